@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/c/experimental/saved_model/core/tf_saved_model_api.h"
 
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <unordered_set>
@@ -22,6 +23,7 @@ limitations under the License.
 
 #include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/strings/str_split.h"
 #include "absl/strings/string_view.h"
 #include "absl/types/optional.h"
@@ -51,11 +53,14 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/flatmap.h"
 #include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/platform/casts.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/stringpiece.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/platform/tstring.h"
 #include "tensorflow/core/protobuf/meta_graph.pb.h"
 #include "tensorflow/core/protobuf/saved_model.pb.h"
@@ -171,6 +176,65 @@ Status InitializeAllResources(const RevivedObjects& revived) {
   return Status();
 }
 
+// Maximum number of threads registering function library functions with the
+// context.
+constexpr int kMaxFunctionRegistrationThreads = 16;
+
+// Revives the functions of `library` that were not revived from the object
+// graph as concrete functions without captures. Registering a function with
+// the context also runs its function optimizations, so the functions are
+// registered in parallel; they are only instantiated when first called.
+Status ReviveLibraryFunctions(const FunctionDefLibrary& library,
+                              const PartiallyRevivedObjects& objects,
+                              ImmediateExecutionContext* context,
+                              RevivedObjects* revived) {
+  // The functions of the object graph are already registered.
+  absl::flat_hash_set<absl::string_view> registered;
+  for (const auto& id_and_func : objects.concrete_functions) {
+    registered.insert(id_and_func.second.fdef->signature().name());
+  }
+  for (const auto& id_and_func : objects.signature_def_functions) {
+    registered.insert(id_and_func.second.fdef->signature().name());
+  }
+  std::vector<const FunctionDef*> functions;
+  for (const FunctionDef& function : library.function()) {
+    if (!registered.contains(function.signature().name())) {
+      functions.push_back(&function);
+    }
+  }
+
+  std::vector<std::unique_ptr<TFConcreteFunction>> concrete_functions(
+      functions.size());
+  std::vector<Status> statuses(functions.size());
+  auto create_functions = [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; ++i) {
+      statuses[i] = TFConcreteFunction::Create(/*function_def=*/functions[i],
+                                               /*captures=*/{},
+                                               /*metadata=*/{},
+                                               /*ctx=*/context,
+                                               /*out=*/&concrete_functions[i]);
+    }
+  };
+  const int num_threads =
+      std::min<int>(port::MaxParallelism(), kMaxFunctionRegistrationThreads);
+  if (functions.size() > 1 && num_threads > 1) {
+    thread::ThreadPool thread_pool(Env::Default(), "revive_library_functions",
+                                   num_threads);
+    // Each function is expensive enough to be scheduled on its own.
+    thread_pool.ParallelFor(functions.size(), /*cost_per_unit=*/1000000,
+                            create_functions);
+  } else {
+    create_functions(0, functions.size());
+  }
+
+  // Insert the functions in library order, so that loading is deterministic.
+  for (size_t i = 0; i < functions.size(); ++i) {
+    TF_RETURN_IF_ERROR(statuses[i]);
+    revived->concrete_functions.Insert(std::move(concrete_functions[i]));
+  }
+  return Status();
+}
+
 }  // namespace
 
 Status TFSavedModelAPI::GetFunction(const std::string& function_path,
@@ -292,16 +356,9 @@ Status TFSavedModelAPI::Load(
   // _not_ in the object graph: A while loop, for example, will create two
   // auxiliary `while_cond` and `while_body` functions that are only present in
   // the graph def function library.
-  for (const FunctionDef& function :
-       bundle.meta_graph_def().graph_def().library().function()) {
-    std::unique_ptr<TFConcreteFunction> concrete_function;
-    TF_RETURN_IF_ERROR(TFConcreteFunction::Create(/*function_def=*/&function,
-                                                  /*captures=*/{},
-                                                  /*metadata=*/{},
-                                                  /*ctx=*/context,
-                                                  /*out=*/&concrete_function));
-    revived_objects.concrete_functions.Insert(std::move(concrete_function));
-  }
+  TF_RETURN_IF_ERROR(ReviveLibraryFunctions(
+      bundle.meta_graph_def().graph_def().library(), partially_revived_objects,
+      context, &revived_objects));
 
   TF_RETURN_IF_ERROR(
       RestoreCheckpoint(&bundle, revived_objects, directory, context));
@@ -65,6 +65,15 @@ constexpr int64_t kDefaultCompilationThreshold = 2;
 // Maximum number of ongoing compilations.
 constexpr int64_t kMaxNumOngoingCompilations = kNumAsyncDeviceCompilerThreads;
 
+// Number of ongoing compilation slots reserved for hot signatures, so that
+// one-off shapes cannot keep the signatures that most requests run through
+// waiting on the TF fallback.
+constexpr int64_t kNumHotSignatureCompilations = 2;
+
+// The number of times a signature must have been requested to be considered
+// hot by asynchronous compilation.
+constexpr int64_t kHotSignatureRequestCount = 3;
+
 }  // namespace
 
 DeviceCompilationProfiler::~DeviceCompilationProfiler() {
@@ -110,6 +119,9 @@ Status DeviceCompilationProfiler::RegisterCompilation(
   const uint64 compile_time_s = compile_time_us / 1.0e6;
   it->second.compile_count++;
   it->second.cumulative_compile_time_us += compile_time_us;
+  if (it->second.compile_count > 1) {
+    metrics::RecordXlaRecompilation();
+  }
   VLOG(1) << "Compiled " << function_name << " " << it->second.compile_count
           << " times, compile time: " << compile_time_us
           << " us, cumulative: " << it->second.cumulative_compile_time_us
@@ -186,6 +198,15 @@ bool DeviceCompilationProfiler::ShouldCompileCluster(
               << " because of too many ongoing compilations.";
       return false;
     }
+    if (num_ongoing_compilations_ >=
+            kMaxNumOngoingCompilations - kNumHotSignatureCompilations &&
+        current_request_count < kHotSignatureRequestCount) {
+      VLOG(2) << "Not asynchronously compiling cluster " << function.name()
+              << " because the remaining compilations are reserved for hot "
+                 "signatures; request count "
+              << current_request_count << ".";
+      return false;
+    }
   }
 
   bool reached_compile_threshold = current_request_count >= *compile_threshold;
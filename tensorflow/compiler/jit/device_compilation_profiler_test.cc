@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/compiler/jit/tests/device_compiler_test_helper.h"
 #include "tensorflow/compiler/jit/xla_activity.pb.h"
 #include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/lib/monitoring/cell_reader.h"
 
 namespace tensorflow {
 namespace {
@@ -81,6 +82,25 @@ TEST(DeviceCompilationProfilerTest, RegisterCompilation) {
   }
 }
 
+TEST(DeviceCompilationProfilerTest, RecordsRecompilations) {
+  DeviceCompilationProfiler* profiler = new DeviceCompilationProfiler();
+  core::ScopedUnref profiler_ref(profiler);
+  monitoring::testing::CellReader<int64_t> recompilations(
+      "/tensorflow/core/xla_recompilations");
+
+  NameAttrList function;
+  function.set_name("TestFunc");
+
+  // The first compilation of a cluster is not a recompilation.
+  EXPECT_TRUE(profiler->RegisterCompilation(function, 4, false).ok());
+  EXPECT_EQ(recompilations.Delta(), 0);
+
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_TRUE(profiler->RegisterCompilation(function, 4, false).ok());
+  }
+  EXPECT_EQ(recompilations.Delta(), 3);
+}
+
 TEST(DeviceCompilationProfilerTest, OngoingAsyncCompilations) {
   DeviceCompilationProfiler* profiler = new DeviceCompilationProfiler();
   core::ScopedUnref profiler_ref(profiler);
@@ -206,8 +226,19 @@ TEST(DeviceCompilationProfilerTest, ShouldCompileClusterAsync) {
       profiler->ShouldCompileCluster(function, DeviceCompileMode::kAsync, 0));
 
   profiler->DecrementOngoingAsyncCompilations();
-  // Should allow compilation since we've decremented the number of ongoing
-  // compilations.
+  // Should only allow compilation of hot signatures since we've decremented the
+  // number of ongoing compilations, but the remaining ones are reserved for hot
+  // signatures.
+  EXPECT_FALSE(
+      profiler->ShouldCompileCluster(function, DeviceCompileMode::kAsync, 0));
+  EXPECT_TRUE(
+      profiler->ShouldCompileCluster(function, DeviceCompileMode::kAsync, 3));
+
+  for (int i = 0; i < 2; ++i) {
+    profiler->DecrementOngoingAsyncCompilations();
+  }
+  // Should allow compilation of any signature since there are enough compiler
+  // threads available.
   EXPECT_TRUE(
       profiler->ShouldCompileCluster(function, DeviceCompileMode::kAsync, 0));
 }
@@ -27,6 +27,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/util.h"
 #include "tensorflow/core/framework/device.h"
 #include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/statusor.h"
@@ -37,6 +38,11 @@ namespace tensorflow {
 // Offers a way to persist and/or load compiled `ExecutableType`s along with the
 // corresponding HLO (`CompilationResult`) to/from `persistent_cache_directory`
 // (if one was provided during construction) on disk  using `ClientType`.
+//
+// `persistent_cache_directory` may be on any file system supported by `Env`,
+// e.g. a GCS bucket, and may be shared by several processes or machines
+// compiling the same clusters: entries are written atomically and checked
+// against the fingerprint of their executable when loaded.
 template <typename ExecutableType, typename ClientType>
 class DeviceExecutablePersistor {
  public:
@@ -51,7 +57,8 @@ class DeviceExecutablePersistor {
           persistence_prefix(persistence_prefix) {}
 
     // If non-empty, JIT-compiled executables are saved to and loaded from the
-    // specified file system directory path.
+    // specified file system directory path. It can be shared by several
+    // processes.
     std::string persistent_cache_directory;
 
     // Disable strict signature checks for entries loaded into the cache from
@@ -114,7 +121,9 @@ class DeviceExecutablePersistor {
       DeviceCompilerClient<ExecutableType, ClientType>* compiler_client) const;
 
   // Saves the cache entry in the file directory supplied during the
-  // construction of this class. Overwrites existing entries.
+  // construction of this class. Overwrites existing entries. The entry is
+  // written to a temporary file first and then renamed, so that concurrent
+  // readers and writers never observe a partially written entry.
   Status SaveSerializedEntry(const XlaSerializedCacheEntry& entry) const;
 
   // Tries to read a cache entry given a `key` by searching the file directory
@@ -251,6 +260,12 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::VerifyLoadedCacheEntry(
   if (entry.executable().empty()) {
     return errors::InvalidArgument("No binary found in serialized entry.");
   }
+
+  if (entry.executable_fingerprint() != 0 &&
+      entry.executable_fingerprint() != Fingerprint64(entry.executable())) {
+    return errors::InvalidArgument(
+        "Serialized executable does not match its fingerprint.");
+  }
   return OkStatus();
 }
 
@@ -261,7 +276,17 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::SaveSerializedEntry(
   Env* env = Env::Default();
   TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(persistent_cache_directory_));
   const std::string file_path = GetFilePath(entry.key());
-  return WriteBinaryProto(env, file_path, entry);
+  std::string temp_file_path = file_path;
+  if (!env->CreateUniqueFileName(&temp_file_path, ".tmp")) {
+    return errors::Internal("Failed to create a temporary file name for ",
+                            file_path);
+  }
+  TF_RETURN_IF_ERROR(WriteBinaryProto(env, temp_file_path, entry));
+  Status status = env->RenameFile(temp_file_path, file_path);
+  if (!status.ok()) {
+    env->DeleteFile(temp_file_path).IgnoreError();
+  }
+  return status;
 }
 
 template <typename ExecutableType, typename ClientType>
@@ -285,6 +310,8 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::SerializeEntry(
           compiler_client->SerializeExecutable(executable);
       serialized_executable.ok()) {
     serialized_entry.set_executable(std::move(*serialized_executable));
+    serialized_entry.set_executable_fingerprint(
+        Fingerprint64(serialized_entry.executable()));
     return serialized_entry;
   } else if (serialized_executable.status().code() == error::UNIMPLEMENTED) {
     VLOG(1) << "Executable export is not implemented";
@@ -296,6 +323,8 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::SerializeEntry(
       auto serialized_executable,
       compiler_client->BuildSerializedExecutable(options, compilation_result));
   serialized_entry.set_executable(std::move(serialized_executable));
+  serialized_entry.set_executable_fingerprint(
+      Fingerprint64(serialized_entry.executable()));
   return serialized_entry;
 }
 
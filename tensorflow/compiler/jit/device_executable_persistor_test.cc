@@ -38,6 +38,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/pjrt/tfrt_cpu_pjrt_client.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/status_matchers.h"
 #include "tensorflow/core/platform/statusor.h"
 #include "tensorflow/core/tfrt/common/create_pjrt_client_util.h"
@@ -555,6 +556,44 @@ TEST_F(DeviceExecutionPersistorTest, LoadSerializedExecutableEmpty) {
               testing::StatusIs(error::INVALID_ARGUMENT));
 }
 
+TEST_F(DeviceExecutionPersistorTest, LoadSerializedExecutableCorrupted) {
+  XlaDeviceExecutablePersistor::Config config(
+      /*persistent_cache_directory=*/cache_dir_,
+      /*disable_strict_signature_checks=*/false,
+      /*persistence_prefix=*/"xla");
+  XlaDeviceExecutablePersistor persistor(config,
+                                         DefaultXlaOptions().device_type);
+
+  MockXlaCompilerClient mock_client;
+  EXPECT_CALL(mock_client, SerializeExecutable(_))
+      .WillOnce(Return(serialized_xla_executable_));
+  TF_ASSERT_OK_AND_ASSIGN(auto executable, BuildSampleExecutable());
+  TF_ASSERT_OK(persistor.TryToPersistExecutable(
+      /*signature_hash=*/789, "signature_string", DefaultXlaOptions(),
+      compilation_result_add_, *executable, &mock_client));
+
+  auto key =
+      CreateCacheKey(/*signature_hash=*/789, compilation_result_add_,
+                     persistor.device_type(), persistor.persistence_prefix());
+  TF_ASSERT_OK_AND_ASSIGN(auto entry, ReadCacheEntryFromFile(key, cache_dir_));
+  EXPECT_EQ(entry.executable_fingerprint(),
+            Fingerprint64(serialized_xla_executable_));
+
+  // Corrupt the executable but keep its original fingerprint.
+  entry.set_executable("corrupted_xla_executable");
+  TF_ASSERT_OK(WriteBinaryProto(
+      Env::Default(), GetFilePath(key, persistor.persistent_cache_directory()),
+      entry));
+
+  auto loaded_executable = persistor.TryToLoadExecutable(
+      /*signature_hash=*/789, "signature_string", DefaultXlaOptions(),
+      compilation_result_add_, &mock_client);
+
+  EXPECT_TRUE(loaded_executable.has_value());
+  EXPECT_THAT(loaded_executable.value(),
+              testing::StatusIs(error::INVALID_ARGUMENT));
+}
+
 TEST_F(DeviceExecutionPersistorTest, PersistPjRtAndXlaExecutables) {
   // Persist PJRT executable.
   PjRtDeviceExecutablePersistor::Config pjrt_config(
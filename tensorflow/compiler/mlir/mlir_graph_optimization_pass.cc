@@ -24,6 +24,7 @@ limitations under the License.
 #include "absl/container/flat_hash_set.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/raw_os_ostream.h"
 #include "mlir/Dialect/Arith/IR/Arith.h"  // from @llvm-project
 #include "mlir/Dialect/Func/Extensions/AllExtensions.h"  // from @llvm-project
@@ -139,6 +140,14 @@ static void RegisterDialects(mlir::DialectRegistry& registry) {
   // clang-format on
 }
 
+// Returns the thread pool shared by the MLIR contexts of all graph
+// optimization passes. Function-level passes of the pipelines run on it in
+// parallel, without every pass invocation spawning a thread pool of its own.
+static llvm::ThreadPool& GetMlirThreadPool() {
+  static auto* pool = new llvm::ThreadPool();
+  return *pool;
+}
+
 Status MlirFunctionOptimizationPass::Run(
     const std::string& function_name, const DeviceSet& device_set,
     const ConfigProto& config_proto,
@@ -202,7 +211,8 @@ Status MlirFunctionOptimizationPass::Run(
   GraphDebugInfo debug_info;
   mlir::DialectRegistry registry;
   RegisterDialects(registry);
-  mlir::MLIRContext context(registry);
+  mlir::MLIRContext context(registry, mlir::MLIRContext::Threading::DISABLED);
+  context.setThreadPool(GetMlirThreadPool());
   GraphImportConfig import_config;
   import_config.graph_as_function = true;
   import_config.control_outputs = *control_ret_node_names;
@@ -388,7 +398,8 @@ Status MlirV1CompatGraphOptimizationPass::Run(
   GraphDebugInfo debug_info;
   mlir::DialectRegistry registry;
   RegisterDialects(registry);
-  mlir::MLIRContext context(registry);
+  mlir::MLIRContext context(registry, mlir::MLIRContext::Threading::DISABLED);
+  context.setThreadPool(GetMlirThreadPool());
   GraphImportConfig import_config;
   import_config.upgrade_legacy = true;
   // Restrict functionalization to compiled nodes to avoid problems in v1
@@ -118,6 +118,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/platform/crash_analysis.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/fingerprint.h"
@@ -179,6 +180,14 @@ void LoadImporterDialects(mlir::MLIRContext& context) {
     context.getOrLoadDialect(name);
 }
 
+// Returns the thread pool used to instantiate the bodies of library functions
+// concurrently during import.
+thread::ThreadPool* GetImportThreadPool() {
+  static thread::ThreadPool* pool = new thread::ThreadPool(
+      Env::Default(), "mlir_import", port::MaxParallelism());
+  return pool;
+}
+
 // This class is used to generate new MLIR function name strings that are both
 // unique in the TF function library `flib_` and unique among the name strings
 // generated by the class object during its lifetime.
@@ -315,6 +324,12 @@ class ImporterBase {
     std::vector<mlir::NamedAttribute> attributes;
   };
 
+  // Converts the instantiated body of a deferred TF function to an MLIR
+  // function and queues the functions it calls for conversion.
+  Status ConvertDeferredFunction(
+      const DeferredConversionMetaData& conversion_metadata,
+      const FunctionBody& fbody);
+
   // Adds all the ordered_nodes to the shape refiner shape_refiner_. Then all
   // data type and shape information is maintained by the shape_refiner_.
   // TODO(jpienaar): Remove once shape inference on import is removed.
@@ -604,74 +619,106 @@ std::string GetUniqueNodeName(
 
 Status ImporterBase::ConvertDeferredFunctions() {
   while (!deferred_functions_.empty()) {
-    auto conversion_metadata = deferred_functions_.front();
-    deferred_functions_.pop();
-
-    const FunctionDef* func_def =
-        graph_flib_.Find(conversion_metadata.function_name);
-    // Converts the graph to an MLIR function and adds it to the module.
-    // We populate the NodeSpec so that all the _Arg ops get their shape
-    // added correctly.
-    GraphImportConfig specs;
-    specs.enable_shape_inference = specs_.enable_shape_inference;
-    specs.unconditionally_use_set_output_shapes =
-        specs_.unconditionally_use_set_output_shapes;
-    for (const auto& name_and_value : func_def->attr()) {
-      if (name_and_value.first == "_input_shapes") {
-        auto& list = name_and_value.second.list();
-        auto& signature = func_def->signature();
-        // Some models have "_input_shapes" attribute, but with its value empty
-        if (list.shape_size() > 0 &&
-            list.shape_size() != signature.input_arg_size()) {
-          return errors::FailedPrecondition(
-              "Number of input arguments must be equal to the length of "
-              "_input_shapes attribute in function '",
-              StringRefToView(conversion_metadata.function_name), "'.");
-        }
-        for (int i = 0, e = signature.input_arg_size(); i < e; i++) {
-          auto& input_arg = signature.input_arg(i);
-          auto& array_info = specs.inputs[input_arg.name()];
-          array_info.imported_dtype = input_arg.type();
-          // set to unranked for empty "_input_shapes" attribute
-          if (list.shape_size() > 0)
-            array_info.shape = list.shape(i);
-          else
-            array_info.shape.set_unknown_rank(true);
-        }
+    std::vector<DeferredConversionMetaData> functions;
+    functions.reserve(deferred_functions_.size());
+    while (!deferred_functions_.empty()) {
+      functions.push_back(std::move(deferred_functions_.front()));
+      deferred_functions_.pop();
+    }
+    // Instantiating the function bodies only reads the function library, so
+    // it is done concurrently for all functions discovered so far. Converting
+    // the bodies mutates the module and is done sequentially afterwards.
+    std::vector<std::unique_ptr<FunctionBody>> fbodies(functions.size());
+    std::vector<Status> statuses(functions.size());
+    auto instantiate = [&](int64_t begin, int64_t end) {
+      for (int64_t i = begin; i < end; ++i) {
+        const FunctionDef* func_def =
+            graph_flib_.Find(functions[i].function_name);
+        statuses[i] = FunctionDefToBodyHelper(*func_def, AttrSlice(),
+                                              &graph_flib_, &fbodies[i]);
       }
+    };
+    if (functions.size() > 1) {
+      // Each function is expensive enough to be worth a shard of its own.
+      GetImportThreadPool()->ParallelFor(
+          functions.size(), /*cost_per_unit=*/1 << 20, instantiate);
+    } else {
+      instantiate(0, functions.size());
     }
 
-    ImporterBase importer(graph_flib_, debug_info_, specs, module_,
-                          tf_name_to_mlir_name_, function_name_uniquifier_,
-                          conversion_metadata.function_name);
+    for (int i = 0, e = functions.size(); i < e; ++i) {
+      TF_RETURN_IF_ERROR(statuses[i]);
+      TF_RETURN_IF_ERROR(ConvertDeferredFunction(functions[i], *fbodies[i]));
+    }
+  }
 
-    std::unique_ptr<FunctionBody> fbody;
-    TF_RETURN_IF_ERROR(
-        FunctionDefToBodyHelper(*func_def, AttrSlice(), &graph_flib_, &fbody));
-    TF_RETURN_IF_ERROR(importer.PrepareConvert(*fbody->graph));
-
-    TF_ASSIGN_OR_RETURN(auto func_type, importer.InferLibFunctionType(*fbody));
-
-    absl::InlinedVector<OutputTensor, 4> arg_nodes;
-    absl::InlinedVector<OutputTensor, 4> ret_nodes;
-    absl::InlinedVector<Node*, 4> control_ret_nodes;
-    importer.GetArgsAndRetsFromFunctionBody(*fbody, &arg_nodes, &ret_nodes,
-                                            &control_ret_nodes);
-    const std::string& mlir_func_name =
-        (*tf_name_to_mlir_name_)[conversion_metadata.function_name];
-
-    TF_RETURN_IF_ERROR(importer.Convert(mlir_func_name, func_type, arg_nodes,
-                                        ret_nodes, control_ret_nodes,
-                                        conversion_metadata.attributes));
-
-    // Additional function bodies could be discovered during the deferred
-    // loading of the current function. Add them to the working queue.
-    while (!importer.deferred_functions_.empty()) {
-      deferred_functions_.push(importer.deferred_functions_.front());
-      importer.deferred_functions_.pop();
+  return OkStatus();
+}
+
+Status ImporterBase::ConvertDeferredFunction(
+    const DeferredConversionMetaData& conversion_metadata,
+    const FunctionBody& fbody) {
+  const FunctionDef* func_def =
+      graph_flib_.Find(conversion_metadata.function_name);
+  // Converts the graph to an MLIR function and adds it to the module.
+  // We populate the NodeSpec so that all the _Arg ops get their shape
+  // added correctly.
+  GraphImportConfig specs;
+  specs.enable_shape_inference = specs_.enable_shape_inference;
+  specs.unconditionally_use_set_output_shapes =
+      specs_.unconditionally_use_set_output_shapes;
+  for (const auto& name_and_value : func_def->attr()) {
+    if (name_and_value.first == "_input_shapes") {
+      auto& list = name_and_value.second.list();
+      auto& signature = func_def->signature();
+      // Some models have "_input_shapes" attribute, but with its value empty
+      if (list.shape_size() > 0 &&
+          list.shape_size() != signature.input_arg_size()) {
+        return errors::FailedPrecondition(
+            "Number of input arguments must be equal to the length of "
+            "_input_shapes attribute in function '",
+            StringRefToView(conversion_metadata.function_name), "'.");
+      }
+      for (int i = 0, e = signature.input_arg_size(); i < e; i++) {
+        auto& input_arg = signature.input_arg(i);
+        auto& array_info = specs.inputs[input_arg.name()];
+        array_info.imported_dtype = input_arg.type();
+        // set to unranked for empty "_input_shapes" attribute
+        if (list.shape_size() > 0)
+          array_info.shape = list.shape(i);
+        else
+          array_info.shape.set_unknown_rank(true);
+      }
     }
   }
 
+  ImporterBase importer(graph_flib_, debug_info_, specs, module_,
+                        tf_name_to_mlir_name_, function_name_uniquifier_,
+                        conversion_metadata.function_name);
+
+  TF_RETURN_IF_ERROR(importer.PrepareConvert(*fbody.graph));
+
+  TF_ASSIGN_OR_RETURN(auto func_type, importer.InferLibFunctionType(fbody));
+
+  absl::InlinedVector<OutputTensor, 4> arg_nodes;
+  absl::InlinedVector<OutputTensor, 4> ret_nodes;
+  absl::InlinedVector<Node*, 4> control_ret_nodes;
+  importer.GetArgsAndRetsFromFunctionBody(fbody, &arg_nodes, &ret_nodes,
+                                          &control_ret_nodes);
+  const std::string& mlir_func_name =
+      (*tf_name_to_mlir_name_)[conversion_metadata.function_name];
+
+  TF_RETURN_IF_ERROR(importer.Convert(mlir_func_name, func_type, arg_nodes,
+                                      ret_nodes, control_ret_nodes,
+                                      conversion_metadata.attributes));
+
+  // Additional function bodies could be discovered during the deferred
+  // loading of the current function. Add them to the working queue.
+  while (!importer.deferred_functions_.empty()) {
+    deferred_functions_.push(importer.deferred_functions_.front());
+    importer.deferred_functions_.pop();
+  }
+
   return OkStatus();
 }
 
@@ -41,8 +41,12 @@ limitations under the License.
 #include "tensorflow/core/grappler/clusters/virtual_cluster.h"
 #include "tensorflow/core/lib/core/refcount.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/stream_executor.h"
 #include "tensorflow/core/platform/thread_annotations.h"
@@ -132,6 +136,23 @@ class AsyncHelper : public core::RefCounted {
   AsyncOpKernel::DoneCallback done_;
 };
 
+// Returns the directory in which engines built at runtime are persisted, so
+// that later processes can load them instead of building them again. Returns
+// an empty string if engines are not persisted.
+const string& GetEngineCacheDir() {
+  static const string* dir = [] {
+    string value;
+    Status status =
+        ReadStringFromEnvVar("TF_TRT_ENGINE_CACHE_DIR", /*default_val=*/"",
+                             &value);
+    if (!status.ok()) {
+      LOG(ERROR) << status;
+    }
+    return new string(value);
+  }();
+  return *dir;
+}
+
 }  // end anonymous namespace
 
 //  This OP can construct TRTEngine on the fly and if construction of engine
@@ -196,6 +217,25 @@ class TRTEngineOp : public AsyncOpKernel {
       bool use_calibration, TRTInt8Calibrator* calibrator,
       TRTEngineCacheResource* cache_resource, OpKernelContext* ctx);
 
+  // Returns the path under which the engine for the input shapes is persisted,
+  // or an empty string if engines are not persisted. The file name
+  // fingerprints everything the engine depends on: the segment graph, the
+  // conversion parameters, the TensorRT version, the GPU and the input shapes
+  // (implicit batch mode) or the optimization profiles (explicit batch mode).
+  string GetEngineCachePath(
+      const std::vector<TensorShape>& input_concrete_shapes,
+      OpKernelContext* ctx, TRTEngineCacheResource* cache_resource);
+
+  // Deserializes the engine persisted at `path`. Returns nullptr if there is
+  // no such engine or it can't be deserialized.
+  TrtUniquePtrType<nvinfer1::ICudaEngine> LoadPersistedEngine(
+      const string& path, OpKernelContext* ctx,
+      TRTEngineCacheResource* cache_resource);
+
+  // Serializes `engine` to `path`. Failures are logged and otherwise ignored.
+  void PersistEngine(const string& path, nvinfer1::ICudaEngine* engine,
+                     OpKernelContext* ctx);
+
   // Verify that the input shapes are consistent and can be handled by this op.
   Status VerifyInputShapes(const std::vector<TensorShape>& shapes);
 
@@ -1143,6 +1183,125 @@ StatusOr<TrtUniquePtrType<nvinfer1::ICudaEngine>> TRTEngineOp::BuildEngine(
   return engine;
 }
 
+string TRTEngineOp::GetEngineCachePath(
+    const std::vector<TensorShape>& input_concrete_shapes,
+    OpKernelContext* ctx, TRTEngineCacheResource* cache_resource) {
+  const string& cache_dir = GetEngineCacheDir();
+  if (cache_dir.empty() || segment_graph_def_.node().empty()) return "";
+
+  string serialized_segment;
+  if (!SerializeToStringDeterministic(segment_graph_def_,
+                                      &serialized_segment)) {
+    return "";
+  }
+  DeviceNameUtils::ParsedName full_parsed_name;
+  DeviceNameUtils::ParseFullName(ctx->device()->name(), &full_parsed_name);
+  const DeviceProperties device = grappler::GetDeviceInfo(full_parsed_name);
+  auto get_env = [&device](const string& key) -> string {
+    auto it = device.environment().find(key);
+    return it == device.environment().end() ? "" : it->second;
+  };
+  const auto trt_version = GetLoadedTensorRTVersion();
+
+  string key = StrCat(
+      "segment=", Fingerprint64(serialized_segment),
+      ";precision=", static_cast<int>(precision_mode_),
+      ";implicit_batch=", static_cast<int>(use_implicit_batch_),
+      ";explicit_precision=", static_cast<int>(use_explicit_precision_),
+      ";workspace=", workspace_size_, ";trt=", std::get<0>(trt_version), ".",
+      std::get<1>(trt_version), ".", std::get<2>(trt_version),
+      ";gpu=", device.model(), ",", get_env("architecture"), ",",
+      get_env("cuda"));
+  if (use_calibration_ && calibrator_) {
+    StrAppend(&key, ";calibration=",
+              Fingerprint64(calibrator_->getCalibrationTableAsString()));
+  }
+  if (use_implicit_batch_) {
+    StrAppend(&key, ";shapes=",
+              TensorShapeUtils::ShapeListString(input_concrete_shapes));
+  } else {
+    StrAppend(&key, ";profiles=",
+              cache_resource->profiles_.ProfilesDebugString());
+  }
+  VLOG(2) << "Engine cache key for " << name() << ": " << key;
+
+  string file_name = StrCat(name(), "_", Fingerprint64(key), ".engine");
+  std::replace(file_name.begin(), file_name.end(), '/', '_');
+  return io::JoinPath(cache_dir, file_name);
+}
+
+TrtUniquePtrType<nvinfer1::ICudaEngine> TRTEngineOp::LoadPersistedEngine(
+    const string& path, OpKernelContext* ctx,
+    TRTEngineCacheResource* cache_resource) {
+  tensorflow::profiler::TraceMe activity(
+      "TRTEngineOp::LoadPersistedEngine",
+      tensorflow::profiler::TraceMeLevel::kInfo);
+  if (!ctx->env()->FileExists(path).ok()) return nullptr;
+  string serialized_engine;
+  Status status = ReadFileToString(ctx->env(), path, &serialized_engine);
+  if (!status.ok()) {
+    LOG_FIRST_FEW_WARNING_WITH_PREFIX << "Failed to read TensorRT engine from "
+                                      << path << ": " << status;
+    return nullptr;
+  }
+  TrtUniquePtrType<IRuntime> infer(nvinfer1::createInferRuntime(logger));
+  infer->setGpuAllocator(cache_resource->allocator_.get());
+  // Need to initialize plugins in order to deserialize engines that contain
+  // plugins.
+  MaybeInitializeTrtPlugins(&logger);
+  TrtUniquePtrType<nvinfer1::ICudaEngine> engine(infer->deserializeCudaEngine(
+      serialized_engine.data(), serialized_engine.size(), nullptr));
+  if (!engine) {
+    LOG_FIRST_FEW_WARNING_WITH_PREFIX
+        << "Failed to deserialize TensorRT engine from " << path;
+    return nullptr;
+  }
+  if (!use_implicit_batch_) {
+    // The profiles are part of the cache key, restoring them from the engine
+    // additionally sets up the shape tensor and pruned input masks.
+    cache_resource->profiles_.clear();
+    status = cache_resource->profiles_.RestoreProfiles(engine.get(),
+                                                       ctx->num_inputs());
+    if (!status.ok()) {
+      LOG_FIRST_FEW_WARNING_WITH_PREFIX
+          << "Failed to restore profiles of TensorRT engine from " << path
+          << ": " << status;
+      return nullptr;
+    }
+  }
+  VLOG(1) << "Loaded TensorRT engine for " << name() << " from " << path;
+  return engine;
+}
+
+void TRTEngineOp::PersistEngine(const string& path,
+                                nvinfer1::ICudaEngine* engine,
+                                OpKernelContext* ctx) {
+  tensorflow::profiler::TraceMe activity(
+      "TRTEngineOp::PersistEngine", tensorflow::profiler::TraceMeLevel::kInfo);
+  TrtUniquePtrType<nvinfer1::IHostMemory> engine_data(engine->serialize());
+  if (!engine_data) return;
+  // Write to a temporary file first so that concurrent processes never read a
+  // partially written engine.
+  const string tmp_path = StrCat(path, ".tmp", ctx->env()->NowMicros());
+  Status status = ctx->env()->RecursivelyCreateDir(string(io::Dirname(path)));
+  if (status.ok()) {
+    status = WriteStringToFile(
+        ctx->env(), tmp_path,
+        StringPiece(static_cast<const char*>(engine_data->data()),
+                    engine_data->size()));
+  }
+  if (status.ok()) {
+    status = ctx->env()->RenameFile(tmp_path, path);
+  }
+  if (!status.ok()) {
+    ctx->env()->DeleteFile(tmp_path).IgnoreError();
+    LOG_FIRST_FEW_WARNING_WITH_PREFIX << "Failed to persist TensorRT engine to "
+                                      << path << ": " << status;
+    return;
+  }
+  VLOG(1) << "Persisted TensorRT engine for " << name() << " to " << path;
+}
+
 StatusOr<std::pair<EngineContext*, int>> TRTEngineOp::GetEngine(
     const std::vector<TensorShape>& input_concrete_shapes, OpKernelContext* ctx,
     TRTEngineCacheResource* cache_res) {
@@ -1300,15 +1459,27 @@ StatusOr<std::pair<EngineContext*, int>> TRTEngineOp::GetEngine(
       return std::pair<EngineContext*, int>(&empty_context, 0);
     }
 
-    // Up to this point, calibrator_ can never be empty, since otherwise it
-    // means calibration_mode_ is true and this path won't get executed.
-    auto result =
-        BuildEngine(input_concrete_shapes, batch_size, use_calibration_,
-                    calibrator_.get(), cache_res, ctx);
-    if (!result.ok()) {
-      return std::pair<EngineContext*, int>(&empty_context, 0);
+    // Engines persisted by an earlier process are loaded instead of built.
+    const string cache_path =
+        GetEngineCachePath(input_concrete_shapes, ctx, cache_res);
+    TrtUniquePtrType<nvinfer1::ICudaEngine> engine;
+    if (!cache_path.empty()) {
+      engine = LoadPersistedEngine(cache_path, ctx, cache_res);
+    }
+    if (!engine) {
+      // Up to this point, calibrator_ can never be empty, since otherwise it
+      // means calibration_mode_ is true and this path won't get executed.
+      auto result =
+          BuildEngine(input_concrete_shapes, batch_size, use_calibration_,
+                      calibrator_.get(), cache_res, ctx);
+      if (!result.ok()) {
+        return std::pair<EngineContext*, int>(&empty_context, 0);
+      }
+      engine = std::move(result.value());
+      if (!cache_path.empty()) {
+        PersistEngine(cache_path, engine.get(), ctx);
+      }
     }
-    TrtUniquePtrType<nvinfer1::ICudaEngine> engine = std::move(result.value());
     std::vector<ExecutionContext> exec_contexts;
     TF_RETURN_IF_ERROR(cache_res->profiles_.CreateExecutionContexts(
         engine.get(), &exec_contexts));
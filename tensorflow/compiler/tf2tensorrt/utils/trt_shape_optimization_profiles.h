@@ -257,6 +257,15 @@ class TrtShapeOptimizationProfile {
   // Returns number of created profiles.
   int GetNumProfiles() const;
 
+  // Returns a string that describes all created profiles.
+  string ProfilesDebugString() const {
+    string result;
+    for (const OptimizationProfileConfig& profile : profiles_) {
+      absl::StrAppend(&result, profile.DebugString());
+    }
+    return result;
+  }
+
   bool HasShape() const { return !input_shapes_.empty(); }
   bool NeedProfiles() const { return need_profiles_; }
 
@@ -479,6 +479,15 @@ Status LocalClient::TransferToInfeedLocal(const LiteralSlice& literal,
                                                                literal);
 }
 
+Status LocalClient::TransferBorrowedToInfeedLocal(
+    const LiteralSlice& literal, int device_ordinal,
+    std::function<void()> on_done_with_literal) {
+  TF_ASSIGN_OR_RETURN(se::StreamExecutor * executor,
+                      backend().stream_executor(device_ordinal));
+  return backend().transfer_manager()->TransferBorrowedLiteralToInfeed(
+      executor, literal, std::move(on_done_with_literal));
+}
+
 Status LocalClient::TransferFromOutfeedLocal(int device_ordinal,
                                              MutableBorrowingLiteral literal) {
   TF_ASSIGN_OR_RETURN(se::StreamExecutor * executor,
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_XLA_CLIENT_LOCAL_CLIENT_H_
 #define TENSORFLOW_COMPILER_XLA_CLIENT_LOCAL_CLIENT_H_
 
+#include <functional>
 #include <memory>
 #include <string>
 #include <utility>
@@ -188,6 +189,13 @@ class LocalClient : public Client {
   // Client::TransferToInfeed.
   Status TransferToInfeedLocal(const LiteralSlice& literal, int device_ordinal);
 
+  // Like TransferToInfeedLocal, but without copying the literal on backends
+  // that can read from it directly. The memory of `literal` must stay valid
+  // until `on_done_with_literal` is called.
+  Status TransferBorrowedToInfeedLocal(
+      const LiteralSlice& literal, int device_ordinal,
+      std::function<void()> on_done_with_literal);
+
   // Transfer and return a value from the outfeed of the given device. The
   // shape of the object to transfer is determined by `literal`'s shape.
   // TODO(b/69670845): Remove the 'Local' from the name when LocalClient does
@@ -121,6 +121,8 @@ DebugOptions DefaultDebugOptionsIgnoringFlags() {
   opts.set_xla_gpu_enable_highest_priority_async_stream(false);
   opts.set_xla_gpu_enable_pipelined_all_reduce(false);
   opts.set_xla_gpu_enable_pipelined_all_gather(false);
+  opts.set_xla_gpu_autotune_collective_combine_thresholds(false);
+  opts.set_xla_gpu_collective_bandwidth_per_size("");
 
   opts.set_xla_cpu_enable_mlir_tiling_and_fusion(true);
   opts.set_xla_cpu_enable_custom_matmul_tiling(false);
@@ -756,6 +758,18 @@ void MakeDebugOptionsFlags(std::vector<tsl::Flag>* flag_list,
       debug_options->xla_gpu_force_compilation_parallelism(),
       "Overrides normal multi-threaded compilation setting to use this many "
       "threads. Setting to 0 (the default value) means no enforcement."));
+  flag_list->push_back(tsl::Flag(
+      "xla_cpu_parallel_codegen_split_count",
+      int32_setter_for(&DebugOptions::set_xla_cpu_parallel_codegen_split_count),
+      debug_options->xla_cpu_parallel_codegen_split_count(),
+      "If greater than 1, XLA:CPU splits the LLVM module into up to this many "
+      "parts and compiles them in parallel."));
+  flag_list->push_back(tsl::Flag(
+      "xla_hlo_pass_parallelism",
+      int32_setter_for(&DebugOptions::set_xla_hlo_pass_parallelism),
+      debug_options->xla_hlo_pass_parallelism(),
+      "If greater than 1, HLO pass pipelines run computation-local passes "
+      "over up to this many computations of a module in parallel."));
   flag_list->push_back(
       tsl::Flag("xla_gpu_deterministic_ops",
                 bool_setter_for(&DebugOptions::set_xla_gpu_deterministic_ops),
@@ -805,6 +819,21 @@ void MakeDebugOptionsFlags(std::vector<tsl::Flag>* flag_list,
           &DebugOptions::set_xla_gpu_reduce_scatter_combine_threshold_bytes),
       debug_options->xla_gpu_reduce_scatter_combine_threshold_bytes(),
       "Size threshold (in bytes) for the GPU reduce-scatter combiner."));
+  flag_list->push_back(tsl::Flag(
+      "xla_gpu_autotune_collective_combine_thresholds",
+      bool_setter_for(
+          &DebugOptions::set_xla_gpu_autotune_collective_combine_thresholds),
+      debug_options->xla_gpu_autotune_collective_combine_thresholds(),
+      "Pick the all-gather and all-reduce combine thresholds per module, "
+      "among halvings of the configured ones, minimizing the exposed "
+      "communication time estimated by the latency hiding scheduler."));
+  flag_list->push_back(tsl::Flag(
+      "xla_gpu_collective_bandwidth_per_size",
+      string_setter_for(
+          &DebugOptions::set_xla_gpu_collective_bandwidth_per_size),
+      debug_options->xla_gpu_collective_bandwidth_per_size(),
+      "Comma separated <size in bytes>:<bandwidth in GB/s> measurements of the "
+      "collective bandwidth, used when autotuning the combine thresholds."));
   flag_list->push_back(tsl::Flag(
       "xla_gpu_all_reduce_contiguous",
       bool_setter_for(&DebugOptions::set_xla_gpu_all_reduce_contiguous),
@@ -1097,6 +1126,15 @@ void MakeDebugOptionsFlags(std::vector<tsl::Flag>* flag_list,
       "File to load autotune results from. It will be considered a binary file "
       "unless the name ends with .txt or .textproto. It will be loaded at most "
       "once per process. This only works on CUDA."));
+  flag_list->push_back(tsl::Flag(
+      "xla_gpu_per_fusion_autotune_cache_dir",
+      string_setter_for(
+          &DebugOptions::set_xla_gpu_per_fusion_autotune_cache_dir),
+      debug_options->xla_gpu_per_fusion_autotune_cache_dir(),
+      "Directory, possibly shared between processes, in which autotuning "
+      "results are cached, keyed by device, library versions and HLO. "
+      "Results are read from it on first use and written to it as soon as "
+      "they are autotuned. This only works on CUDA."));
   flag_list->push_back(tsl::Flag(
       "xla_gpu_auto_spmd_partitioning_memory_budget_gb",
       int32_setter_for(
@@ -140,7 +140,9 @@ HloInstruction* HloComputation::AddInstruction(
 
 HloInstruction* HloComputation::AddInstructionInternal(
     std::unique_ptr<HloInstruction> instruction) {
-  if (parent() != nullptr) {
+  if (next_local_instruction_id_.has_value()) {
+    instruction->SetUniqueId((*next_local_instruction_id_)++);
+  } else if (parent() != nullptr) {
     instruction->UniquifyName(&parent()->instruction_name_uniquer());
     instruction->SetUniqueId(parent()->NewUniqueInstructionId());
   }
@@ -699,6 +699,15 @@ class HloComputation {
     unique_id_ = id;
   }
 
+  // While set, instructions added to this computation take consecutive ids
+  // starting from `first_id` and keep their names as given, instead of getting
+  // module-unique ones from the parent module. This lets several computations
+  // of a module be changed concurrently; see
+  // HloModule::StartConcurrentComputationChanges.
+  void SetLocalInstructionIdsInternal(std::optional<int> first_id) {
+    next_local_instruction_id_ = first_id;
+  }
+
   // Returns the instruction in this computation that has name `name`.  Returns
   // null if there is no such computation.
   HloInstruction* GetInstructionWithName(absl::string_view name);
@@ -779,6 +788,10 @@ class HloComputation {
   int64_t unique_id_;
   HloInstruction* root_instruction_;
 
+  // Id of the next instruction added to this computation while its
+  // instructions get local ids, see SetLocalInstructionIdsInternal.
+  std::optional<int> next_local_instruction_id_;
+
   // If this computation is a fusion computation, this field points to the
   // corresponding fusion instruction (if it is live). Otherwise, this is null.
   HloInstruction* fusion_instruction_;
@@ -223,6 +223,31 @@ void HloModule::MoveComputationsFrom(HloModule* module) {
   }
 }
 
+void HloModule::StartConcurrentComputationChanges(
+    absl::Span<HloComputation* const> computations) {
+  // Local ids start past the ids of all existing instructions, so that they
+  // tell the instructions added in between apart.
+  for (HloComputation* computation : computations) {
+    computation->SetLocalInstructionIdsInternal(next_unique_id_);
+  }
+}
+
+void HloModule::FinishConcurrentComputationChanges(
+    absl::Span<HloComputation* const> computations) {
+  const int first_local_id = next_unique_id_;
+  for (HloComputation* computation : computations) {
+    computation->SetLocalInstructionIdsInternal(std::nullopt);
+    for (HloInstruction* instruction : computation->instructions()) {
+      if (instruction->unique_id() < first_local_id) {
+        continue;
+      }
+      instruction->ClearUniqueIdInternal();
+      instruction->UniquifyName(&instruction_name_uniquer_);
+      instruction->SetUniqueId(NewUniqueInstructionId());
+    }
+  }
+}
+
 void HloModule::ReplaceComputations(
     const absl::flat_hash_map<HloComputation*, HloComputation*>& replacements) {
   // Replace all uses of non-canonical computations with their
@@ -279,6 +279,23 @@ class HloModule {
     }
   }
 
+  // Lets the instructions of `computations` be changed concurrently, e.g. by a
+  // computation-local pass running on each of them in parallel. Until
+  // FinishConcurrentComputationChanges is called, instructions added to them
+  // get ids that are only unique within their computation and keep their
+  // names as given. No other computation of the module may be changed, and no
+  // computation may be added or removed, in between.
+  void StartConcurrentComputationChanges(
+      absl::Span<HloComputation* const> computations);
+
+  // Gives the instructions added to `computations` since
+  // StartConcurrentComputationChanges module-unique ids and names. They are
+  // assigned in the order of `computations` and of their instructions, so the
+  // result does not depend on the order in which the computations were
+  // changed.
+  void FinishConcurrentComputationChanges(
+      absl::Span<HloComputation* const> computations);
+
   // Compute and return a post order of all computations in the module. The sort
   // is defined like so: if computation A has an instruction which calls
   // computation B, then A will appear after B in the sort.
@@ -224,6 +224,9 @@ llvm::SmallVector<RegionStartAndEnd> GetRegionStartAndEnd(FuncOp capture_func) {
       BufferUse dst_buffer = GetBufferUse(memcpy.getDst(), /*read_only=*/false);
       operand_buffer_uses.push_back(src_buffer);
       operand_buffer_uses.push_back(dst_buffer);
+    } else if (auto memset = dyn_cast<mlir::gpu::MemsetOp>(operation)) {
+      BufferUse dst_buffer = GetBufferUse(memset.getDst(), /*read_only=*/false);
+      operand_buffer_uses.push_back(dst_buffer);
     } else if ((!isa<memref::ViewOp>(operation) &&
                 !isa<memref::ReinterpretCastOp>(operation) &&
                 !isa<arith::ConstantOp>(operation)) ||
@@ -181,6 +181,14 @@ struct MemcpyOpCapture : public OpCapturePattern {
   }
 };
 
+// cuBLASLt matmuls get their workspace from an allocator owned by the graph
+// instance, so they can be captured like regular GEMMs.
+struct CublasLtMatmulOpCapture
+    : public MoveOp<lmhlo_gpu::CublasLtMatmulOp,
+                    lmhlo_gpu::CublasLtMatmulF8Op> {};
+
+struct MemsetOpCapture : public MoveOp<mlir::gpu::MemsetOp> {};
+
 // Capture pure operations by cloning them into graph capture function.
 struct ConstantOpCapture : public CloneOp<arith::ConstantOp> {};
 struct ViewOpCapture : public CloneOp<memref::ViewOp> {};
@@ -384,7 +392,8 @@ static LogicalResult Outline(unsigned ordinal,
 
   for (auto op : seq) {
     mlir::Operation* captured_op = op.first;
-    if (isa<lmhlo_gpu::GEMMOp>(captured_op)) {
+    if (isa<lmhlo_gpu::GEMMOp, lmhlo_gpu::CublasLtMatmulOp,
+            lmhlo_gpu::CublasLtMatmulF8Op>(captured_op)) {
       func->setAttr(b.getStringAttr("xla.requires_blas"),
                     BoolAttr::get(ctx, true));
       break;
@@ -458,11 +467,12 @@ void OutlineCudaGraphsPass::runOnOperation() {
   OpCapturePatternSet patterns;
 
   if (cuda_graph_level_ >= 1) {
-    // Enable capturing fusions and memcpies.
+    // Enable capturing fusions, memcpies and memsets.
     patterns.emplace_back(new LaunchFuncOpCapture());
     patterns.emplace_back(new ConstantOpCapture());
     patterns.emplace_back(new ViewOpCapture());
     patterns.emplace_back(new MemcpyOpCapture());
+    patterns.emplace_back(new MemsetOpCapture());
     patterns.emplace_back(new ReinterpretCastOpCapture());
   }
 
@@ -474,6 +484,7 @@ void OutlineCudaGraphsPass::runOnOperation() {
     patterns.emplace_back(new ConvForwardFusedOpCapture());
     patterns.emplace_back(new ConvForwardFusedSideInputOpCapture());
     patterns.emplace_back(new GemmOpCapture());
+    patterns.emplace_back(new CublasLtMatmulOpCapture());
   }
 
   unsigned ordinal = 1;  // entry point will be exported with ordinal 0
@@ -536,6 +536,33 @@ module attributes {gpu.container_module} {
 // CHECK: gpu.memcpy
 // CHECK-NEXT: return
 
+// -----
+// Check that memsets are captured.
+
+module attributes {gpu.container_module} {
+
+  // CHECK: @func(%[[ARG0:.*]]: memref<100xi8>)
+  func.func @func(%arg0: memref<100xi8>) {
+    %c0 = arith.constant 0 : index
+    %c1 = arith.constant 1.0 : f32
+    %dst = memref.view %arg0[%c0][] : memref<100xi8> to memref<10xf32>
+
+    // CHECK: call @xla.gpu.cuda.graph.launch(%[[ARG0]])
+    // CHECK-SAME: {capture = @xla.gpu.cuda.graph.capture}
+    gpu.memset %dst, %c1 : memref<10xf32>, f32
+    gpu.memset %dst, %c1 : memref<10xf32>, f32
+
+    // CHECK: return
+    return
+  }
+  func.func private @external()
+}
+
+// CHECK: func @xla.gpu.cuda.graph.capture
+// CHECK: gpu.memset
+// CHECK: gpu.memset
+// CHECK-NEXT: return
+
 // -----
 // Check that memref.reinterpret_cast operations are cloned into the graph
 // capture function.
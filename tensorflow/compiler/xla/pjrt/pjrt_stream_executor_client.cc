@@ -194,6 +194,65 @@ class CpuAllocator : public tsl::Allocator {
   void DeallocateRaw(void* ptr) override { return tsl::port::AlignedFree(ptr); }
 };
 
+HostToDeviceStagingRing::HostToDeviceStagingRing(
+    tsl::Allocator* host_memory_allocator, LocalDeviceState* local_device)
+    : host_memory_allocator_(host_memory_allocator),
+      local_device_(local_device) {
+  for (int i = 0; i < kNumChunks; ++i) {
+    chunks_[i] = host_memory_allocator_->AllocateRaw(
+        tsl::Allocator::kAllocatorAlignment, kChunkSize);
+    in_use_[i] = false;
+  }
+}
+
+HostToDeviceStagingRing::~HostToDeviceStagingRing() {
+  {
+    absl::MutexLock lock(&mu_);
+    mu_.Await(absl::Condition(
+        +[](std::array<bool, kNumChunks>* in_use) {
+          return absl::c_none_of(*in_use, [](bool b) { return b; });
+        },
+        &in_use_));
+  }
+  for (void* chunk : chunks_) {
+    host_memory_allocator_->DeallocateRaw(chunk);
+  }
+}
+
+Status HostToDeviceStagingRing::TransferToDevice(const void* data,
+                                                 int64_t size,
+                                                 se::DeviceMemoryBase dst) {
+  tsl::profiler::TraceMe traceme("HostToDeviceStagingRing::TransferToDevice");
+  TF_RET_CHECK(dst.size() >= size);
+  se::Stream* stream = local_device_->host_to_device_stream();
+  for (int64_t offset = 0; offset < size; offset += kChunkSize) {
+    const int64_t chunk_size = std::min(kChunkSize, size - offset);
+    int index;
+    {
+      // Wait for the DMA of the previous user of the chunk to complete.
+      absl::MutexLock lock(&mu_);
+      index = next_chunk_;
+      next_chunk_ = (next_chunk_ + 1) % kNumChunks;
+      mu_.Await(absl::Condition(
+          +[](bool* in_use) { return !*in_use; }, &in_use_[index]));
+      in_use_[index] = true;
+    }
+    std::memcpy(chunks_[index], static_cast<const char*>(data) + offset,
+                chunk_size);
+    se::DeviceMemoryBase chunk_dst(
+        static_cast<char*>(dst.opaque()) + offset, chunk_size);
+    stream->ThenMemcpy(&chunk_dst, chunks_[index], chunk_size);
+    local_device_->ThenExecuteCallback(stream, [this, index]() {
+      absl::MutexLock lock(&mu_);
+      in_use_[index] = false;
+    });
+  }
+  if (!stream->ok()) {
+    return InternalError("Host-to-device stream failed during staged transfer");
+  }
+  return OkStatus();
+}
+
 PjRtStreamExecutorClient::PjRtStreamExecutorClient(
     std::string platform_name, LocalClient* client,
     std::vector<std::unique_ptr<PjRtStreamExecutorDevice>> devices,
@@ -246,6 +305,18 @@ PjRtStreamExecutorClient::PjRtStreamExecutorClient(
                });
 }
 
+HostToDeviceStagingRing* PjRtStreamExecutorClient::GetHostToDeviceStagingRing(
+    LocalDeviceState* local_device) {
+  absl::MutexLock lock(&staging_rings_mu_);
+  std::unique_ptr<HostToDeviceStagingRing>& ring =
+      staging_rings_[local_device->device_ordinal()];
+  if (ring == nullptr) {
+    ring = std::make_unique<HostToDeviceStagingRing>(host_memory_allocator(),
+                                                     local_device);
+  }
+  return ring.get();
+}
+
 StatusOr<DeviceAssignment> PjRtStreamExecutorClient::GetDefaultDeviceAssignment(
     int num_replicas, int num_partitions) const {
   return client_->backend().computation_placer()->AssignDevices(num_replicas,
@@ -780,12 +851,25 @@ PjRtStreamExecutorClient::BufferFromHostBuffer(
       py_buffer->GetBufferWithUsageHold());
   CHECK(device_buffer.ok());
 
+  // Large dense transfers are pipelined through the device's staging ring
+  // instead of being staged through a single buffer of the full size, so that
+  // the host copy into staging memory overlaps with the DMA.
+  HostToDeviceStagingRing* staging_ring = nullptr;
+  if (should_stage_host_to_device_transfers() &&
+      host_and_device_strides_equal &&
+      size > HostToDeviceStagingRing::kChunkSize &&
+      transfer_manager->GetByteSizeRequirement(device_shape) == size) {
+    staging_ring = GetHostToDeviceStagingRing(local_device);
+  }
+
   // If necessary, allocate a host-side buffer for staging host-to-device
   // transfers. On GPU this is a buffer in pinned memory.
   std::shared_ptr<void> staging_buffer;
-  if (host_buffer_semantics == HostBufferSemantics::kImmutableOnlyDuringCall ||
-      should_stage_host_to_device_transfers() ||
-      !host_and_device_strides_equal) {
+  if (staging_ring == nullptr &&
+      (host_buffer_semantics ==
+           HostBufferSemantics::kImmutableOnlyDuringCall ||
+       should_stage_host_to_device_transfers() ||
+       !host_and_device_strides_equal)) {
     void* ptr = host_memory_allocator()->AllocateRaw(
         tsl::Allocator::kAllocatorAlignment, size);
     staging_buffer = std::shared_ptr<void>(
@@ -810,7 +894,8 @@ PjRtStreamExecutorClient::BufferFromHostBuffer(
   // caller if the caller only guaranteed that the buffer is valid for the
   // duration of the call. Otherwise, we stage (if necessary) on a separate
   // thread.
-  if (host_buffer_semantics == HostBufferSemantics::kImmutableOnlyDuringCall) {
+  if (staging_buffer &&
+      host_buffer_semantics == HostBufferSemantics::kImmutableOnlyDuringCall) {
     if (transpose) {
       transpose->Execute(data, staging_buffer.get());
     } else {
@@ -833,9 +918,9 @@ PjRtStreamExecutorClient::BufferFromHostBuffer(
        movable_device_buffer{device_buffer.ToClosure()}, device_shape,
        py_buffer{py_buffer.get()},
        on_device_shape{py_buffer->on_device_shape()},
-       staging_buffer{std::move(staging_buffer)},
+       staging_buffer{std::move(staging_buffer)}, staging_ring,
        on_done_with_host_buffer{std::move(on_done_with_host_buffer)},
-       host_buffer_semantics, transpose{std::move(transpose)}]() {
+       host_buffer_semantics, transpose{std::move(transpose)}]() mutable {
         PjRtStreamExecutorBuffer::ScopedHold device_buffer(
             movable_device_buffer);
         // This function uses TF_CHECK_OK and value() since we have no way
@@ -848,7 +933,16 @@ PjRtStreamExecutorClient::BufferFromHostBuffer(
         // If applicable on the backend, stage the transfer via host memory
         // allocated via the host_memory_allocator. On GPU, this is pinned
         // memory.
-        if (staging_buffer) {
+        if (staging_ring) {
+          TF_CHECK_OK(
+              staging_ring->TransferToDevice(data, size, buffer.root_buffer()));
+          // The data has been copied into the ring, so the host buffer is no
+          // longer needed.
+          if (on_done_with_host_buffer) {
+            on_done_with_host_buffer();
+            on_done_with_host_buffer = nullptr;
+          }
+        } else if (staging_buffer) {
           // If we didn't already copy the input buffer into the staging buffer,
           // do so now.
           if (host_buffer_semantics !=
@@ -894,6 +988,12 @@ PjRtStreamExecutorClient::BufferFromHostBuffer(
     // Using the thread_pool would be a double thread hop; the code
     // already defers its work onto a stream (= thread on CPU).
     transfer_h2d();
+  } else if (staging_ring &&
+             host_buffer_semantics ==
+                 HostBufferSemantics::kImmutableOnlyDuringCall) {
+    // The host buffer must be copied before returning, which the staging ring
+    // does while the previous chunks are in flight.
+    transfer_h2d();
   } else {
     thread_pool()->Schedule(transfer_h2d);
   }
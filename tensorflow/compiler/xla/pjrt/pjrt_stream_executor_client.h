@@ -169,6 +169,40 @@ class PjRtStreamExecutorDevice : public PjRtDevice {
   PjRtClient* client_ = nullptr;
 };
 
+// A per-device ring of host staging buffers, allocated with the client's host
+// memory allocator (pinned memory on GPU), through which large host-to-device
+// transfers are pipelined. A transfer is split into chunks, and the host copy
+// of each chunk into the ring overlaps with the DMAs of the previous chunks.
+// Thread-safe.
+class HostToDeviceStagingRing {
+ public:
+  // Size of each staging buffer, and so of the chunks transfers are split into.
+  static constexpr int64_t kChunkSize = 8 << 20;
+  // Number of staging buffers in the ring.
+  static constexpr int kNumChunks = 4;
+
+  HostToDeviceStagingRing(tsl::Allocator* host_memory_allocator,
+                          LocalDeviceState* local_device);
+  // Blocks until the transfers of all chunks in flight have completed.
+  ~HostToDeviceStagingRing();
+
+  // Enqueues the transfer of `size` bytes at `data` to `dst` on the host to
+  // device stream. Returns once every chunk has been copied into the ring, so
+  // the caller may reuse `data` as soon as this returns.
+  Status TransferToDevice(const void* data, int64_t size,
+                          se::DeviceMemoryBase dst);
+
+ private:
+  tsl::Allocator* const host_memory_allocator_;
+  LocalDeviceState* const local_device_;
+
+  absl::Mutex mu_;
+  std::array<void*, kNumChunks> chunks_;
+  // Whether a DMA from the chunk may still be in flight.
+  std::array<bool, kNumChunks> in_use_ ABSL_GUARDED_BY(mu_);
+  int next_chunk_ ABSL_GUARDED_BY(mu_) = 0;
+};
+
 class PjRtStreamExecutorClient : public PjRtClient {
  public:
   // `allocator` may null, in which case the platform default allocator is used.
@@ -326,6 +360,11 @@ class PjRtStreamExecutorClient : public PjRtClient {
 
   tsl::thread::ThreadPool* thread_pool() { return &thread_pool_; }
 
+  // Returns the staging ring used for large host-to-device transfers to
+  // `local_device`, creating it on first use.
+  HostToDeviceStagingRing* GetHostToDeviceStagingRing(
+      LocalDeviceState* local_device);
+
  protected:
   friend class PjRtStreamExecutorBuffer;
 
@@ -399,6 +438,12 @@ class PjRtStreamExecutorClient : public PjRtClient {
   // transfer via pinned memory.
   bool should_stage_host_to_device_transfers_;
 
+  // Staging rings indexed by local device ordinal. Declared before the thread
+  // pool so that they outlive any transfer running on it.
+  absl::Mutex staging_rings_mu_;
+  absl::flat_hash_map<int, std::unique_ptr<HostToDeviceStagingRing>>
+      staging_rings_ ABSL_GUARDED_BY(staging_rings_mu_);
+
   std::unique_ptr<gpu::GpuExecutableRunOptions> gpu_run_options_;
 
   tsl::thread::ThreadPool thread_pool_;
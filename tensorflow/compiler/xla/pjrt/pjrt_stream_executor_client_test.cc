@@ -16,11 +16,13 @@ limitations under the License.
 #include "tensorflow/compiler/xla/pjrt/pjrt_stream_executor_client.h"
 
 #include <memory>
+#include <numeric>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include <gmock/gmock.h>
+#include "absl/algorithm/container.h"
 #include "absl/functional/any_invocable.h"
 #include "tensorflow/compiler/xla/client/client_library.h"
 #include "tensorflow/compiler/xla/client/xla_builder.h"
@@ -33,7 +35,8 @@ limitations under the License.
 namespace xla {
 namespace {
 
-xla::StatusOr<std::unique_ptr<PjRtStreamExecutorClient>> GetClient() {
+xla::StatusOr<std::unique_ptr<PjRtStreamExecutorClient>> GetClient(
+    bool should_stage_host_to_device_transfers = false) {
   LocalClient* local_client = xla::ClientLibrary::LocalClientOrDie();
   TF_ASSIGN_OR_RETURN(se::Platform * platform,
                       PlatformUtil::GetPlatform("Host"));
@@ -52,7 +55,7 @@ xla::StatusOr<std::unique_ptr<PjRtStreamExecutorClient>> GetClient() {
   return std::make_unique<PjRtStreamExecutorClient>(
       "cpu", local_client, std::move(devices), /*process_index=*/0,
       /*allocator=*/nullptr, /*host_memory_allocator=*/nullptr,
-      /*should_stage_host_to_device_transfers=*/false,
+      should_stage_host_to_device_transfers,
       /*gpu_run_options=*/nullptr);
 }
 
@@ -114,5 +117,32 @@ TEST(PjRtStreamExecutorClientTest, DonateSameBufferTwice) {
               ::testing::HasSubstr("f(donate(a), donate(a))"));
 }
 
+TEST(PjRtStreamExecutorClientTest, LargeTransferThroughStagingRing) {
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto client,
+      GetClient(/*should_stage_host_to_device_transfers=*/true));
+  TF_ASSERT_OK_AND_ASSIGN(auto* device0, client->LookupDevice(0));
+
+  // Spans several chunks of the ring, the last of which is partial.
+  constexpr int64_t kChunkSize = HostToDeviceStagingRing::kChunkSize;
+  const int64_t num_elements =
+      (kChunkSize * HostToDeviceStagingRing::kNumChunks + kChunkSize / 2) /
+      sizeof(float);
+  std::vector<float> data(num_elements);
+  std::iota(data.begin(), data.end(), 0.0f);
+
+  bool done_with_host_buffer = false;
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto buffer,
+      client->BufferFromHostBuffer(
+          data.data(), F32, {num_elements}, /*byte_strides=*/std::nullopt,
+          PjRtClient::HostBufferSemantics::kImmutableUntilTransferCompletes,
+          [&]() { done_with_host_buffer = true; }, device0));
+  TF_ASSERT_OK_AND_ASSIGN(std::shared_ptr<Literal> literal,
+                          buffer->ToLiteralSync());
+  EXPECT_TRUE(done_with_host_buffer);
+  EXPECT_TRUE(absl::c_equal(literal->data<float>(), data));
+}
+
 }  // namespace
 }  // namespace xla
@@ -962,8 +962,19 @@ TfrtCpuExecutable::TfrtCpuExecutable(
   // Cache to avoid std::map lookup in flop_count() on critical path.
   // The magic constant 1000 is determined by correlating computation with flop
   // estimate. It is a crude heuristic to find computation less than the thread
-  // context switch time (~5us).
-  cheap_computation_ = hlo_cost_analysis->flop_count() < 1000;
+  // context switch time (~5us). Programs the cost analysis cannot handle are
+  // assumed to be expensive.
+  Status cost_analysis_status =
+      cpu_executable_->module().entry_computation()->Accept(
+          hlo_cost_analysis.get());
+  if (!cost_analysis_status.ok()) {
+    VLOG(1) << "Cost analysis of " << cpu_executable_->module().name()
+            << " failed: " << cost_analysis_status;
+  }
+  cheap_computation_ = cost_analysis_status.ok() &&
+                       hlo_cost_analysis->flop_count() +
+                               hlo_cost_analysis->transcendental_count() <
+                           1000;
 
   const auto& computation_layout =
       cpu_executable_->module().entry_computation_layout();
@@ -1289,7 +1300,8 @@ StatusOr<PjRtLoadedExecutable::Result> TfrtCpuExecutable::ExecuteHelper(
     execute_inline = true;
   }
 
-  if (input_deps.empty() && execute_inline) {
+  execute_inline &= input_deps.empty();
+  if (execute_inline) {
     // Synchronously call generated function.
 
     // Set denormal and rounding behavior to match the default TF
@@ -1422,7 +1434,11 @@ StatusOr<PjRtLoadedExecutable::Result> TfrtCpuExecutable::ExecuteHelper(
     res.push_back(std::move(tfrt_output_buffer));
   }
   std::optional<PjRtFuture<Status>> future;
-  if (fill_future) {
+  if (fill_future && execute_inline) {
+    // The computation has completed successfully, so there is no need to wait
+    // for `execute_event`.
+    future = PjRtFuture<Status>(OkStatus());
+  } else if (fill_future) {
     auto done_event = tfrt::MakeUnconstructedAsyncValueRef<Status>();
     execute_event.AndThen(
         [done_event = done_event.CopyRef(), event = execute_event.CopyRef()]() {
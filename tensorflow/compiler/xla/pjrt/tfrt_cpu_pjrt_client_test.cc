@@ -166,6 +166,48 @@ TEST(TfrtCpuClientTest, HloSnapshot) {
       LiteralUtil::CreateR2<float>({{11.0, 22.0}, {33.0, 44.0}, {55.0, 66.0}}));
 }
 
+TEST(TfrtCpuClientTest, CheapComputationRunsInline) {
+  constexpr char kProgram[] = R"(
+    HloModule add
+    ENTRY add {
+      x = f32[3,2] parameter(0)
+      ROOT add = f32[3,2] add(x, x)
+    })";
+
+  TF_ASSERT_OK_AND_ASSIGN(auto client, GetTfrtCpuClient(/*asynchronous=*/true));
+  TF_ASSERT_OK_AND_ASSIGN(auto hlo_module,
+                          ParseAndReturnUnverifiedModule(kProgram, {}));
+  XlaComputation xla_computation(hlo_module->ToProto());
+  TF_ASSERT_OK_AND_ASSIGN(auto pjrt_executable,
+                          client->Compile(xla_computation, {}));
+
+  std::vector<float> data{1.0, 2.0, 3.0, 4.0, 5.0, 6.0};
+  Shape shape = ShapeUtil::MakeShape(F32, {3, 2});
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto buffer,
+      client->BufferFromHostBuffer(
+          data.data(), shape.element_type(), shape.dimensions(),
+          /*byte_strides=*/std::nullopt,
+          PjRtClient::HostBufferSemantics::kImmutableOnlyDuringCall, nullptr,
+          client->addressable_devices()[0]));
+  TF_ASSERT_OK(buffer->GetReadyFuture().Await());
+
+  // With all inputs ready, the computation runs on the calling thread, so
+  // its results are ready when Execute returns.
+  std::optional<std::vector<PjRtFuture<Status>>> returned_futures;
+  returned_futures.emplace();
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto results,
+      pjrt_executable->Execute(/*argument_handles=*/{{buffer.get()}},
+                               /*options=*/{}, returned_futures));
+  ASSERT_EQ(returned_futures->size(), 1);
+  EXPECT_TRUE((*returned_futures)[0].IsReady());
+  EXPECT_TRUE(results[0][0]->GetReadyFuture().IsReady());
+  TF_ASSERT_OK_AND_ASSIGN(auto literal, results[0][0]->ToLiteralSync());
+  EXPECT_EQ(*literal, LiteralUtil::CreateR2<float>(
+                          {{2.0, 4.0}, {6.0, 8.0}, {10.0, 12.0}}));
+}
+
 TEST(TfrtCpuClientTest, AsyncTransferRawData) {
   TF_ASSERT_OK_AND_ASSIGN(auto client, GetTfrtCpuClient(/*asynchronous=*/true));
   xla::Shape shape = ShapeUtil::MakeShape(U32, {3, 2});
@@ -0,0 +1,79 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/collective_combiner_autotuner.h"
+
+#include <limits>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/tsl/platform/errors.h"
+#include "tensorflow/tsl/platform/logging.h"
+
+namespace xla {
+
+CollectiveCombinerAutotuner::CollectiveCombinerAutotuner(
+    CombinerFactory combiner_factory, std::vector<int64_t> candidate_thresholds,
+    CostFunction cost_fn)
+    : combiner_factory_(std::move(combiner_factory)),
+      candidate_thresholds_(std::move(candidate_thresholds)),
+      cost_fn_(std::move(cost_fn)) {
+  CHECK(!candidate_thresholds_.empty());
+  name_ = absl::StrCat(combiner_factory_(candidate_thresholds_[0])->name(),
+                       "-autotuner");
+}
+
+std::vector<int64_t> CollectiveCombinerAutotuner::HalvingCandidates(
+    int64_t max_threshold_bytes, int64_t min_threshold_bytes,
+    int num_candidates) {
+  std::vector<int64_t> candidates;
+  for (int64_t threshold = max_threshold_bytes;
+       threshold >= min_threshold_bytes &&
+       candidates.size() < num_candidates;
+       threshold /= 2) {
+    candidates.push_back(threshold);
+  }
+  if (candidates.empty()) candidates.push_back(max_threshold_bytes);
+  return candidates;
+}
+
+StatusOr<bool> CollectiveCombinerAutotuner::Run(
+    HloModule* module,
+    const absl::flat_hash_set<absl::string_view>& execution_threads) {
+  int64_t best_threshold = candidate_thresholds_[0];
+  if (candidate_thresholds_.size() > 1) {
+    double best_cost = std::numeric_limits<double>::infinity();
+    for (int64_t threshold : candidate_thresholds_) {
+      std::unique_ptr<HloModule> clone = module->Clone("");
+      TF_RETURN_IF_ERROR(combiner_factory_(threshold)
+                             ->Run(clone.get(), execution_threads)
+                             .status());
+      TF_ASSIGN_OR_RETURN(double cost, cost_fn_(clone.get()));
+      VLOG(2) << name() << ": threshold " << threshold << " bytes costs "
+              << cost << " in " << module->name();
+      if (cost < best_cost) {
+        best_cost = cost;
+        best_threshold = threshold;
+      }
+    }
+    VLOG(1) << name() << ": using threshold " << best_threshold
+            << " bytes for " << module->name();
+  }
+  return combiner_factory_(best_threshold)->Run(module, execution_threads);
+}
+
+}  // namespace xla
@@ -0,0 +1,72 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_COLLECTIVE_COMBINER_AUTOTUNER_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_COLLECTIVE_COMBINER_AUTOTUNER_H_
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "tensorflow/compiler/xla/hlo/ir/hlo_module.h"
+#include "tensorflow/compiler/xla/service/hlo_pass_interface.h"
+#include "tensorflow/compiler/xla/statusor.h"
+
+namespace xla {
+
+// Runs a collective combiner pass with the combine threshold in bytes that
+// works best for the module. Each candidate threshold is tried on a clone of
+// the module, whose cost, typically the communication time that is not
+// overlapped with computation, is estimated by `cost_fn`. The combiner is
+// then run on the module with the threshold of the lowest cost, the first
+// candidate among equal ones.
+class CollectiveCombinerAutotuner : public HloModulePass {
+ public:
+  // Returns the combiner pass with the given threshold.
+  using CombinerFactory =
+      std::function<std::unique_ptr<HloModulePass>(int64_t threshold_bytes)>;
+  // Returns the cost of a module the combiner ran on. The module may be
+  // modified.
+  using CostFunction = std::function<StatusOr<double>(HloModule*)>;
+
+  CollectiveCombinerAutotuner(CombinerFactory combiner_factory,
+                              std::vector<int64_t> candidate_thresholds,
+                              CostFunction cost_fn);
+
+  absl::string_view name() const override { return name_; }
+
+  using HloPassInterface::Run;
+  StatusOr<bool> Run(
+      HloModule* module,
+      const absl::flat_hash_set<absl::string_view>& execution_threads) override;
+
+  // Returns the candidate thresholds `max_threshold_bytes` / 2^i for i in
+  // [0, num_candidates), stopping at `min_threshold_bytes`.
+  static std::vector<int64_t> HalvingCandidates(int64_t max_threshold_bytes,
+                                                int64_t min_threshold_bytes,
+                                                int num_candidates);
+
+ private:
+  CombinerFactory combiner_factory_;
+  std::vector<int64_t> candidate_thresholds_;
+  CostFunction cost_fn_;
+  std::string name_;
+};
+
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_COLLECTIVE_COMBINER_AUTOTUNER_H_
@@ -0,0 +1,128 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/collective_combiner_autotuner.h"
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/compiler/xla/hlo/ir/hlo_computation.h"
+#include "tensorflow/compiler/xla/hlo/ir/hlo_opcode.h"
+#include "tensorflow/compiler/xla/service/all_reduce_combiner.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/compiler/xla/tests/hlo_test_base.h"
+
+namespace xla {
+namespace {
+
+using CollectiveCombinerAutotunerTest = HloTestBase;
+
+constexpr char kHloString[] = R"(
+HloModule Module
+
+summit {
+  lhs = f32[] parameter(0)
+  rhs = f32[] parameter(1)
+  ROOT add = f32[] add(lhs, rhs)
+}
+
+ENTRY entry {
+  p0 = f32[256] parameter(0)
+  p1 = f32[256] parameter(1)
+  p2 = f32[256] parameter(2)
+  p3 = f32[256] parameter(3)
+  ar0 = f32[256] all-reduce(p0), replica_groups={}, to_apply=summit
+  ar1 = f32[256] all-reduce(p1), replica_groups={}, to_apply=summit
+  ar2 = f32[256] all-reduce(p2), replica_groups={}, to_apply=summit
+  ar3 = f32[256] all-reduce(p3), replica_groups={}, to_apply=summit
+  ROOT tuple = (f32[256], f32[256], f32[256], f32[256])
+    tuple(ar0, ar1, ar2, ar3)
+}
+)";
+
+std::vector<const HloInstruction*> AllReduces(const HloModule& module) {
+  std::vector<const HloInstruction*> all_reduces;
+  for (const HloInstruction* instr :
+       module.entry_computation()->instructions()) {
+    if (instr->opcode() == HloOpcode::kAllReduce) {
+      all_reduces.push_back(instr);
+    }
+  }
+  return all_reduces;
+}
+
+std::unique_ptr<HloModulePass> MakeCombiner(int64_t threshold_bytes) {
+  return std::make_unique<AllReduceCombiner>(threshold_bytes,
+                                             /*combine_threshold_count=*/256);
+}
+
+// A fixed cost per all-reduce, plus a penalty for all-reduces larger than
+// 2KiB.
+StatusOr<double> Cost(HloModule* module) {
+  double cost = 0;
+  for (const HloInstruction* all_reduce : AllReduces(*module)) {
+    int64_t bytes = 0;
+    ShapeUtil::ForEachSubshape(
+        all_reduce->shape(), [&](const Shape& subshape, const ShapeIndex&) {
+          if (subshape.IsArray()) bytes += ShapeUtil::ByteSizeOf(subshape);
+        });
+    cost += bytes > 2048 ? 1100 : 100;
+  }
+  return cost;
+}
+
+TEST_F(CollectiveCombinerAutotunerTest, PicksCheapestThreshold) {
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(kHloString));
+  std::vector<int64_t> evaluated;
+  CollectiveCombinerAutotuner autotuner(
+      MakeCombiner, {4096, 2048, 1024}, [&](HloModule* module) {
+        evaluated.push_back(AllReduces(*module).size());
+        return Cost(module);
+      });
+  EXPECT_EQ(autotuner.name(), "all-reduce-combiner-autotuner");
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, RunHloPass(&autotuner, module.get()));
+  EXPECT_TRUE(changed);
+  // Each candidate was evaluated on a clone, combining into 1, 2 and 4
+  // all-reduces.
+  EXPECT_EQ(evaluated, std::vector<int64_t>({1, 2, 4}));
+  EXPECT_EQ(AllReduces(*module).size(), 2);
+}
+
+TEST_F(CollectiveCombinerAutotunerTest, SingleCandidateIsNotEvaluated) {
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(kHloString));
+  CollectiveCombinerAutotuner autotuner(
+      MakeCombiner, {4096}, [](HloModule*) -> StatusOr<double> {
+        ADD_FAILURE() << "Unexpected evaluation";
+        return 0.0;
+      });
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, RunHloPass(&autotuner, module.get()));
+  EXPECT_TRUE(changed);
+  EXPECT_EQ(AllReduces(*module).size(), 1);
+}
+
+TEST_F(CollectiveCombinerAutotunerTest, HalvingCandidates) {
+  EXPECT_EQ(CollectiveCombinerAutotuner::HalvingCandidates(1024, 256, 8),
+            std::vector<int64_t>({1024, 512, 256}));
+  EXPECT_EQ(CollectiveCombinerAutotuner::HalvingCandidates(1024, 1, 2),
+            std::vector<int64_t>({1024, 512}));
+  EXPECT_EQ(CollectiveCombinerAutotuner::HalvingCandidates(100, 256, 8),
+            std::vector<int64_t>({100}));
+}
+
+}  // namespace
+}  // namespace xla
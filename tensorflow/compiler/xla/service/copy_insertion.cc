@@ -1813,19 +1813,17 @@ Status CopyInsertion::AddCopiesForConditional(
 // live-range interference. Generally interference can only occur around kWhile
 // instructions which have update-in-place semantics.
 Status CopyInsertion::AddCopiesToResolveInterference(
-    HloModule* module,
+    const HloAliasAnalysis& alias_analysis, HloModule* module,
     const absl::flat_hash_set<absl::string_view>& execution_threads) {
-  TF_ASSIGN_OR_RETURN(std::unique_ptr<HloAliasAnalysis> alias_analysis,
-                      HloAliasAnalysis::Run(module, can_share_buffer_));
   for (HloComputation* computation :
        module->MakeNonfusionComputations(execution_threads)) {
     for (HloInstruction* instruction :
          computation->MakeInstructionPostOrder()) {
       if (instruction->opcode() == HloOpcode::kWhile) {
-        TF_RETURN_IF_ERROR(AddCopiesForWhile(*alias_analysis, instruction));
+        TF_RETURN_IF_ERROR(AddCopiesForWhile(alias_analysis, instruction));
       } else if (instruction->opcode() == HloOpcode::kConditional) {
         TF_RETURN_IF_ERROR(
-            AddCopiesForConditional(*alias_analysis, instruction));
+            AddCopiesForConditional(alias_analysis, instruction));
       } else {
         // When an operand is a tuple, we avoid copying the operand multiple
         // times by recording and checking the operand number of operands that
@@ -1866,7 +1864,7 @@ Status CopyInsertion::AddCopiesToResolveInterference(
           }
           copied_operands.insert(operand_index.operand_number);
           TF_RETURN_IF_ERROR(AddCopiesForInPlaceOperation(
-              *alias_analysis, instruction, operand_index.operand_number));
+              alias_analysis, instruction, operand_index.operand_number));
         }
       }
     }
@@ -2054,15 +2052,23 @@ static int64_t GetNumExistingCopies(
 Status CopyInsertion::RemoveUnnecessaryCopies(
     HloOrdering* ordering, HloModule* module, bool check_live_range_ordering,
     const absl::flat_hash_set<absl::string_view>& execution_threads) {
-  XLA_VLOG_LINES(4, module->ToString());
   TF_ASSIGN_OR_RETURN(std::unique_ptr<HloAliasAnalysis> alias_analysis,
                       HloAliasAnalysis::Run(module, can_share_buffer_));
-  CopyRemover copy_remover(*module, *alias_analysis, ordering,
+  return RemoveUnnecessaryCopies(*alias_analysis, ordering, module,
+                                 check_live_range_ordering, execution_threads);
+}
+
+Status CopyInsertion::RemoveUnnecessaryCopies(
+    const HloAliasAnalysis& alias_analysis, HloOrdering* ordering,
+    HloModule* module, bool check_live_range_ordering,
+    const absl::flat_hash_set<absl::string_view>& execution_threads) {
+  XLA_VLOG_LINES(4, module->ToString());
+  CopyRemover copy_remover(*module, alias_analysis, ordering,
                            check_live_range_ordering);
   if (VLOG_IS_ON(3)) {
     LOG(INFO) << "Removing unnecessary copies in " << module->name();
     LOG(INFO) << "Buffer values, in dependency order: ";
-    for (const HloBuffer& buffer : alias_analysis->buffers()) {
+    for (const HloBuffer& buffer : alias_analysis.buffers()) {
       LOG(INFO) << "    HloBuffer " << buffer.id();
     }
   }
@@ -2151,7 +2157,14 @@ StatusOr<bool> CopyInsertion::Run(
 
   int64_t num_copies_before = GetNumExistingCopies(module, execution_threads);
 
-  TF_RETURN_IF_ERROR(AddCopiesToResolveInterference(module, execution_threads));
+  // The alias analysis is shared by the steps below until one of them changes
+  // the module. Adding copies only ever adds instructions.
+  TF_ASSIGN_OR_RETURN(std::unique_ptr<HloAliasAnalysis> alias_analysis,
+                      HloAliasAnalysis::Run(module, can_share_buffer_));
+  const int64_t num_instructions_before = module->instruction_count();
+  TF_RETURN_IF_ERROR(AddCopiesToResolveInterference(*alias_analysis, module,
+                                                    execution_threads));
+  bool module_changed = module->instruction_count() != num_instructions_before;
 
   // Simplify the tuple structures introduced by the deep copies. This should be
   // done before removing copies (RemoveUnnecessaryCopies) because tuple
@@ -2160,13 +2173,21 @@ StatusOr<bool> CopyInsertion::Run(
   // instructions introduced by tuple simplification.
   TupleSimplifier tuple_simplifier;
   HloDCE dce;
-  TF_RETURN_IF_ERROR(tuple_simplifier.Run(module, execution_threads).status());
-  TF_RETURN_IF_ERROR(dce.Run(module, execution_threads).status());
+  TF_ASSIGN_OR_RETURN(bool simplified,
+                      tuple_simplifier.Run(module, execution_threads));
+  module_changed |= simplified;
+  TF_ASSIGN_OR_RETURN(bool removed_dead_code,
+                      dce.Run(module, execution_threads));
+  module_changed |= removed_dead_code;
   DumpHloModuleDuringPassIfEnabled(
       name(), "after adding copies to resolve interference", *module);
 
+  if (module_changed) {
+    TF_ASSIGN_OR_RETURN(alias_analysis,
+                        HloAliasAnalysis::Run(module, can_share_buffer_));
+  }
   DependencyHloOrdering ordering(module);
-  TF_RETURN_IF_ERROR(RemoveUnnecessaryCopies(&ordering, module,
+  TF_RETURN_IF_ERROR(RemoveUnnecessaryCopies(*alias_analysis, &ordering, module,
                                              /*check_live_range_ordering=*/true,
                                              execution_threads));
   DumpHloModuleDuringPassIfEnabled(name(), "after removing unnecessary copies",
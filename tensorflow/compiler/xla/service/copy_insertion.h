@@ -108,8 +108,16 @@ class CopyInsertion : public HloModulePass {
 
  private:
   Status AddCopiesToResolveInterference(
-      HloModule* module,
+      const HloAliasAnalysis& alias_analysis, HloModule* module,
       const absl::flat_hash_set<absl::string_view>& execution_threads);
+
+  // Same as the public RemoveUnnecessaryCopies, but uses `alias_analysis`,
+  // which must be up to date with `module`.
+  Status RemoveUnnecessaryCopies(
+      const HloAliasAnalysis& alias_analysis, HloOrdering* ordering,
+      HloModule* module, bool check_live_range_ordering,
+      const absl::flat_hash_set<absl::string_view>& execution_threads);
+
   int64_t use_region_based_live_range_analysis_;
 };
 
@@ -616,7 +616,16 @@ Status CpuCompiler::RunHloPassesThroughLayoutAssn(
   HloPassPipeline pipeline("HLO passes through layout assignment");
   AddHloVerifier(&pipeline, allow_sparse_shapes_);
 
-  pipeline.AddPass<OperandUpcaster>();
+  // S8 x S8 -> S32 dots that are lowered to a runtime GEMM read their S8
+  // operands directly, which saves materializing them as S32.
+  HloPredicate upcast_filter = nullptr;
+  if (!is_mlir_compile) {
+    upcast_filter = [target_machine_features](const HloInstruction* instr) {
+      return !DotImplementationCanHandleS8Operands(*instr,
+                                                   *target_machine_features);
+    };
+  }
+  pipeline.AddPass<OperandUpcaster>(upcast_filter);
   pipeline.AddPass<ResultCaster>();
 
   // Expand random number generation.
@@ -783,6 +792,10 @@ Status CpuCompiler::RunHloPassesThroughLayoutAssn(
   pipeline.AddPass<OptimizationBarrierExpander>();
   pipeline.AddPass<TupleSimplifier>();
 
+  // Upcast the operands of any S8 dot that the passes above rewrote into a
+  // form the runtime GEMM doesn't handle.
+  pipeline.AddPass<OperandUpcaster>(upcast_filter);
+
   // Layout assignment uses alias analysis, which requires the call graph to be
   // flattened.
   pipeline.AddPass<FlattenCallGraph>();
@@ -1402,7 +1415,22 @@ CpuCompiler::CompileLegacyCpuExecutable(std::unique_ptr<HloModule> module) {
   // JIT compile the LLVM IR module to in-memory machine code.
   llvm::orc::ThreadSafeModule thread_safe_module(std::move(llvm_module),
                                                  std::move(llvm_context));
-  cantFail((*jit)->AddModule(std::move(thread_safe_module)));
+  const int parallel_codegen_split_count =
+      module->config().debug_options().xla_cpu_parallel_codegen_split_count();
+  // The IR and object file hooks expect to see the whole module, so only split
+  // it when there are none.
+  if (parallel_codegen_split_count > 1 &&
+      !DumpingEnabledForHloModule(*module) && !user_pre_optimization_hook_ &&
+      !user_post_optimization_hook_) {
+    XLA_SCOPED_LOGGING_TIMER("CpuCompiler - Parallel LLVM codegen");
+    if (auto error = (*jit)->AddModuleInParallel(
+            std::move(thread_safe_module), parallel_codegen_split_count)) {
+      return InternalError("Parallel LLVM codegen failed: %s",
+                           llvm::toString(std::move(error)));
+    }
+  } else {
+    cantFail((*jit)->AddModule(std::move(thread_safe_module)));
+  }
 
   auto cpu_executable = std::make_unique<CpuExecutable>(
       std::move(*jit), std::move(assignment), std::move(module), function_name,
@@ -47,6 +47,13 @@ Status CpuTransferManager::TransferLiteralToInfeed(
   return TransferLiteralToInfeedOnCpu(executor->device_ordinal(), literal);
 }
 
+Status CpuTransferManager::TransferBorrowedLiteralToInfeed(
+    se::StreamExecutor* executor, const LiteralSlice& literal,
+    std::function<void()> on_done_with_literal) {
+  return TransferBorrowedLiteralToInfeedOnCpu(
+      executor->device_ordinal(), literal, std::move(on_done_with_literal));
+}
+
 Status CpuTransferManager::TransferLiteralFromOutfeed(
     se::StreamExecutor* executor, MutableBorrowingLiteral literal) {
   return TransferLiteralFromOutfeedOnCpu(executor->device_ordinal(), literal);
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_XLA_SERVICE_CPU_CPU_TRANSFER_MANAGER_H_
 #define TENSORFLOW_COMPILER_XLA_SERVICE_CPU_CPU_TRANSFER_MANAGER_H_
 
+#include <functional>
 #include <vector>
 
 #include "absl/types/span.h"
@@ -39,6 +40,9 @@ class CpuTransferManager : public GenericTransferManager {
 
   Status TransferLiteralToInfeed(se::StreamExecutor* executor,
                                  const LiteralSlice& literal) override;
+  Status TransferBorrowedLiteralToInfeed(
+      se::StreamExecutor* executor, const LiteralSlice& literal,
+      std::function<void()> on_done_with_literal) override;
   Status TransferLiteralFromOutfeed(se::StreamExecutor* executor,
                                     MutableBorrowingLiteral literal) override;
 
@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/cpu/cpu_xfeed.h"
 
 #include <cstring>
+#include <functional>
 #include <limits>
 #include <memory>
 #include <string>
@@ -24,6 +25,7 @@ limitations under the License.
 
 #include "absl/base/casts.h"
 #include "absl/cleanup/cleanup.h"
+#include "absl/functional/function_ref.h"
 #include "tensorflow/compiler/xla/literal.h"
 #include "tensorflow/compiler/xla/literal_util.h"
 #include "tensorflow/compiler/xla/service/cpu/cpu_runtime.h"
@@ -57,6 +59,27 @@ class CpuInfeedBuffer : public cpu::runtime::XfeedBuffer {
   char* buffer_;
 };
 
+// An infeed buffer pointing to memory owned by the caller. `owner` is shared by
+// all the buffers borrowing from the same literal, and releases it once the
+// last of them is done.
+class BorrowedCpuInfeedBuffer : public cpu::runtime::XfeedBuffer {
+ public:
+  BorrowedCpuInfeedBuffer(int32_t length, const void* data,
+                          std::shared_ptr<void> owner)
+      : length_(length),
+        data_(const_cast<void*>(data)),
+        owner_(std::move(owner)) {}
+
+  int32_t length() override { return length_; }
+  void* data() override { return data_; }
+  void Done(StatusOr<Shape> /*shape*/) override { delete this; }
+
+ private:
+  int32_t length_;
+  void* data_;
+  std::shared_ptr<void> owner_;
+};
+
 class CpuOutfeedBuffer : public cpu::runtime::XfeedBuffer {
  public:
   CpuOutfeedBuffer(void* destination, int32_t length)
@@ -81,10 +104,7 @@ class CpuOutfeedBuffer : public cpu::runtime::XfeedBuffer {
   tsl::Notification done_;
 };
 
-// Transfers infeed data to device. InfeedBuffer->Done() must be called to
-// clean up the memory allocated for InfeedBuffer.
-StatusOr<cpu::runtime::XfeedBuffer*> TransferBufferToInfeedInternal(
-    int64_t size, const void* source) {
+Status ValidateInfeedSize(int64_t size) {
   if (size > std::numeric_limits<int32_t>::max()) {
     return InvalidArgument("CPU infeed of %d bytes exceeds maximum of %d bytes",
                            size, std::numeric_limits<int32_t>::max());
@@ -94,6 +114,14 @@ StatusOr<cpu::runtime::XfeedBuffer*> TransferBufferToInfeedInternal(
     return InvalidArgument("Infeed shape must have positive size; got %d",
                            size);
   }
+  return OkStatus();
+}
+
+// Transfers infeed data to device. InfeedBuffer->Done() must be called to
+// clean up the memory allocated for InfeedBuffer.
+StatusOr<cpu::runtime::XfeedBuffer*> TransferBufferToInfeedInternal(
+    int64_t size, const void* source) {
+  TF_RETURN_IF_ERROR(ValidateInfeedSize(size));
 
   auto size_32 = static_cast<int32_t>(size);
   auto queued_buffer = new CpuInfeedBuffer(size_32);
@@ -102,18 +130,6 @@ StatusOr<cpu::runtime::XfeedBuffer*> TransferBufferToInfeedInternal(
   return queued_buffer;
 }
 
-Status TransferBufferToInfeed(int device_ordinal, int64_t size,
-                              const void* source) {
-  TF_ASSIGN_OR_RETURN(cpu::runtime::XfeedBuffer * buffer,
-                      TransferBufferToInfeedInternal(size, source));
-
-  cpu::runtime::XfeedManager* xfeed_manager =
-      cpu::runtime::GetXfeedManager(device_ordinal);
-  xfeed_manager->infeed()->EnqueueBuffersAtomically({buffer});
-
-  return OkStatus();
-}
-
 StatusOr<Shape> TransferBuffersFromOutfeedInternal(
     int device_ordinal, absl::Span<const std::pair<void*, int64_t>> buffer_data,
     bool is_tuple) {
@@ -173,17 +189,26 @@ StatusOr<Shape> TransferTupleBuffersFromOutfeed(
   return TransferBuffersFromOutfeedInternal(device_ordinal, buffer_data,
                                             /*is_tuple=*/true);
 }
-}  // namespace
 
-Status TransferLiteralToInfeedOnCpu(int device_ordinal,
-                                    const LiteralSlice& literal) {
+// Enqueues the buffers of `literal` on the infeed of the device, creating an
+// infeed buffer for each array in `literal` with `make_buffer`.
+Status EnqueueLiteralOnInfeed(
+    int device_ordinal, const LiteralSlice& literal,
+    absl::FunctionRef<StatusOr<cpu::runtime::XfeedBuffer*>(int64_t size,
+                                                           const void* source)>
+        make_buffer) {
   const Shape& shape = literal.shape();
   VLOG(2) << "Transferring literal to infeed with shape: "
           << ShapeUtil::HumanString(shape);
 
   if (!shape.IsTuple()) {
     int64_t size = cpu::runtime::GetByteSizeRequirement(shape, sizeof(void*));
-    return TransferBufferToInfeed(device_ordinal, size, literal.untyped_data());
+    TF_ASSIGN_OR_RETURN(cpu::runtime::XfeedBuffer * buffer,
+                        make_buffer(size, literal.untyped_data()));
+    cpu::runtime::XfeedManager* xfeed_manager =
+        cpu::runtime::GetXfeedManager(device_ordinal);
+    xfeed_manager->infeed()->EnqueueBuffersAtomically({buffer});
+    return OkStatus();
   }
 
   if (ShapeUtil::IsNestedTuple(shape)) {
@@ -207,9 +232,9 @@ Status TransferLiteralToInfeedOnCpu(int device_ordinal,
     const Shape& tuple_element_shape = ShapeUtil::GetSubshape(shape, {i});
     int64_t tuple_element_size = cpu::runtime::GetByteSizeRequirement(
         tuple_element_shape, sizeof(void*));
-    TF_ASSIGN_OR_RETURN(cpu::runtime::XfeedBuffer * buffer,
-                        TransferBufferToInfeedInternal(
-                            tuple_element_size, literal.untyped_data({i})));
+    TF_ASSIGN_OR_RETURN(
+        cpu::runtime::XfeedBuffer * buffer,
+        make_buffer(tuple_element_size, literal.untyped_data({i})));
     buffers.push_back(buffer);
   }
 
@@ -220,6 +245,34 @@ Status TransferLiteralToInfeedOnCpu(int device_ordinal,
   std::move(cleanup).Cancel();
   return OkStatus();
 }
+}  // namespace
+
+Status TransferLiteralToInfeedOnCpu(int device_ordinal,
+                                    const LiteralSlice& literal) {
+  return EnqueueLiteralOnInfeed(device_ordinal, literal,
+                                TransferBufferToInfeedInternal);
+}
+
+Status TransferBorrowedLiteralToInfeedOnCpu(
+    int device_ordinal, const LiteralSlice& literal,
+    std::function<void()> on_done_with_literal) {
+  // Calls `on_done_with_literal` once the last infeed buffer borrowing from
+  // the literal is done, or when the transfer fails.
+  std::shared_ptr<void> owner(
+      nullptr, [on_done = std::move(on_done_with_literal)](void*) {
+        if (on_done) {
+          on_done();
+        }
+      });
+  return EnqueueLiteralOnInfeed(
+      device_ordinal, literal,
+      [&owner](int64_t size,
+               const void* source) -> StatusOr<cpu::runtime::XfeedBuffer*> {
+        TF_RETURN_IF_ERROR(ValidateInfeedSize(size));
+        return new BorrowedCpuInfeedBuffer(static_cast<int32_t>(size), source,
+                                           owner);
+      });
+}
 
 Status TransferLiteralFromOutfeedOnCpu(int device_ordinal,
                                        MutableBorrowingLiteral literal) {
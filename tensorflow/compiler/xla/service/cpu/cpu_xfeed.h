@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_XLA_SERVICE_CPU_CPU_XFEED_H_
 #define TENSORFLOW_COMPILER_XLA_SERVICE_CPU_CPU_XFEED_H_
 
+#include <functional>
 #include <vector>
 
 #include "tensorflow/compiler/xla/literal.h"
@@ -33,6 +34,13 @@ namespace xla {
 Status TransferLiteralToInfeedOnCpu(int device_ordinal,
                                     const LiteralSlice& literal);
 
+// Like TransferLiteralToInfeedOnCpu, but the infeed reads directly from the
+// memory of `literal` instead of a copy of it. The memory must stay valid until
+// `on_done_with_literal` is called, once the infeed has consumed it.
+Status TransferBorrowedLiteralToInfeedOnCpu(
+    int device_ordinal, const LiteralSlice& literal,
+    std::function<void()> on_done_with_literal);
+
 // Helper function to transfers from outfeed on CPU.
 Status TransferLiteralFromOutfeedOnCpu(int device_ordinal,
                                        MutableBorrowingLiteral literal);
@@ -807,6 +807,8 @@ Status DotOpEmitter::EmitCallToRuntime() {
   llvm::Function* function = b_->GetInsertBlock()->getParent();
   llvm::Module* module = function->getParent();
   llvm::Type* float_type;
+  // The type of the operands, if it differs from the type of the result.
+  llvm::Type* operand_type = nullptr;
   const char* fn_name;
   switch (type) {
     case F16:
@@ -848,23 +850,34 @@ Status DotOpEmitter::EmitCallToRuntime() {
       float_type = llvm_ir::PrimitiveTypeToIrType(C128, module);
       break;
     case S32:
-      fn_name = multi_threaded
-                    ? runtime::kEigenMatMulS32SymbolName
-                    : runtime::kEigenSingleThreadedMatMulS32SymbolName;
+      if (lhs_array_.GetShape().element_type() == S8) {
+        fn_name = multi_threaded
+                      ? runtime::kEigenMatMulS8S32SymbolName
+                      : runtime::kEigenSingleThreadedMatMulS8S32SymbolName;
+        operand_type = b_->getInt8Ty();
+      } else {
+        fn_name = multi_threaded
+                      ? runtime::kEigenMatMulS32SymbolName
+                      : runtime::kEigenSingleThreadedMatMulS32SymbolName;
+      }
       float_type = b_->getInt32Ty();
       break;
     default:
       return Unimplemented("Invalid type %s for dot operation",
                            PrimitiveType_Name(type));
   }
+  if (operand_type == nullptr) {
+    operand_type = float_type;
+  }
 
   llvm::Type* float_ptr_type = float_type->getPointerTo();
+  llvm::Type* operand_ptr_type = operand_type->getPointerTo();
   llvm::Type* int64_type = b_->getInt64Ty();
   llvm::Type* int32_type = b_->getInt32Ty();
   llvm::Type* int8_ptr_type = b_->getInt8Ty()->getPointerTo();
   llvm::FunctionType* matmul_type = llvm::FunctionType::get(
       b_->getVoidTy(),
-      {int8_ptr_type, float_ptr_type, float_ptr_type, float_ptr_type,
+      {int8_ptr_type, float_ptr_type, operand_ptr_type, operand_ptr_type,
        int64_type, int64_type, int64_type, int32_type, int32_type},
       /*isVarArg=*/false);
 
@@ -906,8 +919,8 @@ Status DotOpEmitter::EmitCallToRuntime() {
       matmul_func,
       {b_->CreateBitCast(executable_run_options_value_, int8_ptr_type),
        b_->CreateBitCast(target_array_.GetBasePointer(), float_ptr_type),
-       b_->CreateBitCast(lhs->GetBasePointer(), float_ptr_type),
-       b_->CreateBitCast(rhs->GetBasePointer(), float_ptr_type),
+       b_->CreateBitCast(lhs->GetBasePointer(), operand_ptr_type),
+       b_->CreateBitCast(rhs->GetBasePointer(), operand_ptr_type),
        b_->getInt64(mat_mult_dims.m), b_->getInt64(mat_mult_dims.n),
        b_->getInt64(mat_mult_dims.k), b_->getInt32(transpose_lhs),
        b_->getInt32(transpose_rhs)});
@@ -1481,6 +1494,29 @@ bool DotImplementationCanHandleTranspose(
          impl_strategy == DotImplementationStrategy::kEigen;
 }
 
+bool DotImplementationCanHandleS8Operands(
+    const HloInstruction& dot_instr,
+    const TargetMachineFeatures& target_machine_features) {
+  if (dot_instr.opcode() != HloOpcode::kDot || IsBatchDot(dot_instr) ||
+      dot_instr.shape().element_type() != S32 ||
+      dot_instr.operand(0)->shape().element_type() != S8 ||
+      dot_instr.operand(1)->shape().element_type() != S8) {
+    return false;
+  }
+  for (int precision : dot_instr.precision_config().operand_precision()) {
+    if (precision == PrecisionConfig::PACKED_NIBBLE) {
+      return false;
+    }
+  }
+
+  // Only the Eigen runtime widens S8 operands itself; the LLVM IR emitters
+  // expect the operands to already have the result type.
+  DotImplementationStrategy impl_strategy =
+      GetDotImplementationStrategy(dot_instr.GetModule()->config(),
+                                   DotInfo(dot_instr), target_machine_features);
+  return impl_strategy == DotImplementationStrategy::kEigen;
+}
+
 bool DotOperandsAndResultMustHaveRowMajorLayout(
     const HloInstruction& dot_instr,
     const TargetMachineFeatures& target_machine_features) {
@@ -42,6 +42,13 @@ bool DotImplementationCanHandleTranspose(
     const HloInstruction& dot_instr,
     const TargetMachineFeatures& target_machine_features);
 
+// Returns true if `dot_instr` multiplies S8 operands into an S32 result with a
+// lowering that reads the S8 operands directly, so that they do not have to be
+// upcast to S32 first.
+bool DotImplementationCanHandleS8Operands(
+    const HloInstruction& dot_instr,
+    const TargetMachineFeatures& target_machine_features);
+
 // Returns the index for an operand to `hlo` that should ideally be column
 // major.  Returns nullopt if there is no such operand or if `hlo` is not a dot
 // or a fusion containing a dot.
@@ -868,10 +868,13 @@ Status IrEmitter::HandleSelectAndScatter(HloInstruction* select_and_scatter) {
 Status IrEmitter::HandleDot(HloInstruction* dot) {
   auto lhs = dot->operand(0);
   auto rhs = dot->operand(1);
-  TF_RETURN_IF_ERROR(ElementTypesSameAndSupported(
-      /*instruction=*/*dot, /*operands=*/{lhs, rhs},
-      /*supported_types=*/
-      {PRED, S8, U8, S16, U16, S32, U32, S64, U64, F16, F32, F64, C64, C128}));
+  if (!DotImplementationCanHandleS8Operands(*dot, target_machine_features_)) {
+    TF_RETURN_IF_ERROR(ElementTypesSameAndSupported(
+        /*instruction=*/*dot, /*operands=*/{lhs, rhs},
+        /*supported_types=*/
+        {PRED, S8, U8, S16, U16, S32, U32, S64, U64, F16, F32, F64, C64,
+         C128}));
+  }
   const DotDimensionNumbers& dnums = dot->dot_dimension_numbers();
 
   if (dnums.lhs_contracting_dimensions_size() != 1) {
@@ -2086,6 +2089,45 @@ Status IrEmitter::HandleDynamicSlice(HloInstruction* dynamic_slice) {
   return DefaultAction(dynamic_slice);
 }
 
+namespace {
+// Reports that `instruction`, a dynamic-update-slice or a fusion rooted at
+// one, copies its whole result because its buffer is not shared with the
+// buffer of `operand` at `index` that it updates. Large copies are logged as
+// warnings since they are usually loop-carried buffers, such as KV caches,
+// that are copied on every iteration.
+void ReportDynamicUpdateSliceNotInPlace(const HloInstruction* instruction,
+                                        const HloInstruction* operand,
+                                        const ShapeIndex& index,
+                                        const BufferAssignment& assignment) {
+  constexpr int64_t kWarningBytes = 1 << 20;
+  std::string reason;
+  if (!assignment.HasAllocationAt(instruction, {})) {
+    reason = "its result does not have a unique buffer";
+  } else if (!assignment.HasAllocationAt(operand, index)) {
+    reason = absl::StrCat("operand ", operand->name(), index.ToString(),
+                          " does not have a unique buffer");
+  } else {
+    reason = absl::StrCat(
+        "its result is in ",
+        assignment.GetUniqueTopLevelSlice(instruction)->ToString(),
+        " but operand ", operand->name(), index.ToString(), " is in ",
+        assignment.GetUniqueSlice(operand, index)->ToString(),
+        ", so the operand is live after the update or cannot share its buffer "
+        "with the result");
+  }
+  const std::string message =
+      absl::StrCat(instruction->name(), " updates ",
+                   ShapeUtil::HumanStringWithLayout(instruction->shape()),
+                   " out of place: ", reason);
+  if (instruction->shape().IsArray() &&
+      ShapeUtil::ByteSizeOf(instruction->shape()) >= kWarningBytes) {
+    LOG(WARNING) << message;
+  } else {
+    VLOG(1) << message;
+  }
+}
+}  // namespace
+
 Status IrEmitter::HandleDynamicUpdateSlice(
     HloInstruction* dynamic_update_slice) {
   auto update = dynamic_update_slice->operand(1);
@@ -2100,6 +2142,8 @@ Status IrEmitter::HandleDynamicUpdateSlice(
         operands, GetIrArrayFor(dynamic_update_slice),
         IrName(dynamic_update_slice, "in_place"), &b_);
   }
+  ReportDynamicUpdateSliceNotInPlace(
+      dynamic_update_slice, dynamic_update_slice->operand(0), {}, assignment_);
   return DefaultAction(dynamic_update_slice);
 }
 
@@ -2174,7 +2218,17 @@ Status IrEmitter::HandlePad(HloInstruction* pad) {
 
 Status IrEmitter::HandleFusion(HloInstruction* fusion) {
   auto* root = fusion->fused_expression_root();
-  if (llvm_ir::CanEmitFusedDynamicUpdateSliceInPlace(fusion, assignment_)) {
+  const bool dynamic_update_slice_in_place =
+      llvm_ir::CanEmitFusedDynamicUpdateSliceInPlace(fusion, assignment_);
+  if (!dynamic_update_slice_in_place &&
+      llvm_ir::MayBeImplementedAsInPlaceDynamicUpdateSlice(fusion)) {
+    auto [fused_parameter, index] =
+        root->operand(0)->LatestNonGteAncestorAndIndex();
+    ReportDynamicUpdateSliceNotInPlace(
+        fusion, fusion->operand(fused_parameter->parameter_number()), index,
+        assignment_);
+  }
+  if (dynamic_update_slice_in_place) {
     VLOG(3) << "HandleFusion FusedDynamicUpdateSliceInPlace";
     CpuElementalIrEmitter elemental_emitter(hlo_module_config_, this, module_);
     FusedIrEmitter fused_emitter(elemental_emitter);
@@ -17,7 +17,11 @@ limitations under the License.
 
 #include <algorithm>
 #include <memory>
+#include <optional>
+#include <string>
+#include <utility>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/strings/str_cat.h"
 #include "tensorflow/compiler/xla/hlo/ir/hlo_computation.h"
 #include "tensorflow/compiler/xla/hlo/ir/hlo_instruction.h"
@@ -26,6 +30,8 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/cpu/ir_emission_utils.h"
 #include "tensorflow/compiler/xla/service/cpu/shape_partition.h"
 #include "tensorflow/compiler/xla/service/llvm_ir/dynamic_update_slice_util.h"
+#include "tensorflow/tsl/platform/protobuf.h"
+#include "tensorflow/tsl/profiler/protobuf/profiled_instructions.pb.h"
 
 namespace xla {
 namespace cpu {
@@ -109,6 +115,71 @@ class DefaultCostModel : public ParallelCostModel {
   const std::unique_ptr<HloCostAnalysis> cost_analysis_;
 };
 
+// Cost model based on measured instruction costs, e.g. from a profile of a
+// previous run of the module. Instructions that were not measured are handed to
+// `fallback_cost_model`.
+class ProfileGuidedCostModel : public ParallelCostModel {
+ public:
+  ProfileGuidedCostModel(
+      const int64_t max_parallelism,
+      const tensorflow::profiler::ProfiledInstructionsProto& profile,
+      std::unique_ptr<ParallelCostModel> fallback_cost_model)
+      : max_parallelism_(max_parallelism),
+        fallback_cost_model_(std::move(fallback_cost_model)) {
+    for (const auto& cost : profile.costs()) {
+      costs_us_[cost.name()] = cost.cost_us();
+    }
+  }
+  ~ProfileGuidedCostModel() override {}
+
+  int64_t GetParallelTaskCount(HloInstruction* instruction) override {
+    auto it = costs_us_.find(instruction->name());
+    if (it == costs_us_.end()) {
+      return fallback_cost_model_->GetParallelTaskCount(instruction);
+    }
+    // Minimum per-thread cost, so that each task amortizes the cost of forking
+    // and joining it.
+    constexpr double kMinCostPerThreadUs = 50.0;
+    // Return target parallel task count in [1, max_parallelism_].
+    return std::min(max_parallelism_,
+                    std::max(int64_t{1}, static_cast<int64_t>(
+                                             it->second / kMinCostPerThreadUs)));
+  }
+
+ private:
+  const int64_t max_parallelism_;
+  const std::unique_ptr<ParallelCostModel> fallback_cost_model_;
+  // Measured cost of each instruction, keyed by instruction name.
+  absl::flat_hash_map<std::string, double> costs_us_;
+};
+
+namespace {
+
+// Parses the profile of `module`, which may be a binary or text
+// ProfiledInstructionsProto, if it has one.
+std::optional<tensorflow::profiler::ProfiledInstructionsProto> ReadFdoProfile(
+    const HloModule& module) {
+  absl::string_view fdo_profile = module.config().fdo_profile();
+  if (fdo_profile.empty()) {
+    return std::nullopt;
+  }
+  tensorflow::profiler::ProfiledInstructionsProto profile;
+  if (tsl::ParseProtoUnlimited(&profile, fdo_profile.data(),
+                               fdo_profile.size())) {
+    return profile;
+  }
+  profile.Clear();
+  if (tsl::protobuf::TextFormat::ParseFromString(std::string(fdo_profile),
+                                                 &profile)) {
+    return profile;
+  }
+  LOG(ERROR) << "Unable to parse FDO profile: not a valid text or binary "
+                "ProfiledInstructionsProto";
+  return std::nullopt;
+}
+
+}  // namespace
+
 ParallelTaskAssignment::ParallelTaskAssignment(
     const int64_t max_parallelism,
     const HloCostAnalysis::ShapeSizeFunction& shape_size, HloModule* module,
@@ -129,6 +200,16 @@ ParallelTaskAssignment::ParallelTaskAssignment(
     // HLOs like CustomCall are not yet implemented in the HloCostAnalysis).
     cost_model_.reset(new SimpleCostModel(max_parallelism, shape_size));
   }
+
+  // Prefer measured instruction costs to estimated ones when the module comes
+  // with a profile.
+  if (std::optional<tensorflow::profiler::ProfiledInstructionsProto> profile =
+          ReadFdoProfile(*module)) {
+    VLOG(1) << "ParallelTaskAssignment using profiled costs of "
+            << profile->costs_size() << " instructions";
+    cost_model_ = std::make_unique<ProfileGuidedCostModel>(
+        max_parallelism, *profile, std::move(cost_model_));
+  }
 }
 
 int64_t ParallelTaskAssignment::GetTargetParallelTaskCount(
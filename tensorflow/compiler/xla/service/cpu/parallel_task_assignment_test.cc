@@ -192,6 +192,31 @@ TEST_F(ParallelTaskAssignmentTest, AllReduceNotParallelized) {
   EXPECT_FALSE(changed);
 }
 
+TEST_F(ParallelTaskAssignmentTest, ProfiledCostParallelizes) {
+  constexpr char hlo_string[] = R"(
+  HloModule TestTaskParallel_profiled
+    ENTRY add {
+      lhs = f32[1024] parameter(0)
+      rhs = f32[1024] parameter(1)
+      ROOT add = f32[1024] add(lhs, rhs)
+    }
+  )";
+
+  // Too cheap to parallelize according to the estimated cost.
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> m,
+                          ParseAndReturnVerifiedModule(hlo_string));
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, RunParallelTaskAssigner(m.get()));
+  EXPECT_FALSE(changed);
+
+  // But measured to be expensive.
+  TF_ASSERT_OK_AND_ASSIGN(m, ParseAndReturnVerifiedModule(hlo_string));
+  *m->config().mutable_fdo_profile() = R"pb(
+    costs { name: "add" cost_us: 1000 }
+  )pb";
+  TF_ASSERT_OK_AND_ASSIGN(changed, RunParallelTaskAssigner(m.get()));
+  EXPECT_TRUE(changed);
+}
+
 TEST_F(ParallelTaskAssignmentTest, ConstantNotParallelized) {
   constexpr char hlo_string[] = R"(
   HloModule TestTaskParallel_constant
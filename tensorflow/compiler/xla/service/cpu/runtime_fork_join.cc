@@ -17,6 +17,11 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <vector>
+
 #include "absl/base/dynamic_annotations.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
@@ -29,9 +34,88 @@ limitations under the License.
 using ComputeFunctionType = void (*)(void*, const void*, const void**, void**,
                                      void*, int64_t*, uint64_t*);
 
-// Dispatches 'num_partitions - 1' calls to 'function_ptr' in parallel.
-// Calls 'function_ptr' for first partition inline.
-// Uses blocking counter to synchronize threads after parallel calls complete.
+namespace {
+
+// Number of helper tasks that ParallelForkJoin calls of all executables have
+// queued or running on intra-op thread pools. Nested or concurrent calls
+// request fewer helpers once it reaches the size of the pool, and run the
+// remaining partitions on their calling thread instead.
+std::atomic<int64_t> active_helpers{0};
+
+// Reserves up to 'wanted' helpers without exceeding 'cap' active helpers, and
+// returns the number of helpers reserved.
+int32_t ReserveHelpers(int32_t wanted, int64_t cap) {
+  int64_t active = active_helpers.load(std::memory_order_relaxed);
+  int64_t reserved;
+  do {
+    reserved = std::clamp<int64_t>(cap - active, 0, wanted);
+    if (reserved == 0) return 0;
+  } while (!active_helpers.compare_exchange_weak(active, active + reserved,
+                                                 std::memory_order_relaxed));
+  return reserved;
+}
+
+// The state of a ParallelForkJoin call shared by its calling thread and its
+// helpers. Helpers that start after all partitions were claimed only touch
+// 'next_partition', so the state outlives the call until they are done.
+struct ForkJoinState {
+  ForkJoinState(ComputeFunctionType function, void* result_ptr,
+                const void* run_options_ptr, void** buffer_table,
+                uint64_t* prof_counters, int32_t num_partitions,
+                int64_t* partitions, int64_t stride)
+      : function(function),
+        result_ptr(result_ptr),
+        run_options_ptr(run_options_ptr),
+        buffer_table(buffer_table),
+        prof_counters(prof_counters),
+        num_partitions(num_partitions),
+        partitions(partitions),
+        stride(stride),
+        statuses(num_partitions),
+        done(num_partitions) {}
+
+  ComputeFunctionType function;
+  void* result_ptr;
+  const void* run_options_ptr;
+  void** buffer_table;
+  uint64_t* prof_counters;
+  int32_t num_partitions;
+  int64_t* partitions;
+  int64_t stride;
+
+  std::vector<XlaCustomCallStatus> statuses;
+  // The next partition to be claimed by a thread.
+  std::atomic<int32_t> next_partition{0};
+  // Counts the partitions that have not completed yet.
+  tsl::BlockingCounter done;
+};
+
+// Claims and runs partitions until none is left.
+void RunPartitions(ForkJoinState* state) {
+  for (int32_t i = state->next_partition.fetch_add(1);
+       i < state->num_partitions; i = state->next_partition.fetch_add(1)) {
+    state->function(state->result_ptr, state->run_options_ptr, nullptr,
+                    state->buffer_table, &state->statuses[i],
+                    &state->partitions[i * state->stride],
+                    state->prof_counters);
+    VLOG(3) << "ParallelForkJoin partition " << i << " done.";
+    state->done.DecrementCount();
+  }
+}
+
+}  // namespace
+
+// Runs the 'num_partitions' calls to 'function_ptr' on the calling thread and
+// on helper tasks enqueued on the intra-op thread pool. Partitions are not
+// assigned to threads up front: each thread claims the next unclaimed
+// partition when it is done with its previous one, so threads that get cheap
+// partitions, or start early, run more of them. The calling thread claims
+// partitions too, and only blocks on the partitions that other threads are
+// still running once none is left to claim.
+//
+// The number of helpers is capped by the size of the thread pool, shared by
+// all concurrent calls, so that nested and concurrent parallel loops do not
+// flood the pool with tasks.
 //
 // The 'partitions' array has a total number of elements equal to
 // 'num_partitions * num_partitioned_dims * 2' (the '2' is necessary to specify
@@ -73,34 +157,34 @@ ABSL_ATTRIBUTE_NO_SANITIZE_MEMORY void __xla_cpu_runtime_ParallelForkJoin(
   const xla::ExecutableRunOptions* run_options =
       static_cast<const xla::ExecutableRunOptions*>(run_options_ptr);
   CHECK_NE(run_options, nullptr);
-  CHECK_NE(run_options->intra_op_thread_pool(), nullptr);
+  const Eigen::ThreadPoolDevice* pool = run_options->intra_op_thread_pool();
+  CHECK_NE(pool, nullptr);
 
   ComputeFunctionType function =
       reinterpret_cast<ComputeFunctionType>(function_ptr);
   // Compute partition stride in 'partitions' array.
   const int64_t stride = 2 * num_partitioned_dims;
 
-  std::vector<XlaCustomCallStatus> statuses(num_partitions);
-
-  // Dispatch 'num_partitions - 1' compute functions to run in parallel.
-  tsl::BlockingCounter bc(num_partitions - 1);
-  for (int32_t i = 1; i < num_partitions; ++i) {
-    const int64_t offset = i * stride;
-    run_options->intra_op_thread_pool()->enqueueNoNotification(
-        [i, function, result_ptr, run_options_ptr, buffer_table, prof_counters,
-         partitions, offset, &bc, &statuses]() {
-          function(result_ptr, run_options_ptr, nullptr, buffer_table,
-                   &statuses[i], &partitions[offset], prof_counters);
-          bc.DecrementCount();
-          VLOG(3) << "ParallelForkJoin partition " << i << " done.";
-        });
+  auto state = std::make_shared<ForkJoinState>(
+      function, result_ptr, run_options_ptr, buffer_table, prof_counters,
+      num_partitions, partitions, stride);
+
+  // The calling thread runs partitions too, so at most 'num_partitions - 1'
+  // helpers can do useful work.
+  const int32_t num_helpers = ReserveHelpers(
+      std::min<int64_t>(num_partitions - 1, pool->numThreads()),
+      pool->numThreads());
+  VLOG(3) << "ParallelForkJoin num_helpers: " << num_helpers;
+  for (int32_t i = 0; i < num_helpers; ++i) {
+    pool->enqueueNoNotification([state]() {
+      RunPartitions(state.get());
+      active_helpers.fetch_sub(1, std::memory_order_relaxed);
+    });
   }
 
-  // Call first compute function inline.
-  function(result_ptr, run_options_ptr, params, buffer_table, &statuses[0],
-           &partitions[0], prof_counters);
-  VLOG(3) << "ParallelForkJoin partition 0 done.";
-  bc.Wait();
+  RunPartitions(state.get());
+  state->done.Wait();
+  const std::vector<XlaCustomCallStatus>& statuses = state->statuses;
 
   // Collect all error messages (if any).
   std::vector<std::pair<int32_t, absl::string_view>> error_messages;
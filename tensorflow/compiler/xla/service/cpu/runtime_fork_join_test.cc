@@ -0,0 +1,148 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/cpu/runtime_fork_join.h"
+
+#define EIGEN_USE_THREADS
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/compiler/xla/executable_run_options.h"
+#include "tensorflow/compiler/xla/service/custom_call_status.h"
+#include "tensorflow/compiler/xla/service/custom_call_status_internal.h"
+#include "tensorflow/tsl/platform/test.h"
+
+namespace xla {
+namespace cpu {
+namespace {
+
+constexpr int64_t kFailingPartitionStart = 12;
+
+// Adds one to the counters of the elements in the partition, which are held
+// in the first buffer.
+void CountPartition(void* result, const void* run_options,
+                    const void** params, void** buffer_table, void* status,
+                    int64_t* partition, uint64_t* prof_counters) {
+  auto* counters = static_cast<std::atomic<int>*>(buffer_table[0]);
+  for (int64_t i = partition[0]; i < partition[1]; ++i) {
+    counters[i].fetch_add(1);
+  }
+}
+
+void FailPartition(void* result, const void* run_options, const void** params,
+                   void** buffer_table, void* status, int64_t* partition,
+                   uint64_t* prof_counters) {
+  if (partition[0] == kFailingPartitionStart) {
+    const std::string message = "failed";
+    XlaCustomCallStatusSetFailure(static_cast<XlaCustomCallStatus*>(status),
+                                  message.data(), message.size());
+  }
+}
+
+// Returns the 'partitions' array of 'num_partitions' one-dimensional
+// partitions of 'partition_size' elements.
+std::vector<int64_t> MakePartitions(int32_t num_partitions,
+                                    int64_t partition_size) {
+  std::vector<int64_t> partitions;
+  for (int32_t i = 0; i < num_partitions; ++i) {
+    partitions.push_back(i * partition_size);
+    partitions.push_back((i + 1) * partition_size);
+  }
+  return partitions;
+}
+
+class ParallelForkJoinTest : public ::testing::Test {
+ protected:
+  ParallelForkJoinTest()
+      : pool_(/*num_threads=*/4), device_(&pool_, pool_.NumThreads()) {
+    run_options_.set_intra_op_thread_pool(&device_);
+  }
+
+  Eigen::ThreadPool pool_;
+  Eigen::ThreadPoolDevice device_;
+  ExecutableRunOptions run_options_;
+};
+
+TEST_F(ParallelForkJoinTest, RunsEachPartitionOnce) {
+  constexpr int32_t kNumPartitions = 64;
+  constexpr int64_t kPartitionSize = 3;
+  std::vector<std::atomic<int>> counters(kNumPartitions * kPartitionSize);
+  void* buffer_table[] = {counters.data()};
+  std::vector<int64_t> partitions =
+      MakePartitions(kNumPartitions, kPartitionSize);
+  XlaCustomCallStatus status;
+
+  __xla_cpu_runtime_ParallelForkJoin(
+      nullptr, &run_options_, nullptr, buffer_table, &status, nullptr,
+      kNumPartitions, partitions.data(), /*num_partitioned_dims=*/1,
+      reinterpret_cast<void*>(&CountPartition));
+
+  EXPECT_FALSE(CustomCallStatusGetMessage(&status).has_value());
+  for (const std::atomic<int>& counter : counters) {
+    EXPECT_EQ(counter.load(), 1);
+  }
+}
+
+TEST_F(ParallelForkJoinTest, ConcurrentCallsOversubscribingThePool) {
+  constexpr int32_t kNumCallers = 8;
+  constexpr int32_t kNumPartitions = 16;
+  std::vector<std::vector<std::atomic<int>>> counters(kNumCallers);
+  std::vector<std::thread> callers;
+  for (int32_t c = 0; c < kNumCallers; ++c) {
+    counters[c] = std::vector<std::atomic<int>>(kNumPartitions);
+    callers.emplace_back([&, c]() {
+      void* buffer_table[] = {counters[c].data()};
+      std::vector<int64_t> partitions = MakePartitions(kNumPartitions, 1);
+      XlaCustomCallStatus status;
+      __xla_cpu_runtime_ParallelForkJoin(
+          nullptr, &run_options_, nullptr, buffer_table, &status, nullptr,
+          kNumPartitions, partitions.data(), /*num_partitioned_dims=*/1,
+          reinterpret_cast<void*>(&CountPartition));
+    });
+  }
+  for (std::thread& caller : callers) {
+    caller.join();
+  }
+  for (const std::vector<std::atomic<int>>& caller_counters : counters) {
+    for (const std::atomic<int>& counter : caller_counters) {
+      EXPECT_EQ(counter.load(), 1);
+    }
+  }
+}
+
+TEST_F(ParallelForkJoinTest, ReportsPartitionErrors) {
+  constexpr int32_t kNumPartitions = 8;
+  std::vector<int64_t> partitions = MakePartitions(kNumPartitions, 4);
+  XlaCustomCallStatus status;
+
+  __xla_cpu_runtime_ParallelForkJoin(
+      nullptr, &run_options_, nullptr, nullptr, &status, nullptr,
+      kNumPartitions, partitions.data(), /*num_partitioned_dims=*/1,
+      reinterpret_cast<void*>(&FailPartition));
+
+  std::optional<absl::string_view> message =
+      CustomCallStatusGetMessage(&status);
+  ASSERT_TRUE(message.has_value());
+  EXPECT_EQ(*message, "Partition 3 error: failed");
+}
+
+}  // namespace
+}  // namespace cpu
+}  // namespace xla
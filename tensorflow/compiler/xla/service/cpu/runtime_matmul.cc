@@ -17,6 +17,8 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include <type_traits>
+
 #include "absl/base/dynamic_annotations.h"
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/compiler/xla/executable_run_options.h"
@@ -32,9 +34,9 @@ bool Is16BytesAligned(void* ptr) {
   return reinterpret_cast<uintptr_t>(ptr) % 16 == 0;
 }
 
-template <typename T, Eigen::AlignmentType Alignment>
-void MatMul(const void* run_options_ptr, T* out, T* lhs, T* rhs, int64_t m,
-            int64_t n, int64_t k, int32_t transpose_lhs,
+template <typename T, Eigen::AlignmentType Alignment, typename Input = T>
+void MatMul(const void* run_options_ptr, T* out, Input* lhs, Input* rhs,
+            int64_t m, int64_t n, int64_t k, int32_t transpose_lhs,
             int32_t transpose_rhs) {
   const xla::ExecutableRunOptions* run_options =
       static_cast<const xla::ExecutableRunOptions*>(run_options_ptr);
@@ -51,10 +53,10 @@ void MatMul(const void* run_options_ptr, T* out, T* lhs, T* rhs, int64_t m,
     std::swap(rhs_rows, rhs_cols);
   }
 
-  const Eigen::TensorMap<Eigen::Tensor<const T, 2>, Alignment> A(lhs, lhs_rows,
-                                                                 lhs_cols);
-  const Eigen::TensorMap<Eigen::Tensor<const T, 2>, Alignment> B(rhs, rhs_rows,
-                                                                 rhs_cols);
+  const Eigen::TensorMap<Eigen::Tensor<const Input, 2>, Alignment> A(
+      lhs, lhs_rows, lhs_cols);
+  const Eigen::TensorMap<Eigen::Tensor<const Input, 2>, Alignment> B(
+      rhs, rhs_rows, rhs_cols);
   Eigen::TensorMap<Eigen::Tensor<T, 2>, Alignment> C(out, m, n);
 
   typedef typename Eigen::Tensor<T, 2>::DimensionPair DimPair;
@@ -67,7 +69,14 @@ void MatMul(const void* run_options_ptr, T* out, T* lhs, T* rhs, int64_t m,
   // the contraction is performed along dimension 1 of the lhs and dimension
   // 0 of the rhs.
   XLA_LIGHTWEIGHT_CHECK(run_options->intra_op_thread_pool() != nullptr);
-  C.device(*run_options->intra_op_thread_pool()) = A.contract(B, dims);
+  if constexpr (std::is_same_v<T, Input>) {
+    C.device(*run_options->intra_op_thread_pool()) = A.contract(B, dims);
+  } else {
+    // Widen the inputs as they are packed, so that they never have to be
+    // materialized in the (larger) result type.
+    C.device(*run_options->intra_op_thread_pool()) =
+        A.template cast<T>().contract(B.template cast<T>(), dims);
+  }
 }
 
 template <typename T, Eigen::AlignmentType Alignment>
@@ -113,21 +122,21 @@ void MatMul_Batch(const void* run_options_ptr, T* out, T* lhs, T* rhs,
   }
 }
 
-template <typename T>
-void MatMulDispatch(const void* run_options_ptr, T* out, T* lhs, T* rhs,
-                    int64_t m, int64_t n, int64_t k, int32_t transpose_lhs,
-                    int32_t transpose_rhs) {
+template <typename T, typename Input = T>
+void MatMulDispatch(const void* run_options_ptr, T* out, Input* lhs,
+                    Input* rhs, int64_t m, int64_t n, int64_t k,
+                    int32_t transpose_lhs, int32_t transpose_rhs) {
   bool all_buffers_16b_aligned =
       Is16BytesAligned(out) && Is16BytesAligned(lhs) && Is16BytesAligned(rhs);
 
   if (!all_buffers_16b_aligned) {
-    MatMul<T, Eigen::Unaligned>(run_options_ptr, out, lhs, rhs, m, n, k,
-                                transpose_lhs, transpose_rhs);
+    MatMul<T, Eigen::Unaligned, Input>(run_options_ptr, out, lhs, rhs, m, n, k,
+                                       transpose_lhs, transpose_rhs);
     return;
   }
 
-  MatMul<T, Eigen::Aligned16>(run_options_ptr, out, lhs, rhs, m, n, k,
-                              transpose_lhs, transpose_rhs);
+  MatMul<T, Eigen::Aligned16, Input>(run_options_ptr, out, lhs, rhs, m, n, k,
+                                     transpose_lhs, transpose_rhs);
 }
 
 template <typename T>
@@ -195,6 +204,14 @@ ABSL_ATTRIBUTE_NO_SANITIZE_MEMORY void __xla_cpu_runtime_EigenMatMulS32(
                           transpose_lhs, transpose_rhs);
 }
 
+ABSL_ATTRIBUTE_NO_SANITIZE_MEMORY void __xla_cpu_runtime_EigenMatMulS8S32(
+    const void* run_options_ptr, int32_t* out, int8_t* lhs, int8_t* rhs,
+    int64_t m, int64_t n, int64_t k, int32_t transpose_lhs,
+    int32_t transpose_rhs) {
+  MatMulDispatch<int32_t, int8_t>(run_options_ptr, out, lhs, rhs, m, n, k,
+                                  transpose_lhs, transpose_rhs);
+}
+
 ABSL_ATTRIBUTE_NO_SANITIZE_MEMORY void __xla_cpu_runtime_EigenBatchMatMulF32(
     const void* run_options_ptr, float* out, float* lhs, float* rhs, int64_t m,
     int64_t n, int64_t k, int64_t batch_size, int32_t transpose_lhs,
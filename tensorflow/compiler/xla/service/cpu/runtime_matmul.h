@@ -59,6 +59,13 @@ extern void __xla_cpu_runtime_EigenMatMulS32(
     int32_t* lhs, int32_t* rhs, int64_t m, int64_t n, int64_t k,
     int32_t transpose_lhs, int32_t transpose_rhs);
 
+// Same as __xla_cpu_runtime_EigenMatMulS32, but the s8 inputs are widened to
+// s32 while Eigen packs them, rather than being upcast to s32 buffers first.
+extern void __xla_cpu_runtime_EigenMatMulS8S32(
+    const void* /* xla::ExecutableRunOptions* */ run_options_ptr, int32_t* out,
+    int8_t* lhs, int8_t* rhs, int64_t m, int64_t n, int64_t k,
+    int32_t transpose_lhs, int32_t transpose_rhs);
+
 extern void __xla_cpu_runtime_EigenBatchMatMulF32(
     const void* /* xla::ExecutableRunOptions* */ run_options_ptr, float* out,
     float* lhs, float* rhs, int64_t m, int64_t n, int64_t k, int64_t batch_size,
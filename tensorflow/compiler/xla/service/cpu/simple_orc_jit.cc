@@ -21,8 +21,12 @@ limitations under the License.
 #include <cstdio>
 #include <list>
 #include <memory>
+#include <string>
 #include <utility>
+#include <vector>
 
+#include "llvm/Bitcode/BitcodeReader.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
 #include "llvm/ExecutionEngine/ExecutionEngine.h"
 #include "llvm/ExecutionEngine/JITSymbol.h"
 #include "llvm/ExecutionEngine/Orc/ExecutorProcessControl.h"
@@ -31,6 +35,7 @@ limitations under the License.
 #include "llvm/IR/Operator.h"
 #include "llvm/Support/CodeGen.h"
 #include "llvm/TargetParser/Host.h"
+#include "llvm/Transforms/Utils/SplitModule.h"
 #include "mlir/ExecutionEngine/CRunnerUtils.h"  // from @llvm-project
 #include "tensorflow/compiler/xla/service/cpu/cpu_runtime.h"
 #include "tensorflow/compiler/xla/service/cpu/orc_jit_memory_mapper.h"
@@ -55,7 +60,9 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/cpu/windows_compatibility.h"
 #include "tensorflow/compiler/xla/service/custom_call_target_registry.h"
 #include "tensorflow/compiler/xla/types.h"
+#include "tensorflow/tsl/platform/env.h"
 #include "tensorflow/tsl/platform/logging.h"
+#include "tensorflow/tsl/platform/threadpool.h"
 
 // Provided by compiler-rt and MLIR.
 // Converts an F32 value to a BF16.
@@ -108,6 +115,12 @@ SimpleOrcJIT::SimpleOrcJIT(
     LLVMCompiler::ModuleHook post_optimization_hook,
     std::function<void(const llvm::object::ObjectFile&)> post_codegen_hook)
     : target_machine_(InferTargetMachineForJIT(target_options, opt_level)),
+      target_options_(target_options),
+      opt_level_(opt_level),
+      optimize_for_size_(optimize_for_size),
+      disable_expensive_passes_(disable_expensive_passes),
+      disable_slp_vectorizer_(disable_slp_vectorizer),
+      fast_math_flags_(fast_math_flags),
       target_triple_(target_machine_->getTargetTriple()),
       data_layout_(target_machine_->createDataLayout()),
       target_process_control_(std::move(target_process_control)),
@@ -242,6 +255,74 @@ llvm::Error SimpleOrcJIT::AddModule(llvm::orc::ThreadSafeModule module) {
   return compile_layer_.add(*main_jit_dylib_, std::move(module));
 }
 
+llvm::Error SimpleOrcJIT::AddModuleInParallel(
+    llvm::orc::ThreadSafeModule module, int num_parts) {
+  // Split the module and serialize the parts to bitcode, so that each part can
+  // be compiled in its own LLVMContext.
+  std::vector<std::string> parts;
+  module.withModuleDo([&](llvm::Module& llvm_module) {
+    int num_functions = 0;
+    for (const llvm::Function& function : llvm_module.functions()) {
+      if (!function.isDeclaration()) ++num_functions;
+    }
+    num_parts = std::min(num_parts, num_functions);
+    if (num_parts <= 1) return;
+    llvm::SplitModule(
+        llvm_module, num_parts,
+        [&](std::unique_ptr<llvm::Module> part) {
+          llvm::raw_string_ostream os(parts.emplace_back());
+          llvm::WriteBitcodeToFile(*part, os);
+        },
+        /*PreserveLocals=*/true);
+  });
+  if (parts.empty()) {
+    return AddModule(std::move(module));
+  }
+
+  std::vector<std::unique_ptr<llvm::MemoryBuffer>> objects(parts.size());
+  std::vector<std::string> errors(parts.size());
+  {
+    tsl::thread::ThreadPool thread_pool(tsl::Env::Default(), "xla_cpu_codegen",
+                                        parts.size());
+    for (int i = 0; i < parts.size(); ++i) {
+      thread_pool.Schedule([&, i] {
+        llvm::LLVMContext context;
+        auto part = llvm::parseBitcodeFile(
+            llvm::MemoryBufferRef(parts[i], "xla_cpu_codegen_part"), context);
+        if (!part) {
+          errors[i] = llvm::toString(part.takeError());
+          return;
+        }
+        // Target machines are not thread-safe.
+        std::unique_ptr<llvm::TargetMachine> target_machine =
+            InferTargetMachineForJIT(target_options_, opt_level_);
+        CompilerFunctor compiler(target_machine.get(), opt_level_,
+                                 optimize_for_size_, disable_expensive_passes_,
+                                 disable_slp_vectorizer_, fast_math_flags_);
+        auto object = compiler(**part);
+        if (!object) {
+          errors[i] = llvm::toString(object.takeError());
+          return;
+        }
+        objects[i] = std::move(*object);
+      });
+    }
+    // The thread pool waits for the compilations to finish when destroyed.
+  }
+
+  for (int i = 0; i < parts.size(); ++i) {
+    if (!errors[i].empty()) {
+      return llvm::make_error<llvm::StringError>(
+          errors[i], llvm::inconvertibleErrorCode());
+    }
+    if (auto error =
+            object_layer_.add(*main_jit_dylib_, std::move(objects[i]))) {
+      return error;
+    }
+  }
+  return llvm::Error::success();
+}
+
 void SimpleOrcJIT::DoneCompiling() {
   // The target machine takes a non-trivial amount of memory, so once we are
   // done compiling throw it away.
@@ -296,6 +377,7 @@ bool RegisterKnownJITSymbols() {
   REGISTER_CPU_RUNTIME_SYMBOL(EigenMatMulC64);
   REGISTER_CPU_RUNTIME_SYMBOL(EigenMatMulC128);
   REGISTER_CPU_RUNTIME_SYMBOL(EigenMatMulS32);
+  REGISTER_CPU_RUNTIME_SYMBOL(EigenMatMulS8S32);
   REGISTER_CPU_RUNTIME_SYMBOL(EigenBatchMatMulF32);
   REGISTER_CPU_RUNTIME_SYMBOL(MKLMatMulF32);
   REGISTER_CPU_RUNTIME_SYMBOL(MKLMatMulF64);
@@ -315,6 +397,7 @@ bool RegisterKnownJITSymbols() {
   REGISTER_CPU_RUNTIME_SYMBOL(EigenSingleThreadedMatMulC64);
   REGISTER_CPU_RUNTIME_SYMBOL(EigenSingleThreadedMatMulC128);
   REGISTER_CPU_RUNTIME_SYMBOL(EigenSingleThreadedMatMulS32);
+  REGISTER_CPU_RUNTIME_SYMBOL(EigenSingleThreadedMatMulS8S32);
   REGISTER_CPU_RUNTIME_SYMBOL(ParallelForkJoin);
   REGISTER_CPU_RUNTIME_SYMBOL(PrintfToStderr);
   REGISTER_CPU_RUNTIME_SYMBOL(ReleaseInfeedBufferAfterDequeue);
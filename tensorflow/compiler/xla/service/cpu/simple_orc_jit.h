@@ -81,6 +81,12 @@ class SimpleOrcJIT : public llvm::JITEventListener {
 
   llvm::Error AddModule(llvm::orc::ThreadSafeModule module);
 
+  // Splits `module` into up to `num_parts` modules, compiles them to object
+  // code in parallel, each with its own target machine, and adds them to the
+  // JIT. The module hooks are not run on the parts.
+  llvm::Error AddModuleInParallel(llvm::orc::ThreadSafeModule module,
+                                  int num_parts);
+
   // Discards objects we no longer need once we are done compiling.
   void DoneCompiling();
 
@@ -111,6 +117,12 @@ class SimpleOrcJIT : public llvm::JITEventListener {
   void notifyFreeingObject(llvm::JITEventListener::ObjectKey key) override;
 
   std::unique_ptr<llvm::TargetMachine> target_machine_;
+  const llvm::TargetOptions target_options_;
+  const llvm::CodeGenOpt::Level opt_level_;
+  const bool optimize_for_size_;
+  const bool disable_expensive_passes_;
+  const bool disable_slp_vectorizer_;
+  const llvm::FastMathFlags fast_math_flags_;
   llvm::Triple target_triple_;
   const llvm::DataLayout data_layout_;
   std::unique_ptr<llvm::orc::ExecutorProcessControl> target_process_control_;
@@ -93,6 +93,23 @@ TEST_P(CpuEigenDotOperationTest, DotTransposeOp) {
   CompileAndCheck(builder.Build(), spec.filecheck_lines);
 }
 
+TEST_F(CpuEigenDotOperationTest, S8S32DotOp) {
+  HloComputation::Builder builder(TestName());
+
+  auto param_shape = ShapeUtil::MakeShape(S8, {128, 128});
+  auto result_shape = ShapeUtil::MakeShape(S32, {128, 128});
+
+  HloInstruction* lhs = builder.AddInstruction(
+      HloInstruction::CreateParameter(0, param_shape, "input"));
+  HloInstruction* rhs = builder.AddInstruction(
+      HloInstruction::CreateParameter(1, param_shape, "input"));
+
+  builder.AddInstruction(CreateCanonicalDot(result_shape, lhs, rhs));
+  // The s8 operands are passed to the runtime as is, without being upcast.
+  CompileAndCheck(builder.Build(),
+                  R"(CHECK: call void @__xla_cpu_runtime_EigenMatMulS8S32)");
+}
+
 std::vector<DotTestSpec> GetDotTestCases() {
   std::vector<DotTestSpec> result;
   // The fp16 test runs a 32-bit matmul because we promote fp16 gemms to fp32
@@ -105,6 +105,22 @@ TEST_F(InfeedTest, SingleInfeedEmptyTuple) {
   TestInfeedRoundTrip(LiteralUtil::MakeTuple({}));
 }
 
+TEST_F(InfeedTest, SingleInfeedBorrowedTuple) {
+  Literal literal = LiteralUtil::MakeTupleFromSlices(
+      {LiteralUtil::CreateR2F32Linspace(0.0, 1.0, 128, 64),
+       LiteralUtil::CreateR1<uint32_t>({1, 2, 3})});
+  bool done_with_literal = false;
+  ASSERT_IS_OK(client_->TransferBorrowedToInfeedLocal(
+      literal, /*device_ordinal=*/0, [&]() { done_with_literal = true; }));
+  // The infeed reads from `literal` until the computation consumes it.
+  EXPECT_FALSE(done_with_literal);
+
+  XlaBuilder builder(TestName());
+  Infeed(&builder, literal.shape());
+  ComputeAndCompareTuple(&builder, literal, {});
+  EXPECT_TRUE(done_with_literal);
+}
+
 // Tests Infeed operation used in a while loop, as in the code below. The
 // computation is launched asynchronously, and then infeed data is transferred.
 //
@@ -16,16 +16,18 @@ limitations under the License.
 #include <memory>
 #include <string>
 
+#include "tensorflow/compiler/xla/hlo/ir/hlo_computation.h"
+#include "tensorflow/compiler/xla/hlo/ir/hlo_instruction.h"
 #include "tensorflow/compiler/xla/service/cpu/cpu_compiler.h"
+#include "tensorflow/compiler/xla/service/cpu/cpu_executable.h"
 #include "tensorflow/compiler/xla/service/cpu/tests/cpu_codegen_test.h"
+#include "tensorflow/compiler/xla/service/llvm_ir/dynamic_update_slice_util.h"
 
 namespace xla {
 namespace cpu {
 namespace {
 
-// Verifies fix for b/233647273.
-TEST_F(CpuCodegenTest, While) {
-  const std::string hlo_text = R"(
+constexpr char kWhileHloText[] = R"(
 HloModule module
 
 f1 {
@@ -57,7 +59,10 @@ ENTRY entry {
 }
 )";
 
-  TF_ASSERT_OK_AND_ASSIGN(auto module, ParseAndReturnVerifiedModule(hlo_text));
+// Verifies fix for b/233647273.
+TEST_F(CpuCodegenTest, While) {
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(kWhileHloText));
 
   // Compile and execute the computation.
   auto result = ExecuteAndTransfer(module->Clone(), {});
@@ -66,6 +71,83 @@ ENTRY entry {
   LiteralTestUtil::ExpectR0Equal(3, result);
 }
 
+TEST_F(CpuCodegenTest, WhileWithParallelCodegen) {
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(kWhileHloText));
+  DebugOptions debug_options = module->config().debug_options();
+  debug_options.set_xla_cpu_parallel_codegen_split_count(4);
+  module->config().set_debug_options(debug_options);
+
+  // The functions of the loop end up in different LLVM modules, which must be
+  // linked back together by the JIT.
+  auto result = ExecuteAndTransfer(module->Clone(), {});
+
+  LiteralTestUtil::ExpectR0Equal(3, result);
+}
+
+// A decode loop that writes one row of a loop-carried cache per iteration.
+TEST_F(CpuCodegenTest, WhileLoopCarriedDynamicUpdateSliceIsInPlace) {
+  constexpr char kHloText[] = R"(
+HloModule module
+
+body {
+  body.p0 = (s32[], f32[1024,256]) parameter(0)
+  i = s32[] get-tuple-element(body.p0), index=0
+  cache = f32[1024,256] get-tuple-element(body.p0), index=1
+  one = s32[] constant(1)
+  next_i = s32[] add(i, one)
+  row = f32[] convert(i)
+  update = f32[1,256] broadcast(row), dimensions={}
+  zero = s32[] constant(0)
+  new_cache = f32[1024,256] dynamic-update-slice(cache, update, i, zero)
+  ROOT body.root = (s32[], f32[1024,256]) tuple(next_i, new_cache)
+}
+
+cond {
+  cond.p0 = (s32[], f32[1024,256]) parameter(0)
+  cond.i = s32[] get-tuple-element(cond.p0), index=0
+  cond.n = s32[] constant(1024)
+  ROOT cond.root = pred[] compare(cond.i, cond.n), direction=LT
+}
+
+ENTRY entry {
+  entry.cache = f32[1024,256] parameter(0)
+  entry.i = s32[] constant(0)
+  entry.init = (s32[], f32[1024,256]) tuple(entry.i, entry.cache)
+  ROOT entry.root = (s32[], f32[1024,256]) while(entry.init), condition=cond,
+    body=body
+}
+)";
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(kHloText));
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Executable> executable,
+                          CompileToExecutable(std::move(module)));
+  const BufferAssignment& assignment =
+      static_cast<CpuExecutable*>(executable.get())->buffer_assignment();
+
+  // The update may have been fused with its producers.
+  int num_updates = 0;
+  for (HloComputation* computation : executable->module().computations()) {
+    if (computation->IsFusionComputation()) continue;
+    for (HloInstruction* instruction : computation->instructions()) {
+      if (instruction->opcode() == HloOpcode::kDynamicUpdateSlice) {
+        ++num_updates;
+        EXPECT_TRUE(
+            llvm_ir::CanUpdateDynamicSliceInPlace(instruction, assignment))
+            << instruction->ToString();
+      } else if (instruction->opcode() == HloOpcode::kFusion &&
+                 llvm_ir::MayBeImplementedAsInPlaceDynamicUpdateSlice(
+                     instruction)) {
+        ++num_updates;
+        EXPECT_TRUE(llvm_ir::CanEmitFusedDynamicUpdateSliceInPlace(instruction,
+                                                                   assignment))
+            << instruction->ToString();
+      }
+    }
+  }
+  EXPECT_EQ(num_updates, 1);
+}
+
 }  // namespace
 }  // namespace cpu
 }  // namespace xla
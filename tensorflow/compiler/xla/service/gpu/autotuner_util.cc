@@ -16,11 +16,19 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/gpu/autotuner_util.h"
 
 #include <algorithm>
+#include <optional>
 #include <string>
 #include <tuple>
 #include <utility>
 
+#include "absl/strings/str_cat.h"
+#include "tensorflow/compiler/xla/service/gpu/metrics.h"
 #include "tensorflow/compiler/xla/service/gpu/stream_executor_util.h"
+#include "tensorflow/compiler/xla/stream_executor/dnn.h"
+#include "tensorflow/compiler/xla/util.h"
+#include "tensorflow/tsl/platform/env.h"
+#include "tensorflow/tsl/platform/fingerprint.h"
+#include "tensorflow/tsl/platform/path.h"
 
 namespace xla {
 namespace gpu {
@@ -104,6 +112,20 @@ AutotuneCacheKey::AutotuneCacheKey(absl::string_view model_str,
                                    const HloInstruction& instr)
     : AutotuneCacheKey(model_str, ToCanonicalString(&instr)) {}
 
+namespace {
+
+// Bump this version whenever you change the structure of the results.
+// LINT.IfChange(version)
+constexpr int kVersion = 2;
+// LINT.ThenChange()
+
+bool IsTextProtoPath(absl::string_view file_path) {
+  return absl::EndsWith(file_path, ".txt") ||
+         absl::EndsWith(file_path, ".textproto");
+}
+
+}  // anonymous namespace
+
 static AutotuneResult* TryFindInCache(const AutotuneCacheKey& key) {
   absl::MutexLock lock(&autotune_cache_mu);
   auto it = autotune_cache.find(key);
@@ -114,35 +136,128 @@ static AutotuneResult* TryFindInCache(const AutotuneCacheKey& key) {
   return nullptr;
 }
 
+// Returns the device model and the versions of the driver and libraries that
+// autotuning results depend on. cuBLAS ships with the CUDA toolkit, so it is
+// covered by the runtime version.
+static std::string GetDeviceStrForCacheDir(const AutotuneConfig& config) {
+  se::StreamExecutor* stream_exec = config.GetExecutor();
+  const se::DeviceDescription& desc = stream_exec->GetDeviceDescription();
+  std::string dnn_version = "none";
+  if (se::dnn::DnnSupport* dnn = stream_exec->AsDnn()) {
+    if (StatusOr<se::dnn::VersionInfo> version = dnn->GetVersion();
+        version.ok()) {
+      dnn_version = absl::StrCat(version->major_version(), ".",
+                                 version->minor_version(), ".",
+                                 version->patch());
+    }
+  }
+  return absl::StrCat(config.GetModelStr(), "; driver ", desc.driver_version(),
+                      "; runtime ", desc.runtime_version(), "; cudnn ",
+                      dnn_version);
+}
+
+static std::string GetCacheDirFilePath(const AutotuneConfig& config,
+                                       absl::string_view device_str,
+                                       const AutotuneCacheKey& key) {
+  uint64_t fingerprint =
+      tsl::Fingerprint64(absl::StrCat(device_str, "\n", key.GetHlo()));
+  return tsl::io::JoinPath(
+      config.autotune_cache_dir(),
+      absl::StrCat(absl::Hex(fingerprint, absl::kZeroPad16), ".textproto"));
+}
+
+static std::optional<AutotuneResult> TryToLoadFromCacheDir(
+    const AutotuneConfig& config, const AutotuneCacheKey& key) {
+  std::string device_str = GetDeviceStrForCacheDir(config);
+  std::string file_path = GetCacheDirFilePath(config, device_str, key);
+  std::string textproto;
+  if (!tsl::ReadFileToString(tsl::Env::Default(), file_path, &textproto)
+           .ok()) {
+    return std::nullopt;
+  }
+
+  AutotuneResults results;
+  if (!tsl::protobuf::TextFormat::ParseFromString(textproto, &results) ||
+      results.version() != kVersion || results.results_size() != 1) {
+    LOG(WARNING) << "Ignoring malformed autotune result: " << file_path;
+    return std::nullopt;
+  }
+  // Different keys can have the same fingerprint.
+  const AutotuneResults::Entry& entry = results.results(0);
+  if (entry.device() != device_str || entry.hlo() != key.GetHlo()) {
+    return std::nullopt;
+  }
+  VLOG(1) << "Autotune result loaded from " << file_path;
+  return entry.result();
+}
+
+static Status WriteToCacheDir(const AutotuneConfig& config,
+                              const AutotuneCacheKey& key,
+                              const AutotuneResult& result) {
+  AutotuneResults results;
+  results.set_version(kVersion);
+  AutotuneResults::Entry& entry = *results.add_results();
+  std::string device_str = GetDeviceStrForCacheDir(config);
+  entry.set_device(device_str);
+  entry.set_hlo(std::string(key.GetHlo()));
+  *entry.mutable_result() = result;
+  std::string textproto;
+  if (!tsl::protobuf::TextFormat::PrintToString(results, &textproto)) {
+    return Internal("Failed to serialize autotune result.");
+  }
+
+  tsl::Env* env = tsl::Env::Default();
+  TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(config.autotune_cache_dir()));
+  // Write to a temporary file first, so that other processes never read a
+  // partially written result.
+  std::string file_path = GetCacheDirFilePath(config, device_str, key);
+  std::string temp_file_path = file_path;
+  if (!env->CreateUniqueFileName(&temp_file_path, ".tmp")) {
+    return Internal("Failed to create a temporary file name for %s",
+                    file_path);
+  }
+  TF_RETURN_IF_ERROR(tsl::WriteStringToFile(env, temp_file_path, textproto));
+  return env->RenameFile(temp_file_path, file_path);
+}
+
 /*static*/ StatusOr<AutotuneResult> AutotunerUtil::Autotune(
     const HloInstruction* instr, const AutotuneConfig& config,
     const AutotuneNoCacheFn& autotune_fn) {
   AutotuneCacheKey key(config.GetModelStr(), *instr);
   if (AutotuneResult* res = TryFindInCache(key)) {
+    RecordAutotuneCacheMemoryHit();
     return *res;
   }
 
+  const bool use_cache_dir =
+      !config.IsDeviceless() && !config.autotune_cache_dir().empty();
+  if (use_cache_dir) {
+    if (std::optional<AutotuneResult> res =
+            TryToLoadFromCacheDir(config, key)) {
+      RecordAutotuneCacheDirHit();
+      absl::MutexLock lock(&autotune_cache_mu);
+      auto [it, inserted] = autotune_cache.emplace(key, *std::move(res));
+      return it->second;
+    }
+  }
+  RecordAutotuneCacheMiss();
+
   TF_ASSIGN_OR_RETURN(AutotuneResult autotune_result, autotune_fn());
 
+  if (use_cache_dir) {
+    // Failing to share the result only costs other processes an autotuning.
+    if (Status status = WriteToCacheDir(config, key, autotune_result);
+        !status.ok()) {
+      LOG(WARNING) << "Failed to write autotune result to "
+                   << config.autotune_cache_dir() << ": " << status;
+    }
+  }
+
   absl::MutexLock lock(&autotune_cache_mu);
   auto [it, inserted] = autotune_cache.emplace(key, autotune_result);
   return it->second;
 }
 
-namespace {
-
-// Bump this version whenever you change the structure of the results.
-// LINT.IfChange(version)
-constexpr int kVersion = 2;
-// LINT.ThenChange()
-
-bool IsTextProtoPath(absl::string_view file_path) {
-  return absl::EndsWith(file_path, ".txt") ||
-         absl::EndsWith(file_path, ".textproto");
-}
-
-}  // anonymous namespace
-
 /*static*/ Status AutotunerUtil::LoadAutotuneResults(absl::string_view data,
                                                      bool as_textproto) {
   AutotuneResults results;
@@ -104,7 +104,9 @@ class AutotuneConfig {
         should_crash_on_check_failure_(
             debug_options.xla_gpu_crash_on_verification_failures()),
         exhaustive_tiling_search_(
-            debug_options.xla_gpu_exhaustive_tiling_search()) {}
+            debug_options.xla_gpu_exhaustive_tiling_search()),
+        autotune_cache_dir_(
+            debug_options.xla_gpu_per_fusion_autotune_cache_dir()) {}
 
   absl::string_view GetModelStr() const {
     if (auto deviceless_config = std::get_if<DevicelessConfig>(&config_)) {
@@ -138,11 +140,16 @@ class AutotuneConfig {
 
   bool ExhaustiveTilingSearch() const { return exhaustive_tiling_search_; }
 
+  // Directory in which autotuning results are shared between processes, or
+  // empty if they are only cached in memory.
+  const std::string& autotune_cache_dir() const { return autotune_cache_dir_; }
+
  private:
   std::variant<DeviceConfig, DevicelessConfig> config_;
   int32_t autotune_level_;
   bool should_crash_on_check_failure_;
   bool exhaustive_tiling_search_;
+  std::string autotune_cache_dir_;
 };
 
 using AutotuneNoCacheFn = std::function<StatusOr<AutotuneResult>()>;
@@ -154,6 +161,14 @@ struct AutotunerUtil {
       se::RedzoneAllocator& allocator, const Shape& shape,
       const AutotuneConfig& config, int64_t& rng_state);
 
+  // Returns the cached autotuning result for `instr`, or runs `autotune_fn` and
+  // caches its result.
+  //
+  // If `config.autotune_cache_dir()` is set, results that are not cached in
+  // memory are looked up in that directory before autotuning, and newly
+  // autotuned results are written to it. There, results are also keyed by the
+  // driver, CUDA runtime and cuDNN versions, so that the directory can be
+  // shared by processes running on different machines.
   static StatusOr<AutotuneResult> Autotune(
       const HloInstruction* instr, const AutotuneConfig& config,
       const AutotuneNoCacheFn& autotune_fn);
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
@@ -26,6 +27,8 @@ limitations under the License.
 #include "tensorflow/compiler/xla/autotune_results.pb.h"
 #include "tensorflow/compiler/xla/tests/hlo_test_base.h"
 #include "tensorflow/tsl/lib/core/status_test_util.h"
+#include "tensorflow/tsl/lib/monitoring/cell_reader.h"
+#include "tensorflow/tsl/platform/path.h"
 
 namespace xla {
 namespace gpu {
@@ -33,6 +36,7 @@ namespace {
 
 using ::absl::LogSeverity;
 using ::absl::ScopedMockLog;
+using ::tsl::monitoring::testing::CellReader;
 using ::testing::EndsWith;
 using ::testing::IsEmpty;
 using ::testing::Not;
@@ -127,6 +131,33 @@ TEST_F(AutotunerUtilTest, LoadAutotuneResultsFromFile_Protobuf) {
   TF_EXPECT_OK(AutotunerUtil::LoadAutotuneResultsFromFile(kFilePath));
 }
 
+TEST_F(AutotunerUtilTest, SharesResultsThroughAutotuneCacheDir) {
+  std::string cache_dir = GetUniqueTempFilePath("_autotune_cache");
+  auto optimize = [&]() -> Status {
+    TF_ASSIGN_OR_RETURN(auto module, ParseAndReturnVerifiedModule(kHloText));
+    DebugOptions debug_options = GetDebugOptionsForTest();
+    debug_options.set_xla_gpu_per_fusion_autotune_cache_dir(cache_dir);
+    module->config().set_debug_options(debug_options);
+    return GetOptimizedModule(std::move(module)).status();
+  };
+  CellReader<int64_t> lookups("/xla/service/gpu/autotune_cache_lookups");
+
+  AutotunerUtil::ClearAutotuneResults();
+  TF_EXPECT_OK(optimize());
+  EXPECT_GT(lookups.Delta("miss"), 0);
+  std::vector<std::string> files;
+  TF_EXPECT_OK(tsl::Env::Default()->GetMatchingPaths(
+      tsl::io::JoinPath(cache_dir, "*.textproto"), &files));
+  EXPECT_THAT(files, Not(IsEmpty()));
+
+  // A process that has not autotuned yet picks the results up from the
+  // directory.
+  AutotunerUtil::ClearAutotuneResults();
+  TF_EXPECT_OK(optimize());
+  EXPECT_GT(lookups.Delta("cache_dir_hit"), 0);
+  EXPECT_EQ(lookups.Delta("miss"), 0);
+}
+
 }  // namespace
 }  // namespace gpu
 }  // namespace xla
@@ -73,6 +73,10 @@ const absl::string_view kCudnnfMHAScaleMaskSoftmaxDropoutCallTarget =
     "__cudnn$fhmaScaleMaskSoftmaxDropout";
 const absl::string_view kCudnnfMHASoftmaxDropoutCallTarget =
     "__cudnn$fhmaSoftmaxDropout";
+const absl::string_view kCudnnfMHAFlashScaleSoftmaxCallTarget =
+    "__cudnn$fhmaFlashScaleSoftmax";
+const absl::string_view kCudnnfMHAFlashScaleSoftmaxBackwardCallTarget =
+    "__cudnn$fhmaFlashScaleSoftmaxBackward";
 
 bool IsCustomCallToDnnConvolution(const HloInstruction& hlo) {
   if (hlo.opcode() != HloOpcode::kCustomCall) {
@@ -104,7 +108,9 @@ bool IsCustomCallTofMHA(const HloInstruction& hlo) {
          target == kCudnnfMHAScaleMaskSoftmaxDropoutCallTarget ||
          target == kCudnnfMHASoftmaxDropoutCallTarget ||
          target == kCudnnfMHAScaleBiasSoftmaxCallTarget ||
-         target == kCudnnfMHAScaleBiasSoftmaxDropoutCallTarget;
+         target == kCudnnfMHAScaleBiasSoftmaxDropoutCallTarget ||
+         target == kCudnnfMHAFlashScaleSoftmaxCallTarget ||
+         target == kCudnnfMHAFlashScaleSoftmaxBackwardCallTarget;
 }
 
 StatusOr<CudnnConvKind> GetCudnnConvKind(
@@ -157,6 +163,10 @@ StatusOr<CudnnfMHAKind> GetCudnnfMHAKind(
     return CudnnfMHAKind::kScaleBiasSoftmax;
   if (target == kCudnnfMHAScaleBiasSoftmaxDropoutCallTarget)
     return CudnnfMHAKind::kScaleBiasSoftmaxDropout;
+  if (target == kCudnnfMHAFlashScaleSoftmaxCallTarget)
+    return CudnnfMHAKind::kFlashScaleSoftmax;
+  if (target == kCudnnfMHAFlashScaleSoftmaxBackwardCallTarget)
+    return CudnnfMHAKind::kFlashScaleSoftmaxBackward;
 
   return InternalError("Unexpected call target: %s", target);
 }
@@ -181,6 +191,10 @@ std::string CudnnfMHAKindToString(CudnnfMHAKind kind) {
       return "fmha_bias_softmax_with_dropout";
     case CudnnfMHAKind::kScaleBiasSoftmax:
       return "fmha_bias_softmax";
+    case CudnnfMHAKind::kFlashScaleSoftmax:
+      return "fmha_flash_scaled_softmax";
+    case CudnnfMHAKind::kFlashScaleSoftmaxBackward:
+      return "fmha_flash_scaled_softmax_backward";
   }
 }
 
@@ -55,6 +55,8 @@ enum class CudnnfMHAKind {
   kSoftmax,
   kScaleBiasSoftmax,
   kScaleBiasSoftmaxDropout,
+  kFlashScaleSoftmax,
+  kFlashScaleSoftmaxBackward,
 };
 
 StatusOr<CudnnConvKind> GetCudnnConvKind(const HloCustomCallInstruction* instr);
@@ -152,6 +154,11 @@ bool IsCudnnConvolutionReorder(const HloInstruction& hlo);
 // 6. BMM1 - Softmax - Dropout - BMM2
 // 7. BMM1 - Softmax - BMM2
 // 8. BMM1 - scale - Bias - Softmax - BMM2
+// 9. BMM1 - Scale - Softmax - BMM2, for training: additionally outputs the
+//    softmax statistics from which the backward pass recomputes the
+//    attention probabilities, instead of keeping the [seq, seq] probabilities
+//    alive until the backward pass.
+// 10. The backward pass of 9., producing the gradients of the BMM inputs.
 extern const absl::string_view kCudnnfMHABmmBmmCallTarget;
 extern const absl::string_view kCudnnfMHASoftmaxCallTarget;
 extern const absl::string_view kCudnnfMHAScaleBiasMaskSoftmaxCallTarget;
@@ -161,6 +168,8 @@ extern const absl::string_view kCudnnfMHAScaleMaskSoftmaxDropoutCallTarget;
 extern const absl::string_view kCudnnfMHASoftmaxDropoutCallTarget;
 extern const absl::string_view kCudnnfMHAScaleBiasSoftmaxDropoutCallTarget;
 extern const absl::string_view kCudnnfMHAScaleBiasSoftmaxCallTarget;
+extern const absl::string_view kCudnnfMHAFlashScaleSoftmaxCallTarget;
+extern const absl::string_view kCudnnfMHAFlashScaleSoftmaxBackwardCallTarget;
 
 bool IsCustomCallTofMHA(const HloInstruction& hlo);
 
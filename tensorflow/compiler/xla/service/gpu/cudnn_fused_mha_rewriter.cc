@@ -205,16 +205,26 @@ Status SetName(HloModule* module, HloInstruction* fmha) {
                                     "fmha-bmm-scale-bias-softmax-dropout-bmm");
     return OkStatus();
   }
+  if (fmha->custom_call_target() == kCudnnfMHAFlashScaleSoftmaxCallTarget) {
+    module->SetAndUniquifyInstrName(fmha, "fmha-flash-bmm-scale-softmax-bmm");
+    return OkStatus();
+  }
+  if (fmha->custom_call_target() ==
+      kCudnnfMHAFlashScaleSoftmaxBackwardCallTarget) {
+    module->SetAndUniquifyInstrName(
+        fmha, "fmha-flash-bmm-scale-softmax-bmm-backward");
+    return OkStatus();
+  }
 
   return InternalError(
       "Found invalid FMHA custom-call target while setting custom-call name");
 }
 
-bool IsComputeCapabilityAndCudnnSupported(
-    stream_executor::CudaComputeCapability cc,
+// Returns the version of cuDNN loaded by `stream_exec` if there is one, or
+// `cudnn_version` otherwise.
+se::dnn::VersionInfo GetRealCudnnVersion(
     stream_executor::dnn::VersionInfo cudnn_version,
     stream_executor::StreamExecutor* stream_exec) {
-  // return true;
   se::dnn::VersionInfo real_cudnn_version;
   if (stream_exec) {
     stream_executor::dnn::DnnSupport* dnn = stream_exec->AsDnn();
@@ -225,7 +235,15 @@ bool IsComputeCapabilityAndCudnnSupported(
   } else {
     real_cudnn_version = cudnn_version;
   }
+  return real_cudnn_version;
+}
 
+bool IsComputeCapabilityAndCudnnSupported(
+    stream_executor::CudaComputeCapability cc,
+    stream_executor::dnn::VersionInfo cudnn_version,
+    stream_executor::StreamExecutor* stream_exec) {
+  se::dnn::VersionInfo real_cudnn_version =
+      GetRealCudnnVersion(cudnn_version, stream_exec);
   if (!((cc.IsAtLeast(se::CudaComputeCapability::AMPERE) && cc.minor == 0) &&
         (real_cudnn_version.major_version() == 8 &&
          real_cudnn_version.minor_version() >= 8))) {
@@ -850,6 +868,252 @@ StatusOr<bool> FuseMultiHeadedAttentionBlock(
   changed = true;
   return changed;
 }
+
+bool IsFlashAttentionSupported(se::dnn::VersionInfo cudnn_version) {
+  return cudnn_version.major_version() > 8 ||
+         (cudnn_version.major_version() == 8 &&
+          cudnn_version.minor_version() >= 9);
+}
+
+bool HasDotContractingDims(const HloInstruction* instr, int64_t lhs_dim,
+                           int64_t rhs_dim) {
+  if (!IsBatchedMatmul(instr) || !IsRankSupported(instr)) return false;
+  const DotDimensionNumbers& dnums = instr->dot_dimension_numbers();
+  return IsBatchDimSizeSupported(dnums) &&
+         absl::c_equal(dnums.lhs_batch_dimensions(), std::vector{0, 1}) &&
+         absl::c_equal(dnums.rhs_batch_dimensions(), std::vector{0, 1}) &&
+         absl::c_equal(dnums.lhs_contracting_dimensions(),
+                       std::vector{lhs_dim}) &&
+         absl::c_equal(dnums.rhs_contracting_dimensions(),
+                       std::vector{rhs_dim});
+}
+
+// Returns the user of `instr` that is a dot of `lhs` and `rhs` contracting
+// `lhs_dim` and `rhs_dim`, or nullptr.
+HloInstruction* FindDotUser(const HloInstruction* instr,
+                            const HloInstruction* lhs,
+                            const HloInstruction* rhs, int64_t lhs_dim,
+                            int64_t rhs_dim) {
+  for (HloInstruction* user : instr->users()) {
+    if (user->operand(0) == lhs && user->operand(1) == rhs &&
+        HasDotContractingDims(user, lhs_dim, rhs_dim)) {
+      return user;
+    }
+  }
+  return nullptr;
+}
+
+// The instructions of a BMM1 - (Scale) - Softmax - BMM2 block and of its
+// gradient, as emitted by autodiff:
+//   P  = softmax(scale * dot(Q, K))
+//   O  = dot(P, V)
+//   dV = dot(P, dO)
+//   dP = dot(dO, V)
+//   dS = scale * (P * (dP - broadcast(reduce_sum(dP * P))))
+//   dQ = dot(dS, K)
+//   dK = dot(dS, Q)
+// with Q, K, V, O and their gradients of shape [batch, heads, seq, head_dim].
+struct FlashAttentionTrainingBlock {
+  HloInstruction* bmm_1 = nullptr;
+  HloInstruction* bmm_2 = nullptr;
+  HloInstruction* scale = nullptr;
+  HloInstruction* d_output = nullptr;
+  HloInstruction* d_lhs_bmm1 = nullptr;
+  HloInstruction* d_rhs_bmm1 = nullptr;
+  HloInstruction* d_rhs_bmm2 = nullptr;
+};
+
+// Matches the training block rooted at `instr` (BMM2). Only the canonical
+// dot dimension numbers above are matched, so that the fused call can hand
+// the operands to cuDNN without transposes.
+bool MatchFlashAttentionTraining(HloInstruction* instr,
+                                 FlashAttentionTrainingBlock* block) {
+  if (!HasDotContractingDims(instr, 3, 2)) return false;
+  HloInstruction* softmax_input = nullptr;
+  HloInstruction* softmax = instr->mutable_operand(0);
+  if (!Match(softmax, GetUnfusedReduceMaxSumSoftmaxPattern(&softmax_input))) {
+    return false;
+  }
+  HloInstruction* bmm_1 = nullptr;
+  HloInstruction* scale = nullptr;
+  if (!Match(softmax_input,
+             m::AnyOf<HloInstruction>(
+                 m::Op(&bmm_1),
+                 m::MultiplyAnyOrder(
+                     m::Op(&bmm_1),
+                     m::Broadcast(m::Constant(&scale).WithPredicate(
+                         IsScalar))))) ||
+      !HasDotContractingDims(bmm_1, 3, 3)) {
+    return false;
+  }
+  HloInstruction* lhs_bmm1 = bmm_1->mutable_operand(0);
+  HloInstruction* rhs_bmm1 = bmm_1->mutable_operand(1);
+  HloInstruction* rhs_bmm2 = instr->mutable_operand(1);
+
+  // dV is the only user of P that contracts its query dimension.
+  HloInstruction* d_rhs_bmm2 = nullptr;
+  for (HloInstruction* user : softmax->users()) {
+    if (user->operand(0) == softmax && HasDotContractingDims(user, 2, 2)) {
+      d_rhs_bmm2 = user;
+      break;
+    }
+  }
+  if (d_rhs_bmm2 == nullptr) return false;
+  HloInstruction* d_output = d_rhs_bmm2->mutable_operand(1);
+  HloInstruction* d_softmax = FindDotUser(rhs_bmm2, d_output, rhs_bmm2, 3, 3);
+  if (d_softmax == nullptr) return false;
+
+  // The gradient of the softmax.
+  auto d_softmax_row_sum = m::Op()
+                               .WithPredicate(IsReduceSum)
+                               .WithOperand(0, m::MultiplyAnyOrder(
+                                                   m::Op().Is(d_softmax),
+                                                   m::Op().Is(softmax)));
+  auto d_softmax_input_pattern = m::MultiplyAnyOrder(
+      m::Op().Is(softmax),
+      m::Subtract(m::Op().Is(d_softmax), m::Broadcast(d_softmax_row_sum)));
+  HloInstruction* d_softmax_input = nullptr;
+  for (HloInstruction* user : softmax->users()) {
+    if (Match(user, d_softmax_input_pattern)) {
+      d_softmax_input = user;
+      break;
+    }
+  }
+  if (d_softmax_input == nullptr) return false;
+  HloInstruction* d_bmm_1 = d_softmax_input;
+  if (scale != nullptr) {
+    HloInstruction* d_scale = nullptr;
+    if (d_softmax_input->user_count() != 1 ||
+        !Match(d_softmax_input->users()[0],
+               m::MultiplyAnyOrder(
+                   &d_bmm_1, m::Op().Is(d_softmax_input),
+                   m::Broadcast(
+                       m::Constant(&d_scale).WithPredicate(IsScalar)))) ||
+        GetConstantValue(d_scale) != GetConstantValue(scale)) {
+      return false;
+    }
+  }
+  HloInstruction* d_lhs_bmm1 = FindDotUser(d_bmm_1, d_bmm_1, rhs_bmm1, 3, 2);
+  HloInstruction* d_rhs_bmm1 = FindDotUser(d_bmm_1, d_bmm_1, lhs_bmm1, 2, 2);
+  if (d_lhs_bmm1 == nullptr || d_rhs_bmm1 == nullptr) return false;
+
+  for (const HloInstruction* bmm :
+       {bmm_1, instr, d_lhs_bmm1, d_rhs_bmm1, d_rhs_bmm2}) {
+    if (!IsSupportedPrimitiveType(bmm)) return false;
+  }
+  // The head dimension of Q, K and V needs to be 64 or 128.
+  for (const HloInstruction* operand : {lhs_bmm1, rhs_bmm1, rhs_bmm2}) {
+    int64_t head_dim = operand->shape().dimensions(3);
+    if (head_dim != 64 && head_dim != 128) {
+      VLOG(2) << "Head dimension " << head_dim
+              << " is not supported by flash attention.";
+      return false;
+    }
+  }
+
+  block->bmm_1 = bmm_1;
+  block->bmm_2 = instr;
+  block->scale = scale;
+  block->d_output = d_output;
+  block->d_lhs_bmm1 = d_lhs_bmm1;
+  block->d_rhs_bmm1 = d_rhs_bmm1;
+  block->d_rhs_bmm2 = d_rhs_bmm2;
+  return true;
+}
+
+// Replaces the training block with a forward flash attention call, which
+// saves the per-row softmax statistics instead of the [seq, seq] softmax
+// output, and a backward call that recomputes the softmax from them.
+StatusOr<bool> FuseFlashAttentionTrainingBlock(
+    HloComputation* comp, const FlashAttentionTrainingBlock& block) {
+  if (VLOG_IS_ON(2)) {
+    VLOG(2) << "Before CudnnFusedMHARewriter flash attention: \n"
+            << comp->parent()->ToString();
+  }
+  HloInstruction* bmm_1 = block.bmm_1;
+  HloInstruction* bmm_2 = block.bmm_2;
+  HloInstruction* lhs_bmm1 = bmm_1->mutable_operand(0);
+  HloInstruction* rhs_bmm1 = bmm_1->mutable_operand(1);
+  HloInstruction* rhs_bmm2 = bmm_2->mutable_operand(1);
+
+  CudnnfMHABackendConfig fmha_config;
+  *fmha_config.mutable_bmm1_dot_dimension_numbers() =
+      bmm_1->dot_dimension_numbers();
+  *fmha_config.mutable_bmm2_dot_dimension_numbers() =
+      bmm_2->dot_dimension_numbers();
+  double scale_value = 1.0;
+  if (block.scale != nullptr) {
+    std::optional<double> value = GetConstantValue(block.scale);
+    TF_RET_CHECK(value.has_value());
+    scale_value = *value;
+  }
+  fmha_config.set_fmha_scale(scale_value);
+  *fmha_config.mutable_intermediate_tensor_shape() = bmm_1->shape().ToProto();
+  {
+    auto* algorithm = fmha_config.mutable_algorithm();
+    algorithm->set_algo_id(0);  // engine id
+    algorithm->set_math_type(se::dnn::AlgorithmProto::TENSOR_OP_MATH);
+    std::vector<int64_t> knob_ids = {17, 24};
+    std::vector<int64_t> knob_vals = {1, 0};
+    for (int i = 0; i < knob_ids.size(); ++i) {
+      (*algorithm->mutable_tuning_knobs())[knob_ids[i]] = knob_vals[i];
+    }
+    algorithm->set_is_cudnn_frontend(true);
+    algorithm->mutable_workspace_size()->set_value(0);
+  }
+
+  // The softmax statistics hold one F32 value per row of the intermediate
+  // tensor.
+  const Shape& output_shape = bmm_2->shape();
+  absl::Span<const int64_t> dims = output_shape.dimensions();
+  Shape stats_shape = ShapeUtil::MakeShape(F32, {dims[0], dims[1], dims[2], 1});
+  HloInstruction* fmha_call =
+      comp->AddInstruction(HloInstruction::CreateCustomCall(
+          ShapeUtil::MakeTupleShape(
+              {output_shape, stats_shape, ShapeUtil::MakeShape(U8, {0})}),
+          {lhs_bmm1, rhs_bmm1, rhs_bmm2},
+          kCudnnfMHAFlashScaleSoftmaxCallTarget));
+  TF_RETURN_IF_ERROR(fmha_call->set_backend_config(fmha_config));
+  TF_RETURN_IF_ERROR(SetName(bmm_1->GetModule(), fmha_call));
+  fmha_call->set_metadata(bmm_1->metadata());
+  HloInstruction* output = comp->AddInstruction(
+      HloInstruction::CreateGetTupleElement(output_shape, fmha_call, 0));
+  HloInstruction* stats = comp->AddInstruction(
+      HloInstruction::CreateGetTupleElement(stats_shape, fmha_call, 1));
+
+  // The backward pass accumulates the gradient of the lhs of BMM1 in F32 and
+  // keeps one F32 value per row of the intermediate tensor.
+  int64_t scratch_size =
+      ShapeUtil::ElementsIn(output_shape) * sizeof(float) +
+      ShapeUtil::ElementsIn(stats_shape) * sizeof(float);
+  fmha_config.mutable_algorithm()->mutable_workspace_size()->set_value(
+      scratch_size);
+  HloInstruction* fmha_backward_call =
+      comp->AddInstruction(HloInstruction::CreateCustomCall(
+          ShapeUtil::MakeTupleShape({block.d_lhs_bmm1->shape(),
+                                     block.d_rhs_bmm1->shape(),
+                                     block.d_rhs_bmm2->shape(),
+                                     ShapeUtil::MakeShape(U8, {scratch_size})}),
+          {lhs_bmm1, rhs_bmm1, rhs_bmm2, output, stats, block.d_output},
+          kCudnnfMHAFlashScaleSoftmaxBackwardCallTarget));
+  TF_RETURN_IF_ERROR(fmha_backward_call->set_backend_config(fmha_config));
+  TF_RETURN_IF_ERROR(SetName(bmm_1->GetModule(), fmha_backward_call));
+  fmha_backward_call->set_metadata(block.d_lhs_bmm1->metadata());
+
+  TF_RETURN_IF_ERROR(comp->ReplaceInstruction(bmm_2, output));
+  int64_t index = 0;
+  for (HloInstruction* grad :
+       {block.d_lhs_bmm1, block.d_rhs_bmm1, block.d_rhs_bmm2}) {
+    TF_RETURN_IF_ERROR(comp->ReplaceWithNewInstruction(
+        grad, HloInstruction::CreateGetTupleElement(
+                  grad->shape(), fmha_backward_call, index++)));
+  }
+  if (VLOG_IS_ON(2)) {
+    VLOG(2) << "After CudnnFusedMHARewriter flash attention: \n"
+            << comp->parent()->ToString();
+  }
+  return true;
+}
 }  // namespace
 
 StatusOr<bool> CudnnFusedMHARewriter::Run(
@@ -865,6 +1129,26 @@ StatusOr<bool> CudnnFusedMHARewriter::Run(
             compute_capability_, cudnn_version_, stream_executor_)) {
       return false;
     }
+    // Fuse the training graphs first, since the forward patterns below would
+    // keep the softmax output alive for the backward pass, or match the dot
+    // computing the gradient of BMM2's rhs.
+    // The blocks are all matched before any is fused, since fusing one
+    // removes instructions that come later in post order.
+    std::vector<FlashAttentionTrainingBlock> training_blocks;
+    if (IsFlashAttentionSupported(
+            GetRealCudnnVersion(cudnn_version_, stream_executor_))) {
+      for (HloInstruction* instr : comp->MakeInstructionPostOrder()) {
+        FlashAttentionTrainingBlock training_block;
+        if (MatchFlashAttentionTraining(instr, &training_block)) {
+          training_blocks.push_back(training_block);
+        }
+      }
+    }
+    for (const FlashAttentionTrainingBlock& training_block : training_blocks) {
+      TF_ASSIGN_OR_RETURN(
+          bool changed, FuseFlashAttentionTrainingBlock(comp, training_block));
+      any_changed |= changed;
+    }
     for (HloInstruction* instr : comp->MakeInstructionPostOrder()) {
       HloInstruction* bmm_1;
       HloInstruction* bmm_2;
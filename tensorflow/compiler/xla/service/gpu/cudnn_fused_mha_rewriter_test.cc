@@ -975,6 +975,91 @@ ENTRY main.6 {
                              .WithShape(BF16, {16, 16, 64, 256})));
 }
 
+TEST_F(CudnnFusedMhaRewriterTestHloTest,
+       BF16Bmm1ScaleSoftmaxBmm2TrainingFlashAttention) {
+  const char* module_str = R"(
+HloModule fmha_training
+
+region_max {
+  Arg_0 = bf16[] parameter(0)
+  Arg_1 = bf16[] parameter(1)
+  ROOT maximum = bf16[] maximum(Arg_0, Arg_1)
+}
+
+region_add {
+  Arg_0 = bf16[] parameter(0)
+  Arg_1 = bf16[] parameter(1)
+  ROOT add = bf16[] add(Arg_0, Arg_1)
+}
+
+ENTRY main {
+  q = bf16[2,4,128,64]{3,2,1,0} parameter(0)
+  k = bf16[2,4,128,64]{3,2,1,0} parameter(1)
+  v = bf16[2,4,128,64]{3,2,1,0} parameter(2)
+  d_o = bf16[2,4,128,64]{3,2,1,0} parameter(3)
+  s = bf16[2,4,128,128]{3,2,1,0} dot(q, k), lhs_batch_dims={0,1}, lhs_contracting_dims={3}, rhs_batch_dims={0,1}, rhs_contracting_dims={3}
+  scale = bf16[] constant(0.125)
+  scale_b = bf16[2,4,128,128]{3,2,1,0} broadcast(scale), dimensions={}
+  scaled = bf16[2,4,128,128]{3,2,1,0} multiply(s, scale_b)
+  neg_inf = bf16[] constant(-inf)
+  max = bf16[2,4,128]{2,1,0} reduce(scaled, neg_inf), dimensions={3}, to_apply=region_max
+  max_b = bf16[2,4,128,128]{3,2,1,0} broadcast(max), dimensions={0,1,2}
+  sub = bf16[2,4,128,128]{3,2,1,0} subtract(scaled, max_b)
+  exp = bf16[2,4,128,128]{3,2,1,0} exponential(sub)
+  zero = bf16[] constant(0)
+  sum = bf16[2,4,128]{2,1,0} reduce(exp, zero), dimensions={3}, to_apply=region_add
+  sum_b = bf16[2,4,128,128]{3,2,1,0} broadcast(sum), dimensions={0,1,2}
+  p = bf16[2,4,128,128]{3,2,1,0} divide(exp, sum_b)
+  o = bf16[2,4,128,64]{3,2,1,0} dot(p, v), lhs_batch_dims={0,1}, lhs_contracting_dims={3}, rhs_batch_dims={0,1}, rhs_contracting_dims={2}
+  d_v = bf16[2,4,128,64]{3,2,1,0} dot(p, d_o), lhs_batch_dims={0,1}, lhs_contracting_dims={2}, rhs_batch_dims={0,1}, rhs_contracting_dims={2}
+  d_p = bf16[2,4,128,128]{3,2,1,0} dot(d_o, v), lhs_batch_dims={0,1}, lhs_contracting_dims={3}, rhs_batch_dims={0,1}, rhs_contracting_dims={3}
+  d_p_p = bf16[2,4,128,128]{3,2,1,0} multiply(d_p, p)
+  row_sum = bf16[2,4,128]{2,1,0} reduce(d_p_p, zero), dimensions={3}, to_apply=region_add
+  row_sum_b = bf16[2,4,128,128]{3,2,1,0} broadcast(row_sum), dimensions={0,1,2}
+  d_p_sub = bf16[2,4,128,128]{3,2,1,0} subtract(d_p, row_sum_b)
+  d_scaled = bf16[2,4,128,128]{3,2,1,0} multiply(p, d_p_sub)
+  d_s = bf16[2,4,128,128]{3,2,1,0} multiply(d_scaled, scale_b)
+  d_q = bf16[2,4,128,64]{3,2,1,0} dot(d_s, k), lhs_batch_dims={0,1}, lhs_contracting_dims={3}, rhs_batch_dims={0,1}, rhs_contracting_dims={2}
+  d_k = bf16[2,4,128,64]{3,2,1,0} dot(d_s, q), lhs_batch_dims={0,1}, lhs_contracting_dims={2}, rhs_batch_dims={0,1}, rhs_contracting_dims={2}
+  ROOT t = (bf16[2,4,128,64]{3,2,1,0}, bf16[2,4,128,64]{3,2,1,0}, bf16[2,4,128,64]{3,2,1,0}, bf16[2,4,128,64]{3,2,1,0}) tuple(o, d_q, d_k, d_v)
+}
+)";
+
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto m, ParseAndReturnVerifiedModule(module_str, GetModuleConfig()));
+  // Flash attention needs cuDNN 8.9.
+  CudnnFusedMHARewriter fusedMhaRewriter{GetCudaComputeCapability(),
+                                         se::dnn::VersionInfo(8, 9, 0)};
+  TF_ASSERT_OK(RunHloPass(&fusedMhaRewriter, m.get()).status());
+  const HloInstruction* fmha;
+  const HloInstruction* fmha_backward;
+
+  SCOPED_TRACE(m->ToString());
+  auto fmha_pattern =
+      m::CustomCall(&fmha, {kCudnnfMHAFlashScaleSoftmaxCallTarget},
+                    m::Parameter(0), m::Parameter(1), m::Parameter(2));
+  auto fmha_backward_pattern = m::CustomCall(
+      &fmha_backward, {kCudnnfMHAFlashScaleSoftmaxBackwardCallTarget},
+      m::Parameter(0), m::Parameter(1), m::Parameter(2),
+      m::GetTupleElement(fmha_pattern, 0), m::GetTupleElement(fmha_pattern, 1),
+      m::Parameter(3));
+  EXPECT_THAT(
+      m->entry_computation()->root_instruction(),
+      GmockMatch(m::Tuple(m::GetTupleElement(fmha_pattern, 0),
+                          m::GetTupleElement(fmha_backward_pattern, 0),
+                          m::GetTupleElement(fmha_backward_pattern, 1),
+                          m::GetTupleElement(fmha_backward_pattern, 2))));
+  EXPECT_TRUE(ShapeUtil::Equal(fmha->shape().tuple_shapes(1),
+                               ShapeUtil::MakeShape(F32, {2, 4, 128, 1})));
+  TF_ASSERT_OK_AND_ASSIGN(auto config,
+                          fmha->backend_config<CudnnfMHABackendConfig>());
+  EXPECT_EQ(config.fmha_scale(), 0.125);
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto backward_config,
+      fmha_backward->backend_config<CudnnfMHABackendConfig>());
+  EXPECT_EQ(backward_config.fmha_scale(), 0.125);
+}
+
 }  // anonymous namespace
 }  // namespace gpu
 }  // namespace xla
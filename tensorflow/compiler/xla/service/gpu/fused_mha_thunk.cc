@@ -38,7 +38,8 @@ FusedMHAThunk::FusedMHAThunk(ThunkInfo thunk_info, GpufMHAConfig config,
                              BufferAllocation::Slice output,
                              BufferAllocation::Slice scratch,
                              BufferAllocation::Slice mask,
-                             BufferAllocation::Slice bias)
+                             BufferAllocation::Slice bias,
+                             BufferAllocation::Slice softmax_stats)
     : Thunk(Kind::kFusedMHA, thunk_info),
       lhs_bmm1_buffer_(lhs_bmm1),
       rhs_bmm1_buffer_(rhs_bmm1),
@@ -47,6 +48,7 @@ FusedMHAThunk::FusedMHAThunk(ThunkInfo thunk_info, GpufMHAConfig config,
       scratch_buffer_(scratch),
       mask_buffer_(mask),
       bias_buffer_(bias),
+      softmax_stats_buffer_(softmax_stats),
       config_(std::move(config)) {}
 
 FusedMultiHeadedAttentionRunner& FusedMHAThunk::GetOrCreateRunner(
@@ -83,17 +85,79 @@ Status FusedMHAThunk::ExecuteOnStream(const ExecuteParams& params) {
   if (bias_buffer_.allocation() != nullptr) {
     bias_buffer = buffer_allocations.GetDeviceAddress(bias_buffer_);
   }
+  se::DeviceMemoryBase softmax_stats_buffer;
+  if (softmax_stats_buffer_.allocation() != nullptr) {
+    softmax_stats_buffer =
+        buffer_allocations.GetDeviceAddress(softmax_stats_buffer_);
+  }
 
   RunFusedMHAOptions opts;
   opts.runner_cache = &GetOrCreateRunner(params.stream);
 
   TF_RETURN_IF_ERROR(RunGpuFMHA(config_, lhs_bmm1_buffer, rhs_bmm1_buffer,
                                 rhs_bmm2_buffer, output_buffer, scratch_buffer,
-                                mask_buffer, bias_buffer, params.stream, opts));
+                                mask_buffer, bias_buffer, softmax_stats_buffer,
+                                params.stream, opts));
   if (!params.stream->ok()) {
     return InternalError("FusedMHAThunk::ExecuteOnStream failed.");
   }
   return OkStatus();
 }
+
+FusedMHABackwardThunk::FusedMHABackwardThunk(
+    ThunkInfo thunk_info, GpufMHAConfig config,
+    BufferAllocation::Slice lhs_bmm1, BufferAllocation::Slice rhs_bmm1,
+    BufferAllocation::Slice rhs_bmm2, BufferAllocation::Slice output,
+    BufferAllocation::Slice softmax_stats, BufferAllocation::Slice d_output,
+    BufferAllocation::Slice d_lhs_bmm1, BufferAllocation::Slice d_rhs_bmm1,
+    BufferAllocation::Slice d_rhs_bmm2, BufferAllocation::Slice scratch)
+    : Thunk(Kind::kFusedMHABackward, thunk_info),
+      lhs_bmm1_buffer_(lhs_bmm1),
+      rhs_bmm1_buffer_(rhs_bmm1),
+      rhs_bmm2_buffer_(rhs_bmm2),
+      output_buffer_(output),
+      softmax_stats_buffer_(softmax_stats),
+      d_output_buffer_(d_output),
+      d_lhs_bmm1_buffer_(d_lhs_bmm1),
+      d_rhs_bmm1_buffer_(d_rhs_bmm1),
+      d_rhs_bmm2_buffer_(d_rhs_bmm2),
+      scratch_buffer_(scratch),
+      config_(std::move(config)) {}
+
+FusedMultiHeadedAttentionRunner& FusedMHABackwardThunk::GetOrCreateRunner(
+    const stream_executor::Stream* stream) {
+  absl::MutexLock lock(&mu_);
+  auto it = runner_cache_.find(stream);
+  if (it == runner_cache_.end()) {
+    it = runner_cache_
+             .insert({stream, std::make_unique<FusedMultiHeadedAttentionRunner>(
+                                  config_)})
+             .first;
+  }
+  return *it->second;
+}
+
+Status FusedMHABackwardThunk::ExecuteOnStream(const ExecuteParams& params) {
+  const auto& buffer_allocations = *params.buffer_allocations;
+  RunFusedMHAOptions opts;
+  opts.runner_cache = &GetOrCreateRunner(params.stream);
+
+  TF_RETURN_IF_ERROR(RunGpuFMHABackward(
+      config_, buffer_allocations.GetDeviceAddress(lhs_bmm1_buffer_),
+      buffer_allocations.GetDeviceAddress(rhs_bmm1_buffer_),
+      buffer_allocations.GetDeviceAddress(rhs_bmm2_buffer_),
+      buffer_allocations.GetDeviceAddress(output_buffer_),
+      buffer_allocations.GetDeviceAddress(softmax_stats_buffer_),
+      buffer_allocations.GetDeviceAddress(d_output_buffer_),
+      buffer_allocations.GetDeviceAddress(d_lhs_bmm1_buffer_),
+      buffer_allocations.GetDeviceAddress(d_rhs_bmm1_buffer_),
+      buffer_allocations.GetDeviceAddress(d_rhs_bmm2_buffer_),
+      buffer_allocations.GetDeviceAddress(scratch_buffer_), params.stream,
+      opts));
+  if (!params.stream->ok()) {
+    return InternalError("FusedMHABackwardThunk::ExecuteOnStream failed.");
+  }
+  return OkStatus();
+}
 }  // namespace gpu
 }  // namespace xla
@@ -49,7 +49,8 @@ class FusedMHAThunk : public Thunk {
                 BufferAllocation::Slice output_slice,
                 BufferAllocation::Slice scratch_slice,
                 BufferAllocation::Slice mask_slice, /* may be null */
-                BufferAllocation::Slice bias_slice /* may be null */);
+                BufferAllocation::Slice bias_slice, /* may be null */
+                BufferAllocation::Slice softmax_stats_slice /* may be null */);
 
   FusedMHAThunk(const FusedMHAThunk&) = delete;
   FusedMHAThunk& operator=(const FusedMHAThunk&) = delete;
@@ -64,6 +65,7 @@ class FusedMHAThunk : public Thunk {
   BufferAllocation::Slice scratch_buffer_;
   BufferAllocation::Slice mask_buffer_;
   BufferAllocation::Slice bias_buffer_;
+  BufferAllocation::Slice softmax_stats_buffer_;
 
   FusedMultiHeadedAttentionRunner& GetOrCreateRunner(
       const stream_executor::Stream* stream);
@@ -75,6 +77,51 @@ class FusedMHAThunk : public Thunk {
                       std::unique_ptr<FusedMultiHeadedAttentionRunner>>
       runner_cache_ ABSL_GUARDED_BY(mu_);
 };
+
+// Launches the flash attention backward pass, which recomputes the attention
+// probabilities from the softmax statistics saved by the forward pass.
+//
+// This is thread-compatible.
+class FusedMHABackwardThunk : public Thunk {
+ public:
+  FusedMHABackwardThunk(ThunkInfo thunk_info, GpufMHAConfig config,
+                        BufferAllocation::Slice lhs_bmm1_slice,
+                        BufferAllocation::Slice rhs_bmm1_slice,
+                        BufferAllocation::Slice rhs_bmm2_slice,
+                        BufferAllocation::Slice output_slice,
+                        BufferAllocation::Slice softmax_stats_slice,
+                        BufferAllocation::Slice d_output_slice,
+                        BufferAllocation::Slice d_lhs_bmm1_slice,
+                        BufferAllocation::Slice d_rhs_bmm1_slice,
+                        BufferAllocation::Slice d_rhs_bmm2_slice,
+                        BufferAllocation::Slice scratch_slice);
+
+  FusedMHABackwardThunk(const FusedMHABackwardThunk&) = delete;
+  FusedMHABackwardThunk& operator=(const FusedMHABackwardThunk&) = delete;
+
+  Status ExecuteOnStream(const ExecuteParams& params) override;
+
+ private:
+  BufferAllocation::Slice lhs_bmm1_buffer_;
+  BufferAllocation::Slice rhs_bmm1_buffer_;
+  BufferAllocation::Slice rhs_bmm2_buffer_;
+  BufferAllocation::Slice output_buffer_;
+  BufferAllocation::Slice softmax_stats_buffer_;
+  BufferAllocation::Slice d_output_buffer_;
+  BufferAllocation::Slice d_lhs_bmm1_buffer_;
+  BufferAllocation::Slice d_rhs_bmm1_buffer_;
+  BufferAllocation::Slice d_rhs_bmm2_buffer_;
+  BufferAllocation::Slice scratch_buffer_;
+
+  FusedMultiHeadedAttentionRunner& GetOrCreateRunner(
+      const stream_executor::Stream* stream);
+
+  const GpufMHAConfig config_;
+  absl::Mutex mu_;
+  absl::flat_hash_map<const stream_executor::Stream*,
+                      std::unique_ptr<FusedMultiHeadedAttentionRunner>>
+      runner_cache_ ABSL_GUARDED_BY(mu_);
+};
 }  // namespace gpu
 }  // namespace xla
 #endif  // TENSORFLOW_COMPILER_XLA_SERVICE_GPU_FUSED_MHA_THUNK_H_
@@ -107,11 +107,29 @@ bool IsSupportedDataType(PrimitiveType t, GpuVersion gpu_version) {
     case BF16:
       return cuda_compute_capability.IsAtLeast(
           stream_executor::CudaComputeCapability::AMPERE);
+    case F8E4M3FN:
+    case F8E5M2:
+      return cuda_compute_capability.IsAtLeast(
+          stream_executor::CudaComputeCapability::HOPPER);
     default:
       return false;
   }
 }
 
+// Tells if `hlo` broadcasts a scalar, e.g. a per-tensor scaling factor.
+bool IsBroadcastOfScalar(const HloInstruction& hlo) {
+  return hlo.opcode() == HloOpcode::kBroadcast &&
+         ShapeUtil::IsScalar(hlo.operand(0)->shape());
+}
+
+// Tells if `hlo` multiplies its other operand by a broadcast scalar, like the
+// dequantization of an int8 or FP8 tensor with a per-tensor scale does.
+bool IsScalingByBroadcastScalar(const HloInstruction& hlo) {
+  return hlo.opcode() == HloOpcode::kMultiply &&
+         (IsBroadcastOfScalar(*hlo.operand(0)) ||
+          IsBroadcastOfScalar(*hlo.operand(1)));
+}
+
 Status RequireTritonFusibleConvert(const HloInstruction* input,
                                    GpuVersion gpu_version) {
   if (!IsSupportedDataType(input->operand(0)->shape().element_type(),
@@ -189,7 +207,7 @@ class DimensionOrder {
       }
       return HandleBitcast(hlo);
     } else if (hlo_query::IsScalarConstant(hlo) ||
-               hlo_query::IsBroadcastOfScalarConstant(*hlo)) {
+               IsBroadcastOfScalar(*hlo)) {
       // Dimension order collapses on a scalar, for simplicity leave it equal
       // to the output one for now.
       return OkStatus();
@@ -461,6 +479,11 @@ Status CanFuse(const HloInstruction* hlo, DimensionOrder& dim_order,
                const GpuVersion gpu_version) {
   if (hlo->opcode() == HloOpcode::kConvert) {
     return RequireTritonFusibleConvert(hlo, gpu_version);
+  } else if (IsScalingByBroadcastScalar(*hlo)) {
+    // Dequantization of the operand while it is loaded.
+    if (!IsSupportedDataType(hlo->shape().element_type(), gpu_version)) {
+      return Unimplemented("unsupported data type");
+    }
   } else if (hlo->IsElementwise() && hlo->opcode() != HloOpcode::kCopy) {
     // Temporarily forbid fusing elementwise operations
     // other than copy and convert.
@@ -470,6 +493,27 @@ Status CanFuse(const HloInstruction* hlo, DimensionOrder& dim_order,
   return RequireTritonGemmSupportedDimOrder(dim_order);
 }
 
+// Tells if `hlo`, the only user of `producer` which is a dot or its fused
+// epilogue, can be fused into the output of the dot: the conversions and the
+// rescaling by broadcast scalars of the dequantization of an int8 or FP8 GEMM.
+bool IsTritonFusibleEpilogue(const HloInstruction& hlo,
+                             const HloInstruction& producer,
+                             const GpuVersion gpu_version) {
+  static constexpr std::array<HloOpcode, 5> kEpilogueOpcodes = {
+      HloOpcode::kConvert, HloOpcode::kMultiply, HloOpcode::kDivide,
+      HloOpcode::kAdd, HloOpcode::kSubtract};
+  if (!absl::c_linear_search(kEpilogueOpcodes, hlo.opcode()) ||
+      !IsTritonSupportedElementwise(hlo.opcode(),
+                                    producer.shape().element_type()) ||
+      !IsSupportedDataType(hlo.shape().element_type(), gpu_version) ||
+      hlo.shape().layout() != producer.shape().layout()) {
+    return false;
+  }
+  return absl::c_all_of(hlo.operands(), [&](const HloInstruction* operand) {
+    return operand == &producer || IsBroadcastOfScalar(*operand);
+  });
+}
+
 // Extracts into fused computations parts of HLO graph including dot()
 // operations that can target the triton GEMM emitter.
 class GemmRewriterTritonVisitor : public DfsHloRewriteVisitor {
@@ -485,8 +529,6 @@ class GemmRewriterTritonVisitor : public DfsHloRewriteVisitor {
       return OkStatus();
     }
 
-    // TODO(b/266857789): also fuse convert(dot()) at output if present:
-    // seen on s8xf32->bf16
     std::string suggested_name = absl::StrCat("triton_gemm_", dot->name());
     HloComputation::Builder builder(
         absl::StrCat(suggested_name, "_computation"));
@@ -495,6 +537,14 @@ class GemmRewriterTritonVisitor : public DfsHloRewriteVisitor {
         old_to_new_mapping;
     absl::flat_hash_set<const HloInstruction*> visited;
     std::vector<HloInstruction*> call_operands;
+    auto add_parameter = [&](HloInstruction* hlo) {
+      HloInstruction* parameter =
+          builder.AddInstruction(HloInstruction::CreateParameter(
+              call_operands.size(), hlo->shape(),
+              absl::StrCat("parameter_", call_operands.size())));
+      call_operands.push_back(hlo);
+      return parameter;
+    };
     // Traverse and fuse dot() inputs bottom-up starting from direct operands.
     // If an input is not fusible stop there and make it a parameter of the new
     // fusion, otherwise put it onto stack and check its own inputs first.
@@ -531,11 +581,7 @@ class GemmRewriterTritonVisitor : public DfsHloRewriteVisitor {
       if (top_is_ready_to_fuse) {
         if (hlo->opcode() == HloOpcode::kParameter ||
             hlo->opcode() == HloOpcode::kGetTupleElement) {
-          old_to_new_mapping[hlo] =
-              builder.AddInstruction(HloInstruction::CreateParameter(
-                  call_operands.size(), hlo->shape(),
-                  absl::StrCat("parameter_", call_operands.size())));
-          call_operands.push_back(hlo);
+          old_to_new_mapping[hlo] = add_parameter(hlo);
         } else {
           std::vector<HloInstruction*> hlo_new_operands;
           for (HloInstruction* operand : hlo->operands()) {
@@ -543,11 +589,7 @@ class GemmRewriterTritonVisitor : public DfsHloRewriteVisitor {
             if (iter != old_to_new_mapping.end()) {
               hlo_new_operands.push_back(iter->second);
             } else {
-              hlo_new_operands.push_back(
-                  builder.AddInstruction(HloInstruction::CreateParameter(
-                      call_operands.size(), operand->shape(),
-                      absl::StrCat("parameter_", call_operands.size()))));
-              call_operands.push_back(operand);
+              hlo_new_operands.push_back(add_parameter(operand));
             }
           }
           old_to_new_mapping[hlo] = builder.AddInstruction(
@@ -556,6 +598,44 @@ class GemmRewriterTritonVisitor : public DfsHloRewriteVisitor {
         to_fuse.pop();
       }
     }
+    // Fuse the chain of single users converting or rescaling the result of
+    // the dot, like the dequantization of an int8 or FP8 GEMM does.
+    HloInstruction* fusion_output = dot;
+    while (fusion_output->user_count() == 1 && !fusion_output->IsRoot()) {
+      HloInstruction* user = fusion_output->users()[0];
+      if (!IsTritonFusibleEpilogue(*user, *fusion_output, gpu_version_)) {
+        break;
+      }
+      VLOG(3) << "Fusing " << user->ToString();
+      std::vector<HloInstruction*> user_new_operands;
+      for (HloInstruction* operand : user->operands()) {
+        auto iter = old_to_new_mapping.find(operand);
+        if (iter == old_to_new_mapping.end()) {
+          // A broadcast of a scalar constant or parameter.
+          HloInstruction* scalar = operand->mutable_operand(0);
+          auto scalar_iter = old_to_new_mapping.find(scalar);
+          if (scalar_iter == old_to_new_mapping.end()) {
+            scalar_iter =
+                old_to_new_mapping
+                    .insert({scalar,
+                             scalar->opcode() == HloOpcode::kConstant
+                                 ? builder.AddInstruction(scalar->Clone())
+                                 : add_parameter(scalar)})
+                    .first;
+          }
+          iter = old_to_new_mapping
+                     .insert({operand, builder.AddInstruction(
+                                           operand->CloneWithNewOperands(
+                                               operand->shape(),
+                                               {scalar_iter->second}))})
+                     .first;
+        }
+        user_new_operands.push_back(iter->second);
+      }
+      old_to_new_mapping[user] = builder.AddInstruction(
+          user->CloneWithNewOperands(user->shape(), user_new_operands));
+      fusion_output = user;
+    }
     HloComputation* computation =
         dot->GetModule()->AddComputationAndUnifyNamesAndIds(builder.Build(),
                                                             /*is_entry=*/false);
@@ -571,13 +651,14 @@ class GemmRewriterTritonVisitor : public DfsHloRewriteVisitor {
     backend_config.set_kind(std::string(kTritonGemmFusionKind));
     TF_RETURN_IF_ERROR(dot_fusion->set_backend_config(backend_config));
 
-    if (dot->IsRoot()) {
-      dot->parent()->set_root_instruction(dot_fusion);
+    if (fusion_output->IsRoot()) {
+      fusion_output->parent()->set_root_instruction(dot_fusion);
       TF_RETURN_IF_ERROR(
-          dot->parent()->RemoveInstructionAndUnusedOperands(dot));
+          fusion_output->parent()->RemoveInstructionAndUnusedOperands(
+              fusion_output));
       MarkAsChanged();
     } else {
-      TF_RETURN_IF_ERROR(ReplaceInstruction(dot, dot_fusion));
+      TF_RETURN_IF_ERROR(ReplaceInstruction(fusion_output, dot_fusion));
     }
     VLOG(5) << computation->ToString();
     return OkStatus();
@@ -794,6 +875,9 @@ Status MakeDotSplitKBatch(
   if (dot_fusion->shape().IsTuple()) {
     return Unimplemented("Tuple output is not supported with split-K yet.");
   }
+  if (dot_fusion->fused_expression_root()->opcode() != HloOpcode::kDot) {
+    return Unimplemented("Output fusion is not supported with split-K yet.");
+  }
 
   const Layout old_dot_layout = dot_fusion->shape().layout();
 
@@ -847,7 +931,9 @@ DotFusionAnalysis::DotFusionAnalysis(const HloComputation* dot_computation,
     while (!to_process.empty()) {
       const HloInstruction* hlo = to_process.front();
       to_process.pop();
-      if (hlo->opcode() == HloOpcode::kParameter) {
+      // Scalar parameters are broadcast and are not tiled.
+      if (hlo->opcode() == HloOpcode::kParameter &&
+          !ShapeUtil::IsScalar(hlo->shape())) {
         CHECK(parameters_[scope].insert(hlo).second);
         VLOG(5) << hlo->ToString();
       }
@@ -873,10 +959,17 @@ DotFusionAnalysis::DotFusionAnalysis(const HloComputation* dot_computation,
     }
   }
 
-  DimensionOrder dim_order = DimensionOrder::FromDotOutput(*dot);
-  CHECK(iter_specs_[Scope::OUTPUT]
-            .insert({dot, DimensionOrderToTensorIterationSpec(dim_order)})
-            .second);
+  // The fused epilogue is elementwise and keeps the layout of the dot, so its
+  // instructions are iterated over like the dot.
+  const TensorIterationSpec output_iter_spec =
+      DimensionOrderToTensorIterationSpec(DimensionOrder::FromDotOutput(*dot));
+  const HloInstruction* output = dot;
+  CHECK(iter_specs_[Scope::OUTPUT].insert({output, output_iter_spec}).second);
+  while (output != dot_computation->root_instruction() &&
+         output->user_count() == 1) {
+    output = output->users()[0];
+    CHECK(iter_specs_[Scope::OUTPUT].insert({output, output_iter_spec}).second);
+  }
 }
 
 const DotFusionAnalysis::DimIterationSpec* DotFusionAnalysis::IterSpec(
@@ -907,6 +1000,12 @@ bool IsTritonHandledGEMM(const HloInstruction& dot,
       case BF16:
         return cuda_compute_capability.IsAtLeast(
             stream_executor::CudaComputeCapability::AMPERE);
+      case S32:
+        // Integer accumulation of an int8 GEMM.
+        return dot.operand(0)->shape().element_type() == S8 &&
+               dot.operand(1)->shape().element_type() == S8 &&
+               cuda_compute_capability.IsAtLeast(
+                   stream_executor::CudaComputeCapability::AMPERE);
       default:
         return false;
     }
@@ -971,7 +1070,15 @@ bool IsTritonHandledGEMM(const HloInstruction& dot,
     return false;
   };
 
-  return has_triton_fusible_inputs(dot, 0) || has_triton_fusible_inputs(dot, 1);
+  // Fusing the dequantization of the output saves a round trip of the
+  // accumulator through memory.
+  auto has_triton_fusible_epilogue = [&] {
+    return dot.user_count() == 1 && !dot.IsRoot() &&
+           IsTritonFusibleEpilogue(*dot.users()[0], dot, gpu_version);
+  };
+
+  return has_triton_fusible_inputs(dot, 0) ||
+         has_triton_fusible_inputs(dot, 1) || has_triton_fusible_epilogue();
 
   // TODO(b/266857789): either check that no output fusion (axpy, relu etc)
   // is expected or actually support it.
@@ -110,6 +110,54 @@ ENTRY e {
               GmockMatch(m::Fusion(m::Constant(), m::Parameter())));
 }
 
+TEST_F(GemmRewriterTritonTest, FuseInt8DequantizationEpilogue) {
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<VerifiedHloModule> module,
+                          ParseAndReturnVerifiedModule(R"(
+HloModule m
+
+ENTRY e {
+  p0 = s8[64,128] parameter(0)
+  p1 = s8[128,32] parameter(1)
+  d = s32[64,32] dot(p0, p1),
+    lhs_contracting_dims={1}, rhs_contracting_dims={0}
+  c = f32[64,32] convert(d)
+  p2 = f32[] parameter(2)
+  b = f32[64,32] broadcast(p2), dimensions={}
+  ROOT m = f32[64,32] multiply(c, b)
+})"));
+  EXPECT_TRUE(GemmRewriterTriton(gpu_version_).Run(module.get()).value());
+  const HloInstruction* root = module->entry_computation()->root_instruction();
+  EXPECT_THAT(root, GmockMatch(m::Fusion(m::Parameter(), m::Parameter(),
+                                         m::Parameter())));
+  EXPECT_THAT(root->fused_expression_root(),
+              GmockMatch(m::Multiply(m::Convert(m::Dot()),
+                                     m::Broadcast(m::Parameter()))));
+}
+
+TEST_F(GemmRewriterTritonTest, FuseFp8ScalingPrologue) {
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<VerifiedHloModule> module,
+                          ParseAndReturnVerifiedModule(R"(
+HloModule m
+
+ENTRY e {
+  p0 = f8e4m3fn[64,128] parameter(0)
+  c0 = f16[64,128] convert(p0)
+  p2 = f16[] parameter(2)
+  b0 = f16[64,128] broadcast(p2), dimensions={}
+  m0 = f16[64,128] multiply(c0, b0)
+  p1 = f16[128,32] parameter(1)
+  ROOT d = f16[64,32] dot(m0, p1),
+    lhs_contracting_dims={1}, rhs_contracting_dims={0}
+})"));
+  const GpuVersion hopper =
+      se::CudaComputeCapability{se::CudaComputeCapability::HOPPER, 0};
+  EXPECT_FALSE(GemmRewriterTriton(gpu_version_).Run(module.get()).value());
+  EXPECT_TRUE(GemmRewriterTriton(hopper).Run(module.get()).value());
+  EXPECT_THAT(module->entry_computation()->root_instruction(),
+              GmockMatch(m::Fusion(m::Parameter(), m::Parameter(),
+                                   m::Parameter())));
+}
+
 using TritonDotAnalysisTest = HloTestBase;
 
 TEST_F(TritonDotAnalysisTest, NopBitcasts) {
@@ -681,6 +729,41 @@ ENTRY e {
       tsl::testing::StatusIs(tsl::error::CANCELLED,
                              "Contracting dimension is too fragmented."));
 }
+
+TEST_F(SplitKTest, SkipOutputFusion) {
+  const std::string hlo_text = R"(
+HloModule t
+
+triton_gemm_dot {
+  p0 = s8[64,128] parameter(0)
+  p1 = s8[128,32] parameter(1)
+  d = s32[64,32] dot(p0, p1),
+    lhs_contracting_dims={1}, rhs_contracting_dims={0}
+  ROOT c = f32[64,32] convert(d)
+}
+
+ENTRY e {
+  p0 = s8[64,128] parameter(0)
+  p1 = s8[128,32] parameter(1)
+  ROOT fusion = f32[64,32] fusion(p0, p1),
+    kind=kCustom, calls=triton_gemm_dot, backend_config="__triton_gemm"
+})";
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<VerifiedHloModule> module,
+                          ParseAndReturnVerifiedModule(hlo_text));
+
+  tensorflow::AutotuneResult::TritonGemmKey key;
+  key.set_block_m(16);
+  key.set_block_n(16);
+  key.set_block_k(32);
+  key.set_num_stages(1);
+  key.set_num_warps(4);
+  key.set_split_k(4);
+  EXPECT_THAT(
+      MakeDotSplitKBatch(module->entry_computation()->root_instruction(), key),
+      tsl::testing::StatusIs(tsl::error::UNIMPLEMENTED,
+                             "Output fusion is not supported with split-K "
+                             "yet."));
+}
 }  // namespace
 }  // namespace gpu
 }  // namespace xla
@@ -66,6 +66,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/broadcast_canonicalizer.h"
 #include "tensorflow/compiler/xla/service/buffer_assignment.h"
 #include "tensorflow/compiler/xla/service/call_inliner.h"
+#include "tensorflow/compiler/xla/service/collective_combiner_autotuner.h"
 #include "tensorflow/compiler/xla/service/collectives_schedule_linearizer.h"
 #include "tensorflow/compiler/xla/service/comparison_expander.h"
 #include "tensorflow/compiler/xla/service/conditional_canonicalizer.h"
@@ -337,6 +338,44 @@ void AddHloVerifier(HloPassPipeline* pipeline, HloVerifierOpts&& opts = {},
                                                "hlo verifier");
   }
 }
+
+// Converts all collectives to their async form, and then annotates the ones
+// that actually need to run asynchronously with a GPU specific backend config.
+void AddAsyncCollectivePasses(HloPassPipeline* pipeline,
+                              const DebugOptions& debug_options) {
+  AsyncCollectiveCreator::CollectiveCreatorConfig config;
+  config.convert_all_reduce = HloPredicateTrue;
+  config.convert_collective_permute = HloPredicateTrue;
+  config.convert_all_gather = HloPredicateTrue;
+  config.convert_reduce_scatter = HloPredicateTrue;
+  config.convert_all_to_all = HloPredicateTrue;
+  pipeline->AddPass<AsyncCollectiveCreator>(std::move(config));
+
+  auto convert_to_async = [&debug_options](const HloInstruction* inst) {
+    switch (inst->opcode()) {
+      case HloOpcode::kAllReduceStart:
+        return debug_options.xla_gpu_enable_async_all_reduce();
+      case HloOpcode::kAllGatherStart:
+        return debug_options.xla_gpu_enable_async_all_gather();
+      case HloOpcode::kCollectivePermuteStart:
+        return debug_options.xla_gpu_enable_async_collective_permute();
+      case HloOpcode::kAsyncStart: {
+        auto async_inst = Cast<HloAsyncInstruction>(inst);
+        switch (async_inst->async_wrapped_opcode()) {
+          case HloOpcode::kReduceScatter:
+            return debug_options.xla_gpu_enable_async_reduce_scatter();
+          case HloOpcode::kAllToAll:
+            return debug_options.xla_gpu_enable_async_all_to_all();
+          default:
+            return false;
+        }
+      }
+      default:
+        return false;
+    }
+  };
+  pipeline->AddPass<GpuAsyncCollectiveAnnotator>(convert_to_async);
+}
 }  // namespace
 
 // Runs optimization passes on the given HLO module.
@@ -803,12 +842,45 @@ Status GpuCompiler::OptimizeHloModule(HloModule* hlo_module,
 
   {
     HloPassPipeline pipeline("post-fusion optimization");
-    pipeline.AddPass<AllGatherCombiner>(
-        debug_options.xla_gpu_all_gather_combine_threshold_bytes(),
-        /*combine_threshold_count=*/256);
-    pipeline.AddPass<AllReduceCombiner>(
-        debug_options.xla_gpu_all_reduce_combine_threshold_bytes(),
-        /*combine_threshold_count=*/256);
+    if (debug_options.xla_gpu_autotune_collective_combine_thresholds()) {
+      // Picks the thresholds that leave the least communication time exposed
+      // once the collectives are made async and scheduled.
+      auto exposed_collective_time =
+          [&](HloModule* module) -> StatusOr<double> {
+        HloPassPipeline async_pipeline("async-collective-conversion");
+        AddAsyncCollectivePasses(&async_pipeline, debug_options);
+        TF_RETURN_IF_ERROR(async_pipeline.Run(module).status());
+        return EstimateExposedCollectiveTime(module, pointer_size_,
+                                             gpu_device_info);
+      };
+      constexpr int64_t kMinCombineThresholdBytes = 64 * 1024;
+      constexpr int kNumCandidateThresholds = 8;
+      pipeline.AddPass<CollectiveCombinerAutotuner>(
+          [](int64_t threshold_bytes) {
+            return std::make_unique<AllGatherCombiner>(
+                threshold_bytes, /*combine_threshold_count=*/256);
+          },
+          CollectiveCombinerAutotuner::HalvingCandidates(
+              debug_options.xla_gpu_all_gather_combine_threshold_bytes(),
+              kMinCombineThresholdBytes, kNumCandidateThresholds),
+          exposed_collective_time);
+      pipeline.AddPass<CollectiveCombinerAutotuner>(
+          [](int64_t threshold_bytes) {
+            return std::make_unique<AllReduceCombiner>(
+                threshold_bytes, /*combine_threshold_count=*/256);
+          },
+          CollectiveCombinerAutotuner::HalvingCandidates(
+              debug_options.xla_gpu_all_reduce_combine_threshold_bytes(),
+              kMinCombineThresholdBytes, kNumCandidateThresholds),
+          exposed_collective_time);
+    } else {
+      pipeline.AddPass<AllGatherCombiner>(
+          debug_options.xla_gpu_all_gather_combine_threshold_bytes(),
+          /*combine_threshold_count=*/256);
+      pipeline.AddPass<AllReduceCombiner>(
+          debug_options.xla_gpu_all_reduce_combine_threshold_bytes(),
+          /*combine_threshold_count=*/256);
+    }
     pipeline.AddPass<ReduceScatterCombiner>(
         debug_options.xla_gpu_reduce_scatter_combine_threshold_bytes(),
         /*combine_threshold_count=*/256);
@@ -823,43 +895,7 @@ Status GpuCompiler::OptimizeHloModule(HloModule* hlo_module,
       pipeline.AddPass<AllReduceBlueConnect>(blueconnect_num_devices_per_host);
     }
 
-    {
-      // Convert all collectives to their async form, and then annotate the ones
-      // that actually need to run asynchronously with a GPU specific backend
-      // config.
-      AsyncCollectiveCreator::CollectiveCreatorConfig config;
-      config.convert_all_reduce = HloPredicateTrue;
-      config.convert_collective_permute = HloPredicateTrue;
-      config.convert_all_gather = HloPredicateTrue;
-      config.convert_reduce_scatter = HloPredicateTrue;
-      config.convert_all_to_all = HloPredicateTrue;
-      pipeline.AddPass<AsyncCollectiveCreator>(std::move(config));
-
-      auto convert_to_async = [&debug_options](const HloInstruction* inst) {
-        switch (inst->opcode()) {
-          case HloOpcode::kAllReduceStart:
-            return debug_options.xla_gpu_enable_async_all_reduce();
-          case HloOpcode::kAllGatherStart:
-            return debug_options.xla_gpu_enable_async_all_gather();
-          case HloOpcode::kCollectivePermuteStart:
-            return debug_options.xla_gpu_enable_async_collective_permute();
-          case HloOpcode::kAsyncStart: {
-            auto async_inst = Cast<HloAsyncInstruction>(inst);
-            switch (async_inst->async_wrapped_opcode()) {
-              case HloOpcode::kReduceScatter:
-                return debug_options.xla_gpu_enable_async_reduce_scatter();
-              case HloOpcode::kAllToAll:
-                return debug_options.xla_gpu_enable_async_all_to_all();
-              default:
-                return false;
-            }
-          }
-          default:
-            return false;
-        }
-      };
-      pipeline.AddPass<GpuAsyncCollectiveAnnotator>(convert_to_async);
-    }
+    AddAsyncCollectivePasses(&pipeline, debug_options);
 
     if (!hlo_module->config().use_spmd_partitioning()) {
       pipeline.AddPass<CollectivesScheduleLinearizer>();
@@ -217,6 +217,41 @@ Status RunFusedMHAScaleBiasSoftmax(GpufMHAParams params, se::Stream *stream,
                    rhs_bmm2_buffer, output_buffer);
 }
 
+template <typename ElementType, typename OutputType>
+Status RunFusedMHAFlashScaleSoftmax(GpufMHAParams params, se::Stream *stream,
+                                    RunFusedMHAOptions options,
+                                    DeviceMemory<ElementType> lhs_bmm1_buffer,
+                                    DeviceMemory<ElementType> rhs_bmm1_buffer,
+                                    DeviceMemory<ElementType> rhs_bmm2_buffer,
+                                    DeviceMemory<OutputType> output_buffer,
+                                    DeviceMemory<float> softmax_stats_buffer,
+                                    DeviceMemoryBase scratch_memory) {
+  se::dnn::LazyOpRunner<se::dnn::FusedMHAFlashScaleSoftmaxOp> *lazy_runner =
+      options.runner_cache->AsFusedMHAFlashRunner();
+  std::optional<se::dnn::LazyOpRunner<se::dnn::FusedMHAFlashScaleSoftmaxOp>>
+      local_runner;
+  if (!lazy_runner) {
+    local_runner.emplace(params.config->algorithm);
+    lazy_runner = &*local_runner;
+  }
+  double scale = 1.0;
+  if (params.config->fmha_scale) scale = *params.config->fmha_scale;
+
+  se::dnn::FusedMHAFlashScaleSoftmaxOp::Config config{
+      scale,
+      params.config->lhs_bmm1,
+      params.config->rhs_bmm1,
+      params.config->rhs_bmm2,
+      params.config->intermediate_lhs_bmm2,
+      params.config->output,
+      *params.config->softmax_stats};
+  TF_ASSIGN_OR_RETURN(auto *runner,
+                      lazy_runner->GetOrCreateRunner(config, stream));
+  return (*runner)(stream, options.profile_result, scratch_memory,
+                   lhs_bmm1_buffer, rhs_bmm1_buffer, rhs_bmm2_buffer,
+                   output_buffer, softmax_stats_buffer);
+}
+
 template <typename ElementType, typename BiasType, typename OutputType>
 Status RunGpuFMHAImpl(const GpufMHAParams &params, se::Stream *stream,
                       se::DeviceMemoryBase scratch_memory,
@@ -270,6 +305,14 @@ Status RunGpuFMHAImpl(const GpufMHAParams &params, se::Stream *stream,
               rhs_bmm2_buffer, output_buffer,
               se::DeviceMemory<BiasType>(*params.bias_buffer), scratch_memory);
       break;
+    case CudnnfMHAKind::kFlashScaleSoftmax:
+      TF_RET_CHECK(params.softmax_stats_buffer.has_value());
+      run_status = RunFusedMHAFlashScaleSoftmax<ElementType, OutputType>(
+          params, stream, options, lhs_bmm1_buffer, rhs_bmm1_buffer,
+          rhs_bmm2_buffer, output_buffer,
+          se::DeviceMemory<float>(*params.softmax_stats_buffer),
+          scratch_memory);
+      break;
 
     default:
       return InternalError("Invalid cuDNN fMHA kind");
@@ -341,6 +384,30 @@ Status CheckAndAssignBias(const GpufMHADescriptor &desc,
   }
 }
 
+Status CheckAndAssignSoftmaxStats(const GpufMHADescriptor &desc,
+                                  GpufMHAConfig &config) {
+  switch (config.kind) {
+    case CudnnfMHAKind::kFlashScaleSoftmax:
+    case CudnnfMHAKind::kFlashScaleSoftmaxBackward:
+      if (desc.softmax_stats_shape) {
+        const Shape &stats_shape = *desc.softmax_stats_shape;
+        TF_ASSIGN_OR_RETURN(
+            DataType stats_type,
+            GetDNNDataTypeFromPrimitiveType(stats_shape.element_type()));
+        config.softmax_stats =
+            TensorDescriptor::For(stats_type, stats_shape.dimensions(),
+                                  stats_shape.layout().minor_to_major());
+        return OkStatus();
+      } else {
+        return InternalError(
+            "GpufMHADescriptor should have non-null softmax stats shape but "
+            "found null softmax stats shape");
+      }
+    default:
+      return OkStatus();
+  }
+}
+
 void AssignScale(GpufMHAConfig &config,
                  const CudnnfMHABackendConfig &backend_config) {
   double fmha_scale = 0.0;
@@ -352,6 +419,8 @@ void AssignScale(GpufMHAConfig &config,
     case CudnnfMHAKind::kScaleMaskSoftmaxDropout:
     case CudnnfMHAKind::kScaleBiasSoftmaxDropout:
     case CudnnfMHAKind::kScaleBiasSoftmax:
+    case CudnnfMHAKind::kFlashScaleSoftmax:
+    case CudnnfMHAKind::kFlashScaleSoftmaxBackward:
       fmha_scale = backend_config.fmha_scale();
       config.fmha_scale.emplace(fmha_scale);
       break;
@@ -458,6 +527,7 @@ void AssignSeed(GpufMHAConfig &config,
 
   TF_RETURN_IF_ERROR(CheckAndAssignMask(desc, config));
   TF_RETURN_IF_ERROR(CheckAndAssignBias(desc, config));
+  TF_RETURN_IF_ERROR(CheckAndAssignSoftmaxStats(desc, config));
   AssignScale(config, backend_config);
   AssignDropoutRate(config, backend_config);
   AssignSeed(config, backend_config);
@@ -468,7 +538,8 @@ void AssignSeed(GpufMHAConfig &config,
     const GpufMHAConfig &config, se::DeviceMemoryBase lhs_bmm1_buffer,
     se::DeviceMemoryBase rhs_bmm1_buffer, se::DeviceMemoryBase rhs_bmm2_buffer,
     se::DeviceMemoryBase output_buffer, se::DeviceMemoryBase mask_buffer,
-    se::DeviceMemoryBase bias_buffer) {
+    se::DeviceMemoryBase bias_buffer,
+    se::DeviceMemoryBase softmax_stats_buffer) {
   GpufMHAParams params;
   params.config = &config;
   params.lhs_bmm1_buffer = lhs_bmm1_buffer;
@@ -509,6 +580,14 @@ void AssignSeed(GpufMHAConfig &config,
     case CudnnfMHAKind::kScaleBiasSoftmaxDropout:
       TF_RET_CHECK(!bias_buffer.is_null());
       assign_bias_buffer();
+      break;
+    case CudnnfMHAKind::kFlashScaleSoftmax:
+      TF_RET_CHECK(!softmax_stats_buffer.is_null());
+      params.softmax_stats_buffer = softmax_stats_buffer;
+      break;
+    case CudnnfMHAKind::kFlashScaleSoftmaxBackward:
+      return InternalError(
+          "The flash attention backward pass is run by RunGpuFMHABackward");
   }
   return params;
 }
@@ -518,12 +597,13 @@ Status RunGpuFMHA(
     se::DeviceMemoryBase rhs_bmm1_buffer, se::DeviceMemoryBase rhs_bmm2_buffer,
     se::DeviceMemoryBase output_buffer, se::DeviceMemoryBase scratch_buffer,
     se::DeviceMemoryBase mask_buffer, se::DeviceMemoryBase bias_buffer,
-    se::Stream *stream, RunFusedMHAOptions options) {
+    se::DeviceMemoryBase softmax_stats_buffer, se::Stream *stream,
+    RunFusedMHAOptions options) {
   TF_ASSIGN_OR_RETURN(
       GpufMHAParams params,
       GpufMHAParams::For(fmha_config, lhs_bmm1_buffer, rhs_bmm1_buffer,
                          rhs_bmm2_buffer, output_buffer, mask_buffer,
-                         bias_buffer));
+                         bias_buffer, softmax_stats_buffer));
   PrimitiveType input_primitive_type = fmha_config.input_type;
   switch (input_primitive_type) {
     case F16:
@@ -539,6 +619,61 @@ Status RunGpuFMHA(
   return OkStatus();
 }
 
+Status RunGpuFMHABackward(
+    const GpufMHAConfig &fmha_config, se::DeviceMemoryBase lhs_bmm1_buffer,
+    se::DeviceMemoryBase rhs_bmm1_buffer, se::DeviceMemoryBase rhs_bmm2_buffer,
+    se::DeviceMemoryBase output_buffer,
+    se::DeviceMemoryBase softmax_stats_buffer,
+    se::DeviceMemoryBase d_output_buffer,
+    se::DeviceMemoryBase d_lhs_bmm1_buffer,
+    se::DeviceMemoryBase d_rhs_bmm1_buffer,
+    se::DeviceMemoryBase d_rhs_bmm2_buffer,
+    se::DeviceMemoryBase scratch_buffer, se::Stream *stream,
+    RunFusedMHAOptions options) {
+  TF_RET_CHECK(fmha_config.kind == CudnnfMHAKind::kFlashScaleSoftmaxBackward);
+  TF_RET_CHECK(fmha_config.softmax_stats.has_value());
+  if (fmha_config.input_type != F16 && fmha_config.input_type != BF16) {
+    return absl::UnimplementedError(absl::StrFormat(
+        "Unimplemented fused MHA backward with %s", ToString(fmha_config)));
+  }
+
+  se::dnn::LazyOpRunner<se::dnn::FusedMHAFlashScaleSoftmaxBackwardOp>
+      *lazy_runner = options.runner_cache->AsFusedMHAFlashBackwardRunner();
+  std::optional<
+      se::dnn::LazyOpRunner<se::dnn::FusedMHAFlashScaleSoftmaxBackwardOp>>
+      local_runner;
+  if (!lazy_runner) {
+    local_runner.emplace(fmha_config.algorithm);
+    lazy_runner = &*local_runner;
+  }
+  double scale = 1.0;
+  if (fmha_config.fmha_scale) scale = *fmha_config.fmha_scale;
+
+  se::dnn::FusedMHAFlashScaleSoftmaxBackwardOp::Config config{
+      scale,
+      fmha_config.lhs_bmm1,
+      fmha_config.rhs_bmm1,
+      fmha_config.rhs_bmm2,
+      fmha_config.intermediate_lhs_bmm2,
+      fmha_config.output,
+      *fmha_config.softmax_stats};
+  TF_ASSIGN_OR_RETURN(auto *runner,
+                      lazy_runner->GetOrCreateRunner(config, stream));
+  TF_RETURN_IF_ERROR((*runner)(
+      stream, options.profile_result, scratch_buffer, lhs_bmm1_buffer,
+      rhs_bmm1_buffer, rhs_bmm2_buffer, output_buffer, softmax_stats_buffer,
+      d_output_buffer, d_lhs_bmm1_buffer, d_rhs_bmm1_buffer,
+      d_rhs_bmm2_buffer));
+
+  if (!stream->ok()) {
+    return InternalError(
+        "Unable to launch FMHA backward with type %s and algorithm %s",
+        CudnnfMHAKindToString(fmha_config.kind),
+        fmha_config.algorithm.ToString());
+  }
+  return OkStatus();
+}
+
 std::string ToString(const GpufMHAConfig &config) {
   std::string result = "GpufMHAConfig:\n";
   absl::StrAppend(&result,
@@ -572,6 +707,12 @@ std::string ToString(const GpufMHAConfig &config) {
     absl::StrAppend(&result, "bias: ", (*config.bias).ToString(), "\n");
   }
 
+  if (config.softmax_stats) {
+    absl::StrAppend(&result,
+                    "softmax_stats: ", (*config.softmax_stats).ToString(),
+                    "\n");
+  }
+
   return result;
 }
 
@@ -55,6 +55,9 @@ struct GpufMHADescriptor {
 
   std::optional<Shape> mask_shape;
   std::optional<Shape> bias_shape;
+  // The softmax statistics written by the flash attention forward pass and
+  // read by its backward pass.
+  std::optional<Shape> softmax_stats_shape;
 };
 
 // Structure to describe static properties of a GPU fused Multi-Headed
@@ -81,6 +84,8 @@ struct GpufMHAConfig {
 
   std::optional<se::dnn::TensorDescriptor> mask;
   std::optional<se::dnn::TensorDescriptor> bias;
+  // softmax_stats -> [batch_size, num_attn_heads, q_seq_len, 1]
+  std::optional<se::dnn::TensorDescriptor> softmax_stats;
 };
 
 // Implementation struct exposed for debugging and log analysis.
@@ -91,7 +96,8 @@ struct GpufMHAParams {
                                      se::DeviceMemoryBase rhs_bmm2_buffer,
                                      se::DeviceMemoryBase output_buffer,
                                      se::DeviceMemoryBase mask_buffer,
-                                     se::DeviceMemoryBase bias_buffer);
+                                     se::DeviceMemoryBase bias_buffer,
+                                     se::DeviceMemoryBase softmax_stats_buffer);
 
   const GpufMHAConfig* config;  // Not owned
   se::DeviceMemoryBase lhs_bmm1_buffer;
@@ -100,6 +106,7 @@ struct GpufMHAParams {
   se::DeviceMemoryBase output_buffer;
   std::optional<se::DeviceMemoryBase> mask_buffer;
   std::optional<se::DeviceMemoryBase> bias_buffer;
+  std::optional<se::DeviceMemoryBase> softmax_stats_buffer;
 };
 
 class FusedMultiHeadedAttentionRunner {
@@ -112,7 +119,11 @@ class FusedMultiHeadedAttentionRunner {
       std::unique_ptr<
           se::dnn::LazyOpRunner<se::dnn::FusedMHAScaleBiasSoftmaxOp>>,
       std::unique_ptr<
-          se::dnn::LazyOpRunner<se::dnn::FusedMHAScaleBiasMaskSoftmaxOp>>>;
+          se::dnn::LazyOpRunner<se::dnn::FusedMHAScaleBiasMaskSoftmaxOp>>,
+      std::unique_ptr<
+          se::dnn::LazyOpRunner<se::dnn::FusedMHAFlashScaleSoftmaxOp>>,
+      std::unique_ptr<se::dnn::LazyOpRunner<
+          se::dnn::FusedMHAFlashScaleSoftmaxBackwardOp>>>;
 
   FusedMultiHeadedAttentionRunner() = default;
 
@@ -138,6 +149,18 @@ class FusedMultiHeadedAttentionRunner {
           runner)
       : repr_(std::move(runner)) {}
 
+  explicit FusedMultiHeadedAttentionRunner(
+      std::unique_ptr<
+          se::dnn::LazyOpRunner<se::dnn::FusedMHAFlashScaleSoftmaxOp>>
+          runner)
+      : repr_(std::move(runner)) {}
+
+  explicit FusedMultiHeadedAttentionRunner(
+      std::unique_ptr<se::dnn::LazyOpRunner<
+          se::dnn::FusedMHAFlashScaleSoftmaxBackwardOp>>
+          runner)
+      : repr_(std::move(runner)) {}
+
   explicit FusedMultiHeadedAttentionRunner(Repr runner)
       : repr_(std::move(runner)) {}
 
@@ -193,6 +216,25 @@ class FusedMultiHeadedAttentionRunner {
         .get();
   }
 
+  se::dnn::LazyOpRunner<se::dnn::FusedMHAFlashScaleSoftmaxOp>*
+  AsFusedMHAFlashRunner() {
+    CHECK(std::holds_alternative<std::unique_ptr<
+              se::dnn::LazyOpRunner<se::dnn::FusedMHAFlashScaleSoftmaxOp>>>(
+        repr_));
+    return std::get<std::unique_ptr<
+        se::dnn::LazyOpRunner<se::dnn::FusedMHAFlashScaleSoftmaxOp>>>(repr_)
+        .get();
+  }
+
+  se::dnn::LazyOpRunner<se::dnn::FusedMHAFlashScaleSoftmaxBackwardOp>*
+  AsFusedMHAFlashBackwardRunner() {
+    CHECK(std::holds_alternative<std::unique_ptr<se::dnn::LazyOpRunner<
+              se::dnn::FusedMHAFlashScaleSoftmaxBackwardOp>>>(repr_));
+    return std::get<std::unique_ptr<se::dnn::LazyOpRunner<
+        se::dnn::FusedMHAFlashScaleSoftmaxBackwardOp>>>(repr_)
+        .get();
+  }
+
  private:
   //  The CreateRunner function is defined as static because it
   //  doesn't need access to any non-static member variables of the
@@ -222,6 +264,13 @@ class FusedMultiHeadedAttentionRunner {
         return std::make_unique<
             se::dnn::LazyOpRunner<se::dnn::FusedMHAScaleBiasMaskSoftmaxOp>>(
             config.algorithm);
+      case CudnnfMHAKind::kFlashScaleSoftmax:
+        return std::make_unique<
+            se::dnn::LazyOpRunner<se::dnn::FusedMHAFlashScaleSoftmaxOp>>(
+            config.algorithm);
+      case CudnnfMHAKind::kFlashScaleSoftmaxBackward:
+        return std::make_unique<se::dnn::LazyOpRunner<
+            se::dnn::FusedMHAFlashScaleSoftmaxBackwardOp>>(config.algorithm);
     }
   }
 
@@ -255,7 +304,23 @@ Status RunGpuFMHA(
     se::DeviceMemoryBase rhs_bmm1_buffer, se::DeviceMemoryBase rhs_bmm2_buffer,
     se::DeviceMemoryBase output_buffer, se::DeviceMemoryBase scratch_buffer,
     se::DeviceMemoryBase mask_buffer, se::DeviceMemoryBase bias_buffer,
-    se::Stream* stream, RunFusedMHAOptions = {});
+    se::DeviceMemoryBase softmax_stats_buffer, se::Stream* stream,
+    RunFusedMHAOptions = {});
+
+// Runs the flash attention backward pass of `fmha_config`, whose kind must be
+// kFlashScaleSoftmaxBackward. The gradients of the BMM inputs have the shapes
+// of the inputs and the gradient of the output has the shape of the output.
+Status RunGpuFMHABackward(
+    const GpufMHAConfig& fmha_config, se::DeviceMemoryBase lhs_bmm1_buffer,
+    se::DeviceMemoryBase rhs_bmm1_buffer, se::DeviceMemoryBase rhs_bmm2_buffer,
+    se::DeviceMemoryBase output_buffer,
+    se::DeviceMemoryBase softmax_stats_buffer,
+    se::DeviceMemoryBase d_output_buffer,
+    se::DeviceMemoryBase d_lhs_bmm1_buffer,
+    se::DeviceMemoryBase d_rhs_bmm1_buffer,
+    se::DeviceMemoryBase d_rhs_bmm2_buffer,
+    se::DeviceMemoryBase scratch_buffer, se::Stream* stream,
+    RunFusedMHAOptions = {});
 
 std::string ToString(const GpufMHAConfig& config);
 
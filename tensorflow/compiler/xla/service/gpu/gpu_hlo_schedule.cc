@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/service/gpu/gpu_hlo_schedule.h"
 
+#include <cmath>
 #include <deque>
 #include <memory>
 #include <optional>
@@ -22,6 +23,9 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/algorithm/container.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_split.h"
 #include "tensorflow/compiler/xla/hlo/ir/hlo_instructions.h"
 #include "tensorflow/compiler/xla/hlo/ir/hlo_schedule.h"
 #include "tensorflow/compiler/xla/hlo/utils/hlo_query.h"
@@ -33,6 +37,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/profile_guided_latency_estimator.h"
 #include "tensorflow/tsl/platform/env.h"
 #include "tensorflow/tsl/platform/protobuf.h"
+#include "tensorflow/tsl/profiler/convert/xplane_to_profile_instructions.h"
 
 namespace xla {
 namespace gpu {
@@ -388,6 +393,25 @@ class GpuLatencyEstimator : public ApproximateLatencyEstimator {
   }
 };
 
+// Returns whether `profile` can be used to schedule the module with
+// `fingerprint`. Profiles of a newer format, or collected from another
+// version of the module, are ignored.
+bool IsPGLEProfileApplicable(
+    const tensorflow::profiler::ProfiledInstructionsProto& profile,
+    const std::string& fingerprint) {
+  if (profile.version() > tsl::profiler::kProfiledInstructionsVersion) {
+    LOG(WARNING) << "Ignoring profile of unsupported version "
+                 << profile.version();
+    return false;
+  }
+  if (!profile.fingerprint().empty() && profile.fingerprint() != fingerprint) {
+    LOG(WARNING) << "Ignoring profile of module with fingerprint "
+                 << profile.fingerprint() << ", expected " << fingerprint;
+    return false;
+  }
+  return true;
+}
+
 std::optional<tensorflow::profiler::ProfiledInstructionsProto> ReadPGLEProfile(
     const HloModule* module, const std::string& fingerprint) {
   tensorflow::profiler::ProfiledInstructionsProto profile;
@@ -425,7 +449,7 @@ std::optional<tensorflow::profiler::ProfiledInstructionsProto> ReadPGLEProfile(
         pgle_profile_file_or_dir_path + "/" + fingerprint + ".pbtxt";
     Status s =
         tsl::ReadTextProto(tsl::Env::Default(), pgle_profile_path, &profile);
-    if (!s.ok()) {
+    if (!s.ok() || !IsPGLEProfileApplicable(profile, fingerprint)) {
       // Unable to read PGLE using fingerprint.
       return std::nullopt;
     }
@@ -438,12 +462,126 @@ std::optional<tensorflow::profiler::ProfiledInstructionsProto> ReadPGLEProfile(
   // be present in the HLO module)
   Status s = tsl::ReadTextProto(tsl::Env::Default(),
                                 pgle_profile_file_or_dir_path, &profile);
-  if (!s.ok()) {
+  if (!s.ok() || !IsPGLEProfileApplicable(profile, fingerprint)) {
     return std::nullopt;
   }
   return profile;
 }
 
+// Estimates the latency of async collectives from the size of their result,
+// with the collective bandwidth measured for a few sizes, and delegates
+// everything else to another estimator.
+class CollectiveSizeLatencyEstimator : public LatencyEstimator {
+ public:
+  // `bandwidth_per_size` are (size in bytes, bandwidth in GB/s) pairs sorted
+  // by size. If empty, collectives are assumed to take 10us plus their size
+  // at 50GB/s.
+  CollectiveSizeLatencyEstimator(
+      std::unique_ptr<LatencyEstimator> latency_estimator,
+      std::vector<std::pair<int64_t, double>> bandwidth_per_size)
+      : latency_estimator_(std::move(latency_estimator)),
+        bandwidth_per_size_(std::move(bandwidth_per_size)) {}
+
+  TimeCost GetLatencyBetween(const HloGraphNode& from,
+                             const HloGraphNode& target) const override {
+    if (IsAsyncPair(from, target) &&
+        hlo_query::IsAsyncCollectiveStartOp(from.GetInstr().opcode())) {
+      return CollectiveMicros(target.GetInstr()) * CyclesPerMicrosecond();
+    }
+    return latency_estimator_->GetLatencyBetween(from, target);
+  }
+
+  TimeCost NodeCost(const HloInstruction* instr) const override {
+    return latency_estimator_->NodeCost(instr);
+  }
+
+  int CyclesPerMicrosecond() const override {
+    return latency_estimator_->CyclesPerMicrosecond();
+  }
+
+  // Returns the estimated duration of the collective ending with `done`.
+  double CollectiveMicros(const HloInstruction& done) const {
+    int64_t bytes = 0;
+    ShapeUtil::ForEachSubshape(
+        done.shape(), [&](const Shape& subshape, const ShapeIndex&) {
+          if (subshape.IsArray()) bytes += ShapeUtil::ByteSizeOf(subshape);
+        });
+    // 1 GB/s is 1e3 bytes per microsecond.
+    return bytes / (BandwidthGBps(bytes) * 1e3) +
+           (bandwidth_per_size_.empty() ? 10.0 : 0.0);
+  }
+
+ private:
+  // Interpolates the measured bandwidth linearly in the log of the size.
+  double BandwidthGBps(int64_t bytes) const {
+    if (bandwidth_per_size_.empty()) return 50.0;
+    if (bytes <= bandwidth_per_size_.front().first) {
+      return bandwidth_per_size_.front().second;
+    }
+    for (size_t i = 1; i < bandwidth_per_size_.size(); ++i) {
+      const auto& [hi_bytes, hi_bandwidth] = bandwidth_per_size_[i];
+      if (bytes > hi_bytes) continue;
+      const auto& [lo_bytes, lo_bandwidth] = bandwidth_per_size_[i - 1];
+      const double t = std::log(static_cast<double>(bytes) / lo_bytes) /
+                       std::log(static_cast<double>(hi_bytes) / lo_bytes);
+      return lo_bandwidth + t * (hi_bandwidth - lo_bandwidth);
+    }
+    return bandwidth_per_size_.back().second;
+  }
+
+  std::unique_ptr<LatencyEstimator> latency_estimator_;
+  std::vector<std::pair<int64_t, double>> bandwidth_per_size_;
+};
+
+// Parses xla_gpu_collective_bandwidth_per_size, a comma separated list of
+// <size in bytes>:<bandwidth in GB/s>.
+StatusOr<std::vector<std::pair<int64_t, double>>>
+ParseCollectiveBandwidthPerSize(absl::string_view value) {
+  std::vector<std::pair<int64_t, double>> bandwidth_per_size;
+  for (absl::string_view entry :
+       absl::StrSplit(value, ',', absl::SkipEmpty())) {
+    std::pair<absl::string_view, absl::string_view> parts =
+        absl::StrSplit(entry, ':');
+    int64_t bytes;
+    double bandwidth;
+    if (!absl::SimpleAtoi(parts.first, &bytes) ||
+        !absl::SimpleAtod(parts.second, &bandwidth) || bytes <= 0 ||
+        bandwidth <= 0) {
+      return InvalidArgument(
+          "Invalid entry '%s' in xla_gpu_collective_bandwidth_per_size, "
+          "expected <size in bytes>:<bandwidth in GB/s>",
+          entry);
+    }
+    bandwidth_per_size.emplace_back(bytes, bandwidth);
+  }
+  absl::c_sort(bandwidth_per_size);
+  return bandwidth_per_size;
+}
+
+std::unique_ptr<AsyncTracker> MakeAsyncTracker(const HloModule& module,
+                                               const SchedulerConfig& config) {
+  return module.config().debug_options().xla_gpu_lhs_enable_gpu_async_tracker()
+             ? std::unique_ptr<AsyncTracker>(
+                   std::make_unique<GpuAsyncTracker>(config))
+             : std::make_unique<GpuAsyncTrackerBase>(config);
+}
+
+// Returns the latency estimator of the module, which uses its PGLE profile if
+// it has one.
+std::unique_ptr<LatencyEstimator> MakeLatencyEstimator(
+    const HloModule* module, const SchedulerConfig& config,
+    const std::string& fingerprint) {
+  auto gpu_latency_estimator = std::make_unique<GpuLatencyEstimator>();
+  std::optional<tensorflow::profiler::ProfiledInstructionsProto> profile =
+      ReadPGLEProfile(module, fingerprint);
+  if (profile.has_value()) {
+    LOG(INFO) << "Found profile, using profile guided latency estimator";
+    return std::make_unique<ProfileGuidedLatencyEstimator>(
+        config, std::move(gpu_latency_estimator), profile.value());
+  }
+  return gpu_latency_estimator;
+}
+
 }  // end namespace
 
 int64_t GetSizeOfShape(const Shape& shape, int pointer_size) {
@@ -484,26 +622,10 @@ Status ScheduleGpuModule(HloModule* module, int64_t pointer_size,
   }
 
   SchedulerConfig config = GetSchedulerConfig(gpu_info);
-  auto gpu_latency_estimator = std::make_unique<GpuLatencyEstimator>();
-
-  std::unique_ptr<LatencyEstimator> latency_estimator;
-  std::optional<tensorflow::profiler::ProfiledInstructionsProto> profile =
-      ReadPGLEProfile(module, fingerprint);
-  if (profile.has_value()) {
-    latency_estimator = std::make_unique<ProfileGuidedLatencyEstimator>(
-        config, std::move(gpu_latency_estimator), profile.value());
-    LOG(INFO) << "Found profile, using profile guided latency estimator";
-  } else {
-    latency_estimator = std::move(gpu_latency_estimator);
-  }
-
-  auto async_tracker = [&]() -> std::unique_ptr<AsyncTracker> {
-    return module->config()
-                   .debug_options()
-                   .xla_gpu_lhs_enable_gpu_async_tracker()
-               ? std::make_unique<GpuAsyncTracker>(config)
-               : std::make_unique<GpuAsyncTrackerBase>(config);
-  }();
+  std::unique_ptr<LatencyEstimator> latency_estimator =
+      MakeLatencyEstimator(module, config, fingerprint);
+  std::unique_ptr<AsyncTracker> async_tracker =
+      MakeAsyncTracker(*module, config);
 
   auto shape_size_in_bytes = [pointer_size](const Shape& shape) {
     return GetSizeOfShape(shape, pointer_size);
@@ -521,6 +643,66 @@ Status ScheduleGpuModule(HloModule* module, int64_t pointer_size,
   return OkStatus();
 }
 
+StatusOr<double> EstimateExposedCollectiveTime(HloModule* module,
+                                               int64_t pointer_size,
+                                               const GpuDeviceInfo& gpu_info) {
+  TF_ASSIGN_OR_RETURN(
+      HloSchedule schedule,
+      ScheduleGpuModuleWithMemoryScheduler(module, pointer_size));
+  TF_RETURN_IF_ERROR(module->set_schedule(std::move(schedule)));
+
+  const DebugOptions& debug_options = module->config().debug_options();
+  TF_ASSIGN_OR_RETURN(
+      auto bandwidth_per_size,
+      ParseCollectiveBandwidthPerSize(
+          debug_options.xla_gpu_collective_bandwidth_per_size()));
+  SchedulerConfig config = GetSchedulerConfig(gpu_info);
+  const std::string fingerprint = module->GetFingerprint128(
+      HloPrintOptions::Canonical().set_print_backend_config(true));
+  auto latency_estimator = std::make_unique<CollectiveSizeLatencyEstimator>(
+      MakeLatencyEstimator(module, config, fingerprint),
+      std::move(bandwidth_per_size));
+  std::unique_ptr<AsyncTracker> async_tracker =
+      MakeAsyncTracker(*module, config);
+  const CollectiveSizeLatencyEstimator* estimator = latency_estimator.get();
+  const AsyncTracker* tracker = async_tracker.get();
+
+  auto shape_size_in_bytes = [pointer_size](const Shape& shape) {
+    return GetSizeOfShape(shape, pointer_size);
+  };
+  HloPassPipeline pipeline("latency-hiding-scheduler");
+  auto scheduler_core = std::make_unique<DefaultSchedulerCore>(
+      shape_size_in_bytes, async_tracker.get(), latency_estimator.get(),
+      config);
+  pipeline.AddPass<LatencyHidingScheduler>(
+      std::move(latency_estimator), std::move(async_tracker),
+      std::move(scheduler_core), shape_size_in_bytes);
+  TF_RETURN_IF_ERROR(pipeline.Run(module).status());
+
+  double exposed_cycles = 0;
+  for (const HloComputation* computation :
+       module->MakeNonfusionComputations()) {
+    LatencyHidingScheduler::SchedulerStatistics stats =
+        LatencyHidingScheduler::LatencyHidingStatistics(
+            computation, estimator, tracker, shape_size_in_bytes);
+    exposed_cycles += stats.all_gather_wasted_cycles +
+                      stats.all_reduce_wasted_cycles +
+                      stats.collective_permute_wasted_cycles +
+                      stats.all_to_all_wasted_cycles +
+                      stats.reduce_scatter_wasted_cycles +
+                      stats.send_wasted_cycles + stats.recv_wasted_cycles;
+    // Synchronous collectives are not overlapped at all.
+    for (const HloInstruction* instr : computation->instructions()) {
+      if (hlo_query::IsAsyncCollectiveStartOp(instr->opcode()) &&
+          !tracker->IsSupportedAsyncStart(*instr) && instr->user_count() > 0) {
+        exposed_cycles += estimator->CollectiveMicros(*instr->users()[0]) *
+                          estimator->CyclesPerMicrosecond();
+      }
+    }
+  }
+  return exposed_cycles / estimator->CyclesPerMicrosecond();
+}
+
 HloInstructionSequence PostProcessSchedule(
     const HloInstructionSequence& input) {
   HloInstructionSequence result = PostprocessorToScheduleSyncCollectives(input);
@@ -21,6 +21,7 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/hlo/ir/hlo_module.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_device_info.h"
+#include "tensorflow/compiler/xla/statusor.h"
 
 namespace xla {
 namespace gpu {
@@ -32,6 +33,15 @@ Status ScheduleGpuModule(HloModule* module, int64_t pointer_size,
                          const GpuDeviceInfo& gpu_info);
 HloInstructionSequence PostProcessSchedule(const HloInstructionSequence& input);
 
+// Schedules `module`, whose collectives must have been converted to their
+// async form, with the latency hiding scheduler and returns the time in
+// microseconds that its collectives are estimated not to overlap with
+// computation. Collectives are estimated to take their size at the bandwidth
+// given by xla_gpu_collective_bandwidth_per_size.
+StatusOr<double> EstimateExposedCollectiveTime(HloModule* module,
+                                               int64_t pointer_size,
+                                               const GpuDeviceInfo& gpu_info);
+
 constexpr absl::string_view kFingerprintBeforeLHS = "fingerprint_before_lhs";
 
 }  // namespace gpu
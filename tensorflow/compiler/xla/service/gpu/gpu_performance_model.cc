@@ -24,7 +24,9 @@ limitations under the License.
 #include "tensorflow/compiler/xla/hlo/ir/hlo_casting_utils.h"
 #include "tensorflow/compiler/xla/hlo/ir/hlo_instruction.h"
 #include "tensorflow/compiler/xla/hlo/ir/hlo_instructions.h"
+#include "tensorflow/compiler/xla/service/gpu/gpu_fusible.h"
 #include "tensorflow/compiler/xla/service/gpu/hlo_fusion_analysis.h"
+#include "tensorflow/compiler/xla/shape_util.h"
 
 namespace xla {
 namespace gpu {
@@ -41,6 +43,9 @@ static constexpr float kL1CacheSpeedup = 8;
 // much smaller than the cache size will likely stay in it.
 // For reference, it can be up to 256 kB per SM on RTX A6000.
 static constexpr float kL1CacheSizePerSM = 2 * 1024;
+// Granularity of global memory accesses: with uncoalesced reads every element
+// costs a whole transaction of this size.
+static constexpr int64_t kMemoryTransactionBytes = 32;
 
 // Returns whether a fusion uses the parameter at the given index elementwise
 // from its root.
@@ -67,6 +72,16 @@ absl::Duration ReadTime(const GpuDeviceInfo& gpu_device_info,
   return absl::Seconds(n_bytes_total / bw);
 }
 
+// Returns how many times slower uncoalesced reads of an array of the given
+// shape are compared to coalesced ones.
+float UncoalescedReadSlowdown(const Shape& shape) {
+  if (!shape.IsArray()) return 1.f;
+  int64_t element_bytes =
+      ShapeUtil::ByteSizeOfPrimitiveType(shape.element_type());
+  return std::max(1.f, static_cast<float>(kMemoryTransactionBytes) /
+                           std::max<int64_t>(element_bytes, 1));
+}
+
 // Tells input access time of the producer alone if fused_consumer
 // is not specified. Otherwise estimates the access time to producer's
 // inputs as if it is fused into the consumer.
@@ -84,6 +99,11 @@ absl::Duration ProducerInputAccessTime(
       consumer_operands.insert(op);
     }
   }
+  // A fused producer is evaluated in the iteration order of the consumer, so if
+  // it physically transposes its inputs, the reads from them are no longer
+  // coalesced (unlike in the producer's own kernel, which tiles the transpose).
+  const bool fused_reads_uncoalesced =
+      fused_consumer != nullptr && IsPhysicallyTransposing(*producer);
   for (int i = 0; i < producer->operand_count(); ++i) {
     int64_t p_size_accessed =
         cost_analysis->operand_bytes_accessed(*producer, i);
@@ -121,9 +141,13 @@ absl::Duration ProducerInputAccessTime(
       }
     }
     CHECK_LE(common_utilization, producer_output_utilization);
-    ret += ReadTime(
+    absl::Duration read_time = ReadTime(
         gpu_device_info, std::min(p_size_net, p_size_accessed),
         p_size_accessed * (producer_output_utilization - common_utilization));
+    if (fused_reads_uncoalesced) {
+      read_time *= UncoalescedReadSlowdown(producer->operand(i)->shape());
+    }
+    ret += read_time;
   }
   return ret;
 }
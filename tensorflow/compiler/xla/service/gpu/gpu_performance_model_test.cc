@@ -845,6 +845,41 @@ TEST_F(GpuPerformanceModelTest, UnusedParameter) {
   EXPECT_NEAR(absl::ToInt64Microseconds(t.time_unfused), 2, 1);
 }
 
+TEST_F(GpuPerformanceModelTest, UncoalescedReadsOfFusedTranspose) {
+  absl::string_view hlo_string = R"(
+HloModule m
+
+t {
+  p0 = f32[4096,4096] parameter(0)
+  ROOT t0 = f32[4096,4096] transpose(p0), dimensions={1,0}
+}
+
+a {
+  p0 = f32[4096,4096] parameter(0)
+  p1 = f32[4096,4096] parameter(1)
+  ROOT a0 = f32[4096,4096] add(p0, p1)
+}
+
+ENTRY e {
+  p0 = f32[4096,4096] parameter(0)
+  p1 = f32[4096,4096] parameter(1)
+  t.1 = f32[4096,4096] fusion(p0), kind=kLoop, calls=t
+  ROOT a.1 = f32[4096,4096] fusion(t.1, p1), kind=kLoop, calls=a
+}
+)";
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(hlo_string));
+  HloInstruction* root = module->entry_computation()->root_instruction();
+  HloInstruction* producer = root->mutable_operand(0);
+  ASSERT_IS_OK(module->entry_computation()->Accept(&analysis_));
+
+  GpuPerformanceModel::RunTimes t = GpuPerformanceModel::EstimateRunTimes(
+      producer, &analysis_, device_info_, std::nullopt, {root});
+  // Fused into the consumer the transpose reads its input uncoalesced, which
+  // costs more than writing and reading back its output.
+  EXPECT_GT(t.time_fused, t.time_unfused);
+}
+
 }  // namespace
 }  // namespace gpu
 }  // namespace xla
@@ -136,6 +136,10 @@ Type TritonType(mlir::OpBuilder b, PrimitiveType t) {
       // Treat PRED as S8.
     case S8:
       return b.getI8Type();
+    case F8E4M3FN:
+      return b.getFloat8E4M3FNType();
+    case F8E5M2:
+      return b.getFloat8E5M2Type();
     default:
       LOG(FATAL) << "This type is not supported yet: "
                  << primitive_util::LowercasePrimitiveTypeName(t);
@@ -147,16 +151,26 @@ Value Cast(mlir::ImplicitLocOpBuilder& b, Value value, Type dst_element_ty) {
   Type src_ty = value.getType();
   Type src_element_ty = src_ty;
   Type fp32_ty = b.getF32Type();
+  Type fp16_ty = b.getF16Type();
   Type dst_ty = dst_element_ty;
   if (auto src_shaped_ty = src_ty.dyn_cast<mlir::ShapedType>()) {
     src_element_ty = src_shaped_ty.getElementType();
     dst_ty = src_shaped_ty.clone(src_shaped_ty.getShape(), dst_element_ty);
     fp32_ty = src_shaped_ty.clone(src_shaped_ty.getShape(), b.getF32Type());
+    fp16_ty = src_shaped_ty.clone(src_shaped_ty.getShape(), b.getF16Type());
   }
   if (src_ty == dst_ty) {
     return value;
   }
 
+  // All operations on FP8 are done through f16.
+  if (src_element_ty.isFloat8E4M3FN() || src_element_ty.isFloat8E5M2()) {
+    return Cast(b, b.create<mt::FpToFpOp>(fp16_ty, value), dst_element_ty);
+  }
+  if (dst_element_ty.isFloat8E4M3FN() || dst_element_ty.isFloat8E5M2()) {
+    return b.create<mt::FpToFpOp>(dst_ty, Cast(b, value, b.getF16Type()));
+  }
+
   // All operations on bf16 are done through f32.
   if (src_element_ty.isBF16()) {
     return Cast(b, b.create<ma::ExtFOp>(fp32_ty, value), dst_element_ty);
@@ -416,6 +430,12 @@ Value EmitParameter(mlir::ImplicitLocOpBuilder& b,
                     const HloInstruction& parameter, mlir::triton::FuncOp fn,
                     Value load_offsets, Value load_mask) {
   Value param = fn.getArgument(parameter.parameter_number());
+  // Scalars, like scaling factors, are loaded once and broadcast.
+  if (ShapeUtil::IsScalar(parameter.shape())) {
+    return b.create<mt::LoadOp>(param, mt::CacheModifier::NONE,
+                                mt::EvictionPolicy::NORMAL,
+                                /*isVolatile=*/false);
+  }
   mlir::ArrayRef<int64_t> tile_shape =
       load_offsets.dyn_cast<TensorValue>().getType().getShape();
   if (load_mask != nullptr) {
@@ -875,11 +895,14 @@ StatusOr<LaunchDimensions> MatMulImpl(
     CHECK(lhs_ty == rhs_ty);
     dot_input_ty = lhs_ty;
   }
-  // TODO(b/266862493): Accumulator can be integer too.
-  // Otherwise only f64 x f64 -> f64 uses f64 accumulator.
-  mlir::FloatType acc_ty = (dot_output_ty.isF64() && dot_input_ty.isF64())
-                               ? b.getF64Type()
-                               : b.getF32Type();
+  // Integer GEMMs accumulate in i32, f64 x f64 -> f64 uses an f64
+  // accumulator, other ones use f32.
+  Type acc_ty = b.getF32Type();
+  if (dot_output_ty.isa<mlir::IntegerType>()) {
+    acc_ty = b.getI32Type();
+  } else if (dot_output_ty.isF64() && dot_input_ty.isF64()) {
+    acc_ty = b.getF64Type();
+  }
 
   // X block size is 32-bit, Y and Z are 16-bit. Use X for large dimensions.
   constexpr int64_t kBlockCountYZLimit = 65536;
@@ -1042,6 +1065,12 @@ StatusOr<LaunchDimensions> MatMulImpl(
                                              ZerosLike(b, dot_input_rhs));
     }
 
+    // FP8 tiles are multiplied in f16.
+    if (dot_input_ty.isFloat8E4M3FN() || dot_input_ty.isFloat8E5M2()) {
+      dot_input_lhs = Cast(b, dot_input_lhs, b.getF16Type());
+      dot_input_rhs = Cast(b, dot_input_rhs, b.getF16Type());
+    }
+
     auto accumulator_next = b.create<mt::DotOp>(
         dot_input_lhs, dot_input_rhs, accumulator,
         /*allowTF32=*/tsl::tensor_float_32_execution_enabled());
@@ -661,6 +661,30 @@ ENTRY e {
   EXPECT_TRUE(RunAndCompare(hlo_text, ErrorSpec{/*aabs=*/1e-6, /*arel=*/1e-6}));
 }
 
+TEST_F(TritonGemmTest, Int8WithDequantizationEpilogue) {
+  const std::string hlo_text = R"(
+HloModule m
+
+ENTRY e {
+  p0 = s8[128,256]{1,0} parameter(0)
+  p1 = s8[256,64]{1,0} parameter(1)
+  d = s32[128,64]{1,0} dot(p0, p1),
+    lhs_contracting_dims={1}, rhs_contracting_dims={0}
+  c = f32[128,64]{1,0} convert(d)
+  p2 = f32[] parameter(2)
+  b = f32[128,64]{1,0} broadcast(p2), dimensions={}
+  ROOT m = f32[128,64]{1,0} multiply(c, b)
+})";
+
+  MatchOptimizedHlo(hlo_text, R"(
+; CHECK: ROOT
+; CHECK-SAME: fusion(%p0, %p1, %p2), kind=kCustom
+; CHECK-SAME: "block_m":
+)");
+
+  EXPECT_TRUE(RunAndCompare(hlo_text, ErrorSpec{/*aabs=*/1e-6, /*arel=*/1e-6}));
+}
+
 TEST_F(TritonGemmTest, Naming) {
   const char* hlo_text = R"(
 HloModule t
@@ -476,6 +476,10 @@ StatusOr<xla::gpu::CudnnfMHAKind> AsCudnnfMHAKind(
       return xla::gpu::CudnnfMHAKind::kScaleBiasSoftmax;
     case mlir::lmhlo_gpu::FusedMhaDagSignature::ScaleBiasSoftmaxDropout:
       return xla::gpu::CudnnfMHAKind::kScaleBiasSoftmaxDropout;
+    case mlir::lmhlo_gpu::FusedMhaDagSignature::FlashScaleSoftmax:
+      return xla::gpu::CudnnfMHAKind::kFlashScaleSoftmax;
+    case mlir::lmhlo_gpu::FusedMhaDagSignature::FlashScaleSoftmaxBackward:
+      return xla::gpu::CudnnfMHAKind::kFlashScaleSoftmaxBackward;
     default:
       return xla::InternalError("unknown fused_mha_dag_signature");
   }
@@ -1233,6 +1237,8 @@ Status IrEmitterUnnested::EmitConvolutionReorderThunk(mlir::Operation* op) {
 
 Status IrEmitterUnnested::EmitFusedMHAThunk(mlir::Operation* op) {
   using mlir::dyn_cast;
+  using mlir::lmhlo_gpu::fusedMHAFlashBackwardOp;
+  using mlir::lmhlo_gpu::fusedMHAFlashOp;
   using mlir::lmhlo_gpu::fusedMHAOp;
   using mlir::lmhlo_gpu::fusedMHAWithScaledBiasOp;
   using mlir::lmhlo_gpu::fusedMHAWithScaledMaskOp;
@@ -1240,7 +1246,7 @@ Status IrEmitterUnnested::EmitFusedMHAThunk(mlir::Operation* op) {
   BufferAllocation::Slice lhs_bmm1_slice, rhs_bmm1_slice, rhs_bmm2_slice,
       output_slice, scratch_slice;
 
-  auto populate_common = [&](auto fmha) -> Status {
+  auto populate_dropout = [&](auto fmha) {
     if (fmha.getDropoutRate()) {
       descriptor.backend_config.set_dropout_rate(
           (*fmha.getDropoutRate()).convertToDouble());
@@ -1249,7 +1255,9 @@ Status IrEmitterUnnested::EmitFusedMHAThunk(mlir::Operation* op) {
     if (fmha.getSeed()) {
       descriptor.backend_config.set_seed((*fmha.getSeed()));
     }
+  };
 
+  auto populate_common = [&](auto fmha) -> Status {
     auto* algorithm = descriptor.backend_config.mutable_algorithm();
     algorithm->set_algo_id(fmha.getAlgorithmConfig().getAlgorithm());
     for (int i = 0; i < fmha.getAlgorithmConfig().getKnobIds().size(); ++i) {
@@ -1312,11 +1320,13 @@ Status IrEmitterUnnested::EmitFusedMHAThunk(mlir::Operation* op) {
 
   BufferAllocation::Slice mask_slice;
   BufferAllocation::Slice bias_slice;
+  BufferAllocation::Slice softmax_stats_slice;
   if (auto fmha_op = dyn_cast<fusedMHAOp>(op)) {
     TF_RET_CHECK(fmha_op != nullptr);
     TF_ASSIGN_OR_RETURN(CudnnfMHAKind kind,
                         AsCudnnfMHAKind(fmha_op.getFusedMhaDag()));
     descriptor.kind = kind;
+    populate_dropout(fmha_op);
     TF_RETURN_IF_ERROR(populate_common(fmha_op));
   } else if (auto fmha_with_scaled_mask_op =
                  dyn_cast<fusedMHAWithScaledMaskOp>(op)) {
@@ -1355,6 +1365,7 @@ Status IrEmitterUnnested::EmitFusedMHAThunk(mlir::Operation* op) {
       TF_ASSIGN_OR_RETURN(
           bias_slice, GetAllocationSlice(fmha_with_scaled_mask_op.getBias()));
     }
+    populate_dropout(fmha_with_scaled_mask_op);
     TF_RETURN_IF_ERROR(populate_common(fmha_with_scaled_mask_op));
   } else if (auto fmha_with_bias_op = dyn_cast<fusedMHAWithScaledBiasOp>(op)) {
     TF_RET_CHECK(fmha_with_bias_op != nullptr);
@@ -1374,7 +1385,63 @@ Status IrEmitterUnnested::EmitFusedMHAThunk(mlir::Operation* op) {
     TF_ASSIGN_OR_RETURN(bias_slice,
                         GetAllocationSlice(fmha_with_bias_op.getBias()));
 
+    populate_dropout(fmha_with_bias_op);
     TF_RETURN_IF_ERROR(populate_common(fmha_with_bias_op));
+  } else if (auto fmha_flash_op = dyn_cast<fusedMHAFlashOp>(op)) {
+    TF_ASSIGN_OR_RETURN(CudnnfMHAKind kind,
+                        AsCudnnfMHAKind(fmha_flash_op.getFusedMhaDag()));
+    descriptor.kind = kind;
+    TF_RET_CHECK(kind == xla::gpu::CudnnfMHAKind::kFlashScaleSoftmax);
+    descriptor.backend_config.set_fmha_scale(
+        fmha_flash_op.getFmhaScale().convertToDouble());
+
+    const Shape& stats_shape = GetShape(fmha_flash_op.getSoftmaxStats());
+    descriptor.softmax_stats_shape = ShapeUtil::MakeShapeWithDenseLayout(
+        stats_shape.element_type(), stats_shape.dimensions(),
+        stats_shape.layout().minor_to_major());
+    TF_ASSIGN_OR_RETURN(softmax_stats_slice,
+                        GetAllocationSlice(fmha_flash_op.getSoftmaxStats()));
+
+    TF_RETURN_IF_ERROR(populate_common(fmha_flash_op));
+  } else if (auto fmha_flash_backward_op =
+                 dyn_cast<fusedMHAFlashBackwardOp>(op)) {
+    TF_ASSIGN_OR_RETURN(
+        CudnnfMHAKind kind,
+        AsCudnnfMHAKind(fmha_flash_backward_op.getFusedMhaDag()));
+    descriptor.kind = kind;
+    TF_RET_CHECK(kind == xla::gpu::CudnnfMHAKind::kFlashScaleSoftmaxBackward);
+    descriptor.backend_config.set_fmha_scale(
+        fmha_flash_backward_op.getFmhaScale().convertToDouble());
+
+    const Shape& stats_shape =
+        GetShape(fmha_flash_backward_op.getSoftmaxStats());
+    descriptor.softmax_stats_shape = ShapeUtil::MakeShapeWithDenseLayout(
+        stats_shape.element_type(), stats_shape.dimensions(),
+        stats_shape.layout().minor_to_major());
+    TF_RETURN_IF_ERROR(populate_common(fmha_flash_backward_op));
+
+    TF_ASSIGN_OR_RETURN(
+        softmax_stats_slice,
+        GetAllocationSlice(fmha_flash_backward_op.getSoftmaxStats()));
+    TF_ASSIGN_OR_RETURN(
+        BufferAllocation::Slice d_output_slice,
+        GetAllocationSlice(fmha_flash_backward_op.getDOutput()));
+    TF_ASSIGN_OR_RETURN(
+        BufferAllocation::Slice d_lhs_bmm1_slice,
+        GetAllocationSlice(fmha_flash_backward_op.getDLhsBmm1()));
+    TF_ASSIGN_OR_RETURN(
+        BufferAllocation::Slice d_rhs_bmm1_slice,
+        GetAllocationSlice(fmha_flash_backward_op.getDRhsBmm1()));
+    TF_ASSIGN_OR_RETURN(
+        BufferAllocation::Slice d_rhs_bmm2_slice,
+        GetAllocationSlice(fmha_flash_backward_op.getDRhsBmm2()));
+    TF_ASSIGN_OR_RETURN(GpufMHAConfig config, GpufMHAConfig::For(descriptor));
+
+    AddThunkToThunkSequence(std::make_unique<FusedMHABackwardThunk>(
+        GetThunkInfo(op), std::move(config), lhs_bmm1_slice, rhs_bmm1_slice,
+        rhs_bmm2_slice, output_slice, softmax_stats_slice, d_output_slice,
+        d_lhs_bmm1_slice, d_rhs_bmm1_slice, d_rhs_bmm2_slice, scratch_slice));
+    return OkStatus();
   } else {
     return InternalError("Unexpected operation");
   }
@@ -1382,7 +1449,8 @@ Status IrEmitterUnnested::EmitFusedMHAThunk(mlir::Operation* op) {
 
   AddThunkToThunkSequence(std::make_unique<FusedMHAThunk>(
       GetThunkInfo(op), std::move(config), lhs_bmm1_slice, rhs_bmm1_slice,
-      rhs_bmm2_slice, output_slice, scratch_slice, mask_slice, bias_slice));
+      rhs_bmm2_slice, output_slice, scratch_slice, mask_slice, bias_slice,
+      softmax_stats_slice));
 
   return OkStatus();
 }
@@ -5289,7 +5357,9 @@ Status IrEmitterUnnested::EmitOp(mlir::Operation* op) {
   }
   if (mlir::isa<mlir::lmhlo_gpu::fusedMHAOp,
                 mlir::lmhlo_gpu::fusedMHAWithScaledMaskOp,
-                mlir::lmhlo_gpu::fusedMHAWithScaledBiasOp>(op)) {
+                mlir::lmhlo_gpu::fusedMHAWithScaledBiasOp,
+                mlir::lmhlo_gpu::fusedMHAFlashOp,
+                mlir::lmhlo_gpu::fusedMHAFlashBackwardOp>(op)) {
     return EmitFusedMHAThunk(op);
   }
 #endif  // GOOGLE_CUDA
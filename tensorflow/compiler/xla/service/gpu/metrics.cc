@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/service/gpu/metrics.h"
 
+#include "tensorflow/tsl/lib/monitoring/counter.h"
 #include "tensorflow/tsl/lib/monitoring/sampler.h"
 
 namespace xla {
@@ -29,6 +30,11 @@ auto* compile_time_usecs_histogram = tsl::monitoring::Sampler<1>::New(
     // Maximum: 1 ms * 2 ^ 24 == ~4.66 hours
     {tsl::monitoring::Buckets::Exponential(1000, 2, 25)});
 
+auto* autotune_cache_lookups = tsl::monitoring::Counter<1>::New(
+    "/xla/service/gpu/autotune_cache_lookups",
+    "The number of lookups of autotuning results, by where they were found.",
+    "result");
+
 }  // namespace
 
 void RecordHloPassesDuration(const uint64_t time_usecs) {
@@ -66,4 +72,19 @@ void RecordPtxToCubinDuration(const uint64_t time_usecs) {
   cell->Add(time_usecs);
 }
 
+void RecordAutotuneCacheMemoryHit() {
+  static auto* cell = autotune_cache_lookups->GetCell("memory_hit");
+  cell->IncrementBy(1);
+}
+
+void RecordAutotuneCacheDirHit() {
+  static auto* cell = autotune_cache_lookups->GetCell("cache_dir_hit");
+  cell->IncrementBy(1);
+}
+
+void RecordAutotuneCacheMiss() {
+  static auto* cell = autotune_cache_lookups->GetCell("miss");
+  cell->IncrementBy(1);
+}
+
 }  // namespace xla
@@ -39,6 +39,12 @@ void RecordLlvmToPtxDuration(uint64_t time_usecs);
 // Compiling PTX to cubin.
 void RecordPtxToCubinDuration(uint64_t time_usecs);
 
+// Lookups of autotuning results: found in memory, found in the autotune cache
+// directory, or not found and autotuned.
+void RecordAutotuneCacheMemoryHit();
+void RecordAutotuneCacheDirHit();
+void RecordAutotuneCacheMiss();
+
 }  // namespace xla
 
 #endif  // TENSORFLOW_COMPILER_XLA_SERVICE_GPU_METRICS_H_
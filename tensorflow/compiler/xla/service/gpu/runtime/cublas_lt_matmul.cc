@@ -130,8 +130,14 @@ static absl::Status CublasLtMatmulImpl(
   se::DeviceMemoryBase d_amax_data;
   if (d_amax.has_value()) d_amax_data = GetDeviceAddress(*d_amax);
 
+  // Use the executable allocator if available, because when the matmul is
+  // captured into a CUDA graph it is the allocator that hands out memory owned
+  // by the graph instance.
+  se::DeviceMemoryAllocator* allocator = run_options->allocator();
+  if (allocator == nullptr) allocator = stream->parent()->GetAllocator();
+
   se::OwningScratchAllocator<> scratch_allocator(
-      stream->parent()->device_ordinal(), stream->parent()->GetAllocator());
+      stream->parent()->device_ordinal(), allocator);
 
   return plan->ExecuteOnStream(stream, a_data, b_data, c_data, d_data,
                                bias_data, aux_data, a_scale_data, b_scale_data,
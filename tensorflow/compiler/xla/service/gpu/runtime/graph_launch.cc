@@ -24,16 +24,20 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/algorithm/container.h"
+#include "absl/strings/str_format.h"
 #include "absl/synchronization/mutex.h"
 #include "tensorflow/compiler/xla/runtime/custom_call.h"
 #include "tensorflow/compiler/xla/runtime/executable.h"
 #include "tensorflow/compiler/xla/service/gpu/non_atomically_upgradeable_rw_lock.h"
 #include "tensorflow/compiler/xla/service/gpu/runtime/concurrent_region.h"
 #include "tensorflow/compiler/xla/service/gpu/runtime/conv.h"
+#include "tensorflow/compiler/xla/service/gpu/runtime/cublas_lt_matmul.h"
 #include "tensorflow/compiler/xla/service/gpu/runtime/gemm.h"
 #include "tensorflow/compiler/xla/service/gpu/runtime/kernel_launch.h"
 #include "tensorflow/compiler/xla/service/gpu/runtime/support.h"
 #include "tensorflow/compiler/xla/service/service_executable_run_options.h"
+#include "tensorflow/compiler/xla/stream_executor/device_memory_allocator.h"
 #include "tensorflow/tsl/profiler/lib/scoped_annotation_stack.h"
 #include "tensorflow/tsl/profiler/lib/traceme.h"
 #include "tensorflow/tsl/profiler/lib/traceme_encode.h"
@@ -72,6 +76,99 @@ CapturedFunctionExecutionCount* CapturedFunctionExecutionCounts::operator()(
   return &counts_[executor];
 }
 
+#if GOOGLE_CUDA
+using MatmulPlansSnapshot = MatmulPlans::Snapshot;
+#else
+struct MatmulPlansSnapshot {};
+#endif  // GOOGLE_CUDA
+
+//===----------------------------------------------------------------------===//
+// CUDA graphs owned allocations.
+//===----------------------------------------------------------------------===//
+
+#if GOOGLE_CUDA
+
+absl::StatusOr<se::DeviceMemoryBase> GraphAllocations::Get(size_t index,
+                                                           uint64_t size) {
+  absl::MutexLock lock(&mutex_);
+  if (pending_.size() <= index) pending_.resize(index + 1, 0);
+
+  if (index < allocations_.size() && allocations_[index]->size() >= size) {
+    pending_[index] = 0;
+    return se::DeviceMemoryBase(allocations_[index]->opaque(), size);
+  }
+
+  pending_[index] = size;
+  return absl::ResourceExhaustedError(absl::StrFormat(
+      "CUDA graph allocation #%d of %d bytes is not available", index, size));
+}
+
+bool GraphAllocations::HasPending() {
+  absl::MutexLock lock(&mutex_);
+  return absl::c_any_of(pending_, [](uint64_t size) { return size > 0; });
+}
+
+absl::Status GraphAllocations::AllocatePending(
+    se::DeviceMemoryAllocator* allocator, int device_ordinal) {
+  absl::MutexLock lock(&mutex_);
+  if (allocations_.size() < pending_.size())
+    allocations_.resize(pending_.size());
+
+  for (size_t i = 0; i < pending_.size(); ++i) {
+    if (pending_[i] == 0) continue;
+
+    TF_ASSIGN_OR_RETURN(se::OwningDeviceMemory allocated,
+                        allocator->Allocate(device_ordinal, pending_[i]));
+    VLOG(3) << "Allocated CUDA graph allocation #" << i << " of "
+            << pending_[i] << " bytes";
+
+    if (!allocations_[i].is_null())
+      retired_.push_back(std::move(allocations_[i]));
+    allocations_[i] = std::move(allocated);
+  }
+
+  pending_.clear();
+  return absl::OkStatus();
+}
+
+// Device memory allocator passed to the operations captured into a CUDA graph,
+// that serves allocations, in the order they are requested, from the memory
+// owned by the graph instance.
+class GraphCaptureAllocator : public se::DeviceMemoryAllocator {
+ public:
+  GraphCaptureAllocator(se::Stream* stream, GraphAllocations* allocations)
+      : se::DeviceMemoryAllocator(stream->parent()->platform()),
+        stream_(stream),
+        allocations_(allocations) {}
+
+  using se::DeviceMemoryAllocator::Allocate;
+
+  tsl::StatusOr<se::OwningDeviceMemory> Allocate(
+      int device_ordinal, uint64_t size, bool retry_on_failure,
+      int64_t memory_space) final {
+    if (size == 0) return se::OwningDeviceMemory();
+    TF_ASSIGN_OR_RETURN(se::DeviceMemoryBase mem,
+                        allocations_->Get(next_index_++, size));
+    return se::OwningDeviceMemory(mem, device_ordinal, this);
+  }
+
+  // Memory is owned by the graph instance and released together with it.
+  tsl::Status Deallocate(int device_ordinal, se::DeviceMemoryBase mem) final {
+    return tsl::OkStatus();
+  }
+
+  tsl::StatusOr<se::Stream*> GetStream(int device_ordinal) final {
+    return stream_;
+  }
+
+ private:
+  se::Stream* stream_;
+  GraphAllocations* allocations_;
+  size_t next_index_ = 0;
+};
+
+#endif  // #if GOOGLE_CUDA
+
 //===----------------------------------------------------------------------===//
 // Helper structure to hash the remaining arguments' memref pointers.
 //===----------------------------------------------------------------------===//
@@ -111,7 +208,7 @@ static bool InDebugMode() {
 static absl::StatusOr<OwnedCudaGraph> CaptureGraph(
     const ServiceExecutableRunOptions* run_options,
     runtime::FunctionRef function_ref, CustomCall::RemainingArgs fwd_args,
-    CustomCall::UserData user_data) {
+    CustomCall::UserData user_data, GraphAllocations* allocations) {
   // We capture graph on a borrowed stream because we do not want to
   // accidentally record any concurrent kernel launches from other XLA
   // executables.
@@ -142,9 +239,13 @@ static absl::StatusOr<OwnedCudaGraph> CaptureGraph(
   // via UserData to be able to detect when executing custom call in graph
   // capture mode. Currently we rely on the fact that we know for sure that
   // operations in the graph capture function do not need anything except the
-  // main stream (we capture only kernel launches).
+  // main stream and device memory owned by the graph instance.
+  GraphCaptureAllocator capture_allocator(capture_stream->get(), allocations);
+
   ExecutableRunOptions capture_run_options;
   capture_run_options.set_stream(capture_stream->get());
+  capture_run_options.set_device_ordinal(executor->device_ordinal());
+  capture_run_options.set_allocator(&capture_allocator);
 
   const ServiceExecutableRunOptions capture_opts(capture_run_options);
   user_data.insert(&capture_opts);
@@ -267,8 +368,8 @@ static absl::Status LaunchGraph(
     StreamExecutorConvRunners::Snapshot* convs,
     StreamExecutorGraphInstances::Snapshot* instances,
     CapturedFunctionExecutionCount::Snapshot* counts,
-    GemmConfigs::Snapshot* gemm_config, runtime::Executable* executable,
-    NonAtomicallyUpgradeableRWLock* gpu_lock,
+    GemmConfigs::Snapshot* gemm_config, MatmulPlansSnapshot* matmul_plans,
+    runtime::Executable* executable, NonAtomicallyUpgradeableRWLock* gpu_lock,
     ConcurrentRegionStatus* region_status, CustomCall::RemainingArgs fwd_args,
     CustomCall::FunctionOrdinal capture) {
 #if GOOGLE_CUDA
@@ -284,7 +385,27 @@ static absl::Status LaunchGraph(
   auto user_data = [&] {
     return CustomCall::UserData(run_options, debug_options, ptx, cubin,
                                 temp_buffer, kernels, convs, executable,
-                                gemm_config, gpu_lock, region_status);
+                                gemm_config, matmul_plans, gpu_lock,
+                                region_status);
+  };
+
+  // Captures the graph, and if captured operations requested device memory
+  // that is not yet owned by the graph instance, allocates it outside of the
+  // capture and captures the graph again.
+  auto capture_graph = [&](GraphAllocations* allocations)
+      -> absl::StatusOr<OwnedCudaGraph> {
+    auto g = CaptureGraph(run_options, function_ref, fwd_args, user_data(),
+                          allocations);
+    if (g.ok() || !allocations->HasPending()) return g;
+
+    se::StreamExecutor* executor = run_options->stream()->parent();
+    se::DeviceMemoryAllocator* allocator = run_options->allocator();
+    if (allocator == nullptr) allocator = executor->GetAllocator();
+    TF_RETURN_IF_ERROR(
+        allocations->AllocatePending(allocator, executor->device_ordinal()));
+
+    return CaptureGraph(run_options, function_ref, fwd_args, user_data(),
+                        allocations);
   };
 
   TF_ASSIGN_OR_RETURN(
@@ -316,12 +437,13 @@ static absl::Status LaunchGraph(
       GraphInstance * instance,
       instances->GetOrCreate(
           capture.ordinal, [&]() -> absl::StatusOr<GraphInstance> {
-            TF_ASSIGN_OR_RETURN(auto g, CaptureGraph(run_options, function_ref,
-                                                     fwd_args, user_data()));
+            auto allocations = std::make_unique<GraphAllocations>();
+            TF_ASSIGN_OR_RETURN(auto g, capture_graph(allocations.get()));
 
             TF_ASSIGN_OR_RETURN(auto e,
                                 se::gpu::InstantiateCudaGraph(std::move(g)));
-            return GraphInstance(ptrs_hash, std::move(e));
+            return GraphInstance(ptrs_hash, std::move(e),
+                                 std::move(allocations));
           }));
 
   {
@@ -344,8 +466,7 @@ static absl::Status LaunchGraph(
   // Otherwise we have to re-capture the graph and update the graph instance.
   VLOG(3) << "Update cached graph instance";
   // Capture CUDA graph by running capture function.
-  TF_ASSIGN_OR_RETURN(
-      auto g, CaptureGraph(run_options, function_ref, fwd_args, user_data()));
+  TF_ASSIGN_OR_RETURN(auto g, capture_graph(instance->allocations.get()));
 
   // At this point we have to grab a writer lock, because we might potentially
   // have concurrent execution of the cached graph instance.
@@ -386,6 +507,7 @@ XLA_RUNTIME_DEFINE_CUSTOM_CALL(
         .UserData<StreamExecutorGraphInstances::Snapshot*>()
         .UserData<CapturedFunctionExecutionCount::Snapshot*>()
         .UserData<GemmConfigs::Snapshot*>()
+        .UserData<MatmulPlansSnapshot*>()
         .UserData<Executable*>()
         .UserData<NonAtomicallyUpgradeableRWLock*>()
         .UserData<ConcurrentRegionStatus*>()
@@ -17,14 +17,19 @@ limitations under the License.
 #define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_RUNTIME_GRAPH_LAUNCH_H_
 
 #include <atomic>
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <string_view>
 #include <tuple>
 #include <utility>
+#include <vector>
 
 #include "absl/container/node_hash_map.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
 #include "tensorflow/compiler/xla/runtime/custom_call_registry.h"
+#include "tensorflow/compiler/xla/stream_executor/device_memory_allocator.h"
 #include "tensorflow/compiler/xla/stream_executor/stream_executor.h"
 
 #if GOOGLE_CUDA
@@ -53,10 +58,46 @@ class CapturedFunctionExecutionCount
 class StreamExecutorGraphInstances
     : public runtime::StateVector<GraphInstance> {};
 
+// Device memory owned by a CUDA graph instance. Operations captured into a
+// graph can't allocate memory (e.g. cuBLASLt workspace), because allocation
+// would happen only once at capture time, so instead they get it from the
+// allocations owned by the graph, which outlive all launches of the graph.
+//
+// Allocations are identified by the order in which they are requested during
+// graph capture. When an allocation is missing or too small, the request is
+// recorded as pending and the capture fails; the caller then allocates pending
+// requests outside of the capture and captures the graph again.
+class GraphAllocations {
+ public:
+  // Returns allocation `index` if it is at least `size` bytes large, otherwise
+  // records a pending request and returns an error.
+  absl::StatusOr<se::DeviceMemoryBase> Get(size_t index, uint64_t size);
+
+  // Returns true if some requests were not satisfied in the last capture.
+  bool HasPending();
+
+  // Allocates all pending requests. Allocations that are replaced with larger
+  // ones are kept alive, because they might be used by in-flight launches of
+  // the previously captured graph.
+  absl::Status AllocatePending(se::DeviceMemoryAllocator* allocator,
+                               int device_ordinal);
+
+ private:
+  absl::Mutex mutex_;
+  std::vector<se::OwningDeviceMemory> allocations_ ABSL_GUARDED_BY(mutex_);
+  std::vector<se::OwningDeviceMemory> retired_ ABSL_GUARDED_BY(mutex_);
+  // Requested sizes of missing or too small allocations (zero if satisfied).
+  std::vector<uint64_t> pending_ ABSL_GUARDED_BY(mutex_);
+};
+
 // Instantiated CUDA graph instance guarded with a mutex for exclusive access.
 struct GraphInstance {
-  GraphInstance(size_t ptr_hash, se::gpu::OwnedCudaGraphExec exec)
-      : ptr_hash(ptr_hash), exec(std::move(exec)), mutex(new absl::Mutex) {}
+  GraphInstance(size_t ptr_hash, se::gpu::OwnedCudaGraphExec exec,
+                std::unique_ptr<GraphAllocations> allocations)
+      : ptr_hash(ptr_hash),
+        exec(std::move(exec)),
+        allocations(std::move(allocations)),
+        mutex(new absl::Mutex) {}
 
   // Graph instance is fully identified by the hash of its pointer arguments
   // because currently it's guaranteed that all shapes and launch dimensions
@@ -64,6 +105,9 @@ struct GraphInstance {
   size_t ptr_hash ABSL_GUARDED_BY(*mutex);
   se::gpu::OwnedCudaGraphExec exec ABSL_GUARDED_BY(*mutex);
 
+  // Device memory used by the operations captured into the graph.
+  std::unique_ptr<GraphAllocations> allocations;
+
   // Access to a graph instance must be synchronized, because we potentially can
   // run concurrent graph instance updates.
   std::unique_ptr<absl::Mutex> mutex;
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/runtime/custom_call.h"
 #include "tensorflow/compiler/xla/runtime/executable.h"
+#include "tensorflow/compiler/xla/service/gpu/runtime/concurrent_region.h"
 #include "tensorflow/compiler/xla/service/gpu/runtime/support.h"
 #include "tensorflow/compiler/xla/service/service_executable_run_options.h"
 
@@ -107,9 +108,14 @@ static absl::StatusOr<uint32_t> ToBitPattern(CustomCall::VariantArg constant) {
 }
 
 static absl::Status MemsetImpl(const ServiceExecutableRunOptions* run_options,
+                               ConcurrentRegionStatus* region_status,
                                StridedMemrefView dst,
                                CustomCall::VariantArg constant) {
   se::Stream* stream = run_options->stream();
+  if (region_status->IsInConcurrentRegion()) {
+    stream = region_status->GetNextStream();
+  }
+
   se::DeviceMemoryBase dst_data = GetDeviceAddress(dst);
 
   // If the constant is zero we can use memzero directly.
@@ -134,6 +140,7 @@ XLA_RUNTIME_DEFINE_CUSTOM_CALL(
     Memset, FunctionWrapper<MemsetImpl>(), checks,
     CustomCall::Bind("xla.gpu.memset")
         .UserData<const ServiceExecutableRunOptions*>()
+        .UserData<ConcurrentRegionStatus*>()
         .Arg<StridedMemrefView>()       // dst
         .Arg<CustomCall::VariantArg>()  // constant
 );
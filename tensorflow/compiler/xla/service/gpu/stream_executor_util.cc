@@ -505,6 +505,8 @@ StatusOr<se::dnn::FusedMHAKind> GetDNNFusedMHAKindFromCudnnfMHAKind(
     case CudnnfMHAKind::kScaleBiasSoftmaxDropout:
       return se::dnn::FusedMHAKind::BMM1_OUTPUT_INPUT_TYPE;
     case CudnnfMHAKind::kSoftmax:
+    case CudnnfMHAKind::kFlashScaleSoftmax:
+    case CudnnfMHAKind::kFlashScaleSoftmaxBackward:
       return se::dnn::FusedMHAKind::BMM1_OUTPUT_FLOAT;
   }
   return InternalError("Unexpected fMHA kind");
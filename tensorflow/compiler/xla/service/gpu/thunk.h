@@ -84,7 +84,8 @@ class Thunk {
     kSequential,
     kTriangularSolve,
     kWhile,
-    kFusedMHA
+    kFusedMHA,
+    kFusedMHABackward
   };
 
   struct ThunkInfo {
@@ -44,6 +44,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/hlo/ir/hlo_instruction.h"
 #include "tensorflow/compiler/xla/hlo/ir/hlo_module.h"
 #include "tensorflow/compiler/xla/hlo/ir/hlo_opcode.h"
+#include "tensorflow/compiler/xla/hlo/utils/hlo_query.h"
 #include "tensorflow/compiler/xla/service/backend.h"
 #include "tensorflow/compiler/xla/service/executable.h"
 #include "tensorflow/compiler/xla/service/float_normalization.h"
@@ -316,10 +317,22 @@ class TritonAutotunerVisitor : public DfsHloRewriteVisitor {
 
     BufferComparator comparator(root->shape(), fusion.parent()->config());
 
-    const std::vector<AutotuneResult::TritonGemmKey> configurations =
+    std::vector<AutotuneResult::TritonGemmKey> configurations =
         GetPossibleMatmulAutotuneConfigs(
             stream_exec->GetDeviceDescription().cuda_compute_capability(),
             config_.ExhaustiveTilingSearch());
+    // The MMA instructions on 8-bit integers take 32 elements of the
+    // contracting dimension.
+    const HloInstruction* dot =
+        hlo_query::GetFirstInstructionWithOpcode(fusion, HloOpcode::kDot);
+    if (dot->operand(0)->shape().element_type() == S8) {
+      configurations.erase(
+          std::remove_if(configurations.begin(), configurations.end(),
+                         [](const AutotuneResult::TritonGemmKey& config) {
+                           return config.block_k() < 32;
+                         }),
+          configurations.end());
+    }
 
     // Pre-compile all versions first using the thread pool.
     if (thread_pool_) {
@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/heap_simulator.h"
 
 #include <algorithm>
+#include <cmath>
 #include <cstddef>
 #include <cstdint>
 #include <cstdlib>
@@ -645,46 +646,159 @@ void GlobalDecreasingSizeBestFitHeap<BufferType>::Free(const BufferType* buffer,
 
 using Chunk = HeapSimulator::Chunk;
 
+namespace {
+
+// A subtree of BufferIntervalTree is rebalanced when one of the children of its
+// root holds more than this fraction of its nodes.
+constexpr double kIntervalTreeBalance = 2.0 / 3.0;
+
+std::tuple<int64_t, int64_t, int64_t> IntervalTreeKey(int64_t start,
+                                                      int64_t end,
+                                                      const Chunk& chunk) {
+  return std::make_tuple(start, end, chunk.offset);
+}
+
+std::tuple<int64_t, int64_t, int64_t> IntervalTreeKey(
+    const BufferIntervalTreeNode& node) {
+  return IntervalTreeKey(node.start, node.end, node.chunk);
+}
+
+int64_t IntervalTreeSize(const BufferIntervalTreeNode* node) {
+  int64_t size = 0;
+  std::vector<const BufferIntervalTreeNode*> visiting_stack;
+  if (node != nullptr) {
+    visiting_stack.push_back(node);
+  }
+  while (!visiting_stack.empty()) {
+    const BufferIntervalTreeNode* top = visiting_stack.back();
+    visiting_stack.pop_back();
+    ++size;
+    if (top->left != nullptr) {
+      visiting_stack.push_back(top->left);
+    }
+    if (top->right != nullptr) {
+      visiting_stack.push_back(top->right);
+    }
+  }
+  return size;
+}
+
+// Links `nodes`, which are in order, into a balanced tree under `parent`, and
+// returns its root.
+BufferIntervalTreeNode* BuildBalancedIntervalTree(
+    absl::Span<BufferIntervalTreeNode* const> nodes,
+    BufferIntervalTreeNode* parent) {
+  if (nodes.empty()) {
+    return nullptr;
+  }
+  const size_t mid = nodes.size() / 2;
+  BufferIntervalTreeNode* node = nodes[mid];
+  node->parent = parent;
+  node->left = BuildBalancedIntervalTree(nodes.subspan(0, mid), node);
+  node->right = BuildBalancedIntervalTree(nodes.subspan(mid + 1), node);
+  node->subtree_end = node->end;
+  if (node->left != nullptr) {
+    node->subtree_end = std::max(node->subtree_end, node->left->subtree_end);
+  }
+  if (node->right != nullptr) {
+    node->subtree_end = std::max(node->subtree_end, node->right->subtree_end);
+  }
+  return node;
+}
+
+}  // namespace
+
 void BufferIntervalTree::Add(int64_t start, int64_t end, const Chunk& chunk) {
   node_storage_.emplace_back(BufferIntervalTreeNode{
       start, end, end, chunk,
       /*left=*/nullptr, /*right=*/nullptr, /*parent=*/nullptr});
+  BufferIntervalTreeNode* node = &node_storage_.back();
+  ++num_nodes_;
   if (root_ == nullptr) {
-    root_ = &node_storage_.back();
+    root_ = node;
     // This is root.
     return;
   }
 
+  const auto key = IntervalTreeKey(start, end, chunk);
   BufferIntervalTreeNode* parent = root_;
+  int64_t depth = 1;
   while (true) {
     parent->subtree_end = std::max(parent->subtree_end, end);
-    if (parent->start > start) {
-      if (parent->left == nullptr) {
-        parent->left = &node_storage_.back();
-        node_storage_.back().parent = parent;
-        return;
-      }
-      parent = parent->left;
-    } else {
-      if (parent->right == nullptr) {
-        parent->right = &node_storage_.back();
-        node_storage_.back().parent = parent;
-        return;
-      }
-      parent = parent->right;
+    BufferIntervalTreeNode*& child =
+        key < IntervalTreeKey(*parent) ? parent->left : parent->right;
+    if (child == nullptr) {
+      child = node;
+      node->parent = parent;
+      break;
     }
+    parent = child;
+    ++depth;
+  }
+
+  // Buffers are often added in order of their start times, which would turn an
+  // unbalanced tree into a list.
+  if (depth <= std::log(static_cast<double>(num_nodes_)) /
+                   std::log(1.0 / kIntervalTreeBalance)) {
+    return;
+  }
+  // The tree is too deep, so some ancestor of `node` has a child that holds
+  // too many of its nodes. Rebuild the subtree of the lowest such ancestor.
+  BufferIntervalTreeNode* child = node;
+  int64_t child_size = 1;
+  while (child->parent != nullptr) {
+    BufferIntervalTreeNode* ancestor = child->parent;
+    const int64_t ancestor_size =
+        child_size + 1 +
+        IntervalTreeSize(ancestor->left == child ? ancestor->right
+                                                 : ancestor->left);
+    if (child_size > kIntervalTreeBalance * ancestor_size) {
+      Rebalance(ancestor);
+      return;
+    }
+    child = ancestor;
+    child_size = ancestor_size;
+  }
+}
+
+void BufferIntervalTree::Rebalance(BufferIntervalTreeNode* node) {
+  // Collect the nodes of the subtree in order.
+  std::vector<BufferIntervalTreeNode*> nodes;
+  std::vector<BufferIntervalTreeNode*> visiting_stack;
+  BufferIntervalTreeNode* current = node;
+  while (current != nullptr || !visiting_stack.empty()) {
+    while (current != nullptr) {
+      visiting_stack.push_back(current);
+      current = current->left;
+    }
+    current = visiting_stack.back();
+    visiting_stack.pop_back();
+    nodes.push_back(current);
+    current = current->right;
+  }
+
+  BufferIntervalTreeNode* parent = node->parent;
+  BufferIntervalTreeNode* subtree_root =
+      BuildBalancedIntervalTree(nodes, parent);
+  if (parent == nullptr) {
+    root_ = subtree_root;
+  } else if (parent->left == node) {
+    parent->left = subtree_root;
+  } else {
+    parent->right = subtree_root;
   }
 }
 
 bool BufferIntervalTree::Remove(int64_t start, int64_t end,
                                 const Chunk& chunk) {
+  const auto key = IntervalTreeKey(start, end, chunk);
   BufferIntervalTreeNode* to_delete = root_;
   while (to_delete != nullptr) {
     if (to_delete->start == start && to_delete->end == end &&
         to_delete->chunk.offset == chunk.offset) {
       break;
     }
-    if (start < to_delete->start) {
+    if (key < IntervalTreeKey(*to_delete)) {
       to_delete = to_delete->left;
     } else {
       to_delete = to_delete->right;
@@ -694,6 +808,7 @@ bool BufferIntervalTree::Remove(int64_t start, int64_t end,
     // Nothing to delete.
     return false;
   }
+  --num_nodes_;
   // Found the node to be deleted, enter deletion sequence.
 
   // Recursively traverse the parents of node and fix up the `subtree_end`
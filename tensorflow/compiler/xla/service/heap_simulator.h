@@ -356,6 +356,12 @@ struct BufferIntervalTreeNode {
 };
 
 // An interval tree that can query buffers overlapping in time.
+//
+// Nodes are ordered by (start, end, chunk offset). The tree is kept balanced
+// like a scapegoat tree: when an insertion makes it too deep, the smallest
+// unbalanced subtree on the insertion path is rebuilt. This keeps insertions
+// and queries logarithmic (amortized) in the number of buffers, even when
+// buffers are added in order of their start times.
 class BufferIntervalTree {
  public:
   using Chunk = HeapSimulator::Chunk;
@@ -373,8 +379,13 @@ class BufferIntervalTree {
   BufferIntervalTreeNode* GetRoot() { return root_; }
 
  private:
+  // Rebuilds the subtree rooted at `node` into a balanced tree.
+  void Rebalance(BufferIntervalTreeNode* node);
+
   BufferIntervalTreeNode* root_ = nullptr;
   std::list<BufferIntervalTreeNode> node_storage_;
+  // Number of nodes in the tree.
+  int64_t num_nodes_ = 0;
 };
 
 // GlobalDecreasingSizeBestFitHeap collects the live intervals of all buffers,
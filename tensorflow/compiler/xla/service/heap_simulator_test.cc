@@ -37,6 +37,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/tests/hlo_test_base.h"
 #include "tensorflow/tsl/lib/core/status_test_util.h"
 #include "tensorflow/tsl/platform/test.h"
+#include "tensorflow/tsl/platform/test_benchmark.h"
 
 namespace xla {
 namespace {
@@ -1709,6 +1710,53 @@ TEST_F(IntervalTreeTest, ThreeLevelsRightLeftChunkDifferent) {
   ASSERT_EQ(tree.GetRoot(), nullptr);
 }
 
+TEST_F(IntervalTreeTest, StaysBalancedWhenAddedInOrder) {
+  // A plain binary search tree would turn into a list.
+  constexpr int kNumIntervals = 1024;
+  BufferIntervalTree tree;
+  for (int i = 0; i < kNumIntervals; ++i) {
+    tree.Add(i, i + 10, HeapSimulator::Chunk::FromOffsetSize(i, 1));
+  }
+
+  std::function<int(const BufferIntervalTreeNode*)> height =
+      [&](const BufferIntervalTreeNode* node) {
+        if (node == nullptr) {
+          return 0;
+        }
+        return 1 + std::max(height(node->left), height(node->right));
+      };
+  // log_{3/2}(1024) is about 17.
+  EXPECT_LE(height(tree.GetRoot()), 20);
+
+  // Intervals [490, 500] to [505, 515] overlap with [500, 505].
+  std::vector<HeapSimulator::Chunk> chunks =
+      tree.ChunksOverlappingInTime(500, 505);
+  EXPECT_EQ(chunks.size(), 16);
+  for (const HeapSimulator::Chunk& chunk : chunks) {
+    EXPECT_GE(chunk.offset, 490);
+    EXPECT_LE(chunk.offset, 505);
+  }
+
+  for (int i = 0; i < kNumIntervals; ++i) {
+    EXPECT_TRUE(
+        tree.Remove(i, i + 10, HeapSimulator::Chunk::FromOffsetSize(i, 1)));
+  }
+  ASSERT_EQ(tree.GetRoot(), nullptr);
+}
+
+TEST_F(IntervalTreeTest, SameStartTimes) {
+  BufferIntervalTree tree;
+  for (int i = 0; i < 100; ++i) {
+    tree.Add(0, 100 - i, HeapSimulator::Chunk::FromOffsetSize(i, 1));
+  }
+  EXPECT_EQ(tree.ChunksOverlappingInTime(50, 60).size(), 51);
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_TRUE(
+        tree.Remove(0, 100 - i, HeapSimulator::Chunk::FromOffsetSize(i, 1)));
+  }
+  ASSERT_EQ(tree.GetRoot(), nullptr);
+}
+
 class SlicedBufferIntervalTest : public ::testing::Test {
  public:
   using HeapTy = GlobalDecreasingSizeBestFitHeap<HloValue>;
@@ -2664,5 +2712,41 @@ t0 |xxxxx000        xxxx      xxxxxxxxxxxxxx   xxxxxxxxxxxxxxxxxxxxxxxxxxxx
                                      Chunk::FromOffsetSize(11, 0)));
 }
 
+// Runs buffer assignment's heap algorithm on a synthetic module with a long
+// chain of instructions, whose values are each live while the next few are
+// defined.
+void BM_GlobalDecreasingSizeBestFitHeap(::testing::benchmark::State& state) {
+  const int num_buffers = state.range(0);
+  constexpr int kNumLiveBuffers = 8;
+  auto buffer_size = [](int i) { return int64_t{16} << (i % 4); };
+
+  HloComputation::Builder builder("heap_simulator_benchmark");
+  HloInstruction* constant = builder.AddInstruction(
+      HloInstruction::CreateConstant(LiteralUtil::CreateR0<float>(1.0)));
+  std::vector<std::unique_ptr<HloValue>> buffers;
+  buffers.reserve(num_buffers);
+  for (int i = 0; i < num_buffers; ++i) {
+    buffers.push_back(std::make_unique<HloValue>(i, constant, ShapeIndex{}));
+  }
+
+  for (auto s : state) {
+    GlobalDecreasingSizeBestFitHeap<HloValue> heap(/*alignment=*/1);
+    for (int i = 0; i < num_buffers; ++i) {
+      heap.Alloc(buffers[i].get(), buffer_size(i));
+      if (i >= kNumLiveBuffers) {
+        heap.Free(buffers[i - kNumLiveBuffers].get(),
+                  buffer_size(i - kNumLiveBuffers));
+      }
+    }
+    for (int i = std::max(0, num_buffers - kNumLiveBuffers); i < num_buffers;
+         ++i) {
+      heap.Free(buffers[i].get(), buffer_size(i));
+    }
+    tsl::testing::DoNotOptimize(heap.Finish());
+  }
+}
+
+BENCHMARK(BM_GlobalDecreasingSizeBestFitHeap)->Range(1 << 10, 1 << 17);
+
 }  // namespace
 }  // namespace xla
@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_XLA_SERVICE_HLO_PASS_INTERFACE_H_
 #define TENSORFLOW_COMPILER_XLA_SERVICE_HLO_PASS_INTERFACE_H_
 
+#include <vector>
+
 #include "absl/container/flat_hash_set.h"
 #include "absl/strings/string_view.h"
 #include "tensorflow/compiler/xla/hlo/ir/hlo_module.h"
@@ -167,6 +169,41 @@ class HloModulePass : public HloPassInterface {
   virtual void UpdateLayout(Shape* shape) {}
 };
 
+// Base class for passes which are computation-local: running the pass on a
+// computation only reads and changes the instructions of that computation and
+// of the computations it calls, and does not add or remove computations.
+// HloPassPipeline may run such passes on independent computations of a module
+// in parallel (see DebugOptions::xla_hlo_pass_parallelism), in which case
+// RunOnComputation is called concurrently for computations that don't call
+// each other, after it has been called on the computations they call.
+class HloComputationPass : public HloModulePass {
+ public:
+  // Runs the pass on a single computation. Returns whether it was changed.
+  // Must be safe to call concurrently on different computations.
+  virtual StatusOr<bool> RunOnComputation(HloComputation* computation) = 0;
+
+  // Returns the computations of `module` the pass runs on.
+  virtual std::vector<HloComputation*> ComputationsToRun(
+      HloModule* module,
+      const absl::flat_hash_set<absl::string_view>& execution_threads) {
+    return module->MakeNonfusionComputations(execution_threads);
+  }
+
+  using HloPassInterface::Run;
+  StatusOr<bool> Run(HloModule* module,
+                     const absl::flat_hash_set<absl::string_view>&
+                         execution_threads) final {
+    bool changed = false;
+    for (HloComputation* computation :
+         ComputationsToRun(module, execution_threads)) {
+      TF_ASSIGN_OR_RETURN(bool computation_changed,
+                          RunOnComputation(computation));
+      changed |= computation_changed;
+    }
+    return changed;
+  }
+};
+
 // Base class for passes which are module-group scoped. These passes cannot run
 // on an HLO module.
 class HloModuleGroupPass : public HloPassInterface {
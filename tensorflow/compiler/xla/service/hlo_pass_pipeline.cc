@@ -15,9 +15,14 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/service/hlo_pass_pipeline.h"
 
+#include <algorithm>
 #include <functional>
+#include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/strings/str_format.h"
@@ -28,6 +33,8 @@ limitations under the License.
 #include "tensorflow/compiler/xla/status_macros.h"
 #include "tensorflow/compiler/xla/types.h"
 #include "tensorflow/compiler/xla/util.h"
+#include "tensorflow/tsl/platform/blocking_counter.h"
+#include "tensorflow/tsl/platform/env.h"
 #include "tensorflow/tsl/platform/errors.h"
 #include "tensorflow/tsl/platform/logging.h"
 #include "tensorflow/tsl/platform/status.h"
@@ -231,6 +238,82 @@ StatusOr<bool> HloPassPipeline::RunPassesInternal(
   return changed;
 }
 
+StatusOr<bool> HloPassPipeline::RunComputationPass(
+    HloComputationPass* pass, HloModule* module,
+    const absl::flat_hash_set<absl::string_view>& execution_threads) {
+  const int parallelism =
+      module->config().debug_options().xla_hlo_pass_parallelism();
+  std::vector<HloComputation*> computations =
+      pass->ComputationsToRun(module, execution_threads);
+  if (parallelism <= 1 || computations.size() <= 1) {
+    return pass->Run(module, execution_threads);
+  }
+
+  // Group the computations into waves, so that a computation runs after all
+  // the computations it calls, directly or through computations the pass does
+  // not run on. Computations of the same wave are independent.
+  absl::flat_hash_map<const HloComputation*, int> computation_index;
+  for (int i = 0; i < computations.size(); ++i) {
+    computation_index[computations[i]] = i;
+  }
+  // Number of waves needed to run a computation and everything it calls.
+  absl::flat_hash_map<const HloComputation*, int> depth;
+  std::vector<std::vector<int>> waves;
+  for (const HloComputation* computation :
+       module->MakeComputationPostOrder(execution_threads)) {
+    int callee_depth = 0;
+    for (const HloInstruction* instruction : computation->instructions()) {
+      for (const HloComputation* callee : instruction->called_computations()) {
+        auto it = depth.find(callee);
+        if (it != depth.end()) {
+          callee_depth = std::max(callee_depth, it->second);
+        }
+      }
+    }
+    auto it = computation_index.find(computation);
+    if (it == computation_index.end()) {
+      depth[computation] = callee_depth;
+      continue;
+    }
+    depth[computation] = callee_depth + 1;
+    if (waves.size() <= callee_depth) {
+      waves.resize(callee_depth + 1);
+    }
+    waves[callee_depth].push_back(it->second);
+  }
+
+  if (thread_pool_ == nullptr || thread_pool_->NumThreads() != parallelism) {
+    thread_pool_ = std::make_unique<tsl::thread::ThreadPool>(
+        tsl::Env::Default(), "hlo_pass_pipeline", parallelism);
+  }
+  VLOG(1) << "    Running " << pass->name() << " on " << computations.size()
+          << " computations in " << waves.size() << " waves";
+
+  module->StartConcurrentComputationChanges(computations);
+  std::vector<StatusOr<bool>> results(computations.size(), false);
+  for (const std::vector<int>& wave : waves) {
+    tsl::BlockingCounter counter(wave.size());
+    for (int i : wave) {
+      thread_pool_->Schedule([&, i] {
+        results[i] = pass->RunOnComputation(computations[i]);
+        counter.DecrementCount();
+      });
+    }
+    counter.Wait();
+    if (absl::c_any_of(wave, [&](int i) { return !results[i].ok(); })) {
+      break;
+    }
+  }
+  module->FinishConcurrentComputationChanges(computations);
+
+  bool changed = false;
+  for (StatusOr<bool>& result : results) {
+    TF_ASSIGN_OR_RETURN(bool computation_changed, std::move(result));
+    changed |= computation_changed;
+  }
+  return changed;
+}
+
 std::vector<HloPassInterface*> HloPassPipeline::GetEnabledPasses(
     const DebugOptions& debug_options) {
   if (debug_options.xla_disable_all_hlo_passes()) {
@@ -27,6 +27,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/hlo_pass_interface.h"
 #include "tensorflow/compiler/xla/statusor.h"
 #include "tensorflow/compiler/xla/types.h"
+#include "tensorflow/tsl/platform/threadpool.h"
 
 namespace xla {
 
@@ -134,10 +135,15 @@ class HloPassPipeline : public HloPassInterface {
   // empty thread list means all `execution_threads` are considered. These
   // helpers enable templating of the core of the pipeline logic by providing
   // HloModule and HloModuleGroup specific methods with the same name.
-  static StatusOr<bool> RunHelper(
+  StatusOr<bool> RunHelper(
       HloPassInterface* pass, HloModule* module,
       const absl::flat_hash_set<absl::string_view>& execution_threads) {
-    TF_ASSIGN_OR_RETURN(bool changed, pass->Run(module, execution_threads));
+    auto* computation_pass = dynamic_cast<HloComputationPass*>(pass);
+    TF_ASSIGN_OR_RETURN(
+        bool changed,
+        computation_pass != nullptr
+            ? RunComputationPass(computation_pass, module, execution_threads)
+            : pass->Run(module, execution_threads));
     module->Cleanup();
     return changed;
   }
@@ -150,6 +156,12 @@ class HloPassPipeline : public HloPassInterface {
     return changed;
   }
 
+  // Runs a computation-local pass on the given module, on independent
+  // computations in parallel if the module's DebugOptions enable it.
+  StatusOr<bool> RunComputationPass(
+      HloComputationPass* pass, HloModule* module,
+      const absl::flat_hash_set<absl::string_view>& execution_threads);
+
   const std::string name_;
   std::vector<std::unique_ptr<HloPassInterface>> passes_;
   std::vector<std::unique_ptr<HloPassInterface>> invariant_checkers_;
@@ -160,6 +172,9 @@ class HloPassPipeline : public HloPassInterface {
   // Use via compilation_stats_, not directly.
   std::unique_ptr<CompilationStats> empty_compilation_stats_;
 
+  // Threads running computation-local passes, created on first use.
+  std::unique_ptr<tsl::thread::ThreadPool> thread_pool_;
+
   // Allow PhaseOrderPipeline to modify private passes_ member in order to
   // perform PhaseOrdering.
   friend class ::xla::PhaseOrderPipeline;
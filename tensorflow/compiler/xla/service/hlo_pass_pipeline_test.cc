@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/service/hlo_pass_pipeline.h"
 
+#include "absl/strings/str_cat.h"
 #include "tensorflow/compiler/xla/hlo/ir/hlo_computation.h"
 #include "tensorflow/compiler/xla/hlo/ir/hlo_instruction.h"
 #include "tensorflow/compiler/xla/hlo/ir/hlo_module.h"
@@ -133,6 +134,86 @@ class BarBlowerUpper : public HloModulePass {
   }
 };
 
+// A computation-local pass which negates the root of each computation, and
+// fails if a computation is run before the computations it calls.
+class NegateRootComputationPass : public HloComputationPass {
+  absl::string_view name() const override { return "negate-root"; }
+
+  StatusOr<bool> RunOnComputation(HloComputation* computation) override {
+    for (HloInstruction* instruction : computation->instructions()) {
+      for (HloComputation* callee : instruction->called_computations()) {
+        if (callee->root_instruction()->opcode() != HloOpcode::kNegate) {
+          return InternalError("%s was run before %s", computation->name(),
+                               callee->name());
+        }
+      }
+    }
+    HloInstruction* root = computation->root_instruction();
+    computation->set_root_instruction(
+        computation->AddInstruction(HloInstruction::CreateUnary(
+            root->shape(), HloOpcode::kNegate, root)));
+    return true;
+  }
+};
+
+TEST_F(HloPassPipelineTest, ComputationPassRunsInParallel) {
+  const std::string module_str = R"(
+HloModule ComputationPassRunsInParallel
+
+a {
+  ROOT p = f32[] parameter(0)
+}
+
+b {
+  p = f32[] parameter(0)
+  ROOT call = f32[] call(p), to_apply=a
+}
+
+c {
+  ROOT p = f32[] parameter(0)
+}
+
+d {
+  ROOT p = f32[] parameter(0)
+}
+
+ENTRY main {
+  p = f32[] parameter(0)
+  call_b = f32[] call(p), to_apply=b
+  call_c = f32[] call(call_b), to_apply=c
+  ROOT call_d = f32[] call(call_c), to_apply=d
+}
+)";
+  auto run_pipeline = [&](int parallelism) -> StatusOr<std::string> {
+    TF_ASSIGN_OR_RETURN(std::unique_ptr<HloModule> module,
+                        ParseAndReturnVerifiedModule(module_str));
+    DebugOptions debug_options = module->config().debug_options();
+    debug_options.set_xla_hlo_pass_parallelism(parallelism);
+    module->config().set_debug_options(debug_options);
+
+    HloPassPipeline pipeline(TestName());
+    pipeline.AddPass<NegateRootComputationPass>();
+    TF_ASSIGN_OR_RETURN(bool changed, pipeline.Run(module.get()));
+    EXPECT_TRUE(changed);
+    TF_RETURN_IF_ERROR(
+        module->CheckUniqueNamesAndIdsForComputationsAndInstructions());
+    std::string result = module->ToString();
+    for (const HloComputation* computation : module->computations()) {
+      for (const HloInstruction* instruction : computation->instructions()) {
+        absl::StrAppend(&result, "\n", instruction->name(), " ",
+                        instruction->unique_id());
+      }
+    }
+    return result;
+  };
+
+  TF_ASSERT_OK_AND_ASSIGN(std::string serial, run_pipeline(1));
+  for (int i = 0; i < 10; ++i) {
+    TF_ASSERT_OK_AND_ASSIGN(std::string parallel, run_pipeline(4));
+    EXPECT_EQ(parallel, serial);
+  }
+}
+
 TEST_F(HloPassPipelineTest, ModulePassChanged) {
   // Test an HLO module pass which changes a module.
   const std::string module_str = R"(
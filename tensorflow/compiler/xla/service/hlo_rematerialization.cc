@@ -47,6 +47,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/hlo_memory_scheduler.h"
 #include "tensorflow/compiler/xla/service/hlo_ordering.h"
 #include "tensorflow/compiler/xla/service/logical_buffer.h"
+#include "tensorflow/compiler/xla/shape_util.h"
 #include "tensorflow/compiler/xla/status_macros.h"
 #include "tensorflow/compiler/xla/statusor.h"
 #include "tensorflow/compiler/xla/types.h"
@@ -127,6 +128,8 @@ struct RematStrategy {
     // Change the layout into a compact form and uncompress it back at a later
     // program point.
     kCompress,
+    // Copy the node to host memory and copy it back at a later program point.
+    kHostOffload,
   } kind;
   Shape compact_shape;
 };
@@ -504,7 +507,9 @@ class MemoryUsageTracker {
       const HloRematerialization::CompactShapeFunction& compact_shape_function,
       const TuplePointsToAnalysis& points_to_analysis,
       const InstructionList& instruction_list,
-      HloRematerialization::RematerializationMode mode);
+      HloRematerialization::RematerializationMode mode,
+      const std::optional<HloRematerialization::HostMemoryOffloadConfig>&
+          host_memory_offload_config);
 
   // Starts the placement of the given instruction. This adds the sizes of the
   // LogicalBuffers defined by the instruction to the current memory
@@ -557,6 +562,21 @@ class MemoryUsageTracker {
   Status AddCompressInstructions(Item* original_item, Item* compressed_item,
                                  Item* uncompressed_item);
 
+  // Returns the number of bytes that the current memory usage will be reduced
+  // if the given instruction is offloaded to host memory.
+  int64_t MemoryReducedIfOffloaded(Item* item) const;
+
+  // Adjusts memory usage to account for offloading original_item to host
+  // memory. The offload is performed by the copy-start/copy-done pair
+  // offload_start_item/offload_done_item, which are placed, and the remaining
+  // uses are served by the copy-start/copy-done pair
+  // reload_start_item/reload_done_item, which are not.
+  Status AddHostOffloadInstructions(Item* original_item,
+                                    Item* offload_start_item,
+                                    Item* offload_done_item,
+                                    Item* reload_start_item,
+                                    Item* reload_done_item);
+
   // Adjusts memory usage to account for the rematerialization of
   // original_item for all remaining unplaced uses. The rematerialization
   // is remat_item. This method should be called after the HLO graph has
@@ -609,6 +629,11 @@ class MemoryUsageTracker {
 
   const HloComputation* computation() const { return computation_; }
 
+  const std::optional<HloRematerialization::HostMemoryOffloadConfig>&
+  host_memory_offload_config() const {
+    return host_memory_offload_config_;
+  }
+
   // Check invariants of the data structure. This is expensive to call.
   bool Check() const;
 
@@ -789,6 +814,11 @@ class MemoryUsageTracker {
   Item* in_progress_item_ = nullptr;
 
   HloRematerialization::RematerializationMode mode_;
+
+  // If set, buffers can be offloaded to host memory.
+  std::optional<HloRematerialization::HostMemoryOffloadConfig>
+      host_memory_offload_config_;
+
   // All buffers in the computation.
   std::vector<Buffer> buffers_;
 };
@@ -799,12 +829,15 @@ MemoryUsageTracker::MemoryUsageTracker(
     const HloRematerialization::CompactShapeFunction& compact_shape_function,
     const TuplePointsToAnalysis& points_to_analysis,
     const InstructionList& instruction_list,
-    HloRematerialization::RematerializationMode mode)
+    HloRematerialization::RematerializationMode mode,
+    const std::optional<HloRematerialization::HostMemoryOffloadConfig>&
+        host_memory_offload_config)
     : computation_(computation),
       instruction_list_(instruction_list),
       size_function_(size_function),
       compact_shape_function_(compact_shape_function),
-      mode_(mode) {
+      mode_(mode),
+      host_memory_offload_config_(host_memory_offload_config) {
   PointsToSet::BufferSet live_out_set =
       points_to_analysis.GetPointsToSet(computation_->root_instruction())
           .CreateFlattenedSet();
@@ -965,6 +998,25 @@ int64_t MemoryUsageTracker::MemoryReducedIfCompressed(
   return memory_reduced;
 }
 
+int64_t MemoryUsageTracker::MemoryReducedIfOffloaded(Item* item) const {
+  CHECK_NE(in_progress_item_, nullptr);
+  if (!item->placed || item == in_progress_item_) {
+    return 0;
+  }
+
+  // We only offload a single piece of an output at one time.
+  CHECK_EQ(item->buffers_output.size(), 1);
+  BufferId buffer_id = item->buffers_output[0];
+  const Buffer& buffer = buffers_.at(buffer_id);
+  if (buffer.has_indirect_uses || !IsCurrentlyLive(buffer_id) ||
+      IsInUse(buffer_id) || !IsInstructionCurrentlyLive(item)) {
+    return 0;
+  }
+  // The offloaded buffer lives in host memory until it is reloaded, so the
+  // whole device buffer is freed.
+  return AllocatedSize(buffer_id);
+}
+
 int64_t MemoryUsageTracker::MemoryReducedIfRematerialized(
     absl::Span<const Item* const> items) const {
   CHECK_NE(in_progress_item_, nullptr);
@@ -1078,6 +1130,61 @@ Status MemoryUsageTracker::AddCompressInstructions(Item* original_item,
   return OkStatus();
 }
 
+Status MemoryUsageTracker::AddHostOffloadInstructions(
+    Item* original_item, Item* offload_start_item, Item* offload_done_item,
+    Item* reload_start_item, Item* reload_done_item) {
+  CHECK_EQ(original_item->buffers_output.size(), 1);
+  BufferId original_buffer_id = original_item->buffers_output[0];
+  // Original buffer is now dead, and the host buffer takes no device memory.
+  memory_usage_ -= AllocatedSize(original_buffer_id);
+
+  UsesList placed_users;
+  UsesList unplaced_users;
+  Buffer& original_buffer = buffers_.at(original_buffer_id);
+  for (ItemUse& user : original_buffer.users) {
+    if (user.user->placed) {
+      CHECK(IsFinished(user.user)) << user.user->instruction->name();
+      placed_users.push_back(user);
+    } else {
+      unplaced_users.push_back(user);
+    }
+  }
+  original_buffer.users = std::move(placed_users);
+  original_buffer.unfinished_user_count = 0;
+  original_buffer.users.push_back(ItemUse{offload_start_item, 0, std::nullopt});
+  offload_start_item->buffers_used = {original_buffer_id};
+  // We are reallocating the vector containing the buffers potentially,
+  // invalidating the original_buffer reference, so copy the index that we need
+  // across NewBuffer calls.
+  ShapeIndex copied_index = original_buffer.index;
+
+  // The copy-start instructions are not modeled as defining buffers; the
+  // buffers are attributed to the copy-done instructions instead.
+  Buffer& host_buffer =
+      NewBuffer(offload_done_item, offload_done_item->instruction->shape(),
+                copied_index, {ItemUse{reload_start_item, 0, std::nullopt}},
+                /*live_out=*/false,
+                /*has_indirect_uses=*/false);
+  offload_done_item->buffers_output = {host_buffer.id};
+  offload_done_item->buffers_defined = {host_buffer.id};
+  reload_start_item->buffers_used = {host_buffer.id};
+
+  Buffer& reloaded_buffer =
+      NewBuffer(reload_done_item, reload_done_item->instruction->shape(),
+                copied_index, std::move(unplaced_users), /*live_out=*/false,
+                /*has_indirect_uses=*/false);
+  reload_done_item->buffers_output = {reloaded_buffer.id};
+  reload_done_item->buffers_defined = {reloaded_buffer.id};
+
+  for (ItemUse& user : reloaded_buffer.users) {
+    BufferIdList& buffers_used = user.user->buffers_used;
+    std::replace(buffers_used.begin(), buffers_used.end(), original_buffer_id,
+                 reloaded_buffer.id);
+  }
+
+  return OkStatus();
+}
+
 Status MemoryUsageTracker::AddRematerializedInstruction(
     Item* original_item, Item* remat_item, absl::Span<Item*> indirect_users) {
   VLOG(3) << "AddRematerializedInstruction: original_instruction = "
@@ -1462,6 +1569,30 @@ MemoryUsageTracker::PickRematerializationCandidates(
             }
           }
         }
+        if (item->buffers_output.size() == 1 &&
+            host_memory_offload_config_.has_value()) {
+          const Buffer& output_buffer = buffers_.at(item->buffers_output[0]);
+          const Shape& original_shape = item->instruction->shape();
+          if (item->placed && item != in_progress_item_ &&
+              !output_buffer.live_out && original_shape.IsArray() &&
+              original_shape.has_layout() &&
+              original_shape.layout().memory_space() !=
+                  host_memory_offload_config_->host_memory_space) {
+            const int64_t memory_reduced = MemoryReducedIfOffloaded(item);
+            effort++;
+            if (memory_reduced > 0) {
+              const int64_t cost = memory_limit_bytes / memory_reduced;
+              if (best_items.empty() || cost < best_cost) {
+                VLOG(3) << "candidate " << candidate->name() << "("
+                        << candidate->ToShortString() << ")"
+                        << " now best when offloaded to host memory";
+                best_strategy.kind = RematStrategy::kHostOffload;
+                best_items = block;
+                best_cost = cost;
+              }
+            }
+          }
+        }
       }
       // Do not consider recomputation in compress-only mode.
       if (mode_ == HloRematerialization::RematerializationMode::kCompressOnly) {
@@ -1792,6 +1923,97 @@ StatusOr<int64_t> CompressInstruction(MemoryUsageTracker* memory_tracker,
   return 2;
 }
 
+// Offloads the output of best_item to host memory right after its last placed
+// use, and copies it back right before its earliest unplaced use. Both copies
+// are asynchronous so that they can be overlapped with compute by a latency
+// hiding scheduler.
+StatusOr<int64_t> OffloadInstructionToHost(MemoryUsageTracker* memory_tracker,
+                                           Item* best_item,
+                                           int64_t host_memory_space,
+                                           InstructionList* instruction_list) {
+  HloInstruction* best = best_item->instruction;
+  VLOG(5) << "Offloading instruction " << best->name() << " (saving "
+          << HumanReadableNumBytes(
+                 memory_tracker->MemoryReducedIfOffloaded(best_item))
+          << ") to host memory";
+
+  HloComputation* computation = best->parent();
+  Shape host_shape = best->shape();
+  host_shape.mutable_layout()->set_memory_space(host_memory_space);
+  const Shape context_shape = ShapeUtil::MakeShape(U32, {});
+
+  HloInstruction* offload_start = computation->AddInstruction(
+      HloInstruction::CreateCopyStart(
+          ShapeUtil::MakeTupleShape({host_shape, best->shape(), context_shape}),
+          best),
+      /*new_name=*/absl::StrCat(best->name(), ".remat_offload_start"));
+  HloInstruction* offload_done = computation->AddInstruction(
+      HloInstruction::CreateUnary(host_shape, HloOpcode::kCopyDone,
+                                  offload_start),
+      /*new_name=*/absl::StrCat(best->name(), ".remat_offload"));
+
+  HloInstruction* reload_start = computation->AddInstruction(
+      HloInstruction::CreateCopyStart(
+          ShapeUtil::MakeTupleShape({best->shape(), host_shape, context_shape}),
+          offload_done),
+      /*new_name=*/absl::StrCat(best->name(), ".remat_reload_start"));
+  HloInstruction* reload_done = computation->AddInstruction(
+      HloInstruction::CreateUnary(best->shape(), HloOpcode::kCopyDone,
+                                  reload_start),
+      /*new_name=*/absl::StrCat(best->name(), ".remat_reload"));
+
+  Item* offload_start_item = instruction_list->CreateItem(offload_start);
+  offload_start_item->placed = true;
+  Item* offload_done_item = instruction_list->CreateItem(offload_done);
+  offload_done_item->placed = true;
+  Item* reload_start_item = instruction_list->CreateItem(reload_start);
+  Item* reload_done_item = instruction_list->CreateItem(reload_done);
+
+  // Replace each remaining use of 'best' with the reloaded value, and collect
+  // the placed uses after which the offload can start.
+  ItemList place_after = {best_item};
+  std::vector<HloInstruction*> best_users_copy = best->users();
+  for (HloInstruction* user : best_users_copy) {
+    if (user == offload_start) {
+      continue;
+    }
+    if (memory_tracker->IsPlaced(user)) {
+      place_after.push_back(instruction_list->GetItem(user));
+    } else {
+      VLOG(5) << "  Replacing use of " << best->name() << " in " << user->name()
+              << " with " << reload_done->name();
+      TF_RETURN_IF_ERROR(best->ReplaceUseWith(user, reload_done));
+    }
+  }
+
+  // Account for the offload in the memory tracker.
+  TF_RETURN_IF_ERROR(memory_tracker->AddHostOffloadInstructions(
+      best_item, offload_start_item, offload_done_item, reload_start_item,
+      reload_done_item));
+
+  // Insert the reload right before the earliest unplaced use of the
+  // instruction.
+  ItemList place_before;
+  for (auto user : reload_done->users()) {
+    place_before.push_back(instruction_list->GetItem(user));
+  }
+
+  instruction_list->Denylist(offload_start);
+  instruction_list->Denylist(offload_done);
+  instruction_list->Denylist(reload_start);
+  instruction_list->Denylist(reload_done);
+
+  instruction_list->InsertBeforeInstructions(reload_done_item, place_before);
+  instruction_list->InsertBeforeInstructions(reload_start_item,
+                                             {reload_done_item});
+
+  instruction_list->InsertAfterInstructions(offload_start_item, place_after);
+  instruction_list->InsertAfterInstructions(offload_done_item,
+                                            {offload_start_item});
+
+  return 4;
+}
+
 // A simple struct to encapsulate the number of instructions added during
 // rematerialization.
 struct InstructionsAdded {
@@ -1846,6 +2068,21 @@ StatusOr<InstructionsAdded> RematerializeBestBlock(
         num_instructions_added.net_instructions_added,
         CompressInstruction(memory_tracker, best_items[0],
                             best_strategy.compact_shape, instruction_list));
+  } else if (best_strategy.kind == RematStrategy::kHostOffload) {
+    CHECK(best_items.size() == 1)
+        << "More than one instruction offloaded simultaneously.";
+    HloInstruction* best = best_items[0]->instruction;
+    VLOG(1) << "Offloading instruction " << best->name() << " (saving "
+            << HumanReadableNumBytes(
+                   memory_tracker->MemoryReducedIfOffloaded(best_items[0]))
+            << ")";
+
+    TF_ASSIGN_OR_RETURN(
+        num_instructions_added.net_instructions_added,
+        OffloadInstructionToHost(
+            memory_tracker, best_items[0],
+            memory_tracker->host_memory_offload_config()->host_memory_space,
+            instruction_list));
   } else {
     TF_ASSIGN_OR_RETURN(
         num_instructions_added.net_instructions_added,
@@ -1863,7 +2100,8 @@ StatusOr<int64_t> HloRematerialization::ComputePeakMemory(
   InstructionList instruction_list(order);
   MemoryUsageTracker tracker(computation, size_function_,
                              compact_shape_function_, *points_to_analysis_,
-                             instruction_list, mode_);
+                             instruction_list, mode_,
+                             host_memory_offload_config_);
   int64_t peak_memory = tracker.memory_usage();
   for (auto* item = instruction_list.first(); item != nullptr;
        item = instruction_list.next(item)) {
@@ -1901,6 +2139,24 @@ StatusOr<int64_t> HloRematerialization::CalledComputationsMemoryUsage(
   return callee_usage;
 }
 
+/*static*/ HloRematerialization::ShapeSizeFunction
+HloRematerialization::DeviceMemorySizeFunction(
+    const ShapeSizeFunction& size_function,
+    const std::optional<HostMemoryOffloadConfig>& host_memory_offload_config) {
+  if (!host_memory_offload_config.has_value()) {
+    return size_function;
+  }
+  const int64_t host_memory_space =
+      host_memory_offload_config->host_memory_space;
+  return [size_function, host_memory_space](const Shape& shape) -> int64_t {
+    if (shape.IsArray() && shape.has_layout() &&
+        shape.layout().memory_space() == host_memory_space) {
+      return 0;
+    }
+    return size_function(shape);
+  };
+}
+
 bool HloRematerialization::IsExecutionThreadIncluded(
     const absl::flat_hash_set<absl::string_view>& execution_threads,
     absl::string_view thread) const {
@@ -1929,7 +2185,8 @@ StatusOr<bool> HloRematerialization::RematerializeComputation(
   InstructionList instruction_list(schedule->sequence(computation));
   MemoryUsageTracker memory_tracker(
       computation, size_function_, compact_shape_function_,
-      *points_to_analysis_, instruction_list, mode_);
+      *points_to_analysis_, instruction_list, mode_,
+      host_memory_offload_config_);
 
   instruction_list.PromoteNodesToSkip([&](Item* item) {
     return memory_tracker.AllocatedSize(item) >= min_remat_size;
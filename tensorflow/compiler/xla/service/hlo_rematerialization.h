@@ -15,6 +15,8 @@
 #ifndef TENSORFLOW_COMPILER_XLA_SERVICE_HLO_REMATERIALIZATION_H_
 #define TENSORFLOW_COMPILER_XLA_SERVICE_HLO_REMATERIALIZATION_H_
 
+#include <optional>
+
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/strings/string_view.h"
@@ -64,6 +66,20 @@ class HloRematerialization : public HloModulePass {
     kPostFusion  // Rematerialization pass after multi-output fusion.
   };
 
+  // Configuration of offloading buffers to host memory, which is considered in
+  // addition to the strategies of the rematerialization mode when set.
+  //
+  // An offloaded buffer is copied to host memory right after its last use
+  // before the program point where memory is exceeded, and copied back right
+  // before its next use. Both copies are asynchronous (copy-start/copy-done, as
+  // emitted by memory space assignment), so that a latency hiding scheduler
+  // run afterwards can overlap them with compute.
+  struct HostMemoryOffloadConfig {
+    // Memory space of host memory in shape layouts. Buffers in this memory
+    // space do not count towards the memory limit.
+    int64_t host_memory_space;
+  };
+
   static Shape DefaultCompactShapeFunction(const Shape& shape) { return shape; }
 
   // Constructor parameters:
@@ -81,14 +97,20 @@ class HloRematerialization : public HloModulePass {
   //
   //   compact_shape_function: Function which returns the compact form of a
   //   shape. If nullptr is provided, an default identity function is used.
+  //
+  //   host_memory_offload_config: If set, buffers can also be offloaded to
+  //   host memory instead of being rematerialized.
   explicit HloRematerialization(
       const ShapeSizeFunction& size_function, int64_t memory_limit_bytes,
       RematerializationSizes* sizes, RematerializationPass pass_location,
       int block_size_limit, int block_rematerialization_factor,
       CompactShapeFunction compact_shape_function = nullptr,
       RematerializationMode mode = RematerializationMode::kRecomputeAndCompress,
-      int64_t min_remat_size = 0)
-      : size_function_(size_function),
+      int64_t min_remat_size = 0,
+      std::optional<HostMemoryOffloadConfig> host_memory_offload_config =
+          std::nullopt)
+      : size_function_(DeviceMemorySizeFunction(size_function,
+                                                host_memory_offload_config)),
         memory_limit_bytes_(memory_limit_bytes),
         sizes_(sizes),
         pass_location_(pass_location),
@@ -98,7 +120,8 @@ class HloRematerialization : public HloModulePass {
                                     ? DefaultCompactShapeFunction
                                     : std::move(compact_shape_function)),
         mode_(mode),
-        min_remat_size_(min_remat_size) {}
+        min_remat_size_(min_remat_size),
+        host_memory_offload_config_(host_memory_offload_config) {}
   ~HloRematerialization() override = default;
 
   absl::string_view name() const override { return "rematerialization"; }
@@ -154,6 +177,12 @@ class HloRematerialization : public HloModulePass {
       const HloInstruction* instruction,
       const absl::flat_hash_set<absl::string_view>& execution_threads) const;
 
+  // Returns a size function which returns zero for buffers in host memory, as
+  // they do not count towards the memory limit.
+  static ShapeSizeFunction DeviceMemorySizeFunction(
+      const ShapeSizeFunction& size_function,
+      const std::optional<HostMemoryOffloadConfig>& host_memory_offload_config);
+
   // Returns true if `thread` is considered included within given
   // `execution_threads`.
   bool IsExecutionThreadIncluded(
@@ -225,6 +254,8 @@ class HloRematerialization : public HloModulePass {
 
   int64_t min_remat_size_;
 
+  std::optional<HostMemoryOffloadConfig> host_memory_offload_config_;
+
   // Tracking available channel id numbers to use to apply to rematerialized
   // channel instructions
   int64_t next_channel_id_;
@@ -1273,6 +1273,82 @@ ENTRY %entry {
       (*it2)->called_computations()[0]));
 }
 
+class HostOffloadRematerializationTest
+    : public CompressingRematerializationTest {
+ protected:
+  static constexpr int64_t kHostMemorySpace = 5;
+
+  StatusOr<bool> RunHloRematerialization(int64_t memory_limit_bytes,
+                                         HloModule* module) {
+    TF_EXPECT_OK(verifier().Run(module).status());
+    // Compression into the identity shape never saves memory, so offloading
+    // is the only strategy left.
+    HloRematerialization remat(
+        ShapeSizePadMinorTo64, memory_limit_bytes,
+        /*sizes=*/nullptr,
+        HloRematerialization::RematerializationPass::kPreFusion,
+        /*block_size_limit=*/1, /*block_rematerialization_factor=*/1,
+        /*compact_shape_function=*/nullptr,
+        HloRematerialization::RematerializationMode::kCompressOnly,
+        /*min_remat_size=*/0,
+        HloRematerialization::HostMemoryOffloadConfig{kHostMemorySpace});
+    return remat.Run(module);
+  }
+};
+
+TEST_F(HostOffloadRematerializationTest, SingleOffload) {
+  const std::string& hlo_string = R"(
+HloModule fusion, is_scheduled=true
+
+%add_float {
+  %x = f32[] parameter(0)
+  %y = f32[] parameter(1)
+  ROOT %add = f32[] add(f32[] %x, f32[] %y)
+}
+
+ENTRY %entry {
+  %param.0 = f32[] parameter(0)
+  %constant = f32[] constant(0)
+  %broadcast.0 = f32[64,2]{1,0} broadcast(f32[] %param.0), dimensions={}
+  %negate = f32[64,2]{1,0} negate(f32[64,2]{1,0} broadcast.0)
+  %reduce.0 = f32[] reduce(f32[64,2]{1,0} %negate, f32[] %constant), dimensions={1, 0}, to_apply=%add_float
+  %reduce.1 = f32[] reduce(f32[64,2]{1,0} %broadcast.0, f32[] %constant), dimensions={1, 0}, to_apply=%add_float
+  %add = f32[] add(f32[] %reduce.0, f32[] %reduce.1)
+}
+)";
+
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(hlo_string));
+
+  TF_ASSERT_OK_AND_ASSIGN(bool changed,
+                          RunHloRematerialization(
+                              /*memory_limit_bytes=*/30 * 1024, module.get()));
+  EXPECT_TRUE(changed);
+  HloInstruction* broadcast =
+      module->entry_computation()->GetInstructionWithName("broadcast.0");
+  HloInstruction* reduce =
+      module->entry_computation()->GetInstructionWithName("reduce.1");
+  EXPECT_THAT(reduce,
+              op::Reduce(op::CopyDone(op::CopyStart(
+                             op::CopyDone(op::CopyStart(broadcast)))),
+                         op::Constant()));
+  const HloInstruction* offloaded = reduce->operand(0)->operand(0)->operand(0);
+  EXPECT_EQ(offloaded->shape().layout().memory_space(), kHostMemorySpace);
+
+  // The offload starts after the last use before the reload, which in turn
+  // happens right before the next use.
+  const std::vector<HloInstruction*>& sequence =
+      module->schedule().sequence(module->entry_computation()).instructions();
+  auto position = [&](const HloInstruction* instruction) {
+    return std::find(sequence.begin(), sequence.end(), instruction) -
+           sequence.begin();
+  };
+  HloInstruction* negate =
+      module->entry_computation()->GetInstructionWithName("negate");
+  EXPECT_LT(position(negate), position(offloaded->operand(0)));
+  EXPECT_EQ(position(reduce->operand(0)) + 1, position(reduce));
+}
+
 }  // namespace
 
 }  // namespace xla
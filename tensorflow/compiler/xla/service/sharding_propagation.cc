@@ -2691,9 +2691,22 @@ StatusOr<bool> ShardingPropagation::Run(
   int64_t iterations = 0;
 
   std::unique_ptr<CallGraph> call_graph = CallGraph::Build(module);
+  absl::flat_hash_set<const HloComputation*> computations_with_unspecified_dims;
+  for (const auto& [instruction, dims] : unspecified_dims) {
+    computations_with_unspecified_dims.insert(instruction->parent());
+  }
   auto run_to_fix_point = [&](int64_t aggressiveness) {
     absl::flat_hash_set<const HloInstruction*> already_inferred_from_operands;
     absl::flat_hash_set<const HloInstruction*> already_inferred_from_users;
+    // Computations with instructions that are not in the caches above. The
+    // others would be skipped instruction by instruction, so they are not
+    // visited at all, which avoids recomputing their post order when only a
+    // few computations of a large module changed.
+    absl::flat_hash_set<const HloComputation*> computations_to_visit;
+    for (const HloComputation* computation :
+         module->computations(execution_threads)) {
+      computations_to_visit.insert(computation);
+    }
     bool changed_last_iter = true;
     const bool may_merge_partial = is_spmd_ && aggressiveness > 0;
     while (changed_last_iter) {
@@ -2702,8 +2715,19 @@ StatusOr<bool> ShardingPropagation::Run(
       int64_t inferred_from_user_counter = 0;
       int64_t instruction_counter = 0;
       int64_t already_sharded_counter = 0;
+      int64_t computation_counter = 0;
       for (const HloComputation* computation :
            module->computations(execution_threads)) {
+        if (!computations_to_visit.erase(computation)) {
+          continue;
+        }
+        // Provided shardings with unspecified dimensions are not cached, as
+        // they are refined again in every iteration.
+        if (may_merge_partial &&
+            computations_with_unspecified_dims.contains(computation)) {
+          computations_to_visit.insert(computation);
+        }
+        ++computation_counter;
         VLOG(2) << "Consider computation: " << computation->name();
         std::vector<HloInstruction*> instructions =
             computation->MakeInstructionPostOrder();
@@ -2716,12 +2740,14 @@ StatusOr<bool> ShardingPropagation::Run(
                                HloInstruction* hlo_for_users = nullptr) {
           for (auto operand : hlo->operands()) {
             already_inferred_from_users.erase(operand);
+            computations_to_visit.insert(operand->parent());
           }
           if (hlo_for_users == nullptr) {
             hlo_for_users = hlo;
           }
           for (auto user : hlo_for_users->users()) {
             already_inferred_from_operands.erase(user);
+            computations_to_visit.insert(user->parent());
           }
         };
         // First iterate the HLO graph in post order taking shardings from
@@ -2819,7 +2845,8 @@ StatusOr<bool> ShardingPropagation::Run(
         }
       }
       VLOG(1) << "Sharding propagation iteration " << iterations << ";"
-              << "\n  total instructions: " << instruction_counter
+              << "\n  computations visited: " << computation_counter
+              << "\n  instructions visited: " << instruction_counter
               << "\n  instructions already sharded: " << already_sharded_counter
               << "\n  shardings inferred from operands: "
               << inferred_from_operand_counter
@@ -4965,10 +4965,43 @@ HloInstruction* SpmdPartitioner::AllReduceAlongShardingDimsInternal(
 StatusOr<bool> SpmdPartitioner::PartitionComputation(
     HloComputation* computation, const HloSharding& root_sharding,
     int64_t* next_channel_id, SpmdLogger* logger, const CallGraph& call_graph) {
+  // A computation called by a single instruction that is identical to one
+  // already partitioned, e.g. the loop body of a repeated layer, is replaced
+  // by the partitioned one. The computations shared this way are cloned again
+  // by the FlattenCallGraph at the end of the partitioning.
+  HloModule* module = computation->parent();
+  HloInstruction* caller = nullptr;
+  int64_t callee_index = 0;
+  std::string cache_key;
+  if (options_.cache_partitioned_computations &&
+      computation != module->entry_computation() &&
+      call_graph.GetComputationCallers(computation).size() == 1) {
+    caller = call_graph.GetComputationCallers(computation)[0];
+    callee_index = absl::c_find(caller->called_computations(), computation) -
+                   caller->called_computations().begin();
+    cache_key = absl::StrCat(
+        computation->ToString(HloPrintOptions::Canonical()
+                                  .set_print_ids(false)
+                                  .set_print_large_constants(true)),
+        "\nroot_sharding=", root_sharding.ToString());
+    auto it = partitioned_computations_.find(cache_key);
+    if (it != partitioned_computations_.end()) {
+      VLOG(2) << "Reusing partitioned computation " << it->second->name()
+              << " for " << computation->name();
+      module->ReplaceComputations({{computation, it->second}});
+      return true;
+    }
+  }
   auto visitor = CreateVisitor(computation, num_partitions_, num_replicas_,
                                collective_ops_creator_, next_channel_id, logger,
                                options_, call_graph);
-  return visitor->DoPartition(computation, root_sharding, options_);
+  TF_ASSIGN_OR_RETURN(bool changed, visitor->DoPartition(
+                                        computation, root_sharding, options_));
+  if (caller != nullptr) {
+    partitioned_computations_[cache_key] =
+        caller->called_computations()[callee_index];
+  }
+  return changed;
 }
 
 std::unique_ptr<SpmdPartitioningVisitor> SpmdPartitioner::CreateVisitor(
@@ -4984,6 +5017,7 @@ std::unique_ptr<SpmdPartitioningVisitor> SpmdPartitioner::CreateVisitor(
 StatusOr<bool> SpmdPartitioner::Run(
     HloModule* module,
     const absl::flat_hash_set<absl::string_view>& execution_threads) {
+  partitioned_computations_.clear();
   TF_RETURN_IF_ERROR(PreprocessSharding(module, execution_threads));
   TF_RETURN_IF_ERROR(PreprocessHlos(module, execution_threads));
 
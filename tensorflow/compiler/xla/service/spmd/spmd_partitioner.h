@@ -81,6 +81,11 @@ struct SpmdPartitionerOptions {
   // Whether to skip checking the numbers and shardings of windowed einsum's
   // users.
   bool skip_checking_windowed_einsum_users = false;
+
+  // Whether to reuse the partitioned computation of an identical computation
+  // with the same shardings, e.g. the loop bodies of repeated layers, instead
+  // of partitioning it again.
+  bool cache_partitioned_computations = true;
 };
 
 // Class to wrap the computation builder to capture information during SPMD
@@ -306,6 +311,11 @@ class SpmdPartitioner : public HloModulePass {
   SpmdPartitionerOptions options_;
   SPMDCollectiveOpsCreator collective_ops_creator_;
   std::vector<std::vector<int64_t>> device_groups_;
+
+  // The computations partitioned in the current run, keyed by the canonical
+  // text of the computation they were partitioned from, with its shardings,
+  // and by their root sharding.
+  absl::flat_hash_map<std::string, HloComputation*> partitioned_computations_;
 };
 
 // Class describes partition state of the data represented by an HLO created
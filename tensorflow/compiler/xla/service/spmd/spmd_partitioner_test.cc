@@ -4195,6 +4195,78 @@ ENTRY entry {
   EXPECT_THAT(root, AllOf(op::While(zero), op::Shape("s32[]")));
 }
 
+TEST_F(SpmdPartitioningTest, WhileWithIdenticalBodies) {
+  absl::string_view hlo_string = R"(
+HloModule module
+
+cond.1 {
+  p = (f32[8,4], s32[]) parameter(0)
+  i = s32[] get-tuple-element(p), index=1
+  limit = s32[] constant(5)
+  ROOT lt = pred[] compare(i, limit), direction=LT
+}
+
+body.1 {
+  p = (f32[8,4], s32[]) parameter(0)
+  x = f32[8,4] get-tuple-element(p), index=0
+  i = s32[] get-tuple-element(p), index=1
+  one = s32[] constant(1)
+  next_i = s32[] add(i, one)
+  transposed = f32[8,4] copy(x), sharding={devices=[1,2]0,1}
+  y = f32[8,4] copy(transposed), sharding={devices=[2,1]0,1}
+  ROOT tuple = (f32[8,4], s32[]) tuple(y, next_i)
+}
+
+cond.2 {
+  p = (f32[8,4], s32[]) parameter(0)
+  i = s32[] get-tuple-element(p), index=1
+  limit = s32[] constant(5)
+  ROOT lt = pred[] compare(i, limit), direction=LT
+}
+
+body.2 {
+  p = (f32[8,4], s32[]) parameter(0)
+  x = f32[8,4] get-tuple-element(p), index=0
+  i = s32[] get-tuple-element(p), index=1
+  one = s32[] constant(1)
+  next_i = s32[] add(i, one)
+  transposed = f32[8,4] copy(x), sharding={devices=[1,2]0,1}
+  y = f32[8,4] copy(transposed), sharding={devices=[2,1]0,1}
+  ROOT tuple = (f32[8,4], s32[]) tuple(y, next_i)
+}
+
+ENTRY entry {
+  x = f32[8,4] parameter(0), sharding={devices=[2,1]0,1}
+  zero = s32[] constant(0), sharding={replicated}
+  init = (f32[8,4], s32[]) tuple(x, zero),
+    sharding={{devices=[2,1]0,1}, {replicated}}
+  while.1 = (f32[8,4], s32[]) while(init), body=body.1, condition=cond.1,
+    sharding={{devices=[2,1]0,1}, {replicated}}
+  ROOT while.2 = (f32[8,4], s32[]) while(while.1), body=body.2,
+    condition=cond.2, sharding={{devices=[2,1]0,1}, {replicated}}
+})";
+
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          PartitionComputation(hlo_string, /*num_devices=*/2));
+  VLOG(1) << module->ToString();
+
+  const HloInstruction* root = module->entry_computation()->root_instruction();
+  EXPECT_THAT(root, op::While(op::While(op::Tuple(
+                        AllOf(op::Parameter(0), op::Shape("f32[4,4]")), _))));
+  // The second loop reuses the partitioned body of the first one, which is
+  // then cloned so that each loop has its own body.
+  const HloInstruction* first_loop = root->operand(0);
+  EXPECT_NE(root->while_body(), first_loop->while_body());
+  for (const HloInstruction* loop : {first_loop, root}) {
+    EXPECT_THAT(loop->while_body()->root_instruction(),
+                op::Tuple(AllOf(op::Copy(), op::Shape("f32[4,4]")), _));
+    EXPECT_TRUE(absl::c_any_of(loop->while_body()->instructions(),
+                               [](const HloInstruction* hlo) {
+                                 return hlo->opcode() == HloOpcode::kAllToAll;
+                               }));
+  }
+}
+
 TEST_F(SpmdPartitioningTest, SelectAndScatter_RetinaNet) {
   absl::string_view hlo_string = R"(
 HloModule module
@@ -131,6 +131,16 @@ Status TransferManager::TransferArrayToDeviceAsync(
                                       transfer_metadata);
 }
 
+Status TransferManager::TransferBorrowedLiteralToInfeed(
+    se::StreamExecutor* executor, const LiteralSlice& literal,
+    std::function<void()> on_done_with_literal) {
+  Status status = TransferLiteralToInfeed(executor, literal);
+  if (on_done_with_literal) {
+    on_done_with_literal();
+  }
+  return status;
+}
+
 Status TransferManager::ReadDynamicShapes(se::Stream* stream,
                                           const ShapedBuffer* device_buffer,
                                           Shape* device_shape) {
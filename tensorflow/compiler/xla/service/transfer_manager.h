@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_XLA_SERVICE_TRANSFER_MANAGER_H_
 #define TENSORFLOW_COMPILER_XLA_SERVICE_TRANSFER_MANAGER_H_
 
+#include <functional>
 #include <map>
 #include <set>
 #include <vector>
@@ -185,6 +186,15 @@ class TransferManager {
   virtual Status TransferLiteralToInfeed(se::StreamExecutor* executor,
                                          const LiteralSlice& literal) = 0;
 
+  // Like TransferLiteralToInfeed, but lets the backend read from the memory of
+  // `literal` directly instead of copying it first, so that large host arrays
+  // can be fed without materializing another Literal. The memory must stay
+  // valid until `on_done_with_literal` is called. The default implementation
+  // copies the literal and calls `on_done_with_literal` before returning.
+  virtual Status TransferBorrowedLiteralToInfeed(
+      se::StreamExecutor* executor, const LiteralSlice& literal,
+      std::function<void()> on_done_with_literal);
+
   // Transfers the given literal from the Outfeed interface of the device,
   // using the given executor. The shape and layout are determined by the
   // shape and layout of `literal`.
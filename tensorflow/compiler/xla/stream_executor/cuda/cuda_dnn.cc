@@ -4686,6 +4686,389 @@ GetCudnnFusedMHAOperationGraph(
           << "\nOpGraph: " << op_graph.describe();
   return std::make_unique<cudnn_frontend::OperationGraph>(std::move(op_graph));
 }
+
+// Returns `dims` (or strides) with the two minor-most entries swapped, i.e. the
+// shape of the transpose of a batched matrix.
+std::vector<int64_t> TransposeLastTwo(absl::Span<const int64_t> dims) {
+  std::vector<int64_t> transposed(dims.begin(), dims.end());
+  std::swap(transposed[transposed.size() - 1],
+            transposed[transposed.size() - 2]);
+  return transposed;
+}
+
+// Returns the row-wise reduction of `dims` (or strides), whose minor-most
+// dimension is reduced to 1.
+std::vector<int64_t> ReduceLast(absl::Span<const int64_t> dims,
+                                bool is_stride) {
+  std::vector<int64_t> reduced(dims.begin(), dims.end());
+  if (is_stride) {
+    for (int64_t& stride : reduced) stride /= dims.back();
+  }
+  reduced.back() = 1;
+  return reduced;
+}
+
+// Returns a cudnn tensor that's the output of the pointwise op `mode` applied
+// to `x` (and `b` for binary ops), scaled by `alpha`.
+tsl::StatusOr<cudnn_frontend::Tensor> CreateCudnnPointwiseTensor(
+    std::vector<cudnn_frontend::Operation>& ops, absl::Span<const int64_t> dims,
+    absl::Span<const int64_t> strides, int64_t uid, dnn::DataType dtype,
+    cudnnPointwiseMode_t mode, const cudnn_frontend::Tensor& x,
+    const cudnn_frontend::Tensor* b = nullptr, double alpha = 1.0,
+    bool is_virtual = true) {
+  TF_ASSIGN_OR_RETURN(auto output_tensor,
+                      CreateCudnnTensor(dims, strides, uid, dtype, 1, -1,
+                                        /*is_virtual=*/is_virtual));
+  auto pw_desc = cudnn_frontend::PointWiseDescBuilder()
+                     .setMode(mode)
+                     .setComputeType(CUDNN_DATA_FLOAT)
+                     .build();
+  RETURN_MSG_IF_CUDNN_ERROR(pw_desc);
+  auto builder = cudnn_frontend::OperationBuilder(
+      CUDNN_BACKEND_OPERATION_POINTWISE_DESCRIPTOR);
+  builder.setxDesc(x).setyDesc(output_tensor).setpwDesc(pw_desc).setAlpha(
+      alpha);
+  if (b != nullptr) builder.setbDesc(*b);
+  auto pw_op = builder.build();
+  RETURN_MSG_IF_CUDNN_ERROR(pw_op);
+  ops.push_back(std::move(pw_op));
+  return output_tensor;
+}
+
+// Returns a cudnn tensor that's the row-wise reduction `mode` of `x`.
+tsl::StatusOr<cudnn_frontend::Tensor> CreateCudnnRowReductionTensor(
+    std::vector<cudnn_frontend::Operation>& ops, absl::Span<const int64_t> dims,
+    absl::Span<const int64_t> strides, int64_t uid,
+    cudnnReduceTensorOp_t mode, const cudnn_frontend::Tensor& x) {
+  TF_ASSIGN_OR_RETURN(
+      auto output_tensor,
+      CreateCudnnTensor(ReduceLast(dims, false), ReduceLast(strides, true),
+                        uid, dnn::DataType::kFloat, 1, -1,
+                        /*is_virtual=*/true));
+  auto reduction_desc = cudnn_frontend::ReductionDescBuilder()
+                            .setComputeType(CUDNN_DATA_FLOAT)
+                            .setReductionOp(mode)
+                            .build();
+  RETURN_MSG_IF_CUDNN_ERROR(reduction_desc);
+  auto reduction_op = cudnn_frontend::OperationBuilder(
+                          CUDNN_BACKEND_OPERATION_REDUCTION_DESCRIPTOR)
+                          .setxDesc(x)
+                          .setyDesc(output_tensor)
+                          .setreductionDesc(reduction_desc)
+                          .build();
+  RETURN_MSG_IF_CUDNN_ERROR(reduction_op);
+  ops.push_back(std::move(reduction_op));
+  return output_tensor;
+}
+
+// Returns a cudnn tensor that's the batched matmul of `a` and `b`.
+tsl::StatusOr<cudnn_frontend::Tensor> CreateCudnnMatmulTensor(
+    std::vector<cudnn_frontend::Operation>& ops, absl::Span<const int64_t> dims,
+    absl::Span<const int64_t> strides, int64_t uid, dnn::DataType dtype,
+    const cudnn_frontend::Tensor& a, const cudnn_frontend::Tensor& b,
+    bool is_virtual = true) {
+  TF_ASSIGN_OR_RETURN(auto output_tensor,
+                      CreateCudnnTensor(dims, strides, uid, dtype, 1, -1,
+                                        /*is_virtual=*/is_virtual));
+  auto matmul_desc = cudnn_frontend::MatMulDescBuilder()
+                         .setComputeType(CUDNN_DATA_FLOAT)
+                         .build();
+  RETURN_MSG_IF_CUDNN_ERROR(matmul_desc);
+  auto matmul_op = cudnn_frontend::OperationBuilder(
+                       CUDNN_BACKEND_OPERATION_MATMUL_DESCRIPTOR)
+                       .setaMatDesc(a)
+                       .setbMatDesc(b)
+                       .setcMatDesc(output_tensor)
+                       .setmatmulDesc(matmul_desc)
+                       .build();
+  RETURN_MSG_IF_CUDNN_ERROR(matmul_op);
+  ops.push_back(std::move(matmul_op));
+  return output_tensor;
+}
+
+// Returns a virtual cudnn tensor that's the transpose of the batched matrix
+// `x` with dimensions `dims` and strides `strides`.
+tsl::StatusOr<cudnn_frontend::Tensor> CreateCudnnTransposeTensor(
+    std::vector<cudnn_frontend::Operation>& ops, absl::Span<const int64_t> dims,
+    absl::Span<const int64_t> strides, int64_t uid, dnn::DataType dtype,
+    const cudnn_frontend::Tensor& x) {
+  TF_ASSIGN_OR_RETURN(
+      auto output_tensor,
+      CreateCudnnTensor(TransposeLastTwo(dims), TransposeLastTwo(strides), uid,
+                        dtype, 1, -1, /*is_virtual=*/true));
+  auto reshape_op = cudnn_frontend::OperationBuilder(
+                        CUDNN_BACKEND_OPERATION_RESHAPE_DESCRIPTOR)
+                        .setxDesc(x)
+                        .setyDesc(output_tensor)
+                        .build();
+  RETURN_MSG_IF_CUDNN_ERROR(reshape_op);
+  ops.push_back(std::move(reshape_op));
+  return output_tensor;
+}
+
+// Returns the scaled BMM1 output, scale * q @ k, of the flash attention
+// graphs.
+tsl::StatusOr<cudnn_frontend::Tensor> CreateCudnnFlashScaledBmm1Tensor(
+    std::vector<cudnn_frontend::Operation>& ops,
+    const cudnn_frontend::Tensor& tensor_q,
+    const cudnn_frontend::Tensor& tensor_k,
+    absl::Span<const int64_t> s_dims, absl::Span<const int64_t> s_strides,
+    double scale) {
+  TF_ASSIGN_OR_RETURN(
+      auto tensor_s,
+      CreateCudnnMatmulTensor(ops, s_dims, s_strides, 's',
+                              dnn::DataType::kFloat, tensor_q, tensor_k));
+  return CreateCudnnPointwiseTensor(ops, s_dims, s_strides, 'c',
+                                    dnn::DataType::kFloat,
+                                    CUDNN_POINTWISE_IDENTITY, tensor_s,
+                                    /*b=*/nullptr, /*alpha=*/scale);
+}
+
+tsl::StatusOr<std::unique_ptr<cudnn_frontend::OperationGraph>>
+BuildCudnnOperationGraph(std::vector<cudnn_frontend::Operation>& ops,
+                         CudnnHandle& cudnn) {
+  std::vector<cudnn_frontend::Operation const*> op_ptrs;
+  op_ptrs.reserve(ops.size());
+  for (auto& op : ops) {
+    op_ptrs.push_back(&op);
+  }
+  auto op_graph = cudnn_frontend::OperationGraphBuilder()
+                      .setHandle(cudnn.handle())
+                      .setOperationGraph(op_ptrs.size(), op_ptrs.data())
+                      .build();
+  RETURN_MSG_IF_CUDNN_ERROR(op_graph);
+  VLOG(4) << "\nOpGraph: " << op_graph.describe();
+  return std::make_unique<cudnn_frontend::OperationGraph>(std::move(op_graph));
+}
+
+// Flash attention forward pass for training:
+//   P = softmax(scale * Q @ K), O = P @ V
+// Instead of P, it writes the row-wise softmax statistics
+//   L = max(scale * Q @ K) + log(sum(exp(scale * Q @ K - max)))
+// which are all the backward pass needs to recompute P.
+tsl::StatusOr<std::unique_ptr<cudnn_frontend::OperationGraph>>
+GetCudnnFlashMHAForwardOperationGraph(
+    const dnn::MatmulTensorDescriptor& bmm1_lhs_descriptor,
+    const dnn::MatmulTensorDescriptor& bmm1_rhs_descriptor,
+    const dnn::MatmulTensorDescriptor& bmm2_rhs_descriptor,
+    const dnn::MatmulTensorDescriptor& intermediate_bmm2_lhs_descriptor,
+    const dnn::TensorDescriptor& output_descriptor,
+    const dnn::TensorDescriptor& softmax_stats_descriptor, CudnnHandle& cudnn,
+    double scale) {
+  PreloadCudnnSubLibsHelper(dnn::ConvolutionKind::FORWARD);
+  std::vector<cudnn_frontend::Operation> ops;
+
+  std::vector<int64_t> s_dims =
+      intermediate_bmm2_lhs_descriptor.GetCudnnCompatibleDimensions(true);
+  std::vector<int64_t> s_strides =
+      intermediate_bmm2_lhs_descriptor.GetCudnnCompatibleStrides(true);
+
+  TF_ASSIGN_OR_RETURN(
+      auto tensor_q,
+      CreateCudnnTensor(bmm1_lhs_descriptor.GetCudnnCompatibleDimensions(true),
+                        bmm1_lhs_descriptor.GetCudnnCompatibleStrides(true),
+                        'q', bmm1_lhs_descriptor.type(), 1, -1));
+  TF_ASSIGN_OR_RETURN(
+      auto tensor_k,
+      CreateCudnnTensor(bmm1_rhs_descriptor.GetCudnnCompatibleDimensions(false),
+                        bmm1_rhs_descriptor.GetCudnnCompatibleStrides(false),
+                        'k', bmm1_rhs_descriptor.type(), 1, -1));
+  TF_ASSIGN_OR_RETURN(auto tensor_scaled,
+                      CreateCudnnFlashScaledBmm1Tensor(
+                          ops, tensor_q, tensor_k, s_dims, s_strides, scale));
+
+  std::vector<int64_t> stats_dims = softmax_stats_descriptor.dimensions();
+  std::vector<int64_t> stats_strides =
+      softmax_stats_descriptor.GetLogicalStrides();
+  TF_ASSIGN_OR_RETURN(
+      auto tensor_max,
+      CreateCudnnRowReductionTensor(ops, s_dims, s_strides, 'm',
+                                    CUDNN_REDUCE_TENSOR_MAX, tensor_scaled));
+  TF_ASSIGN_OR_RETURN(
+      auto tensor_sub,
+      CreateCudnnPointwiseTensor(ops, s_dims, s_strides, 'S',
+                                 dnn::DataType::kFloat, CUDNN_POINTWISE_SUB,
+                                 tensor_scaled, &tensor_max));
+  TF_ASSIGN_OR_RETURN(
+      auto tensor_exp,
+      CreateCudnnPointwiseTensor(ops, s_dims, s_strides, 'e',
+                                 dnn::DataType::kFloat, CUDNN_POINTWISE_EXP,
+                                 tensor_sub));
+  TF_ASSIGN_OR_RETURN(
+      auto tensor_sum,
+      CreateCudnnRowReductionTensor(ops, s_dims, s_strides, 'u',
+                                    CUDNN_REDUCE_TENSOR_ADD, tensor_exp));
+  TF_ASSIGN_OR_RETURN(
+      auto tensor_log,
+      CreateCudnnPointwiseTensor(ops, stats_dims, stats_strides, 'g',
+                                 dnn::DataType::kFloat, CUDNN_POINTWISE_LOG,
+                                 tensor_sum));
+  TF_ASSIGN_OR_RETURN(
+      auto tensor_stats,
+      CreateCudnnPointwiseTensor(
+          ops, stats_dims, stats_strides, 'L', softmax_stats_descriptor.type(),
+          CUDNN_POINTWISE_ADD, tensor_max, &tensor_log, /*alpha=*/1.0,
+          /*is_virtual=*/false));
+  TF_ASSIGN_OR_RETURN(
+      auto tensor_p,
+      CreateCudnnPointwiseTensor(ops, s_dims, s_strides, 'p',
+                                 intermediate_bmm2_lhs_descriptor.type(),
+                                 CUDNN_POINTWISE_DIV, tensor_exp,
+                                 &tensor_sum));
+
+  TF_ASSIGN_OR_RETURN(
+      auto tensor_v,
+      CreateCudnnTensor(bmm2_rhs_descriptor.GetCudnnCompatibleDimensions(false),
+                        bmm2_rhs_descriptor.GetCudnnCompatibleStrides(false),
+                        'v', bmm2_rhs_descriptor.type(), 1, -1));
+  TF_ASSIGN_OR_RETURN(
+      auto tensor_o,
+      CreateCudnnMatmulTensor(ops, output_descriptor.dimensions(),
+                              output_descriptor.GetLogicalStrides(), 'o',
+                              output_descriptor.type(), tensor_p, tensor_v,
+                              /*is_virtual=*/false));
+  VLOG(4) << "\nTensor_o: " << tensor_o.describe()
+          << "\nTensor_stats: " << tensor_stats.describe();
+  return BuildCudnnOperationGraph(ops, cudnn);
+}
+
+// Flash attention backward pass. P is recomputed from the softmax statistics
+// of the forward pass as P = exp(scale * Q @ K - L), and then
+//   dV = P^T @ dO
+//   dS = scale * P * (dO @ V^T - rowsum(dO * O))
+//   dQ = dS @ K^T, dK = dS^T @ Q
+// where K is the BMM1 rhs in its [batch, head, d, kv_seq] cuDNN form.
+tsl::StatusOr<std::unique_ptr<cudnn_frontend::OperationGraph>>
+GetCudnnFlashMHABackwardOperationGraph(
+    const dnn::MatmulTensorDescriptor& bmm1_lhs_descriptor,
+    const dnn::MatmulTensorDescriptor& bmm1_rhs_descriptor,
+    const dnn::MatmulTensorDescriptor& bmm2_rhs_descriptor,
+    const dnn::MatmulTensorDescriptor& intermediate_bmm2_lhs_descriptor,
+    const dnn::TensorDescriptor& output_descriptor,
+    const dnn::TensorDescriptor& softmax_stats_descriptor, CudnnHandle& cudnn,
+    double scale) {
+  PreloadCudnnSubLibsHelper(dnn::ConvolutionKind::BACKWARD_DATA);
+  std::vector<cudnn_frontend::Operation> ops;
+
+  std::vector<int64_t> q_dims =
+      bmm1_lhs_descriptor.GetCudnnCompatibleDimensions(true);
+  std::vector<int64_t> q_strides =
+      bmm1_lhs_descriptor.GetCudnnCompatibleStrides(true);
+  std::vector<int64_t> k_dims =
+      bmm1_rhs_descriptor.GetCudnnCompatibleDimensions(false);
+  std::vector<int64_t> k_strides =
+      bmm1_rhs_descriptor.GetCudnnCompatibleStrides(false);
+  std::vector<int64_t> v_dims =
+      bmm2_rhs_descriptor.GetCudnnCompatibleDimensions(false);
+  std::vector<int64_t> v_strides =
+      bmm2_rhs_descriptor.GetCudnnCompatibleStrides(false);
+  std::vector<int64_t> s_dims =
+      intermediate_bmm2_lhs_descriptor.GetCudnnCompatibleDimensions(true);
+  std::vector<int64_t> s_strides =
+      intermediate_bmm2_lhs_descriptor.GetCudnnCompatibleStrides(true);
+  std::vector<int64_t> o_dims = output_descriptor.dimensions();
+  std::vector<int64_t> o_strides = output_descriptor.GetLogicalStrides();
+  dnn::DataType dtype = bmm1_lhs_descriptor.type();
+  dnn::DataType p_type = intermediate_bmm2_lhs_descriptor.type();
+
+  TF_ASSIGN_OR_RETURN(auto tensor_q, CreateCudnnTensor(q_dims, q_strides, 'q',
+                                                       dtype, 1, -1));
+  TF_ASSIGN_OR_RETURN(auto tensor_k, CreateCudnnTensor(k_dims, k_strides, 'k',
+                                                       dtype, 1, -1));
+  TF_ASSIGN_OR_RETURN(auto tensor_v, CreateCudnnTensor(v_dims, v_strides, 'v',
+                                                       dtype, 1, -1));
+  TF_ASSIGN_OR_RETURN(
+      auto tensor_o,
+      CreateCudnnTensor(o_dims, o_strides, 'o', output_descriptor.type(), 1,
+                        -1));
+  TF_ASSIGN_OR_RETURN(
+      auto tensor_d_o,
+      CreateCudnnTensor(o_dims, o_strides, 'O', output_descriptor.type(), 1,
+                        -1));
+  TF_ASSIGN_OR_RETURN(
+      auto tensor_stats,
+      CreateCudnnTensor(softmax_stats_descriptor.dimensions(),
+                        softmax_stats_descriptor.GetLogicalStrides(), 'L',
+                        softmax_stats_descriptor.type(), 1, -1));
+
+  // Recompute P from the softmax statistics.
+  TF_ASSIGN_OR_RETURN(auto tensor_scaled,
+                      CreateCudnnFlashScaledBmm1Tensor(
+                          ops, tensor_q, tensor_k, s_dims, s_strides, scale));
+  TF_ASSIGN_OR_RETURN(
+      auto tensor_sub,
+      CreateCudnnPointwiseTensor(ops, s_dims, s_strides, 'S',
+                                 dnn::DataType::kFloat, CUDNN_POINTWISE_SUB,
+                                 tensor_scaled, &tensor_stats));
+  TF_ASSIGN_OR_RETURN(
+      auto tensor_p,
+      CreateCudnnPointwiseTensor(ops, s_dims, s_strides, 'p', p_type,
+                                 CUDNN_POINTWISE_EXP, tensor_sub));
+
+  // dV = P^T @ dO
+  TF_ASSIGN_OR_RETURN(
+      auto tensor_p_t,
+      CreateCudnnTransposeTensor(ops, s_dims, s_strides, 'P', p_type,
+                                 tensor_p));
+  TF_ASSIGN_OR_RETURN(
+      auto tensor_d_v,
+      CreateCudnnMatmulTensor(ops, v_dims, v_strides, 'V', dtype, tensor_p_t,
+                              tensor_d_o, /*is_virtual=*/false));
+
+  // dS = scale * P * (dO @ V^T - rowsum(dO * O))
+  TF_ASSIGN_OR_RETURN(
+      auto tensor_v_t,
+      CreateCudnnTransposeTensor(ops, v_dims, v_strides, 't', dtype,
+                                 tensor_v));
+  TF_ASSIGN_OR_RETURN(
+      auto tensor_d_p,
+      CreateCudnnMatmulTensor(ops, s_dims, s_strides, 'x',
+                              dnn::DataType::kFloat, tensor_d_o, tensor_v_t));
+  TF_ASSIGN_OR_RETURN(
+      auto tensor_d_o_o,
+      CreateCudnnPointwiseTensor(ops, o_dims, o_strides, 'y',
+                                 dnn::DataType::kFloat, CUDNN_POINTWISE_MUL,
+                                 tensor_d_o, &tensor_o));
+  TF_ASSIGN_OR_RETURN(
+      auto tensor_row_sum,
+      CreateCudnnRowReductionTensor(ops, o_dims, o_strides, 'z',
+                                    CUDNN_REDUCE_TENSOR_ADD, tensor_d_o_o));
+  TF_ASSIGN_OR_RETURN(
+      auto tensor_d_p_sub,
+      CreateCudnnPointwiseTensor(ops, s_dims, s_strides, 'w',
+                                 dnn::DataType::kFloat, CUDNN_POINTWISE_SUB,
+                                 tensor_d_p, &tensor_row_sum));
+  TF_ASSIGN_OR_RETURN(
+      auto tensor_d_s,
+      CreateCudnnPointwiseTensor(ops, s_dims, s_strides, 'a', p_type,
+                                 CUDNN_POINTWISE_MUL, tensor_p,
+                                 &tensor_d_p_sub, /*alpha=*/scale));
+
+  // dQ = dS @ K^T
+  TF_ASSIGN_OR_RETURN(
+      auto tensor_k_t,
+      CreateCudnnTransposeTensor(ops, k_dims, k_strides, 'T', dtype,
+                                 tensor_k));
+  TF_ASSIGN_OR_RETURN(
+      auto tensor_d_q,
+      CreateCudnnMatmulTensor(ops, q_dims, q_strides, 'Q', dtype, tensor_d_s,
+                              tensor_k_t, /*is_virtual=*/false));
+
+  // dK = dS^T @ Q, written in the [batch, head, kv_seq, d] layout of K.
+  TF_ASSIGN_OR_RETURN(
+      auto tensor_d_s_t,
+      CreateCudnnTransposeTensor(ops, s_dims, s_strides, 'D', p_type,
+                                 tensor_d_s));
+  TF_ASSIGN_OR_RETURN(
+      auto tensor_d_k,
+      CreateCudnnMatmulTensor(ops, TransposeLastTwo(k_dims),
+                              TransposeLastTwo(k_strides), 'K', dtype,
+                              tensor_d_s_t, tensor_q, /*is_virtual=*/false));
+  VLOG(4) << "\nTensor_dq: " << tensor_d_q.describe()
+          << "\nTensor_dk: " << tensor_d_k.describe()
+          << "\nTensor_dv: " << tensor_d_v.describe();
+  return BuildCudnnOperationGraph(ops, cudnn);
+}
 #endif
 
 }  // namespace
@@ -6254,6 +6637,78 @@ CudnnSupport::FusedMHAScaleBiasSoftmaxRunnerFromDesc(
 #endif
 }
 
+tsl::StatusOr<std::unique_ptr<const dnn::FusedMHAFlashRunner>>
+CudnnSupport::FusedMHAFlashScaleSoftmaxRunnerFromDesc(
+    Stream* stream, const dnn::AlgorithmDesc& algorithm_desc,
+    const dnn::MatmulTensorDescriptor& bmm1_lhs_descriptor,
+    const dnn::MatmulTensorDescriptor& bmm1_rhs_descriptor,
+    const dnn::MatmulTensorDescriptor& bmm2_rhs_descriptor,
+    const dnn::MatmulTensorDescriptor& intermediate_bmm2_lhs_descriptor,
+    const dnn::TensorDescriptor& output_descriptor,
+    const dnn::TensorDescriptor& softmax_stats_descriptor, double scale) {
+#if CUDNN_VERSION >= 8900 && TF_ENABLE_CUDNN_FRONTEND
+  auto cudnn = cudnn_->GetHandle(parent_, stream);
+  TF_ASSIGN_OR_RETURN(
+      auto op_graph,
+      GetCudnnFlashMHAForwardOperationGraph(
+          bmm1_lhs_descriptor, bmm1_rhs_descriptor, bmm2_rhs_descriptor,
+          intermediate_bmm2_lhs_descriptor, output_descriptor,
+          softmax_stats_descriptor, cudnn, scale));
+
+  TF_ASSIGN_OR_RETURN(auto execution_plan,
+                      RebuildExecutionPlan(cudnn, algorithm_desc, *op_graph));
+
+  // The signature has 5 arguments, so need_side_input must be set to keep the
+  // runner from dropping the third one.
+  TF_ASSIGN_OR_RETURN(
+      auto runner,
+      CudnnExecutionPlanRunner<dnn::FusedMHAFlashSignature>::Create(
+          parent_, cudnn_.get(), std::move(execution_plan),
+          {'q', 'k', 'v', 'o', 'L'}, true));
+  return {
+      std::make_unique<CudnnExecutionPlanRunner<dnn::FusedMHAFlashSignature>>(
+          std::move(runner))};
+#else
+  return tsl::errors::Unimplemented(
+      "Flash attention is only supported with Cudnn >= 8.9.");
+#endif
+}
+
+tsl::StatusOr<std::unique_ptr<const dnn::FusedMHAFlashBackwardRunner>>
+CudnnSupport::FusedMHAFlashScaleSoftmaxBackwardRunnerFromDesc(
+    Stream* stream, const dnn::AlgorithmDesc& algorithm_desc,
+    const dnn::MatmulTensorDescriptor& bmm1_lhs_descriptor,
+    const dnn::MatmulTensorDescriptor& bmm1_rhs_descriptor,
+    const dnn::MatmulTensorDescriptor& bmm2_rhs_descriptor,
+    const dnn::MatmulTensorDescriptor& intermediate_bmm2_lhs_descriptor,
+    const dnn::TensorDescriptor& output_descriptor,
+    const dnn::TensorDescriptor& softmax_stats_descriptor, double scale) {
+#if CUDNN_VERSION >= 8900 && TF_ENABLE_CUDNN_FRONTEND
+  auto cudnn = cudnn_->GetHandle(parent_, stream);
+  TF_ASSIGN_OR_RETURN(
+      auto op_graph,
+      GetCudnnFlashMHABackwardOperationGraph(
+          bmm1_lhs_descriptor, bmm1_rhs_descriptor, bmm2_rhs_descriptor,
+          intermediate_bmm2_lhs_descriptor, output_descriptor,
+          softmax_stats_descriptor, cudnn, scale));
+
+  TF_ASSIGN_OR_RETURN(auto execution_plan,
+                      RebuildExecutionPlan(cudnn, algorithm_desc, *op_graph));
+
+  TF_ASSIGN_OR_RETURN(
+      auto runner,
+      CudnnExecutionPlanRunner<dnn::FusedMHAFlashBackwardSignature>::Create(
+          parent_, cudnn_.get(), std::move(execution_plan),
+          {'q', 'k', 'v', 'o', 'L', 'O', 'Q', 'K', 'V'}, false));
+  return {std::make_unique<
+      CudnnExecutionPlanRunner<dnn::FusedMHAFlashBackwardSignature>>(
+      std::move(runner))};
+#else
+  return tsl::errors::Unimplemented(
+      "Flash attention is only supported with Cudnn >= 8.9.");
+#endif
+}
+
 bool CudnnSupport::GetRnnAlgorithms(
     std::vector<dnn::AlgorithmDesc>* out_algorithms) {
   PreloadCudnnSubLibs(PreloadCudnnType::Rnn);
@@ -1013,6 +1013,28 @@ using FusedMHABiasSignature = void(DeviceMemoryBase /*BMM1_inputA_data*/,
                                    DeviceMemoryBase /* output_data */);
 using FusedMHABiasRunner = OpRunner<FusedMHABiasSignature>;
 
+// Forward pass of flash attention for training: besides the output, it writes
+// the per-row softmax statistics (max + log(sum(exp))) that the backward pass
+// recomputes the attention probabilities from.
+using FusedMHAFlashSignature = void(DeviceMemoryBase /* BMM1_inputA_data */,
+                                    DeviceMemoryBase /* BMM1_inputB_data */,
+                                    DeviceMemoryBase /* BMM2_inputA_data */,
+                                    DeviceMemoryBase /* output_data */,
+                                    DeviceMemoryBase /* softmax_stats_data */);
+using FusedMHAFlashRunner = OpRunner<FusedMHAFlashSignature>;
+
+using FusedMHAFlashBackwardSignature =
+    void(DeviceMemoryBase /* BMM1_inputA_data */,
+         DeviceMemoryBase /* BMM1_inputB_data */,
+         DeviceMemoryBase /* BMM2_inputA_data */,
+         DeviceMemoryBase /* output_data */,
+         DeviceMemoryBase /* softmax_stats_data */,
+         DeviceMemoryBase /* d_output_data */,
+         DeviceMemoryBase /* d_BMM1_inputA_data */,
+         DeviceMemoryBase /* d_BMM1_inputB_data */,
+         DeviceMemoryBase /* d_BMM2_inputA_data */);
+using FusedMHAFlashBackwardRunner = OpRunner<FusedMHAFlashBackwardSignature>;
+
 // Describes the configuration for the algorithms that will used.
 //
 // Arguments:
@@ -1682,6 +1704,29 @@ class DnnSupport {
       const dnn::TensorDescriptor& bias_descriptor, double scale,
       std::optional<double> dropout_rate, std::optional<int64_t> seed);
 
+  virtual tsl::StatusOr<std::unique_ptr<const dnn::FusedMHAFlashRunner>>
+  FusedMHAFlashScaleSoftmaxRunnerFromDesc(
+      Stream* stream, const dnn::AlgorithmDesc& algorithm_desc,
+      const dnn::MatmulTensorDescriptor& bmm1_lhs_descriptor,
+      const dnn::MatmulTensorDescriptor& bmm1_rhs_descriptor,
+      const dnn::MatmulTensorDescriptor& bmm2_rhs_descriptor,
+      const dnn::MatmulTensorDescriptor& intermediate_bmm2_lhs_descriptor,
+      const dnn::TensorDescriptor& output_descriptor,
+      const dnn::TensorDescriptor& softmax_stats_descriptor, double scale);
+
+  // The gradients of the BMM inputs have the descriptors of the inputs and the
+  // gradient of the output has the descriptor of the output.
+  virtual tsl::StatusOr<
+      std::unique_ptr<const dnn::FusedMHAFlashBackwardRunner>>
+  FusedMHAFlashScaleSoftmaxBackwardRunnerFromDesc(
+      Stream* stream, const dnn::AlgorithmDesc& algorithm_desc,
+      const dnn::MatmulTensorDescriptor& bmm1_lhs_descriptor,
+      const dnn::MatmulTensorDescriptor& bmm1_rhs_descriptor,
+      const dnn::MatmulTensorDescriptor& bmm2_rhs_descriptor,
+      const dnn::MatmulTensorDescriptor& intermediate_bmm2_lhs_descriptor,
+      const dnn::TensorDescriptor& output_descriptor,
+      const dnn::TensorDescriptor& softmax_stats_descriptor, double scale);
+
   virtual bool GetMIOpenConvolveAlgorithms(
       dnn::ConvolutionKind kind, dnn::DataType element_type, Stream* stream,
       const dnn::BatchDescriptor& input_descriptor, DeviceMemoryBase input_data,
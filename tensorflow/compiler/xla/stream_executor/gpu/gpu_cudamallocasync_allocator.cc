@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/stream_executor/gpu/gpu_cudamallocasync_allocator.h"
 
+#include <algorithm>
 #include <map>
 #include <memory>
 #include <optional>
@@ -26,6 +27,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/stream_executor/cuda/cuda_activation.h"
 #endif  // GOOGLE_CUDA
 
+#include "absl/algorithm/container.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
 #include "tensorflow/compiler/xla/stream_executor/device_id_utils.h"
@@ -112,13 +114,23 @@ std::atomic<int> GpuCudaMallocAsyncAllocator::number_instantiated_(0);
 GpuCudaMallocAsyncAllocator::GpuCudaMallocAsyncAllocator(
     tsl::PlatformDeviceId platform_device_id, size_t pool_size,
     bool reserve_memory, bool compute_stats)
+    : GpuCudaMallocAsyncAllocator(platform_device_id, pool_size,
+                                  reserve_memory, compute_stats, Options()) {}
+
+GpuCudaMallocAsyncAllocator::GpuCudaMallocAsyncAllocator(
+    tsl::PlatformDeviceId platform_device_id, size_t pool_size,
+    bool reserve_memory, bool compute_stats, const Options& options)
     : name_(absl::StrCat("gpu_async_", platform_device_id.value())),
-      reserve_memory_(reserve_memory) {
+      reserve_memory_(reserve_memory),
+      pool_size_(pool_size),
+      options_(options) {
   ++number_instantiated_;
 
   // Stop clang from complaining about unused private fields when
   // TF_CUDA_MALLOC_ASYNC_SUPPORTED is not defined.
   (void)reserve_memory_;
+  (void)pool_size_;
+  (void)options_;
 
 #if TF_CUDA_MALLOC_ASYNC_SUPPORTED
   stream_exec_ = DeviceIdUtil::ExecutorForPlatformDeviceId(
@@ -194,6 +206,10 @@ GpuCudaMallocAsyncAllocator::GpuCudaMallocAsyncAllocator(
     stats_ = std::make_unique<tsl::AllocatorStats>();
     stats_->bytes_limit = static_cast<int64_t>(pool_size);
   }  // If not set, it means we do not compute stats.
+  if (options_.release_threshold_peak_fraction > 0 && !compute_stats) {
+    LOG(WARNING) << Name() << " release_threshold_peak_fraction is ignored"
+                 << " because stats are not computed.";
+  }
 
   // If in TF_DETERMINISTIC_ALLOCATOR is set, then make the allocator behave
   // determistically.
@@ -277,42 +293,98 @@ GpuCudaMallocAsyncAllocator::GpuCudaMallocAsyncAllocator(
 #endif  // TF_CUDA_MALLOC_ASYNC_SUPPORTED
 }
 
-GpuCudaMallocAsyncAllocator::~GpuCudaMallocAsyncAllocator() {}
+GpuCudaMallocAsyncAllocator::~GpuCudaMallocAsyncAllocator() {
+#if TF_CUDA_MALLOC_ASYNC_SUPPORTED
+  tsl::mutex_lock lock(lock_);
+  if (streams_.empty()) return;
+  cuda::ScopedActivateExecutorContext scoped_activation{stream_exec_};
+  for (const auto& [stream, info] : streams_) {
+    cuEventDestroy(info.event);
+    // The pool is released once its outstanding allocations are freed.
+    if (info.pool != pool_) cuMemPoolDestroy(info.pool);
+  }
+#endif  // TF_CUDA_MALLOC_ASYNC_SUPPORTED
+}
 
 void* GpuCudaMallocAsyncAllocator::AllocateRaw(size_t alignment,
                                                size_t num_bytes) {
 #if TF_CUDA_MALLOC_ASYNC_SUPPORTED
   CHECK(cuda_stream_ != nullptr)
       << "A stream must be added to the GpuCudaMallocAsync allocator";
+  return AllocateRawOnStream(alignment, num_bytes, &cuda_stream_);
+#else   // TF_CUDA_MALLOC_ASYNC_SUPPORTED
+  return nullptr;
+#endif  // TF_CUDA_MALLOC_ASYNC_SUPPORTED
+}
+
+void* GpuCudaMallocAsyncAllocator::AllocateRawOnStream(size_t alignment,
+                                                       size_t num_bytes,
+                                                       void* stream) {
+#if TF_CUDA_MALLOC_ASYNC_SUPPORTED
   if (pool_ == nullptr) {
     LOG(FATAL)  // Crash OK.
         << "The instantiation of GpuCudaMallocAsyncAllocator failed."
         << " See previous errors.";
   }
-  // The lock is only needed when stats are enabled, but it must be around
-  // the cuMemAllocFromPoolAsync call as well to ensure consistency of the stats
-  // update.
+  CUstream cuda_stream = *(static_cast<CUstream*>(stream));
+  // The lock is only needed when stats or stream uses are tracked, but it must
+  // be around the cuMemAllocFromPoolAsync call as well to ensure consistency
+  // of the updates.
   std::unique_lock<tsl::mutex> lock(lock_, std::defer_lock);
-  if (stats_) {
+  if (NeedsLock()) {
     lock.lock();
   }
+  // The main stream always allocates from the default pool. Other streams
+  // must have been added, which makes every allocation take the lock.
+  CUmemoryPool pool = pool_;
+  if (cuda_stream != cuda_stream_) {
+    CHECK(lock.owns_lock())
+        << "Stream " << cuda_stream << " wasn't added to " << Name();
+    auto it = streams_.find(cuda_stream);
+    CHECK(it != streams_.end())
+        << "Stream " << cuda_stream << " wasn't added to " << Name();
+    pool = it->second.pool;
+  }
+  return AllocateRawNoLock(alignment, num_bytes, pool, cuda_stream);
+#else   // TF_CUDA_MALLOC_ASYNC_SUPPORTED
+  return nullptr;
+#endif  // TF_CUDA_MALLOC_ASYNC_SUPPORTED
+}
+
+#if TF_CUDA_MALLOC_ASYNC_SUPPORTED
+void* GpuCudaMallocAsyncAllocator::AllocateRawNoLock(size_t alignment,
+                                                     size_t num_bytes,
+                                                     CUmemoryPool pool,
+                                                     CUstream stream) {
   cuda::ScopedActivateExecutorContext scoped_activation{stream_exec_};
   void* ptr = nullptr;
-  if (auto result =
-          cuMemAllocFromPoolAsync(reinterpret_cast<CUdeviceptr*>(&ptr),
-                                  num_bytes, pool_, cuda_stream_)) {
-    size_t free, total;
-    cuMemGetInfo(&free, &total);
-    LOG(ERROR) << Name() << " cuMemAllocAsync failed to allocate " << num_bytes
-               << " bytes: " << GetCudaErrorMessage(result)
-               << "\n Reported by CUDA: Free memory/Total memory: " << free
-               << "/" << total;
-    if (stats_) {
-      LOG(ERROR) << "Stats: " << stats_->DebugString();
-      PrintAllocatorStatisticsNoLock();
+  if (auto result = cuMemAllocFromPoolAsync(
+          reinterpret_cast<CUdeviceptr*>(&ptr), num_bytes, pool, stream)) {
+    // Memory of the fallback allocator isn't stream-ordered, so only
+    // allocations on the main stream can fall back to it.
+    if (options_.fallback_allocator != nullptr && stream == cuda_stream_) {
+      ptr = options_.fallback_allocator->AllocateRaw(alignment, num_bytes);
     }
+    if (ptr == nullptr) {
+      size_t free, total;
+      cuMemGetInfo(&free, &total);
+      LOG(ERROR) << Name() << " cuMemAllocAsync failed to allocate "
+                 << num_bytes << " bytes: " << GetCudaErrorMessage(result)
+                 << "\n Reported by CUDA: Free memory/Total memory: " << free
+                 << "/" << total;
+      if (stats_) {
+        LOG(ERROR) << "Stats: " << stats_->DebugString();
+        PrintAllocatorStatisticsNoLock();
+      }
 
-    return nullptr;
+      return nullptr;
+    }
+    VLOG(1) << Name() << " cuMemAllocAsync failed to allocate " << num_bytes
+            << " bytes: " << GetCudaErrorMessage(result) << ". Allocated by "
+            << options_.fallback_allocator->Name() << " instead.";
+    fallback_ptrs_.insert(ptr);
+  } else if (stream != cuda_stream_) {
+    stream_uses_[ptr].stream = stream;
   }
 
   // Update stats.
@@ -332,35 +404,42 @@ void* GpuCudaMallocAsyncAllocator::AllocateRaw(size_t alignment,
   }
   VLOG(10) << Name() << " Allocated " << num_bytes << " at " << ptr;
   return ptr;
-#else   // TF_CUDA_MALLOC_ASYNC_SUPPORTED
-  return nullptr;
-#endif  // TF_CUDA_MALLOC_ASYNC_SUPPORTED
 }
+#endif  // TF_CUDA_MALLOC_ASYNC_SUPPORTED
+
 void GpuCudaMallocAsyncAllocator::DeallocateRaw(void* ptr) {
 #if TF_CUDA_MALLOC_ASYNC_SUPPORTED
   if (ptr == nullptr) return;
-  // The lock is only needed when stats are enabled, but it must be around
-  // the cuMemFreeAsync call as well to ensure consistency of the stats update.
+  // The lock is only needed when stats or stream uses are tracked, but it must
+  // be around the cuMemFreeAsync call as well to ensure consistency of the
+  // updates.
   std::unique_lock<tsl::mutex> lock(lock_, std::defer_lock);
-  if (stats_) {
+  if (NeedsLock()) {
     lock.lock();
   }
-  if (auto result = cuMemFreeAsync(reinterpret_cast<const CUdeviceptr&>(ptr),
-                                   cuda_stream_)) {
-    if (result == CUDA_ERROR_DEINITIALIZED) {
-      // It happens with multi-GPU that TF free the GPU allocation after
-      // the driver is unloaded. It is safe to ignore this error here.
-      // TODO: Find how to fix the shutdown steps in TF.
-      VLOG(1) << "Ignoring CUDA error: " << GetCudaErrorMessage(result);
-    } else {
-      size_t free, total;
-      cuda::ScopedActivateExecutorContext scoped_activation{stream_exec_};
-      cuMemGetInfo(&free, &total);
-      LOG(ERROR) << "cudaFreeAsync failed to free " << ptr << ": "
-                 << GetCudaErrorMessage(result)
-                 << "\n Free memory/Total memory: " << free << "/" << total;
-      if (stats_) {
-        LOG(ERROR) << "Stats: " << stats_->DebugString();
+  if (options_.fallback_allocator != nullptr && fallback_ptrs_.erase(ptr)) {
+    options_.fallback_allocator->DeallocateRaw(ptr);
+  } else {
+    // Stream uses are only recorded once other streams were added, which
+    // makes every deallocation take the lock.
+    CUstream stream = lock.owns_lock() ? PrepareFreeNoLock(ptr) : cuda_stream_;
+    if (auto result =
+            cuMemFreeAsync(reinterpret_cast<const CUdeviceptr&>(ptr), stream)) {
+      if (result == CUDA_ERROR_DEINITIALIZED) {
+        // It happens with multi-GPU that TF free the GPU allocation after
+        // the driver is unloaded. It is safe to ignore this error here.
+        // TODO: Find how to fix the shutdown steps in TF.
+        VLOG(1) << "Ignoring CUDA error: " << GetCudaErrorMessage(result);
+      } else {
+        size_t free, total;
+        cuda::ScopedActivateExecutorContext scoped_activation{stream_exec_};
+        cuMemGetInfo(&free, &total);
+        LOG(ERROR) << "cudaFreeAsync failed to free " << ptr << ": "
+                   << GetCudaErrorMessage(result)
+                   << "\n Free memory/Total memory: " << free << "/" << total;
+        if (stats_) {
+          LOG(ERROR) << "Stats: " << stats_->DebugString();
+        }
       }
     }
   }
@@ -377,6 +456,50 @@ void GpuCudaMallocAsyncAllocator::DeallocateRaw(void* ptr) {
 #endif  // TF_CUDA_MALLOC_ASYNC_SUPPORTED
 }
 
+#if TF_CUDA_MALLOC_ASYNC_SUPPORTED
+CUstream GpuCudaMallocAsyncAllocator::PrepareFreeNoLock(void* ptr) {
+  auto it = stream_uses_.find(ptr);
+  if (it == stream_uses_.end()) return cuda_stream_;
+  CUstream stream = it->second.stream;
+  // The free is ordered after the work enqueued so far on the streams that
+  // used the memory, on the GPU only.
+  cuda::ScopedActivateExecutorContext scoped_activation{stream_exec_};
+  for (CUstream used_on : it->second.used_on) {
+    CUevent event = streams_.at(used_on).event;
+    if (auto result = cuEventRecord(event, used_on)) {
+      LOG(ERROR) << "Failed to record event on stream " << used_on << ": "
+                 << GetCudaErrorMessage(result);
+    } else if (auto result = cuStreamWaitEvent(stream, event, 0)) {
+      LOG(ERROR) << "Failed to wait for event on stream " << stream << ": "
+                 << GetCudaErrorMessage(result);
+    }
+  }
+  stream_uses_.erase(it);
+  return stream;
+}
+#endif  // TF_CUDA_MALLOC_ASYNC_SUPPORTED
+
+void GpuCudaMallocAsyncAllocator::RecordStreamUse(void* ptr, void* stream) {
+#if TF_CUDA_MALLOC_ASYNC_SUPPORTED
+  CUstream cuda_stream = *(static_cast<CUstream*>(stream));
+  tsl::mutex_lock lock(lock_);
+  CHECK(streams_.contains(cuda_stream))
+      << "Stream " << cuda_stream << " wasn't added to " << Name();
+  // Memory of the fallback allocator is only used on the main stream.
+  if (fallback_ptrs_.contains(ptr)) return;
+  auto it = stream_uses_.find(ptr);
+  CUstream alloc_stream =
+      it == stream_uses_.end() ? cuda_stream_ : it->second.stream;
+  if (cuda_stream == alloc_stream) return;
+  if (it == stream_uses_.end()) {
+    it = stream_uses_.emplace(ptr, StreamUses{cuda_stream_, {}}).first;
+  }
+  if (!absl::c_linear_search(it->second.used_on, cuda_stream)) {
+    it->second.used_on.push_back(cuda_stream);
+  }
+#endif  // TF_CUDA_MALLOC_ASYNC_SUPPORTED
+}
+
 bool GpuCudaMallocAsyncAllocator::TracksAllocationSizes() const {
   return static_cast<bool>(stats_);
 }
@@ -402,6 +525,28 @@ std::optional<tsl::AllocatorStats> GpuCudaMallocAsyncAllocator::GetStats() {
 bool GpuCudaMallocAsyncAllocator::ClearStats() {
   if (!stats_) return false;
   tsl::mutex_lock l(lock_);
+#if TF_CUDA_MALLOC_ASYNC_SUPPORTED
+  // The release threshold follows the peak usage of the last period, e.g. the
+  // last training step, unless the whole pool is reserved.
+  if (options_.release_threshold_peak_fraction > 0 && !reserve_memory_ &&
+      pool_ != nullptr) {
+    uint64_t threshold = std::min<uint64_t>(
+        pool_size_, static_cast<uint64_t>(
+                        stats_->peak_bytes_in_use *
+                        options_.release_threshold_peak_fraction));
+    cuda::ScopedActivateExecutorContext scoped_activation{stream_exec_};
+    absl::flat_hash_set<CUmemoryPool> pools = {pool_};
+    for (const auto& [stream, info] : streams_) pools.insert(info.pool);
+    for (CUmemoryPool pool : pools) {
+      if (auto status = cuMemPoolSetAttribute(
+              pool, CU_MEMPOOL_ATTR_RELEASE_THRESHOLD, &threshold)) {
+        LOG(ERROR) << "Failed to set CUDA pool attribute: "
+                   << GetCudaErrorMessage(status);
+      }
+    }
+    VLOG(2) << Name() << " release threshold set to " << threshold;
+  }
+#endif  // TF_CUDA_MALLOC_ASYNC_SUPPORTED
   stats_->num_allocs = 0;
   stats_->peak_bytes_in_use = stats_->bytes_in_use;
   stats_->largest_alloc_size = 0;
@@ -424,6 +569,10 @@ void GpuCudaMallocAsyncAllocator::SetStreamAndPreallocateMemory(void* stream) {
         "Failed to get CUDA pool attribute: " << GetCudaErrorMessage(status);
   }
   cuda_stream_ = new_cuda_stream;
+  {
+    tsl::mutex_lock lock(lock_);
+    AddStreamNoLock(cuda_stream_);
+  }
   int64_t prealloc_size = 0;
   // TF_CUDA_MALLOC_ASYNC_SUPPORTED_PREALLOC=-1 is a special value that
   // preallocates the total pool size.
@@ -446,4 +595,91 @@ void GpuCudaMallocAsyncAllocator::SetStreamAndPreallocateMemory(void* stream) {
 #endif
 }
 
+void GpuCudaMallocAsyncAllocator::AddStream(void* stream) {
+#if TF_CUDA_MALLOC_ASYNC_SUPPORTED
+  CUstream cuda_stream = *(static_cast<CUstream*>(stream));
+  tsl::mutex_lock lock(lock_);
+  multi_stream_ = true;
+  AddStreamNoLock(cuda_stream);
+#endif  // TF_CUDA_MALLOC_ASYNC_SUPPORTED
+}
+
+#if TF_CUDA_MALLOC_ASYNC_SUPPORTED
+void GpuCudaMallocAsyncAllocator::AddStreamNoLock(CUstream stream) {
+  if (streams_.contains(stream)) return;
+  cuda::ScopedActivateExecutorContext scoped_activation{stream_exec_};
+  StreamInfo info{pool_, nullptr};
+  if (options_.pool_per_stream && stream != cuda_stream_) {
+    const int device = stream_exec_->device_ordinal();
+    CUmemPoolProps props = {};
+    props.allocType = CU_MEM_ALLOCATION_TYPE_PINNED;
+    props.location.type = CU_MEM_LOCATION_TYPE_DEVICE;
+    props.location.id = device;
+    if (auto status = cuMemPoolCreate(&info.pool, &props)) {
+      LOG(FATAL) <<  // Crash OK.
+          "Failed to create CUDA pool: " << GetCudaErrorMessage(status);
+    }
+
+    // The pool is configured like the default pool of the device.
+    uint64_t threshold = 0;
+    if (auto status = cuMemPoolGetAttribute(
+            pool_, CU_MEMPOOL_ATTR_RELEASE_THRESHOLD, &threshold)) {
+      LOG(FATAL) <<  // Crash OK.
+          "Failed to get CUDA pool attribute: " << GetCudaErrorMessage(status);
+    }
+    if (auto status = cuMemPoolSetAttribute(
+            info.pool, CU_MEMPOOL_ATTR_RELEASE_THRESHOLD, &threshold)) {
+      LOG(FATAL) <<  // Crash OK.
+          "Failed to set CUDA pool attribute: " << GetCudaErrorMessage(status);
+    }
+    for (CUmemPool_attribute attr :
+         {CU_MEMPOOL_ATTR_REUSE_ALLOW_OPPORTUNISTIC,
+          CU_MEMPOOL_ATTR_REUSE_ALLOW_INTERNAL_DEPENDENCIES}) {
+      int value;
+      if (auto status = cuMemPoolGetAttribute(pool_, attr, &value)) {
+        LOG(FATAL)  // Crash OK.
+            << "Failed to get CUDA pool attribute: "
+            << GetCudaErrorMessage(status);
+      }
+      if (auto status = cuMemPoolSetAttribute(info.pool, attr, &value)) {
+        LOG(FATAL)  // Crash OK.
+            << "Failed to set CUDA pool attribute: "
+            << GetCudaErrorMessage(status);
+      }
+    }
+
+    // Gives the peers that can access the default pool at this point access to
+    // the new pool.
+    int device_count = 0;
+    cuDeviceGetCount(&device_count);
+    for (int i = 0; i < device_count; ++i) {
+      if (i == device) continue;
+      CUmemLocation location;
+      location.type = CU_MEM_LOCATION_TYPE_DEVICE;
+      location.id = i;
+      CUmemAccess_flags flags;
+      if (cuMemPoolGetAccess(&flags, pool_, &location) != CUDA_SUCCESS ||
+          flags != CU_MEM_ACCESS_FLAGS_PROT_READWRITE) {
+        continue;
+      }
+      CUmemAccessDesc map;
+      map.flags = flags;
+      map.location = location;
+      if (auto status = cuMemPoolSetAccess(info.pool, &map, 1)) {
+        LOG(ERROR) << "Error when setting access to the pool of stream "
+                   << stream << " location id: " << i
+                   << " error: " << GetCudaErrorMessage(status);
+      }
+    }
+  }
+  if (auto status = cuEventCreate(&info.event, CU_EVENT_DISABLE_TIMING)) {
+    LOG(FATAL) <<  // Crash OK.
+        "Failed to create CUDA event: " << GetCudaErrorMessage(status);
+  }
+  streams_.emplace(stream, info);
+  VLOG(2) << Name() << " added stream " << stream
+          << (info.pool != pool_ ? " with its own pool" : "");
+}
+#endif  // TF_CUDA_MALLOC_ASYNC_SUPPORTED
+
 }  // namespace stream_executor
@@ -16,12 +16,15 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_XLA_STREAM_EXECUTOR_GPU_GPU_CUDAMALLOCASYNC_ALLOCATOR_H_
 #define TENSORFLOW_COMPILER_XLA_STREAM_EXECUTOR_GPU_GPU_CUDAMALLOCASYNC_ALLOCATOR_H_
 
+#include <atomic>
 #include <memory>
 #include <optional>
 #include <string>
 
 #include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/container/inlined_vector.h"
 #include "tensorflow/compiler/xla/stream_executor/stream_executor.h"
 #include "tensorflow/tsl/framework/allocator.h"
 #include "tensorflow/tsl/framework/device_id.h"
@@ -64,12 +67,42 @@ namespace stream_executor {
 // Here, the pool_size isn't the absolute max as for [Gpu]BFCAllocator.
 // The pool can grow above that up to the total GPU memory.  But the
 // driver can return the excess memory to other processes.
+//
+// Besides the stream passed to SetStreamAndPreallocateMemory, other streams
+// (e.g. NCCL streams) can be registered with AddStream and allocated on with
+// AllocateRawOnStream. Memory is then recycled in the order of the stream it
+// was allocated on. A buffer used on other streams than the one it was
+// allocated on must be reported with RecordStreamUse: its free then waits on
+// GPU events recorded on these streams, without blocking the host.
 class GpuCudaMallocAsyncAllocator : public tsl::Allocator {
  public:
+  struct Options {
+    // If true, each stream gets its own memory pool instead of sharing the
+    // default pool of the device. Memory freed on a stream is then only reused
+    // on the same stream, so the driver never inserts dependencies between
+    // streams to reuse it.
+    bool pool_per_stream = false;
+
+    // If positive, every call to ClearStats() sets the release threshold of
+    // the pools to this fraction of the peak memory in use since the previous
+    // call, capped to pool_size. Memory above the threshold is returned to the
+    // driver at the next synchronization. Requires compute_stats.
+    double release_threshold_peak_fraction = 0;
+
+    // If set, allocations that fail in the pool are served by this allocator
+    // (e.g. a BFCAllocator on memory reserved up front) instead of failing.
+    // Its memory isn't stream-ordered, so it must only be used with the stream
+    // passed to SetStreamAndPreallocateMemory. Not owned.
+    tsl::Allocator* fallback_allocator = nullptr;
+  };
+
   explicit GpuCudaMallocAsyncAllocator(tsl::PlatformDeviceId platform_device_id,
                                        size_t pool_size,
                                        bool reserve_memory = false,
                                        bool compute_stats = true);
+  GpuCudaMallocAsyncAllocator(tsl::PlatformDeviceId platform_device_id,
+                              size_t pool_size, bool reserve_memory,
+                              bool compute_stats, const Options& options);
   ~GpuCudaMallocAsyncAllocator() override;
   std::string Name() override { return name_; }
   void* AllocateRaw(size_t alignment,
@@ -88,6 +121,22 @@ class GpuCudaMallocAsyncAllocator : public tsl::Allocator {
 
   void SetStreamAndPreallocateMemory(void* stream) override;
 
+  // Registers another stream that memory can be allocated on or used on. Must
+  // be called after SetStreamAndPreallocateMemory and before any other
+  // allocation. `stream` points to a CUstream.
+  void AddStream(void* stream);
+
+  // Allocates memory that is ready for use in the order of `stream`, a stream
+  // passed to SetStreamAndPreallocateMemory or AddStream. The memory is freed
+  // on the same stream by DeallocateRaw.
+  void* AllocateRawOnStream(size_t alignment, size_t num_bytes, void* stream)
+      ABSL_NO_THREAD_SAFETY_ANALYSIS;
+
+  // Records that `ptr` is used on `stream`, a registered stream other than
+  // the one it was allocated on. DeallocateRaw makes the free wait for the
+  // work enqueued on `stream` until then.
+  void RecordStreamUse(void* ptr, void* stream);
+
   // With the right VLOG set, it prints:
   // - the number of ptr currently allocated per size (histogram).
   // - each ptr value and its size.
@@ -104,6 +153,32 @@ class GpuCudaMallocAsyncAllocator : public tsl::Allocator {
   void PrintAllocatorStatisticsNoLock() ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_);
 
 #if TF_CUDA_MALLOC_ASYNC_SUPPORTED
+  // The pool and the event used to order frees after uses of a registered
+  // stream.
+  struct StreamInfo {
+    CUmemoryPool pool;  // Not owned if it's the default pool.
+    CUevent event;
+  };
+
+  // Registers `stream`, creating its pool if pools are per stream.
+  void AddStreamNoLock(CUstream stream) ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Allocates from `pool` on `stream` and updates the stats, falling back to
+  // the fallback allocator on failure.
+  void* AllocateRawNoLock(size_t alignment, size_t num_bytes,
+                          CUmemoryPool pool, CUstream stream)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Returns the stream to free `ptr` on, after making it wait for the other
+  // streams `ptr` was used on.
+  CUstream PrepareFreeNoLock(void* ptr) ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Whether allocations and deallocations need to take lock_.
+  bool NeedsLock() const {
+    return stats_ != nullptr || multi_stream_ ||
+           options_.fallback_allocator != nullptr;
+  }
+
   StreamExecutor* stream_exec_;  // Not owned.
 
   // cudaMallocAsync is stream aware. But TF StreamExecutor use only 1
@@ -117,6 +192,21 @@ class GpuCudaMallocAsyncAllocator : public tsl::Allocator {
   // If null, then the instanciation failed and the first allocation
   // will return an error.
   CUmemoryPool pool_;
+
+  // Registered streams, including cuda_stream_.
+  absl::flat_hash_map<CUstream, StreamInfo> streams_ ABSL_GUARDED_BY(lock_);
+  // Whether streams other than cuda_stream_ were registered. Read without the
+  // lock to decide whether to take it.
+  std::atomic<bool> multi_stream_{false};
+
+  // The stream each allocation was made on, and the other streams it was used
+  // on. Allocations made on cuda_stream_ and never used elsewhere are omitted.
+  struct StreamUses {
+    CUstream stream;
+    absl::InlinedVector<CUstream, 2> used_on;
+  };
+  absl::flat_hash_map<const void*, StreamUses> stream_uses_
+      ABSL_GUARDED_BY(lock_);
 #endif  // TF_CUDA_MALLOC_ASYNC_SUPPORTED
 
   // Just a counter for the number of time this class is instantiated.
@@ -127,6 +217,10 @@ class GpuCudaMallocAsyncAllocator : public tsl::Allocator {
 
   bool reserve_memory_;
 
+  size_t pool_size_;
+
+  const Options options_;
+
   TF_DISALLOW_COPY_AND_ASSIGN(GpuCudaMallocAsyncAllocator);
 
   // Stats.
@@ -134,6 +228,8 @@ class GpuCudaMallocAsyncAllocator : public tsl::Allocator {
   mutable tsl::mutex lock_;
   std::unique_ptr<tsl::AllocatorStats> stats_ ABSL_PT_GUARDED_BY(lock_);
   absl::flat_hash_map<const void*, size_t> size_map_ ABSL_GUARDED_BY(lock_);
+  // Allocations served by the fallback allocator.
+  absl::flat_hash_set<const void*> fallback_ptrs_ ABSL_GUARDED_BY(lock_);
 };
 
 }  // namespace stream_executor
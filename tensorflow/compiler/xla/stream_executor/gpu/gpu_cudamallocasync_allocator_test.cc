@@ -0,0 +1,238 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#if GOOGLE_CUDA
+#include "tensorflow/compiler/xla/stream_executor/gpu/gpu_cudamallocasync_allocator.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "third_party/gpus/cuda/include/cuda.h"
+#include "tensorflow/compiler/xla/stream_executor/cuda/cuda_activation.h"
+#include "tensorflow/compiler/xla/stream_executor/device_id_utils.h"
+#include "tensorflow/compiler/xla/stream_executor/gpu/gpu_init.h"
+#include "tensorflow/tsl/framework/allocator.h"
+#include "tensorflow/tsl/framework/device_id.h"
+#include "tensorflow/tsl/platform/env.h"
+#include "tensorflow/tsl/platform/mem.h"
+#include "tensorflow/tsl/platform/test.h"
+#include "tensorflow/tsl/platform/threadpool.h"
+
+#if CUDA_VERSION >= 11020
+
+namespace stream_executor {
+namespace {
+
+constexpr size_t kAlignment = tsl::Allocator::kAllocatorAlignment;
+constexpr size_t kPoolSize = 1 << 26;
+
+// Stands in for an allocator of memory reserved up front. It returns small
+// host buffers, which the tests never access.
+class HostFallbackAllocator : public tsl::Allocator {
+ public:
+  std::string Name() override { return "host_fallback"; }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    ++num_allocs;
+    return tsl::port::AlignedMalloc(1024, kAlignment);
+  }
+  void DeallocateRaw(void* ptr) override {
+    ++num_deallocs;
+    tsl::port::AlignedFree(ptr);
+  }
+
+  int num_allocs = 0;
+  int num_deallocs = 0;
+};
+
+class GpuCudaMallocAsyncAllocatorTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    stream_exec_ = DeviceIdUtil::ExecutorForPlatformDeviceId(
+                       GPUMachineManager(), tsl::PlatformDeviceId(0))
+                       .value();
+    int driver_version;
+    cuDriverGetVersion(&driver_version);
+    if (driver_version < 11020) {
+      GTEST_SKIP() << "Driver version too old: " << driver_version;
+    }
+    cuda::ScopedActivateExecutorContext scoped_activation{stream_exec_};
+    ASSERT_EQ(cuStreamCreate(&main_stream_, CU_STREAM_NON_BLOCKING),
+              CUDA_SUCCESS);
+    ASSERT_EQ(cuStreamCreate(&other_stream_, CU_STREAM_NON_BLOCKING),
+              CUDA_SUCCESS);
+  }
+
+  void TearDown() override {
+    cuda::ScopedActivateExecutorContext scoped_activation{stream_exec_};
+    if (main_stream_ != nullptr) cuStreamDestroy(main_stream_);
+    if (other_stream_ != nullptr) cuStreamDestroy(other_stream_);
+  }
+
+  // Creates an allocator whose main stream is main_stream_ and that can also
+  // allocate on other_stream_.
+  std::unique_ptr<GpuCudaMallocAsyncAllocator> CreateAllocator(
+      const GpuCudaMallocAsyncAllocator::Options& options) {
+    auto allocator = std::make_unique<GpuCudaMallocAsyncAllocator>(
+        tsl::PlatformDeviceId(0), kPoolSize, /*reserve_memory=*/false,
+        /*compute_stats=*/true, options);
+    allocator->SetStreamAndPreallocateMemory(&main_stream_);
+    allocator->AddStream(&other_stream_);
+    return allocator;
+  }
+
+  void Synchronize() {
+    cuda::ScopedActivateExecutorContext scoped_activation{stream_exec_};
+    ASSERT_EQ(cuStreamSynchronize(main_stream_), CUDA_SUCCESS);
+    ASSERT_EQ(cuStreamSynchronize(other_stream_), CUDA_SUCCESS);
+  }
+
+  StreamExecutor* stream_exec_ = nullptr;
+  CUstream main_stream_ = nullptr;
+  CUstream other_stream_ = nullptr;
+};
+
+TEST_F(GpuCudaMallocAsyncAllocatorTest, AllocateOnOtherStreams) {
+  for (bool pool_per_stream : {false, true}) {
+    GpuCudaMallocAsyncAllocator::Options options;
+    options.pool_per_stream = pool_per_stream;
+    auto allocator = CreateAllocator(options);
+
+    void* main_ptr = allocator->AllocateRaw(kAlignment, 256);
+    void* other_ptr = allocator->AllocateRawOnStream(
+        kAlignment, 512, &other_stream_);
+    ASSERT_NE(main_ptr, nullptr);
+    ASSERT_NE(other_ptr, nullptr);
+    EXPECT_EQ(allocator->GetStats()->bytes_in_use, 768);
+
+    // Each buffer is also used on the stream it wasn't allocated on.
+    {
+      cuda::ScopedActivateExecutorContext scoped_activation{stream_exec_};
+      ASSERT_EQ(cuMemsetD8Async(reinterpret_cast<CUdeviceptr>(main_ptr), 1,
+                                256, other_stream_),
+                CUDA_SUCCESS);
+      ASSERT_EQ(cuMemsetD8Async(reinterpret_cast<CUdeviceptr>(other_ptr), 2,
+                                512, main_stream_),
+                CUDA_SUCCESS);
+    }
+    allocator->RecordStreamUse(main_ptr, &other_stream_);
+    allocator->RecordStreamUse(other_ptr, &main_stream_);
+    // Recording the stream a buffer was allocated on is a no-op.
+    allocator->RecordStreamUse(other_ptr, &other_stream_);
+    allocator->DeallocateRaw(main_ptr);
+    allocator->DeallocateRaw(other_ptr);
+    Synchronize();
+    EXPECT_EQ(allocator->GetStats()->bytes_in_use, 0);
+    EXPECT_EQ(allocator->GetStats()->num_allocs, 2);
+  }
+}
+
+TEST_F(GpuCudaMallocAsyncAllocatorTest, ConcurrentAllocationsOnTwoStreams) {
+  GpuCudaMallocAsyncAllocator::Options options;
+  options.pool_per_stream = true;
+  auto allocator = CreateAllocator(options);
+
+  constexpr int kIterations = 1000;
+  {
+    tsl::thread::ThreadPool pool(tsl::Env::Default(), "test", 3);
+    pool.Schedule([&]() {
+      for (int i = 0; i < kIterations; ++i) {
+        void* ptr = allocator->AllocateRaw(kAlignment, 64);
+        ASSERT_NE(ptr, nullptr);
+        allocator->DeallocateRaw(ptr);
+      }
+    });
+    pool.Schedule([&]() {
+      for (int i = 0; i < kIterations; ++i) {
+        void* ptr = allocator->AllocateRawOnStream(
+            kAlignment, 64, &other_stream_);
+        ASSERT_NE(ptr, nullptr);
+        allocator->DeallocateRaw(ptr);
+      }
+    });
+    pool.Schedule([&]() {
+      for (int i = 0; i < kIterations; ++i) {
+        void* ptr = allocator->AllocateRaw(kAlignment, 64);
+        ASSERT_NE(ptr, nullptr);
+        allocator->RecordStreamUse(ptr, &other_stream_);
+        allocator->DeallocateRaw(ptr);
+      }
+    });
+  }
+  Synchronize();
+  EXPECT_EQ(allocator->GetStats()->bytes_in_use, 0);
+  EXPECT_EQ(allocator->GetStats()->num_allocs, 3 * kIterations);
+}
+
+TEST_F(GpuCudaMallocAsyncAllocatorTest, ReleaseThresholdFollowsPeak) {
+  GpuCudaMallocAsyncAllocator::Options options;
+  options.pool_per_stream = true;
+  options.release_threshold_peak_fraction = 0.5;
+  auto allocator = CreateAllocator(options);
+
+  constexpr size_t kSize = 1 << 20;
+  void* ptr = allocator->AllocateRaw(kAlignment, kSize);
+  ASSERT_NE(ptr, nullptr);
+  allocator->DeallocateRaw(ptr);
+  Synchronize();
+  ASSERT_TRUE(allocator->ClearStats());
+
+  cuda::ScopedActivateExecutorContext scoped_activation{stream_exec_};
+  CUmemoryPool pool;
+  ASSERT_EQ(cuDeviceGetDefaultMemPool(&pool, 0), CUDA_SUCCESS);
+  uint64_t threshold = 0;
+  ASSERT_EQ(cuMemPoolGetAttribute(pool, CU_MEMPOOL_ATTR_RELEASE_THRESHOLD,
+                                  &threshold),
+            CUDA_SUCCESS);
+  EXPECT_EQ(threshold, kSize / 2);
+
+  // The next period had no allocation, so the threshold drops to zero.
+  ASSERT_TRUE(allocator->ClearStats());
+  ASSERT_EQ(cuMemPoolGetAttribute(pool, CU_MEMPOOL_ATTR_RELEASE_THRESHOLD,
+                                  &threshold),
+            CUDA_SUCCESS);
+  EXPECT_EQ(threshold, 0);
+}
+
+TEST_F(GpuCudaMallocAsyncAllocatorTest, FallbackOnlyOnMainStream) {
+  HostFallbackAllocator fallback;
+  GpuCudaMallocAsyncAllocator::Options options;
+  options.fallback_allocator = &fallback;
+  auto allocator = CreateAllocator(options);
+
+  int64_t free_memory, total_memory;
+  ASSERT_TRUE(stream_exec_->DeviceMemoryUsage(&free_memory, &total_memory));
+  const size_t too_large = 2 * total_memory;
+
+  void* ptr = allocator->AllocateRaw(kAlignment, too_large);
+  ASSERT_NE(ptr, nullptr);
+  EXPECT_EQ(fallback.num_allocs, 1);
+  // The fallback memory is only used on the main stream.
+  allocator->RecordStreamUse(ptr, &other_stream_);
+  allocator->DeallocateRaw(ptr);
+  EXPECT_EQ(fallback.num_deallocs, 1);
+
+  EXPECT_EQ(
+      allocator->AllocateRawOnStream(kAlignment, too_large, &other_stream_),
+      nullptr);
+  EXPECT_EQ(fallback.num_allocs, 1);
+  EXPECT_EQ(allocator->GetStats()->bytes_in_use, 0);
+}
+
+}  // namespace
+}  // namespace stream_executor
+
+#endif  // CUDA_VERSION >= 11020
+#endif  // GOOGLE_CUDA
@@ -311,6 +311,53 @@ struct FusedMHAScaleBiasSoftmaxOp {
   }
 };
 
+struct FusedMHAFlashScaleSoftmaxOp {
+  using Signature = FusedMHAFlashSignature;
+  struct Config {
+    double scale;
+    const MatmulTensorDescriptor& bmm1_lhs_descriptor;
+    const MatmulTensorDescriptor& bmm1_rhs_descriptor;
+    const MatmulTensorDescriptor& bmm2_rhs_descriptor;
+    const MatmulTensorDescriptor& intermediate_bmm2_lhs_descriptor;
+    const TensorDescriptor& output_descriptor;
+    const TensorDescriptor& softmax_stats_descriptor;
+  };
+
+  static tsl::StatusOr<std::unique_ptr<const OpRunner<FusedMHAFlashSignature>>>
+  RunnerFromAlgorithmDesc(const AlgorithmDesc& desc, Config config,
+                          Stream* stream) {
+    return stream->FusedMHAFlashScaleSoftmaxRunnerFromDesc(
+        desc, config.bmm1_lhs_descriptor, config.bmm1_rhs_descriptor,
+        config.bmm2_rhs_descriptor, config.intermediate_bmm2_lhs_descriptor,
+        config.output_descriptor, config.softmax_stats_descriptor,
+        config.scale);
+  }
+};
+
+struct FusedMHAFlashScaleSoftmaxBackwardOp {
+  using Signature = FusedMHAFlashBackwardSignature;
+  struct Config {
+    double scale;
+    const MatmulTensorDescriptor& bmm1_lhs_descriptor;
+    const MatmulTensorDescriptor& bmm1_rhs_descriptor;
+    const MatmulTensorDescriptor& bmm2_rhs_descriptor;
+    const MatmulTensorDescriptor& intermediate_bmm2_lhs_descriptor;
+    const TensorDescriptor& output_descriptor;
+    const TensorDescriptor& softmax_stats_descriptor;
+  };
+
+  static tsl::StatusOr<
+      std::unique_ptr<const OpRunner<FusedMHAFlashBackwardSignature>>>
+  RunnerFromAlgorithmDesc(const AlgorithmDesc& desc, Config config,
+                          Stream* stream) {
+    return stream->FusedMHAFlashScaleSoftmaxBackwardRunnerFromDesc(
+        desc, config.bmm1_lhs_descriptor, config.bmm1_rhs_descriptor,
+        config.bmm2_rhs_descriptor, config.intermediate_bmm2_lhs_descriptor,
+        config.output_descriptor, config.softmax_stats_descriptor,
+        config.scale);
+  }
+};
+
 }  // namespace dnn
 }  // namespace stream_executor
 
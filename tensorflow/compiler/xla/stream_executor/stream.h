@@ -540,6 +540,44 @@ class Stream {
         output_descriptor, bias_descriptor, scale, dropout_rate, seed);
   }
 
+  tsl::StatusOr<std::unique_ptr<const dnn::FusedMHAFlashRunner>>
+  FusedMHAFlashScaleSoftmaxRunnerFromDesc(
+      const dnn::AlgorithmDesc &algorithm_desc,
+      const dnn::MatmulTensorDescriptor &bmm1_lhs_descriptor,
+      const dnn::MatmulTensorDescriptor &bmm1_rhs_descriptor,
+      const dnn::MatmulTensorDescriptor &bmm2_rhs_descriptor,
+      const dnn::MatmulTensorDescriptor &intermediate_bmm2_lhs_descriptor,
+      const dnn::TensorDescriptor &output_descriptor,
+      const dnn::TensorDescriptor &softmax_stats_descriptor, double scale) {
+    dnn::DnnSupport *dnn_support = parent_->AsDnn();
+    if (!dnn_support) {
+      return tsl::errors::Unimplemented("DNN library is not found.");
+    }
+    return dnn_support->FusedMHAFlashScaleSoftmaxRunnerFromDesc(
+        this, algorithm_desc, bmm1_lhs_descriptor, bmm1_rhs_descriptor,
+        bmm2_rhs_descriptor, intermediate_bmm2_lhs_descriptor,
+        output_descriptor, softmax_stats_descriptor, scale);
+  }
+
+  tsl::StatusOr<std::unique_ptr<const dnn::FusedMHAFlashBackwardRunner>>
+  FusedMHAFlashScaleSoftmaxBackwardRunnerFromDesc(
+      const dnn::AlgorithmDesc &algorithm_desc,
+      const dnn::MatmulTensorDescriptor &bmm1_lhs_descriptor,
+      const dnn::MatmulTensorDescriptor &bmm1_rhs_descriptor,
+      const dnn::MatmulTensorDescriptor &bmm2_rhs_descriptor,
+      const dnn::MatmulTensorDescriptor &intermediate_bmm2_lhs_descriptor,
+      const dnn::TensorDescriptor &output_descriptor,
+      const dnn::TensorDescriptor &softmax_stats_descriptor, double scale) {
+    dnn::DnnSupport *dnn_support = parent_->AsDnn();
+    if (!dnn_support) {
+      return tsl::errors::Unimplemented("DNN library is not found.");
+    }
+    return dnn_support->FusedMHAFlashScaleSoftmaxBackwardRunnerFromDesc(
+        this, algorithm_desc, bmm1_lhs_descriptor, bmm1_rhs_descriptor,
+        bmm2_rhs_descriptor, intermediate_bmm2_lhs_descriptor,
+        output_descriptor, softmax_stats_descriptor, scale);
+  }
+
   Stream &ThenSeparableConvolve(
       const dnn::BatchDescriptor &input_descriptor,
       const DeviceMemory<float> &input_data,
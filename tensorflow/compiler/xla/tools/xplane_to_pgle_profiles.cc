@@ -0,0 +1,158 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/tools/xplane_to_pgle_profiles.h"
+
+#include <string>
+#include <vector>
+
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/compiler/xla/service/hlo.pb.h"
+#include "tensorflow/compiler/xla/util.h"
+#include "tensorflow/tsl/platform/env.h"
+#include "tensorflow/tsl/platform/errors.h"
+#include "tensorflow/tsl/platform/logging.h"
+#include "tensorflow/tsl/platform/path.h"
+#include "tensorflow/tsl/profiler/convert/xla_op_utils.h"
+#include "tensorflow/tsl/profiler/convert/xplane_to_profile_instructions.h"
+#include "tensorflow/tsl/profiler/protobuf/profiled_instructions.pb.h"
+#include "tensorflow/tsl/profiler/utils/tf_xplane_visitor.h"
+#include "tensorflow/tsl/profiler/utils/xplane_schema.h"
+#include "tensorflow/tsl/profiler/utils/xplane_utils.h"
+
+namespace xla {
+namespace tools {
+namespace {
+
+// Must match kFingerprintBeforeLHS in service/gpu/gpu_hlo_schedule.h.
+constexpr char kFingerprintAttribute[] = "fingerprint_before_lhs";
+
+constexpr char kXPlanePb[] = "xplane.pb";
+
+// Returns the fingerprint tagged on the root instruction of the entry
+// computation of `hlo_module`, or an empty string.
+std::string GetFingerprint(const HloModuleProto& hlo_module) {
+  for (const HloComputationProto& computation : hlo_module.computations()) {
+    if (computation.id() != hlo_module.entry_computation_id()) continue;
+    for (const HloInstructionProto& instruction : computation.instructions()) {
+      if (instruction.id() != computation.root_id()) continue;
+      auto it = instruction.frontend_attributes().map().find(
+          kFingerprintAttribute);
+      if (it != instruction.frontend_attributes().map().end()) {
+        return it->second;
+      }
+    }
+  }
+  return "";
+}
+
+}  // namespace
+
+absl::flat_hash_map<std::string, std::string> GetModuleFingerprints(
+    const tensorflow::profiler::XSpace& xspace) {
+  absl::flat_hash_map<std::string, std::string> fingerprints;
+  const tsl::profiler::XPlane* raw_plane = tsl::profiler::FindPlaneWithName(
+      xspace, tsl::profiler::kMetadataPlaneName);
+  if (raw_plane == nullptr) return fingerprints;
+  tsl::profiler::XPlaneVisitor plane =
+      tsl::profiler::CreateTfXPlaneVisitor(raw_plane);
+  const tsl::profiler::XStatMetadata* hlo_proto_stat_metadata =
+      plane.GetStatMetadataByType(tsl::profiler::StatType::kHloProto);
+  if (hlo_proto_stat_metadata == nullptr) return fingerprints;
+  plane.ForEachEventMetadata(
+      [&](const tsl::profiler::XEventMetadataVisitor& event_metadata) {
+        auto hlo_proto_stat = event_metadata.GetStat(
+            tsl::profiler::StatType::kHloProto, *hlo_proto_stat_metadata);
+        if (!hlo_proto_stat ||
+            hlo_proto_stat->ValueCase() != tsl::profiler::XStat::kBytesValue) {
+          return;
+        }
+        HloProto hlo_proto;
+        absl::string_view bytes = hlo_proto_stat->BytesValue();
+        if (!hlo_proto.ParseFromArray(bytes.data(), bytes.size())) return;
+        std::string fingerprint = GetFingerprint(hlo_proto.hlo_module());
+        if (fingerprint.empty()) return;
+        const std::string& name = hlo_proto.hlo_module().name();
+        fingerprints[tsl::profiler::HloModuleNameWithProgramId(
+            name, event_metadata.Id())] = fingerprint;
+        fingerprints[name] = fingerprint;
+      });
+  return fingerprints;
+}
+
+Status UpdatePgleProfiles(absl::Span<const std::string> logdirs,
+                          const std::string& output_dir) {
+  tsl::Env* env = tsl::Env::Default();
+  // The latencies of the instructions of each module, across all runs and
+  // hosts, keyed by the fingerprint of the module.
+  absl::flat_hash_map<std::string, tsl::profiler::ModuleLatencyInfo>
+      latency_info_by_fingerprint;
+  for (const std::string& logdir : logdirs) {
+    std::vector<std::string> children;
+    TF_RETURN_IF_ERROR(env->GetChildren(logdir, &children));
+    for (const std::string& child : children) {
+      if (!absl::StrContains(child, kXPlanePb)) continue;
+      tensorflow::profiler::XSpace xspace;
+      TF_RETURN_IF_ERROR(
+          tsl::ReadBinaryProto(env, tsl::io::JoinPath(logdir, child), &xspace));
+      absl::flat_hash_map<std::string, std::string> fingerprints =
+          GetModuleFingerprints(xspace);
+      absl::flat_hash_map<std::string, tsl::profiler::ModuleLatencyInfo>
+          latency_info;
+      tsl::profiler::AddXSpaceLatencyInfo(xspace, &latency_info);
+      for (auto& [module, module_latency_info] : latency_info) {
+        auto it = fingerprints.find(module);
+        if (it == fingerprints.end()) {
+          LOG(WARNING) << "Skipping the instructions of module '" << module
+                       << "' in " << child << ", which has no fingerprint";
+          continue;
+        }
+        tsl::profiler::ModuleLatencyInfo& aggregated =
+            latency_info_by_fingerprint[it->second];
+        for (auto& [hlo, hlo_latency_info] : module_latency_info) {
+          std::vector<double>& durations = aggregated[hlo].durations;
+          durations.insert(durations.end(), hlo_latency_info.durations.begin(),
+                           hlo_latency_info.durations.end());
+        }
+      }
+    }
+  }
+
+  TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(output_dir));
+  for (const auto& [fingerprint, latency_info] : latency_info_by_fingerprint) {
+    const std::string path =
+        tsl::io::JoinPath(output_dir, absl::StrCat(fingerprint, ".pbtxt"));
+    tensorflow::profiler::ProfiledInstructionsProto profile;
+    if (env->FileExists(path).ok()) {
+      TF_RETURN_IF_ERROR(tsl::ReadTextProto(env, path, &profile));
+      if (profile.version() > tsl::profiler::kProfiledInstructionsVersion) {
+        return FailedPrecondition(
+            "Profile %s has version %d, newer than the supported version %d",
+            path, profile.version(),
+            tsl::profiler::kProfiledInstructionsVersion);
+      }
+    }
+    tsl::profiler::MergeIntoProfiledInstructionsProto(latency_info, &profile);
+    profile.set_fingerprint(fingerprint);
+    TF_RETURN_IF_ERROR(tsl::WriteTextProto(env, path, profile));
+    VLOG(1) << "Updated " << latency_info.size() << " instruction costs in "
+            << path;
+  }
+  return OkStatus();
+}
+
+}  // namespace tools
+}  // namespace xla
@@ -0,0 +1,49 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_TOOLS_XPLANE_TO_PGLE_PROFILES_H_
+#define TENSORFLOW_COMPILER_XLA_TOOLS_XPLANE_TO_PGLE_PROFILES_H_
+
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/types/span.h"
+#include "tensorflow/compiler/xla/status.h"
+#include "tensorflow/tsl/profiler/protobuf/xplane.pb.h"
+
+namespace xla {
+namespace tools {
+
+// Returns the fingerprints before scheduling of the HLO modules whose
+// HloProto is in the metadata plane of `xspace`, as tagged on their root
+// instruction by the GPU compiler. They are keyed by the module name followed
+// by the program id in parentheses, and by the plain module name, which are
+// the names the device events refer to their module by.
+absl::flat_hash_map<std::string, std::string> GetModuleFingerprints(
+    const tensorflow::profiler::XSpace& xspace);
+
+// Aggregates the latencies of the HLO instructions in the xplane.pb files of
+// each of `logdirs` per module fingerprint, and merges them into the profiles
+// `<output_dir>/<fingerprint>.pbtxt`, creating them if needed. Pointing
+// --xla_gpu_pgle_profile_file_or_directory_path at `output_dir` makes the
+// latency hiding scheduler use them when the modules are recompiled.
+// Instructions of modules without a fingerprint are skipped.
+Status UpdatePgleProfiles(absl::Span<const std::string> logdirs,
+                          const std::string& output_dir);
+
+}  // namespace tools
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_TOOLS_XPLANE_TO_PGLE_PROFILES_H_
@@ -0,0 +1,56 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Usage:
+//   xplane_to_pgle_profiles --logdirs=run1,run2 --output_dir=profiles
+//
+// Aggregates the HLO instruction latencies of the profiles captured in the
+// given run directories, which hold the <host>.xplane.pb files written by the
+// profiler, into one profile per HLO module under --output_dir. Profiles of
+// later runs are merged into the existing ones. The GPU compiler uses them
+// when run with
+//
+//   --xla_gpu_pgle_profile_file_or_directory_path=profiles
+
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_split.h"
+#include "tensorflow/compiler/xla/tools/xplane_to_pgle_profiles.h"
+#include "tensorflow/tsl/platform/init_main.h"
+#include "tensorflow/tsl/platform/logging.h"
+#include "tensorflow/tsl/util/command_line_flags.h"
+
+int main(int argc, char** argv) {
+  std::string logdirs, output_dir;
+  const std::vector<tsl::Flag> flag_list = {
+      tsl::Flag("logdirs", &logdirs,
+                "Comma separated run directories holding xplane.pb files."),
+      tsl::Flag("output_dir", &output_dir,
+                "Directory of the profiles to create or update."),
+  };
+  const std::string usage = tsl::Flags::Usage(argv[0], flag_list);
+  bool parse_ok = tsl::Flags::Parse(&argc, argv, flag_list);
+  tsl::port::InitMain(usage.c_str(), &argc, &argv);
+  QCHECK(parse_ok && argc == 1) << "\n" << usage;
+
+  QCHECK(!logdirs.empty()) << "--logdirs is required";
+  QCHECK(!output_dir.empty()) << "--output_dir is required";
+
+  const std::vector<std::string> logdir_list =
+      absl::StrSplit(logdirs, ',', absl::SkipEmpty());
+  TF_CHECK_OK(xla::tools::UpdatePgleProfiles(logdir_list, output_dir));
+  return 0;
+}
@@ -0,0 +1,148 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/tools/xplane_to_pgle_profiles.h"
+
+#include <string>
+
+#include <gtest/gtest.h>
+#include "tensorflow/compiler/xla/service/hlo.pb.h"
+#include "tensorflow/tsl/lib/core/status_test_util.h"
+#include "tensorflow/tsl/platform/env.h"
+#include "tensorflow/tsl/platform/path.h"
+#include "tensorflow/tsl/platform/test.h"
+#include "tensorflow/tsl/profiler/convert/xplane_to_profile_instructions.h"
+#include "tensorflow/tsl/profiler/protobuf/profiled_instructions.pb.h"
+#include "tensorflow/tsl/profiler/utils/xplane_builder.h"
+#include "tensorflow/tsl/profiler/utils/xplane_schema.h"
+
+namespace xla {
+namespace tools {
+namespace {
+
+using tensorflow::profiler::XSpace;
+using tsl::profiler::GetStatTypeStr;
+using tsl::profiler::StatType;
+using tsl::profiler::XPlaneBuilder;
+
+constexpr int64_t kProgramId = 7;
+
+// Returns an XSpace with the HloProto of module "train" in its metadata plane,
+// tagged with `fingerprint`, and one execution of its "fusion" instruction
+// taking `fusion_ns`.
+XSpace CreateXSpace(const std::string& fingerprint, int64_t fusion_ns) {
+  HloProto hlo_proto;
+  HloModuleProto* module = hlo_proto.mutable_hlo_module();
+  module->set_name("train");
+  module->set_entry_computation_id(1);
+  HloComputationProto* computation = module->add_computations();
+  computation->set_id(1);
+  computation->set_root_id(2);
+  HloInstructionProto* root = computation->add_instructions();
+  root->set_id(2);
+  (*root->mutable_frontend_attributes()
+        ->mutable_map())["fingerprint_before_lhs"] = fingerprint;
+
+  XSpace xspace;
+  XPlaneBuilder metadata_plane(xspace.add_planes());
+  metadata_plane.SetName(tsl::profiler::kMetadataPlaneName);
+  tsl::profiler::XEventMetadata* event_metadata =
+      metadata_plane.GetOrCreateEventMetadata(kProgramId);
+  event_metadata->set_name("train(7)");
+  tsl::profiler::XStatsBuilder<tsl::profiler::XEventMetadata>(event_metadata,
+                                                              &metadata_plane)
+      .AddStatValue(*metadata_plane.GetOrCreateStatMetadata(
+                        GetStatTypeStr(StatType::kHloProto)),
+                    hlo_proto);
+
+  XPlaneBuilder device_plane(xspace.add_planes());
+  device_plane.SetName(tsl::profiler::GpuPlaneName(0));
+  tsl::profiler::XEventBuilder event =
+      device_plane.GetOrCreateLine(0).AddEvent(
+          *device_plane.GetOrCreateEventMetadata("kernel"));
+  event.SetDurationNs(fusion_ns);
+  event.AddStatValue(
+      *device_plane.GetOrCreateStatMetadata(GetStatTypeStr(StatType::kHloOp)),
+      *device_plane.GetOrCreateStatMetadata("fusion"));
+  event.AddStatValue(*device_plane.GetOrCreateStatMetadata(
+                         GetStatTypeStr(StatType::kHloModule)),
+                     *device_plane.GetOrCreateStatMetadata("train"));
+  event.AddStatValue(*device_plane.GetOrCreateStatMetadata(
+                         GetStatTypeStr(StatType::kProgramId)),
+                     kProgramId);
+  // An instruction of a module that was not profiled with its HloProto.
+  tsl::profiler::XEventBuilder other_event =
+      device_plane.GetOrCreateLine(0).AddEvent(
+          *device_plane.GetOrCreateEventMetadata("other_kernel"));
+  other_event.SetDurationNs(1000);
+  other_event.AddStatValue(
+      *device_plane.GetOrCreateStatMetadata(GetStatTypeStr(StatType::kHloOp)),
+      *device_plane.GetOrCreateStatMetadata("convolution"));
+  other_event.AddStatValue(*device_plane.GetOrCreateStatMetadata(
+                               GetStatTypeStr(StatType::kHloModule)),
+                           *device_plane.GetOrCreateStatMetadata("other"));
+  return xspace;
+}
+
+TEST(XplaneToPgleProfilesTest, GetModuleFingerprints) {
+  auto fingerprints = GetModuleFingerprints(CreateXSpace("abc", 1000));
+  EXPECT_EQ(fingerprints.size(), 2);
+  EXPECT_EQ(fingerprints["train(7)"], "abc");
+  EXPECT_EQ(fingerprints["train"], "abc");
+}
+
+TEST(XplaneToPgleProfilesTest, AggregatesRunsPerFingerprint) {
+  tsl::Env* env = tsl::Env::Default();
+  const std::string root = tsl::io::JoinPath(
+      tsl::testing::TmpDir(), "xplane_to_pgle_profiles_test");
+  const std::string run1 = tsl::io::JoinPath(root, "run1");
+  const std::string run2 = tsl::io::JoinPath(root, "run2");
+  const std::string output_dir = tsl::io::JoinPath(root, "profiles");
+  TF_ASSERT_OK(env->RecursivelyCreateDir(run1));
+  TF_ASSERT_OK(env->RecursivelyCreateDir(run2));
+  TF_ASSERT_OK(tsl::WriteBinaryProto(env,
+                                     tsl::io::JoinPath(run1, "h0.xplane.pb"),
+                                     CreateXSpace("abc", 10000)));
+  TF_ASSERT_OK(tsl::WriteBinaryProto(env,
+                                     tsl::io::JoinPath(run2, "h0.xplane.pb"),
+                                     CreateXSpace("abc", 20000)));
+
+  TF_ASSERT_OK(UpdatePgleProfiles({run1, run2}, output_dir));
+  tensorflow::profiler::ProfiledInstructionsProto profile;
+  const std::string path = tsl::io::JoinPath(output_dir, "abc.pbtxt");
+  TF_ASSERT_OK(tsl::ReadTextProto(env, path, &profile));
+  EXPECT_EQ(profile.version(), tsl::profiler::kProfiledInstructionsVersion);
+  EXPECT_EQ(profile.fingerprint(), "abc");
+  ASSERT_EQ(profile.costs_size(), 1);
+  EXPECT_EQ(profile.costs(0).name(), "fusion");
+  EXPECT_EQ(profile.costs(0).cost_us(), 15);
+  EXPECT_EQ(profile.costs(0).num_samples(), 2);
+
+  // A later run is merged into the existing profile.
+  TF_ASSERT_OK(UpdatePgleProfiles({run1}, output_dir));
+  TF_ASSERT_OK(tsl::ReadTextProto(env, path, &profile));
+  ASSERT_EQ(profile.costs_size(), 1);
+  EXPECT_NEAR(profile.costs(0).cost_us(), 40.0 / 3, 1e-9);
+  EXPECT_EQ(profile.costs(0).num_samples(), 3);
+
+  // Profiles written by newer versions are not overwritten.
+  profile.set_version(tsl::profiler::kProfiledInstructionsVersion + 1);
+  TF_ASSERT_OK(tsl::WriteTextProto(env, path, profile));
+  EXPECT_FALSE(UpdatePgleProfiles({run1}, output_dir).ok());
+}
+
+}  // namespace
+}  // namespace tools
+}  // namespace xla
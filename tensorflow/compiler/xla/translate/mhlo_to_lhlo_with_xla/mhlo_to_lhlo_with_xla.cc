@@ -924,6 +924,10 @@ tsl::StatusOr<lmhlo_gpu::FusedMhaDagSignature> AsLhloFusedMhaDagSignature(
       return lmhlo_gpu::FusedMhaDagSignature::ScaleBiasSoftmax;
     case xla::gpu::CudnnfMHAKind::kScaleBiasSoftmaxDropout:
       return lmhlo_gpu::FusedMhaDagSignature::ScaleBiasSoftmaxDropout;
+    case xla::gpu::CudnnfMHAKind::kFlashScaleSoftmax:
+      return lmhlo_gpu::FusedMhaDagSignature::FlashScaleSoftmax;
+    case xla::gpu::CudnnfMHAKind::kFlashScaleSoftmaxBackward:
+      return lmhlo_gpu::FusedMhaDagSignature::FlashScaleSoftmaxBackward;
     default:
       return xla::InternalError("unknown cudnn fmha kind");
   }
@@ -1433,6 +1437,31 @@ tsl::StatusOr<Operation*> LhloDialectEmitter::EmitDnnfMHA(
           builder_.getF64FloatAttr(config.fmha_scale()));
       return set_common_fmha_attributes(fmha_bias_softmax);
     }
+    case xla::gpu::CudnnfMHAKind::kFlashScaleSoftmax: {
+      // The result tuple is (output, softmax_stats, scratch).
+      TF_RETURN_IF_ERROR(GetOrCreateView(custom_call, &operands));
+      auto fmha_flash =
+          CreateOpWithoutAttrs<lmhlo_gpu::fusedMHAFlashOp>(custom_call,
+                                                           operands);
+      fmha_flash.setFmhaScaleAttr(
+          builder_.getF64FloatAttr(config.fmha_scale()));
+      return set_common_fmha_attributes(fmha_flash);
+    }
+    case xla::gpu::CudnnfMHAKind::kFlashScaleSoftmaxBackward: {
+      // The operands are followed by the forward output, the softmax
+      // statistics and the gradient of the output, and the result tuple is
+      // (d_lhs_bmm1, d_rhs_bmm1, d_rhs_bmm2, scratch).
+      TF_RETURN_IF_ERROR(GetOrCreateView(custom_call->operand(3), &operands));
+      TF_RETURN_IF_ERROR(GetOrCreateView(custom_call->operand(4), &operands));
+      TF_RETURN_IF_ERROR(GetOrCreateView(custom_call->operand(5), &operands));
+      TF_RETURN_IF_ERROR(GetOrCreateView(custom_call, &operands));
+      auto fmha_flash_backward =
+          CreateOpWithoutAttrs<lmhlo_gpu::fusedMHAFlashBackwardOp>(custom_call,
+                                                                   operands);
+      fmha_flash_backward.setFmhaScaleAttr(
+          builder_.getF64FloatAttr(config.fmha_scale()));
+      return set_common_fmha_attributes(fmha_flash_backward);
+    }
   }
 }
 
@@ -699,6 +699,13 @@ void CollectiveParamResolverLocal::AssignCollectiveType(CollectiveParams* cp) {
       CollectiveRegistry::LookupParamResolverInstance("NcclReduce", &col_impl)
           .ok();
   cp->instance.impl_details.collective_name = GetCollectiveName(cp, use_nccl);
+  // A "hierarchical" hint selects the two-level all-reduce, which keeps most of
+  // the traffic within tasks and only exchanges one chunk per device across
+  // tasks.
+  if (!use_nccl && cp->instance.type == REDUCTION_COLLECTIVE &&
+      cp->instance.impl_details.communication_hint == "hierarchical") {
+    cp->instance.impl_details.collective_name = "HierarchicalReduce";
+  }
   VLOG(1) << "AssignCollectiveType "
           << cp->instance.impl_details.collective_name;
 }
@@ -1252,16 +1252,10 @@ Status ColocationGraph::GetDevicesForNode(
   if (DeviceNameUtils::HasSomeDetails(root_member.requested_device_name())) {
     // The root node has a (possibly partial) device
     // specification, so enumerate the physical devices that
-    // conform to it.
-    device_set_.FindMatchingDevices(root_member.requested_device_name(),
-                                    &devices);
-
-    if (!devices.empty()) {
-      // Filter devices into those that are compatible with the root
-      // node (and its children).
-      devices = FilterSupportedDevices(
-          devices, root_member.supported_device_types(), default_local_device_);
-    }
+    // conform to it and are compatible with the root node (and its
+    // children).
+    devices = GetSupportedDevices(&root_member.requested_device_name(),
+                                  root_member.supported_device_types());
 
     // Perform soft placement if allow_soft_placement_ is set.
     if (devices.empty() && allow_soft_placement_) {
@@ -1345,9 +1339,8 @@ Status ColocationGraph::GetDevicesForNode(
     if (device_set_.devices().empty()) {
       return errors::Internal("No devices are registered");
     }
-    devices = FilterSupportedDevices(device_set_.devices(),
-                                     root_member.supported_device_types(),
-                                     default_local_device_);
+    devices = GetSupportedDevices(/*requested_device_name=*/nullptr,
+                                  root_member.supported_device_types());
 
     if (devices.empty()) {
       return errors::InvalidArgument(
@@ -1364,6 +1357,33 @@ Status ColocationGraph::GetDevicesForNode(
   return OkStatus();
 }
 
+const std::vector<Device*>& ColocationGraph::GetSupportedDevices(
+    const DeviceNameUtils::ParsedName* requested_device_name,
+    const PrioritizedDeviceTypeVector& supported_device_types) {
+  string key = "*";
+  if (requested_device_name != nullptr) {
+    key = DeviceNameUtils::ParsedNameToString(*requested_device_name);
+  }
+  for (const auto& [device_type, priority] : supported_device_types) {
+    strings::StrAppend(&key, ";", device_type.type_string(), ":", priority);
+  }
+  auto [it, inserted] = supported_devices_cache_.try_emplace(std::move(key));
+  if (!inserted) return it->second;
+
+  if (requested_device_name == nullptr) {
+    it->second = FilterSupportedDevices(
+        device_set_.devices(), supported_device_types, default_local_device_);
+  } else {
+    std::vector<Device*> matching_devices;
+    device_set_.FindMatchingDevices(*requested_device_name, &matching_devices);
+    if (!matching_devices.empty()) {
+      it->second = FilterSupportedDevices(
+          matching_devices, supported_device_types, default_local_device_);
+    }
+  }
+  return it->second;
+}
+
 Status ColocationGraph::InitializeMembers() {
   for (Node* node : graph_.op_nodes()) {
     Status status = InitializeMember(*node, &members_[node->id()]);
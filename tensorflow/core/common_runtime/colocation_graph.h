@@ -19,6 +19,7 @@ limitations under the License.
 #include <unordered_map>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/strings/str_join.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/inspecting_placer.h"
@@ -356,6 +357,14 @@ class ColocationGraph {
 
   Status InitializeMembers();
 
+  // Returns the devices in `device_set_` that match `requested_device_name`,
+  // or all of them if it is null, filtered and sorted by
+  // FilterSupportedDevices(). Many colocation groups share the same
+  // constraints, so the results are cached.
+  const std::vector<Device*>& GetSupportedDevices(
+      const DeviceNameUtils::ParsedName* requested_device_name,
+      const PrioritizedDeviceTypeVector& supported_device_types);
+
   Status InitializeMemberWithAssignedDevice(const string& assigned_device_name,
                                             const string& node_type,
                                             Member* member);
@@ -384,6 +393,9 @@ class ColocationGraph {
   const bool allow_soft_placement_;
   const bool log_device_placement_;
 
+  // Results of GetSupportedDevices(), keyed by its arguments.
+  absl::flat_hash_map<string, std::vector<Device*>> supported_devices_cache_;
+
   TF_DISALLOW_COPY_AND_ASSIGN(ColocationGraph);
 };
 
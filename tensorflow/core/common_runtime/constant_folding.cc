@@ -687,13 +687,36 @@ Status ConstantFold(const ConstantFoldingOptions& opts,
     graph_runner.reset(nullptr);
   });
 
-  Status s =
-      graph_runner->Run(constant_graph.get(), function_library, {} /* inputs*/,
-                        tensors_to_fetch_names, &outputs);
-  if (!s.ok()) {
-    VLOG(1) << "Could not fetch constants: " << s;
-    *was_mutated = false;
-    return s;
+  std::string cache_key;
+  if (opts.cache != nullptr) {
+    GraphDef constant_graph_def;
+    constant_graph->ToGraphDef(&constant_graph_def);
+    std::vector<const NodeDef*> constant_nodes;
+    constant_nodes.reserve(constant_graph_def.node_size());
+    for (const NodeDef& node : constant_graph_def.node()) {
+      constant_nodes.push_back(&node);
+    }
+    cache_key = ConstantFoldingCache::ComputeKey(
+        constant_nodes, tensors_to_fetch_names,
+        partition_device ? partition_device->device_type() : DEVICE_CPU);
+  }
+
+  if (cache_key.empty() || !opts.cache->Lookup(cache_key, &outputs) ||
+      outputs.size() != tensors_to_fetch_names.size()) {
+    Status s = graph_runner->Run(constant_graph.get(), function_library,
+                                 {} /* inputs*/, tensors_to_fetch_names,
+                                 &outputs);
+    if (!s.ok()) {
+      VLOG(1) << "Could not fetch constants: " << s;
+      *was_mutated = false;
+      return s;
+    }
+    if (!cache_key.empty()) {
+      s = opts.cache->Insert(cache_key, outputs);
+      if (!s.ok()) {
+        LOG(WARNING) << "Could not cache folded constants: " << s;
+      }
+    }
   }
 
   // Fetch the constant tensors and replace the corresponding tensors in the
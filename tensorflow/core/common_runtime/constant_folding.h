@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_COMMON_RUNTIME_CONSTANT_FOLDING_H_
 
 #include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/constant_folding_cache.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/graph/graph.h"
@@ -49,6 +50,10 @@ struct ConstantFoldingOptions {
   // default id generator that monotonically increases is used if nullptr is
   // passed.
   ConstantFoldNameGenerator generate_new_name = nullptr;
+
+  // If not nullptr, the values of the folded subgraph are looked up in (and
+  // stored to) this cache instead of always being evaluated. Not owned.
+  ConstantFoldingCache* cache = nullptr;
 };
 
 // Perform constant folding optimization on "graph".
@@ -0,0 +1,225 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/constant_folding_cache.h"
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/op_def.pb.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/io/record_reader.h"
+#include "tensorflow/core/lib/io/record_writer.h"
+#include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/public/version.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+
+namespace {
+
+constexpr char kFileSuffix[] = ".tfcf";
+
+Fprint128 Combine(const Fprint128& fp, StringPiece s) {
+  return FingerprintCat128(fp, Fingerprint128(s));
+}
+
+// Fingerprints the parts of `node` that determine its value. The assigned and
+// requested devices are deliberately left out, since they differ between
+// replicas of the same model.
+Fprint128 FingerprintNode(const NodeDef& node, Fprint128 fp) {
+  fp = Combine(fp, node.name());
+  fp = Combine(fp, node.op());
+  for (const std::string& input : node.input()) {
+    fp = Combine(fp, input);
+  }
+  std::vector<std::pair<std::string, const AttrValue*>> attrs;
+  attrs.reserve(node.attr_size());
+  for (const auto& attr : node.attr()) {
+    attrs.emplace_back(attr.first, &attr.second);
+  }
+  std::sort(attrs.begin(), attrs.end());
+  std::string serialized;
+  for (const auto& attr : attrs) {
+    fp = Combine(fp, attr.first);
+    SerializeToStringDeterministic(*attr.second, &serialized);
+    fp = Combine(fp, serialized);
+  }
+  return fp;
+}
+
+}  // namespace
+
+constexpr char ConstantFoldingCache::kCacheDirEnvVar[];
+constexpr int64_t ConstantFoldingCache::kDefaultMaxEntryBytes;
+
+ConstantFoldingCache::ConstantFoldingCache(Env* env, std::string directory,
+                                           int64_t max_entry_bytes)
+    : env_(env),
+      directory_(std::move(directory)),
+      max_entry_bytes_(max_entry_bytes) {}
+
+ConstantFoldingCache* ConstantFoldingCache::Default() {
+  static ConstantFoldingCache* cache = []() -> ConstantFoldingCache* {
+    std::string directory;
+    Status s = ReadStringFromEnvVar(kCacheDirEnvVar, "", &directory);
+    if (!s.ok()) {
+      LOG(WARNING) << "Ignoring " << kCacheDirEnvVar << ": " << s;
+      return nullptr;
+    }
+    if (directory.empty()) return nullptr;
+    LOG(INFO) << "Caching constant folding results in " << directory;
+    return new ConstantFoldingCache(Env::Default(), directory);
+  }();
+  return cache;
+}
+
+std::string ConstantFoldingCache::ComputeKey(
+    absl::Span<const NodeDef* const> nodes,
+    absl::Span<const std::string> fetches, StringPiece device_type) {
+  std::vector<const NodeDef*> sorted(nodes.begin(), nodes.end());
+  std::sort(sorted.begin(), sorted.end(),
+            [](const NodeDef* a, const NodeDef* b) {
+              return a->name() < b->name();
+            });
+  Fprint128 fp = Fingerprint128(
+      absl::StrCat(TF_VERSION_STRING, "/", TF_GRAPH_DEF_VERSION));
+  for (const NodeDef* node : sorted) {
+    // Function bodies are not part of the key, so subgraphs that call
+    // functions are not cached.
+    const OpDef* op_def;
+    if (!OpRegistry::Global()->LookUpOpDef(node->op(), &op_def).ok()) {
+      return "";
+    }
+    fp = FingerprintNode(*node, fp);
+  }
+  fp = FingerprintCat128(fp, fetches.size());
+  for (const std::string& fetch : fetches) {
+    fp = Combine(fp, fetch);
+  }
+  fp = Combine(fp, device_type);
+  return absl::StrCat(absl::Hex(fp.high64, absl::kZeroPad16),
+                      absl::Hex(fp.low64, absl::kZeroPad16));
+}
+
+std::string ConstantFoldingCache::FilenameForKey(const std::string& key) const {
+  return io::JoinPath(directory_, absl::StrCat(key, kFileSuffix));
+}
+
+bool ConstantFoldingCache::Lookup(const std::string& key,
+                                  std::vector<Tensor>* outputs) const {
+  if (key.empty()) return false;
+  const std::string filename = FilenameForKey(key);
+  if (!env_->FileExists(filename).ok()) {
+    VLOG(2) << "Constant folding cache miss for " << key;
+    return false;
+  }
+  std::unique_ptr<RandomAccessFile> file;
+  Status s = env_->NewRandomAccessFile(filename, &file);
+  if (!s.ok()) {
+    LOG(WARNING) << "Could not open constant folding cache entry " << filename
+                 << ": " << s;
+    return false;
+  }
+  io::RecordReader reader(file.get());
+  uint64 offset = 0;
+  tstring record;
+  // The first record repeats the key, which guards against misplaced files.
+  s = reader.ReadRecord(&offset, &record);
+  if (!s.ok() || record != key) {
+    LOG(WARNING) << "Ignoring invalid constant folding cache entry "
+                 << filename;
+    return false;
+  }
+  std::vector<Tensor> tensors;
+  while (true) {
+    s = reader.ReadRecord(&offset, &record);
+    if (errors::IsOutOfRange(s)) break;
+    TensorProto proto;
+    if (!s.ok() || !proto.ParseFromString(record)) {
+      LOG(WARNING) << "Ignoring corrupted constant folding cache entry "
+                   << filename << ": " << s;
+      return false;
+    }
+    tensors.emplace_back();
+    if (proto.dtype() != DT_INVALID &&
+        !tensors.back().FromProto(cpu_allocator(), proto)) {
+      LOG(WARNING) << "Ignoring constant folding cache entry " << filename
+                   << " with an invalid tensor";
+      return false;
+    }
+  }
+  VLOG(1) << "Constant folding cache hit for " << key;
+  *outputs = std::move(tensors);
+  return true;
+}
+
+Status ConstantFoldingCache::Insert(const std::string& key,
+                                    const std::vector<Tensor>& outputs) {
+  if (key.empty()) {
+    return errors::InvalidArgument("Empty constant folding cache key");
+  }
+  int64_t total_bytes = 0;
+  for (const Tensor& t : outputs) {
+    if (t.IsInitialized()) total_bytes += t.TotalBytes();
+  }
+  if (total_bytes > max_entry_bytes_) {
+    VLOG(1) << "Not caching " << total_bytes << " bytes of folded constants";
+    return OkStatus();
+  }
+
+  TF_RETURN_IF_ERROR(env_->RecursivelyCreateDir(directory_));
+  const std::string filename = FilenameForKey(key);
+  // Write to a unique temporary file first, so that readers never observe a
+  // partially written entry.
+  const std::string tmp_filename = absl::StrCat(
+      filename, ".tmp.", absl::Hex(random::New64(), absl::kZeroPad16));
+  Status s = [&]() -> Status {
+    std::unique_ptr<WritableFile> file;
+    TF_RETURN_IF_ERROR(env_->NewWritableFile(tmp_filename, &file));
+    io::RecordWriter writer(file.get());
+    TF_RETURN_IF_ERROR(writer.WriteRecord(key));
+    std::string serialized;
+    for (const Tensor& t : outputs) {
+      TensorProto proto;
+      if (t.IsInitialized()) t.AsProtoTensorContent(&proto);
+      if (!proto.SerializeToString(&serialized)) {
+        return errors::Internal("Could not serialize folded tensor");
+      }
+      TF_RETURN_IF_ERROR(writer.WriteRecord(serialized));
+    }
+    TF_RETURN_IF_ERROR(writer.Close());
+    TF_RETURN_IF_ERROR(file->Close());
+    return env_->RenameFile(tmp_filename, filename);
+  }();
+  if (!s.ok()) {
+    env_->DeleteFile(tmp_filename).IgnoreError();
+    return s;
+  }
+  VLOG(1) << "Stored " << outputs.size() << " folded tensors under " << key;
+  return OkStatus();
+}
+
+}  // namespace tensorflow
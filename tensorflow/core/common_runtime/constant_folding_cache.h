@@ -0,0 +1,87 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_CONSTANT_FOLDING_CACHE_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_CONSTANT_FOLDING_CACHE_H_
+
+#include <string>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/stringpiece.h"
+
+namespace tensorflow {
+
+// A cache of constant-folding results that persists across processes.
+//
+// Loading the same model repeatedly (e.g. on every replica of a service)
+// re-evaluates the same constant subgraphs each time. This cache stores the
+// evaluated tensors in files under a directory, which may be on local disk or
+// on any filesystem supported by `Env` (including shared ones), so that later
+// loads can skip the evaluation.
+//
+// Entries are keyed by a fingerprint of the folded nodes, the requested
+// outputs, the device type, and the TensorFlow version. Each entry is written
+// to a temporary file and renamed into place, so concurrent writers and
+// readers only ever observe complete entries. Any failure to read or write an
+// entry is logged and treated as a cache miss.
+class ConstantFoldingCache {
+ public:
+  // Name of the environment variable that enables the default cache.
+  static constexpr char kCacheDirEnvVar[] = "TF_CONSTANT_FOLDING_CACHE_DIR";
+
+  // Entries whose tensors are larger than this in total are not stored.
+  static constexpr int64_t kDefaultMaxEntryBytes = 1LL << 30;
+
+  ConstantFoldingCache(Env* env, std::string directory,
+                       int64_t max_entry_bytes = kDefaultMaxEntryBytes);
+
+  // Returns the process-wide cache, stored under the directory named by
+  // `TF_CONSTANT_FOLDING_CACHE_DIR`, or nullptr if that variable is unset.
+  static ConstantFoldingCache* Default();
+
+  // Computes the cache key for evaluating `fetches` from the subgraph made of
+  // `nodes` on a device of type `device_type`. Returns an empty string if the
+  // subgraph cannot be cached, e.g. because it calls a function whose body is
+  // not part of the key.
+  static std::string ComputeKey(absl::Span<const NodeDef* const> nodes,
+                                absl::Span<const std::string> fetches,
+                                StringPiece device_type);
+
+  // Looks up `key`. On a hit, sets `*outputs` to the stored tensors and
+  // returns true. An uninitialized tensor stands for an output without a
+  // value (e.g. a dead output of a Switch).
+  bool Lookup(const std::string& key, std::vector<Tensor>* outputs) const;
+
+  // Stores `outputs` under `key`, replacing any existing entry.
+  Status Insert(const std::string& key, const std::vector<Tensor>& outputs);
+
+  const std::string& directory() const { return directory_; }
+
+ private:
+  std::string FilenameForKey(const std::string& key) const;
+
+  Env* const env_;
+  const std::string directory_;
+  const int64_t max_entry_bytes_;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_CONSTANT_FOLDING_CACHE_H_
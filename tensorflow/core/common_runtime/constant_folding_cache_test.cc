@@ -0,0 +1,150 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/constant_folding_cache.h"
+
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+NodeDef MakeConst(const string& name, const Tensor& value,
+                  const string& device = "") {
+  NodeDef def;
+  TF_CHECK_OK(NodeDefBuilder(name, "Const")
+                  .Attr("dtype", value.dtype())
+                  .Attr("value", value)
+                  .Device(device)
+                  .Finalize(&def));
+  return def;
+}
+
+NodeDef MakeAdd(const string& name, const string& x, const string& y) {
+  NodeDef def;
+  TF_CHECK_OK(NodeDefBuilder(name, "Add")
+                  .Input(x, 0, DT_FLOAT)
+                  .Input(y, 0, DT_FLOAT)
+                  .Finalize(&def));
+  return def;
+}
+
+class ConstantFoldingCacheTest : public ::testing::Test {
+ protected:
+  ConstantFoldingCacheTest()
+      : dir_(io::JoinPath(testing::TmpDir(),
+                          ::testing::UnitTest::GetInstance()
+                              ->current_test_info()
+                              ->name())),
+        cache_(Env::Default(), dir_) {}
+
+  std::string KeyFor(const std::vector<NodeDef>& nodes,
+                     const std::vector<std::string>& fetches,
+                     StringPiece device_type = "CPU") {
+    std::vector<const NodeDef*> ptrs;
+    for (const NodeDef& node : nodes) ptrs.push_back(&node);
+    return ConstantFoldingCache::ComputeKey(ptrs, fetches, device_type);
+  }
+
+  const std::string dir_;
+  ConstantFoldingCache cache_;
+};
+
+TEST_F(ConstantFoldingCacheTest, RoundTrip) {
+  const std::string key =
+      KeyFor({MakeConst("a", test::AsScalar<float>(1.0)),
+              MakeConst("b", test::AsScalar<float>(2.0)),
+              MakeAdd("c", "a", "b")},
+             {"c:0"});
+  ASSERT_FALSE(key.empty());
+  std::vector<Tensor> outputs;
+  EXPECT_FALSE(cache_.Lookup(key, &outputs));
+
+  // An uninitialized tensor stands for a dead output.
+  TF_ASSERT_OK(cache_.Insert(
+      key, {test::AsTensor<float>({3.0, 4.0}, {2}), Tensor(),
+            test::AsTensor<tstring>({"x"}, {1})}));
+  ASSERT_TRUE(cache_.Lookup(key, &outputs));
+  ASSERT_EQ(outputs.size(), 3);
+  test::ExpectTensorEqual<float>(outputs[0],
+                                 test::AsTensor<float>({3.0, 4.0}, {2}));
+  EXPECT_FALSE(outputs[1].IsInitialized());
+  test::ExpectTensorEqual<tstring>(outputs[2],
+                                   test::AsTensor<tstring>({"x"}, {1}));
+
+  // A second cache on the same directory, e.g. in another process, sees the
+  // entry too.
+  ConstantFoldingCache other(Env::Default(), dir_);
+  EXPECT_TRUE(other.Lookup(key, &outputs));
+}
+
+TEST_F(ConstantFoldingCacheTest, KeyDependsOnValuesFetchesAndDeviceType) {
+  const std::vector<NodeDef> graph = {
+      MakeConst("a", test::AsScalar<float>(1.0)),
+      MakeConst("b", test::AsScalar<float>(2.0)), MakeAdd("c", "a", "b")};
+  const std::string key = KeyFor(graph, {"c:0"});
+
+  std::vector<NodeDef> other_value = graph;
+  other_value[1] = MakeConst("b", test::AsScalar<float>(3.0));
+  EXPECT_NE(key, KeyFor(other_value, {"c:0"}));
+  EXPECT_NE(key, KeyFor(graph, {"a:0"}));
+  EXPECT_NE(key, KeyFor(graph, {"c:0"}, "GPU"));
+
+  // Node order and assigned devices do not matter.
+  std::vector<NodeDef> reordered = {graph[2], graph[0], graph[1]};
+  EXPECT_EQ(key, KeyFor(reordered, {"c:0"}));
+  std::vector<NodeDef> placed = graph;
+  placed[0] = MakeConst("a", test::AsScalar<float>(1.0),
+                        "/job:worker/replica:7/task:0/device:CPU:0");
+  EXPECT_EQ(key, KeyFor(placed, {"c:0"}));
+}
+
+TEST_F(ConstantFoldingCacheTest, FunctionCallsAreNotCached) {
+  NodeDef call;
+  call.set_name("f");
+  call.set_op("UserDefinedFunction");
+  EXPECT_TRUE(KeyFor({call}, {"f:0"}).empty());
+}
+
+TEST_F(ConstantFoldingCacheTest, CorruptedEntryIsAMiss) {
+  const std::string key =
+      KeyFor({MakeConst("a", test::AsScalar<float>(1.0))}, {"a:0"});
+  TF_ASSERT_OK(cache_.Insert(key, {test::AsScalar<float>(1.0)}));
+  std::vector<string> children;
+  TF_ASSERT_OK(Env::Default()->GetChildren(dir_, &children));
+  ASSERT_EQ(children.size(), 1);
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(),
+                                 io::JoinPath(dir_, children[0]), "garbage"));
+  std::vector<Tensor> outputs;
+  EXPECT_FALSE(cache_.Lookup(key, &outputs));
+}
+
+TEST_F(ConstantFoldingCacheTest, LargeEntriesAreNotStored) {
+  ConstantFoldingCache cache(Env::Default(), dir_, /*max_entry_bytes=*/16);
+  const std::string key =
+      KeyFor({MakeConst("a", test::AsScalar<float>(1.0))}, {"a:0"});
+  TF_ASSERT_OK(cache.Insert(key, {Tensor(DT_FLOAT, TensorShape({8}))}));
+  std::vector<Tensor> outputs;
+  EXPECT_FALSE(cache.Lookup(key, &outputs));
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -37,6 +37,7 @@ limitations under the License.
 #include "tensorflow/core/graph/node_builder.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/null_file_system.h"
 #include "tensorflow/core/platform/test.h"
@@ -134,6 +135,46 @@ TEST_F(ConstantFoldingTest, Basic) {
                          {2, 2});
 }
 
+TEST_F(ConstantFoldingTest, UsesCache) {
+  const string dir = io::JoinPath(testing::TmpDir(), "constant_folding_cache");
+  TF_ASSERT_OK(Env::Default()->RecursivelyCreateDir(dir));
+  ConstantFoldingCache cache(Env::Default(), dir);
+  ConstantFoldingOptions opts;
+  opts.cache = &cache;
+
+  auto fold = [this, &opts](std::vector<float> expected_s1) {
+    Scope s = Scope::NewRootScope();
+    BuildSimpleGraph(&s);
+    Graph g(OpRegistry::Global());
+    TF_ASSERT_OK(s.ToGraph(&g));
+    bool was_mutated;
+    TF_ASSERT_OK(
+        ConstantFold(opts, nullptr, Env::Default(), nullptr, &g, &was_mutated));
+    EXPECT_TRUE(was_mutated);
+    std::unordered_map<string, Node*> index = g.BuildNodeNameIndex();
+    ExpectNodeClose<float>(*(index.at("s1")->in_nodes().begin()),
+                           expected_s1, {2, 2});
+  };
+
+  // The first fold evaluates the subgraph and stores the results.
+  fold({1.0, 2.0, 3.0, 4.0});
+  std::vector<string> children;
+  TF_ASSERT_OK(Env::Default()->GetChildren(dir, &children));
+  ASSERT_EQ(children.size(), 1);
+  const string key(io::Basename(children[0]).substr(0, 32));
+
+  // Replace the stored values, so that a second fold that reads them can be
+  // told apart from one that evaluates the subgraph again.
+  std::vector<Tensor> outputs;
+  ASSERT_TRUE(cache.Lookup(key, &outputs));
+  ASSERT_EQ(outputs.size(), 2);
+  for (Tensor& t : outputs) {
+    t = test::AsTensor<float>({9.0, 9.0, 9.0, 9.0}, {2, 2});
+  }
+  TF_ASSERT_OK(cache.Insert(key, outputs));
+  fold({9.0, 9.0, 9.0, 9.0});
+}
+
 // Tests that different node creation ordering creates same graph after constant
 // folding.
 TEST_F(ConstantFoldingTest, DeterministicFolding) {
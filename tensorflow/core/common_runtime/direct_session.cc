@@ -63,6 +63,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/core/threadpool_options.h"
 #include "tensorflow/core/lib/gtl/array_slice.h"
+#include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/monitoring/counter.h"
 #include "tensorflow/core/lib/random/random.h"
 #include "tensorflow/core/lib/strings/numbers.h"
@@ -716,9 +717,16 @@ Status DirectSession::RunInternal(
 
   Status run_status;
 
+  // Plans that this step has started using; they are ended once all executors
+  // have completed.
+  std::vector<StaticMemoryPlan*> static_memory_plans;
+  auto end_static_memory_plans = gtl::MakeCleanup([&static_memory_plans]() {
+    for (StaticMemoryPlan* plan : static_memory_plans) plan->EndStep();
+  });
+
   auto set_threadpool_args_for_item =
-      [&default_runner, &handler](const PerPartitionExecutorsAndLib& item,
-                                  Executor::Args* args) {
+      [&default_runner, &handler, &static_memory_plans](
+          const PerPartitionExecutorsAndLib& item, Executor::Args* args) {
         // TODO(azaks): support partial run.
         // TODO(azaks): if the device picks its own threadpool, we need to
         // assign
@@ -738,6 +746,14 @@ Status DirectSession::RunInternal(
           args->user_intra_op_threadpool =
               handler->AsIntraThreadPoolInterface();
         }
+        args->step_allocator = nullptr;
+        if (item.static_memory_plan) {
+          // Returns nullptr if a concurrent step is using the plan.
+          args->step_allocator = item.static_memory_plan->BeginStep();
+          if (args->step_allocator != nullptr) {
+            static_memory_plans.push_back(item.static_memory_plan.get());
+          }
+        }
       };
 
   if (can_execute_synchronously) {
@@ -1424,6 +1440,7 @@ Status DirectSession::CreateExecutors(
       if (kernel && !OpSegment::ShouldOwnKernel(lib, kernel->type_string()))
         delete kernel;
     };
+    params.create_kernel_thread_pool = thread_pools_[0].first;
 
     optimizer.Optimize(lib, options_.env, device, &partition_graph,
                        GraphOptimizer::Options());
@@ -1445,6 +1462,11 @@ Status DirectSession::CreateExecutors(
     auto executor_type = options_.config.experimental().executor_type();
     TF_RETURN_IF_ERROR(
         NewExecutor(executor_type, params, *partition_graph, &item->executor));
+    if (callable_options.use_static_memory_plan() &&
+        device->device_type() == DEVICE_CPU) {
+      item->static_memory_plan.reset(
+          new StaticMemoryPlan(device->GetAllocator(AllocatorAttributes())));
+    }
     if (!options_.config.experimental().disable_output_partition_graphs() ||
         options_.config.graph_options().build_cost_model() > 0) {
       item->graph = std::move(partition_graph);
@@ -545,6 +545,58 @@ TEST_F(DirectSessionMinusAXTest, TestFeed_Callable) {
   EXPECT_FLOAT_EQ(39.0, mat(1, 0));
 }
 
+TEST_F(DirectSessionMinusAXTest, TestFeed_CallableWithStaticMemoryPlan) {
+  Initialize({1, 2, 3, 4});
+  auto session = CreateSession();
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+
+  CallableOptions callable_options =
+      MakeCallableOptions({x_}, {y_ + ":0", y_neg_ + ":0"}, {});
+  callable_options.set_use_static_memory_plan(true);
+  Session::CallableHandle handle;
+  TF_ASSERT_OK(session->MakeCallable(callable_options, &handle));
+
+  // Keep the outputs of every run alive, so that a buffer reused by a later
+  // run would show up as a wrong value.
+  std::vector<std::vector<Tensor>> all_outputs(20);
+  for (int i = 0; i < all_outputs.size(); ++i) {
+    Tensor t(DT_FLOAT, TensorShape({2, 1}));
+    t.matrix<float>()(0, 0) = i;
+    t.matrix<float>()(1, 0) = i + 1;
+    TF_ASSERT_OK(session->RunCallable(handle, {t}, &all_outputs[i], nullptr));
+  }
+  for (int i = 0; i < all_outputs.size(); ++i) {
+    ASSERT_EQ(2, all_outputs[i].size());
+    auto y = all_outputs[i][0].matrix<float>();
+    auto y_neg = all_outputs[i][1].matrix<float>();
+    EXPECT_FLOAT_EQ(1 * i + 2 * (i + 1), y(0, 0));
+    EXPECT_FLOAT_EQ(3 * i + 4 * (i + 1), y(1, 0));
+    EXPECT_FLOAT_EQ(-(1 * i + 2 * (i + 1)), y_neg(0, 0));
+    EXPECT_FLOAT_EQ(-(3 * i + 4 * (i + 1)), y_neg(1, 0));
+  }
+
+  // Concurrent runs do not share the plan.
+  thread::ThreadPool* tp = new thread::ThreadPool(Env::Default(), "test", 4);
+  auto fn = [&session, handle]() {
+    for (int i = 0; i < 100; ++i) {
+      Tensor t(DT_FLOAT, TensorShape({2, 1}));
+      t.matrix<float>()(0, 0) = 5;
+      t.matrix<float>()(1, 0) = 6;
+      std::vector<Tensor> outputs;
+      TF_ASSERT_OK(session->RunCallable(handle, {t}, &outputs, nullptr));
+      ASSERT_EQ(2, outputs.size());
+      EXPECT_FLOAT_EQ(17.0, outputs[0].matrix<float>()(0, 0));
+      EXPECT_FLOAT_EQ(-39.0, outputs[1].matrix<float>()(1, 0));
+    }
+  };
+  for (int i = 0; i < 4; ++i) {
+    tp->Schedule(fn);
+  }
+  delete tp;
+  TF_ASSERT_OK(session->ReleaseCallable(handle));
+}
+
 TEST_F(DirectSessionMinusAXTest, TestConcurrency) {
   Initialize({1, 2, 3, 4});
   auto session = CreateSession();
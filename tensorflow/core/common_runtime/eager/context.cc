@@ -452,7 +452,11 @@ void EagerContext::ClearCachesAndDefaultExecutor() {
     // during this time as well.
     mutex_lock ml(cache_mu_);
     default_executor_.WaitForAllPendingNodes().IgnoreError();
-    kernel_cache_.clear();
+    kernel_cache_generation_.fetch_add(1, std::memory_order_release);
+    for (KernelCacheShard& shard : kernel_cache_shards_) {
+      mutex_lock sl(shard.mu);
+      shard.kernels.clear();
+    }
     for (auto& entry : registered_functions_) {
       entry.second->cached_kernel_keys->clear();
     }
@@ -1032,7 +1036,11 @@ EagerContext::GetCacheStats() {
   CacheStats stats;
   {
     mutex_lock l(cache_mu_);
-    stats.kernel_cache_size = kernel_cache_.size();
+    stats.kernel_cache_size = 0;
+    for (KernelCacheShard& shard : kernel_cache_shards_) {
+      tf_shared_lock sl(shard.mu);
+      stats.kernel_cache_size += shard.kernels.size();
+    }
     for (const auto& iter : registered_functions_) {
       stats.func_kernel_cache_entries[iter.first] =
           iter.second->cached_kernel_keys->size();
@@ -1062,8 +1070,11 @@ Status EagerContext::RemoveFunction(const string& func) {
     }
     is_last_ref = registered_function->RefCountIsOne();
     if (is_last_ref) {
+      kernel_cache_generation_.fetch_add(1, std::memory_order_release);
       for (auto& key : *registered_function->cached_kernel_keys) {
-        kernel_cache_.erase(key);
+        KernelCacheShard& shard = GetKernelCacheShard(key);
+        mutex_lock sl(shard.mu);
+        shard.kernels.erase(key);
       }
       registered_functions_.erase(func);
     }
@@ -1146,9 +1157,10 @@ Status EagerContext::SyncExecutors() {
 
 core::RefCountPtr<KernelAndDevice> EagerContext::GetCachedKernel(
     Fprint128 cache_key) {
-  tf_shared_lock l(cache_mu_);
-  auto iter = kernel_cache_.find(cache_key);
-  if (iter == kernel_cache_.end()) {
+  KernelCacheShard& shard = GetKernelCacheShard(cache_key);
+  tf_shared_lock l(shard.mu);
+  auto iter = shard.kernels.find(cache_key);
+  if (iter == shard.kernels.end()) {
     return nullptr;
   }
   core::RefCountPtr<KernelAndDevice> new_ref(iter->second.get());
@@ -1168,7 +1180,11 @@ void EagerContext::AddKernelToCache(Fprint128 cache_key,
   mutex_lock ml(cache_mu_);
   core::RefCountPtr<KernelAndDevice> new_ref(kernel);
   new_ref->Ref();
-  kernel_cache_[cache_key] = std::move(new_ref);
+  {
+    KernelCacheShard& shard = GetKernelCacheShard(cache_key);
+    mutex_lock sl(shard.mu);
+    shard.kernels[cache_key] = std::move(new_ref);
+  }
   auto* registered_function =
       gtl::FindPtrOrNull(registered_functions_, kernel->name());
 
@@ -16,6 +16,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_COMMON_RUNTIME_EAGER_CONTEXT_H_
 
 #include <algorithm>
+#include <array>
 #include <atomic>
 #include <cstddef>
 #include <functional>
@@ -272,6 +273,13 @@ class EagerContext : public ImmediateExecutionContext, public core::RefCounted {
   core::RefCountPtr<KernelAndDevice> GetCachedKernel(Fprint128 cache_key);
   Device* GetCachedDevice(Fprint128 device_cache_key);
 
+  // Returns a counter that is incremented whenever kernels are removed from
+  // the kernel cache. Kernels cached outside of the context (e.g. by an
+  // EagerOperation) must only be reused while the generation is unchanged.
+  int64_t KernelCacheGeneration() const {
+    return kernel_cache_generation_.load(std::memory_order_acquire);
+  }
+
   void AddKernelToCache(Fprint128 cache_key, KernelAndDevice* kernel);
   void AddDeviceToCache(Fprint128 device_cache_key, Device* device);
 
@@ -762,9 +770,21 @@ class EagerContext : public ImmediateExecutionContext, public core::RefCounted {
 
     std::unique_ptr<std::vector<Fprint128>> cached_kernel_keys;
   };
-  std::unordered_map<Fprint128, core::RefCountPtr<KernelAndDevice>,
-                     Fprint128Hasher>
-      kernel_cache_ TF_GUARDED_BY(cache_mu_);
+  // The kernel cache is sharded by cache key, so that concurrent eager op
+  // dispatches on different threads don't all contend on the same lock. A
+  // shard's mutex is acquired after cache_mu_ when both are needed.
+  static constexpr int kNumKernelCacheShards = 16;
+  struct alignas(64) KernelCacheShard {
+    mutex mu;
+    std::unordered_map<Fprint128, core::RefCountPtr<KernelAndDevice>,
+                       Fprint128Hasher>
+        kernels TF_GUARDED_BY(mu);
+  };
+  KernelCacheShard& GetKernelCacheShard(const Fprint128& cache_key) {
+    return kernel_cache_shards_[cache_key.low64 % kNumKernelCacheShards];
+  }
+  std::array<KernelCacheShard, kNumKernelCacheShards> kernel_cache_shards_;
+  std::atomic<int64_t> kernel_cache_generation_{0};
   std::unordered_map<string, RegisteredFunction*> registered_functions_
       TF_GUARDED_BY(cache_mu_);
   absl::flat_hash_map<Fprint128, Device*, Fprint128Hasher> device_cache_
@@ -35,7 +35,8 @@ bool IsAsyncWaitForRemoteFunctionEnabled() {
 }  // namespace
 
 EagerExecutor::EagerExecutor(bool async, bool enable_streaming_enqueue,
-                             int in_flight_nodes_limit)
+                             int in_flight_nodes_limit,
+                             int num_parallel_threads)
     : next_node_id_(0),
       ok_(true),
       thread_(async ? tensorflow::Env::Default()->StartThread(
@@ -46,11 +47,20 @@ EagerExecutor::EagerExecutor(bool async, bool enable_streaming_enqueue,
       enable_async_wait_for_remote_function_(
           IsAsyncWaitForRemoteFunctionEnabled()),
       enable_streaming_enqueue_(enable_streaming_enqueue),
-      in_flight_nodes_limit_(in_flight_nodes_limit) {
+      in_flight_nodes_limit_(in_flight_nodes_limit),
+      parallel_pool_(async && num_parallel_threads > 0
+                         ? std::make_unique<thread::ThreadPool>(
+                               tensorflow::Env::Default(),
+                               "eager_parallel_executor", num_parallel_threads)
+                         : nullptr) {
   if (async && in_flight_nodes_limit_ > 0) {
     VLOG(4) << "EagerExecutor InFlightNodes limit is set to "
             << in_flight_nodes_limit_;
   }
+  if (parallel_pool_ != nullptr) {
+    VLOG(4) << "EagerExecutor dispatches independent nodes to "
+            << num_parallel_threads << " threads";
+  }
 }
 
 EagerExecutor::~EagerExecutor() {
@@ -148,6 +158,8 @@ Status EagerExecutor::AddOrExecute(std::unique_ptr<EagerNode> node) {
   if (!Async()) {
     // In sync mode, run the node item regardless of executor status.
     return RunItem(std::move(item), /*from_queue=*/false);
+  } else if (parallel_pool_ != nullptr) {
+    return AddParallel(std::move(item));
   } else {
     tensorflow::mutex_lock l(node_queue_mutex_);
     DVLOG(3) << "Add node [id " << item->id << "]" << item->node->DebugString()
@@ -166,22 +178,7 @@ Status EagerExecutor::AddOrExecute(std::unique_ptr<EagerNode> node) {
         if (node_queue_.size() == 1) {
           nodes_pending_.notify_all();
         }
-        if (in_flight_nodes_limit_ == 0) {
-          return OkStatus();
-        }
-        // Limit the concurrency by controlling the number of in flight nodes.
-        while (true) {
-          int64_t in_flight_nodes_count =
-              node_queue_.size() + unfinished_nodes_.size();
-          if (in_flight_nodes_count < in_flight_nodes_limit_) {
-            break;
-          }
-          VLOG(4) << "Hitting in-flight node limit node_queue_.size() = "
-                  << node_queue_.size()
-                  << " unfinished_nodes_.size() = " << unfinished_nodes_.size()
-                  << ".";
-          nodes_done_.wait(l);
-        }
+        WaitForInFlightNodesLocked(&l);
         return OkStatus();
       }
     }
@@ -195,6 +192,25 @@ Status EagerExecutor::AddOrExecute(std::unique_ptr<EagerNode> node) {
   return status;
 }
 
+void EagerExecutor::WaitForInFlightNodesLocked(mutex_lock* lock) {
+  if (in_flight_nodes_limit_ == 0) {
+    return;
+  }
+  // Limit the concurrency by controlling the number of in flight nodes.
+  while (true) {
+    int64_t in_flight_nodes_count =
+        node_queue_.size() + unfinished_nodes_.size();
+    if (in_flight_nodes_count < in_flight_nodes_limit_) {
+      break;
+    }
+    VLOG(4) << "Hitting in-flight node limit node_queue_.size() = "
+            << node_queue_.size()
+            << " unfinished_nodes_.size() = " << unfinished_nodes_.size()
+            << ".";
+    nodes_done_.wait(*lock);
+  }
+}
+
 tensorflow::Status EagerExecutor::WaitForAllPendingNodes() {
   tensorflow::mutex_lock l(node_queue_mutex_);
   return WaitForAllPendingNodesLocked(&l);
@@ -278,24 +294,7 @@ void EagerExecutor::NodeDone(const core::RefCountPtr<NodeItem>& item,
     if (!status.ok() && item->node->Fatal()) {
       // Since we received an error, broadcast to any waiters.
       need_notification = true;
-      status_ = status;
-      ok_ = false;
-      if (Async()) {
-        // We remove any pending ops so that we don't try to execute them if
-        // ClearError is called.
-        errors::AppendToMessage(&status_,
-                                "Encountered when executing an operation using "
-                                "EagerExecutor. This error cancels all future "
-                                "operations and poisons their output tensors.");
-      }
-      while (!node_queue_.empty()) {
-        items_to_destroy.push_front(std::move(node_queue_.front()));
-        node_queue_.pop();
-      }
-      for (auto& it : unfinished_nodes_) {
-        items_to_destroy.push_front(std::move(it.second));
-      }
-      unfinished_nodes_.clear();
+      SetFatalErrorLocked(status, &items_to_destroy);
     }
     if (need_notification) {
       NotifyWaiters(item->id);
@@ -313,6 +312,31 @@ void EagerExecutor::NodeDone(const core::RefCountPtr<NodeItem>& item,
   // a deadlock.
 }
 
+void EagerExecutor::SetFatalErrorLocked(
+    const Status& status,
+    std::forward_list<core::RefCountPtr<NodeItem>>* items_to_abort) {
+  status_ = status;
+  ok_ = false;
+  if (Async()) {
+    // We remove any pending ops so that we don't try to execute them if
+    // ClearError is called.
+    errors::AppendToMessage(&status_,
+                            "Encountered when executing an operation using "
+                            "EagerExecutor. This error cancels all future "
+                            "operations and poisons their output tensors.");
+  }
+  while (!node_queue_.empty()) {
+    items_to_abort->push_front(std::move(node_queue_.front()));
+    node_queue_.pop();
+  }
+  for (auto& it : unfinished_nodes_) {
+    items_to_abort->push_front(std::move(it.second));
+  }
+  unfinished_nodes_.clear();
+  last_handle_user_.clear();
+  last_barrier_id_.reset();
+}
+
 void EagerExecutor::NotifyWaiters(uint64 id) {
   if (!node_done_notifications_.empty()) {
     uint64 upperbound_id = 0;
@@ -372,35 +396,39 @@ void EagerExecutor::Run() {
   }
 }
 
+Status EagerExecutor::SyncRemoteExecutorsIfNeeded(const NodeItem& item) {
+  AsyncRemoteExecuteNode* async_remote_node =
+      item.node->AsAsyncRemoteExecuteNode();
+  if (!enable_async_wait_for_remote_function_ || async_remote_node == nullptr) {
+    return OkStatus();
+  }
+  if (last_eager_client_ != nullptr &&
+      async_remote_node->eager_client() != nullptr &&
+      last_eager_client_ != async_remote_node->eager_client()) {
+    // Running a remote function, need to sync if the function is going to
+    // different device than last time we run remote distributed function.
+    DVLOG(3) << "Executing Sync Executor for node" << item.id;
+    TF_RETURN_IF_ERROR(async_remote_node->SyncExecutors());
+    last_eager_client_ = nullptr;
+  }
+  if (async_remote_node->eager_client() != nullptr &&
+      async_remote_node->needs_remote_inputs() &&
+      async_remote_node->allow_multiple_pending_requests()) {
+    // We are running remote distributed function, update
+    // last_remote_device_name_.
+    last_eager_client_ = async_remote_node->eager_client();
+  }
+  return OkStatus();
+}
+
 Status EagerExecutor::RunItem(core::RefCountPtr<NodeItem> item,
                               bool from_queue) {
   DVLOG(3) << "Running Node: [id " << item->id << "] "
            << item->node->DebugString();
-  AsyncRemoteExecuteNode* async_remote_node =
-      item->node->AsAsyncRemoteExecuteNode();
-  if (enable_async_wait_for_remote_function_) {
-    if (async_remote_node != nullptr) {
-      if (last_eager_client_ != nullptr &&
-          async_remote_node->eager_client() != nullptr &&
-          last_eager_client_ != async_remote_node->eager_client()) {
-        // Running a remote function, need to sync if the function is going to
-        // different device than last time we run remote distributed function.
-        DVLOG(3) << "Executing Sync Executor for node" << item->id;
-        tensorflow::Status status = async_remote_node->SyncExecutors();
-        if (!status.ok()) {
-          NodeDone(item, status, from_queue);
-          return status;
-        }
-        last_eager_client_ = nullptr;
-      }
-      if (async_remote_node->eager_client() != nullptr &&
-          async_remote_node->needs_remote_inputs() &&
-          async_remote_node->allow_multiple_pending_requests()) {
-        // We are running remote distributed function, update
-        // last_remote_device_name_.
-        last_eager_client_ = async_remote_node->eager_client();
-      }
-    }
+  tensorflow::Status sync_status = SyncRemoteExecutorsIfNeeded(*item);
+  if (!sync_status.ok()) {
+    NodeDone(item, sync_status, from_queue);
+    return sync_status;
   }
 
   AsyncEagerNode* async_node = item->node->AsAsync();
@@ -444,6 +472,169 @@ Status EagerExecutor::MoveToUnfinished(core::RefCountPtr<NodeItem> item,
   return OkStatus();
 }
 
+Status EagerExecutor::AddParallel(core::RefCountPtr<NodeItem> item) {
+  Status status;
+  NodeItem* ready_item = nullptr;
+  {
+    tensorflow::mutex_lock l(node_queue_mutex_);
+    DVLOG(3) << "Add parallel node [id " << item->id << "]"
+             << item->node->DebugString() << " with status: " << status_;
+    if (state_ != ExecutorState::kActive) {
+      status = errors::FailedPrecondition(
+          "EagerExecutor accepts new EagerNodes to run only in Active state. "
+          "Current state is '",
+          StateStringLocked(), "'");
+    } else {
+      status = status_;
+    }
+    if (status.ok()) {
+      if (AddDependenciesLocked(item.get())) {
+        ready_item = item.get();
+        ready_item->Ref();
+      }
+      const uint64 id = item->id;
+      unfinished_nodes_.emplace_hint(unfinished_nodes_.end(), id,
+                                     std::move(item));
+    }
+  }
+  if (!status.ok()) {
+    // Abort outside of the lock since it may call AddOrExecute().
+    item->node->Abort(status);
+    return status;
+  }
+  if (ready_item != nullptr) {
+    ScheduleParallel(core::RefCountPtr<NodeItem>(ready_item));
+  }
+  if (in_flight_nodes_limit_ > 0) {
+    tensorflow::mutex_lock l(node_queue_mutex_);
+    WaitForInFlightNodesLocked(&l);
+  }
+  return OkStatus();
+}
+
+bool EagerExecutor::AddDependenciesLocked(NodeItem* item) {
+  auto depend_on = [this, item](uint64 id) {
+    auto it = unfinished_nodes_.find(id);
+    if (it == unfinished_nodes_.end()) return;
+    it->second->successors.push_back(item->id);
+    ++item->num_pending_deps;
+  };
+  if (!item->node->Parallelizable()) {
+    // Waits for all unfinished nodes. Later nodes only need to wait for this
+    // one.
+    for (const auto& it : unfinished_nodes_) depend_on(it.first);
+    last_handle_user_.clear();
+    last_barrier_id_ = item->id;
+    return item->num_pending_deps == 0;
+  }
+  if (last_barrier_id_.has_value()) depend_on(*last_barrier_id_);
+  // Nodes sharing any handle run in the order they were added. This also
+  // orders nodes that read the same resource handle.
+  auto add_handles = [&](absl::Span<TensorHandle* const> handles) {
+    for (const TensorHandle* handle : handles) {
+      auto [it, inserted] = last_handle_user_.try_emplace(handle, item->id);
+      if (!inserted && it->second != item->id) {
+        depend_on(it->second);
+        it->second = item->id;
+      }
+    }
+  };
+  add_handles(item->node->InputHandles());
+  add_handles(item->node->OutputHandles());
+  return item->num_pending_deps == 0;
+}
+
+void EagerExecutor::ScheduleParallel(core::RefCountPtr<NodeItem> item) {
+  NodeItem* raw_item = item.release();
+  parallel_pool_->Schedule([this, raw_item]() {
+    RunParallelItem(core::RefCountPtr<NodeItem>(raw_item));
+  });
+}
+
+void EagerExecutor::RunParallelItem(core::RefCountPtr<NodeItem> item) {
+  DVLOG(3) << "Running parallel Node: [id " << item->id << "] "
+           << item->node->DebugString();
+  item->state = NodeState::kSCHEDULED;
+  // Nodes that may be remote are not Parallelizable(), so they run alone and
+  // can access last_eager_client_.
+  Status status = SyncRemoteExecutorsIfNeeded(*item);
+  if (!status.ok()) {
+    ParallelNodeDone(item, status);
+    return;
+  }
+  AsyncEagerNode* async_node = item->node->AsAsync();
+  if (async_node == nullptr) {
+    ParallelNodeDone(item, item->node->Run());
+    return;
+  }
+  NodeItem* async_ref = item.release();
+  async_node->RunAsync([this, async_ref](const Status& status) {
+    core::RefCountPtr<NodeItem> async_item(async_ref);
+    ParallelNodeDone(async_item, status);
+  });
+}
+
+void EagerExecutor::ParallelNodeDone(const core::RefCountPtr<NodeItem>& item,
+                                     const Status& status) {
+  DVLOG(3) << "Parallel Node Done: [id " << item->id << "] "
+           << item->node->DebugString() << " with status: " << status;
+  DCHECK(item->state != NodeState::kDONE);
+  item->state = NodeState::kDONE;
+
+  std::vector<core::RefCountPtr<NodeItem>> ready_items;
+  std::forward_list<core::RefCountPtr<NodeItem>> items_to_destroy;
+  {
+    mutex_lock l(node_queue_mutex_);
+    if (!status_.ok()) return;
+    // As in NodeDone(), the node may have been removed by an error followed by
+    // ClearError(). Its successors are gone too.
+    auto item_it = unfinished_nodes_.find(item->id);
+    if (item_it == unfinished_nodes_.end()) return;
+    // Only notify when this is the oldest unfinished node, since waiters of
+    // earlier nodes must not be woken up.
+    bool need_notification = item_it == unfinished_nodes_.begin();
+    unfinished_nodes_.erase(item_it);
+
+    if (!status.ok() && item->node->Fatal()) {
+      need_notification = true;
+      SetFatalErrorLocked(status, &items_to_destroy);
+    } else {
+      if (last_barrier_id_ == item->id) last_barrier_id_.reset();
+      auto release_handles = [&](absl::Span<TensorHandle* const> handles) {
+        for (const TensorHandle* handle : handles) {
+          auto it = last_handle_user_.find(handle);
+          if (it != last_handle_user_.end() && it->second == item->id) {
+            last_handle_user_.erase(it);
+          }
+        }
+      };
+      release_handles(item->node->InputHandles());
+      release_handles(item->node->OutputHandles());
+      for (uint64 successor_id : item->successors) {
+        auto it = unfinished_nodes_.find(successor_id);
+        if (it == unfinished_nodes_.end()) continue;
+        if (--it->second->num_pending_deps == 0 &&
+            state_ != ExecutorState::kShutDown) {
+          it->second->Ref();
+          ready_items.emplace_back(it->second.get());
+        }
+      }
+    }
+    if (need_notification) {
+      NotifyWaiters(item->id);
+    }
+    // Notify AddOrExecute() some nodes have been done.
+    nodes_done_.notify_all();
+  }
+
+  for (auto& ready_item : ready_items) {
+    ScheduleParallel(std::move(ready_item));
+  }
+  for (auto& item_to_abort : items_to_destroy) {
+    item_to_abort->node->Abort(status);
+  }
+}
+
 void EagerExecutor::AddCleanup(intptr_t key, std::function<void()> callback) {
   cleanups_[key].push_back(callback);
 }
@@ -18,15 +18,18 @@ limitations under the License.
 #include <algorithm>
 #include <atomic>
 #include <cstddef>
+#include <forward_list>
 #include <functional>
 #include <map>
 #include <memory>
+#include <optional>
 #include <queue>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/types/span.h"
 #include "tensorflow/core/common_runtime/device_factory.h"
 #include "tensorflow/core/common_runtime/function.h"
 #include "tensorflow/core/common_runtime/rendezvous_mgr.h"
@@ -37,6 +40,7 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/map_util.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/public/version.h"
 
@@ -44,6 +48,7 @@ namespace tensorflow {
 
 class AsyncEagerNode;
 class AsyncRemoteExecuteNode;
+class TensorHandle;
 namespace eager {
 class EagerClient;
 }
@@ -79,6 +84,17 @@ class EagerNode {
 
   // Indicates whether a node failure should make the executor unusable.
   virtual bool Fatal() const { return true; }
+
+  // Indicates whether this node may run concurrently with other nodes when
+  // the executor dispatches nodes in parallel. Such a node is ordered only
+  // after earlier nodes that share a tensor handle with it. Other nodes run
+  // once all earlier nodes are done, and before any later node starts.
+  virtual bool Parallelizable() const { return false; }
+
+  // Tensor handles read and produced by this node. Only used for nodes that
+  // are Parallelizable(). Handles are compared by address and never accessed.
+  virtual absl::Span<TensorHandle* const> InputHandles() const { return {}; }
+  virtual absl::Span<TensorHandle* const> OutputHandles() const { return {}; }
 };
 
 class AsyncEagerNode : public EagerNode {
@@ -110,13 +126,16 @@ class AsyncRemoteExecuteNode : public AsyncEagerNode {
 // TODO(agarwal): TFE_OpAddInput may currently block if it tries to access the
 // device of the input handle. Fix that.
 // TODO(agarwal): Implement support for control dependencies.
-// TODO(agarwal): Support out-of-order execution and dispatching multiple
-// EagerNode in parallel.
 // TODO(agarwal): Implement optimizations over EagerNode traces.
 class EagerExecutor {
  public:
+  // If `async` and `num_parallel_threads` > 0, nodes are dispatched to a pool
+  // of `num_parallel_threads` threads as soon as all earlier nodes they depend
+  // on are done (see EagerNode::Parallelizable()), instead of one at a time in
+  // the order they were added.
   explicit EagerExecutor(bool async, bool enable_streaming_enqueue = true,
-                         int in_flight_nodes_limit = 0);
+                         int in_flight_nodes_limit = 0,
+                         int num_parallel_threads = 0);
 
   ~EagerExecutor();
 
@@ -195,6 +214,10 @@ class EagerExecutor {
     uint64 id;
     std::unique_ptr<EagerNode> node;
     NodeState state;
+    // Only used in parallel mode. Number of earlier unfinished nodes this node
+    // waits for, and ids of the later nodes waiting for this one.
+    int num_pending_deps = 0;
+    std::vector<uint64> successors;
   };
 
   const char* StateStringLocked()
@@ -213,6 +236,33 @@ class EagerExecutor {
   Status RunItem(core::RefCountPtr<NodeItem> item, bool from_queue);
   Status MoveToUnfinished(core::RefCountPtr<NodeItem> item, bool from_queue);
 
+  // Syncs the remote executors before running `item` if it is a remote
+  // function going to a different remote executor than the previous one.
+  Status SyncRemoteExecutorsIfNeeded(const NodeItem& item);
+
+  // Records an error that makes this executor unusable. Moves all pending and
+  // unfinished nodes to `items_to_abort`.
+  void SetFatalErrorLocked(
+      const Status& status,
+      std::forward_list<core::RefCountPtr<NodeItem>>* items_to_abort)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(node_queue_mutex_);
+
+  // Blocks while the number of in flight nodes is at the limit.
+  void WaitForInFlightNodesLocked(mutex_lock* lock)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(node_queue_mutex_);
+
+  // Parallel mode counterparts of AddOrExecute(), RunItem() and NodeDone().
+  Status AddParallel(core::RefCountPtr<NodeItem> item);
+  void ScheduleParallel(core::RefCountPtr<NodeItem> item);
+  void RunParallelItem(core::RefCountPtr<NodeItem> item);
+  void ParallelNodeDone(const core::RefCountPtr<NodeItem>& item,
+                        const Status& status);
+
+  // Registers `item` as a successor of the unfinished nodes it depends on.
+  // Returns true if it doesn't depend on any.
+  bool AddDependenciesLocked(NodeItem* item)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(node_queue_mutex_);
+
   // The impl of WaitForAllPendingNodes
   // `lock` is the lock that holds node_queue_mutex_.
   Status WaitForAllPendingNodesLocked(mutex_lock* lock)
@@ -277,6 +327,16 @@ class EagerExecutor {
   // async nodes reach this number, enqueuing to the eager async queue is
   // blocked.
   const int64_t in_flight_nodes_limit_;
+
+  // Parallel mode only. Id of the last unfinished node using each tensor
+  // handle, and of the last unfinished node that is not Parallelizable().
+  absl::flat_hash_map<const TensorHandle*, uint64> last_handle_user_
+      TF_GUARDED_BY(node_queue_mutex_);
+  std::optional<uint64> last_barrier_id_ TF_GUARDED_BY(node_queue_mutex_);
+
+  // Runs the nodes in parallel mode, `nullptr` otherwise. Declared last so
+  // that it is destroyed, and its threads joined, before any other member.
+  std::unique_ptr<thread::ThreadPool> parallel_pool_;
 };
 
 inline bool EagerExecutor::Async() const { return thread_ != nullptr; }
@@ -14,9 +14,14 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/common_runtime/eager/eager_executor.h"
 
+#include <chrono>  // NOLINT(build/c++11)
+#include <functional>
 #include <memory>
 #include <utility>
+#include <vector>
 
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/status_matchers.h"
 #include "tensorflow/core/platform/test.h"
@@ -102,6 +107,53 @@ class TestAsyncEagerNode : public AsyncEagerNode {
   Status run_return_status_;
 };
 
+// A node that records its id when it runs. Its tensor handles are fake
+// addresses, which the executor only uses for dependency tracking.
+class TestParallelEagerNode : public EagerNode {
+ public:
+  TestParallelEagerNode(int id, std::vector<TensorHandle*> inputs,
+                        std::vector<TensorHandle*> outputs,
+                        std::function<Status()> run, mutex* mu,
+                        std::vector<int>* run_order)
+      : id_(id),
+        inputs_(std::move(inputs)),
+        outputs_(std::move(outputs)),
+        run_(std::move(run)),
+        mu_(mu),
+        run_order_(run_order) {}
+
+  Status Run() override {
+    Status status = run_ ? run_() : OkStatus();
+    mutex_lock l(*mu_);
+    run_order_->push_back(id_);
+    return status;
+  }
+
+  void Abort(Status status) override {}
+  string DebugString() const override { return "testParallelEagerNode"; }
+
+  bool Parallelizable() const override { return true; }
+  absl::Span<TensorHandle* const> InputHandles() const override {
+    return inputs_;
+  }
+  absl::Span<TensorHandle* const> OutputHandles() const override {
+    return outputs_;
+  }
+
+ private:
+  int id_;
+  std::vector<TensorHandle*> inputs_;
+  std::vector<TensorHandle*> outputs_;
+  std::function<Status()> run_;
+  mutex* mu_;
+  std::vector<int>* run_order_;
+};
+
+TensorHandle* FakeHandle(int i) {
+  static char handles[8];
+  return reinterpret_cast<TensorHandle*>(&handles[i]);
+}
+
 TEST(EagerExecutorTest, TestSyncExecutorWithEagerNode) {
   auto sync_executor = std::make_unique<EagerExecutor>(
       /*async=*/false, /*enable_streaming_enqueue=*/true);
@@ -281,5 +333,93 @@ TEST(EagerExecutorTest, TestAsyncExecutorAddNodesAfterShutdown) {
       async_executor->AddOrExecute(std::move(node)),
       tensorflow::testing::StatusIs(tensorflow::error::FAILED_PRECONDITION));
 }
+
+TEST(EagerExecutorTest, TestParallelExecutorRunsIndependentNodesConcurrently) {
+  auto executor = std::make_unique<EagerExecutor>(
+      /*async=*/true, /*enable_streaming_enqueue=*/true,
+      /*in_flight_nodes_limit=*/0, /*num_parallel_threads=*/2);
+  mutex mu;
+  std::vector<int> run_order;
+  // Each node only finishes once both have started, which requires running
+  // them at the same time.
+  BlockingCounter started(2);
+  auto run = [&started]() {
+    started.DecrementCount();
+    if (!started.WaitFor(std::chrono::seconds(60))) {
+      return errors::DeadlineExceeded("nodes did not run concurrently");
+    }
+    return OkStatus();
+  };
+  TF_ASSERT_OK(executor->AddOrExecute(std::make_unique<TestParallelEagerNode>(
+      0, std::vector<TensorHandle*>{FakeHandle(0)},
+      std::vector<TensorHandle*>{FakeHandle(1)}, run, &mu, &run_order)));
+  TF_ASSERT_OK(executor->AddOrExecute(std::make_unique<TestParallelEagerNode>(
+      1, std::vector<TensorHandle*>{FakeHandle(2)},
+      std::vector<TensorHandle*>{FakeHandle(3)}, run, &mu, &run_order)));
+  TF_ASSERT_OK(executor->WaitForAllPendingNodes());
+  EXPECT_EQ(run_order.size(), 2);
+  TF_ASSERT_OK(executor->ShutDown());
+}
+
+TEST(EagerExecutorTest, TestParallelExecutorOrdersDependentNodes) {
+  auto executor = std::make_unique<EagerExecutor>(
+      /*async=*/true, /*enable_streaming_enqueue=*/true,
+      /*in_flight_nodes_limit=*/0, /*num_parallel_threads=*/4);
+  mutex mu;
+  std::vector<int> run_order;
+  auto slow = []() {
+    Env::Default()->SleepForMicroseconds(10000);
+    return OkStatus();
+  };
+  // 0 produces handle 1, which 1 consumes. 2 is not Parallelizable() and runs
+  // after both. 3 produces handle 1 again, after 2.
+  TF_ASSERT_OK(executor->AddOrExecute(std::make_unique<TestParallelEagerNode>(
+      0, std::vector<TensorHandle*>{FakeHandle(0)},
+      std::vector<TensorHandle*>{FakeHandle(1)}, slow, &mu, &run_order)));
+  TF_ASSERT_OK(executor->AddOrExecute(std::make_unique<TestParallelEagerNode>(
+      1, std::vector<TensorHandle*>{FakeHandle(1)},
+      std::vector<TensorHandle*>{FakeHandle(2)}, slow, &mu, &run_order)));
+  auto state = std::make_unique<TestState>();
+  TF_ASSERT_OK(executor->AddOrExecute(
+      std::make_unique<TestEagerNode>(state.get())));
+  TF_ASSERT_OK(executor->AddOrExecute(std::make_unique<TestParallelEagerNode>(
+      3, std::vector<TensorHandle*>{},
+      std::vector<TensorHandle*>{FakeHandle(1)}, nullptr, &mu, &run_order)));
+  TF_ASSERT_OK(executor->WaitForAllPendingNodes());
+  EXPECT_EQ(run_order, std::vector<int>({0, 1, 3}));
+  EXPECT_EQ(state->read_state(), TestState::State::kSuccess);
+  TF_ASSERT_OK(executor->ShutDown());
+}
+
+TEST(EagerExecutorTest, TestParallelExecutorFailRun) {
+  auto executor = std::make_unique<EagerExecutor>(
+      /*async=*/true, /*enable_streaming_enqueue=*/true,
+      /*in_flight_nodes_limit=*/0, /*num_parallel_threads=*/2);
+  mutex mu;
+  std::vector<int> run_order;
+  auto fail = []() { return errors::Internal("test"); };
+  TF_ASSERT_OK(executor->AddOrExecute(std::make_unique<TestParallelEagerNode>(
+      0, std::vector<TensorHandle*>{FakeHandle(0)},
+      std::vector<TensorHandle*>{FakeHandle(1)}, fail, &mu, &run_order)));
+  // Depends on the failed node, so it never runs.
+  Status add_status = executor->AddOrExecute(
+      std::make_unique<TestParallelEagerNode>(
+          1, std::vector<TensorHandle*>{FakeHandle(1)},
+          std::vector<TensorHandle*>{FakeHandle(2)}, nullptr, &mu,
+          &run_order));
+  EXPECT_THAT(executor->WaitForAllPendingNodes(),
+              tensorflow::testing::StatusIs(tensorflow::error::INTERNAL));
+  EXPECT_THAT(add_status.code(),
+              ::testing::AnyOf(absl::StatusCode::kOk,
+                               absl::StatusCode::kInternal));
+  EXPECT_EQ(run_order, std::vector<int>({0}));
+
+  executor->ClearError();
+  TF_ASSERT_OK(executor->AddOrExecute(std::make_unique<TestParallelEagerNode>(
+      2, std::vector<TensorHandle*>{FakeHandle(1)},
+      std::vector<TensorHandle*>{FakeHandle(2)}, nullptr, &mu, &run_order)));
+  TF_ASSERT_OK(executor->WaitForAllPendingNodes());
+  EXPECT_EQ(run_order, std::vector<int>({0, 2}));
+}
 }  // namespace
 }  // namespace tensorflow
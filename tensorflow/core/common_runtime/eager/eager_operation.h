@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <optional>
 #include <string>
+#include <utility>
 #include <variant>
 #include <vector>
 
@@ -228,6 +229,31 @@ class EagerOperation : public ImmediateExecutionOperation {
   // Op name recorded for memory debugging purpose.
   const char* op_name() const { return op_name_; }
 
+  // The inputs of the last kernel cache key computed for this operation, and
+  // the key. An EagerOperation is typically reused to execute the same op
+  // from the same call site, so GetOrCreateKernelAndDevice compares the
+  // signature (input devices by pointer, resource dtypes and shapes by value)
+  // and reuses the key instead of fingerprinting all input device names.
+  //
+  // Device pointers are only compared while the kernel cache generation of
+  // the context is unchanged, as the context clears its caches whenever its
+  // devices change. The signature is kept across Clear() and Reset().
+  struct KernelCacheKeySignature {
+    bool valid = false;
+    Fprint128 op_cache_key;
+    int64_t kernel_cache_generation;
+    bool allow_soft_placement;
+    bool run_eager_op_as_function;
+    bool reuse_rendezvous_for_functions;
+    absl::InlinedVector<tensorflow::Device*, 4> input_devices;
+    std::vector<std::pair<int, DtypeAndPartialTensorShape>>
+        resource_dtypes_and_shapes;
+    Fprint128 cache_key;
+  };
+  KernelCacheKeySignature* MutableKernelCacheKeySignature() {
+    return &kernel_cache_key_signature_;
+  }
+
   // For LLVM style RTTI.
   static bool classof(const AbstractOperation* ptr) {
     return ptr->getKind() == kEager;
@@ -296,6 +322,8 @@ class EagerOperation : public ImmediateExecutionOperation {
   int inference_arg_idx_;  // arg definition index for the next input to be
                            // added
   gtl::FlatSet<std::string> inference_attrs_;  // attributes inferred so far
+
+  KernelCacheKeySignature kernel_cache_key_signature_;
 };
 
 inline void EagerOperation::UpdateInput(int i, TensorHandle* h) {
@@ -30,6 +30,7 @@ limitations under the License.
 
 // clang-format off
 // Required for IS_MOBILE_PLATFORM
+#include "absl/algorithm/container.h"
 #include "absl/container/btree_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/strings/str_replace.h"
@@ -1224,6 +1225,71 @@ StatusOr<Fprint128> GetKernelCacheKey(
   return cache_key;
 }
 
+// Returns the kernel cache key of `op`, like GetKernelCacheKey, but reuses the
+// key computed by the previous execution of `op` when its signature is
+// unchanged.
+StatusOr<Fprint128> GetKernelCacheKeyWithSignature(
+    EagerOperation* op, const Fprint128& op_cache_key,
+    const std::vector<Device*>& input_device_ptrs,
+    const std::unordered_map<int, DtypeAndPartialTensorShape>&
+        input_resource_variable_dtypes_and_shapes) {
+  EagerContext& ctx = op->EagerContext();
+  EagerOperation::KernelCacheKeySignature& signature =
+      *op->MutableKernelCacheKeySignature();
+  const int64_t kernel_cache_generation = ctx.KernelCacheGeneration();
+  const bool allow_soft_placement = ctx.AllowSoftPlacement();
+  const bool run_eager_op_as_function = ctx.RunEagerOpAsFunction();
+  const bool reuse_rendezvous_for_functions =
+      (run_eager_op_as_function && !op->is_function()) ||
+      ctx.GetReuseRendezvousForFunctions();
+
+  auto same_resource_dtypes_and_shapes = [&]() {
+    if (signature.resource_dtypes_and_shapes.size() !=
+        input_resource_variable_dtypes_and_shapes.size()) {
+      return false;
+    }
+    for (const auto& [index, dtype_and_shape] :
+         signature.resource_dtypes_and_shapes) {
+      auto it = input_resource_variable_dtypes_and_shapes.find(index);
+      if (it == input_resource_variable_dtypes_and_shapes.end() ||
+          it->second.dtype != dtype_and_shape.dtype ||
+          !it->second.shape.IsIdenticalTo(dtype_and_shape.shape)) {
+        return false;
+      }
+    }
+    return true;
+  };
+  if (signature.valid && signature.op_cache_key == op_cache_key &&
+      signature.kernel_cache_generation == kernel_cache_generation &&
+      signature.allow_soft_placement == allow_soft_placement &&
+      signature.run_eager_op_as_function == run_eager_op_as_function &&
+      signature.reuse_rendezvous_for_functions ==
+          reuse_rendezvous_for_functions &&
+      absl::c_equal(signature.input_devices, input_device_ptrs) &&
+      same_resource_dtypes_and_shapes()) {
+    return signature.cache_key;
+  }
+
+  signature.valid = false;
+  TF_ASSIGN_OR_RETURN(
+      Fprint128 cache_key,
+      GetKernelCacheKey(*op, op_cache_key, input_device_ptrs,
+                        input_resource_variable_dtypes_and_shapes));
+  signature.op_cache_key = op_cache_key;
+  signature.kernel_cache_generation = kernel_cache_generation;
+  signature.allow_soft_placement = allow_soft_placement;
+  signature.run_eager_op_as_function = run_eager_op_as_function;
+  signature.reuse_rendezvous_for_functions = reuse_rendezvous_for_functions;
+  signature.input_devices.assign(input_device_ptrs.begin(),
+                                 input_device_ptrs.end());
+  signature.resource_dtypes_and_shapes.assign(
+      input_resource_variable_dtypes_and_shapes.begin(),
+      input_resource_variable_dtypes_and_shapes.end());
+  signature.cache_key = cache_key;
+  signature.valid = true;
+  return cache_key;
+}
+
 // Extracts function input info for `op` with `kernel_def`.
 // The following are extracted:
 //   `input_device_ptrs` - The input devices of `op`.
@@ -1385,9 +1451,9 @@ Status GetOrCreateKernelAndDevice(
 
   TF_ASSIGN_OR_RETURN(
       Fprint128 cache_key,
-      GetKernelCacheKey(*op, op->MutableAttrs()->CacheKey(op->DeviceName()),
-                        input_device_ptrs,
-                        input_resource_variable_dtypes_and_shapes));
+      GetKernelCacheKeyWithSignature(
+          op, op->MutableAttrs()->CacheKey(op->DeviceName()),
+          input_device_ptrs, input_resource_variable_dtypes_and_shapes));
   core::RefCountPtr<KernelAndDevice> kernel = ctx.GetCachedKernel(cache_key);
   AbstractOperationPtr wrapped_op_releaser;
   // We can eliminate some overhead by running simple functions using regular
@@ -1808,6 +1874,13 @@ void PrepareRemoteOp(eager::Operation* remote_op, EagerOperation* op) {
   op->Attrs().FillAttrValueMapWithoutDefaults(remote_op->mutable_attrs());
   remote_op->set_device(std::get<Device*>(op->Device())->name());
   remote_op->set_is_function(op->is_function());
+
+  // Lets a streaming client send the name, attrs and device of a repeated op
+  // only once.
+  const Fprint128 signature = op->MutableAttrs()->CacheKey(remote_op->device());
+  remote_op->set_signature_id(tsl::FingerprintCat64(
+      tsl::FingerprintCat64(signature.low64, signature.high64),
+      op->is_function()));
 }
 
 Status StoreResourceDtypesAndShapes(const eager::Operation& remote_op,
@@ -38,6 +38,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/eager/execute.h"
 #include "tensorflow/core/common_runtime/eager/kernel_and_device.h"
 #include "tensorflow/core/common_runtime/eager/tensor_handle.h"
+#include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/step_stats.pb.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/types.h"
@@ -227,6 +228,30 @@ class AsyncExecuteNode : public EagerNode {
     }
   }
 
+  // Primitive stateless ops only touch the tensors of their input and output
+  // handles. Functions and stateful ops may have other side effects.
+  bool Parallelizable() const override {
+    if (graph_collector_ != nullptr || kernel_->IsFunction() ||
+        kernel_->kernel() == nullptr) {
+      return false;
+    }
+    const OpDef* op_def = nullptr;
+    if (!OpRegistry::Global()
+             ->LookUpOpDef(kernel_->kernel()->type_string(), &op_def)
+             .ok()) {
+      return false;
+    }
+    return !op_def->is_stateful();
+  }
+
+  absl::Span<TensorHandle* const> InputHandles() const override {
+    return inputs_;
+  }
+
+  absl::Span<TensorHandle* const> OutputHandles() const override {
+    return retvals_;
+  }
+
   std::string DebugString() const override {
     std::string out = "[AsyncExecuteNode]";
     strings::StrAppend(&out, " kernel: ", kernel_->name());
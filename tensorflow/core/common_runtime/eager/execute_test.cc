@@ -61,6 +61,60 @@ TEST(ExecuteTest, EagerOperationAsFunction) {
   ctx->Unref();
 }
 
+TEST(ExecuteTest, ReusedOperationReusesKernelCacheKey) {
+  StaticDeviceMgr device_mgr(
+      DeviceFactory::NewDevice("CPU", {}, "/job:localhost/replica:0/task:0"));
+  auto ctx = new EagerContext(
+      SessionOptions(),
+      tensorflow::ContextDevicePlacementPolicy::DEVICE_PLACEMENT_EXPLICIT,
+      false, &device_mgr, false, nullptr, nullptr);
+  ctx->SetRunEagerOpAsFunction(true);
+
+  Tensor input_tensor = test::AsScalar<int64_t>(3);
+  auto input = core::RefCountPtr<ImmediateExecutionTensorHandle>(
+      ctx->CreateLocalHandleFromTFTensor(input_tensor,
+                                         ctx->HostCPUName().c_str()));
+
+  auto op = std::make_unique<EagerOperation>(ctx);
+  auto execute = [&]() {
+    op->Clear();
+    TF_ASSERT_OK(op->Reset(
+        /*op=*/"Mul",
+        /*raw_device_name=*/"/job:localhost/replica:0/task:0/device:CPU:0"));
+    TF_ASSERT_OK(op->AddInput(input.get()));
+    TF_ASSERT_OK(op->AddInput(input.get()));
+    std::vector<TensorHandle*> retvals(1);
+    int num_retvals = retvals.size();
+    TF_ASSERT_OK(EagerExecute(op.get(), retvals.data(), &num_retvals));
+    retvals[0]->Unref();
+  };
+
+  execute();
+  const EagerOperation::KernelCacheKeySignature& signature =
+      *op->MutableKernelCacheKeySignature();
+  ASSERT_TRUE(signature.valid);
+  const Fprint128 cache_key = signature.cache_key;
+  const int64_t generation = ctx->KernelCacheGeneration();
+  const int kernel_cache_size = ctx->GetCacheStats().kernel_cache_size;
+  EXPECT_GT(kernel_cache_size, 0);
+
+  execute();
+  EXPECT_EQ(signature.cache_key, cache_key);
+  EXPECT_EQ(ctx->GetCacheStats().kernel_cache_size, kernel_cache_size);
+
+  // Clearing the caches invalidates the signature.
+  ctx->ClearCachesAndThreadExecutors();
+  EXPECT_GT(ctx->KernelCacheGeneration(), generation);
+  EXPECT_EQ(ctx->GetCacheStats().kernel_cache_size, 0);
+  execute();
+  EXPECT_EQ(signature.kernel_cache_generation, ctx->KernelCacheGeneration());
+  EXPECT_EQ(signature.cache_key, cache_key);
+  EXPECT_EQ(ctx->GetCacheStats().kernel_cache_size, kernel_cache_size);
+
+  op.reset();
+  ctx->Unref();
+}
+
 TEST(ExecuteTest, SimpleFunction) {
   StaticDeviceMgr device_mgr(
       DeviceFactory::NewDevice("CPU", {}, "/job:localhost/replica:0/task:0"));
@@ -36,6 +36,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/renamed_device.h"
 #include "tensorflow/core/common_runtime/simple_propagator_state.h"
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
+#include "tensorflow/core/common_runtime/work_stealing_queue.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/collective.h"
@@ -62,6 +63,7 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/manual_constructor.h"
 #include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/platform/context.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/logging.h"
@@ -144,9 +146,25 @@ struct KernelTimer {
 typedef gtl::InlinedVector<TensorValue, 4> TensorValueVec;
 typedef gtl::InlinedVector<AllocatorAttributes, 4> AllocatorAttributeVec;
 
+// The executor type under which the work-stealing variant of `ExecutorImpl` is
+// registered. See `ExecutorState::ScheduleReady()` for details.
+static const char* const kWorkStealingExecutor = "WORK_STEALING_EXECUTOR";
+
+// Identifies the work-stealing worker slot (if any) that the current thread
+// occupies, and the `ExecutorState` that owns it.
+struct WorkStealingWorkerSlot {
+  const void* owner = nullptr;
+  int slot = -1;
+};
+thread_local WorkStealingWorkerSlot current_work_stealing_slot;
+
 class ExecutorImpl : public Executor {
  public:
-  explicit ExecutorImpl(const LocalExecutorParams& p) : immutable_state_(p) {}
+  explicit ExecutorImpl(const LocalExecutorParams& p,
+                        bool use_work_stealing = false)
+      : immutable_state_(p),
+        num_work_stealing_slots_(
+            use_work_stealing ? std::max(1, port::MaxParallelism()) : 0) {}
 
   Status Initialize(const Graph& graph) {
     TF_RETURN_IF_ERROR(immutable_state_.Initialize(graph));
@@ -225,6 +243,10 @@ class ExecutorImpl : public Executor {
   ImmutableExecutorState immutable_state_;
   KernelStats kernel_stats_;
 
+  // The number of per-worker ready deques used by each step, or 0 if this
+  // executor dispatches every expensive ready node to `runner` directly.
+  const int num_work_stealing_slots_;
+
   TF_DISALLOW_COPY_AND_ASSIGN(ExecutorImpl);
 };
 
@@ -282,7 +304,8 @@ class ExecutorState {
  public:
   ExecutorState(const Executor::Args& args,
                 const ImmutableExecutorState& immutable_state_,
-                ExecutorImpl::KernelStats* kernel_stats_);
+                ExecutorImpl::KernelStats* kernel_stats_,
+                int num_work_stealing_slots = 0);
   ~ExecutorState();
 
   void RunAsync(Executor::DoneCallback done);
@@ -296,6 +319,12 @@ class ExecutorState {
 
   struct AsyncState;
 
+  // A ready node waiting in `work_queue_`.
+  struct ReadyTask {
+    TaggedNode tagged_node;
+    int64_t scheduled_nsec;
+  };
+
   // Process a ready node in current thread.
   void Process(const TaggedNode& node, int64_t scheduled_nsec);
 
@@ -344,6 +373,21 @@ class ExecutorState {
   template <typename Closure>
   void RunTask(Closure&& c, int sample_rate = 0);
 
+  // Pushes `nodes` onto `work_queue_`, preferring the deque of the calling
+  // worker, and starts additional workers while there are free worker slots.
+  //
+  // REQUIRES: `work_queue_ != nullptr`.
+  void PushWorkStealing(const TaggedNodeSeq& nodes, int64_t scheduled_nsec);
+
+  // Takes a free worker slot and returns true, or returns false if every slot
+  // is occupied.
+  bool AcquireWorkerSlot(int* slot) TF_LOCKS_EXCLUDED(worker_slots_mu_);
+  void ReleaseWorkerSlot(int slot) TF_LOCKS_EXCLUDED(worker_slots_mu_);
+
+  // Processes nodes from `work_queue_`, stealing from other slots when the
+  // deque of `slot` is empty, until all deques are empty.
+  void RunWorkStealingWorker(int slot);
+
   // Clean up when this executor is done.
   void Finish();
   void ScheduleFinish();
@@ -377,6 +421,7 @@ class ExecutorState {
   TensorStore* tensor_store_;
   // Step-local container.
   ScopedStepContainer* step_container_;
+  Allocator* const step_allocator_;
   StepStatsCollectorInterface* const stats_collector_;
   const tracing::EventCollector* const event_collector_;
   Context context_;
@@ -398,6 +443,14 @@ class ExecutorState {
 
   PropagatorStateType propagator_;
 
+  // Per-worker ready deques. Non-null iff the step was started by an executor
+  // created with the "WORK_STEALING_EXECUTOR" type.
+  std::unique_ptr<WorkStealingQueue<ReadyTask>> work_queue_;
+  mutex worker_slots_mu_;
+  std::vector<int> free_worker_slots_ TF_GUARDED_BY(worker_slots_mu_);
+  // Used to spread nodes pushed from non-worker threads across the deques.
+  std::atomic<uint32> next_push_slot_{0};
+
   // Invoked when the execution finishes.
   Executor::DoneCallback done_cb_;
 
@@ -416,7 +469,7 @@ class ExecutorState {
 template <class PropagatorStateType>
 ExecutorState<PropagatorStateType>::ExecutorState(
     const Executor::Args& args, const ImmutableExecutorState& immutable_state,
-    ExecutorImpl::KernelStats* kernel_stats)
+    ExecutorImpl::KernelStats* kernel_stats, int num_work_stealing_slots)
     : vlog_(VLOG_IS_ON(1)),
       log_memory_(LogMemory::IsEnabled()),
       step_id_(args.step_id),
@@ -430,6 +483,7 @@ ExecutorState<PropagatorStateType>::ExecutorState(
       session_metadata_(immutable_state.params().session_metadata),
       tensor_store_(args.tensor_store),
       step_container_(args.step_container),
+      step_allocator_(args.step_allocator),
       stats_collector_(args.stats_collector),
       event_collector_(
           tracing::GetEventCollector(tracing::EventCategory::kCompute)),
@@ -446,6 +500,16 @@ ExecutorState<PropagatorStateType>::ExecutorState(
       run_all_kernels_inline_(args.run_all_kernels_inline),
       propagator_(immutable_state, step_id_, vlog_),
       num_outstanding_ops_(0) {
+  // Kernels that run inline never reach the thread pool, so there is nothing
+  // for workers to steal.
+  if (num_work_stealing_slots > 0 && !run_all_kernels_inline_) {
+    work_queue_ = std::make_unique<WorkStealingQueue<ReadyTask>>(
+        num_work_stealing_slots);
+    free_worker_slots_.reserve(num_work_stealing_slots);
+    for (int i = num_work_stealing_slots - 1; i >= 0; --i) {
+      free_worker_slots_.push_back(i);
+    }
+  }
   if (args.user_intra_op_threadpool != nullptr) {
     Device* device = immutable_state_.params().device;
     user_device_ = RenamedDevice::NewRenamedDevice(
@@ -485,6 +549,71 @@ void ExecutorState<PropagatorStateType>::RunTask(Closure&& c, int sample_rate) {
   });
 }
 
+template <class PropagatorStateType>
+bool ExecutorState<PropagatorStateType>::AcquireWorkerSlot(int* slot) {
+  mutex_lock l(worker_slots_mu_);
+  if (free_worker_slots_.empty()) return false;
+  *slot = free_worker_slots_.back();
+  free_worker_slots_.pop_back();
+  return true;
+}
+
+template <class PropagatorStateType>
+void ExecutorState<PropagatorStateType>::ReleaseWorkerSlot(int slot) {
+  mutex_lock l(worker_slots_mu_);
+  free_worker_slots_.push_back(slot);
+}
+
+template <class PropagatorStateType>
+void ExecutorState<PropagatorStateType>::PushWorkStealing(
+    const TaggedNodeSeq& nodes, int64_t scheduled_nsec) {
+  const int num_slots = work_queue_->num_slots();
+  const bool is_worker = current_work_stealing_slot.owner == this;
+  for (const TaggedNode& tagged_node : nodes) {
+    // Successors produced by a worker stay on that worker's deque, so that
+    // they run on the core that produced their inputs unless another worker
+    // runs out of work and steals them.
+    const int slot =
+        is_worker ? current_work_stealing_slot.slot
+                  : next_push_slot_.fetch_add(1, std::memory_order_relaxed) %
+                        num_slots;
+    work_queue_->Push(slot, ReadyTask{tagged_node, scheduled_nsec});
+  }
+
+  // Start at most one new worker per pushed node. A worker holds a reference
+  // on `num_outstanding_ops_`, so that the step cannot finish (and delete
+  // `this`) while the worker is still inspecting `work_queue_`.
+  for (size_t i = is_worker ? 1 : 0; i < nodes.size(); ++i) {
+    int slot;
+    if (!AcquireWorkerSlot(&slot)) break;
+    num_outstanding_ops_.fetch_add(1, std::memory_order_relaxed);
+    RunTask([this, slot]() { RunWorkStealingWorker(slot); },
+            /*sample_rate=*/nodes.size());
+  }
+}
+
+template <class PropagatorStateType>
+void ExecutorState<PropagatorStateType>::RunWorkStealingWorker(int slot) {
+  profiler::TraceMe activity("ExecutorState::RunWorkStealingWorker",
+                             profiler::TraceMeLevel::kVerbose);
+  // A kernel may run another executor inline on this thread, so restore the
+  // previous owner when this worker exits.
+  const WorkStealingWorkerSlot saved_slot = current_work_stealing_slot;
+  while (true) {
+    current_work_stealing_slot = {this, slot};
+    while (absl::optional<ReadyTask> task = work_queue_->Pop(slot)) {
+      Process(task->tagged_node, task->scheduled_nsec);
+    }
+    ReleaseWorkerSlot(slot);
+    // A node may have been pushed after the last `Pop()` by a thread that saw
+    // no free slot (and so did not start a worker for it). Such a push is
+    // visible here, because it happened before the slot was released.
+    if (work_queue_->Empty() || !AcquireWorkerSlot(&slot)) break;
+  }
+  current_work_stealing_slot = saved_slot;
+  if (num_outstanding_ops_.fetch_sub(1) == 1) ScheduleFinish();
+}
+
 template <class PropagatorStateType>
 void ExecutorState<PropagatorStateType>::RunAsync(Executor::DoneCallback done) {
   TaggedNodeSeq ready;
@@ -740,6 +869,7 @@ void ExecutorState<PropagatorStateType>::ProcessInline(
   params->function_library = immutable_state_.params().function_library;
   params->resource_manager = device->resource_manager();
   params->step_container = step_container_;
+  params->step_allocator = step_allocator_;
   params->slice_reader_cache = slice_reader_cache_;
   params->runner = &runner_;
   params->run_all_kernels_inline = run_all_kernels_inline_;
@@ -886,6 +1016,9 @@ void ExecutorState<PropagatorStateType>::ProcessInline(
       params->outputs_required_array = item.outputs_required.get();
       params->inputs = *inputs;
       params->input_alloc_attrs = input_alloc_attrs;
+      DeviceContext* op_device_context = immutable_state_.device_context(id);
+      params->op_device_context =
+          op_device_context != nullptr ? op_device_context : device_context_;
 
       if (item.kernel_is_async) {
         ProcessAsync(item, *params, tagged_node, first_input, stats,
@@ -1267,7 +1400,9 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
   } else {
     const TaggedNode* curr_expensive_node = nullptr;
     TaggedNodeSeq expensive_nodes;
-    if (inline_ready == nullptr) {
+    if (inline_ready == nullptr && work_queue_) {
+      PushWorkStealing(*ready, scheduled_nsec);
+    } else if (inline_ready == nullptr) {
       // Schedule to run all the ready ops in thread pool.
       for (auto& tagged_node : *ready) {
         RunTask([=]() { Process(tagged_node, scheduled_nsec); },
@@ -1296,7 +1431,11 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
         expensive_nodes.push_back(*curr_expensive_node);
       }
     }
-    if (!expensive_nodes.empty()) {
+    if (!expensive_nodes.empty() && work_queue_) {
+      // Idle workers steal from the deques, so there is no need to fan out
+      // large batches of expensive nodes through child threads.
+      PushWorkStealing(expensive_nodes, scheduled_nsec);
+    } else if (!expensive_nodes.empty()) {
       if (expensive_nodes.size() < kInlineScheduleReadyThreshold) {
         for (auto& tagged_node : expensive_nodes) {
           RunTask(std::bind(&ExecutorState::Process, this, tagged_node,
@@ -1479,15 +1618,17 @@ void ExecutorState<PropagatorStateType>::Finish() {
 
 void ExecutorImpl::RunAsync(const Args& args, DoneCallback done) {
   if (OpOrderDeterminismRequired()) {
+    // Work stealing would reorder kernels, so it is disabled here.
     (new ExecutorState<OrderedPropagatorState>(args, immutable_state_,
                                                &kernel_stats_))
         ->RunAsync(std::move(done));
   } else if (immutable_state_.requires_control_flow_support()) {
-    (new ExecutorState<PropagatorState>(args, immutable_state_, &kernel_stats_))
+    (new ExecutorState<PropagatorState>(args, immutable_state_, &kernel_stats_,
+                                        num_work_stealing_slots_))
         ->RunAsync(std::move(done));
   } else {
-    (new ExecutorState<SimplePropagatorState>(args, immutable_state_,
-                                              &kernel_stats_))
+    (new ExecutorState<SimplePropagatorState>(
+         args, immutable_state_, &kernel_stats_, num_work_stealing_slots_))
         ->RunAsync(std::move(done));
   }
 }
@@ -1526,6 +1667,7 @@ class DefaultExecutorRegistrar {
     Factory* factory = new Factory;
     ExecutorFactory::Register("", factory);
     ExecutorFactory::Register("DEFAULT", factory);
+    ExecutorFactory::Register(kWorkStealingExecutor, new WorkStealingFactory);
   }
 
  private:
@@ -1538,6 +1680,17 @@ class DefaultExecutorRegistrar {
       return OkStatus();
     }
   };
+
+  class WorkStealingFactory : public ExecutorFactory {
+    Status NewExecutor(const LocalExecutorParams& params, const Graph& graph,
+                       std::unique_ptr<Executor>* out_executor) override {
+      auto impl =
+          std::make_unique<ExecutorImpl>(params, /*use_work_stealing=*/true);
+      TF_RETURN_IF_ERROR(impl->Initialize(graph));
+      *out_executor = std::move(impl);
+      return OkStatus();
+    }
+  };
 };
 static DefaultExecutorRegistrar registrar;
 
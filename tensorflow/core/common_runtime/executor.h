@@ -105,6 +105,9 @@ class Executor {
     string session_handle;
     TensorStore* tensor_store = nullptr;
     ScopedStepContainer* step_container = nullptr;
+    // If non-null, kernels allocate buffers requested with default allocator
+    // attributes from this allocator instead of the device's allocator.
+    Allocator* step_allocator = nullptr;
     CollectiveExecutor* collective_executor = nullptr;
     thread::ThreadPoolInterface* user_intra_op_threadpool = nullptr;
     tsl::CoordinationServiceAgent* coordination_service_agent = nullptr;
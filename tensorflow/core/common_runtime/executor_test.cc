@@ -25,6 +25,7 @@ limitations under the License.
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device_factory.h"
+#include "tensorflow/core/common_runtime/executor_factory.h"
 #include "tensorflow/core/common_runtime/graph_constructor.h"
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
 #include "tensorflow/core/common_runtime/lower_functional_ops.h"
@@ -91,9 +92,18 @@ class ExecutorTest : public ::testing::Test {
     params.delete_kernel = [](OpKernel* kernel) {
       DeleteNonCachedKernel(kernel);
     };
+    if (create_kernels_in_parallel_) {
+      params.create_kernel_thread_pool = thread_pool_;
+    }
     rendez_ = NewLocalRendezvous();
     delete exec_;
-    TF_CHECK_OK(NewLocalExecutor(params, *graph, &exec_));
+    if (executor_type_.empty()) {
+      TF_CHECK_OK(NewLocalExecutor(params, *graph, &exec_));
+    } else {
+      std::unique_ptr<Executor> exec;
+      TF_CHECK_OK(NewExecutor(executor_type_, params, *graph, &exec));
+      exec_ = exec.release();
+    }
     runner_ = [this](std::function<void()> fn) { thread_pool_->Schedule(fn); };
   }
 
@@ -112,6 +122,10 @@ class ExecutorTest : public ::testing::Test {
   StepStats step_stats_;
   Executor::Args::Runner runner_;
   Rendezvous* rendez_ = nullptr;
+  // If non-empty, `Create()` uses the executor registered under this type.
+  string executor_type_;
+  // If true, `Create()` creates the kernels on `thread_pool_`.
+  bool create_kernels_in_parallel_ = false;
 };
 
 // A float val -> Tensor<float>
@@ -266,6 +280,61 @@ TEST_F(ExecutorTest, RandomTree) {
   EXPECT_EQ(4096.0, V(out));
 }
 
+TEST_F(ExecutorTest, ParallelKernelCreationRandomTree) {
+  create_kernels_in_parallel_ = true;
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  BuildTree(4096, g.get());
+  Create(std::move(g));
+  Rendezvous::Args args;
+  TF_ASSERT_OK(
+      rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args, V(1.0), false));
+  TF_ASSERT_OK(Run(rendez_));
+  Tensor out = V(-1);
+  bool is_dead = false;
+  TF_ASSERT_OK(
+      rendez_->Recv(Key(BOB, kIncarnation, ALICE, "b"), args, &out, &is_dead));
+  EXPECT_EQ(4096.0, V(out));
+}
+
+TEST_F(ExecutorTest, WorkStealingRandomTree) {
+  executor_type_ = "WORK_STEALING_EXECUTOR";
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  BuildTree(4096, g.get());
+  Create(std::move(g));
+  for (int iters = 0; iters < 4; ++iters) {
+    Rendezvous* rendez = NewLocalRendezvous();
+    Rendezvous::Args args;
+    TF_ASSERT_OK(
+        rendez->Send(Key(ALICE, kIncarnation, BOB, "a"), args, V(1.0), false));
+    TF_ASSERT_OK(Run(rendez));
+    Tensor out = V(-1);
+    bool is_dead = false;
+    TF_ASSERT_OK(
+        rendez->Recv(Key(BOB, kIncarnation, ALICE, "b"), args, &out, &is_dead));
+    EXPECT_EQ(4096.0, V(out));
+    rendez->Unref();
+  }
+}
+
+TEST_F(ExecutorTest, WorkStealingSimpleSwitchDead) {
+  executor_type_ = "WORK_STEALING_EXECUTOR";
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  auto in0 = test::graph::Recv(g.get(), "a", "float", ALICE, 1, BOB);
+  auto in1 = test::graph::Constant(g.get(), VB(true));
+  auto tmp = test::graph::Switch(g.get(), in0, in1);
+  test::graph::Send(g.get(), tmp, "c", BOB, 1, ALICE);
+  Create(std::move(g));
+  Rendezvous::Args args;
+  TF_ASSERT_OK(rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args, V(1.0),
+                             false));  // in0 = 1.0
+  TF_ASSERT_OK(Run(rendez_));
+  Tensor out = V(-1);
+  bool is_dead = false;
+  TF_ASSERT_OK(
+      rendez_->Recv(Key(BOB, kIncarnation, ALICE, "c"), args, &out, &is_dead));
+  EXPECT_TRUE(is_dead);
+}
+
 void BuildConcurrentAddAssign(Graph* g) {
   auto one = test::graph::Constant(g, V(1.0));
   // A variable holds one float.
@@ -442,8 +511,10 @@ TEST_F(ExecutorTest, NoInputTensors) {
 
 // Create a graph that is 'depth' deep. At each level, fan-in and fan-out a
 // maximum of 'width' nodes. All nodes are no-ops and all dependencies are
-// control dependencies.
-static void BM_executor(::testing::benchmark::State& state) {
+// control dependencies. The graph is run by the executor registered under
+// `executor_type`.
+static void RunExecutorBenchmark(::testing::benchmark::State& state,
+                                 const char* executor_type) {
   const int width = state.range(0);
   const int depth = state.range(1);
 
@@ -477,12 +548,19 @@ static void BM_executor(::testing::benchmark::State& state) {
   }
 
   FixupSourceAndSinkEdges(g);
-  test::Benchmark("cpu", g, /*old_benchmark_api=*/false).Run(state);
+  test::Benchmark("cpu", g, /*options=*/nullptr, /*init=*/nullptr,
+                  /*rendez=*/nullptr, executor_type,
+                  /*old_benchmark_api=*/false)
+      .Run(state);
 
   state.SetLabel(strings::StrCat("Nodes = ", cur));
   state.SetItemsProcessed(cur * static_cast<int64_t>(state.iterations()));
 }
 
+static void BM_executor(::testing::benchmark::State& state) {
+  RunExecutorBenchmark(state, "");
+}
+
 // Tall skinny graphs
 BENCHMARK(BM_executor)->UseRealTime()->ArgPair(16, 1024);
 BENCHMARK(BM_executor)->UseRealTime()->ArgPair(32, 8192);
@@ -494,6 +572,15 @@ BENCHMARK(BM_executor)->UseRealTime()->ArgPair(8192, 32);
 // Tall fat graph
 BENCHMARK(BM_executor)->UseRealTime()->ArgPair(1024, 1024);
 
+static void BM_work_stealing_executor(::testing::benchmark::State& state) {
+  RunExecutorBenchmark(state, "WORK_STEALING_EXECUTOR");
+}
+
+BENCHMARK(BM_work_stealing_executor)->UseRealTime()->ArgPair(16, 1024);
+BENCHMARK(BM_work_stealing_executor)->UseRealTime()->ArgPair(1024, 16);
+BENCHMARK(BM_work_stealing_executor)->UseRealTime()->ArgPair(8192, 32);
+BENCHMARK(BM_work_stealing_executor)->UseRealTime()->ArgPair(1024, 1024);
+
 static void BM_const_identity(::testing::benchmark::State& state) {
   const int width = state.range(0);
   const int outputs_per_const = state.range(1);
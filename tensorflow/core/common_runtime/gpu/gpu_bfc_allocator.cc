@@ -95,6 +95,7 @@ GPUBFCAllocator::GPUBFCAllocator(
           o.garbage_collection = GetGarbageCollectionValue();
         }
         o.fragmentation_fraction = opts.fragmentation_fraction;
+        o.defragment_by_remapping = opts.defragment_by_remapping;
         return o;
       }()) {}
 
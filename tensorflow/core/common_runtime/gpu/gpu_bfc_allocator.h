@@ -46,6 +46,10 @@ class GPUBFCAllocator : public tsl::BFCAllocator {
 
     double fragmentation_fraction = 0;
     bool allow_retry_on_failure = true;
+
+    // Only effective with a sub-allocator that supports remapping, i.e. a
+    // GpuVirtualMemAllocator created with allow_remapping.
+    bool defragment_by_remapping = false;
   };
 
   GPUBFCAllocator(std::unique_ptr<tsl::SubAllocator> sub_allocator,
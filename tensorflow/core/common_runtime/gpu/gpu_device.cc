@@ -34,6 +34,7 @@ limitations under the License.
 #include <string.h>
 
 #include <algorithm>
+#include <atomic>
 #include <list>
 #include <map>
 #include <memory>
@@ -52,6 +53,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/gpu/gpu_device.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_id_manager.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_process_state.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_stream_util.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_util.h"
 #include "tensorflow/core/common_runtime/gpu_device_context.h"
 #include "tensorflow/core/common_runtime/local_device.h"
@@ -113,6 +115,10 @@ namespace tensorflow {
 
 namespace {
 
+// Maximum number of compute streams per device, bounded by the bitmasks used
+// by gpu_stream_util::GetWaitStreamsMask().
+constexpr int kMaxComputeStreams = 64;
+
 // Returns priority for the given virtual GPU id from the session options.
 // Returns 0 if no virtual devices are specified.
 int GetPriority(const int tf_device_id, const GPUOptions& options) {
@@ -421,6 +427,105 @@ class BaseGPUDevice::StreamGroupFactory {
   TF_DISALLOW_COPY_AND_ASSIGN(StreamGroupFactory);
 };
 
+// Wraps the device memory allocator of a GPU device that runs ops on several
+// compute streams.
+//
+// With a single compute stream a buffer can be reused as soon as it is freed,
+// because any later use of it is queued on the same stream after all earlier
+// uses. With several compute streams the last use of a freed buffer may still
+// be queued on another stream than the next user. The wrapper therefore holds
+// on to freed buffers and only returns them to the underlying allocator once
+// every compute stream has passed the point at which they were freed.
+class BaseGPUDevice::MultiStreamAllocator : public Allocator {
+ public:
+  // Does not take ownership of `allocator`, `streams` or `em`.
+  MultiStreamAllocator(Allocator* allocator, std::vector<se::Stream*> streams,
+                       EventMgr* em)
+      : allocator_(allocator), streams_(std::move(streams)), em_(em) {}
+
+  ~MultiStreamAllocator() override { FlushPendingFrees(); }
+
+  std::string Name() override { return allocator_->Name(); }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    return allocator_->AllocateRaw(alignment, num_bytes);
+  }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes,
+                    const AllocationAttributes& allocation_attr) override {
+    return allocator_->AllocateRaw(alignment, num_bytes, allocation_attr);
+  }
+
+  void DeallocateRaw(void* ptr) override {
+    mutex_lock l(mu_);
+    pending_frees_.push_back(ptr);
+  }
+
+  // Frees the buffers deallocated so far once all compute streams have
+  // completed the work queued on them until now.
+  void FlushPendingFrees() {
+    auto batch = std::make_shared<FreeBatch>();
+    {
+      mutex_lock l(mu_);
+      if (pending_frees_.empty()) return;
+      batch->ptrs.swap(pending_frees_);
+    }
+    batch->allocator = allocator_;
+    batch->pending_streams = streams_.size();
+    // The callbacks only hold on to the batch, so that they may run after the
+    // device and this wrapper were destroyed.
+    for (se::Stream* stream : streams_) {
+      em_->ThenExecute(stream, [batch]() {
+        if (batch->pending_streams.fetch_sub(1) == 1) {
+          for (void* ptr : batch->ptrs) batch->allocator->DeallocateRaw(ptr);
+        }
+      });
+    }
+  }
+
+  bool TracksAllocationSizes() const override {
+    return allocator_->TracksAllocationSizes();
+  }
+
+  size_t RequestedSize(const void* ptr) const override {
+    return allocator_->RequestedSize(ptr);
+  }
+
+  size_t AllocatedSize(const void* ptr) const override {
+    return allocator_->AllocatedSize(ptr);
+  }
+
+  int64_t AllocationId(const void* ptr) const override {
+    return allocator_->AllocationId(ptr);
+  }
+
+  absl::optional<AllocatorStats> GetStats() override {
+    return allocator_->GetStats();
+  }
+
+  bool ClearStats() override { return allocator_->ClearStats(); }
+
+  AllocatorMemoryType GetMemoryType() const override {
+    return allocator_->GetMemoryType();
+  }
+
+ private:
+  struct FreeBatch {
+    Allocator* allocator;
+    std::vector<void*> ptrs;
+    std::atomic<int> pending_streams;
+  };
+
+  Allocator* const allocator_;  // not owned
+  const std::vector<se::Stream*> streams_;
+  EventMgr* const em_;
+
+  mutex mu_;
+  std::vector<void*> pending_frees_ TF_GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(MultiStreamAllocator);
+};
+
 BaseGPUDevice::BaseGPUDevice(const SessionOptions& options, const string& name,
                              Bytes memory_limit, const DeviceLocality& locality,
                              tsl::TfDeviceId tf_device_id,
@@ -455,15 +560,23 @@ BaseGPUDevice::BaseGPUDevice(const SessionOptions& options, const string& name,
 
 BaseGPUDevice::~BaseGPUDevice() {
   delete accelerator_device_info_;
-  if (scratch_) gpu_allocator_->DeallocateRaw(scratch_);
+  for (char* scratch : scratch_) {
+    if (scratch) gpu_allocator_->DeallocateRaw(scratch);
+  }
   device_context_->Unref();
+  for (int i = 1; i < device_contexts_.size(); ++i) {
+    device_contexts_[i]->Unref();
+  }
+  for (auto& it : wait_contexts_) it.second->Unref();
 }
 
 // This should be idempotent if already initialized.
 Status BaseGPUDevice::InitScratchBuffers() {
   mutex_lock l(scratch_init_mutex_);
-  if (!scratch_) {
-    DCHECK(stream_);
+  DCHECK(stream_);
+  scratch_.resize(streams_.size(), nullptr);
+  for (int i = 0; i < scratch_.size(); ++i) {
+    if (scratch_[i]) continue;
     size_t scratch_buffer_size = Eigen::kGpuScratchSize + sizeof(unsigned int);
     profiler::ScopedMemoryDebugAnnotation op_annotation("ScratchBuffer");
     void* scratch_buffer = gpu_allocator_->AllocateRaw(
@@ -477,7 +590,7 @@ Status BaseGPUDevice::InitScratchBuffers() {
         se::DeviceMemoryBase(scratch_buffer, scratch_buffer_size));
     TF_RETURN_IF_ERROR(executor_->SynchronousMemZero(
         &mem, Eigen::kGpuScratchSize + sizeof(unsigned int)));
-    scratch_ = static_cast<char*>(scratch_buffer);
+    scratch_[i] = static_cast<char*>(scratch_buffer);
   }
   return OkStatus();
 }
@@ -568,6 +681,54 @@ Status BaseGPUDevice::Init(const SessionOptions& options) {
         timestamped_allocator_ ? gpu_allocator_ : nullptr, em_));
   }
 
+  int num_compute_streams =
+      options.config.gpu_options().experimental().num_compute_streams();
+  if (num_compute_streams < 1) num_compute_streams = 1;
+  if (num_compute_streams > kMaxComputeStreams) {
+    LOG(ERROR) << "Illegal GPUOptions.experimental.num_compute_streams="
+               << num_compute_streams << " set to " << kMaxComputeStreams
+               << " instead.";
+    num_compute_streams = kMaxComputeStreams;
+  }
+  if (num_compute_streams > 1 && kernel_tracker_) {
+    LOG(WARNING) << "GPUOptions.experimental.num_compute_streams is ignored "
+                    "when the GPU kernel tracker or the timestamped allocator "
+                    "is enabled.";
+    num_compute_streams = 1;
+  }
+#ifdef TF_GPU_USE_PJRT
+  if (num_compute_streams > 1) {
+    LOG(WARNING) << "GPUOptions.experimental.num_compute_streams is not "
+                    "supported with PJRT, using a single compute stream.";
+    num_compute_streams = 1;
+  }
+#endif  // TF_GPU_USE_PJRT
+  streams_.push_back(stream_);
+  device_contexts_.push_back(device_context_);
+#ifndef TF_GPU_USE_PJRT
+  for (int i = 1; i < num_compute_streams; ++i) {
+    StreamGroup* group = StreamGroupFactory::Global().GetOrCreate(
+        tf_device_id_, i, executor_, options.config.gpu_options());
+    streams_.push_back(group);
+    device_contexts_.push_back(new GPUDeviceContext(
+        i, group->compute,
+#if TENSORFLOW_USE_ROCM
+        group->nccl,
+#endif
+        group->host_to_device, group->device_to_host, group->device_to_device,
+        host_memory_allocator));
+  }
+#endif  // TF_GPU_USE_PJRT
+  if (streams_.size() > 1) {
+    std::vector<se::Stream*> compute_streams;
+    for (StreamGroup* group : streams_) {
+      compute_streams.push_back(group->compute);
+    }
+    multi_stream_allocator_ = std::make_unique<MultiStreamAllocator>(
+        gpu_allocator_, std::move(compute_streams), em_);
+    gpu_allocator_ = multi_stream_allocator_.get();
+  }
+
   accelerator_device_info_ = new DeviceBase::AcceleratorDeviceInfo;
   accelerator_device_info_->stream = stream_->compute;
   accelerator_device_info_->default_context = device_context_;
@@ -750,6 +911,7 @@ void BaseGPUDevice::Compute(OpKernel* op_kernel, OpKernelContext* context) {
   }
   se::Stream* stream = gpu_device_context->stream();
   const auto stream_id = gpu_device_context->stream_id();
+  PrepareComputeStream(gpu_device_context);
 
   const bool vlog_1 = VLOG_IS_ON(1);
 
@@ -828,7 +990,67 @@ Status BaseGPUDevice::Sync() {
   // enqueued the operation has completed.  We do use other streams for copies
   // and collectives, but in those cases the (Async)OpKernels themselves block
   // until the queued operation has finished.
-  return stream_->compute->BlockHostUntilDone();
+  if (multi_stream_allocator_) multi_stream_allocator_->FlushPendingFrees();
+  for (StreamGroup* group : streams_) {
+    TF_RETURN_IF_ERROR(group->compute->BlockHostUntilDone());
+  }
+  return OkStatus();
+}
+
+void BaseGPUDevice::PrepareComputeStream(GPUDeviceContext* gpu_device_context) {
+  if (!multi_stream_allocator_) return;
+  // Buffers freed before this op may still be read by kernels queued on other
+  // streams, hand them back to the allocator once those have run.
+  multi_stream_allocator_->FlushPendingFrees();
+  for (se::Stream* wait_stream : gpu_device_context->wait_streams()) {
+    gpu_device_context->stream()->ThenWaitFor(wait_stream);
+  }
+}
+
+Status BaseGPUDevice::FillContextMap(
+    const Graph* graph, std::vector<DeviceContext*>* device_context_map) {
+  if (streams_.size() <= 1) return OkStatus();
+  VLOG(2) << "FillContextMap";
+
+  gpu_stream_util::AssignStreamsOpts opts;
+  opts.max_streams = streams_.size();
+  std::vector<int> node_to_stream_id;
+  TF_RETURN_IF_ERROR(
+      gpu_stream_util::AssignStreams(graph, opts, &node_to_stream_id));
+
+  device_context_map->resize(graph->num_node_ids());
+  for (Node* node : graph->nodes()) {
+    (*device_context_map)[node->id()] = GetDeviceContext(
+        node_to_stream_id[node->id()],
+        gpu_stream_util::GetWaitStreamsMask(node, node_to_stream_id));
+  }
+  return OkStatus();
+}
+
+GPUDeviceContext* BaseGPUDevice::GetDeviceContext(int stream_id,
+                                                  uint64 wait_mask) {
+  if (wait_mask == 0) return device_contexts_[stream_id];
+  mutex_lock l(wait_contexts_mu_);
+  GPUDeviceContext*& context = wait_contexts_[{stream_id, wait_mask}];
+  if (context == nullptr) {
+    StreamGroup* group = streams_[stream_id];
+    context = new GPUDeviceContext(stream_id, group->compute,
+#if TENSORFLOW_USE_ROCM
+                                   group->nccl,
+#endif
+                                   group->host_to_device, group->device_to_host,
+                                   group->device_to_device,
+                                   device_contexts_[stream_id]
+                                       ->host_memory_allocator());
+    gtl::InlinedVector<se::Stream*, 4> wait_streams;
+    for (int i = 0; i < streams_.size(); ++i) {
+      if (wait_mask & (uint64{1} << i)) {
+        wait_streams.push_back(streams_[i]->compute);
+      }
+    }
+    context->set_wait_streams(std::move(wait_streams));
+  }
+  return context;
 }
 
 void BaseGPUDevice::ComputeAsync(AsyncOpKernel* op_kernel,
@@ -841,6 +1063,7 @@ void BaseGPUDevice::ComputeAsync(AsyncOpKernel* op_kernel,
   }
   se::Stream* stream = gpu_device_context->stream();
   const auto stream_id = gpu_device_context->stream_id();
+  PrepareComputeStream(gpu_device_context);
 
   VLOG(1) << "GpuDevice::ComputeAsync " << op_kernel->name() << " op "
           << op_kernel->type_string() << " on GPU" << tf_device_id_
@@ -1256,11 +1479,12 @@ void BaseGPUDevice::ReinitializeDevice(OpKernelContext* context,
   ConcretePerOpGpuDevice* concrete_device =
       static_cast<ConcretePerOpGpuDevice*>(device);
   DCHECK(concrete_device);
-  DCHECK_EQ(stream_id, 0);
+  DCHECK_GE(stream_id, 0);
+  DCHECK_LT(stream_id, static_cast<int>(streams_.size()));
   const gpuStream_t* gpu_stream = reinterpret_cast<const gpuStream_t*>(
-      stream_->compute->implementation()->GpuStreamMemberHack());
+      streams_[stream_id]->compute->implementation()->GpuStreamMemberHack());
   concrete_device->Reinitialize(context, gpu_stream, tf_device_id_, allocator,
-                                scratch_);
+                                scratch_[stream_id]);
 }
 
 PerOpGpuDevice* BaseGPUDevice::MakeGpuDevice() {
@@ -1277,7 +1501,6 @@ Status BaseGPUDevice::ReinitializeGpuDevice(OpKernelContext* context,
     const int stream_id = gpu_dc->stream_id();
     VLOG(1) << "  eigen_gpu_device(" << dc << ") => stream[" << stream_id
             << "]";
-    CHECK_EQ(stream_id, 0);
     ReinitializeDevice(context, device, stream_id, allocator);
   } else {
     ReinitializeDevice(context, device, 0, allocator);
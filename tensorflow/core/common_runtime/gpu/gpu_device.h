@@ -35,6 +35,7 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #ifdef TF_GPU_USE_PJRT
 #include "tensorflow/compiler/jit/pjrt_device_context.h"
@@ -142,6 +143,12 @@ class BaseGPUDevice : public LocalDevice {
                                DeviceContext* dc,
                                Allocator* allocator) override;
 
+  // Spreads the nodes of `graph` over the compute streams of the device when
+  // GPUOptions.experimental.num_compute_streams is larger than one.
+  Status FillContextMap(
+      const Graph* graph,
+      std::vector<DeviceContext*>* device_context_map) override;
+
   // Returns the platform GPU id of this device within the native driver system;
   // e.g., for CUDA and ROCm this is the ordinal of the GPU within the system.
   int gpu_id() const {
@@ -201,12 +208,28 @@ class BaseGPUDevice : public LocalDevice {
  private:
   friend class GPUDeviceTestHelper;
   class StreamGroupFactory;
+  class MultiStreamAllocator;
 
   core::RefCountPtr<DeviceContext> pjrt_device_context_;
   StreamGroup* stream_;
+  // The stream groups of all compute streams, streams_[0] == stream_.
+  gtl::InlinedVector<StreamGroup*, 4> streams_;
   mutex scratch_init_mutex_;
-  char* scratch_ = nullptr;
+  // Eigen scratch buffers, one per compute stream.
+  gtl::InlinedVector<char*, 4> scratch_;
   GPUDeviceContext* device_context_;
+  // One device context per compute stream, device_contexts_[0] ==
+  // device_context_.
+  gtl::InlinedVector<GPUDeviceContext*, 4> device_contexts_;
+  mutex wait_contexts_mu_;
+  // Device contexts of nodes that wait for other compute streams, keyed by
+  // stream id and bitmask of the streams to wait for.
+  absl::flat_hash_map<std::pair<int, uint64>, GPUDeviceContext*> wait_contexts_
+      TF_GUARDED_BY(wait_contexts_mu_);
+  // Defers the frees of device memory until all compute streams are done with
+  // it. Only set when there are several compute streams, in which case
+  // gpu_allocator_ points to it.
+  std::unique_ptr<MultiStreamAllocator> multi_stream_allocator_;
   DeviceBase::AcceleratorDeviceInfo* accelerator_device_info_ = nullptr;
   mutex trace_mu_;
   tsl::TfDeviceId tf_device_id_;
@@ -224,6 +247,14 @@ class BaseGPUDevice : public LocalDevice {
   void ReinitializeDevice(OpKernelContext* context, PerOpGpuDevice* device,
                           int stream_id, Allocator* allocator);
 
+  // Returns the device context running ops on the compute stream `stream_id`
+  // after the compute streams in `wait_mask`.
+  GPUDeviceContext* GetDeviceContext(int stream_id, uint64 wait_mask);
+
+  // Orders the stream of `gpu_device_context` after the streams that produce
+  // the inputs of the op about to run in it.
+  void PrepareComputeStream(GPUDeviceContext* gpu_device_context);
+
   std::string ComputeOpKernelDebugString(const OpKernel& op_kernel,
                                          const int& stream_id);
 
@@ -0,0 +1,124 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/gpu/gpu_stream_util.h"
+
+#include <vector>
+
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace gpu_stream_util {
+
+namespace {
+
+// Returns true if `node` has to run on stream 0, see AssignStreams().
+bool MustRunOnDefaultStream(const Node* node) {
+  if (!node->IsOp() || node->IsArg() || node->IsRetval() || node->IsSend() ||
+      node->IsRecv() || node->op_def().is_stateful()) {
+    return true;
+  }
+  for (DataType dtype : node->input_types()) {
+    if (dtype == DT_RESOURCE || IsRefType(dtype)) return true;
+  }
+  return false;
+}
+
+}  // namespace
+
+Status AssignStreams(const Graph* graph, const AssignStreamsOpts& opts,
+                     std::vector<int>* node_to_stream_id) {
+  if (opts.max_streams < 1 || opts.max_streams > 64) {
+    return errors::InvalidArgument(
+        "The number of compute streams must be in [1, 64], got ",
+        opts.max_streams);
+  }
+  node_to_stream_id->assign(graph->num_node_ids(), 0);
+  if (opts.max_streams == 1) return OkStatus();
+
+  std::vector<Node*> order;
+  GetReversePostOrder(*graph, &order);
+
+  // Whether a consumer of the node already continues on the node's stream.
+  std::vector<bool> stream_taken(graph->num_node_ids(), false);
+  // Whether the node may hand its stream over to one of its consumers. Nodes
+  // on the default stream and nodes without data inputs don't, so that
+  // consumers of arguments, variables and constants start new chains.
+  std::vector<bool> can_hand_over(graph->num_node_ids(), false);
+  // Nodes without data inputs, which run on the stream of their first
+  // consumer.
+  std::vector<const Node*> deferred;
+  int next_stream = 1;
+
+  for (const Node* node : order) {
+    if (MustRunOnDefaultStream(node)) continue;
+    int stream_id = -1;
+    bool has_data_inputs = false;
+    for (const Edge* edge : node->in_edges()) {
+      if (edge->IsControlEdge()) continue;
+      has_data_inputs = true;
+      const int src_id = edge->src()->id();
+      if (can_hand_over[src_id] && !stream_taken[src_id]) {
+        stream_taken[src_id] = true;
+        stream_id = (*node_to_stream_id)[src_id];
+        break;
+      }
+    }
+    if (!has_data_inputs) {
+      deferred.push_back(node);
+      continue;
+    }
+    if (stream_id < 0) {
+      stream_id = next_stream;
+      next_stream = (next_stream + 1) % opts.max_streams;
+    }
+    (*node_to_stream_id)[node->id()] = stream_id;
+    can_hand_over[node->id()] = true;
+  }
+
+  for (const Node* node : deferred) {
+    for (const Edge* edge : node->out_edges()) {
+      if (edge->IsControlEdge()) continue;
+      (*node_to_stream_id)[node->id()] =
+          (*node_to_stream_id)[edge->dst()->id()];
+      break;
+    }
+  }
+
+  if (VLOG_IS_ON(2)) {
+    for (const Node* node : graph->nodes()) {
+      VLOG(2) << "Node " << node->name() << " assigned to stream "
+              << (*node_to_stream_id)[node->id()];
+    }
+  }
+  return OkStatus();
+}
+
+uint64 GetWaitStreamsMask(const Node* node,
+                          const std::vector<int>& node_to_stream_id) {
+  const int stream_id = node_to_stream_id[node->id()];
+  uint64 mask = 0;
+  for (const Edge* edge : node->in_edges()) {
+    const int src_stream_id = node_to_stream_id[edge->src()->id()];
+    if (src_stream_id != stream_id) mask |= uint64{1} << src_stream_id;
+  }
+  return mask;
+}
+
+}  // namespace gpu_stream_util
+}  // namespace tensorflow
@@ -0,0 +1,54 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_STREAM_UTIL_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_STREAM_UTIL_H_
+
+#include <vector>
+
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/platform/status.h"
+
+namespace tensorflow {
+namespace gpu_stream_util {
+
+struct AssignStreamsOpts {
+  // Number of compute streams to spread the nodes over. At most 64.
+  int max_streams = 1;
+};
+
+// Given the input graph, assigns every node in the graph a compute stream id,
+// such that independent chains of nodes run on different streams while a node
+// usually stays on the stream of one of its producers.
+//
+// Nodes that touch state shared across graph executions (stateful ops, ops
+// taking resources or refs, sends, receives, arguments and return values)
+// are assigned stream 0, which is the stream that the rest of the device
+// (eager ops, copies, other graphs) is ordered against.
+//
+// On return, (*node_to_stream_id)[n->id()] is the stream id of node n.
+Status AssignStreams(const Graph* graph, const AssignStreamsOpts& opts,
+                     std::vector<int>* node_to_stream_id);
+
+// Returns a bitmask of the streams, other than the stream of `node`, that
+// produce inputs (data or control) of `node`. Bit i is set if stream i has to
+// be waited for before `node` runs.
+uint64 GetWaitStreamsMask(const Node* node,
+                          const std::vector<int>& node_to_stream_id);
+
+}  // namespace gpu_stream_util
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_STREAM_UTIL_H_
@@ -0,0 +1,157 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/gpu/gpu_stream_util.h"
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "tensorflow/cc/framework/scope.h"
+#include "tensorflow/cc/ops/array_ops.h"
+#include "tensorflow/cc/ops/const_op.h"
+#include "tensorflow/cc/ops/function_ops.h"
+#include "tensorflow/cc/ops/math_ops.h"
+#include "tensorflow/cc/ops/resource_variable_ops.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class GpuStreamUtilTest : public ::testing::Test {
+ protected:
+  // Assigns the nodes of `graph` to `max_streams` streams and returns the
+  // stream ids by node name.
+  std::unordered_map<std::string, int> AssignStreams(const Graph& graph,
+                                                     int max_streams) {
+    gpu_stream_util::AssignStreamsOpts opts;
+    opts.max_streams = max_streams;
+    TF_CHECK_OK(
+        gpu_stream_util::AssignStreams(&graph, opts, &node_to_stream_id_));
+    std::unordered_map<std::string, int> streams;
+    for (const Node* node : graph.nodes()) {
+      streams[node->name()] = node_to_stream_id_[node->id()];
+    }
+    return streams;
+  }
+
+  const Node* FindNode(const Graph& graph, const std::string& name) {
+    for (const Node* node : graph.nodes()) {
+      if (node->name() == name) return node;
+    }
+    return nullptr;
+  }
+
+  std::vector<int> node_to_stream_id_;
+};
+
+// Builds a graph with two independent chains of ops between an argument and
+// a return value.
+//
+//          a
+//        /   \
+//      x1     y1
+//      |      |
+//      x2     y2
+//        \   /
+//         sum
+//          |
+//         ret
+std::unique_ptr<Graph> TwoChains() {
+  Scope root = Scope::NewRootScope().ExitOnError();
+  auto a = ops::_Arg(root.WithOpName("a"), DT_FLOAT, 0);
+  auto x1 = ops::Square(root.WithOpName("x1"), a);
+  auto x2 = ops::Square(root.WithOpName("x2"), x1);
+  auto y1 = ops::Sqrt(root.WithOpName("y1"), a);
+  auto y2 = ops::Sqrt(root.WithOpName("y2"), y1);
+  auto sum = ops::Add(root.WithOpName("sum"), x2, y2);
+  ops::_Retval(root.WithOpName("ret"), sum, 0);
+  auto graph = std::make_unique<Graph>(OpRegistry::Global());
+  TF_CHECK_OK(root.ToGraph(graph.get()));
+  return graph;
+}
+
+TEST_F(GpuStreamUtilTest, InvalidNumberOfStreams) {
+  Graph graph(OpRegistry::Global());
+  gpu_stream_util::AssignStreamsOpts opts;
+  opts.max_streams = 0;
+  EXPECT_TRUE(errors::IsInvalidArgument(
+      gpu_stream_util::AssignStreams(&graph, opts, &node_to_stream_id_)));
+  opts.max_streams = 65;
+  EXPECT_TRUE(errors::IsInvalidArgument(
+      gpu_stream_util::AssignStreams(&graph, opts, &node_to_stream_id_)));
+}
+
+TEST_F(GpuStreamUtilTest, SingleStream) {
+  std::unique_ptr<Graph> graph = TwoChains();
+  for (const auto& it : AssignStreams(*graph, 1)) {
+    EXPECT_EQ(it.second, 0) << it.first;
+  }
+}
+
+TEST_F(GpuStreamUtilTest, IndependentChainsOnDifferentStreams) {
+  std::unique_ptr<Graph> graph = TwoChains();
+  auto streams = AssignStreams(*graph, 4);
+
+  EXPECT_EQ(streams["a"], 0);
+  EXPECT_EQ(streams["ret"], 0);
+  EXPECT_EQ(streams["x1"], streams["x2"]);
+  EXPECT_EQ(streams["y1"], streams["y2"]);
+  EXPECT_NE(streams["x1"], streams["y1"]);
+  EXPECT_TRUE(streams["sum"] == streams["x2"] ||
+              streams["sum"] == streams["y2"]);
+
+  // Nodes wait for the streams of their producers, and only for those.
+  const int other_chain =
+      streams["sum"] == streams["x2"] ? streams["y2"] : streams["x2"];
+  EXPECT_EQ(gpu_stream_util::GetWaitStreamsMask(FindNode(*graph, "sum"),
+                                                node_to_stream_id_),
+            uint64{1} << other_chain);
+  EXPECT_EQ(gpu_stream_util::GetWaitStreamsMask(FindNode(*graph, "x2"),
+                                                node_to_stream_id_),
+            uint64{0});
+  EXPECT_EQ(gpu_stream_util::GetWaitStreamsMask(FindNode(*graph, "ret"),
+                                                node_to_stream_id_),
+            uint64{1} << streams["sum"]);
+}
+
+TEST_F(GpuStreamUtilTest, StatefulOpsOnDefaultStream) {
+  Scope root = Scope::NewRootScope().ExitOnError();
+  auto var = ops::VarHandleOp(root.WithOpName("var"), DT_FLOAT, {});
+  auto read = ops::ReadVariableOp(root.WithOpName("read"), var, DT_FLOAT);
+  auto c = ops::Const(root.WithOpName("c"), 2.0f);
+  auto mul = ops::Mul(root.WithOpName("mul"), read, c);
+  auto sq = ops::Square(root.WithOpName("sq"), mul);
+  ops::AssignVariableOp(root.WithOpName("assign"), var, sq);
+  Graph graph(OpRegistry::Global());
+  TF_ASSERT_OK(root.ToGraph(&graph));
+
+  auto streams = AssignStreams(graph, 2);
+  EXPECT_EQ(streams["var"], 0);
+  EXPECT_EQ(streams["read"], 0);
+  EXPECT_EQ(streams["assign"], 0);
+  // The consumers of the variable start a new chain, constants run on the
+  // stream of their consumer.
+  EXPECT_EQ(streams["mul"], 1);
+  EXPECT_EQ(streams["sq"], 1);
+  EXPECT_EQ(streams["c"], 1);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -265,6 +265,19 @@ bool NeedStaging(const Tensor* tensor) {
   return tensor->GetMemoryType() == AllocatorMemoryType::kHostPageable;
 }
 
+// Copies from pageable host memory to the GPU are staged through pinned
+// buffers of at most this size. Splitting large copies into chunks lets the
+// DMA of one chunk overlap with the host memcpy of the next, and lets the
+// pinned allocator recycle the buffers of completed chunks.
+constexpr int64_t kStagingChunkBytes = 8 << 20;
+
+// Copies from the GPU to pageable host memory of at most this size are staged
+// through a pinned buffer, so that they don't block the calling thread while
+// the driver stages them. The data is then copied out of the pinned buffer by
+// the EventMgr callback, which is only cheap enough for small tensors; larger
+// copies are left to the driver.
+constexpr int64_t kMaxStagedDeviceToHostBytes = 1 << 20;
+
 }  // namespace
 
 // static
@@ -293,21 +306,36 @@ void GPUUtil::CopyGPUTensorToCPU(Device* gpu_device,
   send_device_to_host_stream->ThenWaitFor(send_stream);
 
   const int64_t total_bytes = gpu_tensor->TotalBytes();
+  Allocator* host_memory_allocator = device_context->host_memory_allocator();
+  void* dst_ptr = GetBase(cpu_tensor);
+  void* staging_buffer = nullptr;
   if (total_bytes > 0) {
     void* src_ptr = GetBase(gpu_tensor);
     DeviceMemoryBase gpu_src_ptr(src_ptr, total_bytes);
-    void* dst_ptr = GetBase(cpu_tensor);
-    send_device_to_host_stream->ThenMemcpy(dst_ptr, gpu_src_ptr, total_bytes);
+    if (NeedStaging(cpu_tensor) && host_memory_allocator != nullptr &&
+        total_bytes <= kMaxStagedDeviceToHostBytes) {
+      // Falls back to copying directly if no pinned memory is left.
+      staging_buffer = host_memory_allocator->AllocateRaw(
+          Allocator::kAllocatorAlignment, total_bytes);
+    }
+    send_device_to_host_stream->ThenMemcpy(
+        staging_buffer != nullptr ? staging_buffer : dst_ptr, gpu_src_ptr,
+        total_bytes);
   }
   // Use of the input may outlive stack scope, so keep a ref.
   TensorReference input_ref(*gpu_tensor);
   dev_info->event_mgr->ThenExecute(
       send_device_to_host_stream,
-      [send_device_to_host_stream, done, input_ref]() {
+      [send_device_to_host_stream, done, input_ref, staging_buffer, dst_ptr,
+       total_bytes, host_memory_allocator]() {
         if (!send_device_to_host_stream->ok()) {
           LOG(FATAL) << "GPU->CPU Memcpy failed";
         }
         input_ref.Unref();
+        if (staging_buffer != nullptr) {
+          std::memcpy(dst_ptr, staging_buffer, total_bytes);
+          host_memory_allocator->DeallocateRaw(staging_buffer);
+        }
         done(OkStatus());
       });
 }
@@ -342,7 +370,9 @@ void GPUUtil::CopyCPUTensorToGPU(const Tensor* cpu_tensor,
   const int64_t total_bytes = cpu_tensor->TotalBytes();
 
   bool do_staging = false;
-  void* staging_buffer = nullptr;
+  // Whether the whole input was staged, in which case it no longer needs to
+  // be kept alive.
+  bool input_released = false;
   Allocator* host_memory_allocator = device_context->host_memory_allocator();
 
   // Use of cpu_tensor may outlive stack scope, so keep a ref.
@@ -350,9 +380,8 @@ void GPUUtil::CopyCPUTensorToGPU(const Tensor* cpu_tensor,
 
   // Note that 0-size tensors have no backing buffer.
   if (total_bytes > 0) {
-    void* src_ptr = GetBase(cpu_tensor);
-    void* dst_ptr = GetBase(gpu_tensor);
-    DeviceMemoryBase gpu_dst_ptr(dst_ptr, total_bytes);
+    char* src_ptr = static_cast<char*>(GetBase(cpu_tensor));
+    char* dst_ptr = static_cast<char*>(GetBase(gpu_tensor));
 
     if (NeedStaging(cpu_tensor)) {
       if (host_memory_allocator == nullptr) {
@@ -364,27 +393,45 @@ void GPUUtil::CopyCPUTensorToGPU(const Tensor* cpu_tensor,
       }
     }
 
+    int64_t offset = 0;
     if (do_staging) {
-      staging_buffer = host_memory_allocator->AllocateRaw(
-          tensorflow::Allocator::kAllocatorAlignment, total_bytes);
-      std::memcpy(staging_buffer, src_ptr, total_bytes);
-      input_ref.Unref();
-
-      recv_host_to_device_stream->ThenMemcpy(&gpu_dst_ptr, staging_buffer,
-                                             total_bytes);
-    } else {
-      recv_host_to_device_stream->ThenMemcpy(&gpu_dst_ptr, src_ptr,
-                                             total_bytes);
+      for (; offset < total_bytes; offset += kStagingChunkBytes) {
+        const int64_t chunk_bytes =
+            std::min(kStagingChunkBytes, total_bytes - offset);
+        void* staging_buffer = host_memory_allocator->AllocateRaw(
+            tensorflow::Allocator::kAllocatorAlignment, chunk_bytes);
+        if (staging_buffer == nullptr) {
+          LOG_FIRST_N(WARNING, 1)
+              << "Failed to allocate pinned memory to stage data for "
+                 "CPU->GPU transfer. Staging will be skipped.";
+          break;
+        }
+        std::memcpy(staging_buffer, src_ptr + offset, chunk_bytes);
+        DeviceMemoryBase gpu_dst_chunk(dst_ptr + offset, chunk_bytes);
+        recv_host_to_device_stream->ThenMemcpy(&gpu_dst_chunk, staging_buffer,
+                                               chunk_bytes);
+        dev_info->event_mgr->ThenExecute(
+            recv_host_to_device_stream,
+            [host_memory_allocator, staging_buffer]() {
+              host_memory_allocator->DeallocateRaw(staging_buffer);
+            });
+      }
+      if (offset == total_bytes) {
+        input_ref.Unref();
+        input_released = true;
+      }
+    }
+    if (offset < total_bytes) {
+      DeviceMemoryBase gpu_dst_ptr(dst_ptr + offset, total_bytes - offset);
+      recv_host_to_device_stream->ThenMemcpy(&gpu_dst_ptr, src_ptr + offset,
+                                             total_bytes - offset);
     }
   }
 
   dev_info->event_mgr->ThenExecute(
       recv_host_to_device_stream,
-      [recv_host_to_device_stream, done, input_ref, do_staging, staging_buffer,
-       host_memory_allocator]() {
-        if (do_staging) {
-          host_memory_allocator->DeallocateRaw(staging_buffer);
-        } else {
+      [recv_host_to_device_stream, done, input_ref, input_released]() {
+        if (!input_released) {
           input_ref.Unref();
         }
         if (!recv_host_to_device_stream->ok()) {
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/gpu/gpu_virtual_mem_allocator.h"
 
+#include <algorithm>
+
 #include "absl/strings/str_format.h"
 #include "tensorflow/compiler/xla/stream_executor/stream_executor.h"
 #include "tensorflow/tsl/platform/numbers.h"
@@ -63,7 +65,8 @@ GpuVirtualMemAllocator::Create(
     const std::vector<Visitor>& alloc_visitors,
     const std::vector<Visitor>& free_visitors, GpuContext& gpu_context,
     tsl::PlatformDeviceId gpu_id, size_t virtual_address_space_size,
-    const std::vector<tsl::PlatformDeviceId>& peer_gpu_ids) {
+    const std::vector<tsl::PlatformDeviceId>& peer_gpu_ids,
+    bool allow_remapping) {
   tsl::profiler::TraceMe traceme("GpuVirtualMemAllocator::Create");
 
   std::vector<GpuDeviceHandle> access_gpu_handles;
@@ -107,7 +110,7 @@ GpuVirtualMemAllocator::Create(
 
   return std::unique_ptr<GpuVirtualMemAllocator>(new GpuVirtualMemAllocator(
       alloc_visitors, free_visitors, gpu_context, gpu_id,
-      std::move(access_gpu_handles), vmem, max_granularity));
+      std::move(access_gpu_handles), vmem, max_granularity, allow_remapping));
 }
 
 GpuVirtualMemAllocator::GpuVirtualMemAllocator(
@@ -115,13 +118,14 @@ GpuVirtualMemAllocator::GpuVirtualMemAllocator(
     const std::vector<Visitor>& free_visitors, GpuContext& gpu_context,
     tsl::PlatformDeviceId gpu_id,
     const std::vector<GpuDeviceHandle> access_gpu_handles,
-    GpuDriver::VmemSpan vmem, size_t granularity)
+    GpuDriver::VmemSpan vmem, size_t granularity, bool allow_remapping)
     : SubAllocator(alloc_visitors, free_visitors),
       gpu_context_(gpu_context),
       gpu_id_(gpu_id),
       access_gpu_handles_(access_gpu_handles),
       vmem_(vmem),
-      granularity_(granularity) {}
+      granularity_(granularity),
+      allow_remapping_(allow_remapping) {}
 
 GpuVirtualMemAllocator::~GpuVirtualMemAllocator() {
   for (const auto mapping : mappings_) {
@@ -151,25 +155,43 @@ void* GpuVirtualMemAllocator::Alloc(size_t alignment, size_t num_bytes,
     return nullptr;
   }
 
-  // Create physical memory backing allocation.
-  auto maybe_handle =
-      GpuDriver::CreateMemoryHandle(&gpu_context_, padded_bytes);
-  if (!maybe_handle.ok()) {
-    LOG(ERROR) << maybe_handle.status();
-    return nullptr;
-  }
-  GpuDriver::GenericMemoryHandle handle = std::move(maybe_handle).value();
-
-  // Map VAs for this physical memory.
-  auto status =
-      GpuDriver::MapMemory(&gpu_context_, next_va, handle, access_gpu_handles_);
-  if (!status.ok()) {
-    LOG(ERROR) << status;
-    GpuDriver::ReleaseMemoryHandle(&gpu_context_, std::move(handle));
-    return nullptr;
+  // Releases the mappings created by this call if one of them fails. They are
+  // the last ones since nothing is mapped past next_alloc_offset_.
+  auto release_new_mappings = [&] {
+    while (!mappings_.empty() && mappings_.back().va >= next_va) {
+      Mapping& mapping = mappings_.back();
+      GpuDriver::UnmapMemory(&gpu_context_, mapping.va, mapping.physical.bytes);
+      GpuDriver::ReleaseMemoryHandle(&gpu_context_,
+                                     std::move(mapping.physical));
+      mappings_.pop_back();
+    }
+  };
+
+  // Create physical memory backing allocation, in granularity-sized pieces if
+  // the pages may be remapped later.
+  const size_t handle_bytes = allow_remapping_ ? granularity_ : padded_bytes;
+  for (size_t offset = 0; offset < padded_bytes; offset += handle_bytes) {
+    auto maybe_handle =
+        GpuDriver::CreateMemoryHandle(&gpu_context_, handle_bytes);
+    if (!maybe_handle.ok()) {
+      LOG(ERROR) << maybe_handle.status();
+      release_new_mappings();
+      return nullptr;
+    }
+    GpuDriver::GenericMemoryHandle handle = std::move(maybe_handle).value();
+
+    // Map VAs for this physical memory.
+    auto status = GpuDriver::MapMemory(&gpu_context_, next_va + offset, handle,
+                                       access_gpu_handles_);
+    if (!status.ok()) {
+      LOG(ERROR) << status;
+      GpuDriver::ReleaseMemoryHandle(&gpu_context_, std::move(handle));
+      release_new_mappings();
+      return nullptr;
+    }
+    mappings_.push_back({next_va + offset, std::move(handle)});
   }
-  next_alloc_offset_ += handle.bytes;
-  mappings_.push_back({next_va, std::move(handle)});
+  next_alloc_offset_ += padded_bytes;
   VisitAlloc(reinterpret_cast<void*>(next_va), gpu_id_.value(), padded_bytes);
   *bytes_received = padded_bytes;
   return reinterpret_cast<void*>(next_va);
@@ -224,6 +246,102 @@ void GpuVirtualMemAllocator::Free(void* ptr, size_t num_bytes) {
   VisitFree(ptr, gpu_id_.value(), num_bytes);
 }
 
+void* GpuVirtualMemAllocator::Remap(
+    absl::Span<const std::pair<void*, size_t>> ranges, size_t* bytes_received) {
+  tsl::profiler::TraceMe traceme("GpuVirtualMemAllocator::Remap");
+
+  if (!allow_remapping_ || ranges.empty()) return nullptr;
+
+  // Indices in mappings_ of the pages to move, in order.
+  std::vector<size_t> indices;
+  size_t total_bytes = 0;
+  for (const auto& [ptr, num_bytes] : ranges) {
+    auto mapping_it = std::lower_bound(
+        mappings_.begin(), mappings_.end(), ptr,
+        [](const Mapping& mapping, const void* ptr) {
+          return reinterpret_cast<const void*>(mapping.va) < ptr;
+        });
+    size_t range_bytes = 0;
+    if (mapping_it != mappings_.end() &&
+        reinterpret_cast<void*>(mapping_it->va) == ptr) {
+      for (auto it = mapping_it;
+           it != mappings_.end() && range_bytes < num_bytes; ++it) {
+        indices.push_back(it - mappings_.begin());
+        range_bytes += it->physical.bytes;
+      }
+    }
+    if (range_bytes != num_bytes) {
+      LOG(ERROR) << "Could not find GPU vmem mappings of "
+                 << tsl::strings::HumanReadableNumBytes(num_bytes) << " at "
+                 << reinterpret_cast<uintptr_t>(ptr);
+      return nullptr;
+    }
+    total_bytes += num_bytes;
+  }
+
+  GpuDevicePtr new_va = vmem_.base + next_alloc_offset_;
+  if (new_va + total_bytes > vmem_.base + vmem_.size_bytes) {
+    VLOG(1) << "Not enough GPU virtual address space left to remap "
+            << tsl::strings::HumanReadableNumBytes(total_bytes);
+    return nullptr;
+  }
+
+  // Unmaps the new addresses of the pages mapped so far, one page at a time
+  // since partial unmapping of a mapping is not supported.
+  auto unmap_new_addresses = [&](GpuDevicePtr end_va) {
+    GpuDevicePtr va = new_va;
+    for (size_t index : indices) {
+      if (va >= end_va) break;
+      GpuDriver::UnmapMemory(&gpu_context_, va,
+                             mappings_[index].physical.bytes);
+      va += mappings_[index].physical.bytes;
+    }
+  };
+
+  // The pages are mapped at their new addresses before any old address is
+  // unmapped, so that a failure leaves the ranges untouched.
+  GpuDevicePtr va = new_va;
+  for (size_t index : indices) {
+    const Mapping& mapping = mappings_[index];
+    auto status = GpuDriver::MapMemory(&gpu_context_, va, mapping.physical,
+                                       access_gpu_handles_);
+    if (!status.ok()) {
+      LOG(ERROR) << status;
+      unmap_new_addresses(va);
+      return nullptr;
+    }
+    va += mapping.physical.bytes;
+  }
+
+  // Kernels enqueued before the ranges were freed may still access them
+  // through the old addresses.
+  if (!GpuDriver::SynchronizeContext(&gpu_context_)) {
+    LOG(ERROR) << "Failed to synchronize the GPU context before remapping";
+    unmap_new_addresses(va);
+    return nullptr;
+  }
+
+  va = new_va;
+  for (size_t index : indices) {
+    Mapping& mapping = mappings_[index];
+    GpuDriver::UnmapMemory(&gpu_context_, mapping.va, mapping.physical.bytes);
+    mapping.va = va;
+    va += mapping.physical.bytes;
+  }
+  std::sort(mappings_.begin(), mappings_.end(),
+            [](const Mapping& a, const Mapping& b) { return a.va < b.va; });
+  next_alloc_offset_ += total_bytes;
+
+  VLOG(1) << "Remapped " << indices.size() << " mappings for a total of "
+          << total_bytes << " bytes";
+  for (const auto& [ptr, num_bytes] : ranges) {
+    VisitFree(ptr, gpu_id_.value(), num_bytes);
+  }
+  VisitAlloc(reinterpret_cast<void*>(new_va), gpu_id_.value(), total_bytes);
+  *bytes_received = total_bytes;
+  return reinterpret_cast<void*>(new_va);
+}
+
 }  // namespace tensorflow
 
 #endif
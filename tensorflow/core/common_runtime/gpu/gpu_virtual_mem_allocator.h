@@ -19,8 +19,11 @@ limitations under the License.
 #define TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_VIRTUAL_MEM_ALLOCATOR_H_
 
 #include <memory>
+#include <utility>
 #include <vector>
 
+#include "absl/types/span.h"
+
 #include "tensorflow/compiler/xla/stream_executor/stream_executor.h"
 #include "tensorflow/tsl/framework/allocator.h"
 #include "tensorflow/tsl/framework/device_id.h"
@@ -39,6 +42,10 @@ namespace tensorflow {
 // reserving a large chunk of virtual addresses at construction and then mapping
 // physical memory pages to this virtual address range as requested.
 //
+// If `allow_remapping` is set, physical memory is created in
+// granularity-sized pieces so that the BFC allocator can move the pages of free
+// holes to the end of the reservation with Remap() and free the old addresses.
+//
 // This class is not thread-safe.
 class GpuVirtualMemAllocator : public tsl::SubAllocator {
  public:
@@ -47,7 +54,8 @@ class GpuVirtualMemAllocator : public tsl::SubAllocator {
       const std::vector<Visitor>& free_visitors,
       stream_executor::gpu::GpuContext& gpu_context,
       tsl::PlatformDeviceId gpu_id, size_t virtual_address_space_size,
-      const std::vector<tsl::PlatformDeviceId>& peer_gpu_ids);
+      const std::vector<tsl::PlatformDeviceId>& peer_gpu_ids,
+      bool allow_remapping = false);
   ~GpuVirtualMemAllocator() override;
 
   // Allocates memory at least as large as requested by num_bytes. Will be
@@ -71,6 +79,15 @@ class GpuVirtualMemAllocator : public tsl::SubAllocator {
 
   bool SupportsCoalescing() const override { return true; }
 
+  size_t RemapGranularity() const override {
+    return allow_remapping_ ? granularity_ : 0;
+  }
+
+  // Maps the physical memory of `ranges` at the end of the reservation, waits
+  // for the work pending on the context and unmaps the old addresses.
+  void* Remap(absl::Span<const std::pair<void*, size_t>> ranges,
+              size_t* bytes_received) override;
+
  private:
   GpuVirtualMemAllocator(
       const std::vector<Visitor>& alloc_visitors,
@@ -78,7 +95,8 @@ class GpuVirtualMemAllocator : public tsl::SubAllocator {
       stream_executor::gpu::GpuContext& gpu_context,
       tsl::PlatformDeviceId gpu_id,
       std::vector<stream_executor::gpu::GpuDeviceHandle> access_device_handles,
-      stream_executor::gpu::GpuDriver::VmemSpan vmem, size_t granularity);
+      stream_executor::gpu::GpuDriver::VmemSpan vmem, size_t granularity,
+      bool allow_remapping);
 
   stream_executor::gpu::GpuContext& gpu_context_;
   tsl::PlatformDeviceId gpu_id_;
@@ -99,6 +117,10 @@ class GpuVirtualMemAllocator : public tsl::SubAllocator {
   // Smallest allocation as determined by CUDA.
   const size_t granularity_;
 
+  // Whether each granularity-sized page gets its own physical memory handle,
+  // so that any page can be remapped or freed on its own.
+  const bool allow_remapping_;
+
   struct Mapping {
     stream_executor::gpu::GpuDevicePtr va;
     stream_executor::gpu::GpuDriver::GenericMemoryHandle physical;
@@ -17,6 +17,8 @@ limitations under the License.
 
 #if CUDA_VERSION >= 10020
 
+#include <utility>
+
 #include "tensorflow/compiler/xla/stream_executor/device_id_utils.h"
 #include "tensorflow/compiler/xla/stream_executor/gpu/gpu_init.h"
 #include "tensorflow/core/platform/test.h"
@@ -34,7 +36,8 @@ using ::stream_executor::gpu::GpuDriver;
 constexpr size_t k2MiB{2 << 20};
 
 // Creates an allocator with 8 MiB of virtual address space.
-std::unique_ptr<GpuVirtualMemAllocator> CreateAllocator() {
+std::unique_ptr<GpuVirtualMemAllocator> CreateAllocator(
+    bool allow_remapping = false) {
   tsl::PlatformDeviceId gpu_id(0);
   auto executor = se::DeviceIdUtil::ExecutorForPlatformDeviceId(
                       se::GPUMachineManager(), gpu_id)
@@ -43,7 +46,7 @@ std::unique_ptr<GpuVirtualMemAllocator> CreateAllocator() {
       executor->implementation()->GpuContextHack());
   return GpuVirtualMemAllocator::Create(
              {}, {}, *gpu_context, gpu_id,
-             /*virtual_address_space_size=*/4 * k2MiB, {})
+             /*virtual_address_space_size=*/4 * k2MiB, {}, allow_remapping)
       .value();
 }
 
@@ -179,6 +182,31 @@ TEST(GpuVirtualMemAllocatorTest, FreeRange) {
   ASSERT_EQ(re_alloc, first_alloc);
 }
 
+TEST(GpuVirtualMemAllocatorTest, Remap) {
+  auto allocator = CreateAllocator(/*allow_remapping=*/true);
+  ASSERT_EQ(allocator->RemapGranularity(), k2MiB);
+  size_t bytes_received;
+  void* alloc = allocator->Alloc(/*alignment=*/0, /*num_bytes=*/2 * k2MiB,
+                                 &bytes_received);
+  ASSERT_NE(alloc, nullptr);
+
+  // The first page moves to the end of the allocated addresses.
+  std::pair<void*, size_t> first_page = {alloc, k2MiB};
+  void* remapped = allocator->Remap({first_page}, &bytes_received);
+  ASSERT_EQ(remapped, reinterpret_cast<const char*>(alloc) + 2 * k2MiB);
+  ASSERT_EQ(bytes_received, k2MiB);
+
+  // Only one page of virtual addresses is left.
+  std::pair<void*, size_t> second_page = {
+      reinterpret_cast<char*>(alloc) + k2MiB, k2MiB};
+  std::pair<void*, size_t> remapped_page = {remapped, k2MiB};
+  ASSERT_EQ(allocator->Remap({second_page, remapped_page}, &bytes_received),
+            nullptr);
+
+  allocator->Free(second_page.first, k2MiB);
+  allocator->Free(remapped, k2MiB);
+}
+
 }  // namespace
 }  // namespace tensorflow
 
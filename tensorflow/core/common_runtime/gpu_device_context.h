@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_GPU_DEVICE_CONTEXT_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_GPU_DEVICE_CONTEXT_H_
 
+#include <utility>
+
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
@@ -60,6 +62,14 @@ class GPUDeviceContext : public DeviceContext {
     return device_to_device_stream_[index % device_to_device_stream_.size()];
   }
   int stream_id() const { return stream_id_; }
+  // Other compute streams that stream() must wait for before running an op in
+  // this context, because the op consumes values produced on them.
+  const gtl::InlinedVector<se::Stream*, 4>& wait_streams() const {
+    return wait_streams_;
+  }
+  void set_wait_streams(gtl::InlinedVector<se::Stream*, 4> wait_streams) {
+    wait_streams_ = std::move(wait_streams);
+  }
   Allocator* host_memory_allocator() const override {
     return host_memory_allocator_;
   }
@@ -97,6 +107,8 @@ class GPUDeviceContext : public DeviceContext {
   se::Stream* device_to_host_stream_;
   // Streams to use for copying data between GPUs.
   gtl::InlinedVector<se::Stream*, 4> device_to_device_stream_;
+  // Compute streams to wait for before running an op in this context.
+  gtl::InlinedVector<se::Stream*, 4> wait_streams_;
   // The allocator to use for allocating pinned host memory.
   // Not owned.
   Allocator* host_memory_allocator_;
@@ -39,6 +39,7 @@ limitations under the License.
 #include "tensorflow/core/framework/graph_debug_info.pb.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/node_properties.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/versions.h"
@@ -55,6 +56,7 @@ limitations under the License.
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/public/version.h"
 
 namespace tensorflow {
@@ -109,7 +111,8 @@ class GraphConstructor {
           importing(false),
           validate_nodes(in.validate_nodes),
           validate_colocation_constraints(false),
-          add_default_attributes(in.add_default_attributes) {}
+          add_default_attributes(in.add_default_attributes),
+          thread_pool(in.thread_pool) {}
     Options(const ImportGraphDefOptions& in)  // NOLINT(runtime/explicit)
         : allow_internal_ops(false),
           expect_device_spec(false),
@@ -164,6 +167,10 @@ class GraphConstructor {
     bool add_default_attributes = true;
 
     string default_device;
+
+    // If set, nodes are prepared in parallel on this thread pool. Only used
+    // when not `importing`.
+    thread::ThreadPool* thread_pool = nullptr;
   };
 
   typedef gtl::ArraySlice<const NodeDef*> NodeDefSlice;
@@ -248,6 +255,14 @@ class GraphConstructor {
   Status IsNodeFullyMapped(const NodeDef& node_def, bool* is_node_mapped);
   Status ValidateColocationConstraints(const NodeDef& node_def);
   Status MakeNode(NodeDef&& node_def, Node** node);
+  Status MakeNode(Graph::PreparedNode&& prepared, Node** node);
+  void MaybeAssignDevice(Node* node);
+  // Adds default attributes to `node_def` and validates it, as requested by
+  // `opts_`. Only used when not `importing`.
+  Status AddDefaultsAndValidate(NodeDef* node_def) const;
+  // Consumes all the NodeDefs and prepares their nodes in parallel on
+  // `opts_.thread_pool`, filling in `prepared_nodes_`.
+  void PrepareNodes();
   Status MakeEdge(Node* src, int output_index, Node* dst, int input_index);
   Status ValidateShape(Node* node);
   Status ModifyNodeDefForImport(NodeDef* node_def);
@@ -339,6 +354,18 @@ class GraphConstructor {
   // Intermediate datastructure used to track the destinations of back edges.
   absl::flat_hash_set<int> merge_node_indices_;
 
+  // A NodeDef consumed by PrepareNodes().
+  struct PreparedNodeDef {
+    const NodeDef& def() const {
+      return node.ok() ? node->props->node_def : node_def;
+    }
+    // The NodeDef, if preparing its node failed.
+    NodeDef node_def;
+    StatusOr<Graph::PreparedNode> node;
+  };
+  // Indexed like node_defs_. Empty unless the nodes are prepared in parallel.
+  std::vector<PreparedNodeDef> prepared_nodes_;
+
   // Mapping from node name to the index within node_defs_.
   struct NodeInfo {
     explicit NodeInfo(int i) : gdef_index(i), node(nullptr) {}
@@ -808,13 +835,59 @@ Status GraphConstructor::MakeNode(NodeDef&& node_def, Node** node) {
   Status status;
   *node = g_->AddNode(std::move(node_def), &status);
   if (!status.ok()) return status;
+  MaybeAssignDevice(*node);
+  return OkStatus();
+}
+
+Status GraphConstructor::MakeNode(Graph::PreparedNode&& prepared,
+                                  Node** node) {
+  *node = g_->AddPreparedNode(std::move(prepared));
+  MaybeAssignDevice(*node);
+  return OkStatus();
+}
+
+void GraphConstructor::MaybeAssignDevice(Node* node) {
   if (opts_.expect_device_spec ||
-      (opts_.propagate_device_spec && !(*node)->def().device().empty())) {
-    (*node)->set_assigned_device_name((*node)->def().device());
+      (opts_.propagate_device_spec && !node->def().device().empty())) {
+    node->set_assigned_device_name(node->def().device());
+  }
+}
+
+Status GraphConstructor::AddDefaultsAndValidate(NodeDef* node_def) const {
+  const OpDef* op_def;
+  TF_RETURN_IF_ERROR(g_->op_registry()->LookUpOpDef(node_def->op(), &op_def));
+  if (opts_.add_default_attributes) {
+    AddDefaultsToNodeDef(*op_def, node_def);
+  }
+  if (opts_.validate_nodes) {
+    TF_RETURN_IF_ERROR(ValidateNodeDef(*node_def, *op_def));
   }
   return OkStatus();
 }
 
+void GraphConstructor::PrepareNodes() {
+  const int num_nodes = node_def_count();
+  // consume_node_def() is not thread-safe, but it is only a move.
+  prepared_nodes_.resize(num_nodes);
+  for (int i = 0; i < num_nodes; ++i) {
+    prepared_nodes_[i].node_def = consume_node_def(i);
+  }
+  // Rough cost of looking up, validating and specializing one node, in cycles.
+  constexpr int64_t kPrepareNodeCost = 10000;
+  opts_.thread_pool->ParallelFor(
+      num_nodes, kPrepareNodeCost, [this](int64_t begin, int64_t end) {
+        for (int64_t i = begin; i < end; ++i) {
+          PreparedNodeDef& prepared = prepared_nodes_[i];
+          Status s = AddDefaultsAndValidate(&prepared.node_def);
+          if (s.ok()) {
+            prepared.node = g_->PrepareNode(&prepared.node_def);
+          } else {
+            prepared.node = s;
+          }
+        }
+      });
+}
+
 Status GraphConstructor::ValidateShape(Node* node) {
   if (!opts_.importing || !opts_.validate_shape) return OkStatus();
   TF_RETURN_IF_ERROR(refiner_->AddNode(node));
@@ -1197,6 +1270,11 @@ Status GraphConstructor::Convert() {
         g_->AddFunctionLibrary(*std::move(library), library_traces));
   }
 
+  // Everything that follows only reads the op registry, so it can be done
+  // for all nodes at once.
+  const bool parallel = !opts_.importing && opts_.thread_pool != nullptr;
+  if (parallel) PrepareNodes();
+
   std::vector<InputInfo> inputs;
   int processed = 0;
 
@@ -1213,16 +1291,20 @@ Status GraphConstructor::Convert() {
     inputs.clear();
     bool has_data_back_edge = false;
 
-    NodeDef node_def = consume_node_def(o);
+    // With prepared nodes, `node_def` stays empty and `def` refers to the
+    // NodeDef owned by the prepared node instead.
+    NodeDef node_def;
+    if (!parallel) node_def = consume_node_def(o);
+    const NodeDef& def = parallel ? prepared_nodes_[o].def() : node_def;
 
     // input_already_exists[i] is true iff the i-th input of the node we're
     // importing refers to a preexisting node in g_ (i.e. input[i] existed prior
     // to importing node_defs_).  Conversely, input_already_exists[i] is false
     // iff the input refers to a node in node_defs_.
     input_already_exists.clear();
-    input_already_exists.resize(node_def.input_size(), false);
+    input_already_exists.resize(def.input_size(), false);
 
-    std::string node_name = node_def.name();
+    std::string node_name = def.name();
 
     if (opts_.importing) {
       if (opts_.skip_mapped_nodes) {
@@ -1248,10 +1330,10 @@ Status GraphConstructor::Convert() {
       }
     }
 
-    DCHECK_EQ(node_def.input_size(), input_already_exists.size());
-    TF_RETURN_IF_ERROR(ValidateColocationConstraints(node_def));
-    for (int i = 0; i < node_def.input_size(); ++i) {
-      TensorId tensor_id = ParseTensorName(node_def.input(i));
+    DCHECK_EQ(def.input_size(), input_already_exists.size());
+    TF_RETURN_IF_ERROR(ValidateColocationConstraints(def));
+    for (int i = 0; i < def.input_size(); ++i) {
+      TensorId tensor_id = ParseTensorName(def.input(i));
       Node* src_node;
       int src_index;
 
@@ -1272,7 +1354,7 @@ Status GraphConstructor::Convert() {
 
       if (src_node != nullptr && src_index >= src_node->num_outputs()) {
         std::ostringstream out;
-        out << "Node '" << node_def.name() << "': Connecting to invalid output "
+        out << "Node '" << def.name() << "': Connecting to invalid output "
             << tensor_id.index() << " of source node " << tensor_id.node()
             << " which has " << src_node->num_outputs() << " outputs.";
 
@@ -1289,9 +1371,9 @@ Status GraphConstructor::Convert() {
       inputs.emplace_back(string(tensor_id.node()), src_node, src_index);
     }
 
-    if (has_data_back_edge && !IsMerge(node_def)) {
+    if (has_data_back_edge && !IsMerge(def)) {
       return errors::InvalidArgument(
-          "Node '", node_def.name(),
+          "Node '", def.name(),
           "' had a back edge, but only Merge nodes can have back edges.");
     }
 
@@ -1309,20 +1391,16 @@ Status GraphConstructor::Convert() {
 
     if (opts_.importing) {
       TF_RETURN_IF_ERROR(ModifyNodeDefForImport(&node_def));
+      TF_RETURN_IF_ERROR(MakeNode(std::move(node_def), &node));
+    } else if (parallel) {
+      StatusOr<Graph::PreparedNode>& prepared = prepared_nodes_[o].node;
+      TF_RETURN_IF_ERROR(prepared.status());
+      TF_RETURN_IF_ERROR(MakeNode(*std::move(prepared), &node));
     } else {
-      const OpDef* op_def;
-      TF_RETURN_IF_ERROR(
-          g_->op_registry()->LookUpOpDef(node_def.op(), &op_def));
-      if (opts_.add_default_attributes) {
-        AddDefaultsToNodeDef(*op_def, &node_def);
-      }
-      if (opts_.validate_nodes) {
-        TF_RETURN_IF_ERROR(ValidateNodeDef(node_def, *op_def));
-      }
+      TF_RETURN_IF_ERROR(AddDefaultsAndValidate(&node_def));
+      TF_RETURN_IF_ERROR(MakeNode(std::move(node_def), &node));
     }
 
-    TF_RETURN_IF_ERROR(MakeNode(std::move(node_def), &node));
-
     if (node != nullptr) {
       std::shared_ptr<AbstractStackTrace> stack_trace =
           CreateStackTraceForNode(node_name);
@@ -1366,7 +1444,9 @@ Status GraphConstructor::Convert() {
                  << " NODES IN A CYCLE";
     for (int64_t i = 0; i < node_def_count(); i++) {
       if (pending_count_[i] != 0) {
-        LOG(WARNING) << "PENDING: " << SummarizeNodeDef(get_node_def(i))
+        LOG(WARNING) << "PENDING: "
+                     << SummarizeNodeDef(parallel ? prepared_nodes_[i].def()
+                                                  : get_node_def(i))
                      << " WITH PENDING COUNT = " << pending_count_[i];
       }
     }
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/graph_constructor.h"
 
+#include <algorithm>
+#include <memory>
 #include <utility>
 #include <vector>
 
@@ -36,6 +38,7 @@ limitations under the License.
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/public/session.h"
 #include "tensorflow/core/public/version.h"
 
@@ -61,10 +64,17 @@ class GraphConstructorTest : public ::testing::Test {
     const string original_graph_description = GraphDebugString();
 
     Convert(gdef_ascii);
+    std::unique_ptr<Graph> parallel_graph = graph_.Clone();
     GraphConstructorOptions opts;
     Status status = ConvertGraphDefToGraph(opts, gdef_, &graph_);
     EXPECT_FALSE(status.ok());
 
+    // Preparing the nodes in parallel reports the same error.
+    opts.thread_pool = &thread_pool_;
+    EXPECT_EQ(status.ToString(),
+              ConvertGraphDefToGraph(opts, gdef_, parallel_graph.get())
+                  .ToString());
+
     for (const string& error : expected_error_strs) {
       EXPECT_TRUE(absl::StrContains(status.message(), error))
           << "Expected to find '" << error << "' in " << status;
@@ -100,8 +110,15 @@ class GraphConstructorTest : public ::testing::Test {
 
   void ExpectOK(const string& gdef_ascii) {
     Convert(gdef_ascii);
+    std::unique_ptr<Graph> parallel_graph = graph_.Clone();
     GraphConstructorOptions opts;
     TF_CHECK_OK(ConvertGraphDefToGraph(opts, gdef_, &graph_));
+
+    // Preparing the nodes in parallel builds the same graph.
+    opts.thread_pool = &thread_pool_;
+    TF_CHECK_OK(ConvertGraphDefToGraph(opts, gdef_, parallel_graph.get()));
+    EXPECT_EQ(GraphDebugString(),
+              parallel_graph->ToGraphDefDebug().DebugString());
   }
 
   void ExpectOK(const string& gdef_ascii, const ImportGraphDefOptions& opts,
@@ -175,6 +192,8 @@ class GraphConstructorTest : public ::testing::Test {
   }
 
   Graph graph_;
+  thread::ThreadPool thread_pool_{Env::Default(), "graph_constructor_test",
+                                  /*num_threads=*/4};
 
  private:
   GraphDef gdef_;
@@ -925,6 +944,63 @@ TEST_F(GraphConstructorTest, Error_ControlEdgeBeforeRealInput) {
       {"Node 't2': Control dependencies must come after regular dependencies"});
 }
 
+// Builds a chain of `num_nodes` TestMul nodes, listed in reverse topological
+// order so that the GraphDef order differs from the order of conversion.
+GraphDef LargeChain(int num_nodes) {
+  GraphDef def;
+  NodeDef* input = def.add_node();
+  input->set_name("input");
+  input->set_op("TestInput");
+  for (int i = 1; i < num_nodes; ++i) {
+    NodeDef* node = def.add_node();
+    node->set_name(strings::StrCat("n", i));
+    node->set_op("TestMul");
+    node->add_input(i == 1 ? "input" : strings::StrCat("n", i - 1));
+    node->add_input("input:1");
+    if (i % 3 == 0) node->add_input("^input");
+    NodeDef* defaults = def.add_node();
+    defaults->set_name(strings::StrCat("d", i));
+    defaults->set_op("TestDefaultAttr");
+    defaults->add_input(strings::StrCat("^n", i));
+  }
+  std::reverse(def.mutable_node()->begin(), def.mutable_node()->end());
+  return def;
+}
+
+TEST_F(GraphConstructorTest, PreparesLargeGraphInParallel) {
+  const GraphDef def = LargeChain(2000);
+  GraphConstructorOptions opts;
+  TF_ASSERT_OK(ConvertGraphDefToGraph(opts, def, &graph_));
+
+  opts.thread_pool = &thread_pool_;
+  Graph parallel_graph(OpRegistry::Global());
+  TF_ASSERT_OK(ConvertGraphDefToGraph(opts, def, &parallel_graph));
+  EXPECT_EQ(GraphDebugString(),
+            parallel_graph.ToGraphDefDebug().DebugString());
+  Graph moved_parallel_graph(OpRegistry::Global());
+  TF_ASSERT_OK(
+      ConvertGraphDefToGraph(opts, GraphDef(def), &moved_parallel_graph));
+  EXPECT_EQ(GraphDebugString(),
+            moved_parallel_graph.ToGraphDefDebug().DebugString());
+}
+
+TEST_F(GraphConstructorTest, ParallelPreparationReportsFirstErrorInOrder) {
+  GraphDef def = LargeChain(2000);
+  for (NodeDef& node : *def.mutable_node()) {
+    if (node.name() == "n1500") node.set_op("UnknownOp");
+    if (node.name() == "n1200") (*node.mutable_attr())["bogus"].set_i(1);
+  }
+  GraphConstructorOptions opts;
+  opts.validate_nodes = true;
+  Status status = ConvertGraphDefToGraph(opts, def, &graph_);
+  EXPECT_TRUE(absl::StrContains(status.message(), "n1200")) << status;
+
+  opts.thread_pool = &thread_pool_;
+  Graph parallel_graph(OpRegistry::Global());
+  EXPECT_EQ(status.ToString(),
+            ConvertGraphDefToGraph(opts, def, &parallel_graph).ToString());
+}
+
 TEST_F(GraphConstructorTest, ImportGraphDef) {
   GraphDef def;
   ImportGraphDefOptions opts;
@@ -75,6 +75,7 @@ void GraphOptimizer::Optimize(FunctionLibraryRuntime* runtime, Env* env,
       ConstantFoldingOptions cf_opts;
       cf_opts.shape_map = options.shape_map;
       cf_opts.consider = options.cf_consider_fn;
+      cf_opts.cache = ConstantFoldingCache::Default();
       if (opts_.max_folded_constant_in_bytes() > 0) {
         cf_opts.max_constant_size_in_bytes =
             opts_.max_folded_constant_in_bytes();
@@ -0,0 +1,119 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/hardware_counters.h"
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#endif  // defined(__linux__)
+
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+
+#if defined(__linux__)
+namespace {
+
+constexpr int kNumCounters = 4;
+
+// The counters of one thread, as one perf event group led by the cycles.
+class PerfEventGroup {
+ public:
+  PerfEventGroup() {
+    const uint64_t kConfigs[kNumCounters] = {
+        PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+    for (int i = 0; i < kNumCounters; ++i) {
+      struct perf_event_attr attr;
+      memset(&attr, 0, sizeof(attr));
+      attr.size = sizeof(attr);
+      attr.type = PERF_TYPE_HARDWARE;
+      attr.config = kConfigs[i];
+      attr.disabled = i == 0;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      attr.read_format = PERF_FORMAT_GROUP;
+      // Counts the calling thread on any CPU.
+      fds_[i] = syscall(__NR_perf_event_open, &attr, /*pid=*/0, /*cpu=*/-1,
+                        /*group_fd=*/i == 0 ? -1 : fds_[0], /*flags=*/0);
+      if (fds_[i] < 0) {
+        LOG_FIRST_N(WARNING, 1)
+            << "Hardware counters are not available: perf_event_open failed "
+               "with "
+            << strerror(errno);
+        return;
+      }
+    }
+    ioctl(fds_[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    ok_ = true;
+  }
+
+  ~PerfEventGroup() {
+    for (int fd : fds_) {
+      if (fd >= 0) close(fd);
+    }
+  }
+
+  bool Read(ThreadHardwareCounters::Values* values) {
+    if (!ok_) return false;
+    // The number of events, followed by their values.
+    uint64_t buf[1 + kNumCounters];
+    if (read(fds_[0], buf, sizeof(buf)) != sizeof(buf) ||
+        buf[0] != kNumCounters) {
+      return false;
+    }
+    values->cycles = buf[1];
+    values->instructions = buf[2];
+    values->llc_misses = buf[3];
+    values->branch_misses = buf[4];
+    return true;
+  }
+
+ private:
+  int fds_[kNumCounters] = {-1, -1, -1, -1};
+  bool ok_ = false;
+};
+
+}  // namespace
+#endif  // defined(__linux__)
+
+bool ThreadHardwareCounters::Enabled() {
+  static const bool enabled = [] {
+    bool enabled;
+    TF_CHECK_OK(ReadBoolFromEnvVar("TF_STEP_STATS_HARDWARE_COUNTERS",
+                                   /*default_val=*/false, &enabled));
+    return enabled;
+  }();
+  return enabled;
+}
+
+bool ThreadHardwareCounters::Read(Values* values) {
+  if (!Enabled()) return false;
+#if defined(__linux__)
+  static thread_local PerfEventGroup group;
+  return group.Read(values);
+#else
+  return false;
+#endif  // defined(__linux__)
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,50 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_HARDWARE_COUNTERS_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_HARDWARE_COUNTERS_H_
+
+#include <cstdint>
+
+namespace tensorflow {
+
+// Reads hardware performance counters of the calling thread, through
+// perf_event_open on Linux. Counting is opt-in, by setting the
+// TF_STEP_STATS_HARDWARE_COUNTERS environment variable to true, and is not
+// available on other platforms or when the kernel does not allow it (see
+// /proc/sys/kernel/perf_event_paranoid).
+class ThreadHardwareCounters {
+ public:
+  // Counts of events in user space since the counters of the thread were
+  // opened.
+  struct Values {
+    int64_t cycles = 0;
+    int64_t instructions = 0;
+    // Last level cache misses.
+    int64_t llc_misses = 0;
+    int64_t branch_misses = 0;
+  };
+
+  // Returns whether counting was requested.
+  static bool Enabled();
+
+  // Reads the counters of the calling thread, opening them on its first
+  // call. Returns false if the counters are disabled or not available.
+  static bool Read(Values* values);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_HARDWARE_COUNTERS_H_
@@ -0,0 +1,409 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/hierarchical_reducer.h"
+
+#include <algorithm>
+#include <functional>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/common_runtime/collective_rma_local.h"
+#include "tensorflow/core/common_runtime/collective_util.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/device_mgr.h"
+#include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/device_base.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/profiler/lib/traceme.h"
+
+namespace tensorflow {
+namespace {
+// Identifies the transfers of each step of the algorithm in rendezvous keys.
+constexpr int kReduceScatterPhase = 0;
+constexpr int kCrossTaskReducePhase = 1;
+constexpr int kCrossTaskBroadcastPhase = 2;
+constexpr int kAllGatherPhase = 3;
+}  // namespace
+
+HierarchicalReducer::HierarchicalReducer()
+    : col_ctx_(nullptr),
+      col_params_(nullptr),
+      task_idx_(-1),
+      local_idx_(-1),
+      num_chunks_(0) {}
+
+Status HierarchicalReducer::InitializeCollectiveParams(
+    CollectiveParams* col_params) {
+  if (col_params->instance.type != REDUCTION_COLLECTIVE) {
+    return errors::Internal("HierarchicalReducer expects a reduction, got ",
+                            col_params->instance.type);
+  }
+  // Group the devices by task, keeping the group order within each task.
+  // Unlike RingAlg this does not require the devices of a task to be adjacent
+  // in the group.
+  std::vector<std::vector<int>>& perms =
+      col_params->instance.impl_details.subdiv_permutations;
+  perms.clear();
+  absl::flat_hash_map<string, int> task_index;
+  for (int r = 0; r < col_params->group.group_size; ++r) {
+    const string& task = col_params->group.members[r].task;
+    auto it = task_index.emplace(task, static_cast<int>(perms.size())).first;
+    if (it->second == static_cast<int>(perms.size())) perms.emplace_back();
+    perms[it->second].push_back(r);
+  }
+  col_params->subdiv_rank.assign(perms.size(), -1);
+  for (int t = 0; t < perms.size(); ++t) {
+    for (int i = 0; i < perms[t].size(); ++i) {
+      if (perms[t][i] == col_params->default_rank) {
+        col_params->subdiv_rank[t] = i;
+      }
+    }
+  }
+  VLOG(2) << collective_util::SubdivPermDebugString(*col_params);
+  return OkStatus();
+}
+
+Status HierarchicalReducer::InitializeCollectiveContext(
+    std::shared_ptr<CollectiveContext> col_ctx) {
+  DCHECK(col_ctx->dev_mgr);
+  col_ctx_ = col_ctx;
+  col_params_ = col_ctx->col_params.get();
+  return collective_util::InitializeDeviceAndLocality(
+      col_ctx->dev_mgr, col_ctx->device_name, &col_ctx->device,
+      &col_ctx->device_locality);
+}
+
+void HierarchicalReducer::Run(StatusCallback done) {
+  CHECK(col_ctx_);
+  CHECK(col_params_);
+  // Since `HierarchicalReducer` doesn't require non-overlapping collectives,
+  // unblock any collective that is blocked on this instance.
+  col_ctx_->col_exec->UnblockDependencies(*col_params_);
+
+  const std::vector<std::vector<int>>& perms =
+      col_params_->instance.impl_details.subdiv_permutations;
+  num_chunks_ = col_params_->group.group_size;
+  for (int t = 0; t < perms.size(); ++t) {
+    num_chunks_ = std::min(num_chunks_, static_cast<int>(perms[t].size()));
+    for (int i = 0; i < perms[t].size(); ++i) {
+      if (perms[t][i] == col_params_->default_rank) {
+        task_idx_ = t;
+        local_idx_ = i;
+      }
+    }
+  }
+  if (task_idx_ < 0) {
+    done(errors::Internal("Device ", col_ctx_->device_name,
+                          " is not a member of the task groups of ",
+                          col_ctx_->exec_key));
+    return;
+  }
+  local_ranks_ = perms[task_idx_];
+
+  Status s = CopyInputToOutput();
+  if (s.ok()) {
+    AllocatorAttributes attr = col_ctx_->op_ctx->output_alloc_attr(0);
+    ca_.reset(MakeCollectiveAdapter(col_ctx_->output, num_chunks_,
+                                    col_ctx_->device->GetAllocator(attr)));
+    s = PrepareGroupSizeTensor();
+  }
+  if (s.ok()) s = ReduceScatterLocal();
+  if (s.ok()) s = AllReduceAcrossTasks();
+  if (s.ok()) s = AllGatherLocal();
+  if (s.ok()) {
+    // Recover the output from the adaptor.
+    ca_->ConsumeFinalValue(col_ctx_->output);
+  } else {
+    StartAbort(s);
+  }
+  ca_.reset();
+  group_size_tensor_ = Tensor();
+  done(s);
+}
+
+// Note that this function is blocking and must not run in any thread
+// which cannot be blocked.
+Status HierarchicalReducer::CopyInputToOutput() {
+  if ((col_ctx_->input == col_ctx_->output) ||
+      (DMAHelper::base(col_ctx_->input) == DMAHelper::base(col_ctx_->output))) {
+    return OkStatus();
+  }
+  Notification note;
+  Status status;
+  profiler::TraceMe activity("MemCpyAsync", profiler::TraceMeLevel::kInfo);
+  CollectiveRemoteAccessLocal::MemCpyAsync(
+      col_ctx_->op_ctx->op_device_context(),
+      col_ctx_->op_ctx->op_device_context(), col_ctx_->device,
+      col_ctx_->device, col_ctx_->op_ctx->input_alloc_attr(0),
+      col_ctx_->op_ctx->output_alloc_attr(0), col_ctx_->input,
+      col_ctx_->output, 0 /*dev_to_dev_stream_index*/,
+      [&note, &status](const Status& s) {
+        status.Update(s);
+        note.Notify();
+      });
+  note.WaitForNotification();
+  return status;
+}
+
+Status HierarchicalReducer::PrepareGroupSizeTensor() {
+  if (!col_params_->final_op) return OkStatus();
+  Tensor group_size_val = ca_->Scalar(col_params_->group.group_size);
+  if (col_params_->group.device_type == "CPU") {
+    group_size_tensor_ = group_size_val;
+    return OkStatus();
+  }
+  group_size_tensor_ = ca_->Scalar(
+      col_ctx_->device->GetAllocator(col_ctx_->op_ctx->input_alloc_attr(0)),
+      AllocationAttributes());
+  Notification note;
+  Status status;
+  col_ctx_->op_ctx->op_device_context()->CopyCPUTensorToDevice(
+      &group_size_val, col_ctx_->device, &group_size_tensor_,
+      [&note, &status](const Status& s) {
+        status.Update(s);
+        note.Notify();
+      });
+  note.WaitForNotification();
+  return status;
+}
+
+Status HierarchicalReducer::ReduceScatterLocal() {
+  std::vector<std::function<void(StatusCallback)>> ops;
+  std::vector<Tensor> contributions;
+  const bool is_owner = local_idx_ < num_chunks_;
+  if (is_owner && ca_->ChunkBytes(local_idx_) > 0) {
+    contributions.reserve(local_ranks_.size() - 1);
+    for (int i = 0; i < local_ranks_.size(); ++i) {
+      if (i == local_idx_) continue;
+      contributions.push_back(ca_->TempChunk(local_idx_));
+      Tensor* dst = &contributions.back();
+      const int src_rank = local_ranks_[i];
+      ops.push_back([this, src_rank, dst](StatusCallback done) {
+        DispatchRecv(src_rank,
+                     BufKey(kReduceScatterPhase, local_idx_, src_rank,
+                            col_params_->default_rank),
+                     dst, done);
+      });
+    }
+  }
+  std::vector<Tensor> chunks(num_chunks_);
+  for (int c = 0; c < num_chunks_; ++c) {
+    if (c == local_idx_ || ca_->ChunkBytes(c) == 0) continue;
+    chunks[c] = ca_->ChunkAlias(c);
+    const Tensor* src = &chunks[c];
+    const int dst_rank = local_ranks_[c];
+    ops.push_back([this, c, dst_rank, src](StatusCallback done) {
+      DispatchSend(dst_rank,
+                   BufKey(kReduceScatterPhase, c, col_params_->default_rank,
+                          dst_rank),
+                   src, done);
+    });
+  }
+  TF_RETURN_IF_ERROR(RunOps(ops));
+  if (contributions.empty()) return OkStatus();
+
+  // Reduce in local index order so that the result does not depend on the
+  // order in which the contributions arrived.
+  Tensor chunk = ca_->ChunkAlias(local_idx_);
+  for (Tensor& contribution : contributions) {
+    TF_RETURN_IF_ERROR(collective_util::ComputeBinOp(
+        col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+        col_params_->merge_op, &chunk, &contribution));
+  }
+  return OkStatus();
+}
+
+Status HierarchicalReducer::AllReduceAcrossTasks() {
+  if (local_idx_ >= num_chunks_ || ca_->ChunkBytes(local_idx_) == 0) {
+    return OkStatus();
+  }
+  const std::vector<std::vector<int>>& perms =
+      col_params_->instance.impl_details.subdiv_permutations;
+  const int my_rank = col_params_->default_rank;
+  Tensor chunk = ca_->ChunkAlias(local_idx_);
+  if (task_idx_ != 0) {
+    // Send the task-local partial value to the root of this chunk and receive
+    // the final value back into the same buffer.
+    const int root_rank = perms[0][local_idx_];
+    TF_RETURN_IF_ERROR(RunOps({[&](StatusCallback done) {
+      DispatchSend(
+          root_rank,
+          BufKey(kCrossTaskReducePhase, local_idx_, my_rank, root_rank),
+          &chunk, done);
+    }}));
+    return RunOps({[&](StatusCallback done) {
+      DispatchRecv(
+          root_rank,
+          BufKey(kCrossTaskBroadcastPhase, local_idx_, root_rank, my_rank),
+          &chunk, done);
+    }});
+  }
+
+  std::vector<std::function<void(StatusCallback)>> ops;
+  std::vector<Tensor> contributions(perms.size());
+  for (int t = 1; t < perms.size(); ++t) {
+    contributions[t] = ca_->TempChunk(local_idx_);
+    Tensor* dst = &contributions[t];
+    const int src_rank = perms[t][local_idx_];
+    ops.push_back([this, src_rank, my_rank, dst](StatusCallback done) {
+      DispatchRecv(
+          src_rank,
+          BufKey(kCrossTaskReducePhase, local_idx_, src_rank, my_rank), dst,
+          done);
+    });
+  }
+  TF_RETURN_IF_ERROR(RunOps(ops));
+  for (int t = 1; t < perms.size(); ++t) {
+    TF_RETURN_IF_ERROR(collective_util::ComputeBinOp(
+        col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+        col_params_->merge_op, &chunk, &contributions[t]));
+  }
+  if (col_params_->final_op) {
+    TF_RETURN_IF_ERROR(collective_util::ComputeBinOp(
+        col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+        col_params_->final_op, &chunk, &group_size_tensor_));
+  }
+
+  ops.clear();
+  for (int t = 1; t < perms.size(); ++t) {
+    const int dst_rank = perms[t][local_idx_];
+    ops.push_back([this, dst_rank, my_rank, &chunk](StatusCallback done) {
+      DispatchSend(
+          dst_rank,
+          BufKey(kCrossTaskBroadcastPhase, local_idx_, my_rank, dst_rank),
+          &chunk, done);
+    });
+  }
+  return RunOps(ops);
+}
+
+Status HierarchicalReducer::AllGatherLocal() {
+  std::vector<std::function<void(StatusCallback)>> ops;
+  std::vector<Tensor> chunks(num_chunks_);
+  const int my_rank = col_params_->default_rank;
+  for (int c = 0; c < num_chunks_; ++c) {
+    if (ca_->ChunkBytes(c) == 0) continue;
+    chunks[c] = ca_->ChunkAlias(c);
+    Tensor* chunk = &chunks[c];
+    if (c == local_idx_) {
+      for (int i = 0; i < local_ranks_.size(); ++i) {
+        if (i == local_idx_) continue;
+        const int dst_rank = local_ranks_[i];
+        ops.push_back([this, c, dst_rank, my_rank, chunk](StatusCallback done) {
+          DispatchSend(dst_rank, BufKey(kAllGatherPhase, c, my_rank, dst_rank),
+                       chunk, done);
+        });
+      }
+    } else {
+      const int src_rank = local_ranks_[c];
+      ops.push_back([this, c, src_rank, my_rank, chunk](StatusCallback done) {
+        DispatchRecv(src_rank, BufKey(kAllGatherPhase, c, src_rank, my_rank),
+                     chunk, done);
+      });
+    }
+  }
+  return RunOps(ops);
+}
+
+Status HierarchicalReducer::RunOps(
+    const std::vector<std::function<void(StatusCallback)>>& ops) {
+  if (ops.empty()) return OkStatus();
+  mutex mu;
+  Status status;
+  BlockingCounter pending(ops.size());
+  for (const auto& op : ops) {
+    op([this, &mu, &status, &pending](const Status& s) {
+      if (!s.ok()) {
+        // Peers blocked on transfers with this device would otherwise never
+        // complete, so abort right away rather than after the phase.
+        StartAbort(s);
+      }
+      {
+        mutex_lock l(mu);
+        status.Update(s);
+      }
+      pending.DecrementCount();
+    });
+  }
+  pending.Wait();
+  return status;
+}
+
+void HierarchicalReducer::StartAbort(const Status& s) {
+  {
+    mutex_lock l(status_mu_);
+    if (!status_.ok()) return;
+    LOG(ERROR) << "Aborting HierarchicalReduce with " << s;
+    status_.Update(s);
+  }
+  // A cancellation already cancels all of the pending transfers, so only
+  // abort the CollectiveExecutor on other errors.
+  if (col_ctx_->op_ctx->cancellation_manager() == nullptr ||
+      (!col_ctx_->op_ctx->cancellation_manager()->IsCancelled() &&
+       !col_ctx_->op_ctx->cancellation_manager()->IsCancelling())) {
+    col_ctx_->col_exec->StartAbort(s);
+  }
+}
+
+string HierarchicalReducer::BufKey(int phase, int chunk, int src_rank,
+                                   int dst_rank) const {
+  return strings::StrCat(col_ctx_->exec_key, ":", phase, ":", chunk, ":",
+                         src_rank, ":", dst_rank);
+}
+
+void HierarchicalReducer::DispatchSend(int dst_rank, const string& key,
+                                       const Tensor* tensor,
+                                       const StatusCallback& done) {
+  VLOG(3) << "DispatchSend " << key << " from_device "
+          << col_ctx_->device_name << " to_device "
+          << col_params_->group.members[dst_rank].device.name();
+  col_ctx_->col_exec->remote_access()->PostToPeer(
+      col_params_->group.members[dst_rank].device.name(),
+      col_params_->group.members[dst_rank].task, key, col_ctx_->device,
+      col_ctx_->op_ctx->op_device_context(),
+      col_ctx_->op_ctx->output_alloc_attr(0), tensor, col_ctx_->device_locality,
+      col_ctx_->op_ctx->cancellation_manager(), done);
+}
+
+void HierarchicalReducer::DispatchRecv(int src_rank, const string& key,
+                                       Tensor* tensor,
+                                       const StatusCallback& done) {
+  VLOG(3) << "DispatchRecv " << key << " to_device " << col_ctx_->device_name
+          << " from_device "
+          << col_params_->group.members[src_rank].device.name();
+  col_ctx_->col_exec->remote_access()->RecvFromPeer(
+      col_params_->group.members[src_rank].device.name(),
+      col_params_->group.members[src_rank].task,
+      col_params_->group.members[src_rank].is_local, key, col_ctx_->device,
+      col_ctx_->op_ctx->op_device_context(),
+      col_ctx_->op_ctx->output_alloc_attr(0), tensor, col_ctx_->device_locality,
+      0 /*dev_to_dev_stream_index*/, col_ctx_->op_ctx->cancellation_manager(),
+      done);
+}
+
+namespace {
+REGISTER_COLLECTIVE(HierarchicalReduce, HierarchicalReducer);
+}  // namespace
+
+}  // namespace tensorflow
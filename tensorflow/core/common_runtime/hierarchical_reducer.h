@@ -0,0 +1,104 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_REDUCER_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_REDUCER_H_
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/base_collective_executor.h"
+#include "tensorflow/core/framework/collective.h"
+
+namespace tensorflow {
+class Device;
+
+// Two-level implementation of collective all-reduce.
+//
+// Devices are grouped by task, which is the host boundary visible to the
+// collective.  The tensor is split into `num_chunks` chunks, where
+// `num_chunks` is the smallest number of devices in any task, and the device
+// with local index i in each task owns chunk i.  The reduction then proceeds
+// in three phases:
+//  1. Task-local reduce-scatter: every device sends chunk i to the local owner
+//     of chunk i, which reduces the contributions.
+//  2. Cross-task all-reduce: the owners of chunk i in tasks 1..n-1 send their
+//     partial value to the owner of chunk i in task 0, which reduces them,
+//     applies `final_op` and sends the result back.
+//  3. Task-local all-gather: every owner sends its reduced chunk to the other
+//     devices of its task.
+// Only the owners communicate across tasks, and each owner moves only its own
+// chunk, so the inter-host traffic is spread over `num_chunks` links.
+class HierarchicalReducer : public CollectiveImplementationInterface {
+ public:
+  HierarchicalReducer();
+  ~HierarchicalReducer() override = default;
+
+  // Establishes the task-local device groups used by the algorithm.  Stores
+  // them as subdiv permutations: subdiv t lists the ranks of the devices of
+  // task t, in group order.
+  Status InitializeCollectiveParams(CollectiveParams* col_params) override;
+
+  // Initializes members of CollectiveContext not yet initialized, i.e. device
+  // and device_locality.  Also saves the CollectiveContext in this object.
+  Status InitializeCollectiveContext(
+      std::shared_ptr<CollectiveContext> col_ctx) override;
+
+  // Runs the three phases of the reduction.  Must be called in a blockable
+  // thread.
+  void Run(StatusCallback done) override;
+
+ private:
+  // Sends `tensor` from this device to the device at `dst_rank`.
+  void DispatchSend(int dst_rank, const string& key, const Tensor* tensor,
+                    const StatusCallback& done);
+
+  // Receives a tensor into `tensor` from the device at `src_rank`.
+  void DispatchRecv(int src_rank, const string& key, Tensor* tensor,
+                    const StatusCallback& done);
+
+  // Returns the rendezvous key of the transfer of `chunk` from `src_rank` to
+  // `dst_rank` in `phase`.
+  string BufKey(int phase, int chunk, int src_rank, int dst_rank) const;
+
+  // Issues all `ops` concurrently and blocks until every one of them is done.
+  // Returns the first error status.
+  Status RunOps(const std::vector<std::function<void(StatusCallback)>>& ops);
+
+  // Records `s` and aborts the CollectiveExecutor on the first error.
+  void StartAbort(const Status& s);
+
+  Status CopyInputToOutput();
+  Status PrepareGroupSizeTensor();
+  Status ReduceScatterLocal();
+  Status AllReduceAcrossTasks();
+  Status AllGatherLocal();
+
+  std::shared_ptr<CollectiveContext> col_ctx_;
+  const CollectiveParams* col_params_;  // Not owned
+  std::unique_ptr<CollectiveAdapter> ca_;
+  Tensor group_size_tensor_;
+  // Ranks of the devices of this device's task, in group order.
+  std::vector<int> local_ranks_;
+  int task_idx_;
+  int local_idx_;
+  int num_chunks_;
+  mutex status_mu_;
+  Status status_ TF_GUARDED_BY(status_mu_);
+};
+
+}  // namespace tensorflow
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_REDUCER_H_
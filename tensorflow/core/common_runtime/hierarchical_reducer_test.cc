@@ -0,0 +1,150 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/hierarchical_reducer.h"
+
+#include "tensorflow/core/common_runtime/collective_test_util.h"
+#include "tensorflow/core/common_runtime/process_util.h"
+#include "tensorflow/core/framework/device.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/public/version.h"
+
+namespace tensorflow {
+namespace {
+
+std::unique_ptr<OpKernel> GetBinOp(const string& op, DataType dtype,
+                                   const DeviceType& device_type,
+                                   DeviceBase* device) {
+  NodeDef node_def;
+  TF_CHECK_OK(NodeDefBuilder(strings::StrCat(op, "_node"), op)
+                  .Attr("T", dtype)
+                  .Input(FakeInput(dtype))
+                  .Input(FakeInput(dtype))
+                  .Finalize(&node_def));
+  Status status;
+  std::unique_ptr<OpKernel> k = CreateOpKernel(
+      device_type, device, device->GetAllocator(AllocatorAttributes()),
+      node_def, TF_GRAPH_DEF_VERSION, &status);
+  TF_CHECK_OK(status);
+  return k;
+}
+
+class HierarchicalReducerTest : public ::testing::Test {
+ protected:
+  // Reduces on `num_workers` x `num_devices` CPU devices, where device d
+  // contributes d * 10 + i at position i.  Returns the number of devices that
+  // failed.
+  int Reduce(int num_workers, int num_devices, int tensor_len,
+             int fail_after = 0) {
+    test_env_ = CreateCollectiveTestEnv(num_workers, num_devices, DEVICE_CPU);
+    test_env_->remote_access->set_fail_after(fail_after);
+    const int group_size = num_workers * num_devices;
+    std::vector<Tensor> tensors;
+    expected_ = Tensor(DT_DOUBLE, TensorShape({tensor_len}));
+    expected_.flat<double>().setZero();
+    for (int d = 0; d < group_size; ++d) {
+      tensors.emplace_back(DT_DOUBLE, TensorShape({tensor_len}));
+      for (int i = 0; i < tensor_len; ++i) {
+        tensors[d].flat<double>()(i) = d * 10 + i;
+        expected_.flat<double>()(i) += (d * 10 + i) / (1.0 * group_size);
+      }
+    }
+    int num_failures = 0;
+    mutex mu;
+    BlockingCounter counter(group_size);
+    for (int d = 0; d < group_size; ++d) {
+      SchedClosure([this, &tensors, &mu, &num_failures, &counter, d]() {
+        auto col_params = CreateCollectiveParams(
+            *test_env_, d, "HierarchicalReduce", REDUCTION_COLLECTIVE,
+            DT_DOUBLE, tensors[d].shape());
+        Device* device = nullptr;
+        TF_CHECK_OK(test_env_->device_mgr->LookupDevice(
+            col_params->group.members[d].device.name(), &device));
+        auto merge_op = GetBinOp("Add", DT_DOUBLE, DEVICE_CPU, device);
+        auto final_op = GetBinOp("Div", DT_DOUBLE, DEVICE_CPU, device);
+        col_params->merge_op = merge_op.get();
+        col_params->final_op = final_op.get();
+        Status s = RunCollective(test_env_.get(), col_params.get(), device,
+                                 &tensors[d], &tensors[d]);
+        if (!s.ok()) {
+          EXPECT_NE(s.message().find("Deliberate failure"), string::npos) << s;
+          mutex_lock l(mu);
+          ++num_failures;
+        }
+        counter.DecrementCount();
+      });
+    }
+    counter.Wait();
+    if (num_failures == 0) {
+      for (int d = 0; d < group_size; ++d) {
+        test::ExpectTensorNear<double>(expected_, tensors[d], 1e-9);
+      }
+    }
+    return num_failures;
+  }
+
+  std::unique_ptr<CollectiveTestEnv> test_env_;
+  Tensor expected_;
+};
+
+TEST_F(HierarchicalReducerTest, SingleTask) {
+  EXPECT_EQ(0, Reduce(/*num_workers=*/1, /*num_devices=*/3, 1001));
+}
+
+TEST_F(HierarchicalReducerTest, SingleDevicePerTask) {
+  EXPECT_EQ(0, Reduce(/*num_workers=*/4, /*num_devices=*/1, 1001));
+}
+
+TEST_F(HierarchicalReducerTest, MultiTask) {
+  EXPECT_EQ(0, Reduce(/*num_workers=*/2, /*num_devices=*/4, 4095));
+  EXPECT_EQ(0, Reduce(/*num_workers=*/3, /*num_devices=*/2, 128));
+}
+
+TEST_F(HierarchicalReducerTest, FewerElementsThanChunks) {
+  EXPECT_EQ(0, Reduce(/*num_workers=*/2, /*num_devices=*/4, 1));
+}
+
+TEST_F(HierarchicalReducerTest, Failure) {
+  EXPECT_GT(Reduce(/*num_workers=*/2, /*num_devices=*/4, 4095,
+                   /*fail_after=*/3),
+            0);
+}
+
+TEST(HierarchicalReducerInitParamsTest, GroupsDevicesByTask) {
+  auto test_env = CreateCollectiveTestEnv(/*num_workers=*/3,
+                                          /*num_devices_per_worker=*/2,
+                                          DEVICE_CPU);
+  auto cp = CreateCollectiveParams(*test_env, /*rank=*/3, "HierarchicalReduce",
+                                   REDUCTION_COLLECTIVE, DT_FLOAT,
+                                   TensorShape({1}));
+  core::RefCountPtr<HierarchicalReducer> reducer(new HierarchicalReducer());
+  TF_ASSERT_OK(reducer->InitializeCollectiveParams(cp.get()));
+  EXPECT_EQ(std::vector<std::vector<int>>({{0, 1}, {2, 3}, {4, 5}}),
+            cp->instance.impl_details.subdiv_permutations);
+  EXPECT_EQ(std::vector<int>({-1, 1, -1}), cp->subdiv_rank);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -15,7 +15,11 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/immutable_executor_state.h"
 
+#include <optional>
+#include <vector>
+
 #include "absl/memory/memory.h"
+#include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/node_def_util.h"
@@ -96,6 +100,32 @@ Status ImmutableExecutorState::Initialize(const Graph& graph) {
 
   pending_ids_.resize(gview_.num_nodes());
 
+  // Kernels of stateless primitive ops do not depend on each other, so create
+  // them up front in parallel if a pool is given. Their statuses are checked
+  // below in node order, so the reported error does not depend on scheduling.
+  std::vector<std::optional<Status>> create_kernel_statuses;
+  if (params_.create_kernel_thread_pool != nullptr) {
+    std::vector<const Node*> independent_nodes;
+    for (const Node* n : graph.nodes()) {
+      if (IsSink(n) || n->op_def().is_stateful() || n->IsFunctionCall()) {
+        continue;
+      }
+      independent_nodes.push_back(n);
+    }
+    create_kernel_statuses.resize(gview_.num_nodes());
+    // Kernel constructors parse attrs and may set up tables or primitives.
+    const int64_t kCostPerKernel = 10000;
+    params_.create_kernel_thread_pool->ParallelFor(
+        independent_nodes.size(), kCostPerKernel,
+        [&](int64_t begin, int64_t end) {
+          for (int64_t i = begin; i < end; ++i) {
+            const Node* n = independent_nodes[i];
+            create_kernel_statuses[n->id()] = params_.create_kernel(
+                n->properties(), &gview_.node(n->id())->kernel);
+          }
+        });
+  }
+
   // Preprocess every node in the graph to create an instance of op
   // kernel for each node.
   requires_control_flow_ = false;
@@ -129,7 +159,13 @@ Status ImmutableExecutorState::Initialize(const Graph& graph) {
     item->input_start = frame_info->total_inputs;
     frame_info->total_inputs += n->num_inputs();
 
-    Status s = params_.create_kernel(n->properties(), &item->kernel);
+    Status s;
+    if (id < create_kernel_statuses.size() &&
+        create_kernel_statuses[id].has_value()) {
+      s = *create_kernel_statuses[id];
+    } else {
+      s = params_.create_kernel(n->properties(), &item->kernel);
+    }
     if (!s.ok()) {
       params_.delete_kernel(item->kernel);
       item->kernel = nullptr;
@@ -259,6 +295,8 @@ Status ImmutableExecutorState::Initialize(const Graph& graph) {
   // Initialize PendingCounts only after pending_ids_[node.id] is initialized
   // for all nodes.
   InitializePending(&graph, cf_info);
+  TF_RETURN_IF_ERROR(
+      params_.device->FillContextMap(&graph, &device_context_map_));
   return gview_.SetAllocAttrs(&graph, params_.device);
 }
 
@@ -20,6 +20,7 @@ limitations under the License.
 #include <memory>
 
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/threadpool.h"
 
 namespace tensorflow {
 class Device;
@@ -48,6 +49,12 @@ struct LocalExecutorParams {
       create_kernel;
   std::function<void(OpKernel*)> delete_kernel;
 
+  // If set, the kernels of stateless primitive ops are created in parallel on
+  // this pool when the executor is initialized, so `create_kernel` must be
+  // thread-safe for them. Stateful ops and function calls are still created
+  // one at a time, in node order.
+  thread::ThreadPool* create_kernel_thread_pool = nullptr;
+
   // Whether control flow nodes are allowed to be executed synchronously.
   bool allow_control_flow_sync_execution = false;
 };
@@ -0,0 +1,160 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/optimized_function_graph_cache.h"
+
+#include <algorithm>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "tensorflow/core/framework/device.h"
+#include "tensorflow/core/framework/function.pb.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+
+namespace {
+
+Fprint128 Combine(const Fprint128& fp, StringPiece s) {
+  return FingerprintCat128(fp, Fingerprint128(s));
+}
+
+// Fingerprints `name` and its gradient together with the definitions of all the
+// functions they reach, in an order that does not depend on the library.
+Fprint128 FingerprintReachableFunctions(
+    const std::string& name, const FunctionDef& fdef,
+    const FunctionLibraryDefinition& lib_def, Fprint128 fp) {
+  const FunctionLibraryDefinition reachable =
+      lib_def.ReachableDefinitions(fdef);
+  std::vector<std::string> names = reachable.ListFunctionNames();
+  names.push_back(name);
+  std::sort(names.begin(), names.end());
+  names.erase(std::unique(names.begin(), names.end()), names.end());
+  std::string serialized;
+  for (const std::string& function : names) {
+    const FunctionDef* def =
+        function == name ? &fdef : reachable.Find(function);
+    if (def == nullptr) continue;
+    fp = Combine(fp, function);
+    SerializeToStringDeterministic(*def, &serialized);
+    fp = Combine(fp, serialized);
+    fp = Combine(fp, lib_def.FindGradient(function));
+  }
+  return fp;
+}
+
+}  // namespace
+
+constexpr char OptimizedFunctionGraphCache::kEnableEnvVar[];
+constexpr int OptimizedFunctionGraphCache::kDefaultCapacity;
+
+OptimizedFunctionGraphCache* OptimizedFunctionGraphCache::Global() {
+  bool enabled = false;
+  Status s = ReadBoolFromEnvVar(kEnableEnvVar, false, &enabled);
+  if (!s.ok()) {
+    LOG(WARNING) << "Ignoring " << kEnableEnvVar << ": " << s;
+    return nullptr;
+  }
+  if (!enabled) return nullptr;
+  static OptimizedFunctionGraphCache* cache = new OptimizedFunctionGraphCache;
+  return cache;
+}
+
+std::string OptimizedFunctionGraphCache::ComputeKey(
+    const std::string& function_name, AttrSlice attrs,
+    const FunctionLibraryRuntime::InstantiateOptions& options,
+    const FunctionLibraryDefinition& lib_def, const DeviceSet& dev_set,
+    absl::Span<CompositeDevice* const> composite_devices) {
+  // The collected graphs would be missing on a cache hit.
+  if (options.graph_collector != nullptr) return "";
+  const FunctionDef* fdef = lib_def.Find(function_name);
+  if (fdef == nullptr) return "";
+
+  // The library and the state handle identify the instantiating runtime and
+  // its kernels, not the optimized graph, so they are left out of the
+  // canonical name in favor of the library's content.
+  FunctionLibraryRuntime::InstantiateOptions canonical_options = options;
+  canonical_options.lib_def = nullptr;
+  canonical_options.state_handle.clear();
+  Fprint128 fp =
+      Fingerprint128(Canonicalize(function_name, attrs, canonical_options));
+  fp = FingerprintReachableFunctions(function_name, *fdef, lib_def, fp);
+
+  fp = Combine(fp, absl::StrCat(options.is_component_function, "/",
+                                options.xla_compile_device_type, "/",
+                                options.shape_inference_on_tfe_dialect_import));
+  std::vector<std::string> composite_device_names;
+  for (const auto& it : options.composite_devices) {
+    composite_device_names.push_back(
+        absl::StrCat(it.first, "=", absl::StrJoin(*it.second, ",")));
+  }
+  for (const CompositeDevice* d : composite_devices) {
+    composite_device_names.push_back(absl::StrCat(
+        d->name(), "=", absl::StrJoin(*d->underlying_devices(), ",")));
+  }
+  std::sort(composite_device_names.begin(), composite_device_names.end());
+  for (const std::string& name : composite_device_names) {
+    fp = Combine(fp, name);
+  }
+
+  // Device incarnations differ between runtimes and are only used when
+  // partitioning, which is not cached.
+  std::vector<std::string> devices;
+  devices.reserve(dev_set.devices().size());
+  for (const Device* d : dev_set.devices()) {
+    devices.push_back(absl::StrCat(d->name(), "|", d->device_type(), "|",
+                                   d->attributes().physical_device_desc()));
+  }
+  std::sort(devices.begin(), devices.end());
+  for (const std::string& device : devices) {
+    fp = Combine(fp, device);
+  }
+  return absl::StrCat(absl::Hex(fp.high64, absl::kZeroPad16),
+                      absl::Hex(fp.low64, absl::kZeroPad16));
+}
+
+std::shared_ptr<const OptimizedFunctionGraph>
+OptimizedFunctionGraphCache::Lookup(const std::string& key) {
+  mutex_lock l(mu_);
+  auto it = entries_.find(key);
+  if (it == entries_.end()) return nullptr;
+  lru_.splice(lru_.begin(), lru_, it->second.lru_position);
+  return it->second.graph;
+}
+
+void OptimizedFunctionGraphCache::Insert(
+    const std::string& key,
+    std::shared_ptr<const OptimizedFunctionGraph> graph) {
+  if (key.empty() || capacity_ <= 0) return;
+  mutex_lock l(mu_);
+  if (entries_.contains(key)) return;
+  if (entries_.size() >= capacity_) {
+    VLOG(2) << "Evicting optimized function graph " << lru_.back();
+    entries_.erase(lru_.back());
+    lru_.pop_back();
+  }
+  lru_.push_front(key);
+  entries_[key] = {std::move(graph), lru_.begin()};
+}
+
+int OptimizedFunctionGraphCache::size() const {
+  mutex_lock l(mu_);
+  return entries_.size();
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,107 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_OPTIMIZED_FUNCTION_GRAPH_CACHE_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_OPTIMIZED_FUNCTION_GRAPH_CACHE_H_
+
+#include <list>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/types/span.h"
+#include "tensorflow/core/common_runtime/composite_device.h"
+#include "tensorflow/core/common_runtime/device_set.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/optimized_function_graph.pb.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// A process-wide, in-memory cache of optimized multi-device function graphs.
+//
+// Placing and optimizing a multi-device function is the most expensive part
+// of instantiating it, and is repeated by every ProcessFunctionLibraryRuntime
+// that instantiates the function, e.g. when the same SavedModel is loaded into
+// many sessions of one process. This cache lets those runtimes share the
+// result of `OptimizeFunctionGraph()`.
+//
+// Entries are keyed by the content of the function and of every function it
+// reaches, the instantiation attrs and options, and the names and types of the
+// devices it may be placed on. The runtime that owns the function library does
+// not matter. Partitioning is still done by each runtime, since the
+// partitioned graphs refer to the incarnations of its devices.
+//
+// The cache is disabled unless the `TF_SHARE_OPTIMIZED_FUNCTION_GRAPHS`
+// environment variable is set to true. It assumes that the graph optimization
+// passes, including any `InstantiateOptions::optimize_graph_fn`, only depend on
+// the inputs listed above and on `InstantiateOptions::config_proto`.
+//
+// This class is thread-safe.
+class OptimizedFunctionGraphCache {
+ public:
+  // Name of the environment variable that enables the global cache.
+  static constexpr char kEnableEnvVar[] = "TF_SHARE_OPTIMIZED_FUNCTION_GRAPHS";
+
+  // Default maximum number of entries of the global cache.
+  static constexpr int kDefaultCapacity = 256;
+
+  explicit OptimizedFunctionGraphCache(int capacity = kDefaultCapacity)
+      : capacity_(capacity) {}
+
+  // Returns the process-wide cache, or nullptr if it is disabled.
+  static OptimizedFunctionGraphCache* Global();
+
+  // Computes the cache key for instantiating `function_name` from `lib_def`
+  // with the given `attrs` and `options` on the devices in `dev_set`. Returns
+  // an empty string if the instantiation cannot be cached, e.g. because
+  // `options` asks to collect the intermediate graphs.
+  static std::string ComputeKey(
+      const std::string& function_name, AttrSlice attrs,
+      const FunctionLibraryRuntime::InstantiateOptions& options,
+      const FunctionLibraryDefinition& lib_def, const DeviceSet& dev_set,
+      absl::Span<CompositeDevice* const> composite_devices);
+
+  // Returns the entry for `key`, or nullptr if there is none.
+  std::shared_ptr<const OptimizedFunctionGraph> Lookup(const std::string& key)
+      TF_LOCKS_EXCLUDED(mu_);
+
+  // Stores `graph` under `key`, evicting the least recently used entry if the
+  // cache is full. Keeps the existing entry if there already is one.
+  void Insert(const std::string& key,
+              std::shared_ptr<const OptimizedFunctionGraph> graph)
+      TF_LOCKS_EXCLUDED(mu_);
+
+  int size() const TF_LOCKS_EXCLUDED(mu_);
+
+ private:
+  struct Entry {
+    std::shared_ptr<const OptimizedFunctionGraph> graph;
+    std::list<std::string>::iterator lru_position;
+  };
+
+  const int capacity_;
+  mutable mutex mu_;
+  // Keys from the most to the least recently used.
+  std::list<std::string> lru_ TF_GUARDED_BY(mu_);
+  absl::flat_hash_map<std::string, Entry> entries_ TF_GUARDED_BY(mu_);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_OPTIMIZED_FUNCTION_GRAPH_CACHE_H_
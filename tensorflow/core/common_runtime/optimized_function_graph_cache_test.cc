@@ -0,0 +1,142 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/optimized_function_graph_cache.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/device_factory.h"
+#include "tensorflow/core/common_runtime/device_set.h"
+#include "tensorflow/core/framework/function.pb.h"
+#include "tensorflow/core/framework/function_testlib.h"
+#include "tensorflow/core/framework/optimized_function_graph.pb.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/public/session_options.h"
+
+namespace tensorflow {
+namespace {
+
+// The devices and function library of one function runtime.
+struct Runtime {
+  explicit Runtime(const std::vector<FunctionDef>& functions)
+      : lib_def(OpRegistry::Global(), FunctionDefLibrary()) {
+    SessionOptions options;
+    (*options.config.mutable_device_count())["CPU"] = 2;
+    TF_CHECK_OK(DeviceFactory::AddDevices(options, "/job:a/replica:0/task:0",
+                                          &devices));
+    for (const auto& d : devices) dev_set.AddDevice(d.get());
+    for (const FunctionDef& fdef : functions) {
+      TF_CHECK_OK(lib_def.AddFunctionDef(fdef));
+    }
+  }
+
+  std::string Key(const std::string& function_name,
+                  const FunctionLibraryRuntime::InstantiateOptions& options) {
+    return OptimizedFunctionGraphCache::ComputeKey(
+        function_name, AttrSlice(&attrs), options, lib_def, dev_set,
+        /*composite_devices=*/{});
+  }
+
+  std::vector<std::unique_ptr<Device>> devices;
+  DeviceSet dev_set;
+  FunctionLibraryDefinition lib_def;
+  AttrValueMap attrs;
+};
+
+FunctionLibraryRuntime::InstantiateOptions MultiDeviceOptions() {
+  FunctionLibraryRuntime::InstantiateOptions options;
+  options.target = "/job:a/replica:0/task:0/device:CPU:0";
+  options.is_multi_device_function = true;
+  return options;
+}
+
+TEST(OptimizedFunctionGraphCacheTest, KeyIsSharedAcrossRuntimes) {
+  Runtime a({test::function::XTimesTwo(), test::function::XTimesFour()});
+  Runtime b({test::function::XTimesFour(), test::function::XTimesTwo()});
+  FunctionLibraryRuntime::InstantiateOptions options = MultiDeviceOptions();
+  options.lib_def = &a.lib_def;
+  options.state_handle = "a";
+  const std::string key = a.Key("XTimesFour", options);
+  ASSERT_FALSE(key.empty());
+
+  // Different libraries with the same content, different state handles and
+  // different device incarnations all give the same key.
+  options.lib_def = &b.lib_def;
+  options.state_handle = "b";
+  EXPECT_EQ(key, b.Key("XTimesFour", options));
+}
+
+TEST(OptimizedFunctionGraphCacheTest, KeyDependsOnContent) {
+  Runtime a({test::function::XTimesTwo(), test::function::XTimesFour()});
+  const FunctionLibraryRuntime::InstantiateOptions options =
+      MultiDeviceOptions();
+  const std::string key = a.Key("XTimesFour", options);
+
+  // A function reached from the instantiated one differs.
+  FunctionDef other_x_times_two = test::function::XTimesTwoInt32();
+  other_x_times_two.mutable_signature()->set_name("XTimesTwo");
+  Runtime b({other_x_times_two, test::function::XTimesFour()});
+  EXPECT_NE(key, b.Key("XTimesFour", options));
+
+  // Attrs, options and devices differ.
+  Runtime c({test::function::XTimesTwo(), test::function::XTimesFour()});
+  c.attrs["T"].set_type(DT_FLOAT);
+  EXPECT_NE(key, c.Key("XTimesFour", options));
+  FunctionLibraryRuntime::InstantiateOptions other_options = options;
+  other_options.target = "/job:a/replica:0/task:0/device:CPU:1";
+  EXPECT_NE(key, a.Key("XTimesFour", other_options));
+  other_options = options;
+  other_options.config_proto.set_allow_soft_placement(true);
+  EXPECT_NE(key, a.Key("XTimesFour", other_options));
+  DeviceSet fewer_devices;
+  fewer_devices.AddDevice(a.devices[0].get());
+  EXPECT_NE(key, OptimizedFunctionGraphCache::ComputeKey(
+                     "XTimesFour", AttrSlice(&a.attrs), options, a.lib_def,
+                     fewer_devices, /*composite_devices=*/{}));
+}
+
+TEST(OptimizedFunctionGraphCacheTest, NotCacheable) {
+  Runtime a({test::function::XTimesTwo()});
+  FunctionLibraryRuntime::InstantiateOptions options = MultiDeviceOptions();
+  EXPECT_TRUE(a.Key("Missing", options).empty());
+  GraphCollector collector;
+  options.graph_collector = &collector;
+  EXPECT_TRUE(a.Key("XTimesTwo", options).empty());
+}
+
+TEST(OptimizedFunctionGraphCacheTest, EvictsLeastRecentlyUsed) {
+  OptimizedFunctionGraphCache cache(/*capacity=*/2);
+  auto make_graph = [](const std::string& name) {
+    auto graph = std::make_shared<OptimizedFunctionGraph>();
+    graph->set_name(name);
+    return graph;
+  };
+  cache.Insert("a", make_graph("a"));
+  cache.Insert("b", make_graph("b"));
+  // The existing entry is kept.
+  cache.Insert("a", make_graph("other"));
+  EXPECT_EQ(cache.Lookup("a")->name(), "a");
+
+  cache.Insert("c", make_graph("c"));
+  EXPECT_EQ(cache.size(), 2);
+  EXPECT_EQ(cache.Lookup("b"), nullptr);
+  EXPECT_NE(cache.Lookup("a"), nullptr);
+  EXPECT_NE(cache.Lookup("c"), nullptr);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -33,6 +33,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/int32_fulltype.h"
 #include "tensorflow/core/common_runtime/optimization_registry.h"
 #include "tensorflow/core/common_runtime/optimize_function_graph_utils.h"
+#include "tensorflow/core/common_runtime/optimized_function_graph_cache.h"
 #include "tensorflow/core/common_runtime/partitioning_utils.h"
 #include "tensorflow/core/common_runtime/placer.h"
 #include "tensorflow/core/common_runtime/rendezvous_util.h"
@@ -562,7 +563,7 @@ Status ProcessFunctionLibraryRuntime::InstantiateMultiDevice(
   const uint64 optimization_start_time_usecs = Env::Default()->NowMicros();
   // Look up for optimized function graph in library. If found, skip
   // `OptimizeFunctionGraph` step.
-  OptimizedFunctionGraph* optimized_graph_proto =
+  const OptimizedFunctionGraph* optimized_graph_proto =
       options.lib_def != nullptr
           ? options.lib_def->FindOptimizedFunctionGraph(function_name)
           : lib_def_->FindOptimizedFunctionGraph(function_name);
@@ -575,6 +576,32 @@ Status ProcessFunctionLibraryRuntime::InstantiateMultiDevice(
         1, metrics::GraphOptimizationSource::kAot);
   }
 
+  // Otherwise, look for a graph optimized by another runtime in this process.
+  OptimizedFunctionGraphCache* shared_cache =
+      optimized_graph_proto == nullptr ? OptimizedFunctionGraphCache::Global()
+                                       : nullptr;
+  std::string shared_cache_key;
+  std::shared_ptr<const OptimizedFunctionGraph> shared_graph_proto;
+  if (shared_cache != nullptr) {
+    shared_cache_key = OptimizedFunctionGraphCache::ComputeKey(
+        function_name, attrs, options,
+        options.lib_def != nullptr ? *options.lib_def : *lib_def_, *dev_set,
+        composite_devices);
+    if (!shared_cache_key.empty()) {
+      shared_graph_proto = shared_cache->Lookup(shared_cache_key);
+    }
+    if (shared_graph_proto != nullptr) {
+      VLOG(1) << "Reusing the optimized graph of function \"" << function_name
+              << "\" instantiated by another runtime";
+      optimized_graph_proto = shared_graph_proto.get();
+      metrics::UpdateFunctionGraphOptimizationSavingTime(
+          optimized_graph_proto->optimization_time_usecs(),
+          metrics::GraphOptimizationSource::kJit);
+      metrics::IncrementFunctionGraphOptimizationCacheHitCount(
+          1, metrics::GraphOptimizationSource::kJit);
+    }
+  }
+
   StatusOr<OptimizedFunctionGraphInfo> optimized_graph_info =
       optimized_graph_proto == nullptr
           ? OptimizeFunctionGraphOrReadFromFileCache(
@@ -582,6 +609,13 @@ Status ProcessFunctionLibraryRuntime::InstantiateMultiDevice(
                 composite_devices, cpu_device, default_device, env_)
           : OptimizedFunctionGraphInfo::FromProto(*optimized_graph_proto);
   if (!optimized_graph_info.ok()) return optimized_graph_info.status();
+  if (shared_graph_proto == nullptr && !shared_cache_key.empty()) {
+    // Partitioning below consumes the graph, so store a copy first.
+    shared_cache->Insert(shared_cache_key,
+                         std::make_shared<const OptimizedFunctionGraph>(
+                             OptimizedFunctionGraphInfo::ToProto(
+                                 *optimized_graph_info)));
+  }
 
   // Resets the library registration correctly.
   optimized_graph_info->function_graph->mutable_flib_def()
@@ -23,6 +23,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/common_runtime/eager/rendezvous_cache.h"
 #include "tensorflow/core/common_runtime/function_testlib.h"
+#include "tensorflow/core/common_runtime/optimized_function_graph_cache.h"
 #include "tensorflow/core/common_runtime/rendezvous_mgr.h"
 #include "tensorflow/core/framework/full_type.pb.h"
 #include "tensorflow/core/framework/function.h"
@@ -1409,5 +1410,48 @@ TEST_F(ProcessFunctionLibraryRuntimeTest, RecordAotSavingTimeAndHitCount) {
             1);
 }
 
+TEST_F(ProcessFunctionLibraryRuntimeTest,
+       SharesOptimizedGraphsAcrossRuntimes) {
+  setenv(OptimizedFunctionGraphCache::kEnableEnvVar, "true", /*overwrite=*/1);
+  FunctionLibraryRuntime::InstantiateOptions inst_opts =
+      MakeOptions("CPU:0", {"CPU:0"}, {"CPU:0"});
+  FunctionLibraryRuntime::Options opts;
+  auto x = test::AsTensor<float>({1, 2, 3, 4});
+  const int64_t hits_before =
+      metrics::GetFunctionGraphOptimizationCacheHitCount(
+          metrics::GraphOptimizationSource::kJit);
+
+  Init({test::function::XTimesTwo(), test::function::XTimesFour()});
+  Tensor y;
+  TF_CHECK_OK(
+      Run("XTimesFour", opts, {{"T", DT_FLOAT}}, inst_opts, {x}, {&y}));
+  test::ExpectTensorEqual<float>(y, test::AsTensor<float>({4, 8, 12, 16}));
+  EXPECT_EQ(metrics::GetFunctionGraphOptimizationCacheHitCount(
+                metrics::GraphOptimizationSource::kJit),
+            hits_before);
+
+  // A new runtime with its own copy of the same library reuses the optimized
+  // graph.
+  Init({test::function::XTimesFour(), test::function::XTimesTwo()});
+  TF_CHECK_OK(
+      Run("XTimesFour", opts, {{"T", DT_FLOAT}}, inst_opts, {x}, {&y}));
+  test::ExpectTensorEqual<float>(y, test::AsTensor<float>({4, 8, 12, 16}));
+  EXPECT_EQ(metrics::GetFunctionGraphOptimizationCacheHitCount(
+                metrics::GraphOptimizationSource::kJit),
+            hits_before + 1);
+
+  // Changing a reachable function invalidates it.
+  FunctionDef x_times_two = test::function::XTimesTwo();
+  (*x_times_two.mutable_attr())["_noinline"].set_b(true);
+  Init({x_times_two, test::function::XTimesFour()});
+  TF_CHECK_OK(
+      Run("XTimesFour", opts, {{"T", DT_FLOAT}}, inst_opts, {x}, {&y}));
+  test::ExpectTensorEqual<float>(y, test::AsTensor<float>({4, 8, 12, 16}));
+  EXPECT_EQ(metrics::GetFunctionGraphOptimizationCacheHitCount(
+                metrics::GraphOptimizationSource::kJit),
+            hits_before + 1);
+  unsetenv(OptimizedFunctionGraphCache::kEnableEnvVar);
+}
+
 }  // anonymous namespace
 }  // namespace tensorflow
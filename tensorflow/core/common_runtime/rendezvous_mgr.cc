@@ -169,7 +169,8 @@ void IntraProcessRecvAsyncImpl(const DeviceMgr* device_mgr,
 RefCountedIntraProcessRendezvous::RefCountedIntraProcessRendezvous(
     const DeviceMgr* device_mgr)
     : device_mgr_(device_mgr),
-      local_(this, /* num_shards= */ device_mgr->NumDevices()) {}
+      local_(this,
+             LocalRendezvous::DefaultNumShards(device_mgr->NumDevices())) {}
 
 RefCountedIntraProcessRendezvous::~RefCountedIntraProcessRendezvous() {
   VLOG(5) << "Destructor of IntraProcessRendezvous: " << this;
@@ -202,7 +203,8 @@ Status RefCountedIntraProcessRendezvous::GetLocalRendezvousStatus() {
 PrivateIntraProcessRendezvous::PrivateIntraProcessRendezvous(
     const DeviceMgr* device_mgr)
     : device_mgr_(device_mgr),
-      local_(nullptr, /* num_shards= */ device_mgr->NumDevices()) {}
+      local_(nullptr,
+             LocalRendezvous::DefaultNumShards(device_mgr->NumDevices())) {}
 
 PrivateIntraProcessRendezvous::~PrivateIntraProcessRendezvous() {}
 
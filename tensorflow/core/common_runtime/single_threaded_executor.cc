@@ -319,6 +319,7 @@ class SingleThreadedExecutorImpl : public Executor {
     params.function_library = params_.function_library;
     params.resource_manager = device->resource_manager();
     params.step_container = args.step_container;
+    params.step_allocator = args.step_allocator;
     params.collective_executor = args.collective_executor;
     params.stack_trace = args.stack_trace;
     params.slice_reader_cache = nullptr;  // TODO(mrry): Too severe?
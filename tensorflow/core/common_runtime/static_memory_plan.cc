@@ -0,0 +1,304 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/static_memory_plan.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+namespace {
+
+size_t RoundUpToAlignment(size_t bytes) {
+  constexpr size_t kAlignment = Allocator::kAllocatorAlignment;
+  return (bytes + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+}  // namespace
+
+StaticMemoryPlan::StaticMemoryPlan(Allocator* base) : base_(base) {}
+
+StaticMemoryPlan::~StaticMemoryPlan() {
+  // Every outstanding buffer holds a reference, so no arena can still be in
+  // use at this point.
+  mutex_lock l(mu_);
+  DCHECK(live_.empty());
+  if (arena_ != nullptr) ReleaseArenaLocked(arena_);
+}
+
+Allocator* StaticMemoryPlan::BeginStep() {
+  mutex_lock l(mu_);
+  if (in_step_) return nullptr;
+  in_step_ = true;
+  step_misses_ = 0;
+  next_occurrence_.clear();
+  if (!planned_) {
+    tick_ = 0;
+    records_.clear();
+    recorded_live_.clear();
+  }
+  return this;
+}
+
+void StaticMemoryPlan::EndStep() {
+  mutex_lock l(mu_);
+  DCHECK(in_step_);
+  in_step_ = false;
+  if (!planned_) {
+    BuildPlanLocked();
+    return;
+  }
+
+  if (arena_ != nullptr && arena_->num_live > 0) {
+    // Some buffers outlive the step, so the arena cannot be reused by the
+    // next one.
+    step_misses_ += arena_->num_live;
+    if (!ReplaceArenaLocked()) {
+      DiscardPlanLocked();
+      return;
+    }
+  }
+  last_step_misses_ = step_misses_;
+  if (step_misses_ == 0) {
+    steps_with_misses_ = 0;
+  } else if (++steps_with_misses_ >= kMaxStepsWithMisses) {
+    VLOG(1) << "Discarding static memory plan after " << steps_with_misses_
+            << " steps with fallback allocations.";
+    DiscardPlanLocked();
+  }
+}
+
+bool StaticMemoryPlan::is_planned() const {
+  mutex_lock l(mu_);
+  return planned_;
+}
+
+size_t StaticMemoryPlan::arena_bytes() const {
+  mutex_lock l(mu_);
+  return planned_ ? arena_bytes_ : 0;
+}
+
+int64_t StaticMemoryPlan::last_step_misses() const {
+  mutex_lock l(mu_);
+  return last_step_misses_;
+}
+
+void StaticMemoryPlan::BuildPlanLocked() {
+  // Buffers that were not freed during the recording step are left to the
+  // underlying allocator.
+  std::vector<int> planned;
+  for (int i = 0; i < records_.size(); ++i) {
+    if (records_[i].free_tick >= 0) planned.push_back(i);
+  }
+  // Place the largest buffers first, each at the lowest offset that does not
+  // overlap with an already placed buffer whose lifetime intersects its own.
+  std::stable_sort(planned.begin(), planned.end(), [this](int a, int b) {
+    return records_[a].bytes > records_[b].bytes;
+  });
+  std::vector<size_t> offsets(records_.size(), 0);
+  std::vector<int> placed;
+  std::vector<std::pair<size_t, size_t>> busy;
+  arena_bytes_ = 0;
+  for (int r : planned) {
+    const Record& rec = records_[r];
+    const size_t bytes = RoundUpToAlignment(rec.bytes);
+    busy.clear();
+    for (int p : placed) {
+      const Record& other = records_[p];
+      if (rec.alloc_tick < other.free_tick &&
+          other.alloc_tick < rec.free_tick) {
+        busy.emplace_back(offsets[p],
+                          offsets[p] + RoundUpToAlignment(other.bytes));
+      }
+    }
+    std::sort(busy.begin(), busy.end());
+    size_t offset = 0;
+    for (const auto& range : busy) {
+      if (offset + bytes <= range.first) break;
+      offset = std::max(offset, range.second);
+    }
+    offsets[r] = offset;
+    placed.push_back(r);
+    arena_bytes_ = std::max(arena_bytes_, offset + bytes);
+  }
+
+  slots_.clear();
+  slots_by_size_.clear();
+  std::vector<int> slot_of_record(records_.size(), -1);
+  for (int i = 0; i < records_.size(); ++i) {
+    if (records_[i].free_tick >= 0) {
+      slot_of_record[i] = slots_.size();
+      slots_.push_back(
+          {offsets[i], RoundUpToAlignment(records_[i].bytes), {}});
+    }
+    slots_by_size_[records_[i].bytes].push_back(slot_of_record[i]);
+  }
+  for (int i = 0; i < slots_.size(); ++i) {
+    for (int j = i + 1; j < slots_.size(); ++j) {
+      if (slots_[i].offset < slots_[j].offset + slots_[j].bytes &&
+          slots_[j].offset < slots_[i].offset + slots_[i].bytes) {
+        slots_[i].conflicts.push_back(j);
+        slots_[j].conflicts.push_back(i);
+      }
+    }
+  }
+  records_.clear();
+  recorded_live_.clear();
+
+  slot_live_.assign(slots_.size(), false);
+  steps_with_misses_ = 0;
+  last_step_misses_ = 0;
+  planned_ = ReplaceArenaLocked();
+  VLOG(1) << "Built static memory plan with " << slots_.size()
+          << " buffers in an arena of " << arena_bytes_ << " bytes.";
+}
+
+void StaticMemoryPlan::DiscardPlanLocked() {
+  if (arena_ != nullptr) {
+    if (arena_->num_live > 0) {
+      arena_->retired = true;
+    } else {
+      ReleaseArenaLocked(arena_);
+    }
+    arena_ = nullptr;
+  }
+  slots_.clear();
+  slots_by_size_.clear();
+  slot_live_.clear();
+  arena_bytes_ = 0;
+  planned_ = false;
+}
+
+bool StaticMemoryPlan::ReplaceArenaLocked() {
+  if (arena_ != nullptr) {
+    if (arena_->num_live > 0) {
+      arena_->retired = true;
+    } else {
+      ReleaseArenaLocked(arena_);
+    }
+    arena_ = nullptr;
+  }
+  std::fill(slot_live_.begin(), slot_live_.end(), false);
+  if (arena_bytes_ == 0) return true;
+  char* base = static_cast<char*>(
+      base_->AllocateRaw(Allocator::kAllocatorAlignment, arena_bytes_));
+  if (base == nullptr) {
+    LOG(WARNING) << "Could not allocate a static memory arena of "
+                 << arena_bytes_ << " bytes; falling back to "
+                 << base_->Name() << ".";
+    return false;
+  }
+  arena_ = new Arena;
+  arena_->base = base;
+  arena_->bytes = arena_bytes_;
+  return true;
+}
+
+void StaticMemoryPlan::ReleaseArenaLocked(Arena* arena) {
+  DCHECK_EQ(arena->num_live, 0);
+  base_->DeallocateRaw(arena->base);
+  delete arena;
+}
+
+void* StaticMemoryPlan::AllocateFromArenaLocked(size_t alignment,
+                                                size_t num_bytes) {
+  auto it = slots_by_size_.find(num_bytes);
+  if (it == slots_by_size_.end()) {
+    ++step_misses_;
+    return nullptr;
+  }
+  const int k = next_occurrence_[num_bytes]++;
+  if (k >= it->second.size()) {
+    ++step_misses_;
+    return nullptr;
+  }
+  const int slot = it->second[k];
+  if (slot < 0 || arena_ == nullptr) return nullptr;
+  if (slot_live_[slot]) {
+    ++step_misses_;
+    return nullptr;
+  }
+  for (int other : slots_[slot].conflicts) {
+    if (slot_live_[other]) {
+      ++step_misses_;
+      return nullptr;
+    }
+  }
+  slot_live_[slot] = true;
+  ++arena_->num_live;
+  void* ptr = arena_->base + slots_[slot].offset;
+  live_[ptr] = {arena_, slot};
+  return ptr;
+}
+
+void* StaticMemoryPlan::AllocateRaw(
+    size_t alignment, size_t num_bytes,
+    const AllocationAttributes& allocation_attr) {
+  void* ptr = nullptr;
+  bool record = false;
+  {
+    mutex_lock l(mu_);
+    const bool eligible = in_step_ && num_bytes > 0 &&
+                          alignment <= Allocator::kAllocatorAlignment;
+    if (eligible && planned_) {
+      ptr = AllocateFromArenaLocked(alignment, num_bytes);
+    } else {
+      record = eligible;
+    }
+  }
+  if (ptr == nullptr) {
+    ptr = base_->AllocateRaw(alignment, num_bytes, allocation_attr);
+    if (ptr == nullptr) return nullptr;
+    if (record) {
+      mutex_lock l(mu_);
+      // The plan may have been built in between if the step has ended, in
+      // which case the buffer is simply not recorded.
+      if (in_step_ && !planned_) {
+        recorded_live_[ptr] = records_.size();
+        records_.push_back({num_bytes, tick_++, -1});
+      }
+    }
+  }
+  Ref();
+  return ptr;
+}
+
+void StaticMemoryPlan::DeallocateRaw(void* ptr) {
+  bool from_arena = false;
+  {
+    mutex_lock l(mu_);
+    auto it = live_.find(ptr);
+    if (it != live_.end()) {
+      from_arena = true;
+      Arena* arena = it->second.arena;
+      if (arena == arena_) slot_live_[it->second.slot] = false;
+      live_.erase(it);
+      if (--arena->num_live == 0 && arena->retired) ReleaseArenaLocked(arena);
+    } else if (!planned_ && in_step_) {
+      auto rec = recorded_live_.find(ptr);
+      if (rec != recorded_live_.end()) {
+        records_[rec->second].free_tick = tick_++;
+        recorded_live_.erase(rec);
+      }
+    }
+  }
+  if (!from_arena) base_->DeallocateRaw(ptr);
+  Unref();
+}
+
+}  // namespace tensorflow
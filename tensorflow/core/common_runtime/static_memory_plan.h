@@ -0,0 +1,166 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_STATIC_MEMORY_PLAN_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_STATIC_MEMORY_PLAN_H_
+
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// An allocator that serves the buffers of a repeatedly executed step from a
+// single preallocated arena.
+//
+// Graphs that are run many times with identical shapes (e.g. a callable on a
+// serving path) allocate the same sequence of buffers on every step. The first
+// step run through a StaticMemoryPlan forwards every allocation to the
+// underlying allocator and records its size and lifetime. At the end of that
+// step, buffers with disjoint lifetimes are packed into one arena, and
+// subsequent steps hand out offsets into the arena instead of calling the
+// underlying allocator.
+//
+// During replay the k-th allocation of a given size is mapped to the k-th
+// buffer of that size recorded in the first step. Because kernels may run in
+// a different order from step to step, every replayed allocation checks that
+// no buffer overlapping its slot is still live; otherwise, or when a size was
+// not recorded (e.g. because shapes changed), the allocation falls back to the
+// underlying allocator. After `kMaxStepsWithMisses` consecutive steps that
+// needed a fallback the plan is discarded and the next step records again.
+//
+// Buffers may outlive the step that allocated them (e.g. fetched tensors).
+// Such buffers are not planned when they are recorded, and if one ends up in
+// the arena during replay, the arena is retired (kept alive until its last
+// buffer is freed) and a fresh arena is used for the next step.
+//
+// Only one step at a time may use the plan; see BeginStep(). The object is
+// reference counted, and every outstanding buffer holds a reference, so it
+// stays alive until the last buffer it handed out has been deallocated.
+class StaticMemoryPlan : public Allocator, public core::RefCounted {
+ public:
+  // Number of consecutive steps with fallback allocations after which the
+  // plan is recorded again.
+  static constexpr int kMaxStepsWithMisses = 3;
+
+  // Does not take ownership of `base`, which must outlive this object.
+  explicit StaticMemoryPlan(Allocator* base);
+  ~StaticMemoryPlan() override;
+
+  // Starts a step. Returns the allocator that the step's kernels should use,
+  // or nullptr if another step is currently using the plan, in which case
+  // the caller should run without it. Every non-null return must be paired
+  // with a call to EndStep() once all kernels of the step have completed.
+  Allocator* BeginStep();
+  void EndStep();
+
+  // Returns true if the plan has been built and steps are served from the
+  // arena.
+  bool is_planned() const;
+  // Returns the size of the arena, or 0 if no plan has been built.
+  size_t arena_bytes() const;
+  // Returns the number of allocations that were served by the underlying
+  // allocator during the last completed replayed step.
+  int64_t last_step_misses() const;
+
+  // Allocator implementation.
+  std::string Name() override { return "static_memory_plan"; }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    return AllocateRaw(alignment, num_bytes, AllocationAttributes());
+  }
+  void* AllocateRaw(size_t alignment, size_t num_bytes,
+                    const AllocationAttributes& allocation_attr) override;
+  void DeallocateRaw(void* ptr) override;
+  AllocatorMemoryType GetMemoryType() const override {
+    return base_->GetMemoryType();
+  }
+
+ private:
+  // A buffer observed during the recording step.
+  struct Record {
+    size_t bytes;
+    int64_t alloc_tick;
+    int64_t free_tick;  // -1 while the buffer is live.
+  };
+
+  // A planned buffer.
+  struct Slot {
+    size_t offset;
+    size_t bytes;
+    // Indices of the slots whose memory overlaps with this one.
+    std::vector<int> conflicts;
+  };
+
+  struct Arena {
+    char* base = nullptr;
+    size_t bytes = 0;
+    int64_t num_live = 0;
+    bool retired = false;
+  };
+
+  struct LiveBuffer {
+    Arena* arena;
+    int slot;
+  };
+
+  void BuildPlanLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void DiscardPlanLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Allocates a new arena of `arena_bytes_` and makes it the current one. If
+  // the current arena still has live buffers, it is retired instead of freed.
+  // Returns false if the underlying allocator could not provide the memory.
+  bool ReplaceArenaLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void* AllocateFromArenaLocked(size_t alignment, size_t num_bytes)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void ReleaseArenaLocked(Arena* arena) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  Allocator* const base_;
+
+  mutable mutex mu_;
+  bool in_step_ TF_GUARDED_BY(mu_) = false;
+  bool planned_ TF_GUARDED_BY(mu_) = false;
+
+  // State of the recording step.
+  int64_t tick_ TF_GUARDED_BY(mu_) = 0;
+  std::vector<Record> records_ TF_GUARDED_BY(mu_);
+  absl::flat_hash_map<void*, int> recorded_live_ TF_GUARDED_BY(mu_);
+
+  // The plan. `slots_by_size_[bytes][k]` is the slot used for the k-th
+  // allocation of `bytes` in a step, or -1 if that allocation is not planned.
+  std::vector<Slot> slots_ TF_GUARDED_BY(mu_);
+  absl::flat_hash_map<size_t, std::vector<int>> slots_by_size_
+      TF_GUARDED_BY(mu_);
+  size_t arena_bytes_ TF_GUARDED_BY(mu_) = 0;
+
+  // State of the replayed steps.
+  Arena* arena_ TF_GUARDED_BY(mu_) = nullptr;
+  std::vector<bool> slot_live_ TF_GUARDED_BY(mu_);
+  absl::flat_hash_map<size_t, int> next_occurrence_ TF_GUARDED_BY(mu_);
+  absl::flat_hash_map<void*, LiveBuffer> live_ TF_GUARDED_BY(mu_);
+  int64_t step_misses_ TF_GUARDED_BY(mu_) = 0;
+  int64_t last_step_misses_ TF_GUARDED_BY(mu_) = 0;
+  int steps_with_misses_ TF_GUARDED_BY(mu_) = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(StaticMemoryPlan);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_STATIC_MEMORY_PLAN_H_
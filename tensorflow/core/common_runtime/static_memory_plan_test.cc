@@ -0,0 +1,156 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/static_memory_plan.h"
+
+#include <cstring>
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// Forwards to the CPU allocator and counts the calls that reach it.
+class CountingAllocator : public Allocator {
+ public:
+  std::string Name() override { return "counting"; }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    ++num_allocations_;
+    return cpu_allocator()->AllocateRaw(alignment, num_bytes);
+  }
+  void DeallocateRaw(void* ptr) override {
+    cpu_allocator()->DeallocateRaw(ptr);
+  }
+  int num_allocations() const { return num_allocations_; }
+
+ private:
+  int num_allocations_ = 0;
+};
+
+// Allocates two overlapping buffers, then a third one that only overlaps with
+// the second, and returns the buffer that outlives the step.
+void* RunStep(StaticMemoryPlan* plan, size_t scale = 1) {
+  Allocator* a = plan->BeginStep();
+  EXPECT_NE(a, nullptr);
+  void* x = a->AllocateRaw(64, 1024 * scale);
+  void* y = a->AllocateRaw(64, 1024 * scale);
+  memset(x, 1, 1024 * scale);
+  memset(y, 2, 1024 * scale);
+  a->DeallocateRaw(x);
+  void* z = a->AllocateRaw(64, 2048 * scale);
+  memset(z, 3, 2048 * scale);
+  EXPECT_EQ(static_cast<char*>(y)[1024 * scale - 1], 2);
+  a->DeallocateRaw(y);
+  void* out = a->AllocateRaw(64, 512);
+  a->DeallocateRaw(z);
+  plan->EndStep();
+  return out;
+}
+
+TEST(StaticMemoryPlanTest, ReplaysFromArena) {
+  CountingAllocator base;
+  core::RefCountPtr<StaticMemoryPlan> plan(new StaticMemoryPlan(&base));
+  std::vector<void*> outputs;
+  outputs.push_back(RunStep(plan.get()));
+  EXPECT_TRUE(plan->is_planned());
+  // `x` shares memory with `z`, and the escaping buffer is not planned.
+  EXPECT_EQ(plan->arena_bytes(), 3072);
+  // Four buffers during recording, plus the arena.
+  EXPECT_EQ(base.num_allocations(), 5);
+
+  for (int i = 0; i < 10; ++i) {
+    const int before = base.num_allocations();
+    outputs.push_back(RunStep(plan.get()));
+    // Only the escaping buffer reaches the underlying allocator.
+    EXPECT_EQ(base.num_allocations() - before, 1);
+    EXPECT_EQ(plan->last_step_misses(), 0);
+  }
+  for (void* out : outputs) plan->DeallocateRaw(out);
+}
+
+TEST(StaticMemoryPlanTest, OnlyOneStepAtATime) {
+  CountingAllocator base;
+  core::RefCountPtr<StaticMemoryPlan> plan(new StaticMemoryPlan(&base));
+  EXPECT_NE(plan->BeginStep(), nullptr);
+  EXPECT_EQ(plan->BeginStep(), nullptr);
+  plan->EndStep();
+  EXPECT_NE(plan->BeginStep(), nullptr);
+  plan->EndStep();
+}
+
+TEST(StaticMemoryPlanTest, FallsBackAndReplansWhenShapesChange) {
+  CountingAllocator base;
+  core::RefCountPtr<StaticMemoryPlan> plan(new StaticMemoryPlan(&base));
+  std::vector<void*> outputs;
+  outputs.push_back(RunStep(plan.get()));
+  ASSERT_TRUE(plan->is_planned());
+
+  for (int i = 0; i < StaticMemoryPlan::kMaxStepsWithMisses - 1; ++i) {
+    outputs.push_back(RunStep(plan.get(), /*scale=*/2));
+    EXPECT_EQ(plan->last_step_misses(), 2);
+    EXPECT_TRUE(plan->is_planned());
+  }
+  // The plan is discarded after too many steps with misses...
+  outputs.push_back(RunStep(plan.get(), /*scale=*/2));
+  EXPECT_FALSE(plan->is_planned());
+  // ...and rebuilt for the new shapes by the next step.
+  outputs.push_back(RunStep(plan.get(), /*scale=*/2));
+  EXPECT_TRUE(plan->is_planned());
+  EXPECT_EQ(plan->arena_bytes(), 6144);
+  for (void* out : outputs) plan->DeallocateRaw(out);
+}
+
+TEST(StaticMemoryPlanTest, EscapingArenaBufferRetiresArena) {
+  CountingAllocator base;
+  core::RefCountPtr<StaticMemoryPlan> plan(new StaticMemoryPlan(&base));
+  Allocator* a = plan->BeginStep();
+  a->DeallocateRaw(a->AllocateRaw(64, 256));
+  plan->EndStep();
+  ASSERT_EQ(plan->arena_bytes(), 256);
+
+  // The planned buffer is kept past the end of the step.
+  a = plan->BeginStep();
+  void* kept = a->AllocateRaw(64, 256);
+  memset(kept, 7, 256);
+  plan->EndStep();
+  EXPECT_EQ(plan->last_step_misses(), 1);
+
+  // The next step gets a fresh arena, so `kept` is not overwritten.
+  a = plan->BeginStep();
+  void* p = a->AllocateRaw(64, 256);
+  EXPECT_NE(p, kept);
+  memset(p, 0, 256);
+  a->DeallocateRaw(p);
+  plan->EndStep();
+  EXPECT_EQ(static_cast<char*>(kept)[255], 7);
+  plan->DeallocateRaw(kept);
+}
+
+TEST(StaticMemoryPlanTest, BuffersKeepPlanAlive) {
+  CountingAllocator base;
+  auto* plan = new StaticMemoryPlan(&base);
+  Allocator* a = plan->BeginStep();
+  void* p = a->AllocateRaw(64, 128);
+  plan->EndStep();
+  // Dropping the owner's reference does not destroy the plan while `p` is
+  // outstanding.
+  plan->Unref();
+  a->DeallocateRaw(p);
+}
+
+}  // namespace
+}  // namespace tensorflow
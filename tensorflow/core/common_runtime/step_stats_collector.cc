@@ -122,6 +122,8 @@ void NodeExecStatsWrapper::RecordComputeStarted() {
   stats_->set_op_start_rel_micros(now_nanos / EnvTime::kMicrosToNanos -
                                   stats_->all_start_micros());
   stats_->set_op_start_rel_nanos(now_nanos - stats_->all_start_nanos());
+  counting_ = ThreadHardwareCounters::Read(&counters_at_start_);
+  if (counting_) compute_thread_id_ = Env::Default()->GetCurrentThreadId();
 }
 
 void NodeExecStatsWrapper::RecordComputeEnded() {
@@ -131,6 +133,20 @@ void NodeExecStatsWrapper::RecordComputeEnded() {
   stats_->set_op_end_rel_micros(now_nanos / EnvTime::kMicrosToNanos -
                                 stats_->all_start_micros());
   stats_->set_op_end_rel_nanos(now_nanos - stats_->all_start_nanos());
+  // Asynchronous kernels may complete on another thread, whose counters
+  // would be meaningless.
+  ThreadHardwareCounters::Values counters;
+  if (counting_ && compute_thread_id_ == Env::Default()->GetCurrentThreadId() &&
+      ThreadHardwareCounters::Read(&counters)) {
+    HardwareCounters* hw = stats_->mutable_hardware_counters();
+    hw->set_cycles(counters.cycles - counters_at_start_.cycles);
+    hw->set_instructions(counters.instructions -
+                         counters_at_start_.instructions);
+    hw->set_llc_misses(counters.llc_misses - counters_at_start_.llc_misses);
+    hw->set_branch_misses(counters.branch_misses -
+                          counters_at_start_.branch_misses);
+  }
+  counting_ = false;
 }
 
 void NodeExecStatsWrapper::RecordExecutorEnded() {
@@ -19,6 +19,7 @@ limitations under the License.
 #include <unordered_map>
 #include <vector>
 
+#include "tensorflow/core/common_runtime/hardware_counters.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/step_stats.pb.h"
 #include "tensorflow/core/framework/tracking_allocator.h"
@@ -126,6 +127,11 @@ class NodeExecStatsWrapper : public NodeExecStatsInterface {
 
   gtl::InlinedVector<std::pair<AllocatorMemoryUsed*, TrackingAllocator*>, 2>
       allocations_;
+  // Hardware counters of the thread that started the Compute() call, if
+  // counting. See ThreadHardwareCounters.
+  bool counting_ = false;
+  int64_t compute_thread_id_ = 0;
+  ThreadHardwareCounters::Values counters_at_start_;
   std::unique_ptr<NodeExecStats> stats_;
   const NodeDef* const node_;                       // Not owned.
   StepStatsCollector* const step_stats_collector_;  // Not owned.
@@ -0,0 +1,128 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_WORK_STEALING_QUEUE_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_WORK_STEALING_QUEUE_H_
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <utility>
+
+#include "absl/types/optional.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// A set of per-worker double-ended queues used to distribute ready work items
+// among a fixed number of worker slots.
+//
+// Each worker owns one slot. A worker pushes the work it produces onto the
+// back of its own deque and pops from the back as well (LIFO), which keeps
+// recently produced items (and the data they touch) on a warm core. When its
+// own deque is empty, a worker steals from the front (FIFO end) of the other
+// slots' deques, which tends to take the oldest and therefore least cache-hot
+// items.
+//
+// Each slot has its own lock, and the locks are on separate cache lines, so
+// workers that operate on their own slots do not contend with each other.
+//
+// `T` must be movable.
+template <typename T>
+class WorkStealingQueue {
+ public:
+  explicit WorkStealingQueue(int num_slots)
+      : num_slots_(num_slots), slots_(new Slot[num_slots]) {
+    CHECK_GT(num_slots, 0);
+  }
+
+  WorkStealingQueue(const WorkStealingQueue&) = delete;
+  void operator=(const WorkStealingQueue&) = delete;
+
+  int num_slots() const { return num_slots_; }
+
+  // Pushes `item` onto the back of the deque owned by `slot`.
+  void Push(int slot, T item) {
+    DCHECK_GE(slot, 0);
+    DCHECK_LT(slot, num_slots_);
+    Slot& s = slots_[slot];
+    mutex_lock l(s.mu);
+    s.items.push_back(std::move(item));
+    s.size.store(s.items.size(), std::memory_order_release);
+  }
+
+  // Pops an item for the worker that owns `slot`. The worker's own deque is
+  // tried first (from the back); if it is empty, the remaining slots are
+  // visited in order starting after `slot` and an item is stolen from the
+  // front of the first non-empty deque.
+  //
+  // Returns `absl::nullopt` if every deque was observed empty.
+  absl::optional<T> Pop(int slot) {
+    DCHECK_GE(slot, 0);
+    DCHECK_LT(slot, num_slots_);
+    absl::optional<T> item = PopBack(&slots_[slot]);
+    for (int i = 1; !item.has_value() && i < num_slots_; ++i) {
+      item = PopFront(&slots_[(slot + i) % num_slots_]);
+    }
+    return item;
+  }
+
+  // Returns true if all deques were observed empty. The result may be stale
+  // by the time the caller acts on it.
+  bool Empty() const {
+    for (int i = 0; i < num_slots_; ++i) {
+      if (slots_[i].size.load(std::memory_order_acquire) != 0) return false;
+    }
+    return true;
+  }
+
+ private:
+  struct alignas(64) Slot {
+    mutex mu;
+    std::deque<T> items TF_GUARDED_BY(mu);
+    // A lock-free hint of `items.size()`, used to skip empty victims without
+    // acquiring their locks.
+    std::atomic<size_t> size{0};
+  };
+
+  static absl::optional<T> PopBack(Slot* s) {
+    if (s->size.load(std::memory_order_acquire) == 0) return absl::nullopt;
+    mutex_lock l(s->mu);
+    if (s->items.empty()) return absl::nullopt;
+    absl::optional<T> item(std::move(s->items.back()));
+    s->items.pop_back();
+    s->size.store(s->items.size(), std::memory_order_release);
+    return item;
+  }
+
+  static absl::optional<T> PopFront(Slot* s) {
+    if (s->size.load(std::memory_order_acquire) == 0) return absl::nullopt;
+    mutex_lock l(s->mu);
+    if (s->items.empty()) return absl::nullopt;
+    absl::optional<T> item(std::move(s->items.front()));
+    s->items.pop_front();
+    s->size.store(s->items.size(), std::memory_order_release);
+    return item;
+  }
+
+  const int num_slots_;
+  std::unique_ptr<Slot[]> slots_;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_WORK_STEALING_QUEUE_H_
@@ -0,0 +1,85 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/work_stealing_queue.h"
+
+#include <atomic>
+#include <vector>
+
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(WorkStealingQueueTest, OwnerPopsMostRecentItem) {
+  WorkStealingQueue<int> queue(2);
+  queue.Push(0, 1);
+  queue.Push(0, 2);
+  queue.Push(0, 3);
+  EXPECT_EQ(*queue.Pop(0), 3);
+  EXPECT_EQ(*queue.Pop(0), 2);
+  EXPECT_EQ(*queue.Pop(0), 1);
+  EXPECT_FALSE(queue.Pop(0).has_value());
+  EXPECT_TRUE(queue.Empty());
+}
+
+TEST(WorkStealingQueueTest, ThiefStealsOldestItem) {
+  WorkStealingQueue<int> queue(3);
+  queue.Push(1, 1);
+  queue.Push(1, 2);
+  queue.Push(1, 3);
+  EXPECT_FALSE(queue.Empty());
+  // Slot 0 is empty, so it steals from the front of slot 1.
+  EXPECT_EQ(*queue.Pop(0), 1);
+  EXPECT_EQ(*queue.Pop(2), 2);
+  EXPECT_EQ(*queue.Pop(1), 3);
+  EXPECT_TRUE(queue.Empty());
+}
+
+TEST(WorkStealingQueueTest, ConcurrentPushAndSteal) {
+  constexpr int kNumSlots = 4;
+  constexpr int kItemsPerSlot = 10000;
+  WorkStealingQueue<int> queue(kNumSlots);
+  std::vector<std::atomic<int>> seen(kNumSlots * kItemsPerSlot);
+  for (auto& s : seen) s = 0;
+  std::atomic<int> num_popped{0};
+  {
+    thread::ThreadPool pool(Env::Default(), "test", kNumSlots);
+    for (int slot = 0; slot < kNumSlots; ++slot) {
+      pool.Schedule([&, slot]() {
+        for (int i = 0; i < kItemsPerSlot; ++i) {
+          queue.Push(slot, slot * kItemsPerSlot + i);
+          if (i % 2 == 0) {
+            if (absl::optional<int> item = queue.Pop(slot)) {
+              seen[*item]++;
+              num_popped++;
+            }
+          }
+        }
+      });
+    }
+  }
+  while (absl::optional<int> item = queue.Pop(0)) {
+    seen[*item]++;
+    num_popped++;
+  }
+  EXPECT_EQ(num_popped, kNumSlots * kItemsPerSlot);
+  for (auto& s : seen) EXPECT_EQ(s, 1);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,128 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/batch_buffer_pool.h"
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/framework/allocation_description.pb.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/refcount.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace data {
+
+constexpr char BatchBufferPool::kMaxCachedBytesEnvVar[];
+
+// A tensor buffer that returns its memory to the pool when it is destroyed.
+class BatchBufferPool::PooledBuffer : public TensorBuffer {
+ public:
+  PooledBuffer(void* data, size_t num_bytes,
+               std::shared_ptr<BatchBufferPool> pool)
+      : TensorBuffer(data), num_bytes_(num_bytes), pool_(std::move(pool)) {}
+
+  ~PooledBuffer() override { pool_->Release(data(), num_bytes_); }
+
+  size_t size() const override { return num_bytes_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(num_bytes_);
+    proto->set_allocated_bytes(num_bytes_);
+    proto->set_allocator_name(pool_->allocator()->Name());
+    proto->set_ptr(reinterpret_cast<uintptr_t>(data()));
+  }
+  bool GetAllocatedBytes(size_t* out_bytes) const override {
+    *out_bytes = num_bytes_;
+    return true;
+  }
+  AllocatorMemoryType GetMemoryType() const override {
+    return pool_->allocator()->GetMemoryType();
+  }
+
+ private:
+  const size_t num_bytes_;
+  const std::shared_ptr<BatchBufferPool> pool_;
+};
+
+std::shared_ptr<BatchBufferPool> BatchBufferPool::MaybeCreateFromEnv(
+    Allocator* allocator) {
+  int64_t max_cached_bytes;
+  Status s = ReadInt64FromEnvVar(kMaxCachedBytesEnvVar, /*default_val=*/0,
+                                 &max_cached_bytes);
+  if (!s.ok()) {
+    LOG(WARNING) << "Ignoring " << kMaxCachedBytesEnvVar << ": " << s;
+    return nullptr;
+  }
+  if (max_cached_bytes <= 0) return nullptr;
+  return std::make_shared<BatchBufferPool>(allocator, max_cached_bytes);
+}
+
+BatchBufferPool::BatchBufferPool(Allocator* allocator,
+                                 int64_t max_cached_bytes)
+    : allocator_(allocator), max_cached_bytes_(max_cached_bytes) {}
+
+BatchBufferPool::~BatchBufferPool() {
+  for (auto& [num_bytes, buffers] : free_buffers_) {
+    for (void* data : buffers) allocator_->DeallocateRaw(data);
+  }
+}
+
+Tensor BatchBufferPool::Allocate(DataType dtype, const TensorShape& shape) {
+  const size_t num_bytes = shape.num_elements() * DataTypeSize(dtype);
+  if (!DataTypeCanUseMemcpy(dtype) || num_bytes == 0) {
+    return Tensor(allocator_, dtype, shape);
+  }
+  void* data = nullptr;
+  {
+    mutex_lock l(mu_);
+    auto it = free_buffers_.find(num_bytes);
+    if (it != free_buffers_.end()) {
+      data = it->second.back();
+      it->second.pop_back();
+      if (it->second.empty()) free_buffers_.erase(it);
+      cached_bytes_ -= num_bytes;
+    }
+  }
+  if (data == nullptr) {
+    data = allocator_->AllocateRaw(Allocator::kAllocatorAlignment, num_bytes);
+    if (data == nullptr) return Tensor();
+  }
+  return Tensor(dtype, shape,
+                core::RefCountPtr<TensorBuffer>(
+                    new PooledBuffer(data, num_bytes, shared_from_this())));
+}
+
+int64_t BatchBufferPool::cached_bytes() const {
+  mutex_lock l(mu_);
+  return cached_bytes_;
+}
+
+void BatchBufferPool::Release(void* data, size_t num_bytes) {
+  {
+    mutex_lock l(mu_);
+    if (cached_bytes_ + static_cast<int64_t>(num_bytes) <= max_cached_bytes_) {
+      free_buffers_[num_bytes].push_back(data);
+      cached_bytes_ += num_bytes;
+      return;
+    }
+  }
+  allocator_->DeallocateRaw(data);
+}
+
+}  // namespace data
+}  // namespace tensorflow
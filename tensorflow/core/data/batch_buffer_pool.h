@@ -0,0 +1,92 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_BATCH_BUFFER_POOL_H_
+#define TENSORFLOW_CORE_DATA_BATCH_BUFFER_POOL_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+namespace data {
+
+// A pool of buffers for the output tensors of a batching iterator.
+//
+// Tensors allocated from the pool hand their buffer back to the pool when
+// their last reference is dropped, instead of freeing it. Batches of the same
+// shape then reuse buffers whose pages are already resident, which saves the
+// allocation and the page faults of every new batch. Up to `max_cached_bytes`
+// of returned buffers are kept; the rest are freed.
+//
+// The pool must be owned by a `std::shared_ptr`, which the allocated buffers
+// share, so it may be destroyed before them. This class is thread-safe.
+class BatchBufferPool
+    : public std::enable_shared_from_this<BatchBufferPool> {
+ public:
+  // Name of the environment variable that sets `max_cached_bytes` for the
+  // pools of batching iterators. Pooling is disabled if it is unset or 0.
+  static constexpr char kMaxCachedBytesEnvVar[] =
+      "TF_DATA_BATCH_BUFFER_POOL_BYTES";
+
+  // Returns a pool configured by `kMaxCachedBytesEnvVar`, or nullptr if
+  // pooling is disabled.
+  static std::shared_ptr<BatchBufferPool> MaybeCreateFromEnv(
+      Allocator* allocator);
+
+  BatchBufferPool(Allocator* allocator, int64_t max_cached_bytes);
+  ~BatchBufferPool();
+
+  BatchBufferPool(const BatchBufferPool&) = delete;
+  BatchBufferPool& operator=(const BatchBufferPool&) = delete;
+
+  // Returns the allocator that buffers are allocated from.
+  Allocator* allocator() const { return allocator_; }
+
+  // Returns a tensor of `dtype` and `shape`, reusing a pooled buffer of the
+  // same size if there is one. Tensors of dtypes that cannot be memcpy'd are
+  // allocated directly from the allocator. The returned tensor is not
+  // initialized if the allocation fails.
+  Tensor Allocate(DataType dtype, const TensorShape& shape);
+
+  // Returns the number of bytes of buffers waiting to be reused.
+  int64_t cached_bytes() const;
+
+ private:
+  class PooledBuffer;
+
+  // Takes back a buffer of `num_bytes` bytes from a destroyed tensor.
+  void Release(void* data, size_t num_bytes);
+
+  Allocator* const allocator_;
+  const int64_t max_cached_bytes_;
+  mutable mutex mu_;
+  absl::flat_hash_map<size_t, std::vector<void*>> free_buffers_
+      TF_GUARDED_BY(mu_);
+  int64_t cached_bytes_ TF_GUARDED_BY(mu_) = 0;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_BATCH_BUFFER_POOL_H_
@@ -0,0 +1,98 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/batch_buffer_pool.h"
+
+#include <cstdlib>
+#include <memory>
+#include <optional>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+TEST(BatchBufferPoolTest, ReusesReleasedBuffers) {
+  auto pool = std::make_shared<BatchBufferPool>(cpu_allocator(),
+                                                /*max_cached_bytes=*/1 << 20);
+  const void* data;
+  {
+    Tensor t = pool->Allocate(DT_FLOAT, TensorShape({16, 4}));
+    ASSERT_TRUE(t.IsInitialized());
+    EXPECT_TRUE(t.IsAligned());
+    data = t.tensor_data().data();
+    Tensor copy = t;
+    EXPECT_EQ(pool->cached_bytes(), 0);
+  }
+  EXPECT_EQ(pool->cached_bytes(), 16 * 4 * sizeof(float));
+
+  // A tensor of another dtype and shape but the same size reuses the buffer.
+  Tensor t = pool->Allocate(DT_INT32, TensorShape({64}));
+  EXPECT_EQ(t.tensor_data().data(), data);
+  EXPECT_EQ(pool->cached_bytes(), 0);
+  EXPECT_EQ(t.AllocatedBytes(), 64 * sizeof(int32));
+
+  // A tensor of a different size does not.
+  Tensor other = pool->Allocate(DT_INT32, TensorShape({65}));
+  EXPECT_NE(other.tensor_data().data(), data);
+}
+
+TEST(BatchBufferPoolTest, CachesUpToMaxBytes) {
+  auto pool = std::make_shared<BatchBufferPool>(cpu_allocator(),
+                                                /*max_cached_bytes=*/1000);
+  {
+    Tensor a = pool->Allocate(DT_INT8, TensorShape({600}));
+    Tensor b = pool->Allocate(DT_INT8, TensorShape({600}));
+  }
+  EXPECT_EQ(pool->cached_bytes(), 600);
+}
+
+TEST(BatchBufferPoolTest, StringsAreNotPooled) {
+  auto pool = std::make_shared<BatchBufferPool>(cpu_allocator(),
+                                                /*max_cached_bytes=*/1 << 20);
+  {
+    Tensor t = pool->Allocate(DT_STRING, TensorShape({4}));
+    ASSERT_TRUE(t.IsInitialized());
+    t.vec<tstring>()(0) = "pooled";
+  }
+  EXPECT_EQ(pool->cached_bytes(), 0);
+}
+
+TEST(BatchBufferPoolTest, TensorsOutliveThePool) {
+  std::optional<Tensor> t;
+  {
+    auto pool = std::make_shared<BatchBufferPool>(
+        cpu_allocator(), /*max_cached_bytes=*/1 << 20);
+    t = pool->Allocate(DT_INT64, TensorShape({3}));
+  }
+  t->vec<int64_t>().setConstant(7);
+  test::ExpectEqual(*t, test::AsTensor<int64_t>({7, 7, 7}));
+}
+
+TEST(BatchBufferPoolTest, MaybeCreateFromEnv) {
+  unsetenv(BatchBufferPool::kMaxCachedBytesEnvVar);
+  EXPECT_EQ(BatchBufferPool::MaybeCreateFromEnv(cpu_allocator()), nullptr);
+  setenv(BatchBufferPool::kMaxCachedBytesEnvVar, "1024", /*overwrite=*/1);
+  EXPECT_NE(BatchBufferPool::MaybeCreateFromEnv(cpu_allocator()), nullptr);
+  setenv(BatchBufferPool::kMaxCachedBytesEnvVar, "many", /*overwrite=*/1);
+  EXPECT_EQ(BatchBufferPool::MaybeCreateFromEnv(cpu_allocator()), nullptr);
+  unsetenv(BatchBufferPool::kMaxCachedBytesEnvVar);
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -14,6 +14,8 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/data/compression_utils.h"
 
+#include <algorithm>
+#include <cstring>
 #include <limits>
 #include <string>
 #include <vector>
@@ -36,7 +38,17 @@ namespace {
 // Increment this when making changes to the `CompressedElement` proto. The
 // `UncompressElement` function will determine what to read according to the
 // version.
-constexpr int kCompressedElementVersion = 0;
+constexpr int kCompressedElementVersion = 1;
+
+// Elements of at least this many bytes are sampled before compressing them, by
+// compressing their first `kCompressionSampleBytes` bytes.
+constexpr size_t kCompressionSampleThresholdBytes = 256 << 10;
+constexpr size_t kCompressionSampleBytes = 64 << 10;
+
+// Elements whose sample or data do not compress to at most this fraction of
+// their size are stored uncompressed. Compressing them would burn CPU on the
+// producer and the consumer for little gain in bytes transferred.
+constexpr double kMaxCompressionRatio = 0.9;
 
 }  // namespace
 
@@ -57,12 +69,52 @@ class Iov {
 
   size_t NumPieces() const { return iov_.size(); }
 
+  // Returns the iovecs covering the first `num_bytes` bytes of the pieces.
+  std::vector<struct iovec> Prefix(size_t num_bytes) const {
+    std::vector<struct iovec> prefix;
+    for (size_t i = 0; i < idx_ && num_bytes > 0; ++i) {
+      prefix.push_back(iov_[i]);
+      prefix.back().iov_len = std::min(prefix.back().iov_len, num_bytes);
+      num_bytes -= prefix.back().iov_len;
+    }
+    return prefix;
+  }
+
+  // Copies the pieces into `out`, which must hold `NumBytes()` bytes.
+  void CopyTo(char* out) const {
+    for (size_t i = 0; i < idx_; ++i) {
+      if (iov_[i].iov_len == 0) continue;
+      std::memcpy(out, iov_[i].iov_base, iov_[i].iov_len);
+      out += iov_[i].iov_len;
+    }
+  }
+
+  // Copies `NumBytes()` bytes from `in` into the pieces.
+  void CopyFrom(const char* in) {
+    for (size_t i = 0; i < idx_; ++i) {
+      if (iov_[i].iov_len == 0) continue;
+      std::memcpy(iov_[i].iov_base, in, iov_[i].iov_len);
+      in += iov_[i].iov_len;
+    }
+  }
+
  private:
   std::vector<struct iovec> iov_;
   size_t idx_;
   size_t num_bytes_;
 };
 
+namespace {
+
+// Stores the bytes of `iov` in `out` as is.
+void StoreUncompressed(const Iov& iov, CompressedElement* out) {
+  out->set_uncompressed(true);
+  out->mutable_data()->resize(iov.NumBytes());
+  iov.CopyTo(out->mutable_data()->data());
+}
+
+}  // namespace
+
 Status CompressElement(const std::vector<Tensor>& element,
                        CompressedElement* out) {
   // First pass: preprocess the non`memcpy`able tensors.
@@ -127,11 +179,35 @@ Status CompressElement(const std::vector<Tensor>& element,
                               iov.NumBytes(),
                               ", exceeding the 4GB Snappy limit.");
   }
+  out->set_version(kCompressedElementVersion);
+  if (iov.NumBytes() >= kCompressionSampleThresholdBytes) {
+    std::vector<struct iovec> sample = iov.Prefix(kCompressionSampleBytes);
+    std::string compressed_sample;
+    if (!port::Snappy_CompressFromIOVec(sample.data(), kCompressionSampleBytes,
+                                        &compressed_sample)) {
+      return errors::Internal("Failed to compress using snappy.");
+    }
+    if (compressed_sample.size() >
+        kMaxCompressionRatio * kCompressionSampleBytes) {
+      VLOG(3) << "Storing element of " << iov.NumBytes()
+              << " bytes uncompressed, since a sample of it compressed to "
+              << compressed_sample.size() << " bytes";
+      StoreUncompressed(iov, out);
+      return OkStatus();
+    }
+  }
   if (!port::Snappy_CompressFromIOVec(iov.Data(), iov.NumBytes(),
                                       out->mutable_data())) {
     return errors::Internal("Failed to compress using snappy.");
   }
-  out->set_version(kCompressedElementVersion);
+  if (out->data().size() > kMaxCompressionRatio * iov.NumBytes()) {
+    // Spare the consumer the decompression.
+    VLOG(3) << "Storing element of " << iov.NumBytes()
+            << " bytes uncompressed, since it compressed to "
+            << out->data().size() << " bytes";
+    StoreUncompressed(iov, out);
+    return OkStatus();
+  }
   VLOG(3) << "Compressed element from " << iov.NumBytes() << " bytes to "
           << out->data().size() << " bytes";
   return OkStatus();
@@ -139,7 +215,9 @@ Status CompressElement(const std::vector<Tensor>& element,
 
 Status UncompressElement(const CompressedElement& compressed,
                          std::vector<Tensor>* out) {
-  if (compressed.version() != kCompressedElementVersion) {
+  // Version 0 only differs in not having the `uncompressed` field.
+  if (compressed.version() != 0 &&
+      compressed.version() != kCompressedElementVersion) {
     return errors::Internal("Unsupported compressed element version: ",
                             compressed.version());
   }
@@ -193,22 +271,33 @@ Status UncompressElement(const CompressedElement& compressed,
 
   // Step 2: Uncompress into the iovec.
   const std::string& compressed_data = compressed.data();
-  size_t uncompressed_size;
-  if (!port::Snappy_GetUncompressedLength(
-          compressed_data.data(), compressed_data.size(), &uncompressed_size)) {
-    return errors::Internal(
-        "Could not get snappy uncompressed length. Compressed data size: ",
-        compressed_data.size());
-  }
-  if (uncompressed_size != static_cast<size_t>(iov.NumBytes())) {
-    return errors::Internal(
-        "Uncompressed size mismatch. Snappy expects ", uncompressed_size,
-        " whereas the tensor metadata suggests ", iov.NumBytes());
-  }
-  if (!port::Snappy_UncompressToIOVec(compressed_data.data(),
-                                      compressed_data.size(), iov.Data(),
-                                      iov.NumPieces())) {
-    return errors::Internal("Failed to perform snappy decompression.");
+  if (compressed.uncompressed()) {
+    if (compressed_data.size() != iov.NumBytes()) {
+      return errors::Internal("Uncompressed size mismatch. Element has ",
+                              compressed_data.size(),
+                              " bytes whereas the tensor metadata suggests ",
+                              iov.NumBytes());
+    }
+    iov.CopyFrom(compressed_data.data());
+  } else {
+    size_t uncompressed_size;
+    if (!port::Snappy_GetUncompressedLength(compressed_data.data(),
+                                            compressed_data.size(),
+                                            &uncompressed_size)) {
+      return errors::Internal(
+          "Could not get snappy uncompressed length. Compressed data size: ",
+          compressed_data.size());
+    }
+    if (uncompressed_size != static_cast<size_t>(iov.NumBytes())) {
+      return errors::Internal(
+          "Uncompressed size mismatch. Snappy expects ", uncompressed_size,
+          " whereas the tensor metadata suggests ", iov.NumBytes());
+    }
+    if (!port::Snappy_UncompressToIOVec(compressed_data.data(),
+                                        compressed_data.size(), iov.Data(),
+                                        iov.NumPieces())) {
+      return errors::Internal("Failed to perform snappy decompression.");
+    }
   }
 
   // Third pass: deserialize nonstring, non`memcpy`able tensors.
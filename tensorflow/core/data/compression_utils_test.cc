@@ -39,6 +39,59 @@ TEST(CompressionUtilsTest, Exceeds4GB) {
                        HasSubstr("exceeding the 4GB Snappy limit")));
 }
 
+// Returns `num_bytes` of pseudorandom, incompressible bytes.
+std::string RandomBytes(size_t num_bytes) {
+  std::string bytes(num_bytes, '\0');
+  uint64_t state = 42;
+  for (char& c : bytes) {
+    state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+    c = static_cast<char>(state >> 56);
+  }
+  return bytes;
+}
+
+TEST(CompressionUtilsTest, IncompressibleElementIsStoredUncompressed) {
+  for (size_t num_bytes : {1 << 10, 1 << 20}) {
+    std::vector<Tensor> element = {
+        CreateTensor<tstring>(TensorShape{}, {RandomBytes(num_bytes)}),
+        CreateTensor<int64_t>(TensorShape{2}, {1, 2})};
+    CompressedElement compressed;
+    TF_ASSERT_OK(CompressElement(element, &compressed));
+    EXPECT_TRUE(compressed.uncompressed());
+    EXPECT_EQ(compressed.data().size(), num_bytes + 2 * sizeof(int64_t));
+    std::vector<Tensor> round_trip_element;
+    TF_ASSERT_OK(UncompressElement(compressed, &round_trip_element));
+    TF_EXPECT_OK(DatasetOpsTestBase::ExpectEqual(element, round_trip_element,
+                                                 /*compare_order=*/true));
+  }
+}
+
+TEST(CompressionUtilsTest, CompressibleElementIsCompressed) {
+  Tensor zeros(DT_INT64, TensorShape{1 << 17});  // 1MB.
+  zeros.flat<int64_t>().setZero();
+  std::vector<Tensor> element = {zeros};
+  CompressedElement compressed;
+  TF_ASSERT_OK(CompressElement(element, &compressed));
+  EXPECT_FALSE(compressed.uncompressed());
+  EXPECT_LT(compressed.data().size(), 1 << 16);
+  std::vector<Tensor> round_trip_element;
+  TF_ASSERT_OK(UncompressElement(compressed, &round_trip_element));
+  TF_EXPECT_OK(DatasetOpsTestBase::ExpectEqual(element, round_trip_element,
+                                               /*compare_order=*/true));
+}
+
+TEST(CompressionUtilsTest, UncompressVersion0) {
+  std::vector<Tensor> element = {
+      CreateTensor<int64_t>(TensorShape{1 << 10})};
+  CompressedElement compressed;
+  TF_ASSERT_OK(CompressElement(element, &compressed));
+  compressed.set_version(0);
+  std::vector<Tensor> round_trip_element;
+  TF_ASSERT_OK(UncompressElement(compressed, &round_trip_element));
+  TF_EXPECT_OK(DatasetOpsTestBase::ExpectEqual(element, round_trip_element,
+                                               /*compare_order=*/true));
+}
+
 std::vector<std::vector<Tensor>> TestCases() {
   return {
       // Single int64.
@@ -90,7 +143,7 @@ TEST_P(ParameterizedCompressionUtilsTest, CompressedElementVersion) {
   std::vector<Tensor> element = GetParam();
   CompressedElement compressed;
   TF_ASSERT_OK(CompressElement(element, &compressed));
-  EXPECT_EQ(0, compressed.version());
+  EXPECT_EQ(1, compressed.version());
 }
 
 TEST_P(ParameterizedCompressionUtilsTest, VersionMismatch) {
@@ -98,7 +151,7 @@ TEST_P(ParameterizedCompressionUtilsTest, VersionMismatch) {
   CompressedElement compressed;
   TF_ASSERT_OK(CompressElement(element, &compressed));
 
-  compressed.set_version(1);
+  compressed.set_version(2);
   std::vector<Tensor> round_trip_element;
   EXPECT_THAT(UncompressElement(compressed, &round_trip_element),
               StatusIs(error::INTERNAL));
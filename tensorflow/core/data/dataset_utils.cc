@@ -87,6 +87,7 @@ constexpr char kShuffleAndRepeatFusionOpt[] = "shuffle_and_repeat_fusion";
 constexpr char kFilterFusionOpt[] = "filter_fusion";
 constexpr char kMapAndFilterFusionOpt[] = "map_and_filter_fusion";
 constexpr char kMapFusionOpt[] = "map_fusion";
+constexpr char kMapVectorizationOpt[] = "map_vectorization";
 constexpr char kParallelBatchOpt[] = "parallel_batch";
 constexpr char kAutotuneBufferSizesOpt[] = "autotune_buffer_sizes";
 constexpr char kDisablePrefetchLegacyAutotuneOpt[] =
@@ -187,6 +188,14 @@ void DefaultOptimizationGraphRewrites(
       optimization_disabled->insert(kMapFusionOpt);
     }
   }
+  if (optimization_options.optional_map_vectorization_case() ==
+      OptimizationOptions::kMapVectorization) {
+    if (optimization_options.map_vectorization()) {
+      optimization_enabled->insert(kMapVectorizationOpt);
+    } else {
+      optimization_disabled->insert(kMapVectorizationOpt);
+    }
+  }
   if (optimization_options.optional_noop_elimination_case() ==
       OptimizationOptions::kNoopElimination) {
     if (optimization_options.noop_elimination()) {
@@ -771,22 +780,9 @@ Status CopyBatch(CopyBatchParams params,
                  std::function<Status()> allocation_callback,
                  std::vector<Tensor>* out_tensors) {
   const size_t num_tuple_components = batch_elements.at(0).size();
-  out_tensors->reserve(num_tuple_components);
   const int64_t num_batch_elements = batch_elements.size();
-  for (size_t component_index = 0; component_index < num_tuple_components;
-       ++component_index) {
-    const Tensor& first_element = batch_elements.at(0)[component_index];
-    TensorShape first_element_shape(first_element.shape());
-    TensorShape batch_component_shape({num_batch_elements});
-    batch_component_shape.AppendShape(first_element_shape);
-    out_tensors->emplace_back(params.allocator, first_element.dtype(),
-                              batch_component_shape);
-    if (!out_tensors->back().IsInitialized()) {
-      return errors::ResourceExhausted(
-          "Failed to allocate memory for the batch of component ",
-          component_index);
-    }
-  }
+  TF_RETURN_IF_ERROR(AllocateBatch(params, batch_elements.at(0),
+                                   num_batch_elements, out_tensors));
   if (allocation_callback) {
     TF_RETURN_IF_ERROR(allocation_callback());
   }
@@ -855,6 +851,62 @@ Status CopyBatch(CopyBatchParams params,
   return OkStatus();
 }
 
+Status AllocateBatch(const CopyBatchParams& params,
+                     const std::vector<Tensor>& element, int64_t batch_size,
+                     std::vector<Tensor>* batch) {
+  BatchBufferPool* pool = params.buffer_pool;
+  if (pool != nullptr && pool->allocator() != params.allocator) {
+    pool = nullptr;
+  }
+  batch->reserve(batch->size() + element.size());
+  for (size_t component_index = 0; component_index < element.size();
+       ++component_index) {
+    const Tensor& component = element[component_index];
+    TensorShape batch_component_shape({batch_size});
+    batch_component_shape.AppendShape(component.shape());
+    if (pool != nullptr) {
+      batch->push_back(
+          pool->Allocate(component.dtype(), batch_component_shape));
+    } else {
+      batch->emplace_back(params.allocator, component.dtype(),
+                          batch_component_shape);
+    }
+    if (!batch->back().IsInitialized()) {
+      return errors::ResourceExhausted(
+          "Failed to allocate memory for the batch of component ",
+          component_index);
+    }
+  }
+  return OkStatus();
+}
+
+Status CopyElementToBatch(std::vector<Tensor> element, int64_t index,
+                          std::vector<Tensor>* batch) {
+  if (element.size() != batch->size()) {
+    return errors::InvalidArgument(
+        "Cannot batch elements with different numbers of components. The "
+        "batch has ",
+        batch->size(), " components and element ", index, " has ",
+        element.size(), ".");
+  }
+  for (size_t component_index = 0; component_index < element.size();
+       ++component_index) {
+    Tensor& batch_component = (*batch)[component_index];
+    TensorShape element_shape(batch_component.shape());
+    element_shape.RemoveDim(0);
+    if (element[component_index].shape() != element_shape) {
+      return errors::InvalidArgument(
+          "Cannot batch tensors with different shapes in component ",
+          component_index, ". First element had shape ",
+          element_shape.DebugString(), " and element ", index, " had shape ",
+          element[component_index].shape().DebugString(), ".");
+    }
+    TF_RETURN_IF_ERROR(batch_util::CopyElementToSlice(
+        std::move(element[component_index]), &batch_component, index));
+  }
+  return OkStatus();
+}
+
 absl::flat_hash_set<tstring> CreateGraphRewriteConfigs(const Options& options) {
   absl::flat_hash_set<tstring> configs;
   const auto& autotune_options = options.autotune_options();
@@ -963,6 +1015,10 @@ REGISTER_DATASET_EXPERIMENT("allow_small_function_optimizations",
                             RandomJobSamplePercentage<0>, AllTasks);
 REGISTER_DATASET_EXPERIMENT("autotune_buffer_optimization",
                             RandomJobSamplePercentage<0>, IndependentHostTasks);
+REGISTER_DATASET_EXPERIMENT("global_ram_budget", RandomJobSamplePercentage<0>,
+                            AllTasks);
+REGISTER_DATASET_EXPERIMENT("hard_cpu_budget", RandomJobSamplePercentage<0>,
+                            AllTasks);
 REGISTER_DATASET_EXPERIMENT(kFilterParallelizationOpt,
                             RandomJobSamplePercentage<0>, AllTasks);
 REGISTER_DATASET_EXPERIMENT("min_outer_interleave_parallelism",
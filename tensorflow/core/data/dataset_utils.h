@@ -24,6 +24,7 @@ limitations under the License.
 
 #include "absl/container/flat_hash_set.h"
 #include "tensorflow/core/common_runtime/function.h"
+#include "tensorflow/core/data/batch_buffer_pool.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/resource_handle.h"
@@ -287,6 +288,9 @@ struct CopyBatchParams {
   Allocator* allocator;
   std::function<void(std::function<void()>)>* runner;
   int64 runner_threadpool_size;
+  // If set, and it allocates from `allocator`, the batch is allocated from
+  // this pool. Not owned.
+  BatchBufferPool* buffer_pool = nullptr;
 
   explicit CopyBatchParams(IteratorContext* ctx) {
     allocator = ctx->allocator({});
@@ -299,6 +303,12 @@ struct CopyBatchParams {
     runner = ctx->runner();
     runner_threadpool_size = GetRunnerThreadpoolSizeFromOpKernelContext(ctx);
   }
+
+  explicit CopyBatchParams(const AnyContext& ctx) {
+    allocator = ctx.allocator;
+    runner = ctx.runner;
+    runner_threadpool_size = ctx.runner_threadpool_size;
+  }
 };
 
 // Copies the input elements to a batch.
@@ -315,6 +325,18 @@ Status CopyBatch(CopyBatchParams params,
                  std::function<Status()> allocation_callback,
                  std::vector<Tensor>* out_tensors);
 
+// Appends to `batch` one tensor per component of `element`, shaped to hold
+// `batch_size` elements like `element`.
+Status AllocateBatch(const CopyBatchParams& params,
+                     const std::vector<Tensor>& element, int64_t batch_size,
+                     std::vector<Tensor>* batch);
+
+// Copies `element` into slice `index` of `batch`, as allocated by
+// `AllocateBatch`. Fails if `element` does not have the shape of the elements
+// the batch was allocated for.
+Status CopyElementToBatch(std::vector<Tensor> element, int64_t index,
+                          std::vector<Tensor>* batch);
+
 // Computes the set of experiments to apply based on the job name, task id,
 // rollout percentage of registered experiments, and the
 // TF_DATA_EXPERIMENT_OPT_IN and TF_DATA_EXPERIMENT_OPT_OUT environment
@@ -0,0 +1,419 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/io_uring_file.h"
+
+#if defined(__linux__) && !defined(__ANDROID__) && \
+    __has_include(<linux/io_uring.h>)
+#define TF_DATA_HAS_IO_URING 1
+#endif
+
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef TF_DATA_HAS_IO_URING
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif  // TF_DATA_HAS_IO_URING
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace data {
+
+int64_t ReadQueueDepthFromEnv() {
+  int64_t queue_depth = 0;
+  Status s = ReadInt64FromEnvVar(kReadQueueDepthEnvVar, 0, &queue_depth);
+  if (!s.ok()) {
+    LOG(WARNING) << "Ignoring " << kReadQueueDepthEnvVar << ": " << s;
+    return 0;
+  }
+  return queue_depth;
+}
+
+#ifdef TF_DATA_HAS_IO_URING
+namespace {
+
+// Number of submission queue entries of the process-wide ring.
+constexpr unsigned kRingEntries = 1024;
+
+// A minimal io_uring for reads, driven directly through the system calls.
+// Completions are handled by a dedicated thread.
+//
+// This class is thread-safe.
+class IoUring {
+ public:
+  // Returns the process-wide ring, or nullptr if io_uring is not available.
+  static IoUring* Global() {
+    static IoUring* ring = []() -> IoUring* {
+      auto ring = std::unique_ptr<IoUring>(new IoUring);
+      Status s = ring->Init(kRingEntries);
+      if (!s.ok()) {
+        VLOG(1) << "io_uring is not available: " << s;
+        if (ring->ring_fd_ >= 0) close(ring->ring_fd_);
+        return nullptr;
+      }
+      return ring.release();
+    }();
+    return ring;
+  }
+
+  // Submits a read of `n` bytes at `offset` of `fd` into `buf`. `done` is
+  // called with the number of bytes read, or with a negated errno. Returns
+  // false without calling `done` if the ring is full.
+  bool TryRead(int fd, uint64_t offset, size_t n, char* buf,
+               std::function<void(int64_t)> done) TF_LOCKS_EXCLUDED(mu_) {
+    auto request = std::make_unique<Request>();
+    request->iov.iov_base = buf;
+    request->iov.iov_len = n;
+    request->done = std::move(done);
+
+    mutex_lock l(mu_);
+    // Bounding the number of reads in flight by the size of the submission
+    // queue also keeps the completion queue, which is twice as large, from
+    // overflowing.
+    if (in_flight_ >= entries_) return false;
+    const unsigned tail = *sq_tail_;
+    const unsigned index = tail & *sq_mask_;
+    io_uring_sqe* sqe = &sqes_[index];
+    std::memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = IORING_OP_READV;
+    sqe->fd = fd;
+    sqe->off = offset;
+    sqe->addr = reinterpret_cast<uint64_t>(&request->iov);
+    sqe->len = 1;
+    sqe->user_data = reinterpret_cast<uint64_t>(request.release());
+    sq_array_[index] = index;
+    __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+    ++in_flight_;
+    // Entries left over by a failed submission are submitted along with this
+    // one.
+    const unsigned to_submit =
+        tail + 1 - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+    int ret;
+    do {
+      ret = syscall(__NR_io_uring_enter, ring_fd_, to_submit, 0, 0, nullptr, 0);
+    } while (ret < 0 && (errno == EINTR || errno == EAGAIN || errno == EBUSY));
+    if (ret < 0) {
+      LOG(ERROR) << "Could not submit an io_uring read: " << strerror(errno);
+    }
+    return true;
+  }
+
+ private:
+  struct Request {
+    struct iovec iov;
+    std::function<void(int64_t)> done;
+  };
+
+  IoUring() = default;
+
+  Status Init(unsigned entries) {
+    io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    ring_fd_ = syscall(__NR_io_uring_setup, entries, &params);
+    if (ring_fd_ < 0) return errors::IOError("io_uring_setup", errno);
+    entries_ = params.sq_entries;
+
+    const size_t sq_size =
+        params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    void* sq = mmap(nullptr, sq_size, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQ_RING);
+    if (sq == MAP_FAILED) return errors::IOError("mmap", errno);
+    char* sq_ptr = static_cast<char*>(sq);
+    sq_head_ = reinterpret_cast<unsigned*>(sq_ptr + params.sq_off.head);
+    sq_tail_ = reinterpret_cast<unsigned*>(sq_ptr + params.sq_off.tail);
+    sq_mask_ = reinterpret_cast<unsigned*>(sq_ptr + params.sq_off.ring_mask);
+    sq_array_ = reinterpret_cast<unsigned*>(sq_ptr + params.sq_off.array);
+
+    const size_t cq_size =
+        params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    void* cq = mmap(nullptr, cq_size, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_CQ_RING);
+    if (cq == MAP_FAILED) return errors::IOError("mmap", errno);
+    char* cq_ptr = static_cast<char*>(cq);
+    cq_head_ = reinterpret_cast<unsigned*>(cq_ptr + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned*>(cq_ptr + params.cq_off.tail);
+    cq_mask_ = reinterpret_cast<unsigned*>(cq_ptr + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<io_uring_cqe*>(cq_ptr + params.cq_off.cqes);
+
+    void* sqes = mmap(nullptr, params.sq_entries * sizeof(io_uring_sqe),
+                      PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                      ring_fd_, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) return errors::IOError("mmap", errno);
+    sqes_ = static_cast<io_uring_sqe*>(sqes);
+
+    thread_.reset(Env::Default()->StartThread(
+        ThreadOptions(), "tf_data_io_uring", [this]() { CompletionLoop(); }));
+    return OkStatus();
+  }
+
+  void CompletionLoop() {
+    std::vector<std::pair<Request*, int64_t>> completed;
+    while (true) {
+      int ret = syscall(__NR_io_uring_enter, ring_fd_, 0, 1,
+                        IORING_ENTER_GETEVENTS, nullptr, 0);
+      if (ret < 0 && errno != EINTR) {
+        LOG_EVERY_N_SEC(ERROR, 60)
+            << "Could not wait for io_uring completions: " << strerror(errno);
+      }
+      unsigned head = *cq_head_;
+      const unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+      for (; head != tail; ++head) {
+        const io_uring_cqe& cqe = cqes_[head & *cq_mask_];
+        completed.emplace_back(reinterpret_cast<Request*>(cqe.user_data),
+                               cqe.res);
+      }
+      __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+      if (completed.empty()) continue;
+      {
+        mutex_lock l(mu_);
+        in_flight_ -= completed.size();
+      }
+      for (auto& request_and_result : completed) {
+        std::unique_ptr<Request> request(request_and_result.first);
+        request->done(request_and_result.second);
+      }
+      completed.clear();
+    }
+  }
+
+  int ring_fd_ = -1;
+  unsigned entries_ = 0;
+  unsigned* sq_head_ = nullptr;
+  unsigned* sq_tail_ = nullptr;
+  unsigned* sq_mask_ = nullptr;
+  unsigned* sq_array_ = nullptr;
+  io_uring_sqe* sqes_ = nullptr;
+  unsigned* cq_head_ = nullptr;
+  unsigned* cq_tail_ = nullptr;
+  unsigned* cq_mask_ = nullptr;
+  io_uring_cqe* cqes_ = nullptr;
+  std::unique_ptr<Thread> thread_;
+
+  mutex mu_;
+  unsigned in_flight_ TF_GUARDED_BY(mu_) = 0;
+};
+
+// A file that serves sequential reads from blocks read ahead through the
+// process-wide io_uring.
+class IoUringFile : public RandomAccessFile {
+ public:
+  IoUringFile(std::unique_ptr<RandomAccessFile> file, int fd, IoUring* ring,
+              int64_t queue_depth, int64_t block_size)
+      : file_(std::move(file)),
+        fd_(fd),
+        ring_(ring),
+        queue_depth_(queue_depth),
+        block_size_(block_size) {}
+
+  ~IoUringFile() override {
+    {
+      mutex_lock l(mu_);
+      while (in_flight_ > 0) cv_.wait(l);
+    }
+    close(fd_);
+  }
+
+  Status Name(StringPiece* result) const override {
+    return file_->Name(result);
+  }
+
+  Status Read(uint64 offset, size_t n, StringPiece* result,
+              char* scratch) const override {
+    mutex_lock l(mu_);
+    if (blocks_.empty() || offset < blocks_.front()->offset ||
+        offset >= next_offset_) {
+      // Not a continuation of the previous read, so start over at `offset`.
+      blocks_.clear();
+      next_offset_ = offset;
+      eof_ = false;
+    }
+    while (!blocks_.empty() &&
+           blocks_.front()->offset + block_size_ <= offset) {
+      blocks_.pop_front();
+    }
+    IssueReadsLocked();
+
+    size_t copied = 0;
+    while (copied < n) {
+      const uint64 pos = offset + copied;
+      if (blocks_.empty()) {
+        if (eof_) break;
+        // The ring is full, so read synchronously instead of waiting for it.
+        StringPiece data;
+        Status s = file_->Read(pos, n - copied, &data, scratch + copied);
+        if (data.data() != scratch + copied) {
+          std::memmove(scratch + copied, data.data(), data.size());
+        }
+        copied += data.size();
+        next_offset_ = offset + copied;
+        *result = StringPiece(scratch, copied);
+        return s;
+      }
+      std::shared_ptr<Block> block = blocks_.front();
+      while (!block->done) cv_.wait(l);
+      if (!block->status.ok()) {
+        blocks_.clear();
+        *result = StringPiece(scratch, copied);
+        return block->status;
+      }
+      if (block->bytes_read < block_size_ && !eof_ &&
+          pos >= block->offset + block->bytes_read) {
+        // Complete a short read synchronously. It is usually the end of the
+        // file.
+        StringPiece data;
+        Status s = file_->Read(block->offset + block->bytes_read,
+                               block_size_ - block->bytes_read, &data,
+                               block->data.get() + block->bytes_read);
+        if (data.data() != block->data.get() + block->bytes_read) {
+          std::memmove(block->data.get() + block->bytes_read, data.data(),
+                       data.size());
+        }
+        block->bytes_read += data.size();
+        if (errors::IsOutOfRange(s)) {
+          eof_ = true;
+        } else if (!s.ok()) {
+          blocks_.clear();
+          *result = StringPiece(scratch, copied);
+          return s;
+        }
+      }
+      const uint64 block_end = block->offset + block->bytes_read;
+      if (pos >= block_end) break;
+      const size_t k = std::min<uint64>(n - copied, block_end - pos);
+      std::memcpy(scratch + copied, block->data.get() + (pos - block->offset),
+                  k);
+      copied += k;
+      if (pos + k == block->offset + block_size_) {
+        blocks_.pop_front();
+        IssueReadsLocked();
+      }
+    }
+    *result = StringPiece(scratch, copied);
+    if (copied < n) {
+      return errors::OutOfRange("Read less bytes than requested");
+    }
+    return OkStatus();
+  }
+
+ private:
+  struct Block {
+    uint64 offset = 0;
+    std::unique_ptr<char[]> data;
+    size_t bytes_read = 0;
+    bool done = false;
+    Status status;
+  };
+
+  // Keeps `queue_depth_` blocks in flight or ready.
+  void IssueReadsLocked() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    while (!eof_ && blocks_.size() < queue_depth_) {
+      auto block = std::make_shared<Block>();
+      block->offset = next_offset_;
+      block->data.reset(new char[block_size_]);
+      // The callback keeps the block alive in case it is dropped by a restart
+      // of the read-ahead.
+      bool submitted = ring_->TryRead(
+          fd_, block->offset, block_size_, block->data.get(),
+          [this, block](int64_t result) {
+            mutex_lock l(mu_);
+            if (result < 0) {
+              block->status = errors::IOError(
+                  absl::StrCat("Reading ahead from file descriptor ", fd_),
+                  -result);
+            } else {
+              block->bytes_read = result;
+            }
+            block->done = true;
+            --in_flight_;
+            cv_.notify_all();
+          });
+      if (!submitted) return;
+      ++in_flight_;
+      next_offset_ += block_size_;
+      blocks_.push_back(std::move(block));
+    }
+  }
+
+  const std::unique_ptr<RandomAccessFile> file_;
+  const int fd_;
+  IoUring* const ring_;
+  const size_t queue_depth_;
+  const size_t block_size_;
+
+  mutable mutex mu_;
+  mutable condition_variable cv_;
+  // Blocks in the order of the file, starting with the one holding the offset
+  // that the next sequential read will start at.
+  mutable std::deque<std::shared_ptr<Block>> blocks_ TF_GUARDED_BY(mu_);
+  mutable uint64 next_offset_ TF_GUARDED_BY(mu_) = 0;
+  mutable bool eof_ TF_GUARDED_BY(mu_) = false;
+  mutable int64_t in_flight_ TF_GUARDED_BY(mu_) = 0;
+};
+
+}  // namespace
+
+bool IsIoUringAvailable() { return IoUring::Global() != nullptr; }
+
+std::unique_ptr<RandomAccessFile> MaybeMakeIoUringFile(
+    const std::string& filename, std::unique_ptr<RandomAccessFile> file,
+    int64_t queue_depth, int64_t block_size) {
+  if (queue_depth <= 0 || block_size <= 0) return file;
+  StringPiece scheme, host, path;
+  io::ParseURI(filename, &scheme, &host, &path);
+  if (!scheme.empty() && scheme != "file") return file;
+  IoUring* ring = IoUring::Global();
+  if (ring == nullptr) return file;
+  const std::string local_path(scheme.empty() ? StringPiece(filename) : path);
+  int fd = open(local_path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    VLOG(1) << "Not reading ahead from " << filename << ": "
+            << strerror(errno);
+    return file;
+  }
+  return std::make_unique<IoUringFile>(std::move(file), fd, ring, queue_depth,
+                                       block_size);
+}
+
+#else  // TF_DATA_HAS_IO_URING
+
+bool IsIoUringAvailable() { return false; }
+
+std::unique_ptr<RandomAccessFile> MaybeMakeIoUringFile(
+    const std::string& filename, std::unique_ptr<RandomAccessFile> file,
+    int64_t queue_depth, int64_t block_size) {
+  return file;
+}
+
+#endif  // TF_DATA_HAS_IO_URING
+
+}  // namespace data
+}  // namespace tensorflow
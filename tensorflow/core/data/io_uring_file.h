@@ -0,0 +1,57 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_IO_URING_FILE_H_
+#define TENSORFLOW_CORE_DATA_IO_URING_FILE_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "tensorflow/core/platform/file_system.h"
+
+namespace tensorflow {
+namespace data {
+
+// Name of the environment variable that sets the number of block reads that
+// a tf.data file reader keeps in flight. Read-ahead is disabled if it is unset
+// or 0.
+inline constexpr char kReadQueueDepthEnvVar[] = "TF_DATA_READ_QUEUE_DEPTH";
+
+// Block size used when the reader does not specify one.
+inline constexpr int64_t kDefaultReadAheadBlockSize = 256 << 10;  // 256 KiB.
+
+// Returns the queue depth set by `kReadQueueDepthEnvVar`.
+int64_t ReadQueueDepthFromEnv();
+
+// Returns whether the kernel supports io_uring, i.e. whether
+// `MaybeMakeIoUringFile` can return a read-ahead file.
+bool IsIoUringAvailable();
+
+// Returns a file that reads `filename` ahead of sequential reads from `file`.
+// It keeps up to `queue_depth` reads of `block_size` bytes in flight, which
+// are submitted asynchronously to a process-wide io_uring and completed by a
+// single thread. Reads that do not continue the previous one restart the
+// read-ahead at their offset.
+//
+// Returns `file` itself if `queue_depth` is not positive, if `filename` is not
+// a local file, or if io_uring is not available.
+std::unique_ptr<RandomAccessFile> MaybeMakeIoUringFile(
+    const std::string& filename, std::unique_ptr<RandomAccessFile> file,
+    int64_t queue_depth, int64_t block_size);
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_IO_URING_FILE_H_
@@ -0,0 +1,121 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/io_uring_file.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/random/philox_random.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+class IoUringFileTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    if (!IsIoUringAvailable()) {
+      GTEST_SKIP() << "io_uring is not available";
+    }
+    filename_ = io::JoinPath(testing::TmpDir(), "io_uring_file_test");
+    random::PhiloxRandom philox(1, 2);
+    random::SimplePhilox rng(&philox);
+    contents_.resize(1000 * 1000 + 17);
+    for (char& c : contents_) c = rng.Uniform(256);
+    TF_ASSERT_OK(WriteStringToFile(Env::Default(), filename_, contents_));
+  }
+
+  std::unique_ptr<RandomAccessFile> Open(int64_t queue_depth,
+                                         int64_t block_size) {
+    std::unique_ptr<RandomAccessFile> file;
+    TF_CHECK_OK(Env::Default()->NewRandomAccessFile(filename_, &file));
+    return MaybeMakeIoUringFile(filename_, std::move(file), queue_depth,
+                                block_size);
+  }
+
+  std::string filename_;
+  std::string contents_;
+};
+
+TEST_F(IoUringFileTest, SequentialReads) {
+  for (int64_t queue_depth : {1, 8}) {
+    for (int64_t block_size : {4096, 100003}) {
+      for (size_t n : {12, 5000, 300000}) {
+        std::unique_ptr<RandomAccessFile> file = Open(queue_depth, block_size);
+        std::string read;
+        std::vector<char> scratch(n);
+        Status s;
+        while (s.ok()) {
+          StringPiece result;
+          s = file->Read(read.size(), n, &result, scratch.data());
+          read.append(result.data(), result.size());
+        }
+        EXPECT_TRUE(errors::IsOutOfRange(s)) << s;
+        EXPECT_EQ(read, contents_) << "queue_depth=" << queue_depth
+                                   << " block_size=" << block_size
+                                   << " n=" << n;
+      }
+    }
+  }
+}
+
+TEST_F(IoUringFileTest, RandomReads) {
+  std::unique_ptr<RandomAccessFile> file =
+      Open(/*queue_depth=*/4, /*block_size=*/65536);
+  random::PhiloxRandom philox(3, 4);
+  random::SimplePhilox rng(&philox);
+  for (int i = 0; i < 100; ++i) {
+    const uint64 offset = rng.Uniform(contents_.size() + 10);
+    const size_t n = rng.Uniform(200000);
+    std::vector<char> scratch(n);
+    StringPiece result;
+    Status s = file->Read(offset, n, &result, scratch.data());
+    const std::string expected =
+        offset >= contents_.size() ? "" : contents_.substr(offset, n);
+    EXPECT_EQ(result, expected);
+    if (expected.size() < n) {
+      EXPECT_TRUE(errors::IsOutOfRange(s)) << s;
+    } else {
+      TF_EXPECT_OK(s);
+    }
+  }
+}
+
+TEST(IoUringFileFallbackTest, ReturnsFileUnchanged) {
+  const std::string filename =
+      io::JoinPath(testing::TmpDir(), "io_uring_file_fallback_test");
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), filename, "data"));
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(Env::Default()->NewRandomAccessFile(filename, &file));
+  RandomAccessFile* original = file.get();
+  file = MaybeMakeIoUringFile(filename, std::move(file), /*queue_depth=*/0,
+                              /*block_size=*/4096);
+  EXPECT_EQ(file.get(), original);
+  file = MaybeMakeIoUringFile(absl::StrCat("ram://", filename),
+                              std::move(file), /*queue_depth=*/4,
+                              /*block_size=*/4096);
+  EXPECT_EQ(file.get(), original);
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
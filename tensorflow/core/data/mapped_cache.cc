@@ -0,0 +1,490 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/mapped_cache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/framework/allocation_description.pb.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/lib/core/coding.h"
+#include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/refcount.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+constexpr char kShardSuffix[] = ".tfdcache";
+constexpr char kIndexSuffix[] = ".tfdcache_index";
+constexpr char kShardMagic[8] = {'T', 'F', 'D', 'C', 'A', 'C', 'H', 'E'};
+constexpr char kIndexMagic[8] = {'T', 'F', 'D', 'C', 'I', 'N', 'D', 'X'};
+constexpr uint32 kVersion = 1;
+constexpr size_t kMagicSize = sizeof(kShardMagic);
+
+// Payload encodings.
+constexpr uint32 kRawEncoding = 0;
+constexpr uint32 kProtoEncoding = 1;
+
+// Shapes of raw payloads are stored inline in their entries.
+constexpr int kMaxInlineRank = 8;
+
+// Entry layout:
+//   offset: fixed64, size: fixed64, dtype: fixed32, encoding: fixed32,
+//   rank: fixed32, reserved: fixed32, dims: fixed64[kMaxInlineRank].
+constexpr size_t kEntrySize = 32 + 8 * kMaxInlineRank;
+
+// Footer layout:
+//   magic: char[8], version: fixed32, num_components: fixed32,
+//   num_elements: fixed64, entries_offset: fixed64.
+constexpr size_t kFooterSize = kMagicSize + 4 + 4 + 8 + 8;
+
+// Index file layout: magic: char[8], num_shards: fixed64.
+constexpr size_t kIndexSize = kMagicSize + 8;
+
+struct Entry {
+  uint64 offset;
+  uint64 size;
+  DataType dtype;
+  uint32 encoding;
+  TensorShape shape;
+};
+
+std::string EncodeEntry(const Entry& entry) {
+  std::string encoded(kEntrySize, '\0');
+  char* p = &encoded[0];
+  core::EncodeFixed64(p, entry.offset);
+  core::EncodeFixed64(p + 8, entry.size);
+  core::EncodeFixed32(p + 16, entry.dtype);
+  core::EncodeFixed32(p + 20, entry.encoding);
+  if (entry.encoding == kRawEncoding) {
+    core::EncodeFixed32(p + 24, entry.shape.dims());
+    for (int i = 0; i < entry.shape.dims(); ++i) {
+      core::EncodeFixed64(p + 32 + 8 * i, entry.shape.dim_size(i));
+    }
+  }
+  return encoded;
+}
+
+Status DecodeEntry(const char* p, uint64 payload_limit, Entry* entry) {
+  entry->offset = core::DecodeFixed64(p);
+  entry->size = core::DecodeFixed64(p + 8);
+  const uint32 dtype = core::DecodeFixed32(p + 16);
+  entry->encoding = core::DecodeFixed32(p + 20);
+  if (entry->size > payload_limit ||
+      entry->offset > payload_limit - entry->size) {
+    return errors::DataLoss("Cache entry [", entry->offset, ", +",
+                            entry->size, ") exceeds the payload section");
+  }
+  if (!DataType_IsValid(dtype) || dtype == DT_INVALID) {
+    return errors::DataLoss("Invalid cache entry dtype ", dtype);
+  }
+  entry->dtype = static_cast<DataType>(dtype);
+  if (entry->encoding == kProtoEncoding) return OkStatus();
+  if (entry->encoding != kRawEncoding) {
+    return errors::DataLoss("Invalid cache entry encoding ", entry->encoding);
+  }
+  if (!DataTypeCanUseMemcpy(entry->dtype)) {
+    return errors::DataLoss("Cache entry of dtype ",
+                            DataTypeString(entry->dtype), " is not raw");
+  }
+  const uint32 rank = core::DecodeFixed32(p + 24);
+  if (rank > kMaxInlineRank) {
+    return errors::DataLoss("Invalid cache entry rank ", rank);
+  }
+  std::vector<int64_t> dims(rank);
+  for (uint32 i = 0; i < rank; ++i) {
+    dims[i] = static_cast<int64_t>(core::DecodeFixed64(p + 32 + 8 * i));
+  }
+  TF_RETURN_IF_ERROR(TensorShape::BuildTensorShape(dims, &entry->shape));
+  if (entry->shape.num_elements() * DataTypeSize(entry->dtype) !=
+      entry->size) {
+    return errors::DataLoss("Cache entry of shape ",
+                            entry->shape.DebugString(), " has ", entry->size,
+                            " bytes");
+  }
+  return OkStatus();
+}
+
+// A tensor buffer that aliases a memory-mapped payload and keeps the mapping
+// alive. Mapped pages are read-only, so the buffer reports that it does not
+// own its memory, which keeps kernels from forwarding it as an output.
+class MappedTensorBuffer : public TensorBuffer {
+ public:
+  MappedTensorBuffer(const void* data, size_t size,
+                     std::shared_ptr<ReadOnlyMemoryRegion> region)
+      : TensorBuffer(const_cast<void*>(data)),
+        size_(size),
+        region_(std::move(region)) {}
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name("MappedCache");
+    proto->set_ptr(reinterpret_cast<uintptr_t>(data()));
+  }
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  const size_t size_;
+  const std::shared_ptr<ReadOnlyMemoryRegion> region_;
+};
+
+}  // namespace
+
+bool MappedCacheFormatEnabledFromEnv() {
+  std::string format;
+  Status s = ReadStringFromEnvVar(kCacheFileFormatEnvVar, "", &format);
+  if (!s.ok()) {
+    LOG(WARNING) << "Ignoring " << kCacheFileFormatEnvVar << ": " << s;
+    return false;
+  }
+  format = absl::AsciiStrToLower(format);
+  if (format.empty() || format == "bundle") return false;
+  if (format == "mapped") return true;
+  LOG(WARNING) << "Ignoring " << kCacheFileFormatEnvVar << ": unknown format \""
+               << format << "\"; expected \"bundle\" or \"mapped\"";
+  return false;
+}
+
+std::string MappedCacheShardFilename(StringPiece prefix, int64_t shard) {
+  return absl::StrCat(prefix, "_", shard, kShardSuffix);
+}
+
+std::string MappedCacheIndexFilename(StringPiece prefix) {
+  return absl::StrCat(prefix, kIndexSuffix);
+}
+
+Status FinalizeMappedCache(Env* env, StringPiece prefix, int64_t num_shards) {
+  std::string contents(kIndexSize, '\0');
+  memcpy(&contents[0], kIndexMagic, kMagicSize);
+  core::EncodeFixed64(&contents[kMagicSize], num_shards);
+  const std::string filename = MappedCacheIndexFilename(prefix);
+  const std::string tmp_filename = absl::StrCat(filename, ".tmp");
+  TF_RETURN_IF_ERROR(WriteStringToFile(env, tmp_filename, contents));
+  return env->RenameFile(tmp_filename, filename);
+}
+
+MappedCacheWriter::MappedCacheWriter(Env* env, const std::string& filename,
+                                     int64_t num_components)
+    : env_(env), filename_(filename), num_components_(num_components) {}
+
+MappedCacheWriter::~MappedCacheWriter() {
+  if (file_ != nullptr && !finished_) {
+    file_->Close().IgnoreError();
+    env_->DeleteFile(tmp_filename_).IgnoreError();
+  }
+}
+
+Status MappedCacheWriter::Add(const std::vector<Tensor>& element) {
+  TF_RETURN_IF_ERROR(status_);
+  if (finished_) {
+    return errors::FailedPrecondition("Cache file ", filename_,
+                                      " is already finished");
+  }
+  if (element.size() != num_components_) {
+    return errors::InvalidArgument("Expected a cache element with ",
+                                   num_components_, " components, got ",
+                                   element.size());
+  }
+  status_ = EnsureFileOpen();
+  for (const Tensor& tensor : element) {
+    if (!status_.ok()) break;
+    status_ = AddTensor(tensor);
+  }
+  if (status_.ok()) num_elements_++;
+  return status_;
+}
+
+Status MappedCacheWriter::Finish() {
+  TF_RETURN_IF_ERROR(status_);
+  if (finished_) return OkStatus();
+  status_ = [this]() -> Status {
+    TF_RETURN_IF_ERROR(EnsureFileOpen());
+    const uint64 entries_offset = offset_;
+    std::string footer(kFooterSize, '\0');
+    char* p = &footer[0];
+    memcpy(p, kShardMagic, kMagicSize);
+    core::EncodeFixed32(p + kMagicSize, kVersion);
+    core::EncodeFixed32(p + kMagicSize + 4, num_components_);
+    core::EncodeFixed64(p + kMagicSize + 8, num_elements_);
+    core::EncodeFixed64(p + kMagicSize + 16, entries_offset);
+    TF_RETURN_IF_ERROR(file_->Append(entries_));
+    TF_RETURN_IF_ERROR(file_->Append(footer));
+    TF_RETURN_IF_ERROR(file_->Close());
+    TF_RETURN_IF_ERROR(env_->RenameFile(tmp_filename_, filename_));
+    finished_ = true;
+    entries_.clear();
+    return OkStatus();
+  }();
+  return status_;
+}
+
+Status MappedCacheWriter::EnsureFileOpen() {
+  if (file_ != nullptr) return OkStatus();
+  tmp_filename_ = absl::StrCat(filename_, ".tmp",
+                               absl::Hex(random::New64(), absl::kZeroPad16));
+  return env_->NewWritableFile(tmp_filename_, &file_);
+}
+
+Status MappedCacheWriter::AddTensor(const Tensor& tensor) {
+  const uint64 padding =
+      (kMappedCacheAlignment - offset_ % kMappedCacheAlignment) %
+      kMappedCacheAlignment;
+  if (padding > 0) {
+    TF_RETURN_IF_ERROR(file_->Append(std::string(padding, '\0')));
+    offset_ += padding;
+  }
+  Entry entry;
+  entry.offset = offset_;
+  entry.dtype = tensor.dtype();
+  // Raw payloads are the host's in-memory representation, as for the tensor
+  // bundle format.
+  if (DataTypeCanUseMemcpy(tensor.dtype()) &&
+      tensor.dims() <= kMaxInlineRank) {
+    entry.encoding = kRawEncoding;
+    entry.shape = tensor.shape();
+    const StringPiece data = tensor.tensor_data();
+    entry.size = data.size();
+    TF_RETURN_IF_ERROR(file_->Append(data));
+  } else {
+    entry.encoding = kProtoEncoding;
+    TensorProto proto;
+    tensor.AsProtoTensorContent(&proto);
+    std::string serialized;
+    if (!proto.SerializeToString(&serialized)) {
+      return errors::DataLoss("Could not serialize a tensor of shape ",
+                              tensor.shape().DebugString(), " to ", filename_);
+    }
+    entry.size = serialized.size();
+    TF_RETURN_IF_ERROR(file_->Append(serialized));
+  }
+  offset_ += entry.size;
+  entries_.append(EncodeEntry(entry));
+  return OkStatus();
+}
+
+struct MappedCacheReader::Shard {
+  std::string filename;
+  int64_t first_element = 0;
+  int64_t num_elements = 0;
+  // End of the payload section.
+  uint64 entries_offset = 0;
+  // Set if the shard is memory-mapped.
+  std::shared_ptr<ReadOnlyMemoryRegion> region;
+  // Set if the shard is not memory-mapped.
+  std::unique_ptr<RandomAccessFile> file;
+  std::string entries_storage;
+  // The entries, in `region` or `entries_storage`.
+  const char* entries = nullptr;
+
+  Status Open(Env* env, int64_t num_components);
+  Status Read(uint64 offset, uint64 size, char* scratch,
+              StringPiece* result) const;
+};
+
+Status MappedCacheReader::Shard::Open(Env* env, int64_t num_components) {
+  std::unique_ptr<ReadOnlyMemoryRegion> mapped;
+  Status s = env->NewReadOnlyMemoryRegionFromFile(filename, &mapped);
+  uint64 file_size;
+  if (s.ok()) {
+    region = std::move(mapped);
+    file_size = region->length();
+  } else if (errors::IsUnimplemented(s)) {
+    TF_RETURN_IF_ERROR(env->NewRandomAccessFile(filename, &file));
+    TF_RETURN_IF_ERROR(env->GetFileSize(filename, &file_size));
+  } else {
+    return s;
+  }
+  if (file_size < kFooterSize) {
+    return errors::DataLoss("Cache file ", filename, " is truncated");
+  }
+  char footer_scratch[kFooterSize];
+  StringPiece footer;
+  TF_RETURN_IF_ERROR(
+      Read(file_size - kFooterSize, kFooterSize, footer_scratch, &footer));
+  const char* p = footer.data();
+  if (memcmp(p, kShardMagic, kMagicSize) != 0) {
+    return errors::DataLoss(filename, " is not a tf.data cache file");
+  }
+  const uint32 version = core::DecodeFixed32(p + kMagicSize);
+  if (version != kVersion) {
+    return errors::FailedPrecondition("Cache file ", filename,
+                                      " has unsupported version ", version);
+  }
+  const uint32 file_num_components = core::DecodeFixed32(p + kMagicSize + 4);
+  if (file_num_components != num_components) {
+    return errors::FailedPrecondition(
+        "Cache file ", filename, " has ", file_num_components,
+        " components per element, expected ", num_components);
+  }
+  const uint64 file_num_elements = core::DecodeFixed64(p + kMagicSize + 8);
+  entries_offset = core::DecodeFixed64(p + kMagicSize + 16);
+  const uint64 entries_end = file_size - kFooterSize;
+  const uint64 entry_group_size = kEntrySize * num_components;
+  if (entries_offset > entries_end ||
+      file_num_elements > std::numeric_limits<int64_t>::max() ||
+      (entry_group_size > 0 &&
+       file_num_elements > (entries_end - entries_offset) / entry_group_size) ||
+      file_num_elements * entry_group_size != entries_end - entries_offset) {
+    return errors::DataLoss("Cache file ", filename, " has a corrupt index");
+  }
+  num_elements = file_num_elements;
+  const uint64 entries_bytes = entries_end - entries_offset;
+  if (region != nullptr) {
+    entries = static_cast<const char*>(region->data()) + entries_offset;
+    return OkStatus();
+  }
+  entries_storage.resize(entries_bytes);
+  StringPiece result;
+  TF_RETURN_IF_ERROR(Read(entries_offset, entries_bytes,
+                          &entries_storage[0], &result));
+  if (result.data() != entries_storage.data()) {
+    memcpy(&entries_storage[0], result.data(), result.size());
+  }
+  entries = entries_storage.data();
+  return OkStatus();
+}
+
+Status MappedCacheReader::Shard::Read(uint64 offset, uint64 size,
+                                      char* scratch,
+                                      StringPiece* result) const {
+  if (region != nullptr) {
+    *result = StringPiece(static_cast<const char*>(region->data()) + offset,
+                          size);
+    return OkStatus();
+  }
+  Status s = file->Read(offset, size, result, scratch);
+  if (result->size() != size) {
+    return errors::DataLoss("Could not read ", size, " bytes at offset ",
+                            offset, " of cache file ", filename, ": ", s);
+  }
+  return OkStatus();
+}
+
+MappedCacheReader::MappedCacheReader(int64_t num_components)
+    : num_components_(num_components) {}
+
+MappedCacheReader::~MappedCacheReader() = default;
+
+Status MappedCacheReader::Open(Env* env, StringPiece prefix,
+                               int64_t num_components,
+                               std::unique_ptr<MappedCacheReader>* reader) {
+  std::string index;
+  TF_RETURN_IF_ERROR(
+      ReadFileToString(env, MappedCacheIndexFilename(prefix), &index));
+  if (index.size() != kIndexSize ||
+      memcmp(index.data(), kIndexMagic, kMagicSize) != 0) {
+    return errors::DataLoss(MappedCacheIndexFilename(prefix),
+                            " is not a tf.data cache index file");
+  }
+  const int64_t num_shards = core::DecodeFixed64(index.data() + kMagicSize);
+  auto result = absl::WrapUnique(new MappedCacheReader(num_components));
+  result->shards_.reserve(num_shards);
+  for (int64_t i = 0; i < num_shards; ++i) {
+    auto shard = std::make_unique<Shard>();
+    shard->filename = MappedCacheShardFilename(prefix, i);
+    shard->first_element = result->num_elements_;
+    TF_RETURN_IF_ERROR(shard->Open(env, num_components));
+    result->num_elements_ += shard->num_elements;
+    // Empty shards are never looked up.
+    if (shard->num_elements > 0) result->shards_.push_back(std::move(shard));
+  }
+  *reader = std::move(result);
+  return OkStatus();
+}
+
+Status MappedCacheReader::Get(int64_t index,
+                              std::vector<Tensor>* element) const {
+  if (index < 0 || index >= num_elements_) {
+    return errors::OutOfRange("Index out of range [0, ", num_elements_,
+                              "):", index);
+  }
+  auto it = std::upper_bound(
+      shards_.begin(), shards_.end(), index,
+      [](int64_t index, const std::unique_ptr<Shard>& shard) {
+        return index < shard->first_element;
+      });
+  const Shard& shard = **std::prev(it);
+  const int64_t local_index = index - shard.first_element;
+  element->clear();
+  element->reserve(num_components_);
+  for (int64_t i = 0; i < num_components_; ++i) {
+    Entry entry;
+    TF_RETURN_IF_ERROR(DecodeEntry(
+        shard.entries + (local_index * num_components_ + i) * kEntrySize,
+        shard.entries_offset, &entry));
+    if (entry.encoding == kRawEncoding) {
+      if (shard.region != nullptr && entry.size > 0 &&
+          entry.offset % kMappedCacheAlignment == 0) {
+        const char* data =
+            static_cast<const char*>(shard.region->data()) + entry.offset;
+        element->emplace_back(entry.dtype, entry.shape,
+                              core::RefCountPtr<TensorBuffer>(
+                                  new MappedTensorBuffer(data, entry.size,
+                                                         shard.region)));
+        continue;
+      }
+      Tensor tensor(cpu_allocator(), entry.dtype, entry.shape);
+      if (entry.size > 0) {
+        char* scratch = const_cast<char*>(tensor.tensor_data().data());
+        StringPiece result;
+        TF_RETURN_IF_ERROR(
+            shard.Read(entry.offset, entry.size, scratch, &result));
+        if (result.data() != scratch) {
+          memcpy(scratch, result.data(), result.size());
+        }
+      }
+      element->push_back(std::move(tensor));
+      continue;
+    }
+    std::string scratch;
+    if (shard.region == nullptr) scratch.resize(entry.size);
+    StringPiece serialized;
+    TF_RETURN_IF_ERROR(
+        shard.Read(entry.offset, entry.size, &scratch[0], &serialized));
+    TensorProto proto;
+    if (!proto.ParseFromArray(serialized.data(), serialized.size())) {
+      return errors::DataLoss("Could not parse element ", index,
+                              " from cache file ", shard.filename);
+    }
+    element->emplace_back();
+    if (!element->back().FromProto(cpu_allocator(), proto)) {
+      return errors::DataLoss("Could not parse element ", index,
+                              " from cache file ", shard.filename);
+    }
+  }
+  return OkStatus();
+}
+
+}  // namespace data
+}  // namespace tensorflow
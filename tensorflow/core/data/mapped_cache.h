@@ -0,0 +1,137 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_MAPPED_CACHE_H_
+#define TENSORFLOW_CORE_DATA_MAPPED_CACHE_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/stringpiece.h"
+
+namespace tensorflow {
+namespace data {
+
+// An on-disk format for the elements of a file cache that can be read by
+// element index and memory-mapped.
+//
+// A cache with prefix `prefix` consists of shard files
+// `MappedCacheShardFilename(prefix, i)`, each written by a `MappedCacheWriter`,
+// and an index file `MappedCacheIndexFilename(prefix)` that records the number
+// of shards. The index file is written last, so its presence means that the
+// cache is complete.
+//
+// A shard file holds the tensor payloads of its elements, each aligned to
+// `kMappedCacheAlignment` bytes, followed by one fixed-size entry per element
+// component and a footer:
+//
+//   [payload]* [entry]{num_elements * num_components} [footer]
+//
+// An entry holds the offset, size, dtype and shape of a payload. Payloads of
+// dtypes that can be memcpy'd are the raw tensor bytes and are aliased
+// without copying when the shard is memory-mapped; other payloads are
+// serialized `TensorProto`s.
+
+// Alignment of payloads in a shard file.
+inline constexpr int64_t kMappedCacheAlignment = 64;
+
+// Name of the environment variable that selects the file format written by
+// `Dataset.cache(filename)`. Setting it to "mapped" writes this format instead
+// of a tensor bundle. Either format is read back regardless of the setting.
+inline constexpr char kCacheFileFormatEnvVar[] = "TF_DATA_CACHE_FILE_FORMAT";
+
+// Returns whether `kCacheFileFormatEnvVar` selects this format.
+bool MappedCacheFormatEnabledFromEnv();
+
+std::string MappedCacheShardFilename(StringPiece prefix, int64_t shard);
+std::string MappedCacheIndexFilename(StringPiece prefix);
+
+// Writes the index file of the cache with prefix `prefix`, marking the cache
+// with shards [0, num_shards) complete.
+Status FinalizeMappedCache(Env* env, StringPiece prefix, int64_t num_shards);
+
+// Writes one shard file. The file is created on the first call to `Add` or
+// `Finish`, and is written under a temporary name that `Finish` renames to
+// `filename`.
+//
+// This class is not thread-safe.
+class MappedCacheWriter {
+ public:
+  MappedCacheWriter(Env* env, const std::string& filename,
+                    int64_t num_components);
+  ~MappedCacheWriter();
+
+  Status Add(const std::vector<Tensor>& element);
+  Status Finish();
+
+  // Returns the first error encountered by `Add` or `Finish`.
+  Status status() const { return status_; }
+  int64_t num_elements() const { return num_elements_; }
+
+ private:
+  Status EnsureFileOpen();
+  Status AddTensor(const Tensor& tensor);
+
+  Env* const env_;
+  const std::string filename_;
+  const int64_t num_components_;
+  std::string tmp_filename_;
+  std::unique_ptr<WritableFile> file_;
+  uint64_t offset_ = 0;
+  std::string entries_;
+  int64_t num_elements_ = 0;
+  bool finished_ = false;
+  Status status_;
+};
+
+// Reads the elements of a complete cache by index. When the file system
+// supports it, the shards are memory-mapped and the returned tensors of
+// memcpy-able dtypes alias the mapped pages; the mapping stays alive until
+// the last such tensor and the reader are destroyed. Otherwise, the payloads
+// are read into newly allocated tensors.
+//
+// This class is thread-safe.
+class MappedCacheReader {
+ public:
+  // Opens the cache with prefix `prefix`, which must be complete and have
+  // `num_components` components per element.
+  static Status Open(Env* env, StringPiece prefix, int64_t num_components,
+                     std::unique_ptr<MappedCacheReader>* reader);
+  ~MappedCacheReader();
+
+  int64_t num_elements() const { return num_elements_; }
+
+  // Reads the element at `index`, which must be in [0, num_elements()).
+  Status Get(int64_t index, std::vector<Tensor>* element) const;
+
+ private:
+  struct Shard;
+
+  explicit MappedCacheReader(int64_t num_components);
+
+  const int64_t num_components_;
+  int64_t num_elements_ = 0;
+  // Sorted by `Shard::first_element`.
+  std::vector<std::unique_ptr<Shard>> shards_;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_MAPPED_CACHE_H_
@@ -0,0 +1,151 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/mapped_cache.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+std::string TestPrefix() {
+  return io::JoinPath(
+      testing::TmpDir(),
+      ::testing::UnitTest::GetInstance()->current_test_info()->name());
+}
+
+std::vector<Tensor> MakeElement(int64_t i) {
+  return {test::AsTensor<int64_t>({i, i + 1, i + 2}, TensorShape({3})),
+          test::AsScalar<tstring>(absl::StrCat("element_", i)),
+          test::AsTensor<float>({static_cast<float>(i)}, TensorShape({1, 1}))};
+}
+
+// Writes `num_elements` elements split into `num_shards` shards.
+void WriteCache(const std::string& prefix, int64_t num_elements,
+                int64_t num_shards) {
+  int64_t next = 0;
+  for (int64_t shard = 0; shard < num_shards; ++shard) {
+    MappedCacheWriter writer(Env::Default(),
+                             MappedCacheShardFilename(prefix, shard),
+                             /*num_components=*/3);
+    const int64_t end = num_elements * (shard + 1) / num_shards;
+    for (; next < end; ++next) {
+      TF_ASSERT_OK(writer.Add(MakeElement(next)));
+    }
+    TF_ASSERT_OK(writer.Finish());
+  }
+  TF_ASSERT_OK(FinalizeMappedCache(Env::Default(), prefix, num_shards));
+}
+
+void ExpectElement(const std::vector<Tensor>& element, int64_t i) {
+  std::vector<Tensor> expected = MakeElement(i);
+  ASSERT_EQ(element.size(), expected.size());
+  for (size_t j = 0; j < element.size(); ++j) {
+    test::ExpectEqual(element[j], expected[j]);
+  }
+}
+
+TEST(MappedCacheTest, RandomAccess) {
+  const std::string prefix = TestPrefix();
+  WriteCache(prefix, /*num_elements=*/100, /*num_shards=*/3);
+  std::unique_ptr<MappedCacheReader> reader;
+  TF_ASSERT_OK(MappedCacheReader::Open(Env::Default(), prefix,
+                                       /*num_components=*/3, &reader));
+  EXPECT_EQ(reader->num_elements(), 100);
+  for (int64_t i : {99, 0, 33, 34, 66, 67, 50}) {
+    std::vector<Tensor> element;
+    TF_ASSERT_OK(reader->Get(i, &element));
+    ExpectElement(element, i);
+  }
+  std::vector<Tensor> element;
+  EXPECT_TRUE(errors::IsOutOfRange(reader->Get(100, &element)));
+  EXPECT_TRUE(errors::IsOutOfRange(reader->Get(-1, &element)));
+}
+
+TEST(MappedCacheTest, TensorsAliasTheMappingAndOutliveTheReader) {
+  const std::string prefix = TestPrefix();
+  WriteCache(prefix, /*num_elements=*/10, /*num_shards=*/1);
+  std::unique_ptr<MappedCacheReader> reader;
+  TF_ASSERT_OK(MappedCacheReader::Open(Env::Default(), prefix,
+                                       /*num_components=*/3, &reader));
+  std::vector<Tensor> element, again;
+  TF_ASSERT_OK(reader->Get(7, &element));
+  TF_ASSERT_OK(reader->Get(7, &again));
+  EXPECT_TRUE(element[0].IsAligned());
+  // Both reads return the mapped payload rather than copies of it.
+  EXPECT_EQ(element[0].tensor_data().data(), again[0].tensor_data().data());
+  reader.reset();
+  again.clear();
+  ExpectElement(element, 7);
+}
+
+TEST(MappedCacheTest, EmptyShards) {
+  const std::string prefix = TestPrefix();
+  WriteCache(prefix, /*num_elements=*/2, /*num_shards=*/4);
+  std::unique_ptr<MappedCacheReader> reader;
+  TF_ASSERT_OK(MappedCacheReader::Open(Env::Default(), prefix,
+                                       /*num_components=*/3, &reader));
+  EXPECT_EQ(reader->num_elements(), 2);
+  std::vector<Tensor> element;
+  TF_ASSERT_OK(reader->Get(1, &element));
+  ExpectElement(element, 1);
+}
+
+TEST(MappedCacheTest, IncompleteCache) {
+  const std::string prefix = TestPrefix();
+  MappedCacheWriter writer(Env::Default(), MappedCacheShardFilename(prefix, 0),
+                           /*num_components=*/3);
+  TF_ASSERT_OK(writer.Add(MakeElement(0)));
+  TF_ASSERT_OK(writer.Finish());
+  std::unique_ptr<MappedCacheReader> reader;
+  EXPECT_TRUE(errors::IsNotFound(MappedCacheReader::Open(
+      Env::Default(), prefix, /*num_components=*/3, &reader)));
+}
+
+TEST(MappedCacheTest, WrongNumberOfComponents) {
+  const std::string prefix = TestPrefix();
+  WriteCache(prefix, /*num_elements=*/1, /*num_shards=*/1);
+  std::unique_ptr<MappedCacheReader> reader;
+  EXPECT_TRUE(errors::IsFailedPrecondition(MappedCacheReader::Open(
+      Env::Default(), prefix, /*num_components=*/2, &reader)));
+  MappedCacheWriter writer(Env::Default(), MappedCacheShardFilename(prefix, 1),
+                           /*num_components=*/2);
+  EXPECT_TRUE(errors::IsInvalidArgument(writer.Add(MakeElement(0))));
+}
+
+TEST(MappedCacheTest, CorruptShard) {
+  const std::string prefix = TestPrefix();
+  WriteCache(prefix, /*num_elements=*/5, /*num_shards=*/1);
+  const std::string filename = MappedCacheShardFilename(prefix, 0);
+  std::string contents;
+  TF_ASSERT_OK(ReadFileToString(Env::Default(), filename, &contents));
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), filename,
+                                 contents.substr(0, contents.size() - 1)));
+  std::unique_ptr<MappedCacheReader> reader;
+  EXPECT_TRUE(errors::IsDataLoss(MappedCacheReader::Open(
+      Env::Default(), prefix, /*num_components=*/3, &reader)));
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/data/root_dataset.h"
 
 #include <algorithm>
+#include <atomic>
 #include <functional>
 #include <memory>
 #include <string>
@@ -25,10 +26,13 @@ limitations under the License.
 #include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/data/rewrite_utils.h"
+#include "tensorflow/core/data/unbounded_thread_pool.h"
+#include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/dataset_options.pb.h"
 #include "tensorflow/core/framework/model.pb.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/host_info.h"
+#include "tensorflow/core/platform/numa.h"
 #include "tensorflow/core/platform/refcount.h"
 #include "tensorflow/core/platform/stringprintf.h"
 
@@ -48,6 +52,7 @@ constexpr char kPrivateThreadpoolSize[] = "threadpool_size";
 constexpr char kRamBudget[] = "ram_budget_megabytes";
 constexpr char kRamUsage[] = "ram_usage_megabytes";
 constexpr char kMaxBufferBytes[] = "max_buffered_megabytes";
+constexpr char kNumaNode[] = "numa_node";
 constexpr char kWarmStart[] = "warm_start";
 
 // If value `x` matches `y`, returns default value `z`. Otherwise, return `x`.
@@ -64,6 +69,12 @@ void SetRootDatasetParams(const Options& options, RootDataset::Params* params) {
     params->private_threadpool_size =
         options.threading_options().private_threadpool_size();
   }
+  if (options.threading_options().optional_numa_node_case() ==
+      ThreadingOptions::kNumaNode) {
+    params->numa_node = options.threading_options().numa_node();
+  }
+  params->spread_across_numa_nodes =
+      options.threading_options().spread_across_numa_nodes();
   params->autotune = ShouldUseAutotuning(options);
   if (params->autotune) {
     params->autotune_algorithm = model::AutotuneAlgorithm::DEFAULT;
@@ -95,6 +106,31 @@ void SetRootDatasetParams(const Options& options, RootDataset::Params* params) {
   }
 }
 
+// Returns the NUMA node to pin a new iterator of a dataset with the given
+// `params` to, or `port::kNUMANoAffinity`.
+int SelectNumaNode(const RootDataset::Params& params) {
+  if (params.numa_node == port::kNUMANoAffinity &&
+      !params.spread_across_numa_nodes) {
+    return port::kNUMANoAffinity;
+  }
+  if (!port::NUMAEnabled()) {
+    VLOG(1) << "Not pinning tf.data iterator: NUMA is not supported";
+    return port::kNUMANoAffinity;
+  }
+  const int num_nodes = port::NUMANumNodes();
+  if (params.spread_across_numa_nodes) {
+    static std::atomic<int64_t>* next_node = new std::atomic<int64_t>(0);
+    return next_node->fetch_add(1) % num_nodes;
+  }
+  if (params.numa_node < 0 || params.numa_node >= num_nodes) {
+    LOG(WARNING) << "Not pinning tf.data iterator to NUMA node "
+                 << params.numa_node << ": there are " << num_nodes
+                 << " NUMA nodes";
+    return port::kNUMANoAffinity;
+  }
+  return params.numa_node;
+}
+
 void AddTraceMetadata(const RootDataset::Params& params, const Options& options,
                       TraceMeMetadata* trace_metadata) {
   if (params.autotune) {
@@ -165,19 +201,41 @@ class RootDataset::Iterator : public DatasetIterator<RootDataset> {
       if (experiments.contains("autotune_buffer_optimization")) {
         model_->AddExperiment("autotune_buffer_optimization");
       }
+      if (experiments.contains("global_ram_budget")) {
+        model_->AddExperiment("global_ram_budget");
+      }
+      if (experiments.contains("hard_cpu_budget")) {
+        model_->AddExperiment("hard_cpu_budget");
+      }
     }
     if (dataset()->params_.max_intra_op_parallelism >= 0) {
       max_intra_op_parallelism_ =
           value_or_default(dataset()->params_.max_intra_op_parallelism, 0,
                            port::MaxParallelism());
     }
+    numa_node_ = SelectNumaNode(dataset()->params_);
+    ThreadOptions thread_options;
+    thread_options.numa_node = numa_node_;
     if (dataset()->params_.private_threadpool_size >= 0) {
       threadpool_size_ =
           value_or_default(dataset()->params_.private_threadpool_size, 0,
-                           port::MaxParallelism());
+                           port::MaxParallelism(numa_node_));
       thread_pool_ = std::make_unique<thread::ThreadPool>(
-          Env::Default(), ThreadOptions{}, "data_private_threadpool",
+          Env::Default(), thread_options, "data_private_threadpool",
           threadpool_size_);
+    } else if (numa_node_ != port::kNUMANoAffinity) {
+      // The functions of the pipeline run on the cores of the NUMA node rather
+      // than on the inter-op thread pool.
+      threadpool_size_ = port::MaxParallelism(numa_node_);
+      thread_pool_ = std::make_unique<thread::ThreadPool>(
+          Env::Default(), thread_options, "data_numa_threadpool",
+          threadpool_size_);
+    }
+    if (numa_node_ != port::kNUMANoAffinity) {
+      // Background threads, e.g. those of parallel map and interleave, are
+      // pinned to the NUMA node as well.
+      numa_thread_pool_ = std::make_unique<UnboundedThreadPool>(
+          Env::Default(), "tf_data_numa", thread_options);
     }
     cancellation_manager_ = std::make_unique<CancellationManager>();
   }
@@ -186,6 +244,10 @@ class RootDataset::Iterator : public DatasetIterator<RootDataset> {
 
   bool SymbolicCheckpointCompatible() const override { return true; }
 
+  int NumaNode() const override { return numa_node_; }
+
+  std::shared_ptr<model::Model> model() const override { return model_; }
+
   Status Initialize(IteratorContext* ctx) override {
     IteratorContext iter_ctx(CreateParams(ctx));
     TF_RETURN_IF_ERROR(dataset()->input_->MakeIterator(&iter_ctx, this,
@@ -245,6 +307,10 @@ class RootDataset::Iterator : public DatasetIterator<RootDataset> {
           kMemBandwidth,
           strings::Printf("%lld", static_cast<long long>(mem_bw))));
     }
+    if (numa_node_ != port::kNUMANoAffinity) {
+      traceme_metadata.push_back(std::make_pair(
+          kNumaNode, strings::Printf("%d", numa_node_)));
+    }
     const auto memory_info = port::GetMemoryInfo();
     const auto memory_usage = memory_info.total - memory_info.free;
     traceme_metadata.push_back(std::make_pair(
@@ -270,12 +336,19 @@ class RootDataset::Iterator : public DatasetIterator<RootDataset> {
     if (dataset()->params_.autotune) {
       params.model = model_;
     }
-    if (dataset()->params_.private_threadpool_size >= 0) {
+    if (thread_pool_ != nullptr) {
       params.runner = [pool = thread_pool_.get()](std::function<void()> c) {
         pool->Schedule(std::move(c));
       };
       params.runner_threadpool_size = threadpool_size_;
     }
+    if (numa_thread_pool_ != nullptr) {
+      params.thread_factory = numa_thread_pool_->get_thread_factory();
+      params.thread_pool = numa_thread_pool_.get();
+      params.allocator_getter = [numa_node = numa_node_](AllocatorAttributes) {
+        return cpu_allocator(numa_node);
+      };
+    }
     if (dataset()->params_.max_intra_op_parallelism >= 0) {
       params.runner =
           RunnerWithMaxParallelism(params.runner, max_intra_op_parallelism_);
@@ -308,7 +381,10 @@ class RootDataset::Iterator : public DatasetIterator<RootDataset> {
   std::unique_ptr<Thread> model_thread_ TF_GUARDED_BY(mu_);
   int64_t max_intra_op_parallelism_;
   int64_t threadpool_size_;
+  int numa_node_;
   std::unique_ptr<thread::ThreadPool> thread_pool_;
+  // Only set if the iterator is pinned to a NUMA node.
+  std::unique_ptr<UnboundedThreadPool> numa_thread_pool_;
 
   // The end time of the previous `GetNextInternal` call.
   uint64_t end_time_usec_ TF_GUARDED_BY(mu_) = 0;
@@ -359,7 +435,7 @@ int64_t RootDataset::CardinalityInternal(CardinalityOptions options) const {
   return input_->Cardinality(options);
 }
 
-Status RootDataset::Get(OpKernelContext* ctx, int64 index,
+Status RootDataset::Get(AnyContext ctx, int64 index,
                         std::vector<Tensor>* out_tensors) const {
   std::vector<const DatasetBase*> inputs;
   TF_RETURN_IF_ERROR(this->InputDatasets(&inputs));
@@ -37,6 +37,8 @@ class RootDataset : public DatasetBase {
     int64_t autotune_ram_budget = 0;
     int64_t max_intra_op_parallelism = 1;
     int64_t private_threadpool_size = 0;
+    int64_t numa_node = port::kNUMANoAffinity;
+    bool spread_across_numa_nodes = false;
   };
 
   static Status FromOptions(const DatasetBase* input, DatasetBase** output);
@@ -49,7 +51,7 @@ class RootDataset : public DatasetBase {
   const std::vector<PartialTensorShape>& output_shapes() const override;
 
   int64_t CardinalityInternal(CardinalityOptions options) const override;
-  Status Get(OpKernelContext* ctx, int64 index,
+  Status Get(AnyContext ctx, int64 index,
              std::vector<Tensor>* out_tensors) const override;
   Status CheckExternalState() const override;
   string DebugString() const override;
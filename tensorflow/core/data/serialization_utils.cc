@@ -327,13 +327,12 @@ Status VariantTensorDataWriter::WriteTensor(StringPiece name, StringPiece key,
 
 void VariantTensorDataWriter::MaybeFlush() {
   if (is_flushed_) return;
-  for (auto& keys : keys_) {
-    const string name = keys.first;
+  for (const auto& [name, keys] : keys_) {
     string metadata = name;
-    for (size_t i = 0; i < keys_[name].size(); ++i) {
-      strings::StrAppend(&metadata, kDelimiter, keys_[name][i]);
+    for (const string& key : keys) {
+      strings::StrAppend(&metadata, kDelimiter, key);
     }
-    data_[name]->set_metadata(metadata);
+    data_[name]->metadata_string() = std::move(metadata);
   }
   is_flushed_ = true;
 }
@@ -386,16 +385,17 @@ Status VariantTensorDataWriter::WriteTensorInternal(StringPiece n,
         "Cannot call WriteTensor after GetData or ReleaseData is called");
   }
   DCHECK_EQ(key.find(kDelimiter), string::npos);
+  // Iterators with large buffers write millions of tensors while their
+  // pipeline is paused, so look up the per-iterator state only once. The
+  // tensors themselves are shallow copies of the buffered ones.
   string name(n);
-  if (keys_.count(name) == 0) {
-    keys_[name] = std::vector<string>();
+  keys_[name].emplace_back(key);
+  std::unique_ptr<VariantTensorData>& data = data_[std::move(name)];
+  if (data == nullptr) {
+    data = std::make_unique<VariantTensorData>();
+    data->set_type_name("tensorflow::Iterator");
   }
-  keys_[name].push_back(string(key));
-  if (data_.count(name) == 0) {
-    data_[name] = std::make_unique<VariantTensorData>();
-    data_[name]->set_type_name("tensorflow::Iterator");
-  }
-  *(data_[name]->add_tensors()) = val;
+  *(data->add_tensors()) = val;
   return OkStatus();
 }
 
@@ -38,6 +38,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/str_util.h"
+#include "tensorflow/core/platform/strcat.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/protobuf/error_codes.pb.h"
 #include "tensorflow/core/public/session_options.h"
@@ -168,6 +169,40 @@ TEST(SerializationUtilsTest, VariantTensorDataWriteAfterFlushing) {
             writer.WriteTensor(full_name("Tensor"), input_tensor).code());
 }
 
+TEST(SerializationUtilsTest, VariantTensorDataInterleavedIterators) {
+  // Nested iterators interleave their writes, and buffered elements are
+  // written without copying their bytes.
+  VariantTensorDataWriter writer;
+  Tensor buffered(DT_FLOAT, {2});
+  buffered.flat<float>().setConstant(3.0f);
+  for (int64_t i = 0; i < 3; ++i) {
+    TF_ASSERT_OK(
+        writer.WriteScalar("Iterator:a", strings::StrCat("key", i), i));
+    TF_ASSERT_OK(
+        writer.WriteTensor("Iterator:b", strings::StrCat("key", i), buffered));
+  }
+  std::vector<const VariantTensorData*> data;
+  writer.GetData(&data);
+  ASSERT_EQ(data.size(), 2);
+  for (const VariantTensorData* d : data) {
+    EXPECT_EQ(d->type_name(), "tensorflow::Iterator");
+    EXPECT_EQ(d->tensors_size(), 3);
+  }
+
+  VariantTensorDataReader reader(data);
+  for (int64_t i = 0; i < 3; ++i) {
+    int64_t val_int64;
+    TF_ASSERT_OK(
+        reader.ReadScalar("Iterator:a", strings::StrCat("key", i), &val_int64));
+    EXPECT_EQ(val_int64, i);
+    Tensor val_tensor;
+    TF_ASSERT_OK(reader.ReadTensor("Iterator:b", strings::StrCat("key", i),
+                                   &val_tensor));
+    test::ExpectTensorEqual<float>(val_tensor, buffered);
+    EXPECT_TRUE(val_tensor.SharesBufferWith(buffered));
+  }
+}
+
 class ParameterizedIteratorStateVariantTest
     : public DatasetOpsTestBase,
       public ::testing::WithParamInterface<std::vector<Tensor>> {
@@ -15,8 +15,16 @@ limitations under the License.
 
 #include "tensorflow/core/data/service/auto_scaler.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <optional>
 #include <string>
+#include <utility>
+#include <vector>
 
+#include "absl/container/flat_hash_set.h"
 #include "absl/strings/str_cat.h"
 #include "absl/time/time.h"
 #include "tensorflow/tsl/platform/mutex.h"
@@ -82,5 +90,199 @@ tsl::Status AutoScaler::RemoveConsumer(int64_t consumer_id)
   return tsl::OkStatus();
 }
 
+std::optional<int64_t> AutoScaler::GetOptimalNumberOfWorkers() const
+    TF_LOCKS_EXCLUDED(mu_) {
+  tsl::mutex_lock l(mu_);
+  if (worker_throughputs_.empty() || consumption_rates_.empty()) {
+    return std::nullopt;
+  }
+
+  double consumption_rates_sum = 0.0;
+  for (const auto& [consumer_id, consumption_rate] : consumption_rates_) {
+    consumption_rates_sum += consumption_rate;
+  }
+  double worker_throughputs_sum = 0.0;
+  for (const auto& [worker_address, worker_throughput] : worker_throughputs_) {
+    worker_throughputs_sum += worker_throughput;
+  }
+  double average_worker_throughput =
+      worker_throughputs_sum / static_cast<double>(worker_throughputs_.size());
+  return std::max<int64_t>(
+      1, static_cast<int64_t>(
+             std::ceil(consumption_rates_sum / average_worker_throughput)));
+}
+
+std::vector<std::string> AutoScaler::GetSlowWorkers(double threshold) const
+    TF_LOCKS_EXCLUDED(mu_) {
+  tsl::mutex_lock l(mu_);
+  std::vector<double> throughputs;
+  throughputs.reserve(worker_throughputs_.size());
+  for (const auto& [worker_address, worker_throughput] : worker_throughputs_) {
+    throughputs.push_back(worker_throughput);
+  }
+  if (throughputs.empty()) {
+    return {};
+  }
+  auto middle = throughputs.begin() + throughputs.size() / 2;
+  std::nth_element(throughputs.begin(), middle, throughputs.end());
+  double median = *middle;
+  if (throughputs.size() % 2 == 0) {
+    median = (median + *std::max_element(throughputs.begin(), middle)) / 2.0;
+  }
+
+  std::vector<std::string> slow_workers;
+  for (const auto& [worker_address, worker_throughput] : worker_throughputs_) {
+    if (worker_throughput < threshold * median) {
+      slow_workers.push_back(worker_address);
+    }
+  }
+  return slow_workers;
+}
+
+MultipleIterationsAutoScaler::MultipleIterationsAutoScaler(
+    const Options& options)
+    : options_(options) {}
+
+tsl::Status MultipleIterationsAutoScaler::RegisterIteration(
+    int64_t iteration_id) TF_LOCKS_EXCLUDED(mu_) {
+  tsl::mutex_lock l(mu_);
+  if (auto_scalers_.contains(iteration_id)) {
+    return absl::AlreadyExistsError(absl::StrCat(
+        "AutoScaler for iteration_id ", iteration_id, " already exists"));
+  }
+  auto_scalers_[iteration_id] = std::make_unique<AutoScaler>();
+  return tsl::OkStatus();
+}
+
+tsl::Status MultipleIterationsAutoScaler::UnregisterIteration(
+    int64_t iteration_id) TF_LOCKS_EXCLUDED(mu_) {
+  tsl::mutex_lock l(mu_);
+  if (!auto_scalers_.contains(iteration_id)) {
+    return absl::NotFoundError(absl::StrCat(
+        "AutoScaler for iteration_id ", iteration_id, " does not exist"));
+  }
+  auto_scalers_.erase(iteration_id);
+  worker_count_targets_.erase(iteration_id);
+  return tsl::OkStatus();
+}
+
+tsl::Status MultipleIterationsAutoScaler::ReportProcessingTime(
+    int64_t iteration_id, const std::string& worker_address,
+    absl::Duration processing_time) TF_LOCKS_EXCLUDED(mu_) {
+  tsl::mutex_lock l(mu_);
+  auto it = auto_scalers_.find(iteration_id);
+  if (it == auto_scalers_.end()) {
+    return absl::NotFoundError(absl::StrCat(
+        "AutoScaler for iteration_id ", iteration_id, " does not exist"));
+  }
+  return it->second->ReportProcessingTime(worker_address, processing_time);
+}
+
+tsl::Status MultipleIterationsAutoScaler::ReportTargetProcessingTime(
+    int64_t iteration_id, int64_t consumer_id,
+    absl::Duration target_processing_time) TF_LOCKS_EXCLUDED(mu_) {
+  tsl::mutex_lock l(mu_);
+  auto it = auto_scalers_.find(iteration_id);
+  if (it == auto_scalers_.end()) {
+    return absl::NotFoundError(absl::StrCat(
+        "AutoScaler for iteration_id ", iteration_id, " does not exist"));
+  }
+  return it->second->ReportTargetProcessingTime(consumer_id,
+                                                target_processing_time);
+}
+
+tsl::Status MultipleIterationsAutoScaler::RemoveWorker(
+    const std::string& worker_address) TF_LOCKS_EXCLUDED(mu_) {
+  tsl::mutex_lock l(mu_);
+  bool found = false;
+  for (auto& [iteration_id, auto_scaler] : auto_scalers_) {
+    found |= auto_scaler->RemoveWorker(worker_address).ok();
+  }
+  if (!found) {
+    return absl::NotFoundError(
+        absl::StrCat("Worker with address ", worker_address, " not found"));
+  }
+  return tsl::OkStatus();
+}
+
+tsl::Status MultipleIterationsAutoScaler::RemoveConsumer(int64_t iteration_id,
+                                                         int64_t consumer_id)
+    TF_LOCKS_EXCLUDED(mu_) {
+  tsl::mutex_lock l(mu_);
+  auto it = auto_scalers_.find(iteration_id);
+  if (it == auto_scalers_.end()) {
+    return absl::NotFoundError(absl::StrCat(
+        "AutoScaler for iteration_id ", iteration_id, " does not exist"));
+  }
+  return it->second->RemoveConsumer(consumer_id);
+}
+
+void MultipleIterationsAutoScaler::UpdateWorkerCountTargets()
+    TF_LOCKS_EXCLUDED(mu_) {
+  tsl::mutex_lock l(mu_);
+  for (const auto& [iteration_id, auto_scaler] : auto_scalers_) {
+    std::optional<int64_t> estimate = auto_scaler->GetOptimalNumberOfWorkers();
+    if (!estimate.has_value()) {
+      continue;
+    }
+    auto it = worker_count_targets_.find(iteration_id);
+    if (it == worker_count_targets_.end()) {
+      worker_count_targets_[iteration_id] = *estimate;
+      continue;
+    }
+    int64_t& target = it->second;
+    if (*estimate > target ||
+        *estimate < (1.0 - options_.hysteresis) * static_cast<double>(target)) {
+      target = *estimate;
+    }
+  }
+}
+
+absl::flat_hash_map<int64_t, int64_t>
+MultipleIterationsAutoScaler::GetWorkerCountTargets() const
+    TF_LOCKS_EXCLUDED(mu_) {
+  tsl::mutex_lock l(mu_);
+  return worker_count_targets_;
+}
+
+std::optional<int64_t> MultipleIterationsAutoScaler::GetWorkerCountTarget()
+    const TF_LOCKS_EXCLUDED(mu_) {
+  tsl::mutex_lock l(mu_);
+  std::optional<int64_t> result;
+  for (const auto& [iteration_id, target] : worker_count_targets_) {
+    result = std::max(result.value_or(0), target);
+  }
+  return result;
+}
+
+std::optional<int64_t>
+MultipleIterationsAutoScaler::GetOptimalNumberOfWorkers() const
+    TF_LOCKS_EXCLUDED(mu_) {
+  tsl::mutex_lock l(mu_);
+  std::optional<int64_t> result;
+  for (const auto& [iteration_id, auto_scaler] : auto_scalers_) {
+    std::optional<int64_t> estimate = auto_scaler->GetOptimalNumberOfWorkers();
+    if (estimate.has_value()) {
+      result = std::max(result.value_or(0), *estimate);
+    }
+  }
+  return result;
+}
+
+std::vector<std::string> MultipleIterationsAutoScaler::GetSlowWorkers() const
+    TF_LOCKS_EXCLUDED(mu_) {
+  tsl::mutex_lock l(mu_);
+  absl::flat_hash_set<std::string> slow_workers;
+  for (const auto& [iteration_id, auto_scaler] : auto_scalers_) {
+    for (std::string& worker_address :
+         auto_scaler->GetSlowWorkers(options_.slow_worker_threshold)) {
+      slow_workers.insert(std::move(worker_address));
+    }
+  }
+  std::vector<std::string> result(slow_workers.begin(), slow_workers.end());
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
 }  // namespace data
 }  // namespace tensorflow
@@ -16,7 +16,11 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DATA_SERVICE_AUTO_SCALER_H_
 #define TENSORFLOW_CORE_DATA_SERVICE_AUTO_SCALER_H_
 
+#include <cstdint>
+#include <memory>
+#include <optional>
 #include <string>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/time/time.h"
@@ -27,9 +31,9 @@ limitations under the License.
 namespace tensorflow {
 namespace data {
 
-// Exports a metric (/tensorflow/data/service/optimal_number_of_workers) with
-// the current estimated optimal number of tf.data service workers, according to
-// the observed cluster workload.
+// Estimates the optimal number of tf.data service workers for an iteration,
+// according to the observed workload. The dispatcher exports the estimate in
+// the /tensorflow/data/service/optimal_number_of_workers metric.
 //
 // Glossary:
 // * Consumer: A client that consumes elements from tf.data service.
@@ -58,8 +62,10 @@ namespace data {
 // and TPTs, respectively.
 // 2. Having this information, it estimates the optimal number of workers N as
 // follows:
-//  N = (Sum of CRs reported by all consumers) /
-//      (Average of WTs reported by all workers)
+//  N = ceil((Sum of CRs reported by all consumers) /
+//           (Average of WTs reported by all workers))
+// 3. It reports workers whose WT is well below the median WT as slow, since
+// they hold back consumers even when the number of workers is sufficient.
 //
 // AutoScaler is thread-safe.
 class AutoScaler {
@@ -86,6 +92,14 @@ class AutoScaler {
   // target processing time from consideration of the current workload
   // estimation. Returns an error if the specified consumer does not exist.
   tsl::Status RemoveConsumer(int64_t consumer_id) TF_LOCKS_EXCLUDED(mu_);
+  // Returns the estimated optimal number of workers, or `std::nullopt` if no
+  // worker or no consumer has reported yet.
+  std::optional<int64_t> GetOptimalNumberOfWorkers() const
+      TF_LOCKS_EXCLUDED(mu_);
+  // Returns the addresses of the workers whose throughput is below
+  // `threshold` times the median worker throughput, in no particular order.
+  std::vector<std::string> GetSlowWorkers(double threshold) const
+      TF_LOCKS_EXCLUDED(mu_);
 
  private:
   mutable tsl::mutex mu_;
@@ -96,6 +110,86 @@ class AutoScaler {
   absl::flat_hash_map<int64_t, double> consumption_rates_ TF_GUARDED_BY(mu_);
 };
 
+// Turns the estimates of an `AutoScaler` per iteration into worker count
+// targets which a cluster auto-scaler can act on.
+//
+// Every worker runs a task for every iteration, so the fleet needs as many
+// workers as the most demanding iteration. Targets follow increases of the
+// estimates immediately, to protect the consumers' step time, but only
+// decrease once the estimate drops more than `Options::hysteresis` below the
+// current target, so that they don't flap with noisy measurements.
+//
+// MultipleIterationsAutoScaler is thread-safe.
+class MultipleIterationsAutoScaler {
+ public:
+  struct Options {
+    // Fraction by which the estimate must fall below a target to lower it.
+    double hysteresis = 0.2;
+    // Workers with a throughput below this fraction of the median are slow.
+    double slow_worker_threshold = 0.5;
+  };
+
+  MultipleIterationsAutoScaler() : MultipleIterationsAutoScaler(Options()) {}
+  explicit MultipleIterationsAutoScaler(const Options& options);
+
+  // Registers the iteration with `iteration_id`. Returns an error if it is
+  // already registered.
+  tsl::Status RegisterIteration(int64_t iteration_id) TF_LOCKS_EXCLUDED(mu_);
+  // Unregisters the iteration with `iteration_id`, discarding its reports and
+  // its target. Returns an error if it is not registered.
+  tsl::Status UnregisterIteration(int64_t iteration_id)
+      TF_LOCKS_EXCLUDED(mu_);
+  // Same as `AutoScaler::ReportProcessingTime`, for the worker's task of the
+  // iteration with `iteration_id`.
+  tsl::Status ReportProcessingTime(int64_t iteration_id,
+                                   const std::string &worker_address,
+                                   absl::Duration processing_time)
+      TF_LOCKS_EXCLUDED(mu_);
+  // Same as `AutoScaler::ReportTargetProcessingTime`, for the consumer of the
+  // iteration with `iteration_id`.
+  tsl::Status ReportTargetProcessingTime(int64_t iteration_id,
+                                         int64_t consumer_id,
+                                         absl::Duration target_processing_time)
+      TF_LOCKS_EXCLUDED(mu_);
+  // Removes the worker with `worker_address` from every iteration. Returns an
+  // error if no iteration has a report from it.
+  tsl::Status RemoveWorker(const std::string &worker_address)
+      TF_LOCKS_EXCLUDED(mu_);
+  // Removes the consumer identified by `consumer_id` from the iteration with
+  // `iteration_id`.
+  tsl::Status RemoveConsumer(int64_t iteration_id, int64_t consumer_id)
+      TF_LOCKS_EXCLUDED(mu_);
+
+  // Updates the worker count target of each iteration from its estimate.
+  // Targets only change when this is called, so the caller controls how fast
+  // the targets react to the reports.
+  void UpdateWorkerCountTargets() TF_LOCKS_EXCLUDED(mu_);
+  // Returns the current worker count target of each iteration with an
+  // estimate.
+  absl::flat_hash_map<int64_t, int64_t> GetWorkerCountTargets() const
+      TF_LOCKS_EXCLUDED(mu_);
+  // Returns the number of workers the fleet needs, or `std::nullopt` if no
+  // iteration has an estimate.
+  std::optional<int64_t> GetWorkerCountTarget() const TF_LOCKS_EXCLUDED(mu_);
+  // Returns the largest optimal number of workers estimated for any
+  // iteration, without hysteresis, or `std::nullopt` if there is none.
+  std::optional<int64_t> GetOptimalNumberOfWorkers() const
+      TF_LOCKS_EXCLUDED(mu_);
+  // Returns the sorted addresses of the workers that are slow in at least one
+  // iteration.
+  std::vector<std::string> GetSlowWorkers() const TF_LOCKS_EXCLUDED(mu_);
+
+ private:
+  const Options options_;
+  mutable tsl::mutex mu_;
+  // Map from iteration id to the auto-scaler of the iteration.
+  absl::flat_hash_map<int64_t, std::unique_ptr<AutoScaler>> auto_scalers_
+      TF_GUARDED_BY(mu_);
+  // Map from iteration id to the worker count target of the iteration.
+  absl::flat_hash_map<int64_t, int64_t> worker_count_targets_
+      TF_GUARDED_BY(mu_);
+};
+
 }  // namespace data
 }  // namespace tensorflow
 
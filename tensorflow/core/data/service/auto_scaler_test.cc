@@ -15,6 +15,9 @@ limitations under the License.
 
 #include "tensorflow/core/data/service/auto_scaler.h"
 
+#include <cstdint>
+#include <optional>
+
 #include "absl/time/time.h"
 #include "tensorflow/tsl/lib/core/status_test_util.h"
 #include "tensorflow/tsl/platform/status_matchers.h"
@@ -23,6 +26,10 @@ namespace tensorflow {
 namespace data {
 namespace {
 
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+using ::testing::Pair;
+using ::testing::UnorderedElementsAre;
 using ::tsl::testing::StatusIs;
 
 TEST(AutoScalerTest, ReportProcessingTimeNewWorker) {
@@ -162,6 +169,152 @@ TEST(AutoScalerTest, RemoveConsumerAfterNewTPTReported) {
   TF_ASSERT_OK(auto_scaler.RemoveConsumer(0));
 }
 
+TEST(AutoScalerTest, GetOptimalNumberOfWorkersWithoutReports) {
+  AutoScaler auto_scaler;
+  EXPECT_EQ(auto_scaler.GetOptimalNumberOfWorkers(), std::nullopt);
+  TF_ASSERT_OK(auto_scaler.ReportProcessingTime("/worker/task/0:20000",
+                                                absl::Microseconds(10)));
+  EXPECT_EQ(auto_scaler.GetOptimalNumberOfWorkers(), std::nullopt);
+}
+
+TEST(AutoScalerTest, GetOptimalNumberOfWorkers) {
+  AutoScaler auto_scaler;
+  // Average worker throughput: 62500 elements per second.
+  TF_ASSERT_OK(auto_scaler.ReportProcessingTime("/worker/task/0:20000",
+                                                absl::Microseconds(10)));
+  TF_ASSERT_OK(auto_scaler.ReportProcessingTime("/worker/task/1:20000",
+                                                absl::Microseconds(40)));
+  // Sum of consumption rates: 150000 elements per second.
+  TF_ASSERT_OK(
+      auto_scaler.ReportTargetProcessingTime(0, absl::Microseconds(10)));
+  TF_ASSERT_OK(
+      auto_scaler.ReportTargetProcessingTime(1, absl::Microseconds(20)));
+  EXPECT_EQ(auto_scaler.GetOptimalNumberOfWorkers(), 3);
+  TF_ASSERT_OK(
+      auto_scaler.ReportTargetProcessingTime(1, absl::Microseconds(1000)));
+  EXPECT_EQ(auto_scaler.GetOptimalNumberOfWorkers(), 2);
+  TF_ASSERT_OK(auto_scaler.RemoveConsumer(0));
+  EXPECT_EQ(auto_scaler.GetOptimalNumberOfWorkers(), 1);
+}
+
+TEST(AutoScalerTest, GetSlowWorkers) {
+  AutoScaler auto_scaler;
+  EXPECT_THAT(auto_scaler.GetSlowWorkers(/*threshold=*/0.5), IsEmpty());
+  TF_ASSERT_OK(auto_scaler.ReportProcessingTime("/worker/task/0:20000",
+                                                absl::Microseconds(10)));
+  TF_ASSERT_OK(auto_scaler.ReportProcessingTime("/worker/task/1:20000",
+                                                absl::Microseconds(11)));
+  TF_ASSERT_OK(auto_scaler.ReportProcessingTime("/worker/task/2:20000",
+                                                absl::Microseconds(12)));
+  TF_ASSERT_OK(auto_scaler.ReportProcessingTime("/worker/task/3:20000",
+                                                absl::Microseconds(30)));
+  EXPECT_THAT(auto_scaler.GetSlowWorkers(/*threshold=*/0.5),
+              ElementsAre("/worker/task/3:20000"));
+  EXPECT_THAT(auto_scaler.GetSlowWorkers(/*threshold=*/0.1), IsEmpty());
+}
+
+TEST(MultipleIterationsAutoScalerTest, UnregisteredIteration) {
+  MultipleIterationsAutoScaler auto_scaler;
+  EXPECT_THAT(auto_scaler.ReportProcessingTime(0, "/worker/task/0:20000",
+                                               absl::Microseconds(10)),
+              StatusIs(absl::StatusCode::kNotFound));
+  EXPECT_THAT(
+      auto_scaler.ReportTargetProcessingTime(0, 0, absl::Microseconds(10)),
+      StatusIs(absl::StatusCode::kNotFound));
+  EXPECT_THAT(auto_scaler.UnregisterIteration(0),
+              StatusIs(absl::StatusCode::kNotFound));
+  TF_ASSERT_OK(auto_scaler.RegisterIteration(0));
+  EXPECT_THAT(auto_scaler.RegisterIteration(0),
+              StatusIs(absl::StatusCode::kAlreadyExists));
+}
+
+TEST(MultipleIterationsAutoScalerTest, TargetsFollowMostDemandingIteration) {
+  MultipleIterationsAutoScaler auto_scaler;
+  TF_ASSERT_OK(auto_scaler.RegisterIteration(0));
+  TF_ASSERT_OK(auto_scaler.RegisterIteration(1));
+  TF_ASSERT_OK(auto_scaler.ReportProcessingTime(0, "/worker/task/0:20000",
+                                                absl::Microseconds(10)));
+  TF_ASSERT_OK(auto_scaler.ReportProcessingTime(1, "/worker/task/0:20000",
+                                                absl::Microseconds(10)));
+  TF_ASSERT_OK(
+      auto_scaler.ReportTargetProcessingTime(0, 0, absl::Microseconds(5)));
+  TF_ASSERT_OK(
+      auto_scaler.ReportTargetProcessingTime(1, 1, absl::Microseconds(2)));
+  EXPECT_EQ(auto_scaler.GetWorkerCountTarget(), std::nullopt);
+  EXPECT_EQ(auto_scaler.GetOptimalNumberOfWorkers(), 5);
+
+  auto_scaler.UpdateWorkerCountTargets();
+  EXPECT_THAT(auto_scaler.GetWorkerCountTargets(),
+              UnorderedElementsAre(Pair(0, 2), Pair(1, 5)));
+  EXPECT_EQ(auto_scaler.GetWorkerCountTarget(), 5);
+
+  TF_ASSERT_OK(auto_scaler.UnregisterIteration(1));
+  EXPECT_EQ(auto_scaler.GetWorkerCountTarget(), 2);
+}
+
+TEST(MultipleIterationsAutoScalerTest, TargetsScaleDownWithHysteresis) {
+  MultipleIterationsAutoScaler auto_scaler(
+      MultipleIterationsAutoScaler::Options{/*hysteresis=*/0.2,
+                                            /*slow_worker_threshold=*/0.5});
+  TF_ASSERT_OK(auto_scaler.RegisterIteration(0));
+  TF_ASSERT_OK(auto_scaler.ReportProcessingTime(0, "/worker/task/0:20000",
+                                                absl::Microseconds(95)));
+  TF_ASSERT_OK(
+      auto_scaler.ReportTargetProcessingTime(0, 0, absl::Microseconds(10)));
+  auto_scaler.UpdateWorkerCountTargets();
+  EXPECT_EQ(auto_scaler.GetWorkerCountTarget(), 10);
+
+  // Scales up immediately.
+  TF_ASSERT_OK(auto_scaler.ReportProcessingTime(0, "/worker/task/0:20000",
+                                                absl::Microseconds(105)));
+  auto_scaler.UpdateWorkerCountTargets();
+  EXPECT_EQ(auto_scaler.GetWorkerCountTarget(), 11);
+
+  // Ignores decreases within the hysteresis.
+  TF_ASSERT_OK(auto_scaler.ReportProcessingTime(0, "/worker/task/0:20000",
+                                                absl::Microseconds(85)));
+  auto_scaler.UpdateWorkerCountTargets();
+  EXPECT_EQ(auto_scaler.GetWorkerCountTarget(), 11);
+  EXPECT_EQ(auto_scaler.GetOptimalNumberOfWorkers(), 9);
+
+  // Scales down beyond the hysteresis.
+  TF_ASSERT_OK(auto_scaler.ReportProcessingTime(0, "/worker/task/0:20000",
+                                                absl::Microseconds(45)));
+  auto_scaler.UpdateWorkerCountTargets();
+  EXPECT_EQ(auto_scaler.GetWorkerCountTarget(), 5);
+}
+
+TEST(MultipleIterationsAutoScalerTest, RemoveWorker) {
+  MultipleIterationsAutoScaler auto_scaler;
+  TF_ASSERT_OK(auto_scaler.RegisterIteration(0));
+  TF_ASSERT_OK(auto_scaler.RegisterIteration(1));
+  TF_ASSERT_OK(auto_scaler.ReportProcessingTime(0, "/worker/task/0:20000",
+                                                absl::Microseconds(10)));
+  TF_ASSERT_OK(auto_scaler.ReportProcessingTime(1, "/worker/task/0:20000",
+                                                absl::Microseconds(10)));
+  TF_ASSERT_OK(auto_scaler.RemoveWorker("/worker/task/0:20000"));
+  EXPECT_THAT(auto_scaler.RemoveWorker("/worker/task/0:20000"),
+              StatusIs(absl::StatusCode::kNotFound));
+}
+
+TEST(MultipleIterationsAutoScalerTest, GetSlowWorkers) {
+  MultipleIterationsAutoScaler auto_scaler;
+  TF_ASSERT_OK(auto_scaler.RegisterIteration(0));
+  TF_ASSERT_OK(auto_scaler.RegisterIteration(1));
+  for (int64_t iteration_id : {0, 1}) {
+    TF_ASSERT_OK(auto_scaler.ReportProcessingTime(
+        iteration_id, "/worker/task/0:20000", absl::Microseconds(10)));
+    TF_ASSERT_OK(auto_scaler.ReportProcessingTime(
+        iteration_id, "/worker/task/1:20000", absl::Microseconds(10)));
+  }
+  TF_ASSERT_OK(auto_scaler.ReportProcessingTime(0, "/worker/task/2:20000",
+                                                absl::Microseconds(100)));
+  TF_ASSERT_OK(auto_scaler.ReportProcessingTime(1, "/worker/task/3:20000",
+                                                absl::Microseconds(100)));
+  EXPECT_THAT(auto_scaler.GetSlowWorkers(),
+              ElementsAre("/worker/task/2:20000", "/worker/task/3:20000"));
+}
+
 }  // namespace
 
 }  // namespace data
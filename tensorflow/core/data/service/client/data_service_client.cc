@@ -36,6 +36,7 @@ limitations under the License.
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/data/service/dispatcher_client.h"
 #include "tensorflow/core/data/service/grpc_util.h"
+#include "tensorflow/core/data/service/shm_data_transfer.h"
 #include "tensorflow/core/data/service/worker_client.h"
 #include "tensorflow/core/data/service/worker_impl.h"
 #include "tensorflow/core/data/utils.h"
@@ -56,6 +57,9 @@ namespace tensorflow {
 namespace data {
 namespace {
 
+// Weight of the latest interval in the target processing time moving average.
+constexpr double kTargetProcessingTimeEmaWeight = 0.1;
+
 bool IsColocatedTask(const TaskInfo& task) {
   return absl::c_any_of(task.worker_tags(), [](std::string_view worker_tag) {
     return absl::AsciiStrToUpper(worker_tag) == kColocatedWorkerTag;
@@ -140,6 +144,18 @@ StatusOr<GetNextResult> DataServiceClient::GetNext(
   if (ctx_ == nullptr) {
     ctx_ = context_factory();
   }
+  if (last_get_next_return_nsec_ > 0) {
+    // The time the consumer spent since the last element is the time the input
+    // pipeline may take to produce an element without stalling it.
+    const double interval_nsec = static_cast<double>(
+        Env::Default()->NowNanos() - last_get_next_return_nsec_);
+    target_processing_time_nsec_ema_ =
+        target_processing_time_nsec_ema_ == 0.0
+            ? interval_nsec
+            : (1.0 - kTargetProcessingTimeEmaWeight) *
+                      target_processing_time_nsec_ema_ +
+                  kTargetProcessingTimeEmaWeight * interval_nsec;
+  }
   EnsureThreadsStarted();
   std::shared_ptr<Result> result;
   do {
@@ -184,6 +200,7 @@ StatusOr<GetNextResult> DataServiceClient::GetNext(
             << get_next_index_++;
   }
   next.tensors.swap(result->element);
+  last_get_next_return_nsec_ = Env::Default()->NowNanos();
   return next;
 }
 
@@ -365,6 +382,17 @@ DataServiceClient::CreateWorkerClient(const TaskInfo& task_info) {
     info.set_address(task_info.worker_address());
     return CreateDataServiceWorkerClient(params_.protocol, info);
   }
+  if (params_.data_transfer_protocol.empty()) {
+    // Workers on the same host are read through shared memory if they serve
+    // it.
+    StatusOr<DataTransferServerInfo> shm_transfer_server =
+        GetTransferServer(kShmTransferProtocol, task_info);
+    if (shm_transfer_server.ok() &&
+        IsLocalShmTransferServer(*shm_transfer_server)) {
+      return CreateAlternativeWorkerClientWithGrpcFallback(*shm_transfer_server,
+                                                           task_info);
+    }
+  }
   if (!params_.data_transfer_protocol.empty()) {
     TF_ASSIGN_OR_RETURN(
         DataTransferServerInfo transfer_server,
@@ -420,11 +448,15 @@ Status DataServiceClient::AddTask(const TaskInfo& task_info)
 void DataServiceClient::Heartbeat() TF_LOCKS_EXCLUDED(mu_) {
   ClientHeartbeatRequest req;
   req.set_iteration_client_id(iteration_client_id_);
-  if (IsCoordinatedRead()) {
+  {
     mutex_lock l(mu_);
-    req.set_current_round(current_round_);
-    if (round_robin_round_limit_.has_value()) {
-      req.set_blocked_round(round_robin_round_limit_.value());
+    req.set_target_processing_time_nsec(
+        static_cast<int64_t>(target_processing_time_nsec_ema_));
+    if (IsCoordinatedRead()) {
+      req.set_current_round(current_round_);
+      if (round_robin_round_limit_.has_value()) {
+        req.set_blocked_round(round_robin_round_limit_.value());
+      }
     }
   }
   ClientHeartbeatResponse resp;
@@ -804,9 +836,7 @@ Status DataServiceClient::GetElement(Task* task, int64_t deadline_micros,
     if (s.ok()) break;
     if (!IsPreemptedError(s)) {
       std::string data_transfer_protocol =
-          !params_.data_transfer_protocol.empty()
-              ? params_.data_transfer_protocol
-              : DefaultDataTransferProtocol();
+          task->worker->GetDataTransferProtocol();
       if (data_transfer_protocol == kGrpcTransferProtocol ||
           data_transfer_protocol == kLocalTransferProtocol) {
         return s;
@@ -819,7 +849,7 @@ Status DataServiceClient::GetElement(Task* task, int64_t deadline_micros,
                  << data_transfer_protocol << "'; falling back to grpc. "
                  << "Original error: " << s;
       metrics::RecordTFDataServiceDataTransferProtocolError(
-          DefaultDataTransferProtocol(), static_cast<error::Code>(s.raw_code()),
+          data_transfer_protocol, static_cast<error::Code>(s.raw_code()),
           std::string(s.message()));
       continue;
     }
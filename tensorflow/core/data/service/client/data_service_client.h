@@ -15,6 +15,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DATA_SERVICE_CLIENT_DATA_SERVICE_CLIENT_H_
 #define TENSORFLOW_CORE_DATA_SERVICE_CLIENT_DATA_SERVICE_CLIENT_H_
 
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <optional>
@@ -231,6 +232,13 @@ class DataServiceClient {
   std::unique_ptr<DataServiceDispatcherClient> dispatcher_;
 
   int64_t get_next_index_ TF_GUARDED_BY(mu_) = 0;
+  // When `GetNext` last returned an element, in nanoseconds. Zero before the
+  // first element.
+  uint64_t last_get_next_return_nsec_ TF_GUARDED_BY(mu_) = 0;
+  // Exponential moving average of the time between consecutive `GetNext`
+  // calls, reported to the dispatcher's auto-scaler. Zero until the second
+  // call.
+  double target_processing_time_nsec_ema_ TF_GUARDED_BY(mu_) = 0.0;
 
   bool iteration_finished_ TF_GUARDED_BY(mu_) = false;
   bool should_finish_iteration_ TF_GUARDED_BY(mu_) = true;
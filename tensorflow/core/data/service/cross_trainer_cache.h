@@ -15,6 +15,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DATA_SERVICE_CROSS_TRAINER_CACHE_H_
 #define TENSORFLOW_CORE_DATA_SERVICE_CROSS_TRAINER_CACHE_H_
 
+#include <algorithm>
 #include <cstddef>
 #include <deque>
 #include <functional>
@@ -24,7 +25,9 @@ limitations under the License.
 #include <utility>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
 #include "tensorflow/core/data/service/logging_utils.h"
+#include "tensorflow/core/data/service/ring_log.h"
 #include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/mutex.h"
@@ -46,6 +49,12 @@ namespace data {
 // collected when the cache becomes full. Consequently, trainers read from a
 // sliding window through the dataset and may not read the full dataset.
 //
+// Optionally, elements evicted from memory are spilled to a `RingLog` on local
+// disk, and trainers that have fallen behind the in-memory window read them
+// from disk. This widens the window trainers can drift apart by, at the cost of
+// serializing the evicted elements. It requires the `CachableSequence` to
+// implement `SerializeElement` and `DeserializeElement`.
+//
 // The `CrossTrainerCache` class is thread-safe.
 //
 // Example usage:
@@ -78,7 +87,9 @@ namespace data {
 // To use the cache, the user needs to define a `CachableSequence` to generate
 // an infinite sequence of data. It should implement a `GetNext` method to
 // produce elements, and a `GetElementSizeBytes` method to estimate the element
-// size in bytes.
+// size in bytes. Sequences that support the disk tier of the cache also
+// implement `SerializeElement` and `DeserializeElement`, which may be called
+// concurrently.
 template <class ElementType>
 class CachableSequence {
  public:
@@ -89,6 +100,21 @@ class CachableSequence {
 
   // Returns the estimated size of the element in bytes.
   virtual size_t GetElementSizeBytes(const ElementType&) const = 0;
+
+  // Serializes an element spilled to the disk tier of the cache.
+  virtual StatusOr<std::string> SerializeElement(const ElementType&) const {
+    return errors::Unimplemented(
+        "This sequence does not support the disk tier of the cross-trainer "
+        "cache.");
+  }
+
+  // Parses an element serialized by `SerializeElement`.
+  virtual StatusOr<ElementType> DeserializeElement(
+      absl::string_view serialized) const {
+    return errors::Unimplemented(
+        "This sequence does not support the disk tier of the cross-trainer "
+        "cache.");
+  }
 };
 
 // Sliding-window cache shared across concurrent trainers.
@@ -98,9 +124,13 @@ class CrossTrainerCache {
   // Creates a `CrossTrainerCache` with `max_cache_size_bytes` of memory budget.
   // The cache should be able to hold at least one element, i.e.:
   // REQUIRES: `max_cache_size_bytes >= max(GetElementSizeBytes(*))`
+  //
+  // If `disk_tier` is not null, evicted elements are appended to it. It must
+  // be empty.
   explicit CrossTrainerCache(
       size_t max_cache_size_bytes,
-      std::unique_ptr<CachableSequence<ElementType>> cachable_sequence);
+      std::unique_ptr<CachableSequence<ElementType>> cachable_sequence,
+      std::unique_ptr<RingLog> disk_tier = nullptr);
   virtual ~CrossTrainerCache() = default;
   CrossTrainerCache(const CrossTrainerCache&) = delete;
   CrossTrainerCache& operator=(const CrossTrainerCache&) = delete;
@@ -134,6 +164,21 @@ class CrossTrainerCache {
   // data is not ready, one of the trainers need to extend the cache.
   bool IsElementReady(const std::string& trainer_id);
 
+  // Returns true if the next element for `trainer_id` has been evicted from
+  // memory and is read from the disk tier.
+  bool IsElementOnDisk(const std::string& trainer_id);
+
+  // Reads the element at `element_index` from `disk_tier`.
+  StatusOr<std::shared_ptr<const ElementType>> ReadFromDisk(
+      const RingLog& disk_tier, size_t element_index) const;
+
+  // Appends an evicted element to the disk tier. Disables the disk tier if it
+  // fails.
+  void SpillToDisk(const ElementType& element);
+
+  // Returns the index of the oldest element in memory or on disk.
+  size_t FirstAvailableIndex() const;
+
   // Returns the absolute element index relative to the dataset (not relative to
   // the cached elements).
   size_t GetElementIndex(const std::string& trainer_id);
@@ -170,6 +215,11 @@ class CrossTrainerCache {
   size_t cache_size_bytes_ TF_GUARDED_BY(mu_) = 0;
   size_t cache_start_index_ TF_GUARDED_BY(mu_) = 0;
 
+  // Elements evicted from `cache_`. If not null, it holds the elements from
+  // `disk_tier_->begin_position()` up to `cache_start_index_`. It is shared
+  // with the readers outside `mu_`.
+  std::shared_ptr<RingLog> disk_tier_ TF_GUARDED_BY(mu_);
+
   // True if one thread is extending the cache.
   bool extending_cache_ TF_GUARDED_BY(mu_) = false;
 
@@ -183,9 +233,11 @@ class CrossTrainerCache {
 template <class ElementType>
 CrossTrainerCache<ElementType>::CrossTrainerCache(
     size_t max_cache_size_bytes,
-    std::unique_ptr<CachableSequence<ElementType>> cachable_sequence)
+    std::unique_ptr<CachableSequence<ElementType>> cachable_sequence,
+    std::unique_ptr<RingLog> disk_tier)
     : max_cache_size_bytes_(max_cache_size_bytes),
-      cachable_sequence_(std::move(cachable_sequence)) {
+      cachable_sequence_(std::move(cachable_sequence)),
+      disk_tier_(std::move(disk_tier)) {
   DCHECK_GT(max_cache_size_bytes, 0)
       << "CrossTrainerCache size must be greater than 0.";
   VLOG(2) << "Initialized tf.data service cross-trainer cache with "
@@ -212,10 +264,16 @@ CrossTrainerCache<ElementType>::GetCacheQueryResult(
     const std::string& trainer_id) {
   bool should_extend_cache = false;
   while (true) {
+    std::shared_ptr<RingLog> disk_tier;
+    size_t disk_element_index = 0;
     {
       mutex_lock l(mu_);
       TF_RETURN_IF_ERROR(status_);
-      if (IsElementReady(trainer_id)) {
+      if (IsElementOnDisk(trainer_id)) {
+        disk_element_index = GetElementIndex(trainer_id);
+        trainer_to_element_index_map_[trainer_id] = disk_element_index + 1;
+        disk_tier = disk_tier_;
+      } else if (IsElementReady(trainer_id)) {
         TF_ASSIGN_OR_RETURN(std::shared_ptr<const ElementType> element,
                             GetElement(trainer_id));
         return CacheQueryResult{element,
@@ -234,6 +292,19 @@ CrossTrainerCache<ElementType>::GetCacheQueryResult(
       }
     }
 
+    // Reads from disk without blocking the trainers reading from memory.
+    if (disk_tier != nullptr) {
+      StatusOr<std::shared_ptr<const ElementType>> element =
+          ReadFromDisk(*disk_tier, disk_element_index);
+      if (errors::IsNotFound(element.status())) {
+        // The element has been deleted from the disk tier since it was looked
+        // up. Skips to the oldest available element.
+        continue;
+      }
+      TF_RETURN_IF_ERROR(element.status());
+      return CacheQueryResult{*std::move(element), /*is_cache_hit=*/true};
+    }
+
     if (should_extend_cache) {
       Status s = ExtendCache();
       mutex_lock l(mu_);
@@ -250,6 +321,48 @@ bool CrossTrainerCache<ElementType>::IsElementReady(
   return GetElementIndex(trainer_id) < cache_start_index_ + cache_.size();
 }
 
+template <class ElementType>
+bool CrossTrainerCache<ElementType>::IsElementOnDisk(
+    const std::string& trainer_id) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  return disk_tier_ != nullptr &&
+         GetElementIndex(trainer_id) < cache_start_index_;
+}
+
+template <class ElementType>
+StatusOr<std::shared_ptr<const ElementType>>
+CrossTrainerCache<ElementType>::ReadFromDisk(const RingLog& disk_tier,
+                                             size_t element_index) const {
+  TF_ASSIGN_OR_RETURN(std::string serialized, disk_tier.Read(element_index));
+  TF_ASSIGN_OR_RETURN(ElementType element,
+                      cachable_sequence_->DeserializeElement(serialized));
+  return std::make_shared<const ElementType>(std::move(element));
+}
+
+template <class ElementType>
+void CrossTrainerCache<ElementType>::SpillToDisk(const ElementType& element)
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  StatusOr<std::string> serialized =
+      cachable_sequence_->SerializeElement(element);
+  Status status = serialized.status();
+  if (status.ok()) {
+    status = disk_tier_->Append(*serialized);
+  }
+  if (!status.ok()) {
+    LOG(WARNING) << "Disabling the disk tier of the tf.data service "
+                 << "cross-trainer cache: " << status;
+    disk_tier_.reset();
+  }
+}
+
+template <class ElementType>
+size_t CrossTrainerCache<ElementType>::FirstAvailableIndex() const
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  if (disk_tier_ != nullptr) {
+    return std::min<size_t>(disk_tier_->begin_position(), cache_start_index_);
+  }
+  return cache_start_index_;
+}
+
 template <class ElementType>
 StatusOr<std::shared_ptr<const ElementType>>
 CrossTrainerCache<ElementType>::GetElement(const std::string& trainer_id)
@@ -271,8 +384,9 @@ template <class ElementType>
 size_t CrossTrainerCache<ElementType>::GetElementIndex(
     const std::string& trainer_id) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
   size_t element_index = trainer_to_element_index_map_[trainer_id];
-  if (element_index < cache_start_index_) {
-    element_index = cache_start_index_;
+  const size_t first_available_index = FirstAvailableIndex();
+  if (element_index < first_available_index) {
+    element_index = first_available_index;
   }
   return element_index;
 }
@@ -305,6 +419,9 @@ void CrossTrainerCache<ElementType>::FreeSpace(size_t new_element_size_bytes)
          cache_size_bytes_ + new_element_size_bytes > max_cache_size_bytes_) {
     size_t free_bytes =
         cachable_sequence_->GetElementSizeBytes(*cache_.front());
+    if (disk_tier_ != nullptr) {
+      SpillToDisk(*cache_.front());
+    }
     cache_.pop_front();
     cache_size_bytes_ -= free_bytes;
     ++cache_start_index_;
@@ -22,8 +22,11 @@ limitations under the License.
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/memory/memory.h"
+#include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
 #include "absl/time/time.h"
+#include "tensorflow/core/data/service/ring_log.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/lib/monitoring/cell_reader.h"
@@ -61,6 +64,32 @@ class InfiniteRange : public CachableSequence<int64_t> {
   int64_t next_ = 0;
 };
 
+// An `InfiniteRange` whose elements can be spilled to disk.
+class SerializableInfiniteRange : public InfiniteRange {
+ public:
+  StatusOr<std::string> SerializeElement(
+      const int64_t& element) const override {
+    return absl::StrCat(element);
+  }
+  StatusOr<int64_t> DeserializeElement(
+      absl::string_view serialized) const override {
+    int64_t element;
+    if (!absl::SimpleAtoi(serialized, &element)) {
+      return errors::DataLoss("Invalid element: ", serialized);
+    }
+    return element;
+  }
+};
+
+StatusOr<std::unique_ptr<RingLog>> CreateDiskTier(size_t max_size_bytes) {
+  std::string directory;
+  if (!Env::Default()->LocalTempFilename(&directory)) {
+    return errors::FailedPrecondition("Failed to create a temp directory.");
+  }
+  return RingLog::Create(Env::Default(), directory, max_size_bytes,
+                         /*num_segments=*/4);
+}
+
 class TensorDataset : public CachableSequence<Tensor> {
  public:
   StatusOr<Tensor> GetNext() override { return Tensor("Test Tensor"); }
@@ -205,6 +234,54 @@ TEST(CrossTrainerCacheTest, NewTrainersStartLate) {
   }
 }
 
+TEST(CrossTrainerCacheTest, SlowTrainersReadEvictedDataFromDisk) {
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<RingLog> disk_tier,
+                          CreateDiskTier(/*max_size_bytes=*/1 << 20));
+  CrossTrainerCache<int64_t> cache(
+      /*max_cache_size_bytes=*/5 * sizeof(int64_t),
+      std::make_unique<SerializableInfiniteRange>(), std::move(disk_tier));
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_THAT(cache.Get("Fast trainer"), IsOkAndHolds(Pointee(i)));
+  }
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_THAT(cache.Get("Slow trainer"), IsOkAndHolds(Pointee(i)));
+  }
+}
+
+TEST(CrossTrainerCacheTest, DiskTierIsBounded) {
+  // Every element from 10 to 999 takes 2 or 3 bytes on disk.
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<RingLog> disk_tier,
+                          CreateDiskTier(/*max_size_bytes=*/300));
+  CrossTrainerCache<int64_t> cache(
+      /*max_cache_size_bytes=*/5 * sizeof(int64_t),
+      std::make_unique<SerializableInfiniteRange>(), std::move(disk_tier));
+  for (int i = 0; i < 1000; ++i) {
+    EXPECT_THAT(cache.Get("Fast trainer"), IsOkAndHolds(Pointee(i)));
+  }
+
+  // The slow trainer skips the elements deleted from disk, and reads the ones
+  // on disk and in memory in order.
+  TF_ASSERT_OK_AND_ASSIGN(std::shared_ptr<const int64_t> first,
+                          cache.Get("Slow trainer"));
+  EXPECT_GT(*first, 800);
+  EXPECT_LT(*first, 995);
+  for (int64_t i = *first + 1; i < 1000; ++i) {
+    EXPECT_THAT(cache.Get("Slow trainer"), IsOkAndHolds(Pointee(i)));
+  }
+}
+
+TEST(CrossTrainerCacheTest, DiskTierRequiresSerializableElements) {
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<RingLog> disk_tier,
+                          CreateDiskTier(/*max_size_bytes=*/1 << 20));
+  CrossTrainerCache<int64_t> cache(
+      /*max_cache_size_bytes=*/5 * sizeof(int64_t),
+      std::make_unique<InfiniteRange>(), std::move(disk_tier));
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_THAT(cache.Get("Fast trainer"), IsOkAndHolds(Pointee(i)));
+  }
+  EXPECT_THAT(cache.Get("Slow trainer"), IsOkAndHolds(Pointee(Gt(94))));
+}
+
 TEST(CrossTrainerCacheTest, AlternateTrainerExtendsCache) {
   // The cache size is smaller than one int64_t.
   CrossTrainerCache<int64_t> cache(
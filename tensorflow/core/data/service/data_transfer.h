@@ -111,6 +111,10 @@ class DataTransferServer {
   // Return the port that this server is listening on.
   virtual int get_port() = 0;
 
+  // Returns the address clients should connect to. If empty, clients connect
+  // to the worker's `data_transfer_address`.
+  virtual std::string GetAddress() const { return std::string(); }
+
   // Register a DataTransferServer factory under `name`.
   static void Register(std::string name, ServerFactoryT factory);
 
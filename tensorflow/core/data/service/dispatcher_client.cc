@@ -19,6 +19,7 @@ limitations under the License.
 #include <memory>
 #include <optional>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "grpcpp/client_context.h"
@@ -150,6 +151,37 @@ Status DataServiceDispatcherClient::GetSplit(int64_t iteration_id,
   return OkStatus();
 }
 
+Status DataServiceDispatcherClient::GetSplits(
+    int64_t iteration_id, int64_t repetition, int64_t split_provider_index,
+    const std::string& worker_address, int64_t max_splits,
+    int64_t num_splits_started, std::vector<Tensor>& splits,
+    int64_t& num_revoked_splits, bool& end_of_splits) {
+  TF_RETURN_IF_ERROR(EnsureInitialized());
+  GetSplitRequest req;
+  req.set_iteration_id(iteration_id);
+  req.set_repetition(repetition);
+  req.set_split_provider_index(split_provider_index);
+  req.set_max_splits(max_splits);
+  req.set_worker_address(worker_address);
+  req.set_num_splits_started(num_splits_started);
+  GetSplitResponse resp;
+  grpc::ClientContext client_ctx;
+  grpc::Status status = stub_->GetSplit(&client_ctx, req, &resp);
+  if (!status.ok()) {
+    return grpc_util::WrapError("Failed to get splits", status);
+  }
+  end_of_splits = resp.end_of_splits();
+  num_revoked_splits = resp.num_revoked_splits();
+  for (const TensorProto& split_proto : resp.splits()) {
+    Tensor split;
+    if (!split.FromProto(split_proto)) {
+      return errors::Internal("Failed to parse split tensor proto");
+    }
+    splits.push_back(std::move(split));
+  }
+  return OkStatus();
+}
+
 Status DataServiceDispatcherClient::Snapshot(
     const DatasetDef& dataset, const std::string& path,
     const experimental::DistributedSnapshotMetadata& metadata) {
@@ -362,6 +394,18 @@ Status DataServiceDispatcherClient::GetDataServiceConfig(
   return OkStatus();
 }
 
+Status DataServiceDispatcherClient::GetWorkerCountTargets(
+    GetWorkerCountTargetsResponse& response) {
+  TF_RETURN_IF_ERROR(EnsureInitialized());
+  GetWorkerCountTargetsRequest request;
+  grpc::ClientContext ctx;
+  grpc::Status s = stub_->GetWorkerCountTargets(&ctx, request, &response);
+  if (!s.ok()) {
+    return grpc_util::WrapError("Failed to get worker count targets", s);
+  }
+  return OkStatus();
+}
+
 Status DataServiceDispatcherClient::EnsureInitialized() {
   return grpc_util::Retry([this] { return Initialize(); },
                           "Initialize dispatcher client",
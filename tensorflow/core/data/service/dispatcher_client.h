@@ -67,6 +67,17 @@ class DataServiceDispatcherClient : public DataServiceClientBase {
                   int64_t split_provider_index, Tensor& split,
                   bool& end_of_splits);
 
+  // Prefetches up to `max_splits` splits for the worker at `worker_address`,
+  // reporting that it started `num_splits_started` prefetched splits since its
+  // previous call. Appends the new splits to `splits`, and sets
+  // `num_revoked_splits` to the number of unstarted splits the worker must
+  // drop from the end of its prefetched splits before starting any more.
+  Status GetSplits(int64_t iteration_id, int64_t repetition,
+                   int64_t split_provider_index,
+                   const std::string& worker_address, int64_t max_splits,
+                   int64_t num_splits_started, std::vector<Tensor>& splits,
+                   int64_t& num_revoked_splits, bool& end_of_splits);
+
   // Gets the next split for the specified source of a stream of the snapshot in
   // `base_path`. If `end_of_splits` returns true, then there are no more splits
   // to be processed for the specified stream source.
@@ -131,6 +142,9 @@ class DataServiceDispatcherClient : public DataServiceClientBase {
   // Returns data service config of the data service cluster.
   Status GetDataServiceConfig(DataServiceConfig& config);
 
+  // Returns the dispatcher's recommendations for the number of workers.
+  Status GetWorkerCountTargets(GetWorkerCountTargetsResponse& response);
+
  protected:
   Status EnsureInitialized() override;
 
@@ -146,6 +146,16 @@ TEST_F(DispatcherClientTest, GetDataServiceConfig) {
   EXPECT_EQ(config.deployment_mode(), DEPLOYMENT_MODE_COLOCATED);
 }
 
+TEST_F(DispatcherClientTest, GetWorkerCountTargetsWithoutReports) {
+  TF_ASSERT_OK(SetUpTfDataService(/*num_workers=*/1));
+  GetWorkerCountTargetsResponse response;
+  TF_ASSERT_OK(dispatcher_client_->GetWorkerCountTargets(response));
+  EXPECT_EQ(response.worker_count_target(), 0);
+  EXPECT_EQ(response.optimal_number_of_workers(), 0);
+  EXPECT_TRUE(response.iteration_worker_count_targets().empty());
+  EXPECT_TRUE(response.slow_workers().empty());
+}
+
 TEST_F(DispatcherClientTest, SnapshotSkeletonWritten) {
   TF_ASSERT_OK(SetUpTfDataService(/*num_workers=*/1));
   TF_ASSERT_OK_AND_ASSIGN(absl::flat_hash_set<std::string> paths,
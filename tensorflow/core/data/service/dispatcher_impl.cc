@@ -390,6 +390,7 @@ Status DataServiceDispatcherImpl::WorkerHeartbeat(
   for (const auto& [path, snapshot_manager] : snapshots_) {
     TF_RETURN_IF_ERROR(snapshot_manager->WorkerHeartbeat(*request, *response));
   }
+  ReportProcessingTimes(*request);
 
   VLOG(4) << "Finished worker heartbeat for worker at address "
           << request->worker_address();
@@ -449,6 +450,9 @@ Status DataServiceDispatcherImpl::GetSplit(const GetSplitRequest* request,
         "Cannot get split for iteration ", iteration_id,
         ", since it is not a distributed_epoch iteration.");
   }
+  if (request->max_splits() > 0) {
+    return GetPrefetchedSplits(*request, *iteration, *response);
+  }
   int64_t current_repetition =
       iteration->distributed_epoch_state.value().repetitions[provider_index];
   if (repetition < current_repetition) {
@@ -485,6 +489,69 @@ Status DataServiceDispatcherImpl::GetSplit(const GetSplitRequest* request,
   return OkStatus();
 }
 
+Status DataServiceDispatcherImpl::GetPrefetchedSplits(
+    const GetSplitRequest& request, const Iteration& iteration,
+    GetSplitResponse& response) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  const int64_t iteration_id = request.iteration_id();
+  const int64_t repetition = request.repetition();
+  const int64_t provider_index = request.split_provider_index();
+  const int64_t max_splits = request.max_splits();
+  const std::string& worker_address = request.worker_address();
+  SplitLeases& leases =
+      split_leases_[{iteration_id, provider_index, repetition}];
+  leases.RecordStarted(worker_address, request.num_splits_started());
+  response.set_num_revoked_splits(leases.TakeRevocations(worker_address));
+
+  std::vector<Tensor> splits;
+  int64_t current_repetition =
+      iteration.distributed_epoch_state.value().repetitions[provider_index];
+  if (repetition >= current_repetition) {
+    SplitProvider* split_provider =
+        split_providers_[iteration_id][provider_index].get();
+    DCHECK(split_provider != nullptr);
+    if (repetition > current_repetition) {
+      // See `GetSplit`.
+      TF_RETURN_IF_ERROR(split_provider->Reset());
+    }
+    while (static_cast<int64_t>(splits.size()) < max_splits) {
+      Tensor split;
+      bool end_of_splits = false;
+      TF_RETURN_IF_ERROR(split_provider->GetNext(&split, &end_of_splits));
+      TF_RETURN_IF_ERROR(RecordSplitProduced(iteration_id, repetition,
+                                             provider_index, end_of_splits));
+      if (end_of_splits) {
+        TF_RETURN_IF_ERROR(split_provider->Reset());
+        break;
+      }
+      splits.push_back(std::move(split));
+    }
+  }
+  // Once the dataset's splits run out, take over splits of stragglers.
+  Tensor stolen_split;
+  while (static_cast<int64_t>(splits.size()) < max_splits &&
+         leases.PopStolen(stolen_split)) {
+    splits.push_back(std::move(stolen_split));
+  }
+
+  if (!splits.empty()) {
+    leases.Lease(worker_address, splits);
+    for (const Tensor& split : splits) {
+      split.AsProtoTensorContent(response.add_splits());
+    }
+  } else if (leases.NumUnstarted(worker_address) == 0 &&
+             !leases.ScheduleSteal(worker_address)) {
+    response.set_end_of_splits(true);
+    leases.RemoveWorker(worker_address);
+    if (leases.empty()) {
+      split_leases_.erase({iteration_id, provider_index, repetition});
+    }
+  }
+  VLOG(3) << "Returning " << splits.size() << " prefetched splits to worker "
+          << worker_address << ", end_of_splits=" << response.end_of_splits()
+          << ", num_revoked_splits=" << response.num_revoked_splits();
+  return OkStatus();
+}
+
 Status DataServiceDispatcherImpl::MakeSplitProviders(
     const std::string& dataset_id,
     std::vector<std::unique_ptr<SplitProvider>>& split_providers)
@@ -697,6 +764,7 @@ Status DataServiceDispatcherImpl::ReleaseIterationClient(
   std::shared_ptr<const Iteration> iteration;
   TF_RETURN_IF_ERROR(
       state_.IterationForIterationClientId(iteration_client_id, iteration));
+  RemoveConsumerFromAutoScaler(iteration_client_id);
   Update update;
   ReleaseIterationClientUpdate* release_iteration_client =
       update.mutable_release_iteration_client();
@@ -970,6 +1038,7 @@ Status DataServiceDispatcherImpl::ClientHeartbeat(
         "Consider configuring the dispatcher with a higher "
         "`iteration_gc_timeout_ms`.");
   }
+  ReportTargetProcessingTime(*request, iteration->iteration_id);
   if (request->optional_current_round_case() ==
       ClientHeartbeatRequest::kCurrentRound) {
     round_robin_rounds_[request->iteration_client_id()] =
@@ -1055,6 +1124,25 @@ Status DataServiceDispatcherImpl::GetWorkers(const GetWorkersRequest* request,
   return OkStatus();
 }
 
+Status DataServiceDispatcherImpl::GetWorkerCountTargets(
+    const GetWorkerCountTargetsRequest* request,
+    GetWorkerCountTargetsResponse* response) {
+  TF_RETURN_IF_ERROR(CheckStarted());
+  response->set_worker_count_target(
+      auto_scaler_.GetWorkerCountTarget().value_or(0));
+  response->set_optimal_number_of_workers(
+      auto_scaler_.GetOptimalNumberOfWorkers().value_or(0));
+  for (const auto& [iteration_id, target] :
+       auto_scaler_.GetWorkerCountTargets()) {
+    (*response->mutable_iteration_worker_count_targets())[iteration_id] =
+        target;
+  }
+  for (const std::string& worker_address : auto_scaler_.GetSlowWorkers()) {
+    response->add_slow_workers(worker_address);
+  }
+  return OkStatus();
+}
+
 Status DataServiceDispatcherImpl::Snapshot(const SnapshotRequest* request,
                                            SnapshotResponse* response) {
   TF_RETURN_IF_ERROR(CheckStarted());
@@ -1176,38 +1264,62 @@ Status DataServiceDispatcherImpl::ApplyWithoutJournaling(const Update& update)
 Status DataServiceDispatcherImpl::Apply(const Update& update)
     TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
   if (journal_writer_.has_value()) {
-    TF_RETURN_IF_ERROR(journal_writer_.value()->Write(update));
+    TF_ASSIGN_OR_RETURN(journal_sequence_number_,
+                        journal_writer_.value()->Append(update));
   }
   return state_.Apply(update);
 }
 
+Status DataServiceDispatcherImpl::SyncJournal() TF_LOCKS_EXCLUDED(mu_) {
+  JournalWriter* journal_writer;
+  int64_t sequence_number;
+  {
+    mutex_lock l(mu_);
+    if (!journal_writer_.has_value()) {
+      return OkStatus();
+    }
+    journal_writer = journal_writer_.value().get();
+    sequence_number = journal_sequence_number_;
+  }
+  // Syncs outside `mu_` so that other requests can append their updates to the
+  // same sync.
+  return journal_writer->Sync(sequence_number);
+}
+
 void DataServiceDispatcherImpl::MaintenanceThread() {
   int64_t next_check_micros = 0;
   while (true) {
-    mutex_lock l(mu_);
-    while (!cancelled_ && env_->NowMicros() < next_check_micros) {
-      int64_t remaining_micros = next_check_micros - env_->NowMicros();
-      maintenance_thread_cv_.wait_for(
-          l, std::chrono::microseconds(remaining_micros));
-    }
-    if (cancelled_) {
-      return;
-    }
     {
-      Status s = ReleaseMissingClients();
-      if (!s.ok()) {
-        LOG(WARNING) << "Error releasing missing clients: " << s;
+      mutex_lock l(mu_);
+      while (!cancelled_ && env_->NowMicros() < next_check_micros) {
+        int64_t remaining_micros = next_check_micros - env_->NowMicros();
+        maintenance_thread_cv_.wait_for(
+            l, std::chrono::microseconds(remaining_micros));
       }
-    }
-    {
-      Status s = GcOldIterations();
-      if (!s.ok()) {
-        LOG(WARNING) << "Error garbage collecting old iterations: " << s;
+      if (cancelled_) {
+        return;
+      }
+      {
+        Status s = ReleaseMissingClients();
+        if (!s.ok()) {
+          LOG(WARNING) << "Error releasing missing clients: " << s;
+        }
       }
+      {
+        Status s = GcOldIterations();
+        if (!s.ok()) {
+          LOG(WARNING) << "Error garbage collecting old iterations: " << s;
+        }
+      }
+      DetectMissingWorkers();
+      UpdateAutoScaler();
+      next_check_micros =
+          env_->NowMicros() + (config_.job_gc_check_interval_ms() * 1000);
+    }
+    Status s = SyncJournal();
+    if (!s.ok()) {
+      LOG(WARNING) << "Error syncing the journal: " << s;
     }
-    DetectMissingWorkers();
-    next_check_micros =
-        env_->NowMicros() + (config_.job_gc_check_interval_ms() * 1000);
   }
 }
 
@@ -1219,6 +1331,7 @@ Status DataServiceDispatcherImpl::ReleaseMissingClients()
         latest_client_heartbeats_time_[client_id] +
             absl::Milliseconds(config_.client_timeout_ms())) {
       LOG(INFO) << "Releasing timed-out client with id " << client_id;
+      RemoveConsumerFromAutoScaler(client_id);
       Update update;
       ReleaseIterationClientUpdate* release_client =
           update.mutable_release_iteration_client();
@@ -1239,6 +1352,8 @@ void DataServiceDispatcherImpl::DetectMissingWorkers()
     if (absl::FromUnixMicros(now) >
         it->second + absl::Milliseconds(config_.worker_timeout_ms())) {
       LOG(INFO) << "Lost worker " << it->first << " due to timeout";
+      // Workers that never reported a processing time are not found.
+      auto_scaler_.RemoveWorker(it->first).IgnoreError();
       latest_worker_heartbeats_time_.erase(it++);
     } else {
       ++it;
@@ -1264,6 +1379,90 @@ Status DataServiceDispatcherImpl::GcOldIterations()
   return OkStatus();
 }
 
+void DataServiceDispatcherImpl::ReportProcessingTimes(
+    const WorkerHeartbeatRequest& request) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  for (const auto& [task_id, processing_time_nsec] :
+       request.task_processing_time_nsec()) {
+    std::shared_ptr<const Task> task;
+    if (!state_.TaskFromId(task_id, task).ok() ||
+        task->iteration->garbage_collected || task->iteration->finished) {
+      continue;
+    }
+    const int64_t iteration_id = task->iteration->iteration_id;
+    EnsureIterationAutoScaled(iteration_id);
+    Status s = auto_scaler_.ReportProcessingTime(
+        iteration_id, request.worker_address(),
+        absl::Nanoseconds(processing_time_nsec));
+    if (!s.ok()) {
+      VLOG(1) << "Failed to report the processing time of task " << task_id
+              << ": " << s;
+    }
+  }
+}
+
+void DataServiceDispatcherImpl::ReportTargetProcessingTime(
+    const ClientHeartbeatRequest& request, int64_t iteration_id)
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  if (request.target_processing_time_nsec() <= 0) {
+    return;
+  }
+  EnsureIterationAutoScaled(iteration_id);
+  Status s = auto_scaler_.ReportTargetProcessingTime(
+      iteration_id, request.iteration_client_id(),
+      absl::Nanoseconds(request.target_processing_time_nsec()));
+  if (!s.ok()) {
+    VLOG(1) << "Failed to report the target processing time of client "
+            << request.iteration_client_id() << ": " << s;
+  }
+}
+
+void DataServiceDispatcherImpl::RemoveConsumerFromAutoScaler(
+    int64_t iteration_client_id) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  std::shared_ptr<const Iteration> iteration;
+  if (!state_.IterationForIterationClientId(iteration_client_id, iteration)
+           .ok() ||
+      !auto_scaled_iterations_.contains(iteration->iteration_id)) {
+    return;
+  }
+  // Clients that never reported a target processing time are not found.
+  auto_scaler_.RemoveConsumer(iteration->iteration_id, iteration_client_id)
+      .IgnoreError();
+}
+
+void DataServiceDispatcherImpl::EnsureIterationAutoScaled(int64_t iteration_id)
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  if (auto_scaled_iterations_.insert(iteration_id).second) {
+    TF_CHECK_OK(auto_scaler_.RegisterIteration(iteration_id));
+  }
+}
+
+void DataServiceDispatcherImpl::UpdateAutoScaler()
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  for (auto it = auto_scaled_iterations_.begin();
+       it != auto_scaled_iterations_.end();) {
+    std::shared_ptr<const Iteration> iteration;
+    if (!state_.IterationFromId(*it, iteration).ok() || iteration->finished ||
+        iteration->garbage_collected) {
+      TF_CHECK_OK(auto_scaler_.UnregisterIteration(*it));
+      auto_scaled_iterations_.erase(it++);
+    } else {
+      ++it;
+    }
+  }
+  auto_scaler_.UpdateWorkerCountTargets();
+  std::optional<int64_t> optimal_number_of_workers =
+      auto_scaler_.GetOptimalNumberOfWorkers();
+  if (optimal_number_of_workers.has_value()) {
+    metrics::RecordTFDataServiceOptimalNumberOfWorkers(
+        *optimal_number_of_workers);
+  }
+  std::optional<int64_t> worker_count_target =
+      auto_scaler_.GetWorkerCountTarget();
+  if (worker_count_target.has_value()) {
+    metrics::RecordTFDataServiceWorkerCountTarget(*worker_count_target);
+  }
+}
+
 bool DataServiceDispatcherImpl::ShouldGcIteration(const Iteration& iteration,
                                                   int64_t now_us) const {
   if (iteration.job->processing_mode.sharding_policy() ==
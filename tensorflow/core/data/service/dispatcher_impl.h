@@ -20,17 +20,20 @@ limitations under the License.
 #include <memory>
 #include <optional>
 #include <string>
+#include <tuple>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/time/time.h"
+#include "tensorflow/core/data/service/auto_scaler.h"
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/data/service/dataset_store.h"
 #include "tensorflow/core/data/service/dispatcher.pb.h"
 #include "tensorflow/core/data/service/dispatcher_state.h"
 #include "tensorflow/core/data/service/export.pb.h"
 #include "tensorflow/core/data/service/snapshot/snapshot_manager.h"
+#include "tensorflow/core/data/service/split_leases.h"
 #include "tensorflow/core/data/service/task_remover.h"
 #include "tensorflow/core/data/service/worker.grpc.pb.h"
 #include "tensorflow/core/framework/dataset.h"
@@ -181,9 +184,19 @@ class DataServiceDispatcherImpl {
   Status GetSnapshotStreams(const GetSnapshotStreamsRequest* request,
                             GetSnapshotStreamsResponse* response);
 
+  // Auto-scaling API.
+  Status GetWorkerCountTargets(const GetWorkerCountTargetsRequest* request,
+                               GetWorkerCountTargetsResponse* response);
+
   // Exports the dispatcher state for debugging.
   DispatcherStateExport ExportState() const;
 
+  // Waits until the journal is durable up to the last applied update. State
+  // updates are appended to the journal under `mu_` and synced in groups by
+  // this call, so RPC handlers must call it before replying to make the
+  // updates of their request durable.
+  Status SyncJournal() TF_LOCKS_EXCLUDED(mu_);
+
  private:
   // A thread which periodically checks for iterations to clean up, clients to
   // release, workers to consider missing, and snapshot streams to reassign.
@@ -195,6 +208,12 @@ class DataServiceDispatcherImpl {
       const DispatcherState::Iteration& iteration,
       std::vector<std::unique_ptr<SplitProvider>>& restored)
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Serves a `GetSplit` request from a worker prefetching splits, reassigning
+  // unstarted splits of straggling workers once the splits run out.
+  Status GetPrefetchedSplits(const GetSplitRequest& request,
+                             const DispatcherState::Iteration& iteration,
+                             GetSplitResponse& response)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
   // Makes split providers for the specified `dataset_id`, and stores them in
   // `split_providers`.
   Status MakeSplitProviders(
@@ -301,6 +320,7 @@ class DataServiceDispatcherImpl {
                              int64_t split_provider_index, bool finished)
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
   // Applies a state update, updating both the journal and the in-memory state.
+  // The update is not durable until `SyncJournal` returns.
   Status Apply(const Update& update) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
   // Applies a state update, but doesn't update the journal. Only meant to be
   // used when recovering state when the dispatcher starts.
@@ -313,6 +333,24 @@ class DataServiceDispatcherImpl {
   void DetectMissingWorkers() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
   // Scans for old iterations and marks them as finished.
   Status GcOldIterations() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Reports the processing times in a worker heartbeat to `auto_scaler_`.
+  void ReportProcessingTimes(const WorkerHeartbeatRequest& request)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Reports the target processing time in a client heartbeat to
+  // `auto_scaler_`.
+  void ReportTargetProcessingTime(const ClientHeartbeatRequest& request,
+                                  int64_t iteration_id)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Removes the consumer with `iteration_client_id` from `auto_scaler_`.
+  void RemoveConsumerFromAutoScaler(int64_t iteration_client_id)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Registers the iteration with `iteration_id` with `auto_scaler_` if it
+  // isn't registered yet.
+  void EnsureIterationAutoScaled(int64_t iteration_id)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Unregisters finished iterations from `auto_scaler_`, then updates the
+  // worker count targets and their metrics.
+  void UpdateAutoScaler() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
   // Returns true if an iteration should be garbage collected.
   bool ShouldGcIteration(const DispatcherState::Iteration& iteration,
                          int64_t now_us) const;
@@ -342,6 +380,11 @@ class DataServiceDispatcherImpl {
   // Mapping from iteration id to the split providers for the iteration.
   absl::flat_hash_map<int64_t, std::vector<std::unique_ptr<SplitProvider>>>
       split_providers_ TF_GUARDED_BY(mu_);
+  // Splits prefetched by workers, keyed by iteration id, split provider index
+  // and repetition. Leases are not journaled: after a restart, the dispatcher
+  // doesn't reassign splits prefetched before it.
+  absl::flat_hash_map<std::tuple<int64_t, int64_t, int64_t>, SplitLeases>
+      split_leases_ TF_GUARDED_BY(mu_);
   // Mapping from round robin iteration id to the round the iteration is
   // currently on. This is based on the data provided by client heartbeats,
   // and may be stale.
@@ -365,8 +408,16 @@ class DataServiceDispatcherImpl {
   // A single stream assignment manager shared by all managers in `snapshots_`.
   SnapshotAssignmentManager snapshot_assignment_manager_;
 
+  // Estimates the number of workers needed by the iterations in
+  // `auto_scaled_iterations_`, from the processing times reported by workers
+  // and clients in their heartbeats.
+  MultipleIterationsAutoScaler auto_scaler_;
+  absl::flat_hash_set<int64_t> auto_scaled_iterations_ TF_GUARDED_BY(mu_);
+
   std::optional<std::unique_ptr<JournalWriter>> journal_writer_
       TF_GUARDED_BY(mu_);
+  // Sequence number of the last update appended to `journal_writer_`.
+  int64_t journal_sequence_number_ TF_GUARDED_BY(mu_) = 0;
   DispatcherState state_ TF_GUARDED_BY(mu_);
   // Condition variable for waking up the gc thread.
   condition_variable maintenance_thread_cv_;
@@ -43,11 +43,16 @@ DispatcherStateExport GrpcDispatcherImpl::ExportState() const {
   return impl_.ExportState();
 }
 
+// Replies only once the journal updates made by the request are durable.
 #define HANDLER(method)                                                   \
   grpc::Status GrpcDispatcherImpl::method(ServerContext* context,         \
                                           const method##Request* request, \
                                           method##Response* response) {   \
-    return ToGrpcStatus(impl_.method(request, response));                 \
+    Status s = impl_.method(request, response);                           \
+    if (s.ok()) {                                                         \
+      s = impl_.SyncJournal();                                            \
+    }                                                                     \
+    return ToGrpcStatus(s);                                               \
   }
 HANDLER(WorkerHeartbeat);
 HANDLER(WorkerUpdate);
@@ -66,6 +71,7 @@ HANDLER(GetDataServiceConfig);
 HANDLER(Snapshot);
 HANDLER(GetSnapshotSplit);
 HANDLER(GetSnapshotStreams);
+HANDLER(GetWorkerCountTargets);
 #undef HANDLER
 
 }  // namespace data
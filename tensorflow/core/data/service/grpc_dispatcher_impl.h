@@ -61,6 +61,7 @@ class GrpcDispatcherImpl : public DispatcherService::Service {
   HANDLER(Snapshot);
   HANDLER(GetSnapshotSplit);
   HANDLER(GetSnapshotStreams);
+  HANDLER(GetWorkerCountTargets);
 #undef HANDLER
 
  private:
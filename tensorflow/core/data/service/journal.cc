@@ -16,8 +16,10 @@ limitations under the License.
 #include "tensorflow/core/data/service/journal.h"
 
 #include <algorithm>
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "absl/memory/memory.h"
@@ -27,8 +29,10 @@ limitations under the License.
 #include "tensorflow/core/lib/io/record_writer.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/regexp.h"
+#include "tensorflow/core/platform/statusor.h"
 
 namespace tensorflow {
 namespace data {
@@ -55,7 +59,24 @@ std::string DataServiceJournalFile(const std::string& journal_dir,
 FileJournalWriter::FileJournalWriter(Env* env, const std::string& journal_dir)
     : env_(env), journal_dir_(journal_dir) {}
 
+FileJournalWriter::~FileJournalWriter() {
+  int64_t num_appended;
+  {
+    mutex_lock l(mu_);
+    num_appended = num_appended_;
+  }
+  Status s = Sync(num_appended);
+  if (!s.ok()) {
+    LOG(ERROR) << "Failed to sync journal in " << journal_dir_ << ": " << s;
+  }
+}
+
 Status FileJournalWriter::EnsureInitialized() {
+  mutex_lock l(file_mu_);
+  return EnsureInitializedLocked();
+}
+
+Status FileJournalWriter::EnsureInitializedLocked() {
   if (writer_) {
     return OkStatus();
   }
@@ -77,19 +98,64 @@ Status FileJournalWriter::EnsureInitialized() {
 }
 
 Status FileJournalWriter::Write(const Update& update) {
-  TF_RETURN_IF_ERROR(EnsureInitialized());
+  TF_ASSIGN_OR_RETURN(int64_t sequence_number, Append(update));
+  return Sync(sequence_number);
+}
+
+StatusOr<int64_t> FileJournalWriter::Append(const Update& update) {
   std::string s = update.SerializeAsString();
   if (s.empty()) {
     return errors::Internal("Failed to serialize update ", update.DebugString(),
                             " to string");
   }
-  TF_RETURN_IF_ERROR(writer_->WriteRecord(s));
-  TF_RETURN_IF_ERROR(writer_->Flush());
-  TF_RETURN_IF_ERROR(file_->Sync());
+  mutex_lock l(mu_);
+  TF_RETURN_IF_ERROR(status_);
+  pending_records_.push_back(std::move(s));
   if (VLOG_IS_ON(4)) {
-    VLOG(4) << "Wrote journal entry: " << update.DebugString();
+    VLOG(4) << "Appended journal entry: " << update.DebugString();
   }
-  return OkStatus();
+  return ++num_appended_;
+}
+
+Status FileJournalWriter::Sync(int64_t sequence_number) {
+  std::vector<std::string> records;
+  int64_t num_appended;
+  {
+    mutex_lock l(mu_);
+    while (status_.ok() && num_synced_ < sequence_number && syncing_) {
+      sync_cv_.wait(l);
+    }
+    if (num_synced_ >= sequence_number) {
+      return OkStatus();
+    }
+    TF_RETURN_IF_ERROR(status_);
+    // This thread syncs the updates of all waiting threads.
+    syncing_ = true;
+    records.swap(pending_records_);
+    num_appended = num_appended_;
+  }
+  Status s = WriteAndSync(records);
+  mutex_lock l(mu_);
+  syncing_ = false;
+  if (s.ok()) {
+    num_synced_ = num_appended;
+    VLOG(3) << "Synced " << records.size() << " journal entries.";
+  } else {
+    status_ = s;
+  }
+  sync_cv_.notify_all();
+  return s;
+}
+
+Status FileJournalWriter::WriteAndSync(
+    const std::vector<std::string>& records) {
+  mutex_lock l(file_mu_);
+  TF_RETURN_IF_ERROR(EnsureInitializedLocked());
+  for (const std::string& record : records) {
+    TF_RETURN_IF_ERROR(writer_->WriteRecord(record));
+  }
+  TF_RETURN_IF_ERROR(writer_->Flush());
+  return file_->Sync();
 }
 
 FileJournalReader::FileJournalReader(Env* env, StringPiece journal_dir)
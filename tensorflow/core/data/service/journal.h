@@ -15,14 +15,19 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DATA_SERVICE_JOURNAL_H_
 #define TENSORFLOW_CORE_DATA_SERVICE_JOURNAL_H_
 
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "tensorflow/core/data/service/journal.pb.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/io/record_reader.h"
 #include "tensorflow/core/lib/io/record_writer.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 
 namespace tensorflow {
 namespace data {
@@ -37,12 +42,17 @@ class JournalWriter {
   virtual ~JournalWriter() = default;
   // Writes and syncs an update to the journal.
   virtual Status Write(const Update& update) = 0;
+  // Appends an update to the journal without waiting for it to be durable.
+  // Returns the sequence number to pass to `Sync`. Updates become durable in
+  // the order they are appended.
+  virtual StatusOr<int64_t> Append(const Update& update) = 0;
+  // Blocks until the updates up to `sequence_number` are durable.
+  virtual Status Sync(int64_t sequence_number) = 0;
   // Initializes the writer if it is not yet initialized.
   virtual Status EnsureInitialized() = 0;
 };
 
-// FileJournalWriter is not thread-safe, requiring external synchronization when
-// used by multiple threads.
+// FileJournalWriter is thread-safe.
 //
 // FileJournalWriter writes journal files to a configured journal directory. The
 // directory is laid out in the following format:
@@ -55,8 +65,14 @@ class JournalWriter {
 // When the writer is created, it lists the directory to find the next available
 // journal file name. For example, if the journal directory contains
 // "journal_0", "journal_1", and "journal_2", the writer will write to
-// "journal_3". The writer will flush updates as they are written, so that they
-// can be stored durably in case of machine failure.
+// "journal_3". The writer will sync updates before `Write` and `Sync` return,
+// so that they can be stored durably in case of machine failure.
+//
+// Syncs are group-committed: appended updates are buffered, and the first
+// caller of `Sync` writes and syncs the updates of all callers in a single
+// write and sync, then releases them together. Callers arriving during a sync
+// are batched into the next one. If writing or syncing fails, the journal is
+// left in an unknown state, so all later calls fail.
 class FileJournalWriter : public JournalWriter {
  public:
   // Creates a journal writer to write to the given journal directory.
@@ -65,15 +81,39 @@ class FileJournalWriter : public JournalWriter {
   explicit FileJournalWriter(Env* env, const std::string& journal_dir);
   FileJournalWriter(const FileJournalWriter&) = delete;
   FileJournalWriter& operator=(const FileJournalWriter&) = delete;
+  // Syncs the updates appended but not synced yet.
+  ~FileJournalWriter() override;
 
   Status Write(const Update& update) override;
+  StatusOr<int64_t> Append(const Update& update) override;
+  Status Sync(int64_t sequence_number) override;
   Status EnsureInitialized() override;
 
  private:
+  Status EnsureInitializedLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(file_mu_);
+  // Writes `records` to the journal file and syncs it.
+  Status WriteAndSync(const std::vector<std::string>& records)
+      TF_LOCKS_EXCLUDED(file_mu_);
+
   Env* env_;
   const std::string journal_dir_;
-  std::unique_ptr<WritableFile> file_;
-  std::unique_ptr<io::RecordWriter> writer_;
+
+  mutex mu_;
+  // Serialized updates which have been appended but not written yet.
+  std::vector<std::string> pending_records_ TF_GUARDED_BY(mu_);
+  // Number of updates appended and synced.
+  int64_t num_appended_ TF_GUARDED_BY(mu_) = 0;
+  int64_t num_synced_ TF_GUARDED_BY(mu_) = 0;
+  // Whether a thread is writing and syncing a batch of updates.
+  bool syncing_ TF_GUARDED_BY(mu_) = false;
+  // The first error writing or syncing the journal.
+  Status status_ TF_GUARDED_BY(mu_);
+  condition_variable sync_cv_;
+
+  // Only held by the syncing thread, or during initialization.
+  mutex file_mu_;
+  std::unique_ptr<WritableFile> file_ TF_GUARDED_BY(file_mu_);
+  std::unique_ptr<io::RecordWriter> writer_ TF_GUARDED_BY(file_mu_);
 };
 
 // Interface for reading from a journal.
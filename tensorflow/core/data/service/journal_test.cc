@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/data/service/journal.h"
 
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <vector>
@@ -23,9 +24,13 @@ limitations under the License.
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/data/service/journal.pb.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/protobuf/data_service.pb.h"
 
 namespace tensorflow {
@@ -52,10 +57,10 @@ Update MakeCreateIterationUpdate() {
   return update;
 }
 
-Update MakeFinishTaskUpdate() {
+Update MakeFinishTaskUpdate(int64_t task_id = 8) {
   Update update;
   FinishTaskUpdate* finish_task = update.mutable_finish_task();
-  finish_task->set_task_id(8);
+  finish_task->set_task_id(task_id);
   return update;
 }
 
@@ -115,6 +120,84 @@ TEST(Journal, AppendExistingJournal) {
   TF_EXPECT_OK(CheckJournalContent(journal_dir, updates));
 }
 
+TEST(Journal, AppendAndSync) {
+  std::string journal_dir;
+  EXPECT_TRUE(NewJournalDir(journal_dir));
+  std::vector<Update> updates = {MakeCreateIterationUpdate(),
+                                 MakeRegisterDatasetUpdate(),
+                                 MakeFinishTaskUpdate()};
+  FileJournalWriter writer(Env::Default(), journal_dir);
+  TF_EXPECT_OK(writer.Sync(/*sequence_number=*/0));
+  int64_t sequence_number = 0;
+  for (const auto& update : updates) {
+    TF_ASSERT_OK_AND_ASSIGN(int64_t next_sequence_number,
+                            writer.Append(update));
+    EXPECT_GT(next_sequence_number, sequence_number);
+    sequence_number = next_sequence_number;
+  }
+  TF_EXPECT_OK(writer.Sync(sequence_number));
+  TF_EXPECT_OK(CheckJournalContent(journal_dir, updates));
+  // Syncing again is a no-op.
+  TF_EXPECT_OK(writer.Sync(sequence_number));
+  TF_EXPECT_OK(CheckJournalContent(journal_dir, updates));
+}
+
+TEST(Journal, DestructorSyncsAppendedUpdates) {
+  std::string journal_dir;
+  EXPECT_TRUE(NewJournalDir(journal_dir));
+  std::vector<Update> updates = {MakeCreateIterationUpdate(),
+                                 MakeRegisterDatasetUpdate()};
+  {
+    FileJournalWriter writer(Env::Default(), journal_dir);
+    for (const auto& update : updates) {
+      TF_ASSERT_OK(writer.Append(update).status());
+    }
+  }
+  TF_EXPECT_OK(CheckJournalContent(journal_dir, updates));
+}
+
+TEST(Journal, ConcurrentWrites) {
+  constexpr int64_t kNumThreads = 8;
+  constexpr int64_t kNumUpdatesPerThread = 50;
+  std::string journal_dir;
+  EXPECT_TRUE(NewJournalDir(journal_dir));
+  {
+    FileJournalWriter writer(Env::Default(), journal_dir);
+    thread::ThreadPool pool(Env::Default(), "journal_writers", kNumThreads);
+    BlockingCounter counter(kNumThreads);
+    for (int64_t i = 0; i < kNumThreads; ++i) {
+      pool.Schedule([&writer, &counter, i] {
+        for (int64_t j = 0; j < kNumUpdatesPerThread; ++j) {
+          TF_EXPECT_OK(
+              writer.Write(MakeFinishTaskUpdate(i * kNumUpdatesPerThread + j)));
+        }
+        counter.DecrementCount();
+      });
+    }
+    counter.Wait();
+  }
+
+  // Every update is written once, and the updates of each thread are written
+  // in order.
+  FileJournalReader reader(Env::Default(), journal_dir);
+  std::vector<int64_t> next_task_ids(kNumThreads);
+  for (int64_t i = 0; i < kNumThreads; ++i) {
+    next_task_ids[i] = i * kNumUpdatesPerThread;
+  }
+  for (int64_t i = 0; i < kNumThreads * kNumUpdatesPerThread; ++i) {
+    Update update;
+    bool end_of_journal = true;
+    TF_ASSERT_OK(reader.Read(update, end_of_journal));
+    ASSERT_FALSE(end_of_journal);
+    const int64_t task_id = update.finish_task().task_id();
+    EXPECT_EQ(task_id, next_task_ids[task_id / kNumUpdatesPerThread]++);
+  }
+  Update update;
+  bool end_of_journal = false;
+  TF_ASSERT_OK(reader.Read(update, end_of_journal));
+  EXPECT_TRUE(end_of_journal);
+}
+
 TEST(Journal, MissingFile) {
   std::string journal_dir;
   EXPECT_TRUE(NewJournalDir(journal_dir));
@@ -165,5 +248,31 @@ TEST(Journal, InvalidRecordData) {
   EXPECT_THAT(s.message(), HasSubstr("Failed to parse journal record"));
   EXPECT_EQ(s.code(), error::DATA_LOSS);
 }
+
+// Measures the throughput of `Write` calls issued by `state.range(0)`
+// concurrent threads, which share syncs.
+void BM_ConcurrentJournalWrites(::testing::benchmark::State& state) {
+  const int64_t num_threads = state.range(0);
+  std::string journal_dir;
+  CHECK(NewJournalDir(journal_dir));
+  FileJournalWriter writer(Env::Default(), journal_dir);
+  TF_CHECK_OK(writer.EnsureInitialized());
+  thread::ThreadPool pool(Env::Default(), "journal_writers", num_threads);
+  const Update update = MakeCreateIterationUpdate();
+  for (auto s : state) {
+    BlockingCounter counter(num_threads);
+    for (int64_t i = 0; i < num_threads; ++i) {
+      pool.Schedule([&writer, &counter, &update] {
+        TF_CHECK_OK(writer.Write(update));
+        counter.DecrementCount();
+      });
+    }
+    counter.Wait();
+  }
+  state.SetItemsProcessed(state.iterations() * num_threads);
+}
+
+BENCHMARK(BM_ConcurrentJournalWrites)->Arg(1)->Arg(4)->Arg(16)->Arg(64);
+
 }  // namespace data
 }  // namespace tensorflow
@@ -0,0 +1,186 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/ring_log.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/lib/hash/crc32c.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/statusor.h"
+
+namespace tensorflow {
+namespace data {
+
+StatusOr<std::unique_ptr<RingLog>> RingLog::Create(
+    Env* env, const std::string& directory, size_t max_size_bytes,
+    int64_t num_segments) {
+  if (max_size_bytes == 0 || num_segments <= 0) {
+    return errors::InvalidArgument(
+        "A ring log requires a positive size and number of segments. Got ",
+        max_size_bytes, " bytes and ", num_segments, " segments.");
+  }
+  TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(directory));
+  auto log = absl::WrapUnique(
+      new RingLog(env, directory, max_size_bytes, num_segments));
+  mutex_lock l(log->mu_);
+  TF_RETURN_IF_ERROR(log->AddSegment());
+  return log;
+}
+
+RingLog::RingLog(Env* env, const std::string& directory,
+                 size_t max_size_bytes, int64_t num_segments)
+    : env_(env),
+      directory_(directory),
+      max_size_bytes_(max_size_bytes),
+      max_segment_size_bytes_(
+          std::max<size_t>(max_size_bytes / num_segments, 1)) {}
+
+RingLog::~RingLog() {
+  mutex_lock l(mu_);
+  for (Segment& segment : segments_) {
+    if (segment.writer != nullptr) {
+      segment.writer->Close().IgnoreError();
+    }
+    Status s = env_->DeleteFile(segment.filename);
+    if (!s.ok()) {
+      LOG(WARNING) << "Failed to delete ring log segment " << segment.filename
+                   << ": " << s;
+    }
+  }
+}
+
+Status RingLog::Append(absl::string_view record) {
+  mutex_lock l(mu_);
+  Segment* segment = &segments_.back();
+  if (segment->size_bytes > 0 &&
+      segment->size_bytes + record.size() > max_segment_size_bytes_) {
+    TF_RETURN_IF_ERROR(segment->writer->Close());
+    segment->writer = nullptr;
+    TF_RETURN_IF_ERROR(AddSegment());
+    segment = &segments_.back();
+  }
+  TF_RETURN_IF_ERROR(segment->writer->Append(record));
+  segment->records.push_back(
+      Record{segment->size_bytes, record.size(),
+             crc32c::Value(record.data(), record.size())});
+  segment->size_bytes += record.size();
+  size_bytes_ += record.size();
+  ++end_position_;
+  DeleteOldSegments();
+  return OkStatus();
+}
+
+StatusOr<std::string> RingLog::Read(int64_t position) const {
+  std::shared_ptr<RandomAccessFile> reader;
+  Record record;
+  {
+    mutex_lock l(mu_);
+    if (position < begin_position_) {
+      return errors::NotFound("Record ", position,
+                              " has been deleted from the ring log at ",
+                              directory_, ".");
+    }
+    if (position >= end_position_) {
+      return errors::OutOfRange("Record ", position,
+                                " has not been written to the ring log at ",
+                                directory_, ".");
+    }
+    // Segments are ordered by position, and searched from the newest since
+    // recent records are read more often.
+    auto it = std::find_if(segments_.rbegin(), segments_.rend(),
+                           [position](const Segment& segment) {
+                             return segment.begin_position <= position;
+                           });
+    const Segment& segment = *it;
+    record = segment.records[position - segment.begin_position];
+    if (segment.writer != nullptr) {
+      TF_RETURN_IF_ERROR(segment.writer->Flush());
+    }
+    reader = segment.reader;
+  }
+
+  std::string result(record.size, '\0');
+  absl::string_view data;
+  TF_RETURN_IF_ERROR(
+      reader->Read(record.offset, record.size, &data, result.data()));
+  if (data.size() != record.size ||
+      crc32c::Value(data.data(), data.size()) != record.crc) {
+    return errors::DataLoss("Record ", position, " of the ring log at ",
+                            directory_, " is corrupted.");
+  }
+  if (data.data() != result.data()) {
+    result.assign(data.data(), data.size());
+  }
+  return result;
+}
+
+int64_t RingLog::begin_position() const {
+  mutex_lock l(mu_);
+  return begin_position_;
+}
+
+int64_t RingLog::end_position() const {
+  mutex_lock l(mu_);
+  return end_position_;
+}
+
+size_t RingLog::size_bytes() const {
+  mutex_lock l(mu_);
+  return size_bytes_;
+}
+
+Status RingLog::AddSegment() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  Segment segment;
+  segment.filename = io::JoinPath(
+      directory_, absl::StrCat("segment_", next_segment_index_++));
+  segment.begin_position = end_position_;
+  TF_RETURN_IF_ERROR(env_->NewWritableFile(segment.filename, &segment.writer));
+  std::unique_ptr<RandomAccessFile> reader;
+  TF_RETURN_IF_ERROR(env_->NewRandomAccessFile(segment.filename, &reader));
+  segment.reader = std::move(reader);
+  segments_.push_back(std::move(segment));
+  return OkStatus();
+}
+
+void RingLog::DeleteOldSegments() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  while (segments_.size() > 1 && size_bytes_ > max_size_bytes_) {
+    Segment& segment = segments_.front();
+    // Reads in progress keep the segment's file open.
+    Status s = env_->DeleteFile(segment.filename);
+    if (!s.ok()) {
+      LOG(WARNING) << "Failed to delete ring log segment " << segment.filename
+                   << ": " << s;
+    }
+    size_bytes_ -= segment.size_bytes;
+    begin_position_ += segment.records.size();
+    segments_.pop_front();
+  }
+}
+
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,116 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_SERVICE_RING_LOG_H_
+#define TENSORFLOW_CORE_DATA_SERVICE_RING_LOG_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+namespace data {
+
+// A log of records on local disk, bounded by `max_size_bytes`.
+//
+// Records are appended at consecutive positions, starting from 0, and read back
+// by position. The log is split into `num_segments` segment files. When the log
+// outgrows `max_size_bytes`, the oldest segment is deleted, so the log keeps a
+// sliding window of the most recent records. The files are deleted when the
+// log is destroyed.
+//
+// This class is thread-safe.
+class RingLog {
+ public:
+  static constexpr int64_t kDefaultNumSegments = 16;
+
+  // Creates a log whose segments are written to `directory`.
+  static StatusOr<std::unique_ptr<RingLog>> Create(
+      Env* env, const std::string& directory, size_t max_size_bytes,
+      int64_t num_segments = kDefaultNumSegments);
+
+  ~RingLog();
+  RingLog(const RingLog&) = delete;
+  RingLog& operator=(const RingLog&) = delete;
+
+  // Appends `record` at `end_position()`.
+  Status Append(absl::string_view record);
+
+  // Reads the record at `position`. Returns NotFound if the record has been
+  // deleted, and OutOfRange if it has not been written yet.
+  StatusOr<std::string> Read(int64_t position) const;
+
+  // Returns the position of the oldest record in the log.
+  int64_t begin_position() const;
+
+  // Returns the position of the next record to append.
+  int64_t end_position() const;
+
+  // Returns the size of the records in the log.
+  size_t size_bytes() const;
+
+ private:
+  struct Record {
+    uint64_t offset = 0;
+    uint64_t size = 0;
+    uint32_t crc = 0;
+  };
+
+  struct Segment {
+    std::string filename;
+    // Position of the first record in the segment.
+    int64_t begin_position = 0;
+    std::vector<Record> records;
+    size_t size_bytes = 0;
+    // Null once the segment is full.
+    std::unique_ptr<WritableFile> writer;
+    std::shared_ptr<RandomAccessFile> reader;
+  };
+
+  RingLog(Env* env, const std::string& directory, size_t max_size_bytes,
+          int64_t num_segments);
+
+  // Starts a new segment for the next records.
+  Status AddSegment() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Deletes the oldest segments until the log fits in `max_size_bytes_`.
+  void DeleteOldSegments() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  Env* const env_;
+  const std::string directory_;
+  const size_t max_size_bytes_;
+  const size_t max_segment_size_bytes_;
+
+  mutable mutex mu_;
+  std::deque<Segment> segments_ TF_GUARDED_BY(mu_);
+  int64_t begin_position_ TF_GUARDED_BY(mu_) = 0;
+  int64_t end_position_ TF_GUARDED_BY(mu_) = 0;
+  size_t size_bytes_ TF_GUARDED_BY(mu_) = 0;
+  int64_t next_segment_index_ TF_GUARDED_BY(mu_) = 0;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SERVICE_RING_LOG_H_
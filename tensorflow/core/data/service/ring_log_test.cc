@@ -0,0 +1,129 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/ring_log.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/status_matchers.h"
+#include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/error_codes.pb.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+using ::tensorflow::testing::IsOkAndHolds;
+using ::tensorflow::testing::StatusIs;
+using ::testing::IsEmpty;
+
+StatusOr<std::string> TestDirectory() {
+  std::string directory;
+  if (!Env::Default()->LocalTempFilename(&directory)) {
+    return errors::FailedPrecondition("Failed to create a temp directory.");
+  }
+  return directory;
+}
+
+// Returns a 10-byte record.
+std::string TestRecord(int64_t position) {
+  return absl::StrCat("record", 1000 + position % 1000);
+}
+
+TEST(RingLogTest, AppendAndRead) {
+  TF_ASSERT_OK_AND_ASSIGN(std::string directory, TestDirectory());
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<RingLog> log,
+      RingLog::Create(Env::Default(), directory, /*max_size_bytes=*/1 << 20));
+  for (int64_t i = 0; i < 100; ++i) {
+    TF_ASSERT_OK(log->Append(TestRecord(i)));
+  }
+  EXPECT_EQ(log->begin_position(), 0);
+  EXPECT_EQ(log->end_position(), 100);
+  EXPECT_EQ(log->size_bytes(), 1000);
+  for (int64_t i : {99, 0, 50, 51}) {
+    EXPECT_THAT(log->Read(i), IsOkAndHolds(TestRecord(i)));
+  }
+  EXPECT_THAT(log->Read(100), StatusIs(error::OUT_OF_RANGE));
+}
+
+TEST(RingLogTest, DeletesOldestSegments) {
+  TF_ASSERT_OK_AND_ASSIGN(std::string directory, TestDirectory());
+  // Each segment holds 10 records.
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<RingLog> log,
+      RingLog::Create(Env::Default(), directory, /*max_size_bytes=*/400,
+                      /*num_segments=*/4));
+  for (int64_t i = 0; i < 1000; ++i) {
+    TF_ASSERT_OK(log->Append(TestRecord(i)));
+    EXPECT_LE(log->size_bytes(), 400);
+  }
+  EXPECT_EQ(log->end_position(), 1000);
+  EXPECT_GE(log->begin_position(), 960);
+  EXPECT_LE(log->begin_position(), 970);
+  EXPECT_THAT(log->Read(log->begin_position() - 1),
+              StatusIs(error::NOT_FOUND));
+  for (int64_t i = log->begin_position(); i < 1000; ++i) {
+    EXPECT_THAT(log->Read(i), IsOkAndHolds(TestRecord(i)));
+  }
+  std::vector<std::string> segments;
+  TF_ASSERT_OK(Env::Default()->GetChildren(directory, &segments));
+  EXPECT_LE(segments.size(), 4);
+}
+
+TEST(RingLogTest, RecordsLargerThanSegments) {
+  TF_ASSERT_OK_AND_ASSIGN(std::string directory, TestDirectory());
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<RingLog> log,
+      RingLog::Create(Env::Default(), directory, /*max_size_bytes=*/20,
+                      /*num_segments=*/4));
+  const std::string large_record(100, 'a');
+  TF_ASSERT_OK(log->Append(large_record));
+  TF_ASSERT_OK(log->Append(large_record));
+  EXPECT_EQ(log->begin_position(), 1);
+  EXPECT_THAT(log->Read(1), IsOkAndHolds(large_record));
+}
+
+TEST(RingLogTest, DeletesFilesOnDestruction) {
+  TF_ASSERT_OK_AND_ASSIGN(std::string directory, TestDirectory());
+  {
+    TF_ASSERT_OK_AND_ASSIGN(
+        std::unique_ptr<RingLog> log,
+        RingLog::Create(Env::Default(), directory, /*max_size_bytes=*/100));
+    TF_ASSERT_OK(log->Append(TestRecord(0)));
+  }
+  std::vector<std::string> segments;
+  TF_ASSERT_OK(Env::Default()->GetChildren(directory, &segments));
+  EXPECT_THAT(segments, IsEmpty());
+}
+
+TEST(RingLogTest, InvalidArguments) {
+  TF_ASSERT_OK_AND_ASSIGN(std::string directory, TestDirectory());
+  EXPECT_THAT(RingLog::Create(Env::Default(), directory, /*max_size_bytes=*/0),
+              StatusIs(error::INVALID_ARGUMENT));
+  EXPECT_THAT(RingLog::Create(Env::Default(), directory,
+                              /*max_size_bytes=*/100, /*num_segments=*/0),
+              StatusIs(error::INVALID_ARGUMENT));
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
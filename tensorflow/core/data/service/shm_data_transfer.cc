@@ -0,0 +1,742 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/shm_data_transfer.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/data/service/common.pb.h"
+#include "tensorflow/core/data/service/data_transfer.h"
+#include "tensorflow/core/data/service/worker.pb.h"
+#include "tensorflow/core/framework/allocation_description.pb.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/dataset.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/framework/variant.h"
+#include "tensorflow/core/lib/gtl/cleanup.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/host_info.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/protobuf.h"
+#include "tensorflow/core/platform/random.h"
+#include "tensorflow/core/platform/refcount.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+constexpr uint32_t kSlotFree = 0;
+constexpr uint32_t kSlotInUse = 1;
+
+constexpr size_t kPageSize = 4096;
+// Each slot state takes its own cache line, so the server acquiring a slot
+// does not contend with the client releasing another one.
+constexpr size_t kSlotStateSize = 64;
+// Sanity limit on the size of a message read from the socket.
+constexpr uint64_t kMaxMessageSize = uint64_t{1} << 40;
+
+constexpr char kAllocatorName[] = "ShmDataTransfer";
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free,
+              "Slot states are shared between processes.");
+
+size_t AlignUp(size_t value, size_t alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+size_t HeaderSize(int64_t num_slots) {
+  return AlignUp(num_slots * kSlotStateSize, kPageSize);
+}
+
+}  // namespace
+
+// A ring of slots in shared memory, mapped by the server and one client.
+//
+// Each slot is owned by the server while it is free, and by the client from
+// when the server writes an element to it until the client releases it.
+class ShmRing {
+ public:
+  // Creates and maps the shared memory object `name`.
+  static StatusOr<std::shared_ptr<ShmRing>> Create(const std::string& name,
+                                                   int64_t num_slots,
+                                                   int64_t slot_size_bytes) {
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) {
+      return errors::IOError(
+          absl::StrCat("Failed to create shared memory object ", name), errno);
+    }
+    auto close_fd = gtl::MakeCleanup([fd] { close(fd); });
+    const size_t size = HeaderSize(num_slots) + num_slots * slot_size_bytes;
+    if (ftruncate(fd, size) != 0) {
+      const int error = errno;
+      shm_unlink(name.c_str());
+      return errors::IOError(
+          absl::StrCat("Failed to resize shared memory object ", name), error);
+    }
+    StatusOr<std::shared_ptr<ShmRing>> ring =
+        Map(fd, name, num_slots, slot_size_bytes, size);
+    if (!ring.ok()) {
+      shm_unlink(name.c_str());
+    }
+    return ring;
+  }
+
+  // Maps the ring described by `handshake`, and unlinks its name so that the
+  // memory is freed once both sides unmap it.
+  static StatusOr<std::shared_ptr<ShmRing>> Open(
+      const ShmTransferHandshake& handshake) {
+    if (handshake.num_slots() <= 0 || handshake.slot_size_bytes() <= 0 ||
+        handshake.slot_size_bytes() % kPageSize != 0) {
+      return errors::InvalidArgument("Invalid shared memory transfer ring: ",
+                                     handshake.ShortDebugString());
+    }
+    const std::string& name = handshake.shm_name();
+    int fd = shm_open(name.c_str(), O_RDWR, 0);
+    if (fd < 0) {
+      return errors::IOError(
+          absl::StrCat("Failed to open shared memory object ", name), errno);
+    }
+    auto close_fd = gtl::MakeCleanup([fd] { close(fd); });
+    shm_unlink(name.c_str());
+    const size_t size = HeaderSize(handshake.num_slots()) +
+                        handshake.num_slots() * handshake.slot_size_bytes();
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0) {
+      return errors::IOError(
+          absl::StrCat("Failed to stat shared memory object ", name), errno);
+    }
+    if (static_cast<size_t>(file_stat.st_size) != size) {
+      return errors::DataLoss("Shared memory object ", name, " has ",
+                              file_stat.st_size, " bytes, expected ", size,
+                              ".");
+    }
+    return Map(fd, name, handshake.num_slots(), handshake.slot_size_bytes(),
+               size);
+  }
+
+  ~ShmRing() { munmap(base_, size_); }
+  ShmRing(const ShmRing&) = delete;
+  ShmRing& operator=(const ShmRing&) = delete;
+
+  int64_t num_slots() const { return num_slots_; }
+  int64_t slot_size_bytes() const { return slot_size_bytes_; }
+  char* slot_data(int64_t slot) const {
+    return base_ + header_size_ + slot * slot_size_bytes_;
+  }
+
+  // Returns a free slot and marks it in use, or returns -1 if the client holds
+  // every slot. Only called by the server.
+  int64_t AcquireSlot() {
+    for (int64_t i = 0; i < num_slots_; ++i) {
+      const int64_t slot = (next_slot_ + i) % num_slots_;
+      // Pairs with the release in `ReleaseSlot`, so the client is done
+      // reading the slot before the server overwrites it.
+      if (state(slot).load(std::memory_order_acquire) == kSlotFree) {
+        state(slot).store(kSlotInUse, std::memory_order_relaxed);
+        next_slot_ = slot + 1;
+        return slot;
+      }
+    }
+    return -1;
+  }
+
+  // Returns `slot` to the server. Only called by the client.
+  void ReleaseSlot(int64_t slot) {
+    state(slot).store(kSlotFree, std::memory_order_release);
+  }
+
+ private:
+  ShmRing(char* base, size_t size, int64_t num_slots, int64_t slot_size_bytes)
+      : base_(base),
+        size_(size),
+        header_size_(HeaderSize(num_slots)),
+        num_slots_(num_slots),
+        slot_size_bytes_(slot_size_bytes) {}
+
+  static StatusOr<std::shared_ptr<ShmRing>> Map(int fd,
+                                                const std::string& name,
+                                                int64_t num_slots,
+                                                int64_t slot_size_bytes,
+                                                size_t size) {
+    void* base =
+        mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) {
+      return errors::IOError(
+          absl::StrCat("Failed to map shared memory object ", name), errno);
+    }
+    return absl::WrapUnique(new ShmRing(static_cast<char*>(base), size,
+                                        num_slots, slot_size_bytes));
+  }
+
+  std::atomic<uint32_t>& state(int64_t slot) {
+    return *reinterpret_cast<std::atomic<uint32_t>*>(base_ +
+                                                     slot * kSlotStateSize);
+  }
+
+  char* const base_;
+  const size_t size_;
+  const size_t header_size_;
+  const int64_t num_slots_;
+  const int64_t slot_size_bytes_;
+  int64_t next_slot_ = 0;
+};
+
+namespace {
+
+// Releases a slot once the last tensor aliasing it is destroyed.
+class SlotLease {
+ public:
+  SlotLease(std::shared_ptr<ShmRing> ring, int64_t slot)
+      : ring_(std::move(ring)), slot_(slot) {}
+  ~SlotLease() { ring_->ReleaseSlot(slot_); }
+  SlotLease(const SlotLease&) = delete;
+  SlotLease& operator=(const SlotLease&) = delete;
+
+ private:
+  const std::shared_ptr<ShmRing> ring_;
+  const int64_t slot_;
+};
+
+// A tensor buffer aliasing a slot of the ring. The buffer reports that it does
+// not own its memory, which keeps kernels from forwarding it as an output.
+class ShmTensorBuffer : public TensorBuffer {
+ public:
+  ShmTensorBuffer(char* data, size_t size, std::shared_ptr<SlotLease> lease)
+      : TensorBuffer(data), size_(size), lease_(std::move(lease)) {}
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name(kAllocatorName);
+    proto->set_ptr(reinterpret_cast<uintptr_t>(data()));
+  }
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  const size_t size_;
+  const std::shared_ptr<SlotLease> lease_;
+};
+
+Status SocketAddress(const std::string& address, sockaddr_un& addr,
+                     socklen_t& addr_len) {
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  if (address.empty() || address.size() >= sizeof(addr.sun_path)) {
+    return errors::InvalidArgument("Invalid Unix domain socket address \"",
+                                   address, "\".");
+  }
+  memcpy(addr.sun_path, address.data(), address.size());
+  // Addresses starting with '@' are in the abstract namespace, so they don't
+  // leave files behind.
+  if (address[0] == '@') {
+    addr.sun_path[0] = '\0';
+  }
+  addr_len = offsetof(sockaddr_un, sun_path) + address.size();
+  return OkStatus();
+}
+
+Status WriteFully(int fd, const char* data, size_t size) {
+  while (size > 0) {
+    ssize_t written = send(fd, data, size, MSG_NOSIGNAL);
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      return errors::IOError("Failed to write to shared memory transfer socket",
+                             errno);
+    }
+    data += written;
+    size -= written;
+  }
+  return OkStatus();
+}
+
+Status ReadFully(int fd, char* data, size_t size) {
+  while (size > 0) {
+    ssize_t read = recv(fd, data, size, 0);
+    if (read == 0) {
+      return errors::Unavailable("Shared memory transfer socket was closed.");
+    }
+    if (read < 0) {
+      if (errno == EINTR) continue;
+      return errors::IOError(
+          "Failed to read from shared memory transfer socket", errno);
+    }
+    data += read;
+    size -= read;
+  }
+  return OkStatus();
+}
+
+// Messages are sent as their size in host byte order, followed by the
+// serialized message. Both sides run on the same host.
+Status SendMessage(int fd, const protobuf::MessageLite& message) {
+  const uint64_t size = message.ByteSizeLong();
+  std::string buffer(reinterpret_cast<const char*>(&size), sizeof(size));
+  if (!message.AppendToString(&buffer)) {
+    return errors::Internal("Failed to serialize ", message.GetTypeName());
+  }
+  return WriteFully(fd, buffer.data(), buffer.size());
+}
+
+Status ReceiveMessage(int fd, protobuf::MessageLite& message) {
+  uint64_t size = 0;
+  TF_RETURN_IF_ERROR(
+      ReadFully(fd, reinterpret_cast<char*>(&size), sizeof(size)));
+  if (size > kMaxMessageSize) {
+    return errors::DataLoss("Invalid shared memory transfer message size ",
+                            size, ".");
+  }
+  std::string buffer(size, '\0');
+  TF_RETURN_IF_ERROR(ReadFully(fd, buffer.data(), size));
+  if (!message.ParseFromString(buffer)) {
+    return errors::DataLoss("Failed to parse ", message.GetTypeName());
+  }
+  return OkStatus();
+}
+
+// Writes `components` to a free slot of `ring`. Returns false if they can't be
+// written to the ring, in which case `response` is unchanged.
+bool WriteToRing(const std::vector<Tensor>& components, ShmRing& ring,
+                 ShmGetElementResponse& response) {
+  size_t size = 0;
+  for (const Tensor& component : components) {
+    if (!DataTypeCanUseMemcpy(component.dtype())) {
+      return false;
+    }
+    size = AlignUp(size, Allocator::kAllocatorAlignment) +
+           component.TotalBytes();
+  }
+  if (size > static_cast<size_t>(ring.slot_size_bytes())) {
+    return false;
+  }
+  const int64_t slot = ring.AcquireSlot();
+  if (slot < 0) {
+    return false;
+  }
+  char* data = ring.slot_data(slot);
+  size_t offset = 0;
+  for (const Tensor& component : components) {
+    offset = AlignUp(offset, Allocator::kAllocatorAlignment);
+    StringPiece bytes = component.tensor_data();
+    if (!bytes.empty()) {
+      memcpy(data + offset, bytes.data(), bytes.size());
+    }
+    ShmTensor* tensor = response.add_components();
+    tensor->set_dtype(component.dtype());
+    component.shape().AsProto(tensor->mutable_shape());
+    tensor->set_offset(offset);
+    offset += bytes.size();
+  }
+  response.set_slot(slot);
+  return true;
+}
+
+// Moves `element` into `resp`, as the gRPC worker does. If `element` consists
+// of a single CompressedElement variant, the move is zero-copy. Otherwise, the
+// tensors are serialized as TensorProtos.
+Status MoveElementToResponse(std::vector<Tensor>&& element,
+                             GetElementResponse& resp) {
+  if (element.size() != 1 || element[0].dtype() != DT_VARIANT ||
+      !TensorShapeUtils::IsScalar(element[0].shape())) {
+    UncompressedElement* uncompressed = resp.mutable_uncompressed();
+    for (const auto& component : element) {
+      component.AsProtoTensorContent(uncompressed->add_components());
+    }
+    return OkStatus();
+  }
+  Variant& variant = element[0].scalar<Variant>()();
+  CompressedElement* compressed = variant.get<CompressedElement>();
+  if (compressed == nullptr) {
+    return errors::FailedPrecondition(
+        "Expected dataset to produce a CompressedElement variant tensor, but "
+        "it produced ",
+        variant.TypeName());
+  }
+  *resp.mutable_compressed() = std::move(*compressed);
+  return OkStatus();
+}
+
+Status FillResponse(GetElementResult&& result, ShmRing& ring,
+                    ShmGetElementResponse& response) {
+  response.set_slot(-1);
+  GetElementResponse& element = *response.mutable_response();
+  element.set_element_index(result.element_index);
+  element.set_end_of_sequence(result.end_of_sequence);
+  element.set_skip_task(result.skip);
+  if (result.end_of_sequence || result.skip ||
+      WriteToRing(result.components, ring, response)) {
+    return OkStatus();
+  }
+  return MoveElementToResponse(std::move(result.components), element);
+}
+
+// Parses an element sent inline in `response`.
+Status ParseElement(GetElementResponse& response, GetElementResult& result) {
+  switch (response.element_case()) {
+    case GetElementResponse::kCompressed: {
+      Tensor tensor(DT_VARIANT, TensorShape{});
+      tensor.scalar<Variant>()() = std::move(*response.mutable_compressed());
+      result.components.push_back(std::move(tensor));
+      break;
+    }
+    case GetElementResponse::kUncompressed:
+      for (const auto& component : response.uncompressed().components()) {
+        result.components.emplace_back();
+        if (!result.components.back().FromProto(component)) {
+          return errors::Internal("Failed to parse tensor.");
+        }
+      }
+      break;
+    case GetElementResponse::ELEMENT_NOT_SET:
+      break;
+  }
+  return OkStatus();
+}
+
+}  // namespace
+
+bool IsLocalShmTransferServer(const DataTransferServerInfo& info) {
+  return info.protocol() == kShmTransferProtocol && !info.address().empty() &&
+         info.compatibility_info() == port::Hostname();
+}
+
+ShmDataTransferServer::ShmDataTransferServer(GetElementT get_element,
+                                             const Options& options)
+    : get_element_(std::move(get_element)),
+      options_{options.num_slots,
+               static_cast<int64_t>(AlignUp(
+                   std::max<int64_t>(options.slot_size_bytes, 0), kPageSize))},
+      address_(absl::StrCat("@tf_data_service_shm_",
+                            absl::Hex(random::New64(), absl::kZeroPad16))) {}
+
+ShmDataTransferServer::~ShmDataTransferServer() {
+  {
+    mutex_lock l(mu_);
+    cancelled_ = true;
+    for (const auto& connection : connections_) {
+      if (!connection->done) {
+        shutdown(connection->fd, SHUT_RDWR);
+      }
+    }
+  }
+  if (listen_fd_ >= 0) {
+    shutdown(listen_fd_, SHUT_RDWR);
+  }
+  accept_thread_.reset();
+  std::vector<std::unique_ptr<Connection>> connections;
+  {
+    mutex_lock l(mu_);
+    connections = std::move(connections_);
+  }
+  // Joins the connection threads.
+  connections.clear();
+  if (listen_fd_ >= 0) {
+    close(listen_fd_);
+  }
+}
+
+Status ShmDataTransferServer::Start() {
+  if (options_.num_slots <= 0 || options_.slot_size_bytes <= 0) {
+    return errors::InvalidArgument(
+        "The shared memory transfer server requires a positive number of "
+        "slots and slot size. Got ",
+        options_.num_slots, " slots of ", options_.slot_size_bytes, " bytes.");
+  }
+  sockaddr_un addr;
+  socklen_t addr_len;
+  TF_RETURN_IF_ERROR(SocketAddress(address_, addr, addr_len));
+  listen_fd_ = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (listen_fd_ < 0) {
+    return errors::IOError("Failed to create Unix domain socket", errno);
+  }
+  if (bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), addr_len) != 0 ||
+      listen(listen_fd_, SOMAXCONN) != 0) {
+    return errors::IOError(absl::StrCat("Failed to listen on ", address_),
+                           errno);
+  }
+  accept_thread_ = absl::WrapUnique(Env::Default()->StartThread(
+      {}, "tf_data_shm_transfer_server", [this] { AcceptLoop(); }));
+  return OkStatus();
+}
+
+StatusOr<std::string> ShmDataTransferServer::GetCompatibilityInfo() const {
+  return port::Hostname();
+}
+
+void ShmDataTransferServer::AcceptLoop() {
+  while (true) {
+    int fd = accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+    const int error = errno;
+    mutex_lock l(mu_);
+    if (cancelled_) {
+      if (fd >= 0) {
+        close(fd);
+      }
+      return;
+    }
+    if (fd < 0) {
+      if (error == EINTR || error == ECONNABORTED) continue;
+      LOG(ERROR) << "Shared memory transfer server at " << address_
+                 << " stopped accepting connections: "
+                 << errors::IOError("accept failed", error);
+      return;
+    }
+    // Joins the threads of closed connections.
+    connections_.erase(
+        std::remove_if(connections_.begin(), connections_.end(),
+                       [](const auto& connection) { return connection->done; }),
+        connections_.end());
+    auto connection = std::make_unique<Connection>();
+    connection->fd = fd;
+    Connection* connection_ptr = connection.get();
+    connection->thread = absl::WrapUnique(Env::Default()->StartThread(
+        {}, "tf_data_shm_transfer_connection",
+        [this, connection_ptr] { ServeConnection(connection_ptr); }));
+    connections_.push_back(std::move(connection));
+  }
+}
+
+void ShmDataTransferServer::ServeConnection(Connection* connection) {
+  Status s = ServeConnectionInternal(connection->fd);
+  if (!s.ok() && !errors::IsUnavailable(s)) {
+    LOG(WARNING) << "Shared memory transfer connection failed: " << s;
+  }
+  mutex_lock l(mu_);
+  connection->done = true;
+  close(connection->fd);
+}
+
+Status ShmDataTransferServer::ServeConnectionInternal(int fd) {
+  const std::string shm_name =
+      absl::StrCat("/tfdata_", absl::Hex(random::New64(), absl::kZeroPad16));
+  TF_ASSIGN_OR_RETURN(std::shared_ptr<ShmRing> ring,
+                      ShmRing::Create(shm_name, options_.num_slots,
+                                      options_.slot_size_bytes));
+  // The client unlinks the name when it maps the ring. This covers clients
+  // that disconnect before they do.
+  auto unlink = gtl::MakeCleanup([&shm_name] { shm_unlink(shm_name.c_str()); });
+
+  ShmTransferHandshake handshake;
+  handshake.set_shm_name(shm_name);
+  handshake.set_num_slots(ring->num_slots());
+  handshake.set_slot_size_bytes(ring->slot_size_bytes());
+  TF_RETURN_IF_ERROR(SendMessage(fd, handshake));
+  while (true) {
+    GetElementRequest request;
+    TF_RETURN_IF_ERROR(ReceiveMessage(fd, request));
+    ShmGetElementResponse response;
+    GetElementResult result;
+    Status s = get_element_(&request, &result);
+    if (s.ok()) {
+      s = FillResponse(std::move(result), *ring, response);
+    }
+    if (!s.ok()) {
+      response.Clear();
+      response.set_error_code(s.raw_code());
+      response.set_error_message(std::string(s.message()));
+    }
+    TF_RETURN_IF_ERROR(SendMessage(fd, response));
+  }
+}
+
+StatusOr<std::unique_ptr<ShmDataTransferClient>> ShmDataTransferClient::Connect(
+    const std::string& address) {
+  sockaddr_un addr;
+  socklen_t addr_len;
+  TF_RETURN_IF_ERROR(SocketAddress(address, addr, addr_len));
+  int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd < 0) {
+    return errors::IOError("Failed to create Unix domain socket", errno);
+  }
+  auto close_fd = gtl::MakeCleanup([fd] { close(fd); });
+  if (connect(fd, reinterpret_cast<sockaddr*>(&addr), addr_len) != 0) {
+    return errors::IOError(
+        absl::StrCat("Failed to connect to shared memory transfer server at ",
+                     address),
+        errno);
+  }
+  ShmTransferHandshake handshake;
+  TF_RETURN_IF_ERROR(ReceiveMessage(fd, handshake));
+  TF_ASSIGN_OR_RETURN(std::shared_ptr<ShmRing> ring,
+                      ShmRing::Open(handshake));
+  close_fd.release();
+  VLOG(2) << "Connected to shared memory transfer server at " << address
+          << " with " << ring->num_slots() << " slots of "
+          << ring->slot_size_bytes() << " bytes.";
+  return absl::WrapUnique(new ShmDataTransferClient(fd, std::move(ring)));
+}
+
+ShmDataTransferClient::ShmDataTransferClient(int fd,
+                                             std::shared_ptr<ShmRing> ring)
+    : fd_(fd), ring_(std::move(ring)) {}
+
+ShmDataTransferClient::~ShmDataTransferClient() { close(fd_); }
+
+Status ShmDataTransferClient::GetElement(const GetElementRequest& req,
+                                         GetElementResult& result) {
+  VLOG(3) << "GetElement for task " << req.task_id() << " from shared memory "
+          << "transfer server.";
+  {
+    mutex_lock l(mu_);
+    if (cancelled_) {
+      return errors::Cancelled("Client was cancelled.");
+    }
+  }
+  mutex_lock io_lock(io_mu_);
+  Status s = GetElementInternal(req, result);
+  if (!s.ok()) {
+    mutex_lock l(mu_);
+    if (cancelled_) {
+      return errors::Cancelled("Client was cancelled.");
+    }
+  }
+  return s;
+}
+
+Status ShmDataTransferClient::GetElementInternal(const GetElementRequest& req,
+                                                 GetElementResult& result) {
+  ShmGetElementResponse response;
+  Status s = SendMessage(fd_, req);
+  if (s.ok()) {
+    s = ReceiveMessage(fd_, response);
+  }
+  if (!s.ok()) {
+    // The socket can't be resynchronized after a partial message, so later
+    // requests fail too.
+    shutdown(fd_, SHUT_RDWR);
+    return s;
+  }
+  if (response.error_code() != 0) {
+    return Status(static_cast<absl::StatusCode>(response.error_code()),
+                  response.error_message());
+  }
+  GetElementResponse& element = *response.mutable_response();
+  result.element_index = element.element_index();
+  result.end_of_sequence = element.end_of_sequence();
+  result.skip = element.skip_task();
+  if (response.slot() < 0) {
+    return ParseElement(element, result);
+  }
+
+  const int64_t slot = response.slot();
+  if (slot >= ring_->num_slots()) {
+    return errors::DataLoss("Invalid shared memory transfer slot ", slot, ".");
+  }
+  auto lease = std::make_shared<SlotLease>(ring_, slot);
+  for (const ShmTensor& component : response.components()) {
+    TensorShape shape;
+    TF_RETURN_IF_ERROR(
+        TensorShape::BuildTensorShape(component.shape(), &shape));
+    const size_t size = shape.num_elements() * DataTypeSize(component.dtype());
+    if (!DataTypeCanUseMemcpy(component.dtype()) || component.offset() < 0 ||
+        component.offset() + size >
+            static_cast<size_t>(ring_->slot_size_bytes())) {
+      return errors::DataLoss("Invalid shared memory transfer tensor: ",
+                              component.ShortDebugString());
+    }
+    if (size == 0) {
+      result.components.emplace_back(component.dtype(), shape);
+      continue;
+    }
+    result.components.emplace_back(
+        component.dtype(), shape,
+        core::RefCountPtr<TensorBuffer>(new ShmTensorBuffer(
+            ring_->slot_data(slot) + component.offset(), size, lease)));
+  }
+  return OkStatus();
+}
+
+void ShmDataTransferClient::TryCancel() {
+  VLOG(2) << "Cancel ShmDataTransferClient.";
+  mutex_lock l(mu_);
+  cancelled_ = true;
+  // Unblocks a request in progress.
+  shutdown(fd_, SHUT_RDWR);
+}
+
+Status ShmDataTransferClient::CheckCompatibility(
+    const std::string& compatibility_info) const {
+  const std::string hostname = port::Hostname();
+  if (compatibility_info != hostname) {
+    return errors::FailedPrecondition(
+        "The shared memory transfer server runs on host ", compatibility_info,
+        ", but the client runs on host ", hostname, ".");
+  }
+  return OkStatus();
+}
+
+class ShmTransferServerRegistrar {
+ public:
+  ShmTransferServerRegistrar() {
+    DataTransferServer::Register(
+        kShmTransferProtocol,
+        [](DataTransferServer::GetElementT get_element,
+           std::shared_ptr<DataTransferServer>* out) {
+          ShmDataTransferServer::Options options;
+          TF_RETURN_IF_ERROR(ReadInt64FromEnvVar(kShmTransferNumSlotsEnvVar,
+                                                 options.num_slots,
+                                                 &options.num_slots));
+          TF_RETURN_IF_ERROR(ReadInt64FromEnvVar(kShmTransferSlotSizeEnvVar,
+                                                 options.slot_size_bytes,
+                                                 &options.slot_size_bytes));
+          *out = std::make_shared<ShmDataTransferServer>(get_element, options);
+          return OkStatus();
+        });
+  }
+};
+static ShmTransferServerRegistrar shm_server_registrar;
+
+class ShmTransferClientRegistrar {
+ public:
+  ShmTransferClientRegistrar() {
+    DataTransferClient::Register(
+        kShmTransferProtocol, [](DataTransferClient::Config config,
+                                 std::unique_ptr<DataTransferClient>* out) {
+          TF_ASSIGN_OR_RETURN(std::unique_ptr<ShmDataTransferClient> client,
+                              ShmDataTransferClient::Connect(config.address));
+          *out = std::move(client);
+          return OkStatus();
+        });
+  }
+};
+static ShmTransferClientRegistrar shm_client_registrar;
+
+}  // namespace data
+}  // namespace tensorflow
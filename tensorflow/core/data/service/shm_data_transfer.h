@@ -0,0 +1,155 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_SERVICE_SHM_DATA_TRANSFER_H_
+#define TENSORFLOW_CORE_DATA_SERVICE_SHM_DATA_TRANSFER_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/data/service/common.pb.h"
+#include "tensorflow/core/data/service/data_transfer.h"
+#include "tensorflow/core/data/service/worker.pb.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+namespace data {
+
+// Data transfer protocol for clients on the same host as the worker.
+//
+// The server listens on a Unix domain socket. For each connection, it creates a
+// ring of fixed-size slots in POSIX shared memory and sends its name to the
+// client in a `ShmTransferHandshake`. Requests and responses are exchanged over
+// the socket as length-prefixed protos, but the server copies the tensors of
+// each element into a free slot of the ring, and the client aliases them as
+// `Tensor`s without copying or parsing. The client returns a slot to the
+// server when the last tensor of its element is destroyed.
+//
+// Elements that have components which are not memcpy-able (e.g. strings or
+// compressed elements), that don't fit in a slot, or that arrive while the
+// client holds every slot are sent inline in the response instead, so the
+// server never waits on the client.
+//
+// Workers enable the protocol by setting `data_transfer_protocol` to "shm".
+// Clients then use it automatically for workers on their host; see
+// `IsLocalShmTransferServer`.
+inline constexpr char kShmTransferProtocol[] = "shm";
+
+// Environment variables overriding the ring of the registered server.
+inline constexpr char kShmTransferNumSlotsEnvVar[] =
+    "TF_DATA_SHM_TRANSFER_NUM_SLOTS";
+inline constexpr char kShmTransferSlotSizeEnvVar[] =
+    "TF_DATA_SHM_TRANSFER_SLOT_SIZE_BYTES";
+
+// Returns true if `info` describes a shared memory transfer server running on
+// this host.
+bool IsLocalShmTransferServer(const DataTransferServerInfo& info);
+
+class ShmDataTransferServer : public DataTransferServer {
+ public:
+  struct Options {
+    // Number of slots in the ring of each connection.
+    int64_t num_slots = 16;
+    // Size of each slot. Elements larger than this are sent inline.
+    int64_t slot_size_bytes = 16 << 20;  // 16MB
+  };
+
+  ShmDataTransferServer(GetElementT get_element, const Options& options);
+  ~ShmDataTransferServer() override;
+  ShmDataTransferServer(const ShmDataTransferServer&) = delete;
+  ShmDataTransferServer& operator=(const ShmDataTransferServer&) = delete;
+
+  Status Start() override;
+
+  // The server listens on a Unix domain socket, so it has no port.
+  int get_port() override { return 0; }
+
+  // Returns the name of the socket the server listens on.
+  std::string GetAddress() const override { return address_; }
+
+  // Returns the hostname of the server.
+  StatusOr<std::string> GetCompatibilityInfo() const override;
+
+ private:
+  struct Connection {
+    int fd = -1;
+    std::unique_ptr<Thread> thread;
+    bool done = false;
+  };
+
+  // Accepts connections until the server is destroyed.
+  void AcceptLoop();
+  // Serves requests on `connection` until the client disconnects.
+  void ServeConnection(Connection* connection);
+  Status ServeConnectionInternal(int fd);
+
+  const GetElementT get_element_;
+  const Options options_;
+  const std::string address_;
+
+  int listen_fd_ = -1;
+  std::unique_ptr<Thread> accept_thread_;
+
+  mutex mu_;
+  bool cancelled_ TF_GUARDED_BY(mu_) = false;
+  std::vector<std::unique_ptr<Connection>> connections_ TF_GUARDED_BY(mu_);
+};
+
+class ShmRing;
+
+class ShmDataTransferClient : public DataTransferClient {
+ public:
+  // Connects to the server listening at `address`.
+  static StatusOr<std::unique_ptr<ShmDataTransferClient>> Connect(
+      const std::string& address);
+
+  ~ShmDataTransferClient() override;
+  ShmDataTransferClient(const ShmDataTransferClient&) = delete;
+  ShmDataTransferClient& operator=(const ShmDataTransferClient&) = delete;
+
+  Status GetElement(const GetElementRequest& req,
+                    GetElementResult& result) override;
+
+  void TryCancel() override;
+
+  // Returns an error if the server runs on a different host.
+  Status CheckCompatibility(
+      const std::string& compatibility_info) const override;
+
+ private:
+  ShmDataTransferClient(int fd, std::shared_ptr<ShmRing> ring);
+
+  Status GetElementInternal(const GetElementRequest& req,
+                            GetElementResult& result)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(io_mu_);
+
+  const int fd_;
+  const std::shared_ptr<ShmRing> ring_;
+
+  // Serializes the requests on the socket.
+  mutex io_mu_;
+  mutex mu_;
+  bool cancelled_ TF_GUARDED_BY(mu_) = false;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SERVICE_SHM_DATA_TRANSFER_H_
@@ -0,0 +1,270 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/shm_data_transfer.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/data/service/common.pb.h"
+#include "tensorflow/core/data/service/data_transfer.h"
+#include "tensorflow/core/data/service/worker.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_description.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/host_info.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/status_matchers.h"
+#include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/error_codes.pb.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+using ::tensorflow::testing::StatusIs;
+using ::testing::IsEmpty;
+
+// Returns a function producing `components` as elements 0, 1, 2, ...
+DataTransferServer::GetElementT RepeatElement(std::vector<Tensor> components) {
+  auto next_index = std::make_shared<int64_t>(0);
+  return [components, next_index](const GetElementRequest* request,
+                                  GetElementResult* result) {
+    result->components = components;
+    result->element_index = (*next_index)++;
+    return OkStatus();
+  };
+}
+
+StatusOr<std::unique_ptr<ShmDataTransferServer>> StartServer(
+    DataTransferServer::GetElementT get_element, int64_t num_slots = 4,
+    int64_t slot_size_bytes = 4096) {
+  ShmDataTransferServer::Options options;
+  options.num_slots = num_slots;
+  options.slot_size_bytes = slot_size_bytes;
+  auto server =
+      std::make_unique<ShmDataTransferServer>(std::move(get_element), options);
+  TF_RETURN_IF_ERROR(server->Start());
+  return server;
+}
+
+StatusOr<GetElementResult> GetElement(ShmDataTransferClient& client) {
+  GetElementRequest request;
+  GetElementResult result;
+  TF_RETURN_IF_ERROR(client.GetElement(request, result));
+  return result;
+}
+
+bool InSharedMemory(const Tensor& tensor) {
+  TensorDescription description;
+  tensor.FillDescription(&description);
+  return description.allocation_description().allocator_name() ==
+         "ShmDataTransfer";
+}
+
+TEST(ShmDataTransferTest, DenseElementsAreMapped) {
+  std::vector<Tensor> element = {
+      test::AsTensor<int64_t>({1, 2, 3}),
+      test::AsTensor<float>({1.5, 2.5}, TensorShape({2, 1})),
+      test::AsScalar<bool>(true)};
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ShmDataTransferServer> server,
+                          StartServer(RepeatElement(element)));
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ShmDataTransferClient> client,
+      ShmDataTransferClient::Connect(server->GetAddress()));
+  for (int64_t i = 0; i < 10; ++i) {
+    TF_ASSERT_OK_AND_ASSIGN(GetElementResult result, GetElement(*client));
+    EXPECT_EQ(result.element_index, i);
+    EXPECT_FALSE(result.end_of_sequence);
+    ASSERT_EQ(result.components.size(), element.size());
+    for (int64_t j = 0; j < element.size(); ++j) {
+      test::ExpectEqual(result.components[j], element[j]);
+      EXPECT_TRUE(InSharedMemory(result.components[j]));
+    }
+  }
+}
+
+TEST(ShmDataTransferTest, StringsAreSentInline) {
+  std::vector<Tensor> element = {test::AsScalar<tstring>("hello"),
+                                 test::AsTensor<int64_t>({1, 2, 3})};
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ShmDataTransferServer> server,
+                          StartServer(RepeatElement(element)));
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ShmDataTransferClient> client,
+      ShmDataTransferClient::Connect(server->GetAddress()));
+  TF_ASSERT_OK_AND_ASSIGN(GetElementResult result, GetElement(*client));
+  ASSERT_EQ(result.components.size(), 2);
+  test::ExpectEqual(result.components[0], element[0]);
+  test::ExpectEqual(result.components[1], element[1]);
+  EXPECT_FALSE(InSharedMemory(result.components[1]));
+}
+
+TEST(ShmDataTransferTest, LargeElementsAreSentInline) {
+  Tensor large(DT_INT64, TensorShape({1024}));
+  large.flat<int64_t>().setConstant(7);
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ShmDataTransferServer> server,
+      StartServer(RepeatElement({large}), /*num_slots=*/4,
+                  /*slot_size_bytes=*/4096));
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ShmDataTransferClient> client,
+      ShmDataTransferClient::Connect(server->GetAddress()));
+  TF_ASSERT_OK_AND_ASSIGN(GetElementResult result, GetElement(*client));
+  ASSERT_EQ(result.components.size(), 1);
+  test::ExpectEqual(result.components[0], large);
+  EXPECT_FALSE(InSharedMemory(result.components[0]));
+}
+
+TEST(ShmDataTransferTest, FullRingFallsBackToInline) {
+  std::vector<Tensor> element = {test::AsTensor<int64_t>({1, 2, 3})};
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ShmDataTransferServer> server,
+                          StartServer(RepeatElement(element),
+                                      /*num_slots=*/2));
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ShmDataTransferClient> client,
+      ShmDataTransferClient::Connect(server->GetAddress()));
+  std::vector<GetElementResult> results;
+  for (int64_t i = 0; i < 3; ++i) {
+    TF_ASSERT_OK_AND_ASSIGN(GetElementResult result, GetElement(*client));
+    test::ExpectEqual(result.components[0], element[0]);
+    results.push_back(std::move(result));
+  }
+  EXPECT_TRUE(InSharedMemory(results[0].components[0]));
+  EXPECT_TRUE(InSharedMemory(results[1].components[0]));
+  EXPECT_FALSE(InSharedMemory(results[2].components[0]));
+
+  // Destroying the tensors of an element returns its slot to the server.
+  results[0].components.clear();
+  TF_ASSERT_OK_AND_ASSIGN(GetElementResult result, GetElement(*client));
+  test::ExpectEqual(result.components[0], element[0]);
+  EXPECT_TRUE(InSharedMemory(result.components[0]));
+}
+
+TEST(ShmDataTransferTest, ElementsOutliveClient) {
+  std::vector<Tensor> element = {test::AsTensor<int64_t>({1, 2, 3})};
+  GetElementResult result;
+  {
+    TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ShmDataTransferServer> server,
+                            StartServer(RepeatElement(element)));
+    TF_ASSERT_OK_AND_ASSIGN(
+        std::unique_ptr<ShmDataTransferClient> client,
+        ShmDataTransferClient::Connect(server->GetAddress()));
+    TF_ASSERT_OK_AND_ASSIGN(result, GetElement(*client));
+  }
+  ASSERT_EQ(result.components.size(), 1);
+  EXPECT_TRUE(InSharedMemory(result.components[0]));
+  test::ExpectEqual(result.components[0], element[0]);
+}
+
+TEST(ShmDataTransferTest, EndOfSequence) {
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ShmDataTransferServer> server,
+      StartServer([](const GetElementRequest* request,
+                     GetElementResult* result) {
+        result->end_of_sequence = true;
+        return OkStatus();
+      }));
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ShmDataTransferClient> client,
+      ShmDataTransferClient::Connect(server->GetAddress()));
+  TF_ASSERT_OK_AND_ASSIGN(GetElementResult result, GetElement(*client));
+  EXPECT_TRUE(result.end_of_sequence);
+  EXPECT_FALSE(result.skip);
+  EXPECT_THAT(result.components, IsEmpty());
+}
+
+TEST(ShmDataTransferTest, PropagatesErrors) {
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ShmDataTransferServer> server,
+      StartServer([](const GetElementRequest* request,
+                     GetElementResult* result) {
+        return errors::NotFound("Task ", request->task_id(), " not found.");
+      }));
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ShmDataTransferClient> client,
+      ShmDataTransferClient::Connect(server->GetAddress()));
+  EXPECT_THAT(GetElement(*client).status(), StatusIs(error::NOT_FOUND));
+  // The connection is still usable after an error.
+  EXPECT_THAT(GetElement(*client).status(), StatusIs(error::NOT_FOUND));
+}
+
+TEST(ShmDataTransferTest, Cancel) {
+  std::vector<Tensor> element = {test::AsTensor<int64_t>({1, 2, 3})};
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ShmDataTransferServer> server,
+                          StartServer(RepeatElement(element)));
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ShmDataTransferClient> client,
+      ShmDataTransferClient::Connect(server->GetAddress()));
+  TF_ASSERT_OK(GetElement(*client).status());
+  client->TryCancel();
+  EXPECT_THAT(GetElement(*client).status(), StatusIs(error::CANCELLED));
+}
+
+TEST(ShmDataTransferTest, ConnectToMissingServer) {
+  EXPECT_THAT(ShmDataTransferClient::Connect("@tf_data_service_shm_missing"),
+              StatusIs(error::UNAVAILABLE));
+}
+
+TEST(ShmDataTransferTest, RequiresSameHost) {
+  std::vector<Tensor> element = {test::AsTensor<int64_t>({1, 2, 3})};
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ShmDataTransferServer> server,
+                          StartServer(RepeatElement(element)));
+  TF_ASSERT_OK_AND_ASSIGN(std::string compatibility_info,
+                          server->GetCompatibilityInfo());
+  DataTransferServerInfo info;
+  info.set_protocol(kShmTransferProtocol);
+  info.set_address(server->GetAddress());
+  info.set_compatibility_info(compatibility_info);
+  EXPECT_TRUE(IsLocalShmTransferServer(info));
+
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ShmDataTransferClient> client,
+      ShmDataTransferClient::Connect(server->GetAddress()));
+  TF_EXPECT_OK(client->CheckCompatibility(compatibility_info));
+
+  const std::string other_host = absl::StrCat("not-", port::Hostname());
+  info.set_compatibility_info(other_host);
+  EXPECT_FALSE(IsLocalShmTransferServer(info));
+  EXPECT_THAT(client->CheckCompatibility(other_host),
+              StatusIs(error::FAILED_PRECONDITION));
+}
+
+TEST(ShmDataTransferTest, RegisteredProtocol) {
+  std::vector<Tensor> element = {test::AsTensor<int64_t>({1, 2, 3})};
+  std::shared_ptr<DataTransferServer> server;
+  TF_ASSERT_OK(DataTransferServer::Build(kShmTransferProtocol,
+                                         RepeatElement(element), &server));
+  TF_ASSERT_OK(server->Start());
+  std::unique_ptr<DataTransferClient> client;
+  TF_ASSERT_OK(DataTransferClient::Build(
+      kShmTransferProtocol, {"grpc", server->GetAddress()}, &client));
+  GetElementRequest request;
+  GetElementResult result;
+  TF_ASSERT_OK(client->GetElement(request, result));
+  ASSERT_EQ(result.components.size(), 1);
+  test::ExpectEqual(result.components[0], element[0]);
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
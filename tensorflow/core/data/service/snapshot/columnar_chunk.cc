@@ -0,0 +1,494 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/snapshot/columnar_chunk.h"
+
+#include <zlib.h>
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_util.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/coding.h"
+#include "tensorflow/core/protobuf/snapshot.pb.h"
+#include "tensorflow/tsl/lib/io/compression.h"
+#include "tensorflow/tsl/platform/env.h"
+#include "tensorflow/tsl/platform/errors.h"
+#include "tensorflow/tsl/platform/logging.h"
+#include "tensorflow/tsl/platform/snappy.h"
+#include "tensorflow/tsl/platform/status.h"
+#include "tensorflow/tsl/platform/statusor.h"
+#include "tensorflow/tsl/profiler/lib/traceme.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+using ::tensorflow::data::experimental::ColumnarChunkIndex;
+
+constexpr size_t kMagicSize = sizeof(kColumnarChunkMagic) - 1;
+// The index size and the magic bytes.
+constexpr size_t kFooterSize = sizeof(uint64_t) + kMagicSize;
+constexpr char kAutoCompression[] = "AUTO";
+
+// Returns the compression the writer applies for the requested `compression`.
+std::string ColumnCompression(const std::string& compression) {
+  if (compression == tsl::io::compression::kZlib ||
+      compression == tsl::io::compression::kGzip) {
+    return tsl::io::compression::kZlib;
+  }
+  // Snappy decompresses fastest, which suits snapshots that are read many
+  // times.
+  if (compression == tsl::io::compression::kSnappy ||
+      compression == kAutoCompression) {
+    return tsl::io::compression::kSnappy;
+  }
+  if (compression != tsl::io::compression::kNone) {
+    LOG(ERROR) << "Unsupported compression_type:" << compression
+               << ". No compression will be used.";
+  }
+  return tsl::io::compression::kNone;
+}
+
+Status Compress(const std::string& compression, int level,
+                std::string input, std::string& output) {
+  if (compression == tsl::io::compression::kSnappy) {
+    if (!tsl::port::Snappy_Compress(input.data(), input.size(), &output)) {
+      return errors::Internal("Failed to compress using snappy.");
+    }
+    return OkStatus();
+  }
+  if (compression == tsl::io::compression::kZlib) {
+    uLongf output_size = compressBound(input.size());
+    output.resize(output_size);
+    int result = compress2(reinterpret_cast<Bytef*>(output.data()),
+                           &output_size,
+                           reinterpret_cast<const Bytef*>(input.data()),
+                           input.size(), level == 0 ? Z_DEFAULT_COMPRESSION
+                                                    : level);
+    if (result != Z_OK) {
+      return errors::Internal("Failed to compress using zlib: error ",
+                              result);
+    }
+    output.resize(output_size);
+    return OkStatus();
+  }
+  output = std::move(input);
+  return OkStatus();
+}
+
+Status Uncompress(const std::string& compression, absl::string_view input,
+                  uint64_t uncompressed_size, char* output) {
+  if (compression == tsl::io::compression::kSnappy) {
+    size_t size;
+    if (!tsl::port::Snappy_GetUncompressedLength(input.data(), input.size(),
+                                                 &size) ||
+        size != uncompressed_size ||
+        !tsl::port::Snappy_Uncompress(input.data(), input.size(), output)) {
+      return errors::DataLoss("Failed to uncompress using snappy.");
+    }
+    return OkStatus();
+  }
+  if (compression == tsl::io::compression::kZlib) {
+    uLongf size = uncompressed_size;
+    if (uncompress(reinterpret_cast<Bytef*>(output), &size,
+                   reinterpret_cast<const Bytef*>(input.data()),
+                   input.size()) != Z_OK ||
+        size != uncompressed_size) {
+      return errors::DataLoss("Failed to uncompress using zlib.");
+    }
+    return OkStatus();
+  }
+  if (input.size() != uncompressed_size) {
+    return errors::DataLoss("Unexpected uncompressed column size ",
+                            input.size(), "; expected ", uncompressed_size);
+  }
+  std::memcpy(output, input.data(), input.size());
+  return OkStatus();
+}
+
+// Returns true if the elements of a column can be stored as their raw bytes.
+bool IsDense(const std::vector<Tensor>& column) {
+  if (!DataTypeCanUseMemcpy(column.front().dtype())) {
+    return false;
+  }
+  for (const Tensor& tensor : column) {
+    if (tensor.shape() != column.front().shape()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+tsl::StatusOr<bool> IsColumnarChunkFile(Env* env,
+                                        const std::string& filename) {
+  std::unique_ptr<RandomAccessFile> file;
+  TF_RETURN_IF_ERROR(env->NewRandomAccessFile(filename, &file));
+  char scratch[kMagicSize];
+  absl::string_view magic;
+  Status status = file->Read(/*offset=*/0, kMagicSize, &magic, scratch);
+  if (errors::IsOutOfRange(status)) {
+    return false;
+  }
+  TF_RETURN_IF_ERROR(status);
+  return magic == absl::string_view(kColumnarChunkMagic, kMagicSize);
+}
+
+ColumnarChunkWriter::ColumnarChunkWriter(const std::string& filename,
+                                         const std::string& compression,
+                                         int compression_level,
+                                         const DataTypeVector& dtypes,
+                                         int64_t block_size_bytes)
+    : filename_(filename),
+      compression_level_(compression_level),
+      dtypes_(dtypes),
+      block_size_bytes_(block_size_bytes),
+      block_(dtypes.size()) {
+  for (DataType dtype : dtypes_) {
+    index_.add_dtypes(dtype);
+  }
+  index_.set_compression(ColumnCompression(compression));
+}
+
+ColumnarChunkWriter::~ColumnarChunkWriter() {
+  Status s = Close();
+  if (!s.ok()) {
+    LOG(ERROR) << "Failed to close snapshot file " << filename_ << ": " << s;
+  }
+}
+
+Status ColumnarChunkWriter::Initialize(tensorflow::Env* env) {
+  TF_RETURN_IF_ERROR(env->NewWritableFile(filename_, &dest_));
+  TF_RETURN_IF_ERROR(
+      dest_->Append(absl::string_view(kColumnarChunkMagic, kMagicSize)));
+  offset_ = kMagicSize;
+  return OkStatus();
+}
+
+Status ColumnarChunkWriter::WriteTensors(const std::vector<Tensor>& tensors) {
+  if (dtypes_.empty() && index_.blocks().empty() &&
+      block_num_elements_ == 0) {
+    for (const Tensor& tensor : tensors) {
+      dtypes_.push_back(tensor.dtype());
+      index_.add_dtypes(tensor.dtype());
+    }
+    block_.resize(dtypes_.size());
+  }
+  if (tensors.size() != dtypes_.size()) {
+    return errors::InvalidArgument("Expected ", dtypes_.size(),
+                                   " components, but got ", tensors.size());
+  }
+  for (int64_t i = 0; i < tensors.size(); ++i) {
+    if (tensors[i].dtype() != dtypes_[i]) {
+      return errors::InvalidArgument(
+          "Expected component ", i, " to be ", DataTypeString(dtypes_[i]),
+          ", but got ", DataTypeString(tensors[i].dtype()));
+    }
+  }
+  for (int64_t i = 0; i < tensors.size(); ++i) {
+    block_[i].push_back(tensors[i]);
+    block_size_ += tensors[i].TotalBytes();
+  }
+  ++block_num_elements_;
+  if (block_size_ >= block_size_bytes_) {
+    return FlushBlock();
+  }
+  return OkStatus();
+}
+
+Status ColumnarChunkWriter::Sync() {
+  TF_RETURN_IF_ERROR(FlushBlock());
+  return dest_->Sync();
+}
+
+Status ColumnarChunkWriter::Close() {
+  if (dest_ == nullptr) {
+    return OkStatus();
+  }
+  TF_RETURN_IF_ERROR(FlushBlock());
+  std::string footer;
+  if (!index_.SerializeToString(&footer)) {
+    return errors::Internal("Failed to serialize the index of ", filename_);
+  }
+  core::PutFixed64(&footer, footer.size());
+  footer.append(kColumnarChunkMagic, kMagicSize);
+  TF_RETURN_IF_ERROR(dest_->Append(footer));
+  TF_RETURN_IF_ERROR(dest_->Close());
+  dest_ = nullptr;
+  return OkStatus();
+}
+
+Status ColumnarChunkWriter::FlushBlock() {
+  if (block_num_elements_ == 0) {
+    return OkStatus();
+  }
+  tsl::profiler::TraceMe activity("ColumnarChunkWriteBlock",
+                                  tsl::profiler::TraceMeLevel::kInfo);
+  ColumnarChunkIndex::Block* block = index_.add_blocks();
+  block->set_num_elements(block_num_elements_);
+  for (int64_t i = 0; i < block_.size(); ++i) {
+    ColumnarChunkIndex::Column* column = block->add_columns();
+    std::string uncompressed, compressed;
+    TF_RETURN_IF_ERROR(EncodeColumn(i, *column, uncompressed));
+    column->set_uncompressed_size(uncompressed.size());
+    TF_RETURN_IF_ERROR(Compress(index_.compression(), compression_level_,
+                                std::move(uncompressed), compressed));
+    column->set_offset(offset_);
+    column->set_size(compressed.size());
+    TF_RETURN_IF_ERROR(dest_->Append(compressed));
+    offset_ += compressed.size();
+    block_[i].clear();
+  }
+  block_num_elements_ = 0;
+  block_size_ = 0;
+  return OkStatus();
+}
+
+Status ColumnarChunkWriter::EncodeColumn(int64_t component,
+                                         ColumnarChunkIndex::Column& column,
+                                         std::string& output) const {
+  const std::vector<Tensor>& elements = block_[component];
+  if (IsDense(elements)) {
+    column.set_encoding(ColumnarChunkIndex::Column::DENSE);
+    elements.front().shape().AsProto(column.mutable_element_shape());
+    output.reserve(elements.size() * elements.front().TotalBytes());
+    for (const Tensor& tensor : elements) {
+      absl::string_view data = tensor.tensor_data();
+      output.append(data.data(), data.size());
+    }
+    return OkStatus();
+  }
+  column.set_encoding(ColumnarChunkIndex::Column::TENSOR_PROTOS);
+  for (const Tensor& tensor : elements) {
+    TensorProto proto;
+    tensor.AsProtoTensorContent(&proto);
+    std::string serialized;
+    if (!proto.SerializeToString(&serialized)) {
+      return errors::Internal("Failed to serialize a tensor of component ",
+                              component, " to ", filename_);
+    }
+    core::PutVarint64(&output, serialized.size());
+    output.append(serialized);
+  }
+  return OkStatus();
+}
+
+ColumnarChunkReader::ColumnarChunkReader(const std::string& filename,
+                                         const DataTypeVector& dtypes,
+                                         const std::vector<int64_t>& components)
+    : filename_(filename), dtypes_(dtypes), components_(components) {
+  if (components_.empty()) {
+    for (int64_t i = 0; i < dtypes_.size(); ++i) {
+      components_.push_back(i);
+    }
+  }
+}
+
+Status ColumnarChunkReader::Initialize(Env* env) {
+  TF_RETURN_IF_ERROR(env->NewRandomAccessFile(filename_, &file_));
+  uint64_t file_size;
+  TF_RETURN_IF_ERROR(env->GetFileSize(filename_, &file_size));
+  if (file_size < kMagicSize + kFooterSize) {
+    return errors::DataLoss("Columnar chunk ", filename_, " is truncated.");
+  }
+  char footer_scratch[kFooterSize];
+  absl::string_view footer;
+  TF_RETURN_IF_ERROR(file_->Read(file_size - kFooterSize, kFooterSize,
+                                 &footer, footer_scratch));
+  if (footer.substr(sizeof(uint64_t)) !=
+      absl::string_view(kColumnarChunkMagic, kMagicSize)) {
+    return errors::DataLoss(filename_, " is not a complete columnar chunk.");
+  }
+  const uint64_t index_size = core::DecodeFixed64(footer.data());
+  if (index_size > file_size - kMagicSize - kFooterSize) {
+    return errors::DataLoss("Invalid index size in ", filename_);
+  }
+  std::string index_scratch(index_size, '\0');
+  absl::string_view serialized_index;
+  TF_RETURN_IF_ERROR(file_->Read(file_size - kFooterSize - index_size,
+                                 index_size, &serialized_index,
+                                 index_scratch.data()));
+  if (!index_.ParseFromArray(serialized_index.data(),
+                             serialized_index.size())) {
+    return errors::DataLoss("Failed to parse the index of ", filename_);
+  }
+  if (index_.blocks().empty()) {
+    // Writers of empty chunks may not know the dtypes of the dataset.
+    return OkStatus();
+  }
+
+  if (index_.dtypes_size() != dtypes_.size()) {
+    return errors::FailedPrecondition(
+        "Columnar chunk ", filename_, " has ", index_.dtypes_size(),
+        " components, but ", dtypes_.size(), " were expected.");
+  }
+  for (int64_t i = 0; i < dtypes_.size(); ++i) {
+    if (index_.dtypes(i) != dtypes_[i]) {
+      return errors::FailedPrecondition(
+          "Component ", i, " of columnar chunk ", filename_, " is ",
+          DataTypeString(index_.dtypes(i)), ", but ",
+          DataTypeString(dtypes_[i]), " was expected.");
+    }
+  }
+  for (int64_t component : components_) {
+    if (component < 0 || component >= dtypes_.size()) {
+      return errors::InvalidArgument("Invalid component ", component,
+                                     " for a dataset with ", dtypes_.size(),
+                                     " components.");
+    }
+  }
+  for (const ColumnarChunkIndex::Block& block : index_.blocks()) {
+    if (block.columns_size() != dtypes_.size()) {
+      return errors::DataLoss("Invalid block in the index of ", filename_);
+    }
+    num_elements_ += block.num_elements();
+  }
+  return OkStatus();
+}
+
+Status ColumnarChunkReader::ReadTensors(std::vector<Tensor>* read_tensors) {
+  while (element_index_ >= block_num_elements_) {
+    if (block_index_ >= index_.blocks_size()) {
+      return errors::OutOfRange("End of columnar chunk ", filename_);
+    }
+    TF_RETURN_IF_ERROR(ReadBlock());
+  }
+  read_tensors->clear();
+  read_tensors->reserve(block_.size());
+  for (std::vector<Tensor>& column : block_) {
+    read_tensors->push_back(std::move(column[element_index_]));
+  }
+  ++element_index_;
+  return OkStatus();
+}
+
+Status ColumnarChunkReader::SkipRecords(int64_t num_records) {
+  const int64_t remaining = block_num_elements_ - element_index_;
+  if (num_records <= remaining) {
+    element_index_ += num_records;
+    return OkStatus();
+  }
+  num_records -= remaining;
+  block_.clear();
+  block_num_elements_ = element_index_ = 0;
+  while (block_index_ < index_.blocks_size() &&
+         index_.blocks(block_index_).num_elements() <= num_records) {
+    num_records -= index_.blocks(block_index_).num_elements();
+    ++block_index_;
+  }
+  if (num_records == 0) {
+    return OkStatus();
+  }
+  if (block_index_ >= index_.blocks_size()) {
+    return errors::OutOfRange("End of columnar chunk ", filename_);
+  }
+  TF_RETURN_IF_ERROR(ReadBlock());
+  element_index_ = num_records;
+  return OkStatus();
+}
+
+Status ColumnarChunkReader::ReadBlock() {
+  tsl::profiler::TraceMe activity("ColumnarChunkReadBlock",
+                                  tsl::profiler::TraceMeLevel::kInfo);
+  const ColumnarChunkIndex::Block& block = index_.blocks(block_index_);
+  block_.assign(components_.size(), {});
+  std::string scratch;
+  for (int64_t i = 0; i < components_.size(); ++i) {
+    const ColumnarChunkIndex::Column& column = block.columns(components_[i]);
+    scratch.resize(column.size());
+    absl::string_view compressed;
+    TF_RETURN_IF_ERROR(file_->Read(column.offset(), column.size(), &compressed,
+                                   scratch.data()));
+    if (compressed.size() != column.size()) {
+      return errors::DataLoss("Columnar chunk ", filename_, " is truncated.");
+    }
+    std::string uncompressed(column.uncompressed_size(), '\0');
+    TF_RETURN_IF_ERROR(Uncompress(index_.compression(), compressed,
+                                  column.uncompressed_size(),
+                                  uncompressed.data()));
+    TF_RETURN_WITH_CONTEXT_IF_ERROR(
+        DecodeColumn(column, dtypes_[components_[i]], block.num_elements(),
+                     uncompressed, block_[i]),
+        " Failed to decode block ", block_index_, " of ", filename_);
+  }
+  block_num_elements_ = block.num_elements();
+  element_index_ = 0;
+  ++block_index_;
+  return OkStatus();
+}
+
+Status ColumnarChunkReader::DecodeColumn(
+    const ColumnarChunkIndex::Column& column, DataType dtype,
+    int64_t num_elements, const std::string& input,
+    std::vector<Tensor>& elements) const {
+  elements.reserve(num_elements);
+  if (column.encoding() == ColumnarChunkIndex::Column::DENSE) {
+    TensorShape shape;
+    TF_RETURN_IF_ERROR(TensorShape::BuildTensorShape(column.element_shape(),
+                                                     &shape));
+    shape.InsertDim(0, num_elements);
+    Tensor batch(cpu_allocator(), dtype, shape);
+    if (batch.TotalBytes() != input.size()) {
+      return errors::DataLoss("Expected ", batch.TotalBytes(),
+                              " bytes for the column, but got ",
+                              input.size());
+    }
+    if (!input.empty()) {
+      std::memcpy(const_cast<char*>(batch.tensor_data().data()), input.data(),
+                  input.size());
+    }
+    for (int64_t i = 0; i < num_elements; ++i) {
+      Tensor element = batch.SubSlice(i);
+      // Kernels require aligned buffers, so elements whose offset in the
+      // batch is not aligned are copied.
+      elements.push_back(element.IsAligned() ? std::move(element)
+                                             : tensor::DeepCopy(element));
+    }
+    return OkStatus();
+  }
+  absl::string_view remaining = input;
+  for (int64_t i = 0; i < num_elements; ++i) {
+    uint64_t size;
+    if (!core::GetVarint64(&remaining, &size) || size > remaining.size()) {
+      return errors::DataLoss("Invalid tensor size in the column.");
+    }
+    TensorProto proto;
+    if (!proto.ParseFromArray(remaining.data(), size)) {
+      return errors::DataLoss("Failed to parse a tensor of the column.");
+    }
+    remaining.remove_prefix(size);
+    Tensor tensor;
+    if (!tensor.FromProto(cpu_allocator(), proto)) {
+      return errors::DataLoss("Invalid tensor in the column.");
+    }
+    elements.push_back(std::move(tensor));
+  }
+  return OkStatus();
+}
+
+}  // namespace data
+}  // namespace tensorflow
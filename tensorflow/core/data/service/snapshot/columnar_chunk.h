@@ -0,0 +1,155 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_SERVICE_SNAPSHOT_COLUMNAR_CHUNK_H_
+#define TENSORFLOW_CORE_DATA_SERVICE_SNAPSHOT_COLUMNAR_CHUNK_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/data/snapshot_utils.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/protobuf/snapshot.pb.h"
+#include "tensorflow/tsl/platform/env.h"
+#include "tensorflow/tsl/platform/status.h"
+#include "tensorflow/tsl/platform/statusor.h"
+
+namespace tensorflow {
+namespace data {
+
+// Columnar chunk files start and end with these bytes.
+inline constexpr char kColumnarChunkMagic[] = "TFDCOLS1";
+
+// Uncompressed size at which the writer closes a block.
+constexpr int64_t kDefaultColumnarBlockSizeBytes = 16 << 20;  // 16MB
+
+// Returns true if `filename` is a columnar chunk file, and false if it is in
+// another format, e.g. a TFRecord chunk.
+tsl::StatusOr<bool> IsColumnarChunkFile(Env* env, const std::string& filename);
+
+// Writes a distributed snapshot chunk in the columnar format.
+//
+// Elements are buffered into blocks of about `block_size_bytes`. When a block
+// is full, each of its components is written as one compressed buffer, and the
+// location of the buffers is recorded in a `ColumnarChunkIndex` that is
+// written at the end of the file by `Close`. Components whose elements are
+// memcpy-able tensors of the same shape are stored as their raw bytes; other
+// components are stored as serialized `TensorProto`s.
+//
+// `compression` is one of the methods of `tsl::io::compression`, or "AUTO".
+// `compression_level` is the ZLIB/GZIP level; 0 selects the default level. If
+// `dtypes` is empty, they are taken from the first element.
+class ColumnarChunkWriter : public snapshot_util::Writer {
+ public:
+  ColumnarChunkWriter(
+      const std::string& filename, const std::string& compression,
+      int compression_level, const DataTypeVector& dtypes,
+      int64_t block_size_bytes = kDefaultColumnarBlockSizeBytes);
+  ~ColumnarChunkWriter() override;
+
+  Status Initialize(tensorflow::Env* env) override;
+
+  Status WriteTensors(const std::vector<Tensor>& tensors) override;
+
+  // Writes the buffered block and syncs the file.
+  Status Sync() override;
+
+  // Writes the buffered block and the index. Does nothing if the writer is
+  // already closed.
+  Status Close() override;
+
+ private:
+  // Writes the buffered elements as a new block.
+  Status FlushBlock();
+
+  // Encodes the buffered elements of `component` into `output`, and records
+  // the encoding in `column`.
+  Status EncodeColumn(int64_t component,
+                      experimental::ColumnarChunkIndex::Column& column,
+                      std::string& output) const;
+
+  const std::string filename_;
+  const int compression_level_;
+  DataTypeVector dtypes_;
+  const int64_t block_size_bytes_;
+
+  std::unique_ptr<WritableFile> dest_;
+  uint64_t offset_ = 0;
+  experimental::ColumnarChunkIndex index_;
+
+  // The elements of the current block, by component.
+  std::vector<std::vector<Tensor>> block_;
+  int64_t block_num_elements_ = 0;
+  int64_t block_size_ = 0;
+};
+
+// Reads a chunk written by `ColumnarChunkWriter`.
+//
+// A block is read and decoded component by component: dense components are
+// decompressed into one tensor per block, which the elements of the block
+// slice when their alignment allows it. If `components` is not empty, only
+// those components are read, in the order given, and the byte ranges of the
+// other components are never read from the file. `SkipRecords` skips whole
+// blocks without reading them.
+class ColumnarChunkReader : public snapshot_util::Reader {
+ public:
+  ColumnarChunkReader(const std::string& filename,
+                      const DataTypeVector& dtypes,
+                      const std::vector<int64_t>& components = {});
+
+  Status Initialize(Env* env) override;
+
+  // Reads the next element into `read_tensors`. Returns OutOfRange at the end
+  // of the chunk.
+  Status ReadTensors(std::vector<Tensor>* read_tensors) override;
+
+  Status SkipRecords(int64_t num_records) override;
+
+  // Returns the number of elements in the chunk. Valid after `Initialize`.
+  int64_t num_elements() const { return num_elements_; }
+
+ private:
+  // Reads and decodes the block at `block_index_` and advances to the next.
+  Status ReadBlock();
+
+  // Decodes the column of `dtype` in `input` into `num_elements` elements.
+  Status DecodeColumn(const experimental::ColumnarChunkIndex::Column& column,
+                      DataType dtype, int64_t num_elements,
+                      const std::string& input,
+                      std::vector<Tensor>& elements) const;
+
+  const std::string filename_;
+  const DataTypeVector dtypes_;
+  std::vector<int64_t> components_;
+
+  std::unique_ptr<RandomAccessFile> file_;
+  experimental::ColumnarChunkIndex index_;
+  int64_t num_elements_ = 0;
+
+  // Index of the next block to read.
+  int64_t block_index_ = 0;
+  // The decoded elements of the current block, by selected component.
+  std::vector<std::vector<Tensor>> block_;
+  int64_t block_num_elements_ = 0;
+  // Index of the next element in the current block.
+  int64_t element_index_ = 0;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SERVICE_SNAPSHOT_COLUMNAR_CHUNK_H_
@@ -0,0 +1,213 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/snapshot/columnar_chunk.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/data/snapshot_utils.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/tsl/lib/core/status_test_util.h"
+#include "tensorflow/tsl/lib/io/compression.h"
+#include "tensorflow/tsl/platform/env.h"
+#include "tensorflow/tsl/platform/errors.h"
+#include "tensorflow/tsl/platform/path.h"
+#include "tensorflow/tsl/platform/status_matchers.h"
+#include "tensorflow/tsl/platform/statusor.h"
+#include "tensorflow/tsl/platform/test.h"
+#include "tensorflow/tsl/protobuf/error_codes.pb.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+using tsl::testing::IsOkAndHolds;
+using tsl::testing::StatusIs;
+
+const DataTypeVector& TestDtypes() {
+  static const DataTypeVector* dtypes =
+      new DataTypeVector{DT_INT64, DT_STRING, DT_FLOAT};
+  return *dtypes;
+}
+
+// The first component is dense, the second is a string, and the third has a
+// shape that depends on the element.
+std::vector<Tensor> MakeElement(int64_t i) {
+  std::vector<float> values(i % 3, static_cast<float>(i));
+  return {test::AsTensor<int64_t>({i, 2 * i}, TensorShape({2})),
+          test::AsScalar<tstring>(absl::StrCat("element_", i)),
+          test::AsTensor<float>(values, TensorShape({i % 3}))};
+}
+
+std::string TestFilename() {
+  return tsl::io::JoinPath(
+      ::testing::TempDir(),
+      ::testing::UnitTest::GetInstance()->current_test_info()->name());
+}
+
+void WriteChunk(const std::string& filename, const std::string& compression,
+                int64_t num_elements, int64_t block_size_bytes = 100) {
+  ColumnarChunkWriter writer(filename, compression, /*compression_level=*/0,
+                             TestDtypes(), block_size_bytes);
+  TF_ASSERT_OK(writer.Initialize(tsl::Env::Default()));
+  for (int64_t i = 0; i < num_elements; ++i) {
+    TF_ASSERT_OK(writer.WriteTensors(MakeElement(i)));
+  }
+  TF_ASSERT_OK(writer.Close());
+}
+
+void ExpectElement(const std::vector<Tensor>& element, int64_t i,
+                   const std::vector<int64_t>& components = {0, 1, 2}) {
+  std::vector<Tensor> expected = MakeElement(i);
+  ASSERT_EQ(element.size(), components.size());
+  for (int64_t j = 0; j < components.size(); ++j) {
+    test::ExpectEqual(element[j], expected[components[j]]);
+  }
+}
+
+using ColumnarChunkTest = ::testing::TestWithParam<std::string>;
+
+TEST_P(ColumnarChunkTest, ReadWrite) {
+  const std::string filename = TestFilename();
+  WriteChunk(filename, GetParam(), /*num_elements=*/100);
+  ColumnarChunkReader reader(filename, TestDtypes());
+  TF_ASSERT_OK(reader.Initialize(tsl::Env::Default()));
+  EXPECT_EQ(reader.num_elements(), 100);
+  for (int64_t i = 0; i < 100; ++i) {
+    std::vector<Tensor> element;
+    TF_ASSERT_OK(reader.ReadTensors(&element));
+    ExpectElement(element, i);
+  }
+  std::vector<Tensor> element;
+  EXPECT_THAT(reader.ReadTensors(&element), StatusIs(error::OUT_OF_RANGE));
+}
+
+TEST_P(ColumnarChunkTest, ReadComponents) {
+  const std::string filename = TestFilename();
+  WriteChunk(filename, GetParam(), /*num_elements=*/20);
+  ColumnarChunkReader reader(filename, TestDtypes(), /*components=*/{2, 0});
+  TF_ASSERT_OK(reader.Initialize(tsl::Env::Default()));
+  for (int64_t i = 0; i < 20; ++i) {
+    std::vector<Tensor> element;
+    TF_ASSERT_OK(reader.ReadTensors(&element));
+    ExpectElement(element, i, /*components=*/{2, 0});
+  }
+}
+
+TEST_P(ColumnarChunkTest, SkipRecords) {
+  const std::string filename = TestFilename();
+  WriteChunk(filename, GetParam(), /*num_elements=*/50);
+  ColumnarChunkReader reader(filename, TestDtypes());
+  TF_ASSERT_OK(reader.Initialize(tsl::Env::Default()));
+  std::vector<Tensor> element;
+  for (int64_t skip : {0, 1, 7, 20}) {
+    TF_ASSERT_OK(reader.SkipRecords(skip));
+  }
+  TF_ASSERT_OK(reader.ReadTensors(&element));
+  ExpectElement(element, 28);
+  TF_ASSERT_OK(reader.SkipRecords(21));
+  EXPECT_THAT(reader.ReadTensors(&element), StatusIs(error::OUT_OF_RANGE));
+  EXPECT_THAT(reader.SkipRecords(1), StatusIs(error::OUT_OF_RANGE));
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Compression, ColumnarChunkTest,
+    ::testing::ValuesIn<std::string>({tsl::io::compression::kNone,
+                                      tsl::io::compression::kSnappy,
+                                      tsl::io::compression::kZlib,
+                                      tsl::io::compression::kGzip, "AUTO"}));
+
+TEST(ColumnarChunkTest, EmptyChunk) {
+  const std::string filename = TestFilename();
+  WriteChunk(filename, tsl::io::compression::kSnappy, /*num_elements=*/0);
+  ColumnarChunkReader reader(filename, TestDtypes());
+  TF_ASSERT_OK(reader.Initialize(tsl::Env::Default()));
+  EXPECT_EQ(reader.num_elements(), 0);
+  std::vector<Tensor> element;
+  EXPECT_THAT(reader.ReadTensors(&element), StatusIs(error::OUT_OF_RANGE));
+}
+
+TEST(ColumnarChunkTest, CompressionLevel) {
+  const std::string filename = TestFilename();
+  {
+    ColumnarChunkWriter writer(filename, tsl::io::compression::kZlib,
+                               /*compression_level=*/9, {DT_INT64});
+    TF_ASSERT_OK(writer.Initialize(tsl::Env::Default()));
+    for (int64_t i = 0; i < 1000; ++i) {
+      TF_ASSERT_OK(writer.WriteTensors({test::AsScalar<int64_t>(i % 10)}));
+    }
+  }
+  uint64_t file_size;
+  TF_ASSERT_OK(tsl::Env::Default()->GetFileSize(filename, &file_size));
+  EXPECT_LT(file_size, 1000 * sizeof(int64_t));
+  ColumnarChunkReader reader(filename, {DT_INT64});
+  TF_ASSERT_OK(reader.Initialize(tsl::Env::Default()));
+  TF_ASSERT_OK(reader.SkipRecords(123));
+  std::vector<Tensor> element;
+  TF_ASSERT_OK(reader.ReadTensors(&element));
+  test::ExpectEqual(element[0], test::AsScalar<int64_t>(3));
+}
+
+TEST(ColumnarChunkTest, IsColumnarChunkFile) {
+  const std::string filename = TestFilename();
+  WriteChunk(filename, tsl::io::compression::kNone, /*num_elements=*/1);
+  EXPECT_THAT(IsColumnarChunkFile(tsl::Env::Default(), filename),
+              IsOkAndHolds(true));
+
+  const std::string tfrecord_filename = absl::StrCat(filename, ".tfrecord");
+  snapshot_util::TFRecordWriter writer(tfrecord_filename,
+                                       tsl::io::compression::kNone);
+  TF_ASSERT_OK(writer.Initialize(tsl::Env::Default()));
+  TF_ASSERT_OK(writer.WriteTensors(MakeElement(0)));
+  TF_ASSERT_OK(writer.Close());
+  EXPECT_THAT(IsColumnarChunkFile(tsl::Env::Default(), tfrecord_filename),
+              IsOkAndHolds(false));
+}
+
+TEST(ColumnarChunkTest, WrongDtypes) {
+  const std::string filename = TestFilename();
+  WriteChunk(filename, tsl::io::compression::kNone, /*num_elements=*/1);
+  ColumnarChunkReader reader(filename, {DT_INT64, DT_STRING});
+  EXPECT_THAT(reader.Initialize(tsl::Env::Default()),
+              StatusIs(error::FAILED_PRECONDITION));
+
+  ColumnarChunkWriter writer(absl::StrCat(filename, ".new"),
+                             tsl::io::compression::kNone,
+                             /*compression_level=*/0, {DT_INT64});
+  TF_ASSERT_OK(writer.Initialize(tsl::Env::Default()));
+  EXPECT_THAT(writer.WriteTensors({test::AsScalar<float>(1.0)}),
+              StatusIs(error::INVALID_ARGUMENT));
+}
+
+TEST(ColumnarChunkTest, TruncatedChunk) {
+  const std::string filename = TestFilename();
+  WriteChunk(filename, tsl::io::compression::kSnappy, /*num_elements=*/10);
+  std::string contents;
+  TF_ASSERT_OK(ReadFileToString(tsl::Env::Default(), filename, &contents));
+  TF_ASSERT_OK(WriteStringToFile(tsl::Env::Default(), filename,
+                                 contents.substr(0, contents.size() - 1)));
+  ColumnarChunkReader reader(filename, TestDtypes());
+  EXPECT_THAT(reader.Initialize(tsl::Env::Default()),
+              StatusIs(error::DATA_LOSS));
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -19,6 +19,7 @@ limitations under the License.
 #include <vector>
 
 #include "tensorflow/core/data/name_utils.h"
+#include "tensorflow/core/data/service/snapshot/columnar_chunk.h"
 #include "tensorflow/core/data/snapshot_utils.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -28,6 +29,7 @@ limitations under the License.
 #include "tensorflow/tsl/platform/env.h"
 #include "tensorflow/tsl/platform/errors.h"
 #include "tensorflow/tsl/platform/status.h"
+#include "tensorflow/tsl/platform/statusor.h"
 #include "tensorflow/tsl/platform/tstring.h"
 
 namespace tensorflow {
@@ -115,10 +117,24 @@ class SnapshotChunkDatasetOp::Dataset : public DatasetBase {
         : DatasetIterator<Dataset>(params) {}
 
     Status Initialize(IteratorContext* ctx) override {
-      reader_ = std::make_unique<snapshot_util::TFRecordReader>(
+      // Columnar chunks record their compression, so `compression_` only
+      // applies to TFRecord chunks.
+      TF_ASSIGN_OR_RETURN(
+          bool columnar,
+          IsColumnarChunkFile(ctx->env(), dataset()->chunk_file_));
+      if (columnar) {
+        auto reader = std::make_unique<ColumnarChunkReader>(
+            dataset()->chunk_file_, dataset()->dtypes_);
+        TF_RETURN_IF_ERROR(reader->Initialize(ctx->env()));
+        reader_ = std::move(reader);
+        return OkStatus();
+      }
+      auto reader = std::make_unique<snapshot_util::TFRecordReader>(
           dataset()->chunk_file_, dataset()->compression_, dataset()->dtypes_,
           kTFRecordReaderOutputBufferSize);
-      return reader_->Initialize(ctx->env());
+      TF_RETURN_IF_ERROR(reader->Initialize(ctx->env()));
+      reader_ = std::move(reader);
+      return OkStatus();
     }
 
    protected:
@@ -154,18 +170,13 @@ class SnapshotChunkDatasetOp::Dataset : public DatasetBase {
     }
 
    private:
-    // TODO(b/250921378): Optimize this to not parse every single element. We
-    // may consider switching the data format to ArrayRecords so we can use the
-    // index to jump straight to the starting record.
+    // Columnar chunks skip whole blocks using their index. TFRecord chunks
+    // still parse every element up to `start_index_`.
     Status AdvanceToStartIndex(IteratorContext* ctx) {
-      for (int64_t i = 0; i < start_index_; ++i) {
-        std::vector<Tensor> unused;
-        TF_RETURN_IF_ERROR(reader_->ReadTensors(&unused));
-      }
-      return OkStatus();
+      return reader_->SkipRecords(start_index_);
     }
 
-    std::unique_ptr<snapshot_util::TFRecordReader> reader_;
+    std::unique_ptr<snapshot_util::Reader> reader_;
     int64_t start_index_ = 0;
   };
 
@@ -29,6 +29,7 @@ limitations under the License.
 #include "absl/strings/str_cat.h"
 #include "absl/time/time.h"
 #include "tensorflow/core/data/service/common.h"
+#include "tensorflow/core/data/service/snapshot/columnar_chunk.h"
 #include "tensorflow/core/data/service/snapshot/file_utils.h"
 #include "tensorflow/core/data/service/snapshot/path_utils.h"
 #include "tensorflow/core/data/service/snapshot/utils.h"
@@ -147,13 +148,12 @@ Status SnapshotStreamWriter::WriteChunk() {
   std::string uncommitted_chunk_file_path =
       tsl::io::JoinPath(params_.UncommittedChunksDirectory(),
                         absl::StrCat("chunk_", chunk_index_));
-  snapshot_util::TFRecordWriter writer(uncommitted_chunk_file_path,
-                                       params_.compression);
-  TF_RETURN_IF_ERROR(writer.Initialize(params_.env));
+  TF_ASSIGN_OR_RETURN(std::unique_ptr<snapshot_util::Writer> writer,
+                      CreateChunkWriter(uncommitted_chunk_file_path));
   while (ShouldWriteRecord()) {
-    TF_RETURN_IF_ERROR(WriteRecord(writer));
+    TF_RETURN_IF_ERROR(WriteRecord(*writer));
   }
-  TF_RETURN_IF_ERROR(writer.Close());
+  TF_RETURN_IF_ERROR(writer->Close());
   chunk_file_to_num_elements_[absl::StrCat("chunk_", chunk_index_)] =
       chunk_num_elements_;
   if (ShouldCommit()) {
@@ -219,8 +219,23 @@ bool SnapshotStreamWriter::ShouldWriteRecord() const TF_LOCKS_EXCLUDED(mu_) {
          !end_of_sequence_ && completed_.ok();
 }
 
-Status SnapshotStreamWriter::WriteRecord(
-    snapshot_util::TFRecordWriter& writer) {
+StatusOr<std::unique_ptr<snapshot_util::Writer>>
+SnapshotStreamWriter::CreateChunkWriter(const std::string& filename) const {
+  if (params_.chunk_format ==
+      experimental::DistributedSnapshotMetadata::COLUMNAR) {
+    auto writer = std::make_unique<ColumnarChunkWriter>(
+        filename, params_.compression, params_.compression_level,
+        /*dtypes=*/DataTypeVector());
+    TF_RETURN_IF_ERROR(writer->Initialize(params_.env));
+    return writer;
+  }
+  auto writer = std::make_unique<snapshot_util::TFRecordWriter>(
+      filename, params_.compression);
+  TF_RETURN_IF_ERROR(writer->Initialize(params_.env));
+  return writer;
+}
+
+Status SnapshotStreamWriter::WriteRecord(snapshot_util::Writer& writer) {
   std::vector<Tensor> element;
   TF_RETURN_IF_ERROR(iterator_->GetNext(element, end_of_sequence_));
   if (end_of_sequence_) {
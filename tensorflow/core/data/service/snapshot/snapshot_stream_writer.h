@@ -32,6 +32,7 @@ limitations under the License.
 #include "tensorflow/core/data/service/worker.pb.h"
 #include "tensorflow/core/data/snapshot_utils.h"
 #include "tensorflow/core/protobuf/service_config.pb.h"
+#include "tensorflow/core/protobuf/snapshot.pb.h"
 #include "tensorflow/tsl/platform/env.h"
 #include "tensorflow/tsl/platform/mutex.h"
 #include "tensorflow/tsl/platform/status.h"
@@ -69,6 +70,13 @@ struct SnapshotWriterParams {
   // snapshot. Used only for unit testing.
   bool test_only_keep_temp_files = false;
 
+  // Layout of the chunk files.
+  experimental::DistributedSnapshotMetadata::ChunkFormat chunk_format =
+      experimental::DistributedSnapshotMetadata::TFRECORD;
+
+  // Compression level of columnar chunks; 0 selects the default level.
+  int compression_level = 0;
+
   std::string StreamDirectory() const {
     return tensorflow::data::StreamDirectory(snapshot_path, stream_index);
   }
@@ -175,8 +183,12 @@ class SnapshotStreamWriter {
   // chunk.
   bool ShouldWriteRecord() const;
 
+  // Creates and initializes the writer of the chunk at `filename`.
+  StatusOr<std::unique_ptr<snapshot_util::Writer>> CreateChunkWriter(
+      const std::string& filename) const;
+
   // Writes the next record to the current chunk.
-  Status WriteRecord(snapshot_util::TFRecordWriter& writer);
+  Status WriteRecord(snapshot_util::Writer& writer);
 
   // Writes a DONE file when the stream is finished. Writes an ERROR file if it
   // failed.
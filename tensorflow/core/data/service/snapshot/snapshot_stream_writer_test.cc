@@ -23,6 +23,7 @@ limitations under the License.
 
 #include "absl/strings/str_cat.h"
 #include "tensorflow/core/data/service/common.pb.h"
+#include "tensorflow/core/data/service/snapshot/columnar_chunk.h"
 #include "tensorflow/core/data/service/snapshot/path_utils.h"
 #include "tensorflow/core/data/service/task_runner.h"
 #include "tensorflow/core/data/service/test_util.h"
@@ -311,6 +312,35 @@ TEST(SnapshotStreamWriterTest, EmptyDataset) {
               IsOkAndHolds(IsEmpty()));
 }
 
+TEST(SnapshotStreamWriterTest, WriteColumnarChunks) {
+  int64_t range = 10;
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<StandaloneTaskIterator> iterator,
+                          TestIterator(testing::RangeDataset(range)));
+
+  TF_ASSERT_OK_AND_ASSIGN(std::string snapshot_path, CreateSnapshotDirectory());
+  SnapshotWriterParams writer_params{snapshot_path, /*stream_index=*/0,
+                                     tsl::io::compression::kZlib,
+                                     Env::Default()};
+  writer_params.chunk_format =
+      experimental::DistributedSnapshotMetadata::COLUMNAR;
+  writer_params.compression_level = 9;
+  SnapshotStreamWriter snapshot_writer(writer_params, std::move(iterator));
+  EXPECT_THAT(snapshot_writer.Wait(), IsOkAndHolds(true));
+
+  ColumnarChunkReader reader(
+      tsl::io::JoinPath(writer_params.CommittedChunksDirectory(),
+                        "chunk_0_0_10"),
+      {DT_INT64});
+  TF_ASSERT_OK(reader.Initialize(Env::Default()));
+  EXPECT_EQ(reader.num_elements(), range);
+  std::vector<int64_t> result;
+  std::vector<Tensor> element;
+  while (reader.ReadTensors(&element).ok()) {
+    result.push_back(element[0].scalar<int64_t>()());
+  }
+  EXPECT_THAT(result, ElementsAre(0, 1, 2, 3, 4, 5, 6, 7, 8, 9));
+}
+
 TEST(SnapshotStreamWriterTest, Cancel) {
   const int64_t range = 10000;
   TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<StandaloneTaskIterator> iterator,
@@ -0,0 +1,109 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/split_leases.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+
+namespace tensorflow {
+namespace data {
+
+void SplitLeases::RecordStarted(const std::string& worker_address,
+                                int64_t num_started) {
+  auto it = leases_.find(worker_address);
+  if (it == leases_.end()) {
+    // The dispatcher may have restarted since the splits were leased.
+    return;
+  }
+  WorkerLease& lease = it->second;
+  num_started = std::min<int64_t>(num_started, lease.unstarted.size());
+  lease.unstarted.erase(lease.unstarted.begin(),
+                        lease.unstarted.begin() + num_started);
+  lease.num_to_revoke =
+      std::min<int64_t>(lease.num_to_revoke, lease.unstarted.size());
+}
+
+int64_t SplitLeases::TakeRevocations(const std::string& worker_address) {
+  auto it = leases_.find(worker_address);
+  if (it == leases_.end() || it->second.num_to_revoke == 0) {
+    return 0;
+  }
+  WorkerLease& lease = it->second;
+  const int64_t num_revoked = lease.num_to_revoke;
+  auto first_revoked = lease.unstarted.end() - num_revoked;
+  stolen_.insert(stolen_.end(), first_revoked, lease.unstarted.end());
+  lease.unstarted.erase(first_revoked, lease.unstarted.end());
+  lease.num_to_revoke = 0;
+  return num_revoked;
+}
+
+void SplitLeases::Lease(const std::string& worker_address,
+                        const std::vector<Tensor>& splits) {
+  std::deque<Tensor>& unstarted = leases_[worker_address].unstarted;
+  unstarted.insert(unstarted.end(), splits.begin(), splits.end());
+}
+
+bool SplitLeases::PopStolen(Tensor& split) {
+  if (stolen_.empty()) {
+    return false;
+  }
+  split = std::move(stolen_.front());
+  stolen_.pop_front();
+  return true;
+}
+
+bool SplitLeases::ScheduleSteal(const std::string& thief_address) {
+  WorkerLease* victim = nullptr;
+  for (auto& [worker_address, lease] : leases_) {
+    if (lease.num_to_revoke > 0) {
+      return true;
+    }
+    if (worker_address != thief_address &&
+        (victim == nullptr ||
+         lease.unstarted.size() > victim->unstarted.size())) {
+      victim = &lease;
+    }
+  }
+  // The victim keeps the split it may be about to start.
+  if (victim == nullptr || victim->unstarted.size() < 2) {
+    return false;
+  }
+  victim->num_to_revoke = victim->unstarted.size() / 2;
+  return true;
+}
+
+int64_t SplitLeases::NumUnstarted(const std::string& worker_address) const {
+  auto it = leases_.find(worker_address);
+  return it == leases_.end() ? 0 : it->second.unstarted.size();
+}
+
+void SplitLeases::RemoveWorker(const std::string& worker_address) {
+  leases_.erase(worker_address);
+}
+
+bool SplitLeases::empty() const {
+  return stolen_.empty() &&
+         std::all_of(leases_.begin(), leases_.end(), [](const auto& lease) {
+           return lease.second.unstarted.empty();
+         });
+}
+
+}  // namespace data
+}  // namespace tensorflow
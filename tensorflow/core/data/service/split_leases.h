@@ -0,0 +1,96 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_SERVICE_SPLIT_LEASES_H_
+#define TENSORFLOW_CORE_DATA_SERVICE_SPLIT_LEASES_H_
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/tensor.h"
+
+namespace tensorflow {
+namespace data {
+
+// Tracks the splits of one repetition of a split provider that workers have
+// prefetched but not started processing, and reassigns them from straggling
+// workers to idle ones.
+//
+// Each worker owns a lease on the splits it prefetched, in the order it
+// received them. Workers report how many of them they started whenever they
+// ask for more splits. Once the split provider is exhausted, an idle worker
+// may steal from the worker with the most unstarted splits: the second half of
+// the victim's unstarted splits is marked for revocation, and only moved to the
+// stolen pool when the victim next asks for splits and acknowledges the
+// revocation before starting any more of them. Splits are therefore processed
+// exactly once, as long as no worker is lost.
+//
+// SplitLeases is not thread-safe.
+class SplitLeases {
+ public:
+  // Records that `worker_address` started the first `num_started` splits of
+  // its lease.
+  void RecordStarted(const std::string& worker_address, int64_t num_started);
+
+  // Revokes the splits marked for revocation from the end of the lease of
+  // `worker_address`, moving them to the stolen pool. Returns the number of
+  // revoked splits, which the worker must drop from the end of its prefetched
+  // splits.
+  int64_t TakeRevocations(const std::string& worker_address);
+
+  // Appends `splits` to the lease of `worker_address`.
+  void Lease(const std::string& worker_address,
+             const std::vector<Tensor>& splits);
+
+  // Pops a split from the stolen pool into `split`. Returns false if the pool
+  // is empty.
+  bool PopStolen(Tensor& split);
+
+  // Marks splits of the worker with the most unstarted splits, other than
+  // `thief_address`, for revocation. Returns true if there are splits pending
+  // revocation, in which case the thief should ask again later.
+  bool ScheduleSteal(const std::string& thief_address);
+
+  // Returns the number of splits `worker_address` has prefetched but not
+  // started.
+  int64_t NumUnstarted(const std::string& worker_address) const;
+
+  // Removes the lease of `worker_address`, which must have no unstarted
+  // splits.
+  void RemoveWorker(const std::string& worker_address);
+
+  // Returns true if no worker holds unstarted splits and the stolen pool is
+  // empty.
+  bool empty() const;
+
+ private:
+  struct WorkerLease {
+    // Splits prefetched but not started, in the order they were leased.
+    std::deque<Tensor> unstarted;
+    // The number of splits at the end of `unstarted` to revoke.
+    int64_t num_to_revoke = 0;
+  };
+
+  absl::flat_hash_map<std::string, WorkerLease> leases_;
+  // Splits revoked from stragglers, which idle workers may take.
+  std::deque<Tensor> stolen_;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SERVICE_SPLIT_LEASES_H_
@@ -0,0 +1,113 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/split_leases.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+std::vector<Tensor> Splits(int64_t begin, int64_t end) {
+  std::vector<Tensor> splits;
+  for (int64_t i = begin; i < end; ++i) {
+    splits.push_back(Tensor(i));
+  }
+  return splits;
+}
+
+std::vector<int64_t> PopStolen(SplitLeases& leases) {
+  std::vector<int64_t> result;
+  Tensor split;
+  while (leases.PopStolen(split)) {
+    result.push_back(split.scalar<int64_t>()());
+  }
+  return result;
+}
+
+TEST(SplitLeasesTest, RecordStarted) {
+  SplitLeases leases;
+  EXPECT_TRUE(leases.empty());
+  leases.Lease("worker_0", Splits(0, 4));
+  EXPECT_EQ(leases.NumUnstarted("worker_0"), 4);
+  EXPECT_FALSE(leases.empty());
+  leases.RecordStarted("worker_0", 3);
+  EXPECT_EQ(leases.NumUnstarted("worker_0"), 1);
+  leases.RecordStarted("worker_0", 10);
+  EXPECT_EQ(leases.NumUnstarted("worker_0"), 0);
+  EXPECT_TRUE(leases.empty());
+  // Unknown workers are ignored.
+  leases.RecordStarted("worker_1", 1);
+  EXPECT_EQ(leases.NumUnstarted("worker_1"), 0);
+}
+
+TEST(SplitLeasesTest, StealFromStraggler) {
+  SplitLeases leases;
+  leases.Lease("worker_0", Splits(0, 4));
+  leases.Lease("worker_1", Splits(4, 6));
+  leases.RecordStarted("worker_1", 2);
+
+  EXPECT_TRUE(leases.ScheduleSteal("worker_1"));
+  // Nothing is stolen until the victim acknowledges the revocation.
+  EXPECT_TRUE(PopStolen(leases).empty());
+  EXPECT_TRUE(leases.ScheduleSteal("worker_1"));
+  EXPECT_EQ(leases.TakeRevocations("worker_1"), 0);
+
+  leases.RecordStarted("worker_0", 1);
+  EXPECT_EQ(leases.TakeRevocations("worker_0"), 2);
+  EXPECT_EQ(leases.NumUnstarted("worker_0"), 1);
+  EXPECT_EQ(PopStolen(leases), (std::vector<int64_t>{2, 3}));
+  EXPECT_EQ(leases.TakeRevocations("worker_0"), 0);
+}
+
+TEST(SplitLeasesTest, RevokesOnlyUnstartedSplits) {
+  SplitLeases leases;
+  leases.Lease("worker_0", Splits(0, 4));
+  EXPECT_TRUE(leases.ScheduleSteal("worker_1"));
+  // The victim started 3 splits before acknowledging the revocation.
+  leases.RecordStarted("worker_0", 3);
+  EXPECT_EQ(leases.TakeRevocations("worker_0"), 1);
+  EXPECT_EQ(leases.NumUnstarted("worker_0"), 0);
+  EXPECT_EQ(PopStolen(leases), (std::vector<int64_t>{3}));
+}
+
+TEST(SplitLeasesTest, NothingToSteal) {
+  SplitLeases leases;
+  EXPECT_FALSE(leases.ScheduleSteal("worker_0"));
+  leases.Lease("worker_0", Splits(0, 4));
+  // Workers don't steal from themselves.
+  EXPECT_FALSE(leases.ScheduleSteal("worker_0"));
+  leases.Lease("worker_1", Splits(4, 5));
+  leases.RecordStarted("worker_0", 4);
+  // The victim keeps its last split.
+  EXPECT_FALSE(leases.ScheduleSteal("worker_0"));
+}
+
+TEST(SplitLeasesTest, RemoveWorker) {
+  SplitLeases leases;
+  leases.Lease("worker_0", Splits(0, 1));
+  leases.RecordStarted("worker_0", 1);
+  leases.RemoveWorker("worker_0");
+  EXPECT_TRUE(leases.empty());
+  EXPECT_FALSE(leases.ScheduleSteal("worker_1"));
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
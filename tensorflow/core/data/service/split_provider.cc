@@ -15,9 +15,12 @@ limitations under the License.
 
 #include "tensorflow/core/data/service/split_provider.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "tensorflow/core/data/service/common.pb.h"
@@ -33,6 +36,13 @@ limitations under the License.
 
 namespace tensorflow {
 namespace data {
+namespace {
+
+// How long to wait before asking again for splits that are being reassigned
+// from another worker.
+constexpr int64_t kStealRetryIntervalMicros = 10 * 1000;
+
+}  // namespace
 
 Status DataServiceSplitProvider::GetNext(Tensor* split, bool* end_of_splits)
     TF_LOCKS_EXCLUDED(mu_) {
@@ -41,6 +51,9 @@ Status DataServiceSplitProvider::GetNext(Tensor* split, bool* end_of_splits)
     dispatcher_ =
         std::make_unique<DataServiceDispatcherClient>(address_, protocol_);
   }
+  if (max_prefetched_splits_ > 0) {
+    return GetNextPrefetched(split, end_of_splits);
+  }
   TF_RETURN_IF_ERROR(grpc_util::Retry(
       [this, split, end_of_splits]() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
         return dispatcher_->GetSplit(iteration_id_, repetition_,
@@ -61,9 +74,74 @@ Status DataServiceSplitProvider::GetNext(Tensor* split, bool* end_of_splits)
   return OkStatus();
 }
 
+Status DataServiceSplitProvider::GetNextPrefetched(Tensor* split,
+                                                   bool* end_of_splits)
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  *end_of_splits = false;
+  while (true) {
+    if (static_cast<int64_t>(prefetched_splits_.size()) <= refill_threshold_) {
+      TF_RETURN_IF_ERROR(Refill(*end_of_splits));
+      if (*end_of_splits) {
+        VLOG(1) << "Reached end of splits for iteration_id=" << iteration_id_
+                << ", repetition=" << repetition_;
+        return OkStatus();
+      }
+    }
+    if (!prefetched_splits_.empty()) {
+      *split = std::move(prefetched_splits_.front());
+      prefetched_splits_.pop_front();
+      ++num_splits_started_;
+      return OkStatus();
+    }
+    // Another worker's splits are being reassigned to this worker.
+    Env::Default()->SleepForMicroseconds(kStealRetryIntervalMicros);
+  }
+}
+
+Status DataServiceSplitProvider::Refill(bool& end_of_splits)
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  std::vector<Tensor> splits;
+  int64_t num_revoked_splits = 0;
+  const int64_t max_splits =
+      max_prefetched_splits_ - static_cast<int64_t>(prefetched_splits_.size());
+  TF_RETURN_IF_ERROR(grpc_util::Retry(
+      [&]() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        splits.clear();
+        return dispatcher_->GetSplits(
+            iteration_id_, repetition_, split_provider_index_, worker_address_,
+            max_splits, num_splits_started_, splits, num_revoked_splits,
+            end_of_splits);
+      },
+      "get next splits",
+      /*deadline_micros=*/Env::Default()->NowMicros() +
+          (timeout_ms_ * EnvTime::kMillisToMicros)));
+  num_splits_started_ = 0;
+  num_revoked_splits = std::min<int64_t>(num_revoked_splits,
+                                         prefetched_splits_.size());
+  prefetched_splits_.erase(prefetched_splits_.end() - num_revoked_splits,
+                           prefetched_splits_.end());
+  if (num_revoked_splits > 0) {
+    VLOG(1) << "Dropped " << num_revoked_splits
+            << " prefetched splits reassigned to other workers for "
+            << "iteration_id=" << iteration_id_;
+  }
+  for (Tensor& split : splits) {
+    prefetched_splits_.push_back(std::move(split));
+  }
+  // If the dispatcher has no more splits, only ask again once half of the
+  // remaining splits are used, so that it can still reassign them.
+  refill_threshold_ = splits.empty() ? prefetched_splits_.size() / 2
+                                     : max_prefetched_splits_ / 2;
+  return OkStatus();
+}
+
 Status DataServiceSplitProvider::Reset() TF_LOCKS_EXCLUDED(mu_) {
   mutex_lock l(mu_);
   repetition_++;
+  // Splits prefetched for the previous repetition are abandoned with it.
+  prefetched_splits_.clear();
+  num_splits_started_ = 0;
+  refill_threshold_ = 0;
   return OkStatus();
 }
 
@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DATA_SERVICE_SPLIT_PROVIDER_H_
 #define TENSORFLOW_CORE_DATA_SERVICE_SPLIT_PROVIDER_H_
 
+#include <cstdint>
+#include <deque>
 #include <functional>
 #include <memory>
 #include <string>
@@ -33,16 +35,25 @@ namespace tensorflow {
 namespace data {
 
 // SplitProvider which reads splits from a tf.data service dispatcher over RPC.
+//
+// If `max_prefetched_splits` is positive, the split provider prefetches up to
+// that many splits for the worker at `worker_address`, and asks for more once
+// half of them are used. When the dataset's splits run out, the dispatcher
+// reassigns unstarted prefetched splits of straggling workers to idle ones.
 class DataServiceSplitProvider : public SplitProvider {
  public:
   DataServiceSplitProvider(const std::string& address,
                            const std::string& protocol, int64_t iteration_id,
-                           int64_t split_provider_index, int64_t timeout_ms)
+                           int64_t split_provider_index, int64_t timeout_ms,
+                           const std::string& worker_address = "",
+                           int64_t max_prefetched_splits = 0)
       : address_(address),
         protocol_(protocol),
         iteration_id_(iteration_id),
         split_provider_index_(split_provider_index),
-        timeout_ms_(timeout_ms) {}
+        timeout_ms_(timeout_ms),
+        worker_address_(worker_address),
+        max_prefetched_splits_(max_prefetched_splits) {}
 
   Status GetNext(Tensor* split, bool* end_of_splits) override;
   Status Reset() override;
@@ -52,15 +63,28 @@ class DataServiceSplitProvider : public SplitProvider {
                  IteratorStateReader* reader) override;
 
  private:
+  Status GetNextPrefetched(Tensor* split, bool* end_of_splits)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Asks the dispatcher for more splits, applying its revocations.
+  Status Refill(bool& end_of_splits) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   const std::string address_;
   const std::string protocol_;
   const int64_t iteration_id_;
   const int64_t split_provider_index_;
   const int64_t timeout_ms_;
+  const std::string worker_address_;
+  const int64_t max_prefetched_splits_;
 
   mutex mu_;
   int64_t repetition_ TF_GUARDED_BY(mu_) = 0;
   std::unique_ptr<DataServiceDispatcherClient> dispatcher_ TF_GUARDED_BY(mu_);
+  // Prefetched splits which haven't been returned by `GetNext`.
+  std::deque<Tensor> prefetched_splits_ TF_GUARDED_BY(mu_);
+  // The number of prefetched splits returned since the last refill.
+  int64_t num_splits_started_ TF_GUARDED_BY(mu_) = 0;
+  // Refills once `prefetched_splits_` has at most this many splits.
+  int64_t refill_threshold_ TF_GUARDED_BY(mu_) = 0;
 };
 
 // Makes split providers for `dataset_def` and stores them in `split_providers`.
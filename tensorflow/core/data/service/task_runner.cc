@@ -16,24 +16,33 @@ limitations under the License.
 
 #include <algorithm>
 #include <memory>
+#include <string>
 #include <utility>
 #include <vector>
 
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
 #include "tensorflow/core/data/service/common.h"
 #include "tensorflow/core/data/service/cross_trainer_cache.h"
 #include "tensorflow/core/data/service/data_transfer.h"
 #include "tensorflow/core/data/service/logging_utils.h"
+#include "tensorflow/core/data/service/ring_log.h"
 #include "tensorflow/core/data/service/thread_safe_buffer.h"
 #include "tensorflow/core/data/service/worker.pb.h"
 #include "tensorflow/core/data/standalone.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/dataset.pb.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/tensor_util.h"
+#include "tensorflow/core/framework/variant.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/statusor.h"
 #include "tensorflow/core/platform/thread_annotations.h"
@@ -46,6 +55,26 @@ namespace {
 constexpr int64_t kWaitBeforeSkipUs = 100 * 1000;  // 100ms.
 constexpr size_t kDefaultCrossTrainerCacheSizeBytes =
     10 * (size_t{1} << 30);  // 10GB
+constexpr size_t kDefaultCrossTrainerCacheDiskSizeBytes =
+    100 * (size_t{1} << 30);  // 100GB
+
+// Creates the disk tier of the cross-trainer cache of `task_def`, or returns
+// nullptr if the worker does not configure one.
+StatusOr<std::unique_ptr<RingLog>> CreateCrossTrainerCacheDiskTier(
+    const experimental::WorkerConfig& worker_config, const TaskDef& task_def) {
+  if (worker_config.cross_trainer_cache_disk_directory().empty()) {
+    return std::unique_ptr<RingLog>();
+  }
+  const size_t max_size_bytes =
+      worker_config.cross_trainer_cache_disk_size_bytes() > 0
+          ? worker_config.cross_trainer_cache_disk_size_bytes()
+          : kDefaultCrossTrainerCacheDiskSizeBytes;
+  return RingLog::Create(
+      Env::Default(),
+      io::JoinPath(worker_config.cross_trainer_cache_disk_directory(),
+                   absl::StrCat("task_", task_def.task_id())),
+      max_size_bytes);
+}
 
 }  // namespace
 
@@ -94,8 +123,11 @@ Status TaskRunner::Create(const experimental::WorkerConfig& worker_config,
         worker_config.cross_trainer_cache_size_bytes() > 0
             ? worker_config.cross_trainer_cache_size_bytes()
             : kDefaultCrossTrainerCacheSizeBytes;
-    out = std::make_unique<CachingTaskRunner>(std::move(iterator),
-                                              max_cache_size_bytes);
+    TF_ASSIGN_OR_RETURN(
+        std::unique_ptr<RingLog> disk_tier,
+        CreateCrossTrainerCacheDiskTier(worker_config, task_def));
+    out = std::make_unique<CachingTaskRunner>(
+        std::move(iterator), max_cache_size_bytes, std::move(disk_tier));
   } else {
     out = std::make_unique<FirstComeFirstServedTaskRunner>(std::move(iterator));
   }
@@ -164,10 +196,12 @@ void FirstComeFirstServedTaskRunner::Cancel() {
 }
 
 CachingTaskRunner::CachingTaskRunner(std::unique_ptr<TaskIterator> iterator,
-                                     size_t max_cache_size_bytes)
+                                     size_t max_cache_size_bytes,
+                                     std::unique_ptr<RingLog> disk_tier)
     : fcfs_task_runner_(std::move(iterator)),
       cache_(max_cache_size_bytes,
-             std::make_unique<GetElementResultSequence>(fcfs_task_runner_)) {
+             std::make_unique<GetElementResultSequence>(fcfs_task_runner_),
+             std::move(disk_tier)) {
   LOG(INFO) << "Initialized tf.data service cross-trainer cache with "
             << FormatBytes(max_cache_size_bytes) << " of memory.";
 }
@@ -203,6 +237,57 @@ size_t CachingTaskRunner::GetElementResultSequence::GetElementSizeBytes(
   return element.EstimatedMemoryUsageBytes();
 }
 
+// Elements are serialized as a `GetElementResponse`, the same way the worker
+// sends them to the clients.
+StatusOr<std::string>
+CachingTaskRunner::GetElementResultSequence::SerializeElement(
+    const GetElementResult& element) const {
+  GetElementResponse response;
+  response.set_element_index(element.element_index);
+  const CompressedElement* compressed = nullptr;
+  if (element.components.size() == 1 &&
+      element.components[0].dtype() == DT_VARIANT &&
+      TensorShapeUtils::IsScalar(element.components[0].shape())) {
+    compressed =
+        element.components[0].scalar<Variant>()().get<CompressedElement>();
+  }
+  if (compressed != nullptr) {
+    *response.mutable_compressed() = *compressed;
+  } else {
+    UncompressedElement* uncompressed = response.mutable_uncompressed();
+    for (const Tensor& component : element.components) {
+      component.AsProtoTensorContent(uncompressed->add_components());
+    }
+  }
+  return response.SerializeAsString();
+}
+
+StatusOr<GetElementResult>
+CachingTaskRunner::GetElementResultSequence::DeserializeElement(
+    absl::string_view serialized) const {
+  GetElementResponse response;
+  if (!response.ParseFromArray(serialized.data(), serialized.size())) {
+    return errors::DataLoss(
+        "Failed to parse an element of the cross-trainer cache.");
+  }
+  GetElementResult result;
+  result.element_index = response.element_index();
+  if (response.has_compressed()) {
+    Tensor tensor(DT_VARIANT, TensorShape{});
+    tensor.scalar<Variant>()() = std::move(*response.mutable_compressed());
+    result.components.push_back(std::move(tensor));
+    return result;
+  }
+  for (const TensorProto& component : response.uncompressed().components()) {
+    result.components.emplace_back();
+    if (!result.components.back().FromProto(component)) {
+      return errors::DataLoss(
+          "Failed to parse a tensor of the cross-trainer cache.");
+    }
+  }
+  return result;
+}
+
 void CachingTaskRunner::Cancel() {
   VLOG(2) << "Cancelling tf.data service cross-trainer cache task.";
   if (!cache_.IsCancelled()) {
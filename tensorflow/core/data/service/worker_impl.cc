@@ -14,6 +14,8 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/data/service/worker_impl.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <iterator>
 #include <memory>
 #include <string>
@@ -22,6 +24,7 @@ limitations under the License.
 
 #include "grpcpp/create_channel.h"
 #include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/memory/memory.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/string_view.h"
@@ -74,6 +77,8 @@ namespace {
 constexpr absl::Duration kRetryInterval = absl::Seconds(5);
 constexpr absl::Duration kDefaultHeartBeatInterval = absl::Seconds(30);
 constexpr absl::Duration kDefaultDispatcherTimeout = absl::Hours(1);
+// Weight of the latest element in the processing time moving average.
+constexpr double kProcessingTimeEmaWeight = 0.1;
 
 using WorkerConfig = experimental::WorkerConfig;
 
@@ -295,7 +300,17 @@ Status DataServiceWorkerImpl::GetElementResult(
     cv_.notify_all();
   });
   TF_RETURN_IF_ERROR(EnsureTaskInitialized(*task));
+  const uint64_t start_nsec = Env::Default()->NowNanos();
   TF_RETURN_IF_ERROR(task->task_runner->GetNext(*request, *result));
+  if (!result->end_of_sequence && !result->skip) {
+    const double processing_time_nsec =
+        static_cast<double>(Env::Default()->NowNanos() - start_nsec);
+    mutex_lock l(mu_);
+    double& ema = task->processing_time_nsec_ema;
+    ema = ema == 0.0 ? processing_time_nsec
+                     : (1.0 - kProcessingTimeEmaWeight) * ema +
+                           kProcessingTimeEmaWeight * processing_time_nsec;
+  }
 
   if (result->end_of_sequence) {
     mutex_lock l(mu_);
@@ -409,7 +424,8 @@ DataServiceWorkerImpl::MakeDatasetIterator(standalone::Dataset& dataset,
     for (int i = 0; i < task_def.num_split_providers(); ++i) {
       split_providers.push_back(std::make_unique<DataServiceSplitProvider>(
           config_.dispatcher_address(), config_.protocol(),
-          task_def.iteration_id(), i, config_.dispatcher_timeout_ms()));
+          task_def.iteration_id(), i, config_.dispatcher_timeout_ms(),
+          worker_address_, config_.max_prefetched_splits()));
     }
     TF_RETURN_IF_ERROR(
         dataset.MakeIterator(std::move(split_providers), &iterator));
@@ -558,10 +574,15 @@ Status DataServiceWorkerImpl::Heartbeat() {
 WorkerHeartbeatRequest DataServiceWorkerImpl::BuildWorkerHeartbeatRequest()
     const TF_LOCKS_EXCLUDED(mu_) {
   std::vector<int64_t> current_tasks;
+  absl::flat_hash_map<int64_t, int64_t> task_processing_time_nsec;
   {
     mutex_lock l(mu_);
     for (const auto& task : tasks_) {
       current_tasks.push_back(task.first);
+      if (task.second->processing_time_nsec_ema > 0.0) {
+        task_processing_time_nsec[task.first] = std::max<int64_t>(
+            1, static_cast<int64_t>(task.second->processing_time_nsec_ema));
+      }
     }
   }
 
@@ -573,6 +594,8 @@ WorkerHeartbeatRequest DataServiceWorkerImpl::BuildWorkerHeartbeatRequest()
   request.set_worker_uid(worker_uid_);
   *request.mutable_current_tasks() = {current_tasks.begin(),
                                       current_tasks.end()};
+  request.mutable_task_processing_time_nsec()->insert(
+      task_processing_time_nsec.begin(), task_processing_time_nsec.end());
   for (const auto& snapshot_task_progress : GetSnapshotTaskProgress()) {
     request.mutable_snapshot_task_progress()->insert(
         {snapshot_task_progress.snapshot_task().base_path(),
@@ -655,15 +678,17 @@ Status DataServiceWorkerImpl::UpdateSnapshotWriters(
         &dataset_def));
     TF_ASSIGN_OR_RETURN(std::unique_ptr<StandaloneTaskIterator> iterator,
                         MakeSnapshotTaskIterator(snapshot_task, dataset_def));
+    SnapshotWriterParams writer_params{
+        snapshot_task.base_path(), snapshot_task.stream_index(),
+        snapshot_task.metadata().compression(), Env::Default(),
+        config_.snapshot_max_chunk_size_bytes()};
+    writer_params.chunk_format = snapshot_task.metadata().chunk_format();
+    writer_params.compression_level =
+        snapshot_task.metadata().compression_level();
     mutex_lock l(mu_);
-    snapshot_writers_.emplace(
-        snapshot_task_key,
-        std::make_unique<SnapshotStreamWriter>(
-            SnapshotWriterParams{
-                snapshot_task.base_path(), snapshot_task.stream_index(),
-                snapshot_task.metadata().compression(), Env::Default(),
-                config_.snapshot_max_chunk_size_bytes()},
-            std::move(iterator)));
+    snapshot_writers_.emplace(snapshot_task_key,
+                              std::make_unique<SnapshotStreamWriter>(
+                                  writer_params, std::move(iterator)));
   }
 
   // Cancel writers for snapshots that are no longer assigned by the dispatcher.
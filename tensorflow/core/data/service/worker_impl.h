@@ -101,6 +101,11 @@ class DataServiceWorkerImpl {
     bool initialized TF_GUARDED_BY(mu) = false;
     int64_t outstanding_requests TF_GUARDED_BY(&DataServiceWorkerImpl::mu_) = 0;
     std::unique_ptr<TaskRunner> task_runner;
+    // Exponential moving average of the time the task takes to produce an
+    // element, reported to the dispatcher's auto-scaler. Zero until the task
+    // produces its first element.
+    double processing_time_nsec_ema
+        TF_GUARDED_BY(&DataServiceWorkerImpl::mu_) = 0.0;
   };
 
   struct SnapshotTask {
@@ -0,0 +1,272 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/shuffle_spill_buffer.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/protobuf/snapshot.pb.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+constexpr char kNumSegments[] = "spill_num_segments";
+constexpr char kSegmentFilename[] = "spill_segment_filename";
+constexpr char kSegmentNumElements[] = "spill_segment_num_elements";
+constexpr char kSegmentOffset[] = "spill_segment_offset";
+constexpr int64_t kReadBufferSize = 256 << 10;  // 256 KiB.
+
+std::string SegmentKey(const char* key, size_t i) {
+  return absl::StrCat(key, "_", i);
+}
+
+}  // namespace
+
+constexpr char ShuffleSpillBuffer::kDirectoryEnvVar[];
+constexpr char ShuffleSpillBuffer::kMaxElementsInMemoryEnvVar[];
+constexpr int64_t ShuffleSpillBuffer::kDefaultMaxElementsInMemory;
+constexpr int64_t ShuffleSpillBuffer::kDefaultSegmentBytes;
+
+ShuffleSpillBuffer::ShuffleSpillBuffer(Env* env, const std::string& directory,
+                                       int64_t capacity, int64_t segment_bytes)
+    : env_(env),
+      directory_(directory),
+      capacity_(capacity),
+      segment_bytes_(segment_bytes),
+      name_prefix_(absl::StrCat("shuffle_spill_",
+                                absl::Hex(random::New64(), absl::kZeroPad16))) {
+}
+
+ShuffleSpillBuffer::~ShuffleSpillBuffer() {
+  writer_.reset();
+  write_file_.reset();
+  if (!write_filename_.empty()) MaybeDeleteSegmentFile(write_filename_);
+  for (Segment& segment : segments_) {
+    segment.reader.reset();
+    segment.file.reset();
+    MaybeDeleteSegmentFile(segment.filename);
+  }
+}
+
+bool ShuffleSpillBuffer::ReadConfigFromEnv(std::string* directory,
+                                           int64_t* max_elements_in_memory) {
+  Status s = ReadStringFromEnvVar(kDirectoryEnvVar, "", directory);
+  if (!s.ok()) {
+    LOG(WARNING) << "Ignoring " << kDirectoryEnvVar << ": " << s;
+    return false;
+  }
+  if (directory->empty()) return false;
+  s = ReadInt64FromEnvVar(kMaxElementsInMemoryEnvVar,
+                          kDefaultMaxElementsInMemory, max_elements_in_memory);
+  if (!s.ok() || *max_elements_in_memory <= 0) {
+    LOG(WARNING) << "Ignoring " << kMaxElementsInMemoryEnvVar << ": " << s;
+    *max_elements_in_memory = kDefaultMaxElementsInMemory;
+  }
+  return true;
+}
+
+Status ShuffleSpillBuffer::Push(const std::vector<Tensor>& element) {
+  if (writer_ == nullptr) {
+    TF_RETURN_IF_ERROR(env_->RecursivelyCreateDir(directory_));
+    write_filename_ = io::JoinPath(
+        directory_, absl::StrCat(name_prefix_, "_", next_segment_index_++));
+    TF_RETURN_IF_ERROR(env_->NewWritableFile(write_filename_, &write_file_));
+    writer_ = std::make_unique<io::RecordWriter>(write_file_.get());
+    write_num_elements_ = 0;
+    write_bytes_ = 0;
+  }
+  experimental::SnapshotRecord record;
+  for (const Tensor& t : element) {
+    t.AsProtoTensorContent(record.add_tensor());
+  }
+  std::string serialized;
+  if (!record.SerializeToString(&serialized)) {
+    return errors::DataLoss("Could not serialize a shuffle buffer element to ",
+                            write_filename_);
+  }
+  TF_RETURN_IF_ERROR(writer_->WriteRecord(serialized));
+  write_num_elements_++;
+  write_bytes_ += serialized.size();
+  size_++;
+  if (write_bytes_ >= segment_bytes_) {
+    TF_RETURN_IF_ERROR(SealWriteSegment());
+  }
+  return OkStatus();
+}
+
+Status ShuffleSpillBuffer::Pop(uint64_t random, std::vector<Tensor>* element) {
+  if (empty()) {
+    return errors::FailedPrecondition("The shuffle spill buffer is empty");
+  }
+  if (size_ == write_num_elements_) {
+    // All elements are in the segment being written.
+    TF_RETURN_IF_ERROR(SealWriteSegment());
+  }
+  // Draw a segment with probability proportional to its remaining elements.
+  int64_t target = random % (size_ - write_num_elements_);
+  auto it = segments_.begin();
+  while (target >= it->num_elements) {
+    target -= it->num_elements;
+    ++it;
+  }
+  Segment& segment = *it;
+  if (segment.reader == nullptr) {
+    TF_RETURN_IF_ERROR(OpenSegment(&segment));
+  }
+  tstring serialized;
+  TF_RETURN_IF_ERROR(segment.reader->ReadRecord(&segment.offset, &serialized));
+  experimental::SnapshotRecord record;
+  if (!record.ParseFromArray(serialized.data(), serialized.size())) {
+    return errors::DataLoss("Could not parse a shuffle buffer element from ",
+                            segment.filename);
+  }
+  element->clear();
+  element->reserve(record.tensor_size());
+  for (const TensorProto& proto : record.tensor()) {
+    element->emplace_back();
+    if (!element->back().FromProto(cpu_allocator(), proto)) {
+      return errors::DataLoss("Could not parse a shuffle buffer tensor from ",
+                              segment.filename);
+    }
+  }
+  segment.num_elements--;
+  size_--;
+  if (segment.num_elements == 0) {
+    const std::string filename = segment.filename;
+    segments_.erase(it);
+    if (saved_segments_.contains(filename)) {
+      consumed_segments_.push_back(filename);
+    } else {
+      env_->DeleteFile(filename).IgnoreError();
+    }
+  }
+  return OkStatus();
+}
+
+Status ShuffleSpillBuffer::Save(const std::string& prefix,
+                                IteratorStateWriter* writer) {
+  TF_RETURN_IF_ERROR(SealWriteSegment());
+  TF_RETURN_IF_ERROR(writer->WriteScalar(prefix, kNumSegments,
+                                         static_cast<int64_t>(segments_.size())));
+  for (size_t i = 0; i < segments_.size(); ++i) {
+    const Segment& segment = segments_[i];
+    TF_RETURN_IF_ERROR(writer->WriteScalar(
+        prefix, SegmentKey(kSegmentFilename, i), segment.filename));
+    TF_RETURN_IF_ERROR(writer->WriteScalar(
+        prefix, SegmentKey(kSegmentNumElements, i), segment.num_elements));
+    TF_RETURN_IF_ERROR(
+        writer->WriteScalar(prefix, SegmentKey(kSegmentOffset, i),
+                            static_cast<int64_t>(segment.offset)));
+  }
+  // Only the most recent checkpoint can be restored from.
+  for (const std::string& filename : consumed_segments_) {
+    env_->DeleteFile(filename).IgnoreError();
+  }
+  consumed_segments_.clear();
+  saved_segments_.clear();
+  for (const Segment& segment : segments_) {
+    saved_segments_.insert(segment.filename);
+  }
+  return OkStatus();
+}
+
+Status ShuffleSpillBuffer::Restore(const std::string& prefix,
+                                   IteratorStateReader* reader) {
+  writer_.reset();
+  write_file_.reset();
+  if (!write_filename_.empty()) MaybeDeleteSegmentFile(write_filename_);
+  write_filename_.clear();
+  write_num_elements_ = 0;
+  for (Segment& segment : segments_) {
+    segment.reader.reset();
+    segment.file.reset();
+    MaybeDeleteSegmentFile(segment.filename);
+  }
+  segments_.clear();
+  saved_segments_.clear();
+  consumed_segments_.clear();
+  size_ = 0;
+
+  int64_t num_segments;
+  TF_RETURN_IF_ERROR(reader->ReadScalar(prefix, kNumSegments, &num_segments));
+  for (int64_t i = 0; i < num_segments; ++i) {
+    Segment segment;
+    tstring filename;
+    TF_RETURN_IF_ERROR(
+        reader->ReadScalar(prefix, SegmentKey(kSegmentFilename, i), &filename));
+    segment.filename = filename;
+    TF_RETURN_IF_ERROR(reader->ReadScalar(
+        prefix, SegmentKey(kSegmentNumElements, i), &segment.num_elements));
+    int64_t offset;
+    TF_RETURN_IF_ERROR(
+        reader->ReadScalar(prefix, SegmentKey(kSegmentOffset, i), &offset));
+    segment.offset = offset;
+    Status s = env_->FileExists(segment.filename);
+    if (!s.ok()) {
+      return errors::FailedPrecondition(
+          "Could not restore the shuffle buffer: its spill segment ",
+          segment.filename, " is missing: ", s);
+    }
+    size_ += segment.num_elements;
+    saved_segments_.insert(segment.filename);
+    segments_.push_back(std::move(segment));
+  }
+  return OkStatus();
+}
+
+Status ShuffleSpillBuffer::OpenSegment(Segment* segment) {
+  TF_RETURN_IF_ERROR(env_->NewRandomAccessFile(segment->filename,
+                                               &segment->file));
+  io::RecordReaderOptions options;
+  options.buffer_size = kReadBufferSize;
+  segment->reader =
+      std::make_unique<io::RecordReader>(segment->file.get(), options);
+  return OkStatus();
+}
+
+Status ShuffleSpillBuffer::SealWriteSegment() {
+  if (writer_ == nullptr) return OkStatus();
+  TF_RETURN_IF_ERROR(writer_->Close());
+  TF_RETURN_IF_ERROR(write_file_->Close());
+  writer_.reset();
+  write_file_.reset();
+  Segment segment;
+  segment.filename = std::move(write_filename_);
+  segment.num_elements = write_num_elements_;
+  segments_.push_back(std::move(segment));
+  write_filename_.clear();
+  write_num_elements_ = 0;
+  write_bytes_ = 0;
+  return OkStatus();
+}
+
+void ShuffleSpillBuffer::MaybeDeleteSegmentFile(const std::string& filename) {
+  if (saved_segments_.contains(filename)) return;
+  env_->DeleteFile(filename).IgnoreError();
+}
+
+}  // namespace data
+}  // namespace tensorflow
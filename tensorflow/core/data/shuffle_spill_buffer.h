@@ -0,0 +1,135 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_SHUFFLE_SPILL_BUFFER_H_
+#define TENSORFLOW_CORE_DATA_SHUFFLE_SPILL_BUFFER_H_
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/io/record_reader.h"
+#include "tensorflow/core/lib/io/record_writer.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/status.h"
+
+namespace tensorflow {
+namespace data {
+
+// The on-disk tier of a shuffle buffer that is larger than host memory.
+//
+// Elements are appended to sequential segment files. Once a segment is
+// sealed, it is read back sequentially, and `Pop()` draws from the sealed
+// segments at random in proportion to the number of elements they have left.
+// The output is thus a random interleaving of the segments, which a shuffle
+// dataset feeds into its in-memory buffer.
+//
+// Checkpoints only record the segment names and read offsets, so the
+// segment files referenced by the most recent `Save()` are kept on disk when
+// the buffer is destroyed, for a restored buffer to adopt. Other segment files
+// are deleted once they are consumed or when the buffer is destroyed.
+//
+// This class is not thread-safe.
+class ShuffleSpillBuffer {
+ public:
+  // Name of the environment variable that enables spilling and sets the
+  // directory of the segment files.
+  static constexpr char kDirectoryEnvVar[] = "TF_DATA_SHUFFLE_SPILL_DIR";
+  // Name of the environment variable that sets the number of buffered
+  // elements kept in memory when spilling is enabled.
+  static constexpr char kMaxElementsInMemoryEnvVar[] =
+      "TF_DATA_SHUFFLE_MAX_ELEMENTS_IN_MEMORY";
+  static constexpr int64_t kDefaultMaxElementsInMemory = 100000;
+  static constexpr int64_t kDefaultSegmentBytes = 64 << 20;  // 64 MiB.
+
+  // Creates a buffer holding up to `capacity` elements in segments of about
+  // `segment_bytes` under `directory`.
+  ShuffleSpillBuffer(Env* env, const std::string& directory, int64_t capacity,
+                     int64_t segment_bytes = kDefaultSegmentBytes);
+  ~ShuffleSpillBuffer();
+
+  ShuffleSpillBuffer(const ShuffleSpillBuffer&) = delete;
+  ShuffleSpillBuffer& operator=(const ShuffleSpillBuffer&) = delete;
+
+  // Reads the spill directory and the number of elements to keep in memory
+  // from the environment. Returns false if spilling is disabled.
+  static bool ReadConfigFromEnv(std::string* directory,
+                                int64_t* max_elements_in_memory);
+
+  int64_t size() const { return size_; }
+  int64_t capacity() const { return capacity_; }
+  bool empty() const { return size_ == 0; }
+  bool full() const { return size_ >= capacity_; }
+  const std::string& directory() const { return directory_; }
+
+  // Appends `element` to the segment being written.
+  Status Push(const std::vector<Tensor>& element);
+
+  // Removes an element from a sealed segment chosen using `random` and stores
+  // it in `element`. Requires `!empty()`.
+  Status Pop(uint64_t random, std::vector<Tensor>* element);
+
+  // Saves the segment names and read offsets under `prefix`. Seals the
+  // segment being written.
+  Status Save(const std::string& prefix, IteratorStateWriter* writer);
+
+  // Replaces the contents of this buffer with the segments saved under
+  // `prefix`.
+  Status Restore(const std::string& prefix, IteratorStateReader* reader);
+
+ private:
+  struct Segment {
+    std::string filename;
+    int64_t num_elements = 0;
+    uint64_t offset = 0;
+    std::unique_ptr<RandomAccessFile> file;
+    std::unique_ptr<io::RecordReader> reader;
+  };
+
+  Status OpenSegment(Segment* segment);
+  Status SealWriteSegment();
+  // Deletes `filename` unless the most recent checkpoint references it.
+  void MaybeDeleteSegmentFile(const std::string& filename);
+
+  Env* const env_;
+  std::string directory_;
+  const int64_t capacity_;
+  const int64_t segment_bytes_;
+  // Unique prefix of the names of the segment files written by this buffer.
+  const std::string name_prefix_;
+  int64_t next_segment_index_ = 0;
+  int64_t size_ = 0;
+  // Sealed segments that have elements left.
+  std::deque<Segment> segments_;
+  // The segment being written, if any.
+  std::string write_filename_;
+  int64_t write_num_elements_ = 0;
+  int64_t write_bytes_ = 0;
+  std::unique_ptr<WritableFile> write_file_;
+  std::unique_ptr<io::RecordWriter> writer_;
+  // Segments referenced by the most recent checkpoint.
+  absl::flat_hash_set<std::string> saved_segments_;
+  // Consumed segments that the most recent checkpoint still references.
+  std::vector<std::string> consumed_segments_;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SHUFFLE_SPILL_BUFFER_H_
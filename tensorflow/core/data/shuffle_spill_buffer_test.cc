@@ -0,0 +1,144 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/shuffle_spill_buffer.h"
+
+#include <algorithm>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/data/serialization_utils.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+std::string TestDir() {
+  return io::JoinPath(
+      testing::TmpDir(),
+      ::testing::UnitTest::GetInstance()->current_test_info()->name());
+}
+
+int NumFiles(const std::string& dir) {
+  std::vector<string> children;
+  if (!Env::Default()->GetChildren(dir, &children).ok()) return 0;
+  return children.size();
+}
+
+std::vector<int64_t> Drain(ShuffleSpillBuffer* buffer, uint64_t random) {
+  std::vector<int64_t> values;
+  while (!buffer->empty()) {
+    std::vector<Tensor> element;
+    TF_CHECK_OK(buffer->Pop(random++, &element));
+    CHECK_EQ(element.size(), 2);
+    CHECK_EQ(element[1].scalar<tstring>()(), "x");
+    values.push_back(element[0].scalar<int64_t>()());
+  }
+  return values;
+}
+
+TEST(ShuffleSpillBufferTest, InterleavesSegments) {
+  const std::string dir = TestDir();
+  ShuffleSpillBuffer buffer(Env::Default(), dir, /*capacity=*/20,
+                            /*segment_bytes=*/1);
+  for (int64_t i = 0; i < 20; ++i) {
+    EXPECT_FALSE(buffer.full());
+    TF_ASSERT_OK(buffer.Push(
+        {test::AsScalar<int64_t>(i), test::AsScalar<tstring>("x")}));
+  }
+  EXPECT_TRUE(buffer.full());
+  // Every element went into a segment of its own.
+  EXPECT_EQ(NumFiles(dir), 20);
+
+  std::vector<int64_t> values = Drain(&buffer, /*random=*/7);
+  ASSERT_EQ(values.size(), 20);
+  std::vector<int64_t> sorted = values;
+  std::sort(sorted.begin(), sorted.end());
+  for (int64_t i = 0; i < 20; ++i) EXPECT_EQ(sorted[i], i);
+  EXPECT_NE(values, sorted);
+  // Consumed segments are deleted.
+  EXPECT_EQ(NumFiles(dir), 0);
+}
+
+TEST(ShuffleSpillBufferTest, SegmentsAreReadSequentially) {
+  ShuffleSpillBuffer buffer(Env::Default(), TestDir(), /*capacity=*/10);
+  for (int64_t i = 0; i < 10; ++i) {
+    TF_ASSERT_OK(buffer.Push(
+        {test::AsScalar<int64_t>(i), test::AsScalar<tstring>("x")}));
+  }
+  // A single segment comes out in order.
+  std::vector<int64_t> values = Drain(&buffer, /*random=*/3);
+  std::vector<int64_t> expected(10);
+  std::iota(expected.begin(), expected.end(), 0);
+  EXPECT_EQ(values, expected);
+}
+
+TEST(ShuffleSpillBufferTest, SaveAndRestore) {
+  const std::string dir = TestDir();
+  std::vector<int64_t> expected;
+  VariantTensorDataWriter writer;
+  {
+    ShuffleSpillBuffer buffer(Env::Default(), dir, /*capacity=*/12,
+                              /*segment_bytes=*/32);
+    for (int64_t i = 0; i < 12; ++i) {
+      TF_ASSERT_OK(buffer.Push(
+          {test::AsScalar<int64_t>(i), test::AsScalar<tstring>("x")}));
+    }
+    std::vector<Tensor> element;
+    TF_ASSERT_OK(buffer.Pop(/*random=*/5, &element));
+    TF_ASSERT_OK(buffer.Save("spill", &writer));
+    // The original buffer can keep going without breaking the checkpoint.
+    expected = Drain(&buffer, /*random=*/11);
+  }
+  EXPECT_GT(NumFiles(dir), 0);
+
+  std::vector<const VariantTensorData*> data;
+  writer.GetData(&data);
+  VariantTensorDataReader reader(data);
+  ShuffleSpillBuffer restored(Env::Default(), dir, /*capacity=*/12);
+  TF_ASSERT_OK(restored.Restore("spill", &reader));
+  EXPECT_EQ(restored.size(), 11);
+  EXPECT_EQ(Drain(&restored, /*random=*/11), expected);
+}
+
+TEST(ShuffleSpillBufferTest, RestoreWithMissingSegment) {
+  const std::string dir = TestDir();
+  VariantTensorDataWriter writer;
+  {
+    ShuffleSpillBuffer buffer(Env::Default(), dir, /*capacity=*/1);
+    TF_ASSERT_OK(buffer.Push(
+        {test::AsScalar<int64_t>(0), test::AsScalar<tstring>("x")}));
+    TF_ASSERT_OK(buffer.Save("spill", &writer));
+  }
+  int64_t undeleted_files, undeleted_dirs;
+  TF_ASSERT_OK(Env::Default()->DeleteRecursively(dir, &undeleted_files,
+                                                 &undeleted_dirs));
+
+  std::vector<const VariantTensorData*> data;
+  writer.GetData(&data);
+  VariantTensorDataReader reader(data);
+  ShuffleSpillBuffer restored(Env::Default(), dir, /*capacity=*/1);
+  EXPECT_EQ(restored.Restore("spill", &reader).code(),
+            absl::StatusCode::kFailedPrecondition);
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
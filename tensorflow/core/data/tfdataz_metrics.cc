@@ -22,8 +22,12 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/time/time.h"
+#include "tensorflow/core/framework/metrics.h"
+#include "tensorflow/core/framework/model.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
 
 namespace tensorflow {
 namespace data {
@@ -91,15 +95,169 @@ absl::Duration ApproximateLatencyEstimator::GetAverageLatency(Duration duration)
   return absl::Duration(absl::Microseconds(interval_latency)) / interval_count;
 }
 
+int64_t ApproximateLatencyEstimator::GetCount(Duration duration)
+    TF_LOCKS_EXCLUDED(mu_) {
+  UpdateRingBuffer();
+
+  mutex_lock l(mu_);
+  return latency_count_counter_ -
+         latency_count_[PrevSlot(static_cast<int>(duration))];
+}
+
+namespace {
+
+constexpr char kProducer[] = "producer";
+constexpr char kConsumer[] = "consumer";
+
+// Returns the buffer utilization of `node`, or a negative value if the node
+// does not buffer elements.
+double BufferUtilization(const model::Node& node) {
+  StatusOr<double> buffer_size = node.ParameterValue(model::kBufferSize);
+  if (!buffer_size.ok() && node.IsAsync()) {
+    buffer_size = node.ParameterValue(model::kParallelism);
+  }
+  if (!buffer_size.ok() || *buffer_size <= 0) {
+    return -1.0;
+  }
+  return static_cast<double>(node.buffered_elements()) / *buffer_size;
+}
+
+NodeMetricsSampler::LatencySummary Summarize(
+    const histogram::Histogram& histogram, int64_t count) {
+  NodeMetricsSampler::LatencySummary summary;
+  summary.count = count;
+  if (count > 0) {
+    summary.average_usec = histogram.Average();
+    summary.p50_usec = histogram.Median();
+    summary.p90_usec = histogram.Percentile(90.0);
+    summary.p99_usec = histogram.Percentile(99.0);
+  }
+  return summary;
+}
+
+}  // namespace
+
+NodeMetricsSampler::NodeMetricsSampler(const Env& env)
+    : env_(env),
+      next_sample_time_usec_(
+          env.NowMicros() + absl::ToInt64Microseconds(kSamplingInterval)) {}
+
+bool NodeMetricsSampler::ShouldSample() {
+  const int64_t now_usec = env_.NowMicros();
+  int64_t next_sample_time_usec =
+      next_sample_time_usec_.load(std::memory_order_relaxed);
+  if (now_usec < next_sample_time_usec) {
+    return false;
+  }
+  // Only one of the concurrent callers gets to sample.
+  return next_sample_time_usec_.compare_exchange_strong(
+      next_sample_time_usec,
+      now_usec + absl::ToInt64Microseconds(kSamplingInterval),
+      std::memory_order_relaxed);
+}
+
+void NodeMetricsSampler::Sample(std::shared_ptr<model::Node> root)
+    TF_LOCKS_EXCLUDED(mu_) {
+  if (root == nullptr) {
+    return;
+  }
+  // The timing is computed outside of `mu_` since it locks every node.
+  model::ModelTiming model_timing(root);
+  model::Node::NodeVector nodes = root->CollectNodes(
+      model::TraversalOrder::BFS,
+      [](const std::shared_ptr<model::Node>) { return true; });
+  nodes.insert(nodes.begin(), root);
+
+  mutex_lock l(mu_);
+  absl::flat_hash_map<int64_t, std::unique_ptr<NodeState>> sampled_nodes;
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    const model::Node& node = *nodes[i];
+    auto it = nodes_.find(node.id());
+    std::unique_ptr<NodeState> state;
+    if (it != nodes_.end()) {
+      state = std::move(it->second);
+    } else {
+      state = std::make_unique<NodeState>();
+      state->name = node.name();
+      state->long_name = node.long_name();
+    }
+    state->bfs_index = i;
+
+    const int64_t processing_time_nsec = node.processing_time();
+    const int64_t num_elements = node.num_elements();
+    if (num_elements > state->num_elements &&
+        processing_time_nsec >= state->processing_time_nsec) {
+      const double producer_latency_usec =
+          static_cast<double>(processing_time_nsec -
+                              state->processing_time_nsec) /
+          (num_elements - state->num_elements) / EnvTime::kMicrosToNanos;
+      state->producer_latency_usec.Add(producer_latency_usec);
+      ++state->producer_latency_count;
+      metrics::RecordTFDataNodeLatency(state->name, kProducer,
+                                       producer_latency_usec);
+    }
+    state->processing_time_nsec = processing_time_nsec;
+    state->num_elements = num_elements;
+
+    const model::ModelTiming::NodeTiming* timing =
+        model_timing.GetTiming(&node);
+    if (timing != nullptr && timing->total_time_nsec > 0.0) {
+      const double consumer_latency_usec =
+          timing->total_time_nsec / EnvTime::kMicrosToNanos;
+      state->consumer_latency_usec.Add(consumer_latency_usec);
+      ++state->consumer_latency_count;
+      metrics::RecordTFDataNodeLatency(state->name, kConsumer,
+                                       consumer_latency_usec);
+    }
+
+    const double buffer_utilization = BufferUtilization(node);
+    if (buffer_utilization >= 0.0) {
+      state->buffer_utilization.push_back(buffer_utilization);
+      if (state->buffer_utilization.size() > kMaxBufferUtilizationSamples) {
+        state->buffer_utilization.pop_front();
+      }
+      metrics::RecordTFDataNodeBufferUtilization(state->name,
+                                                 buffer_utilization);
+    }
+    sampled_nodes[node.id()] = std::move(state);
+  }
+  nodes_ = std::move(sampled_nodes);
+}
+
+std::vector<NodeMetricsSampler::NodeMetrics>
+NodeMetricsSampler::GetNodeMetrics() TF_LOCKS_EXCLUDED(mu_) {
+  mutex_lock l(mu_);
+  std::vector<NodeMetrics> node_metrics(nodes_.size());
+  for (const auto& [id, state] : nodes_) {
+    NodeMetrics& metrics = node_metrics[state->bfs_index];
+    metrics.name = state->long_name;
+    metrics.producer_latency = Summarize(state->producer_latency_usec,
+                                         state->producer_latency_count);
+    metrics.consumer_latency = Summarize(state->consumer_latency_usec,
+                                         state->consumer_latency_count);
+    metrics.buffer_utilization.assign(state->buffer_utilization.begin(),
+                                      state->buffer_utilization.end());
+  }
+  return node_metrics;
+}
+
 TfDatazMetricsCollector::TfDatazMetricsCollector(const Env& env,
                                                  IteratorBase* iterator)
-    : iterator_(iterator), latency_estimator_(env) {}
+    : iterator_(iterator),
+      latency_estimator_(env),
+      node_metrics_sampler_(env) {}
 
 void TfDatazMetricsCollector::RecordGetNextLatency(
     int64_t get_next_latency_usec) {
   if (get_next_latency_usec > 0) {
     latency_estimator_.AddLatency(get_next_latency_usec);
   }
+  if (iterator_ != nullptr && node_metrics_sampler_.ShouldSample()) {
+    std::shared_ptr<model::Model> model = iterator_->model();
+    if (model != nullptr) {
+      node_metrics_sampler_.Sample(model->output());
+    }
+  }
 }
 
 absl::Duration TfDatazMetricsCollector::GetAverageLatencyForLastOneMinute() {
@@ -121,6 +279,21 @@ int64_t TfDatazMetricsCollector::GetIteratorTotalMemoryUsage() {
   return iterator_->TotalBufferedBytes();
 }
 
+int TfDatazMetricsCollector::GetNumaNode() {
+  return iterator_ == nullptr ? port::kNUMANoAffinity : iterator_->NumaNode();
+}
+
+double TfDatazMetricsCollector::GetThroughputForLastOneMinute() {
+  return static_cast<double>(latency_estimator_.GetCount(
+             ApproximateLatencyEstimator::Duration::kMinute)) /
+         absl::ToDoubleSeconds(absl::Minutes(1));
+}
+
+std::vector<NodeMetricsSampler::NodeMetrics>
+TfDatazMetricsCollector::GetNodeMetrics() {
+  return node_metrics_sampler_.GetNodeMetrics();
+}
+
 namespace {
 static mutex* get_tfdataz_metrics_registry_lock() {
   static mutex tfdataz_metrics_registry_lock(LINKER_INITIALIZED);
@@ -153,5 +326,15 @@ TfDatazMetricsRegistry::GetIteratorMetricCollectors() {
   return tfdataz_metric_collectors();
 }
 
+absl::flat_hash_map<int, double>
+TfDatazMetricsRegistry::GetThroughputPerNumaNode() {
+  absl::flat_hash_map<int, double> throughput;
+  for (const auto& collector : GetIteratorMetricCollectors()) {
+    throughput[collector->GetNumaNode()] +=
+        collector->GetThroughputForLastOneMinute();
+  }
+  return throughput;
+}
+
 }  // namespace data
 }  // namespace tensorflow
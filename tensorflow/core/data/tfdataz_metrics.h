@@ -15,6 +15,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DATA_TFDATAZ_METRICS_H_
 #define TENSORFLOW_CORE_DATA_TFDATAZ_METRICS_H_
 
+#include <atomic>
 #include <cstdint>
 #include <deque>
 #include <memory>
@@ -23,9 +24,12 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/time/time.h"
 #include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/model.h"
+#include "tensorflow/core/lib/histogram/histogram.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/thread_annotations.h"
@@ -53,6 +57,10 @@ class ApproximateLatencyEstimator {
   // specified.
   absl::Duration GetAverageLatency(Duration duration);
 
+  // Returns the number of latencies recorded in the duration (1, 5 and 60
+  // minutes) specified.
+  int64_t GetCount(Duration duration);
+
  private:
   static constexpr int64_t kSecondsPerMinute = 60;
   static constexpr int64_t kMinutesPerHour = 60;
@@ -89,6 +97,82 @@ class ApproximateLatencyEstimator {
   int64_t latency_count_[kSlots] TF_GUARDED_BY(mu_);
 };
 
+// Periodically samples the latency and buffer utilization of the nodes of a
+// tf.data performance model, so that a stalled input pipeline can be traced to
+// the responsible transformation without profiling it.
+//
+// Every `kSamplingInterval`, the sampler computes for each node:
+// - the producer latency: the processing time the node itself spent per
+//   element it produced since the previous sample,
+// - the consumer latency: the time the node and its inputs take to produce an
+//   element, as estimated by `model::ModelTiming`,
+// - the buffer utilization: the number of elements the node buffers relative
+//   to its buffer size, or to its parallelism if it has no buffer size.
+// The latencies are added to per-node histograms, and the buffer utilizations
+// to per-node time series of the last `kMaxBufferUtilizationSamples` samples.
+// The samples are also exported to the monitoring collection registry through
+// the /tensorflow/data/node_latency and
+// /tensorflow/data/node_buffer_utilization metrics.
+class NodeMetricsSampler {
+ public:
+  static constexpr absl::Duration kSamplingInterval = absl::Seconds(10);
+  static constexpr int64_t kMaxBufferUtilizationSamples = 60;
+
+  struct LatencySummary {
+    int64_t count = 0;
+    double average_usec = 0.0;
+    double p50_usec = 0.0;
+    double p90_usec = 0.0;
+    double p99_usec = 0.0;
+  };
+
+  struct NodeMetrics {
+    // The long name of the node, e.g. "ParallelMapV2(id:3)".
+    std::string name;
+    LatencySummary producer_latency;
+    LatencySummary consumer_latency;
+    // Buffer utilization samples, from the oldest to the newest. Empty if the
+    // node does not buffer elements.
+    std::vector<double> buffer_utilization;
+  };
+
+  explicit NodeMetricsSampler(const Env& env);
+
+  // Returns true if `kSamplingInterval` has elapsed since the last sample. In
+  // that case, the caller is expected to call `Sample`. This is cheap enough
+  // to be called for every element.
+  bool ShouldSample();
+
+  // Samples the model subtree rooted at `root`. Nodes which are not in the
+  // subtree anymore are dropped.
+  void Sample(std::shared_ptr<model::Node> root) TF_LOCKS_EXCLUDED(mu_);
+
+  // Returns the metrics of the nodes seen in the last sample, in BFS order.
+  std::vector<NodeMetrics> GetNodeMetrics() TF_LOCKS_EXCLUDED(mu_);
+
+ private:
+  struct NodeState {
+    std::string name;
+    std::string long_name;
+    int64_t bfs_index = 0;
+    int64_t processing_time_nsec = 0;
+    int64_t num_elements = 0;
+    histogram::Histogram producer_latency_usec;
+    int64_t producer_latency_count = 0;
+    histogram::Histogram consumer_latency_usec;
+    int64_t consumer_latency_count = 0;
+    std::deque<double> buffer_utilization;
+  };
+
+  const Env& env_;
+  std::atomic<int64_t> next_sample_time_usec_;
+
+  mutex mu_;
+  // Sampled nodes, keyed by node ID.
+  absl::flat_hash_map<int64_t, std::unique_ptr<NodeState>> nodes_
+      TF_GUARDED_BY(mu_);
+};
+
 // Collects and exports the tf.data performance metrics to /tfdataz.
 class TfDatazMetricsCollector {
  public:
@@ -98,7 +182,8 @@ class TfDatazMetricsCollector {
   // iterator mechanism.
   TfDatazMetricsCollector(const Env& env, IteratorBase* iterator);
 
-  // Records `GetNext` call latency.
+  // Records `GetNext` call latency. Also samples the node metrics of the
+  // iterator's performance model when they are due.
   void RecordGetNextLatency(int64_t get_next_latency_usec);
 
   // Returns the average `GetNext` latency for past 1 minute.
@@ -115,9 +200,23 @@ class TfDatazMetricsCollector {
   // buffered in all nodes in the subtree.
   int64_t GetIteratorTotalMemoryUsage();
 
+  // Returns the NUMA node the iterator is pinned to, or
+  // `port::kNUMANoAffinity` if it is not pinned.
+  int GetNumaNode();
+
+  // Returns the average number of elements produced per second in the past 1
+  // minute.
+  double GetThroughputForLastOneMinute();
+
+  // Returns the sampled latency and buffer utilization metrics of the nodes
+  // of the iterator's performance model. Empty if the iterator is not
+  // autotuned.
+  std::vector<NodeMetricsSampler::NodeMetrics> GetNodeMetrics();
+
  private:
   IteratorBase* iterator_;  // not owned
   ApproximateLatencyEstimator latency_estimator_;
+  NodeMetricsSampler node_metrics_sampler_;
 };
 
 // Thread-safe global registry for the /tfdataz metrics. All callers to
@@ -136,6 +235,12 @@ class TfDatazMetricsRegistry {
   // Returns all the registered `TfDatazMetricsCollector`s.
   static absl::flat_hash_set<std::shared_ptr<TfDatazMetricsCollector>>
   GetIteratorMetricCollectors();
+
+  // Returns the total number of elements produced per second in the past 1
+  // minute by the registered iterators, keyed by the NUMA node they are pinned
+  // to. Iterators that are not pinned are reported under
+  // `port::kNUMANoAffinity`.
+  static absl::flat_hash_map<int, double> GetThroughputPerNumaNode();
 };
 
 }  // namespace data
@@ -16,9 +16,11 @@ limitations under the License.
 
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "absl/time/time.h"
 #include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/model.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/util/fake_clock_env.h"
@@ -27,6 +29,8 @@ namespace tensorflow {
 namespace data {
 namespace {
 
+using ::testing::ElementsAre;
+
 static int64_t k1MinutesInMicros = absl::ToInt64Microseconds(absl::Minutes(1));
 static int64_t k2MinutesInMicros = absl::ToInt64Microseconds(absl::Minutes(2));
 static int64_t k5MinutesInMicros = absl::ToInt64Microseconds(absl::Minutes(5));
@@ -167,6 +171,18 @@ TEST_F(TfDatazMetricsTest, GetMultipleAverageLatencies) {
                   5.0);
 }
 
+TEST_F(TfDatazMetricsTest, GetThroughputForLastOneMinute) {
+  tfdataz_metrics_->RecordGetNextLatency(1);
+  env_->AdvanceByMicroseconds(k2MinutesInMicros);
+  for (int i = 0; i < 120; ++i) {
+    tfdataz_metrics_->RecordGetNextLatency(1);
+  }
+
+  EXPECT_FLOAT_EQ(tfdataz_metrics_->GetThroughputForLastOneMinute(), 2.0);
+  env_->AdvanceByMicroseconds(k2MinutesInMicros);
+  EXPECT_FLOAT_EQ(tfdataz_metrics_->GetThroughputForLastOneMinute(), 0.0);
+}
+
 TEST_F(TfDatazMetricsTest, GetAverageLatencyWithZeroGetNextCalls) {
   EXPECT_FLOAT_EQ(absl::ToDoubleMicroseconds(
                       tfdataz_metrics_->GetAverageLatencyForLastOneMinute()),
@@ -179,6 +195,110 @@ TEST_F(TfDatazMetricsTest, GetAverageLatencyWithZeroGetNextCalls) {
                   0);
 }
 
+TEST_F(TfDatazMetricsTest, GetNodeMetricsWithoutModel) {
+  env_->AdvanceByMicroseconds(k1MinutesInMicros);
+  tfdataz_metrics_->RecordGetNextLatency(1);
+  EXPECT_TRUE(tfdataz_metrics_->GetNodeMetrics().empty());
+}
+
+TEST(NodeMetricsSamplerTest, ShouldSample) {
+  FakeClockEnv env(Env::Default());
+  NodeMetricsSampler sampler(env);
+  EXPECT_FALSE(sampler.ShouldSample());
+  env.AdvanceByMicroseconds(
+      absl::ToInt64Microseconds(NodeMetricsSampler::kSamplingInterval));
+  EXPECT_TRUE(sampler.ShouldSample());
+  EXPECT_FALSE(sampler.ShouldSample());
+  env.AdvanceByMicroseconds(k1MinutesInMicros);
+  EXPECT_TRUE(sampler.ShouldSample());
+}
+
+TEST(NodeMetricsSamplerTest, Latency) {
+  std::shared_ptr<model::Node> map =
+      model::MakeKnownRatioNode({1, "Map", nullptr}, /*ratio=*/1);
+  std::shared_ptr<model::Node> source =
+      model::MakeSourceNode({2, "TFRecord", map});
+  map->add_input(source);
+  source->add_processing_time(4000);
+  source->record_element();
+  map->add_processing_time(2000);
+  map->record_element();
+
+  FakeClockEnv env(Env::Default());
+  NodeMetricsSampler sampler(env);
+  sampler.Sample(map);
+  std::vector<NodeMetricsSampler::NodeMetrics> node_metrics =
+      sampler.GetNodeMetrics();
+  ASSERT_EQ(node_metrics.size(), 2);
+  EXPECT_EQ(node_metrics[0].name, "Map(id:1)");
+  EXPECT_EQ(node_metrics[0].producer_latency.count, 1);
+  EXPECT_DOUBLE_EQ(node_metrics[0].producer_latency.average_usec, 2.0);
+  EXPECT_EQ(node_metrics[0].consumer_latency.count, 1);
+  EXPECT_DOUBLE_EQ(node_metrics[0].consumer_latency.average_usec, 6.0);
+  EXPECT_TRUE(node_metrics[0].buffer_utilization.empty());
+  EXPECT_EQ(node_metrics[1].name, "TFRecord(id:2)");
+  EXPECT_DOUBLE_EQ(node_metrics[1].producer_latency.average_usec, 4.0);
+  EXPECT_DOUBLE_EQ(node_metrics[1].consumer_latency.average_usec, 4.0);
+
+  // Only the elements produced since the last sample count towards the
+  // producer latency.
+  map->add_processing_time(12000);
+  map->record_element();
+  map->record_element();
+  map->record_element();
+  sampler.Sample(map);
+  node_metrics = sampler.GetNodeMetrics();
+  ASSERT_EQ(node_metrics.size(), 2);
+  EXPECT_EQ(node_metrics[0].producer_latency.count, 2);
+  EXPECT_DOUBLE_EQ(node_metrics[0].producer_latency.average_usec, 3.0);
+  // The source did not produce any element.
+  EXPECT_EQ(node_metrics[1].producer_latency.count, 1);
+
+  map->remove_input(source);
+  sampler.Sample(map);
+  node_metrics = sampler.GetNodeMetrics();
+  ASSERT_EQ(node_metrics.size(), 1);
+  EXPECT_EQ(node_metrics[0].name, "Map(id:1)");
+}
+
+TEST(NodeMetricsSamplerTest, BufferUtilization) {
+  std::shared_ptr<model::Node> prefetch = model::MakeAsyncKnownRatioNode(
+      {1, "Prefetch", nullptr}, /*ratio=*/1,
+      {model::MakeParameter(model::kBufferSize,
+                            std::make_shared<model::SharedState>(
+                                /*value=*/4, nullptr, nullptr),
+                            /*min=*/1, /*max=*/8)});
+  std::shared_ptr<model::Node> map = model::MakeAsyncKnownRatioNode(
+      {2, "ParallelMapV2", prefetch}, /*ratio=*/1,
+      {model::MakeParameter(model::kParallelism,
+                            std::make_shared<model::SharedState>(
+                                /*value=*/2, nullptr, nullptr),
+                            /*min=*/1, /*max=*/8)});
+  prefetch->add_input(map);
+
+  FakeClockEnv env(Env::Default());
+  NodeMetricsSampler sampler(env);
+  prefetch->record_buffer_event(/*bytes_delta=*/0, /*elements_delta=*/3);
+  map->record_buffer_event(/*bytes_delta=*/0, /*elements_delta=*/1);
+  sampler.Sample(prefetch);
+  prefetch->record_buffer_event(/*bytes_delta=*/0, /*elements_delta=*/-2);
+  sampler.Sample(prefetch);
+
+  std::vector<NodeMetricsSampler::NodeMetrics> node_metrics =
+      sampler.GetNodeMetrics();
+  ASSERT_EQ(node_metrics.size(), 2);
+  EXPECT_THAT(node_metrics[0].buffer_utilization, ElementsAre(0.75, 0.25));
+  EXPECT_THAT(node_metrics[1].buffer_utilization, ElementsAre(0.5, 0.5));
+
+  for (int i = 0; i < NodeMetricsSampler::kMaxBufferUtilizationSamples; ++i) {
+    sampler.Sample(prefetch);
+  }
+  node_metrics = sampler.GetNodeMetrics();
+  EXPECT_EQ(node_metrics[0].buffer_utilization.size(),
+            NodeMetricsSampler::kMaxBufferUtilizationSamples);
+  prefetch->remove_input(map);
+}
+
 class ScopedTfDataMetricsRegistration {
  public:
   explicit ScopedTfDataMetricsRegistration(
@@ -231,6 +351,27 @@ TEST(TfDatazMetricsRegistryTest, Deregister) {
   EXPECT_EQ(TfDatazMetricsRegistry::GetIteratorMetricCollectors().size(), 0);
 }
 
+TEST(TfDatazMetricsRegistryTest, GetThroughputPerNumaNode) {
+  FakeClockEnv env(Env::Default());
+  std::unique_ptr<IteratorBase> iterator;
+  auto collector_one =
+      std::make_shared<TfDatazMetricsCollector>(env, iterator.get());
+  auto collector_two =
+      std::make_shared<TfDatazMetricsCollector>(env, iterator.get());
+  ScopedTfDataMetricsRegistration scoped_registration_one(collector_one);
+  ScopedTfDataMetricsRegistration scoped_registration_two(collector_two);
+  for (int i = 0; i < 60; ++i) {
+    collector_one->RecordGetNextLatency(1);
+    collector_two->RecordGetNextLatency(1);
+  }
+
+  // Iterators that are not pinned to a NUMA node are reported together.
+  absl::flat_hash_map<int, double> throughput =
+      TfDatazMetricsRegistry::GetThroughputPerNumaNode();
+  ASSERT_EQ(throughput.size(), 1);
+  EXPECT_FLOAT_EQ(throughput[port::kNUMANoAffinity], 2.0);
+}
+
 }  // namespace
 }  // namespace data
 }  // namespace tensorflow
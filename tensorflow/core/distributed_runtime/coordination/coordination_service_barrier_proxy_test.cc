@@ -65,6 +65,8 @@ class MockCoordinationServiceAgent : public CoordinationServiceAgent {
                std::unique_ptr<CoordinationClient> leader_client,
                StatusCallback error_fn),
               (override));
+  MOCK_METHOD(Status, SetHeartbeatParentClient,
+              (std::unique_ptr<CoordinationClient> parent_client), (override));
   MOCK_METHOD(bool, IsInitialized, (), (override));
   MOCK_METHOD(bool, IsConnected, (), (override));
   MOCK_METHOD(bool, IsError, (), (override));
@@ -112,6 +114,8 @@ class MockCoordinationServiceAgent : public CoordinationServiceAgent {
               (const std::string& key,
                (const std::map<std::string, std::string>&)),
               (override));
+  MOCK_METHOD(StatusOr<uint64_t>, AggregateHeartbeat,
+              (const HeartbeatRequest& request), (override));
 };
 
 constexpr auto kTestKey = "test_key";
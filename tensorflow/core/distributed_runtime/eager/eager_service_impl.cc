@@ -672,10 +672,31 @@ Status EagerServiceImpl::Enqueue(CallOptions* call_opts,
           ? context->Context()->Executor()
           : context->Context()->RemoteMgr()->GetOrCreateExecutorForStream(
                 stream_id);
+  RemoteMgr* remote_mgr = context->Context()->RemoteMgr();
+  // Record all signatures before running anything. The client considers a
+  // signature sent as soon as the request is, even if an earlier item fails.
+  // Only streaming clients bound the signatures they send, and only they
+  // reference them.
+  for (const auto& item : request->queue()) {
+    if (stream_id != kInvalidStreamId && item.has_operation() &&
+        item.operation().signature_id() != 0 &&
+        !item.operation().name().empty()) {
+      remote_mgr->AddOperationSignature(item.operation());
+    }
+  }
   Status s;
   for (const auto& item : request->queue()) {
     auto* queue_response = response->add_queue_response();
-    if (item.has_operation()) {
+    if (item.has_operation() && item.operation().name().empty() &&
+        item.operation().signature_id() != 0) {
+      Operation operation = item.operation();
+      s = remote_mgr->GetOperationSignature(operation.signature_id(),
+                                            &operation);
+      if (s.ok()) {
+        s = ExecuteOp(call_opts, operation, context->Context(), &executor,
+                      queue_response);
+      }
+    } else if (item.has_operation()) {
       s = ExecuteOp(call_opts, item.operation(), context->Context(), &executor,
                     queue_response);
     } else if (item.has_handle_to_decref()) {
@@ -469,6 +469,98 @@ TEST_F(EagerServiceImplTest, BasicTest) {
                                                &close_context_response));
 }
 
+TEST_F(EagerServiceImplTest, OperationSignatureTest) {
+  TestEagerServiceImpl eager_service_impl(&worker_env_);
+
+  uint64 context_id = random::New64();
+
+  CreateContextRequest request;
+  request.mutable_server_def()->set_job_name("localhost");
+  request.mutable_server_def()->set_task_index(0);
+  request.set_context_id(context_id);
+  CreateContextResponse response;
+
+  TF_ASSERT_OK(eager_service_impl.CreateContext(&request, &response));
+
+  EnqueueRequest remote_enqueue_request;
+  remote_enqueue_request.set_context_id(context_id);
+  EnqueueResponse remote_enqueue_response;
+
+  std::unordered_map<string, AttrValue> const_attrs;
+  AttrValue val;
+  val.set_type(tensorflow::DataType::DT_FLOAT);
+  const_attrs.insert({"dtype", val});
+  val.Clear();
+  SetTensorProto(val.mutable_tensor());
+  const_attrs.insert({"value", val});
+
+  AddOperationToEnqueueRequest(1, "Const", {}, const_attrs,
+                               "/job:localhost/replica:0/task:0/device:CPU:0",
+                               &remote_enqueue_request);
+
+  std::unordered_map<string, AttrValue> attrs;
+  val.Clear();
+  val.set_type(tensorflow::DataType::DT_FLOAT);
+  attrs.insert({"T", val});
+  val.Clear();
+  val.set_b(false);
+  attrs.insert({"transpose_a", val});
+  attrs.insert({"transpose_b", val});
+
+  // The full MatMul comes after the reference in the same request.
+  Operation* reference =
+      remote_enqueue_request.add_queue()->mutable_operation();
+  AddOperationToEnqueueRequest(
+      2, "MatMul", {std::make_pair(1, 0), std::make_pair(1, 0)}, attrs,
+      "/job:localhost/replica:0/task:0/device:CPU:0", &remote_enqueue_request);
+  remote_enqueue_request.mutable_queue(2)->mutable_operation()
+      ->set_signature_id(42);
+  reference->set_id(3);
+  reference->set_signature_id(42);
+  for (int i = 0; i < 2; ++i) {
+    auto* handle = reference->add_op_inputs()->mutable_remote_handle();
+    handle->set_op_id(1);
+    handle->set_output_num(0);
+    handle->set_op_device("/job:localhost/replica:0/task:0/device:CPU:0");
+    handle->set_device("/job:localhost/replica:0/task:0/device:CPU:0");
+  }
+
+  const uint64 stream_id = 1;
+  TF_ASSERT_OK(eager_service_impl.Enqueue(nullptr, &remote_enqueue_request,
+                                          &remote_enqueue_response,
+                                          stream_id));
+
+  tensorflow::TensorHandle* tensor_handle;
+  TF_ASSERT_OK(eager_service_impl.GetTensorHandle(
+      context_id, RemoteTensorHandleInternal(3, 0), &tensor_handle));
+  const tensorflow::Tensor* t = nullptr;
+  TF_ASSERT_OK(tensor_handle->Tensor(&t));
+  auto actual = t->flat<float>();
+  EXPECT_EQ(4, actual.size());
+  EXPECT_EQ(7, actual(0));
+  EXPECT_EQ(22, actual(3));
+
+  // A reference to a signature that was never sent is rejected.
+  EnqueueRequest unknown_request;
+  unknown_request.set_context_id(context_id);
+  Operation* unknown = unknown_request.add_queue()->mutable_operation();
+  unknown->set_id(4);
+  unknown->set_signature_id(43);
+  EnqueueResponse unknown_response;
+  EXPECT_EQ(error::FAILED_PRECONDITION,
+            eager_service_impl
+                .Enqueue(nullptr, &unknown_request, &unknown_response,
+                         stream_id)
+                .code());
+
+  CloseContextRequest close_context_request;
+  close_context_request.set_context_id(context_id);
+  close_context_request.set_context_view_id(0);
+  CloseContextResponse close_context_response;
+  TF_ASSERT_OK(eager_service_impl.CloseContext(&close_context_request,
+                                               &close_context_response));
+}
+
 class EagerServiceImplFunctionTest : public EagerServiceImplTest {
  public:
   EagerServiceImplFunctionTest() : EagerServiceImplTest() {}
@@ -243,5 +243,35 @@ void RemoteMgr::DeleteExecutorForStream(uint64 stream_id) {
   executor_map_.erase(it);
 }
 
+void RemoteMgr::AddOperationSignature(const Operation& operation) {
+  mutex_lock l(operation_signature_mu_);
+  auto it_and_bool =
+      operation_signatures_.try_emplace(operation.signature_id());
+  if (!it_and_bool.second) {
+    return;
+  }
+  Operation& signature = it_and_bool.first->second;
+  signature.set_name(operation.name());
+  *signature.mutable_attrs() = operation.attrs();
+  signature.set_device(operation.device());
+  signature.set_is_function(operation.is_function());
+}
+
+Status RemoteMgr::GetOperationSignature(uint64 signature_id,
+                                        Operation* operation) {
+  tf_shared_lock l(operation_signature_mu_);
+  auto it = operation_signatures_.find(signature_id);
+  if (it == operation_signatures_.end()) {
+    return WithErrorSourcePayload(errors::FailedPrecondition(
+        "Unknown operation signature ", signature_id,
+        ". The signature must be sent in full before it is referenced."));
+  }
+  operation->set_name(it->second.name());
+  *operation->mutable_attrs() = it->second.attrs();
+  operation->set_device(it->second.device());
+  operation->set_is_function(it->second.is_function());
+  return OkStatus();
+}
+
 }  // namespace eager
 }  // namespace tensorflow
@@ -19,10 +19,12 @@ limitations under the License.
 #include <unordered_map>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/common_runtime/eager/eager_executor.h"
 #include "tensorflow/core/common_runtime/eager/tensor_handle.h"
 #include "tensorflow/core/distributed_runtime/eager/remote_tensor_handle.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/protobuf/eager_service.pb.h"
 
 namespace tensorflow {
 namespace eager {
@@ -79,6 +81,14 @@ class RemoteMgr {
 
   void DeleteExecutorForStream(uint64 stream_id);
 
+  // Records the name, attrs, device and is_function of `operation` under its
+  // signature_id, unless that signature is already recorded.
+  void AddOperationSignature(const Operation& operation);
+
+  // Fills in the name, attrs, device and is_function recorded for
+  // `signature_id`. The other fields of `operation` are left untouched.
+  Status GetOperationSignature(uint64 signature_id, Operation* operation);
+
  protected:
   mutex next_id_mutex_;
   uint64 next_op_id_ TF_GUARDED_BY(next_id_mutex_) = 1;
@@ -128,6 +138,14 @@ class RemoteMgr {
   mutex executor_map_mu_;
   std::unordered_map<uint64, EagerExecutor> executor_map_
       TF_GUARDED_BY(executor_map_mu_);
+
+  mutex operation_signature_mu_;
+  // Signatures of the operations received from clients, keyed by
+  // Operation.signature_id. The ids are content fingerprints, so an entry
+  // stays valid for the lifetime of the context. Clients bound the number of
+  // signatures they send.
+  absl::flat_hash_map<uint64, Operation> operation_signatures_
+      TF_GUARDED_BY(operation_signature_mu_);
 };
 
 }  // namespace eager
@@ -24,6 +24,7 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "tensorflow/core/common_runtime/process_util.h"
 #include "tensorflow/core/common_runtime/profile_handler.h"
@@ -52,6 +53,7 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/map_util.h"
 #include "tensorflow/core/lib/random/random.h"
 #include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
@@ -68,6 +70,64 @@ limitations under the License.
 
 namespace tensorflow {
 
+// Tracks the partition graphs that the client graphs of a session have
+// registered, keyed by worker and by a fingerprint of the registration
+// request, so that a client graph can reuse an identical partition instead of
+// registering it again.  Each registered graph is reference counted and is
+// deregistered when its last user goes away.
+class MasterSession::RegisteredPartitions {
+ public:
+  // Returns the handle of the graph with fingerprint `fingerprint` registered
+  // on `worker` and takes a reference on it, or an empty string if there is
+  // none.
+  string Acquire(const string& worker, uint64 fingerprint) {
+    mutex_lock l(mu_);
+    auto it = handles_.find(std::make_pair(worker, fingerprint));
+    if (it == handles_.end()) return "";
+    ++entries_[std::make_pair(worker, it->second)].refs;
+    return it->second;
+  }
+
+  // Records that `graph_handle`, with fingerprint `fingerprint`, has been
+  // registered on `worker`, with a single reference.
+  void Add(const string& worker, uint64 fingerprint,
+           const string& graph_handle) {
+    mutex_lock l(mu_);
+    handles_.try_emplace(std::make_pair(worker, fingerprint), graph_handle);
+    entries_[std::make_pair(worker, graph_handle)] = {fingerprint, 1};
+  }
+
+  // Drops a reference on `graph_handle`.  Returns true if the graph is no
+  // longer used and must be deregistered from `worker`.
+  bool Release(const string& worker, const string& graph_handle) {
+    mutex_lock l(mu_);
+    auto it = entries_.find(std::make_pair(worker, graph_handle));
+    if (it == entries_.end()) return true;
+    if (--it->second.refs > 0) return false;
+    auto handle_it =
+        handles_.find(std::make_pair(worker, it->second.fingerprint));
+    if (handle_it != handles_.end() && handle_it->second == graph_handle) {
+      handles_.erase(handle_it);
+    }
+    entries_.erase(it);
+    return true;
+  }
+
+ private:
+  struct Entry {
+    uint64 fingerprint;
+    int refs;
+  };
+
+  mutex mu_;
+  // Maps (worker, fingerprint) to the handle of the registered graph.
+  absl::flat_hash_map<std::pair<string, uint64>, string> handles_
+      TF_GUARDED_BY(mu_);
+  // Maps (worker, graph handle) to its fingerprint and reference count.
+  absl::flat_hash_map<std::pair<string, string>, Entry> entries_
+      TF_GUARDED_BY(mu_);
+};
+
 // MasterSession wraps ClientGraph in a reference counted object.
 // This way, MasterSession can clear up the cache mapping Run requests to
 // compiled graphs while the compiled graph is still being used.
@@ -80,7 +140,8 @@ class MasterSession::ReffedClientGraph : public core::RefCounted {
                     const SessionOptions& session_opts,
                     const StatsPublisherFactory& stats_publisher_factory,
                     bool is_partial, WorkerCacheInterface* worker_cache,
-                    bool should_deregister)
+                    bool should_deregister,
+                    std::shared_ptr<RegisteredPartitions> registered_partitions)
       : session_handle_(handle),
         bg_opts_(bopts),
         client_graph_before_register_(std::move(client_graph)),
@@ -89,6 +150,7 @@ class MasterSession::ReffedClientGraph : public core::RefCounted {
         callable_opts_(bopts.callable_options),
         worker_cache_(worker_cache),
         should_deregister_(should_deregister),
+        registered_partitions_(std::move(registered_partitions)),
         collective_graph_key_(
             client_graph_before_register_->collective_graph_key) {
     VLOG(1) << "Created ReffedClientGraph for node with "
@@ -253,6 +315,8 @@ class MasterSession::ReffedClientGraph : public core::RefCounted {
   std::unordered_map<string, NodeDetails> name_to_node_details_;
 
   const bool should_deregister_;
+  // Shared with the other client graphs of the session; may be null.
+  const std::shared_ptr<RegisteredPartitions> registered_partitions_;
   const int64_t collective_graph_key_;
   std::atomic<int64_t> execution_count_ = {0};
 
@@ -471,12 +535,18 @@ Status MasterSession::ReffedClientGraph::DoRegisterPartitions(
     RegisterGraphRequest req;
     RegisterGraphResponse resp;
     Status status;
+    uint64 fingerprint = 0;
+    // True if the partition reuses a graph registered by another client
+    // graph, in which case no RPC is issued.
+    bool reused = false;
   };
   const int num = partitions_.size();
   gtl::InlinedVector<Call, 4> calls(num);
-  BlockingCounter done(num);
+  // Requests are prepared before any is issued so that the number of RPCs,
+  // which excludes the reused partitions, is known up front.
+  int num_rpcs = 0;
   for (int i = 0; i < num; ++i) {
-    const Part& part = partitions_[i];
+    Part& part = partitions_[i];
     Call* c = &calls[i];
     c->req.set_session_handle(session_handle_);
     c->req.set_create_worker_session_called(!should_deregister_);
@@ -488,18 +558,40 @@ Status MasterSession::ReffedClientGraph::DoRegisterPartitions(
     *c->req.mutable_debug_options() =
         callable_opts_.run_options().debug_options();
     c->req.set_collective_graph_key(collective_graph_key_);
+    if (registered_partitions_ != nullptr) {
+      c->fingerprint = DeterministicProtoHash64(c->req);
+      part.graph_handle =
+          registered_partitions_->Acquire(part.name, c->fingerprint);
+      c->reused = !part.graph_handle.empty();
+    }
+    if (c->reused) {
+      VLOG(2) << "Reusing graph " << part.graph_handle << " on " << part.name;
+    } else {
+      ++num_rpcs;
+    }
+  }
+  BlockingCounter done(num_rpcs);
+  for (int i = 0; i < num; ++i) {
+    Call* c = &calls[i];
+    if (c->reused) continue;
     VLOG(2) << "Register " << c->req.graph_def().DebugString();
     auto cb = [c, &done](const Status& s) {
       c->status = s;
       done.DecrementCount();
     };
-    part.worker->RegisterGraphAsync(&c->req, &c->resp, cb);
+    partitions_[i].worker->RegisterGraphAsync(&c->req, &c->resp, cb);
   }
   done.Wait();
   for (int i = 0; i < num; ++i) {
     Call* c = &calls[i];
+    if (c->reused) continue;
     s.Update(c->status);
-    partitions_[i].graph_handle = c->resp.graph_handle();
+    Part& part = partitions_[i];
+    part.graph_handle = c->resp.graph_handle();
+    if (registered_partitions_ != nullptr && c->status.ok()) {
+      registered_partitions_->Add(part.name, c->fingerprint,
+                                  part.graph_handle);
+    }
   }
   return s;
 }
@@ -1100,28 +1192,33 @@ void MasterSession::ReffedClientGraph::DeregisterPartitions() {
   };
   for (Part& part : partitions_) {
     // The graph handle may be empty if we failed during partition registration.
-    if (!part.graph_handle.empty()) {
-      Call* c = new Call;
-      c->req.set_session_handle(session_handle_);
-      c->req.set_create_worker_session_called(!should_deregister_);
-      c->req.set_graph_handle(part.graph_handle);
-      // NOTE(mrry): We must capture `worker_cache_` since `this`
-      // could be deleted before the callback is called.
-      WorkerCacheInterface* worker_cache = worker_cache_;
-      const string name = part.name;
-      WorkerInterface* w = part.worker;
-      CHECK_NOTNULL(w);
-      auto cb = [worker_cache, c, name, w](const Status& s) {
-        if (!s.ok()) {
-          // This error is potentially benign, so we don't log at the
-          // error level.
-          LOG(INFO) << "DeregisterGraph error: " << s;
-        }
-        delete c;
-        worker_cache->ReleaseWorker(name, w);
-      };
-      w->DeregisterGraphAsync(&c->req, &c->resp, cb);
+    if (part.graph_handle.empty()) continue;
+    if (registered_partitions_ != nullptr &&
+        !registered_partitions_->Release(part.name, part.graph_handle)) {
+      // Still used by another client graph.
+      worker_cache_->ReleaseWorker(part.name, part.worker);
+      continue;
     }
+    Call* c = new Call;
+    c->req.set_session_handle(session_handle_);
+    c->req.set_create_worker_session_called(!should_deregister_);
+    c->req.set_graph_handle(part.graph_handle);
+    // NOTE(mrry): We must capture `worker_cache_` since `this`
+    // could be deleted before the callback is called.
+    WorkerCacheInterface* worker_cache = worker_cache_;
+    const string name = part.name;
+    WorkerInterface* w = part.worker;
+    CHECK_NOTNULL(w);
+    auto cb = [worker_cache, c, name, w](const Status& s) {
+      if (!s.ok()) {
+        // This error is potentially benign, so we don't log at the
+        // error level.
+        LOG(INFO) << "DeregisterGraph error: " << s;
+      }
+      delete c;
+      worker_cache->ReleaseWorker(name, w);
+    };
+    w->DeregisterGraphAsync(&c->req, &c->resp, cb);
   }
 }
 
@@ -1246,6 +1343,10 @@ MasterSession::MasterSession(
   UpdateLastAccessTime();
   CHECK(devices_) << "device_set was null!";
 
+  if (session_opts_.config.experimental().reuse_registered_partitions()) {
+    registered_partitions_ = std::make_shared<RegisteredPartitions>();
+  }
+
   VLOG(1) << "Session " << handle_ << " #local " << env->local_devices.size()
           << " #remote " << remote_devs_->size();
   VLOG(1) << "Start master session " << handle_
@@ -1560,7 +1661,7 @@ Status MasterSession::StartStep(const BuildGraphOptions& opts, bool is_partial,
       auto entry = new ReffedClientGraph(
           handle_, opts, std::move(client_graph), session_opts_,
           stats_publisher_factory_, is_partial, worker_cache,
-          !should_delete_worker_sessions_);
+          !should_delete_worker_sessions_, registered_partitions_);
       iter = m->insert({hash, entry}).first;
       VLOG(1) << "Preparing to execute new graph";
     }
@@ -1691,10 +1792,26 @@ Status MasterSession::BuildAndRegisterPartitions(ReffedClientGraph* rcg) {
   // The closures popts.{new_name,get_incarnation} are called synchronously in
   // RegisterPartitions() below, so do not need a Ref()/Unref() pair to keep
   // "this" alive during the closure.
-  popts.new_name = [this](const string& prefix) {
-    mutex_lock l(mu_);
-    return strings::StrCat(prefix, "_S", next_node_id_++);
-  };
+  if (registered_partitions_ != nullptr) {
+    // Derives the names of the added nodes and the rendezvous keys from the
+    // client graph alone, rather than from the session-wide node counter and
+    // the edge ids, so that a partition that is unchanged between two client
+    // graphs has the same fingerprint in both.
+    auto name_counts = std::make_shared<std::unordered_map<string, int64_t>>();
+    popts.new_name = [name_counts](const string& prefix) {
+      return strings::StrCat(prefix, "_S", (*name_counts)[prefix]++);
+    };
+    popts.get_tensor_name_attr = [](const Edge* edge) {
+      return strings::StrCat("edge_", edge->src()->name(), "_",
+                             edge->src_output(), "_", edge->dst()->name(), "_",
+                             edge->dst_input());
+    };
+  } else {
+    popts.new_name = [this](const string& prefix) {
+      mutex_lock l(mu_);
+      return strings::StrCat(prefix, "_S", next_node_id_++);
+    };
+  }
   popts.get_incarnation = [this](const string& name) -> int64 {
     Device* d = devices_->FindDeviceByName(name);
     if (d == nullptr) {
@@ -2029,7 +2146,8 @@ Status MasterSession::MakeCallable(const MakeCallableRequest& req,
     callable = new ReffedClientGraph(handle_, opts, std::move(client_graph),
                                      session_opts_, stats_publisher_factory_,
                                      false /* is_partial */, get_worker_cache(),
-                                     !should_delete_worker_sessions_);
+                                     !should_delete_worker_sessions_,
+                                     registered_partitions_);
   }
 
   Status s = BuildAndRegisterPartitions(callable);
@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/distributed_runtime/rpc/eager/grpc_eager_client.h"
 
 #include <string>
+#include <vector>
 
 #include "grpcpp/generic/generic_stub.h"
 #include "tensorflow/core/distributed_runtime/call_options.h"
@@ -72,6 +73,10 @@ bool EnableStreaming() {
   return result;
 }
 
+// Maximum number of operation signatures remembered per streaming context.
+// Operations with other signatures are always sent in full.
+constexpr size_t kMaxSentSignatures = 16384;
+
 // Ref-counted thread to handle callbacks for completed requests a GRPC
 // completion queue. The thread might be shared by multiple eager clients, and
 // each one of them should hold a reference count to ensure that the thread
@@ -178,6 +183,10 @@ class GrpcEagerClient : public EagerClient {
             << request->DebugString();
 
     mutex_lock l(mu_);
+    {
+      mutex_lock sl(signature_mu_);
+      sent_signatures_.erase(request->context_id());
+    }
     const auto& it = enqueue_dispatchers_.find(request->context_id());
     if (it != enqueue_dispatchers_.end()) {
       it->second.CancelCall();
@@ -210,8 +219,29 @@ class GrpcEagerClient : public EagerClient {
                 "/tensorflow.eager.EagerService/StreamingEnqueue"));
         it = it_and_bool.first;
       }
+      // The signatures are recorded and the request is sent under `mu_`, so
+      // that the server sees every signature before any reference to it.
+      EnqueueRequest compact_request;
+      bool compacted;
+      {
+        mutex_lock sl(signature_mu_);
+        compacted = CompactEnqueueRequest(
+            *request, kMaxSentSignatures,
+            &sent_signatures_[request->context_id()], &compact_request);
+      }
+      // A failed call may not have delivered the signatures; send them again.
+      StatusCallback done_reset = [this, context_id = request->context_id(),
+                                   done = std::move(done_wrapped)](
+                                      const Status& status) {
+        if (!status.ok()) {
+          mutex_lock sl(signature_mu_);
+          sent_signatures_.erase(context_id);
+        }
+        done(status);
+      };
       // TODO(haoyuzhang): Consider supporting cancellation for streaming RPC?
-      it->second.SendNextRequest(*request, response, std::move(done_wrapped));
+      it->second.SendNextRequest(compacted ? compact_request : *request,
+                                 response, std::move(done_reset));
     } else {
       Notification n;
       Status status;
@@ -237,6 +267,13 @@ class GrpcEagerClient : public EagerClient {
   std::unordered_map<uint64, StreamingRPCDispatcher<EnqueueResponse>>
       enqueue_dispatchers_ TF_GUARDED_BY(mu_);
 
+  // Separate from `mu_` because the done callback of a streaming request,
+  // which may run while `mu_` is held, resets the signatures on error.
+  mutable mutex signature_mu_;
+  // Operation signatures sent on the streaming call of each context.
+  std::unordered_map<uint64, absl::flat_hash_set<uint64>> sent_signatures_
+      TF_GUARDED_BY(signature_mu_);
+
   StatusCallback callback_wrapper(StatusCallback done) {
     Ref();
     return [this, done = std::move(done)](const Status& status) {
@@ -332,5 +369,59 @@ EagerClientCache* NewGrpcEagerClientCache(
   return new GrpcEagerClientCache(channel);
 }
 
+bool CompactEnqueueRequest(const EnqueueRequest& request,
+                           size_t max_signatures,
+                           absl::flat_hash_set<uint64>* sent_signatures,
+                           EnqueueRequest* compact) {
+  enum Action : char { kKeep, kReference, kUnsigned };
+  std::vector<Action> actions(request.queue_size(), kKeep);
+  bool rewrite = false;
+  for (int i = 0; i < request.queue_size(); ++i) {
+    const QueueItem& item = request.queue(i);
+    if (!item.has_operation() || item.operation().signature_id() == 0) {
+      continue;
+    }
+    const uint64 signature_id = item.operation().signature_id();
+    if (sent_signatures->contains(signature_id)) {
+      actions[i] = kReference;
+      rewrite = true;
+    } else if (sent_signatures->size() < max_signatures) {
+      sent_signatures->insert(signature_id);
+    } else {
+      // Keep the server from recording a signature we will never reference.
+      actions[i] = kUnsigned;
+      rewrite = true;
+    }
+  }
+  if (!rewrite) {
+    return false;
+  }
+
+  compact->set_context_id(request.context_id());
+  for (int i = 0; i < request.queue_size(); ++i) {
+    const QueueItem& item = request.queue(i);
+    QueueItem* compact_item = compact->add_queue();
+    if (actions[i] == kKeep) {
+      *compact_item = item;
+      continue;
+    }
+    const Operation& operation = item.operation();
+    Operation* compact_operation = compact_item->mutable_operation();
+    if (actions[i] == kUnsigned) {
+      *compact_operation = operation;
+      compact_operation->clear_signature_id();
+      continue;
+    }
+    compact_operation->set_id(operation.id());
+    *compact_operation->mutable_op_inputs() = operation.op_inputs();
+    *compact_operation->mutable_control_op_ids() = operation.control_op_ids();
+    compact_operation->set_is_component_function(
+        operation.is_component_function());
+    compact_operation->set_func_step_id(operation.func_step_id());
+    compact_operation->set_signature_id(operation.signature_id());
+  }
+  return true;
+}
+
 }  // namespace eager
 }  // namespace tensorflow
@@ -16,14 +16,27 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_EAGER_GRPC_EAGER_CLIENT_H_
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_EAGER_GRPC_EAGER_CLIENT_H_
 
+#include "absl/container/flat_hash_set.h"
 #include "tensorflow/core/distributed_runtime/eager/eager_client.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_channel.h"
+#include "tensorflow/core/protobuf/eager_service.pb.h"
 
 namespace tensorflow {
 namespace eager {
 // The GrpcChannelCache is not owned.
 EagerClientCache* NewGrpcEagerClientCache(
     std::shared_ptr<tensorflow::GrpcChannelCache> channel);
+
+// Prepares `request` for a streaming call on which the operation signatures in
+// `sent_signatures` have already been sent. Operations with such a signature
+// are reduced to their signature_id and per-op fields; the signatures of the
+// other operations are added to `sent_signatures`, up to `max_signatures`.
+// Returns true and fills `compact` if the request had to be rewritten, and
+// false if `request` can be sent as is.
+bool CompactEnqueueRequest(const EnqueueRequest& request,
+                           size_t max_signatures,
+                           absl::flat_hash_set<uint64>* sent_signatures,
+                           EnqueueRequest* compact);
 }  // namespace eager
 }  // namespace tensorflow
 
@@ -57,5 +57,67 @@ TEST(GrpcEagerClientCache, TestGetClientThreadSafety) {
   counter.Wait();
 }
 
+TEST(CompactEnqueueRequestTest, ReferencesSentSignatures) {
+  EnqueueRequest request;
+  request.set_context_id(7);
+  for (int i = 0; i < 3; ++i) {
+    Operation* op = request.add_queue()->mutable_operation();
+    op->set_id(i + 1);
+    op->set_name("MatMul");
+    op->set_device("/job:worker/replica:0/task:1/device:CPU:0");
+    (*op->mutable_attrs())["transpose_a"].set_b(false);
+    op->add_op_inputs()->mutable_remote_handle()->set_op_id(i);
+    op->set_signature_id(i == 2 ? 2 : 1);
+  }
+  request.add_queue()->mutable_handle_to_decref()->set_op_id(1);
+
+  absl::flat_hash_set<uint64> sent;
+  EnqueueRequest compact;
+  ASSERT_TRUE(CompactEnqueueRequest(request, /*max_signatures=*/10, &sent,
+                                    &compact));
+  EXPECT_EQ(2, sent.size());
+  EXPECT_EQ(7, compact.context_id());
+  ASSERT_EQ(4, compact.queue_size());
+  // The first operation with a signature carries it in full, the second one
+  // only references it.
+  EXPECT_EQ("MatMul", compact.queue(0).operation().name());
+  const Operation& reference = compact.queue(1).operation();
+  EXPECT_TRUE(reference.name().empty());
+  EXPECT_TRUE(reference.device().empty());
+  EXPECT_TRUE(reference.attrs().empty());
+  EXPECT_EQ(2, reference.id());
+  EXPECT_EQ(1, reference.signature_id());
+  EXPECT_EQ(1, reference.op_inputs(0).remote_handle().op_id());
+  EXPECT_EQ("MatMul", compact.queue(2).operation().name());
+  EXPECT_TRUE(compact.queue(3).has_handle_to_decref());
+
+  // Once both signatures are known, every operation is a reference.
+  EnqueueRequest second_compact;
+  ASSERT_TRUE(CompactEnqueueRequest(request, /*max_signatures=*/10, &sent,
+                                    &second_compact));
+  EXPECT_TRUE(second_compact.queue(0).operation().name().empty());
+  EXPECT_TRUE(second_compact.queue(2).operation().name().empty());
+}
+
+TEST(CompactEnqueueRequestTest, SendsInFullBeyondLimit) {
+  EnqueueRequest request;
+  Operation* op = request.add_queue()->mutable_operation();
+  op->set_name("Add");
+  op->set_signature_id(5);
+
+  absl::flat_hash_set<uint64> sent;
+  EnqueueRequest compact;
+  EXPECT_FALSE(CompactEnqueueRequest(request, /*max_signatures=*/1, &sent,
+                                     &compact));
+  EXPECT_EQ(1, sent.size());
+
+  op->set_signature_id(6);
+  ASSERT_TRUE(CompactEnqueueRequest(request, /*max_signatures=*/1, &sent,
+                                    &compact));
+  EXPECT_EQ(1, sent.size());
+  EXPECT_EQ("Add", compact.queue(0).operation().name());
+  EXPECT_EQ(0, compact.queue(0).operation().signature_id());
+}
+
 }  // namespace eager
 }  // namespace tensorflow
@@ -15,7 +15,10 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/grpc_remote_worker.h"
 
+#include <atomic>
+#include <memory>
 #include <utility>
+#include <vector>
 
 #include "grpcpp/generic/generic_stub.h"
 #include "grpcpp/grpcpp.h"
@@ -42,12 +45,11 @@ namespace tensorflow {
 
 class GrpcRemoteWorker : public WorkerInterface {
  public:
-  explicit GrpcRemoteWorker(SharedGrpcChannelPtr channel,
+  explicit GrpcRemoteWorker(std::vector<SharedGrpcChannelPtr> channels,
                             ::grpc::CompletionQueue* completion_queue,
                             thread::ThreadPool* callback_threadpool,
                             WorkerCacheLogger* logger, const string& target)
-      : channel_(std::move(channel)),
-        stub_(channel_),
+      : channels_(std::move(channels)),
         cq_(completion_queue),
         callback_threadpool_(callback_threadpool),
         getstatus_(Method(GrpcWorkerMethod::kGetStatus)),
@@ -66,8 +68,15 @@ class GrpcRemoteWorker : public WorkerInterface {
         instancesource_(Method(GrpcWorkerMethod::kCompleteInstance)),
         getstepsequence_(Method(GrpcWorkerMethod::kGetStepSequence)),
         markrecvfinished_(Method(GrpcWorkerMethod::kMarkRecvFinished)),
+        recvtensorbatch_(Method(GrpcWorkerMethod::kRecvTensorBatch)),
         logger_(logger),
-        target_(target) {}
+        target_(target) {
+    CHECK(!channels_.empty());
+    stubs_.reserve(channels_.size());
+    for (const SharedGrpcChannelPtr& channel : channels_) {
+      stubs_.push_back(std::make_unique<::grpc::GenericStub>(channel));
+    }
+  }
 
   ~GrpcRemoteWorker() override {}
 
@@ -258,6 +267,15 @@ class GrpcRemoteWorker : public WorkerInterface {
     IssueRequest(request, response, recvtensor_, callback, call_opts);
   }
 
+  void RecvTensorBatchAsync(CallOptions* call_opts,
+                            const RecvTensorBatchRequest* request,
+                            RecvTensorBatchResponse* response,
+                            StatusCallback done) override {
+    VLOG(1) << "RecvTensorBatchAsync req: " << request->ShortDebugString();
+    IssueRequest(request, response, recvtensorbatch_, std::move(done),
+                 call_opts);
+  }
+
   void LoggingAsync(const LoggingRequest* request, LoggingResponse* response,
                     StatusCallback done) override {
     IssueRequest(request, response, logging_, done);
@@ -276,7 +294,7 @@ class GrpcRemoteWorker : public WorkerInterface {
                     StatusCallback done, CallOptions* call_opts = nullptr,
                     bool fail_fast = true) {
     new RPCState<protobuf::Message>(
-        &stub_, cq_, method, *request, response, std::move(done), call_opts,
+        StubFor(method), cq_, method, *request, response, std::move(done), call_opts,
         callback_threadpool_, MaxRetries(), fail_fast, &target_);
   }
 
@@ -284,7 +302,7 @@ class GrpcRemoteWorker : public WorkerInterface {
                     const ::grpc::string& method, StatusCallback done,
                     CallOptions* call_opts = nullptr) {
     new RPCState<TensorResponse>(
-        &stub_, cq_, method, *request, response, std::move(done), call_opts,
+        StubFor(method), cq_, method, *request, response, std::move(done), call_opts,
         callback_threadpool_, MaxRetries(),
         /*fail_fast=*/true, &target_,
         // Use optimized proto parse function that avoids a copy.
@@ -301,6 +319,22 @@ class GrpcRemoteWorker : public WorkerInterface {
     IssueRequest(&request, response, markrecvfinished_, done);
   }
 
+  // Returns the stub on which to issue `method`, which must be one of the
+  // method members below. With more than one channel, the first channel is
+  // reserved for control RPCs so that they never queue behind tensor
+  // transfers, and the tensor transfers are striped round-robin across the
+  // remaining channels.
+  ::grpc::GenericStub* StubFor(const ::grpc::string& method) {
+    if (stubs_.size() == 1) return stubs_[0].get();
+    if (&method != &recvtensor_ && &method != &recvbuf_ &&
+        &method != &recvtensorbatch_) {
+      return stubs_[0].get();
+    }
+    const uint64 bulk_index =
+        next_bulk_stub_.fetch_add(1, std::memory_order_relaxed);
+    return stubs_[1 + bulk_index % (stubs_.size() - 1)].get();
+  }
+
   // Helper function for initializing the RpcMethod objects below.
   const char* Method(GrpcWorkerMethod id) { return GrpcWorkerMethodName(id); }
 
@@ -312,8 +346,9 @@ class GrpcRemoteWorker : public WorkerInterface {
     return max_retries;
   }
 
-  SharedGrpcChannelPtr channel_;
-  ::grpc::GenericStub stub_;
+  const std::vector<SharedGrpcChannelPtr> channels_;
+  std::vector<std::unique_ptr<::grpc::GenericStub>> stubs_;
+  std::atomic<uint64> next_bulk_stub_{0};
   ::grpc::CompletionQueue* cq_;
   thread::ThreadPool* callback_threadpool_;
 
@@ -333,6 +368,7 @@ class GrpcRemoteWorker : public WorkerInterface {
   const ::grpc::string instancesource_;
   const ::grpc::string getstepsequence_;
   const ::grpc::string markrecvfinished_;
+  const ::grpc::string recvtensorbatch_;
 
   // Support for logging.
   WorkerCacheLogger* logger_;
@@ -346,7 +382,17 @@ WorkerInterface* NewGrpcRemoteWorker(SharedGrpcChannelPtr channel,
                                      thread::ThreadPool* callback_threadpool,
                                      WorkerCacheLogger* logger,
                                      const string& target) {
-  return new GrpcRemoteWorker(std::move(channel), completion_queue,
+  return NewGrpcRemoteWorker(
+      std::vector<SharedGrpcChannelPtr>{std::move(channel)}, completion_queue,
+      callback_threadpool, logger, target);
+}
+
+WorkerInterface* NewGrpcRemoteWorker(std::vector<SharedGrpcChannelPtr> channels,
+                                     ::grpc::CompletionQueue* completion_queue,
+                                     thread::ThreadPool* callback_threadpool,
+                                     WorkerCacheLogger* logger,
+                                     const string& target) {
+  return new GrpcRemoteWorker(std::move(channels), completion_queue,
                               callback_threadpool, logger, target);
 }
 
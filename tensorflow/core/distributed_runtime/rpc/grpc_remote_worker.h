@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_REMOTE_WORKER_H_
 
 #include <memory>
+#include <vector>
 
 #include "grpcpp/completion_queue.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_util.h"
@@ -32,6 +33,17 @@ WorkerInterface* NewGrpcRemoteWorker(SharedGrpcChannelPtr channel,
                                      WorkerCacheLogger* logger,
                                      const string& target);
 
+// Like above, but issues the RPCs over a pool of `channels` to the same
+// target. With more than one channel, the first one carries the control RPCs
+// and the tensor transfers (RecvTensor, RecvBuf, RecvTensorBatch) are striped
+// round-robin over the others, so that large transfers do not hold up
+// latency-sensitive RPCs such as RunGraph.
+WorkerInterface* NewGrpcRemoteWorker(std::vector<SharedGrpcChannelPtr> channels,
+                                     ::grpc::CompletionQueue* completion_queue,
+                                     thread::ThreadPool* callback_threadpool,
+                                     WorkerCacheLogger* logger,
+                                     const string& target);
+
 }  // namespace tensorflow
 
 #endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_REMOTE_WORKER_H_
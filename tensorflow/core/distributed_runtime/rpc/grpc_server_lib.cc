@@ -187,6 +187,7 @@ Status GrpcServer::Init(const GrpcServerOptions& opts) {
   CHECK_EQ(state_, NEW);
   master_env_.env = env_;
   worker_env_.env = env_;
+  worker_cache_wrapper_func_ = opts.worker_cache_wrapper_func;
 
   // Check parameters before DeviceFactory::AddDevices,
   // otherwise if 'task_index=-1' the program will abort.
@@ -422,6 +423,13 @@ Status GrpcServer::WorkerCacheFactory(const WorkerCacheFactoryOptions& options,
   }
   *worker_cache = NewGrpcWorkerCacheWithLocalWorker(
       channel_cache, grpc_worker_env(), worker_impl(), name_prefix);
+  if (worker_cache_wrapper_func_) {
+    *worker_cache = worker_cache_wrapper_func_(*worker_cache);
+    if (*worker_cache == nullptr) {
+      return errors::Internal(
+          "worker_cache_wrapper_func did not return a WorkerCacheInterface");
+    }
+  }
   return OkStatus();
 }
 
@@ -585,9 +593,20 @@ std::shared_ptr<::grpc::ServerCredentials> GrpcServer::GetServerCredentials(
 }
 
 ChannelCreationFunction GrpcServer::GetChannelCreationFunction() const {
+  // Only the channel pool size is taken from the default session config, so
+  // that each channel of a pool gets its own connection. Compression and the
+  // other options keep their defaults.
+  RPCOptions rpc_options;
+  rpc_options.set_num_channels_per_target(server_def_.default_session_config()
+                                              .rpc_options()
+                                              .num_channels_per_target());
   // We can do this because SparseGrpcChannelCache is robust to nullptr being
   // returned by the channel creation function
-  return ConvertToChannelCreationFunction(NewHostPortGrpcChannel);
+  return ConvertToChannelCreationFunction(
+      [rpc_options](string target, const RPCOptions* /*unused*/,
+                    SharedGrpcChannelPtr* channel_pointer) {
+        return NewHostPortGrpcChannel(target, &rpc_options, channel_pointer);
+      });
 }
 
 std::unique_ptr<Master> GrpcServer::CreateMaster(MasterEnv* master_env) {
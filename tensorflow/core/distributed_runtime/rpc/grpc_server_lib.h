@@ -64,11 +64,20 @@ typedef std::function<std::unique_ptr<GrpcWorker>(WorkerEnv*,
                                                   const ConfigProto& config)>
     WorkerCreationFunction;
 
+// function that wraps a worker cache created by the server, taking ownership
+// of it. Both the rendezvous and the collectives obtain their
+// `WorkerInterface`s from the worker cache, so the wrapper can route
+// `RecvTensorAsync()` and `RecvBufAsync()` over a transport other than gRPC,
+// e.g. RDMA, and fall back to the wrapped worker for everything else.
+typedef std::function<WorkerCacheInterface*(WorkerCacheInterface*)>
+    WorkerCacheWrapperFunction;
+
 struct GrpcServerOptions {
   ServiceInitFunction service_func = nullptr;
   RendezvousMgrCreationFunction rendezvous_mgr_func = nullptr;
   CollectiveMgrCreationFunction collective_mgr_func = nullptr;
   WorkerCreationFunction worker_func = nullptr;
+  WorkerCacheWrapperFunction worker_cache_wrapper_func = nullptr;
   StatsPublisherFactory stats_factory = CreateNoOpStatsPublisher;
   GrpcWorkerServiceOptions worker_service_options;
   DeviceMgr* local_device_mgr = nullptr;
@@ -185,6 +194,9 @@ class GrpcServer : public ServerInterface {
   // The host name of this server
   string host_name_;
 
+  // Applied to every worker cache created by `WorkerCacheFactory()`.
+  WorkerCacheWrapperFunction worker_cache_wrapper_func_;
+
   // Guards server configuration, server, and state.
   mutex mu_;
 
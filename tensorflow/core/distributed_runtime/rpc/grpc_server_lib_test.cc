@@ -0,0 +1,109 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/rpc/grpc_server_lib.h"
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/distributed_runtime/rpc/rpc_rendezvous_mgr.h"
+#include "tensorflow/core/distributed_runtime/worker_cache_wrapper.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/strcat.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/tensorflow_server.pb.h"
+
+namespace tensorflow {
+namespace {
+
+// Wraps a worker cache and owns it, as a transport plugin would.
+class OwningWorkerCacheWrapper : public WorkerCacheWrapper {
+ public:
+  explicit OwningWorkerCacheWrapper(WorkerCacheInterface* wrapped)
+      : WorkerCacheWrapper(wrapped), owned_(wrapped) {}
+
+ private:
+  std::unique_ptr<WorkerCacheInterface> owned_;
+};
+
+class TestGrpcServer : public GrpcServer {
+ public:
+  explicit TestGrpcServer(const ServerDef& server_def)
+      : GrpcServer(server_def, Env::Default()) {}
+
+  using GrpcServer::Init;
+  using GrpcServer::WorkerCacheFactory;
+};
+
+ServerDef LocalServerDef() {
+  ServerDef server_def;
+  server_def.set_protocol("grpc");
+  server_def.set_job_name("localhost");
+  server_def.set_task_index(0);
+  JobDef* job_def = server_def.mutable_cluster()->add_job();
+  job_def->set_name("localhost");
+  job_def->mutable_tasks()->insert(
+      {0, strings::StrCat("localhost:", testing::PickUnusedPortOrDie())});
+  return server_def;
+}
+
+TEST(GrpcServerTest, WorkerCacheWrapperWrapsEveryWorkerCache) {
+  std::vector<WorkerCacheInterface*> wrappers;
+  GrpcServerOptions options;
+  options.rendezvous_mgr_func = NewRpcRendezvousMgr;
+  options.worker_cache_wrapper_func =
+      [&wrappers](WorkerCacheInterface* worker_cache) -> WorkerCacheInterface* {
+    wrappers.push_back(new OwningWorkerCacheWrapper(worker_cache));
+    return wrappers.back();
+  };
+
+  const ServerDef server_def = LocalServerDef();
+  TestGrpcServer server(server_def);
+  TF_ASSERT_OK(server.Init(options));
+  // The worker cache of the server is shared by the master and the workers.
+  ASSERT_EQ(wrappers.size(), 1);
+  EXPECT_EQ(server.master_env()->worker_cache, wrappers[0]);
+
+  // So are the worker caches created for sessions.
+  WorkerCacheInterface* worker_cache = nullptr;
+  TF_ASSERT_OK(server.WorkerCacheFactory(WorkerCacheFactoryOptions(server_def),
+                                         &worker_cache));
+  std::unique_ptr<WorkerCacheInterface> session_worker_cache(worker_cache);
+  ASSERT_EQ(wrappers.size(), 2);
+  EXPECT_EQ(worker_cache, wrappers[1]);
+
+  // The wrapper delegates to the gRPC worker cache.
+  std::vector<string> workers;
+  worker_cache->ListWorkers(&workers);
+  EXPECT_EQ(workers.size(), 1);
+}
+
+TEST(GrpcServerTest, WorkerCacheWrapperMustReturnWorkerCache) {
+  GrpcServerOptions options;
+  options.rendezvous_mgr_func = NewRpcRendezvousMgr;
+  options.worker_cache_wrapper_func =
+      [](WorkerCacheInterface* worker_cache) -> WorkerCacheInterface* {
+    delete worker_cache;
+    return nullptr;
+  };
+
+  TestGrpcServer server(LocalServerDef());
+  EXPECT_TRUE(errors::IsInternal(server.Init(options)));
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -679,6 +679,52 @@ TEST(GrpcSessionTest, SendRecv_Node_Naming) {
   TF_ASSERT_OK(session->Close());
 }
 
+TEST(GrpcSessionTest, ReuseRegisteredPartitions) {
+  std::unique_ptr<test::TestCluster> cluster;
+  TF_ASSERT_OK(test::TestCluster::MakeTestCluster(
+      TestClusterConfig()
+          .Options(Devices(1, 0))
+          .Jobs({TestJob{"localhost", /*num_tasks=*/2}}),
+      &cluster));
+  SessionOptions options = Options(cluster->targets()[0], 1);
+  options.config.mutable_experimental()->set_reuse_registered_partitions(true);
+  std::unique_ptr<Session> session(NewRemote(options));
+  ASSERT_TRUE(session != nullptr);
+
+  const DeviceAttributes& src = cluster->devices()[0];
+  const DeviceAttributes& dst = cluster->devices()[1];
+
+  // a on 'src' sends to b and c on 'dst'.  Fetching {b} and {b, c} yields
+  // client graphs whose 'src' partitions are identical, so the second one
+  // reuses the partition registered by the first.
+  Graph graph(OpRegistry::Global());
+  Tensor a_tensor(DT_FLOAT, TensorShape({1, 1}));
+  a_tensor.flat<float>()(0) = 100;
+  Node* a = test::graph::Constant(&graph, a_tensor);
+  Node* b = test::graph::Identity(&graph, a);
+  Node* c = test::graph::Identity(&graph, a);
+
+  GraphDef def;
+  test::graph::ToGraphDef(&graph, &def);
+  SetDevice(&def, a->name(), src.name());
+  SetDevice(&def, b->name(), dst.name());
+  SetDevice(&def, c->name(), dst.name());
+  TF_ASSERT_OK(session->Create(def));
+
+  const std::vector<std::vector<string>> fetch_sets = {
+      {b->name()}, {b->name(), c->name()}, {c->name()}, {b->name()}};
+  for (const auto& fetches : fetch_sets) {
+    std::vector<Tensor> outputs;
+    TF_ASSERT_OK(session->Run({}, fetches, {}, &outputs));
+    ASSERT_EQ(fetches.size(), outputs.size());
+    for (const Tensor& output : outputs) {
+      IsSingleFloatValue(output, 100);
+    }
+  }
+
+  TF_ASSERT_OK(session->Close());
+}
+
 TEST(GrpcSessionTest, Error) {
   std::unique_ptr<test::TestCluster> cluster;
   TF_ASSERT_OK(test::TestCluster::MakeTestCluster(
@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_TENSOR_CODING_H_
 
 #include "grpcpp/impl/codegen/byte_buffer.h"
+#include "tensorflow/core/framework/types.pb.h"
 
 namespace tensorflow {
 class Tensor;
@@ -45,9 +46,13 @@ void EncodeRecvTensorResponseToByteBuffer(const RecvTensorResponse& proto,
 //
 // "val" holds the tensor value to be encoded.
 //
+// If "original_dtype" is not DT_INVALID, "val" is a reduced-precision
+// encoding of a tensor of that dtype, which the receiver restores.
+//
 // Discards original contents of *result.
 void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val, bool require_ack,
-                              ::grpc::ByteBuffer* result);
+                              ::grpc::ByteBuffer* result,
+                              DataType original_dtype = DT_INVALID);
 
 }  // namespace grpc
 }  // namespace tensorflow
@@ -55,13 +55,14 @@ class GrpcWorkerCache : public WorkerCachePartial {
     if (target == local_target_) {
       return local_worker_;
     } else {
-      SharedGrpcChannelPtr channel = channel_cache_->FindWorkerChannel(target);
-      if (!channel) {
+      std::vector<SharedGrpcChannelPtr> channels;
+      channel_cache_->FindWorkerChannels(target, &channels);
+      if (channels.empty()) {
         return nullptr;
       }
       size_t index = AssignWorkerToThread(target);
       return NewGrpcRemoteWorker(
-          channel, worker_env_->GetCompletionQueue(index),
+          std::move(channels), worker_env_->GetCompletionQueue(index),
           worker_env_->GetThreadPool(), &logger_, target);
     }
   }
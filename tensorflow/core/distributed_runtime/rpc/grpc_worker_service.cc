@@ -37,6 +37,7 @@ limitations under the License.
 #include "tensorflow/core/distributed_runtime/rpc/grpc_util.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_worker_service_impl.h"
 #include "tensorflow/core/distributed_runtime/rpc/rpc_response_cache.h"
+#include "tensorflow/core/distributed_runtime/tensor_coding.h"
 #include "tensorflow/core/distributed_runtime/worker.h"
 #include "tensorflow/core/distributed_runtime/worker_cache.h"
 #include "tensorflow/core/distributed_runtime/worker_session.h"
@@ -54,6 +55,7 @@ limitations under the License.
 #include "tensorflow/core/profiler/lib/scoped_memory_debug_annotation.h"
 #include "tensorflow/core/protobuf/transport_options.pb.h"
 #include "tensorflow/core/protobuf/worker.pb.h"
+#include "tensorflow/core/util/reffed_status_callback.h"
 #include "tensorflow/tsl/distributed_runtime/rpc/async_service_interface.h"
 #include "tensorflow/tsl/distributed_runtime/rpc/grpc_call.h"
 #include "tensorflow/tsl/protobuf/rpc_options.pb.h"
@@ -148,6 +150,7 @@ class GrpcWorkerServiceThread {
     SETUP_FOR_REQUEST(RunGraph, 100, true);
     SETUP_FOR_REQUEST(CleanupGraph, 100, false);
     SETUP_FOR_REQUEST(MarkRecvFinished, 10, false);
+    SETUP_FOR_REQUEST(RecvTensorBatch, 100, true);
 
     // TODO(ncteisen): Determine a better policy for enqueuing the
     // appropriate number of each request type.
@@ -301,6 +304,25 @@ class GrpcWorkerServiceThread {
     ENQUEUE_REQUEST(RecvBuf, true);
   }
 
+  void RecvTensorBatchHandler(
+      WorkerCall<RecvTensorBatchRequest, RecvTensorBatchResponse>* call) {
+    Schedule([this, call]() {
+      CallOptions* call_opts = new CallOptions;
+      call->SetCancelCallback([call_opts]() { call_opts->StartCancel(); });
+      worker_->RecvTensorBatchAsync(
+          call_opts, &call->request, &call->response,
+          [call, call_opts](const Status& s) {
+            call->ClearCancelCallback();
+            delete call_opts;
+            if (!s.ok()) {
+              VLOG(3) << "Bad response from RecvTensorBatch:" << s;
+            }
+            call->SendResponse(ToGrpcStatus(s));
+          });
+    });
+    ENQUEUE_REQUEST(RecvTensorBatch, true);
+  }
+
   void CompleteGroupHandler(
       WorkerCall<CompleteGroupRequest, CompleteGroupResponse>* call) {
     Schedule([this, call]() {
@@ -445,11 +467,21 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
 
   bool cache_enabled = (response_cache_ != nullptr && request_id != 0);
 
-  auto do_response = [response, done, cache_enabled](const Tensor& tensor,
-                                                     bool is_dead,
-                                                     const Status& status) {
+  auto do_response = [this, request, response, done, cache_enabled](
+                         const Tensor& tensor, bool is_dead,
+                         const Status& status) {
     if (status.ok()) {
-      grpc::EncodeTensorToByteBuffer(is_dead, tensor, cache_enabled, response);
+      const DataType wire_dtype = request->wire_dtype();
+      if (!is_dead && CanReduceWirePrecision(tensor, wire_dtype) &&
+          tensor.TotalBytes() >= request->wire_min_bytes()) {
+        Tensor reduced;
+        ReduceWirePrecision(request, tensor, &reduced);
+        grpc::EncodeTensorToByteBuffer(is_dead, reduced, cache_enabled,
+                                       response, tensor.dtype());
+      } else {
+        grpc::EncodeTensorToByteBuffer(is_dead, tensor, cache_enabled,
+                                       response);
+      }
     }
     done(status);
   };
@@ -510,20 +542,125 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
     LOG(WARNING) << "RecvTensor cancelled for " << step_id;
     AbortStep(step_id);
   });
+  RecvLocalTensorAsync(opts, request, parsed, src_dev, rendezvous_done);
+}
+
+void GrpcWorker::ReduceWirePrecision(const RecvTensorRequest* request,
+                                     const Tensor& val, Tensor* reduced) {
+  if (!request->wire_error_feedback()) {
+    ::tensorflow::ReduceWirePrecision(val, request->wire_dtype(),
+                                      /*residual=*/nullptr, reduced);
+    return;
+  }
+  Rendezvous::ParsedKey parsed;
+  TF_CHECK_OK(Rendezvous::ParseKey(request->rendezvous_key(), &parsed));
+  const string edge_key = strings::StrCat(parsed.src_device, ";",
+                                          parsed.dst_device, ";",
+                                          parsed.edge_name);
+  std::shared_ptr<WireResidual> residual;
+  {
+    mutex_lock l(wire_residuals_mu_);
+    std::shared_ptr<WireResidual>& entry = wire_residuals_[edge_key];
+    if (entry == nullptr) {
+      entry = std::make_shared<WireResidual>();
+    }
+    residual = entry;
+  }
+  mutex_lock l(residual->mu);
+  ::tensorflow::ReduceWirePrecision(val, request->wire_dtype(),
+                                    &residual->tensor, reduced);
+}
+
+void GrpcWorker::RecvTensorBatchAsync(CallOptions* opts,
+                                      const RecvTensorBatchRequest* request,
+                                      RecvTensorBatchResponse* response,
+                                      StatusCallback done) {
+  VLOG(3) << "RecvTensorBatchAsync req: " << request->ShortDebugString();
+  const int64_t step_id = request->step_id();
+  const int num_tensors = request->request_size();
+  TRACEPRINTF("RecvTensorBatch: %lld %d", step_id, num_tensors);
+
+  Status s = recent_request_ids_.TrackUnique(
+      request->request_id(), "RecvTensorBatch (GrpcWorker)", *request);
+
+  // Resolve every key before waiting on any of them, so that a malformed
+  // request does not consume tensors from the rendezvous.
+  std::vector<Rendezvous::ParsedKey> parsed(num_tensors);
+  std::vector<Device*> src_devs(num_tensors, nullptr);
+  for (int i = 0; s.ok() && i < num_tensors; ++i) {
+    const RecvTensorRequest& recv_request = request->request(i);
+    if (recv_request.step_id() != step_id) {
+      s = errors::InvalidArgument("RecvTensorBatch element ", i, " has step ",
+                                  recv_request.step_id(), ", expected ",
+                                  step_id);
+      break;
+    }
+    s = Rendezvous::ParseKey(recv_request.rendezvous_key(), &parsed[i]);
+    if (s.ok()) {
+      s = PrepareRecvTensor(parsed[i], &src_devs[i]);
+    }
+  }
+  if (!s.ok() || num_tensors == 0) {
+    done(s);
+    return;
+  }
+
+  std::vector<RecvTensorResponse*> entries(num_tensors);
+  for (int i = 0; i < num_tensors; ++i) {
+    entries[i] = response->add_response();
+  }
+
+  // Any time while waiting for the tensors to be produced, an RPC
+  // cancellation should abort the rendezvous. See `GrpcRecvTensorAsync()`.
+  opts->SetCancelCallback([this, step_id]() {
+    LOG(WARNING) << "RecvTensorBatch cancelled for " << step_id;
+    AbortStep(step_id);
+  });
+  auto* batch_done = new ReffedStatusCallback(
+      [opts, done = std::move(done)](const Status& s) {
+        opts->ClearCancelCallback();
+        done(s);
+      });
+  for (int i = 0; i < num_tensors; ++i) {
+    batch_done->Ref();
+    RecvLocalTensorAsync(
+        /*opts=*/nullptr, &request->request(i), parsed[i], src_devs[i],
+        [batch_done, entry = entries[i]](const Tensor& tensor, bool is_dead,
+                                         const Status& status) {
+          if (status.ok()) {
+            entry->set_is_dead(is_dead);
+            entry->set_send_start_micros(Env::Default()->NowMicros());
+            tensor.AsProtoTensorContent(entry->mutable_tensor());
+          } else {
+            batch_done->UpdateStatus(status);
+          }
+          batch_done->Unref();
+        });
+  }
+  batch_done->Unref();
+}
+
+void GrpcWorker::RecvLocalTensorAsync(CallOptions* opts,
+                                      const RecvTensorRequest* request,
+                                      const Rendezvous::ParsedKey& parsed,
+                                      Device* src_dev,
+                                      RecvLocalTensorCallback done) {
   env_->rendezvous_mgr->RecvLocalAsync(
-      step_id, parsed,
-      [opts, rendezvous_done, src_dev, request](
+      request->step_id(), parsed,
+      [opts, done = std::move(done), src_dev, request](
           const Status& status, const Rendezvous::Args& send_args,
           const Rendezvous::Args& recv_args, const Tensor& val,
           const bool is_dead) {
-        opts->ClearCancelCallback();
+        if (opts != nullptr) {
+          opts->ClearCancelCallback();
+        }
         if (!status.ok()) {
-          return rendezvous_done(val, is_dead, status);
+          return done(val, is_dead, status);
         }
 
         const bool on_host = send_args.alloc_attrs.on_host();
         if (!src_dev->tensorflow_accelerator_device_info() || on_host) {
-          return rendezvous_done(val, is_dead, status);
+          return done(val, is_dead, status);
         }
 
         DeviceContext* send_dev_context = send_args.device_context;
@@ -540,10 +677,9 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
             << "send dev name: " << src_dev->name()
             << " gpu_info: " << src_dev->tensorflow_accelerator_device_info();
 
-        StatusCallback copy_ready = [rendezvous_done, copy,
-                                     is_dead](const Status& s) {
+        StatusCallback copy_ready = [done, copy, is_dead](const Status& s) {
           // The value is now ready to be returned on the wire.
-          rendezvous_done(*copy, is_dead, s);
+          done(*copy, is_dead, s);
           delete copy;
         };
 
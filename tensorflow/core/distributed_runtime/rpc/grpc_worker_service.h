@@ -20,9 +20,11 @@ limitations under the License.
 #include <unordered_map>
 
 #include "grpcpp/server_builder.h"
+#include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_worker_service_impl.h"
 #include "tensorflow/core/distributed_runtime/rpc/rpc_response_cache.h"
 #include "tensorflow/core/distributed_runtime/worker.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/protobuf/worker.pb.h"
 #include "tensorflow/tsl/distributed_runtime/rpc/async_service_interface.h"
 
@@ -51,6 +53,11 @@ class GrpcWorker : public Worker {
                                    ::grpc::ByteBuffer* response,
                                    StatusCallback done);
 
+  void RecvTensorBatchAsync(CallOptions* opts,
+                            const RecvTensorBatchRequest* request,
+                            RecvTensorBatchResponse* response,
+                            StatusCallback done) override;
+
   void LoggingAsync(const LoggingRequest* request, LoggingResponse* response,
                     StatusCallback done) override;
 
@@ -68,8 +75,37 @@ class GrpcWorker : public Worker {
   void RemoveCacheEntryForId(int64_t request_id);
 
  private:
+  using RecvLocalTensorCallback =
+      std::function<void(const Tensor& tensor, bool is_dead,
+                         const Status& status)>;
+
+  // Receives the tensor named by `parsed` from the local rendezvous and, if
+  // it was produced in accelerator memory, copies it to the host so that it
+  // can be encoded for the wire. If `opts` is not null, its cancel callback
+  // is cleared once the tensor is available.
+  void RecvLocalTensorAsync(CallOptions* opts,
+                            const RecvTensorRequest* request,
+                            const Rendezvous::ParsedKey& parsed,
+                            Device* src_dev, RecvLocalTensorCallback done);
+
+  // Rounds `val` to `request->wire_dtype()`, applying the error feedback of
+  // the request's edge if it asks for it.
+  void ReduceWirePrecision(const RecvTensorRequest* request, const Tensor& val,
+                           Tensor* reduced);
+
   std::unique_ptr<RpcResponseCache> response_cache_;
   const int32 recv_buf_max_chunk_;
+
+  // The rounding error of the last tensor sent with error feedback on an edge.
+  struct WireResidual {
+    mutex mu;
+    Tensor tensor TF_GUARDED_BY(mu);
+  };
+  mutex wire_residuals_mu_;
+  // Keyed by "<src_device>;<dst_device>;<edge_name>", so that the residual
+  // carries over across steps and frames.
+  absl::flat_hash_map<string, std::shared_ptr<WireResidual>> wire_residuals_
+      TF_GUARDED_BY(wire_residuals_mu_);
 };
 
 std::unique_ptr<GrpcWorker> NewGrpcWorker(WorkerEnv* worker_env,
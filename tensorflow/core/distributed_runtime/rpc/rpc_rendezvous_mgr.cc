@@ -15,6 +15,13 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/rpc_rendezvous_mgr.h"
 
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "re2/re2.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
@@ -24,22 +31,196 @@ limitations under the License.
 #include "tensorflow/core/distributed_runtime/worker_cache.h"
 #include "tensorflow/core/distributed_runtime/worker_interface.h"
 #include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/monitoring/counter.h"
+#include "tensorflow/core/lib/monitoring/sampler.h"
 #include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/notification.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
 namespace {
 
+auto* recv_tensor_calls = monitoring::Counter<1>::New(
+    "/tensorflow/rpc/client/recv_tensor_calls",
+    "Number of remote tensor receives, by the RPC that served them: "
+    "`single` for RecvTensor, `batched` for RecvTensorBatch, and `fallback` "
+    "for RecvTensor after the remote worker rejected RecvTensorBatch.",
+    "path");
+
+auto* recv_tensor_batch_size = monitoring::Sampler<0>::New(
+    {"/tensorflow/rpc/client/recv_tensor_batch_size",
+     "Number of tensors received by each RecvTensorBatch RPC."},
+    {monitoring::Buckets::Exponential(1, 2, 12)});
+
+auto* recv_tensor_batch_wait_usecs = monitoring::Sampler<0>::New(
+    {"/tensorflow/rpc/client/recv_tensor_batch_wait_usecs",
+     "Time between the first recv of a batch and the RecvTensorBatch RPC being "
+     "sent."},
+    {monitoring::Buckets::Exponential(1, 2, 20)});
+
+}  // namespace
+
+RpcRecvTensorBatchOptions RpcRecvTensorBatchOptions::FromEnv() {
+  RpcRecvTensorBatchOptions options;
+  TF_CHECK_OK(ReadInt64FromEnvVar("TF_RPC_RECV_BATCH_WINDOW_USECS",
+                                  options.window_usecs, &options.window_usecs));
+  TF_CHECK_OK(ReadInt64FromEnvVar("TF_RPC_RECV_BATCH_MAX_TENSOR_BYTES",
+                                  options.max_tensor_bytes,
+                                  &options.max_tensor_bytes));
+  TF_CHECK_OK(ReadInt64FromEnvVar("TF_RPC_RECV_BATCH_MAX_SIZE",
+                                  options.max_batch_size,
+                                  &options.max_batch_size));
+  return options;
+}
+
+// Decides which recvs are batched. Tensor sizes are not known until they are
+// received, so the policy remembers the last size seen on each edge and only
+// batches the edges that carried small tensors.
+class RecvTensorBatchPolicy {
+ public:
+  explicit RecvTensorBatchPolicy(const RpcRecvTensorBatchOptions& options)
+      : options_(options) {}
+
+  const RpcRecvTensorBatchOptions& options() const { return options_; }
+
+  bool enabled() const { return options_.window_usecs > 0; }
+
+  // Returns the key that identifies the edge of `parsed` across steps.
+  static string EdgeKey(const Rendezvous::ParsedKey& parsed) {
+    return strings::StrCat(parsed.src_device, ";", parsed.dst_device, ";",
+                           parsed.edge_name);
+  }
+
+  bool ShouldBatch(const string& src_worker, const string& edge_key) {
+    tf_shared_lock l(mu_);
+    if (unsupported_workers_.contains(src_worker)) return false;
+    auto it = edge_bytes_.find(edge_key);
+    return it != edge_bytes_.end() && it->second <= options_.max_tensor_bytes;
+  }
+
+  void RecordTensorBytes(const string& edge_key, int64_t bytes) {
+    {
+      tf_shared_lock l(mu_);
+      auto it = edge_bytes_.find(edge_key);
+      if (it != edge_bytes_.end() && it->second == bytes) return;
+    }
+    mutex_lock l(mu_);
+    edge_bytes_[edge_key] = bytes;
+  }
+
+  // Stops batching the recvs from `src_worker`, which does not implement
+  // RecvTensorBatch.
+  void DisableWorker(const string& src_worker) {
+    mutex_lock l(mu_);
+    if (unsupported_workers_.insert(src_worker).second) {
+      LOG(WARNING) << "Worker " << src_worker
+                   << " does not support RecvTensorBatch; its recvs will not "
+                      "be batched.";
+    }
+  }
+
+ private:
+  const RpcRecvTensorBatchOptions options_;
+
+  mutex mu_;
+  absl::flat_hash_map<string, int64_t> edge_bytes_ TF_GUARDED_BY(mu_);
+  absl::flat_hash_set<string> unsupported_workers_ TF_GUARDED_BY(mu_);
+};
+
+RpcRecvTensorWireOptions RpcRecvTensorWireOptions::FromEnv() {
+  RpcRecvTensorWireOptions options;
+  string wire_dtype;
+  TF_CHECK_OK(ReadStringFromEnvVar("TF_RPC_RECV_WIRE_DTYPE", "", &wire_dtype));
+  if (!wire_dtype.empty() &&
+      (!DataTypeFromString(wire_dtype, &options.wire_dtype) ||
+       (options.wire_dtype != DT_BFLOAT16 && options.wire_dtype != DT_HALF))) {
+    LOG(ERROR) << "Ignoring TF_RPC_RECV_WIRE_DTYPE=" << wire_dtype
+               << ", which must be bfloat16 or half.";
+    options.wire_dtype = DT_INVALID;
+  }
+  TF_CHECK_OK(ReadStringFromEnvVar("TF_RPC_RECV_WIRE_EDGE_REGEX", "",
+                                   &options.edge_name_regex));
+  TF_CHECK_OK(ReadInt64FromEnvVar("TF_RPC_RECV_WIRE_MIN_BYTES",
+                                  options.min_tensor_bytes,
+                                  &options.min_tensor_bytes));
+  TF_CHECK_OK(ReadBoolFromEnvVar("TF_RPC_RECV_WIRE_ERROR_FEEDBACK",
+                                 options.error_feedback,
+                                 &options.error_feedback));
+  return options;
+}
+
+// Decides which recvs ask the sender for a reduced-precision encoding.
+class RecvTensorWirePolicy {
+ public:
+  explicit RecvTensorWirePolicy(const RpcRecvTensorWireOptions& options)
+      : options_(options) {
+    if (!enabled() || options_.edge_name_regex.empty()) return;
+    edge_name_regex_ = std::make_unique<RE2>(options_.edge_name_regex);
+    if (!edge_name_regex_->ok()) {
+      LOG(ERROR) << "Invalid edge name regex \"" << options_.edge_name_regex
+                 << "\": " << edge_name_regex_->error()
+                 << ". Tensors will be received at full precision.";
+      options_.wire_dtype = DT_INVALID;
+    }
+  }
+
+  bool enabled() const { return options_.wire_dtype != DT_INVALID; }
+
+  void Apply(const Rendezvous::ParsedKey& parsed, const Device* dst_device,
+             const AllocatorAttributes& alloc_attrs,
+             RecvTensorRequest* req) const {
+    if (!enabled()) return;
+    // The receiver restores the precision on the host.
+    if (!alloc_attrs.on_host() && dst_device->device_type() != DEVICE_CPU) {
+      return;
+    }
+    if (edge_name_regex_ != nullptr &&
+        !RE2::FullMatch(
+            absl::string_view(parsed.edge_name.data(), parsed.edge_name.size()),
+            *edge_name_regex_)) {
+      return;
+    }
+    req->set_wire_dtype(options_.wire_dtype);
+    req->set_wire_min_bytes(options_.min_tensor_bytes);
+    req->set_wire_error_feedback(options_.error_feedback);
+  }
+
+ private:
+  RpcRecvTensorWireOptions options_;
+  std::unique_ptr<RE2> edge_name_regex_;
+};
+
+namespace {
+
+class RpcRecvTensorCall;
+
+// The recvs of one step from one remote worker that are sent together.
+struct RecvTensorBatch {
+  std::vector<std::pair<RpcRecvTensorCall*, std::function<void()>>> calls;
+  int64_t start_micros = 0;
+  CallOptions opts;
+  RecvTensorBatchRequest req;
+  RecvTensorBatchResponse resp;
+  // Notified once the calls forward their aborts to `opts`.
+  Notification abort_checked;
+};
+
 class RpcRemoteRendezvous : public BaseRemoteRendezvous {
  public:
-  RpcRemoteRendezvous(const WorkerEnv* env, int64_t step_id)
-      : BaseRemoteRendezvous(env, step_id) {}
+  RpcRemoteRendezvous(const WorkerEnv* env, int64_t step_id,
+                      std::shared_ptr<RecvTensorBatchPolicy> batch_policy,
+                      std::shared_ptr<const RecvTensorWirePolicy> wire_policy)
+      : BaseRemoteRendezvous(env, step_id),
+        batch_policy_(std::move(batch_policy)),
+        wire_policy_(std::move(wire_policy)) {}
 
  protected:
   void RecvFromRemoteAsync(const Rendezvous::ParsedKey& parsed,
@@ -49,6 +230,25 @@ class RpcRemoteRendezvous : public BaseRemoteRendezvous {
  private:
   ~RpcRemoteRendezvous() override {}
 
+  // Adds `call` to the pending batch for its worker, starting a new batch if
+  // there is none.
+  void AddToBatch(RpcRecvTensorCall* call, std::function<void()> recv_done);
+
+  // Sends the pending batch for `src_worker` if it is still `expected`.
+  void FlushBatch(const string& src_worker, const RecvTensorBatch* expected);
+
+  void SendBatch(std::shared_ptr<RecvTensorBatch> batch);
+
+  void FinishBatch(const std::shared_ptr<RecvTensorBatch>& batch, Status s);
+
+  const std::shared_ptr<RecvTensorBatchPolicy> batch_policy_;
+  const std::shared_ptr<const RecvTensorWirePolicy> wire_policy_;
+
+  mutex mu_;
+  // Keyed by the name of the remote worker.
+  absl::flat_hash_map<string, std::shared_ptr<RecvTensorBatch>> pending_batches_
+      TF_GUARDED_BY(mu_);
+
   TF_DISALLOW_COPY_AND_ASSIGN(RpcRemoteRendezvous);
 };
 
@@ -126,6 +326,7 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
   bool is_dead() const { return resp_.metadata().is_dead(); }
 
   Device* dst_device() const { return dst_device_; }
+  const string& src_worker() const { return src_worker_; }
   const Rendezvous::Args& recv_args() const { return recv_args_; }
   const Rendezvous::DoneCallback& done() const { return done_; }
 
@@ -166,6 +367,29 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
     abort_checked->Notify();
   }
 
+  // Prepares this call to be sent as part of `batch`: forwards aborts to the
+  // batch RPC and returns the request to add to it.
+  const RecvTensorRequest& PrepareBatched(
+      const std::shared_ptr<RecvTensorBatch>& batch) {
+    resp_.InitAlloc(dst_device_, alloc_attrs_);
+    opts_.SetCancelCallback([batch]() { batch->opts.StartCancel(); });
+    return req_;
+  }
+
+  // Completes a batched call with the status of the batch RPC and, if it
+  // succeeded, the call's element of the batch response.
+  void FinishBatched(const Status& s, RecvTensorResponse* response) {
+    opts_.ClearCancelCallback();
+    Status status = s;
+    if (status.ok()) {
+      status = resp_.InitFrom(response);
+    }
+    if (!status.ok()) {
+      mutex_lock l(mu_);
+      status_.Update(status);
+    }
+  }
+
   string src_worker_;
   string src_rel_device_;
   WorkerInterface* wi_;  // Not owned.
@@ -269,6 +493,7 @@ void RpcRemoteRendezvous::RecvFromRemoteAsync(
 
   call->Init(rwi, step_id_, parsed.FullKey(), recv_args.alloc_attrs, dst_device,
              recv_args, std::move(done));
+  wire_policy_->Apply(parsed, dst_device, recv_args.alloc_attrs, &call->req_);
 
   // Record "call" in calls_ so that it can be aborted cleanly.
   RegisterCall(call, recv_args);
@@ -285,14 +510,26 @@ void RpcRemoteRendezvous::RecvFromRemoteAsync(
     return;
   }
 
+  // The sizes of the tensors are only tracked if batching is enabled.
+  string edge_key;
+  bool batched = false;
+  if (batch_policy_->enabled()) {
+    edge_key = RecvTensorBatchPolicy::EdgeKey(parsed);
+    batched = batch_policy_->ShouldBatch(call->src_worker(), edge_key);
+  }
+
   // Start "call".
   Ref();
-  call->Start([this, call, recv_args, worker_cache]() {
+  auto recv_done = [this, call, recv_args, worker_cache,
+                    edge_key = std::move(edge_key)]() {
     // Removes "call" from calls_. Prevent StartAbort().
     DeregisterCall(call, recv_args);
     // If StartAbort was called prior to DeregisterCall, then the
     // current status should be bad.
     Status s = call->status();
+    if (s.ok() && !edge_key.empty() && !call->is_dead()) {
+      batch_policy_->RecordTensorBytes(edge_key, call->tensor().TotalBytes());
+    }
     // NOTE: `*session()` can potentially be deleted before we return from
     // `call->done()(...)`, so we must release the worker before calling the
     // callback.
@@ -300,18 +537,157 @@ void RpcRemoteRendezvous::RecvFromRemoteAsync(
     call->done()(s, Args(), call->recv_args(), call->tensor(), call->is_dead());
     get_call_freelist()->Release(call);
     Unref();
-  });
+  };
+  if (batched) {
+    AddToBatch(call, std::move(recv_done));
+  } else {
+    if (batch_policy_->enabled()) {
+      recv_tensor_calls->GetCell("single")->IncrementBy(1);
+    }
+    call->Start(std::move(recv_done));
+  }
+}
+
+void RpcRemoteRendezvous::AddToBatch(RpcRecvTensorCall* call,
+                                     std::function<void()> recv_done) {
+  std::shared_ptr<RecvTensorBatch> full_batch;
+  {
+    mutex_lock l(mu_);
+    std::shared_ptr<RecvTensorBatch>& batch =
+        pending_batches_[call->src_worker()];
+    if (batch == nullptr) {
+      batch = std::make_shared<RecvTensorBatch>();
+      batch->start_micros = env_->env->NowMicros();
+      Ref();
+      env_->env->SchedClosureAfter(
+          batch_policy_->options().window_usecs,
+          [this, src_worker = call->src_worker(), expected = batch.get()]() {
+            FlushBatch(src_worker, expected);
+            Unref();
+          });
+    }
+    batch->calls.emplace_back(call, std::move(recv_done));
+    if (static_cast<int64_t>(batch->calls.size()) >=
+        batch_policy_->options().max_batch_size) {
+      full_batch = std::move(batch);
+      pending_batches_.erase(call->src_worker());
+    }
+  }
+  if (full_batch != nullptr) {
+    SendBatch(std::move(full_batch));
+  }
+}
+
+void RpcRemoteRendezvous::FlushBatch(const string& src_worker,
+                                     const RecvTensorBatch* expected) {
+  std::shared_ptr<RecvTensorBatch> batch;
+  {
+    mutex_lock l(mu_);
+    auto it = pending_batches_.find(src_worker);
+    // The batch may have been sent already because it filled up.
+    if (it == pending_batches_.end() || it->second.get() != expected) return;
+    batch = std::move(it->second);
+    pending_batches_.erase(it);
+  }
+  SendBatch(std::move(batch));
+}
+
+void RpcRemoteRendezvous::SendBatch(std::shared_ptr<RecvTensorBatch> batch) {
+  recv_tensor_batch_wait_usecs->GetCell()->Add(env_->env->NowMicros() -
+                                               batch->start_micros);
+  // Calls that were aborted while waiting for the batch are finished without
+  // being sent.
+  auto& calls = batch->calls;
+  std::vector<std::pair<RpcRecvTensorCall*, std::function<void()>>> live_calls;
+  live_calls.reserve(calls.size());
+  for (auto& call : calls) {
+    if (call.first->status().ok()) {
+      live_calls.push_back(std::move(call));
+    } else {
+      call.second();
+    }
+  }
+  calls.swap(live_calls);
+  if (calls.empty()) return;
+  if (calls.size() == 1) {
+    recv_tensor_calls->GetCell("single")->IncrementBy(1);
+    calls[0].first->Start(std::move(calls[0].second));
+    return;
+  }
+
+  recv_tensor_calls->GetCell("batched")->IncrementBy(calls.size());
+  recv_tensor_batch_size->GetCell()->Add(calls.size());
+  batch->req.set_step_id(step_id_);
+  batch->req.set_request_id(GetUniqueRequestId());
+  for (auto& call : calls) {
+    *batch->req.add_request() = call.first->PrepareBatched(batch);
+  }
+  // Every call of the batch holds the same worker until it is finished.
+  WorkerInterface* wi = calls[0].first->wi_;
+  Ref();
+  wi->RecvTensorBatchAsync(&batch->opts, &batch->req, &batch->resp,
+                           [this, batch](const Status& s) {
+                             FinishBatch(batch, s);
+                             Unref();
+                           });
+
+  // NOTE: As in `RpcRecvTensorCall::StartRTCall()`, check for aborts that
+  // happened before the calls forwarded them to the batch RPC.
+  for (auto& call : calls) {
+    if (!call.first->status().ok()) {
+      batch->opts.StartCancel();
+      break;
+    }
+  }
+  batch->abort_checked.Notify();
+}
+
+void RpcRemoteRendezvous::FinishBatch(
+    const std::shared_ptr<RecvTensorBatch>& batch, Status s) {
+  // The calls, which may be destroyed by their callbacks, must not be touched
+  // by `SendBatch()` anymore.
+  batch->abort_checked.WaitForNotification();
+  auto& calls = batch->calls;
+  if (errors::IsUnimplemented(s)) {
+    batch_policy_->DisableWorker(calls[0].first->src_worker());
+    recv_tensor_calls->GetCell("fallback")->IncrementBy(calls.size());
+    for (auto& call : calls) {
+      call.first->opts_.ClearCancelCallback();
+      call.first->Start(std::move(call.second));
+    }
+    return;
+  }
+  const int num_calls = calls.size();
+  if (s.ok() && batch->resp.response_size() != num_calls) {
+    s = errors::Internal("RecvTensorBatch returned ",
+                         batch->resp.response_size(), " tensors, expected ",
+                         num_calls);
+  }
+  for (int i = 0; i < num_calls; ++i) {
+    calls[i].first->FinishBatched(
+        s, s.ok() ? batch->resp.mutable_response(i) : nullptr);
+    calls[i].second();
+  }
 }
 
 }  // namespace
 
 RpcRendezvousMgr::RpcRendezvousMgr(const WorkerEnv* env)
-    : BaseRendezvousMgr(env) {}
+    : RpcRendezvousMgr(env, RpcRecvTensorBatchOptions::FromEnv(),
+                       RpcRecvTensorWireOptions::FromEnv()) {}
+
+RpcRendezvousMgr::RpcRendezvousMgr(
+    const WorkerEnv* env, const RpcRecvTensorBatchOptions& batch_options,
+    const RpcRecvTensorWireOptions& wire_options)
+    : BaseRendezvousMgr(env),
+      batch_policy_(std::make_shared<RecvTensorBatchPolicy>(batch_options)),
+      wire_policy_(std::make_shared<RecvTensorWirePolicy>(wire_options)) {}
 
 tsl::core::RefCountPtr<BaseRemoteRendezvous> RpcRendezvousMgr::Create(
     int64_t step_id, const WorkerEnv* worker_env) {
   return tsl::core::RefCountPtr<BaseRemoteRendezvous>(
-      new RpcRemoteRendezvous(worker_env, step_id));
+      new RpcRemoteRendezvous(worker_env, step_id, batch_policy_,
+                              wire_policy_));
 }
 
 }  // end namespace tensorflow
@@ -16,13 +16,64 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_RPC_RENDEZVOUS_MGR_H_
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_RPC_RENDEZVOUS_MGR_H_
 
+#include <memory>
+
 #include "tensorflow/core/distributed_runtime/base_rendezvous_mgr.h"
 #include "tensorflow/core/distributed_runtime/worker_env.h"
+#include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/platform/macros.h"
 
 namespace tensorflow {
 
 class DeviceMgr;
+class RecvTensorBatchPolicy;
+class RecvTensorWirePolicy;
+
+// Options for coalescing the RecvTensor RPCs that a step issues to the same
+// remote worker into RecvTensorBatch RPCs.
+struct RpcRecvTensorBatchOptions {
+  // How long the first pending recv of a batch waits for more recvs before
+  // the batch is sent. Zero disables batching.
+  int64_t window_usecs = 0;
+
+  // The recvs of an edge are only batched if the last tensor received on that
+  // edge was at most this many bytes. Edges that have not been received on
+  // yet use a RecvTensor RPC.
+  int64_t max_tensor_bytes = 4096;
+
+  // A batch is sent as soon as it has this many recvs.
+  int64_t max_batch_size = 256;
+
+  // Returns the options set by the TF_RPC_RECV_BATCH_WINDOW_USECS,
+  // TF_RPC_RECV_BATCH_MAX_TENSOR_BYTES and TF_RPC_RECV_BATCH_MAX_SIZE
+  // environment variables.
+  static RpcRecvTensorBatchOptions FromEnv();
+};
+
+// Options for receiving DT_FLOAT tensors at a reduced precision, to save
+// network bandwidth. Only tensors received into host memory are reduced.
+struct RpcRecvTensorWireOptions {
+  // DT_BFLOAT16 or DT_HALF to reduce the precision of tensors on the wire.
+  // DT_INVALID sends every tensor at full precision.
+  DataType wire_dtype = DT_INVALID;
+
+  // Only the edges whose name fully matches this regular expression are
+  // reduced. An empty expression matches every edge.
+  string edge_name_regex;
+
+  // Tensors smaller than this are sent at full precision.
+  int64_t min_tensor_bytes = 4096;
+
+  // Whether the sender carries the rounding error of an edge over to the next
+  // tensor it sends on that edge. Only appropriate if every selected edge
+  // carries values that the receiver accumulates, such as gradients.
+  bool error_feedback = false;
+
+  // Returns the options set by the TF_RPC_RECV_WIRE_DTYPE ("bfloat16" or
+  // "half"), TF_RPC_RECV_WIRE_EDGE_REGEX, TF_RPC_RECV_WIRE_MIN_BYTES and
+  // TF_RPC_RECV_WIRE_ERROR_FEEDBACK environment variables.
+  static RpcRecvTensorWireOptions FromEnv();
+};
 
 // RendezvousMgr keeps track of a set of local rendezvous instances.
 // All tensors sent by this worker are buffered in a RendezvousMgr
@@ -42,15 +93,29 @@ class DeviceMgr;
 //
 // Tensors sent and recved through rendezvous managed by this
 // RendezvousMgr must have keys generated by Rendezvous::CreateKey.
+//
+// Recvs of small tensors can be batched: see `RpcRecvTensorBatchOptions`.
+// Batching is only effective if the remote workers implement the
+// RecvTensorBatch RPC; workers that do not are served with RecvTensor RPCs.
+// Float tensors can be received at a reduced precision: see
+// `RpcRecvTensorWireOptions`.
 class RpcRendezvousMgr : public BaseRendezvousMgr {
  public:
   explicit RpcRendezvousMgr(const WorkerEnv* env);
+  RpcRendezvousMgr(const WorkerEnv* env,
+                   const RpcRecvTensorBatchOptions& batch_options,
+                   const RpcRecvTensorWireOptions& wire_options =
+                       RpcRecvTensorWireOptions());
 
  protected:
   tsl::core::RefCountPtr<BaseRemoteRendezvous> Create(
       int64_t step_id, const WorkerEnv* worker_env) override;
 
  private:
+  // Shared with the rendezvous created by this manager, which may outlive it.
+  const std::shared_ptr<RecvTensorBatchPolicy> batch_policy_;
+  const std::shared_ptr<const RecvTensorWirePolicy> wire_policy_;
+
   TF_DISALLOW_COPY_AND_ASSIGN(RpcRendezvousMgr);
 };
 
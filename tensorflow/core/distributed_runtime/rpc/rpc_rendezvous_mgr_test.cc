@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/rpc_rendezvous_mgr.h"
 
+#include <atomic>
+
 #include "tensorflow/core/common_runtime/process_util.h"
 #include "tensorflow/core/distributed_runtime/test_utils.h"
 #include "tensorflow/core/framework/cancellation.h"
@@ -22,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/blocking_counter.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
@@ -66,6 +69,33 @@ class DummyWorker : public TestWorkerInterface {
       done(OkStatus());
     });
   }
+
+  void RecvTensorBatchAsync(CallOptions* opts,
+                            const RecvTensorBatchRequest* request,
+                            RecvTensorBatchResponse* response,
+                            StatusCallback done) override {
+    if (!supports_batching_) {
+      done(errors::Unimplemented("RecvTensorBatchAsync"));
+      return;
+    }
+    num_batches_++;
+    SchedClosure([request, response, done = std::move(done)]() {
+      for (const RecvTensorRequest& recv_request : request->request()) {
+        V(recv_request.rendezvous_key())
+            .AsProtoTensorContent(response->add_response()->mutable_tensor());
+      }
+      done(OkStatus());
+    });
+  }
+
+  void set_supports_batching(bool supports_batching) {
+    supports_batching_ = supports_batching;
+  }
+  int num_batches() const { return num_batches_; }
+
+ private:
+  std::atomic<bool> supports_batching_{true};
+  std::atomic<int> num_batches_{0};
 };
 
 // Fake cache implementation for WorkerEnv.
@@ -80,6 +110,7 @@ class DummyWorkerCache : public WorkerCacheInterface {
     }
     return dummy_remote_worker_;
   }
+  DummyWorker* dummy_remote_worker() { return dummy_remote_worker_; }
   Status GetEagerClientCache(
       std::unique_ptr<eager::EagerClientCache>* eager_client_cache) override {
     return errors::Unimplemented("Unimplemented.");
@@ -104,7 +135,9 @@ static Device* CreateDevice(const char* type, const char* name) {
    public:
     explicit FakeDevice(const DeviceAttributes& attr) : Device(nullptr, attr) {}
     Status Sync() override { return OkStatus(); }
-    Allocator* GetAllocator(AllocatorAttributes) override { return nullptr; }
+    Allocator* GetAllocator(AllocatorAttributes) override {
+      return cpu_allocator();
+    }
   };
   DeviceAttributes attr;
   attr.set_name(name);
@@ -342,4 +375,73 @@ TEST_F(RpcRendezvousMgrTest, RemoteRecvAsyncMany) {
   rmgr_.Cleanup(step_id);
 }
 
+// Receives `num_steps` steps of the edges "edge0".."edge<num_edges - 1>",
+// and checks that every batched tensor is the rendezvous key it was sent for.
+void RecvEdges(RendezvousMgrInterface* rmgr, WorkerSession* session,
+               int num_steps, int num_edges) {
+  for (int64_t step_id = 1; step_id <= num_steps; ++step_id) {
+    {
+      tsl::core::RefCountPtr<RemoteRendezvous> rendez = rmgr->Find(step_id);
+      TF_ASSERT_OK(rendez->Initialize(session));
+      mutex mu;
+      Status status = OkStatus();
+      BlockingCounter counter(num_edges);
+      for (int i = 0; i < num_edges; ++i) {
+        const string key = Rendezvous::CreateKey(
+            "/job:worker/replica:1/task:2/cpu:0", 7890,
+            "/job:mnist/replica:1/task:2/cpu:1", strings::StrCat("edge", i),
+            FrameAndIter(0, 0));
+        rendez->RecvAsync(
+            MakeKey(key), Rendezvous::Args(),
+            [&mu, &status, &counter, key](
+                const Status& s, const Rendezvous::Args&,
+                const Rendezvous::Args&, const Tensor& val, const bool) {
+              mutex_lock l(mu);
+              status.Update(s);
+              if (s.ok() && val.dtype() == DT_STRING) {
+                EXPECT_EQ(V(val), key);
+              }
+              counter.DecrementCount();
+            });
+      }
+      counter.Wait();
+      TF_ASSERT_OK(status);
+    }
+    rmgr->Cleanup(step_id);
+  }
+}
+
+TEST_F(RpcRendezvousMgrTest, RemoteRecvBatched) {
+  RpcRecvTensorBatchOptions options;
+  options.window_usecs = 100 * 1000;
+  RpcRendezvousMgr rmgr(&env, options);
+
+  // The first step learns the sizes of the edges, which are only batched in
+  // the following steps.
+  RecvEdges(&rmgr, &worker_session_, /*num_steps=*/3, /*num_edges=*/8);
+  EXPECT_EQ(cache_->dummy_remote_worker()->num_batches(), 2);
+}
+
+TEST_F(RpcRendezvousMgrTest, RemoteRecvBatchedMaxBatchSize) {
+  RpcRecvTensorBatchOptions options;
+  options.window_usecs = 100 * 1000;
+  options.max_batch_size = 4;
+  RpcRendezvousMgr rmgr(&env, options);
+
+  RecvEdges(&rmgr, &worker_session_, /*num_steps=*/2, /*num_edges=*/8);
+  EXPECT_EQ(cache_->dummy_remote_worker()->num_batches(), 2);
+}
+
+TEST_F(RpcRendezvousMgrTest, RemoteRecvBatchedUnimplemented) {
+  RpcRecvTensorBatchOptions options;
+  options.window_usecs = 100 * 1000;
+  RpcRendezvousMgr rmgr(&env, options);
+
+  // Creates the remote worker and learns the sizes of the edges.
+  RecvEdges(&rmgr, &worker_session_, /*num_steps=*/1, /*num_edges=*/8);
+  cache_->dummy_remote_worker()->set_supports_batching(false);
+  RecvEdges(&rmgr, &worker_session_, /*num_steps=*/3, /*num_edges=*/8);
+  EXPECT_EQ(cache_->dummy_remote_worker()->num_batches(), 0);
+}
+
 }  // namespace tensorflow
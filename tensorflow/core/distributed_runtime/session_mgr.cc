@@ -302,6 +302,15 @@ Status SessionMgr::CreateSession(
         coordination_config,
         agent_cache->GetOwnedClient(coordination_config.service_leader()),
         std::move(coordination_error_callback)));
+    CoordinatedTask task;
+    task.set_job_name(server_def.job_name());
+    task.set_task_id(server_def.task_index());
+    if (auto parent = tsl::GetHeartbeatParent(coordination_config, task)) {
+      TF_RETURN_IF_ERROR(coordination_service_agent_->SetHeartbeatParentClient(
+          agent_cache->GetOwnedClient(
+              strings::StrCat("/job:", parent->job_name(),
+                              "/replica:0/task:", parent->task_id()))));
+    }
 
     activity_watcher::MaybeEnableMultiWorkersWatching(
         coordination_service_agent_.get());
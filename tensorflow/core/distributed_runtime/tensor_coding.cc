@@ -15,14 +15,87 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/tensor_coding.h"
 
+#include <algorithm>
+#include <list>
+
 #include "google/protobuf/any.pb.h"
 
 #include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/framework/tensor_types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/notification.h"
 
 namespace tensorflow {
 
+namespace {
+
+// Size of the chunks in which parsed tensor contents are copied to the
+// device, so that copying a chunk overlaps with parsing the next ones.
+constexpr int64_t kDeviceCopyChunkBytes = 8 << 20;
+
+template <typename T>
+void ReduceWirePrecisionImpl(const Tensor& val, Tensor* residual, Tensor* out) {
+  auto reduced = out->flat<T>();
+  if (residual == nullptr) {
+    reduced = val.flat<float>().template cast<T>();
+    return;
+  }
+  if (residual->dtype() != DT_FLOAT || residual->shape() != val.shape()) {
+    *residual = Tensor(DT_FLOAT, val.shape());
+    residual->flat<float>().setZero();
+  }
+  auto error = residual->flat<float>();
+  error += val.flat<float>();
+  reduced = error.template cast<T>();
+  error -= reduced.template cast<float>();
+}
+
+}  // namespace
+
+bool CanReduceWirePrecision(const Tensor& val, DataType wire_dtype) {
+  return val.dtype() == DT_FLOAT &&
+         (wire_dtype == DT_BFLOAT16 || wire_dtype == DT_HALF);
+}
+
+void ReduceWirePrecision(const Tensor& val, DataType wire_dtype,
+                         Tensor* residual, Tensor* out) {
+  DCHECK(CanReduceWirePrecision(val, wire_dtype));
+  *out = Tensor(wire_dtype, val.shape());
+  if (wire_dtype == DT_BFLOAT16) {
+    ReduceWirePrecisionImpl<bfloat16>(val, residual, out);
+  } else {
+    ReduceWirePrecisionImpl<Eigen::half>(val, residual, out);
+  }
+}
+
+Status RestoreWirePrecision(Allocator* allocator, const Tensor& val,
+                            DataType dtype, Tensor* out) {
+  if (dtype != DT_FLOAT) {
+    return errors::InvalidArgument("Cannot restore a tensor sent as ",
+                                   DataTypeString(val.dtype()), " to ",
+                                   DataTypeString(dtype));
+  }
+  Tensor restored(allocator, dtype, val.shape());
+  switch (val.dtype()) {
+    case DT_BFLOAT16:
+      restored.flat<float>() = val.flat<bfloat16>().cast<float>();
+      break;
+    case DT_HALF:
+      restored.flat<float>() = val.flat<Eigen::half>().cast<float>();
+      break;
+    default:
+      return errors::InvalidArgument("Cannot restore a tensor sent as ",
+                                     DataTypeString(val.dtype()), " to ",
+                                     DataTypeString(dtype));
+  }
+  *out = std::move(restored);
+  return OkStatus();
+}
+
 TensorResponse::Source::~Source() {}
 
 void TensorResponse::Clear() {
@@ -30,6 +103,7 @@ void TensorResponse::Clear() {
   device_ = nullptr;
   alloc_attrs_ = AllocatorAttributes();
   allocator_ = nullptr;
+  device_context_ = nullptr;
   already_used_ = false;
   ClearTensor();
 }
@@ -46,6 +120,12 @@ void TensorResponse::InitAlloc(DeviceBase* d, const AllocatorAttributes& aa) {
   const DeviceAttributes& da = d->attributes();
   if (alloc_attrs_.on_host() || da.device_type() == "CPU") {
     on_host_ = true;
+  } else if (da.device_type() == "GPU") {
+    const DeviceBase::AcceleratorDeviceInfo* device_info =
+        device_->tensorflow_accelerator_device_info();
+    if (device_info != nullptr) {
+      device_context_ = device_info->default_context;
+    }
   }
   allocator_ = device_->GetAllocator(alloc_attrs_);
 }
@@ -65,9 +145,22 @@ Status TensorResponse::InitFrom(RecvTensorResponse* response) {
     meta_.mutable_tensor()->Swap(&empty);
   }
   meta_.clear_tensor();
+  if (s.ok()) {
+    s = RestoreOriginalDtype();
+  }
   return s;
 }
 
+Status TensorResponse::RestoreOriginalDtype() {
+  const DataType dtype = meta_.original_dtype();
+  if (dtype == DT_INVALID || dtype == tensor_.dtype()) return OkStatus();
+  if (!on_host_) {
+    return errors::Unimplemented(
+        "Tensors sent at reduced precision must be received in host memory");
+  }
+  return RestoreWirePrecision(allocator_, tensor_, dtype, &tensor_);
+}
+
 void TensorResponse::InitPartial(const RecvTensorResponse& response,
                                  const AllocationAttributes& allocation_attr) {
   // Everything except content is present in *response.  Content will
@@ -80,6 +173,14 @@ void TensorResponse::InitPartial(const RecvTensorResponse& response,
 }
 
 Status TensorResponse::ParseFrom(Source* source) {
+  if (already_used_) {
+    ClearTensor();
+  }
+  already_used_ = true;
+  if (on_host_ || device_context_ != nullptr) {
+    if (ParseFast(source)) return RestoreOriginalDtype();
+    meta_.Clear();
+  }
   if (!on_host_) {
     protobuf::io::CodedInputStream input(source->contents());
 
@@ -95,15 +196,12 @@ Status TensorResponse::ParseFrom(Source* source) {
       meta_.mutable_tensor()->Swap(&empty);
     }
     meta_.clear_tensor();
+    if (s.ok()) {
+      s = RestoreOriginalDtype();
+    }
     return s;
   }
-  if (already_used_) {
-    ClearTensor();
-  }
-  already_used_ = true;
-  if (ParseFast(source)) return OkStatus();
-  meta_.Clear();
-  if (ParseSlow(source)) return OkStatus();
+  if (ParseSlow(source)) return RestoreOriginalDtype();
   return errors::InvalidArgument("Cannot parse tensor from response");
 }
 
@@ -198,11 +296,15 @@ bool TensorResponse::ParseTensorSubmessage(
         Tensor t(allocator_, tensor_meta->dtype(), shape);
         StringPiece buf = t.tensor_data();
         if (static_cast<size_t>(num_bytes) != buf.size()) return false;
-        // TODO(jeff,sanjay): Figure out a way to avoid this copy if
-        // the underlying ZeroCopyInputStream data is properly aligned
-        // and compatible with what allocator_ wants.
-        if (!input->ReadRaw(const_cast<char*>(buf.data()), num_bytes))
-          return false;
+        if (device_context_ != nullptr) {
+          if (!ReadTensorContentToDevice(input, &t)) return false;
+        } else {
+          // TODO(jeff,sanjay): Figure out a way to avoid this copy if
+          // the underlying ZeroCopyInputStream data is properly aligned
+          // and compatible with what allocator_ wants.
+          if (!input->ReadRaw(const_cast<char*>(buf.data()), num_bytes))
+            return false;
+        }
         tensor_ = std::move(t);
         break;
       }
@@ -215,6 +317,64 @@ bool TensorResponse::ParseTensorSubmessage(
   }
 }
 
+bool TensorResponse::ReadTensorContentToDevice(
+    protobuf::io::CodedInputStream* input, Tensor* device_tensor) {
+  AllocatorAttributes host_attrs;
+  host_attrs.set_on_host(true);
+  host_attrs.set_gpu_compatible(true);
+  Tensor host_tensor(device_->GetAllocator(host_attrs), device_tensor->dtype(),
+                     device_tensor->shape());
+  // Flatten both tensors so that they can be sliced into chunks.
+  const int64_t num_elements = device_tensor->NumElements();
+  Tensor src;
+  Tensor dst;
+  if (!src.CopyFrom(host_tensor, TensorShape({num_elements})) ||
+      !dst.CopyFrom(*device_tensor, TensorShape({num_elements}))) {
+    return false;
+  }
+  const int64_t chunk_elements = std::max<int64_t>(
+      1, kDeviceCopyChunkBytes / DataTypeSize(device_tensor->dtype()));
+
+  Device* device = static_cast<Device*>(device_);
+  // The copies are waited for before returning, since `device_tensor` does
+  // not outlive a failed parse.
+  std::list<Notification> notifications;
+  std::list<Tensor> dst_chunks;
+  mutex mu;
+  Status copy_status;
+  bool ok = true;
+  for (int64_t start = 0; start < num_elements; start += chunk_elements) {
+    const int64_t limit = std::min(start + chunk_elements, num_elements);
+    Tensor src_chunk = src.Slice(start, limit);
+    StringPiece buf = src_chunk.tensor_data();
+    if (!input->ReadRaw(const_cast<char*>(buf.data()), buf.size())) {
+      ok = false;
+      break;
+    }
+    dst_chunks.push_back(dst.Slice(start, limit));
+    notifications.emplace_back();
+    Notification& n = notifications.back();
+    device_context_->CopyCPUTensorToDevice(
+        &src_chunk, device, &dst_chunks.back(),
+        [&n, &mu, &copy_status](const Status& s) {
+          {
+            mutex_lock l(mu);
+            copy_status.Update(s);
+          }
+          n.Notify();
+        });
+  }
+  for (auto& n : notifications) {
+    n.WaitForNotification();
+  }
+  if (!copy_status.ok()) {
+    LOG(WARNING) << "Failed to copy received tensor to "
+                 << device_->attributes().name() << ": " << copy_status;
+    return false;
+  }
+  return ok;
+}
+
 bool TensorResponse::ParseFast(Source* source) {
   protobuf::io::CodedInputStream input(source->contents());
   while (true) {
@@ -265,6 +425,12 @@ bool TensorResponse::ParseFast(Source* source) {
         meta_.set_require_ack(v != 0);
         break;
       }
+      case RecvTensorResponse::kOriginalDtypeFieldNumber: {
+        uint32 v;
+        if ((wt != WIRETYPE_VARINT) || !input.ReadVarint32(&v)) return false;
+        meta_.set_original_dtype(static_cast<DataType>(static_cast<int>(v)));
+        break;
+      }
       default: {
         // Unknown tag, so don't handle we can't handle on the fast path
         return false;
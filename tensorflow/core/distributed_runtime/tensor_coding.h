@@ -18,6 +18,7 @@ limitations under the License.
 
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/types.h"
@@ -26,8 +27,28 @@ limitations under the License.
 namespace tensorflow {
 
 class DeviceBase;
+class DeviceContext;
 class TensorProto;
 
+// Returns true if `val` can be sent as `wire_dtype` and restored with
+// `RestoreWirePrecision()`: `val` must be DT_FLOAT and `wire_dtype`
+// DT_BFLOAT16 or DT_HALF.
+bool CanReduceWirePrecision(const Tensor& val, DataType wire_dtype);
+
+// Rounds `val` to `wire_dtype` into `*out`, which is allocated on the host.
+// REQUIRES: CanReduceWirePrecision(val, wire_dtype).
+//
+// If `residual` is not null, it is added to `val` before rounding and then set
+// to the rounding error, so that the error is sent with the next tensor
+// instead of being lost. A `residual` of another shape is treated as zero.
+void ReduceWirePrecision(const Tensor& val, DataType wire_dtype,
+                         Tensor* residual, Tensor* out);
+
+// Casts `val`, received as a reduced-precision dtype, back to `dtype` into
+// `*out`, allocated with `allocator`.
+Status RestoreWirePrecision(Allocator* allocator, const Tensor& val,
+                            DataType dtype, Tensor* out);
+
 // TensorResponse can be used as the destination of an RPC that returns
 // a RecvTensorResponse.  It efficiently decodes the incoming data
 // into Tensor contents as well as associated metadata.
@@ -43,6 +64,11 @@ class TensorResponse {
   void ClearTensor();
 
   // Initialize memory allocation related members.
+  //
+  // When `d` is a GPU and `aa` is not on host, ParseFrom allocates the tensor
+  // on `d` from the dtype and shape in the response and copies its contents
+  // to `d` in chunks through pinned host memory while it parses them, instead
+  // of parsing them into a host tensor first.
   void InitAlloc(DeviceBase* d, const AllocatorAttributes& aa);
 
   // Source provides a way for a particular RPC implementation to provide
@@ -91,15 +117,26 @@ class TensorResponse {
   DeviceBase* device() const { return device_; }
 
  private:
+  // Casts `tensor_` back to `meta_.original_dtype()`, if it was sent at a
+  // reduced precision.
+  Status RestoreOriginalDtype();
+
   bool ParseTensorSubmessage(protobuf::io::CodedInputStream* input,
                              TensorProto* tensor_meta);
   bool ParseFast(Source* source);
+  // Reads the `tensor_content` of a tensor allocated on `device_` from
+  // `input` into `*device_tensor`.
+  bool ReadTensorContentToDevice(protobuf::io::CodedInputStream* input,
+                                 Tensor* device_tensor);
   bool ParseSlow(Source* source);
 
   bool on_host_ = false;
   DeviceBase* device_ = nullptr;
   AllocatorAttributes alloc_attrs_;
   Allocator* allocator_ = nullptr;
+  // The context used to copy parsed contents to `device_`, or null if they
+  // are parsed on the host.
+  DeviceContext* device_context_ = nullptr;
   bool already_used_ = false;
   Tensor tensor_;
   RecvTensorResponse meta_;
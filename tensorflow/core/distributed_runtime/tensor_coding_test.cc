@@ -15,10 +15,14 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/tensor_coding.h"
 
+#include <cstring>
+
+#include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/framework/device_attributes.pb.h"
 #include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/env.h"
@@ -46,6 +50,56 @@ class DummyDevice : public DeviceBase {
   DeviceAttributes attr_;
 };
 
+// Copies to the "device" with memcpy and counts the copies.
+class FakeDeviceContext : public DeviceContext {
+ public:
+  void CopyCPUTensorToDevice(const Tensor* cpu_tensor, Device* device,
+                             Tensor* device_tensor, StatusCallback done,
+                             bool sync_dst_compute) const override {
+    ++num_copies_;
+    StringPiece src = cpu_tensor->tensor_data();
+    StringPiece dst = device_tensor->tensor_data();
+    if (src.size() != dst.size()) {
+      done(errors::Internal("Size mismatch"));
+      return;
+    }
+    std::memcpy(const_cast<char*>(dst.data()), src.data(), src.size());
+    done(OkStatus());
+  }
+
+  int num_copies() const { return num_copies_; }
+
+ private:
+  mutable int num_copies_ = 0;
+};
+
+class FakeGpuDevice : public Device {
+ public:
+  explicit FakeGpuDevice(Env* env) : Device(env, MakeAttributes()) {
+    device_info_.default_context = &context_;
+    set_tensorflow_accelerator_device_info(&device_info_);
+  }
+
+  Status Sync() override { return OkStatus(); }
+
+  Allocator* GetAllocator(AllocatorAttributes attr) override {
+    return cpu_allocator();
+  }
+
+  const FakeDeviceContext& context() const { return context_; }
+
+ private:
+  static DeviceAttributes MakeAttributes() {
+    DeviceAttributes attr;
+    attr.set_name("/job:a/replica:0/task:0/device:GPU:0");
+    attr.set_device_type("GPU");
+    return attr;
+  }
+
+  FakeDeviceContext context_;
+  AcceleratorDeviceInfo device_info_;
+};
+
 class StringSource : public TensorResponse::Source {
  public:
   explicit StringSource(const string* s, int block_size)
@@ -156,6 +210,88 @@ TEST_F(TensorResponseTest, Simple) {
 
 TEST_F(TensorResponseTest, StringTensor) { DoTestForStrings(DT_STRING); }
 
+TEST_F(TensorResponseTest, ReducedPrecision) {
+  Tensor src(DT_FLOAT, TensorShape({4}));
+  test::FillValues<float>(&src, {1.0f, -2.5f, 1.0f / 3, 1e-3f});
+
+  for (DataType wire_dtype : {DT_BFLOAT16, DT_HALF}) {
+    ASSERT_TRUE(CanReduceWirePrecision(src, wire_dtype));
+    Tensor reduced;
+    ReduceWirePrecision(src, wire_dtype, /*residual=*/nullptr, &reduced);
+    EXPECT_EQ(reduced.dtype(), wire_dtype);
+
+    RecvTensorResponse proto;
+    proto.set_original_dtype(DT_FLOAT);
+    reduced.AsProtoTensorContent(proto.mutable_tensor());
+    string encoded;
+    proto.AppendToString(&encoded);
+    StringSource source(&encoded, 1024);
+
+    TensorResponse response;
+    DummyDevice cpu_device(Env::Default());
+    response.InitAlloc(&cpu_device, AllocatorAttributes());
+    TF_ASSERT_OK(response.ParseFrom(&source));
+    EXPECT_EQ(response.tensor().dtype(), DT_FLOAT);
+    test::ExpectTensorNear<float>(response.tensor(), src, 1e-2);
+  }
+}
+
+TEST_F(TensorResponseTest, DeviceTensorIsCopiedInChunks) {
+  // 12MB, which is copied to the device in two chunks.
+  const int64_t num_elements = 3 << 20;
+  Tensor src(DT_FLOAT, TensorShape({3, num_elements / 3}));
+  auto values = src.flat<float>();
+  for (int64_t i = 0; i < num_elements; ++i) {
+    values(i) = i % 1000;
+  }
+  RecvTensorResponse proto;
+  proto.set_send_start_micros(123456);
+  src.AsProtoTensorContent(proto.mutable_tensor());
+  string encoded;
+  proto.AppendToString(&encoded);
+  StringSource source(&encoded, 1024);
+
+  FakeGpuDevice gpu_device(Env::Default());
+  TensorResponse response;
+  response.InitAlloc(&gpu_device, AllocatorAttributes());
+  TF_ASSERT_OK(response.ParseFrom(&source));
+  EXPECT_EQ(gpu_device.context().num_copies(), 2);
+  EXPECT_EQ(response.metadata().send_start_micros(), 123456);
+  test::ExpectTensorEqual<float>(response.tensor(), src);
+}
+
+TEST(WirePrecisionTest, CannotReduce) {
+  const Tensor floats = test::AsTensor<float>({1.0f, 2.0f});
+  EXPECT_FALSE(CanReduceWirePrecision(test::AsTensor<double>({1.0, 2.0}),
+                                      DT_BFLOAT16));
+  EXPECT_FALSE(CanReduceWirePrecision(floats, DT_INVALID));
+  EXPECT_FALSE(CanReduceWirePrecision(floats, DT_INT8));
+}
+
+TEST(WirePrecisionTest, ErrorFeedback) {
+  // 1 + 2^-9 is not representable in bfloat16, which rounds it down to 1.
+  const float value = 1.0f + 1.0f / 512;
+  Tensor src(DT_FLOAT, TensorShape({1}));
+  test::FillValues<float>(&src, {value});
+
+  Tensor residual;
+  float sent = 0;
+  const int kNumSteps = 64;
+  for (int i = 0; i < kNumSteps; ++i) {
+    Tensor reduced;
+    ReduceWirePrecision(src, DT_BFLOAT16, &residual, &reduced);
+    sent += static_cast<float>(reduced.flat<bfloat16>()(0));
+  }
+  // Without error feedback, every step would lose 2^-9.
+  EXPECT_NEAR(sent, kNumSteps * value, 1.0f / 64);
+
+  // A residual of another shape is reset.
+  Tensor reduced;
+  ReduceWirePrecision(test::AsTensor<float>({1.0f, 2.0f, 3.0f}), DT_HALF,
+                      &residual, &reduced);
+  EXPECT_EQ(residual.shape(), TensorShape({3}));
+}
+
 string MakeFloatTensorTestCase(int num_elems) {
   std::vector<int8> v(num_elems);
   for (int i = 0; i < num_elems; i++) {
@@ -822,12 +822,23 @@ Status DatasetBase::CheckRandomAccessCompatible(const int64 index) const {
   return OkStatus();
 }
 
-Status DatasetBase::Get(OpKernelContext* ctx, int64 index,
+Status DatasetBase::Get(AnyContext ctx, int64 index,
                         std::vector<Tensor>* out_tensors) const {
   return errors::Unimplemented(
       "Random access is not implemented for this dataset.");
 }
 
+Status DatasetBase::GetMany(
+    AnyContext ctx, absl::Span<const int64_t> indices,
+    std::vector<std::vector<Tensor>>* out_tensors) const {
+  out_tensors->resize(indices.size());
+  for (size_t i = 0; i < indices.size(); ++i) {
+    (*out_tensors)[i].clear();
+    TF_RETURN_IF_ERROR(Get(ctx, indices[i], &(*out_tensors)[i]));
+  }
+  return OkStatus();
+}
+
 StatusOr<DatasetBase*> DatasetBase::Finalize(
     OpKernelContext* ctx,
     std::function<StatusOr<core::RefCountPtr<DatasetBase>>()>
@@ -26,6 +26,7 @@ limitations under the License.
 #include "absl/container/flat_hash_set.h"
 #include "absl/memory/memory.h"
 #include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
 #include "tensorflow/core/framework/attr_value.pb.h"
 #include "tensorflow/core/framework/attr_value_util.h"
 #include "tensorflow/core/framework/cancellation.h"
@@ -916,6 +917,38 @@ class IteratorContext {
   MemoryCheckpoint checkpoint_;
 };
 
+// The context in which elements of a randomly accessible dataset are read. It
+// is created either from the `OpKernelContext` of a kernel that reads elements
+// by index, or from the `IteratorContext` of an iterator that reads the
+// elements of its input in a random order.
+struct AnyContext {
+  explicit AnyContext(IteratorContext* ctx)
+      : env(ctx->env()),
+        flr(ctx->flr()),
+        function_handle_cache(ctx->function_handle_cache()),
+        runner(ctx->runner()),
+        runner_threadpool_size(ctx->runner_threadpool_size()),
+        allocator(ctx->allocator({})) {}
+
+  explicit AnyContext(OpKernelContext* ctx)
+      : env(ctx->env()),
+        flr(ctx->function_library()),
+        runner(ctx->runner()),
+        runner_threadpool_size(
+            GetRunnerThreadpoolSizeFromOpKernelContext(ctx)),
+        allocator(ctx->get_allocator({})),
+        op_kernel_context(ctx) {}
+
+  Env* env;
+  FunctionLibraryRuntime* flr;
+  FunctionHandleCache* function_handle_cache = nullptr;
+  std::function<void(std::function<void()>)>* runner;
+  int64_t runner_threadpool_size;
+  Allocator* allocator;
+  // The kernel context, if the context was created from one.
+  OpKernelContext* op_kernel_context = nullptr;
+};
+
 // Represents the current position in a range of outputs, where the
 // range of outputs is typically represented by an `DatasetBase`,
 // defined below.
@@ -994,6 +1027,15 @@ class IteratorBase : public Checkpointable {
   // Indicates whether the iterator is compatible with symbolic checkpointing.
   virtual bool SymbolicCheckpointCompatible() const { return false; }
 
+  // Returns the NUMA node that the threads of this iterator are pinned to, or
+  // `port::kNUMANoAffinity` if they are not pinned.
+  virtual int NumaNode() const { return port::kNUMANoAffinity; }
+
+  // Returns the performance model of the input pipeline, or null if this
+  // iterator does not own one. Only the root iterator of an autotuned input
+  // pipeline owns a model.
+  virtual std::shared_ptr<model::Model> model() const { return nullptr; }
+
   // Performs initialization that needs to happen outside of a constructor to
   // properly propagate errors.
   virtual Status Initialize(IteratorContext* ctx) { return OkStatus(); }
@@ -1272,9 +1314,16 @@ class DatasetBase : public core::RefCounted {
   Status CheckRandomAccessCompatible(const int64 index) const;
 
   // Return the element at a particular index for a randomly accessible dataset.
-  virtual Status Get(OpKernelContext* ctx, int64 index,
+  virtual Status Get(AnyContext ctx, int64 index,
                      std::vector<Tensor>* out_tensors) const;
 
+  // Returns the elements at the given indices, which must be sorted in
+  // increasing order, for a randomly accessible dataset. Datasets which read
+  // from files can override this to coalesce the reads of nearby elements. The
+  // default implementation calls `Get` for each index.
+  virtual Status GetMany(AnyContext ctx, absl::Span<const int64_t> indices,
+                         std::vector<std::vector<Tensor>>* out_tensors) const;
+
   // Return a finalized version of the dataset.  The returned DatasetBase is
   // unowned and lives for as long as this dataset.
   virtual StatusOr<DatasetBase*> Finalize(
@@ -31,6 +31,7 @@ limitations under the License.
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/control_flow.h"
@@ -156,6 +157,16 @@ class Device : public DeviceBase {
     return OkStatus();
   }
 
+  // Fills in the context map for the graph. The implementation may choose to
+  // run different nodes of the graph in different device contexts, e.g. on
+  // different streams. `device_context_map` is indexed by node id; nodes whose
+  // entry is missing or null use the default context of the device. The
+  // contexts are owned by the device and outlive the graph's executors.
+  virtual Status FillContextMap(
+      const Graph* graph, std::vector<DeviceContext*>* device_context_map) {
+    return OkStatus();
+  }
+
   // Returns the op segment of this device.  The caller can reuse op
   // kernels registered for the same session running on this device.
   OpSegment* op_segment() { return &op_seg_; }
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/framework/local_rendezvous.h"
 
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <utility>
@@ -29,6 +30,7 @@ limitations under the License.
 #include "tensorflow/core/lib/monitoring/counter.h"
 #include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/refcount.h"
@@ -400,6 +402,7 @@ void LocalRendezvous::DoAbort(const Status& status) {
   {
     mutex_lock l(mu_);
     status_.Update(status);
+    aborted_.store(true, std::memory_order_release);
   }
 
   // Keeps one Item to make sure the current rendezvous won't be destructed.
@@ -434,8 +437,20 @@ void LocalRendezvous::DoAbort(const Status& status) {
 }
 
 Status LocalRendezvous::status() {
+  if (TF_PREDICT_TRUE(!aborted_.load(std::memory_order_acquire))) {
+    return OkStatus();
+  }
   tf_shared_lock ml(mu_);
   return status_;
 }
 
+int LocalRendezvous::DefaultNumShards(int num_devices) {
+  // Beyond the number of hardware threads, additional shards only cost memory
+  // (each rendezvous is typically created per step).
+  constexpr int kMaxDefaultNumShards = 16;
+  return std::max(
+      num_devices,
+      std::min(kMaxDefaultNumShards, std::max(1, port::MaxParallelism())));
+}
+
 }  // namespace tensorflow
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_FRAMEWORK_LOCAL_RENDEZVOUS_H_
 #define TENSORFLOW_CORE_FRAMEWORK_LOCAL_RENDEZVOUS_H_
 
+#include <atomic>
 #include <memory>
 #include <optional>
 #include <vector>
@@ -43,6 +44,10 @@ class LocalRendezvous {
   // Rendezvous), pass in its pointer in constructor so the LocalRendezvous
   // can make sure it outlives the async recv requests.
   // Pass in nullptr if the wrapping class is not refcounted.
+  //
+  // Pending Send and Recv items are partitioned into `num_shards` independent
+  // tables by the hash of their parsed key, each protected by its own mutex.
+  // Use `DefaultNumShards()` when there is no better hint.
   explicit LocalRendezvous(Rendezvous* owner, int num_shards)
       : num_buckets_(num_shards > 0 ? num_shards : 1),
         rc_owner_(owner),
@@ -58,6 +63,11 @@ class LocalRendezvous {
   void StartAbort(const Status& status);
   Status status();
 
+  // Returns a shard count that keeps concurrent Send/Recv pairs on different
+  // keys from contending on the same table, given the number of devices that
+  // exchange tensors through the rendezvous.
+  static int DefaultNumShards(int num_devices);
+
   // Releases all the references to the aborted rendezvous. Used in unit tests.
   static void ReleaseAbortedRendezvous() {
     mutex_lock l(aborted_rendezs_mu_);
@@ -89,7 +99,9 @@ class LocalRendezvous {
   // nullptr otherwise.
   Rendezvous* rc_owner_;
 
-  struct TableBucket {
+  // Buckets are aligned to (at least) a cache line, so that updates to the
+  // mutex of one bucket do not invalidate the neighbouring buckets.
+  struct alignas(64) TableBucket {
     mutex mu;
     Table table TF_GUARDED_BY(mu);
 
@@ -102,6 +114,9 @@ class LocalRendezvous {
   const std::unique_ptr<TableBucket[]> table_buckets_;
   mutex mu_;
   Status status_ TF_GUARDED_BY(mu_);
+  // True once `status_` is not OK. Lets `status()` skip acquiring `mu_`, which
+  // is shared by all buckets, on the common (not aborted) path.
+  std::atomic<bool> aborted_{false};
 
   // We deliberately leak one reference of the aborted rendezvous here, so that
   // they won't be destructed, and lose the status_.
@@ -51,6 +51,20 @@ auto* graph_pending_queue_length_histogram = tsl::monitoring::Sampler<0>::New(
     // Power of 1.5 with bucket count 30 (> 191k)
     {tsl::monitoring::Buckets::Exponential(1, 1.5, 30)});
 
+auto* run_handler_queueing_delay_usecs = tsl::monitoring::Sampler<1>::New(
+    {"/tensorflow/core/run_handler/queueing_delay_usecs",
+     "The mean time in microseconds that the closures of a request waited in "
+     "the RunHandlerPool queues before running.",
+     "priority"},
+    // Power of 2 with bucket count 24 (> 8 seconds)
+    {tsl::monitoring::Buckets::Exponential(1, 2, 24)});
+
+auto* run_handler_deadline_misses = tsl::monitoring::Counter<1>::New(
+    "/tensorflow/core/run_handler/deadline_misses",
+    "The number of RunHandlerPool requests that completed after their "
+    "deadline.",
+    "priority");
+
 auto* graph_run_input_tensor_bytes = tsl::monitoring::Sampler<0>::New(
     {"/tensorflow/core/graph_run_input_tensor_bytes",
      "The size of input tensors in bytes."},
@@ -145,6 +159,23 @@ auto* tf_data_iterator_gap_msec_histogram = tsl::monitoring::Sampler<0>::New(
     // Power of 1.5 with bucket count of 20 (from 1 msec to about 2.2 secs).
     {tsl::monitoring::Buckets::Exponential(1, 1.5, 20)});
 
+auto* tf_data_node_latency_usecs_histogram = tsl::monitoring::Sampler<2>::New(
+    {"/tensorflow/data/node_latency",
+     "The time (in microseconds) a tf.data model node takes to produce an "
+     "element.",
+     "name", "kind"},
+    // Power of 2 with bucket count 24 (> 8 seconds)
+    {tsl::monitoring::Buckets::Exponential(1, 2, 24)});
+
+auto* tf_data_node_buffer_utilization_histogram =
+    tsl::monitoring::Sampler<1>::New(
+        {"/tensorflow/data/node_buffer_utilization",
+         "The fraction of a tf.data model node's buffer that is in use.",
+         "name"},
+        // Uniform linear buckets with count 10 from 0 to 1
+        {tsl::monitoring::Buckets::Explicit(
+            {0.1, 0.2, 0.3, 0.4, 0.5, 0.6, 0.7, 0.8, 0.9, 1.0})});
+
 auto* tf_data_optimization_counter = tsl::monitoring::Counter<1>::New(
     "/tensorflow/data/optimization", "tf.data optimization", "name");
 
@@ -175,6 +206,18 @@ auto* tf_data_service_cross_trainer_cache_size_bytes =
         "/tensorflow/data/service/cross_trainer_cache_size_bytes",
         "tf.data service cross-trainer cache memory usage in bytes.");
 
+auto* tf_data_service_optimal_number_of_workers =
+    tsl::monitoring::Gauge<int64_t, 0>::New(
+        "/tensorflow/data/service/optimal_number_of_workers",
+        "Estimated optimal number of tf.data service workers.");
+
+auto* tf_data_service_worker_count_target =
+    tsl::monitoring::Gauge<int64_t, 0>::New(
+        "/tensorflow/data/service/worker_count_target",
+        "Recommended number of tf.data service workers. Unlike "
+        "optimal_number_of_workers, it only scales down once the estimate "
+        "stays clearly below it.");
+
 auto* tf_data_service_snapshot_bytes_committed =
     tsl::monitoring::Counter<0>::New(
         "/tensorflow/data/service/snapshot_bytes_committed",
@@ -317,6 +360,26 @@ auto* xla_compilation_time_usecs = tsl::monitoring::Counter<0>::New(
     "/tensorflow/core/xla_compilation_time_usecs",
     "The total time spent on compiling XLA graphs in microseconds.");
 
+auto* xla_recompilations = tsl::monitoring::Counter<0>::New(
+    "/tensorflow/core/xla_recompilations",
+    "The number of XLA compilations of clusters that had already been "
+    "compiled for other input shapes or constant values.");
+
+auto* mkl_primitive_cache_lookups = tsl::monitoring::Counter<1>::New(
+    "/tensorflow/core/mkl/primitive_cache_lookups",
+    "The number of lookups in the oneDNN primitive cache.",
+    "result"  // hit or miss
+);
+
+auto* mkl_weight_reorders = tsl::monitoring::Counter<0>::New(
+    "/tensorflow/core/mkl/weight_reorders",
+    "The number of constant weights reordered and cached, used to collect "
+    "/tensorflow/core/mkl/weight_reorder_time_usecs");
+
+auto* mkl_weight_reorder_time_usecs = tsl::monitoring::Counter<0>::New(
+    "/tensorflow/core/mkl/weight_reorder_time_usecs",
+    "The total time spent reordering constant weights in microseconds.");
+
 auto* xla_tpu_spmd_cores_per_replica = tsl::monitoring::Counter<1>::New(
     "/tensorflow/tpu/xla_spmd_cores_per_replica",
     "The number of cores used by XLA SPMD-replicated models.", "cores");
@@ -455,6 +518,16 @@ void RecordTFDataIteratorGap(uint64 duration_us) {
   tf_data_iterator_gap_msec_histogram_cell->Add(duration_us * 0.001);
 }
 
+void RecordTFDataNodeLatency(const string& name, const string& kind,
+                             double latency_usec) {
+  tf_data_node_latency_usecs_histogram->GetCell(name, kind)->Add(latency_usec);
+}
+
+void RecordTFDataNodeBufferUtilization(const string& name,
+                                       double utilization) {
+  tf_data_node_buffer_utilization_histogram->GetCell(name)->Add(utilization);
+}
+
 void RecordTFDataOptimization(const string& name, int64_t num_changes) {
   tf_data_optimization_counter->GetCell(name)->IncrementBy(num_changes);
 }
@@ -530,6 +603,14 @@ void RecordTFDataServiceSnapshotBytesCommitted(int64_t bytes) {
   tf_data_service_snapshot_bytes_committed->GetCell()->IncrementBy(bytes);
 }
 
+void RecordTFDataServiceOptimalNumberOfWorkers(int64_t number_of_workers) {
+  tf_data_service_optimal_number_of_workers->GetCell()->Set(number_of_workers);
+}
+
+void RecordTFDataServiceWorkerCountTarget(int64_t number_of_workers) {
+  tf_data_service_worker_count_target->GetCell()->Set(number_of_workers);
+}
+
 void RecordTFDataFilename(const string& name, const string& filename) {
   tf_data_filename_counter->GetCell(name, filename)->IncrementBy(1);
 }
@@ -586,6 +667,15 @@ void RecordGraphOutputTensors(const size_t size) {
   graph_run_output_tensor_bytes_cell->Add(size);
 }
 
+void RecordRunHandlerQueueingDelay(int64_t priority, int64_t delay_usecs) {
+  run_handler_queueing_delay_usecs->GetCell(absl::StrCat(priority))
+      ->Add(delay_usecs);
+}
+
+void RecordRunHandlerDeadlineMiss(int64_t priority) {
+  run_handler_deadline_misses->GetCell(absl::StrCat(priority))->IncrementBy(1);
+}
+
 void RecordTPUXlaSpmdCoresPerReplica(int64_t cores_per_replica) {
   xla_tpu_spmd_cores_per_replica->GetCell(absl::StrCat(cores_per_replica))
       ->IncrementBy(1);
@@ -715,6 +805,25 @@ void UpdateXlaCompilationTime(const uint64 compilation_time_usecs) {
   }
 }
 
+void RecordXlaRecompilation() {
+  static auto* xla_recompilations_cell = xla_recompilations->GetCell();
+  xla_recompilations_cell->IncrementBy(1);
+}
+
+void RecordMklPrimitiveCacheLookup(bool hit) {
+  static auto* hit_cell = mkl_primitive_cache_lookups->GetCell("hit");
+  static auto* miss_cell = mkl_primitive_cache_lookups->GetCell("miss");
+  (hit ? hit_cell : miss_cell)->IncrementBy(1);
+}
+
+void UpdateMklWeightReorderTime(const uint64 reorder_time_usecs) {
+  static auto* mkl_weight_reorders_cell = mkl_weight_reorders->GetCell();
+  static auto* mkl_weight_reorder_time_usecs_cell =
+      mkl_weight_reorder_time_usecs->GetCell();
+  mkl_weight_reorders_cell->IncrementBy(1);
+  mkl_weight_reorder_time_usecs_cell->IncrementBy(reorder_time_usecs);
+}
+
 void RecordUnusedOutput(const string& op_name) {
   graph_unused_outputs->GetCell(op_name)->IncrementBy(1);
 }
@@ -115,6 +115,19 @@ void RecordTFDataIteratorLifetime(uint64 duration_us);
 // request.
 void RecordTFDataIteratorGap(uint64 duration_us);
 
+// Records the latency (in microseconds) of a tf.data model node, sampled by
+// the /tfdataz metrics collector.
+//
+// The `name` argument identifies the node type (e.g. "ParallelMapV2"), and
+// `kind` is "producer" for the node's own time per element and "consumer" for
+// the time including its inputs.
+void RecordTFDataNodeLatency(const string& name, const string& kind,
+                             double latency_usec);
+
+// Records the fraction of a tf.data model node's buffer that is in use,
+// sampled by the /tfdataz metrics collector.
+void RecordTFDataNodeBufferUtilization(const string& name, double utilization);
+
 // Records the number of independent graph changes resulting from the
 // application of a tf.data optimization.
 //
@@ -162,6 +175,14 @@ void RecordTFDataServiceCrossTrainerCacheSizeBytes(size_t bytes);
 // Records distributed tf.data snapshot bytes committed.
 void RecordTFDataServiceSnapshotBytesCommitted(int64_t bytes);
 
+// Records the optimal number of tf.data service workers estimated by the
+// dispatcher's auto-scaler.
+void RecordTFDataServiceOptimalNumberOfWorkers(int64_t number_of_workers);
+
+// Records the number of tf.data service workers the dispatcher's auto-scaler
+// recommends provisioning.
+void RecordTFDataServiceWorkerCountTarget(int64_t number_of_workers);
+
 // Records the file name read by a tf.data Dataset.
 //
 // The `name` argument identifies the Dataset type (e.g. "TFRecordDataset").
@@ -207,6 +228,14 @@ void RecordTPUXlaSpmdCoresPerReplica(int64_t cores_per_replica);
 void UpdateGraphExecTime(const uint64 running_time_usecs);
 void UpdateGraphPendingQueueLength(uint64 len);
 
+// Records the mean time that the closures of one RunHandlerPool request with
+// the given `priority` waited in a queue before they started running.
+void RecordRunHandlerQueueingDelay(int64_t priority, int64_t delay_usecs);
+
+// Records that a RunHandlerPool request with the given `priority` completed
+// after its deadline.
+void RecordRunHandlerDeadlineMiss(int64_t priority);
+
 // Records that one output of an op of type `op_name` was unused.
 void RecordUnusedOutput(const string& op_name);
 
@@ -392,6 +421,17 @@ void UpdateTpuVariableDistributionTime(const uint64 distribution_time_usecs);
 // Updates the metrics stored about time XLA spents compiling graphs.
 void UpdateXlaCompilationTime(const uint64 compilation_time_usecs);
 
+// Records a compilation of an XLA cluster that had already been compiled, i.e.
+// a recompilation caused by new input shapes or constant values.
+void RecordXlaRecompilation();
+
+// Records a lookup in the oneDNN primitive cache, and whether it was a hit.
+void RecordMklPrimitiveCacheLookup(bool hit);
+
+// Updates the metrics stored about time spent reordering constant weights
+// into the layout of a oneDNN primitive before caching them.
+void UpdateMklWeightReorderTime(const uint64 reorder_time_usecs);
+
 // Increments (by 1) a simple integer counter that is exposed for testing.
 void IncrementTestCounter(const string& name, const string& label);
 
@@ -232,6 +232,17 @@ bool AreAllParametersMax(const Model::ModelParameters& parameters) {
   return true;
 }
 
+// Returns the total value of the `parallelism` parameters in `parameters`.
+double TotalParallelism(const Model::ModelParameters& parameters) {
+  double parallelism = 0;
+  for (const auto& pair : parameters) {
+    if (pair.second->name == kParallelism) {
+      parallelism += pair.second->value;
+    }
+  }
+  return parallelism;
+}
+
 // Records the ram usage of hill climbing algorithm.
 void RecordAutotuneRamUsage(int64 ram_budget, double max_buffered_bytes) {
   if (ram_budget == 0) {
@@ -2292,6 +2303,11 @@ void Model::Optimize(AutotuneAlgorithm algorithm, int64_t cpu_budget,
   if (experiments_.contains("autotune_buffer_optimization")) {
     OptimizeBuffers(snapshot, optimization_params.ram_budget());
   }
+  if (experiments_.contains("global_ram_budget")) {
+    RamBudgetManager::Global()->Report(
+        this, TotalMaximumBufferedBytes(snapshot),
+        BufferBenefitPerByte(snapshot, model_input_time));
+  }
   {
     // Save the snapshot of the model proto including the parameters used by
     // autotune. This will be used as the model proto returned in `tfstreamz`.
@@ -2386,6 +2402,17 @@ Status Model::OptimizeLoop(AutotuneAlgorithm algorithm, int64_t cpu_budget,
       },
       /*deregister_fn=*/&unused));
 
+  // With a process-wide budget, `ram_budget` only caps the share that this
+  // model is given.
+  RamBudgetManager* ram_budget_manager = nullptr;
+  if (experiments_.contains("global_ram_budget")) {
+    ram_budget_manager = RamBudgetManager::Global();
+    ram_budget_manager->Register(this);
+  }
+  auto unregister = gtl::MakeCleanup([this, ram_budget_manager]() {
+    if (ram_budget_manager != nullptr) ram_budget_manager->Unregister(this);
+  });
+
   int64_t last_optimization_ms = 0;
   int64_t current_time_ms = EnvTime::NowMicros() / EnvTime::kMillisToMicros;
   while (true) {
@@ -2413,7 +2440,11 @@ Status Model::OptimizeLoop(AutotuneAlgorithm algorithm, int64_t cpu_budget,
     if (algorithm == AutotuneAlgorithm::STAGE_BASED) {
       model_input_time = ComputeTargetTimeNsec();
     }
-    Optimize(algorithm, cpu_budget, ram_budget, model_input_time,
+    const int64_t current_ram_budget =
+        ram_budget_manager == nullptr
+            ? ram_budget
+            : std::min(ram_budget, ram_budget_manager->GetBudget(this));
+    Optimize(algorithm, cpu_budget, current_ram_budget, model_input_time,
              cancellation_manager);
     int64_t end_ms = EnvTime::NowMicros() / EnvTime::kMillisToMicros;
     VLOG(2) << "Optimized for " << end_ms - start_ms << " ms.";
@@ -2533,6 +2564,7 @@ void Model::OptimizeHillClimbHelper(
     }
     pair.second->value = pair.second->min;
   }
+  const bool hard_cpu_budget = experiments_.contains("hard_cpu_budget");
   while (!cancellation_manager->IsCancelled()) {
     const double output_time =
         OutputTime(snapshot, optimization_params.model_input_time(),
@@ -2541,12 +2573,17 @@ void Model::OptimizeHillClimbHelper(
                     TotalMaximumBufferedBytes(snapshot))) {
       break;
     }
+    // With a hard CPU budget, parallelism is not increased past the budget.
+    const bool cpu_budget_reached =
+        hard_cpu_budget &&
+        TotalParallelism(parameters) + 1 > optimization_params.cpu_budget();
 
     double best_delta = -1.0L;
     Parameter* best_parameter = nullptr;
     for (auto& pair : parameters) {
       if (pair.second->value >= pair.second->max ||
-          (skip_buffer_sizes && (pair.second->name == kBufferSize))) {
+          (skip_buffer_sizes && (pair.second->name == kBufferSize)) ||
+          (cpu_budget_reached && pair.second->name == kParallelism)) {
         continue;
       }
       pair.second->value++;
@@ -2573,6 +2610,32 @@ void Model::OptimizeHillClimbHelper(
   }
   UpdateStateValues(&parameters);
 }
+double Model::BufferBenefitPerByte(std::shared_ptr<Node> snapshot,
+                                   double model_input_time) {
+  auto parameters = CollectTunableParameters(snapshot);
+  const double output_time =
+      OutputTime(snapshot, model_input_time, /*gradients=*/nullptr);
+  const double buffered_bytes = TotalMaximumBufferedBytes(snapshot);
+  double best_benefit = 0.0;
+  for (auto& pair : parameters) {
+    Parameter& parameter = *pair.second;
+    if (parameter.name != kBufferSize || parameter.value >= parameter.max) {
+      continue;
+    }
+    parameter.value++;
+    const double delta_time =
+        output_time -
+        OutputTime(snapshot, model_input_time, /*gradients=*/nullptr);
+    const double delta_bytes =
+        TotalMaximumBufferedBytes(snapshot) - buffered_bytes;
+    parameter.value--;
+    if (delta_bytes > 0) {
+      best_benefit = std::max(best_benefit, delta_time / delta_bytes);
+    }
+  }
+  return best_benefit;
+}
+
 void Model::RecordIteratorGapTime(uint64_t duration_usec) {
   mutex_lock l(gap_mu_);
   // Drop duration if it is too large.
@@ -2637,6 +2700,8 @@ void Model::OptimizeStageBasedAsyncInterleaveManyNodes(
                               node_tunable_parameters.begin(),
                               node_tunable_parameters.end());
   }
+  const bool hard_cpu_budget = experiments_.contains("hard_cpu_budget");
+  double parallelism = TotalParallelism(tunable_parameters);
   ModelTiming model_timing(snapshot);
   ModelTimingPriorityQueue priority_queue(model_timing);
   NodeParallelismParameters node_parallelism;
@@ -2657,7 +2722,13 @@ void Model::OptimizeStageBasedAsyncInterleaveManyNodes(
         parallelism_parameter->value >= parallelism_parameter->max) {
       continue;
     }
+    if (hard_cpu_budget &&
+        parallelism + 1 > optimization_params.cpu_budget()) {
+      metrics::RecordTFDataAutotuneStoppingCriteria("cpu_budget_reached");
+      break;
+    }
     parallelism_parameter->value += 1.0;
+    parallelism += 1.0;
     if (TotalMaximumBufferedBytes(snapshot) >
         optimization_params.ram_budget()) {
       // Increasing the parallelism by 1 exceeded ram budget. Reduce it back and
@@ -2716,6 +2787,10 @@ void Model::OptimizeStageBasedNonAsyncInterleaveManyNodes(
     }
     pair.second->value = pair.second->min;
   }
+  const bool hard_cpu_budget = experiments_.contains("hard_cpu_budget");
+  // The async interleave many nodes keep the parallelism they were just
+  // given, so they count against the budget too.
+  double parallelism = TotalParallelism(CollectTunableParameters(snapshot));
   ModelTiming model_timing(snapshot);
   ModelTimingPriorityQueue priority_queue(model_timing);
   StatusOr<std::pair<double, Node*>> critical_root_status =
@@ -2745,7 +2820,13 @@ void Model::OptimizeStageBasedNonAsyncInterleaveManyNodes(
           RemoveArrayIndices(critical_root.second->long_name())));
       break;
     }
+    if (hard_cpu_budget &&
+        parallelism + 1 > optimization_params.cpu_budget()) {
+      metrics::RecordTFDataAutotuneStoppingCriteria("cpu_budget_reached");
+      break;
+    }
     parallelism_parameter->value += 1.0;
+    parallelism += 1.0;
     if (cancellation_manager->IsCancelled() ||
         TotalMaximumBufferedBytes(snapshot) >
             optimization_params.ram_budget()) {
@@ -3012,6 +3093,61 @@ std::string Model::DebugString() {
   return cached_debug_string_;
 }
 
+RamBudgetManager* RamBudgetManager::Global() {
+  static RamBudgetManager* manager =
+      new RamBudgetManager(kRamBudgetShare * port::AvailableRam());
+  return manager;
+}
+
+void RamBudgetManager::Register(const Model* model) {
+  mutex_lock l(mu_);
+  models_.try_emplace(model);
+  Rebalance();
+}
+
+void RamBudgetManager::Unregister(const Model* model) {
+  mutex_lock l(mu_);
+  models_.erase(model);
+  Rebalance();
+}
+
+void RamBudgetManager::Report(const Model* model, double buffered_bytes,
+                              double benefit_per_byte) {
+  mutex_lock l(mu_);
+  auto it = models_.find(model);
+  if (it == models_.end()) return;
+  it->second.buffered_bytes = buffered_bytes;
+  it->second.benefit_per_byte = std::max(benefit_per_byte, 0.0);
+  Rebalance();
+}
+
+int64_t RamBudgetManager::GetBudget(const Model* model) const {
+  tf_shared_lock l(mu_);
+  auto it = models_.find(model);
+  return it == models_.end() ? ram_budget_ : it->second.budget;
+}
+
+void RamBudgetManager::Rebalance() {
+  if (models_.empty()) return;
+  const double even_share =
+      kGuaranteedShare * ram_budget_ / static_cast<double>(models_.size());
+  double remaining = ram_budget_;
+  double total_benefit = 0.0;
+  for (const auto& it : models_) {
+    remaining -= std::min(even_share, it.second.buffered_bytes);
+    total_benefit += it.second.benefit_per_byte;
+  }
+  for (auto& it : models_) {
+    ModelState& state = it.second;
+    const double share =
+        total_benefit > 0.0 ? state.benefit_per_byte / total_benefit
+                            : 1.0 / static_cast<double>(models_.size());
+    state.budget = static_cast<int64_t>(
+        std::min(even_share, state.buffered_bytes) + share * remaining);
+    VLOG(3) << "RAM budget of model " << it.first << ": " << state.budget;
+  }
+}
+
 ModelTiming::ModelTiming(std::shared_ptr<Node> root) : root_(root) {
   DCHECK(root_.get() != nullptr);
   auto bfs_nodes = CollectNodes(root_, TraversalOrder::BFS, IsAnyNode);
@@ -968,6 +968,12 @@ class Model {
                   const ModelParameters& buffer_size_parameters,
                   std::shared_ptr<Node> snapshot, bool* cpu_budget_reached);
 
+  // Returns the largest reduction of the output time, in nanoseconds per
+  // additional byte, that upsizing one buffer of the pipeline rooted at
+  // `snapshot` by one element would bring.
+  double BufferBenefitPerByte(std::shared_ptr<Node> snapshot,
+                              double model_input_time);
+
   // Collects the processing time for the given node.
   double TotalProcessingTime(std::shared_ptr<Node> node);
 
@@ -1026,6 +1032,60 @@ class Model {
   OptimizationParams optimization_params_ TF_GUARDED_BY(mu_);
 };
 
+// Arbitrates one RAM budget between the models of all the input pipelines of a
+// process, so that pipelines that run side by side do not collectively exceed
+// it.
+//
+// Registered models report, after each optimization, how many bytes their
+// buffers may hold and by how much buffering more elements would reduce their
+// output time per additional byte. Every model is guaranteed an even share of
+// `kGuaranteedShare` of the budget, capped at what it already buffers; the
+// rest is split in proportion to the reported benefits, so that memory goes to
+// the pipelines whose throughput improves the most. Budgets are re-balanced on
+// every report.
+//
+// Models opt in with the "global_ram_budget" experiment.
+//
+// This class is thread-safe.
+class RamBudgetManager {
+ public:
+  // Fraction of the budget that is split evenly between the models.
+  static constexpr double kGuaranteedShare = 0.5;
+
+  explicit RamBudgetManager(int64_t ram_budget) : ram_budget_(ram_budget) {}
+
+  // Returns the process-wide manager, whose budget is `kRamBudgetShare` of the
+  // available RAM.
+  static RamBudgetManager* Global();
+
+  void Register(const Model* model) TF_LOCKS_EXCLUDED(mu_);
+  void Unregister(const Model* model) TF_LOCKS_EXCLUDED(mu_);
+
+  // Records that the buffers of `model` may hold `buffered_bytes` and that
+  // buffering more elements would reduce its output time by `benefit_per_byte`
+  // nanoseconds per additional byte, then re-balances the budgets. Reports of
+  // unregistered models are ignored.
+  void Report(const Model* model, double buffered_bytes,
+              double benefit_per_byte) TF_LOCKS_EXCLUDED(mu_);
+
+  // Returns the current budget of `model`, or the whole budget if it is not
+  // registered.
+  int64_t GetBudget(const Model* model) const TF_LOCKS_EXCLUDED(mu_);
+
+ private:
+  struct ModelState {
+    double buffered_bytes = 0.0;
+    double benefit_per_byte = 0.0;
+    int64_t budget = 0;
+  };
+
+  void Rebalance() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const int64_t ram_budget_;
+  mutable mutex mu_;
+  absl::flat_hash_map<const Model*, ModelState> models_ TF_GUARDED_BY(mu_);
+};
+
 // Class to compute timing information for a model.
 class ModelTiming {
  public:
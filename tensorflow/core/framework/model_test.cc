@@ -2703,6 +2703,76 @@ TEST_F(ModelTimingTest, OptimizeStageBased_TwoStages) {
   EXPECT_EQ(5, GetNode(/*node_id=*/2)->parameter_value("parallelism"));
 }
 
+TEST_F(ModelTimingTest, OptimizeStageBased_TwoStages_HardCpuBudget) {
+  BuildModelFromProto(R"pb(
+    nodes: {
+      key: 1
+      value: {
+        id: 1
+        name: "ParallelMapV2"
+        autotune: true
+        num_elements: 100
+        processing_time: 25000
+        bytes_produced: 10000
+        node_class: ASYNC_KNOWN_RATIO
+        ratio: 1
+        inputs: 2
+        parameters: {
+          name: "parallelism"
+          value: 4
+          min: 1
+          max: 16
+          tunable: true
+        }
+      }
+    }
+    nodes: {
+      key: 2
+      value: {
+        id: 2
+        name: "ParallelMapV2"
+        autotune: true
+        num_elements: 100
+        processing_time: 20000
+        bytes_produced: 10000
+        node_class: ASYNC_KNOWN_RATIO
+        ratio: 1
+        inputs: 3
+        parameters: {
+          name: "parallelism"
+          value: 4
+          min: 1
+          max: 16
+          tunable: true
+        }
+      }
+    }
+    nodes: {
+      key: 3
+      value: {
+        id: 3
+        name: "SSTable"
+        autotune: true
+        num_elements: 100
+        processing_time: 1000
+        node_class: KNOWN_RATIO
+        ratio: 2
+      }
+    }
+    output: 1
+  )pb");
+
+  model_->AddExperiment("hard_cpu_budget");
+
+  CancellationManager cancellation_manager;
+  model_->Optimize(AutotuneAlgorithm::STAGE_BASED, /*cpu_budget=*/6, 1000, 50,
+                   &cancellation_manager);
+
+  // Without the experiment, both stages get a parallelism of 5.
+  EXPECT_EQ(6, GetNode(/*node_id=*/1)->parameter_value("parallelism") +
+                   GetNode(/*node_id=*/2)->parameter_value("parallelism"));
+}
+
 TEST_F(ModelTimingTest, OptimizeStageBased_ParallelInterleaveMaxParallelism) {
   BuildModelFromProto(R"pb(
     nodes: {
@@ -3179,6 +3249,40 @@ TEST_F(ModelTimingTest, SelfTime) {
   EXPECT_DOUBLE_EQ(910, node_2->ComputeSelfTime());
 }
 
+TEST(RamBudgetManagerTest, SplitsEvenlyWithoutReports) {
+  RamBudgetManager manager(/*ram_budget=*/1000);
+  Model a, b;
+  EXPECT_EQ(manager.GetBudget(&a), 1000);
+  manager.Register(&a);
+  EXPECT_EQ(manager.GetBudget(&a), 1000);
+  manager.Register(&b);
+  EXPECT_EQ(manager.GetBudget(&a), 500);
+  EXPECT_EQ(manager.GetBudget(&b), 500);
+}
+
+TEST(RamBudgetManagerTest, FavorsModelsThatBenefitMore) {
+  RamBudgetManager manager(/*ram_budget=*/1000);
+  Model a, b, unregistered;
+  manager.Register(&a);
+  manager.Register(&b);
+  manager.Report(&a, /*buffered_bytes=*/100, /*benefit_per_byte=*/3.0);
+  manager.Report(&b, /*buffered_bytes=*/100, /*benefit_per_byte=*/1.0);
+  manager.Report(&unregistered, /*buffered_bytes=*/100,
+                 /*benefit_per_byte=*/100.0);
+  // Both keep what they buffer, and the remaining 800 bytes are split 3:1.
+  EXPECT_EQ(manager.GetBudget(&a), 700);
+  EXPECT_EQ(manager.GetBudget(&b), 300);
+  EXPECT_EQ(manager.GetBudget(&unregistered), 1000);
+
+  // The guaranteed share is capped at an even split of half the budget.
+  manager.Report(&b, /*buffered_bytes=*/900, /*benefit_per_byte=*/0.0);
+  EXPECT_EQ(manager.GetBudget(&a), 750);
+  EXPECT_EQ(manager.GetBudget(&b), 250);
+
+  manager.Unregister(&b);
+  EXPECT_EQ(manager.GetBudget(&a), 1000);
+}
+
 }  // namespace
 }  // namespace model
 }  // namespace data
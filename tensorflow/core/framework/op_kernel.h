@@ -617,6 +617,12 @@ class OpKernelContext {
     bool track_allocations = false;
     bool log_memory = false;
 
+    // If non-null, allocations requested with default allocator attributes
+    // are served by this allocator instead of the device's allocator. Used by
+    // the executor to redirect buffers into a per-step arena (see
+    // StaticMemoryPlan). Not owned.
+    Allocator* step_allocator = nullptr;
+
     // Array indexed by output number for this node
     const AllocatorAttributes* output_attr_array = nullptr;
 
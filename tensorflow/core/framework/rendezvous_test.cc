@@ -15,6 +15,9 @@ limitations under the License.
 
 #include "tensorflow/core/framework/rendezvous.h"
 
+#include <atomic>
+#include <vector>
+
 #include "absl/status/status.h"
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/framework/cancellation.h"
@@ -28,6 +31,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/blocking_counter.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
@@ -394,6 +398,45 @@ TEST_F(LocalRendezvousTest, AbortThenRecvOrSend) {
   EXPECT_TRUE(absl::IsAborted(rendez_->Recv(KeyFoo(), args, &val, &val_dead)));
 }
 
+TEST(ShardedLocalRendezvousTest, SendRecvAcrossShards) {
+  Rendezvous* rendez = NewLocalRendezvous(/*num_shards=*/8);
+  Rendezvous::Args args;
+  for (int i = 0; i < 64; ++i) {
+    TF_ASSERT_OK(rendez->Send(MakeKey(strings::StrCat("key", i)), args,
+                              V(strings::StrCat("val", i)), false));
+  }
+  for (int i = 63; i >= 0; --i) {
+    Tensor val(DT_STRING);
+    bool is_dead = false;
+    TF_ASSERT_OK(
+        rendez->Recv(MakeKey(strings::StrCat("key", i)), args, &val, &is_dead));
+    EXPECT_EQ(strings::StrCat("val", i), V(val));
+  }
+  rendez->Unref();
+}
+
+TEST(ShardedLocalRendezvousTest, AbortCancelsPendingRecvsInAllShards) {
+  Rendezvous* rendez = NewLocalRendezvous(/*num_shards=*/8);
+  constexpr int kNumKeys = 64;
+  std::atomic<int> num_aborted{0};
+  Rendezvous::Args args;
+  for (int i = 0; i < kNumKeys; ++i) {
+    rendez->RecvAsync(MakeKey(strings::StrCat("key", i)), args,
+                      [&num_aborted](const Status& s, const Rendezvous::Args&,
+                                     const Rendezvous::Args&, const Tensor&,
+                                     bool) {
+                        if (absl::IsAborted(s)) ++num_aborted;
+                      });
+  }
+  rendez->StartAbort(errors::Aborted(""));
+  EXPECT_EQ(kNumKeys, num_aborted);
+  Tensor val(DT_STRING);
+  bool is_dead = false;
+  EXPECT_TRUE(absl::IsAborted(rendez->Send(KeyFoo(), args, val, is_dead)));
+  EXPECT_TRUE(absl::IsAborted(rendez->Recv(KeyFoo(), args, &val, &is_dead)));
+  rendez->Unref();
+}
+
 class DummyDeviceContext : public DeviceContext {
  public:
   explicit DummyDeviceContext(int stream_id) : stream_id_(stream_id) {}
@@ -518,5 +561,57 @@ void BM_PingPong(::testing::benchmark::State& state) {
 }
 BENCHMARK(BM_PingPong)->Arg(100)->Arg(200)->Arg(300);
 
+// Measures Send/Recv pairs per second when `state.range(0)` threads exchange
+// tensors through one rendezvous with `state.range(1)` shards. Each thread uses
+// its own set of keys, so all contention comes from the rendezvous itself.
+void BM_ConcurrentSendRecv(::testing::benchmark::State& state) {
+  const int num_threads = state.range(0);
+  const int num_shards = state.range(1);
+  constexpr int kPairsPerThread = 1000;
+  constexpr int kKeysPerThread = 16;
+
+  std::vector<std::vector<Rendezvous::ParsedKey>> keys(num_threads);
+  for (int t = 0; t < num_threads; ++t) {
+    for (int k = 0; k < kKeysPerThread; ++k) {
+      keys[t].push_back(MakeKey(strings::StrCat("t", t, "_k", k)));
+    }
+  }
+  thread::ThreadPool pool(Env::Default(), "test", num_threads);
+  Tensor orig = V("val");
+
+  for (auto s : state) {
+    Rendezvous* rendez = NewLocalRendezvous(num_shards);
+    BlockingCounter counter(num_threads);
+    for (int t = 0; t < num_threads; ++t) {
+      pool.Schedule([&, t]() {
+        Tensor val(DT_STRING, TensorShape({}));
+        bool is_dead = false;
+        Rendezvous::Args args;
+        for (int i = 0; i < kPairsPerThread; ++i) {
+          const Rendezvous::ParsedKey& key = keys[t][i % kKeysPerThread];
+          TF_CHECK_OK(rendez->Send(key, args, orig, is_dead));
+          TF_CHECK_OK(rendez->Recv(key, args, &val, &is_dead));
+        }
+        counter.DecrementCount();
+      });
+    }
+    counter.Wait();
+    rendez->Unref();
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                          num_threads * kPairsPerThread);
+}
+BENCHMARK(BM_ConcurrentSendRecv)
+    ->UseRealTime()
+    ->ArgPair(1, 1)
+    ->ArgPair(4, 1)
+    ->ArgPair(16, 1)
+    ->ArgPair(32, 1)
+    ->ArgPair(64, 1)
+    ->ArgPair(4, 16)
+    ->ArgPair(16, 16)
+    ->ArgPair(32, 16)
+    ->ArgPair(64, 16);
+
 }  // namespace
 }  // namespace tensorflow
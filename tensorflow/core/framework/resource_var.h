@@ -57,6 +57,14 @@ namespace tensorflow {
 // shared mutex prevents them from overlapping with dense writes, which is
 // necessary as dense writes can change the shape the of the tensor.
 //
+// A variable can also be marked read-mostly when it is created, for variables
+// that are read by many concurrent steps and rarely written. Sparse reads of a
+// read-mostly variable do not switch it to copy-on-read mode: they alias its
+// buffer under a shared lock, like dense reads, and then read the alias without
+// holding the lock. As in copy-on-write mode, writers see the alias and write
+// to a copy, and the old buffer is freed when its last reader is done. Sparse
+// writes still switch the variable to copy-on-read mode.
+//
 // Transitioning a variable from copy-on-read mode to copy-on-write mode is
 // currently not supported. To upgrade a variable from copy-on-write to
 // copy-on-read use `EnsureSparseVariableAccess()`, and then grab the variable's
@@ -103,6 +111,10 @@ class Var : public ResourceBase {
   // so desired.
   std::atomic<bool> copy_on_read_mode{false};
 
+  // Whether sparse reads alias the buffer of the variable instead of switching
+  // it to copy-on-read mode. See the class comment.
+  std::atomic<bool> read_mostly{false};
+
  private:
   mutex mu_;
   Tensor tensor_;
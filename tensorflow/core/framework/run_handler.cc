@@ -19,10 +19,12 @@ limitations under the License.
 
 #include <algorithm>
 #include <cmath>
+#include <limits>
 #include <list>
 #include <memory>
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/run_handler_util.h"
 #include "tensorflow/core/lib/core/threadpool_interface.h"
 #include "tensorflow/core/lib/strings/strcat.h"
@@ -76,6 +78,7 @@ RunHandlerEnvironment::Task RunHandlerEnvironment::CreateTask(
           std::move(f),
           Context(ContextKind::kThread),
           id,
+          EnvTime::NowMicros(),
       }),
   };
 }
@@ -129,6 +132,8 @@ ThreadWorkSource::ThreadWorkSource()
       non_blocking_work_queues_(non_blocking_work_sharding_factor_),
       blocking_inflight_(0),
       non_blocking_inflight_(0),
+      total_queueing_delay_us_(0),
+      num_queued_tasks_executed_(0),
       traceme_id_(0),
       version_(0),
       sub_thread_pool_waiter_(nullptr) {
@@ -297,6 +302,23 @@ void ThreadWorkSource::DecrementInflightTaskCount(bool is_blocking) {
   counter->fetch_sub(1, std::memory_order_relaxed);
 }
 
+void ThreadWorkSource::RecordQueueingDelay(uint64 delay_us) {
+  total_queueing_delay_us_.fetch_add(delay_us, std::memory_order_relaxed);
+  num_queued_tasks_executed_.fetch_add(1, std::memory_order_relaxed);
+}
+
+int64_t ThreadWorkSource::MeanQueueingDelayMicros() {
+  const int64_t num_tasks =
+      num_queued_tasks_executed_.load(std::memory_order_relaxed);
+  if (num_tasks == 0) return -1;
+  return total_queueing_delay_us_.load(std::memory_order_relaxed) / num_tasks;
+}
+
+void ThreadWorkSource::ResetQueueingDelay() {
+  total_queueing_delay_us_.store(0, std::memory_order_relaxed);
+  num_queued_tasks_executed_.store(0, std::memory_order_relaxed);
+}
+
 unsigned ThreadWorkSource::NonBlockingWorkShardingFactor() {
   return non_blocking_work_sharding_factor_;
 }
@@ -631,6 +653,9 @@ void RunHandlerThreadPool::WorkerLoop(int thread_id,
           profiler::TraceMeLevel::kInfo);
       VLOG(2) << "Running " << (task_from_blocking_queue ? "inter" : "intra")
               << " work from " << tws->GetTracemeId();
+      const uint64 now = EnvTime::NowMicros();
+      tws->RecordQueueingDelay(
+          now > t.f->enqueue_time_us ? now - t.f->enqueue_time_us : 0);
       tws->IncrementInflightTaskCount(task_from_blocking_queue);
       env_.ExecuteTask(t);
       tws->DecrementInflightTaskCount(task_from_blocking_queue);
@@ -736,6 +761,9 @@ class RunHandler::Impl {
   // requested via RunHandlerPool::Get().
   uint64 start_time_us() const { return start_time_us_; }
   int64_t step_id() const { return step_id_; }
+  // Returns the time (in microseconds since unix epoch) by which the request
+  // should complete, or UINT64_MAX if it has no deadline.
+  uint64 deadline_us() const { return deadline_us_; }
   void ScheduleInterOpClosure(std::function<void()> fn);
   void ScheduleIntraOpClosure(std::function<void()> fn);
 
@@ -764,6 +792,7 @@ class RunHandler::Impl {
 
   RunHandlerPool::Impl* pool_impl_;  // NOT OWNED.
   uint64 start_time_us_;
+  uint64 deadline_us_;
   int64_t step_id_;
   std::unique_ptr<thread::ThreadPoolInterface> thread_pool_interface_;
   internal::ThreadWorkSource tws_;
@@ -874,11 +903,17 @@ class RunHandlerPool::Impl {
       num_active_requests = sorted_active_handlers_.size() + 1;
       thread_work_sources->resize(num_active_requests);
       int priority = options.priority();
+      uint64 deadline_us = handler_impl->deadline_us();
       auto it = sorted_active_handlers_.cbegin();
       bool new_handler_inserted = false;
       for (int i = 0; i < num_active_requests; ++i) {
-        if (!new_handler_inserted && (it == sorted_active_handlers_.cend() ||
-                                      priority > (*it)->priority())) {
+        // Higher priorities go first, and within a priority, earlier
+        // deadlines. Requests that compare equal keep their arrival order.
+        if (!new_handler_inserted &&
+            (it == sorted_active_handlers_.cend() ||
+             priority > (*it)->priority() ||
+             (priority == (*it)->priority() &&
+              deadline_us < (*it)->deadline_us()))) {
           sorted_active_handlers_.insert(it, handler_impl);
           new_handler_inserted = true;
           // Point to the newly added handler.
@@ -903,6 +938,14 @@ class RunHandlerPool::Impl {
     uint64 now = tensorflow::EnvTime::NowMicros();
     double elapsed = (now - handler->start_time_us()) / 1000.0;
     time_hist_.Add(elapsed);
+    const int64_t queueing_delay_us = handler->tws()->MeanQueueingDelayMicros();
+    if (queueing_delay_us >= 0) {
+      metrics::RecordRunHandlerQueueingDelay(handler->priority(),
+                                             queueing_delay_us);
+    }
+    if (now > handler->deadline_us()) {
+      metrics::RecordRunHandlerDeadlineMiss(handler->priority());
+    }
 
     // Erase from and update sorted_active_handlers_. Add it to the end of
     // free_handlers_.
@@ -934,6 +977,16 @@ class RunHandlerPool::Impl {
     return ret;
   }
 
+  std::vector<int64_t> GetActiveHandlerStepIdsForTesting()
+      TF_LOCKS_EXCLUDED(mu_) {
+    mutex_lock l(mu_);
+    std::vector<int64_t> ret;
+    for (const auto& handler_impl : sorted_active_handlers_) {
+      ret.push_back(handler_impl->step_id());
+    }
+    return ret;
+  }
+
  private:
   void RecomputePoolStats(
       int num_active_requests, uint64 version,
@@ -953,8 +1006,7 @@ class RunHandlerPool::Impl {
 
   std::unique_ptr<internal::RunHandlerThreadPool> run_handler_thread_pool_;
   // Thread compatible part used only by lock under RunHandlerPool.
-  // Handlers are sorted by start time.
-  // TODO(azaks): sort by the remaining latency budget.
+  // Handlers are sorted by priority, then by deadline, then by start time.
   // TODO(chaox): Consider other data structure for maintaining the sorted
   // active handlers if the searching overhead(currently O(n)) becomes the
   // bottleneck.
@@ -1078,9 +1130,13 @@ void RunHandler::Impl::Reset(
     int64_t step_id,
     const RunOptions::Experimental::RunHandlerPoolOptions& options) {
   start_time_us_ = tensorflow::Env::Default()->NowMicros();
+  deadline_us_ = options.deadline_in_ms() > 0
+                     ? start_time_us_ + options.deadline_in_ms() * 1000
+                     : std::numeric_limits<uint64>::max();
   step_id_ = step_id;
   options_ = options;
   tws_.SetTracemeId(step_id);
+  tws_.ResetQueueingDelay();
 }
 
 RunHandlerPool::RunHandlerPool(int num_inter_op_threads)
@@ -1103,6 +1159,11 @@ std::vector<int64_t> RunHandlerPool::GetActiveHandlerPrioritiesForTesting()
   return impl_->GetActiveHandlerPrioritiesForTesting();
 }
 
+std::vector<int64_t> RunHandlerPool::GetActiveHandlerStepIdsForTesting()
+    const {
+  return impl_->GetActiveHandlerStepIdsForTesting();
+}
+
 RunHandler::RunHandler(Impl* impl) : impl_(impl) {}
 
 void RunHandler::ScheduleInterOpClosure(std::function<void()> fn) {
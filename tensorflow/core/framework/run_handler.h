@@ -72,6 +72,10 @@ class RunHandlerPool {
   // order of the active handler list.
   std::vector<int64_t> GetActiveHandlerPrioritiesForTesting() const;
 
+  // Get the step ids for active handlers, in the order of the active handler
+  // list.
+  std::vector<int64_t> GetActiveHandlerStepIdsForTesting() const;
+
  private:
   class Impl;
   friend class RunHandler;
@@ -116,6 +120,9 @@ class RunHandlerEnvironment {
     std::function<void()> f;
     Context context;
     uint64 trace_id;
+    // Time (in microseconds) at which the task was created, used to measure
+    // how long it waits in a queue.
+    uint64 enqueue_time_us;
   };
   Env* const env_;
   const ThreadOptions thread_options_;
@@ -182,6 +189,16 @@ class ThreadWorkSource {
 
   void DecrementInflightTaskCount(bool is_blocking);
 
+  // Accounts for a task that waited `delay_us` in one of the queues before a
+  // worker thread started running it.
+  void RecordQueueingDelay(uint64 delay_us);
+
+  // Returns the mean queueing delay (in microseconds) of the tasks recorded
+  // since the last call to ResetQueueingDelay(), or -1 if there were none.
+  int64_t MeanQueueingDelayMicros();
+
+  void ResetQueueingDelay();
+
   unsigned NonBlockingWorkShardingFactor();
 
   std::string ToString();
@@ -199,6 +216,9 @@ class ThreadWorkSource {
   std::atomic<int64_t> blocking_inflight_;
   std::atomic<int64_t> non_blocking_inflight_;
 
+  std::atomic<int64_t> total_queueing_delay_us_;
+  std::atomic<int64_t> num_queued_tasks_executed_;
+
   Queue blocking_work_queue_;
   mutex blocking_queue_op_mu_;
   char pad_[128];
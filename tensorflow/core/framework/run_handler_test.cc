@@ -113,6 +113,38 @@ TEST(RunHandlerUtilTest, PrioritySchedulingTest) {
   EXPECT_EQ(sorted_active_list[3], 1);
 }
 
+TEST(RunHandlerUtilTest, DeadlineSchedulingTest) {
+  int num_threads = 2;
+  std::unique_ptr<RunHandlerPool> pool(
+      new RunHandlerPool(num_threads, num_threads));
+
+  RunOptions::Experimental::RunHandlerPoolOptions options;
+  options.set_priority(1);
+  auto handler1 = pool->Get(/*step_id=*/1, /*timeout_in_ms=*/0, options);
+  options.set_deadline_in_ms(100000);
+  auto handler2 = pool->Get(/*step_id=*/2, /*timeout_in_ms=*/0, options);
+  options.set_deadline_in_ms(1000);
+  auto handler3 = pool->Get(/*step_id=*/3, /*timeout_in_ms=*/0, options);
+  options.set_priority(2);
+  options.set_deadline_in_ms(0);
+  auto handler4 = pool->Get(/*step_id=*/4, /*timeout_in_ms=*/0, options);
+  options.set_priority(1);
+  options.set_deadline_in_ms(1000000);
+  auto handler5 = pool->Get(/*step_id=*/5, /*timeout_in_ms=*/0, options);
+
+  // Higher priorities go first. Within a priority, earlier deadlines go first
+  // and requests without a deadline go last.
+  EXPECT_EQ(pool->GetActiveHandlerStepIdsForTesting(),
+            std::vector<int64_t>({4, 3, 2, 5, 1}));
+
+  handler3.reset();
+  options.set_deadline_in_ms(100000);
+  auto handler6 = pool->Get(/*step_id=*/6, /*timeout_in_ms=*/0, options);
+  // Requests with the same deadline keep their arrival order.
+  EXPECT_EQ(pool->GetActiveHandlerStepIdsForTesting(),
+            std::vector<int64_t>({4, 2, 6, 5, 1}));
+}
+
 TEST(RunHandlerThreadPool, EnqueueTask) {
   Eigen::MaxSizeVector<mutex> waiters_mu(2);
   waiters_mu.resize(2);
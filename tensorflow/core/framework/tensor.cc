@@ -60,6 +60,7 @@ limitations under the License.
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mem.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/tensor_coding.h"
 #include "tensorflow/core/platform/types.h"
@@ -156,6 +157,110 @@ class Buffer : public BufferBase {
   TF_DISALLOW_COPY_AND_ASSIGN(Buffer);
 };
 
+// Tensors of simple types whose payload is at most this many bytes, allocated
+// from the default CPU allocator, store their payload inside the TensorBuffer
+// instead of in a separate allocation.
+constexpr size_t kMaxInlineBufferBytes = 32;
+
+// A ref-counted buffer that holds up to `kMaxInlineBufferBytes` of payload in
+// its own storage. The payload is left uninitialized, like the memory returned
+// by `TypedAllocator::Allocate()` for simple types.
+//
+// Scalars and short shape vectors are created and destroyed at a high rate,
+// so instances are recycled through a small per-thread free list rather than
+// going through the heap each time.
+class InlineBuffer : public TensorBuffer {
+ public:
+  // `alloc` is the allocator that the payload would otherwise have come from.
+  // It is only used to describe the buffer.
+  InlineBuffer(Allocator* alloc, size_t num_bytes)
+      : TensorBuffer(storage_), alloc_(alloc), num_bytes_(num_bytes) {
+    DCHECK_LE(num_bytes, kMaxInlineBufferBytes);
+  }
+
+  size_t size() const override { return num_bytes_; }
+  TensorBuffer* root_buffer() override { return this; }
+
+  bool GetAllocatedBytes(size_t* out_bytes) const override { return false; }
+
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(num_bytes_);
+    proto->set_allocator_name(alloc_->Name());
+    proto->set_ptr(reinterpret_cast<uintptr_t>(data()));
+  }
+
+  AllocatorMemoryType GetMemoryType() const override {
+    return alloc_->GetMemoryType();
+  }
+
+  static void* operator new(size_t size);
+  static void operator delete(void* ptr);
+
+ private:
+  ~InlineBuffer() override {}
+
+  Allocator* const alloc_;
+  const size_t num_bytes_;
+  alignas(Allocator::kAllocatorAlignment) char storage_[kMaxInlineBufferBytes];
+
+  TF_DISALLOW_COPY_AND_ASSIGN(InlineBuffer);
+};
+
+// Per-thread cache of the memory blocks backing `InlineBuffer`s. A block may
+// be returned to a different thread than the one that took it, which is fine
+// since all blocks have the same size.
+class InlineBufferFreeList {
+ public:
+  static constexpr int kCapacity = 64;
+
+  ~InlineBufferFreeList() {
+    for (int i = 0; i < size_; ++i) port::AlignedFree(blocks_[i]);
+    size_ = 0;
+    destroyed_ = true;
+  }
+
+  // Returns the free list of the calling thread, or nullptr if it has
+  // already been destroyed because the thread is exiting.
+  static InlineBufferFreeList* Get() {
+    if (destroyed_) return nullptr;
+    thread_local InlineBufferFreeList free_list;
+    return &free_list;
+  }
+
+  void* Pop() { return size_ > 0 ? blocks_[--size_] : nullptr; }
+
+  bool Push(void* block) {
+    if (size_ == kCapacity) return false;
+    blocks_[size_++] = block;
+    return true;
+  }
+
+ private:
+  // Trivially destructible, so it can still be read after the free list of
+  // the same thread has been destroyed.
+  static thread_local bool destroyed_;
+
+  void* blocks_[kCapacity];
+  int size_ = 0;
+};
+
+thread_local bool InlineBufferFreeList::destroyed_ = false;
+
+void* InlineBuffer::operator new(size_t size) {
+  DCHECK_EQ(size, sizeof(InlineBuffer));
+  InlineBufferFreeList* free_list = InlineBufferFreeList::Get();
+  void* block = free_list != nullptr ? free_list->Pop() : nullptr;
+  if (block == nullptr) {
+    block = port::AlignedMalloc(sizeof(InlineBuffer), alignof(InlineBuffer));
+  }
+  return block;
+}
+
+void InlineBuffer::operator delete(void* ptr) {
+  InlineBufferFreeList* free_list = InlineBufferFreeList::Get();
+  if (free_list == nullptr || !free_list->Push(ptr)) port::AlignedFree(ptr);
+}
+
 void LogUnexpectedSize(int64_t actual, int64_t expected) {
   LOG(ERROR) << "Input size was " << actual << " and expected " << expected;
 }
@@ -547,6 +652,28 @@ Buffer<T>::~Buffer() {
   }
 }
 
+// Returns true if a payload of `num_bytes` allocated from `a` can be stored
+// in an `InlineBuffer` without any observable difference. Allocators other
+// than the default CPU allocator may place memory elsewhere or keep records of
+// it, and so do the CPU allocator stats and memory logging.
+bool CanUseInlineBuffer(Allocator* a, size_t num_bytes) {
+  static Allocator* const default_cpu_allocator = cpu_allocator_base();
+  return num_bytes <= kMaxInlineBufferBytes && a == default_cpu_allocator &&
+         !CPUAllocatorStatsEnabled() && !MemoryLoggingEnabled();
+}
+
+// Creates the buffer for a tensor of `n` elements of type `T` allocated from
+// `a`, storing small payloads of simple types inline.
+template <typename T>
+TensorBuffer* NewBuffer(Allocator* a, int64_t n,
+                        const AllocationAttributes& allocation_attr) {
+  if (is_simple_type<T>::value && allocation_attr.freed_by_func == nullptr &&
+      CanUseInlineBuffer(a, sizeof(T) * n)) {
+    return new InlineBuffer(a, sizeof(T) * n);
+  }
+  return new Buffer<T>(a, n, allocation_attr);
+}
+
 // Allocates a T[n] buffer. Fills in the buffer with repeated values
 // in "in".  If "in" has less values than "n", fills the rest of T[n]
 // with the last value. If "in" has no values, fills T[n] with the
@@ -893,7 +1020,8 @@ Tensor::Tensor(Allocator* a, DataType type, const TensorShape& shape)
   set_dtype(type);
   CHECK_NOTNULL(a);
   if (shape_.num_elements() > 0 || a->AllocatesOpaqueHandle()) {
-    CASES(type, buf_ = new Buffer<T>(a, shape.num_elements()));
+    CASES(type, buf_ = NewBuffer<T>(a, shape.num_elements(),
+                                    AllocationAttributes()));
   }
   if (MemoryLoggingEnabled() && buf_ != nullptr && buf_->data() != nullptr) {
     LogMemory::RecordTensorAllocation("Unknown", LogMemory::UNKNOWN_STEP_ID,
@@ -907,7 +1035,8 @@ Tensor::Tensor(Allocator* a, DataType type, const TensorShape& shape,
   set_dtype(type);
   CHECK_NOTNULL(a);
   if (shape_.num_elements() > 0 || a->AllocatesOpaqueHandle()) {
-    CASES(type, buf_ = new Buffer<T>(a, shape.num_elements(), allocation_attr));
+    CASES(type,
+          buf_ = NewBuffer<T>(a, shape.num_elements(), allocation_attr));
   }
   if (MemoryLoggingEnabled() && !allocation_attr.allocation_will_be_logged &&
       buf_ != nullptr && buf_->data() != nullptr) {
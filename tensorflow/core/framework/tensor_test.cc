@@ -34,6 +34,7 @@ limitations under the License.
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
+#include "tensorflow/core/platform/threadpool.h"
 
 namespace tensorflow {
 
@@ -1872,6 +1873,61 @@ void BM_Assign(::testing::benchmark::State& state) {
 }
 BENCHMARK(BM_Assign);
 
+// Small tensors allocated from the default CPU allocator keep their payload in
+// the tensor buffer. Check that this is not observable.
+TEST(Tensor, SmallBuffers) {
+  for (int64_t n : {1, 2, 8, 9, 64}) {
+    Tensor t(DT_INT32, TensorShape({n}));
+    EXPECT_TRUE(t.IsAligned());
+    for (int i = 0; i < n; ++i) t.flat<int32>()(i) = i;
+    Tensor copy = t;
+    EXPECT_TRUE(copy.SharesBufferWith(t));
+    EXPECT_EQ(copy.tensor_data().data(), t.tensor_data().data());
+    Tensor slice = t.Slice(n - 1, n);
+    EXPECT_TRUE(slice.SharesBufferWith(t));
+    EXPECT_EQ(slice.flat<int32>()(0), n - 1);
+
+    copy = Tensor();
+    slice = Tensor();
+    EXPECT_TRUE(t.RefCountIsOne());
+    EXPECT_EQ(t.TotalBytes(), n * sizeof(int32));
+    EXPECT_EQ(t.AllocatedBytes(), n * sizeof(int32));
+
+    TensorDescription desc;
+    t.FillDescription(&desc);
+    EXPECT_EQ(desc.allocation_description().requested_bytes(),
+              n * sizeof(int32));
+    EXPECT_EQ(desc.allocation_description().allocator_name(),
+              cpu_allocator()->Name());
+  }
+}
+
+TEST(Tensor, SmallBuffersReleasedOnOtherThreads) {
+  constexpr int kNumTensors = 1000;
+  std::vector<Tensor> tensors;
+  for (int i = 0; i < kNumTensors; ++i) {
+    tensors.emplace_back(DT_INT64, TensorShape({2}));
+    tensors.back().flat<int64_t>()(1) = i;
+  }
+  {
+    thread::ThreadPool pool(Env::Default(), "release", 4);
+    for (int i = 0; i < kNumTensors; ++i) {
+      pool.Schedule([i, t = std::move(tensors[i])]() mutable {
+        EXPECT_EQ(t.flat<int64_t>()(1), i);
+        t = Tensor();
+        Tensor other(DT_INT64, TensorShape({2}));
+        other.flat<int64_t>()(1) = -i;
+        EXPECT_EQ(other.flat<int64_t>()(1), -i);
+      });
+    }
+  }
+  for (int i = 0; i < kNumTensors; ++i) {
+    Tensor t(DT_INT64, TensorShape({2}));
+    t.flat<int64_t>()(1) = i;
+    EXPECT_EQ(t.flat<int64_t>()(1), i);
+  }
+}
+
 // Ensure tensor_data() works on empty tensors
 TEST(Tensor, EmptyTensorData) {
   Tensor empty;
@@ -1933,6 +1989,33 @@ void BM_CreateAndDestroyHostScalarOptimized(
 }
 BENCHMARK(BM_CreateAndDestroyHostScalarOptimized);
 
+// Benchmark creating and destroying small tensors, e.g. as produced by shape
+// manipulation ops, using the allocator interface.
+void BM_CreateAndDestroySmall(::testing::benchmark::State& state) {
+  const int num_elements = state.range(0);
+  TensorShape shape({num_elements});
+  Allocator* allocator = cpu_allocator();
+  for (auto s : state) {
+    Tensor a(allocator, DT_INT32, shape);
+    a.flat<int32>()(0) = 37;
+  }
+}
+BENCHMARK(BM_CreateAndDestroySmall)->Arg(1)->Arg(4)->Arg(8)->Arg(16);
+
+// Benchmark a churn of scalar tensors that outlive each other, as in a graph
+// that computes many shapes.
+void BM_ScalarChurn(::testing::benchmark::State& state) {
+  constexpr int kNumLive = 64;
+  std::vector<Tensor> live(kNumLive);
+  int i = 0;
+  for (auto s : state) {
+    live[i % kNumLive] = Tensor(DT_INT64, TensorShape({}));
+    live[i % kNumLive].scalar<int64_t>()() = i;
+    ++i;
+  }
+}
+BENCHMARK(BM_ScalarChurn);
+
 void BM_FromProto(::testing::benchmark::State& state) {
   const int size = state.range(0);
 
@@ -564,6 +564,26 @@ class Graph {
   // Same as above, but using StatusOr. This method is always preferred.
   StatusOr<Node*> AddNode(NodeDef node_def);
 
+  // The properties of a node computed by PrepareNode().
+  struct PreparedNode {
+    std::shared_ptr<NodeProperties> props;
+    bool is_function_op = false;
+  };
+
+  // Infers the Op, the input/output types and the full type of a node for
+  // `*node_def` like AddNode() does, but without adding it to this graph. On
+  // success the result owns the NodeDef moved from `*node_def`; on error
+  // `*node_def` is left unchanged.
+  //
+  // This only reads the op registry of the graph, so it may be called
+  // concurrently for different NodeDefs, e.g. to build the nodes of a large
+  // graph in parallel before adding them in order with AddPreparedNode().
+  StatusOr<PreparedNode> PrepareNode(NodeDef* node_def) const;
+
+  // Adds a node prepared by PrepareNode() to this graph, and returns it.
+  // *this owns the returned instance.
+  Node* AddPreparedNode(PreparedNode prepared);
+
   // Copies *node, which may belong to another graph, to a new node,
   // which is returned.  Does not copy any edges.  *this owns the
   // returned instance.
@@ -16,6 +16,9 @@ limitations under the License.
 
 #include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
 
+#include <algorithm>
+#include <cmath>
+#include <iterator>
 #include <optional>
 
 #include "absl/strings/match.h"
@@ -28,7 +31,9 @@ limitations under the License.
 #include "tensorflow/core/grappler/clusters/utils.h"
 #include "tensorflow/core/grappler/costs/op_context.h"
 #include "tensorflow/core/grappler/costs/utils.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/overflow.h"
 
 namespace tensorflow {
@@ -649,9 +654,33 @@ OpLevelCostEstimator::OpLevelCostEstimator() {
 
   // By default, use sum of memory_time and compute_time for execution_time.
   compute_memory_overlap_ = false;
+
+  // Optionally calibrate the estimates with a table produced by
+  // BuildCalibration() on the target machine.
+  static const OpCostCalibration* const calibration_from_file = [] {
+    auto* calibration = new OpCostCalibration();
+    string path;
+    TF_CHECK_OK(ReadStringFromEnvVar("TF_GRAPPLER_OP_COST_CALIBRATION_FILE",
+                                     "", &path));
+    if (!path.empty()) {
+      Status status = ReadBinaryProto(Env::Default(), path, calibration);
+      if (!status.ok()) {
+        LOG(WARNING) << "Failed to read op cost calibration from " << path
+                     << ": " << status;
+        calibration->Clear();
+      }
+    }
+    return calibration;
+  }();
+  SetCalibration(*calibration_from_file);
 }
 
 Costs OpLevelCostEstimator::PredictCosts(const OpContext& op_context) const {
+  return PredictCostsImpl(op_context, /*calibrated=*/true);
+}
+
+Costs OpLevelCostEstimator::PredictCostsImpl(const OpContext& op_context,
+                                             bool calibrated) const {
   Costs costs;
   NodeCosts node_costs;
   if (PredictNodeCosts(op_context, &node_costs).ok()) {
@@ -676,6 +705,7 @@ Costs OpLevelCostEstimator::PredictCosts(const OpContext& op_context) const {
       costs = PredictOpCountBasedCost(
           node_costs.num_compute_ops, node_costs.num_total_read_bytes(),
           node_costs.num_total_write_bytes(), op_context.op_info);
+      if (calibrated) ApplyCalibration(op_context.op_info, &costs);
     }
     VLOG(1) << "Operation " << op_context.op_info.op() << " takes "
             << costs.execution_time.count() << " ns.";
@@ -826,6 +856,105 @@ Status OpLevelCostEstimator::PredictCostOfAnUnknownOp(
                                  node_costs);
 }
 
+OpCostCalibration OpLevelCostEstimator::BuildCalibration(
+    const OpPerformanceList& measurements) const {
+  struct BucketSums {
+    double predicted_time = 0;
+    double measured_time = 0;
+    int64_t num_measurements = 0;
+  };
+  std::map<std::pair<string, string>, std::map<int, BucketSums>> buckets;
+  for (const OpPerformance& op_perf : measurements.op_performance()) {
+    if (op_perf.compute_cost() <= 0) continue;
+    OpContext op_context;
+    op_context.name = op_perf.node();
+    op_context.op_info = op_perf.op();
+    const Costs costs = PredictCostsImpl(op_context, /*calibrated=*/false);
+    const double predicted_time = costs.execution_time.count();
+    if (costs.inaccurate || predicted_time <= 0) continue;
+    BucketSums& sums =
+        buckets[{op_perf.op().device().type(), op_perf.op().op()}]
+               [std::ilogb(predicted_time)];
+    sums.predicted_time += predicted_time;
+    sums.measured_time += op_perf.compute_cost();
+    ++sums.num_measurements;
+  }
+
+  OpCostCalibration calibration;
+  for (const auto& op_buckets : buckets) {
+    OpCostCalibration::Entry* entry = calibration.add_entries();
+    entry->set_device_type(op_buckets.first.first);
+    entry->set_op(op_buckets.first.second);
+    for (const auto& bucket : op_buckets.second) {
+      const BucketSums& sums = bucket.second;
+      OpCostCalibration::Bucket* calibrated_bucket = entry->add_buckets();
+      calibrated_bucket->set_predicted_time(sums.predicted_time /
+                                            sums.num_measurements);
+      calibrated_bucket->set_measured_time(sums.measured_time /
+                                           sums.num_measurements);
+      calibrated_bucket->set_num_measurements(sums.num_measurements);
+    }
+  }
+  return calibration;
+}
+
+void OpLevelCostEstimator::SetCalibration(
+    const OpCostCalibration& calibration) {
+  calibration_.clear();
+  for (const OpCostCalibration::Entry& entry : calibration.entries()) {
+    std::vector<std::pair<double, double>>& points =
+        calibration_[{entry.device_type(), entry.op()}];
+    for (const OpCostCalibration::Bucket& bucket : entry.buckets()) {
+      if (bucket.predicted_time() <= 0 || bucket.measured_time() <= 0) continue;
+      points.emplace_back(bucket.predicted_time(), bucket.measured_time());
+    }
+    std::sort(points.begin(), points.end());
+  }
+}
+
+void OpLevelCostEstimator::ApplyCalibration(const OpInfo& op_info,
+                                            Costs* costs) const {
+  auto it = calibration_.find({op_info.device().type(), op_info.op()});
+  if (it == calibration_.end() || it->second.empty()) return;
+  const std::vector<std::pair<double, double>>& points = it->second;
+  const double predicted_time = costs->execution_time.count();
+  if (predicted_time <= 0) return;
+
+  // Interpolates the measured/predicted ratio linearly in log(predicted time),
+  // and extends the ratio of the outermost buckets beyond them.
+  double ratio;
+  auto upper = std::lower_bound(
+      points.begin(), points.end(), predicted_time,
+      [](const std::pair<double, double>& point, double time) {
+        return point.first < time;
+      });
+  if (upper == points.begin()) {
+    ratio = upper->second / upper->first;
+  } else if (upper == points.end()) {
+    ratio = points.back().second / points.back().first;
+  } else {
+    auto lower = std::prev(upper);
+    const double lower_ratio = lower->second / lower->first;
+    const double upper_ratio = upper->second / upper->first;
+    const double weight = std::log(predicted_time / lower->first) /
+                          std::log(upper->first / lower->first);
+    ratio = lower_ratio + weight * (upper_ratio - lower_ratio);
+  }
+  VLOG(1) << "Op:" << op_info.op() << " calibration ratio: " << ratio;
+
+  auto scale = [ratio](Costs::Duration duration) {
+    return Costs::NanoSeconds(std::ceil(duration.count() * ratio));
+  };
+  costs->compute_time = scale(costs->compute_time);
+  costs->memory_time = scale(costs->memory_time);
+  costs->intermediate_memory_time = scale(costs->intermediate_memory_time);
+  costs->intermediate_memory_read_time =
+      scale(costs->intermediate_memory_read_time);
+  costs->intermediate_memory_write_time =
+      scale(costs->intermediate_memory_write_time);
+  CombineCostsAndUpdateExecutionTime(compute_memory_overlap_, costs);
+}
+
 Costs OpLevelCostEstimator::PredictOpCountBasedCost(
     double operations, const OpInfo& op_info) const {
   bool unknown_shapes = false;
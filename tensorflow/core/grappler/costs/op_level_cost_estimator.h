@@ -16,7 +16,10 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_GRAPPLER_COSTS_OP_LEVEL_COST_ESTIMATOR_H_
 #define TENSORFLOW_CORE_GRAPPLER_COSTS_OP_LEVEL_COST_ESTIMATOR_H_
 
+#include <map>
 #include <numeric>
+#include <utility>
+#include <vector>
 
 #include "tensorflow/core/grappler/costs/cost_estimator.h"
 #include "tensorflow/core/grappler/costs/op_context.h"
@@ -98,6 +101,21 @@ class OpLevelCostEstimator {
   // Returns basic device performance info.
   virtual DeviceInfo GetDeviceInfo(const DeviceProperties& device) const;
 
+  // Builds a calibration table from measured op performance, e.g. from
+  // CostGraphToOpPerformanceData() on the cost graph of a run on the target
+  // machine. The measured compute_cost of every op is matched with the
+  // uncalibrated prediction of this estimator, and the pairs are bucketed by
+  // powers of two of the predicted time.
+  OpCostCalibration BuildCalibration(
+      const OpPerformanceList& measurements) const;
+
+  // Makes PredictCosts() scale the analytical costs of the ops covered by
+  // `calibration` by the ratio of measured to predicted time, interpolated
+  // between the buckets around the prediction. Replaces any previous
+  // calibration, including the one read at construction from the file named by
+  // the TF_GRAPPLER_OP_COST_CALIBRATION_FILE environment variable.
+  void SetCalibration(const OpCostCalibration& calibration);
+
  protected:
   // TODO(dyoon): Consider to remove PredictOpCountBasedCosts() with OpInfo.
   // Naive cost estimate based on the given operations count and total
@@ -111,6 +129,13 @@ class OpLevelCostEstimator {
                                 double output_io_bytes,
                                 const OpInfo& op_info) const;
 
+  // Predicts the costs of the op, applying the calibration set by
+  // SetCalibration() if `calibrated` is true.
+  Costs PredictCostsImpl(const OpContext& op_context, bool calibrated) const;
+
+  // Scales `costs` according to the calibration entry of the op, if any.
+  void ApplyCalibration(const OpInfo& op_info, Costs* costs) const;
+
   // Top-level method cost function (PredictCosts calls this method to get
   // NodeCosts, and then converts it to Costs). PredictNodeCosts() calls other
   // Predict methods depending on op types.
@@ -322,6 +347,10 @@ class OpLevelCostEstimator {
   // compute_time and memory_time, instead of sum of those two.
   bool compute_memory_overlap_;
   std::set<string> persistent_ops_;
+  // Calibration buckets keyed by (device type, op), as sorted pairs of
+  // predicted and measured execution time.
+  std::map<std::pair<string, string>, std::vector<std::pair<double, double>>>
+      calibration_;
 
  private:
   friend class OpLevelCostEstimatorTest;
@@ -1167,6 +1167,47 @@ TEST_F(OpLevelCostEstimatorTest, BroadcastAddExecutionTime) {
   EXPECT_EQ(cost.persistent_memory, 0);
 }
 
+TEST_F(OpLevelCostEstimatorTest, Calibration) {
+  const OpContext small = DescribeMatMul(32, 32, 32, 32);
+  const OpContext medium = DescribeMatMul(128, 128, 128, 128);
+  const OpContext large = DescribeMatMul(512, 512, 512, 512);
+  const int64_t small_time = PredictCosts(small).execution_time.count();
+  const int64_t medium_time = PredictCosts(medium).execution_time.count();
+  const int64_t large_time = PredictCosts(large).execution_time.count();
+
+  // Small MatMuls are measured 4x slower than predicted, large ones 2x.
+  OpPerformanceList measurements;
+  for (int i = 0; i < 3; ++i) {
+    OpPerformance* op_perf = measurements.add_op_performance();
+    *op_perf->mutable_op() = small.op_info;
+    op_perf->set_compute_cost(4 * small_time);
+    op_perf = measurements.add_op_performance();
+    *op_perf->mutable_op() = large.op_info;
+    op_perf->set_compute_cost(2 * large_time);
+  }
+  const OpCostCalibration calibration =
+      estimator_.BuildCalibration(measurements);
+  ASSERT_EQ(calibration.entries_size(), 1);
+  EXPECT_EQ(calibration.entries(0).op(), "MatMul");
+  EXPECT_EQ(calibration.entries(0).device_type(), "CPU");
+  ASSERT_EQ(calibration.entries(0).buckets_size(), 2);
+  EXPECT_EQ(calibration.entries(0).buckets(0).num_measurements(), 3);
+
+  estimator_.SetCalibration(calibration);
+  EXPECT_NEAR(PredictCosts(small).execution_time.count(), 4 * small_time, 4);
+  EXPECT_NEAR(PredictCosts(large).execution_time.count(), 2 * large_time, 4);
+  const int64_t calibrated_medium_time =
+      PredictCosts(medium).execution_time.count();
+  EXPECT_GT(calibrated_medium_time, 2 * medium_time);
+  EXPECT_LT(calibrated_medium_time, 4 * medium_time);
+
+  // Ops without calibration data keep their analytical costs.
+  const OpContext conv = DescribeConvolution(16, 19, 19, 48, 48, 5, 5, 256);
+  OpLevelCostEstimator uncalibrated;
+  EXPECT_EQ(PredictCosts(conv).execution_time,
+            uncalibrated.PredictCosts(conv).execution_time);
+}
+
 TEST_F(OpLevelCostEstimatorTest, UnknownOrPartialShape) {
   {
     auto cost = PredictCosts(DescribeMatMul(2, 4, 7, 7));
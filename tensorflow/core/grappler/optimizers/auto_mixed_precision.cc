@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/grappler/optimizers/auto_mixed_precision.h"
 
+#include <algorithm>
+#include <cmath>
 #include <fstream>
 #include <memory>
 #include <string>
@@ -28,6 +30,7 @@ limitations under the License.
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/grappler/clusters/cluster.h"
@@ -1067,6 +1070,8 @@ class AutoMixedPrecisionImpl {
                                                              cudnn_version_);
       case AutoMixedPrecisionMode::BF16:
         return std::make_unique<AutoMixedPrecisionListsMkl>();
+      case AutoMixedPrecisionMode::INT8:
+        return std::make_unique<AutoMixedPrecisionListsInt8>();
       case AutoMixedPrecisionMode::CPU:
         // Note: this is not a typo here. AutoMixedPrecisionListsCuda is used
         // intentionally to make CPU and GPU have the same fp16 ops.
@@ -1428,6 +1433,7 @@ Status AutoMixedPrecisionImpl::Optimize() {
         break;
       case AutoMixedPrecisionMode::BF16:
       case AutoMixedPrecisionMode::CPU:
+      case AutoMixedPrecisionMode::INT8:
         device_type = DEVICE_CPU;
         should_process = !MustPreserve(node) && IsOnDevice(node, device_type);
         break;
@@ -2258,6 +2264,305 @@ Status AutoMixedPrecisionImpl::ChangeTypeAttrsAndAddCasts(
   return OkStatus();
 }
 
+// Rewrites float MatMul and Conv2D nodes with constant weights on CPU into
+// their dynamic-range int8 equivalents: the weights are quantized to quint8
+// once, here, while the activation is quantized by QuantizeV2 over its own
+// range on every step. The qint32 result is dequantized back to float under
+// the original node name, so the fanouts of the node are left untouched.
+class DynamicRangeInt8Rewriter {
+ public:
+  DynamicRangeInt8Rewriter(Cluster* cluster,
+                           const std::unordered_set<string>& nodes_to_preserve,
+                           GraphDef* graph)
+      : devices_(GetDevices(cluster)),
+        virtual_placer_(devices_),
+        nodes_to_preserve_(nodes_to_preserve),
+        graph_(graph) {}
+
+  Status Optimize();
+
+ private:
+  bool IsOnCpu(const NodeDef& node) const;
+  bool IsRewritable(const NodeDef& node) const;
+  bool IsFedByDenyOp(const NodeDef& node) const;
+  NodeDef* AddConstNode(const string& name, const string& device,
+                        const std::vector<string>& control_inputs,
+                        const Tensor& value);
+  Status Rewrite(int node_index, const Tensor& weights,
+                 const std::vector<string>& control_inputs);
+
+  std::unordered_map<string, DeviceProperties> devices_;
+  VirtualPlacer virtual_placer_;
+  std::unordered_set<string> nodes_to_preserve_;
+  GraphDef* graph_;
+  absl::flat_hash_map<string, const NodeDef*> node_by_name_;
+  gtl::FlatSet<string> allow_list_;
+  gtl::FlatSet<string> deny_list_;
+  gtl::FlatSet<string> infer_list_;
+  gtl::FlatSet<string> clear_list_;
+};
+
+// Quantizes `weights` to quint8 over a range that includes zero, exactly as
+// QuantizeV2 in MIN_FIRST mode would (see FloatToQuantized in
+// kernels/quantization_utils.h).
+void QuantizeWeights(const Tensor& weights, Tensor* quantized, float* min,
+                     float* max) {
+  const auto values = weights.flat<float>();
+  float min_value = 0.0f;
+  float max_value = 0.0f;
+  for (int64_t i = 0; i < values.size(); ++i) {
+    min_value = std::min(min_value, values(i));
+    max_value = std::max(max_value, values(i));
+  }
+  // Mirrors the ensure_minimum_range default of QuantizeV2.
+  const float epsilon =
+      std::max(1.0f, std::max(std::abs(min_value), std::abs(max_value))) *
+      0.01f;
+  max_value = std::max(max_value, min_value + epsilon);
+
+  const double range_adjust = 256.0 / 255.0;
+  const double range_scale =
+      256.0 / ((static_cast<double>(max_value) - min_value) * range_adjust);
+  const int64_t lowest_quantized =
+      static_cast<int64_t>(std::round(min_value * range_scale));
+  *quantized = Tensor(DT_QUINT8, weights.shape());
+  auto quantized_values = quantized->flat<quint8>();
+  for (int64_t i = 0; i < values.size(); ++i) {
+    const int64_t q =
+        static_cast<int64_t>(std::round(values(i) * range_scale)) -
+        lowest_quantized;
+    quantized_values(i) =
+        static_cast<uint8>(std::min<int64_t>(255, std::max<int64_t>(0, q)));
+  }
+  *min = min_value;
+  *max = max_value;
+}
+
+bool DynamicRangeInt8Rewriter::IsOnCpu(const NodeDef& node) const {
+  const string device_name =
+      node.device().empty() ? virtual_placer_.get_canonical_device_name(node)
+                            : node.device();
+  string device;
+  string not_used;
+  return DeviceNameUtils::SplitDeviceName(device_name, &not_used, &device) &&
+         absl::StrContains(absl::AsciiStrToLower(device),
+                           absl::AsciiStrToLower(DEVICE_CPU));
+}
+
+bool DynamicRangeInt8Rewriter::IsRewritable(const NodeDef& node) const {
+  if (!allow_list_.count(node.op())) return false;
+  if (!IsMatMul(node) && !IsConv2D(node)) {
+    VLOG(2) << "No quantized kernel for allow list op " << node.op()
+            << ", skipping " << node.name();
+    return false;
+  }
+  if (nodes_to_preserve_.count(node.name()) || !IsOnCpu(node)) return false;
+  if (node.input_size() < 2 || IsControlInput(node.input(1)) ||
+      GetDataTypeFromAttr(node, "T") != DT_FLOAT) {
+    return false;
+  }
+  if (IsConv2D(node)) {
+    // QuantizedConv2D only supports NHWC without dilations.
+    const AttrValue* data_format = AttrSlice(node).Find("data_format");
+    if (data_format != nullptr && data_format->s() != "NHWC") return false;
+    const string& padding = node.attr().at("padding").s();
+    if (padding != "SAME" && padding != "VALID") return false;
+    const AttrValue* dilations = AttrSlice(node).Find("dilations");
+    if (dilations != nullptr) {
+      for (int64_t dilation : dilations->list().i()) {
+        if (dilation != 1) return false;
+      }
+    }
+  }
+  return !IsFedByDenyOp(node);
+}
+
+bool DynamicRangeInt8Rewriter::IsFedByDenyOp(const NodeDef& node) const {
+  // Walks the activation back through infer and clear list ops.
+  absl::flat_hash_set<string> visited;
+  std::vector<string> to_visit = {NodeName(node.input(0))};
+  while (!to_visit.empty()) {
+    const string name = to_visit.back();
+    to_visit.pop_back();
+    if (!visited.insert(name).second) continue;
+    auto it = node_by_name_.find(name);
+    if (it == node_by_name_.end()) continue;
+    const NodeDef& producer = *it->second;
+    if (deny_list_.count(producer.op())) return true;
+    if (!clear_list_.count(producer.op()) &&
+        !infer_list_.count(producer.op())) {
+      continue;
+    }
+    for (const string& input : producer.input()) {
+      if (!IsControlInput(input)) to_visit.push_back(NodeName(input));
+    }
+  }
+  return false;
+}
+
+NodeDef* DynamicRangeInt8Rewriter::AddConstNode(
+    const string& name, const string& device,
+    const std::vector<string>& control_inputs, const Tensor& value) {
+  NodeDef* node = graph_->add_node();
+  node->set_name(name);
+  node->set_op("Const");
+  node->set_device(device);
+  for (const string& input : control_inputs) node->add_input(input);
+  (*node->mutable_attr())["dtype"].set_type(value.dtype());
+  value.AsProtoTensorContent(
+      (*node->mutable_attr())["value"].mutable_tensor());
+  return node;
+}
+
+Status DynamicRangeInt8Rewriter::Rewrite(
+    int node_index, const Tensor& weights,
+    const std::vector<string>& control_inputs) {
+  const NodeDef original = graph_->node(node_index);
+  const string& name = original.name();
+  const string& device = original.device();
+  const string prefix = strings::StrCat(name, "/", kSuffix, "/");
+
+  // The new constants take the control inputs of the original weights so that
+  // they live in the same frame.
+  Tensor flat_shape(DT_INT32, TensorShape({1}));
+  flat_shape.vec<int32>()(0) = -1;
+  AddConstNode(prefix + "flat_shape", device, control_inputs, flat_shape);
+  AddConstNode(prefix + "reduction_axis", device, control_inputs,
+               Tensor(static_cast<int32>(0)));
+  Tensor quantized_weights;
+  float weights_min, weights_max;
+  QuantizeWeights(weights, &quantized_weights, &weights_min, &weights_max);
+  AddConstNode(prefix + "weights", device, control_inputs, quantized_weights);
+  AddConstNode(prefix + "weights_min", device, control_inputs,
+               Tensor(weights_min));
+  AddConstNode(prefix + "weights_max", device, control_inputs,
+               Tensor(weights_max));
+
+  NodeDef* flat = graph_->add_node();
+  flat->set_name(prefix + "flat_activation");
+  flat->set_op("Reshape");
+  flat->set_device(device);
+  flat->add_input(original.input(0));
+  flat->add_input(prefix + "flat_shape");
+  (*flat->mutable_attr())["T"].set_type(DT_FLOAT);
+  (*flat->mutable_attr())["Tshape"].set_type(DT_INT32);
+
+  for (const char* op : {"Min", "Max"}) {
+    NodeDef* reduction = graph_->add_node();
+    reduction->set_name(
+        strings::StrCat(prefix, "activation_", absl::AsciiStrToLower(op)));
+    reduction->set_op(op);
+    reduction->set_device(device);
+    reduction->add_input(flat->name());
+    reduction->add_input(prefix + "reduction_axis");
+    (*reduction->mutable_attr())["T"].set_type(DT_FLOAT);
+    (*reduction->mutable_attr())["Tidx"].set_type(DT_INT32);
+    (*reduction->mutable_attr())["keep_dims"].set_b(false);
+  }
+
+  NodeDef* quantize = graph_->add_node();
+  quantize->set_name(prefix + "quantize_activation");
+  quantize->set_op("QuantizeV2");
+  quantize->set_device(device);
+  quantize->add_input(original.input(0));
+  quantize->add_input(prefix + "activation_min");
+  quantize->add_input(prefix + "activation_max");
+  (*quantize->mutable_attr())["T"].set_type(DT_QUINT8);
+  (*quantize->mutable_attr())["mode"].set_s("MIN_FIRST");
+
+  NodeDef* quantized = graph_->add_node();
+  quantized->set_name(prefix + "quantized");
+  quantized->set_device(device);
+  quantized->add_input(quantize->name());
+  quantized->add_input(prefix + "weights");
+  quantized->add_input(strings::StrCat(quantize->name(), ":1"));
+  quantized->add_input(strings::StrCat(quantize->name(), ":2"));
+  quantized->add_input(prefix + "weights_min");
+  quantized->add_input(prefix + "weights_max");
+  for (int i = 2; i < original.input_size(); ++i) {
+    quantized->add_input(original.input(i));
+  }
+  auto* attr = quantized->mutable_attr();
+  if (IsMatMul(original)) {
+    quantized->set_op("QuantizedMatMul");
+    (*attr)["T1"].set_type(DT_QUINT8);
+    (*attr)["T2"].set_type(DT_QUINT8);
+    (*attr)["Toutput"].set_type(DT_QINT32);
+    (*attr)["transpose_a"] = original.attr().at("transpose_a");
+    (*attr)["transpose_b"] = original.attr().at("transpose_b");
+  } else {
+    quantized->set_op("QuantizedConv2D");
+    (*attr)["Tinput"].set_type(DT_QUINT8);
+    (*attr)["Tfilter"].set_type(DT_QUINT8);
+    (*attr)["out_type"].set_type(DT_QINT32);
+    (*attr)["strides"] = original.attr().at("strides");
+    (*attr)["padding"] = original.attr().at("padding");
+  }
+
+  // The Dequantize takes over the original node in place.
+  NodeDef* dequantize = graph_->mutable_node(node_index);
+  dequantize->clear_input();
+  dequantize->clear_attr();
+  dequantize->set_op("Dequantize");
+  dequantize->add_input(quantized->name());
+  dequantize->add_input(strings::StrCat(quantized->name(), ":1"));
+  dequantize->add_input(strings::StrCat(quantized->name(), ":2"));
+  (*dequantize->mutable_attr())["T"].set_type(DT_QINT32);
+  (*dequantize->mutable_attr())["mode"].set_s("MIN_FIRST");
+  (*dequantize->mutable_attr())["dtype"].set_type(DT_FLOAT);
+  return OkStatus();
+}
+
+Status DynamicRangeInt8Rewriter::Optimize() {
+  AutoMixedPrecisionListsInt8 lists;
+  allow_list_ = lists.AllowList();
+  infer_list_ = lists.InferList();
+  deny_list_ = lists.DenyList();
+  clear_list_ = lists.ClearList();
+  TF_RETURN_IF_ERROR(
+      ValidateLists(allow_list_, deny_list_, infer_list_, clear_list_));
+
+  for (const NodeDef& node : graph_->node()) {
+    node_by_name_[node.name()] = &node;
+  }
+
+  // Collect the rewrites up front, since rewriting a node replaces it in
+  // place and would hide its producers from IsFedByDenyOp.
+  struct Candidate {
+    int node_index;
+    Tensor weights;
+    std::vector<string> control_inputs;
+  };
+  std::vector<Candidate> candidates;
+  for (int i = 0; i < graph_->node_size(); ++i) {
+    const NodeDef& node = graph_->node(i);
+    if (!IsRewritable(node)) continue;
+    auto it = node_by_name_.find(NodeName(node.input(1)));
+    if (it == node_by_name_.end() || !IsConstant(*it->second)) continue;
+    const NodeDef& weights_node = *it->second;
+    Candidate candidate;
+    candidate.node_index = i;
+    if (GetDataTypeFromAttr(weights_node, "dtype") != DT_FLOAT ||
+        !candidate.weights.FromProto(
+            weights_node.attr().at("value").tensor())) {
+      continue;
+    }
+    for (const string& input : weights_node.input()) {
+      candidate.control_inputs.push_back(input);
+    }
+    candidates.push_back(std::move(candidate));
+  }
+  node_by_name_.clear();
+
+  for (const Candidate& candidate : candidates) {
+    TF_RETURN_IF_ERROR(Rewrite(candidate.node_index, candidate.weights,
+                               candidate.control_inputs));
+  }
+  LOG(INFO) << "Converted " << candidates.size()
+            << " nodes to dynamic-range int8";
+  return OkStatus();
+}
+
 int GetNumGPUs(const Cluster& cluster) {
   if (ShouldSimulateGpu()) {
     return 1;
@@ -2310,6 +2615,18 @@ Status AutoMixedPrecision::Optimize(Cluster* cluster, const GrapplerItem& item,
                  << " graph optimizer configured for BFloat16 on CPUs";
   }
 
+  if (mode_ == AutoMixedPrecisionMode::INT8) {
+    VLOG(1) << "Running " << name() << " graph optimizer on " << item.id;
+    DynamicRangeInt8Rewriter rewriter(cluster, item.NodesToPreserve(), output);
+    Status status = rewriter.Optimize();
+    if (!status.ok()) {
+      *output = item.graph;
+      LOG(WARNING) << name()
+                   << " graph optimizer FAILED: " << status.ToString();
+    }
+    return status;
+  }
+
   // Optimize the output graph in-place.
   AutoMixedPrecisionImpl optimizer(cluster, item.NodesToPreserve(), output,
                                    item.id, mode_);
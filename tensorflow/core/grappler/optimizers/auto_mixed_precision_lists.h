@@ -564,6 +564,62 @@ class AutoMixedPrecisionListsMkl : public AutoMixedPrecisionLists {
   }
 };
 
+// Lists for the dynamic-range int8 mode. Only allow list ops with a quantized
+// CPU kernel are rewritten, and an allow list op is left in float if its input
+// activation comes (through infer and clear list ops) from a deny list op,
+// since a wide or skewed dynamic range does not survive 8-bit quantization.
+class AutoMixedPrecisionListsInt8 : public AutoMixedPrecisionLists {
+ public:
+  AutoMixedPrecisionListsInt8() {}
+
+  gtl::FlatSet<string> AllowList() override {
+    auto list = gtl::FlatSet<string>{"Conv2D", "MatMul"};
+    UpdateList("ALLOWLIST", &list);
+    return list;
+  }
+
+  gtl::FlatSet<string> InferList() override {
+    auto list = gtl::FlatSet<string>{};
+    UpdateList("INFERLIST", &list);
+    return list;
+  }
+
+  gtl::FlatSet<string> DenyList() override {
+    auto list = gtl::FlatSet<string>{
+        "Exp",
+        "Expm1",
+        "L2Loss",
+        "Log",
+        "Log1p",
+        "LogSoftmax",
+        "Mean",
+        "Pow",
+        "Reciprocal",
+        "Rsqrt",
+        "Softmax",
+        "SoftmaxCrossEntropyWithLogits",
+        "Softplus",
+        "SparseSoftmaxCrossEntropyWithLogits",
+        "Sqrt",
+        "Square",
+        "SquaredDifference",
+        "Sum",
+    };
+    UpdateList("DENYLIST", &list);
+    return list;
+  }
+
+  gtl::FlatSet<string> ClearList() override {
+    auto list = gtl::FlatSet<string>{
+        "ConcatV2", "ExpandDims", "Identity", "MaxPool",
+        "Pad",      "Relu",       "Relu6",    "Reshape",
+        "Snapshot", "Squeeze",    "StopGradient", "Transpose",
+    };
+    UpdateList("CLEARLIST", &list);
+    return list;
+  }
+};
+
 }  // end namespace grappler
 }  // end namespace tensorflow
 
@@ -31,6 +31,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/clusters/virtual_cluster.h"
 #include "tensorflow/core/grappler/devices.h"
 #include "tensorflow/core/grappler/graph_view.h"
+#include "tensorflow/core/grappler/utils.h"
 #include "tensorflow/core/grappler/utils/grappler_test.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/random/random.h"
@@ -1359,6 +1360,54 @@ TEST_F(AutoMixedPrecisionCpuTest, MixedFanout) {
   }
 }
 
+TEST_F(AutoMixedPrecisionCpuTest, DynamicRangeInt8) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope().WithDevice(
+      "/job:localhost/replica:0/task:0/device:CPU:0");
+  Output input = ops::Const(s.WithOpName("input"),
+                            GenerateTensorWithSetRandom<DT_FLOAT>({8, 16}));
+  Output weights = ops::Const(s.WithOpName("weights"),
+                              GenerateTensorWithSetRandom<DT_FLOAT>({16, 4}));
+  Output allow1 = ops::MatMul(s.WithOpName("allow1"), input, weights);
+  Output deny1 = ops::Exp(s.WithOpName("deny1"), input);
+  Output clr1 = ops::Relu(s.WithOpName("clr1"), deny1);
+  Output allow2 = ops::MatMul(s.WithOpName("allow2"), clr1, weights);
+  Output fetch1 = ops::Identity(s.WithOpName("fetch1"), allow1);
+  Output fetch2 = ops::Identity(s.WithOpName("fetch2"), allow2);
+
+  GrapplerItem item;
+  item.fetch = {"fetch1", "fetch2"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch);
+
+  AutoMixedPrecision optimizer{AutoMixedPrecisionMode::INT8};
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(virtual_cluster_.get(), item, &output));
+
+  VLOG(1) << output.DebugString();
+
+  GraphView output_view(&output);
+  // The original name now holds the dequantized result of the int8 MatMul.
+  EXPECT_EQ(output_view.GetNode("allow1")->op(), "Dequantize");
+  const NodeDef* quantized =
+      output_view.GetNode("allow1/AutoMixedPrecision/quantized");
+  ASSERT_NE(quantized, nullptr);
+  EXPECT_EQ(quantized->op(), "QuantizedMatMul");
+  EXPECT_EQ(output_view.GetNode(NodeName(quantized->input(0)))->op(),
+            "QuantizeV2");
+  const NodeDef* quantized_weights =
+      output_view.GetNode(NodeName(quantized->input(1)));
+  EXPECT_EQ(quantized_weights->attr().at("dtype").type(), DT_QUINT8);
+  // An activation coming from a deny list op is left in float.
+  EXPECT_EQ(output_view.GetNode("allow2")->op(), "MatMul");
+
+  auto tensors = EvaluateNodes(output, item.fetch);
+  ASSERT_EQ(tensors.size(), tensors_expected.size());
+  for (int i = 0; i < tensors.size(); ++i) {
+    test::ExpectClose(tensors_expected[i], tensors[i], /*atol=*/0.1,
+                      /*rtol=*/0.05);
+  }
+}
+
 class AutoMixedPrecisionSimulateGpuTest : public GrapplerTest {
  protected:
   void SetUp() override {
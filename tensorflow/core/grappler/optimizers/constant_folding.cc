@@ -23,6 +23,7 @@ limitations under the License.
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "absl/strings/substitute.h"
+#include "tensorflow/core/common_runtime/constant_folding_cache.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/attr_value.pb.h"
 #include "tensorflow/core/framework/function.pb.h"
@@ -65,6 +66,9 @@ using TensorVector = gtl::InlinedVector<TensorValue, 4>;
 
 // We only fold/materialize constants smaller than 100kB.
 const int64_t kMaxConstantSize = 100 * 1024;
+// Nodes with smaller inputs are cheaper to evaluate than to look up in the
+// persistent constant folding cache.
+const int64_t kMinCachedInputSize = 64 * 1024;
 
 namespace {
 template <typename T>
@@ -1358,6 +1362,7 @@ Status ConstantFolding::EvaluateOneFoldable(const NodeDef& node,
   });
 
   size_t total_inputs_size = 0;
+  std::vector<const NodeDef*> subgraph = {&node};
   for (const auto& input : node.input()) {
     const TensorId input_tensor = ParseTensorName(input);
     if (input_tensor.index() < 0) {
@@ -1365,6 +1370,7 @@ Status ConstantFolding::EvaluateOneFoldable(const NodeDef& node,
       break;
     }
     const NodeDef* input_node = node_map_->GetNode(input);
+    subgraph.push_back(input_node);
     if (!IsReallyConstant(*input_node)) {
       return Status(absl::StatusCode::kInvalidArgument,
                     strings::StrCat("Can't fold ", node.name(), ", its ", input,
@@ -1395,7 +1401,29 @@ Status ConstantFolding::EvaluateOneFoldable(const NodeDef& node,
     total_inputs_size += value->TotalBytes();
   }
 
-  TF_RETURN_IF_ERROR(EvaluateNode(node, inputs, &output_tensors));
+  ConstantFoldingCache* cache = ConstantFoldingCache::Default();
+  std::string cache_key;
+  if (cache != nullptr && total_inputs_size >= kMinCachedInputSize) {
+    cache_key =
+        ConstantFoldingCache::ComputeKey(subgraph, {node.name()}, DEVICE_CPU);
+  }
+  std::vector<Tensor> cached_outputs;
+  if (!cache_key.empty() && cache->Lookup(cache_key, &cached_outputs)) {
+    for (const Tensor& t : cached_outputs) {
+      output_tensors.emplace_back(t.IsInitialized() ? new Tensor(t) : nullptr);
+    }
+  } else {
+    TF_RETURN_IF_ERROR(EvaluateNode(node, inputs, &output_tensors));
+    if (!cache_key.empty()) {
+      for (const auto& output : output_tensors) {
+        cached_outputs.push_back(output.tensor ? *output.tensor : Tensor());
+      }
+      Status s = cache->Insert(cache_key, cached_outputs);
+      if (!s.ok()) {
+        LOG(WARNING) << "Could not cache folded constants: " << s;
+      }
+    }
+  }
   if (output_tensors.empty()) {
     return Status(absl::StatusCode::kInvalidArgument,
                   "Expected at least one output.");
@@ -67,6 +67,7 @@ const ConfigList& DefaultPluginConfigs() {
        {"auto_mixed_precision_onednn_bfloat16", RewriterConfig::ON},
        {"auto_mixed_precision_mkl", RewriterConfig::ON},
        {"auto_mixed_precision_cpu", RewriterConfig::ON},
+       {"auto_mixed_precision_int8", RewriterConfig::ON},
        {"pin_to_host_optimization", RewriterConfig::ON},
        {"layout_optimizer", RewriterConfig::ON},
        {"remapping", RewriterConfig::ON},
@@ -15,14 +15,18 @@ limitations under the License.
 
 #include "tensorflow/core/grappler/optimizers/data/map_and_batch_fusion.h"
 
+#include <vector>
+
 #include "absl/container/flat_hash_set.h"
 #include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/function.pb.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/grappler/clusters/cluster.h"
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/mutable_graph_view.h"
 #include "tensorflow/core/grappler/op_types.h"
 #include "tensorflow/core/grappler/optimizers/custom_graph_optimizer_registry.h"
+#include "tensorflow/core/grappler/optimizers/data/function_utils.h"
 #include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
 #include "tensorflow/core/grappler/utils.h"
 #include "tensorflow/core/platform/protobuf.h"
@@ -34,11 +38,82 @@ namespace {
 constexpr char kFusedOpName[] = "MapAndBatchDataset";
 constexpr char kParallelMap[] = "ParallelMapDataset";
 constexpr char kParallelMapV2[] = "ParallelMapDatasetV2";
+constexpr char kRaggedTensorToVariant[] = "RaggedTensorToVariant";
 
 bool IsParallelMap(const NodeDef& node) {
   return node.op() == kParallelMap || node.op() == kParallelMapV2;
 }
 
+// Returns the node of `function` producing `tensor`, skipping identities, or
+// nullptr if `tensor` is not produced by a node.
+const NodeDef* GetProducingNode(const FunctionDef& function,
+                                StringPiece tensor) {
+  while (true) {
+    const int index = function_utils::FindFunctionNodeWithName(
+        tensor.substr(0, tensor.find(':')), function);
+    if (index < 0) return nullptr;
+    const NodeDef& node = function.node_def(index);
+    if (node.op() != "Identity") return &node;
+    tensor = node.input(0);
+  }
+}
+
+// Sets the `ragged_components` of the fused node to the components that the
+// map function encodes with "RaggedTensorToVariant", which is how `tf.data`
+// represents elements of type `RaggedTensorSpec`. The fused node then builds
+// each batch of these components as a single ragged tensor, instead of a vector
+// of per-element encodings that the consumer has to decode and stack again.
+//
+// Elements that are encoded with a ragged rank of 0 are dense tensors whose row
+// splits type is only known to the consumer, so they are batched as before.
+void SetRaggedComponents(const NodeDef& map_node, const NodeDef& batch_node,
+                         const FunctionDefLibrary& library,
+                         NodeDef* new_node) {
+  const int function_index = graph_utils::FindGraphFunctionWithName(
+      map_node.attr().at("f").func().name(), library);
+  const AttrValue* output_shapes_attr =
+      gtl::FindOrNull(batch_node.attr(), "output_shapes");
+  if (function_index < 0 || output_shapes_attr == nullptr) return;
+  const FunctionDef& function = library.function(function_index);
+  const auto& output_shapes = output_shapes_attr->list();
+  std::vector<int64_t> ragged_components;
+  DataType splits_type = DT_INVALID;
+  for (int i = 0; i < function.signature().output_arg_size(); ++i) {
+    // The batch of a `RaggedTensorSpec` component has an unknown shape, which
+    // is compatible with a scalar.
+    if (i >= output_shapes.shape_size() ||
+        !output_shapes.shape(i).unknown_rank()) {
+      continue;
+    }
+    auto ret = function.ret().find(function.signature().output_arg(i).name());
+    if (ret == function.ret().end()) continue;
+    const NodeDef* node = GetProducingNode(function, ret->second);
+    if (node == nullptr || node->op() != kRaggedTensorToVariant) continue;
+    const AttrValue* batched_input =
+        gtl::FindOrNull(node->attr(), "batched_input");
+    const AttrValue* ragged_rank = gtl::FindOrNull(node->attr(), "RAGGED_RANK");
+    if (batched_input == nullptr || batched_input->b() ||
+        ragged_rank == nullptr || ragged_rank->i() == 0) {
+      continue;
+    }
+    const AttrValue* tsplits = gtl::FindOrNull(node->attr(), "Tsplits");
+    const DataType component_splits_type =
+        tsplits == nullptr ? DT_INT64 : tsplits->type();
+    if (splits_type == DT_INVALID) splits_type = component_splits_type;
+    if (component_splits_type != splits_type) continue;
+    ragged_components.push_back(i);
+  }
+  if (ragged_components.empty()) return;
+  AttrValue ragged_components_attr;
+  for (int64_t index : ragged_components) {
+    ragged_components_attr.mutable_list()->add_i(index);
+  }
+  (*new_node->mutable_attr())["ragged_components"] = ragged_components_attr;
+  AttrValue splits_type_attr;
+  splits_type_attr.set_type(splits_type);
+  (*new_node->mutable_attr())["Tsplits"] = splits_type_attr;
+}
+
 NodeDef MakeMapAndBatchNode(const NodeDef& map_node, const NodeDef& batch_node,
                             MutableGraphView* graph) {
   NodeDef new_node;
@@ -91,6 +166,8 @@ NodeDef MakeMapAndBatchNode(const NodeDef& map_node, const NodeDef& batch_node,
     graph_utils::CopyAttribute(key, map_node, &new_node);
   }
   graph_utils::CopyShapesAndTypesAttrs(batch_node, &new_node);
+  SetRaggedComponents(map_node, batch_node, graph->graph()->library(),
+                      &new_node);
 
   // Optional attributes.
   // TODO(jsimsa): Support `use_inter_op_parallelism` and `sloppy`.
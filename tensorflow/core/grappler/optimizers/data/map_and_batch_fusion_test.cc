@@ -16,6 +16,8 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/data/map_and_batch_fusion.h"
 
 #include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
@@ -365,6 +367,81 @@ TEST(MapAndBatchFusionTest, FuseParallelMapV2AndBatchNodesIntoOne) {
                                  batch_node->attr().at("output_types")));
 }
 
+TEST(MapAndBatchFusionTest, BatchRaggedComponentsAsRaggedTensors) {
+  GrapplerItem item;
+  MutableGraphView graph(&item.graph);
+  // The function returns a dense tensor, a ragged tensor with ragged rank 1
+  // and a ragged tensor with ragged rank 0.
+  *item.graph.mutable_library()->add_function() = FunctionDefHelper::Create(
+      "ToRagged", {"x: int64", "splits: int32"},
+      {"dense: int64", "ragged: variant", "dense_ragged: variant"}, {},
+      {{{"encoded"},
+        "RaggedTensorToVariant",
+        {"splits", "x"},
+        {{"RAGGED_RANK", 1},
+         {"Tvalues", DT_INT64},
+         {"Tsplits", DT_INT32},
+         {"batched_input", false}}},
+       {{"identity"},
+        "Identity",
+        {"encoded:encoded_ragged:0"},
+        {{"T", DT_VARIANT}}},
+       {{"encoded_dense"},
+        "RaggedTensorToVariant",
+        {"x"},
+        {{"RAGGED_RANK", 0},
+         {"Tvalues", DT_INT64},
+         {"Tsplits", DT_INT64},
+         {"batched_input", false}}}},
+      {{"dense", "x"},
+       {"ragged", "identity:output:0"},
+       {"dense_ragged", "encoded_dense:encoded_ragged:0"}});
+
+  NodeDef *start_node = graph_utils::AddScalarConstNode<int64_t>(0, &graph);
+  NodeDef *stop_node = graph_utils::AddScalarConstNode<int64_t>(10, &graph);
+  NodeDef *step_node = graph_utils::AddScalarConstNode<int64_t>(1, &graph);
+  NodeDef *range_node = graph_utils::AddNode(
+      "", "RangeDataset",
+      {start_node->name(), stop_node->name(), step_node->name()}, {}, &graph);
+  NodeDef *captured_input_node =
+      graph_utils::AddScalarConstNode<int64_t>(1, &graph);
+
+  AttrValue f_attr;
+  f_attr.mutable_func()->set_name("ToRagged");
+  AttrValue args_attr;
+  SetAttrValue(DataTypeVector({DT_INT32}), &args_attr);
+  NodeDef *map_node = graph_utils::AddNode(
+      "", "MapDataset", {range_node->name(), captured_input_node->name()},
+      {{"f", f_attr}, {"Targuments", args_attr}}, &graph);
+
+  NodeDef *batch_size_node =
+      graph_utils::AddScalarConstNode<int64_t>(5, &graph);
+  AttrValue shapes_attr;
+  SetAttrValue(std::vector<PartialTensorShape>({PartialTensorShape({-1}),
+                                                PartialTensorShape(),
+                                                PartialTensorShape()}),
+               &shapes_attr);
+  AttrValue types_attr;
+  SetAttrValue(DataTypeVector({DT_INT64, DT_VARIANT, DT_VARIANT}),
+               &types_attr);
+  graph_utils::AddNode(
+      "", "BatchDataset", {map_node->name(), batch_size_node->name()},
+      {{"output_shapes", shapes_attr}, {"output_types", types_attr}}, &graph);
+
+  MapAndBatchFusion optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  ASSERT_TRUE(graph_utils::ContainsNodeWithOp("MapAndBatchDataset", output));
+  NodeDef map_and_batch_node = output.node(
+      graph_utils::FindGraphNodeWithOp("MapAndBatchDataset", output));
+  const auto &ragged_components =
+      map_and_batch_node.attr().at("ragged_components").list();
+  ASSERT_EQ(ragged_components.i_size(), 1);
+  EXPECT_EQ(ragged_components.i(0), 1);
+  EXPECT_EQ(map_and_batch_node.attr().at("Tsplits").type(), DT_INT32);
+}
+
 TEST(MapAndBatchFusionTest, NoChange) {
   GrapplerItem item;
   MutableGraphView graph(&item.graph);
@@ -0,0 +1,252 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/data/map_vectorization.h"
+
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/mutable_graph_view.h"
+#include "tensorflow/core/grappler/op_types.h"
+#include "tensorflow/core/grappler/optimizers/custom_graph_optimizer_registry.h"
+#include "tensorflow/core/grappler/optimizers/data/function_utils.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/platform/protobuf.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+constexpr char kMapDataset[] = "MapDataset";
+constexpr char kParallelMapDataset[] = "ParallelMapDataset";
+constexpr char kParallelMapDatasetV2[] = "ParallelMapDatasetV2";
+constexpr char kBatchDataset[] = "BatchDataset";
+constexpr char kBatchDatasetV2[] = "BatchDatasetV2";
+
+// Stateless ops that compute each output element from the elements at the same
+// position of their (broadcast) inputs.
+bool IsElementwise(const NodeDef& node) {
+  static const auto* const kElementwiseOps = new absl::flat_hash_set<string>{
+      "Abs", "Add", "AddV2", "Cast", "Ceil", "Cos", "Div", "DivNoNan", "Elu",
+      "Equal", "Exp", "Expm1", "Floor", "FloorDiv", "FloorMod", "Greater",
+      "GreaterEqual", "Identity", "IsFinite", "IsNan", "Less", "LessEqual",
+      "Log", "Log1p", "LogicalAnd", "LogicalNot", "LogicalOr", "Maximum",
+      "Minimum", "Mod", "Mul", "Neg", "NotEqual", "Pow", "RealDiv",
+      "Reciprocal", "Relu", "Relu6", "Round", "Rsqrt", "Selu", "Sigmoid",
+      "Sign", "Sin", "Softplus", "Sqrt", "Square", "SquaredDifference", "Sub",
+      "Tanh", "TruncateDiv"};
+  return kElementwiseOps->contains(node.op());
+}
+
+bool IsScalarConst(const NodeDef& node) {
+  if (!IsConstant(node)) return false;
+  const AttrValue* value = gtl::FindOrNull(node.attr(), "value");
+  return value != nullptr && value->has_tensor() &&
+         value->tensor().tensor_shape().dim_size() == 0 &&
+         !value->tensor().tensor_shape().unknown_rank();
+}
+
+// Returns the rank shared by all the components described by `node`'s
+// "output_shapes" attribute, or -1 if it is unknown or differs between
+// components.
+int CommonComponentRank(const NodeDef& node) {
+  const AttrValue* output_shapes =
+      gtl::FindOrNull(node.attr(), "output_shapes");
+  if (output_shapes == nullptr || output_shapes->list().shape_size() == 0) {
+    return -1;
+  }
+  int rank = -1;
+  for (const TensorShapeProto& shape : output_shapes->list().shape()) {
+    if (shape.unknown_rank()) return -1;
+    if (rank >= 0 && shape.dim_size() != rank) return -1;
+    rank = shape.dim_size();
+  }
+  return rank;
+}
+
+// Returns true if `function` computes the same result when applied to a batch
+// of elements as when applied to each element followed by batching. This is
+// the case if every node is an elementwise op that combines element-derived
+// tensors (which all have the rank of the element components, so that their
+// leading batch dimensions line up) with scalars, and every output is derived
+// from the element.
+bool IsVectorizable(const FunctionDef& function) {
+  absl::flat_hash_set<string> element_derived;
+  for (const OpDef::ArgDef& arg : function.signature().input_arg()) {
+    element_derived.insert(arg.name());
+  }
+  absl::flat_hash_set<string> scalars;
+  // FunctionDefs list their nodes in an arbitrary order, so iterate until all
+  // nodes are classified.
+  absl::flat_hash_set<string> classified;
+  bool changed = true;
+  while (changed && classified.size() < function.node_def_size()) {
+    changed = false;
+    for (const NodeDef& node : function.node_def()) {
+      if (classified.contains(node.name())) continue;
+      if (IsScalarConst(node)) {
+        scalars.insert(node.name());
+        classified.insert(node.name());
+        changed = true;
+        continue;
+      }
+      if (!IsElementwise(node)) return false;
+      bool ready = true;
+      bool has_element_input = false;
+      for (const string& input : node.input()) {
+        if (IsControlInput(input)) return false;
+        const string name = input.substr(0, input.find(':'));
+        if (element_derived.contains(name)) {
+          has_element_input = true;
+        } else if (!scalars.contains(name)) {
+          ready = false;
+        }
+      }
+      if (!ready) continue;
+      if (has_element_input) {
+        element_derived.insert(node.name());
+      } else {
+        scalars.insert(node.name());
+      }
+      classified.insert(node.name());
+      changed = true;
+    }
+  }
+  if (classified.size() < function.node_def_size()) return false;
+  for (const OpDef::ArgDef& output_arg : function.signature().output_arg()) {
+    auto ret = function.ret().find(output_arg.name());
+    if (ret == function.ret().end()) return false;
+    const string name = ret->second.substr(0, ret->second.find(':'));
+    if (!element_derived.contains(name)) return false;
+  }
+  return !function.signature().is_stateful();
+}
+
+bool IsMap(const NodeDef& node) {
+  return node.op() == kMapDataset || node.op() == kParallelMapDataset ||
+         node.op() == kParallelMapDatasetV2;
+}
+
+// Returns a copy of `batch_node` that batches the elements of `map_input`.
+NodeDef MakeBatchNode(const NodeDef& batch_node, const NodeDef& map_node,
+                      const NodeDef& map_input, MutableGraphView* graph) {
+  NodeDef new_batch = batch_node;
+  graph_utils::SetUniqueGraphNodeName(batch_node.op(), graph->graph(),
+                                      &new_batch);
+  new_batch.set_input(0, map_node.input(0));
+
+  // The batch dimension is the same as for the batch of mapped elements.
+  TensorShapeProto::Dim batch_dim;
+  batch_dim.set_size(-1);
+  const auto& batch_shapes = batch_node.attr().at("output_shapes").list();
+  if (batch_shapes.shape_size() > 0 && !batch_shapes.shape(0).unknown_rank() &&
+      batch_shapes.shape(0).dim_size() > 0) {
+    batch_dim = batch_shapes.shape(0).dim(0);
+  }
+  AttrValue output_shapes;
+  for (const TensorShapeProto& shape :
+       map_input.attr().at("output_shapes").list().shape()) {
+    TensorShapeProto* batched_shape = output_shapes.mutable_list()->add_shape();
+    *batched_shape->add_dim() = batch_dim;
+    for (const auto& dim : shape.dim()) *batched_shape->add_dim() = dim;
+  }
+  (*new_batch.mutable_attr())["output_shapes"] = output_shapes;
+  (*new_batch.mutable_attr())["output_types"] =
+      map_input.attr().at("output_types");
+  return new_batch;
+}
+
+// Returns a copy of `map_node` that maps the batches of `new_batch`.
+NodeDef MakeMapNode(const NodeDef& map_node, const NodeDef& batch_node,
+                    const NodeDef& new_batch, MutableGraphView* graph) {
+  NodeDef new_map = map_node;
+  graph_utils::SetUniqueGraphNodeName(map_node.op(), graph->graph(), &new_map);
+  new_map.set_input(0, new_batch.name());
+  graph_utils::CopyShapesAndTypesAttrs(batch_node, &new_map);
+  return new_map;
+}
+
+}  // namespace
+
+Status MapVectorization::OptimizeAndCollectStats(Cluster* cluster,
+                                                 const GrapplerItem& item,
+                                                 GraphDef* output,
+                                                 OptimizationStats* stats) {
+  *output = item.graph;
+  MutableGraphView graph(output);
+  absl::flat_hash_set<string> nodes_to_delete;
+  FunctionLibraryDefinition function_library(OpRegistry::Global(),
+                                             item.graph.library());
+  for (const NodeDef& node : item.graph.node()) {
+    if (node.op() != kBatchDataset && node.op() != kBatchDatasetV2) continue;
+    const NodeDef& batch_node = node;
+    NodeDef* map_node = graph_utils::GetInputNode(batch_node, graph);
+    if (map_node == nullptr || !IsMap(*map_node) ||
+        nodes_to_delete.contains(map_node->name())) {
+      continue;
+    }
+    // The map must only feed the batch, and must not capture any inputs,
+    // whose shapes are unknown.
+    if (graph.GetFanouts(*map_node, /*include_controlled_nodes=*/true).size() !=
+            1 ||
+        item.NodesToPreserve().count(map_node->name()) > 0) {
+      continue;
+    }
+    const AttrValue* targuments =
+        gtl::FindOrNull(map_node->attr(), "Targuments");
+    if (targuments == nullptr || targuments->list().type_size() > 0) continue;
+    NodeDef* map_input = graph_utils::GetInputNode(*map_node, graph);
+    if (map_input == nullptr || CommonComponentRank(*map_input) < 0 ||
+        !gtl::FindOrNull(map_input->attr(), "output_types") ||
+        !gtl::FindOrNull(batch_node.attr(), "output_shapes")) {
+      continue;
+    }
+    const FunctionDef* function =
+        function_library.Find(map_node->attr().at("f").func().name());
+    if (function == nullptr ||
+        function->signature().input_arg_size() !=
+            map_input->attr().at("output_shapes").list().shape_size() ||
+        function_utils::IsFunctionStateful(function_library, *function) ||
+        !IsVectorizable(*function)) {
+      VLOG(2) << "Not vectorizing the function of " << map_node->name();
+      continue;
+    }
+
+    NodeDef* new_batch = graph.AddNode(
+        MakeBatchNode(batch_node, *map_node, *map_input, &graph));
+    NodeDef* new_map = graph.AddNode(
+        MakeMapNode(*map_node, batch_node, *new_batch, &graph));
+    TF_RETURN_IF_ERROR(graph.UpdateFanouts(batch_node.name(), new_map->name()));
+    nodes_to_delete.insert(map_node->name());
+    nodes_to_delete.insert(batch_node.name());
+    stats->num_changes++;
+  }
+
+  TF_RETURN_IF_ERROR(graph.DeleteNodes(nodes_to_delete));
+  return OkStatus();
+}
+
+REGISTER_GRAPH_OPTIMIZER_AS(MapVectorization, "map_vectorization");
+
+}  // namespace grappler
+}  // namespace tensorflow
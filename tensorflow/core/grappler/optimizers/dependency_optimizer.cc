@@ -494,8 +494,13 @@ Status DependencyOptimizer::OptimizeDependencies() {
   if (fetch_nodes_known_) {
     VLOG(1) << "Deleted " << nodes_to_delete.size() << " out of "
             << optimized_graph_->node_size() << " nodes.";
+    // The deleted nodes were already disconnected from the rest of the graph
+    // in the node map, and erasing nodes leaves the remaining NodeDefs in
+    // place, so the node map is kept up to date instead of being rebuilt.
+    for (int node_idx : nodes_to_delete) {
+      node_map_->RemoveNode(optimized_graph_->node(node_idx).name());
+    }
     EraseNodesFromGraph(nodes_to_delete, optimized_graph_);
-    node_map_.reset(new NodeMap(optimized_graph_));
     BuildNodeToIdx();
   }
   return OkStatus();
@@ -730,7 +735,7 @@ void DependencyOptimizer::GroupCrossDeviceControlEdges(bool host_granularity) {
             node->mutable_input()->SwapElements(pos, node->input_size() - 1);
             node->mutable_input()->RemoveLast();
             it->second->add_input(AsControlDependency(*input));
-            node_map_->UpdateOutput(input_name, node->name(),
+            node_map_->UpdateOutput(input->name(), node->name(),
                                     it->second->name());
           }
         }
@@ -762,7 +767,11 @@ Status DependencyOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
     // Perform topological sort to prepare the graph for transitive reduction.
     topo_sort_status = TopologicalSort(optimized_graph_);
     // Set up index-based graph datastructures to speed up analysis steps below.
-    node_map_.reset(new NodeMap(optimized_graph_));
+    // The node map is maintained incrementally by all the steps below, and
+    // sorting only permutes the NodeDef pointers, so it is built only once.
+    if (iteration == 0) {
+      node_map_.reset(new NodeMap(optimized_graph_));
+    }
     BuildNodeToIdx();
 
     if (topo_sort_status.ok()) {
@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/dependency_optimizer.h"
 
 #include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/framework/full_type.pb.h"
 #include "tensorflow/core/framework/node_def.pb.h"
@@ -29,7 +30,9 @@ limitations under the License.
 #include "tensorflow/core/grappler/utils/grappler_test.h"
 #include "tensorflow/core/grappler/utils/topological_sort.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
 
 namespace tensorflow {
 namespace grappler {
@@ -1025,6 +1028,54 @@ TEST_F(DependencyOptimizerTest, GroupCrossHostControlDeps) {
   EXPECT_EQ(tasks.size(), 4);
 }
 
+// Builds a graph of `size` nodes in which runs of Identity nodes hang off
+// constants and are chained together by NoOps, with random control edges
+// between them, so that every optimizer stage has work to do.
+GraphDef CreateLargeControlFlowGraph(int size) {
+  random::PhiloxRandom philox(0x12345);
+  random::SimplePhilox rnd(&philox);
+  GraphDef graph;
+  string last_data_node;
+  std::vector<string> names;
+  names.reserve(size);
+  for (int i = 0; i < size; ++i) {
+    NodeDef* node = graph.add_node();
+    node->set_name(absl::StrCat("node_", i));
+    if (i % 8 == 0) {
+      node->set_op("Const");
+      (*node->mutable_attr())["dtype"].set_type(DT_FLOAT);
+      last_data_node = node->name();
+    } else if (i % 4 == 0) {
+      node->set_op("NoOp");
+      for (int j = 0; j < 2; ++j) {
+        node->add_input(AsControlDependency(names[rnd.Uniform(i)]));
+      }
+    } else {
+      node->set_op("Identity");
+      node->add_input(last_data_node);
+      node->add_input(AsControlDependency(names[rnd.Uniform(i)]));
+      (*node->mutable_attr())["T"].set_type(DT_FLOAT);
+      last_data_node = node->name();
+    }
+    names.push_back(node->name());
+  }
+  return graph;
+}
+
+void BM_DependencyOptimizer(::testing::benchmark::State& state) {
+  const int size = state.range(0);
+
+  GrapplerItem item;
+  item.graph = CreateLargeControlFlowGraph(size);
+  item.fetch = {item.graph.node(size - 1).name()};
+  for (auto s : state) {
+    DependencyOptimizer optimizer;
+    GraphDef output;
+    TF_CHECK_OK(optimizer.Optimize(nullptr, item, &output));
+  }
+}
+BENCHMARK(BM_DependencyOptimizer)->Range(1 << 6, 1 << 20);
+
 }  // namespace
 }  // namespace grappler
 }  // namespace tensorflow
@@ -30,6 +30,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/generic_layout_optimizer_transposer_factory.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/platform/tensor_float_32_utils.h"
+#include "tensorflow/core/util/util.h"
 
 namespace tensorflow {
 namespace grappler {
@@ -457,7 +458,8 @@ Status EraseOutputShapeAttrs(TransposeContext* context) {
 // When there is a GPU, the computation graph is converted to NCHW format.
 // When there is only CPU, there will be no conversion by default, unless user
 // chose to convert the graph to a desired format. Currently, NCHW -> NHWC
-// format conversion is available on CPU.
+// format conversion is available on CPU, and NHWC -> NCHW format conversion is
+// available on CPU when oneDNN is enabled.
 Status GenericLayoutOptimizer::Optimize(Cluster* cluster,
                                         const GrapplerItem& item,
                                         GraphDef* output) {
@@ -494,12 +496,19 @@ Status GenericLayoutOptimizer::Optimize(Cluster* cluster,
       case RewriterConfig::NCHW_TO_NHWC:
         context.AssignDeviceAndDataFormats(kCPU, kNCHW, kNHWC);
         break;
-      // TODO(intel-tf): Add functionality for NHWC_TO_NCHW layout conversion on
-      // CPU.
+      // oneDNN kernels compute in channel-blocked layouts (e.g. nChw8c or
+      // nChw16c) derived from NCHW. Converting whole chains of layout sensitive
+      // ops to NCHW keeps the layout conversions at the chain boundaries
+      // instead of around every op. Ops without a oneDNN NCHW kernel are left
+      // in NHWC by the transposers.
       case RewriterConfig::NHWC_TO_NCHW:
-        return errors::Aborted(
-            "Conversion from NHWC to NCHW is currently not  available for "
-            "CPU.");
+        if (!IsMKLEnabled()) {
+          return errors::Aborted(
+              "Conversion from NHWC to NCHW is only available for CPU when "
+              "oneDNN is enabled.");
+        }
+        context.AssignDeviceAndDataFormats(kCPU, kNHWC, kNCHW);
+        break;
       default:
         *output = item.graph;
         VLOG(2) << "No layout conversion will take place for CPU.";
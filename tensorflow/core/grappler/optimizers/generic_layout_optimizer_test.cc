@@ -34,6 +34,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/tensor_float_32_utils.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/util/util.h"
 
 namespace tensorflow {
 namespace grappler {
@@ -345,6 +346,58 @@ TEST_F(GenericLayoutOptimizerTest, CPUDevice) {
 #endif  // (GOOGLE_CUDA || TENSORFLOW_USE_ROCM)
 }
 
+TEST_F(GenericLayoutOptimizerTest, CPUDeviceNhwcToNchw) {
+#if (GOOGLE_CUDA || TENSORFLOW_USE_ROCM)
+  GTEST_SKIP() << "CPU layout conversion is not applied when GPUs are present";
+#endif  // (GOOGLE_CUDA || TENSORFLOW_USE_ROCM)
+  // Conv2D -> Relu -> MaxPool should run in NCHW with transposes only at the
+  // boundaries of the chain. SpaceToDepth has no NCHW CPU kernel and stays in
+  // NHWC.
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope().WithDevice("/CPU:0");
+  auto input = ops::Placeholder(s.WithOpName("Input"), DT_FLOAT,
+                                ops::Placeholder::Shape({8, 4, 4, 3}));
+  Tensor filter_data(DT_FLOAT, TensorShape({2, 2, 3, 2}));
+  test::FillIota<float>(&filter_data, 1.0f);
+  auto filter =
+      ops::Const(s.WithOpName("Filter"), Input::Initializer(filter_data));
+  auto conv = ops::Conv2D(s.WithOpName("Conv2D"), input, filter, {1, 1, 1, 1},
+                          "SAME");
+  auto relu = ops::Relu(s.WithOpName("Relu"), conv);
+  auto pool = ops::MaxPool(s.WithOpName("MaxPool"), relu, {1, 2, 2, 1},
+                           {1, 2, 2, 1}, "VALID");
+  auto space_to_depth =
+      ops::SpaceToDepth(s.WithOpName("SpaceToDepth"), pool, 2);
+  Output fetch = ops::Identity(s.WithOpName("Fetch"), {space_to_depth});
+  GrapplerItem item;
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  GenericLayoutOptimizer optimizer(RewriterConfig::DEFAULT,
+                                   RewriterConfig::NHWC_TO_NCHW);
+  GraphDef output;
+  Status status = optimizer.Optimize(virtual_cluster_.get(), item, &output);
+  if (!IsMKLEnabled()) {
+    EXPECT_EQ(status.code(), absl::StatusCode::kAborted);
+    return;
+  }
+  TF_ASSERT_OK(status);
+
+  utils::GraphView graph_view(&output, &status);
+  TF_ASSERT_OK(status);
+  auto* conv_node = graph_view.GetNode("Conv2D");
+  ASSERT_NE(conv_node, nullptr);
+  VerifyDataFormatAttributeMatch(conv_node, "NCHW");
+  auto* relu_node = graph_view.GetNode("Relu");
+  ASSERT_NE(relu_node, nullptr);
+  VerifyRegularFaninMatch(relu_node, 0, "Conv2D", 0);
+  auto* pool_node = graph_view.GetNode("MaxPool");
+  ASSERT_NE(pool_node, nullptr);
+  VerifyDataFormatAttributeMatch(pool_node, "NCHW");
+  VerifyRegularFaninMatch(pool_node, 0, "Relu", 0);
+  auto* space_to_depth_node = graph_view.GetNode("SpaceToDepth");
+  ASSERT_NE(space_to_depth_node, nullptr);
+  VerifyDataFormatAttributeMatch(space_to_depth_node, "NHWC");
+}
+
 TEST_F(GenericLayoutOptimizerTest, NoOptimizeIntegerConvolution) {
   tensorflow::Scope s = tensorflow::Scope::NewRootScope();
   auto conv = SimpleConv2D<int32>(&s, 4, 2, "VALID", "");
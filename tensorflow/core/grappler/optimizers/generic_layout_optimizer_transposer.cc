@@ -97,6 +97,31 @@ bool IsNonFloatingConv2D(const utils::MutableNodeView& node) {
   return false;
 }
 
+// Layout sensitive ops that have channels-first oneDNN kernels on CPU.
+bool HasChannelsFirstCpuKernel(const NodeDef& node) {
+  static const absl::flat_hash_set<string>* channels_first_cpu_ops =
+      new absl::flat_hash_set<std::string>(
+          {"AvgPool", "AvgPoolGrad", "BiasAdd", "BiasAddGrad", "Conv2D",
+           "Conv2DBackpropFilter", "Conv2DBackpropInput", "Conv3D",
+           "Conv3DBackpropFilterV2", "Conv3DBackpropInputV2",
+           "DepthwiseConv2dNative", "FusedBatchNorm", "FusedBatchNormV2",
+           "FusedBatchNormV3", "FusedBatchNormGrad", "FusedBatchNormGradV2",
+           "FusedBatchNormGradV3", "MaxPool", "MaxPoolGrad"});
+  return channels_first_cpu_ops->contains(node.op());
+}
+
+// Returns false for layout sensitive ops that cannot run in the destination
+// format on the target device, e.g. SpaceToDepth in NCHW on CPU.
+bool IsDstFormatSupported(const TransposeContext& context,
+                          const NodeDef& node) {
+  if (context.target_device != kCPU || !IsLayoutSensitiveOp(node)) {
+    return true;
+  }
+  const bool is_dst_channels_first =
+      context.dst_format == "NCHW" || context.dst_format == "NCDHW";
+  return !is_dst_channels_first || HasChannelsFirstCpuKernel(node);
+}
+
 // Utils for layout agnostic transposer.
 
 bool IsComparisonOp(const NodeDef& node) {
@@ -283,6 +308,7 @@ bool Transposer::ShouldProcess(const TransposeContext& context,
   const bool is_integer_conv2d = IsNonFloatingConv2D(node);
 
   return is_on_target_device && data_format_match && !is_integer_conv2d &&
+         IsDstFormatSupported(context, *node_def) &&
          !context.nodes_to_preserve.contains(node_def->name()) &&
          !(node.NumRegularFanouts() == 0 && node.NumControlledFanouts() == 0);
 }
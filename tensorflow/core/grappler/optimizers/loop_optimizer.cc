@@ -22,13 +22,18 @@ limitations under the License.
 #include <unordered_set>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_split.h"
 #include "absl/strings/string_view.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/attr_value.pb.h"
 #include "tensorflow/core/framework/full_type.pb.h"
+#include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/types.h"
@@ -38,7 +43,9 @@ limitations under the License.
 #include "tensorflow/core/grappler/op_types.h"
 #include "tensorflow/core/grappler/optimizers/constant_folding.h"
 #include "tensorflow/core/grappler/optimizers/evaluation_utils.h"
+#include "tensorflow/core/grappler/utils.h"
 #include "tensorflow/core/grappler/utils/frame.h"
+#include "tensorflow/core/grappler/utils/functions.h"
 #include "tensorflow/core/grappler/utils/traversal.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
@@ -715,6 +722,398 @@ Status CheckForDeadFanout(const MutableGraphView& view,
   return OkStatus();
 }
 
+// Hoists loop-invariant computations out of the body functions of functional
+// While loops. A body node is invariant if it is stateless and all its inputs
+// are loop variables that the body passes through unchanged, or other
+// invariant nodes. The invariant subgraph is copied into the graph of the
+// While node, and the tensors that the rest of the body reads from it become
+// additional loop variables, which the new body passes through unchanged.
+class FunctionalLoopInvariantNodeMotionOptimizer {
+ public:
+  FunctionalLoopInvariantNodeMotionOptimizer(
+      const std::unordered_set<string>& nodes_to_preserve,
+      GraphDef* optimized_graph)
+      : nodes_to_preserve_(nodes_to_preserve),
+        optimized_graph_(optimized_graph),
+        flib_(OpRegistry::Global(), optimized_graph->library()) {}
+
+  Status Optimize();
+
+ private:
+  // A tensor produced in the loop body that is moved out of the loop.
+  struct HoistedTensor {
+    string body_tensor;   // In FunctionDef format ("node:output:index").
+    string outer_tensor;  // In GraphDef format.
+    DataType dtype;
+  };
+
+  Status OptimizeWhile(int while_idx, const FunctionDef& body,
+                       const FunctionDef& cond);
+  void FindInvariantNodes(const FunctionDef& body,
+                          absl::flat_hash_set<string>* invariant_nodes);
+  Status OuterTensor(const string& body_tensor, const NodeDef& while_node,
+                     const string& outer_prefix, string* outer_tensor) const;
+  string UniqueFunctionName(const string& prefix) const;
+
+  const std::unordered_set<string>& nodes_to_preserve_;
+  GraphDef* optimized_graph_;  // Not owned.
+  FunctionLibraryDefinition flib_;
+  std::unique_ptr<NodeMap> node_map_;
+  // Body argument name -> loop variable index, for the invariant arguments.
+  absl::flat_hash_map<string, int> invariant_args_;
+  // Body node name -> body node.
+  absl::flat_hash_map<string, const NodeDef*> body_nodes_;
+};
+
+bool HasFunctionAttr(const NodeDef& node) {
+  for (const auto& attr : node.attr()) {
+    if (attr.second.has_func() || attr.second.list().func_size() > 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+string BodyNodeName(const string& body_input) {
+  const string name =
+      IsControlInput(body_input) ? body_input.substr(1) : body_input;
+  return name.substr(0, name.find(':'));
+}
+
+void FunctionalLoopInvariantNodeMotionOptimizer::FindInvariantNodes(
+    const FunctionDef& body, absl::flat_hash_set<string>* invariant_nodes) {
+  invariant_args_.clear();
+  body_nodes_.clear();
+  for (const NodeDef& node : body.node_def()) {
+    body_nodes_[node.name()] = &node;
+  }
+
+  // A loop variable is invariant if the body returns its argument, possibly
+  // through a chain of Identity nodes.
+  for (int i = 0; i < body.signature().output_arg_size(); ++i) {
+    auto ret = body.ret().find(body.signature().output_arg(i).name());
+    if (ret == body.ret().end()) continue;
+    string tensor = ret->second;
+    auto it = body_nodes_.find(BodyNodeName(tensor));
+    while (it != body_nodes_.end() && IsIdentity(*it->second) &&
+           it->second->input_size() == 1) {
+      tensor = it->second->input(0);
+      it = body_nodes_.find(BodyNodeName(tensor));
+    }
+    if (tensor == body.signature().input_arg(i).name()) {
+      invariant_args_[tensor] = i;
+    }
+  }
+
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (const NodeDef& node : body.node_def()) {
+      if (invariant_nodes->contains(node.name())) continue;
+      const OpDef* op_def = nullptr;
+      // Function calls are not moved, and neither are stateful ops.
+      if (flib_.Find(node.op()) != nullptr ||
+          !OpRegistry::Global()->LookUpOpDef(node.op(), &op_def).ok() ||
+          op_def->is_stateful() || HasFunctionAttr(node)) {
+        continue;
+      }
+      bool is_invariant = true;
+      for (const string& input : node.input()) {
+        const string name = BodyNodeName(input);
+        if (!invariant_args_.contains(name) &&
+            !invariant_nodes->contains(name)) {
+          is_invariant = false;
+          break;
+        }
+      }
+      if (is_invariant) {
+        invariant_nodes->insert(node.name());
+        changed = true;
+      }
+    }
+  }
+}
+
+Status FunctionalLoopInvariantNodeMotionOptimizer::OuterTensor(
+    const string& body_tensor, const NodeDef& while_node,
+    const string& outer_prefix, string* outer_tensor) const {
+  const bool is_control = IsControlInput(body_tensor);
+  const string name = BodyNodeName(body_tensor);
+  auto arg = invariant_args_.find(name);
+  if (arg != invariant_args_.end()) {
+    const string& while_input = while_node.input(arg->second);
+    *outer_tensor =
+        is_control ? AsControlDependency(NodeName(while_input)) : while_input;
+    return OkStatus();
+  }
+  const string outer_name = AddPrefixToNodeName(name, outer_prefix);
+  if (is_control) {
+    *outer_tensor = AsControlDependency(outer_name);
+    return OkStatus();
+  }
+  // Converts "node:output:index" to the position of that output.
+  const std::vector<string> parts = absl::StrSplit(body_tensor, ':');
+  const NodeDef& node = *body_nodes_.at(name);
+  if (parts.size() != 3) {
+    return errors::InvalidArgument("Unexpected body tensor ", body_tensor);
+  }
+  const OpDef* op_def = nullptr;
+  TF_RETURN_IF_ERROR(OpRegistry::Global()->LookUpOpDef(node.op(), &op_def));
+  NameRangeMap outputs;
+  TF_RETURN_IF_ERROR(NameRangesForNode(node, *op_def, nullptr, &outputs));
+  auto range = outputs.find(parts[1]);
+  int index;
+  if (range == outputs.end() || !absl::SimpleAtoi(parts[2], &index)) {
+    return errors::InvalidArgument("Unexpected body tensor ", body_tensor);
+  }
+  const int port = range->second.first + index;
+  *outer_tensor = port == 0 ? outer_name : StrCat(outer_name, ":", port);
+  return OkStatus();
+}
+
+string FunctionalLoopInvariantNodeMotionOptimizer::UniqueFunctionName(
+    const string& prefix) const {
+  string name = prefix;
+  for (int i = 1; flib_.Find(name) != nullptr; ++i) {
+    name = StrCat(prefix, "_", i);
+  }
+  return name;
+}
+
+Status FunctionalLoopInvariantNodeMotionOptimizer::OptimizeWhile(
+    int while_idx, const FunctionDef& body, const FunctionDef& cond) {
+  const NodeDef& while_node = optimized_graph_->node(while_idx);
+  const int num_loop_vars = while_node.attr().at("T").list().type_size();
+  if (body.signature().input_arg_size() != num_loop_vars ||
+      body.signature().output_arg_size() != num_loop_vars ||
+      cond.signature().input_arg_size() != num_loop_vars ||
+      NumNonControlInputs(while_node) != num_loop_vars) {
+    return OkStatus();
+  }
+
+  absl::flat_hash_set<string> invariant_nodes;
+  FindInvariantNodes(body, &invariant_nodes);
+  if (invariant_nodes.empty()) return OkStatus();
+
+  // The tensors that loop variant nodes and outputs read from invariant nodes.
+  // Constants are cheap enough to be left in the body.
+  std::vector<string> body_tensors;
+  absl::flat_hash_set<string> seen_body_tensors;
+  auto maybe_hoist = [&](const string& tensor) {
+    if (IsControlInput(tensor)) return;
+    const string name = BodyNodeName(tensor);
+    if (!invariant_nodes.contains(name) || IsConstant(*body_nodes_.at(name))) {
+      return;
+    }
+    if (seen_body_tensors.insert(tensor).second) body_tensors.push_back(tensor);
+  };
+  for (const NodeDef& node : body.node_def()) {
+    if (invariant_nodes.contains(node.name())) continue;
+    for (const string& input : node.input()) maybe_hoist(input);
+  }
+  for (const OpDef::ArgDef& output_arg : body.signature().output_arg()) {
+    auto ret = body.ret().find(output_arg.name());
+    if (ret != body.ret().end()) maybe_hoist(ret->second);
+  }
+  if (body_tensors.empty()) return OkStatus();
+
+  // Copy the invariant subgraphs feeding the hoisted tensors out of the loop.
+  const string outer_prefix = StrCat(while_node.name(), "/", kLoopOptimizer);
+  absl::flat_hash_set<string> nodes_to_copy;
+  std::vector<string> to_visit;
+  for (const string& tensor : body_tensors) {
+    to_visit.push_back(BodyNodeName(tensor));
+  }
+  while (!to_visit.empty()) {
+    const string name = to_visit.back();
+    to_visit.pop_back();
+    if (invariant_args_.contains(name) || !nodes_to_copy.insert(name).second) {
+      continue;
+    }
+    if (node_map_->NodeExists(AddPrefixToNodeName(name, outer_prefix))) {
+      return OkStatus();
+    }
+    for (const string& input : body_nodes_.at(name)->input()) {
+      to_visit.push_back(BodyNodeName(input));
+    }
+  }
+  std::vector<NodeDef> outer_nodes;
+  for (const NodeDef& node : body.node_def()) {
+    if (!nodes_to_copy.contains(node.name())) continue;
+    NodeDef outer_node = node;
+    outer_node.set_name(AddPrefixToNodeName(node.name(), outer_prefix));
+    if (outer_node.device().empty()) {
+      outer_node.set_device(while_node.device());
+    }
+    for (int i = 0; i < node.input_size(); ++i) {
+      TF_RETURN_IF_ERROR(OuterTensor(node.input(i), while_node, outer_prefix,
+                                     outer_node.mutable_input(i)));
+    }
+    outer_nodes.push_back(std::move(outer_node));
+  }
+  std::vector<HoistedTensor> hoisted;
+  for (const string& tensor : body_tensors) {
+    HoistedTensor hoisted_tensor;
+    hoisted_tensor.body_tensor = tensor;
+    TF_RETURN_IF_ERROR(OuterTensor(tensor, while_node, outer_prefix,
+                                   &hoisted_tensor.outer_tensor));
+    const NodeDef& producer = *body_nodes_.at(BodyNodeName(tensor));
+    const OpDef* op_def = nullptr;
+    TF_RETURN_IF_ERROR(
+        OpRegistry::Global()->LookUpOpDef(producer.op(), &op_def));
+    TF_RETURN_IF_ERROR(OutputTypeForNode(
+        producer, *op_def, ParseTensorName(hoisted_tensor.outer_tensor).index(),
+        &hoisted_tensor.dtype));
+    hoisted.push_back(std::move(hoisted_tensor));
+  }
+
+  // Build the new body, in which the hoisted tensors are loop variables.
+  FunctionDef new_body = body;
+  new_body.mutable_signature()->set_name(
+      UniqueFunctionName(StrCat(body.signature().name(), "_hoisted")));
+  absl::flat_hash_set<string> body_names;
+  for (const OpDef::ArgDef& arg : body.signature().input_arg()) {
+    body_names.insert(arg.name());
+  }
+  for (const OpDef::ArgDef& arg : body.signature().output_arg()) {
+    body_names.insert(arg.name());
+  }
+  for (const NodeDef& node : body.node_def()) body_names.insert(node.name());
+  absl::flat_hash_map<string, string> replacements;
+  for (int i = 0; i < hoisted.size(); ++i) {
+    string arg_name = StrCat("loop_invariant_", i);
+    while (body_names.contains(arg_name)) arg_name += "_";
+    body_names.insert(arg_name);
+    string ret_name = StrCat(arg_name, "_ret");
+    while (body_names.contains(ret_name)) ret_name += "_";
+    body_names.insert(ret_name);
+
+    OpDef::ArgDef* input_arg = new_body.mutable_signature()->add_input_arg();
+    input_arg->set_name(arg_name);
+    input_arg->set_type(hoisted[i].dtype);
+    OpDef::ArgDef* output_arg = new_body.mutable_signature()->add_output_arg();
+    output_arg->set_name(ret_name);
+    output_arg->set_type(hoisted[i].dtype);
+    (*new_body.mutable_ret())[ret_name] = arg_name;
+    replacements[hoisted[i].body_tensor] = arg_name;
+  }
+  for (NodeDef& node : *new_body.mutable_node_def()) {
+    for (string& input : *node.mutable_input()) {
+      auto it = replacements.find(input);
+      if (it != replacements.end()) input = it->second;
+    }
+  }
+  for (auto& ret : *new_body.mutable_ret()) {
+    auto it = replacements.find(ret.second);
+    if (it != replacements.end()) ret.second = it->second;
+  }
+  // Drop the invariant nodes that the body no longer uses.
+  bool removed = true;
+  while (removed) {
+    removed = false;
+    absl::flat_hash_set<string> used;
+    for (const NodeDef& node : new_body.node_def()) {
+      for (const string& input : node.input()) used.insert(BodyNodeName(input));
+    }
+    for (const auto& ret : new_body.ret()) {
+      used.insert(BodyNodeName(ret.second));
+    }
+    for (const auto& ret : new_body.control_ret()) used.insert(ret.second);
+    auto* nodes = new_body.mutable_node_def();
+    for (int i = nodes->size() - 1; i >= 0; --i) {
+      if (invariant_nodes.contains(nodes->Get(i).name()) &&
+          !used.contains(nodes->Get(i).name())) {
+        nodes->DeleteSubrange(i, 1);
+        removed = true;
+      }
+    }
+  }
+
+  // The condition takes the new loop variables but does not use them.
+  FunctionDef new_cond = cond;
+  new_cond.mutable_signature()->set_name(
+      UniqueFunctionName(StrCat(cond.signature().name(), "_hoisted")));
+  absl::flat_hash_set<string> cond_names;
+  for (const OpDef::ArgDef& arg : cond.signature().input_arg()) {
+    cond_names.insert(arg.name());
+  }
+  for (const NodeDef& node : cond.node_def()) cond_names.insert(node.name());
+  for (int i = 0; i < hoisted.size(); ++i) {
+    string arg_name = StrCat("loop_invariant_", i);
+    while (cond_names.contains(arg_name)) arg_name += "_";
+    cond_names.insert(arg_name);
+    OpDef::ArgDef* input_arg = new_cond.mutable_signature()->add_input_arg();
+    input_arg->set_name(arg_name);
+    input_arg->set_type(hoisted[i].dtype);
+  }
+
+  // Commit: add the functions and the hoisted nodes, and feed the hoisted
+  // tensors to the While node.
+  VLOG(1) << "Hoisting " << nodes_to_copy.size()
+          << " loop invariant nodes out of " << while_node.name();
+  TF_RETURN_IF_ERROR(flib_.AddFunctionDef(new_body));
+  TF_RETURN_IF_ERROR(flib_.AddFunctionDef(new_cond));
+  *optimized_graph_->mutable_library()->add_function() = new_body;
+  *optimized_graph_->mutable_library()->add_function() = new_cond;
+  for (NodeDef& outer_node : outer_nodes) {
+    NodeDef* added = optimized_graph_->add_node();
+    *added = std::move(outer_node);
+    node_map_->AddNode(added->name(), added);
+  }
+
+  NodeDef* while_node_mutable = optimized_graph_->mutable_node(while_idx);
+  std::vector<string> control_inputs;
+  while (while_node_mutable->input_size() > num_loop_vars) {
+    control_inputs.push_back(while_node_mutable->input(num_loop_vars));
+    while_node_mutable->mutable_input()->DeleteSubrange(num_loop_vars, 1);
+  }
+  auto* attr = while_node_mutable->mutable_attr();
+  for (const HoistedTensor& hoisted_tensor : hoisted) {
+    while_node_mutable->add_input(hoisted_tensor.outer_tensor);
+    (*attr)["T"].mutable_list()->add_type(hoisted_tensor.dtype);
+    for (const char* shapes_attr : {"output_shapes", "_output_shapes"}) {
+      auto it = attr->find(shapes_attr);
+      if (it != attr->end() && it->second.list().shape_size() > 0) {
+        it->second.mutable_list()->add_shape()->set_unknown_rank(true);
+      }
+    }
+  }
+  for (const string& control_input : control_inputs) {
+    while_node_mutable->add_input(control_input);
+  }
+  (*attr)["body"].mutable_func()->set_name(new_body.signature().name());
+  (*attr)["cond"].mutable_func()->set_name(new_cond.signature().name());
+  return OkStatus();
+}
+
+Status FunctionalLoopInvariantNodeMotionOptimizer::Optimize() {
+  node_map_.reset(new NodeMap(optimized_graph_));
+  FrameView frame_view;
+  TF_RETURN_IF_ERROR(frame_view.InferFromGraph(*optimized_graph_));
+
+  const int num_nodes = optimized_graph_->node_size();
+  for (int i = 0; i < num_nodes; ++i) {
+    const NodeDef& node = optimized_graph_->node(i);
+    // Hoisted nodes without inputs would leave the frame of a While node
+    // nested in a v1 loop, so only top-level loops are handled.
+    if (!IsWhile(node) || nodes_to_preserve_.count(node.name()) ||
+        !frame_view.Frames(node).empty()) {
+      continue;
+    }
+    const FunctionDef* body = flib_.Find(node.attr().at("body").func().name());
+    const FunctionDef* cond = flib_.Find(node.attr().at("cond").func().name());
+    if (body == nullptr || cond == nullptr || IsParametrized(*body) ||
+        IsParametrized(*cond)) {
+      continue;
+    }
+    // Copies, since OptimizeWhile adds functions to the library.
+    const FunctionDef body_copy = *body;
+    const FunctionDef cond_copy = *cond;
+    TF_RETURN_IF_ERROR(OptimizeWhile(i, body_copy, cond_copy));
+  }
+  return OkStatus();
+}
+
 }  // namespace
 
 LoopOptimizer::LoopOptimizer()
@@ -726,13 +1125,14 @@ LoopOptimizer::LoopOptimizer(RewriterConfig::Toggle opt_level,
                              DeviceBase* cpu_device)
     : opt_level_(opt_level),
       cpu_device_(cpu_device),
-      options_(LoopOptimizerOptions::Default(RewriterConfig::ON)) {
+      options_(LoopOptimizerOptions::Default(opt_level)) {
   resource_mgr_.reset(new ResourceMgr());
 }
 
 Status LoopOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
                                GraphDef* optimized_graph) {
   if (!options_.enable_loop_invariant_node_motion &&
+      !options_.enable_functional_loop_invariant_node_motion &&
       !options_.enable_stack_push_removal &&
       !options_.enable_dead_branch_removal) {
     return errors::Aborted("Nothing to do.");
@@ -743,6 +1143,11 @@ Status LoopOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
     LoopInvariantNodeMotionOptimizer linm_optimizer(optimized_graph);
     TF_RETURN_IF_ERROR(linm_optimizer.Optimize());
   }
+  if (options_.enable_functional_loop_invariant_node_motion) {
+    FunctionalLoopInvariantNodeMotionOptimizer flinm_optimizer(
+        item.NodesToPreserve(), optimized_graph);
+    TF_RETURN_IF_ERROR(flinm_optimizer.Optimize());
+  }
   if (options_.enable_stack_push_removal) {
     TF_RETURN_IF_ERROR(RemoveStackOps(item.NodesToPreserve(), optimized_graph));
   }
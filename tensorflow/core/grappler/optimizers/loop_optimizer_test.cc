@@ -17,6 +17,7 @@ limitations under the License.
 
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/framework/full_type.pb.h"
+#include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/grappler/grappler_item.h"
@@ -71,10 +72,17 @@ class LoopOptimizerTest : public GrapplerTest {
     optimizer->options_.enable_stack_push_removal = true;
   }
 
+  void EnableOnlyFunctionalLoopInvariantNodeMotion(LoopOptimizer* optimizer) {
+    DisableAllStages(optimizer);
+    optimizer->options_.enable_dead_branch_removal = false;
+    optimizer->options_.enable_functional_loop_invariant_node_motion = true;
+  }
+
  private:
   void DisableAllStages(LoopOptimizer* optimizer) {
     LoopOptimizer::LoopOptimizerOptions options;
     options.enable_loop_invariant_node_motion = false;
+    options.enable_functional_loop_invariant_node_motion = false;
     options.enable_stack_push_removal = false;
     optimizer->options_ = options;
   }
@@ -644,6 +652,74 @@ TEST_F(LoopOptimizerTest, NoOp) {
   VerifyGraphsEqual(item.graph, output, __FUNCTION__);
 }
 
+TEST_F(LoopOptimizerTest, FunctionalWhileInvariantNodeMotion) {
+  using FDH = FunctionDefHelper;
+  // x is updated by the loop and y is passed through unchanged, so Square(y)
+  // is loop invariant while Add(x, Square(y)) is not.
+  FunctionDef body = FDH::Create(
+      "Body", {"x: float", "y: float"}, {"x_out: float", "y_out: float"}, {},
+      {{{"square"}, "Square", {"y"}, {{"T", DT_FLOAT}}},
+       {{"add"}, "Add", {"x", "square:y:0"}, {{"T", DT_FLOAT}}}},
+      {{"x_out", "add:z:0"}, {"y_out", "y"}});
+  FunctionDef cond = FDH::Create(
+      "Cond", {"x: float", "y: float"}, {"out: bool"}, {},
+      {{{"less"}, "Less", {"x", "y"}, {{"T", DT_FLOAT}}}},
+      {{"out", "less:z:0"}});
+
+  GrapplerItem item;
+  GraphDef& graph = item.graph;
+  *graph.mutable_library()->add_function() = body;
+  *graph.mutable_library()->add_function() = cond;
+  AddSimpleNode("x", "Const", {}, &graph);
+  AddSimpleNode("y", "Const", {}, &graph);
+  AttrValue types;
+  types.mutable_list()->add_type(DT_FLOAT);
+  types.mutable_list()->add_type(DT_FLOAT);
+  AttrValue body_attr;
+  body_attr.mutable_func()->set_name("Body");
+  AttrValue cond_attr;
+  cond_attr.mutable_func()->set_name("Cond");
+  AddNode("while", "While", {"x", "y"},
+          {{"T", types}, {"body", body_attr}, {"cond", cond_attr}}, &graph);
+  AddSimpleNode("out", "Identity", {"while"}, &graph);
+
+  LoopOptimizer optimizer;
+  EnableOnlyFunctionalLoopInvariantNodeMotion(&optimizer);
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  const string hoisted_name = "while/LoopOptimizer/square";
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    if (node.name() == hoisted_name) {
+      ++found;
+      EXPECT_EQ(node.op(), "Square");
+      ASSERT_EQ(node.input_size(), 1);
+      EXPECT_EQ(node.input(0), "y");
+    } else if (node.name() == "while") {
+      ++found;
+      ASSERT_EQ(node.input_size(), 3);
+      EXPECT_EQ(node.input(2), hoisted_name);
+      EXPECT_EQ(node.attr().at("T").list().type_size(), 3);
+      EXPECT_EQ(node.attr().at("body").func().name(), "Body_hoisted");
+      EXPECT_EQ(node.attr().at("cond").func().name(), "Cond_hoisted");
+    }
+  }
+  EXPECT_EQ(found, 2);
+
+  FunctionLibraryDefinition flib(OpRegistry::Global(), output.library());
+  const FunctionDef* new_body = flib.Find("Body_hoisted");
+  ASSERT_NE(new_body, nullptr);
+  EXPECT_EQ(new_body->signature().input_arg_size(), 3);
+  EXPECT_EQ(new_body->signature().output_arg_size(), 3);
+  ASSERT_EQ(new_body->node_def_size(), 1);
+  EXPECT_EQ(new_body->node_def(0).name(), "add");
+  EXPECT_EQ(new_body->node_def(0).input(1), "loop_invariant_0");
+  const FunctionDef* new_cond = flib.Find("Cond_hoisted");
+  ASSERT_NE(new_cond, nullptr);
+  EXPECT_EQ(new_cond->signature().input_arg_size(), 3);
+}
+
 TEST_F(LoopOptimizerTest, RemovePushNoOp) {
   GrapplerItem item;
   GraphDef& graph = item.graph;
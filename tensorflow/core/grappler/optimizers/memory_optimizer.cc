@@ -977,6 +977,39 @@ struct MemInfo {
   bool operator<(const MemInfo& other) const { return fitness < other.fitness; }
 };
 
+// Simulates one step of `item` on a VirtualCluster with the devices of
+// `cluster`, and returns the estimated time at which each node completes and,
+// if `op_compute_times` is not null, the time each node spends running.
+static Status EstimateOpTimes(
+    Cluster* cluster, const GrapplerItem& item,
+    std::unordered_map<string, Costs::NanoSeconds>* op_completion_times,
+    std::unordered_map<string, Costs::NanoSeconds>* op_compute_times) {
+  VirtualCluster vcluster(cluster->GetDevices());
+  TF_RETURN_IF_ERROR(vcluster.Provision());
+  TF_RETURN_IF_ERROR(vcluster.Initialize(item));
+  RunMetadata metadata;
+  Status s = vcluster.Run(item.graph, item.feed, item.fetch, &metadata);
+  if (!s.ok() && s.code() != error::RESOURCE_EXHAUSTED) {
+    return s;
+  }
+
+  for (const auto& dev_stats : metadata.step_stats().dev_stats()) {
+    for (const auto& node_stats : dev_stats.node_stats()) {
+      Costs::NanoSeconds exec_time =
+          Costs::NanoSeconds(1) +
+          Costs::MicroSeconds(node_stats.all_start_micros() +
+                              node_stats.op_end_rel_micros());
+      op_completion_times->emplace(node_stats.node_name(), exec_time);
+      if (op_compute_times != nullptr) {
+        op_compute_times->emplace(
+            node_stats.node_name(),
+            Costs::NanoSeconds(node_stats.op_end_rel_nanos()));
+      }
+    }
+  }
+  return OkStatus();
+}
+
 static bool IdentifySwappingCandidates(
     Cluster* cluster, GrapplerItem* item,
     std::unique_ptr<GraphMemory>* memory_ptr,
@@ -1012,29 +1045,10 @@ static bool IdentifySwappingCandidates(
     int64_t required_savings = mem_usage.used_memory - prop.memory_size();
 
     std::unordered_map<string, Costs::NanoSeconds> op_completion_times;
-    {
-      VirtualCluster vcluster(cluster->GetDevices());
-      if (!vcluster.Provision().ok()) {
-        return false;
-      }
-      if (!vcluster.Initialize(*item).ok()) {
-        return false;
-      }
-      RunMetadata metadata;
-      Status s = vcluster.Run(item->graph, item->feed, item->fetch, &metadata);
-      if (!s.ok() && s.code() != error::RESOURCE_EXHAUSTED) {
-        return false;
-      }
-
-      for (const auto& dev_stats : metadata.step_stats().dev_stats()) {
-        for (const auto& node_stats : dev_stats.node_stats()) {
-          Costs::NanoSeconds exec_time =
-              Costs::NanoSeconds(1) +
-              Costs::MicroSeconds(node_stats.all_start_micros() +
-                                  node_stats.op_end_rel_micros());
-          op_completion_times.emplace(node_stats.node_name(), exec_time);
-        }
-      }
+    if (!EstimateOpTimes(cluster, *item, &op_completion_times,
+                         /*op_compute_times=*/nullptr)
+             .ok()) {
+      return false;
     }
 
     Costs::Duration peak_time = -1;
@@ -1270,6 +1284,231 @@ bool SwappingPass(RewriterConfig::MemOptType optimization_level,
   return updated_graph;
 }
 
+// A way to free an activation that is live at the memory peak of a device,
+// as chosen by CostModelPlanningPass.
+struct ActivationPlan {
+  enum Action { kRecompute, kSwap };
+  Action action;
+  string node;
+  int output_id;
+  int64_t memory_saved;
+  // Estimated increase of the step time.
+  Costs::NanoSeconds cost;
+  // Node names and input ports of the uses after the memory peak.
+  std::vector<std::pair<string, int>> uses_left;
+};
+
+// Returns true if `node` may be executed a second time to regenerate its
+// outputs.
+bool IsRecomputable(const NodeDef& node) {
+  return IsFreeOfSideEffect(node) && !IsControlFlow(node) &&
+         !IsVariable(node) && !IsPlaceholder(node) && !IsConstant(node) &&
+         !ModifiesInputsInPlace(node);
+}
+
+// Decides, for every large activation that is live at the estimated memory
+// peak of a device that doesn't fit in its memory, whether to keep it, to
+// recompute it before its remaining uses, or to swap it to the host in
+// between. Memory usage comes from GraphMemory, and op costs from a simulation
+// of the step with the VirtualScheduler. Recomputing an op costs its compute
+// time, and is considered only if its inputs stay live until the recomputation
+// anyway. Swapping costs the part of the round trip to the host that can't be
+// overlapped with the computation, and is considered only on GPUs. The
+// activations with the cheapest cost per byte are freed first, until the peak
+// fits. Recomputations are rewritten right away; swaps are recorded as
+// _swap_to_host annotations that SwappingPass turns into swap nodes.
+bool CostModelPlanningPass(Cluster* cluster, GrapplerItem* item) {
+  GraphMemory memory(*item);
+  Status s = memory.InferStatically(cluster->GetDevices());
+  if (!s.ok()) {
+    VLOG(1) << "Failed to infer memory usage: " << s.message();
+    return false;
+  }
+  std::unordered_map<string, Costs::NanoSeconds> op_completion_times;
+  std::unordered_map<string, Costs::NanoSeconds> op_compute_times;
+  s = EstimateOpTimes(cluster, *item, &op_completion_times, &op_compute_times);
+  if (!s.ok()) {
+    VLOG(1) << "Failed to estimate op costs: " << s.message();
+    return false;
+  }
+
+  // Fed nodes don't produce their value and can't be recomputed.
+  std::unordered_set<string> feeds;
+  for (const auto& feed : item->feed) {
+    feeds.insert(NodeName(feed.first));
+  }
+
+  std::vector<ActivationPlan> plans;
+  std::unordered_set<string> planned_nodes;
+  MutableGraphView graph(&item->graph);
+  for (const auto& device : cluster->GetDevices()) {
+    const string& name = device.first;
+    const DeviceProperties& prop = device.second;
+    if (prop.memory_size() <= 0) {
+      VLOG(1) << "Peak memory usage unknown for device " << name;
+      continue;
+    }
+    const GraphMemory::MemoryUsage& mem_usage = memory.GetPeakMemoryUsage(name);
+    if (mem_usage.used_memory <= prop.memory_size()) {
+      continue;
+    }
+    int64_t required_savings = mem_usage.used_memory - prop.memory_size();
+
+    Costs::Duration peak_time = -1;
+    std::unordered_map<string, Costs::Duration> deallocation_times;
+    for (const auto& live_tensor : mem_usage.live_tensors) {
+      peak_time = std::max(peak_time, live_tensor.allocation_time);
+      deallocation_times[strings::StrCat(live_tensor.node, ":",
+                                         live_tensor.output_id)] =
+          live_tensor.deallocation_time;
+    }
+
+    std::vector<ActivationPlan> candidates;
+    for (const auto& live_tensor : mem_usage.live_tensors) {
+      if (live_tensor.memory_used <= 1024) {
+        // Don't bother with small tensors.
+        continue;
+      }
+      MutableGraphView::OutputPort port =
+          graph.GetOutputPort(live_tensor.node, live_tensor.output_id);
+      if (port.node == nullptr) {
+        continue;
+      }
+      ActivationPlan plan;
+      plan.node = port.node->name();
+      plan.output_id = port.port_id;
+      plan.memory_saved = live_tensor.memory_used;
+      Costs::Duration earliest_use(Costs::Duration::infinity());
+      bool valid = true;
+      bool can_swap = prop.type() == "GPU" && IsSwappable(graph, port);
+      for (MutableGraphView::InputPort input : graph.GetFanout(port)) {
+        auto it = op_completion_times.find(input.node->name());
+        if (it == op_completion_times.end()) {
+          valid = false;
+          break;
+        }
+        if (it->second <= peak_time) {
+          continue;
+        }
+        // Respect the manual swapping annotations.
+        if (input.node->attr().count("_swap_to_host") != 0) {
+          valid = false;
+          break;
+        }
+        can_swap = can_swap && IsSwappable(input);
+        plan.uses_left.emplace_back(input.node->name(), input.port_id);
+        earliest_use = std::min(earliest_use, it->second);
+      }
+      if (!valid || plan.uses_left.empty()) {
+        continue;
+      }
+
+      // Recomputing the activation must not extend the lifetime of its inputs,
+      // or it would only move the memory pressure elsewhere.
+      bool can_recompute = feeds.count(plan.node) == 0 &&
+                           IsRecomputable(*port.node) &&
+                           op_compute_times.count(plan.node) != 0;
+      for (const string& input : port.node->input()) {
+        if (!can_recompute) break;
+        if (IsControlInput(input)) continue;
+        const TensorId input_id = ParseTensorName(input);
+        const NodeDef* input_node = graph.GetNode(input_id.node());
+        if (input_node != nullptr &&
+            (IsConstant(*input_node) || IsVariable(*input_node))) {
+          continue;
+        }
+        auto it = deallocation_times.find(
+            strings::StrCat(input_id.node(), ":", input_id.index()));
+        can_recompute =
+            it != deallocation_times.end() && it->second >= earliest_use;
+      }
+
+      // Let's assume we're going to swap over PCIe running at 16 GBps.
+      const Costs::NanoSeconds round_trip_time(2 * plan.memory_saved / 16);
+      const Costs::Duration hidden_time =
+          earliest_use - live_tensor.allocation_time;
+      const Costs::Duration swap_cost =
+          round_trip_time > hidden_time ? Costs::Duration(round_trip_time -
+                                                          hidden_time)
+                                        : Costs::Duration(0);
+      if (can_recompute &&
+          (!can_swap || op_compute_times[plan.node] <= swap_cost)) {
+        plan.action = ActivationPlan::kRecompute;
+        plan.cost = op_compute_times[plan.node];
+      } else if (can_swap) {
+        plan.action = ActivationPlan::kSwap;
+        plan.cost = swap_cost;
+      } else {
+        continue;
+      }
+      candidates.push_back(std::move(plan));
+    }
+
+    std::sort(candidates.begin(), candidates.end(),
+              [](const ActivationPlan& a, const ActivationPlan& b) {
+                // Compare the costs per byte saved. Note that we must perform
+                // the arithmetic inexactly as "double", since the products do
+                // not fit into any integral type.
+                return static_cast<double>(a.cost.count()) * b.memory_saved <
+                       static_cast<double>(b.cost.count()) * a.memory_saved;
+              });
+    for (ActivationPlan& plan : candidates) {
+      if (required_savings <= 0) {
+        break;
+      }
+      // Rewrite each node at most once.
+      if (!planned_nodes.insert(plan.node).second) {
+        continue;
+      }
+      VLOG(1) << "Will "
+              << (plan.action == ActivationPlan::kRecompute ? "recompute"
+                                                            : "swap")
+              << " tensor " << plan.node << ":" << plan.output_id
+              << " of size " << plan.memory_saved << " at an estimated cost of "
+              << plan.cost.count() << "ns";
+      required_savings -= plan.memory_saved;
+      plans.push_back(std::move(plan));
+    }
+  }
+  if (plans.empty()) {
+    return false;
+  }
+
+  for (const ActivationPlan& plan : plans) {
+    if (plan.action != ActivationPlan::kSwap) continue;
+    for (const auto& use : plan.uses_left) {
+      NodeDef* node = graph.GetNode(use.first);
+      (*node->mutable_attr())["_swap_to_host"].mutable_list()->add_i(
+          use.second);
+    }
+  }
+
+  // RecomputeSubgraph expects a topologically sorted graph. The sort
+  // invalidates the NodeDef pointers, so look the nodes up again.
+  if (!TopologicalSort(&item->graph).ok()) {
+    return true;
+  }
+  NodeMap node_map(&item->graph);
+  std::unordered_map<const NodeDef*, int> topological_numbering;
+  for (int node_number = 0; node_number < item->graph.node_size();
+       ++node_number) {
+    topological_numbering[item->graph.mutable_node(node_number)] =
+        item->graph.node_size() - node_number - 1;
+  }
+  for (const ActivationPlan& plan : plans) {
+    if (plan.action != ActivationPlan::kRecompute) continue;
+    std::unordered_set<const NodeDef*> recomputed_source_nodes = {
+        node_map.GetNode(plan.node)};
+    std::unordered_set<NodeDef*> target_nodes;
+    for (const auto& use : plan.uses_left) {
+      target_nodes.insert(node_map.GetNode(use.first));
+    }
+    RecomputeSubgraph(recomputed_source_nodes, target_nodes, node_map,
+                      topological_numbering, &item->graph);
+  }
+  return true;
+}
+
 bool CrossesTaskOrCpuGpuBoundary(const NodeDef& node1, const NodeDef& node2) {
   string task1;
   string device1;
@@ -1400,6 +1639,12 @@ Status MemoryOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
                                &optimized_item.graph, item);
   }
 
+  if (optimization_level_ == RewriterConfig::COST_MODEL_HEURISTICS &&
+      !item.fetch.empty() && cluster != nullptr) {
+    GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
+    CostModelPlanningPass(cluster, &optimized_item);
+  }
+
   std::unordered_set<string> skip_list;
   // Bound the number of rewrite passes to avoid long processing times on graphs
   // that simply won't fit in memory.
@@ -1426,7 +1671,8 @@ Status MemoryOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
       if ((optimization_level_ == RewriterConfig::DEFAULT_MEM_OPT ||
            optimization_level_ == RewriterConfig::SWAPPING_HEURISTICS ||
            optimization_level_ == RewriterConfig::HEURISTICS ||
-           optimization_level_ == RewriterConfig::MANUAL) &&
+           optimization_level_ == RewriterConfig::MANUAL ||
+           optimization_level_ == RewriterConfig::COST_MODEL_HEURISTICS) &&
           cluster != nullptr) {
         if (SwappingPass(optimization_level_, cluster, &memory, &optimized_item,
                          &skip_list)) {
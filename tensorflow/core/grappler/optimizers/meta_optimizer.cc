@@ -17,6 +17,8 @@ limitations under the License.
 
 #include <algorithm>
 #include <functional>
+#include <map>
+#include <set>
 #include <string>
 #include <utility>
 
@@ -30,9 +32,11 @@ limitations under the License.
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/function.pb.h"
 #include "tensorflow/core/framework/metrics.h"
+#include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
 #include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/framework/versions.pb.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
 #include "tensorflow/core/grappler/clusters/virtual_cluster.h"
 #include "tensorflow/core/grappler/optimizers/arithmetic_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/auto_mixed_precision.h"
@@ -60,7 +64,14 @@ limitations under the License.
 #include "tensorflow/core/grappler/verifiers/structure_verifier.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/random.h"
+#include "tensorflow/core/protobuf/device_properties.pb.h"
+#include "tensorflow/core/public/version.h"
 #include "tensorflow/core/util/dump_graph.h"
 #include "tensorflow/core/util/util.h"
 #include "tensorflow/core/util/xla_config_registry.h"
@@ -184,6 +195,105 @@ Status GetGraphDevice(const GraphDef& g_def, std::set<std::string>* devices) {
   return OkStatus();
 }
 
+// Returns the name of the optimization cache entry of `item`: a fingerprint of
+// everything the result of the meta optimizer depends on. Each component is
+// length-prefixed so that different inputs can't produce the same material.
+string OptimizationCacheKey(const ConfigProto& config_proto,
+                            bool has_cpu_device, const Cluster* cluster,
+                            const GrapplerItem& item) {
+  string material;
+  const auto append = [&material](absl::string_view s) {
+    absl::StrAppend(&material, s.size(), ":", s);
+  };
+  const auto append_proto = [&append](const protobuf::MessageLite& proto) {
+    string serialized;
+    SerializeToStringDeterministic(proto, &serialized);
+    append(serialized);
+  };
+
+  append(TF_VERSION_STRING);
+  append(absl::StrCat(TF_GRAPH_DEF_VERSION));
+  append_proto(item.graph);
+
+  ConfigProto key_config = config_proto;
+  key_config.mutable_graph_options()
+      ->mutable_rewrite_options()
+      ->clear_experimental_optimization_cache_dir();
+  append_proto(key_config);
+
+  for (const auto& feed : item.feed) {
+    append(feed.first);
+    TensorProto feed_proto;
+    feed.second.AsProtoTensorContent(&feed_proto);
+    append_proto(feed_proto);
+  }
+  append("fetch");
+  for (const string& fetch : item.fetch) append(fetch);
+
+  const std::unordered_set<string> preserved = item.NodesToPreserve();
+  std::set<string> sorted_preserved(preserved.begin(), preserved.end());
+  append("preserve");
+  for (const string& node : sorted_preserved) append(node);
+
+  std::set<string> sorted_devices(item.devices().begin(), item.devices().end());
+  append("devices");
+  for (const string& device : sorted_devices) append(device);
+  if (cluster != nullptr) {
+    std::map<string, DeviceProperties> cluster_devices(
+        cluster->GetDevices().begin(), cluster->GetDevices().end());
+    append("cluster");
+    for (const auto& device : cluster_devices) {
+      append(device.first);
+      append_proto(device.second);
+    }
+  }
+
+  const GrapplerItem::OptimizationOptions& options =
+      item.optimization_options();
+  append(absl::StrCat(options.allow_non_differentiable_rewrites,
+                      options.allow_pruning_stateful_and_dataset_ops,
+                      options.optimize_function_library,
+                      options.is_eager_mode, has_cpu_device));
+
+  const Fprint128 fingerprint = Fingerprint128(material);
+  return absl::StrCat(absl::Hex(fingerprint.high64, absl::kZeroPad16),
+                      absl::Hex(fingerprint.low64, absl::kZeroPad16));
+}
+
+// Reads the cached optimization result at `path` into `optimized_graph`.
+// Returns false if there is no usable entry.
+bool ReadOptimizationCacheEntry(const string& path, GraphDef* optimized_graph) {
+  Env* env = Env::Default();
+  if (!env->FileExists(path).ok()) return false;
+  const Status status = ReadBinaryProto(env, path, optimized_graph);
+  if (!status.ok()) {
+    LOG(WARNING) << "Ignoring unreadable optimization cache entry " << path
+                 << ": " << status;
+    optimized_graph->Clear();
+    return false;
+  }
+  return true;
+}
+
+// Stores `optimized_graph` at `path`. The entry is written to a temporary file
+// and renamed into place, so that concurrent readers, e.g. other replicas
+// sharing the cache directory, never observe a partially written entry.
+// Failures are logged and otherwise ignored.
+void WriteOptimizationCacheEntry(const string& path,
+                                 const GraphDef& optimized_graph) {
+  Env* env = Env::Default();
+  Status status = env->RecursivelyCreateDir(string(io::Dirname(path)));
+  const string tmp_path =
+      absl::StrCat(path, ".", absl::Hex(random::New64()), ".tmp");
+  if (status.ok()) status = WriteBinaryProto(env, tmp_path, optimized_graph);
+  if (status.ok()) status = env->RenameFile(tmp_path, path);
+  if (!status.ok()) {
+    LOG(WARNING) << "Failed to write optimization cache entry " << path << ": "
+                 << status;
+    env->DeleteFile(tmp_path).IgnoreError();
+  }
+}
+
 }  // namespace
 
 #define MK_OPT(NAME, CONFIG, VALUE)                                    \
@@ -238,6 +348,8 @@ std::unique_ptr<GraphOptimizer> MetaOptimizer::MakeNewOptimizer(
 #endif
   MK_OPT("auto_mixed_precision_cpu", "auto_mixed_precision_cpu",
          new AutoMixedPrecision(AutoMixedPrecisionMode::CPU));
+  MK_OPT("auto_mixed_precision_int8", "auto_mixed_precision_int8",
+         new AutoMixedPrecision(AutoMixedPrecisionMode::INT8));
   MK_OPT("memory", "memory_optimization",
          new MemoryOptimizer(RewriterConfig::MANUAL));
   MK_OPT("common_subgraph_elimination", "common_subgraph_elimination",
@@ -401,6 +513,12 @@ Status MetaOptimizer::InitializeOptimizers(
     optimizers->push_back(
         std::make_unique<AutoMixedPrecision>(AutoMixedPrecisionMode::CPU));
   }
+  if (AutoMixedPrecisionEnabled(cfg_.auto_mixed_precision_int8()) &&
+      AutoMixedPrecisionEnabled(
+          plugin_configs.toggle_config["auto_mixed_precision_int8"])) {
+    optimizers->push_back(
+        std::make_unique<AutoMixedPrecision>(AutoMixedPrecisionMode::INT8));
+  }
   if (BOTH_ARE_ON(pin_to_host_optimization))
     optimizers->push_back(std::make_unique<PinToHostOptimizer>());
   else if (BOTH_ARE_EXPERIMENTAL_MLIR(pin_to_host_optimization) ||
@@ -651,6 +769,10 @@ void MetaOptimizer::PrintUserAndPluginConfigs(
         AutoMixedPrecisionEnabled(cfg_.auto_mixed_precision_cpu())
             ? RewriterConfig::ON
             : RewriterConfig::OFF;
+    user_cfg.toggle_config["auto_mixed_precision_int8"] =
+        AutoMixedPrecisionEnabled(cfg_.auto_mixed_precision_int8())
+            ? RewriterConfig::ON
+            : RewriterConfig::OFF;
     user_cfg.toggle_config["memory_optimization"] =
         MemoryOptimizerEnabled(cfg_.memory_optimization(),
                                config_proto_.graph_options()
@@ -681,6 +803,7 @@ void MetaOptimizer::PrintUserAndPluginConfigs(
                 "auto_mixed_precision_onednn_bfloat16")
       PRINT_CFG("auto_mixed_precision_mkl", "auto_mixed_precision_mkl")
       PRINT_CFG("auto_mixed_precision_cpu", "auto_mixed_precision_cpu")
+      PRINT_CFG("auto_mixed_precision_int8", "auto_mixed_precision_int8")
       PRINT_CFG("pin_to_host", "pin_to_host_optimization")
       PRINT_CFG("layout", "layout_optimizer")
       PRINT_CFG("remap", "remapping")
@@ -722,6 +845,7 @@ void MetaOptimizer::PrintUserAndPluginConfigs(
         pair.first == "auto_mixed_precision_onednn_bfloat16" ||
         pair.first == "auto_mixed_precision_mkl" ||
         pair.first == "auto_mixed_precision_cpu" ||
+        pair.first == "auto_mixed_precision_int8" ||
         pair.first == "pin_to_host_optimization" ||
         pair.first == "scoped_allocator_optimization") {
       // These optimizers are turned off by default.
@@ -1072,6 +1196,21 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
       "Deleted $0 unreachable functions from the graph (library size = $1)",
       old_library_size - new_library_size, new_library_size);
 
+  // If a result for an identical item was cached, e.g. by an earlier run of
+  // the same model, reuse it instead of running the optimizers again.
+  string cache_entry_path;
+  if (!cfg_.experimental_optimization_cache_dir().empty()) {
+    const string key = OptimizationCacheKey(
+        config_proto_, cpu_device_ != nullptr, cluster, item);
+    cache_entry_path = io::JoinPath(cfg_.experimental_optimization_cache_dir(),
+                                    absl::StrCat(key, ".pb"));
+    if (ReadOptimizationCacheEntry(cache_entry_path, optimized_graph)) {
+      VLOG(1) << "Using cached optimization result " << cache_entry_path
+              << " for grappler item: " << item.id;
+      return OkStatus();
+    }
+  }
+
   // Save a few small fields from item before we move it.
   bool optimize_function_library =
       item.optimization_options().optimize_function_library;
@@ -1299,6 +1438,10 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
   }
 #endif
 
+  if (!cache_entry_path.empty()) {
+    WriteOptimizationCacheEntry(cache_entry_path, *optimized_graph);
+  }
+
   VLOG(1) << "Optimized " << optimized_funcs.size()
           << " functions: " << absl::StrJoin(optimized_funcs, ", ");
   VLOG(3) << "Optimized graph =\n" << optimized_graph->DebugString();
@@ -1355,6 +1498,7 @@ bool MetaOptimizerEnabled(const ConfigProto& cfg) {
              rewrite_cfg.auto_mixed_precision_onednn_bfloat16()) ||
          AutoMixedPrecisionEnabled(rewrite_cfg.auto_mixed_precision_mkl()) ||
          AutoMixedPrecisionEnabled(rewrite_cfg.auto_mixed_precision_cpu()) ||
+         AutoMixedPrecisionEnabled(rewrite_cfg.auto_mixed_precision_int8()) ||
          !rewrite_cfg.optimizers().empty() ||
          !rewrite_cfg.custom_optimizers().empty();
 }
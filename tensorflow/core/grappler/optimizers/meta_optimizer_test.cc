@@ -32,6 +32,8 @@ limitations under the License.
 #include "tensorflow/core/grappler/utils/grappler_test.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/protobuf/config.pb.h"
@@ -255,6 +257,53 @@ TEST_F(MetaOptimizerTest, RunToggleOptimizersAndCustomGraphOptimizerTwice) {
   EXPECT_TRUE(TestGraphOptimizer::IsOptimized());
 }
 
+TEST_F(MetaOptimizerTest, ReusesCachedOptimizationResult) {
+  TrivialTestGraphInputYielder fake_input(4, 1, 10, false, {kDevice});
+  GrapplerItem item;
+  ASSERT_TRUE(fake_input.NextItem(&item));
+
+  Env* env = Env::Default();
+  const string cache_dir =
+      io::JoinPath(testing::TmpDir(), "meta_optimizer_cache");
+  int64_t undeleted_files, undeleted_dirs;
+  env->DeleteRecursively(cache_dir, &undeleted_files, &undeleted_dirs)
+      .IgnoreError();
+
+  ConfigProto config_proto;
+  auto& rewriter_config =
+      *config_proto.mutable_graph_options()->mutable_rewrite_options();
+  rewriter_config.add_optimizers("TestOptimizer");
+  rewriter_config.set_min_graph_nodes(-1);
+  rewriter_config.set_experimental_optimization_cache_dir(cache_dir);
+
+  TestOptimizer::SetOptimized(false);
+  MetaOptimizer optimizer(nullptr, config_proto);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_TRUE(TestOptimizer::IsOptimized());
+  std::vector<string> entries;
+  TF_ASSERT_OK(env->GetChildren(cache_dir, &entries));
+  ASSERT_EQ(entries.size(), 1);
+
+  // The same item and config hit the cache and skip the optimizers.
+  TestOptimizer::SetOptimized(false);
+  MetaOptimizer cached_optimizer(nullptr, config_proto);
+  GraphDef cached_output;
+  TF_ASSERT_OK(cached_optimizer.Optimize(nullptr, item, &cached_output));
+  EXPECT_FALSE(TestOptimizer::IsOptimized());
+  CompareGraphs(output, cached_output);
+
+  // A different config misses it.
+  rewriter_config.set_constant_folding(RewriterConfig::OFF);
+  TestOptimizer::SetOptimized(false);
+  MetaOptimizer other_optimizer(nullptr, config_proto);
+  GraphDef other_output;
+  TF_ASSERT_OK(other_optimizer.Optimize(nullptr, item, &other_output));
+  EXPECT_TRUE(TestOptimizer::IsOptimized());
+  TF_ASSERT_OK(env->GetChildren(cache_dir, &entries));
+  EXPECT_EQ(entries.size(), 2);
+}
+
 TEST_F(MetaOptimizerTest, OptimizeFunctionLibrary) {
   using test::function::NDef;
 
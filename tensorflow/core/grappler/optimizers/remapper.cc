@@ -86,6 +86,10 @@ constexpr char kFusedDepthwiseConv2dNative[] = "_FusedDepthwiseConv2dNative";
 constexpr char kFusedBatchNormEx[] = "_FusedBatchNormEx";
 constexpr char kFusedBatchNormGradEx[] = "_FusedBatchNormGradEx";
 constexpr char kTensorToHashBucket[] = "_TensorToHashBucketFast";
+constexpr char kEmbeddingLookupCombine[] = "_EmbeddingLookupCombine";
+constexpr char kFusedImagePreprocess[] = "_FusedImagePreprocess";
+constexpr char kMultiTensorResourceApplyAdam[] =
+    "_MultiTensorResourceApplyAdam";
 constexpr char kLeakyRelu[] = "LeakyRelu";
 constexpr char kMklFusedMish[] = "_MklFusedMish";
 constexpr char kRelu[] = "Relu";
@@ -161,6 +165,34 @@ struct TensorToHashBucket {
   int string_to_hash_bucket = kMissingIndex;
 };
 
+// ResourceGather followed by a SparseSegmentSum, SparseSegmentMean or
+// SparseSegmentSqrtN that can be replaced with an EmbeddingLookupCombine, which
+// reduces the rows of the variable without materializing the gathered rows.
+struct EmbeddingLookupCombine {
+  EmbeddingLookupCombine() = default;
+  EmbeddingLookupCombine(int resource_gather, int sparse_segment_reduction)
+      : resource_gather(resource_gather),
+        sparse_segment_reduction(sparse_segment_reduction) {}
+
+  int resource_gather = kMissingIndex;
+  int sparse_segment_reduction = kMissingIndex;
+};
+
+// ResizeBilinear followed by a Sub and a Mul with per-channel constants, an
+// optional Transpose to NCHW and an optional Cast to bfloat16, that can be
+// replaced with a _FusedImagePreprocess.
+struct ImagePreprocess {
+  ImagePreprocess() = default;
+
+  int resize = kMissingIndex;
+  int sub = kMissingIndex;
+  int mul = kMissingIndex;
+  int transpose = kMissingIndex;
+  int cast = kMissingIndex;
+  // Input of the Mul that holds the scale.
+  int scale_port = kMissingIndex;
+};
+
 // Pad followed by Conv3D/FusedConv3D
 struct PadWithConv3D {
   PadWithConv3D() = default;
@@ -2390,6 +2422,208 @@ bool FindTensorToHashBucket(const RemapperContext& ctx, int node_index,
   return true;
 }
 
+// Returns the combiner of the EmbeddingLookupCombine equivalent to the sparse
+// segment reduction `node`, or nullptr if there is none.
+const char* GetEmbeddingLookupCombiner(const NodeDef& node) {
+  const string& op = node.op();
+  if (op == "SparseSegmentSum" || op == "SparseSegmentSumWithNumSegments") {
+    return "sum";
+  }
+  if (op == "SparseSegmentMean" || op == "SparseSegmentMeanWithNumSegments") {
+    return "mean";
+  }
+  if (op == "SparseSegmentSqrtN" ||
+      op == "SparseSegmentSqrtNWithNumSegments") {
+    return "sqrtn";
+  }
+  return nullptr;
+}
+
+bool FindEmbeddingLookupCombine(RemapperContext* ctx, int node_index,
+                                EmbeddingLookupCombine* matched) {
+  // Root of the pattern must be a sparse segment reduction.
+  const auto* node_view = ctx->graph_view.GetNode(node_index);
+  const auto* node_def = node_view->node();
+
+  if (GetEmbeddingLookupCombiner(*node_def) == nullptr ||
+      HasControlFaninOrFanout(*node_view) || !NodeIsOnCpu(node_def)) {
+    return false;
+  }
+  if (!HasDataType(node_def, DT_FLOAT) && !HasDataType(node_def, DT_BFLOAT16) &&
+      !HasDataType(node_def, DT_HALF)) {
+    return false;
+  }
+
+  // Input to the sparse segment reduction must be a ResourceGather that is
+  // not used anywhere else.
+  if (node_view->NumRegularFanins() < 3) return false;
+  const auto& regular_fanin_0 = node_view->GetRegularFanin(0);
+  const auto* gather_node_view = regular_fanin_0.node_view();
+  const auto* gather_node_def = gather_node_view->node();
+  if (gather_node_def->op() != "ResourceGather" ||
+      regular_fanin_0.index() != 0 ||
+      HasControlFaninOrFanout(*gather_node_view) ||
+      !HasAtMostOneFanoutAtPort0(*gather_node_view) ||
+      IsInPreserveSet(*ctx, gather_node_def) || !NodeIsOnCpu(gather_node_def)) {
+    return false;
+  }
+
+  int batch_dims;
+  if (!GetNodeAttr(*gather_node_def, "batch_dims", &batch_dims).ok() ||
+      batch_dims != 0) {
+    return false;
+  }
+
+  // The sparse segment reduction indexes the first dimension of the gathered
+  // rows, so the ids must be a vector for the two indirections to compose.
+  if (!ctx->inferred_graph_properties) {
+    Status s = ctx->graph_properties.InferStatically(
+        /*assume_valid_feeds=*/true,
+        /*aggressive_shape_inference=*/false,
+        /*include_input_tensor_values=*/false,
+        /*include_output_tensor_values=*/false);
+    if (!s.ok()) return false;
+    ctx->inferred_graph_properties = true;
+  }
+  const auto& props =
+      ctx->graph_properties.GetInputProperties(gather_node_def->name());
+  if (props.size() < 2 || props[1].shape().unknown_rank() ||
+      props[1].shape().dim_size() != 1) {
+    return false;
+  }
+
+  *matched = EmbeddingLookupCombine(gather_node_view->node_index(), node_index);
+  return true;
+}
+
+// Returns true if `node` is a float constant that broadcasts only along the
+// channels of NHWC images with `channels` channels (or an unknown number of
+// channels if `channels` is negative).
+bool IsPerChannelConstant(const NodeDef& node, int64_t channels) {
+  Tensor value;
+  if (!IsConstant(node) || !HasDataType(&node, DT_FLOAT, "dtype") ||
+      !value.FromProto(node.attr().at("value").tensor()) ||
+      value.dims() > 4) {
+    return false;
+  }
+  for (int d = 0; d < value.dims() - 1; ++d) {
+    if (value.dim_size(d) != 1) return false;
+  }
+  return value.NumElements() == 1 || value.NumElements() == channels;
+}
+
+bool FindImagePreprocess(RemapperContext* ctx, int node_index,
+                         ImagePreprocess* matched) {
+  // All the nodes of the pattern but the root must have a single consumer.
+  auto is_fusable = [ctx](const utils::MutableNodeView& node_view,
+                          bool is_root) {
+    return !HasControlFaninOrFanout(node_view) &&
+           NodeIsOnCpu(node_view.node()) &&
+           (is_root || (HasAtMostOneFanoutAtPort0(node_view) &&
+                        !IsInPreserveSet(*ctx, node_view.node())));
+  };
+
+  ImagePreprocess pattern;
+  const auto* node_view = ctx->graph_view.GetNode(node_index);
+  if (!is_fusable(*node_view, /*is_root=*/true)) return false;
+
+  // Optional Cast of the result to bfloat16.
+  if (IsCast(*node_view->node())) {
+    const NodeDef* cast = node_view->node();
+    bool truncate = false;
+    if (!HasDataType(cast, DT_FLOAT, "SrcT") ||
+        !HasDataType(cast, DT_BFLOAT16, "DstT") ||
+        (TryGetNodeAttr(*cast, "Truncate", &truncate) && truncate)) {
+      return false;
+    }
+    pattern.cast = node_index;
+    node_view = node_view->GetRegularFanin(0).node_view();
+    if (!is_fusable(*node_view, /*is_root=*/false)) return false;
+  }
+
+  // Optional Transpose of the result from NHWC to NCHW.
+  if (IsTranspose(*node_view->node())) {
+    const NodeDef* transpose = node_view->node();
+    if (!HasDataType(transpose, DT_FLOAT) ||
+        node_view->NumRegularFanins() != 2) {
+      return false;
+    }
+    const NodeDef* perm = node_view->GetRegularFanin(1).node_view()->node();
+    Tensor perm_tensor;
+    if (!IsConstant(*perm) ||
+        !perm_tensor.FromProto(perm->attr().at("value").tensor()) ||
+        perm_tensor.NumElements() != 4) {
+      return false;
+    }
+    const std::vector<int64_t> nchw = {0, 3, 1, 2};
+    for (int i = 0; i < 4; ++i) {
+      const int64_t dim = perm_tensor.dtype() == DT_INT32
+                              ? perm_tensor.flat<int32>()(i)
+                              : perm_tensor.flat<int64_t>()(i);
+      if (dim != nchw[i]) return false;
+    }
+    pattern.transpose = node_view->node_index();
+    node_view = node_view->GetRegularFanin(0).node_view();
+    if (!is_fusable(*node_view, /*is_root=*/false)) return false;
+  }
+
+  // Mul of the centered images by the scale, in either order.
+  const NodeDef* mul = node_view->node();
+  if (!IsMul(*mul) || !HasDataType(mul, DT_FLOAT) ||
+      node_view->NumRegularFanins() != 2) {
+    return false;
+  }
+  pattern.mul = node_view->node_index();
+  const int sub_port =
+      IsSub(*node_view->GetRegularFanin(0).node_view()->node()) ? 0 : 1;
+  pattern.scale_port = 1 - sub_port;
+  const auto* sub_view = node_view->GetRegularFanin(sub_port).node_view();
+  const NodeDef* scale =
+      node_view->GetRegularFanin(pattern.scale_port).node_view()->node();
+  const NodeDef* sub = sub_view->node();
+  if (!IsSub(*sub) || !HasDataType(sub, DT_FLOAT) ||
+      sub_view->NumRegularFanins() != 2 ||
+      !is_fusable(*sub_view, /*is_root=*/false)) {
+    return false;
+  }
+  pattern.sub = sub_view->node_index();
+  const NodeDef* mean = sub_view->GetRegularFanin(1).node_view()->node();
+
+  // Sub of the mean from the resized images.
+  const auto* resize_view = sub_view->GetRegularFanin(0).node_view();
+  if (resize_view->node()->op() != "ResizeBilinear" ||
+      !is_fusable(*resize_view, /*is_root=*/false)) {
+    return false;
+  }
+  pattern.resize = resize_view->node_index();
+
+  // The mean and the scale must broadcast along the channels only, so that the
+  // Sub and the Mul do not change the shape of the resized images.
+  if (!ctx->inferred_graph_properties) {
+    Status s = ctx->graph_properties.InferStatically(
+        /*assume_valid_feeds=*/true,
+        /*aggressive_shape_inference=*/false,
+        /*include_input_tensor_values=*/false,
+        /*include_output_tensor_values=*/false);
+    if (!s.ok()) return false;
+    ctx->inferred_graph_properties = true;
+  }
+  const auto& props =
+      ctx->graph_properties.GetInputProperties(resize_view->node()->name());
+  if (props.empty() || props[0].shape().unknown_rank() ||
+      props[0].shape().dim_size() != 4) {
+    return false;
+  }
+  const int64_t channels = props[0].shape().dim(3).size();
+  if (!IsPerChannelConstant(*mean, channels) ||
+      !IsPerChannelConstant(*scale, channels)) {
+    return false;
+  }
+
+  *matched = pattern;
+  return true;
+}
+
 bool FindFusedBatchMatMul(RemapperContext* ctx, int node_index,
                           std::map<string, int>* matched_nodes_map,
                           std::set<int>* remove_node_indices,
@@ -2507,6 +2741,150 @@ bool FindFusedBatchMatMul(RemapperContext* ctx, int node_index,
   return found_op_type_match;
 }
 
+// Finds scaled dot-product attention,
+//   BatchMatMulV2(Softmax(BatchMatMulV2(q, k, adj_y=True) * scale [+ mask]), v)
+// on CPU, which is remapped into _FusedAttention.
+bool FindFusedAttention(RemapperContext* ctx, int node_index,
+                        std::map<string, int>* matched_nodes_map,
+                        std::set<int>* remove_node_indices, bool* has_mask) {
+  auto* output_node_def = ctx->graph_view.GetNode(node_index)->node();
+  if (!IsAnyBatchMatMul(*output_node_def) ||
+      !HasDataType(output_node_def, DT_FLOAT) ||
+      !NodeIsOnCpu(output_node_def)) {
+    return false;
+  }
+
+  using utils::MatchingDirection;
+  using utils::NodeStatus;
+  // clang-format off
+  utils::OpTypePattern scaled_scores =
+    {"Mul", "scale_mul", NodeStatus::kRemove,
+      {
+        {"BatchMatMulV2", "scores", NodeStatus::kRemove},
+        {"*", "scale", NodeStatus::kRemain}
+      }
+    };
+  utils::OpTypePattern masked_attention_pattern =
+    {"BatchMatMulV2", "output", NodeStatus::kReplace,
+      {
+        {"Softmax", "softmax", NodeStatus::kRemove,
+          {
+            {"Add|AddV2", "mask_add", NodeStatus::kRemove,
+              {
+                scaled_scores,
+                {"*", "mask", NodeStatus::kRemain}
+              }
+            }
+          }
+        },
+        {"*", "value", NodeStatus::kRemain}
+      }
+    };
+  utils::OpTypePattern attention_pattern =
+    {"BatchMatMulV2", "output", NodeStatus::kReplace,
+      {
+        {"Softmax", "softmax", NodeStatus::kRemove,
+          {
+            scaled_scores
+          }
+        },
+        {"*", "value", NodeStatus::kRemain}
+      }
+    };
+  // clang-format on
+
+  utils::SubGraphMatcher<MatchingDirection::kFollowInputs> graph_matcher(
+      &(ctx->graph_view));
+  matched_nodes_map->clear();
+  remove_node_indices->clear();
+  *has_mask = graph_matcher.GetMatchedNodes(
+      masked_attention_pattern, ctx->nodes_to_preserve,
+      ctx->graph_view.GetNode(node_index), matched_nodes_map,
+      remove_node_indices);
+  if (!*has_mask) {
+    matched_nodes_map->clear();
+    remove_node_indices->clear();
+    if (!graph_matcher.GetMatchedNodes(
+            attention_pattern, ctx->nodes_to_preserve,
+            ctx->graph_view.GetNode(node_index), matched_nodes_map,
+            remove_node_indices)) {
+      return false;
+    }
+  }
+
+  // The kernel computes q * k^T and softmax * v without broadcasting.
+  const NodeDef* scores_node_def =
+      ctx->graph_view.GetNode(matched_nodes_map->at("scores"))->node();
+  bool adj_x = true;
+  bool adj_y = false;
+  if (!TryGetNodeAttr(*scores_node_def, "adj_x", &adj_x) || adj_x ||
+      !TryGetNodeAttr(*scores_node_def, "adj_y", &adj_y) || !adj_y) {
+    return false;
+  }
+  if (!TryGetNodeAttr(*output_node_def, "adj_x", &adj_x) || adj_x ||
+      !TryGetNodeAttr(*output_node_def, "adj_y", &adj_y) || adj_y) {
+    return false;
+  }
+
+  if (!ctx->inferred_graph_properties) {
+    Status s = ctx->graph_properties.InferStatically(
+        /*assume_valid_feeds=*/true,
+        /*aggressive_shape_inference=*/false,
+        /*include_input_tensor_values=*/false,
+        /*include_output_tensor_values=*/true);
+    if (!s.ok()) return false;
+    ctx->inferred_graph_properties = true;
+  }
+  const auto& scores_inputs =
+      ctx->graph_properties.GetInputProperties(scores_node_def->name());
+  const auto& output_inputs =
+      ctx->graph_properties.GetInputProperties(output_node_def->name());
+  if (scores_inputs.size() != 2 || output_inputs.size() != 2) return false;
+  const TensorShapeProto& query_shape = scores_inputs[0].shape();
+  const TensorShapeProto& key_shape = scores_inputs[1].shape();
+  const TensorShapeProto& value_shape = output_inputs[1].shape();
+  const int rank = Rank(query_shape);
+  if (rank < 3 || Rank(key_shape) != rank || Rank(value_shape) != rank) {
+    return false;
+  }
+  for (int i = 0; i < rank - 2; ++i) {
+    const auto& dim = query_shape.dim(i);
+    if (!IsKnownSymbolically(dim) || key_shape.dim(i).size() != dim.size() ||
+        value_shape.dim(i).size() != dim.size()) {
+      return false;
+    }
+  }
+
+  const NodeDef* scale_node_def =
+      ctx->graph_view.GetNode(matched_nodes_map->at("scale"))->node();
+  const auto& scale_props =
+      ctx->graph_properties.GetOutputProperties(scale_node_def->name());
+  if (scale_props.empty() || Rank(scale_props[0].shape()) != 0) return false;
+
+  if (*has_mask) {
+    // The mask must broadcast to the scores, not the other way around.
+    const NodeDef* mask_add_node_def =
+        ctx->graph_view.GetNode(matched_nodes_map->at("mask_add"))->node();
+    const auto& mask_add_inputs =
+        ctx->graph_properties.GetInputProperties(mask_add_node_def->name());
+    const auto& mask_add_outputs =
+        ctx->graph_properties.GetOutputProperties(mask_add_node_def->name());
+    const auto& scores_outputs =
+        ctx->graph_properties.GetOutputProperties(scores_node_def->name());
+    if (mask_add_inputs.size() != 2 || mask_add_outputs.empty() ||
+        scores_outputs.empty()) {
+      return false;
+    }
+    if (Rank(mask_add_inputs[0].shape()) != rank ||
+        Rank(mask_add_inputs[1].shape()) != rank ||
+        !ShapesSymbolicallyEqual(mask_add_outputs[0].shape(),
+                                 scores_outputs[0].shape())) {
+      return false;
+    }
+  }
+  return true;
+}
+
 // Helper function to check if the reduction axes for a given input
 // shape align with instance normalization's mean computation.
 // Mean reduction axes for instance norm are expected to be:
@@ -3903,6 +4281,281 @@ Status AddTensorToHashBucketNode(RemapperContext* ctx,
   return OkStatus();
 }
 
+Status AddEmbeddingLookupCombineNode(RemapperContext* ctx,
+                                     const EmbeddingLookupCombine& matched,
+                                     std::vector<bool>* invalidated_nodes,
+                                     std::vector<bool>* nodes_to_delete) {
+  const GraphDef* graph = ctx->graph_view.graph();
+  const NodeDef& resource_gather = graph->node(matched.resource_gather);
+  const NodeDef& sparse_segment_reduction =
+      graph->node(matched.sparse_segment_reduction);
+  VLOG(2) << "Fuse ResourceGather with " << sparse_segment_reduction.op()
+          << ": resource_gather=" << resource_gather.name()
+          << " sparse_segment_reduction=" << sparse_segment_reduction.name()
+          << " on device=" << sparse_segment_reduction.device();
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  Status status;
+
+  auto& src_attr = sparse_segment_reduction.attr();
+  // The index type attrs default to int32 and may be missing from the node.
+  auto index_type = [&sparse_segment_reduction](const string& attr_name) {
+    const DataType type =
+        GetDataTypeFromAttr(sparse_segment_reduction, attr_name);
+    return type == DT_INVALID ? DT_INT32 : type;
+  };
+
+  string num_segments;
+  DataType num_segments_type = DT_INT32;
+  if (sparse_segment_reduction.input_size() > 3 &&
+      !IsControlInput(sparse_segment_reduction.input(3))) {
+    num_segments = sparse_segment_reduction.input(3);
+    num_segments_type = index_type("Tnumsegments");
+  } else {
+    // A negative number of segments makes the kernel use the last segment id
+    // plus one, like the variants without num_segments.
+    NodeDef num_segments_const;
+    num_segments = AddPrefixToNodeName("NumSegments",
+                                       sparse_segment_reduction.name());
+    num_segments_const.set_name(num_segments);
+    num_segments_const.set_op("Const");
+    num_segments_const.set_device(sparse_segment_reduction.device());
+    *num_segments_const.add_input() =
+        AsControlDependency(sparse_segment_reduction.input(2));
+    (*num_segments_const.mutable_attr())["dtype"].set_type(DT_INT32);
+    Tensor t(DT_INT32, TensorShape({}));
+    t.scalar<int32>()() = -1;
+    t.AsProtoTensorContent(
+        (*num_segments_const.mutable_attr())["value"].mutable_tensor());
+    mutation->AddNode(std::move(num_segments_const), &status);
+    TF_RETURN_IF_ERROR(status);
+  }
+
+  NodeDef fused_op;
+  fused_op.set_name(sparse_segment_reduction.name());
+  fused_op.set_device(sparse_segment_reduction.device());
+  fused_op.add_input(resource_gather.input(0));           // 0: resource
+  fused_op.add_input(resource_gather.input(1));           // 1: ids
+  fused_op.add_input(sparse_segment_reduction.input(1));  // 2: indices
+  fused_op.add_input(sparse_segment_reduction.input(2));  // 3: segment_ids
+  fused_op.add_input(num_segments);                       // 4: num_segments
+  fused_op.set_op(kEmbeddingLookupCombine);
+
+  auto* attr = fused_op.mutable_attr();
+  (*attr)["dtype"] = src_attr.at("T");
+  (*attr)["combiner"].set_s(
+      GetEmbeddingLookupCombiner(sparse_segment_reduction));
+  (*attr)["Tids"] = resource_gather.attr().at("Tindices");
+  (*attr)["Tidx"].set_type(index_type("Tidx"));
+  (*attr)["Tsegmentids"].set_type(index_type("Tsegmentids"));
+  (*attr)["Tnumsegments"].set_type(num_segments_type);
+
+  mutation->AddNode(std::move(fused_op), &status);
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(mutation->Apply());
+
+  (*invalidated_nodes)[matched.sparse_segment_reduction] = true;
+  (*nodes_to_delete)[matched.resource_gather] = true;
+
+  return OkStatus();
+}
+
+Status AddImagePreprocessNode(RemapperContext* ctx,
+                              const ImagePreprocess& matched,
+                              std::vector<bool>* invalidated_nodes,
+                              std::vector<bool>* nodes_to_delete) {
+  const GraphDef* graph = ctx->graph_view.graph();
+  const NodeDef& resize = graph->node(matched.resize);
+  const NodeDef& sub = graph->node(matched.sub);
+  const NodeDef& mul = graph->node(matched.mul);
+  const int root = matched.cast != kMissingIndex        ? matched.cast
+                   : matched.transpose != kMissingIndex ? matched.transpose
+                                                        : matched.mul;
+  const NodeDef& root_node = graph->node(root);
+  VLOG(2) << "Fuse ResizeBilinear with Sub and Mul:"
+          << " resize=" << resize.name() << " root=" << root_node.name()
+          << " on device=" << resize.device();
+
+  NodeDef fused_op;
+  fused_op.set_name(root_node.name());
+  fused_op.set_device(resize.device());
+  fused_op.add_input(resize.input(0));                // 0: images
+  fused_op.add_input(resize.input(1));                // 1: size
+  fused_op.add_input(sub.input(1));                   // 2: mean
+  fused_op.add_input(mul.input(matched.scale_port));  // 3: scale
+  fused_op.set_op(kFusedImagePreprocess);
+
+  auto* attr = fused_op.mutable_attr();
+  auto& src_attr = resize.attr();
+  (*attr)["T"] = src_attr.at("T");
+  (*attr)["out_type"].set_type(matched.cast != kMissingIndex ? DT_BFLOAT16
+                                                             : DT_FLOAT);
+  bool align_corners = false;
+  bool half_pixel_centers = false;
+  TryGetNodeAttr(resize, "align_corners", &align_corners);
+  TryGetNodeAttr(resize, "half_pixel_centers", &half_pixel_centers);
+  (*attr)["align_corners"].set_b(align_corners);
+  (*attr)["half_pixel_centers"].set_b(half_pixel_centers);
+  (*attr)["data_format"].set_s(matched.transpose != kMissingIndex ? "NCHW"
+                                                                  : "NHWC");
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  Status status;
+  mutation->AddNode(std::move(fused_op), &status);
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(mutation->Apply());
+
+  (*invalidated_nodes)[root] = true;
+  for (int node :
+       {matched.resize, matched.sub, matched.mul, matched.transpose}) {
+    if (node != kMissingIndex && node != root) (*nodes_to_delete)[node] = true;
+  }
+
+  return OkStatus();
+}
+
+// Groups the ResourceApplyAdam nodes on CPU that share their hyperparameters
+// into _MultiTensorResourceApplyAdam nodes, so that the variables of a model
+// are updated by one kernel instead of one kernel per variable. A node that
+// depends on another ResourceApplyAdam node is not grouped, so that a group
+// can not create a cycle. The control dependencies on the grouped nodes are
+// moved to their group.
+Status AddMultiTensorApplyAdamNodes(RemapperContext* ctx,
+                                    std::vector<bool>* nodes_to_delete) {
+  const GraphDef* graph = ctx->graph_view.graph();
+  const int num_nodes = nodes_to_delete->size();
+
+  auto is_candidate = [&](int node_index) {
+    const NodeDef& node = graph->node(node_index);
+    if (node.op() != "ResourceApplyAdam" || (*nodes_to_delete)[node_index] ||
+        !NodeIsOnCpu(&node) || ctx->nodes_to_preserve.count(node.name()) > 0) {
+      return false;
+    }
+    if (node.input_size() < 10) return false;
+    for (int i = 0; i < 10; ++i) {
+      if (IsControlInput(node.input(i))) return false;
+    }
+    const DataType dtype = GetDataTypeFromAttr(node, "T");
+    return dtype == DT_HALF || dtype == DT_BFLOAT16 || dtype == DT_FLOAT ||
+           dtype == DT_DOUBLE;
+  };
+  std::vector<int> candidates;
+  for (int i = 0; i < num_nodes; ++i) {
+    if (is_candidate(i)) candidates.push_back(i);
+  }
+  if (candidates.size() < 2) return OkStatus();
+
+  // Find the candidates that depend on another candidate.
+  std::vector<bool> depends_on_candidate(ctx->graph_view.NumNodes());
+  std::vector<int> ready;
+  auto add_fanouts = [&](int node_index) {
+    const auto* node_view = ctx->graph_view.GetNode(node_index);
+    for (const auto& fanouts : node_view->GetRegularFanouts()) {
+      for (const auto& fanout : fanouts) ready.push_back(fanout.node_index());
+    }
+    for (const auto& fanout : node_view->GetControlledFanouts()) {
+      ready.push_back(fanout.node_index());
+    }
+  };
+  for (int node_index : candidates) add_fanouts(node_index);
+  while (!ready.empty()) {
+    const int node_index = ready.back();
+    ready.pop_back();
+    if (depends_on_candidate[node_index]) continue;
+    depends_on_candidate[node_index] = true;
+    add_fanouts(node_index);
+  }
+
+  // Group the candidates by device, attributes and hyperparameters. An
+  // ordered map keeps the rewritten graph deterministic.
+  std::map<string, std::vector<int>> groups;
+  for (int node_index : candidates) {
+    if (depends_on_candidate[node_index]) continue;
+    const NodeDef& node = graph->node(node_index);
+    string key = absl::StrCat(node.device(), ";",
+                              DataTypeString(GetDataTypeFromAttr(node, "T")));
+    for (const char* attr_name : {"use_locking", "use_nesterov"}) {
+      // The attributes default to false and may be missing from the node.
+      bool value = false;
+      TryGetNodeAttr(node, attr_name, &value);
+      absl::StrAppend(&key, ";", value);
+    }
+    for (int i = 3; i < 9; ++i) absl::StrAppend(&key, ";", node.input(i));
+    groups[key].push_back(node_index);
+  }
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  Status status;
+  for (const auto& group : groups) {
+    // A variable updated twice stays with its own node, since the updates of
+    // a group are not ordered.
+    std::vector<int> members;
+    absl::flat_hash_set<string> variables;
+    for (int node_index : group.second) {
+      const NodeDef& node = graph->node(node_index);
+      if (variables.insert(NodeName(node.input(0))).second) {
+        members.push_back(node_index);
+      }
+    }
+    if (members.size() < 2) continue;
+
+    const NodeDef& first = graph->node(members.front());
+    VLOG(2) << "Group " << members.size()
+            << " ResourceApplyAdam nodes: first=" << first.name()
+            << " on device=" << first.device();
+
+    NodeDef fused_op;
+    fused_op.set_name(AddPrefixToNodeName("MultiTensorApplyAdam",
+                                          first.name()));
+    fused_op.set_op(kMultiTensorResourceApplyAdam);
+    fused_op.set_device(first.device());
+    for (int i = 0; i < 3; ++i) {
+      // 0: var, 1: m, 2: v
+      for (int node_index : members) {
+        fused_op.add_input(graph->node(node_index).input(i));
+      }
+    }
+    for (int i = 3; i < 9; ++i) {
+      // beta1_power, beta2_power, lr, beta1, beta2, epsilon
+      fused_op.add_input(first.input(i));
+    }
+    for (int node_index : members) {
+      fused_op.add_input(graph->node(node_index).input(9));  // grad
+    }
+    absl::flat_hash_set<string> control_inputs;
+    for (int node_index : members) {
+      const NodeDef& node = graph->node(node_index);
+      for (int i = 10; i < node.input_size(); ++i) {
+        if (control_inputs.insert(node.input(i)).second) {
+          fused_op.add_input(node.input(i));
+        }
+      }
+    }
+
+    auto* attr = fused_op.mutable_attr();
+    (*attr)["N"].set_i(members.size());
+    (*attr)["T"] = first.attr().at("T");
+    for (const char* attr_name : {"use_locking", "use_nesterov"}) {
+      auto it = first.attr().find(attr_name);
+      if (it != first.attr().end()) (*attr)[attr_name] = it->second;
+    }
+    const string fused_name = fused_op.name();
+    mutation->AddNode(std::move(fused_op), &status);
+    TF_RETURN_IF_ERROR(status);
+
+    for (int node_index : members) {
+      auto* node_view = ctx->graph_view.GetNode(node_index);
+      for (const auto& fanout : node_view->GetControlledFanouts()) {
+        mutation->RemoveControllingFanin(fanout.node_view(),
+                                         node_view->GetName());
+        mutation->AddControllingFanin(fanout.node_view(), fused_name);
+      }
+      (*nodes_to_delete)[node_index] = true;
+    }
+  }
+  return mutation->Apply();
+}
+
 Status AddFusedBatchMatMul(RemapperContext* ctx,
                            const std::map<string, int>& matched_nodes_map,
                            const std::set<int>& remove_node_indices,
@@ -3936,6 +4589,56 @@ Status AddFusedBatchMatMul(RemapperContext* ctx,
   return OkStatus();
 }
 
+Status AddFusedAttention(RemapperContext* ctx,
+                         const std::map<string, int>& matched_nodes_map,
+                         const std::set<int>& remove_node_indices,
+                         bool has_mask, std::vector<bool>* invalidated_nodes,
+                         std::vector<bool>* nodes_to_delete) {
+  auto* output_node =
+      ctx->graph_view.GetNode(matched_nodes_map.at("output"))->node();
+  auto* scores_node =
+      ctx->graph_view.GetNode(matched_nodes_map.at("scores"))->node();
+  auto* scale_mul_node =
+      ctx->graph_view.GetNode(matched_nodes_map.at("scale_mul"))->node();
+
+  // Returns the input of the binary `node` that is not produced by `other`.
+  auto other_input = [](const NodeDef& node, const NodeDef& other) {
+    return NodeName(node.input(0)) == other.name() ? node.input(1)
+                                                   : node.input(0);
+  };
+
+  // Inputs are query, key, value, scale and, optionally, the mask.
+  NodeDef fused_node;
+  fused_node.set_name(output_node->name());
+  fused_node.set_op("_FusedAttention");
+  fused_node.set_device(output_node->device());
+  fused_node.add_input(scores_node->input(0));
+  fused_node.add_input(scores_node->input(1));
+  fused_node.add_input(output_node->input(1));
+  fused_node.add_input(other_input(*scale_mul_node, *scores_node));
+  if (has_mask) {
+    auto* mask_add_node =
+        ctx->graph_view.GetNode(matched_nodes_map.at("mask_add"))->node();
+    fused_node.add_input(other_input(*mask_add_node, *scale_mul_node));
+  }
+
+  auto* attr = fused_node.mutable_attr();
+  (*attr)["T"] = output_node->attr().at("T");
+  SetAttrValue(has_mask ? 1 : 0, &(*attr)["num_args"]);
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  Status status;
+  mutation->AddNode(std::move(fused_node), &status);
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(mutation->Apply());
+  (*invalidated_nodes)[matched_nodes_map.at("output")] = true;
+
+  for (const auto& node_idx : remove_node_indices) {
+    (*nodes_to_delete)[node_idx] = true;
+  }
+  return OkStatus();
+}
+
 // Helper function to get data of type T from a given tensor and
 // return them in a vector and casted to type U.
 // Note - use this function only when type cast is safe from T to U.
@@ -4552,9 +5255,23 @@ Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
       }
     }
 
-    // Remap MatMul + BiasAdd + gelu-subgraph
+    // Remap BatchMatMul+Softmax+BatchMatMul attention into _FusedAttention.
     std::map<string, int> matched_nodes_map;
     std::set<int> remove_node_indices;
+    bool has_mask = false;
+    if (allow_non_differentiable_rewrites &&
+        FindFusedAttention(&ctx, i, &matched_nodes_map, &remove_node_indices,
+                           &has_mask)) {
+      TF_RETURN_IF_ERROR(AddFusedAttention(&ctx, matched_nodes_map,
+                                           remove_node_indices, has_mask,
+                                           &invalidated_nodes,
+                                           &nodes_to_delete));
+      continue;
+    }
+
+    // Remap MatMul + BiasAdd + gelu-subgraph
+    matched_nodes_map.clear();
+    remove_node_indices.clear();
     bool is_gelu_approximate = false;
     if (FindMatMulBiasAddAndGelu(&ctx, i, cluster, &matched_nodes_map,
                                  &remove_node_indices, &is_gelu_approximate)) {
@@ -4651,6 +5368,25 @@ Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
       continue;
     }
 
+    EmbeddingLookupCombine embedding_lookup_combine;
+    if (allow_non_differentiable_rewrites &&
+        FindEmbeddingLookupCombine(&ctx, i, &embedding_lookup_combine)) {
+      TF_RETURN_IF_ERROR(AddEmbeddingLookupCombineNode(
+          &ctx, embedding_lookup_combine, &invalidated_nodes,
+          &nodes_to_delete));
+      continue;
+    }
+
+    // Remap ResizeBilinear+Sub+Mul+<Transpose>+<Cast> into the
+    // _FusedImagePreprocess.
+    ImagePreprocess image_preprocess;
+    if (allow_non_differentiable_rewrites &&
+        FindImagePreprocess(&ctx, i, &image_preprocess)) {
+      TF_RETURN_IF_ERROR(AddImagePreprocessNode(
+          &ctx, image_preprocess, &invalidated_nodes, &nodes_to_delete));
+      continue;
+    }
+
     // During inference, most of the inputs to FusedBatchNorm are constant, and
     // we can therefore replace the op with a much cheaper set of primitives.
     FusedBatchNorm fused_batch_norm;
@@ -4660,6 +5396,8 @@ Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
     }
   }
 
+  TF_RETURN_IF_ERROR(AddMultiTensorApplyAdamNodes(&ctx, &nodes_to_delete));
+
   // Remove invalidated nodes.
   utils::Mutation* mutation = ctx.graph_view.GetMutationBuilder();
   for (int i = 0; i < num_nodes; ++i) {
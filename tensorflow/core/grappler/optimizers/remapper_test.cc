@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/remapper.h"
 
 #include "tensorflow/cc/ops/nn_ops_internal.h"
+#include "tensorflow/cc/ops/resource_variable_ops.h"
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/types.h"
@@ -1330,6 +1331,114 @@ TEST_F(RemapperTest, FuseMatmulWithAdd) {
   test::ExpectClose(tensors[0], tensors_expected[0], 1e-6);
 }
 
+class RemapperFuseAttentionTest : public RemapperTest {
+ protected:
+  void RunTest(bool with_mask) {
+    using ::tensorflow::ops::Placeholder;
+    tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+    auto q = Placeholder(s.WithOpName("q"), DT_FLOAT,
+                         ops::Placeholder::Shape({2, 3, 4, 8}));
+    auto k = Placeholder(s.WithOpName("k"), DT_FLOAT,
+                         ops::Placeholder::Shape({2, 3, 6, 8}));
+    auto v = Placeholder(s.WithOpName("v"), DT_FLOAT,
+                         ops::Placeholder::Shape({2, 3, 6, 8}));
+    auto scores = ops::BatchMatMulV2(s.WithOpName("scores"), q, k,
+                                     ops::BatchMatMulV2::AdjY(true));
+    auto scale = ops::Const(s.WithOpName("scale"), 0.35f);
+    Output logits = ops::Mul(s.WithOpName("scale_mul"), scores, scale);
+    if (with_mask) {
+      auto mask = ops::Const(s.WithOpName("mask"),
+                             {0.0f, 0.0f, -1e9f, 0.0f, 0.0f, 0.0f, -1e9f,
+                              -1e9f, 0.0f, 0.0f, 0.0f, 0.0f},
+                             {2, 1, 1, 6});
+      logits = ops::AddV2(s.WithOpName("mask_add"), logits, mask);
+    }
+    auto softmax = ops::Softmax(s.WithOpName("softmax"), logits);
+    auto attention = ops::BatchMatMulV2(s.WithOpName("attention"), softmax, v);
+    auto fetch = ops::Identity(s.WithOpName("fetch"), attention);
+
+    auto q_t = GenerateRandomTensor<DT_FLOAT>({2, 3, 4, 8});
+    auto k_t = GenerateRandomTensor<DT_FLOAT>({2, 3, 6, 8});
+    auto v_t = GenerateRandomTensor<DT_FLOAT>({2, 3, 6, 8});
+
+    GrapplerItem item;
+    item.fetch = {"fetch"};
+    item.feed = {{"q", q_t}, {"k", k_t}, {"v", v_t}};
+    TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+    // Place all nodes on CPU.
+    for (int i = 0; i < item.graph.node_size(); ++i) {
+      item.graph.mutable_node(i)->set_device("/device:CPU:0");
+    }
+
+    Remapper optimizer(RewriterConfig::ON);
+    GraphDef output;
+    TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+    int found = 0;
+    for (const NodeDef& node : output.node()) {
+      EXPECT_NE(node.op(), "Softmax");
+      if (node.name() == "attention") {
+        EXPECT_EQ(node.op(), "_FusedAttention");
+        ASSERT_EQ(node.input_size(), with_mask ? 5 : 4);
+        EXPECT_EQ(node.input(0), "q");
+        EXPECT_EQ(node.input(1), "k");
+        EXPECT_EQ(node.input(2), "v");
+        EXPECT_EQ(node.input(3), "scale");
+        if (with_mask) EXPECT_EQ(node.input(4), "mask");
+        EXPECT_EQ(node.attr().at("num_args").i(), with_mask ? 1 : 0);
+        found++;
+      }
+    }
+    EXPECT_EQ(1, found);
+
+    auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+    ASSERT_EQ(tensors_expected.size(), 1);
+    auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+    ASSERT_EQ(tensors.size(), 1);
+    test::ExpectClose(tensors[0], tensors_expected[0], 1e-5);
+  }
+};
+
+TEST_F(RemapperFuseAttentionTest, WithoutMask) { RunTest(/*with_mask=*/false); }
+
+TEST_F(RemapperFuseAttentionTest, WithMask) { RunTest(/*with_mask=*/true); }
+
+TEST_F(RemapperTest, DoNotFuseAttentionWithTransposedValue) {
+  using ::tensorflow::ops::Placeholder;
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  auto q = Placeholder(s.WithOpName("q"), DT_FLOAT,
+                       ops::Placeholder::Shape({2, 4, 8}));
+  auto k = Placeholder(s.WithOpName("k"), DT_FLOAT,
+                       ops::Placeholder::Shape({2, 4, 8}));
+  auto v = Placeholder(s.WithOpName("v"), DT_FLOAT,
+                       ops::Placeholder::Shape({2, 4, 4}));
+  auto scores = ops::BatchMatMulV2(s.WithOpName("scores"), q, k,
+                                   ops::BatchMatMulV2::AdjY(true));
+  auto scale = ops::Const(s.WithOpName("scale"), 0.35f);
+  auto logits = ops::Mul(s.WithOpName("scale_mul"), scores, scale);
+  auto softmax = ops::Softmax(s.WithOpName("softmax"), logits);
+  auto attention = ops::BatchMatMulV2(s.WithOpName("attention"), softmax, v,
+                                      ops::BatchMatMulV2::AdjY(true));
+  auto fetch = ops::Identity(s.WithOpName("fetch"), attention);
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE(node.op(), "_FusedAttention");
+  }
+}
+
 class RemapperFuseSoftplusTanhMul : public RemapperTest {
  public:
   template <DataType DTYPE>
@@ -1473,6 +1582,225 @@ TEST_F(RemapperTensorToHashBucketTest, I32) { RunTest<DT_INT32>(); }
 
 TEST_F(RemapperTensorToHashBucketTest, I64) { RunTest<DT_INT64>(); }
 
+TEST_F(RemapperTest, FuseResourceGatherWithSparseSegmentReduction) {
+  using ::tensorflow::ops::Placeholder;
+
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  auto table = ops::VarHandleOp(s.WithOpName("table"), DT_FLOAT, {100, 16});
+  auto ids = Placeholder(s.WithOpName("ids"), DT_INT64,
+                         ops::Placeholder::Shape({10}));
+  auto indices = Placeholder(s.WithOpName("indices"), DT_INT32,
+                             ops::Placeholder::Shape({10}));
+  auto segment_ids = Placeholder(s.WithOpName("segment_ids"), DT_INT32,
+                                 ops::Placeholder::Shape({10}));
+  auto num_segments = ops::Const(s.WithOpName("num_segments"), 4);
+
+  auto gather_1 = ops::ResourceGather(s.WithOpName("gather_1"), table, ids,
+                                      DT_FLOAT);
+  auto mean = ops::SparseSegmentMean(s.WithOpName("mean"), gather_1, indices,
+                                     segment_ids);
+  auto gather_2 = ops::ResourceGather(s.WithOpName("gather_2"), table, ids,
+                                      DT_FLOAT);
+  auto sum = ops::SparseSegmentSumWithNumSegments(
+      s.WithOpName("sum"), gather_2, indices, segment_ids, num_segments);
+  // The rows gathered by gather_3 are also used elsewhere, so they must be
+  // materialized anyway.
+  auto gather_3 = ops::ResourceGather(s.WithOpName("gather_3"), table, ids,
+                                      DT_FLOAT);
+  auto sqrtn = ops::SparseSegmentSqrtN(s.WithOpName("sqrtn"), gather_3,
+                                       indices, segment_ids);
+  auto fetch_1 = ops::Identity(s.WithOpName("fetch_1"), mean);
+  auto fetch_2 = ops::Identity(s.WithOpName("fetch_2"), sum);
+  auto fetch_3 = ops::Identity(s.WithOpName("fetch_3"), sqrtn);
+  auto fetch_4 = ops::Identity(s.WithOpName("fetch_4"), gather_3);
+
+  GrapplerItem item;
+  item.fetch = {"fetch_1", "fetch_2", "fetch_3", "fetch_4"};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE(node.name(), "gather_1");
+    EXPECT_NE(node.name(), "gather_2");
+    if (node.name() == "mean") {
+      EXPECT_EQ(node.op(), "_EmbeddingLookupCombine");
+      ASSERT_EQ(node.input_size(), 5);
+      EXPECT_EQ(node.input(0), "table");
+      EXPECT_EQ(node.input(1), "ids");
+      EXPECT_EQ(node.input(2), "indices");
+      EXPECT_EQ(node.input(3), "segment_ids");
+      EXPECT_EQ(node.attr().at("combiner").s(), "mean");
+      EXPECT_EQ(node.attr().at("Tids").type(), DT_INT64);
+      found++;
+    } else if (node.name() == "sum") {
+      EXPECT_EQ(node.op(), "_EmbeddingLookupCombine");
+      ASSERT_EQ(node.input_size(), 5);
+      EXPECT_EQ(node.input(4), "num_segments");
+      EXPECT_EQ(node.attr().at("combiner").s(), "sum");
+      found++;
+    } else if (node.name() == "sqrtn") {
+      EXPECT_EQ(node.op(), "SparseSegmentSqrtN");
+      found++;
+    }
+  }
+  EXPECT_EQ(found, 3);
+}
+
+TEST_F(RemapperTest, FuseImagePreprocess) {
+  using ::tensorflow::ops::Placeholder;
+
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  auto images = Placeholder(s.WithOpName("images"), DT_UINT8,
+                            ops::Placeholder::Shape({8, 480, 640, 3}));
+  auto size = ops::Const(s.WithOpName("size"), {224, 224}, {2});
+  auto mean = ops::Const(s.WithOpName("mean"), {123.7f, 116.3f, 103.5f}, {3});
+  auto scale =
+      ops::Const(s.WithOpName("scale"), {0.0171f, 0.0175f, 0.0174f}, {3});
+  auto perm = ops::Const(s.WithOpName("perm"), {0, 3, 1, 2}, {4});
+
+  // NCHW bfloat16 output.
+  auto resize_1 = ops::ResizeBilinear(
+      s.WithOpName("resize_1"), images, size,
+      ops::ResizeBilinear::HalfPixelCenters(true));
+  auto sub_1 = ops::Sub(s.WithOpName("sub_1"), resize_1, mean);
+  auto mul_1 = ops::Mul(s.WithOpName("mul_1"), scale, sub_1);
+  auto transpose_1 = ops::Transpose(s.WithOpName("transpose_1"), mul_1, perm);
+  auto cast_1 = ops::Cast(s.WithOpName("cast_1"), transpose_1, DT_BFLOAT16);
+  // NHWC float output.
+  auto resize_2 = ops::ResizeBilinear(s.WithOpName("resize_2"), images, size);
+  auto sub_2 = ops::Sub(s.WithOpName("sub_2"), resize_2, mean);
+  auto mul_2 = ops::Mul(s.WithOpName("mul_2"), sub_2, scale);
+  // The mean broadcasts along the height, so the pattern must not match.
+  auto mean_3 = ops::Const(s.WithOpName("mean_3"), 0.5f, {224, 1, 1});
+  auto resize_3 = ops::ResizeBilinear(s.WithOpName("resize_3"), images, size);
+  auto sub_3 = ops::Sub(s.WithOpName("sub_3"), resize_3, mean_3);
+  auto mul_3 = ops::Mul(s.WithOpName("mul_3"), sub_3, scale);
+  auto fetch_1 = ops::Identity(s.WithOpName("fetch_1"), cast_1);
+  auto fetch_2 = ops::Identity(s.WithOpName("fetch_2"), mul_2);
+  auto fetch_3 = ops::Identity(s.WithOpName("fetch_3"), mul_3);
+
+  GrapplerItem item;
+  item.fetch = {"fetch_1", "fetch_2", "fetch_3"};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE(node.name(), "resize_1");
+    EXPECT_NE(node.name(), "transpose_1");
+    EXPECT_NE(node.name(), "resize_2");
+    if (node.name() == "cast_1") {
+      EXPECT_EQ(node.op(), "_FusedImagePreprocess");
+      ASSERT_EQ(node.input_size(), 4);
+      EXPECT_EQ(node.input(0), "images");
+      EXPECT_EQ(node.input(1), "size");
+      EXPECT_EQ(node.input(2), "mean");
+      EXPECT_EQ(node.input(3), "scale");
+      EXPECT_EQ(node.attr().at("T").type(), DT_UINT8);
+      EXPECT_EQ(node.attr().at("out_type").type(), DT_BFLOAT16);
+      EXPECT_EQ(node.attr().at("data_format").s(), "NCHW");
+      EXPECT_TRUE(node.attr().at("half_pixel_centers").b());
+      found++;
+    } else if (node.name() == "mul_2") {
+      EXPECT_EQ(node.op(), "_FusedImagePreprocess");
+      EXPECT_EQ(node.attr().at("out_type").type(), DT_FLOAT);
+      EXPECT_EQ(node.attr().at("data_format").s(), "NHWC");
+      found++;
+    } else if (node.name() == "mul_3") {
+      EXPECT_EQ(node.op(), "Mul");
+      found++;
+    }
+  }
+  EXPECT_EQ(found, 3);
+}
+
+TEST_F(RemapperTest, GroupResourceApplyAdam) {
+  using ::tensorflow::ops::Placeholder;
+
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  auto beta1_power = ops::Const(s.WithOpName("beta1_power"), 0.9f);
+  auto beta2_power = ops::Const(s.WithOpName("beta2_power"), 0.999f);
+  auto lr = ops::Const(s.WithOpName("lr"), 0.01f);
+  auto other_lr = ops::Const(s.WithOpName("other_lr"), 0.1f);
+  auto beta1 = ops::Const(s.WithOpName("beta1"), 0.9f);
+  auto beta2 = ops::Const(s.WithOpName("beta2"), 0.999f);
+  auto epsilon = ops::Const(s.WithOpName("epsilon"), 1e-7f);
+
+  std::vector<Operation> apply_ops;
+  for (const string& name : {"a", "b", "c"}) {
+    auto var = ops::VarHandleOp(s.WithOpName("var_" + name), DT_FLOAT, {4});
+    auto m = ops::VarHandleOp(s.WithOpName("m_" + name), DT_FLOAT, {4});
+    auto v = ops::VarHandleOp(s.WithOpName("v_" + name), DT_FLOAT, {4});
+    auto grad = Placeholder(s.WithOpName("grad_" + name), DT_FLOAT,
+                            ops::Placeholder::Shape({4}));
+    // Variable c uses a different learning rate, so it is not grouped.
+    auto apply = ops::ResourceApplyAdam(
+        s.WithOpName("apply_" + name), var, m, v, beta1_power, beta2_power,
+        name == "c" ? other_lr : lr, beta1, beta2, epsilon, grad);
+    apply_ops.push_back(apply.operation);
+  }
+  auto train = ops::NoOp(s.WithOpName("train").WithControlDependencies(
+      {apply_ops[0], apply_ops[1], apply_ops[2]}));
+
+  GrapplerItem item;
+  item.fetch = {"train"};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE(node.name(), "apply_a");
+    EXPECT_NE(node.name(), "apply_b");
+    if (node.name() == "MultiTensorApplyAdam/apply_a") {
+      EXPECT_EQ(node.op(), "_MultiTensorResourceApplyAdam");
+      ASSERT_EQ(node.input_size(), 14);
+      EXPECT_EQ(node.input(0), "var_a");
+      EXPECT_EQ(node.input(1), "var_b");
+      EXPECT_EQ(node.input(2), "m_a");
+      EXPECT_EQ(node.input(3), "m_b");
+      EXPECT_EQ(node.input(4), "v_a");
+      EXPECT_EQ(node.input(5), "v_b");
+      EXPECT_EQ(node.input(8), "lr");
+      EXPECT_EQ(node.input(12), "grad_a");
+      EXPECT_EQ(node.input(13), "grad_b");
+      EXPECT_EQ(node.attr().at("N").i(), 2);
+      EXPECT_EQ(node.attr().at("T").type(), DT_FLOAT);
+      found++;
+    } else if (node.name() == "apply_c") {
+      EXPECT_EQ(node.op(), "ResourceApplyAdam");
+      found++;
+    } else if (node.name() == "train") {
+      EXPECT_THAT(node.input(), ::testing::UnorderedElementsAre(
+                                    "^apply_c",
+                                    "^MultiTensorApplyAdam/apply_a"));
+      found++;
+    }
+  }
+  EXPECT_EQ(found, 3);
+}
+
 class RemapperFuseMatMulWithBiasTest : public RemapperTest {
  public:
   template <DataType DTYPE>
@@ -512,9 +512,8 @@ class UnaryElementwiseRewriter : public ScopedAllocatorOptimizer::Rewriter {
   // the output tensors of the input node set.
   Status ConstructScopedAllocatorNode(
       ScopedAllocatorOptimizer* sa_opti, GraphDef* graph, NodeMap* node_map,
-      const std::vector<NodeDef*>& ops, const string& device_name,
-      DataType dtype, int sa_id, const string& sa_name,
-      const std::vector<TensorShape>& input_shapes,
+      const string& device_name, DataType dtype, int sa_id,
+      const string& sa_name, const std::vector<TensorShape>& input_shapes,
       const std::vector<InputDesc>& inputs, const TensorShape& sa_shape) {
     VLOG(2) << "ConstructScopedAllocatorNode " << sa_name;
     NodeDefBuilder sa_builder(sa_name, "_ScopedAllocator");
@@ -524,7 +523,8 @@ class UnaryElementwiseRewriter : public ScopedAllocatorOptimizer::Rewriter {
     sa_builder.Attr("id", sa_id);
     sa_builder.Attr("shapes", input_shapes);
     sa_builder.Attr("shape", sa_shape);
-    sa_builder.Attr("expected_call_count", static_cast<int64_t>(ops.size()));
+    sa_builder.Attr("expected_call_count",
+                    static_cast<int64_t>(inputs.size()));
     NodeDef* sa_node = graph->add_node();
     LOG_WARNING_AND_RETURN_IF_ERROR(sa_builder.Finalize(sa_node));
     node_map->AddNode(sa_name, sa_node);
@@ -855,7 +855,7 @@ class UnaryElementwiseRewriter : public ScopedAllocatorOptimizer::Rewriter {
     string sa_name =
         strings::StrCat("scoped_allocator_", sa_id, "_", invocation_count);
     TF_RETURN_IF_ERROR(ConstructScopedAllocatorNode(
-        sa_opti, graph, node_map, ops, device_name, dtype, sa_id, sa_name,
+        sa_opti, graph, node_map, device_name, dtype, sa_id, sa_name,
         input_shapes, inputs, sa_shape));
 
     // Build a ScopedAllocatorConcat below all of the input nodes.
@@ -889,22 +889,216 @@ class UnaryElementwiseRewriter : public ScopedAllocatorOptimizer::Rewriter {
   }
 };
 
+// Rewrites a Concat or ConcatV2 op whose inputs are laid out back to back in
+// its output, i.e. are concatenated along their outermost non-trivial
+// dimension, so that the producers of the inputs allocate them directly in the
+// output buffer.  The concat op is replaced by a _ScopedAllocatorConcat, which
+// outputs the buffer without copying.
+//
+// Concat ops that cannot be rewritten are left untouched, instead of failing
+// the whole optimization.
+class ConcatRewriter : public UnaryElementwiseRewriter {
+ public:
+  ~ConcatRewriter() override {}
+
+  bool RewritesIndividualOps() const override { return true; }
+
+  Status Rewrite(ScopedAllocatorOptimizer* sa_opti, int64_t invocation_count,
+                 GraphDef* graph, const string& op_name,
+                 const std::vector<NodeDef*>& ops, bool* applied) override {
+    NodeMap* node_map = sa_opti->node_map();
+    for (NodeDef* concat : ops) {
+      DataType dtype;
+      std::vector<InputDesc> inputs;
+      std::vector<TensorShape> input_shapes;
+      TensorShape output_shape;
+      if (!CanAllocateInputsInOutput(node_map, concat, &dtype, &inputs,
+                                     &input_shapes, &output_shape)) {
+        VLOG(2) << "Not rewriting " << concat->name();
+        continue;
+      }
+      VLOG(1) << "ConcatRewriter::Rewrite " << concat->name();
+      const int sa_id = sa_opti->NewScopedAllocatorId(inputs.size());
+      const string sa_name =
+          strings::StrCat("scoped_allocator_", sa_id, "_", invocation_count);
+      const TensorShape sa_shape({output_shape.num_elements()});
+      TF_RETURN_IF_ERROR(ConstructScopedAllocatorNode(
+          sa_opti, graph, node_map, concat->device(), dtype, sa_id, sa_name,
+          input_shapes, inputs, sa_shape));
+
+      // Replace the concat, keeping its name so that its fanout is unchanged.
+      const string axis_name =
+          NodeName(concat->input(concat->op() == "Concat" ? 0 : inputs.size()));
+      std::vector<NodeDefBuilder::NodeOut> sac_inputs;
+      for (const InputDesc& input : inputs) {
+        sac_inputs.emplace_back(input.from_node_def->name(), input.output_slot,
+                                dtype);
+      }
+      std::vector<string> control_inputs;
+      for (const string& input : concat->input()) {
+        if (IsControlInput(input)) control_inputs.push_back(input);
+      }
+      NodeDefBuilder sac_builder(concat->name(), "_ScopedAllocatorConcat");
+      sac_builder.Device(concat->device());
+      sac_builder.Attr("sa_name", sa_name);
+      sac_builder.Attr("id", sa_id);
+      sac_builder.Attr("T", dtype);
+      sac_builder.Attr("shape", output_shape);
+      sac_builder.Attr("reshape", true);
+      sac_builder.Attr("N", static_cast<int>(sac_inputs.size()));
+      sac_builder.Input(NodeDefBuilder::NodeOut(sa_name, 0, dtype));
+      sac_builder.Input(sac_inputs);
+      NodeDef sac_node;
+      LOG_WARNING_AND_RETURN_IF_ERROR(sac_builder.Finalize(&sac_node));
+      for (const string& control_input : control_inputs) {
+        sac_node.add_input(control_input);
+      }
+      node_map->RemoveOutput(axis_name, concat->name());
+      *concat = std::move(sac_node);
+      node_map->AddOutput(sa_name, concat->name());
+      *applied = true;
+    }
+    return OkStatus();
+  }
+
+ private:
+  // Returns true if the data inputs of `concat` can be allocated in its output
+  // buffer, and populates the type and shapes of the inputs and the output.
+  bool CanAllocateInputsInOutput(NodeMap* node_map, NodeDef* concat,
+                                 DataType* dtype,
+                                 std::vector<InputDesc>* inputs,
+                                 std::vector<TensorShape>* input_shapes,
+                                 TensorShape* output_shape) {
+    int num_inputs;
+    if (!GetNodeAttr(*concat, "N", &num_inputs).ok() ||
+        !GetNodeAttr(*concat, "T", dtype).ok() || num_inputs < 2 ||
+        concat->device().empty() || DataTypeSize(*dtype) == 0 ||
+        NumNonControlInputs(*concat) != num_inputs + 1) {
+      return false;
+    }
+    const bool axis_first = concat->op() == "Concat";
+    const int first_input = axis_first ? 1 : 0;
+    const NodeDef* axis_node =
+        node_map->GetNode(concat->input(axis_first ? 0 : num_inputs));
+    Tensor axis_tensor;
+    if (axis_node == nullptr || !IsConstant(*axis_node) ||
+        !axis_tensor.FromProto(axis_node->attr().at("value").tensor()) ||
+        axis_tensor.NumElements() != 1) {
+      return false;
+    }
+    int64_t axis = axis_tensor.dtype() == DT_INT32
+                       ? axis_tensor.flat<int32>()(0)
+                       : axis_tensor.flat<int64_t>()(0);
+
+    if (!graph_properties_->HasOutputProperties(concat->name())) return false;
+    const auto& output_props =
+        graph_properties_->GetOutputProperties(concat->name());
+    if (output_props.size() != 1 ||
+        !TensorShape::IsValid(output_props[0].shape()) ||
+        output_props[0].shape().unknown_rank()) {
+      return false;
+    }
+    *output_shape = TensorShape(output_props[0].shape());
+    const int rank = output_shape->dims();
+    if (axis < 0) axis += rank;
+    if (axis < 0 || axis >= rank) return false;
+
+    absl::flat_hash_set<string> seen_inputs;
+    for (int i = first_input; i < first_input + num_inputs; ++i) {
+      const string& input_name = concat->input(i);
+      int output_slot = 0;
+      ParseNodeName(input_name, &output_slot);
+      NodeDef* producer = node_map->GetNode(input_name);
+      // Each tensor is a separate field of the buffer, and must be allocated
+      // by an op that honors the AllocatorAttributes set by the executor.
+      if (producer == nullptr || IsConstant(*producer) || IsExit(*producer) ||
+          IsArg(*producer) || producer->device() != concat->device() ||
+          !seen_inputs.insert(strings::StrCat(producer->name(), ":",
+                                              output_slot))
+               .second ||
+          IsScopedAllocated(*producer, output_slot) ||
+          HasOtherConsumers(node_map, *producer, input_name, *concat) ||
+          !graph_properties_->HasOutputProperties(producer->name())) {
+        return false;
+      }
+      const auto& props =
+          graph_properties_->GetOutputProperties(producer->name());
+      if (output_slot >= static_cast<int>(props.size()) ||
+          props[output_slot].dtype() != *dtype ||
+          !TensorShape::IsValid(props[output_slot].shape()) ||
+          props[output_slot].shape().unknown_rank()) {
+        return false;
+      }
+      TensorShape shape(props[output_slot].shape());
+      if (shape.dims() != rank || shape.num_elements() == 0) return false;
+      // The inputs are contiguous in the output only if all the dimensions
+      // before the concat axis are trivial.
+      for (int d = 0; d < axis; ++d) {
+        if (shape.dim_size(d) != 1) return false;
+      }
+      // Every field but the last is followed by padding up to the allocator
+      // alignment, which would end up in the middle of the output.
+      if (shape.num_elements() * DataTypeSize(*dtype) %
+              Allocator::kAllocatorAlignment !=
+          0) {
+        return false;
+      }
+      inputs->emplace_back(producer, output_slot, concat);
+      input_shapes->push_back(shape);
+    }
+    return true;
+  }
+
+  // Returns true if output `output_slot` of `node` is already allocated by a
+  // ScopedAllocator.
+  static bool IsScopedAllocated(const NodeDef& node, int output_slot) {
+    std::vector<int32> scope_ids;
+    if (!GetNodeAttr(node, kScopedAllocatorAttrName, &scope_ids).ok()) {
+      return false;
+    }
+    for (int i = 0; i + 1 < static_cast<int>(scope_ids.size()); i += 2) {
+      if (scope_ids[i] == output_slot) return true;
+    }
+    return false;
+  }
+
+  // Returns true if `tensor`, produced by `producer`, is read by a node other
+  // than `concat`.  Such a tensor may be needed by another rewrite, which
+  // would conflict on the allocation of the tensor.
+  static bool HasOtherConsumers(NodeMap* node_map, const NodeDef& producer,
+                                const string& tensor, const NodeDef& concat) {
+    const TensorId tensor_id = ParseTensorName(tensor);
+    for (const NodeDef* consumer : node_map->GetOutputs(producer.name())) {
+      if (consumer == &concat) continue;
+      for (const string& input : consumer->input()) {
+        if (ParseTensorName(input) == tensor_id) return true;
+      }
+    }
+    return false;
+  }
+};
+
 ScopedAllocatorOptimizer::ScopedAllocatorOptimizer(
     RewriterConfig::Toggle opt_level, const ScopedAllocatorOptions& opts)
     : opt_level_(opt_level) {
   VLOG(1) << "ScopedAllocatorOptimizer::ScopedAllocatorOptimizer";
   Rewriter* r = new UnaryElementwiseRewriter();
   to_delete_.push_back(r);
+  Rewriter* concat_rewriter = new ConcatRewriter();
+  to_delete_.push_back(concat_rewriter);
+  auto add_op = [this, r, concat_rewriter](const string& op_name) {
+    op_name_set_.insert(op_name);
+    rewriters_[op_name] =
+        op_name == "Concat" || op_name == "ConcatV2" ? concat_rewriter : r;
+  };
   if (opts.enable_op_size() == 0) {
     // Opts handled by default:
-    for (const auto& op_name : {"CollectiveReduce"}) {
-      op_name_set_.insert(op_name);
-      rewriters_[op_name] = r;
+    for (const auto& op_name : {"CollectiveReduce", "Concat", "ConcatV2"}) {
+      add_op(op_name);
     }
   } else {
     for (const auto& op_name : opts.enable_op()) {
-      op_name_set_.insert(op_name);
-      rewriters_[op_name] = r;
+      add_op(op_name);
     }
   }
 }
@@ -1110,6 +1304,15 @@ Status ScopedAllocatorOptimizer::ProcessGraphDef(
           continue;
         }
         rewriter->SetGraphProperties(graph_properties);
+        if (rewriter->RewritesIndividualOps()) {
+          bool applied = false;
+          status = rewriter->Rewrite(this, invocation_count, graph, op_name,
+                                     it.second, &applied);
+          if (!status.ok()) {
+            break;
+          }
+          continue;
+        }
         std::unique_ptr<Tree> root(ComputeScopeTree(it.first, it.second));
         // Record outputs that are inputs to multiple Tree nodes.
         absl::flat_hash_set<string> seen_outputs;
@@ -1175,6 +1378,16 @@ struct InstanceKeyLess {
   }
 };
 
+struct SharedNameLess {
+  bool operator()(const NodeDef* a, const NodeDef* b) const {
+    string a_name;
+    string b_name;
+    TF_CHECK_OK(GetNodeAttr(*a, "shared_name", &a_name));
+    TF_CHECK_OK(GetNodeAttr(*b, "shared_name", &b_name));
+    return a_name < b_name;
+  }
+};
+
 struct NameLess {
   bool operator()(const NodeDef* a, const NodeDef* b) const {
     return a->name() < b->name();
@@ -1197,10 +1410,13 @@ Status ScopedAllocatorOptimizer::OrderNodeSet(
     std::vector<NodeDef*>* nodes) const {
   // Nodes should be identical type.  Default order is by name but for
   // collectives we order by increasing instance_key so each group gets
-  // the same instance_key.
+  // the same instance_key.  Likewise NCCL all-reduces are ordered by
+  // shared_name, which pairs up the merged ops across devices.
   if (nodes->size() <= 1) return OkStatus();
   if (IsCollectiveNode(*nodes->at(0))) {
     std::sort(nodes->begin(), nodes->end(), InstanceKeyLess());
+  } else if (nodes->at(0)->op() == "NcclAllReduce") {
+    std::sort(nodes->begin(), nodes->end(), SharedNameLess());
   } else {
     std::sort(nodes->begin(), nodes->end(), NameLess());
   }
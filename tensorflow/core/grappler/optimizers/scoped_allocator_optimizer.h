@@ -93,6 +93,11 @@ class ScopedAllocatorOptimizer : public GraphOptimizer {
                            const std::vector<NodeDef*>& nodes,
                            bool* applied) = 0;
 
+    // Returns true if the rewriter handles each op instance on its own, in
+    // which case Rewrite is called once with all the instances on a device,
+    // rather than once per group of logically parallel instances.
+    virtual bool RewritesIndividualOps() const { return false; }
+
     void SetGraphProperties(const GraphProperties& graph_properties) {
       graph_properties_ = &graph_properties;
       CHECK(graph_properties_);
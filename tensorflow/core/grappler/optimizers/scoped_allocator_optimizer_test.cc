@@ -267,6 +267,37 @@ class ScopedAllocatorOptimizerTest : public ::testing::Test {
     TF_CHECK_OK(s.ToGraphDef(graph_def));
   }
 
+  // Constructs the following graph, in which s1 and s2 have shape [2, cols].
+  //
+  // The intended optimization is to have s1 and s2 allocate from a new
+  // ScopedAllocator, whose backing tensor is the output of concat.
+  /*
+        a    b    c
+         \  / \  /
+          s1   s2
+           \  /
+          concat
+            |
+            o
+  */
+  void BuildConcatGraph(GraphDef* graph_def, int cols) {
+    Scope s = Scope::NewRootScope();
+    s = s.WithDevice("/job:localhost/replica:0/task:0/device:CPU:0");
+
+    std::vector<float> values(2 * cols);
+    for (int i = 0; i < 2 * cols; ++i) values[i] = i;
+    Output a = ops::Const<float>(s.WithOpName("a"), values, {2, cols});
+    for (float& value : values) value *= -2;
+    Output b = ops::Const<float>(s.WithOpName("b"), values, {2, cols});
+    for (float& value : values) value += 1;
+    Output c = ops::Const<float>(s.WithOpName("c"), values, {2, cols});
+    Output s1 = ops::Add(s.WithOpName("s1"), a, b);
+    Output s2 = ops::Add(s.WithOpName("s2"), b, c);
+    Output concat = ops::Concat(s.WithOpName("concat"), {s1, s2}, 0);
+    Output o = ops::Identity(s.WithOpName("o"), concat);
+    TF_CHECK_OK(s.ToGraphDef(graph_def));
+  }
+
   void SetShapes(GraphDef* graph_def) {
     TensorShapeProto shape_proto;
     shape_proto.add_dim()->set_size(2);
@@ -283,7 +314,8 @@ class ScopedAllocatorOptimizerTest : public ::testing::Test {
   // returns the outputs specified by `output_names` in `outputs`.
   void ExecuteGraph(const GraphDef& graph_def,
                     const std::vector<string>& output_names,
-                    std::vector<Tensor>* outputs) {
+                    std::vector<Tensor>* outputs,
+                    const string& enable_op = "Abs") {
     // Turn off all optimization except the ScopedAllocatorOptimizer
     // to avoid anything that would alter the expected graph input/output,
     // e.g. by constant folding away all calculations.
@@ -297,7 +329,7 @@ class ScopedAllocatorOptimizerTest : public ::testing::Test {
     RewriterConfig* rwcfg = gopt->mutable_rewrite_options();
     rwcfg->clear_optimizers();
     (*rwcfg->add_optimizers()) = "scoped_allocator";
-    rwcfg->mutable_scoped_allocator_opts()->add_enable_op("Abs");
+    rwcfg->mutable_scoped_allocator_opts()->add_enable_op(enable_op);
     std::unique_ptr<Session> session(CreateSession(graph_def, config));
 
     std::vector<std::pair<string, Tensor>> inputs;
@@ -596,6 +628,60 @@ TEST_F(ScopedAllocatorOptimizerTest, ConstInput) {
   }
   EXPECT_EQ(num_identity_ops, 2);
 }
+
+// Test that the inputs of a concat along its outermost dimension are allocated
+// in the output of the concat, which no longer copies them.
+TEST_F(ScopedAllocatorOptimizerTest, ConcatRewriteOnly) {
+  GrapplerItem item;
+  BuildConcatGraph(&item.graph, /*cols=*/8);
+
+  ScopedAllocatorOptions opts;
+  opts.add_enable_op("ConcatV2");
+  ScopedAllocatorOptimizer sao(RewriterConfig::ON, opts);
+  GraphDef optimized_graph;
+  TF_ASSERT_OK(sao.Optimize(nullptr /*cluster*/, item, &optimized_graph));
+
+  NodeMap node_map(&optimized_graph);
+  NodeDef* concat = nullptr;
+  GetNode(&node_map, "concat", &concat);
+  EXPECT_EQ(concat->op(), "_ScopedAllocatorConcat");
+  ASSERT_EQ(concat->input_size(), 3);
+  EXPECT_EQ(concat->input(1), "s1");
+  EXPECT_EQ(concat->input(2), "s2");
+  NodeDef* sa_node = nullptr;
+  GetNode(&node_map, concat->input(0), &sa_node);
+  EXPECT_EQ(sa_node->op(), "_ScopedAllocator");
+  EXPECT_EQ(ValidateSAControlInput(&optimized_graph, &node_map, "s1"), sa_node);
+  EXPECT_EQ(ValidateSAControlInput(&optimized_graph, &node_map, "s2"), sa_node);
+}
+
+TEST_F(ScopedAllocatorOptimizerTest, ConcatExecute) {
+  GraphDef graph_def;
+  BuildConcatGraph(&graph_def, /*cols=*/8);
+  const std::vector<Tensor> expected = EvaluateNodes(graph_def, {"o:0"});
+  std::vector<Tensor> outputs;
+  ExecuteGraph(graph_def, /*output_names=*/{"o:0"}, &outputs,
+               /*enable_op=*/"ConcatV2");
+  test::ExpectTensorEqual<float>(expected[0], outputs[0]);
+}
+
+// Test that a concat is left untouched when the alignment of its inputs in a
+// ScopedAllocator would leave padding between them.
+TEST_F(ScopedAllocatorOptimizerTest, ConcatUnalignedInputs) {
+  GrapplerItem item;
+  BuildConcatGraph(&item.graph, /*cols=*/3);
+
+  ScopedAllocatorOptions opts;
+  opts.add_enable_op("ConcatV2");
+  ScopedAllocatorOptimizer sao(RewriterConfig::ON, opts);
+  GraphDef optimized_graph;
+  TF_ASSERT_OK(sao.Optimize(nullptr /*cluster*/, item, &optimized_graph));
+
+  for (const NodeDef& node : optimized_graph.node()) {
+    EXPECT_NE(node.op(), "_ScopedAllocator");
+    if (node.name() == "concat") EXPECT_EQ(node.op(), "ConcatV2");
+  }
+}
 #endif  // ENABLE_MKL
 
 }  // namespace
@@ -31,6 +31,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/kernels/batching_util/adaptive_shared_batch_scheduler.h"
+#include "tensorflow/core/kernels/batching_util/batch_latency_model.h"
 #include "tensorflow/core/kernels/batching_util/batch_resource_base.h"
 #include "tensorflow/core/kernels/batching_util/bounded_executor.h"
 #include "tensorflow/core/kernels/batching_util/concat_split_util.h"
@@ -54,6 +55,15 @@ constexpr char kMaxInflightBatchesAttr[] = "_max_inflight_batches";
 constexpr char kBatchesToAverageOverAttr[] = "_batches_to_average_over";
 constexpr char kFullBatchSchedulingBoostMicros[] =
     "_full_batch_scheduling_boost_micros";
+constexpr char kEnablePriorityQueueAttr[] = "_enable_priority_queue";
+constexpr char kLowPriorityMaxEnqueuedBatchesAttr[] =
+    "_low_priority_max_enqueued_batches";
+constexpr char kLowPriorityBatchTimeoutMicrosAttr[] =
+    "_low_priority_batch_timeout_micros";
+
+// Values of the `batch_padding_policy` attribute.
+constexpr char kPadUpPaddingPolicy[] = "PAD_UP";
+constexpr char kMinimizeLatencyPaddingPolicy[] = "MINIMIZE_LATENCY";
 
 // Default thread count in the per-process batching thread pool.
 constexpr int64_t kBatchThreadPoolSize = 128;
@@ -156,19 +166,32 @@ class BatchResource : public serving::BatchResourceBase {
                        int32_t max_enqueued_batches,
                        const std::vector<int32>& allowed_batch_sizes,
                        bool enable_large_batch_splitting,
+                       const string& batch_padding_policy,
+                       const BatcherT::QueueOptions::LowPriorityQueueOptions*
+                           low_priority_queue_options,
                        std::unique_ptr<BatchResource>* resource) {
     BatcherT::Options batcher_options;
     batcher_options.num_batch_threads = num_batch_threads;
     std::shared_ptr<BatcherT> batcher;
     TF_RETURN_IF_ERROR(BatcherT::Create(batcher_options, &batcher));
 
-    resource->reset(new BatchResource(
-        has_process_batch_function, std::move(batcher),
-        GetBatcherQueueOptions(
-            num_batch_threads, max_execution_batch_size, batch_timeout_micros,
-            max_enqueued_batches, allowed_batch_sizes,
-            enable_large_batch_splitting, /*disable_padding=*/false),
-        allowed_batch_sizes));
+    BatcherT::QueueOptions batcher_queue_options = GetBatcherQueueOptions(
+        num_batch_threads, max_execution_batch_size, batch_timeout_micros,
+        max_enqueued_batches, allowed_batch_sizes,
+        enable_large_batch_splitting, /*disable_padding=*/false);
+    if (batch_padding_policy == kMinimizeLatencyPaddingPolicy &&
+        !allowed_batch_sizes.empty()) {
+      batcher_queue_options.batch_latency_model =
+          std::make_shared<serving::BatchLatencyModel>(allowed_batch_sizes);
+    }
+    if (low_priority_queue_options != nullptr) {
+      batcher_queue_options.enable_priority_queue = true;
+      batcher_queue_options.low_priority_queue_options =
+          *low_priority_queue_options;
+    }
+    resource->reset(new BatchResource(has_process_batch_function,
+                                      std::move(batcher), batcher_queue_options,
+                                      allowed_batch_sizes));
     return OkStatus();
   }
 
@@ -268,6 +291,18 @@ BatchFunctionKernel::BatchFunctionKernel(OpKernelConstruction* c)
     has_attribute_enable_large_batch_splitting_ = false;
   }
 
+  if (c->HasAttr("batch_padding_policy")) {
+    OP_REQUIRES_OK(c,
+                   c->GetAttr("batch_padding_policy", &batch_padding_policy_));
+  } else {
+    batch_padding_policy_ = kPadUpPaddingPolicy;
+  }
+  OP_REQUIRES(c,
+              batch_padding_policy_ == kPadUpPaddingPolicy ||
+                  batch_padding_policy_ == kMinimizeLatencyPaddingPolicy,
+              errors::InvalidArgument("Unknown batch_padding_policy: ",
+                                      batch_padding_policy_));
+
   // Helper function `SetAdaptiveBatchSchedulerOptions` calls
   // `OP_REQUIRES_OK`, which exits the current function upon error.
   // So validate status of `op-kernel-construction`.
@@ -275,6 +310,10 @@ BatchFunctionKernel::BatchFunctionKernel(OpKernelConstruction* c)
   if (!c->status().ok()) {
     return;
   }
+  SetLowPriorityQueueOptions(c);
+  if (!c->status().ok()) {
+    return;
+  }
 
   if (enable_adaptive_batch_threads_) {
     // One scheduler instance contains a couple of queue instances,
@@ -381,11 +420,26 @@ void BatchFunctionKernel::ComputeAsync(OpKernelContext* c, DoneCallback done) {
   } else {
     creator = [this,
                session_metadata = c->session_metadata()](BatchResource** r) {
+      absl::optional<
+          BatchResource::BatcherT::QueueOptions::LowPriorityQueueOptions>
+          low_priority_queue_options;
+      if (low_priority_queue_options_.has_value()) {
+        low_priority_queue_options.emplace();
+        low_priority_queue_options->max_enqueued_batches =
+            low_priority_queue_options_->max_enqueued_batches;
+        low_priority_queue_options->batch_timeout_micros =
+            low_priority_queue_options_->batch_timeout_micros;
+      }
       std::unique_ptr<BatchResource> new_resource;
       TF_RETURN_IF_ERROR(BatchResource::Create(
           /*has_process_batch_function=*/true, num_batch_threads_,
           max_batch_size_, batch_timeout_micros_, max_enqueued_batches_,
-          allowed_batch_sizes_, enable_large_batch_splitting_, &new_resource));
+          allowed_batch_sizes_, enable_large_batch_splitting_,
+          batch_padding_policy_,
+          low_priority_queue_options.has_value()
+              ? &*low_priority_queue_options
+              : nullptr,
+          &new_resource));
       if (session_metadata) {
         new_resource->set_session_metadata(*session_metadata);
       }
@@ -576,6 +630,40 @@ void BatchFunctionKernel::SetAdaptiveBatchSchedulerOptions(
 
   adaptive_batch_scheduler_options_ = options;
 }
+
+void BatchFunctionKernel::SetLowPriorityQueueOptions(OpKernelConstruction* c) {
+  bool enable_priority_queue = false;
+  if (c->HasAttr(kEnablePriorityQueueAttr)) {
+    OP_REQUIRES_OK(
+        c, c->GetAttr(kEnablePriorityQueueAttr, &enable_priority_queue));
+  }
+  if (!enable_priority_queue) {
+    // low_priority_queue_options_ is nullopt.
+    return;
+  }
+  OP_REQUIRES(c, !enable_adaptive_batch_threads_,
+              errors::InvalidArgument(
+                  kEnablePriorityQueueAttr,
+                  " is not supported with the adaptive batch scheduler."));
+
+  LowPriorityQueueOptions options;
+  if (c->HasAttr(kLowPriorityMaxEnqueuedBatchesAttr)) {
+    OP_REQUIRES_OK(c, c->GetAttr(kLowPriorityMaxEnqueuedBatchesAttr,
+                                 &options.max_enqueued_batches));
+  }
+  if (c->HasAttr(kLowPriorityBatchTimeoutMicrosAttr)) {
+    OP_REQUIRES_OK(c, c->GetAttr(kLowPriorityBatchTimeoutMicrosAttr,
+                                 &options.batch_timeout_micros));
+  }
+  OP_REQUIRES(c,
+              options.max_enqueued_batches > 0 &&
+                  options.batch_timeout_micros >= 0,
+              errors::InvalidArgument(
+                  kLowPriorityMaxEnqueuedBatchesAttr,
+                  " must be positive and ", kLowPriorityBatchTimeoutMicrosAttr,
+                  " must be non-negative."));
+  low_priority_queue_options_ = options;
+}
 REGISTER_KERNEL_BUILDER(Name("BatchFunction").Device(DEVICE_CPU),
                         BatchFunctionKernel);
 // Currently all inputs and outputs are on the host.
@@ -621,7 +709,8 @@ class BatchKernel : public AsyncOpKernel {
       TF_RETURN_IF_ERROR(BatchResource::Create(
           /*has_process_batch_function=*/false, num_batch_threads_,
           max_batch_size_, batch_timeout_micros_, max_enqueued_batches_,
-          allowed_batch_sizes_, false, &new_resource));
+          allowed_batch_sizes_, false, kPadUpPaddingPolicy,
+          /*low_priority_queue_options=*/nullptr, &new_resource));
       *r = new_resource.release();
       return OkStatus();
     };
@@ -81,6 +81,13 @@ class BatchFunctionKernel : public AsyncOpKernel {
   //   Read from corresponding attributes as long as they are set.
   void SetAdaptiveBatchSchedulerOptions(OpKernelConstruction* c,
                                         int32_t num_batch_threads);
+
+  // Initialize vars by reading from op-kernel-construction.
+  // Vars
+  // - low_priority_queue_options_
+  //   Set iff attribute `kEnablePriorityQueueAttr` is true; read from
+  //   corresponding attributes as long as they are set.
+  void SetLowPriorityQueueOptions(OpKernelConstruction* c);
   string container_;
   string shared_name_;
   string batcher_queue_;
@@ -93,6 +100,7 @@ class BatchFunctionKernel : public AsyncOpKernel {
   absl::optional<FunctionLibraryRuntime::Handle> fhandle_ TF_GUARDED_BY(mu_);
   bool enable_large_batch_splitting_;
   bool has_attribute_enable_large_batch_splitting_;
+  string batch_padding_policy_;
   bool enable_adaptive_batch_threads_ = false;
 
   mutex mu_;
@@ -109,6 +117,15 @@ class BatchFunctionKernel : public AsyncOpKernel {
   };
   absl::optional<AdaptiveBatchSchedulerOptions>
       adaptive_batch_scheduler_options_ = absl::nullopt;
+
+  // Parameters of the low priority lane of the batcher queue, which is only
+  // supported by the non-adaptive batch scheduler.
+  struct LowPriorityQueueOptions {
+    int32 max_enqueued_batches = 2;
+    int32 batch_timeout_micros = 0;
+  };
+  absl::optional<LowPriorityQueueOptions> low_priority_queue_options_ =
+      absl::nullopt;
 };
 
 }  // namespace tensorflow
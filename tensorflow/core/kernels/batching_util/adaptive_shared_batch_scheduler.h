@@ -18,6 +18,7 @@ limitations under the License.
 
 #include <algorithm>
 #include <atomic>
+#include <cmath>
 #include <functional>
 #include <memory>
 #include <random>
@@ -132,6 +133,19 @@ class AdaptiveSharedBatchScheduler
     // full_batch_scheduling_boost_micros==zero) for backward compatibility of
     // API.
     bool fifo_scheduling = false;
+
+    // If set, the scheduler tunes itself to keep the 99th percentile latency
+    // of batches (from the creation of a batch to the end of its processing)
+    // under this target while maximizing throughput, instead of minimizing
+    // the average latency. Every `batches_to_average_over` batches it jointly
+    // adjusts in_flight_batches_limit_ and a scale applied to the
+    // `max_batch_size` and `batch_timeout_micros` of all queues:
+    // - Above the target, it allows more batches in flight if batches mostly
+    //   wait to be scheduled, and otherwise forms smaller batches sooner.
+    // - Well below the target, it forms larger batches, and once they are at
+    //   their maximum size, lowers in_flight_batches_limit_ so that batches
+    //   fill up more before being scheduled.
+    absl::optional<int64_t> target_p99_latency_micros = absl::nullopt;
   };
 
   // Ownership is shared between the caller of Create() and any queues created
@@ -185,8 +199,15 @@ class AdaptiveSharedBatchScheduler
     return in_flight_batches_limit_;
   }
 
+  // The scale applied to the batch size and timeout of all queues, which is
+  // only tuned if `Options.target_p99_latency_micros` is set.
+  double batch_size_scale() const {
+    return batch_size_scale_.load(std::memory_order_relaxed);
+  }
+
  private:
-  // access to AddBatch, MaybeScheduleClosedBatches, RemoveQueue, GetEnv.
+  // access to AddBatch, MaybeScheduleClosedBatches, RemoveQueue, GetEnv,
+  // ScaledMaxBatchSize, ScaledBatchTimeoutMicros.
   friend class internal::ASBSQueue<TaskType>;
 
   explicit AdaptiveSharedBatchScheduler(const Options& options);
@@ -214,6 +235,15 @@ class AdaptiveSharedBatchScheduler
 
   void MaybeAdjustInflightLimit() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // Adjusts in_flight_batches_limit_ and batch_size_scale_ towards
+  // `Options.target_p99_latency_micros`.
+  void MaybeAdjustForLatencyTarget() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Returns the batch size and timeout that queues should currently use given
+  // the ones they are configured with.
+  int ScaledMaxBatchSize(int max_batch_size) const;
+  int64_t ScaledBatchTimeoutMicros(int64_t batch_timeout_micros) const;
+
   // Notifies scheduler of non-empty batch which is eligible for processing.
   void AddBatch(const internal::ASBSBatch<TaskType>* batch);
 
@@ -284,6 +314,30 @@ class AdaptiveSharedBatchScheduler
   // Current adjustment size (as a fraction of in_flight_batches_limit_).
   double step_size_multiplier_ TF_GUARDED_BY(mu_) = kMaxStepSizeMultiplier;
 
+  // Fields controlling the adjustments towards target_p99_latency_micros.
+  struct LatencyTargetStats {
+    // Latency of each batch counted by batch_count_.
+    std::vector<int64_t> batch_latencies_micros;
+    // Sum of the time the batches waited to be scheduled.
+    int64_t queueing_delay_sum_micros = 0;
+    // Sum of the time the batches took to process.
+    int64_t processing_latency_sum_micros = 0;
+  };
+  LatencyTargetStats latency_target_stats_ TF_GUARDED_BY(mu_);
+
+  // Scale of the batch size and timeout of all queues, in
+  // [kMinBatchSizeScale, 1]. Read by queues without holding mu_.
+  std::atomic<double> batch_size_scale_{1.0};
+  // Lower bound for batch_size_scale_.
+  constexpr static double kMinBatchSizeScale = 0.0625;  // 1/16
+  // Multiplicative decrease of batch_size_scale_ above the target.
+  constexpr static double kBatchSizeScaleDecrease = 0.75;
+  // Additive increase of batch_size_scale_ well below the target.
+  constexpr static double kBatchSizeScaleIncrease = 0.0625;
+  // Fraction of the target under which the latency is considered to have
+  // room for more throughput.
+  constexpr static double kLatencyTargetHeadroom = 0.8;
+
   TF_DISALLOW_COPY_AND_ASSIGN(AdaptiveSharedBatchScheduler);
 };
 
@@ -377,6 +431,20 @@ constexpr double AdaptiveSharedBatchScheduler<TaskType>::kMaxStepSizeMultiplier;
 template <typename TaskType>
 constexpr double AdaptiveSharedBatchScheduler<TaskType>::kMinStepSizeMultiplier;
 
+template <typename TaskType>
+constexpr double AdaptiveSharedBatchScheduler<TaskType>::kMinBatchSizeScale;
+
+template <typename TaskType>
+constexpr double
+    AdaptiveSharedBatchScheduler<TaskType>::kBatchSizeScaleDecrease;
+
+template <typename TaskType>
+constexpr double
+    AdaptiveSharedBatchScheduler<TaskType>::kBatchSizeScaleIncrease;
+
+template <typename TaskType>
+constexpr double AdaptiveSharedBatchScheduler<TaskType>::kLatencyTargetHeadroom;
+
 template <typename TaskType>
 Status AdaptiveSharedBatchScheduler<TaskType>::Create(
     const Options& options,
@@ -420,6 +488,12 @@ Status AdaptiveSharedBatchScheduler<TaskType>::Create(
         "greater than or equal to 1; was ",
         options.batches_to_average_over);
   }
+  if (options.target_p99_latency_micros.has_value() &&
+      *options.target_p99_latency_micros <= 0) {
+    return errors::InvalidArgument(
+        "target_p99_latency_micros must be positive; was ",
+        *options.target_p99_latency_micros);
+  }
   scheduler->reset(new AdaptiveSharedBatchScheduler<TaskType>(options));
   return OkStatus();
 }
@@ -639,6 +713,7 @@ void AdaptiveSharedBatchScheduler<TaskType>::CallbackWrapper(
       profiler::ContextType::kAdaptiveSharedBatchScheduler,
       batch->traceme_context_id());
   const int64_t start_time = batch->creation_time_micros();
+  const int64_t process_start_time = GetEnv()->NowMicros();
   callback(std::unique_ptr<Batch<TaskType>>(
       const_cast<internal::ASBSBatch<TaskType>*>(batch)));
   int64_t end_time = GetEnv()->NowMicros();
@@ -650,9 +725,18 @@ void AdaptiveSharedBatchScheduler<TaskType>::CallbackWrapper(
   }
   in_flight_batches_--;
   batch_count_++;
-  batch_delay_stats_.batch_latency_sum += end_time - start_time;
-
-  MaybeAdjustInflightLimit();
+  if (options_.target_p99_latency_micros.has_value()) {
+    latency_target_stats_.batch_latencies_micros.push_back(end_time -
+                                                           start_time);
+    latency_target_stats_.queueing_delay_sum_micros +=
+        process_start_time - start_time;
+    latency_target_stats_.processing_latency_sum_micros +=
+        end_time - process_start_time;
+    MaybeAdjustForLatencyTarget();
+  } else {
+    batch_delay_stats_.batch_latency_sum += end_time - start_time;
+    MaybeAdjustInflightLimit();
+  }
 
   MaybeScheduleNextBatch();
 }
@@ -700,6 +784,64 @@ void AdaptiveSharedBatchScheduler<TaskType>::MaybeAdjustInflightLimit() {
   }
 }
 
+template <typename TaskType>
+void AdaptiveSharedBatchScheduler<TaskType>::MaybeAdjustForLatencyTarget() {
+  if (batch_count_ < options_.batches_to_average_over) return;
+  std::vector<int64_t>& latencies =
+      latency_target_stats_.batch_latencies_micros;
+  auto p99_it = latencies.begin() + (latencies.size() * 99 + 99) / 100 - 1;
+  std::nth_element(latencies.begin(), p99_it, latencies.end());
+  const int64_t p99_latency_micros = *p99_it;
+  const int64_t target_micros = *options_.target_p99_latency_micros;
+  const double max_limit = static_cast<double>(options_.num_batch_threads);
+  const double min_limit =
+      static_cast<double>(options_.min_in_flight_batches_limit);
+  double scale = batch_size_scale_.load(std::memory_order_relaxed);
+
+  if (p99_latency_micros > target_micros) {
+    if (latency_target_stats_.queueing_delay_sum_micros >
+            latency_target_stats_.processing_latency_sum_micros &&
+        in_flight_batches_limit_ < max_limit) {
+      // Batches mostly wait for a free slot; process more of them at once.
+      in_flight_batches_limit_ =
+          std::min(max_limit,
+                   in_flight_batches_limit_ * (1 + kMaxStepSizeMultiplier));
+    } else {
+      // Batches take too long to form or to process; make them smaller.
+      scale = std::max(kMinBatchSizeScale, scale * kBatchSizeScaleDecrease);
+    }
+  } else if (p99_latency_micros < target_micros * kLatencyTargetHeadroom) {
+    if (scale < 1) {
+      scale = std::min(1.0, scale + kBatchSizeScaleIncrease);
+    } else {
+      // Open batches keep filling up until they are scheduled, so fewer
+      // batches in flight means larger batches.
+      in_flight_batches_limit_ =
+          std::max(min_limit,
+                   in_flight_batches_limit_ * (1 - kMaxStepSizeMultiplier));
+    }
+  }
+  batch_size_scale_.store(scale, std::memory_order_relaxed);
+
+  batch_count_ = 0;
+  latencies.clear();
+  latency_target_stats_.queueing_delay_sum_micros = 0;
+  latency_target_stats_.processing_latency_sum_micros = 0;
+}
+
+template <typename TaskType>
+int AdaptiveSharedBatchScheduler<TaskType>::ScaledMaxBatchSize(
+    int max_batch_size) const {
+  return std::max(
+      1, static_cast<int>(std::lround(max_batch_size * batch_size_scale())));
+}
+
+template <typename TaskType>
+int64_t AdaptiveSharedBatchScheduler<TaskType>::ScaledBatchTimeoutMicros(
+    int64_t batch_timeout_micros) const {
+  return static_cast<int64_t>(batch_timeout_micros * batch_size_scale());
+}
+
 // ---------------- ASBSQueue ----------------
 
 namespace internal {
@@ -750,10 +892,18 @@ Status ASBSQueue<TaskType>::Schedule(std::unique_ptr<TaskType>* task) {
       return errors::Unavailable("The batch scheduling queue is full");
     }
 
+    // The batch size the scheduler currently wants, at most
+    // `options_.max_batch_size`.
+    const int max_batch_size =
+        scheduler_->ScaledMaxBatchSize(options_.max_batch_size);
+    if (current_batch_ && current_batch_->size() >= max_batch_size) {
+      current_batch_->Close();
+      closed_batch = true;
+      current_batch_ = nullptr;
+    }
     int remaining_batch_size =
-        current_batch_ == nullptr
-            ? options_.max_batch_size
-            : options_.max_batch_size - current_batch_->size();
+        current_batch_ == nullptr ? max_batch_size
+                                  : max_batch_size - current_batch_->size();
     if (options_.split_input_task_func == nullptr ||
         size <= remaining_batch_size) {
       // Either we don't allow task splitting or task fits within the current
@@ -764,13 +914,12 @@ Status ASBSQueue<TaskType>::Schedule(std::unique_ptr<TaskType>* task) {
       // Beyond this point Schedule should not fail, as the caller has been
       // promised that all of the split tasks will be scheduled.
       TF_RETURN_IF_ERROR(options_.split_input_task_func(
-          task, remaining_batch_size, options_.max_batch_size,
-          &tasks_to_schedule));
+          task, remaining_batch_size, max_batch_size, &tasks_to_schedule));
     }
     for (auto& task : tasks_to_schedule) {
       // Can't fit within current batch, close it off and try to create another.
       if (current_batch_ &&
-          current_batch_->size() + task->size() > options_.max_batch_size) {
+          current_batch_->size() + task->size() > max_batch_size) {
         current_batch_->Close();
         closed_batch = true;
         current_batch_ = nullptr;
@@ -783,7 +932,8 @@ Status ASBSQueue<TaskType>::Schedule(std::unique_ptr<TaskType>* task) {
         // are processed in the same batch and should share traceme_context_id.
         current_batch_ = new ASBSBatch<TaskType>(
             this, scheduler_->GetEnv()->NowMicros(),
-            options_.batch_timeout_micros, NewTraceMeContextIdForBatch());
+            scheduler_->ScaledBatchTimeoutMicros(options_.batch_timeout_micros),
+            NewTraceMeContextIdForBatch());
         new_batches.push_back(current_batch_);
       }
 
@@ -803,8 +953,7 @@ Status ASBSQueue<TaskType>::Schedule(std::unique_ptr<TaskType>* task) {
       bool reached_max_tasks =
           (options_.max_tasks_per_batch.has_value() &&
            current_batch_->num_tasks() >= options_.max_tasks_per_batch.value());
-      if (current_batch_->size() == options_.max_batch_size ||
-          reached_max_tasks) {
+      if (current_batch_->size() >= max_batch_size || reached_max_tasks) {
         current_batch_->Close();
         closed_batch = true;
         current_batch_ = nullptr;
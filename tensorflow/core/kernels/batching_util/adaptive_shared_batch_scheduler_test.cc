@@ -95,6 +95,9 @@ TEST(AdaptiveSharedBatchSchedulerTest, BadOptions) {
   options.min_in_flight_batches_limit = 2;
   options.num_batch_threads = 3;
   EXPECT_FALSE(Scheduler::Create(options, &scheduler).ok());
+  options = Scheduler::Options();
+  options.target_p99_latency_micros = 0;
+  EXPECT_FALSE(Scheduler::Create(options, &scheduler).ok());
 }
 
 TEST(AdaptiveSharedBatchSchedulerTest, InFlightBatchesLimit) {
@@ -199,6 +202,83 @@ TEST(AdaptiveSharedBatchSchedulerTest, InFlightBatchesLimitTuning) {
   stop_teardown.Notify();
 }
 
+TEST(AdaptiveSharedBatchSchedulerTest, LatencyTargetTuning) {
+  test_util::FakeClockEnv env(Env::Default());
+  Notification start_teardown, stop_teardown;
+  std::unique_ptr<Thread> teardown_thread =
+      CreateFakeClockAdvancerThread(&env, &start_teardown, &stop_teardown);
+  {
+    AdaptiveSharedBatchScheduler<FakeTask>::Options options;
+    options.env = &env;
+    options.num_batch_threads = 4;
+    options.initial_in_flight_batches_limit = 1;
+    options.batches_to_average_over = 1;
+    options.target_p99_latency_micros = 1000;
+    mutex mu;
+    std::vector<size_t> batch_sizes;
+    // Processing time is proportional to the batch size.
+    auto queue_callback = [&](std::unique_ptr<Batch<FakeTask>> batch) {
+      ASSERT_TRUE(batch->IsClosed());
+      env.AdvanceByMicroseconds(100 * batch->size());
+      mutex_lock l(mu);
+      batch_sizes.push_back(batch->size());
+    };
+    auto num_batches = [&] {
+      mutex_lock l(mu);
+      return batch_sizes.size();
+    };
+    std::shared_ptr<AdaptiveSharedBatchScheduler<FakeTask>> scheduler;
+    TF_ASSERT_OK(
+        AdaptiveSharedBatchScheduler<FakeTask>::Create(options, &scheduler));
+    AdaptiveSharedBatchScheduler<FakeTask>::QueueOptions queue_options;
+    queue_options.max_batch_size = 20;
+    queue_options.split_input_task_func =
+        [](std::unique_ptr<FakeTask>* input_task, int first_size,
+           int max_batch_size,
+           std::vector<std::unique_ptr<FakeTask>>* output_tasks) {
+          int remaining_size = (*input_task)->size();
+          for (int size = first_size; remaining_size > 0;
+               size = max_batch_size) {
+            size = std::min(size, remaining_size);
+            output_tasks->push_back(std::make_unique<FakeTask>(size));
+            remaining_size -= size;
+          }
+          return OkStatus();
+        };
+    std::unique_ptr<BatchScheduler<FakeTask>> queue;
+    TF_ASSERT_OK(scheduler->AddQueue(queue_options, queue_callback, &queue));
+
+    // A full batch takes 2000us, above the target; since it did not wait to
+    // be scheduled, batches get smaller.
+    TF_ASSERT_OK(ScheduleTask(20, queue.get()));
+    while (scheduler->batch_size_scale() == 1) {
+    }
+    EXPECT_EQ(scheduler->batch_size_scale(), 0.75);
+    EXPECT_EQ(scheduler->in_flight_batches_limit(), 1);
+
+    // Batches are now limited to 15 tasks.
+    TF_ASSERT_OK(ScheduleTask(20, queue.get()));
+    while (num_batches() < 3) {
+    }
+    {
+      mutex_lock l(mu);
+      EXPECT_EQ(batch_sizes[1], 15);
+      EXPECT_EQ(batch_sizes[2], 5);
+    }
+
+    // A small batch is well below the target, so batches get larger again.
+    while (queue->NumEnqueuedTasks() > 0) {
+    }
+    double batch_size_scale = scheduler->batch_size_scale();
+    TF_ASSERT_OK(ScheduleTask(1, queue.get()));
+    while (scheduler->batch_size_scale() == batch_size_scale) {
+    }
+    EXPECT_GT(scheduler->batch_size_scale(), batch_size_scale);
+    start_teardown.Notify();
+  }
+  stop_teardown.Notify();
+}
+
 TEST(AdaptiveSharedBatchSchedulerTest, FullBatchSchedulingBoostMicros) {
   test_util::FakeClockEnv env(Env::Default());
   Notification start_teardown, stop_teardown;
@@ -0,0 +1,108 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/batching_util/batch_latency_model.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace serving {
+namespace {
+
+// Weight of a new latency sample in the moving average, so that the model
+// follows changes in load or hardware within a few tens of batches.
+constexpr double kLatencySmoothing = 0.1;
+
+}  // namespace
+
+BatchLatencyModel::BatchLatencyModel(std::vector<int32> allowed_batch_sizes)
+    : allowed_batch_sizes_(std::move(allowed_batch_sizes)),
+      latencies_(allowed_batch_sizes_.size(), absl::Microseconds(-1)) {
+  DCHECK(!allowed_batch_sizes_.empty());
+  DCHECK(std::is_sorted(allowed_batch_sizes_.begin(),
+                        allowed_batch_sizes_.end()));
+}
+
+int BatchLatencyModel::BucketIndex(int batch_size) const {
+  const auto it = std::lower_bound(allowed_batch_sizes_.begin(),
+                                   allowed_batch_sizes_.end(), batch_size);
+  if (it == allowed_batch_sizes_.end()) return -1;
+  return it - allowed_batch_sizes_.begin();
+}
+
+void BatchLatencyModel::RecordLatency(int batch_size,
+                                      absl::Duration latency) {
+  const int bucket = BucketIndex(batch_size);
+  if (bucket < 0 || allowed_batch_sizes_[bucket] != batch_size) return;
+  mutex_lock l(mu_);
+  absl::Duration& average = latencies_[bucket];
+  if (average < absl::ZeroDuration()) {
+    average = latency;
+  } else {
+    average += (latency - average) * kLatencySmoothing;
+  }
+}
+
+absl::optional<absl::Duration> BatchLatencyModel::GetLatency(
+    int batch_size) const {
+  mutex_lock l(mu_);
+  return GetLatencyLocked(batch_size);
+}
+
+absl::optional<absl::Duration> BatchLatencyModel::GetLatencyLocked(
+    int batch_size) const {
+  const int bucket = BucketIndex(batch_size);
+  if (bucket < 0 || latencies_[bucket] < absl::ZeroDuration()) {
+    return absl::nullopt;
+  }
+  return latencies_[bucket];
+}
+
+int BatchLatencyModel::GetBatchSizeToProcess(int batch_size,
+                                             int next_batch_size,
+                                             absl::Duration wait_time) const {
+  mutex_lock l(mu_);
+  const absl::optional<absl::Duration> padded_latency =
+      GetLatencyLocked(batch_size);
+  if (!padded_latency.has_value()) return batch_size;
+
+  // Total latency over the requests of the batch, in request-microseconds.
+  int best_batch_size = batch_size;
+  double best_cost =
+      batch_size * absl::ToDoubleMicroseconds(*padded_latency);
+  for (const int32 smaller_size : allowed_batch_sizes_) {
+    if (smaller_size >= batch_size) break;
+    const int remaining = batch_size - smaller_size;
+    const absl::optional<absl::Duration> smaller_latency =
+        GetLatencyLocked(smaller_size);
+    const absl::optional<absl::Duration> next_latency =
+        GetLatencyLocked(remaining + next_batch_size);
+    if (!smaller_latency.has_value() || !next_latency.has_value()) continue;
+    const double cost =
+        smaller_size * absl::ToDoubleMicroseconds(*smaller_latency) +
+        remaining * absl::ToDoubleMicroseconds(wait_time + *next_latency);
+    if (cost < best_cost) {
+      best_cost = cost;
+      best_batch_size = smaller_size;
+    }
+  }
+  return best_batch_size;
+}
+
+}  // namespace serving
+}  // namespace tensorflow
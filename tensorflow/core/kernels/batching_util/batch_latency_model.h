@@ -0,0 +1,89 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_BATCH_LATENCY_MODEL_H_
+#define TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_BATCH_LATENCY_MODEL_H_
+
+#include <vector>
+
+#include "absl/time/time.h"
+#include "absl/types/optional.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace serving {
+
+// Learns online how long a batch takes to process for each allowed batch
+// size, and uses it to decide how much of a formed batch to process.
+//
+// Padding a batch up to the next allowed size wastes the compute spent on the
+// padding, which can be a large part of the batch when allowed sizes are far
+// apart. Instead, the tasks above a smaller allowed size can be left in the
+// queue, where they wait for more work to form the next batch. The model picks
+// whichever of the two gives the lowest total latency over the requests of the
+// batch, given the latencies learned so far.
+//
+// Thread-safe.
+class BatchLatencyModel {
+ public:
+  // `allowed_batch_sizes` must be non-empty and increasing.
+  explicit BatchLatencyModel(std::vector<int32> allowed_batch_sizes);
+
+  // Records that processing a batch padded to `batch_size` took `latency`.
+  // Sizes that are not allowed batch sizes are ignored.
+  void RecordLatency(int batch_size, absl::Duration latency)
+      TF_LOCKS_EXCLUDED(mu_);
+
+  // Returns the learned latency of a batch of `batch_size` once padded, or
+  // nullopt if none has been recorded yet or `batch_size` is larger than all
+  // allowed sizes.
+  absl::optional<absl::Duration> GetLatency(int batch_size) const
+      TF_LOCKS_EXCLUDED(mu_);
+
+  // Returns the size of the part of a batch of `batch_size` that should be
+  // processed now: either `batch_size` itself, to be padded up, or a smaller
+  // allowed size, in which case the remaining tasks are expected to join the
+  // `next_batch_size` tasks of the next batch after waiting `wait_time` for
+  // it to be scheduled.
+  int GetBatchSizeToProcess(int batch_size, int next_batch_size,
+                            absl::Duration wait_time) const
+      TF_LOCKS_EXCLUDED(mu_);
+
+  const std::vector<int32>& allowed_batch_sizes() const {
+    return allowed_batch_sizes_;
+  }
+
+ private:
+  // Returns the index of the smallest allowed size that is greater than or
+  // equal to `batch_size`, or -1 if there is none.
+  int BucketIndex(int batch_size) const;
+
+  absl::optional<absl::Duration> GetLatencyLocked(int batch_size) const
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const std::vector<int32> allowed_batch_sizes_;
+
+  mutable mutex mu_;
+  // Moving average of the latency of each allowed batch size, or a negative
+  // duration if no latency has been recorded for it.
+  std::vector<absl::Duration> latencies_ TF_GUARDED_BY(mu_);
+};
+
+}  // namespace serving
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_BATCH_LATENCY_MODEL_H_
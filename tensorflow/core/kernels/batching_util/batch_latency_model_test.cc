@@ -0,0 +1,77 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/batching_util/batch_latency_model.h"
+
+#include "absl/time/time.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace serving {
+namespace {
+
+TEST(BatchLatencyModelTest, RecordsLatencyPerAllowedBatchSize) {
+  BatchLatencyModel model({4, 8, 16});
+  EXPECT_FALSE(model.GetLatency(8).has_value());
+
+  model.RecordLatency(8, absl::Milliseconds(10));
+  // Not an allowed batch size.
+  model.RecordLatency(6, absl::Milliseconds(100));
+  ASSERT_TRUE(model.GetLatency(8).has_value());
+  EXPECT_EQ(*model.GetLatency(8), absl::Milliseconds(10));
+  // Sizes are rounded up to the next allowed size.
+  EXPECT_EQ(*model.GetLatency(5), absl::Milliseconds(10));
+  EXPECT_FALSE(model.GetLatency(4).has_value());
+  EXPECT_FALSE(model.GetLatency(17).has_value());
+
+  // Later samples are averaged in.
+  model.RecordLatency(8, absl::Milliseconds(20));
+  EXPECT_GT(*model.GetLatency(8), absl::Milliseconds(10));
+  EXPECT_LT(*model.GetLatency(8), absl::Milliseconds(20));
+}
+
+TEST(BatchLatencyModelTest, PadsUpWithoutLearnedLatencies) {
+  BatchLatencyModel model({4, 8, 16});
+  EXPECT_EQ(model.GetBatchSizeToProcess(9, 0, absl::ZeroDuration()), 9);
+
+  model.RecordLatency(16, absl::Milliseconds(100));
+  EXPECT_EQ(model.GetBatchSizeToProcess(9, 0, absl::ZeroDuration()), 9);
+}
+
+TEST(BatchLatencyModelTest, BatchesDownWhenPaddingIsExpensive) {
+  BatchLatencyModel model({4, 8, 16});
+  model.RecordLatency(4, absl::Milliseconds(10));
+  model.RecordLatency(8, absl::Milliseconds(10));
+  model.RecordLatency(16, absl::Milliseconds(100));
+
+  // Padding 9 up to 16 costs 9 * 100ms; processing 8 now and 1 in the next
+  // batch of 4 costs 8 * 10ms + 1 * (5ms + 10ms).
+  EXPECT_EQ(model.GetBatchSizeToProcess(9, 0, absl::Milliseconds(5)), 8);
+  // Waiting too long for the next batch makes padding cheaper.
+  EXPECT_EQ(model.GetBatchSizeToProcess(9, 0, absl::Seconds(1)), 9);
+}
+
+TEST(BatchLatencyModelTest, PadsUpWhenPaddingIsCheap) {
+  BatchLatencyModel model({4, 8, 16});
+  model.RecordLatency(4, absl::Milliseconds(10));
+  model.RecordLatency(8, absl::Milliseconds(10));
+  model.RecordLatency(16, absl::Milliseconds(10));
+
+  EXPECT_EQ(model.GetBatchSizeToProcess(9, 0, absl::Milliseconds(5)), 9);
+}
+
+}  // namespace
+}  // namespace serving
+}  // namespace tensorflow
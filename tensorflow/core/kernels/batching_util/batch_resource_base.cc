@@ -179,6 +179,21 @@ void RecordBatchDelayUsV2(int64_t batch_delay_us, const string& model_name,
       ->Add(static_cast<double>(batch_delay_us));
 }
 
+void RecordBatchDelayUsByPriority(int64_t batch_delay_us,
+                                  const string& model_name,
+                                  const string& op_name, bool low_priority) {
+  static auto* cell = tensorflow::monitoring::Sampler<3>::New(
+      {"/tensorflow/serving/batching/batch_delay_us_by_priority",
+       "Tracks the batching delay (in microseconds) for inputs by model_name "
+       "(if available) and by the priority lane of the inputs.",
+       "model_name", "op_name", "priority"},
+      // It's 27 buckets with the last bucket being 2^26 to DBL_MAX;
+      // so the limits are [1, 2, 4, 8, ..., 64 * 1024 * 1024, DBL_MAX].
+      monitoring::Buckets::Exponential(1, 2, 27));
+  cell->GetCell(model_name, op_name, low_priority ? "low" : "high")
+      ->Add(static_cast<double>(batch_delay_us));
+}
+
 void RecordBatchParamBatchTimeoutMicros(int64_t batch_timeout_micros,
                                         const string& model_name,
                                         const string& op_name) {
@@ -244,6 +259,7 @@ BatchResourceBase::BatchTask::CreateSplitTask(
   task->is_partial = true;
   task->start_time = this->start_time;
   task->request_cost = this->request_cost;
+  task->criticality_val = this->criticality_val;
 
   return task;
 }
@@ -495,6 +511,12 @@ Status BatchResourceBase::ConcatInputTensors(
                              context->op_kernel().name());
   RecordBatchSize(batch.size(), GetModelName(context),
                   context->op_kernel().name());
+  if (!session_metadata().name().empty()) {
+    GetGlobalWarmupStateRegistry().RecordProcessedBatchSize(
+        WarmupStateRegistry::Key(session_metadata().name(),
+                                 session_metadata().version()),
+        context->op_kernel().name(), allowed_batch_sizes_, padded_batch_size);
+  }
 
   // All tasks should have the same number of input edges.
   const int num_inputs = batch.task(0).inputs.size();
@@ -786,6 +808,13 @@ void BatchResourceBase::ProcessFuncBatch(std::unique_ptr<BatchT> batch) const {
     RecordBatchDelayUsV2((current_time - batch->task(i).start_time) * 1e-3,
                          model_name, last_task_context->op_kernel().name(),
                          processed_size);
+    if (batcher_queue_options_.enable_priority_queue) {
+      RecordBatchDelayUsByPriority(
+          (current_time - batch->task(i).start_time) * 1e-3, model_name,
+          last_task_context->op_kernel().name(),
+          batch->task(i).criticality() <
+              tsl::criticality::Criticality::kCritical);
+    }
   }
   // Releases the cleanup method here, because the callback of the function
   // library runtime will handle it now.
@@ -806,6 +835,11 @@ void BatchResourceBase::ProcessFuncBatch(std::unique_ptr<BatchT> batch) const {
         if (!final_status.ok()) {
           return;
         }
+        if (batcher_queue_options_.batch_latency_model != nullptr) {
+          batcher_queue_options_.batch_latency_model->RecordLatency(
+              processed_size,
+              absl::Nanoseconds(EnvTime::NowNanos() - current_time));
+        }
         final_status = SplitOutputTensors(combined_outputs, batch.get());
       });
 }
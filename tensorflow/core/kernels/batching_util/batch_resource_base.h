@@ -35,6 +35,7 @@ limitations under the License.
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/protobuf/config.pb.h"
+#include "tensorflow/tsl/platform/criticality.h"
 
 namespace tensorflow {
 namespace serving {
@@ -91,6 +92,14 @@ class BatchResourceBase : public ResourceBase {
 
     size_t size() const override { return inputs[0].shape().dim_size(0); }
 
+    // The criticality of the thread that created the task.
+    tsl::criticality::Criticality criticality_val =
+        tsl::criticality::GetCriticality();
+
+    tsl::criticality::Criticality criticality() const override {
+      return criticality_val;
+    }
+
     // Create a split task from this one. The caller needs to setup the inputs
     // of the new task
     std::unique_ptr<BatchTask> CreateSplitTask(
@@ -18,6 +18,7 @@ limitations under the License.
 
 #include <stddef.h>
 
+#include <algorithm>
 #include <deque>
 #include <functional>
 #include <list>
@@ -30,6 +31,7 @@ limitations under the License.
 #include "absl/types/variant.h"
 #include "absl/utility/utility.h"
 #include "tensorflow/core/kernels/batching_util/batch_input_task.h"
+#include "tensorflow/core/kernels/batching_util/batch_latency_model.h"
 #include "tensorflow/core/kernels/batching_util/batch_scheduler.h"
 #include "tensorflow/core/kernels/batching_util/periodic_function.h"
 #include "tensorflow/core/lib/core/errors.h"
@@ -221,6 +223,35 @@ class SharedBatchScheduler
 
     // If true, the padding will not be appended.
     bool disable_padding = false;
+
+    // If set, a batch that is not a multiple of the model's allowed batch
+    // sizes may be cut down to a smaller allowed size when it is scheduled,
+    // with the tasks left out put back in front of the open batch, if the
+    // model predicts a lower total latency for the requests than padding the
+    // batch up. The model learns from the latencies recorded by the
+    // process-batch callback. Ignored if `enable_lazy_split` is true.
+    std::shared_ptr<BatchLatencyModel> batch_latency_model;
+
+    // If true, tasks whose criticality is below kCritical are queued in a
+    // separate low priority lane. They are only batched into the capacity that
+    // high priority tasks leave in a batch when it is scheduled, or on their
+    // own once the lane has a full batch worth of tasks or its timeout has
+    // expired and no high priority batch is ready. Requires `enable_lazy_split`
+    // to be false.
+    bool enable_priority_queue = false;
+
+    // Options of the low priority lane, used iff `enable_priority_queue`.
+    struct LowPriorityQueueOptions {
+      // Maximum number of enqueued low priority tasks, in terms of batches of
+      // `max_execution_batch_size`. Tasks are rejected with UNAVAILABLE beyond
+      // it, independently of the high priority lane.
+      size_t max_enqueued_batches = 2;
+
+      // How long (in microseconds) the oldest low priority task waits for
+      // more low priority tasks before the lane forms a batch on its own.
+      int64_t batch_timeout_micros = 0;
+    };
+    LowPriorityQueueOptions low_priority_queue_options;
   };
   Status AddQueue(const QueueOptions& options,
                   std::function<void(std::unique_ptr<Batch<TaskType>>)>
@@ -403,6 +434,27 @@ class Queue {
   // currently schedulable.
   bool IsOpenBatchSchedulable() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // Returns true if the task goes to the low priority lane.
+  bool IsLowPriorityTask(const TaskType& task) const {
+    return options_.enable_priority_queue &&
+           task.criticality() < tsl::criticality::Criticality::kCritical;
+  }
+
+  // Enqueues `task` in the low priority lane.
+  Status ScheduleLowPriorityTask(std::unique_ptr<TaskType>* task);
+
+  // Determines whether the low priority lane can form a batch on its own.
+  bool IsLowPriorityLaneSchedulable() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Moves low priority tasks, oldest first, into the capacity left in the
+  // open batch.
+  void FillOpenBatchWithLowPriorityTasks() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Cuts `batch`, which was just taken off the front of 'batches_', down to
+  // the size chosen by `options_.batch_latency_model`, and puts the tasks
+  // left out back in front of the open batch.
+  void MaybeBatchDown(Batch<TaskType>* batch) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   // A variant of `IsOpenBatchSchedulable`; used when batches are formed at
   // task enqueue time, and open batch is `batches_.back()`.
   bool IsOpenBatchSchedulableAfterEagerSplit() const
@@ -465,6 +517,15 @@ class Queue {
   std::deque<std::unique_ptr<Batch<BatchInputTaskHandle<TaskType>>>>
       task_handle_batches_ TF_GUARDED_BY(mu_);
 
+  // The low priority tasks, oldest first, with the time (in microseconds)
+  // at which each was enqueued.
+  //
+  // Used iff `QueueOptions.enable_priority_queue` is true.
+  std::deque<std::pair<std::unique_ptr<TaskType>, uint64>> low_priority_tasks_
+      TF_GUARDED_BY(mu_);
+  // The sum of the sizes of `low_priority_tasks_`.
+  size_t low_priority_tasks_size_ TF_GUARDED_BY(mu_) = 0;
+
   // The counter of the TraceMe context ids.
   uint64 traceme_context_id_counter_ TF_GUARDED_BY(mu_) = 0;
 
@@ -600,6 +661,18 @@ Status SharedBatchScheduler<TaskType>::AddQueueAfterRewritingOptions(
         options.enable_large_batch_splitting);
   }
 
+  if (options.enable_priority_queue && options.enable_lazy_split) {
+    return errors::InvalidArgument(
+        "enable_priority_queue is not supported with enable_lazy_split.");
+  }
+  if (options.enable_priority_queue &&
+      (options.low_priority_queue_options.max_enqueued_batches == 0 ||
+       options.low_priority_queue_options.batch_timeout_micros < 0)) {
+    return errors::InvalidArgument(
+        "low_priority_queue_options must have positive max_enqueued_batches "
+        "and non-negative batch_timeout_micros.");
+  }
+
   if (options.enable_lazy_split && (!options.enable_large_batch_splitting)) {
     return errors::InvalidArgument(
         "enable_lazy_split should be enabled only if "
@@ -802,9 +875,69 @@ Status Queue<TaskType>::Schedule(std::unique_ptr<TaskType>* task) {
   if (options_.enable_lazy_split) {
     return ScheduleWithLazySplit(std::move(task));
   }
+  if (IsLowPriorityTask(**task)) {
+    return ScheduleLowPriorityTask(task);
+  }
   return ScheduleWithoutOrEagerSplit(std::move(task));
 }
 
+template <typename TaskType>
+Status Queue<TaskType>::ScheduleLowPriorityTask(
+    std::unique_ptr<TaskType>* task) {
+  profiler::TraceMe trace_me([task] {
+    return profiler::TraceMeEncode(
+        "ScheduleLowPriorityTask",
+        {{"batching_input_task_size", (*task)->size()}});
+  });
+
+  bool notify_of_schedulable_batch = false;
+  {
+    mutex_lock l(mu_);
+
+    DCHECK(!closed_);
+
+    const size_t capacity =
+        options_.low_priority_queue_options.max_enqueued_batches *
+        max_execution_batch_size();
+    if (low_priority_tasks_size_ + (*task)->size() > capacity) {
+      return errors::Unavailable(
+          "The low priority batch scheduling queue to which this task was "
+          "submitted is full; task size is ",
+          (*task)->size(), " but scheduling capacity is only ",
+          capacity - low_priority_tasks_size_,
+          " (max_enqueued_batches=",
+          options_.low_priority_queue_options.max_enqueued_batches,
+          ", max_execution_batch_size=", max_execution_batch_size(), ")");
+    }
+
+    // Each low priority task has to fit in a batch on its own.
+    std::vector<std::unique_ptr<TaskType>> output_tasks;
+    if ((*task)->size() <= max_execution_batch_size()) {
+      output_tasks.push_back(std::move(*task));
+    } else {
+      TF_RETURN_IF_ERROR(options_.split_input_task_func(
+          task, max_execution_batch_size(), max_execution_batch_size(),
+          &output_tasks));
+    }
+    const uint64 now_micros = env_->NowMicros();
+    for (auto& output_task : output_tasks) {
+      low_priority_tasks_size_ += output_task->size();
+      low_priority_tasks_.emplace_back(std::move(output_task), now_micros);
+    }
+
+    if (!schedulable_batch_ && IsLowPriorityLaneSchedulable()) {
+      schedulable_batch_ = true;
+      notify_of_schedulable_batch = true;
+    }
+  }
+
+  if (notify_of_schedulable_batch) {
+    schedulable_batch_callback_();
+  }
+
+  return OkStatus();
+}
+
 template <typename TaskType>
 Status Queue<TaskType>::ScheduleWithLazySplit(std::unique_ptr<TaskType>* task) {
   profiler::TraceMe trace_me([task] {
@@ -956,7 +1089,7 @@ size_t Queue<TaskType>::NumEnqueuedTasks() const {
   for (const auto& batch : batches_) {
     num_enqueued_tasks += batch->num_tasks();
   }
-  return num_enqueued_tasks;
+  return num_enqueued_tasks + low_priority_tasks_.size();
 }
 
 template <typename TaskType>
@@ -1030,8 +1163,12 @@ Queue<TaskType>::ScheduleBatchWithEagerSplit() {
   {
     mutex_lock l(mu_);
 
-    // Consider closing the open batch at this time, to schedule it.
-    if (batches_.size() == 1 && IsOpenBatchSchedulable()) {
+    // Consider closing the open batch at this time, to schedule it. Low
+    // priority tasks fill whatever capacity the high priority tasks leave in
+    // it.
+    if (batches_.size() == 1 &&
+        (IsOpenBatchSchedulable() || IsLowPriorityLaneSchedulable())) {
+      FillOpenBatchWithLowPriorityTasks();
       StartNewBatch();
     }
 
@@ -1040,6 +1177,9 @@ Queue<TaskType>::ScheduleBatchWithEagerSplit() {
       ++num_batches_being_processed_;
       batch_to_schedule = std::move(batches_.front());
       batches_.pop_front();
+      if (options_.batch_latency_model != nullptr) {
+        MaybeBatchDown(batch_to_schedule.get());
+      }
     } else {
       schedulable_batch_ = false;
     }
@@ -1131,7 +1271,33 @@ bool Queue<TaskType>::IsEmptyInternal() const {
            task_handle_batches_.back()->empty();
   }
   return num_batches_being_processed_ == 0 && batches_.size() == 1 &&
-         batches_.back()->empty();
+         batches_.back()->empty() && low_priority_tasks_.empty();
+}
+
+template <typename TaskType>
+bool Queue<TaskType>::IsLowPriorityLaneSchedulable() const {
+  if (low_priority_tasks_.empty()) {
+    return false;
+  }
+  return closed_ || low_priority_tasks_size_ >= max_execution_batch_size() ||
+         env_->NowMicros() >=
+             low_priority_tasks_.front().second +
+                 options_.low_priority_queue_options.batch_timeout_micros;
+}
+
+template <typename TaskType>
+void Queue<TaskType>::FillOpenBatchWithLowPriorityTasks() {
+  Batch<TaskType>* open_batch = batches_.back().get();
+  while (!low_priority_tasks_.empty() &&
+         open_batch->size() + low_priority_tasks_.front().first->size() <=
+             max_execution_batch_size()) {
+    if (open_batch->empty()) {
+      open_batch_start_time_micros_ = low_priority_tasks_.front().second;
+    }
+    low_priority_tasks_size_ -= low_priority_tasks_.front().first->size();
+    open_batch->AddTask(std::move(low_priority_tasks_.front().first));
+    low_priority_tasks_.pop_front();
+  }
 }
 
 template <typename TaskType>
@@ -1146,6 +1312,54 @@ void Queue<TaskType>::StartNewBatch() {
   batches_.emplace_back(new Batch<TaskType>(++traceme_context_id_counter_));
 }
 
+template <typename TaskType>
+void Queue<TaskType>::MaybeBatchDown(Batch<TaskType>* batch) {
+  // The tasks left out can only wait for more work in the open batch, which
+  // is only next in line if no other batch is waiting.
+  if (closed_ || batches_.size() != 1) return;
+  Batch<TaskType>* open_batch = batches_.back().get();
+  const int batch_size = batch->size();
+  const int open_batch_size = open_batch->size();
+  absl::Duration wait_time = absl::Microseconds(options_.batch_timeout_micros);
+  if (!open_batch->empty()) {
+    wait_time -= absl::Microseconds(env_->NowMicros() -
+                                    open_batch_start_time_micros_);
+    wait_time = std::max(wait_time, absl::ZeroDuration());
+  }
+  const int target_size = options_.batch_latency_model->GetBatchSizeToProcess(
+      batch_size, open_batch_size, wait_time);
+  if (target_size >= batch_size) return;
+
+  // Only whole tasks can be left out, and at least one has to stay.
+  int num_tasks_to_keep = batch->num_tasks();
+  int kept_size = batch_size;
+  while (num_tasks_to_keep > 0 && kept_size > target_size) {
+    --num_tasks_to_keep;
+    kept_size -= batch->task(num_tasks_to_keep).size();
+  }
+  if (num_tasks_to_keep == 0 || open_batch_size + batch_size - kept_size >
+                                    max_execution_batch_size()) {
+    return;
+  }
+
+  // Rebuild the open batch with the tasks left out first, as they are older.
+  std::vector<std::unique_ptr<TaskType>> tasks;
+  while (!open_batch->empty()) tasks.push_back(open_batch->RemoveTask());
+  while (batch->num_tasks() > num_tasks_to_keep) {
+    tasks.push_back(batch->RemoveTask());
+  }
+  auto new_open_batch =
+      std::make_unique<Batch<TaskType>>(open_batch->traceme_context_id());
+  for (auto it = tasks.rbegin(); it != tasks.rend(); ++it) {
+    new_open_batch->AddTask(std::move(*it));
+  }
+  open_batch->Close();
+  batches_.back() = std::move(new_open_batch);
+  if (open_batch_size == 0) {
+    open_batch_start_time_micros_ = env_->NowMicros();
+  }
+}
+
 template <typename TaskType>
 Status Queue<TaskType>::SplitInputBatchIntoSubtasks(
     std::unique_ptr<TaskType>* input_task,
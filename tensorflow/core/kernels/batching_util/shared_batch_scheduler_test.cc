@@ -35,6 +35,7 @@ limitations under the License.
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
 #include "tensorflow/core/protobuf/error_codes.pb.h"
+#include "tensorflow/tsl/platform/criticality.h"
 
 namespace tensorflow {
 namespace serving {
@@ -44,14 +45,21 @@ using ::testing::HasSubstr;
 
 class FakeTask : public BatchTask {
  public:
-  explicit FakeTask(size_t size) : size_(size) {}
+  explicit FakeTask(size_t size, tsl::criticality::Criticality criticality =
+                                      tsl::criticality::Criticality::kCritical)
+      : size_(size), criticality_(criticality) {}
 
   ~FakeTask() override = default;
 
   size_t size() const override { return size_; }
 
+  tsl::criticality::Criticality criticality() const override {
+    return criticality_;
+  }
+
  private:
   const size_t size_;
+  const tsl::criticality::Criticality criticality_;
 
   TF_DISALLOW_COPY_AND_ASSIGN(FakeTask);
 };
@@ -793,6 +801,59 @@ TEST_P(SharedBatchSchedulerTest, ZeroQueueRewrittenToOneQueue) {
   }
 }
 
+// Tests that low priority tasks only fill the capacity left by high priority
+// tasks, and are rejected beyond the capacity of their own lane.
+TEST(SharedBatchSchedulerPriorityQueueTest, LowPriorityTasksFillBatches) {
+  mutex mu;
+  std::vector<std::vector<size_t>> batches;
+  Notification batch_processed;
+  auto callback = [&](std::unique_ptr<Batch<FakeTask>> batch) {
+    ASSERT_TRUE(batch->IsClosed());
+    std::vector<size_t> task_sizes;
+    for (int i = 0; i < batch->num_tasks(); ++i) {
+      task_sizes.push_back(batch->task(i).size());
+    }
+    mutex_lock l(mu);
+    batches.push_back(task_sizes);
+    batch_processed.Notify();
+  };
+
+  auto scheduler = CreateSharedBatchScheduler(/*num_batch_threads=*/1);
+  QueueOptions queue_options = CreateQueueOptions(
+      /*max_execution_batch_size=*/10, /*input_batch_size_limit=*/10,
+      /*batch_timeout_micros=*/0, /*max_enqueued_batches=*/2,
+      /*enable_large_batch_splitting=*/false, /*enable_lazy_split=*/false,
+      /*split_func=*/nullptr);
+  queue_options.enable_priority_queue = true;
+  queue_options.low_priority_queue_options.max_enqueued_batches = 1;
+  // Long enough for the low priority lane never to time out in this test.
+  queue_options.low_priority_queue_options.batch_timeout_micros =
+      1000 * 1000 * 1000;
+  std::unique_ptr<Queue> queue =
+      CreateQueue(scheduler, queue_options, callback);
+
+  auto low_priority_task = [](size_t size) {
+    return std::make_unique<FakeTask>(
+        size, tsl::criticality::Criticality::kSheddable);
+  };
+  std::unique_ptr<FakeTask> task = low_priority_task(3);
+  TF_ASSERT_OK(queue->Schedule(&task));
+  task = low_priority_task(8);
+  EXPECT_THAT(queue->Schedule(&task),
+              testing::StatusIs(error::UNAVAILABLE,
+                                HasSubstr("low priority batch scheduling "
+                                          "queue")));
+  EXPECT_EQ(queue->NumEnqueuedTasks(), 1);
+
+  TF_ASSERT_OK(ScheduleTask(6, queue.get()));
+  batch_processed.WaitForNotification();
+  {
+    mutex_lock l(mu);
+    ASSERT_EQ(batches.size(), 1);
+    EXPECT_THAT(batches[0], ::testing::ElementsAre(6, 3));
+  }
+}
+
 // TODO(b/161857471):
 // Add test coverage when input-split and no-split returns differently.
 INSTANTIATE_TEST_SUITE_P(
@@ -15,10 +15,13 @@ limitations under the License.
 #include "tensorflow/core/kernels/batching_util/warmup.h"
 
 #include <optional>
+#include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/status/status.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
 #include "absl/synchronization/mutex.h"
 #include "tensorflow/tsl/platform/logging.h"
 
@@ -39,7 +42,7 @@ absl::StatusOr<WarmupStateRegistry::Handle> WarmupStateRegistry::Register(
   absl::MutexLock l(&mu_);
   VLOG(1) << "Registering model " << model_key.name << ":" << model_key.version
           << " to warm-up registry";
-  if (!states_.insert(model_key).second) {
+  if (!states_.try_emplace(model_key).second) {
     return absl::AlreadyExistsError(
         absl::StrCat("Model ", model_key.name, ":", model_key.version,
                      " already exists in the warm-up registry"));
@@ -52,7 +55,19 @@ void WarmupStateRegistry::Unregister(const Key& model_key) {
 
   VLOG(1) << "Unregistering model " << model_key.name << ":"
           << model_key.version << " from warm-up registry";
-  states_.erase(model_key);
+  auto it = states_.find(model_key);
+  if (it == states_.end()) {
+    return;
+  }
+  for (const auto& [op_name, batch_sizes] : ColdBatchSizes(it->second)) {
+    LOG(WARNING) << "Batching op " << op_name << " of model " << model_key.name
+                 << ":" << model_key.version
+                 << " did not process batch sizes "
+                 << absl::StrJoin(batch_sizes, ",")
+                 << " during warm-up; the first requests padded to these "
+                    "sizes may be slow.";
+  }
+  states_.erase(it);
 }
 
 bool WarmupStateRegistry::Lookup(const Key& model_key) {
@@ -60,6 +75,47 @@ bool WarmupStateRegistry::Lookup(const Key& model_key) {
   return states_.contains(model_key);
 }
 
+void WarmupStateRegistry::RecordProcessedBatchSize(
+    const Key& model_key, absl::string_view op_name,
+    absl::Span<const int32_t> allowed_batch_sizes, int batch_size) {
+  absl::MutexLock l(&mu_);
+  auto it = states_.find(model_key);
+  if (it == states_.end()) {
+    return;
+  }
+  BatchSizeCoverage& coverage = it->second[std::string(op_name)];
+  coverage.allowed_batch_sizes.assign(allowed_batch_sizes.begin(),
+                                      allowed_batch_sizes.end());
+  coverage.processed_batch_sizes.insert(batch_size);
+}
+
+absl::flat_hash_map<std::string, std::vector<int32_t>>
+WarmupStateRegistry::GetColdBatchSizes(const Key& model_key) {
+  absl::ReaderMutexLock l(&mu_);
+  auto it = states_.find(model_key);
+  if (it == states_.end()) {
+    return {};
+  }
+  return ColdBatchSizes(it->second);
+}
+
+/*static*/ absl::flat_hash_map<std::string, std::vector<int32_t>>
+WarmupStateRegistry::ColdBatchSizes(const WarmupState& state) {
+  absl::flat_hash_map<std::string, std::vector<int32_t>> cold_batch_sizes;
+  for (const auto& [op_name, coverage] : state) {
+    std::vector<int32_t> batch_sizes;
+    for (const int32_t batch_size : coverage.allowed_batch_sizes) {
+      if (!coverage.processed_batch_sizes.contains(batch_size)) {
+        batch_sizes.push_back(batch_size);
+      }
+    }
+    if (!batch_sizes.empty()) {
+      cold_batch_sizes[op_name] = std::move(batch_sizes);
+    }
+  }
+  return cold_batch_sizes;
+}
+
 WarmupStateRegistry& GetGlobalWarmupStateRegistry() {
   static auto* const registry = new WarmupStateRegistry;
   return *registry;
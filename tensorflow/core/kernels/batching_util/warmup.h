@@ -19,11 +19,15 @@ limitations under the License.
 #include <optional>
 #include <string>
 #include <utility>
+#include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/hash/hash.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
 #include "tensorflow/core/kernels/batching_util/warmup.h"
 #include "tensorflow/core/protobuf/config.pb.h"
 #include "tensorflow/tsl/platform/logging.h"
@@ -34,6 +38,11 @@ namespace serving {
 // Global registry for model's warm-up states. Before a model executes warm-up
 // requests, it is registered here so that the runtime can distinguish demand
 // requests vs. warm-up requests and apply warm-up specific optimizations.
+//
+// While a model is in a warm-up state, the registry also tracks which of the
+// allowed batch sizes of each of its batching ops have been processed, so that
+// warm-up can replay requests covering the remaining ones. The batch sizes
+// still cold when the model leaves the warm-up state are logged.
 class WarmupStateRegistry {
  public:
   struct Key {
@@ -100,14 +109,39 @@ class WarmupStateRegistry {
   // Return true if the model is in a warm-up state.
   bool Lookup(const Key& model_key);
 
+  // Records that the batching op `op_name` of the model, which pads batches
+  // to `allowed_batch_sizes`, processed a batch padded to `batch_size`. Does
+  // nothing if the model is not in a warm-up state.
+  void RecordProcessedBatchSize(const Key& model_key, absl::string_view op_name,
+                                absl::Span<const int32_t> allowed_batch_sizes,
+                                int batch_size);
+
+  // Returns the allowed batch sizes that each batching op of the model has not
+  // processed during warm-up so far, keyed by op name. Ops that have not
+  // processed any batch, or have processed all their allowed batch sizes, are
+  // omitted.
+  absl::flat_hash_map<std::string, std::vector<int32_t>> GetColdBatchSizes(
+      const Key& model_key);
+
  private:
   friend class Handle;
 
+  // The batch sizes processed by a batching op during warm-up.
+  struct BatchSizeCoverage {
+    std::vector<int32_t> allowed_batch_sizes;
+    absl::flat_hash_set<int> processed_batch_sizes;
+  };
+  // Per-model warm-up state, keyed by batching op name.
+  using WarmupState = absl::flat_hash_map<std::string, BatchSizeCoverage>;
+
   void Unregister(const Key& model_key);
 
+  static absl::flat_hash_map<std::string, std::vector<int32_t>>
+  ColdBatchSizes(const WarmupState& state);
+
   absl::Mutex mu_;
-  // Mapping from model names/versions to executables.
-  absl::flat_hash_set<Key> states_ ABSL_GUARDED_BY(&mu_);
+  // Mapping from model names/versions to their warm-up state.
+  absl::flat_hash_map<Key, WarmupState> states_ ABSL_GUARDED_BY(&mu_);
 };
 
 WarmupStateRegistry& GetGlobalWarmupStateRegistry();
@@ -0,0 +1,61 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/batching_util/warmup.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace serving {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+TEST(WarmupStateRegistryTest, TracksColdBatchSizes) {
+  WarmupStateRegistry registry;
+  const WarmupStateRegistry::Key key("model", 1);
+  const std::vector<int32_t> allowed_batch_sizes = {2, 4, 8};
+
+  // Batches processed outside of warm-up are not tracked.
+  registry.RecordProcessedBatchSize(key, "batch", allowed_batch_sizes, 2);
+  EXPECT_THAT(registry.GetColdBatchSizes(key), IsEmpty());
+
+  {
+    auto handle = registry.Register(key);
+    TF_ASSERT_OK(handle.status());
+    EXPECT_THAT(registry.GetColdBatchSizes(key), IsEmpty());
+
+    registry.RecordProcessedBatchSize(key, "batch", allowed_batch_sizes, 4);
+    auto cold_batch_sizes = registry.GetColdBatchSizes(key);
+    ASSERT_EQ(cold_batch_sizes.size(), 1);
+    EXPECT_THAT(cold_batch_sizes["batch"], ElementsAre(2, 8));
+
+    registry.RecordProcessedBatchSize(key, "batch", allowed_batch_sizes, 2);
+    registry.RecordProcessedBatchSize(key, "batch", allowed_batch_sizes, 8);
+    EXPECT_THAT(registry.GetColdBatchSizes(key), IsEmpty());
+  }
+
+  EXPECT_FALSE(registry.Lookup(key));
+  EXPECT_THAT(registry.GetColdBatchSizes(key), IsEmpty());
+}
+
+}  // namespace
+}  // namespace serving
+}  // namespace tensorflow
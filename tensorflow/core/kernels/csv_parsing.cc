@@ -0,0 +1,132 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/csv_parsing.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/platform/byte_order.h"
+#include "tensorflow/core/platform/numbers.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif  // __SSE2__
+
+namespace tensorflow {
+namespace {
+
+// Returns true if the eight bytes of `chunk` are all ASCII digits.
+bool IsEightDigits(uint64_t chunk) {
+  return ((chunk & 0xF0F0F0F0F0F0F0F0) |
+          (((chunk + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) >> 4)) ==
+         0x3333333333333333;
+}
+
+// Returns the value of the eight ASCII digits of `chunk`, which were loaded
+// from memory in little-endian order.
+uint32_t ParseEightDigits(uint64_t chunk) {
+  chunk = ((chunk & 0x0F0F0F0F0F0F0F0F) * 2561) >> 8;
+  chunk = ((chunk & 0x00FF00FF00FF00FF) * 6553601) >> 16;
+  return static_cast<uint32_t>(
+      ((chunk & 0x0000FFFF0000FFFF) * 42949672960001) >> 32);
+}
+
+// Parses `field` if it is an optional '-' followed by at most `kMaxDigits`
+// decimal digits, which can't overflow `T`. Falls back to `safe_strto` for
+// anything else (e.g. surrounding spaces or large values).
+template <typename T, size_t kMaxDigits, typename Fallback>
+bool ParseCsvInteger(absl::string_view field, T* value, Fallback fallback) {
+  absl::string_view digits = field;
+  const bool negative = !digits.empty() && digits.front() == '-';
+  if (negative) {
+    digits.remove_prefix(1);
+  }
+  if (digits.empty() || digits.size() > kMaxDigits) {
+    return fallback(field, value);
+  }
+  uint64_t result = 0;
+  size_t i = 0;
+  if (port::kLittleEndian) {
+    for (; i + sizeof(uint64_t) <= digits.size(); i += sizeof(uint64_t)) {
+      uint64_t chunk;
+      std::memcpy(&chunk, digits.data() + i, sizeof(chunk));
+      if (!IsEightDigits(chunk)) {
+        return fallback(field, value);
+      }
+      result = result * 100000000 + ParseEightDigits(chunk);
+    }
+  }
+  for (; i < digits.size(); ++i) {
+    const uint32_t digit = static_cast<unsigned char>(digits[i]) - '0';
+    if (digit > 9) {
+      return fallback(field, value);
+    }
+    result = result * 10 + digit;
+  }
+  *value = negative ? -static_cast<T>(result) : static_cast<T>(result);
+  return true;
+}
+
+}  // namespace
+
+size_t FindCsvFieldEnd(absl::string_view data, size_t pos, char delim,
+                       bool use_quote_delim) {
+  // '\n' stands in for the quote when quotes don't end fields.
+  const char quote = use_quote_delim ? '"' : '\n';
+#ifdef __SSE2__
+  const __m128i delims = _mm_set1_epi8(delim);
+  const __m128i newlines = _mm_set1_epi8('\n');
+  const __m128i carriage_returns = _mm_set1_epi8('\r');
+  const __m128i quotes = _mm_set1_epi8(quote);
+  for (; pos + sizeof(__m128i) <= data.size(); pos += sizeof(__m128i)) {
+    const __m128i chunk =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(data.data() + pos));
+    const __m128i matches =
+        _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, delims),
+                                  _mm_cmpeq_epi8(chunk, newlines)),
+                     _mm_or_si128(_mm_cmpeq_epi8(chunk, carriage_returns),
+                                  _mm_cmpeq_epi8(chunk, quotes)));
+    const uint32_t mask = _mm_movemask_epi8(matches);
+    if (mask != 0) {
+      return pos + __builtin_ctz(mask);
+    }
+  }
+#endif  // __SSE2__
+  for (; pos < data.size(); ++pos) {
+    const char c = data[pos];
+    if (c == delim || c == '\n' || c == '\r' || c == quote) {
+      return pos;
+    }
+  }
+  return data.size();
+}
+
+bool ParseCsvInt32(absl::string_view field, int32_t* value) {
+  return ParseCsvInteger<int32_t, 9>(
+      field, value, [](absl::string_view str, int32_t* result) {
+        return strings::safe_strto32(str, result);
+      });
+}
+
+bool ParseCsvInt64(absl::string_view field, int64_t* value) {
+  return ParseCsvInteger<int64_t, 18>(
+      field, value, [](absl::string_view str, int64_t* result) {
+        return strings::safe_strto64(str, result);
+      });
+}
+
+}  // namespace tensorflow
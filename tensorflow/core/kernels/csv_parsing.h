@@ -0,0 +1,41 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_KERNELS_CSV_PARSING_H_
+#define TENSORFLOW_CORE_KERNELS_CSV_PARSING_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "absl/strings/string_view.h"
+
+namespace tensorflow {
+
+// Helpers shared by the CSV parsing kernels (`DecodeCSV` and `CSVDataset`).
+
+// Returns the offset of the first byte of `data[pos:]` that ends or breaks an
+// unquoted field: `delim`, '\n', '\r', or '"' if `use_quote_delim` is true.
+// Returns `data.size()` if there is none.
+size_t FindCsvFieldEnd(absl::string_view data, size_t pos, char delim,
+                       bool use_quote_delim);
+
+// Parses a CSV field as an integer. These are equivalent to
+// `strings::safe_strto32` and `strings::safe_strto64`, but parse plain decimal
+// fields eight digits at a time.
+bool ParseCsvInt32(absl::string_view field, int32_t* value);
+bool ParseCsvInt64(absl::string_view field, int64_t* value);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_CSV_PARSING_H_
@@ -0,0 +1,116 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/csv_parsing.h"
+
+#include <cstdint>
+#include <limits>
+#include <string>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/platform/numbers.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(FindCsvFieldEndTest, FindsFirstSpecialCharacter) {
+  // Longer than a vector register.
+  const std::string data = "0123456789abcdefghijklmnopqrstuvwxyz";
+  for (char special : {',', '\n', '\r', '"'}) {
+    for (size_t i : {0, 5, 15, 16, 17, 35}) {
+      std::string field = data;
+      field[i] = special;
+      EXPECT_EQ(FindCsvFieldEnd(field, 0, ',', /*use_quote_delim=*/true), i);
+      EXPECT_EQ(FindCsvFieldEnd(field, i, ',', /*use_quote_delim=*/true), i);
+      EXPECT_EQ(FindCsvFieldEnd(field, i + 1, ',', /*use_quote_delim=*/true),
+                field.size());
+    }
+  }
+}
+
+TEST(FindCsvFieldEndTest, QuotesOnlyEndFieldsWithQuoteDelim) {
+  const std::string data = "a\"bcdefghijklmnopqrstuvwxyz|";
+  EXPECT_EQ(FindCsvFieldEnd(data, 0, '|', /*use_quote_delim=*/true), 1);
+  EXPECT_EQ(FindCsvFieldEnd(data, 0, '|', /*use_quote_delim=*/false),
+            data.size() - 1);
+}
+
+TEST(FindCsvFieldEndTest, NoSpecialCharacter) {
+  EXPECT_EQ(FindCsvFieldEnd("", 0, ',', /*use_quote_delim=*/true), 0);
+  const std::string data(100, 'a');
+  EXPECT_EQ(FindCsvFieldEnd(data, 3, ',', /*use_quote_delim=*/true), 100);
+}
+
+TEST(ParseCsvIntTest, MatchesSafeStrto) {
+  const std::string fields[] = {
+      "0",
+      "-0",
+      "7",
+      "-7",
+      "12345678",
+      "123456789",
+      "-123456789",
+      "1234567890",
+      "2147483647",
+      "2147483648",
+      "-2147483648",
+      "-2147483649",
+      "00000000000000000001",
+      "123456789012345678",
+      "-123456789012345678",
+      "9223372036854775807",
+      "-9223372036854775808",
+      "9223372036854775808",
+      " 42",
+      "42 ",
+      "+42",
+      "",
+      "-",
+      "--1",
+      "4a",
+      "1234567a",
+      "1234:678",
+      "12345678/",
+      "1.5",
+      "\xff\xff\xff\xff\xff\xff\xff\xff",
+  };
+  for (const std::string& field : fields) {
+    int32_t expected_int32 = -1, actual_int32 = -1;
+    EXPECT_EQ(ParseCsvInt32(field, &actual_int32),
+              strings::safe_strto32(field, &expected_int32))
+        << field;
+    EXPECT_EQ(actual_int32, expected_int32) << field;
+
+    int64_t expected_int64 = -1, actual_int64 = -1;
+    EXPECT_EQ(ParseCsvInt64(field, &actual_int64),
+              strings::safe_strto64(field, &expected_int64))
+        << field;
+    EXPECT_EQ(actual_int64, expected_int64) << field;
+  }
+}
+
+TEST(ParseCsvIntTest, Limits) {
+  int32_t int32_value;
+  ASSERT_TRUE(ParseCsvInt32(
+      absl::StrCat(std::numeric_limits<int32_t>::min()), &int32_value));
+  EXPECT_EQ(int32_value, std::numeric_limits<int32_t>::min());
+  int64_t int64_value;
+  ASSERT_TRUE(ParseCsvInt64(
+      absl::StrCat(std::numeric_limits<int64_t>::max()), &int64_value));
+  EXPECT_EQ(int64_value, std::numeric_limits<int64_t>::max());
+}
+
+}  // namespace
+}  // namespace tensorflow
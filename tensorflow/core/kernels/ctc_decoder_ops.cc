@@ -330,34 +330,44 @@ class CTCBeamSearchDecoderOp : public OpKernel {
                                 batch_size, num_classes);
     }
 
-    ctc::CTCBeamSearchDecoder<T> beam_search(num_classes, beam_width_,
-                                             &beam_scorer_, 1 /* batch_size */,
-                                             merge_repeated_);
-    Tensor input_chip(DataTypeToEnum<T>::v(), TensorShape({num_classes}));
-    auto input_chip_t = input_chip.flat<T>();
-
     std::vector<std::vector<std::vector<int> > > best_paths(batch_size);
-    std::vector<T> log_probs;
+    std::vector<Status> statuses(batch_size);
 
-    // Assumption: the blank index is num_classes - 1
-    for (int b = 0; b < batch_size; ++b) {
-      auto& best_paths_b = best_paths[b];
-      best_paths_b.resize(decode_helper_.GetTopPaths());
-      for (int t = 0; t < seq_len_t(b); ++t) {
-        input_chip_t = input_list_t[t].chip(b, 0);
-        auto input_bi = Eigen::Map<const Eigen::Array<T, Eigen::Dynamic, 1>>(
-            input_chip_t.data(), num_classes);
-        beam_search.Step(input_bi);
+    // Batch entries are decoded independently, each shard with its own
+    // decoder. Assumption: the blank index is num_classes - 1
+    auto decode = [&](const int64_t begin, const int64_t end) {
+      ctc::CTCBeamSearchDecoder<T> beam_search(
+          num_classes, beam_width_, &beam_scorer_, 1 /* batch_size */,
+          merge_repeated_);
+      std::vector<T> log_probs;
+      for (int b = begin; b < end; ++b) {
+        auto& best_paths_b = best_paths[b];
+        best_paths_b.resize(decode_helper_.GetTopPaths());
+        for (int t = 0; t < seq_len_t(b); ++t) {
+          auto input_bi = Eigen::Map<const Eigen::Array<T, Eigen::Dynamic, 1>>(
+              &input_list_t[t](b, 0), num_classes);
+          beam_search.Step(input_bi);
+        }
+        statuses[b] =
+            beam_search.TopPaths(decode_helper_.GetTopPaths(), &best_paths_b,
+                                 &log_probs, merge_repeated_);
+        beam_search.Reset();
+        if (!statuses[b].ok()) continue;
+
+        for (int bp = 0; bp < decode_helper_.GetTopPaths(); ++bp) {
+          log_prob_t(b, bp) = log_probs[bp];
+        }
       }
-      OP_REQUIRES_OK(
-          ctx, beam_search.TopPaths(decode_helper_.GetTopPaths(), &best_paths_b,
-                                    &log_probs, merge_repeated_));
-
-      beam_search.Reset();
+    };
 
-      for (int bp = 0; bp < decode_helper_.GetTopPaths(); ++bp) {
-        log_prob_t(b, bp) = log_probs[bp];
-      }
+    // Each step expands every beam with every class.
+    const int64_t kCostPerUnit = 50 * max_time * num_classes * beam_width_;
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *ctx->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads.num_threads, worker_threads.workers, batch_size,
+          kCostPerUnit, decode);
+    for (const Status& status : statuses) {
+      OP_REQUIRES_OK(ctx, status);
     }
 
     OP_REQUIRES_OK(ctx, decode_helper_.StoreAllDecodedSequences(
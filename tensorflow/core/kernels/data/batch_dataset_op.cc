@@ -17,6 +17,7 @@ limitations under the License.
 #include <algorithm>
 #include <utility>
 
+#include "tensorflow/core/data/batch_buffer_pool.h"
 #include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/framework/dataset.h"
@@ -27,6 +28,7 @@ limitations under the License.
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/stringprintf.h"
 #include "tensorflow/core/util/batch_util.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 namespace data {
@@ -44,6 +46,9 @@ namespace data {
 
 constexpr char kInputImplEmpty[] = "input_impl_empty";
 constexpr char kBatchDataset[] = "BatchDataset";
+// Name of the environment variable that makes the iterator copy each input
+// element into its slice of the batch as soon as the element is produced.
+constexpr char kCopyOnArrivalEnvVar[] = "TF_DATA_BATCH_COPY_ON_ARRIVAL";
 
 class BatchDatasetOp::Dataset : public DatasetBase {
  public:
@@ -126,7 +131,7 @@ class BatchDatasetOp::Dataset : public DatasetBase {
     return input_->CheckExternalState();
   }
 
-  Status Get(OpKernelContext* ctx, int64 index,
+  Status Get(AnyContext ctx, int64 index,
              std::vector<Tensor>* out_tensors) const override {
     const int64 cardinality = Cardinality();
     if (index < 0 || index >= cardinality) {
@@ -170,17 +175,31 @@ class BatchDatasetOp::Dataset : public DatasetBase {
   class Iterator : public DatasetIterator<Dataset> {
    public:
     explicit Iterator(const Params& params)
-        : DatasetIterator<Dataset>(params) {}
+        : DatasetIterator<Dataset>(params) {
+      Status s = ReadBoolFromEnvVar(kCopyOnArrivalEnvVar,
+                                    /*default_val=*/false, &copy_on_arrival_);
+      if (!s.ok()) {
+        LOG(WARNING) << "Ignoring " << kCopyOnArrivalEnvVar << ": " << s;
+        copy_on_arrival_ = false;
+      }
+    }
 
     bool SymbolicCheckpointCompatible() const override { return true; }
 
     Status Initialize(IteratorContext* ctx) override {
+      buffer_pool_ = BatchBufferPool::MaybeCreateFromEnv(ctx->allocator({}));
       return dataset()->input_->MakeIterator(ctx, this, prefix(), &input_impl_);
     }
 
     Status GetNextInternal(IteratorContext* ctx,
                            std::vector<Tensor>* out_tensors,
                            bool* end_of_sequence) override {
+      // Batches that are not bounded by `reserve_size_` could be too large to
+      // allocate up front.
+      if (copy_on_arrival_ &&
+          dataset()->reserve_size_ == dataset()->batch_size_) {
+        return GetNextCopyingOnArrival(ctx, out_tensors, end_of_sequence);
+      }
       // Each row of `batch_elements` is a tuple of tensors from the
       // input iterator.
       std::vector<std::vector<Tensor>> batch_elements;
@@ -223,9 +242,12 @@ class BatchDatasetOp::Dataset : public DatasetBase {
       // respective slice locations. This would require a different GetNext()
       // overload that supports zero-copy, and might make sense in an
       // optimization pass.
-      TF_RETURN_IF_ERROR(CopyBatch(
-          CopyBatchParams(ctx), batch_elements, dataset()->parallel_copy_,
-          /*allocation_callback=*/nullptr, out_tensors));
+      CopyBatchParams params(ctx);
+      params.buffer_pool = buffer_pool_.get();
+      TF_RETURN_IF_ERROR(CopyBatch(params, batch_elements,
+                                   dataset()->parallel_copy_,
+                                   /*allocation_callback=*/nullptr,
+                                   out_tensors));
 
       *end_of_sequence = false;
       return OkStatus();
@@ -267,8 +289,52 @@ class BatchDatasetOp::Dataset : public DatasetBase {
     }
 
    private:
+    // Copies each input element into its slice of the batch as soon as it is
+    // produced, so that at most one element is held besides the batch. The
+    // copies are made by the calling thread, and `parallel_copy` is ignored.
+    Status GetNextCopyingOnArrival(IteratorContext* ctx,
+                                   std::vector<Tensor>* out_tensors,
+                                   bool* end_of_sequence) {
+      std::vector<Tensor> batch;
+      int64_t num_elements = 0;
+      {
+        mutex_lock l(mu_);
+        if (!input_impl_) {
+          *end_of_sequence = true;
+          return OkStatus();
+        }
+        CopyBatchParams params(ctx);
+        params.buffer_pool = buffer_pool_.get();
+        *end_of_sequence = false;
+        while (num_elements < dataset()->batch_size_) {
+          std::vector<Tensor> element;
+          TF_RETURN_IF_ERROR(
+              input_impl_->GetNext(ctx, &element, end_of_sequence));
+          if (*end_of_sequence) {
+            input_impl_.reset();
+            break;
+          }
+          if (num_elements == 0) {
+            TF_RETURN_IF_ERROR(AllocateBatch(params, element,
+                                             dataset()->batch_size_, &batch));
+          }
+          TF_RETURN_IF_ERROR(
+              CopyElementToBatch(std::move(element), num_elements, &batch));
+          num_elements++;
+        }
+      }
+      // Trims a final partial batch, or drops it if `drop_remainder` is set.
+      return ProcessBatch(dataset()->batch_size_, num_elements,
+                          dataset()->drop_remainder_, OkStatus(), ctx,
+                          out_tensors, end_of_sequence, &batch);
+    }
+
     mutex mu_;
     std::unique_ptr<IteratorBase> input_impl_ TF_GUARDED_BY(mu_);
+    bool copy_on_arrival_;
+    // Recycles the buffers of the batches once they are no longer referenced.
+    // Null unless `BatchBufferPool::kMaxCachedBytesEnvVar` is set.
+    std::shared_ptr<BatchBufferPool> buffer_pool_;
   };
 
   const int64_t batch_size_;
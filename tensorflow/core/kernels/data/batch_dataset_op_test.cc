@@ -14,6 +14,7 @@ limitations under the License.
 #include <string>
 
 #include "tensorflow/core/common_runtime/type_inference.h"
+#include "tensorflow/core/data/batch_buffer_pool.h"
 #include "tensorflow/core/data/dataset_test_base.h"
 #include "tensorflow/core/graph/node_builder.h"
 #include "tensorflow/core/public/session_options.h"
@@ -154,6 +155,35 @@ std::vector<GetNextTestCase<BatchDatasetParams>> GetNextTestCases() {
 ITERATOR_GET_NEXT_TEST_P(BatchDatasetOpTest, BatchDatasetParams,
                          GetNextTestCases())
 
+// Runs the GetNext test cases with each element copied into the batch as it
+// is produced, and with the batches allocated from a buffer pool.
+class BatchDatasetOpCopyOnArrivalTest
+    : public BatchDatasetOpTest,
+      public ::testing::WithParamInterface<
+          GetNextTestCase<BatchDatasetParams>> {
+ protected:
+  void SetUp() override {
+    setenv("TF_DATA_BATCH_COPY_ON_ARRIVAL", "true", /*overwrite=*/1);
+    setenv(BatchBufferPool::kMaxCachedBytesEnvVar, "1048576",
+           /*overwrite=*/1);
+  }
+
+  void TearDown() override {
+    unsetenv("TF_DATA_BATCH_COPY_ON_ARRIVAL");
+    unsetenv(BatchBufferPool::kMaxCachedBytesEnvVar);
+  }
+};
+
+TEST_P(BatchDatasetOpCopyOnArrivalTest, GetNext) {
+  auto test_case = GetParam();
+  TF_ASSERT_OK(Initialize(test_case.dataset_params));
+  TF_ASSERT_OK(
+      CheckIteratorGetNext(test_case.expected_outputs, /*compare_order=*/true));
+}
+
+INSTANTIATE_TEST_SUITE_P(BatchDatasetOpTest, BatchDatasetOpCopyOnArrivalTest,
+                         ::testing::ValuesIn(GetNextTestCases()));
+
 TEST_F(BatchDatasetOpTest, DatasetNodeName) {
   auto batch_dataset_params = BatchDatasetParams1();
   TF_ASSERT_OK(Initialize(batch_dataset_params));
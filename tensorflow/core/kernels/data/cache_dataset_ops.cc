@@ -19,6 +19,7 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "tensorflow/core/data/mapped_cache.h"
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/data/serialization_utils.h"
 #include "tensorflow/core/framework/dataset.h"
@@ -57,6 +58,7 @@ constexpr char kLockFileSuffix[] = ".lockfile";
 constexpr char kIterationCompleted[] = "iteration_completed";
 constexpr char kCurIndex[] = "cur_index";
 constexpr char kShardId[] = "shard_id";
+constexpr char kMappedFormat[] = "mapped_format";
 constexpr char kCreatedAt[] = "Created at";
 constexpr char kMemoryDatasetPrefix[] = "Memory";
 constexpr char kMemoryCache[] = "MemoryCache";
@@ -144,7 +146,8 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
         item_index_padding_size_(StringPaddingSize(kMaxItems)),
         tensor_format_string_(strings::Printf(kKeyStrFormat,
                                               item_index_padding_size_,
-                                              tensor_index_padding_size_)) {
+                                              tensor_index_padding_size_)),
+        write_mapped_format_(MappedCacheFormatEnabledFromEnv()) {
     input_->Ref();
     DCHECK_EQ(item_index_padding_size_, 7);
   }
@@ -174,7 +177,26 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
   }
 
   int64_t CardinalityInternal(CardinalityOptions options) const override {
-    return input_->Cardinality(options);
+    int64_t cardinality = input_->Cardinality(options);
+    if (cardinality == kUnknownCardinality) {
+      // A complete cache in the mapped format knows its size.
+      std::shared_ptr<MappedCacheReader> cache;
+      if (GetMappedCache(&cache).ok() && cache != nullptr) {
+        cardinality = cache->num_elements();
+      }
+    }
+    return cardinality;
+  }
+
+  Status Get(AnyContext ctx, int64 index,
+             std::vector<Tensor>* out_tensors) const override {
+    std::shared_ptr<MappedCacheReader> cache;
+    TF_RETURN_IF_ERROR(GetMappedCache(&cache));
+    if (cache != nullptr) {
+      return cache->Get(index, out_tensors);
+    }
+    TF_RETURN_IF_ERROR(CheckRandomAccessCompatible(index));
+    return input_->Get(ctx, index, out_tensors);
   }
 
   Status InputDatasets(std::vector<const DatasetBase*>* inputs) const override {
@@ -191,6 +213,30 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
   const tstring filename_;
 
  private:
+  bool MappedCacheExists() const {
+    return env_->FileExists(MappedCacheIndexFilename(filename_)).ok();
+  }
+
+  bool CacheExists() const {
+    return env_->FileExists(MetaFilename(filename_)).ok() ||
+           MappedCacheExists();
+  }
+
+  // Returns the reader of the cache if it has been completely written in the
+  // mapped format, and nullptr otherwise. The reader is opened once and shared
+  // by `Get` and all iterators.
+  Status GetMappedCache(std::shared_ptr<MappedCacheReader>* cache) const {
+    mutex_lock l(mapped_cache_mu_);
+    if (mapped_cache_ == nullptr && MappedCacheExists()) {
+      std::unique_ptr<MappedCacheReader> reader;
+      TF_RETURN_IF_ERROR(
+          MappedCacheReader::Open(env_, filename_, num_tensors_, &reader));
+      mapped_cache_ = std::move(reader);
+    }
+    *cache = mapped_cache_;
+    return OkStatus();
+  }
+
   static size_t StringPaddingSize(size_t num_tensors) {
     return strings::Printf(kPaddingSizeStrFormat, num_tensors - 1).size();
   }
@@ -204,9 +250,7 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
    public:
     explicit FileIterator(const Params& params)
         : DatasetIterator<FileDatasetBase>(params) {
-      if (params.dataset->env_
-              ->FileExists(MetaFilename(params.dataset->filename_))
-              .ok()) {
+      if (params.dataset->CacheExists()) {
         mode_ = Mode::read;
       } else {
         mode_ = Mode::write;
@@ -246,15 +290,14 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
         TF_RETURN_IF_ERROR(reader->ReadScalar(prefix(), kMode, &temp));
         mode_ = static_cast<Mode>(temp);
       }
-      if (mode_ == Mode::write &&
-          dataset()
-              ->env_->FileExists(MetaFilename(dataset()->filename_))
-              .ok()) {
+      if (mode_ == Mode::write && dataset()->CacheExists()) {
         // This could happen if the cache was completely written after the
         // checkpoint was saved.
         LOG(WARNING)
             << "It looks like the cache was already completely written("
-            << MetaFilename(dataset()->filename_)
+            << (dataset()->MappedCacheExists()
+                    ? MappedCacheIndexFilename(dataset()->filename_)
+                    : MetaFilename(dataset()->filename_))
             << ") after the last checkpoint was saved. Attempting to read "
             << "the cache instead of continuing to write. If this is a "
             << "mistake, please remove the above file and try running again.";
@@ -281,6 +324,10 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
     // partial cache gets flushed to disk in files with prefix
     // <filename>_<shard_id> where shard_id is unique for each checkpoint.
     // When all elements have been produced, these shards get coalesced.
+    //
+    // If `kCacheFileFormatEnvVar` selects the mapped format, each shard is
+    // instead written by a `MappedCacheWriter` and the shards are kept as they
+    // are, with an index file listing them written last.
     class FileWriterIterator : public DatasetIterator<FileDatasetBase> {
      public:
       explicit FileWriterIterator(const Params& params)
@@ -291,17 +338,31 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
                 strings::StrCat(params.dataset->filename_, "_", shard_id_)),
             lockfile_(strings::StrCat(filename_, kLockFileSuffix)),
             lockfile_created_(false),
-            iteration_completed_(false) {}
+            iteration_completed_(false),
+            mapped_format_(params.dataset->write_mapped_format_) {}
 
       ~FileWriterIterator() override {
-        if (!dataset()->env_->FileExists(MetaFilename(filename_)).ok()) {
+        const bool complete =
+            mapped_format_
+                ? dataset()->MappedCacheExists()
+                : dataset()->env_->FileExists(MetaFilename(filename_)).ok();
+        if (!complete) {
           LOG(WARNING) << kIncompleteCacheErrorMessage;
+          mapped_writer_.reset();
+          const string pattern = strings::StrCat(
+              mapped_format_
+                  ? MappedCacheShardFilename(dataset()->filename_, shard_id_)
+                  : filename_,
+              "*");
           std::vector<string> cache_files;
-          Status s = dataset()->env_->GetMatchingPaths(
-              strings::StrCat(filename_, "*"), &cache_files);
+          Status s =
+              dataset()->env_->GetMatchingPaths(pattern, &cache_files);
           if (!s.ok()) {
-            LOG(WARNING) << "Failed to get matching files on " << filename_
-                         << "* : " << s.ToString();
+            LOG(WARNING) << "Failed to get matching files on " << pattern
+                         << " : " << s.ToString();
+          }
+          if (mapped_format_ && lockfile_created_) {
+            cache_files.push_back(lockfile_);
           }
           for (const string& path : cache_files) {
             s = dataset()->env_->DeleteFile(path);
@@ -327,7 +388,7 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
         if (*end_of_sequence) {
           return OkStatus();
         }
-        TF_RETURN_IF_ERROR(writer_->status());
+        TF_RETURN_IF_ERROR(WriterStatus());
         if (cur_index_ >= kMaxItems) {
           // As a courtesy, close the [truncated] cache file.
           Status s = Finish();
@@ -352,12 +413,7 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
               "Expected ",
               dataset()->num_tensors_, " got: ", out_tensors->size());
         }
-        size_t tensor_index = 0;
-        for (const Tensor& t : *out_tensors) {
-          DCHECK_LT(tensor_index, dataset()->num_tensors_);
-          string key = dataset()->FormatName(cur_index_, tensor_index++);
-          TF_RETURN_IF_ERROR(writer_->Add(key, t));
-        }
+        TF_RETURN_IF_ERROR(AddElement(*out_tensors));
         if (*end_of_sequence) {
           TF_RETURN_IF_ERROR(Finish());
         }
@@ -377,6 +433,9 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
         mutex_lock l(mu_);
         TF_RETURN_IF_ERROR(
             writer->WriteScalar(prefix(), kCurIndex, cur_index_));
+        if (mapped_format_) {
+          TF_RETURN_IF_ERROR(writer->WriteScalar(prefix(), kMappedFormat, ""));
+        }
 
         if (iteration_completed_) {
           TF_RETURN_IF_ERROR(
@@ -390,8 +449,8 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
         // about flushing the current shard. This ensures that we never write
         // empty shards.
         if (lockfile_created_) {
-          // Flush the current bundle.
-          TF_RETURN_IF_ERROR(writer_->Finish());
+          // Flush the current shard.
+          TF_RETURN_IF_ERROR(FinishShard());
 
           // Note: We do not delete the lockfile here. We keep lockfiles of
           // all shards around until the entire cache has been written to
@@ -422,6 +481,7 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
           }
         }
 
+        mapped_format_ = reader->Contains(prefix(), kMappedFormat);
         if (reader->Contains(prefix(), kIterationCompleted)) {
           iteration_completed_ = true;
           return OkStatus();
@@ -440,11 +500,45 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
         }
         filename_ = strings::StrCat(dataset()->filename_, "_", shard_id_);
         lockfile_ = strings::StrCat(filename_, kLockFileSuffix);
-        writer_ = std::make_unique<BundleWriter>(dataset()->env_, filename_);
+        NewShardWriter();
         return OkStatus();
       }
 
      private:
+      void NewShardWriter() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        if (mapped_format_) {
+          mapped_writer_ = std::make_unique<MappedCacheWriter>(
+              dataset()->env_,
+              MappedCacheShardFilename(dataset()->filename_, shard_id_),
+              dataset()->num_tensors_);
+        } else {
+          writer_ =
+              std::make_unique<BundleWriter>(dataset()->env_, filename_);
+        }
+      }
+
+      Status WriterStatus() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        return mapped_format_ ? mapped_writer_->status() : writer_->status();
+      }
+
+      Status AddElement(const std::vector<Tensor>& element)
+          TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        if (mapped_format_) {
+          return mapped_writer_->Add(element);
+        }
+        size_t tensor_index = 0;
+        for (const Tensor& t : element) {
+          DCHECK_LT(tensor_index, dataset()->num_tensors_);
+          string key = dataset()->FormatName(cur_index_, tensor_index++);
+          TF_RETURN_IF_ERROR(writer_->Add(key, t));
+        }
+        return OkStatus();
+      }
+
+      Status FinishShard() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        return mapped_format_ ? mapped_writer_->Finish() : writer_->Finish();
+      }
+
       Status EnsureLockFileExists(bool* end_of_sequence)
           TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
         if (iteration_completed_) {
@@ -460,7 +554,15 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
 
         // 1. Check that a checkpoint for the shard has not already been
         // written.
-        if (dataset()->env_->FileExists(MetaFilename(filename_)).ok()) {
+        if (mapped_format_) {
+          const string shard_filename =
+              MappedCacheShardFilename(dataset()->filename_, shard_id_);
+          if (dataset()->env_->FileExists(shard_filename).ok()) {
+            return errors::AlreadyExists(
+                "Existing cache files found: \n", shard_filename, "\n",
+                "To continue delete the above file.");
+          }
+        } else if (dataset()->env_->FileExists(MetaFilename(filename_)).ok()) {
           return errors::AlreadyExists("Existing cache files found: \n",
                                        MetaFilename(filename_), "\n",
                                        DataFilename(filename_, 0, 1), "\n",
@@ -502,15 +604,31 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
         // conditions are not met since BundleWriter's constructor creates
         // new temp files which can delete the temp files created by a
         // BundleWriter in another Session.
-        writer_ = std::make_unique<BundleWriter>(dataset()->env_, filename_);
+        NewShardWriter();
         lockfile_created_ = true;
         return OkStatus();
       }
 
       Status Finish() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
         iteration_completed_ = true;
-        // Flush the current bundle.
-        TF_RETURN_IF_ERROR(writer_->Finish());
+        // Flush the current shard.
+        TF_RETURN_IF_ERROR(FinishShard());
+        if (mapped_format_) {
+          // Mapped shards are read in place; the index file lists them.
+          TF_RETURN_IF_ERROR(FinalizeMappedCache(
+              dataset()->env_, dataset()->filename_, shard_id_ + 1));
+        } else {
+          TF_RETURN_IF_ERROR(MergeBundles());
+        }
+        // Delete all lockfiles.
+        for (size_t i = 0; i <= shard_id_; ++i) {
+          TF_RETURN_IF_ERROR(dataset()->env_->DeleteFile(
+              strings::StrCat(dataset()->filename_, "_", i, kLockFileSuffix)));
+        }
+        return OkStatus();
+      }
+
+      Status MergeBundles() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
         // Merge all the bundles.
         // Currently there are `shard_id_ + 1` bundles, one for each
         // checkpoint. Each bundle has prefix <filename>_<id> where `id` is an
@@ -525,13 +643,8 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
             prefixes.emplace_back(
                 strings::StrCat(dataset()->filename_, "_", i));
           }
-          TF_RETURN_IF_ERROR(
-              MergeBundles(dataset()->env_, prefixes, dataset()->filename_));
-        }
-        // Delete all lockfiles.
-        for (size_t i = 0; i <= shard_id_; ++i) {
-          TF_RETURN_IF_ERROR(dataset()->env_->DeleteFile(
-              strings::StrCat(dataset()->filename_, "_", i, kLockFileSuffix)));
+          TF_RETURN_IF_ERROR(tensorflow::MergeBundles(
+              dataset()->env_, prefixes, dataset()->filename_));
         }
         return OkStatus();
       }
@@ -549,6 +662,10 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
       string lockfile_ TF_GUARDED_BY(mu_);
       bool lockfile_created_ TF_GUARDED_BY(mu_);
       bool iteration_completed_ TF_GUARDED_BY(mu_);
+      // Whether the shards are written in the mapped format, by
+      // `mapped_writer_`, rather than as bundles, by `writer_`.
+      bool mapped_format_ TF_GUARDED_BY(mu_);
+      std::unique_ptr<MappedCacheWriter> mapped_writer_ TF_GUARDED_BY(mu_);
     };  // FileWriterIterator
 
     class FileReaderIterator : public DatasetIterator<FileDatasetBase> {
@@ -640,6 +757,70 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
       bool iterator_restored_ TF_GUARDED_BY(mu_);
     };  // FileReaderIterator
 
+    // MappedReaderIterator reads a cache written in the mapped format. The
+    // tensors it produces alias the mapped cache files where possible.
+    class MappedReaderIterator : public DatasetIterator<FileDatasetBase> {
+     public:
+      explicit MappedReaderIterator(const Params& params)
+          : DatasetIterator<FileDatasetBase>(params) {}
+
+      Status Initialize(IteratorContext* ctx) override {
+        mutex_lock l(mu_);
+        TF_RETURN_IF_ERROR(dataset()->GetMappedCache(&cache_));
+        if (cache_ == nullptr) {
+          return errors::NotFound(
+              "Cache index file ",
+              MappedCacheIndexFilename(dataset()->filename_), " not found");
+        }
+        return OkStatus();
+      }
+
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
+        mutex_lock l(mu_);
+        if (cur_index_ >= cache_->num_elements()) {
+          *end_of_sequence = true;
+          return OkStatus();
+        }
+        *end_of_sequence = false;
+        TF_RETURN_IF_ERROR(cache_->Get(cur_index_, out_tensors));
+        cur_index_++;
+        return OkStatus();
+      }
+
+     protected:
+      std::shared_ptr<model::Node> CreateNode(
+          IteratorContext* ctx, model::Node::Args args) const override {
+        return model::MakeKnownRatioNode(std::move(args),
+                                         /*ratio=*/1);
+      }
+
+      Status SaveInternal(SerializationContext* ctx,
+                          IteratorStateWriter* writer) override {
+        mutex_lock l(mu_);
+        TF_RETURN_IF_ERROR(
+            writer->WriteScalar(prefix(), kCurIndex, cur_index_));
+        return OkStatus();
+      }
+
+      Status RestoreInternal(IteratorContext* ctx,
+                             IteratorStateReader* reader) override {
+        mutex_lock l(mu_);
+        TF_RETURN_IF_ERROR(
+            reader->ReadScalar(prefix(), kCurIndex, &cur_index_));
+        if (cur_index_ < 0 || cur_index_ > cache_->num_elements()) {
+          return errors::Internal("Invalid value for cur_index ", cur_index_);
+        }
+        return OkStatus();
+      }
+
+     private:
+      mutex mu_;
+      int64_t cur_index_ TF_GUARDED_BY(mu_) = 0;
+      std::shared_ptr<MappedCacheReader> cache_ TF_GUARDED_BY(mu_);
+    };  // MappedReaderIterator
+
     Status InitializeIterator(IteratorContext* ctx)
         TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
       // We intentionally use the same prefix for both `FileReaderIterator` and
@@ -652,9 +833,15 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
       // `cur_index`.
       switch (mode_) {
         case Mode::read:
-          iterator_ =
-              std::make_unique<FileReaderIterator>(FileReaderIterator::Params{
-                  dataset(), strings::StrCat(prefix(), kImpl)});
+          if (dataset()->MappedCacheExists()) {
+            iterator_ = std::make_unique<MappedReaderIterator>(
+                MappedReaderIterator::Params{
+                    dataset(), strings::StrCat(prefix(), kImpl)});
+          } else {
+            iterator_ = std::make_unique<FileReaderIterator>(
+                FileReaderIterator::Params{dataset(),
+                                           strings::StrCat(prefix(), kImpl)});
+          }
           break;
         case Mode::write:
           iterator_ =
@@ -677,6 +864,11 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
   static constexpr size_t kMaxItems = 10000000;  // 10 million
   const size_t item_index_padding_size_;
   const string tensor_format_string_;
+  // Whether new caches are written in the mapped format.
+  const bool write_mapped_format_;
+  mutable mutex mapped_cache_mu_;
+  mutable std::shared_ptr<MappedCacheReader> mapped_cache_
+      TF_GUARDED_BY(mapped_cache_mu_);
 };  // FileDatasetBase
 
 class CacheDatasetOp::FileDataset : public CacheDatasetOp::FileDatasetBase {
@@ -763,7 +955,7 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
     return input_->Cardinality(options);
   };
 
-  Status Get(OpKernelContext* ctx, int64 index,
+  Status Get(AnyContext ctx, int64 index,
              std::vector<Tensor>* out_tensors) const override {
     mutex_lock l(mu_);
 
@@ -776,10 +968,17 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
       return errors::OutOfRange("Index out of range [0, ", cardinality,
                                 "):", index);
     }
+    // The temporary cache is filled by an iterator resource, which is only
+    // available to kernels.
+    if (ctx.op_kernel_context == nullptr) {
+      return errors::Unimplemented(
+          "Random access into an in-memory cache is only supported when "
+          "reading individual elements with `GetElementAtIndex`.");
+    }
     if (!partial_cache_) {
       partial_cache_ = std::make_unique<PartialCache>(input_);
     }
-    return partial_cache_->Get(ctx, index, out_tensors);
+    return partial_cache_->Get(ctx.op_kernel_context, index, out_tensors);
   }
 
   Status InputDatasets(std::vector<const DatasetBase*>* inputs) const override {
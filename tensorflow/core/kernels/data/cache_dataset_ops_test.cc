@@ -16,6 +16,7 @@ limitations under the License.
 
 #include "tensorflow/core/data/dataset_test_base.h"
 #include "tensorflow/core/data/dataset_utils.h"
+#include "tensorflow/core/data/mapped_cache.h"
 #include "tensorflow/core/data/serialization_utils.h"
 #include "tensorflow/core/platform/path.h"
 
@@ -204,6 +205,41 @@ TEST_P(ParameterizedGetNextTest, GetNext) {
 INSTANTIATE_TEST_SUITE_P(CacheDatasetOpTest, ParameterizedGetNextTest,
                          ::testing::ValuesIn(GetNextTestCases()));
 
+TEST_F(CacheDatasetOpTest, MappedFormat) {
+  setenv(kCacheFileFormatEnvVar, "mapped", /*overwrite=*/1);
+  auto dataset_params = CacheDatasetParams1();
+  Status s = Initialize(dataset_params);
+  unsetenv(kCacheFileFormatEnvVar);
+  TF_ASSERT_OK(s);
+  std::vector<Tensor> expected_outputs = CreateTensors<int64_t>(
+      TensorShape({3, 1}), {{0, 1, 2}, {3, 4, 5}, {6, 7, 8}});
+
+  // The write mode falls back to the input for random access.
+  std::vector<Tensor> element;
+  TF_ASSERT_OK(dataset_->Get(AnyContext(dataset_ctx_.get()), 1, &element));
+  TF_EXPECT_OK(ExpectEqual(element, {expected_outputs[1]},
+                           /*compare_order=*/true));
+
+  TF_ASSERT_OK(CheckIteratorGetNext(expected_outputs, /*compare_order=*/true));
+  EXPECT_TRUE(device_->env()
+                  ->FileExists(MappedCacheIndexFilename(
+                      dataset_params.filename()))
+                  .ok());
+
+  // The read mode serves the written cache, by position or by index.
+  TF_ASSERT_OK(dataset_->MakeIterator(iterator_ctx_.get(), /*parent=*/nullptr,
+                                      dataset_params.iterator_prefix(),
+                                      &iterator_));
+  TF_ASSERT_OK(CheckIteratorGetNext(expected_outputs, /*compare_order=*/true));
+  for (int64_t i : {2, 0, 1}) {
+    TF_ASSERT_OK(dataset_->Get(AnyContext(dataset_ctx_.get()), i, &element));
+    TF_EXPECT_OK(ExpectEqual(element, {expected_outputs[i]},
+                             /*compare_order=*/true));
+  }
+  EXPECT_TRUE(errors::IsOutOfRange(
+      dataset_->Get(AnyContext(dataset_ctx_.get()), 3, &element)));
+}
+
 TEST_F(CacheDatasetOpTest, DatasetNodeName) {
   auto dataset_params = CacheDatasetParams1();
   TF_ASSERT_OK(Initialize(dataset_params));
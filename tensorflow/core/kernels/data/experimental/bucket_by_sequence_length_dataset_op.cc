@@ -0,0 +1,651 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/bucket_by_sequence_length_dataset_op.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/data/dataset_utils.h"
+#include "tensorflow/core/data/name_utils.h"
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_util.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/util/batch_util.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+
+// Constants declared in bucket_by_sequence_length_dataset_op.h and used both
+// here and in test cases.
+/* static */ constexpr const char* const
+    BucketBySequenceLengthDatasetOp::kDatasetType;
+/* static */ constexpr const char* const
+    BucketBySequenceLengthDatasetOp::kInputDataset;
+/* static */ constexpr const char* const
+    BucketBySequenceLengthDatasetOp::kBucketBoundaries;
+/* static */ constexpr const char* const
+    BucketBySequenceLengthDatasetOp::kBucketBatchSizes;
+/* static */ constexpr const char* const
+    BucketBySequenceLengthDatasetOp::kPaddingValues;
+/* static */ constexpr const char* const
+    BucketBySequenceLengthDatasetOp::kLengthComponent;
+/* static */ constexpr const char* const
+    BucketBySequenceLengthDatasetOp::kPadToBucketBoundary;
+/* static */ constexpr const char* const
+    BucketBySequenceLengthDatasetOp::kDropRemainder;
+/* static */ constexpr const char* const
+    BucketBySequenceLengthDatasetOp::kToutputTypes;
+/* static */ constexpr const char* const
+    BucketBySequenceLengthDatasetOp::kOutputShapes;
+
+namespace {
+
+constexpr char kInputImplEmpty[] = "input_impl_empty";
+constexpr char kNextFlushBucket[] = "next_flush_bucket";
+constexpr char kNumElements[] = "num_elements";
+constexpr char kBatch[] = "batch";
+constexpr char kElement[] = "element";
+
+// Returns the shape `batch_size` elements of `shape` once batched.
+StatusOr<TensorShape> BatchShape(int64_t batch_size, const TensorShape& shape) {
+  TensorShape batch_shape({batch_size});
+  TF_RETURN_IF_ERROR(batch_shape.AppendShapeWithStatus(shape));
+  return batch_shape;
+}
+
+}  // namespace
+
+class BucketBySequenceLengthDatasetOp::Dataset : public DatasetBase {
+ public:
+  Dataset(OpKernelContext* ctx, const DatasetBase* input,
+          std::vector<int64_t> bucket_boundaries,
+          std::vector<int64_t> bucket_batch_sizes,
+          std::vector<Tensor> padding_values, int64_t length_component,
+          bool pad_to_bucket_boundary, bool drop_remainder)
+      : DatasetBase(DatasetContext(ctx)),
+        input_(input),
+        bucket_boundaries_(std::move(bucket_boundaries)),
+        bucket_batch_sizes_(std::move(bucket_batch_sizes)),
+        padding_values_(std::move(padding_values)),
+        length_component_(length_component),
+        pad_to_bucket_boundary_(pad_to_bucket_boundary),
+        drop_remainder_(drop_remainder) {
+    input_->Ref();
+    const auto& input_shapes = input_->output_shapes();
+    output_shapes_.reserve(input_shapes.size());
+    for (const PartialTensorShape& shape : input_shapes) {
+      output_shapes_.push_back(PartialTensorShape({-1}).Concatenate(shape));
+    }
+    // The elements of a bucket are padded to the same shape. Dimensions with
+    // a static size keep it. With `pad_to_bucket_boundary`, the others are
+    // padded to the largest length of the bucket, and otherwise to the
+    // largest size in the batch.
+    padded_shapes_.resize(num_buckets());
+    for (int64_t bucket = 0; bucket < num_buckets(); ++bucket) {
+      for (const PartialTensorShape& shape : input_shapes) {
+        PartialTensorShape padded_shape = shape;
+        if (pad_to_bucket_boundary_ && bucket < num_buckets() - 1) {
+          for (int dim = 0; dim < padded_shape.dims(); ++dim) {
+            if (padded_shape.dim_size(dim) == -1) {
+              padded_shape.set_dim(dim, bucket_boundaries_[bucket] - 1);
+            }
+          }
+        }
+        padded_shapes_[bucket].push_back(std::move(padded_shape));
+      }
+      dense_buckets_.push_back(absl::c_all_of(
+          padded_shapes_[bucket], [](const PartialTensorShape& shape) {
+            return shape.IsFullyDefined();
+          }));
+    }
+  }
+
+  ~Dataset() override { input_->Unref(); }
+
+  std::unique_ptr<IteratorBase> MakeIteratorInternal(
+      const string& prefix) const override {
+    return std::make_unique<Iterator>(Iterator::Params{
+        this, name_utils::IteratorPrefix(kDatasetType, prefix)});
+  }
+
+  const DataTypeVector& output_dtypes() const override {
+    return input_->output_dtypes();
+  }
+
+  const std::vector<PartialTensorShape>& output_shapes() const override {
+    return output_shapes_;
+  }
+
+  string DebugString() const override {
+    return name_utils::DatasetDebugString(kDatasetType);
+  }
+
+  int64_t CardinalityInternal(CardinalityOptions options) const override {
+    int64_t n = input_->Cardinality(options);
+    if (n == kInfiniteCardinality) {
+      return n;
+    }
+    // The number of batches depends on the lengths of the elements.
+    return kUnknownCardinality;
+  }
+
+  Status InputDatasets(std::vector<const DatasetBase*>* inputs) const override {
+    inputs->push_back(input_);
+    return OkStatus();
+  }
+
+  Status CheckExternalState() const override {
+    return input_->CheckExternalState();
+  }
+
+ protected:
+  Status AsGraphDefInternal(SerializationContext* ctx,
+                            DatasetGraphDefBuilder* b,
+                            Node** output) const override {
+    Node* input_graph_node = nullptr;
+    TF_RETURN_IF_ERROR(b->AddInputDataset(ctx, input_, &input_graph_node));
+    Node* bucket_boundaries = nullptr;
+    TF_RETURN_IF_ERROR(b->AddVector(bucket_boundaries_, &bucket_boundaries));
+    Node* bucket_batch_sizes = nullptr;
+    TF_RETURN_IF_ERROR(b->AddVector(bucket_batch_sizes_, &bucket_batch_sizes));
+    std::vector<Node*> padding_values;
+    padding_values.reserve(padding_values_.size());
+    for (const Tensor& t : padding_values_) {
+      Node* node;
+      TF_RETURN_IF_ERROR(b->AddTensor(t, &node));
+      padding_values.emplace_back(node);
+    }
+    AttrValue length_component;
+    b->BuildAttrValue(length_component_, &length_component);
+    AttrValue pad_to_bucket_boundary;
+    b->BuildAttrValue(pad_to_bucket_boundary_, &pad_to_bucket_boundary);
+    AttrValue drop_remainder;
+    b->BuildAttrValue(drop_remainder_, &drop_remainder);
+    AttrValue output_types;
+    b->BuildAttrValue(output_dtypes(), &output_types);
+    return b->AddDataset(this,
+                         {{0, input_graph_node},
+                          {1, bucket_boundaries},
+                          {2, bucket_batch_sizes}},
+                         {{3, padding_values}},
+                         {{kLengthComponent, length_component},
+                          {kPadToBucketBoundary, pad_to_bucket_boundary},
+                          {kDropRemainder, drop_remainder},
+                          {kToutputTypes, output_types}},
+                         output);
+  }
+
+ private:
+  class Iterator : public DatasetIterator<Dataset> {
+   public:
+    explicit Iterator(const Params& params)
+        : DatasetIterator<Dataset>(params),
+          buckets_(params.dataset->num_buckets()) {}
+
+    Status Initialize(IteratorContext* ctx) override {
+      return dataset()->input_->MakeIterator(ctx, this, prefix(), &input_impl_);
+    }
+
+    Status GetNextInternal(IteratorContext* ctx,
+                           std::vector<Tensor>* out_tensors,
+                           bool* end_of_sequence) override {
+      mutex_lock l(mu_);
+      while (input_impl_) {
+        std::vector<Tensor> element;
+        bool end_of_input = false;
+        TF_RETURN_IF_ERROR(input_impl_->GetNext(ctx, &element, &end_of_input));
+        if (end_of_input) {
+          input_impl_.reset();
+          break;
+        }
+        int64_t bucket_index;
+        TF_RETURN_IF_ERROR(BucketIndex(element, &bucket_index));
+        Bucket& bucket = buckets_[bucket_index];
+        TF_RETURN_IF_ERROR(Add(ctx, bucket_index, std::move(element)));
+        if (bucket.num_elements ==
+            dataset()->bucket_batch_sizes_[bucket_index]) {
+          TF_RETURN_IF_ERROR(Flush(ctx, bucket_index, out_tensors));
+          *end_of_sequence = false;
+          return OkStatus();
+        }
+      }
+      // The input is exhausted. Produce the partial batches in bucket order.
+      for (; next_flush_bucket_ < buckets_.size(); ++next_flush_bucket_) {
+        if (buckets_[next_flush_bucket_].num_elements == 0) {
+          continue;
+        }
+        if (dataset()->drop_remainder_) {
+          buckets_[next_flush_bucket_] = Bucket();
+          continue;
+        }
+        TF_RETURN_IF_ERROR(Flush(ctx, next_flush_bucket_++, out_tensors));
+        *end_of_sequence = false;
+        return OkStatus();
+      }
+      *end_of_sequence = true;
+      return OkStatus();
+    }
+
+   protected:
+    std::shared_ptr<model::Node> CreateNode(
+        IteratorContext* ctx, model::Node::Args args) const override {
+      return model::MakeUnknownRatioNode(std::move(args));
+    }
+
+    Status SaveInternal(SerializationContext* ctx,
+                        IteratorStateWriter* writer) override {
+      mutex_lock l(mu_);
+      TF_RETURN_IF_ERROR(writer->WriteScalar(
+          prefix(), kInputImplEmpty, static_cast<int64_t>(!input_impl_)));
+      if (input_impl_) {
+        TF_RETURN_IF_ERROR(SaveInput(ctx, writer, input_impl_));
+      }
+      TF_RETURN_IF_ERROR(
+          writer->WriteScalar(prefix(), kNextFlushBucket, next_flush_bucket_));
+      for (int64_t i = 0; i < buckets_.size(); ++i) {
+        const Bucket& bucket = buckets_[i];
+        const std::string bucket_prefix = absl::StrCat(prefix(), "::", i);
+        TF_RETURN_IF_ERROR(writer->WriteScalar(bucket_prefix, kNumElements,
+                                               bucket.num_elements));
+        if (bucket.num_elements == 0) {
+          continue;
+        }
+        if (IsDense(i)) {
+          for (int64_t c = 0; c < bucket.batch.size(); ++c) {
+            TF_RETURN_IF_ERROR(writer->WriteTensor(
+                bucket_prefix, absl::StrCat(kBatch, "[", c, "]"),
+                bucket.batch[c].Slice(0, bucket.num_elements)));
+          }
+          continue;
+        }
+        for (int64_t j = 0; j < bucket.elements.size(); ++j) {
+          for (int64_t c = 0; c < bucket.elements[j].size(); ++c) {
+            TF_RETURN_IF_ERROR(writer->WriteTensor(
+                bucket_prefix, absl::StrCat(kElement, "[", j, "][", c, "]"),
+                bucket.elements[j][c]));
+          }
+        }
+      }
+      return OkStatus();
+    }
+
+    Status RestoreInternal(IteratorContext* ctx,
+                           IteratorStateReader* reader) override {
+      mutex_lock l(mu_);
+      int64_t input_empty;
+      TF_RETURN_IF_ERROR(
+          reader->ReadScalar(prefix(), kInputImplEmpty, &input_empty));
+      if (static_cast<bool>(input_empty)) {
+        input_impl_.reset();
+      } else {
+        TF_RETURN_IF_ERROR(
+            dataset()->input_->MakeIterator(ctx, this, prefix(), &input_impl_));
+        TF_RETURN_IF_ERROR(RestoreInput(ctx, reader, input_impl_));
+      }
+      TF_RETURN_IF_ERROR(
+          reader->ReadScalar(prefix(), kNextFlushBucket, &next_flush_bucket_));
+      const int64_t num_components = dataset()->output_dtypes().size();
+      for (int64_t i = 0; i < buckets_.size(); ++i) {
+        Bucket& bucket = buckets_[i];
+        bucket = Bucket();
+        const std::string bucket_prefix = absl::StrCat(prefix(), "::", i);
+        int64_t num_elements;
+        TF_RETURN_IF_ERROR(
+            reader->ReadScalar(bucket_prefix, kNumElements, &num_elements));
+        if (num_elements == 0) {
+          continue;
+        }
+        if (IsDense(i)) {
+          TF_RETURN_IF_ERROR(AllocateBatch(ctx, i));
+          for (int64_t c = 0; c < num_components; ++c) {
+            Tensor saved;
+            TF_RETURN_IF_ERROR(reader->ReadTensor(
+                ctx->flr(), bucket_prefix, absl::StrCat(kBatch, "[", c, "]"),
+                &saved));
+            TF_RETURN_IF_ERROR(batch_util::CopyContiguousSlices(
+                saved, /*src_offset=*/0, /*dst_offset=*/0, num_elements,
+                &bucket.batch[c]));
+          }
+          bucket.num_elements = num_elements;
+          continue;
+        }
+        bucket.elements.resize(num_elements);
+        for (int64_t j = 0; j < num_elements; ++j) {
+          bucket.elements[j].resize(num_components);
+          for (int64_t c = 0; c < num_components; ++c) {
+            TF_RETURN_IF_ERROR(reader->ReadTensor(
+                ctx->flr(), bucket_prefix,
+                absl::StrCat(kElement, "[", j, "][", c, "]"),
+                &bucket.elements[j][c]));
+          }
+        }
+        bucket.num_elements = num_elements;
+      }
+      return OkStatus();
+    }
+
+   private:
+    // The elements of a bucket which have not been produced yet.
+    struct Bucket {
+      int64_t num_elements = 0;
+      // If the padded shapes of the bucket are static, the elements are copied
+      // into their padded batch as they arrive.
+      std::vector<Tensor> batch;
+      // Otherwise, they are kept until the batch is complete.
+      std::vector<std::vector<Tensor>> elements;
+    };
+
+    // Returns true if the elements of `bucket_index` are copied into a batch
+    // as they arrive.
+    bool IsDense(int64_t bucket_index) const {
+      return dataset()->dense_buckets_[bucket_index];
+    }
+
+    Status BucketIndex(const std::vector<Tensor>& element,
+                       int64_t* bucket_index) const {
+      const Tensor& component = element[dataset()->length_component_];
+      int64_t length;
+      if (TensorShapeUtils::IsScalar(component.shape()) &&
+          component.dtype() == DT_INT64) {
+        length = component.scalar<int64_t>()();
+      } else if (TensorShapeUtils::IsScalar(component.shape()) &&
+                 component.dtype() == DT_INT32) {
+        length = component.scalar<int32_t>()();
+      } else if (component.dims() > 0) {
+        length = component.dim_size(0);
+      } else {
+        return errors::InvalidArgument(
+            "The length component of `bucket_by_sequence_length` must be an "
+            "integer scalar or have at least one dimension, but got a ",
+            DataTypeString(component.dtype()), " scalar.");
+      }
+      const auto& boundaries = dataset()->bucket_boundaries_;
+      *bucket_index =
+          std::upper_bound(boundaries.begin(), boundaries.end(), length) -
+          boundaries.begin();
+      if (dataset()->pad_to_bucket_boundary_ &&
+          *bucket_index == boundaries.size()) {
+        return errors::InvalidArgument(
+            "When `pad_to_bucket_boundary` is true, elements must have length "
+            "< max(bucket_boundaries) = ",
+            boundaries.back(), ", but got an element of length ", length, ".");
+      }
+      return OkStatus();
+    }
+
+    // Allocates the padded batch of `bucket_index`.
+    Status AllocateBatch(IteratorContext* ctx, int64_t bucket_index)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      Bucket& bucket = buckets_[bucket_index];
+      const auto& padded_shapes = dataset()->padded_shapes_[bucket_index];
+      bucket.batch.clear();
+      bucket.batch.reserve(padded_shapes.size());
+      for (int64_t c = 0; c < padded_shapes.size(); ++c) {
+        TensorShape padded_shape;
+        if (!padded_shapes[c].AsTensorShape(&padded_shape)) {
+          return errors::Internal("Padded shape ",
+                                  padded_shapes[c].DebugString(),
+                                  " is not fully defined.");
+        }
+        TF_ASSIGN_OR_RETURN(
+            TensorShape batch_shape,
+            BatchShape(dataset()->bucket_batch_sizes_[bucket_index],
+                       padded_shape));
+        bucket.batch.emplace_back(ctx->allocator({}),
+                                  dataset()->output_dtypes()[c], batch_shape);
+        TF_RETURN_IF_ERROR(batch_util::SetElementZero(
+            &bucket.batch.back(), dataset()->padding_values_[c]));
+      }
+      return OkStatus();
+    }
+
+    // Adds `element` to the bucket `bucket_index`.
+    Status Add(IteratorContext* ctx, int64_t bucket_index,
+               std::vector<Tensor> element) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      Bucket& bucket = buckets_[bucket_index];
+      const auto& padded_shapes = dataset()->padded_shapes_[bucket_index];
+      for (int64_t c = 0; c < element.size(); ++c) {
+        TF_RETURN_IF_ERROR(CheckFitsPaddedShape(c, element[c].shape(),
+                                                padded_shapes[c]));
+      }
+      if (!IsDense(bucket_index)) {
+        bucket.elements.push_back(std::move(element));
+        ++bucket.num_elements;
+        return OkStatus();
+      }
+      if (bucket.num_elements == 0) {
+        TF_RETURN_IF_ERROR(AllocateBatch(ctx, bucket_index));
+      }
+      for (int64_t c = 0; c < element.size(); ++c) {
+        Tensor& batch = bucket.batch[c];
+        if (element[c].NumElements() * bucket_batch_size(bucket_index) ==
+            batch.NumElements()) {
+          TF_RETURN_IF_ERROR(batch_util::CopyElementToSlice(
+              std::move(element[c]), &batch, bucket.num_elements));
+        } else {
+          TF_RETURN_IF_ERROR(batch_util::CopyElementToLargerSlice(
+              element[c], &batch, bucket.num_elements));
+        }
+      }
+      ++bucket.num_elements;
+      return OkStatus();
+    }
+
+    // Produces the batch of bucket `bucket_index` and empties the bucket.
+    Status Flush(IteratorContext* ctx, int64_t bucket_index,
+                 std::vector<Tensor>* out_tensors)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      Bucket bucket = std::move(buckets_[bucket_index]);
+      buckets_[bucket_index] = Bucket();
+      out_tensors->clear();
+      if (IsDense(bucket_index)) {
+        for (Tensor& batch : bucket.batch) {
+          if (bucket.num_elements == batch.dim_size(0)) {
+            out_tensors->push_back(std::move(batch));
+          } else {
+            out_tensors->push_back(batch.Slice(0, bucket.num_elements));
+          }
+        }
+        return OkStatus();
+      }
+      return PadBatch(ctx, bucket.elements, out_tensors);
+    }
+
+    // Copies `elements` into one batch per component, padding each dimension
+    // to its largest size in the batch.
+    Status PadBatch(IteratorContext* ctx,
+                    const std::vector<std::vector<Tensor>>& elements,
+                    std::vector<Tensor>* out_tensors) const {
+      const int64_t num_elements = elements.size();
+      for (int64_t c = 0; c < elements[0].size(); ++c) {
+        TensorShape component_shape = elements[0][c].shape();
+        for (int64_t i = 1; i < num_elements; ++i) {
+          const TensorShape& shape = elements[i][c].shape();
+          if (shape.dims() != component_shape.dims()) {
+            return errors::InvalidArgument(
+                "All elements in a batch must have the same rank for "
+                "component ",
+                c, ": expected rank ", component_shape.dims(),
+                " but got element with rank ", shape.dims());
+          }
+          for (int dim = 0; dim < shape.dims(); ++dim) {
+            if (shape.dim_size(dim) > component_shape.dim_size(dim)) {
+              component_shape.set_dim(dim, shape.dim_size(dim));
+            }
+          }
+        }
+        TF_ASSIGN_OR_RETURN(TensorShape batch_shape,
+                            BatchShape(num_elements, component_shape));
+        out_tensors->emplace_back(ctx->allocator({}),
+                                  dataset()->output_dtypes()[c], batch_shape);
+        Tensor& batch = out_tensors->back();
+        TF_RETURN_IF_ERROR(
+            batch_util::SetElementZero(&batch, dataset()->padding_values_[c]));
+        for (int64_t i = 0; i < num_elements; ++i) {
+          if (elements[i][c].shape() == component_shape) {
+            TF_RETURN_IF_ERROR(
+                batch_util::CopyElementToSlice(elements[i][c], &batch, i));
+          } else {
+            TF_RETURN_IF_ERROR(batch_util::CopyElementToLargerSlice(
+                elements[i][c], &batch, i));
+          }
+        }
+      }
+      return OkStatus();
+    }
+
+    Status CheckFitsPaddedShape(int64_t component, const TensorShape& shape,
+                                const PartialTensorShape& padded_shape) const {
+      if (padded_shape.unknown_rank()) {
+        return OkStatus();
+      }
+      if (shape.dims() != padded_shape.dims()) {
+        return errors::InvalidArgument(
+            "Expected component ", component, " to have rank ",
+            padded_shape.dims(), " but got an element with shape ",
+            shape.DebugString(), ".");
+      }
+      for (int dim = 0; dim < shape.dims(); ++dim) {
+        if (padded_shape.dim_size(dim) != -1 &&
+            shape.dim_size(dim) > padded_shape.dim_size(dim)) {
+          return errors::InvalidArgument(
+              "Attempted to pad component ", component, " with shape ",
+              shape.DebugString(), " to the smaller shape ",
+              padded_shape.DebugString(), ".");
+        }
+      }
+      return OkStatus();
+    }
+
+    int64_t bucket_batch_size(int64_t bucket_index) const {
+      return dataset()->bucket_batch_sizes_[bucket_index];
+    }
+
+    mutex mu_;
+    std::unique_ptr<IteratorBase> input_impl_ TF_GUARDED_BY(mu_);
+    std::vector<Bucket> buckets_ TF_GUARDED_BY(mu_);
+    // Once the input is exhausted, the next bucket whose partial batch is
+    // produced.
+    int64_t next_flush_bucket_ TF_GUARDED_BY(mu_) = 0;
+  };
+
+  int64_t num_buckets() const { return bucket_batch_sizes_.size(); }
+
+  const DatasetBase* const input_;
+  const std::vector<int64_t> bucket_boundaries_;
+  const std::vector<int64_t> bucket_batch_sizes_;
+  const std::vector<Tensor> padding_values_;
+  const int64_t length_component_;
+  const bool pad_to_bucket_boundary_;
+  const bool drop_remainder_;
+  std::vector<PartialTensorShape> output_shapes_;
+  // The shapes the components of each bucket are padded to.
+  std::vector<std::vector<PartialTensorShape>> padded_shapes_;
+  // Whether the padded shapes of each bucket are fully defined.
+  std::vector<bool> dense_buckets_;
+};
+
+BucketBySequenceLengthDatasetOp::BucketBySequenceLengthDatasetOp(
+    OpKernelConstruction* ctx)
+    : UnaryDatasetOpKernel(ctx) {
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kLengthComponent, &length_component_));
+  OP_REQUIRES_OK(ctx,
+                 ctx->GetAttr(kPadToBucketBoundary, &pad_to_bucket_boundary_));
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kDropRemainder, &drop_remainder_));
+}
+
+void BucketBySequenceLengthDatasetOp::MakeDataset(OpKernelContext* ctx,
+                                                  DatasetBase* input,
+                                                  DatasetBase** output) {
+  std::vector<int64_t> bucket_boundaries;
+  OP_REQUIRES_OK(ctx, ParseVectorArgument<int64_t>(ctx, kBucketBoundaries,
+                                                   &bucket_boundaries));
+  for (size_t i = 1; i < bucket_boundaries.size(); ++i) {
+    OP_REQUIRES(ctx, bucket_boundaries[i - 1] < bucket_boundaries[i],
+                errors::InvalidArgument(
+                    "`bucket_boundaries` must be strictly increasing."));
+  }
+  std::vector<int64_t> bucket_batch_sizes;
+  OP_REQUIRES_OK(ctx, ParseVectorArgument<int64_t>(ctx, kBucketBatchSizes,
+                                                   &bucket_batch_sizes));
+  OP_REQUIRES(
+      ctx, bucket_batch_sizes.size() == bucket_boundaries.size() + 1,
+      errors::InvalidArgument(
+          "`bucket_batch_sizes` must have one more element than "
+          "`bucket_boundaries`, but got ",
+          bucket_batch_sizes.size(), " batch sizes and ",
+          bucket_boundaries.size(), " boundaries."));
+  for (int64_t batch_size : bucket_batch_sizes) {
+    OP_REQUIRES(ctx, batch_size > 0,
+                errors::InvalidArgument(
+                    "`bucket_batch_sizes` must be greater than zero."));
+  }
+  OP_REQUIRES(ctx, !pad_to_bucket_boundary_ || !bucket_boundaries.empty(),
+              errors::InvalidArgument("`pad_to_bucket_boundary` requires at "
+                                      "least one bucket boundary."));
+  const int64_t num_components = input->output_dtypes().size();
+  OP_REQUIRES(ctx, length_component_ >= 0 && length_component_ < num_components,
+              errors::InvalidArgument("`length_component` must be in [0, ",
+                                      num_components, "), but got ",
+                                      length_component_, "."));
+
+  OpInputList padding_values_list;
+  OP_REQUIRES_OK(ctx, ctx->input_list(kPaddingValues, &padding_values_list));
+  OP_REQUIRES(ctx, padding_values_list.size() == num_components,
+              errors::InvalidArgument(
+                  "Number of padding values (", padding_values_list.size(),
+                  ") must match the number of components in the input "
+                  "dataset's elements (",
+                  num_components, ")"));
+  std::vector<Tensor> padding_values;
+  for (int i = 0; i < padding_values_list.size(); ++i) {
+    const Tensor& padding_value_t = padding_values_list[i];
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(padding_value_t.shape()),
+                errors::InvalidArgument("All padding values must be scalars"));
+    OP_REQUIRES(ctx, padding_value_t.dtype() == input->output_dtypes()[i],
+                errors::InvalidArgument(
+                    "Mismatched type between padding value ", i,
+                    " and input dataset's component ", i, ": ",
+                    DataTypeString(padding_value_t.dtype()), " vs. ",
+                    DataTypeString(input->output_dtypes()[i])));
+    padding_values.push_back(tensor::DeepCopy(padding_value_t));
+  }
+
+  *output = new Dataset(ctx, input, std::move(bucket_boundaries),
+                        std::move(bucket_batch_sizes),
+                        std::move(padding_values), length_component_,
+                        pad_to_bucket_boundary_, drop_remainder_);
+}
+
+namespace {
+REGISTER_KERNEL_BUILDER(
+    Name("BucketBySequenceLengthDataset").Device(DEVICE_CPU),
+    BucketBySequenceLengthDatasetOp);
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,255 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/bucket_by_sequence_length_dataset_op.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/data/dataset_test_base.h"
+#include "tensorflow/core/platform/status_matchers.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+using ::tensorflow::testing::StatusIs;
+
+constexpr char kNodeName[] = "bucket_by_sequence_length_dataset";
+
+class BucketBySequenceLengthDatasetParams : public DatasetParams {
+ public:
+  template <typename T>
+  BucketBySequenceLengthDatasetParams(
+      T input_dataset_params, std::vector<int64_t> bucket_boundaries,
+      std::vector<int64_t> bucket_batch_sizes,
+      std::vector<Tensor> padding_values, bool pad_to_bucket_boundary,
+      bool drop_remainder, DataTypeVector output_dtypes,
+      std::vector<PartialTensorShape> output_shapes, string node_name)
+      : DatasetParams(std::move(output_dtypes), std::move(output_shapes),
+                      std::move(node_name)),
+        bucket_boundaries_(std::move(bucket_boundaries)),
+        bucket_batch_sizes_(std::move(bucket_batch_sizes)),
+        padding_values_(std::move(padding_values)),
+        pad_to_bucket_boundary_(pad_to_bucket_boundary),
+        drop_remainder_(drop_remainder) {
+    input_dataset_params_.push_back(std::make_unique<T>(input_dataset_params));
+    iterator_prefix_ =
+        name_utils::IteratorPrefix(input_dataset_params.dataset_type(),
+                                   input_dataset_params.iterator_prefix());
+  }
+
+  std::vector<Tensor> GetInputTensors() const override {
+    std::vector<Tensor> input_tensors = {
+        CreateTensor<int64_t>(
+            TensorShape({static_cast<int64_t>(bucket_boundaries_.size())}),
+            bucket_boundaries_),
+        CreateTensor<int64_t>(
+            TensorShape({static_cast<int64_t>(bucket_batch_sizes_.size())}),
+            bucket_batch_sizes_)};
+    for (const Tensor& padding_value : padding_values_) {
+      input_tensors.push_back(padding_value);
+    }
+    return input_tensors;
+  }
+
+  Status GetInputNames(std::vector<string>* input_names) const override {
+    *input_names = {BucketBySequenceLengthDatasetOp::kInputDataset,
+                    BucketBySequenceLengthDatasetOp::kBucketBoundaries,
+                    BucketBySequenceLengthDatasetOp::kBucketBatchSizes};
+    for (int i = 0; i < padding_values_.size(); ++i) {
+      input_names->push_back(absl::StrCat(
+          BucketBySequenceLengthDatasetOp::kPaddingValues, "_", i));
+    }
+    return OkStatus();
+  }
+
+  Status GetAttributes(AttributeVector* attr_vector) const override {
+    *attr_vector = {
+        {BucketBySequenceLengthDatasetOp::kLengthComponent, 0},
+        {BucketBySequenceLengthDatasetOp::kPadToBucketBoundary,
+         pad_to_bucket_boundary_},
+        {BucketBySequenceLengthDatasetOp::kDropRemainder, drop_remainder_},
+        {BucketBySequenceLengthDatasetOp::kToutputTypes, output_dtypes_},
+        {BucketBySequenceLengthDatasetOp::kOutputShapes, output_shapes_},
+        {"metadata", ""}};
+    return OkStatus();
+  }
+
+  string dataset_type() const override {
+    return BucketBySequenceLengthDatasetOp::kDatasetType;
+  }
+
+ private:
+  std::vector<int64_t> bucket_boundaries_;
+  std::vector<int64_t> bucket_batch_sizes_;
+  std::vector<Tensor> padding_values_;
+  bool pad_to_bucket_boundary_;
+  bool drop_remainder_;
+};
+
+class BucketBySequenceLengthDatasetOpTest : public DatasetOpsTestBase {};
+
+// Sequences [0, 1, 2], [3, 4, 5], [6, 7, 8] and [9].
+BatchDatasetParams SequenceParams() {
+  return BatchDatasetParams(RangeDatasetParams(0, 10, 1),
+                            /*batch_size=*/3,
+                            /*drop_remainder=*/false,
+                            /*parallel_copy=*/false,
+                            /*output_dtypes=*/{DT_INT64},
+                            /*output_shapes=*/{PartialTensorShape({-1})},
+                            /*node_name=*/"batch");
+}
+
+BucketBySequenceLengthDatasetParams BucketParams(
+    std::vector<int64_t> bucket_boundaries,
+    std::vector<int64_t> bucket_batch_sizes, bool pad_to_bucket_boundary,
+    bool drop_remainder) {
+  return BucketBySequenceLengthDatasetParams(
+      SequenceParams(), std::move(bucket_boundaries),
+      std::move(bucket_batch_sizes),
+      /*padding_values=*/{CreateTensor<int64_t>(TensorShape({}), {-1})},
+      pad_to_bucket_boundary, drop_remainder,
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({-1, -1})}, kNodeName);
+}
+
+std::vector<GetNextTestCase<BucketBySequenceLengthDatasetParams>>
+GetNextTestCases() {
+  return {
+      // Full batches are produced as soon as their bucket fills up, and
+      // partial batches at the end in bucket order.
+      {/*dataset_params=*/BucketParams(/*bucket_boundaries=*/{2},
+                                       /*bucket_batch_sizes=*/{2, 2},
+                                       /*pad_to_bucket_boundary=*/false,
+                                       /*drop_remainder=*/false),
+       /*expected_outputs=*/
+       {CreateTensor<int64_t>(TensorShape({2, 3}), {0, 1, 2, 3, 4, 5}),
+        CreateTensor<int64_t>(TensorShape({1, 1}), {9}),
+        CreateTensor<int64_t>(TensorShape({1, 3}), {6, 7, 8})}},
+      // Elements are padded to the largest length in their batch.
+      {/*dataset_params=*/BucketParams(/*bucket_boundaries=*/{4},
+                                       /*bucket_batch_sizes=*/{2, 2},
+                                       /*pad_to_bucket_boundary=*/false,
+                                       /*drop_remainder=*/false),
+       /*expected_outputs=*/
+       {CreateTensor<int64_t>(TensorShape({2, 3}), {0, 1, 2, 3, 4, 5}),
+        CreateTensor<int64_t>(TensorShape({2, 3}), {6, 7, 8, 9, -1, -1})}},
+      // Elements are padded to the largest length of their bucket.
+      {/*dataset_params=*/BucketParams(/*bucket_boundaries=*/{2, 5},
+                                       /*bucket_batch_sizes=*/{1, 2, 1},
+                                       /*pad_to_bucket_boundary=*/true,
+                                       /*drop_remainder=*/false),
+       /*expected_outputs=*/
+       {CreateTensor<int64_t>(TensorShape({2, 4}),
+                              {0, 1, 2, -1, 3, 4, 5, -1}),
+        CreateTensor<int64_t>(TensorShape({1, 1}), {9}),
+        CreateTensor<int64_t>(TensorShape({1, 4}), {6, 7, 8, -1})}},
+      // Partial batches are dropped.
+      {/*dataset_params=*/BucketParams(/*bucket_boundaries=*/{2},
+                                       /*bucket_batch_sizes=*/{2, 2},
+                                       /*pad_to_bucket_boundary=*/false,
+                                       /*drop_remainder=*/true),
+       /*expected_outputs=*/
+       {CreateTensor<int64_t>(TensorShape({2, 3}), {0, 1, 2, 3, 4, 5})}}};
+}
+
+ITERATOR_GET_NEXT_TEST_P(BucketBySequenceLengthDatasetOpTest,
+                         BucketBySequenceLengthDatasetParams,
+                         GetNextTestCases())
+
+TEST_F(BucketBySequenceLengthDatasetOpTest, DatasetNodeName) {
+  auto dataset_params = BucketParams({2}, {2, 2}, false, false);
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetNodeName(dataset_params.node_name()));
+}
+
+TEST_F(BucketBySequenceLengthDatasetOpTest, DatasetTypeString) {
+  auto dataset_params = BucketParams({2}, {2, 2}, false, false);
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetTypeString(
+      name_utils::OpName(BucketBySequenceLengthDatasetOp::kDatasetType)));
+}
+
+TEST_F(BucketBySequenceLengthDatasetOpTest, DatasetOutputShapes) {
+  auto dataset_params = BucketParams({2}, {2, 2}, false, false);
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetOutputShapes({PartialTensorShape({-1, -1})}));
+}
+
+TEST_F(BucketBySequenceLengthDatasetOpTest, Cardinality) {
+  auto dataset_params = BucketParams({2}, {2, 2}, false, false);
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetCardinality(kUnknownCardinality));
+}
+
+std::vector<IteratorSaveAndRestoreTestCase<BucketBySequenceLengthDatasetParams>>
+IteratorSaveAndRestoreTestCases() {
+  return {
+      {/*dataset_params=*/BucketParams({2}, {2, 2}, false, false),
+       /*breakpoints=*/{0, 1, 2, 5},
+       /*expected_outputs=*/
+       {CreateTensor<int64_t>(TensorShape({2, 3}), {0, 1, 2, 3, 4, 5}),
+        CreateTensor<int64_t>(TensorShape({1, 1}), {9}),
+        CreateTensor<int64_t>(TensorShape({1, 3}), {6, 7, 8})}},
+      {/*dataset_params=*/BucketParams({2, 5}, {1, 2, 1}, true, false),
+       /*breakpoints=*/{0, 1, 2, 5},
+       /*expected_outputs=*/
+       {CreateTensor<int64_t>(TensorShape({2, 4}),
+                              {0, 1, 2, -1, 3, 4, 5, -1}),
+        CreateTensor<int64_t>(TensorShape({1, 1}), {9}),
+        CreateTensor<int64_t>(TensorShape({1, 4}), {6, 7, 8, -1})}}};
+}
+
+ITERATOR_SAVE_AND_RESTORE_TEST_P(BucketBySequenceLengthDatasetOpTest,
+                                 BucketBySequenceLengthDatasetParams,
+                                 IteratorSaveAndRestoreTestCases())
+
+TEST_F(BucketBySequenceLengthDatasetOpTest, LengthBeyondLastBoundary) {
+  auto dataset_params = BucketParams(/*bucket_boundaries=*/{2},
+                                     /*bucket_batch_sizes=*/{2, 2},
+                                     /*pad_to_bucket_boundary=*/true,
+                                     /*drop_remainder=*/false);
+  TF_ASSERT_OK(Initialize(dataset_params));
+  std::vector<Tensor> out_tensors;
+  bool end_of_sequence = false;
+  EXPECT_THAT(
+      iterator_->GetNext(iterator_ctx_.get(), &out_tensors, &end_of_sequence),
+      StatusIs(error::INVALID_ARGUMENT));
+}
+
+TEST_F(BucketBySequenceLengthDatasetOpTest, InvalidArguments) {
+  std::vector<BucketBySequenceLengthDatasetParams> invalid_params = {
+      // Boundaries must be increasing.
+      BucketParams({4, 2}, {1, 1, 1}, false, false),
+      // There must be one batch size per bucket.
+      BucketParams({2}, {1}, false, false),
+      // Batch sizes must be positive.
+      BucketParams({2}, {1, 0}, false, false)};
+  TF_ASSERT_OK(InitializeRuntime(invalid_params[0]));
+  for (const auto& dataset_params : invalid_params) {
+    std::unique_ptr<TestDataset> dataset;
+    EXPECT_THAT(MakeDataset(dataset_params, &dataset),
+                StatusIs(error::INVALID_ARGUMENT));
+  }
+}
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/shape_inference.h"
+#include "tensorflow/core/kernels/csv_parsing.h"
 #include "tensorflow/core/lib/io/inputstream_interface.h"
 #include "tensorflow/core/lib/io/random_inputstream.h"
 #include "tensorflow/core/lib/io/zlib_compression_options.h"
@@ -562,7 +563,9 @@ class CSVDatasetOp : public DatasetOpKernel {
             }
 
           } else {
-            pos_++;
+            // Skip to the next quote.
+            size_t quote = StringPiece(buffer_).find('"', pos_);
+            pos_ = quote == StringPiece::npos ? buffer_.size() : quote;
           }
         }
       }
@@ -681,9 +684,11 @@ class CSVDatasetOp : public DatasetOpKernel {
             // Take note of the error, but keep going to end of field.
             parse_result.Update(errors::InvalidArgument(
                 "Unquoted fields cannot have quotes inside"));
+            pos_++;
           }
-          // Otherwise, go to next character
-          pos_++;
+          // Otherwise, skip to the next character that may end the field.
+          pos_ = FindCsvFieldEnd(buffer_, pos_, dataset()->delim_,
+                                 dataset()->use_quote_delim_);
         }
       }
 
@@ -730,7 +735,7 @@ class CSVDatasetOp : public DatasetOpKernel {
                   dataset()->record_defaults_[output_idx].flat<int32>()(0);
             } else {
               int32_t value;
-              if (!strings::safe_strto32(field, &value)) {
+              if (!ParseCsvInt32(field, &value)) {
                 return errors::InvalidArgument(
                     "Field ", output_idx,
                     " in record is not a valid int32: ", field);
@@ -745,7 +750,7 @@ class CSVDatasetOp : public DatasetOpKernel {
                   dataset()->record_defaults_[output_idx].flat<int64_t>()(0);
             } else {
               int64_t value;
-              if (!strings::safe_strto64(field, &value)) {
+              if (!ParseCsvInt64(field, &value)) {
                 return errors::InvalidArgument(
                     "Field ", output_idx,
                     " in record is not a valid int64: ", field);
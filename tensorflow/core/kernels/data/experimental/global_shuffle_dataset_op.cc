@@ -0,0 +1,443 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/global_shuffle_dataset_op.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/data/dataset_utils.h"
+#include "tensorflow/core/data/name_utils.h"
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/model.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/kernels/data/random_seed_ops.h"
+#include "tensorflow/core/kernels/random_index_shuffle.h"
+#include "tensorflow/core/lib/gtl/cleanup.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+
+// Constants declared in global_shuffle_dataset_op.h and used both here and in
+// test cases.
+/* static */ constexpr const char* const GlobalShuffleDatasetOp::kDatasetType;
+/* static */ constexpr const char* const GlobalShuffleDatasetOp::kInputDataset;
+/* static */ constexpr const char* const GlobalShuffleDatasetOp::kSeed;
+/* static */ constexpr const char* const GlobalShuffleDatasetOp::kSeed2;
+/* static */ constexpr const char* const GlobalShuffleDatasetOp::kWindowSize;
+/* static */ constexpr const char* const
+    GlobalShuffleDatasetOp::kReshuffleEachIteration;
+/* static */ constexpr const char* const GlobalShuffleDatasetOp::kOutputTypes;
+/* static */ constexpr const char* const GlobalShuffleDatasetOp::kOutputShapes;
+
+namespace {
+
+constexpr char kEpochNumRandomSamples[] = "epoch_num_random_samples";
+constexpr char kNextPosition[] = "next_position";
+
+// Number of rounds of the permutation's block cipher. This is the setting
+// recommended by `random::index_shuffle`.
+constexpr int32_t kNumRounds = 8;
+
+// Number of windows the iterator reads ahead of its consumer.
+constexpr int64_t kNumPrefetchedWindows = 2;
+
+std::array<uint32_t, 3> PermutationKey(int64_t seed, int64_t seed2) {
+  return {static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32),
+          static_cast<uint32_t>(seed2) ^ static_cast<uint32_t>(seed2 >> 32)};
+}
+
+// Returns the input index of output `position` in the permutation of
+// [0, cardinality) selected by `key`.
+int64_t PermutedIndex(int64_t position, const std::array<uint32_t, 3>& key,
+                      int64_t cardinality) {
+  return static_cast<int64_t>(
+      random::index_shuffle(position, key, cardinality - 1, kNumRounds));
+}
+
+Status CheckShuffleCompatible(const DatasetBase* input, int64_t cardinality) {
+  if (cardinality == kInfiniteCardinality ||
+      cardinality == kUnknownCardinality) {
+    return errors::FailedPrecondition(
+        "`global_shuffle` requires an input dataset of known, finite "
+        "cardinality that supports random access. Got ",
+        input->DebugString(), " with ",
+        cardinality == kInfiniteCardinality ? "infinite" : "unknown",
+        " cardinality.");
+  }
+  return OkStatus();
+}
+
+}  // namespace
+
+class GlobalShuffleDatasetOp::Dataset : public DatasetBase {
+ public:
+  Dataset(OpKernelContext* ctx, const DatasetBase* input, int64_t window_size,
+          RandomSeeds&& seeds, bool reshuffle_each_iteration)
+      : DatasetBase(DatasetContext(ctx)),
+        input_(input),
+        window_size_(window_size),
+        seeds_(std::move(seeds)),
+        reshuffle_each_iteration_(reshuffle_each_iteration) {
+    if (reshuffle_each_iteration_) {
+      seed_generator_ = std::make_shared<RandomSeedGenerator>(seeds_);
+    } else {
+      seed_generator_ = std::make_shared<FixedSeedGenerator>(seeds_);
+    }
+    input_->Ref();
+  }
+
+  ~Dataset() override { input_->Unref(); }
+
+  std::unique_ptr<IteratorBase> MakeIteratorInternal(
+      const string& prefix) const override {
+    return std::make_unique<Iterator>(Iterator::Params{
+        this, name_utils::IteratorPrefix(kDatasetType, prefix)});
+  }
+
+  const DataTypeVector& output_dtypes() const override {
+    return input_->output_dtypes();
+  }
+
+  const std::vector<PartialTensorShape>& output_shapes() const override {
+    return input_->output_shapes();
+  }
+
+  string DebugString() const override {
+    name_utils::DatasetDebugStringParams params;
+    params.set_args(window_size_, seeds_.input_seed(), seeds_.input_seed2());
+    return name_utils::DatasetDebugString(kDatasetType, params);
+  }
+
+  int64_t CardinalityInternal(CardinalityOptions options) const override {
+    return input_->Cardinality(options);
+  }
+
+  Status InputDatasets(std::vector<const DatasetBase*>* inputs) const override {
+    inputs->push_back(input_);
+    return OkStatus();
+  }
+
+  Status CheckExternalState() const override {
+    return input_->CheckExternalState();
+  }
+
+  // Random access uses the permutation of the first epoch.
+  Status Get(AnyContext ctx, int64 index,
+             std::vector<Tensor>* out_tensors) const override {
+    TF_RETURN_IF_ERROR(CheckRandomAccessCompatible(index));
+    CardinalityOptions options;
+    options.set_compute_level(CardinalityOptions::CARDINALITY_COMPUTE_MODERATE);
+    return input_->Get(
+        ctx,
+        PermutedIndex(index, PermutationKey(seeds_.seed(), seeds_.seed2()),
+                      Cardinality(options)),
+        out_tensors);
+  }
+
+ protected:
+  Status AsGraphDefInternal(SerializationContext* ctx,
+                            DatasetGraphDefBuilder* b,
+                            Node** output) const override {
+    Node* input_graph_node = nullptr;
+    TF_RETURN_IF_ERROR(b->AddInputDataset(ctx, input_, &input_graph_node));
+    Node* seed_node = nullptr;
+    Node* seed2_node = nullptr;
+    Node* window_size_node = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(seeds_.input_seed(), &seed_node));
+    TF_RETURN_IF_ERROR(b->AddScalar(seeds_.input_seed2(), &seed2_node));
+    TF_RETURN_IF_ERROR(b->AddScalar(window_size_, &window_size_node));
+    AttrValue reshuffle_each_iteration;
+    b->BuildAttrValue(reshuffle_each_iteration_, &reshuffle_each_iteration);
+    return b->AddDataset(
+        this, {input_graph_node, seed_node, seed2_node, window_size_node},
+        {std::make_pair(kReshuffleEachIteration, reshuffle_each_iteration)},
+        output);
+  }
+
+ private:
+  class Iterator : public DatasetIterator<Dataset> {
+   public:
+    explicit Iterator(const Params& params)
+        : DatasetIterator<Dataset>(params) {}
+
+    ~Iterator() override {
+      CancelThreads();
+      if (deregister_fn_) deregister_fn_();
+    }
+
+    bool SymbolicCheckpointCompatible() const override { return true; }
+
+    Status Initialize(IteratorContext* ctx) override {
+      mutex_lock l(mu_);
+      CardinalityOptions options;
+      options.set_compute_level(
+          CardinalityOptions::CARDINALITY_COMPUTE_MODERATE);
+      cardinality_ = dataset()->input_->Cardinality(options);
+      TF_RETURN_IF_ERROR(
+          CheckShuffleCompatible(dataset()->input_, cardinality_));
+      dataset()->seed_generator_->GenerateSeeds(&seed_, &seed2_);
+      key_ = PermutationKey(seed_, seed2_);
+      return RegisterCancellationCallback(
+          ctx->cancellation_manager(), [this]() { CancelThreads(); },
+          &deregister_fn_);
+    }
+
+    Status GetNextInternal(IteratorContext* ctx,
+                           std::vector<Tensor>* out_tensors,
+                           bool* end_of_sequence) override {
+      mutex_lock l(mu_);
+      if (next_position_ >= cardinality_) {
+        *end_of_sequence = true;
+        return OkStatus();
+      }
+      EnsureThreadStarted(ctx);
+      while (!cancelled_ && buffer_.empty()) {
+        RecordStop(ctx);
+        cond_var_.wait(l);
+        RecordStart(ctx);
+      }
+      if (cancelled_) {
+        return errors::Cancelled("Iterator was cancelled");
+      }
+      Element element = std::move(buffer_.front());
+      buffer_.pop_front();
+      next_position_ += element.num_positions;
+      cond_var_.notify_all();
+      TF_RETURN_IF_ERROR(element.status);
+      *out_tensors = std::move(element.value);
+      *end_of_sequence = false;
+      return OkStatus();
+    }
+
+   protected:
+    std::shared_ptr<model::Node> CreateNode(
+        IteratorContext* ctx, model::Node::Args args) const override {
+      return model::MakeAsyncKnownRatioNode(std::move(args), /*ratio=*/1,
+                                            /*parameters=*/{});
+    }
+
+    // The output at every position is determined by the seeds, so the state
+    // only consists of the seeds and the number of elements produced.
+    Status SaveInternal(SerializationContext* ctx,
+                        IteratorStateWriter* writer) override {
+      mutex_lock l(mu_);
+      TF_RETURN_IF_ERROR(writer->WriteScalar(
+          full_name(kEpochNumRandomSamples),
+          dataset()->seed_generator_->num_random_samples()));
+      TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kSeed), seed_));
+      TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kSeed2), seed2_));
+      TF_RETURN_IF_ERROR(
+          writer->WriteScalar(full_name(kNextPosition), next_position_));
+      return OkStatus();
+    }
+
+    Status RestoreInternal(IteratorContext* ctx,
+                           IteratorStateReader* reader) override {
+      mutex_lock l(mu_);
+      int64_t num_random_samples;
+      TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kEpochNumRandomSamples),
+                                            &num_random_samples));
+      dataset()->seed_generator_->set_num_random_samples(num_random_samples);
+      dataset()->seed_generator_->Reset();
+      TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kSeed), &seed_));
+      TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kSeed2), &seed2_));
+      TF_RETURN_IF_ERROR(
+          reader->ReadScalar(full_name(kNextPosition), &next_position_));
+      key_ = PermutationKey(seed_, seed2_);
+      // Elements read ahead for the old position are discarded, and the
+      // windows in flight are dropped when they complete.
+      buffer_.clear();
+      read_position_ = next_position_;
+      ++generation_;
+      cond_var_.notify_all();
+      return OkStatus();
+    }
+
+   private:
+    struct Element {
+      Status status;
+      std::vector<Tensor> value;
+      // Number of positions the element accounts for. A failed window is
+      // reported as a single element.
+      int64_t num_positions = 1;
+    };
+
+    void CancelThreads() TF_LOCKS_EXCLUDED(mu_) {
+      mutex_lock l(mu_);
+      cancelled_ = true;
+      cond_var_.notify_all();
+    }
+
+    void EnsureThreadStarted(IteratorContext* ctx)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (!prefetch_thread_) {
+        std::shared_ptr<IteratorContext> new_ctx =
+            std::make_shared<IteratorContext>(*ctx);
+        prefetch_thread_ =
+            ctx->StartThread("tf_data_global_shuffle",
+                             [this, new_ctx]() { PrefetchThread(new_ctx); });
+      }
+    }
+
+    // Reads windows of permuted elements into `buffer_`, at most
+    // `kNumPrefetchedWindows` windows ahead of the consumer.
+    void PrefetchThread(const std::shared_ptr<IteratorContext>& ctx) {
+      RecordStart(ctx.get());
+      auto cleanup = gtl::MakeCleanup([this, ctx] { RecordStop(ctx.get()); });
+      const int64_t window_size = dataset()->window_size_;
+      while (true) {
+        int64_t begin;
+        int64_t end;
+        int64_t generation;
+        std::array<uint32_t, 3> key;
+        {
+          mutex_lock l(mu_);
+          while (!cancelled_ &&
+                 (read_position_ >= cardinality_ ||
+                  buffer_.size() >= kNumPrefetchedWindows * window_size)) {
+            RecordStop(ctx.get());
+            cond_var_.wait(l);
+            RecordStart(ctx.get());
+          }
+          if (cancelled_) {
+            return;
+          }
+          begin = read_position_;
+          end = std::min(begin + window_size, cardinality_);
+          generation = generation_;
+          key = key_;
+        }
+
+        std::vector<Element> window(end - begin);
+        Status s = ReadWindow(ctx.get(), begin, key, window);
+
+        mutex_lock l(mu_);
+        if (generation != generation_) {
+          continue;
+        }
+        if (!s.ok()) {
+          // The error is reported in place of the first element of the window,
+          // and the rest of the window is skipped.
+          window.resize(1);
+          window.front().status = s;
+          window.front().value.clear();
+          window.front().num_positions = end - begin;
+        }
+        for (Element& element : window) {
+          buffer_.push_back(std::move(element));
+        }
+        read_position_ = end;
+        cond_var_.notify_all();
+      }
+    }
+
+    // Reads the elements at positions [begin, begin + window.size()) of the
+    // permutation selected by `key`. The input is read in increasing index
+    // order so that it can coalesce the reads of nearby elements.
+    Status ReadWindow(IteratorContext* ctx, int64_t begin,
+                      const std::array<uint32_t, 3>& key,
+                      std::vector<Element>& window) {
+      // Pairs of input index and position in the window.
+      std::vector<std::pair<int64_t, int64_t>> permuted(window.size());
+      for (size_t i = 0; i < window.size(); ++i) {
+        permuted[i] = {PermutedIndex(begin + i, key, cardinality_), i};
+      }
+      std::sort(permuted.begin(), permuted.end());
+      std::vector<int64_t> indices(permuted.size());
+      for (size_t i = 0; i < permuted.size(); ++i) {
+        indices[i] = permuted[i].first;
+      }
+      std::vector<std::vector<Tensor>> elements;
+      TF_RETURN_IF_ERROR(
+          dataset()->input_->GetMany(AnyContext(ctx), indices, &elements));
+      if (elements.size() != indices.size()) {
+        return errors::Internal("Expected ", indices.size(),
+                                " elements from the input, but got ",
+                                elements.size(), ".");
+      }
+      for (size_t i = 0; i < permuted.size(); ++i) {
+        window[permuted[i].second].value = std::move(elements[i]);
+      }
+      return OkStatus();
+    }
+
+    mutex mu_;
+    condition_variable cond_var_;
+    int64_t cardinality_ TF_GUARDED_BY(mu_) = 0;
+    int64_t seed_ TF_GUARDED_BY(mu_) = 0;
+    int64_t seed2_ TF_GUARDED_BY(mu_) = 0;
+    std::array<uint32_t, 3> key_ TF_GUARDED_BY(mu_) = {0, 0, 0};
+    // Position of the next element returned by `GetNext`.
+    int64_t next_position_ TF_GUARDED_BY(mu_) = 0;
+    // Position of the next element read by the prefetch thread.
+    int64_t read_position_ TF_GUARDED_BY(mu_) = 0;
+    // Incremented on restore to invalidate windows in flight.
+    int64_t generation_ TF_GUARDED_BY(mu_) = 0;
+    std::deque<Element> buffer_ TF_GUARDED_BY(mu_);
+    bool cancelled_ TF_GUARDED_BY(mu_) = false;
+    std::function<void()> deregister_fn_;
+    std::unique_ptr<Thread> prefetch_thread_ TF_GUARDED_BY(mu_);
+  };
+
+  const DatasetBase* const input_;
+  const int64_t window_size_;
+  const RandomSeeds seeds_;
+  const bool reshuffle_each_iteration_;
+  std::shared_ptr<SeedGenerator> seed_generator_;
+};
+
+GlobalShuffleDatasetOp::GlobalShuffleDatasetOp(OpKernelConstruction* ctx)
+    : UnaryDatasetOpKernel(ctx) {
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kReshuffleEachIteration,
+                                   &reshuffle_each_iteration_));
+}
+
+void GlobalShuffleDatasetOp::MakeDataset(OpKernelContext* ctx,
+                                         DatasetBase* input,
+                                         DatasetBase** output) {
+  int64_t seed;
+  OP_REQUIRES_OK(ctx, ParseScalarArgument<int64_t>(ctx, kSeed, &seed));
+  int64_t seed2;
+  OP_REQUIRES_OK(ctx, ParseScalarArgument<int64_t>(ctx, kSeed2, &seed2));
+  int64_t window_size;
+  OP_REQUIRES_OK(
+      ctx, ParseScalarArgument<int64_t>(ctx, kWindowSize, &window_size));
+  OP_REQUIRES(
+      ctx, window_size > 0,
+      errors::InvalidArgument("`window_size` must be greater than zero."));
+  *output = new Dataset(ctx, input, window_size, RandomSeeds(seed, seed2),
+                        reshuffle_each_iteration_);
+}
+
+namespace {
+REGISTER_KERNEL_BUILDER(Name("GlobalShuffleDataset").Device(DEVICE_CPU),
+                        GlobalShuffleDatasetOp);
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
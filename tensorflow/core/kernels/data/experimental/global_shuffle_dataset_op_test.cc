@@ -0,0 +1,222 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/global_shuffle_dataset_op.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/data/dataset_test_base.h"
+#include "tensorflow/core/platform/status_matchers.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+using ::tensorflow::testing::StatusIs;
+
+constexpr char kNodeName[] = "global_shuffle_dataset";
+
+class GlobalShuffleDatasetParams : public DatasetParams {
+ public:
+  template <typename T>
+  GlobalShuffleDatasetParams(T input_dataset_params, int64_t seed,
+                             int64_t seed2, int64_t window_size,
+                             bool reshuffle_each_iteration,
+                             DataTypeVector output_dtypes,
+                             std::vector<PartialTensorShape> output_shapes,
+                             string node_name)
+      : DatasetParams(std::move(output_dtypes), std::move(output_shapes),
+                      std::move(node_name)),
+        seed_(seed),
+        seed2_(seed2),
+        window_size_(window_size),
+        reshuffle_each_iteration_(reshuffle_each_iteration) {
+    input_dataset_params_.push_back(std::make_unique<T>(input_dataset_params));
+    iterator_prefix_ =
+        name_utils::IteratorPrefix(input_dataset_params.dataset_type(),
+                                   input_dataset_params.iterator_prefix());
+  }
+
+  std::vector<Tensor> GetInputTensors() const override {
+    return {CreateTensor<int64_t>(TensorShape({}), {seed_}),
+            CreateTensor<int64_t>(TensorShape({}), {seed2_}),
+            CreateTensor<int64_t>(TensorShape({}), {window_size_})};
+  }
+
+  Status GetInputNames(std::vector<string>* input_names) const override {
+    *input_names = {GlobalShuffleDatasetOp::kInputDataset,
+                    GlobalShuffleDatasetOp::kSeed,
+                    GlobalShuffleDatasetOp::kSeed2,
+                    GlobalShuffleDatasetOp::kWindowSize};
+    return OkStatus();
+  }
+
+  Status GetAttributes(AttributeVector* attr_vector) const override {
+    *attr_vector = {{GlobalShuffleDatasetOp::kOutputTypes, output_dtypes_},
+                    {GlobalShuffleDatasetOp::kOutputShapes, output_shapes_},
+                    {GlobalShuffleDatasetOp::kReshuffleEachIteration,
+                     reshuffle_each_iteration_},
+                    {"metadata", ""}};
+    return OkStatus();
+  }
+
+  string dataset_type() const override {
+    return GlobalShuffleDatasetOp::kDatasetType;
+  }
+
+ private:
+  int64_t seed_;
+  int64_t seed2_;
+  int64_t window_size_;
+  bool reshuffle_each_iteration_;
+};
+
+class GlobalShuffleDatasetOpTest : public DatasetOpsTestBase {
+ protected:
+  // Returns all the elements produced by `iterator`.
+  StatusOr<std::vector<Tensor>> GetAll(TestIterator& iterator) {
+    std::vector<Tensor> outputs;
+    bool end_of_sequence = false;
+    while (!end_of_sequence) {
+      std::vector<Tensor> next;
+      TF_RETURN_IF_ERROR(iterator.GetNext(&next, &end_of_sequence));
+      outputs.insert(outputs.end(), next.begin(), next.end());
+    }
+    return outputs;
+  }
+};
+
+GlobalShuffleDatasetParams ShuffleRangeParams(
+    int64_t window_size, bool reshuffle_each_iteration = false) {
+  return GlobalShuffleDatasetParams(
+      RangeDatasetParams(0, 100, 1),
+      /*seed=*/42, /*seed2=*/7, window_size, reshuffle_each_iteration,
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({})}, kNodeName);
+}
+
+std::vector<Tensor> RangeOutputs(int64_t n) {
+  std::vector<Tensor> outputs;
+  for (int64_t i = 0; i < n; ++i) {
+    outputs.push_back(CreateTensor<int64_t>(TensorShape({}), {i}));
+  }
+  return outputs;
+}
+
+TEST_F(GlobalShuffleDatasetOpTest, ProducesPermutation) {
+  for (int64_t window_size : {1, 7, 100, 1000}) {
+    GlobalShuffleDatasetParams params = ShuffleRangeParams(window_size);
+    std::unique_ptr<TestDataset> dataset;
+    TF_ASSERT_OK(InitializeRuntime(params));
+    TF_ASSERT_OK(MakeDataset(params, &dataset));
+    std::unique_ptr<TestIterator> iterator;
+    TF_ASSERT_OK(MakeIterator(params, *dataset, &iterator));
+    TF_ASSERT_OK_AND_ASSIGN(std::vector<Tensor> outputs, GetAll(*iterator));
+    TF_EXPECT_OK(ExpectEqual(outputs, RangeOutputs(100),
+                             /*compare_order=*/false));
+    EXPECT_FALSE(ExpectEqual(outputs, RangeOutputs(100),
+                             /*compare_order=*/true)
+                     .ok());
+  }
+}
+
+TEST_F(GlobalShuffleDatasetOpTest, OrderDoesNotDependOnWindowSize) {
+  std::vector<std::vector<Tensor>> outputs;
+  for (int64_t window_size : {1, 7, 100}) {
+    GlobalShuffleDatasetParams params = ShuffleRangeParams(window_size);
+    std::unique_ptr<TestDataset> dataset;
+    TF_ASSERT_OK(InitializeRuntime(params));
+    TF_ASSERT_OK(MakeDataset(params, &dataset));
+    std::unique_ptr<TestIterator> iterator;
+    TF_ASSERT_OK(MakeIterator(params, *dataset, &iterator));
+    TF_ASSERT_OK_AND_ASSIGN(std::vector<Tensor> output, GetAll(*iterator));
+    outputs.push_back(std::move(output));
+  }
+  TF_EXPECT_OK(ExpectEqual(outputs[0], outputs[1], /*compare_order=*/true));
+  TF_EXPECT_OK(ExpectEqual(outputs[0], outputs[2], /*compare_order=*/true));
+}
+
+TEST_F(GlobalShuffleDatasetOpTest, ReshuffleEachIteration) {
+  GlobalShuffleDatasetParams params =
+      ShuffleRangeParams(/*window_size=*/10, /*reshuffle_each_iteration=*/true);
+  std::unique_ptr<TestDataset> dataset;
+  TF_ASSERT_OK(InitializeRuntime(params));
+  TF_ASSERT_OK(MakeDataset(params, &dataset));
+  std::unique_ptr<TestIterator> iterator1, iterator2;
+  TF_ASSERT_OK(MakeIterator(params, *dataset, &iterator1));
+  TF_ASSERT_OK(MakeIterator(params, *dataset, &iterator2));
+  TF_ASSERT_OK_AND_ASSIGN(std::vector<Tensor> outputs1, GetAll(*iterator1));
+  TF_ASSERT_OK_AND_ASSIGN(std::vector<Tensor> outputs2, GetAll(*iterator2));
+  TF_EXPECT_OK(ExpectEqual(outputs1, outputs2, /*compare_order=*/false));
+  EXPECT_FALSE(ExpectEqual(outputs1, outputs2, /*compare_order=*/true).ok());
+}
+
+TEST_F(GlobalShuffleDatasetOpTest, RandomAccessMatchesIteration) {
+  GlobalShuffleDatasetParams params = ShuffleRangeParams(/*window_size=*/10);
+  TF_ASSERT_OK(Initialize(params));
+  std::vector<Tensor> outputs;
+  bool end_of_sequence = false;
+  for (int64_t i = 0; i < 100; ++i) {
+    std::vector<Tensor> next;
+    TF_ASSERT_OK(
+        iterator_->GetNext(iterator_ctx_.get(), &next, &end_of_sequence));
+    ASSERT_FALSE(end_of_sequence);
+    std::vector<Tensor> element;
+    TF_ASSERT_OK(
+        dataset_->Get(AnyContext(dataset_ctx_.get()), i, &element));
+    TF_EXPECT_OK(ExpectEqual(element, next, /*compare_order=*/true));
+  }
+}
+
+TEST_F(GlobalShuffleDatasetOpTest, SaveAndRestore) {
+  GlobalShuffleDatasetParams params = ShuffleRangeParams(/*window_size=*/8);
+  TF_ASSERT_OK(Initialize(params));
+  std::vector<Tensor> expected_outputs;
+  bool end_of_sequence = false;
+  while (!end_of_sequence) {
+    std::vector<Tensor> next;
+    TF_ASSERT_OK(
+        iterator_->GetNext(iterator_ctx_.get(), &next, &end_of_sequence));
+    expected_outputs.insert(expected_outputs.end(), next.begin(), next.end());
+  }
+  TF_ASSERT_OK(CheckIteratorSaveAndRestore(
+      params.iterator_prefix(), expected_outputs,
+      /*breakpoints=*/{0, 3, 8, 9, 50, 120}, /*compare_order=*/true));
+}
+
+TEST_F(GlobalShuffleDatasetOpTest, InvalidWindowSize) {
+  GlobalShuffleDatasetParams params = ShuffleRangeParams(/*window_size=*/0);
+  EXPECT_THAT(Initialize(params), StatusIs(error::INVALID_ARGUMENT));
+}
+
+TEST_F(GlobalShuffleDatasetOpTest, EmptyInput) {
+  GlobalShuffleDatasetParams params = GlobalShuffleDatasetParams(
+      RangeDatasetParams(0, 0, 1),
+      /*seed=*/42, /*seed2=*/7, /*window_size=*/10,
+      /*reshuffle_each_iteration=*/false,
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({})}, kNodeName);
+  TF_ASSERT_OK(Initialize(params));
+  TF_EXPECT_OK(CheckIteratorGetNext(/*expected_outputs=*/{},
+                                    /*compare_order=*/true));
+}
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
@@ -29,7 +29,9 @@ limitations under the License.
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/stats_aggregator.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/variant.h"
 #include "tensorflow/core/kernels/inplace_ops_functor.h"
+#include "tensorflow/core/kernels/ragged_tensor_variant.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/random/random.h"
@@ -41,6 +43,7 @@ limitations under the License.
 #include "tensorflow/core/platform/tracing.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
 #include "tensorflow/core/profiler/lib/traceme_encode.h"
+#include "tensorflow/core/util/batch_util.h"
 
 namespace tensorflow {
 namespace data {
@@ -59,6 +62,9 @@ namespace experimental {
 /* static */ constexpr const char* const MapAndBatchDatasetOp::kOutputShapes;
 /* static */ constexpr const char* const
     MapAndBatchDatasetOp::kPreserveCardinality;
+/* static */ constexpr const char* const
+    MapAndBatchDatasetOp::kRaggedComponents;
+/* static */ constexpr const char* const MapAndBatchDatasetOp::kTsplits;
 
 // Maximum number of batch results to buffer.
 
@@ -79,6 +85,142 @@ constexpr char kStatus[] = "status";
 // Computes ceil(x / y).
 inline int64_t CeilDiv(int64_t x, int64_t y) { return (x + y - 1) / y; }
 
+// Stacks the vector `elements` of variant-encoded `RaggedTensor`s into a
+// scalar variant encoding a single `RaggedTensor` with one more ragged
+// dimension. The values of the elements are copied into a single flat buffer
+// and their row splits are concatenated, so that consumers can decode the batch
+// without stacking the elements again.
+template <typename SPLITS_TYPE>
+Status StackRaggedElements(Allocator* allocator, const Tensor& elements,
+                           int64_t component_index, Tensor* output) {
+  const DataType splits_type = DataTypeToEnum<SPLITS_TYPE>::v();
+  if (elements.dims() != 1) {
+    return errors::InvalidArgument(
+        "Ragged component ", component_index,
+        " must be a scalar variant, but got a batch of shape ",
+        elements.shape().DebugString(), ".");
+  }
+  const auto elements_vec = elements.vec<Variant>();
+  const int64_t num_elements = elements_vec.size();
+  std::vector<const RaggedTensorVariant*> ragged_elements;
+  ragged_elements.reserve(num_elements);
+  for (int64_t i = 0; i < num_elements; ++i) {
+    const RaggedTensorVariant* element =
+        elements_vec(i).get<RaggedTensorVariant>();
+    if (element == nullptr) {
+      return errors::InvalidArgument(
+          "Ragged component ", component_index, " of element ", i,
+          " doesn't hold a RaggedTensorVariant: ",
+          elements_vec(i).DebugString());
+    }
+    const RaggedTensorVariant* first =
+        ragged_elements.empty() ? element : ragged_elements.front();
+    if (element->values().dims() < 1) {
+      return errors::InvalidArgument(
+          "Ragged component ", component_index, " of element ", i,
+          " has scalar values, which cannot be batched into a ragged tensor.");
+    }
+    if (element->ragged_rank() != first->ragged_rank() ||
+        element->values().dtype() != first->values().dtype()) {
+      return errors::InvalidArgument(
+          "Ragged component ", component_index, " of element ", i,
+          " has ragged rank ", element->ragged_rank(), " and type ",
+          DataTypeString(element->values().dtype()),
+          ", but the first element of the batch has ragged rank ",
+          first->ragged_rank(), " and type ",
+          DataTypeString(first->values().dtype()), ".");
+    }
+    TensorShape inner_shape = element->values().shape();
+    inner_shape.RemoveDim(0);
+    TensorShape first_inner_shape = first->values().shape();
+    first_inner_shape.RemoveDim(0);
+    if (inner_shape != first_inner_shape) {
+      return errors::InvalidArgument(
+          "Ragged component ", component_index, " of element ", i,
+          " has values of shape ", element->values().shape().DebugString(),
+          ", which is incompatible with the values of shape ",
+          first->values().shape().DebugString(),
+          " of the first element of the batch.");
+    }
+    for (const Tensor& splits : element->nested_splits()) {
+      if (splits.dtype() != splits_type || splits.dims() != 1 ||
+          splits.NumElements() == 0) {
+        return errors::InvalidArgument(
+            "Ragged component ", component_index, " of element ", i,
+            " has row splits ", splits.DebugString(), ", but expected a ",
+            "non-empty vector of type ", DataTypeString(splits_type), ".");
+      }
+    }
+    ragged_elements.push_back(element);
+  }
+  if (ragged_elements.empty()) {
+    return errors::InvalidArgument("Cannot batch an empty ragged component ",
+                                   component_index, ".");
+  }
+
+  const int ragged_rank = ragged_elements.front()->ragged_rank();
+  std::vector<Tensor> nested_splits;
+  nested_splits.reserve(ragged_rank + 1);
+  // The new outermost dimension has one row per element.
+  nested_splits.emplace_back(splits_type, TensorShape({num_elements + 1}));
+  auto outer_splits = nested_splits.back().vec<SPLITS_TYPE>();
+  outer_splits(0) = 0;
+  int64_t num_rows = 0;
+  for (int64_t i = 0; i < num_elements; ++i) {
+    const RaggedTensorVariant* element = ragged_elements[i];
+    num_rows += ragged_rank > 0 ? element->splits(0).NumElements() - 1
+                                : element->values().dim_size(0);
+    outer_splits(i + 1) = num_rows;
+  }
+  for (int level = 0; level < ragged_rank; ++level) {
+    int64_t size = 1;
+    for (const RaggedTensorVariant* element : ragged_elements) {
+      size += element->splits(level).NumElements() - 1;
+    }
+    nested_splits.emplace_back(splits_type, TensorShape({size}));
+    auto splits = nested_splits.back().vec<SPLITS_TYPE>();
+    splits(0) = 0;
+    int64_t index = 1;
+    SPLITS_TYPE offset = 0;
+    for (const RaggedTensorVariant* element : ragged_elements) {
+      const auto element_splits = element->splits(level).vec<SPLITS_TYPE>();
+      for (int64_t j = 1; j < element_splits.size(); ++j) {
+        splits(index++) = offset + element_splits(j);
+      }
+      offset += element_splits(element_splits.size() - 1);
+    }
+  }
+
+  int64_t num_values = 0;
+  for (const RaggedTensorVariant* element : ragged_elements) {
+    num_values += element->values().dim_size(0);
+  }
+  TensorShape values_shape = ragged_elements.front()->values().shape();
+  values_shape.set_dim(0, num_values);
+  Tensor values(allocator, ragged_elements.front()->values().dtype(),
+                values_shape);
+  if (!values.IsInitialized()) {
+    return errors::ResourceExhausted(
+        "Failed to allocate memory for the values of ragged component ",
+        component_index);
+  }
+  int64_t values_offset = 0;
+  for (const RaggedTensorVariant* element : ragged_elements) {
+    const int64_t element_rows = element->values().dim_size(0);
+    if (element_rows > 0) {
+      TF_RETURN_IF_ERROR(batch_util::CopyContiguousSlices(
+          element->values(), /*src_offset=*/0, values_offset, element_rows,
+          &values));
+    }
+    values_offset += element_rows;
+  }
+
+  *output = Tensor(DT_VARIANT, TensorShape({}));
+  output->scalar<Variant>()() =
+      RaggedTensorVariant(std::move(values), nested_splits);
+  return OkStatus();
+}
+
 }  // namespace
 
 class MapAndBatchDatasetOp::Dataset : public DatasetBase {
@@ -88,7 +230,8 @@ class MapAndBatchDatasetOp::Dataset : public DatasetBase {
           const DataTypeVector& output_types,
           const std::vector<PartialTensorShape>& output_shapes,
           std::unique_ptr<CapturedFunction> captured_func,
-          bool preserve_cardinality)
+          bool preserve_cardinality,
+          const std::vector<int64_t>& ragged_components, DataType splits_type)
       : DatasetBase(DatasetContext(ctx)),
         input_(input),
         batch_size_(batch_size),
@@ -98,6 +241,8 @@ class MapAndBatchDatasetOp::Dataset : public DatasetBase {
         output_shapes_(output_shapes),
         captured_func_(std::move(captured_func)),
         preserve_cardinality_(preserve_cardinality),
+        ragged_components_(ragged_components),
+        splits_type_(splits_type),
         traceme_metadata_(
             {{"autotune",
               num_parallel_calls == model::kAutotune ? "true" : "false"},
@@ -169,6 +314,20 @@ class MapAndBatchDatasetOp::Dataset : public DatasetBase {
     b->BuildAttrValue(other_arguments_types, &other_arguments_types_attr);
     AttrValue preserve_cardinality_attr;
     b->BuildAttrValue(preserve_cardinality_, &preserve_cardinality_attr);
+    std::vector<std::pair<StringPiece, AttrValue>> attrs = {
+        std::make_pair(kFunc, f),
+        std::make_pair(kTarguments, other_arguments_types_attr),
+        std::make_pair(kPreserveCardinality, preserve_cardinality_attr)};
+    // The attrs are only set when needed, since the deprecated
+    // "ExperimentalMapAndBatchDataset" op does not define them.
+    if (!ragged_components_.empty()) {
+      AttrValue ragged_components_attr;
+      b->BuildAttrValue(ragged_components_, &ragged_components_attr);
+      attrs.emplace_back(kRaggedComponents, ragged_components_attr);
+      AttrValue splits_type_attr;
+      b->BuildAttrValue(splits_type_, &splits_type_attr);
+      attrs.emplace_back(kTsplits, splits_type_attr);
+    }
 
     TF_RETURN_IF_ERROR(b->AddDataset(
         this,
@@ -177,11 +336,7 @@ class MapAndBatchDatasetOp::Dataset : public DatasetBase {
          std::make_pair(3, num_parallel_calls_node),
          std::make_pair(4, drop_remainder_node)},  // Single tensor inputs.
         {std::make_pair(1, other_arguments)},      // Tensor list inputs.
-        {std::make_pair(kFunc, f),
-         std::make_pair(kTarguments, other_arguments_types_attr),
-         std::make_pair(kPreserveCardinality,
-                        preserve_cardinality_attr)},  // Attrs
-        output));
+        attrs, output));
     return OkStatus();
   }
 
@@ -279,6 +434,9 @@ class MapAndBatchDatasetOp::Dataset : public DatasetBase {
           ProcessBatch(dataset()->batch_size_, result->num_elements,
                        dataset()->drop_remainder_, result->status, ctx,
                        out_tensors, end_of_sequence, &result->output));
+      if (!*end_of_sequence) {
+        TF_RETURN_IF_ERROR(StackRaggedComponents(ctx, out_tensors));
+      }
       return OkStatus();
     }
 
@@ -507,6 +665,23 @@ class MapAndBatchDatasetOp::Dataset : public DatasetBase {
                                             std::move(done), model_node());
     }
 
+    // Replaces the batched ragged components of `batch` with their stacked
+    // `RaggedTensor` encodings.
+    Status StackRaggedComponents(IteratorContext* ctx,
+                                 std::vector<Tensor>* batch) {
+      for (int64_t index : dataset()->ragged_components_) {
+        Tensor& component = (*batch)[index];
+        if (dataset()->splits_type_ == DT_INT32) {
+          TF_RETURN_IF_ERROR(StackRaggedElements<int32>(
+              ctx->allocator({}), component, index, &component));
+        } else {
+          TF_RETURN_IF_ERROR(StackRaggedElements<int64_t>(
+              ctx->allocator({}), component, index, &component));
+        }
+      }
+      return OkStatus();
+    }
+
     void CancelThreads(bool wait) TF_LOCKS_EXCLUDED(mu_) {
       cancellation_manager_->StartCancel();
       mutex_lock l(*mu_);
@@ -734,6 +909,8 @@ class MapAndBatchDatasetOp::Dataset : public DatasetBase {
   const std::vector<PartialTensorShape> output_shapes_;
   const std::unique_ptr<CapturedFunction> captured_func_;
   const bool preserve_cardinality_;
+  const std::vector<int64_t> ragged_components_;
+  const DataType splits_type_;
   const TraceMeMetadata traceme_metadata_;
 };
 
@@ -745,6 +922,24 @@ MapAndBatchDatasetOp::MapAndBatchDatasetOp(OpKernelConstruction* ctx)
   OP_REQUIRES_OK(ctx, ctx->GetAttr(kOutputShapes, &output_shapes_));
   OP_REQUIRES_OK(ctx,
                  ctx->GetAttr(kPreserveCardinality, &preserve_cardinality_));
+  if (ctx->HasAttr(kRaggedComponents)) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kRaggedComponents, &ragged_components_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kTsplits, &splits_type_));
+  }
+  for (int64_t index : ragged_components_) {
+    OP_REQUIRES(ctx, index >= 0 && index < output_types_.size(),
+                errors::InvalidArgument("Invalid ragged component index ",
+                                        index, " for ", output_types_.size(),
+                                        " output components."));
+    OP_REQUIRES(ctx,
+                output_types_[index] == DT_VARIANT &&
+                    output_shapes_[index].IsCompatibleWith(TensorShape({})),
+                errors::InvalidArgument(
+                    "Ragged component ", index,
+                    " must be a scalar variant, but has type ",
+                    DataTypeString(output_types_[index]), " and shape ",
+                    output_shapes_[index].DebugString(), "."));
+  }
 }
 
 void MapAndBatchDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
@@ -776,7 +971,8 @@ void MapAndBatchDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
 
   *output = new Dataset(ctx, input, batch_size, num_parallel_calls,
                         drop_remainder, output_types_, output_shapes_,
-                        std::move(captured_func), preserve_cardinality_);
+                        std::move(captured_func), preserve_cardinality_,
+                        ragged_components_, splits_type_);
 }
 
 namespace {
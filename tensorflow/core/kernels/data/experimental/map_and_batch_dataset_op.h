@@ -39,6 +39,8 @@ class MapAndBatchDatasetOp : public UnaryDatasetOpKernel {
   static constexpr const char* const kOutputShapes = "output_shapes";
   static constexpr const char* const kPreserveCardinality =
       "preserve_cardinality";
+  static constexpr const char* const kRaggedComponents = "ragged_components";
+  static constexpr const char* const kTsplits = "Tsplits";
 
   explicit MapAndBatchDatasetOp(OpKernelConstruction* ctx);
 
@@ -52,6 +54,8 @@ class MapAndBatchDatasetOp : public UnaryDatasetOpKernel {
   DataTypeVector output_types_;
   std::vector<PartialTensorShape> output_shapes_;
   bool preserve_cardinality_;
+  std::vector<int64_t> ragged_components_;
+  DataType splits_type_ = DT_INT64;
 };
 
 }  // namespace experimental
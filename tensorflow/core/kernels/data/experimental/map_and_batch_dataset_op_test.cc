@@ -12,6 +12,8 @@ limitations under the License.
 #include "tensorflow/core/kernels/data/experimental/map_and_batch_dataset_op.h"
 
 #include "tensorflow/core/data/dataset_test_base.h"
+#include "tensorflow/core/framework/variant.h"
+#include "tensorflow/core/kernels/ragged_tensor_variant.h"
 
 namespace tensorflow {
 namespace data {
@@ -29,7 +31,9 @@ class MapAndBatchDatasetParams : public DatasetParams {
       FunctionDefHelper::AttrValueWrapper func,
       std::vector<FunctionDef> func_lib, DataTypeVector type_arguments,
       bool preserve_cardinality, DataTypeVector output_dtypes,
-      std::vector<PartialTensorShape> output_shapes, string node_name)
+      std::vector<PartialTensorShape> output_shapes, string node_name,
+      std::vector<int64_t> ragged_components = {},
+      DataType splits_type = DT_INT64)
       : DatasetParams(std::move(output_dtypes), std::move(output_shapes),
                       std::move(node_name)),
         other_arguments_(std::move(other_arguments)),
@@ -39,7 +43,9 @@ class MapAndBatchDatasetParams : public DatasetParams {
         func_(std::move(func)),
         func_lib_(std::move(func_lib)),
         type_arguments_(std::move(type_arguments)),
-        preserve_cardinality_(preserve_cardinality) {
+        preserve_cardinality_(preserve_cardinality),
+        ragged_components_(std::move(ragged_components)),
+        splits_type_(splits_type) {
     input_dataset_params_.push_back(std::make_unique<T>(input_dataset_params));
     iterator_prefix_ =
         name_utils::IteratorPrefix(input_dataset_params.dataset_type(),
@@ -76,6 +82,8 @@ class MapAndBatchDatasetParams : public DatasetParams {
                     {"output_shapes", output_shapes_},
                     {"output_types", output_dtypes_},
                     {"preserve_cardinality", preserve_cardinality_},
+                    {"ragged_components", ragged_components_},
+                    {"Tsplits", splits_type_},
                     {"metadata", ""}};
     return OkStatus();
   }
@@ -95,6 +103,8 @@ class MapAndBatchDatasetParams : public DatasetParams {
   std::vector<FunctionDef> func_lib_;
   DataTypeVector type_arguments_;
   bool preserve_cardinality_;
+  std::vector<int64_t> ragged_components_;
+  DataType splits_type_;
 };
 
 class MapAndBatchDatasetOpTest : public DatasetOpsTestBase {};
@@ -104,6 +114,54 @@ FunctionDefHelper::AttrValueWrapper MapFunc(const string& func_name,
   return FunctionDefHelper::FunctionRef(func_name, {{"T", dtype}});
 }
 
+// Maps `x` to the variant encoding of `range(x)`, as a dense tensor if
+// `ragged_rank` is 0 and as a ragged tensor with a single row otherwise.
+FunctionDef RangeToRaggedVariant(int ragged_rank) {
+  std::vector<FunctionDefHelper::Node> nodes = {
+      {{"zero"}, "Const", {}, {{"value", int64_t{0}}, {"dtype", DT_INT64}}},
+      {{"one"}, "Const", {}, {{"value", int64_t{1}}, {"dtype", DT_INT64}}},
+      {{"range"}, "Range", {"zero", "x", "one"}, {{"Tidx", DT_INT64}}}};
+  std::vector<string> ragged_inputs = {"range"};
+  if (ragged_rank > 0) {
+    nodes.push_back({{"splits"},
+                     "Pack",
+                     {"zero", "x"},
+                     {{"N", 2}, {"T", DT_INT64}, {"axis", 0}}});
+    ragged_inputs.insert(ragged_inputs.begin(), "splits");
+  }
+  nodes.push_back({{"y"},
+                   "RaggedTensorToVariant",
+                   ragged_inputs,
+                   {{"RAGGED_RANK", ragged_rank},
+                    {"Tvalues", DT_INT64},
+                    {"Tsplits", DT_INT64},
+                    {"batched_input", false}}});
+  return FunctionDefHelper::Define(
+      absl::StrCat("RangeToRaggedVariant", ragged_rank),
+      /*arg_def=*/{"x: int64"}, /*ret_def=*/{"y: variant"},
+      /*attr_def=*/{}, nodes);
+}
+
+MapAndBatchDatasetParams RaggedMapAndBatchDatasetParams(
+    int ragged_rank, int64_t num_parallel_calls) {
+  return MapAndBatchDatasetParams(
+      RangeDatasetParams(0, 5, 1),
+      /*other_arguments=*/{},
+      /*batch_size=*/2,
+      /*num_parallel_calls=*/num_parallel_calls,
+      /*drop_remainder=*/false,
+      /*func=*/
+      FunctionDefHelper::FunctionRef(
+          absl::StrCat("RangeToRaggedVariant", ragged_rank)),
+      /*func_lib=*/{RangeToRaggedVariant(ragged_rank)},
+      /*type_arguments*/ {},
+      /*preserve_cardinality=*/true,
+      /*output_dtypes=*/{DT_VARIANT},
+      /*output_shapes=*/{PartialTensorShape()},
+      /*node_name=*/kNodeName,
+      /*ragged_components=*/{0});
+}
+
 // test case 1: num_parallel_calls = 1, drop_remainder = true,
 // preserve_cardinality = false, MapFunc = XTimesTwo
 MapAndBatchDatasetParams MapAndBatchDatasetParams1() {
@@ -407,6 +465,79 @@ ITERATOR_SAVE_AND_RESTORE_TEST_P(MapAndBatchDatasetOpTest,
                                  MapAndBatchDatasetParams,
                                  IteratorSaveAndRestoreTestCases())
 
+TEST_F(MapAndBatchDatasetOpTest, RaggedComponents) {
+  // Each element `x` of `range(5)` is mapped to `range(x)`, and the elements
+  // are batched in pairs.
+  const std::vector<Tensor> expected_values = {
+      CreateTensor<int64_t>(TensorShape({1}), {0}),
+      CreateTensor<int64_t>(TensorShape({5}), {0, 1, 0, 1, 2}),
+      CreateTensor<int64_t>(TensorShape({4}), {0, 1, 2, 3})};
+  const std::vector<Tensor> expected_splits = {
+      CreateTensor<int64_t>(TensorShape({3}), {0, 0, 1}),
+      CreateTensor<int64_t>(TensorShape({3}), {0, 2, 5}),
+      CreateTensor<int64_t>(TensorShape({2}), {0, 4})};
+  // With a ragged rank of 1, each element is a ragged tensor with one row,
+  // so every element of the batch adds a row to the outer splits.
+  const std::vector<Tensor> expected_outer_splits = {
+      CreateTensor<int64_t>(TensorShape({3}), {0, 1, 2}),
+      CreateTensor<int64_t>(TensorShape({3}), {0, 1, 2}),
+      CreateTensor<int64_t>(TensorShape({2}), {0, 1})};
+  for (int ragged_rank : {0, 1}) {
+    for (int64_t num_parallel_calls : {1, 4}) {
+      auto dataset_params =
+          RaggedMapAndBatchDatasetParams(ragged_rank, num_parallel_calls);
+      TF_ASSERT_OK(Initialize(dataset_params));
+      for (int i = 0; i < expected_values.size(); ++i) {
+        std::vector<Tensor> out_tensors;
+        bool end_of_sequence = false;
+        TF_ASSERT_OK(iterator_->GetNext(iterator_ctx_.get(), &out_tensors,
+                                        &end_of_sequence));
+        ASSERT_FALSE(end_of_sequence);
+        ASSERT_EQ(out_tensors.size(), 1);
+        ASSERT_EQ(out_tensors[0].dims(), 0);
+        const RaggedTensorVariant* ragged =
+            out_tensors[0].scalar<Variant>()().get<RaggedTensorVariant>();
+        ASSERT_NE(ragged, nullptr);
+        ASSERT_EQ(ragged->ragged_rank(), ragged_rank + 1);
+        test::ExpectTensorEqual<int64_t>(ragged->values(), expected_values[i]);
+        if (ragged_rank == 0) {
+          test::ExpectTensorEqual<int64_t>(ragged->splits(0),
+                                           expected_splits[i]);
+        } else {
+          test::ExpectTensorEqual<int64_t>(ragged->splits(0),
+                                           expected_outer_splits[i]);
+          test::ExpectTensorEqual<int64_t>(ragged->splits(1),
+                                           expected_splits[i]);
+        }
+      }
+      std::vector<Tensor> out_tensors;
+      bool end_of_sequence = false;
+      TF_ASSERT_OK(iterator_->GetNext(iterator_ctx_.get(), &out_tensors,
+                                      &end_of_sequence));
+      EXPECT_TRUE(end_of_sequence);
+    }
+  }
+}
+
+TEST_F(MapAndBatchDatasetOpTest, InvalidRaggedComponent) {
+  auto dataset_params = MapAndBatchDatasetParams(
+      RangeDatasetParams(0, 10, 2),
+      /*other_arguments=*/{},
+      /*batch_size=*/2,
+      /*num_parallel_calls=*/1,
+      /*drop_remainder=*/true,
+      /*func=*/MapFunc("XTimesTwo", DT_INT64),
+      /*func_lib=*/{test::function::XTimesTwo()},
+      /*type_arguments*/ {},
+      /*preserve_cardinality=*/false,
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({2})},
+      /*node_name=*/kNodeName,
+      /*ragged_components=*/{0});
+  EXPECT_EQ(Initialize(dataset_params).code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
 TEST_F(MapAndBatchDatasetOpTest, InvalidBatchSize) {
   auto dataset_params = InvalidBatchSizeMapAndBatchDatasetParams();
   EXPECT_EQ(Initialize(dataset_params).code(),
@@ -21,6 +21,7 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/function.h"
 #include "tensorflow/core/common_runtime/input_colocation_exemption_registry.h"
+#include "tensorflow/core/data/batch_buffer_pool.h"
 #include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/data/stats_utils.h"
@@ -216,6 +217,7 @@ class ParallelBatchDatasetOp::Dataset : public DatasetBase {
           num_parallel_calls_->value = GetAutotuneDefaultParallelism(ctx);
         }
       }
+      buffer_pool_ = BatchBufferPool::MaybeCreateFromEnv(ctx->allocator({}));
       cancellation_manager_ = std::make_unique<CancellationManager>();
       TF_RETURN_IF_ERROR(RegisterCancellationCallback(
           ctx->cancellation_manager(),
@@ -429,8 +431,9 @@ class ParallelBatchDatasetOp::Dataset : public DatasetBase {
                     RecordBufferEnqueue(ctx.get(), result->output);
                     return OkStatus();
                   };
-          status = CopyBatch(CopyBatchParams(ctx.get()), *batch_elements,
-                             dataset()->parallel_copy_,
+          CopyBatchParams params(ctx.get());
+          params.buffer_pool = buffer_pool_.get();
+          status = CopyBatch(params, *batch_elements, dataset()->parallel_copy_,
                              std::move(allocation_callback), &result->output);
           result->status.Update(status);
         }
@@ -636,6 +639,9 @@ class ParallelBatchDatasetOp::Dataset : public DatasetBase {
     // tree. We record the interleave depth so that it can be included in the
     // trace metadata.
     int64 interleave_depth_ = -1;
+    // Recycles the buffers of the batches once they are no longer referenced.
+    // Null unless `BatchBufferPool::kMaxCachedBytesEnvVar` is set.
+    std::shared_ptr<BatchBufferPool> buffer_pool_;
     // Background thread used for coordinating input processing.
     std::unique_ptr<Thread> runner_thread_ TF_GUARDED_BY(*mu_);
   };
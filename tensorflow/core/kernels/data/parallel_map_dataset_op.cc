@@ -138,7 +138,7 @@ class ParallelMapDatasetOp::Dataset : public DatasetBase {
     }
   }
 
-  Status Get(OpKernelContext* ctx, int64 index,
+  Status Get(AnyContext ctx, int64 index,
              std::vector<Tensor>* out_tensors) const override {
     TF_RETURN_IF_ERROR(CheckRandomAccessCompatible(index));
     std::vector<Tensor> args;
@@ -151,6 +151,31 @@ class ParallelMapDatasetOp::Dataset : public DatasetBase {
     return instantiated_captured_func_->RunInstantiated(args, out_tensors);
   }
 
+  Status GetMany(AnyContext ctx, absl::Span<const int64_t> indices,
+                 std::vector<std::vector<Tensor>>* out_tensors) const override {
+    if (indices.empty()) {
+      out_tensors->clear();
+      return OkStatus();
+    }
+    TF_RETURN_IF_ERROR(CheckRandomAccessCompatible(indices.front()));
+    TF_RETURN_IF_ERROR(CheckRandomAccessCompatible(indices.back()));
+    // Reads the inputs together, so that sources can coalesce their reads.
+    std::vector<std::vector<Tensor>> args;
+    TF_RETURN_IF_ERROR(input_->GetMany(ctx, indices, &args));
+    if (!instantiated_captured_func_) {
+      TF_RETURN_IF_ERROR(
+          captured_func_->Instantiate(InstantiateCapturedFunctionParams(ctx),
+                                      &instantiated_captured_func_));
+    }
+    out_tensors->resize(args.size());
+    for (size_t i = 0; i < args.size(); ++i) {
+      (*out_tensors)[i].clear();
+      TF_RETURN_IF_ERROR(instantiated_captured_func_->RunInstantiated(
+          args[i], &(*out_tensors)[i]));
+    }
+    return OkStatus();
+  }
+
   Status InputDatasets(std::vector<const DatasetBase*>* inputs) const override {
     inputs->push_back(input_);
     return OkStatus();
@@ -26,6 +26,7 @@ limitations under the License.
 #include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/data/serialization_utils.h"
+#include "tensorflow/core/data/shuffle_spill_buffer.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/resource_mgr.h"
@@ -73,6 +74,9 @@ constexpr char kSlicesEnd[] = "slices_end";
 constexpr char kSlicesReachedEndOfSequence[] = "slices_reached_end_of_sequence";
 constexpr char kSeedGenerator[] = "SeedGenerator";
 constexpr char kEpochNumRandomSamples[] = "epoch_num_random_samples";
+constexpr char kSpillCapacity[] = "spill_capacity";
+constexpr char kSpillDirectory[] = "spill_directory";
+constexpr char kSpillInputExhausted[] = "spill_input_exhausted";
 constexpr char kShuffleDatasetV1[] = "ShuffleDataset";
 constexpr char kShuffleDatasetV2[] = "ShuffleDatasetV2";
 constexpr char kShuffleDatasetV3[] = "ShuffleDatasetV3";
@@ -131,7 +135,7 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
     return input_->CheckExternalState();
   }
 
-  Status Get(OpKernelContext* ctx, int64 index,
+  Status Get(AnyContext ctx, int64 index,
              std::vector<Tensor>* out_tensors) const override {
     TF_RETURN_IF_ERROR(CheckRandomAccessCompatible(index));
     {
@@ -203,6 +207,22 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
       mutex_lock l(mu_);
       seed_generator_->GenerateSeeds(&seed_, &seed2_);
       ResetRngs();
+      // When spilling is enabled, only part of a large buffer is kept in
+      // memory and the rest is spilled to disk.
+      std::string spill_directory;
+      int64_t max_elements_in_memory;
+      if (!IsShuffleAll() &&
+          ShuffleSpillBuffer::ReadConfigFromEnv(&spill_directory,
+                                                &max_elements_in_memory) &&
+          dataset()->buffer_size_ > max_elements_in_memory) {
+        const int64_t spill_capacity =
+            dataset()->buffer_size_ - max_elements_in_memory;
+        VLOG(1) << "Spilling " << spill_capacity
+                << " elements of the shuffle buffer to " << spill_directory;
+        spill_ = std::make_unique<ShuffleSpillBuffer>(
+            ctx->env(), spill_directory, spill_capacity);
+        buffer_->resize(max_elements_in_memory);
+      }
       return OkStatus();
     }
 
@@ -293,6 +313,17 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
         TF_RETURN_IF_ERROR(
             writer->WriteScalar(this->prefix(), kDataProduced, ""));
       }
+      // Spilled elements stay on disk, only their location is saved.
+      if (spill_) {
+        TF_RETURN_IF_ERROR(
+            writer->WriteScalar(prefix(), kSpillCapacity, spill_->capacity()));
+        TF_RETURN_IF_ERROR(writer->WriteScalar(prefix(), kSpillDirectory,
+                                               spill_->directory()));
+        TF_RETURN_IF_ERROR(
+            writer->WriteScalar(prefix(), kSpillInputExhausted,
+                                static_cast<int64_t>(spill_input_exhausted_)));
+        TF_RETURN_IF_ERROR(spill_->Save(prefix(), writer));
+      }
 
       return OkStatus();
     }
@@ -335,6 +366,24 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
             reader->ReadScalar(this->prefix(), kSlicesSize, &temp));
         slices_size = static_cast<size_t>(temp);
       }
+      if (reader->Contains(prefix(), kSpillCapacity)) {
+        int64_t capacity;
+        TF_RETURN_IF_ERROR(
+            reader->ReadScalar(prefix(), kSpillCapacity, &capacity));
+        tstring directory;
+        TF_RETURN_IF_ERROR(
+            reader->ReadScalar(prefix(), kSpillDirectory, &directory));
+        int64_t input_exhausted;
+        TF_RETURN_IF_ERROR(reader->ReadScalar(prefix(), kSpillInputExhausted,
+                                              &input_exhausted));
+        spill_input_exhausted_ = static_cast<bool>(input_exhausted);
+        spill_ = std::make_unique<ShuffleSpillBuffer>(ctx->env(), directory,
+                                                      capacity);
+        TF_RETURN_IF_ERROR(spill_->Restore(prefix(), reader));
+      } else {
+        spill_.reset();
+        spill_input_exhausted_ = false;
+      }
       buffer_ = std::make_unique<std::vector<std::vector<Tensor>>>();
       TF_RETURN_IF_ERROR(ReadElementsFromCheckpoint(
           ctx, reader, absl::StrCat(prefix(), kColon, "buffer"),
@@ -343,7 +392,8 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
         RecordBufferEnqueue(ctx, element);
       }
       if (!IsShuffleAll()) {
-        buffer_->resize(dataset()->buffer_size_);
+        buffer_->resize(dataset()->buffer_size_ -
+                        (spill_ ? spill_->capacity() : 0));
       }
       slices_.clear();
       for (size_t i = 0; i < slices_size; ++i) {
@@ -420,7 +470,8 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
             ((num_log_entries + 1) * kLogIntervalMicros) + start_micros) {
           num_log_entries++;
           LOG(INFO) << "Filling up shuffle buffer (this may take a while): "
-                    << num_elements_ << " of " << BufferSizeString();
+                    << num_elements_ + (spill_ ? spill_->size() : 0) << " of "
+                    << BufferSizeString();
         }
         if (!input_impl_) {
           TF_RETURN_IF_ERROR(PrepareNextEpoch(ctx));
@@ -428,7 +479,7 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
         std::vector<Tensor> input_element;
         bool end_of_input_sequence = false;
         TF_RETURN_IF_ERROR(
-            input_impl_->GetNext(ctx, &input_element, &end_of_input_sequence));
+            GetNextInput(ctx, &input_element, &end_of_input_sequence));
         if (end_of_input_sequence) {
           slices_.back()->reached_end_of_sequence = true;
         }
@@ -452,6 +503,36 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
       return OkStatus();
     }
 
+    // Gets the next element of the current epoch of the input. When spilling,
+    // the elements are passed through `spill_`, which is kept full until the
+    // input is exhausted and then drained before reporting the end of the
+    // epoch.
+    Status GetNextInput(IteratorContext* ctx, std::vector<Tensor>* element,
+                        bool* end_of_sequence)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (!spill_) {
+        return input_impl_->GetNext(ctx, element, end_of_sequence);
+      }
+      while (!spill_input_exhausted_ && !spill_->full()) {
+        std::vector<Tensor> input_element;
+        bool end_of_input_sequence = false;
+        TF_RETURN_IF_ERROR(
+            input_impl_->GetNext(ctx, &input_element, &end_of_input_sequence));
+        if (end_of_input_sequence) {
+          spill_input_exhausted_ = true;
+          break;
+        }
+        TF_RETURN_IF_ERROR(spill_->Push(input_element));
+      }
+      if (spill_->empty()) {
+        spill_input_exhausted_ = false;
+        *end_of_sequence = true;
+        return OkStatus();
+      }
+      *end_of_sequence = false;
+      return spill_->Pop(Random(), element);
+    }
+
     bool ShouldFillBuffer() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
       if (!input_impl_ && dataset()->count_ != -1 &&
           epoch_ >= dataset()->count_) {
@@ -543,6 +624,12 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
         TF_GUARDED_BY(mu_);
     int64_t num_random_samples_ TF_GUARDED_BY(mu_) = 0;
     bool data_produced_ TF_GUARDED_BY(mu_) = false;
+    // The on-disk part of the buffer, which is only used if spilling is
+    // enabled. It holds elements of the current epoch that have not been
+    // moved to `buffer_` yet.
+    std::unique_ptr<ShuffleSpillBuffer> spill_ TF_GUARDED_BY(mu_);
+    // Whether `spill_` has seen the end of the current epoch of the input.
+    bool spill_input_exhausted_ TF_GUARDED_BY(mu_) = false;
   };
 
   const DatasetBase* const input_;
@@ -17,6 +17,8 @@ limitations under the License.
 #include "tensorflow/core/data/dataset_test_base.h"
 #include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/data/serialization_utils.h"
+#include "tensorflow/core/data/shuffle_spill_buffer.h"
+#include "tensorflow/core/lib/io/path.h"
 
 namespace tensorflow {
 namespace data {
@@ -583,6 +585,72 @@ INSTANTIATE_TEST_CASE_P(ShuffleDatasetOpTest,
                         ParameterizedIteratorSaveAndRestoreTest,
                         ::testing::ValuesIn(IteratorSaveAndRestoreTestCases()));
 
+TEST_F(ShuffleDatasetOpTest, SpillToDisk) {
+  const std::string spill_dir =
+      io::JoinPath(testing::TmpDir(), "shuffle_dataset_op_test_spill");
+  setenv(ShuffleSpillBuffer::kDirectoryEnvVar, spill_dir.c_str(), 1);
+  setenv(ShuffleSpillBuffer::kMaxElementsInMemoryEnvVar, "4", 1);
+  auto dataset_params =
+      ShuffleDatasetParams(RangeDatasetParams(0, 100, 1),
+                           /*buffer_size=*/50,
+                           /*seed=*/1,
+                           /*seed2=*/2,
+                           /*count=*/2,
+                           /*reshuffle_each_iteration=*/true,
+                           /*output_dtypes=*/{DT_INT64},
+                           /*output_shapes=*/{PartialTensorShape({})},
+                           /*node_name=*/kShuffleAndRepeatNodeName);
+  TF_ASSERT_OK(Initialize(dataset_params));
+  std::unique_ptr<SerializationContext> serialization_ctx;
+  TF_ASSERT_OK(CreateSerializationContext(&serialization_ctx));
+
+  // Save in the middle of the first epoch, and check that the restored
+  // iterator produces the same elements as the original one.
+  std::vector<Tensor> out_tensors;
+  bool end_of_sequence = false;
+  for (int i = 0; i < 30; ++i) {
+    std::vector<Tensor> next;
+    TF_ASSERT_OK(
+        iterator_->GetNext(iterator_ctx_.get(), &next, &end_of_sequence));
+    out_tensors.insert(out_tensors.end(), next.begin(), next.end());
+  }
+  VariantTensorDataWriter writer;
+  TF_ASSERT_OK(iterator_->Save(serialization_ctx.get(), &writer));
+  std::vector<Tensor> expected;
+  while (!end_of_sequence) {
+    std::vector<Tensor> next;
+    TF_ASSERT_OK(
+        iterator_->GetNext(iterator_ctx_.get(), &next, &end_of_sequence));
+    expected.insert(expected.end(), next.begin(), next.end());
+  }
+  // Both epochs are complete.
+  out_tensors.insert(out_tensors.end(), expected.begin(), expected.end());
+  std::vector<Tensor> range;
+  for (int64_t i = 0; i < 200; ++i) {
+    range.push_back(CreateTensor<int64_t>(TensorShape({}), {i % 100}));
+  }
+  TF_EXPECT_OK(ExpectEqual(out_tensors, range, /*compare_order=*/false));
+
+  std::vector<const VariantTensorData*> data;
+  writer.GetData(&data);
+  VariantTensorDataReader reader(data);
+  TF_ASSERT_OK(RestoreIterator(iterator_ctx_.get(), &reader,
+                               dataset_params.iterator_prefix(), *dataset_,
+                               &iterator_));
+  end_of_sequence = false;
+  std::vector<Tensor> restored;
+  while (!end_of_sequence) {
+    std::vector<Tensor> next;
+    TF_ASSERT_OK(
+        iterator_->GetNext(iterator_ctx_.get(), &next, &end_of_sequence));
+    restored.insert(restored.end(), next.begin(), next.end());
+  }
+  TF_EXPECT_OK(ExpectEqual(restored, expected, /*compare_order=*/true));
+
+  unsetenv(ShuffleSpillBuffer::kDirectoryEnvVar);
+  unsetenv(ShuffleSpillBuffer::kMaxElementsInMemoryEnvVar);
+}
+
 TEST_F(ShuffleDatasetOpTest, InvalidArguments) {
   std::vector<ShuffleDatasetParams> dataset_params_vec(
       {ShuffleDatasetParamsWithInvalidBufferSize(),
@@ -84,7 +84,7 @@ Status TakeDataset::CheckExternalState() const {
   return input_->CheckExternalState();
 }
 
-Status TakeDataset::Get(OpKernelContext* ctx, int64 index,
+Status TakeDataset::Get(AnyContext ctx, int64 index,
                         std::vector<Tensor>* out_tensors) const {
   TF_RETURN_IF_ERROR(CheckRandomAccessCompatible(index));
   return input_->Get(ctx, index, out_tensors);
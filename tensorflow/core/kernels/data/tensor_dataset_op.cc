@@ -82,7 +82,7 @@ class TensorDatasetOp::Dataset : public DatasetBase {
 
   Status CheckExternalState() const override { return OkStatus(); }
 
-  Status Get(OpKernelContext* ctx, int64 index,
+  Status Get(AnyContext ctx, int64 index,
              std::vector<Tensor>* out_tensors) const override {
     TF_RETURN_IF_ERROR(CheckRandomAccessCompatible(index));
     *out_tensors = tensors_;
@@ -19,11 +19,13 @@ limitations under the License.
 #include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/tensor.h"
-#include "tensorflow/core/lib/io/buffered_inputstream.h"
-#include "tensorflow/core/lib/io/inputbuffer.h"
+#include "tensorflow/core/kernels/data/text_line_reader.h"
+#include "tensorflow/core/lib/io/compression.h"
+#include "tensorflow/core/lib/io/lz4_inputstream.h"
 #include "tensorflow/core/lib/io/random_inputstream.h"
 #include "tensorflow/core/lib/io/zlib_compression_options.h"
 #include "tensorflow/core/lib/io/zlib_inputstream.h"
+#include "tensorflow/core/lib/io/zstd_inputstream.h"
 
 namespace tensorflow {
 namespace data {
@@ -104,13 +106,23 @@ class TextLineDatasetOp::Dataset : public DatasetBase {
       mutex_lock l(mu_);
       do {
         // We are currently processing a file, so try to read the next line.
-        if (buffered_input_stream_) {
-          Tensor line_contents(tstring{});
-          tstring& line_contents_str = line_contents.scalar<tstring>()();
-          Status s = buffered_input_stream_->ReadLine(&line_contents_str);
+        if (line_reader_) {
+          Status s = OkStatus();
+          if (!block_ || next_line_ == block_->num_lines()) {
+            next_line_ = 0;
+            s = line_reader_->ReadBlock(&block_);
+          }
 
           if (s.ok()) {
             // Produce the line as output.
+            Tensor line_contents(tstring{});
+            tstring& line_contents_str = line_contents.scalar<tstring>()();
+            if (block_->has_carriage_return(next_line_)) {
+              block_->CopyLine(next_line_, &line_contents_str);
+            } else {
+              line_contents_str = block_->raw_line(next_line_);
+            }
+            ++next_line_;
             static monitoring::CounterCell* bytes_counter =
                 metrics::GetTFDataBytesReadCounter(
                     name_utils::OpName(TextLineDatasetOp::kDatasetType));
@@ -149,12 +161,14 @@ class TextLineDatasetOp::Dataset : public DatasetBase {
       mutex_lock l(mu_);
       TF_RETURN_IF_ERROR(writer->WriteScalar(prefix(), kCurrentFileIndex,
                                              current_file_index_));
-      // `buffered_input_stream_` is empty if
+      // `line_reader_` is empty if
       // 1. GetNext has not been called even once.
       // 2. All files have been read and iterator has been exhausted.
-      if (buffered_input_stream_) {
-        TF_RETURN_IF_ERROR(writer->WriteScalar(prefix(), kCurrentPos,
-                                               buffered_input_stream_->Tell()));
+      if (line_reader_) {
+        const int64_t current_pos = block_ ? block_->LineOffset(next_line_)
+                                           : line_reader_->Tell();
+        TF_RETURN_IF_ERROR(
+            writer->WriteScalar(prefix(), kCurrentPos, current_pos));
       }
       return OkStatus();
     }
@@ -175,7 +189,7 @@ class TextLineDatasetOp::Dataset : public DatasetBase {
             reader->ReadScalar(prefix(), kCurrentPos, &current_pos));
 
         TF_RETURN_IF_ERROR(SetupStreamsLocked(ctx->env()));
-        TF_RETURN_IF_ERROR(buffered_input_stream_->Seek(current_pos));
+        TF_RETURN_IF_ERROR(line_reader_->Seek(current_pos));
       }
       return OkStatus();
     }
@@ -197,33 +211,47 @@ class TextLineDatasetOp::Dataset : public DatasetBase {
           std::make_unique<io::RandomAccessInputStream>(file_.get(), false);
 
       if (dataset()->use_compression_) {
-        zlib_input_stream_ = std::make_unique<io::ZlibInputStream>(
-            input_stream_.get(), dataset()->options_.input_buffer_size,
-            dataset()->options_.input_buffer_size, dataset()->options_);
-        buffered_input_stream_ = std::make_unique<io::BufferedInputStream>(
-            zlib_input_stream_.get(), dataset()->options_.input_buffer_size,
-            false);
+        const int64_t buffer_size = dataset()->options_.input_buffer_size;
+        if (dataset()->compression_type_ == io::compression::kZstd) {
+          compressed_input_stream_ = std::make_unique<io::ZstdInputStream>(
+              input_stream_.get(), buffer_size, buffer_size);
+        } else if (dataset()->compression_type_ == io::compression::kLz4) {
+          compressed_input_stream_ = std::make_unique<io::Lz4InputStream>(
+              input_stream_.get(), buffer_size, buffer_size);
+        } else {
+          compressed_input_stream_ = std::make_unique<io::ZlibInputStream>(
+              input_stream_.get(), buffer_size, buffer_size,
+              dataset()->options_);
+        }
+        line_reader_ = std::make_unique<TextLineReader>(
+            compressed_input_stream_.get(), buffer_size);
       } else {
-        buffered_input_stream_ = std::make_unique<io::BufferedInputStream>(
-            input_stream_.get(), dataset()->options_.input_buffer_size, false);
+        line_reader_ = std::make_unique<TextLineReader>(
+            input_stream_.get(), dataset()->options_.input_buffer_size);
       }
       return OkStatus();
     }
 
     // Resets all reader streams.
     void ResetStreamsLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      block_.reset();
+      next_line_ = 0;
+      line_reader_.reset();
+      compressed_input_stream_.reset();
       input_stream_.reset();
-      zlib_input_stream_.reset();
-      buffered_input_stream_.reset();
       file_.reset();
     }
 
     mutex mu_;
     std::unique_ptr<io::RandomAccessInputStream> input_stream_
         TF_GUARDED_BY(mu_);
-    std::unique_ptr<io::ZlibInputStream> zlib_input_stream_ TF_GUARDED_BY(mu_);
-    std::unique_ptr<io::BufferedInputStream> buffered_input_stream_
+    std::unique_ptr<io::InputStreamInterface> compressed_input_stream_
         TF_GUARDED_BY(mu_);
+    std::unique_ptr<TextLineReader> line_reader_ TF_GUARDED_BY(mu_);
+    // The lines read by `line_reader_` that haven't been produced yet start at
+    // line `next_line_` of `block_`.
+    core::RefCountPtr<TextLineBlock> block_ TF_GUARDED_BY(mu_);
+    size_t next_line_ TF_GUARDED_BY(mu_) = 0;
     size_t current_file_index_ TF_GUARDED_BY(mu_) = 0;
     std::unique_ptr<RandomAccessFile> file_
         TF_GUARDED_BY(mu_);  // must outlive input_stream_
@@ -232,6 +260,8 @@ class TextLineDatasetOp::Dataset : public DatasetBase {
   const std::vector<string> filenames_;
   const tstring compression_type_;
   const bool use_compression_;
+  // The zlib options of ZLIB and GZIP files. Only `input_buffer_size` applies
+  // to the other compression types.
   const io::ZlibCompressionOptions options_;
 };
 
@@ -263,7 +293,8 @@ void TextLineDatasetOp::MakeDataset(OpKernelContext* ctx,
     zlib_compression_options = io::ZlibCompressionOptions::DEFAULT();
   } else if (compression_type == kGZIP) {
     zlib_compression_options = io::ZlibCompressionOptions::GZIP();
-  } else {
+  } else if (compression_type != io::compression::kZstd &&
+             compression_type != io::compression::kLz4) {
     OP_REQUIRES(ctx, compression_type.empty(),
                 errors::InvalidArgument("Unsupported compression_type."));
   }
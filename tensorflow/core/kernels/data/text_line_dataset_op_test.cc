@@ -140,6 +140,24 @@ TextLineDatasetParams TextLineDatasetParams3() {
                                /*node_name=*/kNodeName);
 }
 
+// Test case 4: line breaks with carriage returns, lines longer than the buffer
+// and a last line without a newline.
+TextLineDatasetParams TextLineDatasetParams4() {
+  std::vector<tstring> filenames = {LocalTempFilename(), LocalTempFilename()};
+  std::vector<tstring> contents = {
+      absl::StrCat("a\r\n", "bc\r\n", "a line longer than the buffer\n"),
+      absl::StrCat("\n", "x\ry\n", "no newline\r")};
+  CompressionType compression_type = CompressionType::UNCOMPRESSED;
+  if (!CreateTestFiles(filenames, contents, compression_type).ok()) {
+    VLOG(WARNING) << "Failed to create the test files: "
+                  << absl::StrJoin(filenames, ", ");
+  }
+  return TextLineDatasetParams(filenames,
+                               /*compression_type=*/compression_type,
+                               /*buffer_size=*/4,
+                               /*node_name=*/kNodeName);
+}
+
 std::vector<GetNextTestCase<TextLineDatasetParams>> GetNextTestCases() {
   return {{/*dataset_params=*/TextLineDatasetParams1(),
            /*expected_outputs=*/
@@ -159,7 +177,15 @@ std::vector<GetNextTestCase<TextLineDatasetParams>> GetNextTestCases() {
                                                     {"11223334455"},
                                                     {"abcd, EFgH"},
                                                     {"           "},
-                                                    {"$%^&*()"}})}};
+                                                    {"$%^&*()"}})},
+          {/*dataset_params=*/TextLineDatasetParams4(),
+           CreateTensors<tstring>(TensorShape({}),
+                                  {{"a"},
+                                   {"bc"},
+                                   {"a line longer than the buffer"},
+                                   {""},
+                                   {"xy"},
+                                   {"no newline"}})}};
 }
 
 ITERATOR_GET_NEXT_TEST_P(TextLineDatasetOpTest, TextLineDatasetParams,
@@ -239,7 +265,16 @@ IteratorSaveAndRestoreTestCases() {
                                                     {"11223334455"},
                                                     {"abcd, EFgH"},
                                                     {"           "},
-                                                    {"$%^&*()"}})}};
+                                                    {"$%^&*()"}})},
+          {/*dataset_params=*/TextLineDatasetParams4(),
+           /*breakpoints=*/{0, 1, 3, 5, 7},
+           CreateTensors<tstring>(TensorShape({}),
+                                  {{"a"},
+                                   {"bc"},
+                                   {"a line longer than the buffer"},
+                                   {""},
+                                   {"xy"},
+                                   {"no newline"}})}};
 }
 
 ITERATOR_SAVE_AND_RESTORE_TEST_P(TextLineDatasetOpTest, TextLineDatasetParams,
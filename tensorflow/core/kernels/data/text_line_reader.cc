@@ -0,0 +1,155 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/text_line_reader.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/lib/io/inputstream_interface.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/refcount.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/tstring.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif  // __SSE2__
+
+namespace tensorflow {
+namespace data {
+
+void FindLineBreaks(absl::string_view data, size_t begin,
+                    std::vector<size_t>* newlines,
+                    std::vector<size_t>* carriage_returns) {
+  size_t i = begin;
+#ifdef __SSE2__
+  const __m128i newline = _mm_set1_epi8('\n');
+  const __m128i carriage_return = _mm_set1_epi8('\r');
+  for (; i + sizeof(__m128i) <= data.size(); i += sizeof(__m128i)) {
+    const __m128i chunk =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(data.data() + i));
+    uint32_t newline_mask =
+        _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, newline));
+    uint32_t carriage_return_mask =
+        _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, carriage_return));
+    for (; newline_mask != 0; newline_mask &= newline_mask - 1) {
+      newlines->push_back(i + __builtin_ctz(newline_mask));
+    }
+    for (; carriage_return_mask != 0;
+         carriage_return_mask &= carriage_return_mask - 1) {
+      carriage_returns->push_back(i + __builtin_ctz(carriage_return_mask));
+    }
+  }
+#endif  // __SSE2__
+  for (; i < data.size(); ++i) {
+    if (data[i] == '\n') {
+      newlines->push_back(i);
+    } else if (data[i] == '\r') {
+      carriage_returns->push_back(i);
+    }
+  }
+}
+
+bool TextLineBlock::has_carriage_return(size_t i) const {
+  auto it = std::lower_bound(carriage_returns_.begin(),
+                             carriage_returns_.end(), line_begin(i));
+  return it != carriage_returns_.end() && *it < line_ends_[i];
+}
+
+void TextLineBlock::CopyLine(size_t i, tstring* line) const {
+  const absl::string_view raw = raw_line(i);
+  line->resize_uninitialized(raw.size());
+  char* end = std::remove_copy(raw.begin(), raw.end(), line->mdata(), '\r');
+  line->resize(end - line->data());
+}
+
+TextLineReader::TextLineReader(io::InputStreamInterface* input,
+                               size_t block_size)
+    : input_(input), block_size_(std::max<size_t>(block_size, 1)) {}
+
+Status TextLineReader::ReadBlock(core::RefCountPtr<TextLineBlock>* block) {
+  if (end_of_input_ && remainder_.empty()) {
+    return errors::OutOfRange("Reached the end of the input.");
+  }
+  core::RefCountPtr<TextLineBlock> result(new TextLineBlock);
+  result->offset_ = offset_;
+  tstring& data = result->data_;
+  std::swap(data, remainder_);
+  size_t scanned = 0;
+  while (true) {
+    FindLineBreaks(data, scanned, &result->line_ends_,
+                   &result->carriage_returns_);
+    scanned = data.size();
+    if (!result->line_ends_.empty() || end_of_input_) {
+      break;
+    }
+    // Reads directly into the block unless it starts with a partial line.
+    tstring chunk;
+    tstring* destination = data.empty() ? &data : &chunk;
+    Status s = input_->ReadNBytes(block_size_, destination);
+    if (errors::IsOutOfRange(s)) {
+      end_of_input_ = true;
+    } else {
+      TF_RETURN_IF_ERROR(s);
+    }
+    if (destination == &chunk) {
+      data.append(chunk);
+    }
+  }
+
+  result->size_ =
+      result->line_ends_.empty() ? 0 : result->line_ends_.back() + 1;
+  auto tail_carriage_returns =
+      std::lower_bound(result->carriage_returns_.begin(),
+                       result->carriage_returns_.end(), result->size_);
+  if (end_of_input_) {
+    // The last line of the input may not end with a newline. It is dropped if
+    // it has nothing but '\r's, like in `BufferedInputStream::ReadLine`.
+    if (data.size() - result->size_ >
+        static_cast<size_t>(result->carriage_returns_.end() -
+                            tail_carriage_returns)) {
+      result->line_ends_.push_back(data.size());
+    }
+    result->size_ = data.size();
+  } else {
+    result->carriage_returns_.erase(tail_carriage_returns,
+                                    result->carriage_returns_.end());
+    remainder_.assign(data.data() + result->size_,
+                      data.size() - result->size_);
+  }
+  offset_ += result->size_;
+  if (result->line_ends_.empty()) {
+    return errors::OutOfRange("Reached the end of the input.");
+  }
+  *block = std::move(result);
+  return OkStatus();
+}
+
+Status TextLineReader::Seek(int64_t offset) {
+  TF_RETURN_IF_ERROR(input_->Reset());
+  TF_RETURN_IF_ERROR(input_->SkipNBytes(offset));
+  remainder_.clear();
+  offset_ = offset;
+  end_of_input_ = false;
+  return OkStatus();
+}
+
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,117 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_KERNELS_DATA_TEXT_LINE_READER_H_
+#define TENSORFLOW_CORE_KERNELS_DATA_TEXT_LINE_READER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/lib/io/inputstream_interface.h"
+#include "tensorflow/core/platform/refcount.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/tstring.h"
+
+namespace tensorflow {
+namespace data {
+
+// Appends the offsets of the '\n' and '\r' bytes in `data[begin:]` to
+// `newlines` and `carriage_returns` respectively.
+void FindLineBreaks(absl::string_view data, size_t begin,
+                    std::vector<size_t>* newlines,
+                    std::vector<size_t>* carriage_returns);
+
+// A block of input read by `TextLineReader`, and the lines it contains. The
+// lines are views into the block, so they remain valid while it is referenced.
+class TextLineBlock : public core::RefCounted {
+ public:
+  size_t num_lines() const { return line_ends_.size(); }
+
+  // Returns the bytes of line `i`, without its '\n'.
+  absl::string_view raw_line(size_t i) const {
+    const size_t begin = line_begin(i);
+    return absl::string_view(data_.data() + begin, line_ends_[i] - begin);
+  }
+
+  // Returns true if line `i` contains a '\r'. Like `BufferedInputStream`, the
+  // reader drops them, so such lines must be read with `CopyLine`.
+  bool has_carriage_return(size_t i) const;
+
+  // Sets `*line` to line `i` without its '\r's.
+  void CopyLine(size_t i, tstring* line) const;
+
+  // Returns the input offset of line `i`. `LineOffset(num_lines())` is the
+  // offset of the first line after this block.
+  int64_t LineOffset(size_t i) const {
+    return offset_ + (i < num_lines() ? line_begin(i) : size_);
+  }
+
+ private:
+  friend class TextLineReader;
+
+  size_t line_begin(size_t i) const {
+    return i == 0 ? 0 : line_ends_[i - 1] + 1;
+  }
+
+  tstring data_;
+  // Input offset of `data_`.
+  int64_t offset_ = 0;
+  // Number of bytes of `data_` taken by the lines of the block. The rest is a
+  // partial line, which is also the beginning of the next block.
+  size_t size_ = 0;
+  // Offsets of the '\n' ending each line, or of the end of the input for the
+  // last line of a file that doesn't end with a newline.
+  std::vector<size_t> line_ends_;
+  // Offsets of the '\r's in the lines of the block.
+  std::vector<size_t> carriage_returns_;
+};
+
+// Reads the lines of an input stream a block at a time.
+//
+// Unlike `BufferedInputStream::ReadLine`, which scans and copies each line out
+// of its buffer, the reader finds the line breaks of a whole block in one
+// vectorized pass and returns the lines as views into the block. It returns the
+// same lines as `ReadLine`.
+class TextLineReader {
+ public:
+  // Reads `block_size` bytes from `input` at a time. Blocks are extended past
+  // `block_size` to hold lines that are longer. `input` must outlive the
+  // reader.
+  TextLineReader(io::InputStreamInterface* input, size_t block_size);
+
+  // Reads the next block of lines. Each block has at least one line. Returns
+  // an `OutOfRange` error at the end of the input.
+  Status ReadBlock(core::RefCountPtr<TextLineBlock>* block);
+
+  // Returns the input offset of the next line returned by `ReadBlock`.
+  int64_t Tell() const { return offset_; }
+
+  // Moves to `offset`, which must be the offset of a line.
+  Status Seek(int64_t offset);
+
+ private:
+  io::InputStreamInterface* const input_;
+  const size_t block_size_;
+  // The partial line at the end of the last block.
+  tstring remainder_;
+  int64_t offset_ = 0;
+  bool end_of_input_ = false;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_DATA_TEXT_LINE_READER_H_
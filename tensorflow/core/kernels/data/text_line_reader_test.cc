@@ -0,0 +1,194 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/text_line_reader.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/inputstream_interface.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/refcount.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/status_matchers.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/tstring.h"
+#include "tensorflow/core/protobuf/error_codes.pb.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+using ::tensorflow::testing::StatusIs;
+using ::testing::ElementsAre;
+using ::testing::ElementsAreArray;
+using ::testing::IsEmpty;
+
+class StringInputStream : public io::InputStreamInterface {
+ public:
+  explicit StringInputStream(std::string data) : data_(std::move(data)) {}
+
+  Status ReadNBytes(int64_t bytes_to_read, tstring* result) override {
+    const size_t size = std::min<size_t>(bytes_to_read, data_.size() - pos_);
+    result->assign(data_.data() + pos_, size);
+    pos_ += size;
+    if (size < bytes_to_read) {
+      return errors::OutOfRange("Reached the end of the string.");
+    }
+    return OkStatus();
+  }
+
+  int64_t Tell() const override { return pos_; }
+
+  Status Reset() override {
+    pos_ = 0;
+    return OkStatus();
+  }
+
+ private:
+  const std::string data_;
+  size_t pos_ = 0;
+};
+
+// Reads the remaining lines of `reader`, checking that the blocks are
+// contiguous.
+std::vector<std::string> ReadLines(TextLineReader& reader) {
+  std::vector<std::string> lines;
+  while (true) {
+    const int64_t offset = reader.Tell();
+    core::RefCountPtr<TextLineBlock> block;
+    Status s = reader.ReadBlock(&block);
+    if (errors::IsOutOfRange(s)) {
+      return lines;
+    }
+    TF_CHECK_OK(s);
+    EXPECT_GT(block->num_lines(), 0);
+    EXPECT_EQ(block->LineOffset(0), offset);
+    EXPECT_EQ(block->LineOffset(block->num_lines()), reader.Tell());
+    for (size_t i = 0; i < block->num_lines(); ++i) {
+      tstring line;
+      block->CopyLine(i, &line);
+      if (!block->has_carriage_return(i)) {
+        EXPECT_EQ(line, block->raw_line(i));
+      }
+      lines.push_back(line);
+    }
+  }
+}
+
+TEST(FindLineBreaksTest, FindsAllLineBreaks) {
+  // Longer than a vector register, with some breaks at the end.
+  std::string data(70, 'a');
+  std::vector<size_t> expected_newlines = {0, 15, 16, 40, 68};
+  std::vector<size_t> expected_carriage_returns = {14, 33, 69};
+  for (size_t i : expected_newlines) data[i] = '\n';
+  for (size_t i : expected_carriage_returns) data[i] = '\r';
+
+  std::vector<size_t> newlines, carriage_returns;
+  FindLineBreaks(data, /*begin=*/0, &newlines, &carriage_returns);
+  EXPECT_THAT(newlines, ElementsAreArray(expected_newlines));
+  EXPECT_THAT(carriage_returns, ElementsAreArray(expected_carriage_returns));
+
+  newlines.clear();
+  carriage_returns.clear();
+  FindLineBreaks(data, /*begin=*/16, &newlines, &carriage_returns);
+  EXPECT_THAT(newlines, ElementsAre(16, 40, 68));
+  EXPECT_THAT(carriage_returns, ElementsAre(33, 69));
+}
+
+TEST(TextLineReaderTest, ReadsLines) {
+  std::vector<std::string> expected;
+  std::string data;
+  for (int i = 0; i < 100; ++i) {
+    expected.push_back(absl::StrCat("line ", i));
+    absl::StrAppend(&data, expected.back(), "\n");
+  }
+  for (size_t block_size : {1, 7, 64, 1 << 20}) {
+    StringInputStream input(data);
+    TextLineReader reader(&input, block_size);
+    EXPECT_THAT(ReadLines(reader), ElementsAreArray(expected));
+    EXPECT_EQ(reader.Tell(), data.size());
+  }
+}
+
+TEST(TextLineReaderTest, LinesLongerThanBlocks) {
+  const std::string long_line(1000, 'a');
+  StringInputStream input(absl::StrCat("b\n", long_line, "\nc\n"));
+  TextLineReader reader(&input, /*block_size=*/16);
+  EXPECT_THAT(ReadLines(reader), ElementsAre("b", long_line, "c"));
+}
+
+TEST(TextLineReaderTest, DropsCarriageReturns) {
+  StringInputStream input("a\r\n\r\nb\rc\r\r\n");
+  TextLineReader reader(&input, /*block_size=*/4);
+  EXPECT_THAT(ReadLines(reader), ElementsAre("a", "", "bc"));
+}
+
+TEST(TextLineReaderTest, LastLineWithoutNewline) {
+  for (const auto& [data, last_line] :
+       std::vector<std::pair<std::string, std::string>>{
+           {"a\nb", "b"}, {"a\nb\r", "b"}, {"a\n\r", ""}, {"a\n", ""}}) {
+    StringInputStream input(data);
+    TextLineReader reader(&input, /*block_size=*/8);
+    if (last_line.empty()) {
+      EXPECT_THAT(ReadLines(reader), ElementsAre("a"));
+    } else {
+      EXPECT_THAT(ReadLines(reader), ElementsAre("a", last_line));
+    }
+  }
+}
+
+TEST(TextLineReaderTest, EmptyInput) {
+  StringInputStream input("");
+  TextLineReader reader(&input, /*block_size=*/8);
+  core::RefCountPtr<TextLineBlock> block;
+  EXPECT_THAT(reader.ReadBlock(&block), StatusIs(error::OUT_OF_RANGE));
+  EXPECT_THAT(reader.ReadBlock(&block), StatusIs(error::OUT_OF_RANGE));
+}
+
+TEST(TextLineReaderTest, Seek) {
+  StringInputStream input("first\nsecond\nthird\n");
+  TextLineReader reader(&input, /*block_size=*/4);
+  core::RefCountPtr<TextLineBlock> block;
+  TF_ASSERT_OK(reader.ReadBlock(&block));
+  EXPECT_EQ(block->raw_line(0), "first");
+  const int64_t second_line_offset = block->LineOffset(1);
+  EXPECT_THAT(ReadLines(reader), ElementsAre("second", "third"));
+
+  TF_ASSERT_OK(reader.Seek(second_line_offset));
+  EXPECT_THAT(ReadLines(reader), ElementsAre("second", "third"));
+  TF_ASSERT_OK(reader.Seek(0));
+  EXPECT_THAT(ReadLines(reader), ElementsAre("first", "second", "third"));
+}
+
+TEST(TextLineReaderTest, BlocksOutliveReader) {
+  core::RefCountPtr<TextLineBlock> block;
+  {
+    StringInputStream input("a\nb\n");
+    TextLineReader reader(&input, /*block_size=*/64);
+    TF_ASSERT_OK(reader.ReadBlock(&block));
+  }
+  ASSERT_EQ(block->num_lines(), 2);
+  EXPECT_EQ(block->raw_line(0), "a");
+  EXPECT_EQ(block->raw_line(1), "b");
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
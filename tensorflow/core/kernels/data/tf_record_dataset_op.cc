@@ -14,11 +14,18 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/tf_record_dataset_op.h"
 
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "tensorflow/core/data/io_uring_file.h"
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/data/utils.h"
 #include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/kernels/data/tf_record_index.h"
 #include "tensorflow/core/lib/io/buffered_inputstream.h"
 #include "tensorflow/core/lib/io/inputbuffer.h"
 #include "tensorflow/core/lib/io/random_inputstream.h"
@@ -65,7 +72,8 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
         options_(io::RecordReaderOptions::CreateRecordReaderOptions(
             compression_type)),
         byte_offsets_(std::move(byte_offsets)),
-        op_version_(op_version) {
+        op_version_(op_version),
+        read_queue_depth_(ReadQueueDepthFromEnv()) {
     if (buffer_size > 0) {
       options_.buffer_size = buffer_size;
     }
@@ -102,6 +110,54 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
 
   Status CheckExternalState() const override { return OkStatus(); }
 
+  // The records of uncompressed files can be counted, and read by index, by
+  // building an index of the record offsets.
+  int64_t CardinalityInternal(CardinalityOptions options) const override {
+    if (options.compute_level() !=
+            CardinalityOptions::CARDINALITY_COMPUTE_MODERATE ||
+        options_.compression_type != io::RecordReaderOptions::NONE) {
+      return kUnknownCardinality;
+    }
+    StatusOr<const TFRecordIndex*> index = GetIndex();
+    if (!index.ok()) {
+      LOG(WARNING) << "Failed to index the records of " << DebugString()
+                   << ": " << index.status();
+      return kUnknownCardinality;
+    }
+    return (*index)->num_records();
+  }
+
+  Status Get(AnyContext ctx, int64 index,
+             std::vector<Tensor>* out_tensors) const override {
+    std::vector<std::vector<Tensor>> elements;
+    TF_RETURN_IF_ERROR(GetMany(ctx, {index}, &elements));
+    *out_tensors = std::move(elements[0]);
+    return OkStatus();
+  }
+
+  Status GetMany(AnyContext ctx, absl::Span<const int64_t> indices,
+                 std::vector<std::vector<Tensor>>* out_tensors) const override {
+    if (options_.compression_type != io::RecordReaderOptions::NONE) {
+      return errors::FailedPrecondition(
+          "Random access is only supported for uncompressed TFRecord files. "
+          "Got compression type \"", compression_type_, "\".");
+    }
+    TF_ASSIGN_OR_RETURN(const TFRecordIndex* index, GetIndex());
+    std::vector<tstring> records;
+    TF_RETURN_IF_ERROR(index->ReadRecords(indices, &records));
+    static monitoring::CounterCell* bytes_counter =
+        metrics::GetTFDataBytesReadCounter(kDatasetType);
+    out_tensors->resize(records.size());
+    for (size_t i = 0; i < records.size(); ++i) {
+      bytes_counter->IncrementBy(records[i].size());
+      std::vector<Tensor>& element = (*out_tensors)[i];
+      element.clear();
+      element.emplace_back(ctx.allocator, DT_STRING, TensorShape({}));
+      element.back().scalar<tstring>()() = std::move(records[i]);
+    }
+    return OkStatus();
+  }
+
  protected:
   Status AsGraphDefInternal(SerializationContext* ctx,
                             DatasetGraphDefBuilder* b,
@@ -260,9 +316,15 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
       }
 
       // Actually move on to next file.
-      TF_RETURN_IF_ERROR(env->NewRandomAccessFile(
-          TranslateFileName(dataset()->filenames_[current_file_index_]),
-          &file_));
+      const std::string filename =
+          TranslateFileName(dataset()->filenames_[current_file_index_]);
+      TF_RETURN_IF_ERROR(env->NewRandomAccessFile(filename, &file_));
+      // Read the next blocks of the file ahead asynchronously if enabled.
+      file_ = MaybeMakeIoUringFile(filename, std::move(file_),
+                                   dataset()->read_queue_depth_,
+                                   dataset()->options_.buffer_size > 0
+                                       ? dataset()->options_.buffer_size
+                                       : kDefaultReadAheadBlockSize);
       reader_ = std::make_unique<io::SequentialRecordReader>(
           file_.get(), dataset()->options_);
       if (!dataset()->byte_offsets_.empty()) {
@@ -287,11 +349,39 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
     std::unique_ptr<io::SequentialRecordReader> reader_ TF_GUARDED_BY(mu_);
   };
 
+  // Returns the index of the records, building it on first use.
+  StatusOr<const TFRecordIndex*> GetIndex() const TF_LOCKS_EXCLUDED(index_mu_) {
+    mutex_lock l(index_mu_);
+    if (index_ == nullptr && index_status_.ok()) {
+      std::vector<std::string> filenames;
+      filenames.reserve(filenames_.size());
+      for (const std::string& filename : filenames_) {
+        filenames.push_back(TranslateFileName(filename));
+      }
+      StatusOr<std::unique_ptr<TFRecordIndex>> index =
+          TFRecordIndex::Create(Env::Default(), filenames, byte_offsets_,
+                                options_.buffer_size);
+      if (index.ok()) {
+        index_ = std::move(*index);
+      } else {
+        index_status_ = index.status();
+      }
+    }
+    TF_RETURN_IF_ERROR(index_status_);
+    return index_.get();
+  }
+
   const std::vector<string> filenames_;
   const tstring compression_type_;
   io::RecordReaderOptions options_;
   const std::vector<int64_t> byte_offsets_;
   const int op_version_;
+  // Number of block reads kept in flight when reading ahead from local files.
+  const int64_t read_queue_depth_;
+
+  mutable mutex index_mu_;
+  mutable std::unique_ptr<TFRecordIndex> index_ TF_GUARDED_BY(index_mu_);
+  mutable Status index_status_ TF_GUARDED_BY(index_mu_);
 };
 
 TFRecordDatasetOp::TFRecordDatasetOp(OpKernelConstruction* ctx)
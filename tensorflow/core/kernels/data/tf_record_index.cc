@@ -0,0 +1,181 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/tf_record_index.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
+#include "tensorflow/core/lib/core/coding.h"
+#include "tensorflow/core/lib/hash/crc32c.h"
+#include "tensorflow/core/lib/io/record_reader.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/platform/tstring.h"
+
+namespace tensorflow {
+namespace data {
+
+constexpr int64_t TFRecordIndex::kMaxCoalescedGapBytes;
+constexpr int64_t TFRecordIndex::kMaxCoalescedReadBytes;
+
+namespace {
+
+constexpr uint64_t kHeaderSize = io::RecordReader::kHeaderSize;
+constexpr uint64_t kFooterSize = io::RecordReader::kFooterSize;
+
+}  // namespace
+
+StatusOr<std::unique_ptr<TFRecordIndex>> TFRecordIndex::Create(
+    Env* env, const std::vector<std::string>& filenames,
+    const std::vector<int64_t>& byte_offsets, int64_t buffer_size) {
+  if (!byte_offsets.empty() && byte_offsets.size() != filenames.size()) {
+    return errors::InvalidArgument("Got ", byte_offsets.size(),
+                                   " byte offsets for ", filenames.size(),
+                                   " TFRecord files.");
+  }
+  io::RecordReaderOptions options;
+  if (buffer_size > 0) {
+    options.buffer_size = buffer_size;
+  }
+  std::vector<File> files(filenames.size());
+  int64_t num_records = 0;
+  for (size_t i = 0; i < filenames.size(); ++i) {
+    File& file = files[i];
+    file.filename = filenames[i];
+    file.first_record = num_records;
+    TF_RETURN_IF_ERROR(env->NewRandomAccessFile(file.filename, &file.file));
+    io::RecordReader reader(file.file.get(), options);
+    uint64_t offset = byte_offsets.empty() ? 0 : byte_offsets[i];
+    while (true) {
+      file.offsets.push_back(offset);
+      int num_skipped = 0;
+      Status s = reader.SkipRecords(&offset, /*num_to_skip=*/1, &num_skipped);
+      if (errors::IsOutOfRange(s)) {
+        break;
+      }
+      if (!s.ok()) {
+        return errors::CreateWithUpdatedMessage(
+            s, absl::StrCat("Failed to index TFRecord file ", file.filename,
+                            ": ", s.message()));
+      }
+    }
+    num_records += file.num_records();
+  }
+  return absl::WrapUnique(new TFRecordIndex(std::move(files)));
+}
+
+TFRecordIndex::TFRecordIndex(std::vector<File> files)
+    : files_(std::move(files)),
+      num_records_(files_.empty() ? 0
+                                  : files_.back().first_record +
+                                        files_.back().num_records()) {}
+
+const TFRecordIndex::File& TFRecordIndex::FileOf(int64_t index) const {
+  // Finds the last file whose first record is at or before `index`. Empty
+  // files are skipped since the next file has the same first record.
+  auto it = std::upper_bound(
+      files_.begin(), files_.end(), index,
+      [](int64_t position, const File& file) {
+        return position < file.first_record;
+      });
+  return *(it - 1);
+}
+
+Status TFRecordIndex::ReadRecords(absl::Span<const int64_t> indices,
+                                  std::vector<tstring>* records) const {
+  records->resize(indices.size());
+  std::string scratch;
+  size_t begin = 0;
+  while (begin < indices.size()) {
+    if (indices[begin] < 0 || indices[begin] >= num_records_) {
+      return errors::OutOfRange("Index out of range [0, ", num_records_,
+                                "): ", indices[begin]);
+    }
+    const File& file = FileOf(indices[begin]);
+    const int64_t file_end = file.first_record + file.num_records();
+    const uint64_t read_begin =
+        file.offsets[indices[begin] - file.first_record];
+    uint64_t read_end = file.offsets[indices[begin] - file.first_record + 1];
+    // Extends the read to the following records of the same file while they
+    // are close enough.
+    size_t end = begin + 1;
+    while (end < indices.size() && indices[end] < file_end) {
+      if (indices[end] < indices[end - 1]) {
+        return errors::InvalidArgument(
+            "The indices of the records to read must be sorted. Got ",
+            indices[end], " after ", indices[end - 1], ".");
+      }
+      const int64_t record = indices[end] - file.first_record;
+      if (file.offsets[record] > read_end + kMaxCoalescedGapBytes ||
+          file.offsets[record + 1] - read_begin > kMaxCoalescedReadBytes) {
+        break;
+      }
+      read_end = std::max(read_end, file.offsets[record + 1]);
+      ++end;
+    }
+
+    scratch.resize(read_end - read_begin);
+    StringPiece data;
+    TF_RETURN_IF_ERROR(file.file->Read(read_begin, scratch.size(), &data,
+                                       scratch.data()));
+    if (data.size() != scratch.size()) {
+      return errors::DataLoss("Truncated TFRecord file ", file.filename,
+                              ": expected ", scratch.size(), " bytes at ",
+                              read_begin, ", got ", data.size(), ".");
+    }
+    for (size_t i = begin; i < end; ++i) {
+      const int64_t record = indices[i] - file.first_record;
+      const uint64_t offset = file.offsets[record];
+      TF_RETURN_IF_ERROR(ParseRecord(file, offset,
+                                     data.data() + (offset - read_begin),
+                                     file.offsets[record + 1] - offset,
+                                     &(*records)[i]));
+    }
+    begin = end;
+  }
+  return OkStatus();
+}
+
+Status TFRecordIndex::ParseRecord(const File& file, uint64_t offset,
+                                  const char* data, uint64_t size,
+                                  tstring* record) {
+  const uint64_t length = core::DecodeFixed64(data);
+  if (crc32c::Unmask(core::DecodeFixed32(data + sizeof(uint64_t))) !=
+          crc32c::Value(data, sizeof(uint64_t)) ||
+      length != size - kHeaderSize - kFooterSize) {
+    return errors::DataLoss("Corrupted record header at ", offset,
+                            " in TFRecord file ", file.filename, ".");
+  }
+  const char* payload = data + kHeaderSize;
+  if (crc32c::Unmask(core::DecodeFixed32(payload + length)) !=
+      crc32c::Value(payload, length)) {
+    return errors::DataLoss("Corrupted record at ", offset,
+                            " in TFRecord file ", file.filename, ".");
+  }
+  record->assign(payload, length);
+  return OkStatus();
+}
+
+}  // namespace data
+}  // namespace tensorflow
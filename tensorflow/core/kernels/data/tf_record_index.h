@@ -0,0 +1,94 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_KERNELS_DATA_TF_RECORD_INDEX_H_
+#define TENSORFLOW_CORE_KERNELS_DATA_TF_RECORD_INDEX_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/platform/tstring.h"
+
+namespace tensorflow {
+namespace data {
+
+// An index of the record offsets of a sequence of uncompressed TFRecord files,
+// which allows reading the records of the sequence in any order.
+//
+// The index is built by reading the record headers and skipping over the
+// record data, and takes 8 bytes of memory per record.
+class TFRecordIndex {
+ public:
+  // Records of a file which are at most this many bytes apart are read
+  // together by `ReadRecords`.
+  static constexpr int64_t kMaxCoalescedGapBytes = 64 << 10;  // 64KB
+  // The maximum size of a read which serves multiple records.
+  static constexpr int64_t kMaxCoalescedReadBytes = 16 << 20;  // 16MB
+
+  // Builds the index of the records in `filenames`. If `byte_offsets` is not
+  // empty, it holds the offset of the first record of each file. The headers
+  // are read through a buffer of `buffer_size` bytes.
+  static StatusOr<std::unique_ptr<TFRecordIndex>> Create(
+      Env* env, const std::vector<std::string>& filenames,
+      const std::vector<int64_t>& byte_offsets, int64_t buffer_size);
+
+  TFRecordIndex(const TFRecordIndex&) = delete;
+  TFRecordIndex& operator=(const TFRecordIndex&) = delete;
+
+  // Returns the number of records in all files.
+  int64_t num_records() const { return num_records_; }
+
+  // Reads the records at `indices`, which must be sorted in increasing order,
+  // into `records`. Records which are close to each other in a file are read
+  // with a single read. This method is thread-safe.
+  Status ReadRecords(absl::Span<const int64_t> indices,
+                     std::vector<tstring>* records) const;
+
+ private:
+  struct File {
+    std::string filename;
+    std::unique_ptr<RandomAccessFile> file;
+    // The position of the first record of the file in the sequence.
+    int64_t first_record = 0;
+    // The offsets of the records of the file, followed by the offset of the
+    // end of the last record.
+    std::vector<uint64_t> offsets;
+
+    int64_t num_records() const { return offsets.size() - 1; }
+  };
+
+  explicit TFRecordIndex(std::vector<File> files);
+
+  // Returns the file which holds the record at `index`.
+  const File& FileOf(int64_t index) const;
+
+  // Parses the record which starts at `data`, whose size including its header
+  // and footer is `size`.
+  static Status ParseRecord(const File& file, uint64_t offset,
+                            const char* data, uint64_t size, tstring* record);
+
+  const std::vector<File> files_;
+  const int64_t num_records_;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_DATA_TF_RECORD_INDEX_H_
@@ -0,0 +1,158 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/tf_record_index.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/record_writer.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/status_matchers.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/tstring.h"
+#include "tensorflow/core/protobuf/error_codes.pb.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+using ::tensorflow::testing::StatusIs;
+using ::testing::ElementsAre;
+using ::testing::ElementsAreArray;
+using ::testing::HasSubstr;
+
+std::string TestRecord(int64_t file, int64_t record) {
+  // Records of different sizes, some larger than the coalescing gap.
+  return std::string(record % 3 == 2 ? 100 << 10 : 10 + record,
+                     'a' + (file * 7 + record) % 26);
+}
+
+// Writes files with the given numbers of records, and returns their names.
+std::vector<std::string> WriteFiles(const std::vector<int64_t>& num_records) {
+  std::vector<std::string> filenames;
+  for (int64_t i = 0; i < num_records.size(); ++i) {
+    filenames.push_back(io::JoinPath(
+        ::testing::TempDir(),
+        absl::StrCat(::testing::UnitTest::GetInstance()->current_test_info()
+                         ->name(),
+                     "_", i, ".tfrecord")));
+    std::unique_ptr<WritableFile> file;
+    TF_CHECK_OK(Env::Default()->NewWritableFile(filenames.back(), &file));
+    io::RecordWriter writer(file.get());
+    for (int64_t j = 0; j < num_records[i]; ++j) {
+      TF_CHECK_OK(writer.WriteRecord(TestRecord(i, j)));
+    }
+    TF_CHECK_OK(writer.Close());
+    TF_CHECK_OK(file->Close());
+  }
+  return filenames;
+}
+
+TEST(TFRecordIndexTest, ReadRecords) {
+  std::vector<std::string> filenames = WriteFiles({5, 0, 7, 1});
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<TFRecordIndex> index,
+      TFRecordIndex::Create(Env::Default(), filenames, /*byte_offsets=*/{},
+                            /*buffer_size=*/0));
+  EXPECT_EQ(index->num_records(), 13);
+
+  std::vector<std::string> expected;
+  for (int64_t i : {0, 2, 3}) {
+    for (int64_t j = 0; j < (i == 0 ? 5 : i == 2 ? 7 : 1); ++j) {
+      expected.push_back(TestRecord(i, j));
+    }
+  }
+  std::vector<int64_t> all_indices(13);
+  for (int64_t i = 0; i < 13; ++i) {
+    all_indices[i] = i;
+  }
+  std::vector<tstring> records;
+  TF_ASSERT_OK(index->ReadRecords(all_indices, &records));
+  EXPECT_THAT(records, ElementsAreArray(expected));
+
+  TF_ASSERT_OK(index->ReadRecords({1, 1, 4, 5, 11, 12}, &records));
+  EXPECT_THAT(records, ElementsAre(expected[1], expected[1], expected[4],
+                                   expected[5], expected[11], expected[12]));
+  TF_ASSERT_OK(index->ReadRecords({}, &records));
+  EXPECT_TRUE(records.empty());
+}
+
+TEST(TFRecordIndexTest, ByteOffsets) {
+  std::vector<std::string> filenames = WriteFiles({3, 3});
+  // Skips the first record of the second file.
+  const int64_t offset = TestRecord(1, 0).size() + 16;
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<TFRecordIndex> index,
+                          TFRecordIndex::Create(Env::Default(), filenames,
+                                                /*byte_offsets=*/{0, offset},
+                                                /*buffer_size=*/1024));
+  EXPECT_EQ(index->num_records(), 5);
+  std::vector<tstring> records;
+  TF_ASSERT_OK(index->ReadRecords({2, 3}, &records));
+  EXPECT_THAT(records, ElementsAre(TestRecord(0, 2), TestRecord(1, 1)));
+}
+
+TEST(TFRecordIndexTest, InvalidIndices) {
+  std::vector<std::string> filenames = WriteFiles({3});
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<TFRecordIndex> index,
+      TFRecordIndex::Create(Env::Default(), filenames, /*byte_offsets=*/{},
+                            /*buffer_size=*/0));
+  std::vector<tstring> records;
+  EXPECT_THAT(index->ReadRecords({3}, &records),
+              StatusIs(error::OUT_OF_RANGE));
+  EXPECT_THAT(index->ReadRecords({-1}, &records),
+              StatusIs(error::OUT_OF_RANGE));
+  EXPECT_THAT(index->ReadRecords({1, 0}, &records),
+              StatusIs(error::INVALID_ARGUMENT, HasSubstr("sorted")));
+}
+
+TEST(TFRecordIndexTest, CorruptedRecord) {
+  std::vector<std::string> filenames = WriteFiles({2});
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<TFRecordIndex> index,
+      TFRecordIndex::Create(Env::Default(), filenames, /*byte_offsets=*/{},
+                            /*buffer_size=*/0));
+  std::string contents;
+  TF_ASSERT_OK(ReadFileToString(Env::Default(), filenames[0], &contents));
+  // Corrupts the data of the second record.
+  contents[contents.size() - 5] ^= 1;
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), filenames[0], contents));
+
+  std::vector<tstring> records;
+  TF_ASSERT_OK(index->ReadRecords({0}, &records));
+  EXPECT_THAT(index->ReadRecords({1}, &records),
+              StatusIs(error::DATA_LOSS, HasSubstr(filenames[0])));
+}
+
+TEST(TFRecordIndexTest, TruncatedFile) {
+  std::vector<std::string> filenames = WriteFiles({2});
+  std::string contents;
+  TF_ASSERT_OK(ReadFileToString(Env::Default(), filenames[0], &contents));
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), filenames[0],
+                                 contents.substr(0, contents.size() - 8)));
+  EXPECT_THAT(
+      TFRecordIndex::Create(Env::Default(), filenames, /*byte_offsets=*/{},
+                            /*buffer_size=*/0),
+      StatusIs(error::DATA_LOSS, HasSubstr(filenames[0])));
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -16,7 +16,9 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_DEBUG_OPS_H_
 #define TENSORFLOW_CORE_KERNELS_DEBUG_OPS_H_
 
+#include <atomic>
 #include <cstdint>
+#include <limits>
 #include <memory>
 #include <numeric>
 
@@ -470,6 +472,12 @@ class DebugIdentityV2Op : public OpKernel {
 
   void Compute(OpKernelContext* context) override {
     const Tensor& tensor = context->input(0);
+    // A summary op that samples its executions outputs an empty summary for
+    // the executions it doesn't sample, there is nothing to write for those.
+    if (tensor.NumElements() == 0 && IsSummaryDebugMode(tensor_debug_mode_)) {
+      context->set_output(0, tensor);
+      return;
+    }
     for (const string& dump_root : dump_roots_) {
       tfdbg::DebugEventsWriter* debug_events_writer =
           tfdbg::DebugEventsWriter::GetDebugEventsWriter(
@@ -487,11 +495,62 @@ class DebugIdentityV2Op : public OpKernel {
   string device_name_;
   string op_name_;
   int32 output_slot_;
+  // Returns true if the input of the op is a summary computed by
+  // DebugNumericSummaryV2, as opposed to no tensor or the full tensor.
+  static bool IsSummaryDebugMode(int32 tensor_debug_mode) {
+    switch (tensor_debug_mode) {
+      case 2:  // CURT_HEALTH
+      case 3:  // CONCISE_HEALTH
+      case 4:  // FULL_HEALTH
+      case 5:  // SHAPE
+      case 6:  // FULL_NUMERICS
+      case 8:  // REDUCE_INF_NAN_THREE_SLOTS
+        return true;
+      default:
+        return false;
+    }
+  }
+
   int32 tensor_debug_mode_;
   int64_t circular_buffer_size_;
   string tfdbg_run_id_;
 };
 
+// Decides which executions of a DebugNumericSummaryV2 op are summarized: the
+// first one and every sampling_period-th one after it.
+class DebugSummarySampler {
+ public:
+  explicit DebugSummarySampler(OpKernelConstruction* context) {
+    if (context->HasAttr("sampling_period")) {
+      OP_REQUIRES_OK(context,
+                     context->GetAttr("sampling_period", &sampling_period_));
+    }
+  }
+
+  bool ShouldSample() {
+    return sampling_period_ <= 1 ||
+           num_executions_.fetch_add(1, std::memory_order_relaxed) %
+                   sampling_period_ ==
+               0;
+  }
+
+ private:
+  int64_t sampling_period_ = 1;
+  std::atomic<int64_t> num_executions_{0};
+};
+
+// Returns true if `y` is a nonzero floating point number that is smaller in
+// magnitude than the smallest normal number of its type.
+template <typename T>
+EIGEN_DEVICE_FUNC inline bool IsDenormal(const T& y) {
+  if constexpr (Eigen::NumTraits<T>::IsInteger) {
+    return false;
+  } else {
+    return y != static_cast<T>(0.f) &&
+           Eigen::numext::abs(y) < std::numeric_limits<T>::min();
+  }
+}
+
 typedef Eigen::ThreadPoolDevice CPUDevice;
 typedef Eigen::GpuDevice GPUDevice;
 
@@ -532,6 +591,18 @@ extern template struct FullHealthLaunch<Eigen::half, double>;
 extern template struct FullHealthLaunch<float, double>;
 extern template struct FullHealthLaunch<double, double>;
 
+template <typename Tin, typename Tout>
+struct FullNumericsLaunch {
+  void Run(const GPUDevice& d, const Tin* data, int size, Tout output[11]);
+};
+
+extern template struct FullNumericsLaunch<Eigen::half, float>;
+extern template struct FullNumericsLaunch<float, float>;
+extern template struct FullNumericsLaunch<double, float>;
+extern template struct FullNumericsLaunch<Eigen::half, double>;
+extern template struct FullNumericsLaunch<float, double>;
+extern template struct FullNumericsLaunch<double, double>;
+
 template <typename Tin, typename Tout>
 struct ReduceInfNanThreeSlotsLaunch {
   void Run(const GPUDevice& d, const Tin* data, int size, Tout output[3]);
@@ -554,7 +625,7 @@ template <typename Tin, typename Tout>
 class DebugNumericSummaryV2Op<CPUDevice, Tin, Tout> : public OpKernel {
  public:
   explicit DebugNumericSummaryV2Op(OpKernelConstruction* context)
-      : OpKernel(context) {
+      : OpKernel(context), sampler_(context) {
     OP_REQUIRES_OK(context,
                    context->GetAttr("tensor_debug_mode", &tensor_debug_mode_));
     OP_REQUIRES_OK(context, context->GetAttr("tensor_id", &tensor_id_));
@@ -566,6 +637,11 @@ class DebugNumericSummaryV2Op<CPUDevice, Tin, Tout> : public OpKernel {
     const Tin* data = in.data();
     const int64_t size = in.size();
     Tensor* output_tensor;
+    if (!sampler_.ShouldSample()) {
+      OP_REQUIRES_OK(context, context->allocate_output(0, TensorShape({0}),
+                                                       &output_tensor));
+      return;
+    }
     Tout tensor_id = static_cast<Tout>(tensor_id_);
     const Tout num_elem = static_cast<Tout>(context->input(0).NumElements());
     // Disregard lossy cast if mode is REDUCE_INF_NAN_THREE_SLOTS because
@@ -683,6 +759,78 @@ class DebugNumericSummaryV2Op<CPUDevice, Tin, Tout> : public OpKernel {
           output_tensor->flat<Tout>()(dim_idx++) = 0.0;
         }
       }
+    } else if (tensor_debug_mode_ == 6) {  // FULL_NUMERICS
+      TensorShape shape({kFullNumericsSize});
+      OP_REQUIRES_OK(context,
+                     context->allocate_output(0, shape, &output_tensor));
+      auto output = output_tensor->flat<Tout>();
+      output.setZero();
+      int num_dims = tensor.dims();
+      output(0) = tensor_id;
+      output(1) = -1.0;  // TODO(144919262): Device ID
+      output(2) = static_cast<Tout>(tensor.dtype());
+      output(3) = static_cast<Tout>(num_dims);
+      // Tensor shape: right pad zeros, truncate head.
+      int dim_idx = 4;
+      for (int i = std::max(0, num_dims - kShapeDims); i < num_dims; ++i) {
+        output(dim_idx++) = static_cast<Tout>(tensor.dim_size(i));
+      }
+      output(10) = num_elem;
+
+      // Accumulator value [neg_inf_count, pos_inf_count, nan_count,
+      //                   denormal_count, neg_count, zero_count, pos_count]
+      Tout fp_props[7] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+      Tout min = std::numeric_limits<Tout>::infinity();
+      Tout max = -std::numeric_limits<Tout>::infinity();
+      Tout sum = 0.0;
+      std::for_each(data, data + size, [&](const Tin& y) {
+        if (TF_PREDICT_TRUE(Eigen::numext::isfinite(y))) {
+          if (IsDenormal(y)) {
+            ++fp_props[3];
+          }
+          if (y < static_cast<Tin>(0.f)) {
+            ++fp_props[4];
+          } else if (y == static_cast<Tin>(0.f)) {
+            ++fp_props[5];
+          } else {
+            ++fp_props[6];
+          }
+          const Tout x = static_cast<Tout>(y);
+          min = std::min(min, x);
+          max = std::max(max, x);
+          sum += x;
+        } else if (Eigen::numext::isinf(y)) {
+          if (y < static_cast<Tin>(0.f)) {
+            ++fp_props[0];
+          } else {
+            ++fp_props[1];
+          }
+        } else if (Eigen::numext::isnan(y)) {
+          ++fp_props[2];
+        }
+      });
+      Tout mean = std::numeric_limits<Tout>::quiet_NaN();
+      Tout variance = std::numeric_limits<Tout>::quiet_NaN();
+      const Tout finite_count = fp_props[4] + fp_props[5] + fp_props[6];
+      if (finite_count > 0) {
+        mean = sum / finite_count;
+        // Do a second pass to compute the variance.
+        Tout sum_squares = 0.0;
+        std::for_each(data, data + size, [&](const Tin& y) {
+          if (Eigen::numext::isfinite(y)) {
+            const Tout x = static_cast<Tout>(y) - mean;
+            sum_squares += x * x;
+          }
+        });
+        variance = sum_squares / finite_count;
+      }
+      for (int i = 0; i < 7; ++i) {
+        output(11 + i) = fp_props[i];
+      }
+      output(18) = min;
+      output(19) = max;
+      output(20) = mean;
+      output(21) = variance;
     } else if (tensor_debug_mode_ == 8) {  // REDUCE_INF_NAN_THREE_SLOTS.
       TensorShape shape({3});
       OP_REQUIRES_OK(context,
@@ -723,7 +871,9 @@ class DebugNumericSummaryV2Op<CPUDevice, Tin, Tout> : public OpKernel {
  private:
   int tensor_debug_mode_;
   int64_t tensor_id_;
+  DebugSummarySampler sampler_;
   static constexpr int kShapeDims = 6;
+  static constexpr int kFullNumericsSize = 22;
   static constexpr int kNegInfBit = 0x01;
   static constexpr int kPosInfBit = 0x02;
   static constexpr int kNaNBit = 0x04;
@@ -739,7 +889,7 @@ class DebugNumericSummaryV2Op<GPUDevice, Tin, Tout> : public AsyncOpKernel {
   typedef GPUDevice Device;
 
   explicit DebugNumericSummaryV2Op(OpKernelConstruction* context)
-      : AsyncOpKernel(context) {
+      : AsyncOpKernel(context), sampler_(context) {
     OP_REQUIRES_OK(context,
                    context->GetAttr("tensor_debug_mode", &tensor_debug_mode_));
     OP_REQUIRES_OK(context, context->GetAttr("tensor_id", &tensor_id_));
@@ -747,6 +897,13 @@ class DebugNumericSummaryV2Op<GPUDevice, Tin, Tout> : public AsyncOpKernel {
 
   void ComputeAsync(OpKernelContext* context, DoneCallback done) override {
     Tensor* output_tensor;
+    if (!sampler_.ShouldSample()) {
+      OP_REQUIRES_OK_ASYNC(
+          context,
+          context->allocate_output(0, TensorShape({0}), &output_tensor), done);
+      done();
+      return;
+    }
     Tout tensor_id = static_cast<Tout>(tensor_id_);
     const Tensor& tensor = context->input(0);
     const Tout num_elem = static_cast<Tout>(tensor.NumElements());
@@ -898,6 +1055,58 @@ class DebugNumericSummaryV2Op<GPUDevice, Tin, Tout> : public AsyncOpKernel {
       }
       // Write to device stream
       stream->ThenMemcpy(&output_tensor_ptr, &static_output, sizeof(Tout) * 10);
+      context->device()
+          ->tensorflow_accelerator_device_info()
+          ->event_mgr->ThenExecute(stream, std::move(check_cb));
+    } else if (tensor_debug_mode_ == 6) {  // FULL_NUMERICS
+      TensorShape shape({22});
+      OP_REQUIRES_OK(context,
+                     context->allocate_output(0, shape, &output_tensor));
+
+      auto* stream = context->op_device_context()->stream();
+      OP_REQUIRES_ASYNC(context, stream != nullptr,
+                        errors::Internal("No GPU stream available."), done);
+      OP_REQUIRES_ASYNC(context, !tensorflow::OpDeterminismRequired(),
+                        errors::Unimplemented(
+                            "Determinism is not yet supported for "
+                            "DebugNumericSummaryV2 when tensor_debug_mode is "
+                            "FULL_NUMERICS."),
+                        done);
+
+      se::DeviceMemoryBase output_tensor_ptr(
+          output_tensor->flat<Tout>().data(),
+          output_tensor->flat<Tout>().size());
+
+      int num_dims = tensor.dims();
+      Tout static_output[22] = {tensor_id,
+                                -1.0,  // TODO(144919262): Device ID
+                                static_cast<Tout>(tensor.dtype()),
+                                static_cast<Tout>(num_dims)};
+      // Tensor shape: right pad zeros, truncate head
+      int dim_idx = 4;
+      for (int i = std::max(0, num_dims - 6); i < num_dims; ++i) {
+        static_output[dim_idx++] = static_cast<Tout>(tensor.dim_size(i));
+      }
+      static_output[10] = num_elem;
+      // Identities of the min and max reductions. The mean and variance slots
+      // accumulate the sum and sum of squares until they are finalized.
+      static_output[18] = std::numeric_limits<Tout>::infinity();
+      static_output[19] = -std::numeric_limits<Tout>::infinity();
+      if (num_elem == 0) {
+        static_output[20] = std::numeric_limits<Tout>::quiet_NaN();
+        static_output[21] = std::numeric_limits<Tout>::quiet_NaN();
+      }
+      stream->ThenMemcpy(&output_tensor_ptr, &static_output, 22 * sizeof(Tout));
+      if (num_elem == 0) {
+        done();
+        return;
+      }
+
+      // Call the GPU kernels for the value counts and the summary statistics.
+      FullNumericsLaunch<Tin, Tout>().Run(
+          d, input.data(), input.size(),
+          output_tensor->flat<Tout>().data() + 11);
+
       context->device()
           ->tensorflow_accelerator_device_info()
           ->event_mgr->ThenExecute(stream, std::move(check_cb));
@@ -939,6 +1148,7 @@ class DebugNumericSummaryV2Op<GPUDevice, Tin, Tout> : public AsyncOpKernel {
  private:
   int tensor_debug_mode_;
   int64_t tensor_id_;
+  DebugSummarySampler sampler_;
   static constexpr int64_t kMaxTensorId = 1L
                                           << std::numeric_limits<Tout>::digits;
 };
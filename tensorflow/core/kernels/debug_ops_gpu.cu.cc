@@ -21,6 +21,7 @@ limitations under the License.
 #include <stdio.h>
 
 #include <algorithm>
+#include <limits>
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/platform/types.h"
@@ -33,6 +34,18 @@ namespace {
 
 typedef Eigen::GpuDevice GPUDevice;
 
+// Returns true if `y` is a nonzero floating point number that is smaller in
+// magnitude than the smallest normal number of its type.
+template <typename T>
+__device__ bool IsDenormal(const T& y) {
+  if constexpr (Eigen::NumTraits<T>::IsInteger) {
+    return false;
+  } else {
+    return y != static_cast<T>(0.f) &&
+           Eigen::numext::abs(y) < std::numeric_limits<T>::min();
+  }
+}
+
 // A CUDA kernel that fills the second element of a vector according
 // to whether any of the input data contains infinity or NaN.
 template <typename Tin, typename Tout>
@@ -122,6 +135,79 @@ __global__ void FullHealthKernel(const Tin* __restrict__ data, int size,
   GpuAtomicAdd(output + 5, accum[5]);
 }
 
+// A CUDA kernel that fills the first seven elements of an output vector with
+// the number of -infs, infs, nans, denormals, negatives, zeros, and positives
+// in the input respectively. The remaining four elements, which must be
+// initialized to +inf, -inf, zero and zero, are filled with the min, max, sum
+// and sum of squares of the finite elements of the input.
+template <typename Tin, typename Tout>
+__global__ void FullNumericsKernel(const Tin* __restrict__ data, int size,
+                                   Tout output[11]) {
+  const int32 thread_id = blockIdx.x * blockDim.x + threadIdx.x;
+  const int32 total_thread_count = gridDim.x * blockDim.x;
+
+  int32 offset = thread_id;
+  Tout accum[7] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+  Tout min = std::numeric_limits<Tout>::infinity();
+  Tout max = -std::numeric_limits<Tout>::infinity();
+  Tout sum = 0.0;
+  Tout sum_squares = 0.0;
+
+  while (offset < size) {
+    const Tin y = data[offset];
+    if (Eigen::numext::isinf(y)) {
+      if (y < static_cast<Tin>(0.f)) {
+        ++accum[0];
+      } else {
+        ++accum[1];
+      }
+    } else if (Eigen::numext::isnan(y)) {
+      ++accum[2];
+    } else {
+      if (IsDenormal(y)) {
+        ++accum[3];
+      }
+      if (y < static_cast<Tin>(0.f)) {
+        ++accum[4];
+      } else if (y == static_cast<Tin>(0.f)) {
+        ++accum[5];
+      } else {
+        ++accum[6];
+      }
+      const Tout x = static_cast<Tout>(y);
+      min = x < min ? x : min;
+      max = x > max ? x : max;
+      sum += x;
+      sum_squares += x * x;
+    }
+    offset += total_thread_count;
+  }
+
+  for (int i = 0; i < 7; ++i) {
+    GpuAtomicAdd(output + i, accum[i]);
+  }
+  GpuAtomicMin(output + 7, min);
+  GpuAtomicMax(output + 8, max);
+  GpuAtomicAdd(output + 9, sum);
+  GpuAtomicAdd(output + 10, sum_squares);
+}
+
+// A CUDA kernel that turns the sum and sum of squares computed by
+// FullNumericsKernel into the mean and variance of the finite elements.
+template <typename Tout>
+__global__ void FullNumericsFinalizeKernel(Tout output[11]) {
+  const Tout count = output[4] + output[5] + output[6];
+  if (count > 0) {
+    const Tout mean = output[9] / count;
+    const Tout variance = output[10] / count - mean * mean;
+    output[9] = mean;
+    output[10] = variance > 0 ? variance : 0;
+  } else {
+    output[9] = std::numeric_limits<Tout>::quiet_NaN();
+    output[10] = std::numeric_limits<Tout>::quiet_NaN();
+  }
+}
+
 // A CUDA kernel that fills a length-3 vector according to whether any of the
 // input data contains negative infinity, positive infinity, or NaN. The first
 // element is filled with -infinity if any of the elements is -infinity.
@@ -224,6 +310,32 @@ template struct FullHealthLaunch<double, double>;
 template struct FullHealthLaunch<int16, double>;
 template struct FullHealthLaunch<int32, double>;
 
+template <typename Tin, typename Tout>
+struct FullNumericsLaunch {
+  void Run(const GPUDevice& d, const Tin* data, int size, Tout output[11]) {
+    const int32 block_size = d.maxGpuThreadsPerBlock();
+    const int32 num_blocks =
+        (d.getNumGpuMultiProcessors() * d.maxGpuThreadsPerMultiProcessor()) /
+        block_size;
+
+    TF_CHECK_OK(GpuLaunchKernel(FullNumericsKernel<Tin, Tout>, num_blocks,
+                                block_size, 0, d.stream(), data, size, output));
+    TF_CHECK_OK(GpuLaunchKernel(FullNumericsFinalizeKernel<Tout>, 1, 1, 0,
+                                d.stream(), output));
+  }
+};
+
+template struct FullNumericsLaunch<Eigen::half, float>;
+template struct FullNumericsLaunch<float, float>;
+template struct FullNumericsLaunch<double, float>;
+template struct FullNumericsLaunch<int16, float>;
+template struct FullNumericsLaunch<int32, float>;
+template struct FullNumericsLaunch<Eigen::half, double>;
+template struct FullNumericsLaunch<float, double>;
+template struct FullNumericsLaunch<double, double>;
+template struct FullNumericsLaunch<int16, double>;
+template struct FullNumericsLaunch<int32, double>;
+
 template <typename Tin, typename Tout>
 struct ReduceInfNanThreeSlotsLaunch {
   void Run(const GPUDevice& d, const Tin* data, int size, Tout output[3]) {
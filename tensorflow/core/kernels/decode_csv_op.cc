@@ -14,11 +14,15 @@ limitations under the License.
 ==============================================================================*/
 
 // See docs in ../ops/parsing_ops.cc.
+#include <deque>
 #include <vector>
+
+#include "absl/strings/str_replace.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/csv_parsing.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/strings/numbers.h"
 
@@ -81,10 +85,13 @@ class DecodeCSVOp : public OpKernel {
       OP_REQUIRES_OK(ctx, output.allocate(i, records->shape(), &out));
     }
 
+    std::vector<StringPiece> fields;
+    std::deque<string> unescaped_fields;
     for (int64_t i = 0; i < records_size; ++i) {
       const StringPiece record(records_t(i));
-      std::vector<string> fields;
-      ExtractFields(ctx, record, &fields);
+      fields.clear();
+      unescaped_fields.clear();
+      OP_REQUIRES_OK(ctx, ExtractFields(record, &fields, &unescaped_fields));
       OP_REQUIRES(ctx, fields.size() == out_type_.size(),
                   errors::InvalidArgument("Expect ", out_type_.size(),
                                           " fields but have ", fields.size(),
@@ -106,7 +113,7 @@ class DecodeCSVOp : public OpKernel {
               output[f]->flat<int32>()(i) = record_defaults[f].flat<int32>()(0);
             } else {
               int32_t value;
-              OP_REQUIRES(ctx, strings::safe_strto32(fields[f], &value),
+              OP_REQUIRES(ctx, ParseCsvInt32(fields[f], &value),
                           errors::InvalidArgument(
                               "Field ", f, " in record ", i,
                               " is not a valid int32: ", fields[f]));
@@ -127,7 +134,7 @@ class DecodeCSVOp : public OpKernel {
                   record_defaults[f].flat<int64_t>()(0);
             } else {
               int64_t value;
-              OP_REQUIRES(ctx, strings::safe_strto64(fields[f], &value),
+              OP_REQUIRES(ctx, ParseCsvInt64(fields[f], &value),
                           errors::InvalidArgument(
                               "Field ", f, " in record ", i,
                               " is not a valid int64: ", fields[f]));
@@ -185,7 +192,7 @@ class DecodeCSVOp : public OpKernel {
               output[f]->flat<tstring>()(i) =
                   record_defaults[f].flat<tstring>()(0);
             } else {
-              output[f]->flat<tstring>()(i) = std::move(fields[f]);
+              output[f]->flat<tstring>()(i) = fields[f];
             }
             break;
           }
@@ -206,8 +213,11 @@ class DecodeCSVOp : public OpKernel {
   bool select_all_cols_;
   string na_value_;
 
-  void ExtractFields(OpKernelContext* ctx, StringPiece input,
-                     std::vector<string>* result) {
+  // Splits `input` into the selected fields. Unquoted fields and quoted fields
+  // without escaped quotes are views into `input`; the others are unescaped
+  // into `unescaped_fields`.
+  Status ExtractFields(StringPiece input, std::vector<StringPiece>* result,
+                       std::deque<string>* unescaped_fields) {
     int64_t current_idx = 0;
     int64_t num_fields_parsed = 0;
     int64_t selector_idx = 0;  // Keep track of index into select_cols
@@ -230,48 +240,50 @@ class DecodeCSVOp : public OpKernel {
         }
 
         // This is the body of the field;
-        string field;
+        StringPiece field;
         if (!quoted) {
-          while (static_cast<size_t>(current_idx) < input.size() &&
-                 input[current_idx] != delim_) {
-            OP_REQUIRES(ctx,
-                        (!use_quote_delim_ || input[current_idx] != '"') &&
-                            input[current_idx] != '\n' &&
-                            input[current_idx] != '\r',
-                        errors::InvalidArgument(
-                            "Unquoted fields cannot have quotes/CRLFs inside"));
-            if (include) field += input[current_idx];
-            current_idx++;
+          const size_t field_end =
+              FindCsvFieldEnd(input, current_idx, delim_, use_quote_delim_);
+          if (field_end < input.size() && input[field_end] != delim_) {
+            return errors::InvalidArgument(
+                "Unquoted fields cannot have quotes/CRLFs inside");
           }
+          field = input.substr(current_idx, field_end - current_idx);
 
           // Go to next field or the end
-          current_idx++;
+          current_idx = field_end + 1;
         } else if (use_quote_delim_) {
           // Quoted field needs to be ended with '"' and delim or end
-          while (
-              (static_cast<size_t>(current_idx) < input.size() - 1) &&
-              (input[current_idx] != '"' || input[current_idx + 1] != delim_)) {
-            if (input[current_idx] != '"') {
-              if (include) field += input[current_idx];
-              current_idx++;
-            } else {
-              OP_REQUIRES(
-                  ctx, input[current_idx + 1] == '"',
-                  errors::InvalidArgument("Quote inside a string has to be "
-                                          "escaped by another quote"));
-              if (include) field += '"';
-              current_idx += 2;
+          const size_t field_begin = current_idx;
+          bool has_escaped_quotes = false;
+          while (true) {
+            const size_t quote = input.find('"', current_idx);
+            if (quote == StringPiece::npos) {
+              current_idx = input.size();
+              break;
+            }
+            current_idx = quote;
+            if (quote == input.size() - 1 || input[quote + 1] == delim_) {
+              break;
             }
+            if (input[quote + 1] != '"') {
+              return errors::InvalidArgument(
+                  "Quote inside a string has to be escaped by another quote");
+            }
+            has_escaped_quotes = true;
+            current_idx += 2;
           }
 
-          OP_REQUIRES(
-              ctx,
-              (static_cast<size_t>(current_idx) < input.size() &&
-               input[current_idx] == '"' &&
-               (static_cast<size_t>(current_idx) == input.size() - 1 ||
-                input[current_idx + 1] == delim_)),
-              errors::InvalidArgument("Quoted field has to end with quote "
-                                      "followed by delim or end"));
+          if (static_cast<size_t>(current_idx) >= input.size()) {
+            return errors::InvalidArgument(
+                "Quoted field has to end with quote followed by delim or end");
+          }
+          field = input.substr(field_begin, current_idx - field_begin);
+          if (include && has_escaped_quotes) {
+            unescaped_fields->push_back(absl::StrReplaceAll(
+                field, {{StringPiece("\"\""), StringPiece("\"")}}));
+            field = unescaped_fields->back();
+          }
 
           current_idx += 2;
         }
@@ -280,7 +292,7 @@ class DecodeCSVOp : public OpKernel {
         if (include) {
           result->push_back(field);
           selector_idx++;
-          if (selector_idx == select_cols_.size()) return;
+          if (selector_idx == select_cols_.size()) return OkStatus();
         }
       }
 
@@ -289,8 +301,9 @@ class DecodeCSVOp : public OpKernel {
                                    static_cast<size_t>(num_fields_parsed));
       // Check if the last field is missing
       if (include && input[input.size() - 1] == delim_)
-        result->push_back(string());
+        result->push_back(StringPiece());
     }
+    return OkStatus();
   }
 };
 
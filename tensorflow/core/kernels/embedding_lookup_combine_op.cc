@@ -0,0 +1,172 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/resource_variable_ops.cc.
+
+#define EIGEN_USE_THREADS
+
+#include <optional>
+#include <string>
+
+#include "tensorflow/core/framework/bounds_check.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/kernels/segment_reduction_ops_impl.h"
+#include "tensorflow/core/kernels/training_op_helpers.h"
+#include "tensorflow/core/kernels/variable_ops.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/refcount.h"
+
+namespace tensorflow {
+
+typedef Eigen::ThreadPoolDevice CPUDevice;
+
+namespace {
+
+string GetCombiner(OpKernelConstruction* context) {
+  string combiner;
+  context->SetStatus(context->GetAttr("combiner", &combiner));
+  return combiner;
+}
+
+}  // namespace
+
+// Computes the sparse segment reduction of the rows `ids[indices[k]]` of a
+// resource variable, without materializing the gathered rows. Like in
+// ResourceGather, the variable lock is held for the whole reduction unless the
+// variable is read-mostly, so that concurrent writers do not have to copy the
+// table.
+template <typename T, typename Tids, typename Tidx, typename Tsegmentids>
+class EmbeddingLookupCombineOp
+    : public SparseSegmentReductionOpBase<CPUDevice, T, Tids, Tsegmentids> {
+  using Base = SparseSegmentReductionOpBase<CPUDevice, T, Tids, Tsegmentids>;
+
+ public:
+  explicit EmbeddingLookupCombineOp(OpKernelConstruction* context)
+      : EmbeddingLookupCombineOp(context, GetCombiner(context)) {}
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& ids = context->input(1);
+    const Tensor& indices = context->input(2);
+    const Tensor& segment_ids = context->input(3);
+    const Tensor& num_segments = context->input(4);
+
+    OP_REQUIRES(context, TensorShapeUtils::IsVector(ids.shape()),
+                errors::InvalidArgument("ids should be a vector."));
+    OP_REQUIRES(context, TensorShapeUtils::IsVector(indices.shape()),
+                errors::InvalidArgument("indices should be a vector."));
+    OP_REQUIRES(context, TensorShapeUtils::IsVector(segment_ids.shape()),
+                errors::InvalidArgument("segment_ids should be a vector."));
+    OP_REQUIRES(context, TensorShapeUtils::IsScalar(num_segments.shape()),
+                errors::InvalidArgument(
+                    "num_segments should be a scalar, not shape ",
+                    num_segments.shape().DebugString()));
+    const int64_t num_indices = indices.NumElements();
+    OP_REQUIRES(context, num_indices == segment_ids.NumElements(),
+                errors::InvalidArgument(
+                    "segment_ids and indices should have same size."));
+
+    // Compose the two levels of indirection so that the reduction reads the
+    // rows of the variable directly.
+    const auto ids_vec = ids.vec<Tids>();
+    const auto indices_vec = indices.vec<Tidx>();
+    const int64_t num_ids = ids.NumElements();
+    Tensor rows;
+    OP_REQUIRES_OK(context,
+                   context->allocate_temp(DataTypeToEnum<Tids>::v(),
+                                          TensorShape({num_indices}), &rows));
+    auto rows_vec = rows.vec<Tids>();
+    for (int64_t i = 0; i < num_indices; ++i) {
+      const Tidx index = internal::SubtleMustCopy(indices_vec(i));
+      OP_REQUIRES(context, FastBoundsCheck(index, num_ids),
+                  errors::InvalidArgument("indices[", i, "] == ", index,
+                                          " out of range [0, ", num_ids, ")"));
+      rows_vec(i) = ids_vec(index);
+    }
+
+    core::RefCountPtr<Var> v;
+    OP_REQUIRES_OK(context,
+                   LookupResource(context, HandleFromInput(context, 0), &v));
+    std::optional<tf_shared_lock> ml;
+    Tensor snapshot;
+    const Tensor* params_ptr;
+    OP_REQUIRES_OK(context, PrepareSparseVariableRead<CPUDevice, T>(
+                                context, v.get(), &ml, &snapshot, &params_ptr));
+    const Tensor& params = *params_ptr;
+    OP_REQUIRES(context, params.dtype() == DataTypeToEnum<T>::v(),
+                errors::InvalidArgument(
+                    "Trying to read variable with wrong dtype. Expected ",
+                    DataTypeString(params.dtype()), " got ",
+                    DataTypeString(DataTypeToEnum<T>::v())));
+    OP_REQUIRES(
+        context, TensorShapeUtils::IsVectorOrHigher(params.shape()),
+        errors::InvalidArgument("params must be at least 1 dimensional"));
+
+    const bool has_num_segments =
+        (num_segments.dtype() == DT_INT32
+             ? num_segments.scalar<int32>()()
+             : num_segments.scalar<int64_t>()()) >= 0;
+    this->ComputeReduction(context, params, rows, segment_ids,
+                           has_num_segments ? &num_segments : nullptr);
+  }
+
+ private:
+  EmbeddingLookupCombineOp(OpKernelConstruction* context,
+                           const string& combiner)
+      : Base(context, /*is_mean=*/combiner == "mean",
+             /*is_sqrtn=*/combiner == "sqrtn",
+             /*has_num_segments=*/false, /*default_value=*/T(0)) {}
+};
+
+#define REGISTER_CPU_KERNEL_WITH_SEGMENT_IDS(type, index_type, segment_type) \
+  REGISTER_KERNEL_BUILDER(Name("_EmbeddingLookupCombine")                    \
+                              .Device(DEVICE_CPU)                            \
+                              .HostMemory("resource")                        \
+                              .TypeConstraint<type>("dtype")                 \
+                              .TypeConstraint<int32>("Tids")                 \
+                              .TypeConstraint<index_type>("Tidx")            \
+                              .TypeConstraint<segment_type>("Tsegmentids"),  \
+                          EmbeddingLookupCombineOp<type, int32, index_type,  \
+                                                   segment_type>);           \
+  REGISTER_KERNEL_BUILDER(Name("_EmbeddingLookupCombine")                    \
+                              .Device(DEVICE_CPU)                            \
+                              .HostMemory("resource")                        \
+                              .TypeConstraint<type>("dtype")                 \
+                              .TypeConstraint<int64_t>("Tids")               \
+                              .TypeConstraint<index_type>("Tidx")            \
+                              .TypeConstraint<segment_type>("Tsegmentids"),  \
+                          EmbeddingLookupCombineOp<type, int64_t,            \
+                                                   index_type, segment_type>)
+
+#define REGISTER_CPU_KERNEL_WITH_INDICES(type, index_type)                  \
+  REGISTER_CPU_KERNEL_WITH_SEGMENT_IDS(type, index_type, int32);           \
+  REGISTER_CPU_KERNEL_WITH_SEGMENT_IDS(type, index_type, int64_t)
+
+#define REGISTER_CPU_KERNEL(type)                  \
+  REGISTER_CPU_KERNEL_WITH_INDICES(type, int32);   \
+  REGISTER_CPU_KERNEL_WITH_INDICES(type, int64_t)
+
+TF_CALL_half(REGISTER_CPU_KERNEL);
+TF_CALL_bfloat16(REGISTER_CPU_KERNEL);
+TF_CALL_float(REGISTER_CPU_KERNEL);
+
+#undef REGISTER_CPU_KERNEL
+#undef REGISTER_CPU_KERNEL_WITH_INDICES
+#undef REGISTER_CPU_KERNEL_WITH_SEGMENT_IDS
+
+}  // namespace tensorflow
@@ -23,6 +23,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/bits.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/types.h"
@@ -161,31 +162,18 @@ class FFTCPU : public FFTBase {
 
   void DoFFT(OpKernelContext* ctx, const Tensor& in, uint64* fft_shape,
              Tensor* out) override {
-    // Create the axes (which are always trailing).
-    const auto axes = Eigen::ArrayXi::LinSpaced(FFTRank, 1, FFTRank);
-    auto device = ctx->eigen_device<CPUDevice>();
-
     const bool is_complex128 =
         in.dtype() == DT_COMPLEX128 || out->dtype() == DT_COMPLEX128;
 
     if (!IsReal()) {
-      // Compute the FFT using Eigen.
-      constexpr auto direction =
-          Forward ? Eigen::FFT_FORWARD : Eigen::FFT_REVERSE;
       if (is_complex128) {
         DCHECK_EQ(in.dtype(), DT_COMPLEX128);
         DCHECK_EQ(out->dtype(), DT_COMPLEX128);
-        auto input = Tensor(in).flat_inner_dims<complex128, FFTRank + 1>();
-        auto output = out->flat_inner_dims<complex128, FFTRank + 1>();
-        output.device(device) =
-            input.template fft<Eigen::BothParts, direction>(axes);
+        DoComplexFFT<complex128>(ctx, fft_shape, in, out);
       } else {
         DCHECK_EQ(in.dtype(), DT_COMPLEX64);
         DCHECK_EQ(out->dtype(), DT_COMPLEX64);
-        auto input = Tensor(in).flat_inner_dims<complex64, FFTRank + 1>();
-        auto output = out->flat_inner_dims<complex64, FFTRank + 1>();
-        output.device(device) =
-            input.template fft<Eigen::BothParts, direction>(axes);
+        DoComplexFFT<complex64>(ctx, fft_shape, in, out);
       }
     } else {
       if (IsForward()) {
@@ -212,17 +200,64 @@ class FFTCPU : public FFTBase {
     }
   }
 
+  using Indices = Eigen::DSizes<Eigen::DenseIndex, FFTRank + 1>;
+
+  // Calls `work(start, limit)` on the ranges of batch entries the batch of
+  // `batch_size` entries is sharded into on the intra-op thread pool. Eigen's
+  // tensor FFT transforms all lines on the calling thread, even when it is
+  // evaluated on a ThreadPoolDevice, so the batch is split across threads
+  // instead, and each shard is evaluated on the default device.
+  template <typename Work>
+  void ShardBatch(OpKernelContext* ctx, int64_t batch_size,
+                  const uint64* fft_shape, Work work) {
+    int64_t fft_size = 1;
+    for (int i = 0; i < FFTRank; ++i) {
+      fft_size *= fft_shape[i];
+    }
+    // A transform of n elements costs about 5 * n * log2(n) flops.
+    const int64_t cost_per_entry =
+        5 * fft_size * std::max(1, Log2Ceiling64(fft_size));
+    auto worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers, batch_size,
+          cost_per_entry, work);
+  }
+
+  // Returns `indices` with its batch dimension set to `batch_index`.
+  static Indices WithBatch(Indices indices, int64_t batch_index) {
+    indices[0] = batch_index;
+    return indices;
+  }
+
+  template <typename ComplexT>
+  void DoComplexFFT(OpKernelContext* ctx, uint64* fft_shape, const Tensor& in,
+                    Tensor* out) {
+    // Create the axes (which are always trailing).
+    const auto axes = Eigen::ArrayXi::LinSpaced(FFTRank, 1, FFTRank);
+    constexpr auto direction =
+        Forward ? Eigen::FFT_FORWARD : Eigen::FFT_REVERSE;
+    auto input = Tensor(in).flat_inner_dims<ComplexT, FFTRank + 1>();
+    auto output = out->flat_inner_dims<ComplexT, FFTRank + 1>();
+    const Indices dims = input.dimensions();
+
+    ShardBatch(ctx, dims[0], fft_shape, [&](int64_t start, int64_t limit) {
+      const Indices offsets = WithBatch(Indices(), start);
+      const Indices sizes = WithBatch(dims, limit - start);
+      output.slice(offsets, sizes) =
+          input.slice(offsets, sizes)
+              .template fft<Eigen::BothParts, direction>(axes);
+    });
+  }
+
   template <typename RealT, typename ComplexT>
   void DoRealForwardFFT(OpKernelContext* ctx, uint64* fft_shape,
                         const Tensor& in, Tensor* out) {
     // Create the axes (which are always trailing).
     const auto axes = Eigen::ArrayXi::LinSpaced(FFTRank, 1, FFTRank);
-    auto device = ctx->eigen_device<CPUDevice>();
     auto input = Tensor(in).flat_inner_dims<RealT, FFTRank + 1>();
     const auto input_dims = input.dimensions();
 
     // Slice input to fft_shape on its inner-most dimensions.
-    Eigen::DSizes<Eigen::DenseIndex, FFTRank + 1> input_slice_sizes;
+    Indices input_slice_sizes;
     input_slice_sizes[0] = input_dims[0];
     TensorShape temp_shape{input_dims[0]};
     for (int i = 1; i <= FFTRank; ++i) {
@@ -234,36 +269,43 @@ class FFTCPU : public FFTBase {
                                         temp_shape.DebugString()));
 
     auto output = out->flat_inner_dims<ComplexT, FFTRank + 1>();
-    const Eigen::DSizes<Eigen::DenseIndex, FFTRank + 1> zero_start_indices;
+    const Indices output_dims = output.dimensions();
 
     // Compute the full FFT using a temporary tensor.
     Tensor temp;
     OP_REQUIRES_OK(ctx, ctx->allocate_temp(DataTypeToEnum<ComplexT>::v(),
                                            temp_shape, &temp));
     auto full_fft = temp.flat_inner_dims<ComplexT, FFTRank + 1>();
-    full_fft.device(device) =
-        input.slice(zero_start_indices, input_slice_sizes)
-            .template fft<Eigen::BothParts, Eigen::FFT_FORWARD>(axes);
 
-    // Slice away the negative frequency components.
-    output.device(device) =
-        full_fft.slice(zero_start_indices, output.dimensions());
+    ShardBatch(ctx, input_dims[0], fft_shape, [&](int64_t start,
+                                                  int64_t limit) {
+      const Indices offsets = WithBatch(Indices(), start);
+      const Indices sizes = WithBatch(input_slice_sizes, limit - start);
+      full_fft.slice(offsets, sizes) =
+          input.slice(offsets, sizes)
+              .template fft<Eigen::BothParts, Eigen::FFT_FORWARD>(axes);
+
+      // Slice away the negative frequency components.
+      const Indices output_sizes = WithBatch(output_dims, limit - start);
+      output.slice(offsets, output_sizes) =
+          full_fft.slice(offsets, output_sizes);
+    });
   }
 
   template <typename ComplexT, typename RealT>
   void DoRealBackwardFFT(OpKernelContext* ctx, uint64* fft_shape,
                          const Tensor& in, Tensor* out) {
-    auto device = ctx->eigen_device<CPUDevice>();
     // Reconstruct the full FFT and take the inverse.
     auto input = Tensor(in).flat_inner_dims<ComplexT, FFTRank + 1>();
     auto output = out->flat_inner_dims<RealT, FFTRank + 1>();
     const auto input_dims = input.dimensions();
+    const Indices output_dims = output.dimensions();
 
     // Calculate the shape of the temporary tensor for the full FFT and the
     // region we will slice from input given fft_shape. We slice input to
     // fft_shape on its inner-most dimensions, except the last (which we
     // slice to fft_shape[-1] / 2 + 1).
-    Eigen::DSizes<Eigen::DenseIndex, FFTRank + 1> input_slice_sizes;
+    Indices input_slice_sizes;
     input_slice_sizes[0] = input_dims[0];
     TensorShape full_fft_shape;
     OP_REQUIRES_OK(ctx, full_fft_shape.AddDimWithStatus(input_dims[0]));
@@ -285,27 +327,12 @@ class FFTCPU : public FFTBase {
     // negative frequency part.
     auto neg_sizes = input_slice_sizes;
     neg_sizes[FFTRank] = fft_shape[FFTRank - 1] - input_slice_sizes[FFTRank];
-    Eigen::DSizes<Eigen::DenseIndex, FFTRank + 1> neg_target_indices;
+    Indices neg_target_indices;
     neg_target_indices[FFTRank] = input_slice_sizes[FFTRank];
 
-    const Eigen::DSizes<Eigen::DenseIndex, FFTRank + 1> start_indices;
-    Eigen::DSizes<Eigen::DenseIndex, FFTRank + 1> neg_start_indices;
+    Indices neg_start_indices;
     neg_start_indices[FFTRank] = 1;
 
-    full_fft.slice(start_indices, input_slice_sizes).device(device) =
-        input.slice(start_indices, input_slice_sizes);
-
-    // First, conduct IFFTs on outer dimensions. We save computation (and
-    // avoid touching uninitialized memory) by slicing full_fft to the
-    // subregion we wrote input to.
-    if (FFTRank > 1) {
-      const auto outer_axes =
-          Eigen::ArrayXi::LinSpaced(FFTRank - 1, 1, FFTRank - 1);
-      full_fft.slice(start_indices, input_slice_sizes).device(device) =
-          full_fft.slice(start_indices, input_slice_sizes)
-              .template fft<Eigen::BothParts, Eigen::FFT_REVERSE>(outer_axes);
-    }
-
     // Reconstruct the full FFT by appending reversed and conjugated
     // spectrum as the negative frequency part.
     Eigen::array<bool, FFTRank + 1> reverse_last_axis;
@@ -313,16 +340,38 @@ class FFTCPU : public FFTBase {
       reverse_last_axis[i] = i == FFTRank;
     }
 
-    if (neg_sizes[FFTRank] != 0) {
-      full_fft.slice(neg_target_indices, neg_sizes).device(device) =
-          full_fft.slice(neg_start_indices, neg_sizes)
-              .reverse(reverse_last_axis)
-              .conjugate();
-    }
+    ShardBatch(ctx, input_dims[0], fft_shape, [&](int64_t start,
+                                                  int64_t limit) {
+      const Indices start_indices = WithBatch(Indices(), start);
+      const Indices sizes = WithBatch(input_slice_sizes, limit - start);
+      full_fft.slice(start_indices, sizes) = input.slice(start_indices, sizes);
+
+      // First, conduct IFFTs on outer dimensions. We save computation (and
+      // avoid touching uninitialized memory) by slicing full_fft to the
+      // subregion we wrote input to.
+      if (FFTRank > 1) {
+        const auto outer_axes =
+            Eigen::ArrayXi::LinSpaced(FFTRank - 1, 1, FFTRank - 1);
+        full_fft.slice(start_indices, sizes) =
+            full_fft.slice(start_indices, sizes)
+                .template fft<Eigen::BothParts, Eigen::FFT_REVERSE>(outer_axes);
+      }
+
+      if (neg_sizes[FFTRank] != 0) {
+        const Indices shard_neg_sizes = WithBatch(neg_sizes, limit - start);
+        full_fft.slice(WithBatch(neg_target_indices, start), shard_neg_sizes) =
+            full_fft.slice(WithBatch(neg_start_indices, start), shard_neg_sizes)
+                .reverse(reverse_last_axis)
+                .conjugate();
+      }
 
-    auto inner_axis = Eigen::array<int, 1>{FFTRank};
-    output.device(device) =
-        full_fft.template fft<Eigen::RealPart, Eigen::FFT_REVERSE>(inner_axis);
+      auto inner_axis = Eigen::array<int, 1>{FFTRank};
+      const Indices full_fft_sizes =
+          WithBatch(full_fft.dimensions(), limit - start);
+      output.slice(start_indices, WithBatch(output_dims, limit - start)) =
+          full_fft.slice(start_indices, full_fft_sizes)
+              .template fft<Eigen::RealPart, Eigen::FFT_REVERSE>(inner_axis);
+    });
   }
 };
 
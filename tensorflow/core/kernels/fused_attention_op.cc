@@ -0,0 +1,250 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/nn_ops.cc.
+
+#define EIGEN_USE_THREADS
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/lib/gtl/inlined_vector.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+
+// Computes scaled dot-product attention one tile of queries at a time.
+//
+// For each tile of kQueryBlock queries the keys are visited in blocks of
+// kKeyBlock, and the softmax is computed online: every row keeps its running
+// maximum and sum, and its partial output is rescaled whenever the maximum
+// grows. Only a kQueryBlock x kKeyBlock block of scores is ever live, so the
+// [Sq, Sk] attention matrix is never materialized, and each key and value row
+// is read once per tile rather than once per query.
+template <typename T>
+class FusedAttentionOp : public OpKernel {
+ public:
+  static constexpr int64_t kQueryBlock = 16;
+  static constexpr int64_t kKeyBlock = 128;
+
+  explicit FusedAttentionOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    int num_args;
+    OP_REQUIRES_OK(context, context->GetAttr("num_args", &num_args));
+    OP_REQUIRES(context, num_args <= 1,
+                errors::InvalidArgument(
+                    "_FusedAttention supports at most one extra argument, "
+                    "the mask, but got num_args=",
+                    num_args));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& query = context->input(0);
+    const Tensor& key = context->input(1);
+    const Tensor& value = context->input(2);
+    const Tensor& scale = context->input(3);
+
+    const int rank = query.dims();
+    OP_REQUIRES(
+        context, rank >= 3 && key.dims() == rank && value.dims() == rank,
+        errors::InvalidArgument(
+            "query, key and value must have the same rank of at least 3, got "
+            "shapes ",
+            query.shape().DebugString(), ", ", key.shape().DebugString(),
+            " and ", value.shape().DebugString()));
+    OP_REQUIRES(context, TensorShapeUtils::IsScalar(scale.shape()),
+                errors::InvalidArgument("scale must be a scalar, got shape ",
+                                        scale.shape().DebugString()));
+    int64_t batch_size = 1;
+    for (int i = 0; i < rank - 2; ++i) {
+      OP_REQUIRES(context,
+                  key.dim_size(i) == query.dim_size(i) &&
+                      value.dim_size(i) == query.dim_size(i),
+                  errors::InvalidArgument(
+                      "query, key and value must have the same batch "
+                      "dimensions, got shapes ",
+                      query.shape().DebugString(), ", ",
+                      key.shape().DebugString(), " and ",
+                      value.shape().DebugString()));
+      batch_size *= query.dim_size(i);
+    }
+    const int64_t num_queries = query.dim_size(rank - 2);
+    const int64_t depth = query.dim_size(rank - 1);
+    const int64_t num_keys = key.dim_size(rank - 2);
+    const int64_t value_depth = value.dim_size(rank - 1);
+    OP_REQUIRES(context, key.dim_size(rank - 1) == depth,
+                errors::InvalidArgument(
+                    "query and key must have the same depth, got shapes ",
+                    query.shape().DebugString(), " and ",
+                    key.shape().DebugString()));
+    OP_REQUIRES(context, value.dim_size(rank - 2) == num_keys,
+                errors::InvalidArgument(
+                    "key and value must have the same number of rows, got "
+                    "shapes ",
+                    key.shape().DebugString(), " and ",
+                    value.shape().DebugString()));
+
+    // The mask broadcasts to the [..., Sq, Sk] scores; a dimension of size 1
+    // gets a stride of 0.
+    const T* mask = nullptr;
+    gtl::InlinedVector<int64_t, 6> mask_strides(rank, 0);
+    std::vector<int64_t> mask_batch_offsets;
+    if (context->num_inputs() > 4) {
+      const Tensor& mask_tensor = context->input(4);
+      OP_REQUIRES(context, mask_tensor.dims() == rank,
+                  errors::InvalidArgument(
+                      "mask must have the rank of the attention scores, got "
+                      "shape ",
+                      mask_tensor.shape().DebugString()));
+      int64_t stride = 1;
+      for (int i = rank - 1; i >= 0; --i) {
+        const int64_t scores_dim =
+            i == rank - 1 ? num_keys : query.dim_size(i);
+        const int64_t mask_dim = mask_tensor.dim_size(i);
+        OP_REQUIRES(context, mask_dim == 1 || mask_dim == scores_dim,
+                    errors::InvalidArgument(
+                        "mask of shape ", mask_tensor.shape().DebugString(),
+                        " does not broadcast to the attention scores"));
+        mask_strides[i] = mask_dim == 1 ? 0 : stride;
+        stride *= mask_dim;
+      }
+      mask_batch_offsets.resize(batch_size);
+      for (int64_t b = 0; b < batch_size; ++b) {
+        int64_t remainder = b;
+        int64_t offset = 0;
+        for (int i = rank - 3; i >= 0; --i) {
+          offset += (remainder % query.dim_size(i)) * mask_strides[i];
+          remainder /= query.dim_size(i);
+        }
+        mask_batch_offsets[b] = offset;
+      }
+      mask = mask_tensor.flat<T>().data();
+    }
+
+    TensorShape output_shape = query.shape();
+    output_shape.set_dim(rank - 1, value_depth);
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(0, output_shape, &output));
+    if (output->NumElements() == 0) return;
+    T* output_data = output->flat<T>().data();
+    if (num_keys == 0) {
+      std::fill(output_data, output_data + output->NumElements(), T(0));
+      return;
+    }
+
+    const T* query_data = query.flat<T>().data();
+    const T* key_data = key.flat<T>().data();
+    const T* value_data = value.flat<T>().data();
+    const T scale_value = scale.scalar<T>()();
+    const int64_t mask_query_stride = mask_strides[rank - 2];
+    const int64_t mask_key_stride = mask_strides[rank - 1];
+    const int64_t blocks_per_batch =
+        (num_queries + kQueryBlock - 1) / kQueryBlock;
+
+    auto compute = [&](int64_t begin, int64_t end) {
+      std::vector<T> scores(kQueryBlock * kKeyBlock);
+      std::vector<T> max_scores(kQueryBlock);
+      std::vector<T> sums(kQueryBlock);
+      for (int64_t unit = begin; unit < end; ++unit) {
+        const int64_t b = unit / blocks_per_batch;
+        const int64_t first_query = (unit % blocks_per_batch) * kQueryBlock;
+        const int64_t tile_queries =
+            std::min(kQueryBlock, num_queries - first_query);
+        const T* q = query_data + (b * num_queries + first_query) * depth;
+        const T* k = key_data + b * num_keys * depth;
+        const T* v = value_data + b * num_keys * value_depth;
+        T* out = output_data + (b * num_queries + first_query) * value_depth;
+        std::fill(out, out + tile_queries * value_depth, T(0));
+        std::fill(max_scores.begin(), max_scores.end(),
+                  -std::numeric_limits<T>::infinity());
+        std::fill(sums.begin(), sums.end(), T(0));
+
+        for (int64_t first_key = 0; first_key < num_keys;
+             first_key += kKeyBlock) {
+          const int64_t block_keys = std::min(kKeyBlock, num_keys - first_key);
+          for (int64_t i = 0; i < tile_queries; ++i) {
+            const T* q_row = q + i * depth;
+            T* row_scores = scores.data() + i * kKeyBlock;
+            T block_max = -std::numeric_limits<T>::infinity();
+            for (int64_t j = 0; j < block_keys; ++j) {
+              const T* k_row = k + (first_key + j) * depth;
+              T dot = T(0);
+              for (int64_t d = 0; d < depth; ++d) dot += q_row[d] * k_row[d];
+              T score = dot * scale_value;
+              if (mask != nullptr) {
+                score += mask[mask_batch_offsets[b] +
+                              (first_query + i) * mask_query_stride +
+                              (first_key + j) * mask_key_stride];
+              }
+              row_scores[j] = score;
+              block_max = std::max(block_max, score);
+            }
+
+            const T new_max = std::max(max_scores[i], block_max);
+            // Every key so far is masked out; nothing to accumulate yet.
+            if (new_max == -std::numeric_limits<T>::infinity()) continue;
+            T* out_row = out + i * value_depth;
+            if (new_max != max_scores[i]) {
+              const T correction = std::exp(max_scores[i] - new_max);
+              sums[i] *= correction;
+              for (int64_t d = 0; d < value_depth; ++d) {
+                out_row[d] *= correction;
+              }
+              max_scores[i] = new_max;
+            }
+            for (int64_t j = 0; j < block_keys; ++j) {
+              const T p = std::exp(row_scores[j] - new_max);
+              sums[i] += p;
+              const T* v_row = v + (first_key + j) * value_depth;
+              for (int64_t d = 0; d < value_depth; ++d) {
+                out_row[d] += p * v_row[d];
+              }
+            }
+          }
+        }
+
+        for (int64_t i = 0; i < tile_queries; ++i) {
+          const T inverse_sum = T(1) / sums[i];
+          T* out_row = out + i * value_depth;
+          for (int64_t d = 0; d < value_depth; ++d) out_row[d] *= inverse_sum;
+        }
+      }
+    };
+
+    const auto& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    const int64_t cost_per_unit =
+        kQueryBlock * num_keys * (depth + value_depth) * 2;
+    Shard(worker_threads.num_threads, worker_threads.workers,
+          batch_size * blocks_per_batch, cost_per_unit, compute);
+  }
+};
+
+#define REGISTER_CPU(T)                                                   \
+  REGISTER_KERNEL_BUILDER(                                                \
+      Name("_FusedAttention").Device(DEVICE_CPU).TypeConstraint<T>("T"), \
+      FusedAttentionOp<T>);
+
+TF_CALL_float(REGISTER_CPU);
+
+#undef REGISTER_CPU
+
+}  // namespace tensorflow
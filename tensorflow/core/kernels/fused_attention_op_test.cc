@@ -0,0 +1,136 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class FusedAttentionOpTest : public OpsTestBase {
+ protected:
+  // Runs _FusedAttention on [batch, Sq, depth] queries and [batch, Sk, depth]
+  // keys and values, with an optional [batch, 1, Sk] mask, and compares the
+  // result with an unfused reference.
+  void RunAndCompare(int batch, int num_queries, int num_keys, int depth,
+                     bool with_mask) {
+    TF_ASSERT_OK(NodeDefBuilder("fused_attention", "_FusedAttention")
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(with_mask ? 1 : 0, DT_FLOAT))
+                     .Attr("num_args", with_mask ? 1 : 0)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+
+    auto values = [](int n, int seed) {
+      std::vector<float> v(n);
+      for (int i = 0; i < n; ++i) v[i] = std::sin(0.37f * i + seed);
+      return v;
+    };
+    const std::vector<float> q = values(batch * num_queries * depth, 1);
+    const std::vector<float> k = values(batch * num_keys * depth, 2);
+    const std::vector<float> v = values(batch * num_keys * depth, 3);
+    std::vector<float> mask(batch * num_keys, 0.0f);
+    for (int i = 0; i < mask.size(); i += 3) {
+      mask[i] = -std::numeric_limits<float>::infinity();
+    }
+    const float scale = 1.0f / std::sqrt(static_cast<float>(depth));
+
+    AddInputFromArray<float>(TensorShape({batch, num_queries, depth}), q);
+    AddInputFromArray<float>(TensorShape({batch, num_keys, depth}), k);
+    AddInputFromArray<float>(TensorShape({batch, num_keys, depth}), v);
+    AddInputFromArray<float>(TensorShape({}), {scale});
+    if (with_mask) {
+      AddInputFromArray<float>(TensorShape({batch, 1, num_keys}), mask);
+    }
+    TF_ASSERT_OK(RunOpKernel());
+
+    Tensor expected(DT_FLOAT, TensorShape({batch, num_queries, depth}));
+    auto expected_flat = expected.flat<float>();
+    for (int b = 0; b < batch; ++b) {
+      for (int i = 0; i < num_queries; ++i) {
+        std::vector<float> scores(num_keys);
+        float max_score = -std::numeric_limits<float>::infinity();
+        for (int j = 0; j < num_keys; ++j) {
+          float dot = 0;
+          for (int d = 0; d < depth; ++d) {
+            dot += q[(b * num_queries + i) * depth + d] *
+                   k[(b * num_keys + j) * depth + d];
+          }
+          scores[j] = dot * scale + (with_mask ? mask[b * num_keys + j] : 0);
+          max_score = std::max(max_score, scores[j]);
+        }
+        float sum = 0;
+        for (int j = 0; j < num_keys; ++j) {
+          scores[j] = std::exp(scores[j] - max_score);
+          sum += scores[j];
+        }
+        for (int d = 0; d < depth; ++d) {
+          float out = 0;
+          for (int j = 0; j < num_keys; ++j) {
+            out += scores[j] / sum * v[(b * num_keys + j) * depth + d];
+          }
+          expected_flat((b * num_queries + i) * depth + d) = out;
+        }
+      }
+    }
+    test::ExpectClose(expected, *GetOutput(0), /*atol=*/1e-5, /*rtol=*/1e-4);
+  }
+};
+
+TEST_F(FusedAttentionOpTest, Small) {
+  RunAndCompare(/*batch=*/2, /*num_queries=*/3, /*num_keys=*/5, /*depth=*/4,
+                /*with_mask=*/false);
+}
+
+TEST_F(FusedAttentionOpTest, SpansSeveralTiles) {
+  RunAndCompare(/*batch=*/3, /*num_queries=*/37, /*num_keys=*/300,
+                /*depth=*/8, /*with_mask=*/false);
+}
+
+TEST_F(FusedAttentionOpTest, BroadcastMask) {
+  RunAndCompare(/*batch=*/2, /*num_queries=*/20, /*num_keys=*/260,
+                /*depth=*/8, /*with_mask=*/true);
+}
+
+TEST_F(FusedAttentionOpTest, MismatchedBatchDimensions) {
+  TF_ASSERT_OK(NodeDefBuilder("fused_attention", "_FusedAttention")
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(0, DT_FLOAT))
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+  AddInputFromArray<float>(TensorShape({1, 1, 1}), {1});
+  AddInputFromArray<float>(TensorShape({2, 1, 1}), {1, 2});
+  AddInputFromArray<float>(TensorShape({2, 1, 1}), {1, 2});
+  AddInputFromArray<float>(TensorShape({}), {1});
+  EXPECT_EQ(error::INVALID_ARGUMENT, RunOpKernel().code());
+}
+
+}  // namespace
+}  // namespace tensorflow
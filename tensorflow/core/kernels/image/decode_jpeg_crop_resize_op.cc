@@ -0,0 +1,257 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/image_ops.cc
+
+#define EIGEN_USE_THREADS
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/jpeg/jpeg_mem.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+namespace {
+
+// Interpolation weights of one output coordinate along one axis.
+struct InterpolationWeight {
+  int64_t lower;
+  int64_t upper;
+  float lerp;
+};
+
+// Maps `out_size` output pixels with half-pixel centers onto the input window
+// starting at `in_offset` (which may be fractional) with extent `in_extent`,
+// clamping to the `in_size` pixels that were actually decoded.
+void ComputeInterpolationWeights(int64_t out_size, int64_t in_size,
+                                 double in_offset, double in_extent,
+                                 std::vector<InterpolationWeight>* weights) {
+  weights->resize(out_size);
+  const double scale = in_extent / out_size;
+  for (int64_t i = 0; i < out_size; ++i) {
+    double in = in_offset + (i + 0.5) * scale - 0.5;
+    in = std::min(std::max(in, 0.0), static_cast<double>(in_size - 1));
+    const int64_t lower = static_cast<int64_t>(std::floor(in));
+    InterpolationWeight& w = (*weights)[i];
+    w.lower = lower;
+    w.upper = std::min(lower + 1, in_size - 1);
+    w.lerp = static_cast<float>(in - lower);
+  }
+}
+
+}  // namespace
+
+// Decodes the crop window of a JPEG image and bilinearly resizes it to `size`.
+// The window is decoded with the largest DCT scaling ratio that still leaves
+// at least `size` pixels in the window, so blocks outside the window are
+// skipped and a large window is not decoded at full resolution only to be
+// thrown away by the resize.
+class DecodeJpegCropResizeOp : public OpKernel {
+ public:
+  explicit DecodeJpegCropResizeOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("channels", &channels_));
+    OP_REQUIRES(context,
+                channels_ == 0 || channels_ == 1 || channels_ == 3,
+                errors::InvalidArgument("channels must be 0, 1, or 3, got ",
+                                        channels_));
+    OP_REQUIRES_OK(context, context->GetAttr("fancy_upscaling",
+                                             &flags_.fancy_upscaling));
+    string dct_method;
+    OP_REQUIRES_OK(context, context->GetAttr("dct_method", &dct_method));
+    OP_REQUIRES(
+        context,
+        (dct_method.empty() || dct_method == "INTEGER_FAST" ||
+         dct_method == "INTEGER_ACCURATE"),
+        errors::InvalidArgument("dct_method must be one of "
+                                "{'', 'INTEGER_FAST', 'INTEGER_ACCURATE'}"));
+    if (dct_method.empty() || dct_method == "INTEGER_FAST") {
+      flags_.dct_method = JDCT_IFAST;
+    } else {
+      flags_.dct_method = JDCT_ISLOW;
+    }
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& contents = context->input(0);
+    OP_REQUIRES(context, TensorShapeUtils::IsScalar(contents.shape()),
+                errors::InvalidArgument("contents must be scalar, got shape ",
+                                        contents.shape().DebugString()));
+    const tstring& input = contents.scalar<tstring>()();
+    OP_REQUIRES(context, input.size() <= std::numeric_limits<int>::max(),
+                errors::InvalidArgument("JPEG contents are too large for int: ",
+                                        input.size()));
+
+    const Tensor& crop_window = context->input(1);
+    OP_REQUIRES(context,
+                TensorShapeUtils::IsVector(crop_window.shape()) &&
+                    crop_window.NumElements() == 4,
+                errors::InvalidArgument(
+                    "crop_window must be a vector of 4 elements, got shape ",
+                    crop_window.shape().DebugString()));
+    const Tensor& size = context->input(2);
+    OP_REQUIRES(context,
+                TensorShapeUtils::IsVector(size.shape()) &&
+                    size.NumElements() == 2,
+                errors::InvalidArgument(
+                    "size must be a vector of 2 elements, got shape ",
+                    size.shape().DebugString()));
+
+    const auto crop_window_vec = crop_window.vec<int32>();
+    const int crop_y = crop_window_vec(0);
+    const int crop_x = crop_window_vec(1);
+    const int crop_height = crop_window_vec(2);
+    const int crop_width = crop_window_vec(3);
+    const auto size_vec = size.vec<int32>();
+    const int out_height = size_vec(0);
+    const int out_width = size_vec(1);
+    OP_REQUIRES(context, out_height > 0 && out_width > 0,
+                errors::InvalidArgument("size must be positive, got [",
+                                        out_height, ", ", out_width, "]"));
+
+    int image_width, image_height, image_components;
+    OP_REQUIRES(context,
+                jpeg::GetImageInfo(input.data(), input.size(), &image_width,
+                                   &image_height, &image_components),
+                errors::InvalidArgument("Invalid JPEG data, size ",
+                                        input.size()));
+    OP_REQUIRES(
+        context,
+        crop_height > 0 && crop_width > 0 && crop_y >= 0 && crop_x >= 0 &&
+            static_cast<int64_t>(crop_y) + crop_height <= image_height &&
+            static_cast<int64_t>(crop_x) + crop_width <= image_width,
+        errors::InvalidArgument("Invalid crop window [", crop_y, ", ", crop_x,
+                                ", ", crop_height, ", ", crop_width,
+                                "] for image of size ", image_height, "x",
+                                image_width));
+
+    // Pick the coarsest DCT scaling that does not leave fewer pixels in the
+    // window than the output has, so the resize never upsamples because of it.
+    int ratio = 8;
+    while (ratio > 1 &&
+           (static_cast<int64_t>(out_height) * ratio > crop_height ||
+            static_cast<int64_t>(out_width) * ratio > crop_width)) {
+      ratio /= 2;
+    }
+
+    // Window of the scaled image covering the requested crop. libjpeg rounds
+    // the scaled image size up.
+    const int scaled_height = (image_height + ratio - 1) / ratio;
+    const int scaled_width = (image_width + ratio - 1) / ratio;
+    const int y0 = crop_y / ratio;
+    const int x0 = crop_x / ratio;
+    auto scaled_end = [ratio](int64_t start, int64_t extent) {
+      return static_cast<int>((start + extent + ratio - 1) / ratio);
+    };
+    const int y1 = std::min(scaled_end(crop_y, crop_height), scaled_height);
+    const int x1 = std::min(scaled_end(crop_x, crop_width), scaled_width);
+
+    jpeg::UncompressFlags flags = flags_;
+    flags.components = channels_;
+    flags.ratio = ratio;
+    flags.crop = true;
+    flags.crop_y = y0;
+    flags.crop_x = x0;
+    flags.crop_height = y1 - y0;
+    flags.crop_width = x1 - x0;
+
+    Tensor decoded;
+    uint8* buffer = jpeg::Uncompress(
+        input.data(), input.size(), flags, nullptr /* nwarn */,
+        [&](int width, int height, int channels) -> uint8* {
+          Status status = context->allocate_temp(
+              DT_UINT8, TensorShape({height, width, channels}), &decoded);
+          if (!status.ok()) {
+            VLOG(1) << status;
+            context->SetStatus(status);
+            return nullptr;
+          }
+          return decoded.flat<uint8>().data();
+        });
+    OP_REQUIRES(
+        context, buffer,
+        errors::InvalidArgument(
+            "jpeg::Uncompress failed. Invalid JPEG data or crop window."));
+
+    const int64_t in_height = decoded.dim_size(0);
+    const int64_t in_width = decoded.dim_size(1);
+    const int64_t channels = decoded.dim_size(2);
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(
+                       0, TensorShape({out_height, out_width, channels}),
+                       &output));
+
+    // Map the output onto the crop window in scaled coordinates, relative to
+    // the decoded window which starts at (y0, x0).
+    std::vector<InterpolationWeight> ys;
+    std::vector<InterpolationWeight> xs;
+    ComputeInterpolationWeights(out_height, in_height,
+                                static_cast<double>(crop_y) / ratio - y0,
+                                static_cast<double>(crop_height) / ratio, &ys);
+    ComputeInterpolationWeights(out_width, in_width,
+                                static_cast<double>(crop_x) / ratio - x0,
+                                static_cast<double>(crop_width) / ratio, &xs);
+
+    const uint8* in_data = decoded.flat<uint8>().data();
+    float* out_data = output->flat<float>().data();
+    const int64_t in_row_size = in_width * channels;
+    const int64_t out_row_size = static_cast<int64_t>(out_width) * channels;
+    auto resize_rows = [&](int64_t start, int64_t limit) {
+      for (int64_t y = start; y < limit; ++y) {
+        const uint8* top = in_data + ys[y].lower * in_row_size;
+        const uint8* bottom = in_data + ys[y].upper * in_row_size;
+        const float y_lerp = ys[y].lerp;
+        float* out = out_data + y * out_row_size;
+        for (int64_t x = 0; x < out_width; ++x) {
+          const int64_t left = xs[x].lower * channels;
+          const int64_t right = xs[x].upper * channels;
+          const float x_lerp = xs[x].lerp;
+          for (int64_t c = 0; c < channels; ++c) {
+            const float top_value =
+                top[left + c] + (top[right + c] - top[left + c]) * x_lerp;
+            const float bottom_value =
+                bottom[left + c] +
+                (bottom[right + c] - bottom[left + c]) * x_lerp;
+            out[x * channels + c] =
+                top_value + (bottom_value - top_value) * y_lerp;
+          }
+        }
+      }
+    };
+    auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers, out_height,
+          /*cost_per_unit=*/out_row_size * 10, resize_rows);
+  }
+
+ private:
+  int channels_;
+  jpeg::UncompressFlags flags_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("DecodeJpegCropResize").Device(DEVICE_CPU),
+                        DecodeJpegCropResizeOp);
+
+}  // namespace tensorflow
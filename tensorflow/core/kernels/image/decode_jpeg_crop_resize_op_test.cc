@@ -0,0 +1,108 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <vector>
+
+#include "tensorflow/cc/client/client_session.h"
+#include "tensorflow/cc/ops/array_ops.h"
+#include "tensorflow/cc/ops/const_op.h"
+#include "tensorflow/cc/ops/image_ops.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace ops {
+namespace {
+
+// A grayscale linear gradient, which survives JPEG compression and DCT
+// downscaling almost unchanged.
+Tensor MakeGradientImage(int height, int width) {
+  Tensor image(DT_UINT8, TensorShape({height, width, 1}));
+  auto pixels = image.tensor<uint8, 3>();
+  for (int y = 0; y < height; ++y) {
+    for (int x = 0; x < width; ++x) {
+      pixels(y, x, 0) = 32 + y + x;
+    }
+  }
+  return image;
+}
+
+// Runs DecodeJpegCropResize and DecodeJpeg + crop + ResizeBilinear on the
+// same JPEG and checks that they agree within `tolerance`.
+void ExpectMatchesDecodeCropResize(const Tensor& image,
+                                   const std::vector<int>& crop_window,
+                                   const std::vector<int>& size,
+                                   float tolerance) {
+  Scope root = Scope::NewRootScope();
+  auto contents = EncodeJpeg(root, Const(root, Input::Initializer(image)),
+                             EncodeJpeg::Quality(100));
+  auto crop_window_op =
+      Const(root, Input::Initializer(test::AsTensor<int32>(crop_window)));
+  auto size_op = Const(root, Input::Initializer(test::AsTensor<int32>(size)));
+
+  auto fused = DecodeJpegCropResize(root, contents, crop_window_op, size_op,
+                                    DecodeJpegCropResize::Channels(1));
+
+  auto decoded = DecodeJpeg(root, contents, DecodeJpeg::Channels(1));
+  auto cropped = Slice(root, decoded, {crop_window[0], crop_window[1], 0},
+                       {crop_window[2], crop_window[3], -1});
+  auto resized =
+      ResizeBilinear(root, ExpandDims(root, cropped, 0), size_op,
+                     ResizeBilinear::HalfPixelCenters(true));
+  auto expected = Squeeze(root, resized, Squeeze::Axis({0}));
+  TF_ASSERT_OK(root.status());
+
+  ClientSession session(root);
+  std::vector<Tensor> outputs;
+  TF_ASSERT_OK(session.Run({fused, expected}, &outputs));
+  EXPECT_EQ(outputs[0].shape(), TensorShape({size[0], size[1], 1}));
+  test::ExpectTensorNear<float>(outputs[0], outputs[1], tolerance);
+}
+
+TEST(DecodeJpegCropResizeOpTest, MatchesDecodeCropResizeAtFullScale) {
+  // The output is larger than half of the window, so the window is decoded at
+  // full scale and only the interpolation differs.
+  ExpectMatchesDecodeCropResize(MakeGradientImage(64, 96), {8, 16, 40, 48},
+                                {30, 36}, 1e-2);
+}
+
+TEST(DecodeJpegCropResizeOpTest, MatchesDecodeCropResizeWithDctScaling) {
+  // The window is decoded at 1/4 scale, whose box filtering agrees with
+  // bilinear sampling of a linear gradient up to compression error.
+  ExpectMatchesDecodeCropResize(MakeGradientImage(64, 96), {0, 0, 64, 96},
+                                {16, 24}, 2.0);
+  // 1/2 scale of an unaligned window.
+  ExpectMatchesDecodeCropResize(MakeGradientImage(64, 96), {4, 10, 40, 56},
+                                {20, 28}, 2.0);
+}
+
+TEST(DecodeJpegCropResizeOpTest, InvalidCropWindow) {
+  Scope root = Scope::NewRootScope();
+  auto image = Const(root, Input::Initializer(MakeGradientImage(8, 8)));
+  auto contents = EncodeJpeg(root, image);
+  auto fused = DecodeJpegCropResize(root, contents, {4, 4, 8, 8}, {2, 2});
+  TF_ASSERT_OK(root.status());
+
+  ClientSession session(root);
+  std::vector<Tensor> outputs;
+  EXPECT_TRUE(errors::IsInvalidArgument(session.Run({fused}, &outputs)));
+}
+
+}  // namespace
+}  // namespace ops
+}  // namespace tensorflow
@@ -0,0 +1,212 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/image_ops.cc
+
+#define EIGEN_USE_THREADS
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/util/image_resizer_state.h"
+#include "tensorflow/core/util/tensor_format.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+namespace {
+
+struct CachedInterpolation {
+  int64_t lower;
+  int64_t upper;
+  float lerp;
+};
+
+// Same interpolation weights as the ResizeBilinear CPU kernel, so that the
+// fused op matches the unfused graph.
+template <typename Scaler>
+void ComputeInterpolationWeights(const Scaler scaler, const int64_t out_size,
+                                 const int64_t in_size, const float scale,
+                                 std::vector<CachedInterpolation>* weights) {
+  weights->resize(out_size);
+  for (int64_t i = 0; i < out_size; ++i) {
+    const float in = scaler(i, scale);
+    const float in_f = std::floor(in);
+    CachedInterpolation& w = (*weights)[i];
+    w.lower = std::max(static_cast<int64_t>(in_f), static_cast<int64_t>(0));
+    w.upper = std::min(static_cast<int64_t>(std::ceil(in)), in_size - 1);
+    w.lerp = in - in_f;
+  }
+}
+
+template <typename Scaler>
+void ComputeInterpolationWeights(const Scaler scaler,
+                                 const ImageResizerState& st,
+                                 std::vector<CachedInterpolation>* ys,
+                                 std::vector<CachedInterpolation>* xs) {
+  ComputeInterpolationWeights(scaler, st.out_height, st.in_height,
+                              st.height_scale, ys);
+  ComputeInterpolationWeights(scaler, st.out_width, st.in_width,
+                              st.width_scale, xs);
+}
+
+}  // namespace
+
+// Computes (ResizeBilinear(images, size) - mean) * scale in one pass over the
+// output: each output pixel is interpolated, normalized per channel and
+// written in the requested layout and type, instead of materializing the
+// resized, centered and scaled float images and their transpose.
+template <typename T, typename OutType>
+class FusedImagePreprocessOp : public OpKernel {
+ public:
+  explicit FusedImagePreprocessOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("align_corners", &align_corners_));
+    OP_REQUIRES_OK(
+        context, context->GetAttr("half_pixel_centers", &half_pixel_centers_));
+    string data_format;
+    OP_REQUIRES_OK(context, context->GetAttr("data_format", &data_format));
+    OP_REQUIRES(context, FormatFromString(data_format, &data_format_),
+                errors::InvalidArgument("Invalid data format: ", data_format));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    ImageResizerState st(align_corners_, half_pixel_centers_);
+    st.ValidateAndCalculateOutputSize(context);
+    if (!context->status().ok()) return;
+
+    const Tensor& mean = context->input(2);
+    const Tensor& scale = context->input(3);
+    OP_REQUIRES(context,
+                mean.NumElements() == 1 || mean.NumElements() == st.channels,
+                errors::InvalidArgument(
+                    "mean must have 1 or ", st.channels,
+                    " elements, got shape ", mean.shape().DebugString()));
+    OP_REQUIRES(context,
+                scale.NumElements() == 1 || scale.NumElements() == st.channels,
+                errors::InvalidArgument(
+                    "scale must have 1 or ", st.channels,
+                    " elements, got shape ", scale.shape().DebugString()));
+
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(
+                       0,
+                       ShapeFromFormat(data_format_, st.batch_size,
+                                       st.out_height, st.out_width,
+                                       st.channels),
+                       &output));
+    if (output->NumElements() == 0) return;
+
+    std::vector<CachedInterpolation> ys;
+    std::vector<CachedInterpolation> xs;
+    if (half_pixel_centers_) {
+      ComputeInterpolationWeights(HalfPixelScaler(), st, &ys, &xs);
+    } else {
+      ComputeInterpolationWeights(LegacyScaler(), st, &ys, &xs);
+    }
+
+    const int64_t channels = st.channels;
+    std::vector<float> means(channels);
+    std::vector<float> scales(channels);
+    const auto mean_flat = mean.flat<float>();
+    const auto scale_flat = scale.flat<float>();
+    for (int64_t c = 0; c < channels; ++c) {
+      means[c] = mean_flat(mean.NumElements() == 1 ? 0 : c);
+      scales[c] = scale_flat(scale.NumElements() == 1 ? 0 : c);
+    }
+
+    const T* input_data = context->input(0).flat<T>().data();
+    OutType* output_data = output->flat<OutType>().data();
+    const int64_t in_height = st.in_height;
+    const int64_t in_width = st.in_width;
+    const int64_t out_height = st.out_height;
+    const int64_t out_width = st.out_width;
+    const int64_t in_row_size = in_width * channels;
+    const int64_t in_batch_size = in_height * in_row_size;
+    const int64_t out_image_size = out_height * out_width;
+    // Distance between two consecutive output pixels and channels of a pixel.
+    const bool nchw = data_format_ == FORMAT_NCHW;
+    const int64_t pixel_stride = nchw ? 1 : channels;
+    const int64_t channel_stride = nchw ? out_image_size : 1;
+
+    // Each unit of work is one output row of one image.
+    auto preprocess_rows = [&](int64_t start, int64_t limit) {
+      for (int64_t row = start; row < limit; ++row) {
+        const int64_t b = row / out_height;
+        const int64_t y = row % out_height;
+        const T* image = input_data + b * in_batch_size;
+        const T* ys_lower = image + ys[y].lower * in_row_size;
+        const T* ys_upper = image + ys[y].upper * in_row_size;
+        const float y_lerp = ys[y].lerp;
+        OutType* out = output_data + b * out_image_size * channels +
+                       y * out_width * pixel_stride;
+        for (int64_t x = 0; x < out_width; ++x) {
+          const int64_t xs_lower = xs[x].lower * channels;
+          const int64_t xs_upper = xs[x].upper * channels;
+          const float x_lerp = xs[x].lerp;
+          for (int64_t c = 0; c < channels; ++c) {
+            const float top_left = static_cast<float>(ys_lower[xs_lower + c]);
+            const float top_right = static_cast<float>(ys_lower[xs_upper + c]);
+            const float bottom_left =
+                static_cast<float>(ys_upper[xs_lower + c]);
+            const float bottom_right =
+                static_cast<float>(ys_upper[xs_upper + c]);
+            const float top = top_left + (top_right - top_left) * x_lerp;
+            const float bottom =
+                bottom_left + (bottom_right - bottom_left) * x_lerp;
+            const float value = top + (bottom - top) * y_lerp;
+            out[x * pixel_stride + c * channel_stride] =
+                static_cast<OutType>((value - means[c]) * scales[c]);
+          }
+        }
+      }
+    };
+    auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers,
+          st.batch_size * out_height,
+          /*cost_per_unit=*/out_width * channels * 20, preprocess_rows);
+  }
+
+ private:
+  bool align_corners_;
+  bool half_pixel_centers_;
+  TensorFormat data_format_;
+};
+
+#define REGISTER_KERNEL(T, OutType)                                \
+  REGISTER_KERNEL_BUILDER(Name("_FusedImagePreprocess")            \
+                              .Device(DEVICE_CPU)                  \
+                              .TypeConstraint<T>("T")              \
+                              .TypeConstraint<OutType>("out_type") \
+                              .HostMemory("size"),                 \
+                          FusedImagePreprocessOp<T, OutType>);
+
+#define REGISTER_CPU_KERNELS(T) \
+  REGISTER_KERNEL(T, float);    \
+  REGISTER_KERNEL(T, bfloat16);
+
+TF_CALL_REAL_NUMBER_TYPES(REGISTER_CPU_KERNELS);
+
+#undef REGISTER_CPU_KERNELS
+#undef REGISTER_KERNEL
+
+}  // namespace tensorflow
@@ -0,0 +1,246 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Runs the cases of the kernel benchmark suite (see kernel_benchmark_suite.h)
+// on the given devices, writes the results as JSON and optionally compares
+// them to the results of an earlier run:
+//
+//   kernel_benchmark_driver --devices=cpu,gpu --output=new.json \
+//       --baseline=old.json --max_slowdown=0.05
+//
+// The output is a BenchmarkEntries proto in JSON format. Each entry holds the
+// mean wall time per iteration over the repetitions, the throughput in MB/s
+// and the "wall_time_stddev", "repetitions", "bytes_per_iteration" and, if
+// the peak bandwidth of the device is given, "bandwidth_utilization" extras.
+// The program fails if a benchmark is significantly slower than its baseline.
+// Flags not listed below, e.g. --benchmark_min_time, are passed to the
+// benchmark library.
+
+#include <cmath>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/match.h"
+#include "absl/strings/str_split.h"
+#include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/kernels/kernel_benchmark_suite.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/init_main.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/protobuf.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+#include "tensorflow/core/util/command_line_flags.h"
+
+namespace tensorflow {
+namespace kernel_benchmark {
+namespace {
+
+// Collects the runs of the repetitions of each benchmark, while printing them
+// to the console.
+class CollectingReporter : public ::benchmark::ConsoleReporter {
+ public:
+  void ReportRuns(const std::vector<Run>& reports) override {
+    for (const Run& run : reports) {
+      if (run.run_type != Run::RT_Iteration || run.error_occurred ||
+          run.iterations == 0) {
+        continue;
+      }
+      runs_[run.benchmark_name()].push_back(run);
+    }
+    ConsoleReporter::ReportRuns(reports);
+  }
+
+  const std::map<std::string, std::vector<Run>>& runs() const { return runs_; }
+
+ private:
+  std::map<std::string, std::vector<Run>> runs_;
+};
+
+struct Options {
+  std::string devices = "cpu";
+  std::string filter;
+  int repetitions = 10;
+  std::string output;
+  std::string baseline;
+  float max_slowdown = 0.05;
+  float significance = 0.01;
+  float peak_cpu_bandwidth_gbps = 0;
+  float peak_gpu_bandwidth_gbps = 0;
+};
+
+// Returns the name of the benchmark of the case, without the suffixes added
+// by the benchmark library.
+std::string BenchmarkName(const Case& c, const std::string& device) {
+  return strings::StrCat(c.name, "/", device);
+}
+
+BenchmarkEntries Summarize(
+    const CollectingReporter& reporter,
+    const std::map<std::string, int64_t>& bytes_per_iteration,
+    const Options& flags) {
+  BenchmarkEntries entries;
+  for (const auto& it : reporter.runs()) {
+    // Strips the "/repeats:N" and "/real_time" suffixes.
+    std::string name = it.first;
+    for (const char* suffix : {"/real_time", "/repeats:"}) {
+      const size_t pos = name.find(suffix);
+      if (pos != std::string::npos) name = name.substr(0, pos);
+    }
+    auto bytes_it = bytes_per_iteration.find(name);
+    if (bytes_it == bytes_per_iteration.end()) continue;
+
+    int64_t iters = 0;
+    std::vector<double> seconds;
+    for (const auto& run : it.second) {
+      iters += run.iterations;
+      seconds.push_back(run.real_accumulated_time / run.iterations);
+    }
+    double mean = 0;
+    for (double s : seconds) mean += s / seconds.size();
+    double var = 0;
+    for (double s : seconds) {
+      var += (s - mean) * (s - mean) / std::max<size_t>(seconds.size() - 1, 1);
+    }
+
+    BenchmarkEntry* entry = entries.add_entry();
+    entry->set_name(name);
+    entry->set_iters(iters);
+    entry->set_wall_time(mean);
+    const double bytes_per_second = bytes_it->second / mean;
+    entry->set_throughput(bytes_per_second / (1 << 20));
+    auto& extras = *entry->mutable_extras();
+    extras["wall_time_stddev"].set_double_value(std::sqrt(var));
+    extras["repetitions"].set_double_value(seconds.size());
+    extras["bytes_per_iteration"].set_double_value(bytes_it->second);
+    const double peak_gbps = absl::EndsWith(name, "/gpu")
+                                 ? flags.peak_gpu_bandwidth_gbps
+                                 : flags.peak_cpu_bandwidth_gbps;
+    if (peak_gbps > 0) {
+      extras["bandwidth_utilization"].set_double_value(bytes_per_second /
+                                                       (peak_gbps * 1e9));
+    }
+  }
+  return entries;
+}
+
+int Main(int argc, char** argv) {
+  Options flags;
+  std::vector<Flag> flag_list = {
+      Flag("devices", &flags.devices,
+           "Comma separated devices to run the cases on, cpu and/or gpu."),
+      Flag("filter", &flags.filter,
+           "Only runs the cases whose name contains this string."),
+      Flag("repetitions", &flags.repetitions,
+           "Number of repetitions of each benchmark."),
+      Flag("output", &flags.output, "Path of the JSON results to write."),
+      Flag("baseline", &flags.baseline,
+           "Path of the JSON results of an earlier run to compare against."),
+      Flag("max_slowdown", &flags.max_slowdown,
+           "Relative slowdown tolerated before a benchmark regresses."),
+      Flag("significance", &flags.significance,
+           "Significance level of the test for regressions."),
+      Flag("peak_cpu_bandwidth_gbps", &flags.peak_cpu_bandwidth_gbps,
+           "Peak memory bandwidth of the CPU in GB/s, if known."),
+      Flag("peak_gpu_bandwidth_gbps", &flags.peak_gpu_bandwidth_gbps,
+           "Peak memory bandwidth of the GPU in GB/s, if known."),
+  };
+  const std::string usage = Flags::Usage(argv[0], flag_list);
+  if (!Flags::Parse(&argc, argv, flag_list)) {
+    LOG(ERROR) << usage;
+    return 2;
+  }
+  port::InitMain(usage.c_str(), &argc, &argv);
+  ::benchmark::Initialize(&argc, argv);
+
+  std::map<std::string, int64_t> bytes_per_iteration;
+  const std::vector<std::string> devices = absl::StrSplit(flags.devices, ',');
+  for (const std::string& device : devices) {
+    for (const Case& c : Cases()) {
+      if (!absl::StrContains(c.name, flags.filter)) continue;
+      std::unique_ptr<Graph> graph;
+      int64_t bytes;
+      const Status status = BuildGraph(c, &graph, &bytes);
+      if (!status.ok()) {
+        LOG(ERROR) << "Skipping " << c.name << ": " << status;
+        continue;
+      }
+      const std::string name = BenchmarkName(c, device);
+      bytes_per_iteration[name] = bytes;
+      ::benchmark::RegisterBenchmark(
+          name.c_str(),
+          [&c, device, bytes](::benchmark::State& state) {
+            std::unique_ptr<Graph> graph;
+            int64_t unused_bytes;
+            TF_CHECK_OK(BuildGraph(c, &graph, &unused_bytes));
+            test::Benchmark(device, graph.release(),
+                            /*old_benchmark_api=*/false)
+                .Run(state);
+            state.SetBytesProcessed(state.iterations() * bytes);
+          })
+          ->Repetitions(flags.repetitions)
+          ->ReportAggregatesOnly(false)
+          ->UseRealTime();
+    }
+  }
+
+  CollectingReporter reporter;
+  ::benchmark::RunSpecifiedBenchmarks(&reporter);
+  const BenchmarkEntries results =
+      Summarize(reporter, bytes_per_iteration, flags);
+
+  if (!flags.output.empty()) {
+    std::string json;
+    protobuf::util::JsonPrintOptions options;
+    options.add_whitespace = true;
+    if (!protobuf::util::MessageToJsonString(results, &json, options).ok()) {
+      LOG(ERROR) << "Could not convert the results to JSON";
+      return 1;
+    }
+    TF_CHECK_OK(WriteStringToFile(Env::Default(), flags.output, json));
+  }
+
+  if (flags.baseline.empty()) return 0;
+  std::string json;
+  TF_CHECK_OK(ReadFileToString(Env::Default(), flags.baseline, &json));
+  BenchmarkEntries baseline;
+  if (!protobuf::util::JsonStringToMessage(json, &baseline).ok()) {
+    LOG(ERROR) << "Could not parse the baseline " << flags.baseline;
+    return 1;
+  }
+  int num_regressions = 0;
+  for (const Comparison& c : CompareToBaseline(
+           baseline, results, flags.max_slowdown, flags.significance)) {
+    LOG(INFO) << (c.regressed ? "REGRESSED " : "") << c.name << ": "
+              << c.baseline_seconds * 1e6 << "us -> " << c.seconds * 1e6
+              << "us (" << (c.change > 0 ? "+" : "") << c.change * 100
+              << "%, p=" << c.p_value << ")";
+    if (c.regressed) ++num_regressions;
+  }
+  if (num_regressions > 0) {
+    LOG(ERROR) << num_regressions << " benchmarks regressed";
+    return 1;
+  }
+  return 0;
+}
+
+}  // namespace
+}  // namespace kernel_benchmark
+}  // namespace tensorflow
+
+int main(int argc, char** argv) {
+  return tensorflow::kernel_benchmark::Main(argc, argv);
+}
@@ -0,0 +1,245 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/kernel_benchmark_suite.h"
+
+#include <cmath>
+#include <unordered_map>
+
+#include "absl/strings/str_join.h"
+#include "tensorflow/core/common_runtime/shape_refiner.h"
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/shape_inference.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/strcat.h"
+#include "unsupported/Eigen/SpecialFunctions"  // from @eigen_archive
+
+namespace tensorflow {
+namespace kernel_benchmark {
+
+namespace {
+
+std::string ShapesString(const std::vector<TensorShape>& shapes) {
+  return absl::StrJoin(shapes, ",", [](std::string* out, const TensorShape& s) {
+    absl::StrAppend(out, absl::StrJoin(s.dim_sizes(), "x"));
+  });
+}
+
+Case MakeCase(const std::string& op, DataType dtype,
+              std::vector<TensorShape> input_shapes,
+              const std::string& variant = "") {
+  Case c;
+  c.name = strings::StrCat(op, "/", DataTypeString(dtype), "/",
+                           ShapesString(input_shapes));
+  if (!variant.empty()) strings::StrAppend(&c.name, "/", variant);
+  c.op = op;
+  c.dtype = dtype;
+  c.input_shapes = std::move(input_shapes);
+  return c;
+}
+
+std::vector<Case>* BuildCases() {
+  auto* cases = new std::vector<Case>;
+  const DataType kElementwiseTypes[] = {DT_FLOAT, DT_HALF};
+  const TensorShape kElementwiseShapes[] = {
+      TensorShape({4096}), TensorShape({1 << 20}), TensorShape({1 << 24})};
+
+  for (DataType dtype : kElementwiseTypes) {
+    for (const TensorShape& shape : kElementwiseShapes) {
+      for (const char* op : {"Relu", "Tanh", "Exp", "Sigmoid"}) {
+        cases->push_back(MakeCase(op, dtype, {shape}));
+      }
+      for (const char* op : {"AddV2", "Mul"}) {
+        cases->push_back(MakeCase(op, dtype, {shape, shape}));
+      }
+    }
+    cases->push_back(MakeCase("AddV2", dtype,
+                              {TensorShape({1024, 1024}), TensorShape({1024})},
+                              "broadcast"));
+    cases->push_back(MakeCase(
+        "BiasAdd", dtype, {TensorShape({256, 1024}), TensorShape({1024})}));
+    cases->push_back(MakeCase("Softmax", dtype, {TensorShape({256, 32000})}));
+
+    // Reductions over the inner, the outer and all dimensions.
+    for (const char* op : {"Sum", "Max"}) {
+      for (int axis : {0, 1}) {
+        Case c = MakeCase(op, dtype, {TensorShape({4096, 4096})},
+                          strings::StrCat("axis", axis));
+        c.extra_inputs.push_back(test::AsTensor<int32>({axis}));
+        cases->push_back(std::move(c));
+      }
+      Case c = MakeCase(op, dtype, {TensorShape({1 << 24})}, "all");
+      c.extra_inputs.push_back(test::AsTensor<int32>({0}));
+      cases->push_back(std::move(c));
+    }
+
+    Case transpose = MakeCase("Transpose", dtype, {TensorShape({4096, 4096})});
+    transpose.extra_inputs.push_back(test::AsTensor<int32>({1, 0}));
+    cases->push_back(std::move(transpose));
+
+    for (int64_t n : {256, 1024, 4096}) {
+      cases->push_back(MakeCase(
+          "MatMul", dtype, {TensorShape({n, 1024}), TensorShape({1024, n})}));
+    }
+  }
+
+  // ResNet-50 like convolutions.
+  const std::vector<std::vector<TensorShape>> kConvShapes = {
+      {TensorShape({32, 56, 56, 64}), TensorShape({3, 3, 64, 64})},
+      {TensorShape({32, 28, 28, 128}), TensorShape({3, 3, 128, 128})},
+      {TensorShape({32, 14, 14, 256}), TensorShape({1, 1, 256, 1024})},
+  };
+  for (const auto& shapes : kConvShapes) {
+    Case c = MakeCase("Conv2D", DT_FLOAT, shapes);
+    SetAttrValue(std::vector<int32>{1, 1, 1, 1}, &c.attrs["strides"]);
+    SetAttrValue("SAME", &c.attrs["padding"]);
+    cases->push_back(std::move(c));
+  }
+  return cases;
+}
+
+Tensor RandomTensor(DataType dtype, const TensorShape& shape) {
+  Tensor t(dtype, shape);
+  switch (dtype) {
+    case DT_FLOAT:
+      t.flat<float>().setRandom();
+      break;
+    case DT_HALF:
+      t.flat<Eigen::half>().setRandom();
+      break;
+    case DT_BFLOAT16:
+      t.flat<bfloat16>().setRandom();
+      break;
+    case DT_DOUBLE:
+      t.flat<double>().setRandom();
+      break;
+    case DT_INT32:
+      t.flat<int32>().setRandom();
+      break;
+    default:
+      LOG(FATAL) << "Unsupported benchmark dtype " << DataTypeString(dtype);
+  }
+  return t;
+}
+
+}  // namespace
+
+const std::vector<Case>& Cases() {
+  static const std::vector<Case>* cases = BuildCases();
+  return *cases;
+}
+
+Status BuildGraph(const Case& c, std::unique_ptr<Graph>* graph,
+                  int64_t* bytes_accessed) {
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  ShapeRefiner refiner(g->versions().producer(), g->op_registry());
+  *bytes_accessed = 0;
+
+  NodeBuilder builder(g->NewName("op"), c.op);
+  for (const TensorShape& shape : c.input_shapes) {
+    Node* input = test::graph::Constant(g.get(), RandomTensor(c.dtype, shape));
+    TF_RETURN_IF_ERROR(refiner.AddNode(input));
+    builder.Input(input);
+    *bytes_accessed += shape.num_elements() * DataTypeSize(c.dtype);
+  }
+  for (const Tensor& t : c.extra_inputs) {
+    Node* input = test::graph::Constant(g.get(), t);
+    TF_RETURN_IF_ERROR(refiner.AddNode(input));
+    builder.Input(input);
+  }
+  for (const auto& attr : c.attrs) {
+    builder.Attr(attr.first, attr.second);
+  }
+  Node* node;
+  TF_RETURN_IF_ERROR(builder.Finalize(g.get(), &node));
+  TF_RETURN_IF_ERROR(refiner.AddNode(node));
+
+  shape_inference::InferenceContext* ctx = refiner.GetContext(node);
+  for (int i = 0; i < node->num_outputs(); ++i) {
+    shape_inference::ShapeHandle shape = ctx->output(i);
+    if (!ctx->FullyDefined(shape)) {
+      return errors::InvalidArgument("Output ", i, " of ", c.name,
+                                     " has unknown shape ",
+                                     ctx->DebugString(shape));
+    }
+    int64_t num_elements = 1;
+    for (int d = 0; d < ctx->Rank(shape); ++d) {
+      num_elements *= ctx->Value(ctx->Dim(shape, d));
+    }
+    *bytes_accessed += num_elements * DataTypeSize(node->output_type(i));
+  }
+  *graph = std::move(g);
+  return OkStatus();
+}
+
+double SlowdownPValue(double baseline_mean, double baseline_stddev,
+                      int baseline_n, double mean, double stddev, int n) {
+  if (baseline_n < 2 || n < 2) return 1.0;
+  const double baseline_var = baseline_stddev * baseline_stddev / baseline_n;
+  const double var = stddev * stddev / n;
+  if (baseline_var + var == 0) return mean > baseline_mean ? 0.0 : 1.0;
+  const double t = (mean - baseline_mean) / std::sqrt(baseline_var + var);
+  // Welch-Satterthwaite degrees of freedom.
+  const double df =
+      (baseline_var + var) * (baseline_var + var) /
+      (baseline_var * baseline_var / (baseline_n - 1) + var * var / (n - 1));
+  // P(T > |t|) of the Student's t-distribution with df degrees of freedom.
+  const double tail =
+      0.5 * Eigen::numext::betainc(df / 2, 0.5, df / (df + t * t));
+  return t > 0 ? tail : 1.0 - tail;
+}
+
+std::vector<Comparison> CompareToBaseline(const BenchmarkEntries& baseline,
+                                          const BenchmarkEntries& results,
+                                          double max_slowdown,
+                                          double significance) {
+  std::unordered_map<std::string, const BenchmarkEntry*> baseline_by_name;
+  for (const BenchmarkEntry& entry : baseline.entry()) {
+    baseline_by_name[entry.name()] = &entry;
+  }
+  auto extra = [](const BenchmarkEntry& entry, const std::string& key) {
+    auto it = entry.extras().find(key);
+    return it == entry.extras().end() ? 0.0 : it->second.double_value();
+  };
+
+  std::vector<Comparison> comparisons;
+  for (const BenchmarkEntry& entry : results.entry()) {
+    auto it = baseline_by_name.find(entry.name());
+    if (it == baseline_by_name.end() || it->second->wall_time() <= 0) {
+      continue;
+    }
+    const BenchmarkEntry& base = *it->second;
+    Comparison c;
+    c.name = entry.name();
+    c.baseline_seconds = base.wall_time();
+    c.seconds = entry.wall_time();
+    c.change = c.seconds / c.baseline_seconds - 1.0;
+    // Tests for a slowdown beyond the tolerance, rather than for any.
+    c.p_value = SlowdownPValue(
+        base.wall_time() * (1.0 + max_slowdown),
+        extra(base, "wall_time_stddev") * (1.0 + max_slowdown),
+        extra(base, "repetitions"), entry.wall_time(),
+        extra(entry, "wall_time_stddev"), extra(entry, "repetitions"));
+    c.regressed = c.change > max_slowdown && c.p_value < significance;
+    comparisons.push_back(c);
+  }
+  return comparisons;
+}
+
+}  // namespace kernel_benchmark
+}  // namespace tensorflow
@@ -0,0 +1,89 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_KERNEL_BENCHMARK_SUITE_H_
+#define TENSORFLOW_CORE_KERNELS_KERNEL_BENCHMARK_SUITE_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/util/test_log.pb.h"
+
+namespace tensorflow {
+namespace kernel_benchmark {
+
+// One case of the kernel benchmark suite: a single op run on random inputs of
+// the given dtype and shapes.
+struct Case {
+  // Unique name of the case, e.g. "MatMul/float/1024x1024,1024x1024".
+  std::string name;
+  std::string op;
+  DataType dtype;
+  // Shapes of the random inputs of type `dtype`, in order.
+  std::vector<TensorShape> input_shapes;
+  // Inputs passed after the random ones, e.g. the axes of a reduction.
+  std::vector<Tensor> extra_inputs;
+  // Attrs other than the type attrs, which are inferred from the inputs.
+  AttrValueMap attrs;
+};
+
+// Returns the curated list of cases of the suite.
+const std::vector<Case>& Cases();
+
+// Builds a graph that runs the op of `c` once on constant inputs. Sets
+// `*bytes_accessed` to the bytes of the random inputs and of the outputs of
+// the op, which is the memory traffic of a memory bound kernel.
+Status BuildGraph(const Case& c, std::unique_ptr<Graph>* graph,
+                  int64_t* bytes_accessed);
+
+// Returns the p-value of the hypothesis that the true mean of the samples
+// summarized by (`mean`, `stddev`, `n`) is not larger than the one of the
+// baseline samples, using Welch's t-test.
+double SlowdownPValue(double baseline_mean, double baseline_stddev,
+                      int baseline_n, double mean, double stddev, int n);
+
+// The comparison of a benchmark against its baseline.
+struct Comparison {
+  std::string name;
+  double baseline_seconds;
+  double seconds;
+  // Relative change of the time per iteration, positive if slower.
+  double change;
+  double p_value;
+  // Whether the benchmark is slower by more than the tolerated change, with
+  // a p-value below the significance level.
+  bool regressed;
+};
+
+// Compares the entries of `results` to the entries with the same name in
+// `baseline`, as written by the benchmark driver. The wall time of an entry
+// is the mean time per iteration, its "wall_time_stddev" and "repetitions"
+// extras describe the distribution of the repetitions.
+std::vector<Comparison> CompareToBaseline(const BenchmarkEntries& baseline,
+                                          const BenchmarkEntries& results,
+                                          double max_slowdown,
+                                          double significance);
+
+}  // namespace kernel_benchmark
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_KERNEL_BENCHMARK_SUITE_H_
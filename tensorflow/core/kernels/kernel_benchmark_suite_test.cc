@@ -0,0 +1,107 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/kernel_benchmark_suite.h"
+
+#include <cmath>
+#include <set>
+#include <string>
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace kernel_benchmark {
+namespace {
+
+const Case* FindCase(const std::string& name) {
+  for (const Case& c : Cases()) {
+    if (c.name == name) return &c;
+  }
+  return nullptr;
+}
+
+BenchmarkEntry MakeEntry(const std::string& name, double mean, double stddev,
+                         int repetitions) {
+  BenchmarkEntry entry;
+  entry.set_name(name);
+  entry.set_wall_time(mean);
+  (*entry.mutable_extras())["wall_time_stddev"].set_double_value(stddev);
+  (*entry.mutable_extras())["repetitions"].set_double_value(repetitions);
+  return entry;
+}
+
+TEST(KernelBenchmarkSuiteTest, CaseNamesAreUnique) {
+  std::set<std::string> names;
+  for (const Case& c : Cases()) {
+    EXPECT_TRUE(names.insert(c.name).second) << c.name;
+  }
+}
+
+TEST(KernelBenchmarkSuiteTest, BuildGraph) {
+  const Case* c = FindCase("MatMul/float/256x1024,1024x256");
+  ASSERT_NE(c, nullptr);
+  std::unique_ptr<Graph> graph;
+  int64_t bytes;
+  TF_ASSERT_OK(BuildGraph(*c, &graph, &bytes));
+  EXPECT_EQ(bytes, (256 * 1024 * 2 + 256 * 256) * sizeof(float));
+
+  c = FindCase("Sum/half/4096x4096/axis1");
+  ASSERT_NE(c, nullptr);
+  TF_ASSERT_OK(BuildGraph(*c, &graph, &bytes));
+  EXPECT_EQ(bytes, (4096 * 4096 + 4096) * sizeof(Eigen::half));
+}
+
+TEST(KernelBenchmarkSuiteTest, SlowdownPValue) {
+  // Same distributions.
+  EXPECT_NEAR(SlowdownPValue(1.0, 0.1, 10, 1.0, 0.1, 10), 0.5, 1e-6);
+  // Clearly slower, clearly faster.
+  EXPECT_LT(SlowdownPValue(1.0, 0.01, 10, 1.1, 0.01, 10), 1e-6);
+  EXPECT_GT(SlowdownPValue(1.0, 0.01, 10, 0.9, 0.01, 10), 1 - 1e-6);
+  // Too noisy to tell.
+  EXPECT_GT(SlowdownPValue(1.0, 0.5, 3, 1.1, 0.5, 3), 0.1);
+  // t = 2.2 with 18 degrees of freedom.
+  EXPECT_NEAR(SlowdownPValue(1.0, std::sqrt(5.0), 10, 3.2, std::sqrt(5.0), 10),
+              0.0206, 1e-3);
+}
+
+TEST(KernelBenchmarkSuiteTest, CompareToBaseline) {
+  BenchmarkEntries baseline;
+  *baseline.add_entry() = MakeEntry("a", 1.0, 0.01, 10);
+  *baseline.add_entry() = MakeEntry("b", 1.0, 0.01, 10);
+  *baseline.add_entry() = MakeEntry("c", 1.0, 0.01, 10);
+  BenchmarkEntries results;
+  *results.add_entry() = MakeEntry("a", 1.2, 0.01, 10);
+  // Within the tolerated slowdown.
+  *results.add_entry() = MakeEntry("b", 1.03, 0.01, 10);
+  // Not significant.
+  *results.add_entry() = MakeEntry("c", 1.2, 1.0, 10);
+  // Not in the baseline.
+  *results.add_entry() = MakeEntry("d", 1.0, 0.01, 10);
+
+  const std::vector<Comparison> comparisons =
+      CompareToBaseline(baseline, results, /*max_slowdown=*/0.05,
+                        /*significance=*/0.01);
+  ASSERT_EQ(comparisons.size(), 3);
+  EXPECT_EQ(comparisons[0].name, "a");
+  EXPECT_NEAR(comparisons[0].change, 0.2, 1e-9);
+  EXPECT_TRUE(comparisons[0].regressed);
+  EXPECT_FALSE(comparisons[1].regressed);
+  EXPECT_FALSE(comparisons[2].regressed);
+}
+
+}  // namespace
+}  // namespace kernel_benchmark
+}  // namespace tensorflow
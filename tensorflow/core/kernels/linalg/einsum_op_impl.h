@@ -333,6 +333,27 @@ struct EinsumHelper {
     return true;
   }
 
+  // Returns true if the free labels of the output are those of the second
+  // operand followed by those of the first, but not the other way around, so
+  // that contracting the operands in the opposite order avoids transposing the
+  // contraction result.
+  static bool ShouldSwapOperands(
+      const OperandLabels& free_labels, const Labels& output_labels,
+      const std::vector<EinsumDimensionType>& label_types) {
+    Labels output_free_labels;
+    for (int label : output_labels) {
+      if (label_types[label] == EinsumDimensionType::kFree) {
+        output_free_labels.push_back(label);
+      }
+    }
+    Labels in_order(free_labels[0]);
+    in_order.insert(in_order.end(), free_labels[1].begin(),
+                    free_labels[1].end());
+    Labels swapped(free_labels[1]);
+    swapped.insert(swapped.end(), free_labels[0].begin(), free_labels[0].end());
+    return output_free_labels == swapped && output_free_labels != in_order;
+  }
+
   template <typename Device, typename T>
   static Status ReduceOperand(
       OpKernelContext* ctx, const Tensor& input,
@@ -522,6 +543,18 @@ class EinsumOp : public OpKernel {
                          &swap_free_and_contract[i], &inputs_reduced[i]));
     }
 
+    // The contraction result has the free dimensions of the first operand
+    // before the ones of the second. If the output wants them the other way
+    // around, contract the operands in the opposite order, which only changes
+    // the BatchMatMul transpose flags, instead of transposing the result.
+    if (num_inputs == 2 &&
+        EinsumHelper::ShouldSwapOperands(free_labels, output_labels,
+                                         label_types)) {
+      std::swap(free_labels[0], free_labels[1]);
+      std::swap(inputs_reduced[0], inputs_reduced[1]);
+      std::swap(swap_free_and_contract[0], swap_free_and_contract[1]);
+    }
+
     // After reduction, the inputs should be reshaped to Tensors suitable for
     // contraction. If num_inputs is 1, the reduced input is simply forwarded to
     // the output.
@@ -15,16 +15,21 @@ limitations under the License.
 
 // Tests kernels of lookup ops.
 
+#include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
 #include "tensorflow/core/framework/fake_input.h"
 #include "tensorflow/core/framework/lookup_interface.h"
 #include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/shape_inference_testutil.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/graph/testlib.h"
 #include "tensorflow/core/kernels/lookup_table_op.h"
 #include "tensorflow/core/kernels/ops_testutil.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
 
 namespace tensorflow {
 namespace {
@@ -100,5 +105,100 @@ TEST_F(LookupOpsTest, AnonymousHashTable_RefCounting) {
   EXPECT_FALSE(alive);
 }
 
+constexpr int64_t kDenseHashTableSize = 1 << 16;
+constexpr int kDenseHashTableBatchSize = 1024;
+
+Node* DenseHashTable(Graph* g) {
+  Node* table;
+  TF_CHECK_OK(NodeBuilder(g->NewName("table"), "MutableDenseHashTableV2")
+                  .Input(test::graph::Constant(g, test::AsScalar<int64_t>(-1)))
+                  .Input(test::graph::Constant(g, test::AsScalar<int64_t>(-2)))
+                  .Attr("shared_name", "dense_hash_table")
+                  .Attr("key_dtype", DT_INT64)
+                  .Attr("value_dtype", DT_INT64)
+                  .Finalize(g, &table));
+  return table;
+}
+
+// Builds `init`, which fills a MutableDenseHashTable with kDenseHashTableSize
+// entries, and `g`, in which `num_readers` ops each look up
+// kDenseHashTableBatchSize keys in the table. If `with_writer` is true, an op
+// concurrently inserts random keys, which grows the table until it holds four
+// times as many entries.
+void DenseHashTableGraphs(int num_readers, bool with_writer, Graph** init,
+                          Graph** g) {
+  Tensor keys(DT_INT64, TensorShape({kDenseHashTableSize}));
+  test::FillIota<int64_t>(&keys, 0);
+  {
+    Graph* init_g = new Graph(OpRegistry::Global());
+    Node* insert;
+    TF_CHECK_OK(NodeBuilder(init_g->NewName("insert"), "LookupTableInsertV2")
+                    .Input(DenseHashTable(init_g))
+                    .Input(test::graph::Constant(init_g, keys))
+                    .Input(test::graph::Constant(init_g, keys))
+                    .Finalize(init_g, &insert));
+    *init = init_g;
+  }
+
+  Graph* lookup_g = new Graph(OpRegistry::Global());
+  Node* table = DenseHashTable(lookup_g);
+  Node* lookup_keys = test::graph::Constant(
+      lookup_g, keys.Slice(0, kDenseHashTableBatchSize));
+  Node* default_value =
+      test::graph::Constant(lookup_g, test::AsScalar<int64_t>(-1));
+  for (int i = 0; i < num_readers; ++i) {
+    Node* find;
+    TF_CHECK_OK(NodeBuilder(lookup_g->NewName("find"), "LookupTableFindV2")
+                    .Input(table)
+                    .Input(lookup_keys)
+                    .Input(default_value)
+                    .Finalize(lookup_g, &find));
+  }
+  if (with_writer) {
+    Node* new_keys;
+    TF_CHECK_OK(
+        NodeBuilder(lookup_g->NewName("new_keys"), "RandomUniformInt")
+            .Input(test::graph::Constant(
+                lookup_g, test::AsTensor<int32>({kDenseHashTableBatchSize})))
+            .Input(test::graph::Constant(lookup_g,
+                                         test::AsScalar<int64_t>(0)))
+            .Input(test::graph::Constant(
+                lookup_g, test::AsScalar<int64_t>(4 * kDenseHashTableSize)))
+            .Finalize(lookup_g, &new_keys));
+    Node* insert;
+    TF_CHECK_OK(NodeBuilder(lookup_g->NewName("insert"), "LookupTableInsertV2")
+                    .Input(table)
+                    .Input(new_keys)
+                    .Input(new_keys)
+                    .Finalize(lookup_g, &insert));
+  }
+  *g = lookup_g;
+}
+
+// Measures the lookup throughput of a MutableDenseHashTable against the number
+// of concurrent readers, with and without a concurrent writer.
+void BM_MutableDenseHashTableFind(::testing::benchmark::State& state) {
+  const int num_readers = state.range(0);
+  const bool with_writer = state.range(1);
+  Graph* init;
+  Graph* g;
+  DenseHashTableGraphs(num_readers, with_writer, &init, &g);
+  test::Benchmark("cpu", g, /*options=*/nullptr, init, /*rendez=*/nullptr, "",
+                  /*old_benchmark_api=*/false)
+      .Run(state);
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                          num_readers * kDenseHashTableBatchSize);
+}
+
+BENCHMARK(BM_MutableDenseHashTableFind)
+    ->ArgPair(1, 0)
+    ->ArgPair(4, 0)
+    ->ArgPair(16, 0)
+    ->ArgPair(64, 0)
+    ->ArgPair(1, 1)
+    ->ArgPair(4, 1)
+    ->ArgPair(16, 1)
+    ->ArgPair(64, 1);
+
 }  // namespace
 }  // namespace tensorflow
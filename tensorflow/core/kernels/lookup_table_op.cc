@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/variant.h"
 #include "tensorflow/core/kernels/initializable_lookup_table.h"
+#include "tensorflow/core/kernels/mapped_hash_table_file.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/platform/random.h"
@@ -425,9 +426,29 @@ TensorShape MaybeVectorizeShape(const TensorShape& shape) {
   return shape;
 }
 
+// Control bytes of the buckets of a MutableDenseHashTable. Empty and deleted
+// buckets have the high bit set, while full buckets hold 7 bits of the key
+// hash, so that most non-matching buckets are skipped without comparing keys.
+constexpr uint8 kEmptyBucket = 0x80;
+constexpr uint8 kDeletedBucket = 0xFE;
+
+inline bool IsFullBucket(uint8 tag) { return (tag & 0x80) == 0; }
+
+inline uint8 HashTag(uint64 hash) {
+  // Bucket indices use the low bits of the hash, which is the key itself for
+  // integer keys, so the tag is taken from the high bits of a mixed hash.
+  return static_cast<uint8>((hash * 0x9E3779B97F4A7C15ULL) >> 57);
+}
+
 }  // namespace
 
 // Modeled after densehashtable in https://github.com/sparsehash/sparsehash
+//
+// Lookups hold a shared lock on mu_, which is only held exclusively while the
+// buckets are modified in place. Writers are serialized by writer_mu_, so an
+// Insert that grows the table can rehash into new buckets under a shared lock.
+// Lookups then proceed during the rehash and only wait for the new buckets to
+// be swapped in.
 template <class K, class V>
 class MutableDenseHashTable final : public LookupInterface {
  public:
@@ -488,12 +509,12 @@ class MutableDenseHashTable final : public LookupInterface {
     int64_t initial_num_buckets;
     OP_REQUIRES_OK(ctx, GetNodeAttr(kernel->def(), "initial_num_buckets",
                                     &initial_num_buckets));
-    OP_REQUIRES_OK(ctx, AllocateBuckets(ctx, initial_num_buckets));
+    OP_REQUIRES_OK(ctx, AllocateBuckets(ctx, initial_num_buckets, &buckets_));
   }
 
   size_t size() const override TF_LOCKS_EXCLUDED(mu_) {
     tf_shared_lock l(mu_);
-    return num_entries_;
+    return buckets_.num_entries;
   }
 
   Status Find(OpKernelContext* ctx, const Tensor& key, Tensor* value,
@@ -513,13 +534,14 @@ class MutableDenseHashTable final : public LookupInterface {
     const auto default_flat = default_value.flat<V>();
 
     tf_shared_lock l(mu_);
-    const auto key_buckets_matrix = key_buckets_.template matrix<K>();
-    const auto value_buckets_matrix = value_buckets_.template matrix<V>();
+    const auto key_buckets_matrix = buckets_.keys.template matrix<K>();
+    const auto value_buckets_matrix = buckets_.values.template matrix<V>();
+    const auto tag_buckets = buckets_.tags.template flat<uint8>();
     const auto empty_key_matrix =
         empty_key_.template shaped<K, 2>({1, key_size});
     const auto deleted_key_matrix =
         deleted_key_.template shaped<K, 2>({1, key_size});
-    const int64_t bit_mask = num_buckets_ - 1;
+    const int64_t bit_mask = buckets_.num_buckets - 1;
     // TODO(andreasst): parallelize using work_sharder
     for (int64_t i = 0; i < num_elements; ++i) {
       const uint64 key_hash = HashKey(key_matrix, i);
@@ -533,10 +555,13 @@ class MutableDenseHashTable final : public LookupInterface {
         return errors::InvalidArgument(
             "Using the deleted_key as a table key is not allowed");
       }
+      const uint8 tag = HashTag(key_hash);
       int64_t bucket_index = key_hash & bit_mask;
       int64_t num_probes = 0;
       while (true) {
-        if (IsEqualKey(key_buckets_matrix, bucket_index, key_matrix, i)) {
+        const uint8 bucket_tag = tag_buckets(bucket_index);
+        if (bucket_tag == tag &&
+            IsEqualKey(key_buckets_matrix, bucket_index, key_matrix, i)) {
           for (int64_t j = 0; j < value_size; ++j) {
             // TODO(andreasst): check if we can get rid of SubtleMustCopy
             // here and elsewhere in this file.
@@ -545,7 +570,7 @@ class MutableDenseHashTable final : public LookupInterface {
           }
           break;
         }
-        if (IsEqualKey(key_buckets_matrix, bucket_index, empty_key_matrix, 0)) {
+        if (bucket_tag == kEmptyBucket) {
           for (int64_t j = 0; j < value_size; ++j) {
             value_matrix(i, j) = SubtleMustCopyIfIntegral(default_flat(j));
           }
@@ -554,7 +579,7 @@ class MutableDenseHashTable final : public LookupInterface {
         ++num_probes;
         bucket_index =
             (bucket_index + num_probes) & bit_mask;  // quadratic probing
-        if (num_probes >= num_buckets_) {
+        if (num_probes >= buckets_.num_buckets) {
           return errors::Internal(
               "Internal error in MutableDenseHashTable lookup");
         }
@@ -564,7 +589,8 @@ class MutableDenseHashTable final : public LookupInterface {
   }
 
   Status Insert(OpKernelContext* ctx, const Tensor& key,
-                const Tensor& value) override TF_LOCKS_EXCLUDED(mu_) {
+                const Tensor& value) override
+      TF_LOCKS_EXCLUDED(writer_mu_, mu_) {
     const int64_t batch_size = (key.dims() == 0) ? 1 : key.dim_size(0);
     if (key.NumElements() != batch_size * key_shape_.num_elements()) {
       TensorShape expected_shape({batch_size});
@@ -573,24 +599,31 @@ class MutableDenseHashTable final : public LookupInterface {
                                      expected_shape.DebugString(), " got ",
                                      key.shape().DebugString());
     }
-    mutex_lock l(mu_);
+    mutex_lock writer_lock(writer_mu_);
     // For simplicity we assume that all keys in the input result in inserts
     // rather than updates. That means we may grow the table even though we
     // don't need to. As long as the number of keys inserted in one call is
     // small compared to the size of the map, the impact of this is minimal.
-    const int64_t pending_num_entries = num_entries_ + batch_size;
-    if (pending_num_entries > num_buckets_ * max_load_factor_) {
-      int64_t new_num_buckets = num_buckets_;
-      do {
+    int64_t num_buckets;
+    int64_t new_num_buckets;
+    {
+      tf_shared_lock l(mu_);
+      num_buckets = buckets_.num_buckets;
+      const int64_t pending_num_entries = buckets_.num_entries + batch_size;
+      new_num_buckets = num_buckets;
+      while (pending_num_entries > new_num_buckets * max_load_factor_) {
         new_num_buckets <<= 1;
-      } while (pending_num_entries > new_num_buckets * max_load_factor_);
+      }
+    }
+    if (new_num_buckets != num_buckets) {
       TF_RETURN_IF_ERROR(Rebucket(ctx, new_num_buckets));
     }
-    return DoInsert(ctx, key, value, false);
+    mutex_lock l(mu_);
+    return DoInsert(key, value, &buckets_);
   }
 
   Status Remove(OpKernelContext* ctx, const Tensor& key) override
-      TF_LOCKS_EXCLUDED(mu_) {
+      TF_LOCKS_EXCLUDED(writer_mu_, mu_) {
     if (key.NumElements() != key.dim_size(0) * key_shape_.num_elements()) {
       TensorShape expected_shape({key.dim_size(0)});
       expected_shape.AppendShape(key_shape_);
@@ -598,38 +631,50 @@ class MutableDenseHashTable final : public LookupInterface {
                                      expected_shape.DebugString(), " got ",
                                      key.shape().DebugString());
     }
+    mutex_lock writer_lock(writer_mu_);
     mutex_lock l(mu_);
-    return DoRemove(ctx, key);
+    return DoRemove(key, &buckets_);
   }
 
   Status ImportValues(OpKernelContext* ctx, const Tensor& keys,
-                      const Tensor& values) override TF_LOCKS_EXCLUDED(mu_) {
-    mutex_lock l(mu_);
-    num_buckets_ = keys.dim_size(0);
-    key_buckets_ = keys;
-    value_buckets_ = values;
-    // Count the number of keys that are not the empty_key or deleted_key.
-    // This requires iterating through the whole table but that is OK as we
-    // only execute it during checkpoint restore.
-    num_entries_ = 0;
+                      const Tensor& values) override
+      TF_LOCKS_EXCLUDED(writer_mu_, mu_) {
+    mutex_lock writer_lock(writer_mu_);
+    Buckets new_buckets;
+    new_buckets.num_buckets = keys.dim_size(0);
+    new_buckets.keys = keys;
+    new_buckets.values = values;
+    TF_RETURN_IF_ERROR(ctx->allocate_temp(
+        DT_UINT8, TensorShape({new_buckets.num_buckets}), &new_buckets.tags));
+    // Count the number of keys that are not the empty_key or deleted_key, and
+    // compute the control byte of every bucket. This requires iterating
+    // through the whole table but that is OK as we only execute it during
+    // checkpoint restore.
     const auto empty_key_tensor =
         empty_key_.template shaped<K, 2>({1, key_shape_.num_elements()});
     const auto deleted_key_tensor =
         deleted_key_.template shaped<K, 2>({1, key_shape_.num_elements()});
-    const auto key_buckets_tensor = key_buckets_.template matrix<K>();
-    for (int64_t i = 0; i < num_buckets_; ++i) {
-      if (!IsEqualKey(key_buckets_tensor, i, empty_key_tensor, 0) &&
-          !IsEqualKey(key_buckets_tensor, i, deleted_key_tensor, 0)) {
-        ++num_entries_;
+    const auto key_buckets_tensor = keys.template matrix<K>();
+    auto tag_buckets = new_buckets.tags.template flat<uint8>();
+    for (int64_t i = 0; i < new_buckets.num_buckets; ++i) {
+      if (IsEqualKey(key_buckets_tensor, i, empty_key_tensor, 0)) {
+        tag_buckets(i) = kEmptyBucket;
+      } else if (IsEqualKey(key_buckets_tensor, i, deleted_key_tensor, 0)) {
+        tag_buckets(i) = kDeletedBucket;
+      } else {
+        tag_buckets(i) = HashTag(HashKey(key_buckets_tensor, i));
+        ++new_buckets.num_entries;
       }
     }
+    mutex_lock l(mu_);
+    buckets_ = std::move(new_buckets);
     return OkStatus();
   }
 
   Status ExportValues(OpKernelContext* ctx) override TF_LOCKS_EXCLUDED(mu_) {
     tf_shared_lock l(mu_);
-    TF_RETURN_IF_ERROR(ctx->set_output("keys", key_buckets_));
-    TF_RETURN_IF_ERROR(ctx->set_output("values", value_buckets_));
+    TF_RETURN_IF_ERROR(ctx->set_output("keys", buckets_.keys));
+    TF_RETURN_IF_ERROR(ctx->set_output("values", buckets_.values));
     return OkStatus();
   }
 
@@ -668,94 +713,112 @@ class MutableDenseHashTable final : public LookupInterface {
 
   int64_t MemoryUsed() const override TF_LOCKS_EXCLUDED(mu_) {
     tf_shared_lock l(mu_);
-    return sizeof(MutableDenseHashTable) + key_buckets_.AllocatedBytes() +
-           value_buckets_.AllocatedBytes() + empty_key_.AllocatedBytes();
+    return sizeof(MutableDenseHashTable) + buckets_.keys.AllocatedBytes() +
+           buckets_.values.AllocatedBytes() + buckets_.tags.AllocatedBytes() +
+           empty_key_.AllocatedBytes();
   }
 
  private:
-  Status DoInsert(OpKernelContext* ctx, const Tensor& key, const Tensor& value,
-                  bool ignore_empty_and_deleted_key)
-      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  // Storage of the table. The keys and values are what gets exported, and the
+  // tags hold the control byte of each bucket.
+  struct Buckets {
+    int64_t num_buckets = 0;
+    int64_t num_entries = 0;
+    Tensor keys;
+    Tensor values;
+    Tensor tags;
+  };
+
+  Status DoInsert(const Tensor& key, const Tensor& value,
+                  Buckets* buckets) const {
     const int64_t num_elements = (key.dims() == 0) ? 1 : key.dim_size(0);
     const int64_t value_size = value_shape_.num_elements();
     const int64_t key_size = key_shape_.num_elements();
     const auto key_matrix = key.shaped<K, 2>({num_elements, key_size});
-    auto value_matrix = value.shaped<V, 2>({num_elements, value_size});
+    const auto value_matrix = value.shaped<V, 2>({num_elements, value_size});
 
-    auto key_buckets_matrix = key_buckets_.template matrix<K>();
-    auto value_buckets_matrix = value_buckets_.template matrix<V>();
     const auto empty_key_tensor =
         empty_key_.template shaped<K, 2>({1, key_size});
     const auto deleted_key_tensor =
         deleted_key_.template shaped<K, 2>({1, key_size});
-    const int64_t bit_mask = num_buckets_ - 1;
     for (int64_t i = 0; i < num_elements; ++i) {
       const uint64 key_hash = HashKey(key_matrix, i);
       if (empty_key_hash_ == key_hash &&
           IsEqualKey(empty_key_tensor, 0, key_matrix, i)) {
-        if (ignore_empty_and_deleted_key) {
-          continue;
-        }
         return errors::InvalidArgument(
             "Using the empty_key as a table key is not allowed");
       }
       if (deleted_key_hash_ == key_hash &&
           IsEqualKey(deleted_key_tensor, 0, key_matrix, i)) {
-        if (ignore_empty_and_deleted_key) {
-          continue;
-        }
         return errors::InvalidArgument(
             "Using the deleted_key as a table key is not allowed");
       }
-      int64_t bucket_index = key_hash & bit_mask;
-      int64_t num_probes = 0;
-      while (true) {
-        if (IsEqualKey(key_buckets_matrix, bucket_index, key_matrix, i)) {
-          for (int64_t j = 0; j < value_size; ++j) {
-            value_buckets_matrix(bucket_index, j) =
-                SubtleMustCopyIfIntegral(value_matrix(i, j));
-          }
-          break;
+      TF_RETURN_IF_ERROR(
+          InsertKey(key_matrix, value_matrix, i, key_hash, buckets));
+    }
+    return OkStatus();
+  }
+
+  // Inserts row `index` of `key_matrix` and `value_matrix` into `buckets`, or
+  // updates the value if the key is found before a free bucket.
+  Status InsertKey(typename TTypes<K>::ConstMatrix key_matrix,
+                   typename TTypes<V>::ConstMatrix value_matrix, int64_t index,
+                   uint64 key_hash, Buckets* buckets) const {
+    const int64_t key_size = key_shape_.num_elements();
+    const int64_t value_size = value_shape_.num_elements();
+    auto key_buckets_matrix = buckets->keys.template matrix<K>();
+    auto value_buckets_matrix = buckets->values.template matrix<V>();
+    auto tag_buckets = buckets->tags.template flat<uint8>();
+    const uint8 tag = HashTag(key_hash);
+    const int64_t bit_mask = buckets->num_buckets - 1;
+    int64_t bucket_index = key_hash & bit_mask;
+    int64_t num_probes = 0;
+    while (true) {
+      const uint8 bucket_tag = tag_buckets(bucket_index);
+      if (bucket_tag == tag &&
+          IsEqualKey(key_buckets_matrix, bucket_index, key_matrix, index)) {
+        for (int64_t j = 0; j < value_size; ++j) {
+          value_buckets_matrix(bucket_index, j) =
+              SubtleMustCopyIfIntegral(value_matrix(index, j));
         }
-        if (IsEqualKey(key_buckets_matrix, bucket_index, empty_key_tensor, 0) ||
-            IsEqualKey(key_buckets_matrix, bucket_index, deleted_key_tensor,
-                       0)) {
-          ++num_entries_;
-          for (int64_t j = 0; j < key_size; ++j) {
-            key_buckets_matrix(bucket_index, j) =
-                SubtleMustCopyIfIntegral(key_matrix(i, j));
-          }
-          for (int64_t j = 0; j < value_size; ++j) {
-            value_buckets_matrix(bucket_index, j) =
-                SubtleMustCopyIfIntegral(value_matrix(i, j));
-          }
-          break;
+        return OkStatus();
+      }
+      if (!IsFullBucket(bucket_tag)) {
+        ++buckets->num_entries;
+        for (int64_t j = 0; j < key_size; ++j) {
+          key_buckets_matrix(bucket_index, j) =
+              SubtleMustCopyIfIntegral(key_matrix(index, j));
         }
-        ++num_probes;
-        bucket_index =
-            (bucket_index + num_probes) & bit_mask;  // quadratic probing
-        if (num_probes >= num_buckets_) {
-          return errors::Internal(
-              "Internal error in MutableDenseHashTable insert");
+        for (int64_t j = 0; j < value_size; ++j) {
+          value_buckets_matrix(bucket_index, j) =
+              SubtleMustCopyIfIntegral(value_matrix(index, j));
         }
+        tag_buckets(bucket_index) = tag;
+        return OkStatus();
+      }
+      ++num_probes;
+      bucket_index =
+          (bucket_index + num_probes) & bit_mask;  // quadratic probing
+      if (num_probes >= buckets->num_buckets) {
+        return errors::Internal(
+            "Internal error in MutableDenseHashTable insert");
       }
     }
-    return OkStatus();
   }
 
-  Status DoRemove(OpKernelContext* ctx, const Tensor& key)
-      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  Status DoRemove(const Tensor& key, Buckets* buckets) const {
     const int64_t num_elements = key.dim_size(0);
     const int64_t key_size = key_shape_.num_elements();
     const auto key_matrix = key.shaped<K, 2>({num_elements, key_size});
 
-    auto key_buckets_matrix = key_buckets_.template matrix<K>();
+    auto key_buckets_matrix = buckets->keys.template matrix<K>();
+    auto tag_buckets = buckets->tags.template flat<uint8>();
     const auto empty_key_tensor =
         empty_key_.template shaped<K, 2>({1, key_size});
     const auto deleted_key_tensor =
         deleted_key_.template shaped<K, 2>({1, key_size});
     const auto deleted_key_flat = deleted_key_.template flat<K>();
-    const int64_t bit_mask = num_buckets_ - 1;
+    const int64_t bit_mask = buckets->num_buckets - 1;
     for (int64_t i = 0; i < num_elements; ++i) {
       const uint64 key_hash = HashKey(key_matrix, i);
       if (empty_key_hash_ == key_hash &&
@@ -768,24 +831,28 @@ class MutableDenseHashTable final : public LookupInterface {
         return errors::InvalidArgument(
             "Using the deleted_key as a table key is not allowed");
       }
+      const uint8 tag = HashTag(key_hash);
       int64_t bucket_index = key_hash & bit_mask;
       int64_t num_probes = 0;
       while (true) {
-        if (IsEqualKey(key_buckets_matrix, bucket_index, key_matrix, i)) {
-          --num_entries_;
+        const uint8 bucket_tag = tag_buckets(bucket_index);
+        if (bucket_tag == tag &&
+            IsEqualKey(key_buckets_matrix, bucket_index, key_matrix, i)) {
+          --buckets->num_entries;
           for (int64_t j = 0; j < key_size; ++j) {
             key_buckets_matrix(bucket_index, j) =
                 SubtleMustCopyIfIntegral(deleted_key_flat(j));
           }
+          tag_buckets(bucket_index) = kDeletedBucket;
           break;
         }
-        if (IsEqualKey(key_buckets_matrix, bucket_index, empty_key_tensor, 0)) {
+        if (bucket_tag == kEmptyBucket) {
           break;
         }
         ++num_probes;
         bucket_index =
             (bucket_index + num_probes) & bit_mask;  // quadratic probing
-        if (num_probes >= num_buckets_) {
+        if (num_probes >= buckets->num_buckets) {
           return errors::Internal(
               "Internal error in MutableDenseHashTable remove");
         }
@@ -794,23 +861,24 @@ class MutableDenseHashTable final : public LookupInterface {
     return OkStatus();
   }
 
-  Status AllocateBuckets(OpKernelContext* ctx, int64_t new_num_buckets)
-      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  Status AllocateBuckets(OpKernelContext* ctx, int64_t new_num_buckets,
+                         Buckets* buckets) const {
     if (new_num_buckets < 4 ||
         ((new_num_buckets & (new_num_buckets - 1)) != 0)) {
       return errors::InvalidArgument(
           "Number of buckets must be at least 4 and a power of 2, got: ",
           new_num_buckets);
     }
-    num_buckets_ = new_num_buckets;
-    num_entries_ = 0;
+    buckets->num_buckets = new_num_buckets;
+    buckets->num_entries = 0;
 
     const int64_t key_size = key_shape_.num_elements();
     TF_RETURN_IF_ERROR(ctx->allocate_temp(
-        key_dtype(), TensorShape({num_buckets_, key_size}), &key_buckets_));
-    auto key_buckets_matrix = key_buckets_.matrix<K>();
+        key_dtype(), TensorShape({new_num_buckets, key_size}),
+        &buckets->keys));
+    auto key_buckets_matrix = buckets->keys.template matrix<K>();
     const auto empty_key_flat = empty_key_.template flat<K>();
-    for (int64_t i = 0; i < num_buckets_; ++i) {
+    for (int64_t i = 0; i < new_num_buckets; ++i) {
       for (int64_t j = 0; j < key_size; ++j) {
         key_buckets_matrix(i, j) = empty_key_flat(j);
       }
@@ -819,25 +887,49 @@ class MutableDenseHashTable final : public LookupInterface {
     const int64_t value_size = value_shape_.num_elements();
 
     TF_RETURN_IF_ERROR(ctx->allocate_temp(
-        value_dtype(), TensorShape({num_buckets_, value_size}),
-        &value_buckets_));
-    auto value_buckets_matrix = value_buckets_.matrix<V>();
-    for (int64_t i = 0; i < num_buckets_; ++i) {
+        value_dtype(), TensorShape({new_num_buckets, value_size}),
+        &buckets->values));
+    auto value_buckets_matrix = buckets->values.template matrix<V>();
+    for (int64_t i = 0; i < new_num_buckets; ++i) {
       for (int64_t j = 0; j < value_size; ++j) {
         // Initialize values to the default value for the type to avoid
         // exposing uninitialized memory in ExportValues().
         value_buckets_matrix(i, j) = V();
       }
     }
+
+    TF_RETURN_IF_ERROR(ctx->allocate_temp(
+        DT_UINT8, TensorShape({new_num_buckets}), &buckets->tags));
+    buckets->tags.template flat<uint8>().setConstant(kEmptyBucket);
     return OkStatus();
   }
 
+  // Moves the table into `num_new_buckets` buckets. The current buckets are
+  // only read while the new ones are filled, so lookups are not blocked until
+  // the new buckets are swapped in.
   Status Rebucket(OpKernelContext* ctx, int64_t num_new_buckets)
-      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
-    Tensor old_key_buckets = key_buckets_;
-    Tensor old_value_buckets = value_buckets_;
-    TF_RETURN_IF_ERROR(AllocateBuckets(ctx, num_new_buckets));
-    return DoInsert(ctx, old_key_buckets, old_value_buckets, true);
+      TF_EXCLUSIVE_LOCKS_REQUIRED(writer_mu_) TF_LOCKS_EXCLUDED(mu_) {
+    Buckets new_buckets;
+    TF_RETURN_IF_ERROR(AllocateBuckets(ctx, num_new_buckets, &new_buckets));
+    {
+      tf_shared_lock l(mu_);
+      const Buckets& old_buckets = buckets_;
+      const auto key_buckets_matrix = old_buckets.keys.template matrix<K>();
+      const auto value_buckets_matrix =
+          old_buckets.values.template matrix<V>();
+      const auto tag_buckets = old_buckets.tags.template flat<uint8>();
+      for (int64_t i = 0; i < old_buckets.num_buckets; ++i) {
+        if (!IsFullBucket(tag_buckets(i))) {
+          continue;
+        }
+        TF_RETURN_IF_ERROR(InsertKey(key_buckets_matrix, value_buckets_matrix,
+                                     i, HashKey(key_buckets_matrix, i),
+                                     &new_buckets));
+      }
+    }
+    mutex_lock l(mu_);
+    buckets_ = std::move(new_buckets);
+    return OkStatus();
   }
 
   uint64 HashKey(typename TTypes<K>::ConstMatrix key, int64_t index) const {
@@ -853,9 +945,9 @@ class MutableDenseHashTable final : public LookupInterface {
 
   // Use a template to allow this function to be used both with Matrix and
   // ConstMatrix types.
-  template <typename MT2>
-  bool IsEqualKey(typename TTypes<K>::Matrix tensor1, int64_t index1,
-                  MT2 tensor2, int64_t index2) const {
+  template <typename MT1, typename MT2>
+  bool IsEqualKey(MT1 tensor1, int64_t index1, MT2 tensor2,
+                  int64_t index2) const {
     for (int64_t i = 0; i < key_shape_.num_elements(); ++i) {
       if (tensor1(index1, i) != tensor2(index2, i)) {
         return false;
@@ -867,17 +959,143 @@ class MutableDenseHashTable final : public LookupInterface {
   TensorShape key_shape_;
   TensorShape value_shape_;
   float max_load_factor_;
-  mutable mutex mu_;
-  int64_t num_entries_ TF_GUARDED_BY(mu_);
-  int64_t num_buckets_ TF_GUARDED_BY(mu_);
-  Tensor key_buckets_ TF_GUARDED_BY(mu_);
-  Tensor value_buckets_ TF_GUARDED_BY(mu_);
+  // Serializes Insert, Remove and ImportValues, which only hold mu_
+  // exclusively while they modify buckets_.
+  mutable mutex writer_mu_;
+  mutable mutex mu_ TF_ACQUIRED_AFTER(writer_mu_);
+  Buckets buckets_ TF_GUARDED_BY(mu_);
   Tensor empty_key_;
   uint64 empty_key_hash_;
   Tensor deleted_key_;
   uint64 deleted_key_hash_;
 };
 
+namespace {
+
+Status GetMappedKey(const MappedHashTableFile& file, int64_t index,
+                    int64_t* key) {
+  return file.GetKey(index, key);
+}
+
+Status GetMappedKey(const MappedHashTableFile& file, int64_t index,
+                    tstring* key) {
+  absl::string_view key_view;
+  TF_RETURN_IF_ERROR(file.GetKey(index, &key_view));
+  *key = key_view;
+  return OkStatus();
+}
+
+Status GetMappedValue(const MappedHashTableFile& file, int64_t index,
+                      int64_t* value) {
+  return file.GetValue(index, value);
+}
+
+Status GetMappedValue(const MappedHashTableFile& file, int64_t index,
+                      tstring* value) {
+  absl::string_view value_view;
+  TF_RETURN_IF_ERROR(file.GetValue(index, &value_view));
+  *value = value_view;
+  return OkStatus();
+}
+
+}  // namespace
+
+// Immutable lookup table backed by a memory mapped MappedHashTableFile, which
+// is built ahead of time with WriteMappedHashTableFile. Creating the table only
+// maps the file and validates its header, so it takes the same time whatever
+// the number of entries, and the pages of the file are shared by all the
+// tables and processes that map it.
+template <class K, class V>
+class MappedHashTable final : public LookupInterface {
+ public:
+  MappedHashTable(OpKernelContext* ctx, OpKernel* kernel) {
+    const Tensor* filename;
+    OP_REQUIRES_OK(ctx, ctx->input("filename", &filename));
+    OP_REQUIRES(
+        ctx, TensorShapeUtils::IsScalar(filename->shape()),
+        errors::InvalidArgument("filename should be a single string, but got ",
+                                filename->shape().DebugString()));
+    OP_REQUIRES_OK(ctx, MappedHashTableFile::Open(
+                            ctx->env(), filename->scalar<tstring>()(), &file_));
+    OP_REQUIRES(ctx,
+                file_->key_dtype() == key_dtype() &&
+                    file_->value_dtype() == value_dtype(),
+                errors::InvalidArgument(
+                    "Mapped hash table file ", filename->scalar<tstring>()(),
+                    " maps ", DataTypeString(file_->key_dtype()), " to ",
+                    DataTypeString(file_->value_dtype()), ", expected ",
+                    DataTypeString(key_dtype()), " to ",
+                    DataTypeString(value_dtype())));
+  }
+
+  size_t size() const override { return file_->size(); }
+
+  Status Find(OpKernelContext* ctx, const Tensor& key, Tensor* value,
+              const Tensor& default_value) override {
+    const auto key_values = key.flat<K>();
+    auto value_values = value->flat<V>();
+    const auto default_flat = default_value.flat<V>();
+    const bool is_full_size_default =
+        (value_values.size() == default_flat.size());
+
+    for (int64_t i = 0; i < key_values.size(); ++i) {
+      int64_t index;
+      TF_RETURN_IF_ERROR(
+          file_->Find(SubtleMustCopyIfIntegral(key_values(i)), &index));
+      if (index < 0) {
+        value_values(i) =
+            is_full_size_default ? default_flat(i) : default_flat(0);
+      } else {
+        TF_RETURN_IF_ERROR(GetMappedValue(*file_, index, &value_values(i)));
+      }
+    }
+    return OkStatus();
+  }
+
+  Status Insert(OpKernelContext* ctx, const Tensor& keys,
+                const Tensor& values) override {
+    return errors::Unimplemented("Insert not supported by MappedHashTable");
+  }
+
+  Status Remove(OpKernelContext* ctx, const Tensor& keys) override {
+    return errors::Unimplemented("Remove not supported by MappedHashTable");
+  }
+
+  Status ImportValues(OpKernelContext* ctx, const Tensor& keys,
+                      const Tensor& values) override {
+    return errors::Unimplemented(
+        "ImportValues not supported by MappedHashTable");
+  }
+
+  Status ExportValues(OpKernelContext* ctx) override {
+    const int64_t size = file_->size();
+    Tensor* keys;
+    Tensor* values;
+    TF_RETURN_IF_ERROR(
+        ctx->allocate_output("keys", TensorShape({size}), &keys));
+    TF_RETURN_IF_ERROR(
+        ctx->allocate_output("values", TensorShape({size}), &values));
+    auto keys_data = keys->flat<K>();
+    auto values_data = values->flat<V>();
+    for (int64_t i = 0; i < size; ++i) {
+      TF_RETURN_IF_ERROR(GetMappedKey(*file_, i, &keys_data(i)));
+      TF_RETURN_IF_ERROR(GetMappedValue(*file_, i, &values_data(i)));
+    }
+    return OkStatus();
+  }
+
+  DataType key_dtype() const override { return DataTypeToEnum<K>::v(); }
+
+  DataType value_dtype() const override { return DataTypeToEnum<V>::v(); }
+
+  TensorShape key_shape() const override { return TensorShape(); }
+
+  TensorShape value_shape() const override { return TensorShape(); }
+
+ private:
+  std::unique_ptr<MappedHashTableFile> file_;
+};
+
 }  // namespace lookup
 
 // Base class for kernels that take a LookupTable handle as the 0th input.
@@ -1076,6 +1294,26 @@ REGISTER_KERNEL_BUILDER(Name("LookupTableImport").Device(DEVICE_CPU),
 REGISTER_KERNEL_BUILDER(Name("LookupTableImportV2").Device(DEVICE_CPU),
                         LookupTableImportOp);
 
+// Op that writes keys and values to a file that MappedHashTable can map.
+class WriteMappedHashTableFileOp : public OpKernel {
+ public:
+  using OpKernel::OpKernel;
+
+  void Compute(OpKernelContext* ctx) override {
+    const Tensor& filename = ctx->input(0);
+    OP_REQUIRES(
+        ctx, TensorShapeUtils::IsScalar(filename.shape()),
+        errors::InvalidArgument("filename should be a single string, but got ",
+                                filename.shape().DebugString()));
+    OP_REQUIRES_OK(ctx, lookup::WriteMappedHashTableFile(
+                            ctx->env(), filename.scalar<tstring>()(),
+                            ctx->input(1), ctx->input(2)));
+  }
+};
+
+REGISTER_KERNEL_BUILDER(Name("WriteMappedHashTableFile").Device(DEVICE_CPU),
+                        WriteMappedHashTableFileOp);
+
 // Register the HashTable op with the currently supported key and value types.
 #define REGISTER_KERNEL(key_dtype, value_dtype)                           \
   REGISTER_KERNEL_BUILDER(                                                \
@@ -1244,4 +1482,21 @@ REGISTER_KERNEL(tstring, ResourceHandle);
 
 #undef REGISTER_KERNEL
 
+// Register the MappedHashTable op.
+#define REGISTER_KERNEL(key_dtype, value_dtype)                      \
+  REGISTER_KERNEL_BUILDER(                                           \
+      Name("MappedHashTable")                                        \
+          .Device(DEVICE_CPU)                                        \
+          .TypeConstraint<key_dtype>("key_dtype")                    \
+          .TypeConstraint<value_dtype>("value_dtype"),               \
+      LookupTableOp<lookup::MappedHashTable<key_dtype, value_dtype>, \
+                    key_dtype, value_dtype>)
+
+REGISTER_KERNEL(int64_t, int64_t);
+REGISTER_KERNEL(int64_t, tstring);
+REGISTER_KERNEL(tstring, int64_t);
+REGISTER_KERNEL(tstring, tstring);
+
+#undef REGISTER_KERNEL
+
 }  // namespace tensorflow
@@ -0,0 +1,331 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/mapped_hash_table_file.h"
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/platform/byte_order.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/fingerprint.h"
+
+namespace tensorflow {
+namespace lookup {
+namespace {
+
+constexpr char kMagic[8] = {'T', 'F', 'M', 'H', 'T', 'B', 'L', '1'};
+
+struct Header {
+  char magic[8];
+  uint32 key_dtype;
+  uint32 value_dtype;
+  uint64 num_entries;
+  uint64 num_buckets;
+};
+static_assert(sizeof(Header) == 32, "Unexpected mapped hash table header size");
+
+// Entries are stored as 1 + their index in a uint32 bucket.
+constexpr uint64 kMaxNumEntries = kuint32max - 1;
+
+bool IsSupportedDtype(DataType dtype) {
+  return dtype == DT_INT64 || dtype == DT_STRING;
+}
+
+uint64 PaddedSize(uint64 size) { return (size + 7) & ~uint64{7}; }
+
+uint64 HashKey(int64_t key) {
+  return Fingerprint64(
+      absl::string_view(reinterpret_cast<const char*>(&key), sizeof(key)));
+}
+
+uint64 HashKey(absl::string_view key) { return Fingerprint64(key); }
+
+Status CheckLittleEndian() {
+  if (!port::kLittleEndian) {
+    return errors::Unimplemented(
+        "Mapped hash table files are only supported on little-endian hosts.");
+  }
+  return OkStatus();
+}
+
+Status AppendPadding(uint64 size, WritableFile* file) {
+  static constexpr char kZeros[8] = {};
+  return file->Append(absl::string_view(kZeros, PaddedSize(size) - size));
+}
+
+Status AppendColumn(const Tensor& column, WritableFile* file) {
+  if (column.dtype() == DT_INT64) {
+    return file->Append(column.tensor_data());
+  }
+  const auto strings = column.flat<tstring>();
+  std::vector<uint64> offsets;
+  offsets.reserve(strings.size() + 1);
+  offsets.push_back(0);
+  for (int64_t i = 0; i < strings.size(); ++i) {
+    offsets.push_back(offsets.back() + strings(i).size());
+  }
+  TF_RETURN_IF_ERROR(file->Append(
+      absl::string_view(reinterpret_cast<const char*>(offsets.data()),
+                        offsets.size() * sizeof(uint64))));
+  for (int64_t i = 0; i < strings.size(); ++i) {
+    TF_RETURN_IF_ERROR(file->Append(strings(i)));
+  }
+  return AppendPadding(offsets.back(), file);
+}
+
+template <typename T>
+Status FillBuckets(const Tensor& keys, std::vector<uint32>* buckets) {
+  const auto keys_flat = keys.flat<T>();
+  for (int64_t i = 0; i < keys_flat.size(); ++i) {
+    uint64 bucket = HashKey(keys_flat(i)) % buckets->size();
+    while ((*buckets)[bucket] != 0) {
+      if (keys_flat((*buckets)[bucket] - 1) == keys_flat(i)) {
+        return errors::InvalidArgument(
+            "Mapped hash table has more than one value for key ",
+            keys_flat(i));
+      }
+      if (++bucket == buckets->size()) bucket = 0;
+    }
+    (*buckets)[bucket] = i + 1;
+  }
+  return OkStatus();
+}
+
+}  // namespace
+
+Status MappedHashTableFile::Open(Env* env, const std::string& filename,
+                                 std::unique_ptr<MappedHashTableFile>* file) {
+  TF_RETURN_IF_ERROR(CheckLittleEndian());
+  std::unique_ptr<ReadOnlyMemoryRegion> region;
+  TF_RETURN_IF_ERROR(env->NewReadOnlyMemoryRegionFromFile(filename, &region));
+  auto result = absl::WrapUnique(new MappedHashTableFile(std::move(region)));
+  TF_RETURN_IF_ERROR(result->Parse(filename));
+  *file = std::move(result);
+  return OkStatus();
+}
+
+Status MappedHashTableFile::Parse(const std::string& filename) {
+  const char* data = static_cast<const char*>(region_->data());
+  const uint64 length = region_->length();
+  Header header;
+  if (length < sizeof(header)) {
+    return errors::DataLoss(filename,
+                            " is too short to be a mapped hash table file.");
+  }
+  std::memcpy(&header, data, sizeof(header));
+  if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) {
+    return errors::DataLoss(filename, " is not a mapped hash table file.");
+  }
+  key_dtype_ = static_cast<DataType>(header.key_dtype);
+  value_dtype_ = static_cast<DataType>(header.value_dtype);
+  if (!IsSupportedDtype(key_dtype_) || !IsSupportedDtype(value_dtype_)) {
+    return errors::DataLoss(filename, " has unsupported key or value type ",
+                            header.key_dtype, " or ", header.value_dtype);
+  }
+  num_entries_ = header.num_entries;
+  num_buckets_ = header.num_buckets;
+  // Lookups stop at the first empty bucket, so there must be one.
+  if (num_entries_ > kMaxNumEntries || num_buckets_ <= num_entries_ ||
+      num_buckets_ > (length - sizeof(header)) / sizeof(uint32)) {
+    return errors::DataLoss(filename, " has ", num_entries_, " entries in ",
+                            num_buckets_, " buckets, which is invalid.");
+  }
+
+  uint64 offset = sizeof(header);
+  buckets_ = reinterpret_cast<const uint32*>(data + offset);
+  offset += PaddedSize(num_buckets_ * sizeof(uint32));
+  if (offset > length) {
+    return errors::DataLoss(filename, " is truncated.");
+  }
+  TF_RETURN_IF_ERROR(ParseColumn(filename, key_dtype_, &offset, &keys_));
+  TF_RETURN_IF_ERROR(ParseColumn(filename, value_dtype_, &offset, &values_));
+  if (offset != length) {
+    return errors::DataLoss(filename, " has ", length - offset,
+                            " unexpected trailing bytes.");
+  }
+  return OkStatus();
+}
+
+Status MappedHashTableFile::ParseColumn(const std::string& filename,
+                                        DataType dtype, uint64* offset,
+                                        Column* column) {
+  const char* data = static_cast<const char*>(region_->data());
+  const uint64 length = region_->length();
+  column->dtype = dtype;
+  column->data = data + *offset;
+  if (dtype == DT_INT64) {
+    const uint64 size = num_entries_ * sizeof(int64_t);
+    if (size > length - *offset) {
+      return errors::DataLoss(filename, " is truncated.");
+    }
+    *offset += size;
+    return OkStatus();
+  }
+
+  const uint64 size = (num_entries_ + 1) * sizeof(uint64);
+  if (size > length - *offset) {
+    return errors::DataLoss(filename, " is truncated.");
+  }
+  std::memcpy(&column->bytes_size, data + *offset + size - sizeof(uint64),
+              sizeof(uint64));
+  *offset += size;
+  if (column->bytes_size > length - *offset) {
+    return errors::DataLoss(filename, " is truncated.");
+  }
+  column->bytes = data + *offset;
+  *offset += PaddedSize(column->bytes_size);
+  if (*offset > length) {
+    return errors::DataLoss(filename, " is truncated.");
+  }
+  return OkStatus();
+}
+
+template <typename T>
+Status MappedHashTableFile::FindImpl(T key, int64_t* index) const {
+  uint64 bucket = HashKey(key) % num_buckets_;
+  for (uint64 probes = 0; probes < num_buckets_; ++probes) {
+    const uint32 entry = buckets_[bucket];
+    if (entry == 0) break;
+    if (entry > num_entries_) {
+      return errors::DataLoss("Mapped hash table has a bucket with entry ",
+                              entry - 1, " out of ", num_entries_);
+    }
+    T entry_key;
+    TF_RETURN_IF_ERROR(Get(keys_, entry - 1, &entry_key));
+    if (entry_key == key) {
+      *index = entry - 1;
+      return OkStatus();
+    }
+    if (++bucket == num_buckets_) bucket = 0;
+  }
+  *index = -1;
+  return OkStatus();
+}
+
+Status MappedHashTableFile::Find(int64_t key, int64_t* index) const {
+  return FindImpl(key, index);
+}
+
+Status MappedHashTableFile::Find(absl::string_view key, int64_t* index) const {
+  return FindImpl(key, index);
+}
+
+Status MappedHashTableFile::GetKey(int64_t index, int64_t* key) const {
+  return Get(keys_, index, key);
+}
+
+Status MappedHashTableFile::GetKey(int64_t index,
+                                   absl::string_view* key) const {
+  return Get(keys_, index, key);
+}
+
+Status MappedHashTableFile::GetValue(int64_t index, int64_t* value) const {
+  return Get(values_, index, value);
+}
+
+Status MappedHashTableFile::GetValue(int64_t index,
+                                     absl::string_view* value) const {
+  return Get(values_, index, value);
+}
+
+Status MappedHashTableFile::Get(const Column& column, int64_t index,
+                                int64_t* out) {
+  if (column.dtype != DT_INT64) {
+    return errors::InvalidArgument("Expected ", DataTypeString(column.dtype),
+                                   ", got int64");
+  }
+  std::memcpy(out, column.data + index * sizeof(int64_t), sizeof(int64_t));
+  return OkStatus();
+}
+
+Status MappedHashTableFile::Get(const Column& column, int64_t index,
+                                absl::string_view* out) {
+  if (column.dtype != DT_STRING) {
+    return errors::InvalidArgument("Expected ", DataTypeString(column.dtype),
+                                   ", got string");
+  }
+  uint64 offsets[2];
+  std::memcpy(offsets, column.data + index * sizeof(uint64), sizeof(offsets));
+  if (offsets[0] > offsets[1] || offsets[1] > column.bytes_size) {
+    return errors::DataLoss("Mapped hash table has invalid offsets [",
+                            offsets[0], ", ", offsets[1], ") for entry ",
+                            index);
+  }
+  *out = absl::string_view(column.bytes + offsets[0], offsets[1] - offsets[0]);
+  return OkStatus();
+}
+
+Status WriteMappedHashTableFile(Env* env, const std::string& filename,
+                                const Tensor& keys, const Tensor& values) {
+  TF_RETURN_IF_ERROR(CheckLittleEndian());
+  if (!IsSupportedDtype(keys.dtype()) || !IsSupportedDtype(values.dtype())) {
+    return errors::InvalidArgument(
+        "Mapped hash tables only support int64 and string keys and values, "
+        "got ",
+        DataTypeString(keys.dtype()), " and ", DataTypeString(values.dtype()));
+  }
+  if (!TensorShapeUtils::IsVector(keys.shape()) ||
+      !TensorShapeUtils::IsVector(values.shape()) ||
+      keys.NumElements() != values.NumElements()) {
+    return errors::InvalidArgument(
+        "Keys and values must be vectors of the same size, got shapes ",
+        keys.shape().DebugString(), " and ", values.shape().DebugString());
+  }
+  const uint64 num_entries = keys.NumElements();
+  if (num_entries > kMaxNumEntries) {
+    return errors::InvalidArgument("Mapped hash tables support at most ",
+                                   kMaxNumEntries, " entries, got ",
+                                   num_entries);
+  }
+
+  // A load factor of 1/2 keeps the linear probing sequences short.
+  std::vector<uint32> buckets(2 * num_entries + 1, 0);
+  if (keys.dtype() == DT_INT64) {
+    TF_RETURN_IF_ERROR(FillBuckets<int64_t>(keys, &buckets));
+  } else {
+    TF_RETURN_IF_ERROR(FillBuckets<tstring>(keys, &buckets));
+  }
+
+  Header header;
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.key_dtype = keys.dtype();
+  header.value_dtype = values.dtype();
+  header.num_entries = num_entries;
+  header.num_buckets = buckets.size();
+
+  const std::string tmp_filename = absl::StrCat(filename, ".tmp");
+  std::unique_ptr<WritableFile> file;
+  TF_RETURN_IF_ERROR(env->NewWritableFile(tmp_filename, &file));
+  TF_RETURN_IF_ERROR(file->Append(
+      absl::string_view(reinterpret_cast<const char*>(&header),
+                        sizeof(header))));
+  const uint64 buckets_size = buckets.size() * sizeof(uint32);
+  TF_RETURN_IF_ERROR(file->Append(absl::string_view(
+      reinterpret_cast<const char*>(buckets.data()), buckets_size)));
+  TF_RETURN_IF_ERROR(AppendPadding(buckets_size, file.get()));
+  TF_RETURN_IF_ERROR(AppendColumn(keys, file.get()));
+  TF_RETURN_IF_ERROR(AppendColumn(values, file.get()));
+  TF_RETURN_IF_ERROR(file->Close());
+  return env->RenameFile(tmp_filename, filename);
+}
+
+}  // namespace lookup
+}  // namespace tensorflow
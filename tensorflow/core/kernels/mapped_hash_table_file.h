@@ -0,0 +1,114 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_MAPPED_HASH_TABLE_FILE_H_
+#define TENSORFLOW_CORE_KERNELS_MAPPED_HASH_TABLE_FILE_H_
+
+#include <memory>
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/status.h"
+
+namespace tensorflow {
+namespace lookup {
+
+// A prebuilt, immutable hash table file that is memory mapped instead of being
+// parsed into memory, so that loading it is independent of its size and its
+// pages are shared by all the processes mapping it.
+//
+// Keys and values are int64 or string scalars. All integers are little-endian
+// and every section starts at a multiple of 8 bytes:
+//
+//   Header: magic, key and value DataType, number of entries and of buckets.
+//   uint32 buckets[num_buckets]: 1 + the index of the entry in the bucket, or 0
+//     for an empty bucket. Entries are placed by linear probing starting at
+//     Fingerprint64(key) % num_buckets.
+//   Keys, then values, of the entries: int64 data[num_entries] for int64, or
+//     uint64 offsets[num_entries + 1] followed by the bytes they delimit for
+//     strings.
+class MappedHashTableFile {
+ public:
+  // Maps `filename`, which must have been written by WriteMappedHashTableFile.
+  // Only the header and the section sizes are validated here; the offsets read
+  // by lookups are validated when they are used.
+  static Status Open(Env* env, const std::string& filename,
+                     std::unique_ptr<MappedHashTableFile>* file);
+
+  DataType key_dtype() const { return key_dtype_; }
+  DataType value_dtype() const { return value_dtype_; }
+  uint64 size() const { return num_entries_; }
+
+  // Sets `*index` to the index of the entry with `key`, or to -1 if there is
+  // none. Returns InvalidArgument if `key` is not of the key type.
+  Status Find(int64_t key, int64_t* index) const;
+  Status Find(absl::string_view key, int64_t* index) const;
+
+  // Gets the key and the value of the entry at `index`, which must be in
+  // [0, size()). Returns InvalidArgument if the output is not of their type.
+  Status GetKey(int64_t index, int64_t* key) const;
+  Status GetKey(int64_t index, absl::string_view* key) const;
+  Status GetValue(int64_t index, int64_t* value) const;
+  Status GetValue(int64_t index, absl::string_view* value) const;
+
+ private:
+  // The keys or values of the entries.
+  struct Column {
+    DataType dtype = DT_INVALID;
+    // The int64 data, or the uint64 offsets of the strings.
+    const char* data = nullptr;
+    // The bytes of the strings.
+    const char* bytes = nullptr;
+    uint64 bytes_size = 0;
+  };
+
+  explicit MappedHashTableFile(std::unique_ptr<ReadOnlyMemoryRegion> region)
+      : region_(std::move(region)) {}
+
+  Status Parse(const std::string& filename);
+  Status ParseColumn(const std::string& filename, DataType dtype,
+                     uint64* offset, Column* column);
+
+  template <typename T>
+  Status FindImpl(T key, int64_t* index) const;
+
+  static Status Get(const Column& column, int64_t index, int64_t* out);
+  static Status Get(const Column& column, int64_t index,
+                    absl::string_view* out);
+
+  std::unique_ptr<ReadOnlyMemoryRegion> region_;
+  DataType key_dtype_ = DT_INVALID;
+  DataType value_dtype_ = DT_INVALID;
+  uint64 num_entries_ = 0;
+  uint64 num_buckets_ = 0;
+  const uint32* buckets_ = nullptr;
+  Column keys_;
+  Column values_;
+};
+
+// Writes the entries of the `keys` and `values` vectors, which must be int64 or
+// string, to `filename` in the MappedHashTableFile format. The file is written
+// next to `filename` and then renamed, so that readers never map a partially
+// written file. Returns InvalidArgument if a key is duplicated.
+Status WriteMappedHashTableFile(Env* env, const std::string& filename,
+                                const Tensor& keys, const Tensor& values);
+
+}  // namespace lookup
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_MAPPED_HASH_TABLE_FILE_H_
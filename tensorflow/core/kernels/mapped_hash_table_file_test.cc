@@ -0,0 +1,139 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/mapped_hash_table_file.h"
+
+#include <memory>
+#include <string>
+
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace lookup {
+namespace {
+
+std::string TestFilename(const std::string& name) {
+  return io::JoinPath(testing::TmpDir(), name);
+}
+
+TEST(MappedHashTableFileTest, StringToInt64) {
+  const std::string filename = TestFilename("string_to_int64");
+  Env* env = Env::Default();
+  TF_ASSERT_OK(WriteMappedHashTableFile(
+      env, filename, test::AsTensor<tstring>({"brain", "", "salad"}),
+      test::AsTensor<int64_t>({0, 1, 2})));
+
+  std::unique_ptr<MappedHashTableFile> file;
+  TF_ASSERT_OK(MappedHashTableFile::Open(env, filename, &file));
+  EXPECT_EQ(file->key_dtype(), DT_STRING);
+  EXPECT_EQ(file->value_dtype(), DT_INT64);
+  EXPECT_EQ(file->size(), 3);
+
+  int64_t index;
+  int64_t value;
+  TF_ASSERT_OK(file->Find(absl::string_view("salad"), &index));
+  ASSERT_EQ(index, 2);
+  TF_ASSERT_OK(file->GetValue(index, &value));
+  EXPECT_EQ(value, 2);
+  TF_ASSERT_OK(file->Find(absl::string_view(""), &index));
+  ASSERT_EQ(index, 1);
+  TF_ASSERT_OK(file->GetValue(index, &value));
+  EXPECT_EQ(value, 1);
+  TF_ASSERT_OK(file->Find(absl::string_view("surgery"), &index));
+  EXPECT_EQ(index, -1);
+
+  EXPECT_TRUE(errors::IsInvalidArgument(file->Find(int64_t{0}, &index)));
+}
+
+TEST(MappedHashTableFileTest, Int64ToString) {
+  const std::string filename = TestFilename("int64_to_string");
+  Env* env = Env::Default();
+  Tensor keys(DT_INT64, TensorShape({1000}));
+  Tensor values(DT_STRING, TensorShape({1000}));
+  for (int i = 0; i < 1000; ++i) {
+    keys.flat<int64_t>()(i) = i * 7919;
+    values.flat<tstring>()(i) = std::string(i % 10, 'a' + i % 26);
+  }
+  TF_ASSERT_OK(WriteMappedHashTableFile(env, filename, keys, values));
+
+  std::unique_ptr<MappedHashTableFile> file;
+  TF_ASSERT_OK(MappedHashTableFile::Open(env, filename, &file));
+  ASSERT_EQ(file->size(), 1000);
+  for (int i = 0; i < 1000; ++i) {
+    int64_t index;
+    TF_ASSERT_OK(file->Find(int64_t{i * 7919}, &index));
+    ASSERT_EQ(index, i);
+    int64_t key;
+    TF_ASSERT_OK(file->GetKey(index, &key));
+    EXPECT_EQ(key, i * 7919);
+    absl::string_view value;
+    TF_ASSERT_OK(file->GetValue(index, &value));
+    EXPECT_EQ(value, values.flat<tstring>()(i));
+  }
+  int64_t index;
+  TF_ASSERT_OK(file->Find(int64_t{1}, &index));
+  EXPECT_EQ(index, -1);
+}
+
+TEST(MappedHashTableFileTest, Empty) {
+  const std::string filename = TestFilename("empty");
+  Env* env = Env::Default();
+  TF_ASSERT_OK(WriteMappedHashTableFile(env, filename,
+                                        Tensor(DT_INT64, TensorShape({0})),
+                                        Tensor(DT_INT64, TensorShape({0}))));
+
+  std::unique_ptr<MappedHashTableFile> file;
+  TF_ASSERT_OK(MappedHashTableFile::Open(env, filename, &file));
+  EXPECT_EQ(file->size(), 0);
+  int64_t index;
+  TF_ASSERT_OK(file->Find(int64_t{0}, &index));
+  EXPECT_EQ(index, -1);
+}
+
+TEST(MappedHashTableFileTest, DuplicateKey) {
+  EXPECT_TRUE(errors::IsInvalidArgument(WriteMappedHashTableFile(
+      Env::Default(), TestFilename("duplicate_key"),
+      test::AsTensor<int64_t>({1, 2, 1}), test::AsTensor<int64_t>({0, 1, 2}))));
+}
+
+TEST(MappedHashTableFileTest, CorruptedFile) {
+  const std::string filename = TestFilename("corrupted");
+  Env* env = Env::Default();
+  TF_ASSERT_OK(WriteMappedHashTableFile(env, filename,
+                                        test::AsTensor<int64_t>({1, 2}),
+                                        test::AsTensor<int64_t>({3, 4})));
+  std::string contents;
+  TF_ASSERT_OK(ReadFileToString(env, filename, &contents));
+
+  std::unique_ptr<MappedHashTableFile> file;
+  TF_ASSERT_OK(WriteStringToFile(env, filename,
+                                 contents.substr(0, contents.size() - 8)));
+  EXPECT_TRUE(
+      errors::IsDataLoss(MappedHashTableFile::Open(env, filename, &file)));
+
+  contents[0] = 'X';
+  TF_ASSERT_OK(WriteStringToFile(env, filename, contents));
+  EXPECT_TRUE(
+      errors::IsDataLoss(MappedHashTableFile::Open(env, filename, &file)));
+}
+
+}  // namespace
+}  // namespace lookup
+}  // namespace tensorflow
@@ -1404,6 +1404,7 @@ class MklConvOp : public OpKernel {
 #endif  // ENABLE_ONEDNN_V3
 
     // Otherwise, cache reordered filter
+    const uint64 start_time_usecs = Env::Default()->NowMicros();
     filter.SetUsrMem(filter_md, &filter_tensor);
     filter.CheckReorderToOpMem(conv_fwd_pd.get()->weights_desc(),
                                this->cpu_engine_, context);
@@ -1415,6 +1416,8 @@ class MklConvOp : public OpKernel {
     void* cached_filter_data = filter.GetTensorBuffer(filter_tensor_ptr);
     size_t cached_filter_data_size = filter.GetOpMem().get_desc().get_size();
     memcpy(cached_filter_data, filter_data, cached_filter_data_size);
+    metrics::UpdateMklWeightReorderTime(Env::Default()->NowMicros() -
+                                        start_time_usecs);
   }
 
 #ifndef ENABLE_ONEDNN_V3
@@ -607,6 +607,7 @@ class MklDnnMatMulOpBase : public OpKernel {
     }
 
     // reorder and cache the weight
+    const uint64 start_time_usecs = Env::Default()->NowMicros();
     weight.SetUsrMem(weight_md, &weight_tensor);
     weight.CheckReorderToOpMem(matmul_fwd_pd.get()->weights_desc(), cpu_engine_,
                                context);
@@ -633,6 +634,8 @@ class MklDnnMatMulOpBase : public OpKernel {
                                           weight_mkl_format, &weight_oi_md_));
     *reinterpret_cast<memory::desc*>(weight_oi_md_.flat<Tweight>().data()) =
         expected_md;
+    metrics::UpdateMklWeightReorderTime(Env::Default()->NowMicros() -
+                                        start_time_usecs);
   }
 
   Tweight* GetCachedWeight(OpKernelContext* context,
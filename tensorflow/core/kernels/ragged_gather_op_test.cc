@@ -175,6 +175,43 @@ TEST_F(RaggedGatherOpTest, RaggedGather_ScalarIndices) {
                                 test::AsTensor<float>({.4, .5, .6, .7}), 0.1);
 }
 
+TEST_F(RaggedGatherOpTest, RaggedGather_ManyRows) {
+  // params[i] = [i, i + 1, ..., 2 * i - 1], with 2D values of size 2.
+  // indices = [N - 1, N - 2, ..., 0]
+  constexpr int kNumRows = 1000;
+  std::vector<int64_t> splits = {0};
+  std::vector<int32> values;
+  for (int i = 0; i < kNumRows; ++i) {
+    splits.push_back(splits.back() + i);
+    for (int j = 0; j < i; ++j) {
+      values.push_back(i + j);
+      values.push_back(-(i + j));
+    }
+  }
+  std::vector<int32> indices;
+  for (int i = kNumRows - 1; i >= 0; --i) indices.push_back(i);
+  const int64_t num_values = splits.back();
+  BuildRaggedGatherGraph<int32, int32>(TensorShape({kNumRows}), indices,
+                                       {splits}, TensorShape({num_values, 2}),
+                                       values);
+  TF_ASSERT_OK(RunOpKernel());
+
+  std::vector<int64_t> expected_splits = {0};
+  std::vector<int32> expected_values;
+  for (int i : indices) {
+    expected_splits.push_back(expected_splits.back() + i);
+    for (int j = 0; j < i; ++j) {
+      expected_values.push_back(i + j);
+      expected_values.push_back(-(i + j));
+    }
+  }
+  test::ExpectTensorEqual<int64_t>(*GetOutput(0),
+                                   test::AsTensor<int64_t>(expected_splits));
+  test::ExpectTensorEqual<int32>(
+      *GetOutput(1), test::AsTensor<int32>(expected_values,
+                                           TensorShape({num_values, 2})));
+}
+
 TEST_F(RaggedGatherOpTest, RaggedGather_OutOfBounds) {
   // indices = [2, 10]
   // params = [[.1, .2, .3], [], [.4, .5, .6, .7], [.8, .9]]
@@ -36,8 +36,8 @@ limitations under the License.
 #include <algorithm>
 #include <array>
 #include <bitset>
-#include <cmath>
 
+#include "absl/numeric/bits.h"
 #include "tensorflow/core/platform/types.h"
 
 namespace tensorflow {
@@ -121,8 +121,9 @@ uint64_t index_shuffle(const uint64_t index, const std::array<uint32_t, 3>& key,
                        const uint64_t max_index, const int32_t rounds) {
   // Block size must be large enough to represent max_index and even (since
   // word size is half of it). We force at least 16 bits as minimum block size
-  // since we observed pattern in the permutations below.
-  int block_size = static_cast<int>(std::ceil(std::log2(max_index)));
+  // since we observed pattern in the permutations below. The block must hold
+  // `max_index` itself, so powers of two need one more bit than their log2.
+  int block_size = absl::bit_width(max_index);
   block_size = std::max(block_size + block_size % 2, kMinBlockSize);
   assert(block_size > 0 && block_size % 2 == 0 && block_size <= 64);
   // At least 4 rounds and number of rounds must be even.
@@ -21,6 +21,7 @@ limitations under the License.
 #include <algorithm>
 #include <cmath>
 #include <memory>
+#include <type_traits>
 
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
@@ -51,6 +52,7 @@ typedef Eigen::ThreadPoolDevice CPUDevice;
 typedef Eigen::GpuDevice GPUDevice;
 
 namespace functor {
+using random::BatchedPhiloxRandom;
 using random::PhiloxRandom;
 using random::SingleSampleAdapter;
 
@@ -83,15 +85,28 @@ struct FillPhiloxRandomTask<Distribution, false> {
   typedef typename Distribution::ResultElementType T;
   static void Run(random::PhiloxRandom gen, T* data, int64_t size,
                   int64_t start_group, int64_t limit_group, Distribution dist) {
-    const int kGroupSize = Distribution::kResultElementCount;
-
     gen.Skip(start_group);
+    // Distributions that accept any generator draw their samples from batches
+    // of Philox results, which is bit-identical but vectorizes.
+    if constexpr (std::is_invocable_v<Distribution&, BatchedPhiloxRandom*>) {
+      BatchedPhiloxRandom batched_gen(gen);
+      Fill(&batched_gen, data, size, start_group, limit_group, &dist);
+    } else {
+      Fill(&gen, data, size, start_group, limit_group, &dist);
+    }
+  }
+
+ private:
+  template <class Generator>
+  static void Fill(Generator* gen, T* data, int64_t size, int64_t start_group,
+                   int64_t limit_group, Distribution* dist) {
+    const int kGroupSize = Distribution::kResultElementCount;
     int64_t offset = start_group * kGroupSize;
 
     // First fill all the full-size groups
     int64_t limit_group_full = std::min(limit_group, size / kGroupSize);
     for (int64_t index = start_group; index < limit_group_full; ++index) {
-      auto samples = dist(&gen);
+      auto samples = (*dist)(gen);
       std::copy(&samples[0], &samples[0] + kGroupSize, data + offset);
       offset += kGroupSize;
     }
@@ -99,7 +114,7 @@ struct FillPhiloxRandomTask<Distribution, false> {
     // If there are any remaining elements that need to be filled, process them
     if (limit_group_full < limit_group) {
       int64_t remaining_size = size - limit_group_full * kGroupSize;
-      auto samples = dist(&gen);
+      auto samples = (*dist)(gen);
       std::copy(&samples[0], &samples[0] + remaining_size, data + offset);
     }
   }
@@ -54,6 +54,7 @@ limitations under the License.
 #endif
 
 #include <memory>
+#include <optional>
 #include <type_traits>
 #include <vector>
 
@@ -234,6 +235,11 @@ VarHandleOp::VarHandleOp(OpKernelConstruction* context) : OpKernel(context) {
 
   OP_REQUIRES_OK(context, context->GetAttr("dtype", &dtype_and_shape_.dtype));
   OP_REQUIRES_OK(context, context->GetAttr("shape", &dtype_and_shape_.shape));
+  // Internal attribute that marks the anonymous variables created by this op
+  // as read-mostly, see Var. Named variables are marked by the
+  // AssignVariableOp that creates them.
+  read_mostly_ = false;
+  TryGetNodeAttr(context->def(), "_read_mostly", &read_mostly_);
 
   is_anonymous_ = name_ == ResourceHandle::ANONYMOUS_NAME;
 
@@ -252,6 +258,7 @@ VarHandleOp::VarHandleOp(OpKernelConstruction* context) : OpKernel(context) {
 void VarHandleOp::Compute(OpKernelContext* ctx) {
   if (is_anonymous_) {
     Var* resource = new Var(dtype_and_shape_.dtype);
+    resource->read_mostly.store(read_mostly_);
     ResourceMgr* mgr = ctx->resource_manager();
     ResourceHandle handle = ResourceHandle::MakeRefCountingHandle<Var>(
         resource, ctx->device()->name(),
@@ -395,6 +402,9 @@ class AssignVariableOp : public OpKernel {
     if (c->HasAttr("validate_shape")) {
       OP_REQUIRES_OK(c, c->GetAttr("validate_shape", &validate_shape_));
     }
+    // Internal attribute that marks the variable as read-mostly when this op
+    // creates it, see Var.
+    TryGetNodeAttr(c->def(), "_read_mostly", &read_mostly_);
   }
 
   void Compute(OpKernelContext* context) override {
@@ -419,6 +429,7 @@ class AssignVariableOp : public OpKernel {
                                   *ptr = new Var(dtype_);
                                   *(*ptr)->tensor() = value;
                                   (*ptr)->is_initialized = true;
+                                  (*ptr)->read_mostly.store(read_mostly_);
                                   return OkStatus();
                                 }));
     mutex_lock ml(*variable->mu());
@@ -468,6 +479,7 @@ class AssignVariableOp : public OpKernel {
   DataType dtype_;
   bool relax_constraints_;
   bool validate_shape_ = false;
+  bool read_mostly_ = false;
 };
 
 template <typename Device>
@@ -679,14 +691,17 @@ class ResourceGatherOp : public OpKernel {
   void Compute(OpKernelContext* c) override {
     core::RefCountPtr<Var> v;
     OP_REQUIRES_OK(c, LookupResource(c, HandleFromInput(c, 0), &v));
-    OP_REQUIRES_OK(c, EnsureSparseVariableAccess<Device, T>(c, v.get()));
-    // NOTE: We hold the lock for the whole gather operation instead
-    // of increasing the reference count of v->tensor() to avoid a
-    // situation where a write to the same variable will see a
-    // reference count greater than one and make a copy of the
+    // NOTE: Unless the variable is read-mostly, we hold the lock for the
+    // whole gather operation instead of increasing the reference count of
+    // v->tensor() to avoid a situation where a write to the same variable
+    // will see a reference count greater than one and make a copy of the
     // (potentially very large) tensor buffer.
-    tf_shared_lock ml(*v->mu());
-    const Tensor& params = *v->tensor();
+    std::optional<tf_shared_lock> ml;
+    Tensor snapshot;
+    const Tensor* params_ptr;
+    OP_REQUIRES_OK(c, PrepareSparseVariableRead<Device, T>(
+                          c, v.get(), &ml, &snapshot, &params_ptr));
+    const Tensor& params = *params_ptr;
     const Tensor& indices = c->input(1);
     OP_REQUIRES(
         c, TensorShapeUtils::IsVectorOrHigher(params.shape()),
@@ -32,6 +32,7 @@ class VarHandleOp : public OpKernel {
  private:
   // Same fields as in ResourceHandleOp.
   bool is_anonymous_;
+  bool read_mostly_;
   string container_;
   string name_;
   Tensor const_tensor_;
@@ -0,0 +1,159 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/device_mgr.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/framework/resource_var.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/public/session.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr int kRows = 64;
+constexpr int kCols = 1024;
+
+// A session holding a [kRows, kCols] float variable "v" initialized to ones,
+// with a gather of all of its rows and dense in-place updates that add and
+// subtract ones.
+class ReadMostlyVariableTest : public ::testing::Test {
+ protected:
+  void CreateSession(bool read_mostly) {
+    Graph g(OpRegistry::Global());
+    Node* var;
+    TF_ASSERT_OK(NodeBuilder("v", "VarHandleOp")
+                     .Attr("dtype", DT_FLOAT)
+                     .Attr("shape", TensorShape({kRows, kCols}))
+                     .Attr("shared_name", "v")
+                     .Finalize(&g, &var));
+    Tensor ones(DT_FLOAT, TensorShape({kRows, kCols}));
+    ones.flat<float>().setConstant(1.0f);
+    Node* value = test::graph::Constant(&g, ones);
+    Node* node;
+    TF_ASSERT_OK(NodeBuilder("init", "AssignVariableOp")
+                     .Input(var)
+                     .Input(value)
+                     .Attr("dtype", DT_FLOAT)
+                     .Attr("_read_mostly", read_mostly)
+                     .Finalize(&g, &node));
+    TF_ASSERT_OK(NodeBuilder("add", "AssignAddVariableOp")
+                     .Input(var)
+                     .Input(value)
+                     .Attr("dtype", DT_FLOAT)
+                     .Finalize(&g, &node));
+    TF_ASSERT_OK(NodeBuilder("sub", "AssignSubVariableOp")
+                     .Input(var)
+                     .Input(value)
+                     .Attr("dtype", DT_FLOAT)
+                     .Finalize(&g, &node));
+    Tensor indices(DT_INT32, TensorShape({kRows}));
+    for (int i = 0; i < kRows; ++i) indices.vec<int32>()(i) = i;
+    TF_ASSERT_OK(NodeBuilder("gather", "ResourceGather")
+                     .Input(var)
+                     .Input(test::graph::Constant(&g, indices))
+                     .Attr("dtype", DT_FLOAT)
+                     .Finalize(&g, &node));
+    GraphDef gd;
+    g.ToGraphDef(&gd);
+
+    SessionOptions options;
+    options.config.set_inter_op_parallelism_threads(4);
+    session_.reset(NewSession(options));
+    TF_ASSERT_OK(session_->Create(gd));
+    TF_ASSERT_OK(session_->Run({}, {}, {"init"}, nullptr));
+  }
+
+  // Returns the variable created by the session.
+  core::RefCountPtr<Var> LookupVariable() {
+    const DeviceMgr* device_mgr;
+    TF_CHECK_OK(session_->LocalDeviceManager(&device_mgr));
+    ResourceMgr* rm = device_mgr->ListDevices()[0]->resource_manager();
+    Var* variable;
+    TF_CHECK_OK(rm->Lookup<Var>(rm->default_container(), "v", &variable));
+    return core::RefCountPtr<Var>(variable);
+  }
+
+  std::unique_ptr<Session> session_;
+};
+
+TEST_F(ReadMostlyVariableTest, GatherKeepsCopyOnWriteMode) {
+  CreateSession(/*read_mostly=*/true);
+  EXPECT_TRUE(LookupVariable()->read_mostly.load());
+
+  std::vector<Tensor> outputs;
+  TF_ASSERT_OK(session_->Run({}, {"gather"}, {}, &outputs));
+  Tensor expected(DT_FLOAT, TensorShape({kRows, kCols}));
+  expected.flat<float>().setConstant(1.0f);
+  test::ExpectTensorEqual<float>(outputs[0], expected);
+  TF_ASSERT_OK(session_->Run({}, {}, {"add"}, nullptr));
+  EXPECT_FALSE(LookupVariable()->copy_on_read_mode.load());
+}
+
+TEST_F(ReadMostlyVariableTest, GatherSwitchesOtherVariablesToCopyOnRead) {
+  CreateSession(/*read_mostly=*/false);
+  EXPECT_FALSE(LookupVariable()->read_mostly.load());
+
+  TF_ASSERT_OK(session_->Run({}, {}, {"gather"}, nullptr));
+  EXPECT_TRUE(LookupVariable()->copy_on_read_mode.load());
+}
+
+TEST_F(ReadMostlyVariableTest, ConcurrentWritesDoNotChangeGatheredSnapshot) {
+  CreateSession(/*read_mostly=*/true);
+
+  // The variable is uniformly one or two between the updates, so every gather
+  // must see a uniform snapshot even though it does not hold the lock while
+  // it copies the rows.
+  constexpr int kReaders = 4;
+  constexpr int kIterations = 200;
+  {
+    thread::ThreadPool pool(Env::Default(), "test", kReaders + 1);
+    pool.Schedule([this]() {
+      for (int i = 0; i < kIterations; ++i) {
+        TF_ASSERT_OK(session_->Run({}, {}, {"add"}, nullptr));
+        TF_ASSERT_OK(session_->Run({}, {}, {"sub"}, nullptr));
+      }
+    });
+    for (int r = 0; r < kReaders; ++r) {
+      pool.Schedule([this]() {
+        for (int i = 0; i < kIterations; ++i) {
+          std::vector<Tensor> outputs;
+          TF_ASSERT_OK(session_->Run({}, {"gather"}, {}, &outputs));
+          auto rows = outputs[0].flat<float>();
+          const float first = rows(0);
+          ASSERT_TRUE(first == 1.0f || first == 2.0f) << first;
+          for (int k = 1; k < rows.size(); ++k) {
+            ASSERT_EQ(rows(k), first) << "at element " << k;
+          }
+        }
+      });
+    }
+  }
+  EXPECT_FALSE(LookupVariable()->copy_on_read_mode.load());
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -33,6 +33,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 #include "tensorflow/core/util/tensor_slice_reader.h"
 #include "tensorflow/core/util/tensor_slice_reader_cache.h"
@@ -257,12 +258,13 @@ const int64_t kLargeShapeThreshold = 16 << 20;  // 16M
 struct RestoreOp {
   RestoreOp(OpKernelContext* context, int idx, const string& tensor_name,
             const string& shape_and_slice, const string& reader_prefix,
-            DataType dtype)
+            const BundleReader::Options& reader_options, DataType dtype)
       : context(context),
         idx(idx),
         tensor_name(tensor_name),
         shape_and_slice(shape_and_slice),
         reader_prefix(reader_prefix),
+        reader_options(reader_options),
         dtype(dtype) {}
 
   // Move-only. It does not make sense to "run()" a copied RestoreOp.
@@ -284,7 +286,7 @@ struct RestoreOp {
 
   // Run this restore operation using a new BundleReader.
   void run_with_new_reader() {
-    BundleReader reader(Env::Default(), reader_prefix);
+    BundleReader reader(Env::Default(), reader_prefix, reader_options);
     if (!reader.status().ok()) {
       status = reader.status();
       return;
@@ -301,7 +303,14 @@ struct RestoreOp {
     VLOG(1) << "Restoring tensor " << idx << " : " << tensor_name << " : "
             << restored_full_shape.num_elements();
     Tensor* restored_tensor;
-    if (shape_and_slice.empty()) {
+    if (shape_and_slice.empty() && reader_options.mmap_data_files) {
+      // Lookup the full tensor, letting the reader alias the mapped data file
+      // when possible.
+      Tensor restored;
+      TF_RETURN_IF_ERROR(reader->Lookup(tensor_name, &restored));
+      context->set_output(idx, restored);
+      restored_tensor = context->mutable_output(idx);
+    } else if (shape_and_slice.empty()) {
       // Lookup the full tensor.
       TF_RETURN_IF_ERROR(
           context->allocate_output(idx, restored_full_shape, &restored_tensor));
@@ -354,6 +363,7 @@ struct RestoreOp {
   string tensor_name;
   string shape_and_slice;
   string reader_prefix;
+  BundleReader::Options reader_options;
   DataType dtype;
 
   ::tensorflow::Status status;
@@ -370,14 +380,22 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
   const auto& tensor_names_flat = tensor_names.flat<tstring>();
   const auto& shape_and_slices_flat = shape_and_slices.flat<tstring>();
 
+  // Restoring from memory-mapped data files makes restoring large variables
+  // nearly free, at the cost of a copy on their first update.
+  BundleReader::Options reader_options;
+  TF_RETURN_IF_ERROR(ReadBoolFromEnvVar("TF_RESTORE_MMAP_CHECKPOINT",
+                                        /*default_val=*/false,
+                                        &reader_options.mmap_data_files));
+
   std::vector<RestoreOp> restore_ops;
   restore_ops.reserve(tensor_names_flat.size());
   for (int i = 0; i < tensor_names_flat.size(); ++i) {
     restore_ops.push_back({context, i, tensor_names_flat(i),
-                           shape_and_slices_flat(i), prefix_string, dtypes[i]});
+                           shape_and_slices_flat(i), prefix_string,
+                           reader_options, dtypes[i]});
   }
 
-  BundleReader default_reader(Env::Default(), prefix_string);
+  BundleReader default_reader(Env::Default(), prefix_string, reader_options);
   TF_RETURN_IF_ERROR(default_reader.status());
 
   TF_RETURN_IF_ERROR(default_reader.SortForSequentialAccess<RestoreOp>(
@@ -15,22 +15,33 @@ limitations under the License.
 
 // See docs in ../ops/io_ops.cc.
 
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <numeric>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/kernels/checkpoint_callback_manager.h"
 #include "tensorflow/core/kernels/save_restore_tensor.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/notification.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/saved_tensor_slice_util.h"
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 #include "tensorflow/core/util/tensor_slice_reader.h"
@@ -87,9 +98,196 @@ void ValidateInputs(bool is_save_op, OpKernelContext* context,
   }
 }
 
+// Adds the tensor `tensor` named `tensor_name`, or the slice of it described
+// by `shape_and_slice` if non-empty, to `writer`.
+Status AddTensor(BundleWriter* writer, const string& tensor_name,
+                 const string& shape_and_slice, const Tensor& tensor) {
+  VLOG(2) << "Starting save of " << tensor_name;
+
+  if (!shape_and_slice.empty()) {
+    TensorShape shape;
+    TensorSlice slice(tensor.dims());
+    TensorShape slice_shape;
+
+    TF_RETURN_IF_ERROR(checkpoint::ParseShapeAndSlice(shape_and_slice, &shape,
+                                                      &slice, &slice_shape));
+    if (!slice_shape.IsSameSize(tensor.shape())) {
+      return errors::InvalidArgument(
+          "Slice in shape_and_slice "
+          "specification does not match the "
+          "shape of the tensor to  save: ",
+          shape_and_slice, ", tensor: ", tensor.shape().DebugString());
+    }
+
+    TF_RETURN_IF_ERROR(writer->AddSlice(tensor_name, shape, slice, tensor));
+  } else {
+    TF_RETURN_IF_ERROR(writer->Add(tensor_name, tensor));
+  }
+
+  if (VLOG_IS_ON(5)) {
+    if (tensor.dtype() == DT_FLOAT) {
+      const float* t_data = tensor.flat<float>().data();
+      float min = std::numeric_limits<float>::infinity();
+      float max = -std::numeric_limits<float>::infinity();
+      double avg = 0.0;
+      for (int i = 0; i < tensor.NumElements(); ++i) {
+        if (t_data[i] < min) min = t_data[i];
+        if (t_data[i] > max) max = t_data[i];
+        avg += t_data[i];
+      }
+      VLOG(5) << " min " << min << " max " << max << " avg "
+              << avg / tensor.NumElements() << " total elts "
+              << tensor.NumElements();
+    }
+  }
+
+  VLOG(2) << "Done save of " << tensor_name;
+  return OkStatus();
+}
+
+// Writes `tensors` with the given names and slice specs to the bundle at
+// `prefix`, split across `num_shards` concurrently written data shards.
+Status WriteTensors(const string& prefix, const std::vector<string>& names,
+                    const std::vector<string>& shape_and_slices,
+                    const std::vector<Tensor>& tensors, int64_t num_shards) {
+  const int num_tensors = tensors.size();
+  num_shards = std::min<int64_t>(num_shards, num_tensors);
+
+  // Writes the tensors at `indices` to the bundle at `shard_prefix`.
+  auto write_tensors = [&](const string& shard_prefix,
+                           const std::vector<int>& indices) -> Status {
+    BundleWriter writer(Env::Default(), shard_prefix);
+    TF_RETURN_IF_ERROR(writer.status());
+    VLOG(1) << "BundleWriter, prefix_string: " << shard_prefix;
+    for (const int i : indices) {
+      TF_RETURN_IF_ERROR(
+          AddTensor(&writer, names[i], shape_and_slices[i], tensors[i]));
+    }
+    TF_RETURN_IF_ERROR(writer.Finish());
+    VLOG(1) << "Done BundleWriter, prefix_string: " << shard_prefix;
+    return OkStatus();
+  };
+
+  if (num_shards <= 1) {
+    std::vector<int> indices(num_tensors);
+    std::iota(indices.begin(), indices.end(), 0);
+    return write_tensors(prefix, indices);
+  }
+
+  // Assigns the largest tensors first, each to the shard with the fewest
+  // bytes so far.
+  std::vector<int> order(num_tensors);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+    return tensors[a].TotalBytes() > tensors[b].TotalBytes();
+  });
+  std::vector<std::vector<int>> shard_indices(num_shards);
+  std::vector<size_t> shard_bytes(num_shards, 0);
+  for (const int i : order) {
+    const int shard =
+        std::min_element(shard_bytes.begin(), shard_bytes.end()) -
+        shard_bytes.begin();
+    shard_indices[shard].push_back(i);
+    shard_bytes[shard] += tensors[i].TotalBytes();
+  }
+
+  std::vector<tstring> shard_prefixes(num_shards);
+  std::vector<Status> statuses(num_shards);
+  {
+    thread::ThreadPool writer_pool(Env::Default(), "save_tensors", num_shards);
+    for (int shard = 0; shard < num_shards; ++shard) {
+      shard_prefixes[shard] = strings::StrCat(prefix, "_temp_part-", shard);
+      writer_pool.Schedule([&, shard] {
+        statuses[shard] =
+            write_tensors(shard_prefixes[shard], shard_indices[shard]);
+      });
+    }
+  }
+  for (const Status& status : statuses) {
+    TF_RETURN_IF_ERROR(status);
+  }
+  return MergeBundles(Env::Default(), shard_prefixes, prefix);
+}
+
+// Tracks the bundles that SaveV2 writes in the background, by prefix. Ops
+// that read or replace a bundle wait for its pending write first, and return
+// the error of the write, if any.
+class AsyncSaves {
+ public:
+  static AsyncSaves* Global() {
+    // Not leaked on purpose: destroying it at exit waits for the pending
+    // writes, so that returning from the program does not truncate them.
+    static AsyncSaves async_saves;
+    return &async_saves;
+  }
+
+  ~AsyncSaves() {
+    mutex_lock l(mu_);
+    for (auto& it : pending_) {
+      it.second->done.WaitForNotification();
+    }
+  }
+
+  // Runs `write` on a background thread as the pending write of `prefix`.
+  // The caller waits for the previous write of `prefix` beforehand.
+  void Start(const string& prefix, std::function<Status()> write) {
+    auto pending = std::make_shared<PendingSave>();
+    {
+      mutex_lock l(mu_);
+      pending_[prefix] = pending;
+    }
+    Env::Default()->SchedClosure([prefix, pending, write = std::move(write)] {
+      pending->status = write();
+      if (!pending->status.ok()) {
+        LOG(ERROR) << "Asynchronous save of " << prefix
+                   << " failed: " << pending->status;
+      }
+      pending->done.Notify();
+    });
+  }
+
+  // Waits for the pending write of `prefix`, if any, and returns its status.
+  Status Wait(const string& prefix) {
+    std::shared_ptr<PendingSave> pending;
+    {
+      mutex_lock l(mu_);
+      auto it = pending_.find(prefix);
+      if (it == pending_.end()) return OkStatus();
+      pending = it->second;
+    }
+    pending->done.WaitForNotification();
+    mutex_lock l(mu_);
+    auto it = pending_.find(prefix);
+    if (it != pending_.end() && it->second == pending) pending_.erase(it);
+    return pending->status;
+  }
+
+ private:
+  struct PendingSave {
+    Notification done;
+    Status status;
+  };
+
+  mutex mu_;
+  std::unordered_map<string, std::shared_ptr<PendingSave>> pending_
+      TF_GUARDED_BY(mu_);
+};
+
 }  // namespace
 
 // Saves a list of named tensors using the tensor bundle library.
+//
+// If the TF_SAVE_V2_NUM_DATA_SHARDS environment variable is larger than one,
+// the tensors are split across that many bundles, balanced by size, which are
+// written concurrently by as many threads and then merged into one bundle
+// with as many data shards. Each writer only buffers a bounded amount of data,
+// so the host memory used does not grow with the size of the tensors.
+//
+// If the TF_SAVE_V2_ASYNC environment variable is true, the op only copies
+// the tensors to a host memory snapshot, so that later updates of the
+// variables don't race with the save, and returns. The bundle is written in
+// the background. RestoreV2, MergeV2Checkpoints and SaveV2 ops on the same
+// prefix wait for the write to complete and return its error, if any.
 class SaveV2 : public OpKernel {
  public:
   explicit SaveV2(OpKernelConstruction* context) : OpKernel(context) {}
@@ -108,61 +306,31 @@ class SaveV2 : public OpKernel {
     const auto& tensor_names_flat = tensor_names.flat<tstring>();
     const auto& shape_and_slices_flat = shape_and_slices.flat<tstring>();
 
-    BundleWriter writer(Env::Default(), prefix_string);
-    OP_REQUIRES_OK(context, writer.status());
-    VLOG(1) << "BundleWriter, prefix_string: " << prefix_string;
-
+    int64_t num_shards;
+    OP_REQUIRES_OK(context,
+                   ReadInt64FromEnvVar("TF_SAVE_V2_NUM_DATA_SHARDS",
+                                       /*default_val=*/1, &num_shards));
+    bool async;
+    OP_REQUIRES_OK(context, ReadBoolFromEnvVar("TF_SAVE_V2_ASYNC",
+                                               /*default_val=*/false, &async));
+
+    // Don't race with (and don't lose the error of) a write in flight.
+    OP_REQUIRES_OK(context, AsyncSaves::Global()->Wait(prefix_string));
+
+    std::vector<string> names(num_tensors);
+    std::vector<string> slices(num_tensors);
+    std::vector<Tensor> tensors(num_tensors);
     for (int i = 0; i < num_tensors; ++i) {
-      const string& tensor_name = tensor_names_flat(i);
-      const Tensor& tensor = context->input(i + kFixedInputs);
-      VLOG(2) << "Starting save of " << tensor_name;
-
-      if (!shape_and_slices_flat(i).empty()) {
-        const string& shape_spec = shape_and_slices_flat(i);
-        TensorShape shape;
-        TensorSlice slice(tensor.dims());
-        TensorShape slice_shape;
-
-        OP_REQUIRES_OK(context, checkpoint::ParseShapeAndSlice(
-                                    shape_spec, &shape, &slice, &slice_shape));
-        OP_REQUIRES(context, slice_shape.IsSameSize(tensor.shape()),
-                    errors::InvalidArgument("Slice in shape_and_slice "
-                                            "specification does not match the "
-                                            "shape of the tensor to  save: ",
-                                            shape_spec, ", tensor: ",
-                                            tensor.shape().DebugString()));
-
-        OP_REQUIRES_OK(context,
-                       writer.AddSlice(tensor_name, shape, slice, tensor));
-      } else {
-        OP_REQUIRES_OK(context, writer.Add(tensor_name, tensor));
-      }
-
-      if (VLOG_IS_ON(5)) {
-        if (tensor.dtype() == DT_FLOAT) {
-          const float* t_data = tensor.flat<float>().data();
-          float min = std::numeric_limits<float>::infinity();
-          float max = -std::numeric_limits<float>::infinity();
-          double avg = 0.0;
-          for (int i = 0; i < tensor.NumElements(); ++i) {
-            if (t_data[i] < min) min = t_data[i];
-            if (t_data[i] > max) max = t_data[i];
-            avg += t_data[i];
-          }
-          VLOG(5) << " min " << min << " max " << max << " avg "
-                  << avg / tensor.NumElements() << " total elts "
-                  << tensor.NumElements();
-        }
-      }
-
-      VLOG(2) << "Done save of " << tensor_name;
+      names[i] = tensor_names_flat(i);
+      slices[i] = shape_and_slices_flat(i);
+      const Tensor& input = context->input(i + kFixedInputs);
+      tensors[i] = async ? tensor::DeepCopy(input) : input;
     }
-    OP_REQUIRES_OK(context, writer.Finish());
-    VLOG(1) << "Done BundleWriter, prefix_string: " << prefix_string;
 
+    checkpoint::CheckpointCallbackManager* checkpoint_callback_manager =
+        nullptr;
     ResourceMgr* resource_manager = context->resource_manager();
     if (resource_manager != nullptr) {
-      checkpoint::CheckpointCallbackManager* checkpoint_callback_manager;
       OP_REQUIRES_OK(
           context,
           resource_manager
@@ -175,9 +343,32 @@ class SaveV2 : public OpKernel {
                     *out = new checkpoint::CheckpointCallbackManager();
                     return OkStatus();
                   }));
-      checkpoint_callback_manager->Save(prefix_string);
-      checkpoint_callback_manager->Unref();
     }
+    core::ScopedUnref unref_callback_manager(checkpoint_callback_manager);
+
+    auto write = [prefix_string, names = std::move(names),
+                  slices = std::move(slices), tensors = std::move(tensors),
+                  num_shards, checkpoint_callback_manager]() -> Status {
+      TF_RETURN_IF_ERROR(
+          WriteTensors(prefix_string, names, slices, tensors, num_shards));
+      if (checkpoint_callback_manager != nullptr) {
+        checkpoint_callback_manager->Save(prefix_string);
+      }
+      return OkStatus();
+    };
+    if (!async) {
+      OP_REQUIRES_OK(context, write());
+      return;
+    }
+    if (checkpoint_callback_manager != nullptr) {
+      checkpoint_callback_manager->Ref();
+    }
+    AsyncSaves::Global()->Start(
+        prefix_string,
+        [write = std::move(write), checkpoint_callback_manager]() {
+          core::ScopedUnref unref(checkpoint_callback_manager);
+          return write();
+        });
   }
 };
 REGISTER_KERNEL_BUILDER(Name("SaveV2").Device(DEVICE_CPU), SaveV2);
@@ -202,6 +393,7 @@ class RestoreV2 : public OpKernel {
     if (!context->status().ok()) return;
 
     const string& prefix_string = prefix.scalar<tstring>()();
+    OP_REQUIRES_OK(context, AsyncSaves::Global()->Wait(prefix_string));
 
     VLOG(2) << "Started Restore at prefix: " << prefix_string;
     // Intention: we plan to use the RestoreV2 op as a backward-compatible
@@ -284,6 +476,9 @@ class MergeV2Checkpoints : public OpKernel {
         gtl::ArraySlice<tstring>(checkpoint_prefixes.flat<tstring>());
     Env* env = Env::Default();
     const string& merged_prefix = destination_prefix.scalar<tstring>()();
+    for (const tstring& input_prefix : input_prefixes) {
+      OP_REQUIRES_OK(context, AsyncSaves::Global()->Wait(input_prefix));
+    }
     OP_REQUIRES_OK(context,
                    tensorflow::MergeBundles(env, input_prefixes, merged_prefix,
                                             allow_missing_files_));
@@ -26,6 +26,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/types.h"
@@ -340,5 +341,90 @@ TEST_F(SaveV2OpTest, Simple) {
   }
 }
 
+TEST_F(SaveV2OpTest, ParallelDataShards) {
+  setenv("TF_SAVE_V2_NUM_DATA_SHARDS", "3", /*overwrite=*/1);
+  const string prefix = io::JoinPath(testing::TmpDir(), "tensor_shards");
+  TF_ASSERT_OK(NodeDefBuilder("myop", "SaveV2")
+                   .Input(FakeInput())  // prefix
+                   .Input(FakeInput())  // tensor_names
+                   .Input(FakeInput())  // shape_and_slices
+                   .Input(FakeInput({DT_FLOAT, DT_FLOAT, DT_INT32, DT_FLOAT}))
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+  AddInput<tstring>(TensorShape({}),
+                    [&prefix](int x) -> tstring { return prefix; });
+  AddInput<tstring>(TensorShape({4}), [](int x) -> tstring {
+    return strings::StrCat("tensor_", x);
+  });
+  AddInput<tstring>(TensorShape({4}), [](int x) -> tstring {
+    // The last tensor is a slice of a partitioned variable.
+    return x == 3 ? "4 0,2" : "";
+  });
+  AddInput<float>(TensorShape({100}), [](int x) -> float { return x; });
+  AddInput<float>(TensorShape({10}), [](int x) -> float { return -x; });
+  AddInput<int32>(TensorShape({50}), [](int x) -> int32 { return 2 * x; });
+  AddInput<float>(TensorShape({2}), [](int x) -> float { return x + 0.5f; });
+  TF_ASSERT_OK(RunOpKernel());
+  unsetenv("TF_SAVE_V2_NUM_DATA_SHARDS");
+
+  // The bundle has one data shard per writer thread.
+  EXPECT_TRUE(Env::Default()->FileExists(DataFilename(prefix, 2, 3)).ok());
+  BundleReader reader(Env::Default(), prefix);
+  TF_ASSERT_OK(reader.status());
+  Tensor val;
+  TF_EXPECT_OK(reader.Lookup("tensor_0", &val));
+  for (int i = 0; i < 100; ++i) EXPECT_EQ(i, val.flat<float>()(i));
+  TF_EXPECT_OK(reader.Lookup("tensor_1", &val));
+  for (int i = 0; i < 10; ++i) EXPECT_EQ(-i, val.flat<float>()(i));
+  TF_EXPECT_OK(reader.Lookup("tensor_2", &val));
+  for (int i = 0; i < 50; ++i) EXPECT_EQ(2 * i, val.flat<int32>()(i));
+  Tensor slice(DT_FLOAT, TensorShape({2}));
+  TF_EXPECT_OK(reader.LookupSlice(
+      "tensor_3", TensorSlice::ParseOrDie("0,2"), &slice));
+  EXPECT_EQ(0.5f, slice.flat<float>()(0));
+  EXPECT_EQ(1.5f, slice.flat<float>()(1));
+}
+
+TEST_F(SaveV2OpTest, AsyncSnapshot) {
+  setenv("TF_SAVE_V2_ASYNC", "1", /*overwrite=*/1);
+  const string prefix = io::JoinPath(testing::TmpDir(), "tensor_async");
+  TF_ASSERT_OK(NodeDefBuilder("myop", "SaveV2")
+                   .Input(FakeInput())  // prefix
+                   .Input(FakeInput())  // tensor_names
+                   .Input(FakeInput())  // shape_and_slices
+                   .Input(FakeInput({DT_FLOAT}))
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+  AddInput<tstring>(TensorShape({}),
+                    [&prefix](int x) -> tstring { return prefix; });
+  AddInput<tstring>(TensorShape({1}),
+                    [](int x) -> tstring { return "tensor_0"; });
+  AddInput<tstring>(TensorShape({1}), [](int x) -> tstring { return ""; });
+  AddInput<float>(TensorShape({1000}), [](int x) -> float { return x; });
+  TF_ASSERT_OK(RunOpKernel());
+  unsetenv("TF_SAVE_V2_ASYNC");
+
+  // Updates after the op returned are not part of the checkpoint.
+  mutable_input(3).tensor->flat<float>().setZero();
+
+  // RestoreV2 waits for the pending write of the bundle.
+  inputs_.clear();
+  TF_ASSERT_OK(NodeDefBuilder("restore", "RestoreV2")
+                   .Input(FakeInput())  // prefix
+                   .Input(FakeInput())  // tensor_names
+                   .Input(FakeInput())  // shape_and_slices
+                   .Attr("dtypes", {DT_FLOAT})
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+  AddInput<tstring>(TensorShape({}),
+                    [&prefix](int x) -> tstring { return prefix; });
+  AddInput<tstring>(TensorShape({1}),
+                    [](int x) -> tstring { return "tensor_0"; });
+  AddInput<tstring>(TensorShape({1}), [](int x) -> tstring { return ""; });
+  TF_ASSERT_OK(RunOpKernel());
+  const Tensor* val = GetOutput(0);
+  for (int i = 0; i < 1000; ++i) EXPECT_EQ(i, val->flat<float>()(i));
+}
+
 }  // namespace
 }  // namespace tensorflow
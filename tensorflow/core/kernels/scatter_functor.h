@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_KERNELS_SCATTER_FUNCTOR_H_
 
 #include <type_traits>
+#include <vector>
 
 #include "third_party/eigen3/Eigen/Core"
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
@@ -25,6 +26,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/variant_op_registry.h"
 #include "tensorflow/core/kernels/dense_update_functor.h"
+#include "tensorflow/core/kernels/scatter_update_groups.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/util/determinism.h"
 #include "tensorflow/core/util/work_sharder.h"
@@ -199,36 +201,76 @@ struct ScatterFunctorBase {
     return -1;
   }
 
+  // Applies the updates grouped by the row they update, with each row updated
+  // by a single thread in the original order of its updates. Unlike
+  // ParallelExecute this takes no locks, so duplicate indices do not contend,
+  // and the result is the same as the one of SerialExecute.
+  Index GroupedExecute(OpKernelContext* c, const Device& d,
+                       typename TTypes<T>::Matrix params,
+                       typename TTypes<T>::ConstMatrix updates,
+                       typename TTypes<Index>::ConstFlat indices) {
+    const Index N = static_cast<Index>(indices.size());
+    const Index limit = static_cast<Index>(params.dimension(0));
+    std::vector<Index> rows(N);
+    for (Index i = 0; i < N; ++i) {
+      // Copy the index once, so that the value checked is the value used.
+      const Index index = ::tensorflow::internal::SubtleMustCopy(indices(i));
+      if (!FastBoundsCheck(index, limit)) return i;
+      rows[i] = index;
+    }
+    scatter_op::UpdateGroups<Index> groups;
+    scatter_op::GroupUpdatesByRow(rows, limit, &groups);
+    auto GroupedScatter = [&](int64_t start, int64_t end) {
+      for (int64_t g = start; g < end; ++g) {
+        auto row = params.template chip<0>(groups.rows[g]);
+        for (Index k = groups.offsets[g]; k < groups.offsets[g + 1]; ++k) {
+          scatter_op::internal::Assign<op>::Run(
+              row, updates.template chip<0>(groups.positions[k]));
+        }
+      }
+    };
+    const float kMovingCost = 2.5f;
+    const float shard_cost =
+        kMovingCost * params.dimension(1) * N / groups.num_groups();
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *(c->device()->tensorflow_cpu_worker_threads());
+    Shard(worker_threads.num_threads, worker_threads.workers,
+          groups.num_groups(), shard_cost, GroupedScatter);
+    return -1;
+  }
+
   Index operator()(OpKernelContext* c, const Device& d,
                    typename TTypes<T>::Matrix params,
                    typename TTypes<T>::ConstMatrix updates,
                    typename TTypes<Index>::ConstFlat indices) {
-#ifdef PLATFORM_GOOGLE
-    // The parallel version is significantly slower internally. Only call the
-    // serial version for now.
-    // TODO(penporn): Avoid locking in parallelization (sort beforehand).
-    return SerialExecute(c, d, params, updates, indices);
-#else
     // indices and params sizes were validated in DoCompute().
     const Index N = static_cast<Index>(indices.size());
     const Index limit = static_cast<Index>(params.dimension(0));
-    const Index min_n_threshold = 1024;
+    const Index min_n_threshold = scatter_op::kMinGroupedScatterUpdates;
     const Index ser_par_ratio = 10000;
-    // For parallelizing the updates, duplicate entries need to be handled
-    // correctly. Multiple updates to the same index has to be serialized.
-    // This can lead to lock contention which may nullify the benefits of
-    // parallelization. Assuming uniform random distribution of the indices, we
-    // come up with a rough heuristic and determine whether the updates execute
-    // serially or parallelly. Also if 'N' is small, overheads of parallel
-    // execution outweigh its benefits and hence we check the value of N.
-    const bool execute_serial = N < min_n_threshold ||
-                                (N / limit) > ser_par_ratio ||
-                                OpDeterminismRequired();
-    if (execute_serial)
-      return SerialExecute(c, d, params, updates, indices);
+    // If 'N' is small, overheads of parallel execution outweigh its benefits,
+    // and if there are many more updates than rows, there is little to
+    // parallelize over.
+    const bool execute_serial =
+        N < min_n_threshold || (N / limit) > ser_par_ratio;
+    if (execute_serial) return SerialExecute(c, d, params, updates, indices);
+#ifdef PLATFORM_GOOGLE
+    // The locked parallel version is significantly slower internally.
+    const bool execute_grouped = true;
+#else
+    // Multiple updates to the same index have to be serialized. Locking is
+    // cheap for uniformly distributed indices, but when many updates hit the
+    // same rows it contends and grouping the updates by row first is faster.
+    // The grouped version also gives the same result as the serial one, so it
+    // is used when determinism is required.
+    const bool execute_grouped =
+        OpDeterminismRequired() ||
+        scatter_op::HasFrequentDuplicates(indices.data(), N);
+#endif  // PLATFORM_GOOGLE
+    if (execute_grouped)
+      return GroupedExecute(c, d, params, updates, indices);
     else
       return ParallelExecute(c, d, params, updates, indices);
-#endif  // PLATFORM_GOOGLE
   }
 };
 
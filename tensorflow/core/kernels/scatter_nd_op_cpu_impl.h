@@ -21,6 +21,7 @@ limitations under the License.
 #define EIGEN_USE_THREADS
 
 #include <atomic>
+#include <vector>
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 
@@ -31,6 +32,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/kernels/fill_functor.h"
 #include "tensorflow/core/kernels/scatter_nd_op.h"
+#include "tensorflow/core/kernels/scatter_update_groups.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/util/util.h"
@@ -127,6 +129,12 @@ struct ScatterNdFunctor<CPUDevice, T, Index, OP, IXDIM> {
           batch_strides[dim + 1] * output_shape_prefix[dim + 1];
     }
 
+    if (batch_size >= scatter_op::kMinGroupedScatterUpdates &&
+        d.numThreads() > 1) {
+      return GroupedExecute(d, slice_size, output_shape_prefix, batch_strides,
+                            Tindices, Tupdates, Toutput);
+    }
+
     for (Eigen::DenseIndex loc = 0; loc < batch_size; ++loc) {
       Index i = 0;
       bool out_of_bounds = false;
@@ -151,6 +159,59 @@ struct ScatterNdFunctor<CPUDevice, T, Index, OP, IXDIM> {
 
     return error_loc;
   }
+
+ private:
+  // Applies the updates grouped by the slice they update, with each slice
+  // updated by a single thread in the original order of its updates. This
+  // needs no locking even when many indices are duplicates, and gives the same
+  // result as applying the updates one after the other.
+  static Index GroupedExecute(
+      const CPUDevice& d, const Index slice_size,
+      const Eigen::array<Eigen::DenseIndex, IXDIM>& output_shape_prefix,
+      const Index* batch_strides,
+      typename TTypes<Index, 2>::ConstTensor Tindices,
+      typename TTypes<T, 2>::ConstTensor Tupdates,
+      typename TTypes<T, 2>::Tensor Toutput) {
+    const Eigen::DenseIndex batch_size = Tindices.dimension(0);
+    std::vector<Index> slices(batch_size);
+    for (Eigen::DenseIndex loc = 0; loc < batch_size; ++loc) {
+      Index i = 0;
+      bool out_of_bounds = false;
+      for (int dim = 0; dim < IXDIM; ++dim) {
+        const Index ix_d = internal::SubtleMustCopy(Tindices(loc, dim));
+        out_of_bounds |= !FastBoundsCheck(ix_d, output_shape_prefix[dim]);
+        i += ix_d * batch_strides[dim];
+      }
+      if (TF_PREDICT_FALSE(out_of_bounds)) return loc;
+      slices[loc] = i;
+    }
+
+    scatter_op::UpdateGroups<Index> groups;
+    const Index num_slices = static_cast<Index>(Toutput.dimension(0));
+    scatter_op::GroupUpdatesByRow(slices, num_slices, &groups);
+    const Eigen::DefaultDevice device;
+    auto apply_groups = [&](Eigen::Index start, Eigen::Index end) {
+      for (Eigen::Index g = start; g < end; ++g) {
+        auto input_chip = Toutput.template chip<0>(groups.rows[g]);
+        auto output_chip = input_chip;
+        for (Index k = groups.offsets[g]; k < groups.offsets[g + 1]; ++k) {
+          auto update_chip = Tupdates.template chip<0>(groups.positions[k]);
+          update_executor::UpdateExecutor<
+              Eigen::DefaultDevice, decltype(input_chip),
+              decltype(update_chip), decltype(output_chip),
+              OP>::Execute(device, input_chip, update_chip, output_chip);
+        }
+      }
+    };
+    const double bytes_per_group = static_cast<double>(sizeof(T)) *
+                                   slice_size * batch_size /
+                                   groups.num_groups();
+    d.parallelFor(groups.num_groups(),
+                  Eigen::TensorOpCost(2 * bytes_per_group, bytes_per_group,
+                                      bytes_per_group / sizeof(T)),
+                  apply_groups);
+    return -1;
+  }
 };
 
 #define REGISTER_SCATTER_ND_FULL(T, Index, op)                               \
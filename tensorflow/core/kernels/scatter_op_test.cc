@@ -217,6 +217,33 @@ TEST_F(ScatterSubOpTest, StressIndexTest) {
   test::ExpectTensorEqual<int32>(expected, params_tensor);
 }
 
+TEST_F(ScatterSubOpTest, DuplicateHeavyIndices) {
+  MakeOp(DT_INT32_REF, DT_INT32);
+  // Few distinct rows, so the updates are applied grouped by row.
+  const int kRows = 100;
+  const int kCols = 2;
+  const int kNumUpdates = 10000;
+  std::vector<int32> indices(kNumUpdates);
+  std::vector<int32> updates(kNumUpdates * kCols);
+  std::vector<int32> expected_values(kRows * kCols, 0);
+  for (int i = 0; i < kNumUpdates; ++i) {
+    indices[i] = (i * 7) % kRows;
+    for (int j = 0; j < kCols; ++j) {
+      updates[i * kCols + j] = i + j;
+      expected_values[indices[i] * kCols + j] -= i + j;
+    }
+  }
+  AddInputFromArray<int32>(TensorShape({kRows, kCols}),
+                           std::vector<int32>(kRows * kCols, 0));
+  AddInputFromArray<int32>(TensorShape({kNumUpdates}), indices);
+  AddInputFromArray<int32>(TensorShape({kNumUpdates, kCols}), updates);
+  TF_ASSERT_OK(RunOpKernel());
+  Tensor params_tensor = *mutable_input(0).tensor;
+  Tensor expected(allocator(), DT_INT32, TensorShape({kRows, kCols}));
+  test::FillValues<int32>(&expected, expected_values);
+  test::ExpectTensorEqual<int32>(expected, params_tensor);
+}
+
 TEST_F(ScatterUpdateOpTest, Error_WrongDimsIndices) {
   MakeOp(DT_FLOAT_REF, DT_INT32);
 
@@ -0,0 +1,105 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_SCATTER_UPDATE_GROUPS_H_
+#define TENSORFLOW_CORE_KERNELS_SCATTER_UPDATE_GROUPS_H_
+
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace scatter_op {
+
+// Minimum number of updates for which grouping them by row pays off.
+constexpr int64_t kMinGroupedScatterUpdates = 1024;
+
+// The updates of a scatter on CPU grouped by the row they update, so that
+// every row can be updated by a single thread without any locking. Within a
+// group the updates keep their original order, so applying the groups in any
+// order gives the same result as applying all the updates serially.
+template <typename Index>
+struct UpdateGroups {
+  // Positions of the updates, sorted by row and then by position.
+  std::vector<Index> positions;
+  // The updates of group g are positions[offsets[g]] to
+  // positions[offsets[g + 1] - 1].
+  std::vector<Index> offsets;
+  // The row updated by each group.
+  std::vector<Index> rows;
+
+  int64_t num_groups() const { return rows.size(); }
+};
+
+// Groups the updates whose target rows, all in [0, num_rows), are
+// `update_rows`.
+template <typename Index>
+void GroupUpdatesByRow(const std::vector<Index>& update_rows, Index num_rows,
+                       UpdateGroups<Index>* groups) {
+  const Index num_updates = update_rows.size();
+  groups->positions.resize(num_updates);
+  groups->offsets.clear();
+  groups->rows.clear();
+  if (num_rows <= 4 * static_cast<int64_t>(num_updates)) {
+    // Counting sort, which is stable and linear when the rows are dense.
+    std::vector<Index> starts(num_rows + 1, 0);
+    for (const Index row : update_rows) ++starts[row + 1];
+    std::partial_sum(starts.begin(), starts.end(), starts.begin());
+    std::vector<Index> next(starts.begin(), starts.end() - 1);
+    for (Index i = 0; i < num_updates; ++i) {
+      groups->positions[next[update_rows[i]]++] = i;
+    }
+    for (Index row = 0; row < num_rows; ++row) {
+      if (starts[row + 1] > starts[row]) {
+        groups->rows.push_back(row);
+        groups->offsets.push_back(starts[row]);
+      }
+    }
+  } else {
+    std::iota(groups->positions.begin(), groups->positions.end(), 0);
+    std::stable_sort(groups->positions.begin(), groups->positions.end(),
+                     [&update_rows](Index a, Index b) {
+                       return update_rows[a] < update_rows[b];
+                     });
+    for (Index i = 0; i < num_updates; ++i) {
+      const Index row = update_rows[groups->positions[i]];
+      if (groups->rows.empty() || groups->rows.back() != row) {
+        groups->rows.push_back(row);
+        groups->offsets.push_back(i);
+      }
+    }
+  }
+  groups->offsets.push_back(num_updates);
+}
+
+// Returns true if the first updates of a scatter often target the same rows,
+// in which case updating the rows in parallel with locks would contend.
+template <typename Index>
+bool HasFrequentDuplicates(const Index* update_rows, int64_t num_updates) {
+  constexpr int64_t kNumSamples = 1024;
+  std::vector<Index> samples(update_rows,
+                             update_rows + std::min(num_updates, kNumSamples));
+  std::sort(samples.begin(), samples.end());
+  const int64_t num_unique =
+      std::unique(samples.begin(), samples.end()) - samples.begin();
+  return num_unique * 4 < static_cast<int64_t>(samples.size()) * 3;
+}
+
+}  // namespace scatter_op
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_SCATTER_UPDATE_GROUPS_H_
@@ -18,7 +18,10 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_SEGMENT_REDUCTION_OPS_IMPL_H_
 #define TENSORFLOW_CORE_KERNELS_SEGMENT_REDUCTION_OPS_IMPL_H_
 
+#include <algorithm>
 #include <cstdint>
+#include <type_traits>
+#include <vector>
 
 #include "tensorflow/core/framework/op_requires.h"
 #include "tensorflow/core/platform/types.h"
@@ -41,8 +44,10 @@ limitations under the License.
 #include "tensorflow/core/kernels/segment_reduction_ops.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/prefetch.h"
 #include "tensorflow/core/util/determinism.h"
 #include "tensorflow/core/util/util.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 #include "tensorflow/core/common_runtime/gpu/gpu_event_mgr.h"
@@ -126,15 +131,20 @@ class SegmentReductionOp : public OpKernel {
                 errors::InvalidArgument("segment ids must be >= 0"));
     auto output_flat = output->flat_outer_dims<T>();
 
-    Eigen::IndexList<Eigen::type2index<0> > dims_to_reduce;
+    const auto* worker_threads =
+        context->device()->tensorflow_cpu_worker_threads();
+    if (worker_threads->num_threads > 1 &&
+        num_indices * num_col >= kMinParallelSize) {
+      ParallelReduce(context, input_flat, segment_vec, output_rows,
+                     output_flat);
+      return;
+    }
+
     Index start = 0, end = 1;
 
     Index uninitialized_index = 0;  // Index from which the output is not set.
     Index out_index = internal::SubtleMustCopy(segment_vec(start));
 
-    // TODO(agarwal): if this loop becomes a bottleneck, consider sharding it
-    // across threads.
-    Eigen::DSizes<Eigen::DenseIndex, 1> out_slice_shape(num_col);
     while (end <= num_indices) {
       // We initialize next_index to 0 to avoid "warning: 'next_index' may be
       // used uninitialized in this function" in the Mac build (since the
@@ -151,11 +161,132 @@ class SegmentReductionOp : public OpKernel {
                     errors::InvalidArgument("segment ids are not increasing"));
       }
 
+      OP_REQUIRES(
+          context, FastBoundsCheck(out_index, output_rows),
+          errors::InvalidArgument(
+              "Segment id ", out_index, " out of range [0, ", output_rows,
+              "), possibly because 'segment_ids' input is not sorted."));
+
+      // If there is a gap between two indices, we need to set that gap to the
+      // default value.
+      if (out_index > uninitialized_index) {
+        Eigen::DSizes<Eigen::DenseIndex, 2> gap_slice_shape(
+            out_index - uninitialized_index, num_col);
+        Eigen::TensorMap<Eigen::Tensor<T, 2, Eigen::RowMajor>, Eigen::Unaligned>
+            gap_slice(&output_flat(uninitialized_index, 0), gap_slice_shape);
+        gap_slice.setConstant(T(default_value));
+      }
+
       // Process segment [start, end)
-      const T* in_slice_ptr = &input_flat(start, 0);
-      typedef Eigen::TensorMap<Eigen::Tensor<T, 1, Eigen::RowMajor>,
+      ReduceRows(&input_flat(start, 0), end - start, num_col,
+                 &output_flat(out_index, 0));
+      if (end >= num_indices) break;
+      start = end;
+      ++end;
+      uninitialized_index = out_index + 1;
+      out_index = next_index;
+    }
+  }
+
+ private:
+  // Minimum number of input elements for which the reduction is sharded
+  // across the worker threads.
+  static constexpr int64_t kMinParallelSize = 1 << 15;
+  // Minimum number of rows of the pieces a segment is split into.
+  static constexpr int64_t kMinChunkRows = 64;
+
+  // Reduces the `num_rows` contiguous rows starting at `in` into `out`.
+  static void ReduceRows(const T* in, int64_t num_rows, int64_t num_col,
+                         T* out) {
+    typedef Eigen::TensorMap<Eigen::Tensor<T, 1, Eigen::RowMajor>,
+                             Eigen::Unaligned>
+        OutT;
+    Eigen::DSizes<Eigen::DenseIndex, 1> out_slice_shape(num_col);
+    OutT out_slice(out, out_slice_shape);
+    // We don't use out_slice.device(context->eigen_device<Device>)
+    // because these pieces of work are likely to be very small and
+    // the context switching overhead dwarfs any benefit we get from
+    // using another thread to do this work.
+    if (num_rows == 1) {
+      typedef Eigen::TensorMap<Eigen::Tensor<const T, 1, Eigen::RowMajor>,
                                Eigen::Unaligned>
-          OutT;
+          InT;
+      InT in_slice(in, out_slice_shape);
+      out_slice = in_slice;
+    } else {
+      Eigen::DSizes<Eigen::DenseIndex, 2> in_slice_shape(num_rows, num_col);
+      typedef Eigen::TensorMap<Eigen::Tensor<const T, 2, Eigen::RowMajor>,
+                               Eigen::Unaligned>
+          InT;
+      InT in_slice(in, in_slice_shape);
+      Eigen::IndexList<Eigen::type2index<0> > dims_to_reduce;
+      out_slice = in_slice.reduce(dims_to_reduce, Reducer());
+    }
+  }
+
+  // Shards the reduction across the worker threads by row ranges. Segments
+  // longer than the chunk size are split into several chunks, each reduced
+  // into a partial result row, and the partial results of a segment are
+  // reduced into the output row at the end. This keeps all the threads busy
+  // when there are many rows and only a few segments.
+  void ParallelReduce(OpKernelContext* context,
+                      typename TTypes<T>::ConstMatrix input_flat,
+                      typename TTypes<Index>::ConstVec segment_vec,
+                      Index output_rows,
+                      typename TTypes<T>::Matrix output_flat) {
+    const auto* worker_threads =
+        context->device()->tensorflow_cpu_worker_threads();
+    const int64_t num_indices = segment_vec.dimension(0);
+    const int64_t num_col = input_flat.dimension(1);
+
+    // The mean of partial means is not the mean of the segment, and the order
+    // of a split floating point reduction depends on the number of threads.
+    const bool can_split_segments =
+        !std::is_same<Reducer, Eigen::internal::MeanReducer<T>>::value &&
+        !OpDeterminismRequired();
+    const int64_t chunk_rows =
+        can_split_segments
+            ? std::max<int64_t>(
+                  kMinChunkRows,
+                  Eigen::divup<int64_t>(num_indices,
+                                        4 * worker_threads->num_threads))
+            : num_indices;
+
+    // A contiguous range of rows of a segment, reduced either directly into
+    // the output row or into a partial result row.
+    struct Chunk {
+      Index start;
+      Index end;
+      Index out_index;
+      int64_t partial;
+    };
+    // The partial result rows [first_partial, first_partial + num_partials)
+    // of a split segment.
+    struct SplitSegment {
+      Index out_index;
+      int64_t first_partial;
+      int64_t num_partials;
+    };
+    std::vector<Chunk> chunks;
+    std::vector<SplitSegment> split_segments;
+    int64_t num_partials = 0;
+
+    // Validate the segment ids and find the chunks, filling the gaps between
+    // the segments with the default value on the way.
+    Index start = 0, end = 1;
+    Index uninitialized_index = 0;
+    Index out_index = internal::SubtleMustCopy(segment_vec(start));
+    while (end <= num_indices) {
+      Index next_index = 0;
+      if (end < num_indices) {
+        next_index = internal::SubtleMustCopy(segment_vec(end));
+        if (out_index == next_index) {
+          ++end;
+          continue;
+        }
+        OP_REQUIRES(context, out_index < next_index,
+                    errors::InvalidArgument("segment ids are not increasing"));
+      }
 
       OP_REQUIRES(
           context, FastBoundsCheck(out_index, output_rows),
@@ -163,8 +294,6 @@ class SegmentReductionOp : public OpKernel {
               "Segment id ", out_index, " out of range [0, ", output_rows,
               "), possibly because 'segment_ids' input is not sorted."));
 
-      // If there is a gap between two indices, we need to set that gap to the
-      // default value.
       if (out_index > uninitialized_index) {
         Eigen::DSizes<Eigen::DenseIndex, 2> gap_slice_shape(
             out_index - uninitialized_index, num_col);
@@ -173,34 +302,53 @@ class SegmentReductionOp : public OpKernel {
         gap_slice.setConstant(T(default_value));
       }
 
-      T* out_slice_ptr = &output_flat(out_index, 0);
-      OutT out_slice(out_slice_ptr, out_slice_shape);
-      // We don't use out_slice.device(context->eigen_device<Device>)
-      // because these pieces of work are likely to be very small and
-      // the context switching overhead dwarfs any benefit we get from
-      // using another thread to do this work.
-      if (start == end - 1) {
-        typedef Eigen::TensorMap<Eigen::Tensor<const T, 1, Eigen::RowMajor>,
-                                 Eigen::Unaligned>
-            InT;
-        InT in_slice(in_slice_ptr, out_slice_shape);
-        out_slice = in_slice;
+      if (end - start <= chunk_rows) {
+        chunks.push_back({start, end, out_index, -1});
       } else {
-        Eigen::DSizes<Eigen::DenseIndex, 2> in_slice_shape(end - start,
-                                                           num_col);
-        typedef Eigen::TensorMap<Eigen::Tensor<const T, 2, Eigen::RowMajor>,
-                                 Eigen::Unaligned>
-            InT;
-        InT in_slice(in_slice_ptr, in_slice_shape);
-
-        out_slice = in_slice.reduce(dims_to_reduce, Reducer());
+        const int64_t first_partial = num_partials;
+        for (Index chunk_start = start; chunk_start < end;
+             chunk_start += chunk_rows) {
+          const Index chunk_end =
+              std::min<int64_t>(chunk_start + chunk_rows, end);
+          chunks.push_back({chunk_start, chunk_end, out_index, num_partials++});
+        }
+        split_segments.push_back(
+            {out_index, first_partial, num_partials - first_partial});
       }
+
       if (end >= num_indices) break;
       start = end;
       ++end;
       uninitialized_index = out_index + 1;
       out_index = next_index;
     }
+
+    Tensor partials;
+    OP_REQUIRES_OK(context, context->allocate_temp(
+                                DataTypeToEnum<T>::value,
+                                TensorShape({num_partials, num_col}),
+                                &partials));
+    auto partials_flat = partials.matrix<T>();
+
+    auto reduce_chunks = [&](int64_t first, int64_t last) {
+      for (int64_t i = first; i < last; ++i) {
+        const Chunk& chunk = chunks[i];
+        T* out = chunk.partial < 0 ? &output_flat(chunk.out_index, 0)
+                                   : &partials_flat(chunk.partial, 0);
+        ReduceRows(&input_flat(chunk.start, 0), chunk.end - chunk.start,
+                   num_col, out);
+      }
+    };
+    const int64_t cost_per_chunk =
+        Eigen::divup<int64_t>(num_indices, chunks.size()) * num_col;
+    Shard(worker_threads->num_threads, worker_threads->workers, chunks.size(),
+          cost_per_chunk, reduce_chunks);
+
+    for (const SplitSegment& segment : split_segments) {
+      ReduceRows(&partials_flat(segment.first_partial, 0),
+                 segment.num_partials, num_col,
+                 &output_flat(segment.out_index, 0));
+    }
   }
 };
 
@@ -390,6 +538,22 @@ struct UnsortedSegmentFunctor<CPUDevice, T, Index, InitialValueF, ReductionF> {
     // Nothing to reduce. All output values equal to `InitialValueF()`.
     if (num_reductions == 0) return;
 
+    // With fewer segments than threads, parallelizing by segments leaves
+    // threads idle. Instead, shard the rows and let every shard reduce into
+    // its own accumulator, which are then merged into the output. This is
+    // only done when every accumulator row receives enough input rows for the
+    // merge to be cheap, and when the result does not have to be independent
+    // of the number of threads.
+    const int num_threads = cpu_device.numThreads();
+    const int64_t num_blocks = std::min<int64_t>(
+        num_threads, num_real_segment / (kMinRowsPerAccumulatorRow *
+                                         std::max<int64_t>(num_segments, 1)));
+    if (num_segments < num_threads && num_blocks > 1 &&
+        !OpDeterminismRequired()) {
+      ReduceWithAccumulators(ctx, segment_ids, data, output, num_blocks);
+      return;
+    }
+
     // Parallelize by `num_segments`. It's simple, efficient and safe
     // (no data dependency):
     //
@@ -421,6 +585,77 @@ struct UnsortedSegmentFunctor<CPUDevice, T, Index, InitialValueF, ReductionF> {
     const Eigen::TensorOpCost cost(input_bytes, output_bytes, compute_cycles);
     cpu_device.parallelFor(num_segments, cost, reductionWorker);
   }
+
+ private:
+  // Minimum average number of input rows reduced into each row of an
+  // accumulator for the rows to be sharded.
+  static constexpr int64_t kMinRowsPerAccumulatorRow = 16;
+
+  // Reduces the rows in `num_blocks` shards. The first shard reduces directly
+  // into `output`, the others into accumulators initialized with
+  // `InitialValueF()` that are merged into `output` at the end. Segment ids
+  // must already have been validated.
+  void ReduceWithAccumulators(OpKernelContext* ctx,
+                              typename TTypes<Index>::ConstFlat segment_ids,
+                              typename TTypes<T, 2>::ConstTensor data,
+                              typename TTypes<T, 2>::Tensor output,
+                              int64_t num_blocks) {
+    auto cpu_device = ctx->eigen_cpu_device();
+    const int64_t N = segment_ids.dimension(0);
+    const int64_t num_segments = output.dimension(0);
+    const int64_t inner_dim = data.dimension(1);
+
+    // Every accumulator is a separate allocation, so that it is aligned.
+    std::vector<Tensor> accumulators(num_blocks - 1);
+    for (Tensor& accumulator : accumulators) {
+      OP_REQUIRES_OK(ctx, ctx->allocate_temp(
+                              DataTypeToEnum<T>::value,
+                              TensorShape({num_segments, inner_dim}),
+                              &accumulator));
+      typename TTypes<T, 2>::Tensor accumulator_flat =
+          accumulator.tensor<T, 2>();
+      accumulator_flat.device(cpu_device) =
+          accumulator_flat.constant(InitialValueF()());
+    }
+
+    const int64_t rows_per_block = Eigen::divup(N, num_blocks);
+    auto reduce_block = [&](int64_t first, int64_t last) {
+      ReductionF reduction;
+      for (int64_t block = first; block < last; ++block) {
+        typename TTypes<T, 2>::Tensor block_output =
+            block == 0 ? output : accumulators[block - 1].tensor<T, 2>();
+        const int64_t row_end = std::min(N, (block + 1) * rows_per_block);
+        for (int64_t i = block * rows_per_block; i < row_end; ++i) {
+          Index j = internal::SubtleMustCopy(segment_ids(i));
+          if (j < 0 || j >= num_segments) continue;
+          reduction(data.template chip<0>(i), block_output.template chip<0>(j));
+        }
+      }
+    };
+    const int64_t block_size = rows_per_block * inner_dim;
+    const Eigen::TensorOpCost block_cost(sizeof(T) * block_size,
+                                         sizeof(T) * block_size,
+                                         5 * block_size);
+    cpu_device.parallelFor(num_blocks, block_cost, reduce_block);
+
+    // Merge the accumulators into the output, in parallel over the segments.
+    auto merge = [&](int64_t first, int64_t last) {
+      ReductionF reduction;
+      for (const Tensor& accumulator : accumulators) {
+        typename TTypes<T, 2>::ConstTensor accumulator_flat =
+            accumulator.tensor<T, 2>();
+        for (int64_t j = first; j < last; ++j) {
+          reduction(accumulator_flat.template chip<0>(j),
+                    output.template chip<0>(j));
+        }
+      }
+    };
+    const int64_t merge_size = (num_blocks - 1) * inner_dim;
+    const Eigen::TensorOpCost merge_cost(sizeof(T) * merge_size,
+                                         sizeof(T) * inner_dim,
+                                         5 * merge_size);
+    cpu_device.parallelFor(num_segments, merge_cost, merge);
+  }
 };
 
 template <typename T>
@@ -535,12 +770,25 @@ class SparseSegmentReductionOpBase : public OpKernel {
         context, internal::ValidateSparseSegmentReduction(
                      context, input, indices, segment_ids, has_num_segments_));
 
+    ComputeReduction(context, input, indices, segment_ids,
+                     has_num_segments_ ? &context->input(3) : nullptr);
+  }
+
+ protected:
+  // Reduces the rows of `input` selected by `indices` into the segments given
+  // by `segment_ids`, writing the result to output 0. If `num_segments` is
+  // null the number of output rows is the last segment id plus one. The inputs
+  // must already have been validated to be of compatible shapes.
+  void ComputeReduction(OpKernelContext* context, const Tensor& input,
+                        const Tensor& indices, const Tensor& segment_ids,
+                        const Tensor* num_segments) {
     Index output_rows = -1;
-    if (has_num_segments_) {
-      const Tensor& num_segments = context->input(3);
-      // Note that there is a Tnumsegments parameter on the op, but it is not
-      // plumbed through to here and so always takes its default value of int32.
-      output_rows = internal::SubtleMustCopy(num_segments.scalar<int32>()());
+    if (num_segments != nullptr) {
+      output_rows = num_segments->dtype() == DT_INT32
+                        ? internal::SubtleMustCopy(
+                              num_segments->scalar<int32>()())
+                        : internal::SubtleMustCopy(
+                              num_segments->scalar<int64_t>()());
     }
     const int64_t num_indices = indices.NumElements();
 
@@ -564,7 +812,7 @@ class SparseSegmentReductionOpBase : public OpKernel {
             ? internal::SubtleMustCopy(segment_vec(num_indices - 1)) + 1
             : 0;
 
-    if (has_num_segments_) {
+    if (num_segments != nullptr) {
       OP_REQUIRES(
           context, output_rows >= last_segment_id_plus_one,
           errors::InvalidArgument("segment ids must be < num_segments"));
@@ -634,6 +882,15 @@ class SparseSegmentReductionOpBase : public OpKernel {
         gap_slice.setConstant(default_value_);
       }
 
+      // The rows of the next segment are gathered from arbitrary offsets in
+      // `input`, which defeats the hardware prefetcher for large embedding
+      // tables. Issue prefetches for them so that the loads overlap with the
+      // reduction of the current segment.
+      if (end < num_indices) {
+        PrefetchRows(input_flat, indices_vec, end,
+                     std::min<int64_t>(num_indices - end, kPrefetchRows));
+      }
+
       auto out = output_flat.template chip<0>(out_index);
       auto temp = temp_flat.template chip<0>(out_index);
       const int bad_offset = Reduce<T, Index>(input_flat, indices_vec, start,
@@ -662,6 +919,29 @@ class SparseSegmentReductionOpBase : public OpKernel {
   }
 
  private:
+  // Maximum number of rows of the next segment to prefetch.
+  static constexpr int64_t kPrefetchRows = 8;
+  // Maximum number of cache lines to prefetch per row.
+  static constexpr int64_t kPrefetchLinesPerRow = 8;
+
+  void PrefetchRows(const typename TTypes<T>::ConstMatrix& input_flat,
+                    const typename TTypes<Index>::ConstVec& indices_vec,
+                    int64_t start, int64_t num) {
+    constexpr int64_t kLineElements = 64 / sizeof(T);
+    const int64_t num_col = input_flat.dimension(1);
+    const int64_t num_lines = std::min<int64_t>(
+        (num_col + kLineElements - 1) / kLineElements, kPrefetchLinesPerRow);
+    for (int64_t i = 0; i < num; ++i) {
+      const Index index = indices_vec(start + i);
+      // Out of range indices are reported by Reduce.
+      if (!FastBoundsCheck(index, input_flat.dimension(0))) continue;
+      const T* row = &input_flat(index, 0);
+      for (int64_t line = 0; line < num_lines; ++line) {
+        port::prefetch<port::PREFETCH_HINT_T0>(row + line * kLineElements);
+      }
+    }
+  }
+
   const DataType dtidx_;
   template <typename Tin>
   using EnableIfBfloat16OrHalf =
@@ -105,6 +105,7 @@ static void BM_UnsortedSegmentReduction(::testing::benchmark::State& state,
 
 BM_UnsortedReduce_Arg(4096, 1024, 1);
 BM_UnsortedReduce_Arg(4096, 1024, 128);
+BM_UnsortedReduce_Arg(131072, 64, 4);
 
 template <typename Index>
 static void BM_SegmentReduction(::testing::benchmark::State& state,
@@ -180,6 +181,7 @@ BM_Reduce_Arg(16, 8, 2);
 BM_Reduce_Arg(64, 32, 2);
 BM_Reduce_Arg(4096, 32, 2);
 BM_Reduce_Arg(4096, 128, 2);
+BM_Reduce_Arg(131072, 64, 32768);
 
 template <DataType T>
 static void SparseSegmentMeanGradHelper(::testing::benchmark::State& state,
@@ -326,6 +326,68 @@ class StringCrosser {
   const tstring k_feature_separator_;
 };
 
+// Generates all the hashed crosses of a batch in the order of
+// ProductIterator. The features of every column are hashed once, and the
+// hash of every prefix of a cross is shared by all the crosses that extend
+// it, so that a cross only combines the hashes of the columns that changed
+// since the previous one. If `use_hash_key`, the hash of a cross starts from
+// `hash_key`, otherwise from the hash of its first feature.
+template <typename Updater>
+void GenerateHashedCrosses(
+    const std::vector<std::unique_ptr<ColumnInterface<int64_t>>>& columns,
+    const int64_t batch_index, const bool use_hash_key, const uint64 hash_key,
+    const int64_t num_buckets, const bool strong_hash,
+    const Updater& updater) {
+  const int num_columns = columns.size();
+  gtl::InlinedVector<std::vector<uint64>, 6> hashes(num_columns);
+  for (int i = 0; i < num_columns; ++i) {
+    const int64_t feature_count = columns[i]->FeatureCount(batch_index);
+    if (feature_count == 0) return;
+    hashes[i].resize(feature_count);
+    for (int64_t n = 0; n < feature_count; ++n) {
+      hashes[i][n] = columns[i]->Feature(batch_index, n, strong_hash);
+    }
+  }
+
+  gtl::InlinedVector<int64_t, 6> next(num_columns, 0);
+  gtl::InlinedVector<uint64, 6> prefix_hash(num_columns);
+  auto update_prefix_hashes = [&](int first) {
+    for (int i = first; i < num_columns; ++i) {
+      const uint64 hash_i = hashes[i][next[i]];
+      if (i > 0) {
+        prefix_hash[i] = FingerprintCat64(prefix_hash[i - 1], hash_i);
+      } else if (use_hash_key) {
+        prefix_hash[i] = FingerprintCat64(hash_key, hash_i);
+      } else {
+        prefix_hash[i] = hash_i;
+      }
+    }
+  };
+  update_prefix_hashes(0);
+
+  int64_t cross_count = 0;
+  while (true) {
+    const uint64 hashed_output = prefix_hash[num_columns - 1];
+    // The return value is int64 based on the number of buckets.
+    if (num_buckets > 0) {
+      updater.Update(batch_index, cross_count, hashed_output % num_buckets);
+    } else {
+      // To prevent negative output we take modulo to max int64.
+      updater.Update(batch_index, cross_count,
+                     hashed_output % std::numeric_limits<int64_t>::max());
+    }
+    ++cross_count;
+
+    int i = num_columns - 1;
+    while (i >= 0 && ++next[i] == static_cast<int64_t>(hashes[i].size())) {
+      next[i] = 0;
+      --i;
+    }
+    if (i < 0) break;
+    update_prefix_hashes(i);
+  }
+}
+
 // Generates the sparse crosses as nested hash to avoid string manipulations.
 class HashCrosser {
  public:
@@ -353,6 +415,16 @@ class HashCrosser {
     }
   }
 
+  // Generates all the crosses of a batch, equivalent to calling Generate on
+  // every permutation of a ProductIterator.
+  template <typename Updater>
+  void GenerateAll(const int64_t batch_index, bool unused_strong_hash,
+                   const Updater& updater) const {
+    GenerateHashedCrosses(columns_, batch_index, /*use_hash_key=*/true,
+                          hash_key_, num_buckets_, /*strong_hash=*/false,
+                          updater);
+  }
+
  private:
   const std::vector<std::unique_ptr<ColumnInterface<int64_t>>>& columns_;
   const int64_t num_buckets_;
@@ -388,6 +460,15 @@ class HashCrosserV2 {
     }
   }
 
+  // Generates all the crosses of a batch, equivalent to calling Generate on
+  // every permutation of a ProductIterator.
+  template <typename Updater>
+  void GenerateAll(const int64_t batch_index, bool strong_hash,
+                   const Updater& updater) const {
+    GenerateHashedCrosses(columns_, batch_index, /*use_hash_key=*/false,
+                          /*hash_key=*/0, num_buckets_, strong_hash, updater);
+  }
+
  private:
   const std::vector<std::unique_ptr<ColumnInterface<int64_t>>>& columns_;
   const int64_t num_buckets_;
@@ -787,6 +868,12 @@ class SparseCrossOp : public OpKernel {
         output_start_indices, indices_out, values_out);
     auto do_work = [&columns, crosser, updater](int64_t begin, int64_t end) {
       for (int b = begin; b < end; b++) {
+        if constexpr (HASHED_OUTPUT) {
+          if (!columns.empty()) {
+            crosser.GenerateAll(b, false, updater);
+            continue;
+          }
+        }
         ProductIterator<InternalType> product_iterator(columns, b);
         int64_t cross_count = 0;
         while (product_iterator.HasNext()) {
@@ -938,6 +1025,10 @@ class SparseCrossHashedOp : public OpKernel {
     auto do_work = [&columns, crosser, updater, strong_hash](int64_t begin,
                                                              int64_t end) {
       for (int b = begin; b < end; b++) {
+        if (!columns.empty()) {
+          crosser.GenerateAll(b, strong_hash, updater);
+          continue;
+        }
         ProductIterator<int64_t> product_iterator(columns, b);
         int64_t cross_count = 0;
         while (product_iterator.HasNext()) {
@@ -0,0 +1,221 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <vector>
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/strong_hash.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// The string features of every batch row of every column, indexed as
+// features[column][row].
+using Features = std::vector<std::vector<std::vector<tstring>>>;
+
+// Four batch rows of two sparse columns followed by a dense column. Every
+// column has several features in most rows, and row 1 has no cross because
+// its second column is empty.
+constexpr int kNumSparse = 2;
+constexpr int kBatchSize = 4;
+
+Features MultiFeatureRows() {
+  return {{{"a", "b", "c"}, {"d"}, {"e", "f"}, {"g"}},
+          {{"x", "y"}, {}, {"z", "w", "v"}, {"u"}},
+          {{"p0", "q0"}, {"p1", "q1"}, {"p2", "q2"}, {"p3", "q3"}}};
+}
+
+// Appends the crosses of `row` as the kernels computed them from a
+// ProductIterator before GenerateHashedCrosses: the features of every cross
+// are hashed one at a time with `hash` and combined with FingerprintCat64,
+// starting from `hash_key` if it is set.
+void AppendExpectedCrosses(const Features& features, int row,
+                           const std::function<uint64(const tstring&)>& hash,
+                           std::optional<uint64> hash_key,
+                           int64_t num_buckets, std::vector<int64_t>* indices,
+                           std::vector<int64_t>* values) {
+  const int num_columns = features.size();
+  for (int i = 0; i < num_columns; ++i) {
+    if (features[i][row].empty()) return;
+  }
+  std::vector<int> permutation(num_columns, 0);
+  int64_t cross_count = 0;
+  while (true) {
+    std::optional<uint64> hashed_output = hash_key;
+    for (int i = 0; i < num_columns; ++i) {
+      const uint64 hash_i = hash(features[i][row][permutation[i]]);
+      hashed_output = hashed_output.has_value()
+                          ? FingerprintCat64(*hashed_output, hash_i)
+                          : hash_i;
+    }
+    indices->push_back(row);
+    indices->push_back(cross_count++);
+    values->push_back(num_buckets > 0
+                          ? *hashed_output % num_buckets
+                          : *hashed_output %
+                                std::numeric_limits<int64_t>::max());
+
+    int i = num_columns - 1;
+    while (i >= 0 &&
+           ++permutation[i] == static_cast<int>(features[i][row].size())) {
+      permutation[i] = 0;
+      --i;
+    }
+    if (i < 0) return;
+  }
+}
+
+class SparseCrossOpTest : public OpsTestBase {
+ protected:
+  // Adds the indices, values and shapes of the first kNumSparse columns of
+  // `features` as sparse inputs, followed by the other columns as dense
+  // inputs.
+  void AddFeatureInputs(const Features& features) {
+    std::vector<std::vector<int64_t>> indices(kNumSparse);
+    std::vector<std::vector<tstring>> values(kNumSparse);
+    std::vector<int64_t> max_counts(kNumSparse, 0);
+    for (int i = 0; i < kNumSparse; ++i) {
+      for (int b = 0; b < kBatchSize; ++b) {
+        const auto& row = features[i][b];
+        for (int n = 0; n < row.size(); ++n) {
+          indices[i].push_back(b);
+          indices[i].push_back(n);
+          values[i].push_back(row[n]);
+        }
+        max_counts[i] = std::max<int64_t>(max_counts[i], row.size());
+      }
+    }
+    for (int i = 0; i < kNumSparse; ++i) {
+      AddInputFromArray<int64_t>(
+          TensorShape({static_cast<int64_t>(values[i].size()), 2}),
+          indices[i]);
+    }
+    for (int i = 0; i < kNumSparse; ++i) {
+      AddInputFromArray<tstring>(
+          TensorShape({static_cast<int64_t>(values[i].size())}), values[i]);
+    }
+    for (int i = 0; i < kNumSparse; ++i) {
+      AddInputFromArray<int64_t>(TensorShape({2}), {kBatchSize, max_counts[i]});
+    }
+    for (int i = kNumSparse; i < features.size(); ++i) {
+      std::vector<tstring> dense;
+      for (int b = 0; b < kBatchSize; ++b) {
+        dense.insert(dense.end(), features[i][b].begin(),
+                     features[i][b].end());
+      }
+      const int64_t width = features[i][0].size();
+      AddInputFromArray<tstring>(TensorShape({kBatchSize, width}), dense);
+    }
+  }
+
+  // Checks the output SparseTensor against the crosses of every row
+  // computed by AppendExpectedCrosses.
+  void ExpectCrosses(const Features& features,
+                     const std::function<uint64(const tstring&)>& hash,
+                     std::optional<uint64> hash_key, int64_t num_buckets) {
+    std::vector<int64_t> indices;
+    std::vector<int64_t> values;
+    int64_t max_cross_count = 0;
+    for (int b = 0; b < kBatchSize; ++b) {
+      const int64_t start = values.size();
+      AppendExpectedCrosses(features, b, hash, hash_key, num_buckets, &indices,
+                            &values);
+      max_cross_count = std::max<int64_t>(max_cross_count,
+                                          values.size() - start);
+    }
+    const int64_t num_crosses = values.size();
+    test::ExpectTensorEqual<int64_t>(
+        *GetOutput(0),
+        test::AsTensor<int64_t>(indices, TensorShape({num_crosses, 2})));
+    test::ExpectTensorEqual<int64_t>(*GetOutput(1),
+                                     test::AsTensor<int64_t>(values));
+    test::ExpectTensorEqual<int64_t>(
+        *GetOutput(2), test::AsTensor<int64_t>({kBatchSize, max_cross_count}));
+  }
+};
+
+TEST_F(SparseCrossOpTest, HashedCrossesMatchProductIterator) {
+  constexpr uint64 kHashKey = 0xDECAFCAFFE;
+  const Features features = MultiFeatureRows();
+  for (const int64_t num_buckets : {0, 100}) {
+    TF_ASSERT_OK(NodeDefBuilder("sparse_cross", "SparseCross")
+                     .Input(FakeInput(kNumSparse, DT_INT64))
+                     .Input(FakeInput({DT_STRING, DT_STRING}))
+                     .Input(FakeInput(kNumSparse, DT_INT64))
+                     .Input(FakeInput({DT_STRING}))
+                     .Attr("hashed_output", true)
+                     .Attr("num_buckets", num_buckets)
+                     .Attr("hash_key", static_cast<int64_t>(kHashKey))
+                     .Attr("out_type", DT_INT64)
+                     .Attr("internal_type", DT_INT64)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+    inputs_.clear();
+    AddFeatureInputs(features);
+    TF_ASSERT_OK(RunOpKernel());
+    ExpectCrosses(
+        features, [](const tstring& s) { return Fingerprint64(s); }, kHashKey,
+        num_buckets);
+  }
+}
+
+TEST_F(SparseCrossOpTest, HashedV2CrossesMatchProductIterator) {
+  const Features features = MultiFeatureRows();
+  const uint64 key[2] = {137, 97};
+  for (const bool strong_hash : {false, true}) {
+    for (const int64_t num_buckets : {0, 100}) {
+      TF_ASSERT_OK(NodeDefBuilder("sparse_cross", "SparseCrossHashed")
+                       .Input(FakeInput(kNumSparse, DT_INT64))
+                       .Input(FakeInput({DT_STRING, DT_STRING}))
+                       .Input(FakeInput(kNumSparse, DT_INT64))
+                       .Input(FakeInput({DT_STRING}))
+                       .Input(FakeInput(DT_INT64))
+                       .Input(FakeInput(DT_BOOL))
+                       .Input(FakeInput(DT_INT64))
+                       .Finalize(node_def()));
+      TF_ASSERT_OK(InitOp());
+      inputs_.clear();
+      AddFeatureInputs(features);
+      AddInputFromArray<int64_t>(TensorShape({}), {num_buckets});
+      AddInputFromArray<bool>(TensorShape({}), {strong_hash});
+      AddInputFromArray<int64_t>(TensorShape({2}),
+                                 {static_cast<int64_t>(key[0]),
+                                  static_cast<int64_t>(key[1])});
+      TF_ASSERT_OK(RunOpKernel());
+      ExpectCrosses(
+          features,
+          [&key, strong_hash](const tstring& s) {
+            return strong_hash ? StrongKeyedHash(key, s) : Fingerprint64(s);
+          },
+          /*hash_key=*/std::nullopt, num_buckets);
+    }
+  }
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -19,17 +19,50 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/sparse_tensor_dense_matmul_op.h"
 
+#include <algorithm>
+#include <vector>
+
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/kernels/fill_functor.h"
 #include "tensorflow/core/platform/bfloat16.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
 typedef Eigen::ThreadPoolDevice CPUDevice;
 typedef Eigen::GpuDevice GPUDevice;
 
+namespace functor {
+
+// The structure of the sparse operand in compressed sparse row format, where
+// the rows are the rows of the output (i.e. of adjoint(A) if adjoint_a).
+struct SparseTensorDenseMatMulCsr {
+  int64_t num_rows = 0;
+  int64_t num_cols = 0;
+
+  // The entries of row r are [row_ptr[r], row_ptr[r + 1]).
+  std::vector<int64_t> row_ptr;
+  // The column of every entry, and its position in a_values.
+  std::vector<int64_t> col;
+  std::vector<int64_t> value_index;
+};
+
+template <typename Tindices, bool ADJ_A>
+Status BuildSparseTensorDenseMatMulCsr(
+    typename TTypes<Tindices>::ConstMatrix a_indices, int64_t num_rows,
+    int64_t num_cols, SparseTensorDenseMatMulCsr* csr);
+
+template <typename T, bool ADJ_A, bool ADJ_B>
+Status SparseTensorDenseMatMulCsrImpl(OpKernelContext* ctx,
+                                      const SparseTensorDenseMatMulCsr& csr,
+                                      typename TTypes<T>::Matrix out,
+                                      typename TTypes<T>::ConstVec a_values,
+                                      typename TTypes<T>::ConstMatrix b);
+
+}  // namespace functor
+
 template <typename Device, typename T, typename Tindices>
 class SparseTensorDenseMatMulOp : public OpKernel {
  public:
@@ -133,6 +166,35 @@ class SparseTensorDenseMatMulOp : public OpKernel {
       return;
     }
 
+    if constexpr (std::is_same<Device, CPUDevice>::value) {
+      const auto* worker_threads =
+          ctx->device()->tensorflow_cpu_worker_threads();
+      if (worker_threads->num_threads > 1 &&
+          nnz * outer_right >= kMinCsrSize) {
+        // Building the structure reads every index once, which is cheap
+        // next to the nnz * output.shape[1] multiply-adds of the product.
+        functor::SparseTensorDenseMatMulCsr csr;
+        OP_REQUIRES_OK(ctx,
+                       BuildCsr(*a_indices, outer_left, inner_left, &csr));
+
+#define MAYBE_ADJOINT_CSR(ADJ_A, ADJ_B)                                    \
+  if (adjoint_a_ == ADJ_A && adjoint_b_ == ADJ_B) {                        \
+    OP_REQUIRES_OK(                                                        \
+        ctx, (functor::SparseTensorDenseMatMulCsrImpl<T, ADJ_A, ADJ_B>(    \
+                 ctx, csr, out->matrix<T>(), a_values->vec<T>(),           \
+                 b->matrix<T>())));                                        \
+  }
+
+        MAYBE_ADJOINT_CSR(false, false);
+        MAYBE_ADJOINT_CSR(false, true);
+        MAYBE_ADJOINT_CSR(true, false);
+        MAYBE_ADJOINT_CSR(true, true);
+
+#undef MAYBE_ADJOINT_CSR
+        return;
+      }
+    }
+
 #define MAYBE_ADJOINT(ADJ_A, ADJ_B)                                           \
   if (adjoint_a_ == ADJ_A && adjoint_b_ == ADJ_B) {                           \
     Status functor_status = functor::SparseTensorDenseMatMulFunctor<          \
@@ -151,6 +213,23 @@ class SparseTensorDenseMatMulOp : public OpKernel {
   }
 
  private:
+  // Minimum value of nnz(a) * output.shape[1] for which the product is
+  // computed in CSR format on multiple threads.
+  static constexpr int64_t kMinCsrSize = 1 << 16;
+
+  // Builds the CSR structure of `a_indices`.
+  Status BuildCsr(const Tensor& a_indices, int64_t num_rows, int64_t num_cols,
+                  functor::SparseTensorDenseMatMulCsr* csr) {
+    csr->num_rows = num_rows;
+    csr->num_cols = num_cols;
+    if (adjoint_a_) {
+      return functor::BuildSparseTensorDenseMatMulCsr<Tindices, true>(
+          a_indices.matrix<Tindices>(), num_rows, num_cols, csr);
+    }
+    return functor::BuildSparseTensorDenseMatMulCsr<Tindices, false>(
+        a_indices.matrix<Tindices>(), num_rows, num_cols, csr);
+  }
+
   bool adjoint_a_;
   bool adjoint_b_;
 };
@@ -323,6 +402,118 @@ Status SparseTensorDenseMatMulImpl(
 }
 }  // namespace
 
+template <typename Tindices, bool ADJ_A>
+Status BuildSparseTensorDenseMatMulCsr(
+    typename TTypes<Tindices>::ConstMatrix a_indices, int64_t num_rows,
+    int64_t num_cols, SparseTensorDenseMatMulCsr* csr) {
+  const int lhs_index_a = ADJ_A ? 1 : 0;
+  const int rhs_index_a = ADJ_A ? 0 : 1;
+  const int64_t nnz = a_indices.dimension(0);
+
+  // Read every index once, and count the entries of every row.
+  std::vector<int64_t> rows(nnz);
+  std::vector<int64_t> cols(nnz);
+  csr->row_ptr.assign(num_rows + 1, 0);
+  for (int64_t i = 0; i < nnz; ++i) {
+    const Tindices m = internal::SubtleMustCopy(a_indices(i, lhs_index_a));
+    const Tindices k = internal::SubtleMustCopy(a_indices(i, rhs_index_a));
+    if (!FastBoundsCheck(k, num_cols)) {
+      return KOutOfBoundsError(k, i, rhs_index_a, num_cols);
+    }
+    if (!FastBoundsCheck(m, num_rows)) {
+      return MOutOfBoundsError(m, i, lhs_index_a, num_rows);
+    }
+    rows[i] = m;
+    cols[i] = k;
+    ++csr->row_ptr[m + 1];
+  }
+  for (int64_t r = 0; r < num_rows; ++r) {
+    csr->row_ptr[r + 1] += csr->row_ptr[r];
+  }
+
+  // Bucket the entries by row, keeping the order of the entries of a row.
+  std::vector<int64_t> next(csr->row_ptr.begin(), csr->row_ptr.end() - 1);
+  csr->col.resize(nnz);
+  csr->value_index.resize(nnz);
+  for (int64_t i = 0; i < nnz; ++i) {
+    const int64_t pos = next[rows[i]]++;
+    csr->col[pos] = cols[i];
+    csr->value_index[pos] = i;
+  }
+  return OkStatus();
+}
+
+template <typename T, bool ADJ_A, bool ADJ_B>
+Status SparseTensorDenseMatMulCsrImpl(OpKernelContext* ctx,
+                                      const SparseTensorDenseMatMulCsr& csr,
+                                      typename TTypes<T>::Matrix out,
+                                      typename TTypes<T>::ConstVec a_values,
+                                      typename TTypes<T>::ConstMatrix b) {
+  using Tsum = typename SumType<T>::type;
+  const CPUDevice& d = ctx->eigen_device<CPUDevice>();
+  const int64_t num_rows = csr.num_rows;
+  const int64_t rhs_right = out.dimension(1);
+
+  // Perform transpose and conjugation on B once, so that every entry of A
+  // reads a contiguous row of B.
+  Tensor b_adj_t;
+  if (ADJ_B) {
+    TF_RETURN_IF_ERROR(ctx->allocate_temp(
+        DataTypeToEnum<T>::value,
+        TensorShape({b.dimension(1), b.dimension(0)}), &b_adj_t));
+    Eigen::array<int, 2> shuffle{1, 0};
+    b_adj_t.matrix<T>().device(d) = b.shuffle(shuffle).conjugate();
+  }
+  const Tensor& b_adj = b_adj_t;
+  typename TTypes<T>::ConstMatrix b_rows = ADJ_B ? b_adj.matrix<T>() : b;
+
+  // Split the rows into shards of about the same number of entries plus rows,
+  // so that skewed rows do not unbalance the threads.
+  const auto* worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+  const int64_t nnz = csr.col.size();
+  const int64_t total_cost = nnz + num_rows;
+  const int64_t num_shards =
+      std::min<int64_t>(4 * worker_threads->num_threads, num_rows);
+  std::vector<int64_t> shard_rows(num_shards + 1);
+  for (int64_t s = 0; s <= num_shards; ++s) {
+    const int64_t target = total_cost * s / num_shards;
+    int64_t lo = 0, hi = num_rows;
+    while (lo < hi) {
+      const int64_t mid = lo + (hi - lo) / 2;
+      if (csr.row_ptr[mid] + mid < target) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    shard_rows[s] = lo;
+  }
+  shard_rows[num_shards] = num_rows;
+
+  auto work = [&](int64_t first, int64_t last) {
+    Eigen::Tensor<Tsum, 1, Eigen::RowMajor> acc(rhs_right);
+    for (int64_t s = first; s < last; ++s) {
+      for (int64_t m = shard_rows[s]; m < shard_rows[s + 1]; ++m) {
+        acc.setZero();
+        for (int64_t j = csr.row_ptr[m]; j < csr.row_ptr[m + 1]; ++j) {
+          const T a_value = ADJ_A ? MaybeConj(a_values(csr.value_index[j]))
+                                  : a_values(csr.value_index[j]);
+          acc += b_rows.template chip<0>(csr.col[j]).template cast<Tsum>() *
+                 static_cast<Tsum>(a_value);
+        }
+        out.template chip<0>(m) = acc.template cast<T>();
+      }
+    }
+  };
+  const int64_t cost_per_shard =
+      Eigen::divup(total_cost, num_shards) * rhs_right *
+      (Eigen::TensorOpCost::AddCost<Tsum>() +
+       Eigen::TensorOpCost::MulCost<Tsum>());
+  Shard(worker_threads->num_threads, worker_threads->workers, num_shards,
+        cost_per_shard, work);
+  return OkStatus();
+}
+
 template <typename T, typename Tindices, bool ADJ_A, bool ADJ_B>
 struct SparseTensorDenseMatMulFunctor<CPUDevice, T, Tindices, ADJ_A, ADJ_B> {
   static Status Compute(OpKernelContext* ctx, typename TTypes<T>::Matrix out,
@@ -14,15 +14,117 @@ limitations under the License.
 ==============================================================================*/
 
 #include <random>
+#include <vector>
 
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
+#include "tensorflow/core/platform/threadpool.h"
 
 namespace tensorflow {
 
+class SparseTensorDenseMatMulOpTest : public OpsTestBase {
+ protected:
+  // Runs the op with `num_threads` CPU worker threads. Products of at least
+  // 2^16 multiply-adds use the CSR kernel when there is more than one thread,
+  // and the COO kernel otherwise.
+  Status RunWithThreads(int num_threads) {
+    thread::ThreadPool pool(Env::Default(), "test", num_threads);
+    DeviceBase::CpuWorkerThreads worker_threads;
+    worker_threads.num_threads = num_threads;
+    worker_threads.workers = &pool;
+    const DeviceBase::CpuWorkerThreads* original =
+        device_->tensorflow_cpu_worker_threads();
+    device_->set_tensorflow_cpu_worker_threads(&worker_threads);
+    Status s = RunOpKernel();
+    device_->set_tensorflow_cpu_worker_threads(
+        const_cast<DeviceBase::CpuWorkerThreads*>(original));
+    return s;
+  }
+
+  // Multiplies a random [m, k] sparse matrix with `nnz` entries, a quarter of
+  // which are in row 0, by a random [k, n] matrix.
+  void MakeOp(int nnz, int m, int k, int n, bool adjoint_a, bool adjoint_b,
+              int64_t bad_index = -1) {
+    TF_ASSERT_OK(NodeDefBuilder("matmul", "SparseTensorDenseMatMul")
+                     .Input(FakeInput(DT_INT64))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_INT64))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Attr("adjoint_a", adjoint_a)
+                     .Attr("adjoint_b", adjoint_b)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+
+    // Small integers, so that the products are exact in any order.
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<> value_dist(-3, 3);
+    std::uniform_int_distribution<> row_dist(0, m - 1);
+    std::uniform_int_distribution<> col_dist(0, k - 1);
+    std::vector<int64_t> indices;
+    std::vector<float> values;
+    for (int i = 0; i < nnz; ++i) {
+      const int64_t row = i % 4 == 0 ? 0 : row_dist(gen);
+      const int64_t col = i == bad_index ? k : col_dist(gen);
+      if (adjoint_a) {
+        indices.insert(indices.end(), {col, row});
+      } else {
+        indices.insert(indices.end(), {row, col});
+      }
+      values.push_back(value_dist(gen));
+    }
+    std::vector<float> b(k * n);
+    for (float& v : b) v = value_dist(gen);
+
+    AddInputFromArray<int64_t>(TensorShape({nnz, 2}), indices);
+    AddInputFromArray<float>(TensorShape({nnz}), values);
+    AddInputFromArray<int64_t>(TensorShape({2}),
+                               adjoint_a ? std::vector<int64_t>{k, m}
+                                         : std::vector<int64_t>{m, k});
+    AddInputFromArray<float>(
+        adjoint_b ? TensorShape({n, k}) : TensorShape({k, n}), b);
+  }
+
+  void ExpectCsrMatchesCoo(bool adjoint_a, bool adjoint_b) {
+    MakeOp(/*nnz=*/4096, /*m=*/300, /*k=*/200, /*n=*/64, adjoint_a,
+           adjoint_b);
+    TF_ASSERT_OK(RunWithThreads(1));
+    const Tensor coo = *GetOutput(0);
+    TF_ASSERT_OK(RunWithThreads(4));
+    test::ExpectTensorEqual<float>(*GetOutput(0), coo);
+  }
+};
+
+TEST_F(SparseTensorDenseMatMulOpTest, CsrMatchesCoo) {
+  ExpectCsrMatchesCoo(false, false);
+}
+
+TEST_F(SparseTensorDenseMatMulOpTest, CsrMatchesCooAdjointA) {
+  ExpectCsrMatchesCoo(true, false);
+}
+
+TEST_F(SparseTensorDenseMatMulOpTest, CsrMatchesCooAdjointB) {
+  ExpectCsrMatchesCoo(false, true);
+}
+
+TEST_F(SparseTensorDenseMatMulOpTest, CsrMatchesCooAdjointAB) {
+  ExpectCsrMatchesCoo(true, true);
+}
+
+TEST_F(SparseTensorDenseMatMulOpTest, CsrOutOfBoundsIndex) {
+  MakeOp(/*nnz=*/4096, /*m=*/300, /*k=*/200, /*n=*/64, false, false,
+         /*bad_index=*/1001);
+  Status s = RunWithThreads(4);
+  EXPECT_TRUE(errors::IsInvalidArgument(s)) << s;
+}
+
 Node* SparseTensorDenseMatMulNode(Graph* g, Node* a_indices, Node* a_values,
                                   Node* a_shape, Node* b, bool adjoint_a,
                                   bool adjoint_b) {
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_STRING_TO_HASH_BUCKET_FAST_OP_H_
 #define TENSORFLOW_CORE_KERNELS_STRING_TO_HASH_BUCKET_FAST_OP_H_
 
+#include <algorithm>
 #include <string>
 
 #include "tensorflow/core/framework/op_kernel.h"
@@ -23,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -44,18 +46,39 @@ class StringToHashBucketOp : public OpKernel {
                                             &output_tensor));
     auto output_flat = output_tensor->flat<int64_t>();
 
-    typedef decltype(input_flat.size()) Index;
-    for (Index i = 0; i < input_flat.size(); ++i) {
-      const uint64 input_hash = hash(input_flat(i));
-      const uint64 bucket_id = input_hash % num_buckets_;
-      // The number of buckets is always in the positive range of int64 so is
-      // the resulting bucket_id. Casting the bucket_id from uint64 to int64 is
-      // safe.
-      output_flat(i) = static_cast<int64_t>(bucket_id);
+    const int64_t num_elements = input_flat.size();
+    auto hash_range = [&](int64_t start, int64_t limit) {
+      for (int64_t i = start; i < limit; ++i) {
+        const uint64 input_hash = hash(input_flat(i));
+        const uint64 bucket_id = input_hash % num_buckets_;
+        // The number of buckets is always in the positive range of int64 so
+        // is the resulting bucket_id. Casting the bucket_id from uint64 to
+        // int64 is safe.
+        output_flat(i) = static_cast<int64_t>(bucket_id);
+      }
+    };
+
+    // Estimate the cost of hashing a string from the length of the first
+    // few, so that batches of short strings are not split too finely.
+    const int64_t num_samples = std::min<int64_t>(num_elements, kNumSamples);
+    int64_t sample_bytes = 0;
+    for (int64_t i = 0; i < num_samples; ++i) {
+      sample_bytes += input_flat(i).size();
     }
+    const int64_t cost_per_string =
+        kFixedCostPerString +
+        (num_samples > 0 ? sample_bytes / num_samples : 0);
+    auto* worker_threads = context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers, num_elements,
+          cost_per_string, hash_range);
   }
 
  private:
+  // The number of strings whose length is used to estimate the cost.
+  static constexpr int64_t kNumSamples = 64;
+  // The cost of hashing a string, in addition to a cycle per byte.
+  static constexpr int64_t kFixedCostPerString = 20;
+
   int64_t num_buckets_;
 
   TF_DISALLOW_COPY_AND_ASSIGN(StringToHashBucketOp);
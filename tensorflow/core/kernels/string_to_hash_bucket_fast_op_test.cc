@@ -0,0 +1,78 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <vector>
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/strcat.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class StringToHashBucketFastOpTest : public OpsTestBase {
+ protected:
+  void MakeOp(int64_t num_buckets) {
+    TF_ASSERT_OK(NodeDefBuilder("hash", "StringToHashBucketFast")
+                     .Input(FakeInput(DT_STRING))
+                     .Attr("num_buckets", num_buckets)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+};
+
+TEST_F(StringToHashBucketFastOpTest, SmallInput) {
+  MakeOp(10);
+  AddInputFromArray<tstring>(TensorShape({2, 2}), {"a", "b", "", "abc"});
+  TF_ASSERT_OK(RunOpKernel());
+  test::ExpectTensorEqual<int64_t>(
+      *GetOutput(0),
+      test::AsTensor<int64_t>({static_cast<int64_t>(Fingerprint64("a") % 10),
+                               static_cast<int64_t>(Fingerprint64("b") % 10),
+                               static_cast<int64_t>(Fingerprint64("") % 10),
+                               static_cast<int64_t>(Fingerprint64("abc") % 10)},
+                              TensorShape({2, 2})));
+}
+
+TEST_F(StringToHashBucketFastOpTest, ShardedLargeInput) {
+  // Enough strings to be split across the worker threads. The strings used
+  // to estimate the cost are shorter than the rest, which must not change
+  // the result.
+  constexpr int64_t kNumStrings = 100000;
+  constexpr int64_t kNumBuckets = 1000;
+  MakeOp(kNumBuckets);
+  std::vector<tstring> input(kNumStrings);
+  std::vector<int64_t> expected(kNumStrings);
+  for (int64_t i = 0; i < kNumStrings; ++i) {
+    const std::string suffix = i < 64 ? "" : std::string(i % 200, 'x');
+    input[i] = strings::StrCat(i, suffix);
+    expected[i] = Fingerprint64(input[i]) % kNumBuckets;
+  }
+  AddInputFromArray<tstring>(TensorShape({kNumStrings}), input);
+  TF_ASSERT_OK(RunOpKernel());
+  test::ExpectTensorEqual<int64_t>(*GetOutput(0),
+                                   test::AsTensor<int64_t>(expected));
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -23,6 +23,7 @@ limitations under the License.
 #include "tensorflow/core/summary/schema.h"
 #include "tensorflow/core/summary/summary_db_writer.h"
 #include "tensorflow/core/summary/summary_file_writer.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/event.pb.h"
 
 namespace tensorflow {
@@ -33,7 +34,20 @@ REGISTER_KERNEL_BUILDER(Name("SummaryWriter").Device(DEVICE_CPU),
 class CreateSummaryFileWriterOp : public OpKernel {
  public:
   explicit CreateSummaryFileWriterOp(OpKernelConstruction* ctx)
-      : OpKernel(ctx) {}
+      : OpKernel(ctx) {
+    // Writing summaries on a background thread is opt-in for now, since it
+    // delays the errors of malformed summaries to later writes or flushes.
+    OP_REQUIRES_OK(ctx, ReadBoolFromEnvVar("TF_SUMMARY_WRITER_ASYNC",
+                                           /*default_val=*/false,
+                                           &options_.async));
+    OP_REQUIRES_OK(ctx, ReadInt64FromEnvVar("TF_SUMMARY_WRITER_MAX_PENDING_MB",
+                                            options_.max_pending_bytes >> 20,
+                                            &options_.max_pending_bytes));
+    options_.max_pending_bytes <<= 20;
+    OP_REQUIRES_OK(ctx, ReadBoolFromEnvVar("TF_SUMMARY_WRITER_DROP_WHEN_FULL",
+                                           /*default_val=*/false,
+                                           &options_.drop_when_full));
+  }
 
   void Compute(OpKernelContext* ctx) override {
     const Tensor* tmp;
@@ -57,13 +71,19 @@ class CreateSummaryFileWriterOp : public OpKernel {
     core::RefCountPtr<SummaryWriterInterface> s;
     OP_REQUIRES_OK(ctx, LookupOrCreateResource<SummaryWriterInterface>(
                             ctx, HandleFromInput(ctx, 0), &s,
-                            [max_queue, flush_millis, logdir, filename_suffix,
-                             ctx](SummaryWriterInterface** s) {
+                            [this, max_queue, flush_millis, logdir,
+                             filename_suffix, ctx](SummaryWriterInterface** s) {
+                              SummaryFileWriterOptions options = options_;
+                              options.max_queue = max_queue;
+                              options.flush_millis = flush_millis;
                               return CreateSummaryFileWriter(
-                                  max_queue, flush_millis, logdir,
-                                  filename_suffix, ctx->env(), s);
+                                  options, logdir, filename_suffix, ctx->env(),
+                                  s);
                             }));
   }
+
+ private:
+  SummaryFileWriterOptions options_;
 };
 REGISTER_KERNEL_BUILDER(Name("CreateSummaryFileWriter").Device(DEVICE_CPU),
                         CreateSummaryFileWriterOp);
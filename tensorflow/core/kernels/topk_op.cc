@@ -23,6 +23,7 @@ limitations under the License.
 #include <numeric>
 #include <vector>
 
+#include "third_party/eigen3/Eigen/Core"
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
@@ -129,8 +130,84 @@ class TopK : public OpKernel {
 
 namespace functor {
 
+namespace {
+
+// Orders indices by decreasing value, and equal values by increasing index.
+template <typename T, typename Tidx>
+struct StableGreater {
+  bool operator()(const Tidx a, const Tidx b) const {
+    if (input_data[b] < input_data[a]) {
+      return true;
+    } else if (input_data[b] > input_data[a]) {
+      return false;
+    } else {
+      return a < b;
+    }
+  }
+  const T* input_data;
+};
+
+// Number of columns whose maximum is compared against the threshold at once.
+constexpr int kSelectBlockSize = 32;
+
+// Appends to `candidates` the indices of the top `k` values of
+// `input_data[begin, end)`, in no particular order. The columns are scanned in
+// blocks, and a block is skipped unless its maximum exceeds the k-th largest
+// value of the candidates found so far. The maximum is computed with Eigen, so
+// that most of the row is only touched by vectorized compares. Since columns
+// are scanned in increasing order, a later value equal to the threshold can
+// never be in the top k.
+template <typename T, typename Tidx>
+void SelectTopK(const T* input_data, int64_t begin, int64_t end, int k,
+                std::vector<Tidx>* candidates) {
+  const StableGreater<T, Tidx> comp{input_data};
+  const size_t first = candidates->size();
+  const size_t capacity = std::max(2 * k, kSelectBlockSize);
+  candidates->reserve(first + capacity + kSelectBlockSize);
+
+  bool has_threshold = false;
+  T threshold = T();
+  auto compact = [&]() {
+    auto top_begin = candidates->begin() + first;
+    std::nth_element(top_begin, top_begin + (k - 1), candidates->end(), comp);
+    candidates->resize(first + k);
+    threshold = input_data[candidates->back()];
+    has_threshold = true;
+  };
+
+  for (int64_t c = begin; c < end; c += kSelectBlockSize) {
+    const int64_t block_end = std::min<int64_t>(c + kSelectBlockSize, end);
+    if (has_threshold) {
+      if (block_end - c == kSelectBlockSize) {
+        const T block_max =
+            Eigen::Map<const Eigen::Array<T, kSelectBlockSize, 1>>(
+                input_data + c)
+                .maxCoeff();
+        if (!(block_max > threshold)) continue;
+      }
+      for (int64_t i = c; i < block_end; ++i) {
+        if (input_data[i] > threshold) {
+          candidates->push_back(static_cast<Tidx>(i));
+        }
+      }
+    } else {
+      for (int64_t i = c; i < block_end; ++i) {
+        candidates->push_back(static_cast<Tidx>(i));
+      }
+    }
+    if (candidates->size() - first >= capacity) compact();
+  }
+  if (candidates->size() - first > static_cast<size_t>(k)) compact();
+}
+
+}  // namespace
+
 template <typename T, typename Tidx>
 struct TopKFunctor<CPUDevice, T, Tidx> {
+  // Minimum number of columns of a row, or of a slice of a row, for which the
+  // top k values are found by selection.
+  static constexpr int64_t kMinSelectCols = 1024;
+
   static EIGEN_ALWAYS_INLINE Status Compute(
       OpKernelContext* context, bool sorted, int k,
       const typename TTypes<T, 2>::ConstTensor& input, const int64_t num_rows,
@@ -161,6 +238,64 @@ struct TopKFunctor<CPUDevice, T, Tidx> {
       return OkStatus();
     }
 
+    auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
+
+    // For a small k, select the top k values of every row by thresholding
+    // instead of pushing every column through a heap. Rows that are wide
+    // compared to the number of rows are split into slices whose top k are
+    // selected in parallel and then merged.
+    if (num_cols >= kMinSelectCols && 4 * k <= num_cols) {
+      int64_t num_slices = 1;
+      if (num_rows < worker_threads.num_threads) {
+        num_slices = std::min<int64_t>(
+            Eigen::divup<int64_t>(worker_threads.num_threads, num_rows),
+            num_cols / kMinSelectCols);
+      }
+      const int64_t slice_size = Eigen::divup(num_cols, num_slices);
+      std::vector<std::vector<Tidx>> candidates(num_rows * num_slices);
+      auto SelectSlices = [&](int64_t start, int64_t limit) {
+        for (int64_t i = start; i < limit; ++i) {
+          const int64_t b = i / num_slices;
+          const int64_t begin = (i % num_slices) * slice_size;
+          const int64_t end = std::min(begin + slice_size, num_cols);
+          SelectTopK<T, Tidx>(&input(b, 0), begin, end,
+                              std::min<int64_t>(k, end - begin),
+                              &candidates[i]);
+        }
+      };
+      const int64_t select_cost =
+          slice_size * 2 * Eigen::TensorOpCost::AddCost<T>();
+      Shard(worker_threads.num_threads, worker_threads.workers,
+            num_rows * num_slices, select_cost, SelectSlices);
+
+      auto MergeSlices = [&](int64_t start_batch, int64_t limit_batch) {
+        for (int64_t b = start_batch; b < limit_batch; ++b) {
+          std::vector<Tidx>& top_k = candidates[b * num_slices];
+          for (int64_t i = 1; i < num_slices; ++i) {
+            const std::vector<Tidx>& slice = candidates[b * num_slices + i];
+            top_k.insert(top_k.end(), slice.begin(), slice.end());
+          }
+          const StableGreater<T, Tidx> comp{&input(b, 0)};
+          if (top_k.size() > static_cast<size_t>(k)) {
+            std::nth_element(top_k.begin(), top_k.begin() + (k - 1),
+                             top_k.end(), comp);
+            top_k.resize(k);
+          }
+          if (sorted) std::sort(top_k.begin(), top_k.end(), comp);
+          for (int i = 0; i < k; ++i) {
+            indices(b, i) = top_k[i];
+            values(b, i) = input(b, top_k[i]);
+          }
+        }
+      };
+      const int64_t merge_cost = static_cast<int64_t>(
+          num_slices * k * Eigen::numext::log2(static_cast<float>(k + 1)) *
+          Eigen::TensorOpCost::AddCost<T>());
+      Shard(worker_threads.num_threads, worker_threads.workers, num_rows,
+            merge_cost, MergeSlices);
+      return OkStatus();
+    }
+
     auto SortIndices = [&](int64_t start_batch, int64_t limit_batch) {
       for (int32_t b = start_batch; b < limit_batch; ++b) {
         const T* input_data = &input(b, 0);
@@ -247,7 +382,6 @@ struct TopKFunctor<CPUDevice, T, Tidx> {
     const int64_t final_cost = (total_cost >= static_cast<double>(kint64max))
                                    ? kint64max
                                    : static_cast<int64_t>(total_cost);
-    auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
     Shard(worker_threads.num_threads, worker_threads.workers, num_rows,
           final_cost, SortIndices);
 
@@ -0,0 +1,140 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace {
+
+class TopKOpTest : public OpsTestBase {
+ protected:
+  void MakeOp(bool sorted) {
+    TF_ASSERT_OK(NodeDefBuilder("top_k", "TopKV2")
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_INT32))
+                     .Attr("sorted", sorted)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+};
+
+// Wide rows take the selection path, which must give the same result as a
+// stable sort, including for ties.
+TEST_F(TopKOpTest, WideRowsMatchStableSort) {
+  MakeOp(/*sorted=*/true);
+  const int kRows = 3;
+  const int kCols = 50000;
+  const int kK = 100;
+  std::vector<float> input(kRows * kCols);
+  for (int i = 0; i < kRows * kCols; ++i) {
+    input[i] = static_cast<float>((i * 7919) % 4099);
+  }
+  AddInputFromArray<float>(TensorShape({kRows, kCols}), input);
+  AddInputFromArray<int32>(TensorShape({}), {kK});
+  TF_ASSERT_OK(RunOpKernel());
+
+  std::vector<float> expected_values;
+  std::vector<int32> expected_indices;
+  for (int r = 0; r < kRows; ++r) {
+    const float* row = &input[r * kCols];
+    std::vector<int32> order(kCols);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+                     [row](int32 a, int32 b) { return row[a] > row[b]; });
+    for (int i = 0; i < kK; ++i) {
+      expected_indices.push_back(order[i]);
+      expected_values.push_back(row[order[i]]);
+    }
+  }
+  test::ExpectTensorEqual<float>(
+      *GetOutput(0), test::AsTensor<float>(expected_values, {kRows, kK}));
+  test::ExpectTensorEqual<int32>(
+      *GetOutput(1), test::AsTensor<int32>(expected_indices, {kRows, kK}));
+}
+
+TEST_F(TopKOpTest, WideRowsUnsorted) {
+  MakeOp(/*sorted=*/false);
+  const int kCols = 20000;
+  const int kK = 10;
+  std::vector<float> input(kCols);
+  for (int i = 0; i < kCols; ++i) {
+    input[i] = static_cast<float>(i % 1000);
+  }
+  input[12345] = 5000.0f;
+  AddInputFromArray<float>(TensorShape({kCols}), input);
+  AddInputFromArray<int32>(TensorShape({}), {kK});
+  TF_ASSERT_OK(RunOpKernel());
+
+  // The top values are 5000 and the nine first occurrences of 999.
+  std::vector<int32> indices(GetOutput(1)->flat<int32>().data(),
+                             GetOutput(1)->flat<int32>().data() + kK);
+  std::sort(indices.begin(), indices.end());
+  std::vector<int32> expected_indices = {999,  1999, 2999, 3999, 4999,
+                                         5999, 6999, 7999, 8999, 12345};
+  EXPECT_EQ(indices, expected_indices);
+}
+
+Graph* TopK(int rows, int cols, int k) {
+  Graph* g = new Graph(OpRegistry::Global());
+  Tensor input(DT_FLOAT, TensorShape({rows, cols}));
+  input.flat<float>().setRandom();
+  Tensor k_t(DT_INT32, TensorShape({}));
+  k_t.scalar<int32>()() = k;
+
+  Node* top_k;
+  TF_CHECK_OK(NodeBuilder(g->NewName("top_k"), "TopKV2")
+                  .Input(test::graph::Constant(g, input))
+                  .Input(test::graph::Constant(g, k_t))
+                  .Attr("sorted", true)
+                  .Finalize(g, &top_k));
+  return g;
+}
+
+void BM_TopK(::testing::benchmark::State& state) {
+  const int rows = state.range(0);
+  const int cols = state.range(1);
+  const int k = state.range(2);
+
+  test::Benchmark("cpu", TopK(rows, cols, k), /*old_benchmark_api=*/false)
+      .Run(state);
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * rows *
+                          cols);
+}
+
+BENCHMARK(BM_TopK)
+    ->UseRealTime()
+    ->Args({1, 1 << 20, 100})
+    ->Args({8, 1 << 20, 100})
+    ->Args({128, 1 << 16, 100})
+    ->Args({128, 1 << 16, 1000})
+    ->Args({1024, 1024, 10})
+    ->Args({1024, 1000, 500});
+
+}  // namespace
+}  // namespace tensorflow
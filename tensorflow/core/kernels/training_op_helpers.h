@@ -87,6 +87,30 @@ Status EnsureSparseVariableAccess(OpKernelContext* ctx, Var* var,
   return OkStatus();
 }
 
+// Prepares a sparse read of `var`, e.g. a gather, and sets `*params` to the
+// tensor to read. If the variable is read-mostly and in copy-on-write mode,
+// `*params` is `snapshot`, which aliases the buffer of the variable and can be
+// read without holding its mutex. Otherwise the variable is switched to
+// copy-on-read mode, `*params` is its tensor and `*lock` holds its mutex in
+// shared mode.
+template <typename Device, typename T>
+Status PrepareSparseVariableRead(OpKernelContext* ctx, Var* var,
+                                 std::optional<tf_shared_lock>* lock,
+                                 Tensor* snapshot, const Tensor** params) {
+  if (var->read_mostly.load()) {
+    tf_shared_lock ml(*var->mu());
+    if (!var->copy_on_read_mode.load()) {
+      *snapshot = *var->tensor();
+      *params = snapshot;
+      return OkStatus();
+    }
+  }
+  TF_RETURN_IF_ERROR(EnsureSparseVariableAccess<Device, T>(ctx, var));
+  lock->emplace(*var->mu());
+  *params = var->tensor();
+  return OkStatus();
+}
+
 // Utility structure that releases a sequence of borrowed mutexes when it is
 // deleted.
 struct VariableInputLockHolder {
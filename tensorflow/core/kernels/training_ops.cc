@@ -17,6 +17,8 @@ limitations under the License.
 #include "tensorflow/core/kernels/training_ops.h"
 
 #include <algorithm>  // NOLINT
+#include <numeric>
+#include <vector>
 
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -771,6 +773,28 @@ struct SparseApplyAdadelta<CPUDevice, T, Tindex> {
   }
 };
 
+// Applies the Adam update to `size` contiguous elements, where `alpha` is the
+// learning rate corrected for the bias of m and v.
+template <typename T>
+void ApplyAdamToRange(T* var_ptr, T* m_ptr, T* v_ptr, const T* g_ptr,
+                      Index size, const T alpha, const T beta1, const T beta2,
+                      const T epsilon, bool use_nesterov) {
+  auto var = typename TTypes<T>::UnalignedTensor(var_ptr, size);
+  auto m = typename TTypes<T>::UnalignedTensor(m_ptr, size);
+  auto v = typename TTypes<T>::UnalignedTensor(v_ptr, size);
+  auto g = typename TTypes<T>::UnalignedConstTensor(g_ptr, size);
+
+  if (use_nesterov) {
+    m += (g - m) * (T(1) - beta1);
+    v += (g.square() - v) * (T(1) - beta2);
+    var -= ((g * (T(1) - beta1) + beta1 * m) * alpha) / (v.sqrt() + epsilon);
+  } else {
+    m += (g - m) * (T(1) - beta1);
+    v += (g.square() - v) * (T(1) - beta2);
+    var -= (m * alpha) / (v.sqrt() + epsilon);
+  }
+}
+
 template <typename Device, typename T>
 struct ApplyAdamNonCuda {
   void operator()(const Device& d, typename TTypes<T>::Flat var,
@@ -806,21 +830,9 @@ struct ApplyAdamNonCuda {
                   use_nesterov, packet_size](int begin, int end) {
       int t_size = (end - begin) * packet_size;
       begin = begin * packet_size;
-      auto var = typename TTypes<T>::UnalignedTensor(var_ptr + begin, t_size);
-      auto m = typename TTypes<T>::UnalignedTensor(m_ptr + begin, t_size);
-      auto v = typename TTypes<T>::UnalignedTensor(v_ptr + begin, t_size);
-      auto g = typename TTypes<T>::UnalignedConstTensor(g_ptr + begin, t_size);
-
-      if (use_nesterov) {
-        m += (g - m) * (T(1) - beta1());
-        v += (g.square() - v) * (T(1) - beta2());
-        var -= ((g * (T(1) - beta1()) + beta1() * m) * alpha) /
-               (v.sqrt() + epsilon());
-      } else {
-        m += (g - m) * (T(1) - beta1());
-        v += (g.square() - v) * (T(1) - beta2());
-        var -= (m * alpha) / (v.sqrt() + epsilon());
-      }
+      ApplyAdamToRange(var_ptr + begin, m_ptr + begin, v_ptr + begin,
+                       g_ptr + begin, t_size, alpha, beta1(), beta2(),
+                       epsilon(), use_nesterov);
     };
 
     // Input data: var, v, m, grad.
@@ -3654,6 +3666,145 @@ REGISTER_KERNELS(GPU, complex128);
 #undef REGISTER_CPU_KERNELS
 #undef REGISTER_KERNELS
 
+// Applies Adam to N resource variables with the same hyperparameters. The
+// elements of all the variables are split into one set of shards, so that
+// many small variables are updated by one kernel and still in parallel.
+template <typename T>
+class MultiTensorApplyAdamOp : public OpKernel {
+ public:
+  explicit MultiTensorApplyAdamOp(OpKernelConstruction* ctx) : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("N", &num_tensors_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("use_locking", &use_exclusive_lock_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("use_nesterov", &use_nesterov_));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    const bool sparse = false;
+    std::vector<int> variable_inputs(3 * num_tensors_);
+    std::iota(variable_inputs.begin(), variable_inputs.end(), 0);
+    auto locks = MaybeLockVariableInputMutexesInOrder<CPUDevice, T>(
+        ctx, use_exclusive_lock_, sparse, variable_inputs);
+
+    const int scalars_idx = 3 * num_tensors_;
+    const Tensor& beta1_power = ctx->input(scalars_idx);
+    const Tensor& beta2_power = ctx->input(scalars_idx + 1);
+    const Tensor& lr = ctx->input(scalars_idx + 2);
+    const Tensor& beta1 = ctx->input(scalars_idx + 3);
+    const Tensor& beta2 = ctx->input(scalars_idx + 4);
+    const Tensor& epsilon = ctx->input(scalars_idx + 5);
+    for (int i = scalars_idx; i < scalars_idx + 6; ++i) {
+      OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(ctx->input(i).shape()),
+                  errors::InvalidArgument(requested_input(i),
+                                          " is not a scalar: ",
+                                          ctx->input(i).shape().DebugString()));
+    }
+
+    std::vector<Tensor> vars(num_tensors_);
+    std::vector<Tensor> ms(num_tensors_);
+    std::vector<Tensor> vs(num_tensors_);
+    // The elements of variable i are [limits[i], limits[i + 1]) in the
+    // combined index space.
+    std::vector<int64_t> limits(num_tensors_ + 1, 0);
+    const int grad_idx = scalars_idx + 6;
+    for (int i = 0; i < num_tensors_; ++i) {
+      const int m_idx = num_tensors_ + i;
+      const int v_idx = 2 * num_tensors_ + i;
+      OP_REQUIRES_OK(ctx,
+                     GetInputTensorFromVariable<CPUDevice, T>(
+                         ctx, i, use_exclusive_lock_, sparse, &vars[i]));
+      OP_REQUIRES_OK(ctx,
+                     GetInputTensorFromVariable<CPUDevice, T>(
+                         ctx, m_idx, use_exclusive_lock_, sparse, &ms[i]));
+      OP_REQUIRES_OK(ctx,
+                     GetInputTensorFromVariable<CPUDevice, T>(
+                         ctx, v_idx, use_exclusive_lock_, sparse, &vs[i]));
+      OP_REQUIRES(ctx, vars[i].IsInitialized(),
+                  errors::FailedPrecondition(
+                      "Attempting to use uninitialized variables: ",
+                      requested_input(i)));
+      OP_REQUIRES(ctx, ms[i].IsInitialized(),
+                  errors::FailedPrecondition(
+                      "Attempting to use uninitialized variables: ",
+                      requested_input(m_idx)));
+      OP_REQUIRES(ctx, vs[i].IsInitialized(),
+                  errors::FailedPrecondition(
+                      "Attempting to use uninitialized variables: ",
+                      requested_input(v_idx)));
+
+      const Tensor& grad = ctx->input(grad_idx + i);
+      OP_REQUIRES(
+          ctx, vars[i].shape().IsSameSize(ms[i].shape()),
+          errors::InvalidArgument("var and m do not have the same shape",
+                                  vars[i].shape().DebugString(), " ",
+                                  ms[i].shape().DebugString()));
+      OP_REQUIRES(
+          ctx, vars[i].shape().IsSameSize(vs[i].shape()),
+          errors::InvalidArgument("var and v do not have the same shape",
+                                  vars[i].shape().DebugString(), " ",
+                                  vs[i].shape().DebugString()));
+      OP_REQUIRES(
+          ctx, vars[i].shape().IsSameSize(grad.shape()),
+          errors::InvalidArgument("var and grad do not have the same shape",
+                                  vars[i].shape().DebugString(), " ",
+                                  grad.shape().DebugString()));
+      limits[i + 1] = limits[i] + vars[i].NumElements();
+    }
+
+    const T beta1_value = beta1.scalar<T>()();
+    const T beta2_value = beta2.scalar<T>()();
+    const T epsilon_value = epsilon.scalar<T>()();
+    const T alpha = lr.scalar<T>()() *
+                    Eigen::numext::sqrt(T(1) - beta2_power.scalar<T>()()) /
+                    (T(1) - beta1_power.scalar<T>()());
+
+    auto shard = [&](int64_t begin, int64_t end) {
+      int i = std::upper_bound(limits.begin(), limits.end(), begin) -
+              limits.begin() - 1;
+      while (begin < end) {
+        const int64_t limit = std::min(end, limits[i + 1]);
+        const int64_t offset = begin - limits[i];
+        functor::ApplyAdamToRange(
+            vars[i].flat<T>().data() + offset, ms[i].flat<T>().data() + offset,
+            vs[i].flat<T>().data() + offset,
+            ctx->input(grad_idx + i).flat<T>().data() + offset, limit - begin,
+            alpha, beta1_value, beta2_value, epsilon_value, use_nesterov_);
+        begin = limit;
+        ++i;
+      }
+    };
+
+    // Input data: var, v, m, grad.
+    // Output data: var, v, m.
+    const Eigen::TensorOpCost cost(
+        sizeof(T) * 4, sizeof(T) * 3,
+        Eigen::TensorOpCost::AddCost<T>() * 10 +
+            Eigen::TensorOpCost::MulCost<T>() * 6 +
+            Eigen::TensorOpCost::DivCost<T>());
+    ctx->eigen_device<CPUDevice>().parallelFor(limits[num_tensors_], cost,
+                                               shard);
+  }
+
+ private:
+  int num_tensors_;
+  bool use_exclusive_lock_;
+  bool use_nesterov_;
+};
+
+#define REGISTER_CPU_KERNELS(T)                                    \
+  REGISTER_KERNEL_BUILDER(Name("_MultiTensorResourceApplyAdam")    \
+                              .HostMemory("var")                   \
+                              .HostMemory("m")                     \
+                              .HostMemory("v")                     \
+                              .Device(DEVICE_CPU)                  \
+                              .TypeConstraint<T>("T"),             \
+                          MultiTensorApplyAdamOp<T>);
+
+TF_CALL_half(REGISTER_CPU_KERNELS);
+TF_CALL_bfloat16(REGISTER_CPU_KERNELS);
+TF_CALL_float(REGISTER_CPU_KERNELS);
+TF_CALL_double(REGISTER_CPU_KERNELS);
+#undef REGISTER_CPU_KERNELS
+
 template <typename Device, typename T>
 class ApplyAdamWithAmsgradOp : public OpKernel {
  public:
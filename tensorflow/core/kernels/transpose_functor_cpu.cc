@@ -15,6 +15,7 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
 #include <complex>
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
@@ -68,12 +69,72 @@ void TransposeSimple(const CPUDevice& device, const Tensor& in,
   device.parallelFor(in.NumElements(), cost, std::move(transpose_fn));
 }
 
+// Transposes the [batch, rows, cols] tensor `in` into the [batch, cols, rows]
+// tensor `out`, one kTileSize x kTileSize tile at a time, so that both the
+// reads and the strided writes of a tile stay in cache.
+template <typename T, bool conjugate>
+void TransposeBatchedMatrix(const CPUDevice& device, const Tensor& in,
+                            int64_t batch, int64_t rows, int64_t cols,
+                            Tensor* out) {
+  constexpr int64_t kTileSize = 32;
+  const T* p = reinterpret_cast<const T*>(in.tensor_data().data());
+  T* q = reinterpret_cast<T*>(const_cast<char*>((out->tensor_data().data())));
+  const int64_t row_tiles = (rows + kTileSize - 1) / kTileSize;
+  const int64_t col_tiles = (cols + kTileSize - 1) / kTileSize;
+  auto transpose_fn = [=](int64_t begin, int64_t end) {
+    for (int64_t tile = begin; tile < end; ++tile) {
+      const int64_t b = tile / (row_tiles * col_tiles);
+      const int64_t row_start = (tile / col_tiles) % row_tiles * kTileSize;
+      const int64_t col_start = tile % col_tiles * kTileSize;
+      const int64_t row_end = std::min(row_start + kTileSize, rows);
+      const int64_t col_end = std::min(col_start + kTileSize, cols);
+      const T* p_b = p + b * rows * cols;
+      T* q_b = q + b * rows * cols;
+      for (int64_t c = col_start; c < col_end; ++c) {
+        for (int64_t r = row_start; r < row_end; ++r) {
+          if (conjugate) {
+            q_b[c * rows + r] = Eigen::numext::conj(p_b[r * cols + c]);
+          } else {
+            q_b[c * rows + r] = p_b[r * cols + c];
+          }
+        }
+      }
+    }
+  };
+  const double elements_per_tile = kTileSize * kTileSize;
+  Eigen::TensorOpCost cost(/*bytes_loaded=*/sizeof(T) * elements_per_tile,
+                           /*bytes_stored=*/sizeof(T) * elements_per_tile,
+                           /*compute_cycles=*/elements_per_tile);
+  device.parallelFor(batch * row_tiles * col_tiles, cost,
+                     std::move(transpose_fn));
+}
+
 }  // namespace
 
 template <typename T, bool conjugate>
 struct Transpose<CPUDevice, T, conjugate> {
   static void run(const CPUDevice& d, const Tensor& in,
                   const gtl::ArraySlice<int32> perm, Tensor* out) {
+    // Permutations that only swap two groups of dimensions, possibly under
+    // leading batch dimensions, are (batched) matrix transposes once
+    // neighboring dimensions are combined. This covers the matrix transposes
+    // and the NHWC <-> NCHW layout conversions.
+    if (in.dims() >= 2) {
+      internal::TransposePermsVec new_perm;
+      internal::TransposeDimsVec new_dims(in.dims());
+      internal::ReduceTransposeDimensions(in.shape(), perm, &new_perm,
+                                          &new_dims);
+      if (new_perm.size() == 2 && new_perm[0] == 1) {
+        TransposeBatchedMatrix<T, conjugate>(d, in, 1, new_dims[0],
+                                             new_dims[1], out);
+        return;
+      }
+      if (new_perm.size() == 3 && new_perm[0] == 0 && new_perm[1] == 2) {
+        TransposeBatchedMatrix<T, conjugate>(d, in, new_dims[0], new_dims[1],
+                                             new_dims[2], out);
+        return;
+      }
+    }
     switch (in.dims()) {
       case 2:
         internal::TransposeUsingEigen<CPUDevice, T, 2>(d, in, perm, conjugate,
@@ -13,9 +13,12 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#define EIGEN_USE_THREADS
+
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/kernels/transpose_functor.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/test.h"
 
 namespace tensorflow {
@@ -98,6 +101,38 @@ TEST_F(TransposeUtilTest, LargeDimensionReduction) {
                          {0, 1, 2, 3, 4, 5, 6, 7, 8, 9}, {0}, {72576000});
 }
 
+TEST_F(TransposeUtilTest, TransposeMatchesReference) {
+  Eigen::ThreadPool pool(4);
+  Eigen::ThreadPoolDevice device(&pool, 4);
+  // NHWC -> NCHW and NCHW -> NHWC are batched matrix transposes, the others
+  // go through Eigen.
+  const std::vector<std::vector<int32>> perms = {
+      {0, 3, 1, 2}, {0, 2, 3, 1}, {3, 2, 1, 0}, {1, 0, 3, 2}};
+  Tensor in(DT_FLOAT, TensorShape({3, 5, 7, 37}));
+  auto in_t = in.tensor<float, 4>();
+  for (int64_t i = 0; i < in.NumElements(); ++i) in.flat<float>()(i) = i;
+  for (const std::vector<int32>& perm : perms) {
+    TensorShape out_shape;
+    for (int32 d : perm) out_shape.AddDim(in.dim_size(d));
+    Tensor expected(DT_FLOAT, out_shape);
+    auto expected_t = expected.tensor<float, 4>();
+    Eigen::array<int64_t, 4> index;
+    for (index[0] = 0; index[0] < in.dim_size(0); ++index[0]) {
+      for (index[1] = 0; index[1] < in.dim_size(1); ++index[1]) {
+        for (index[2] = 0; index[2] < in.dim_size(2); ++index[2]) {
+          for (index[3] = 0; index[3] < in.dim_size(3); ++index[3]) {
+            expected_t(index[perm[0]], index[perm[1]], index[perm[2]],
+                       index[perm[3]]) = in_t(index);
+          }
+        }
+      }
+    }
+    Tensor out(DT_FLOAT, out_shape);
+    TF_EXPECT_OK(DoTranspose(device, in, perm, &out));
+    test::ExpectTensorEqual<float>(out, expected);
+  }
+}
+
 TEST_F(TransposeUtilTest, NonSingletonDimensionAlignment) {
   // Non-singleton dims 0, 2
   EXPECT_TRUE(internal::NonSingletonDimensionsAlign({2, 1, 2}, {1, 0, 2}));
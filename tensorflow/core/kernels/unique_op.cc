@@ -16,6 +16,7 @@ limitations under the License.
 #include <functional>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/framework/bounds_check.h"
@@ -25,7 +26,9 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/lib/core/bits.h"
 #include "tensorflow/core/platform/bfloat16.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 namespace {
@@ -150,26 +153,33 @@ class UniqueOp : public OpKernel {
       auto Tin = input.flat<T>();
       const int64_t N = static_cast<int64_t>(Tin.size());
 
-      typename UniqueOpHashMap<T, TIndex>::map_type uniq;
-      uniq.reserve(2 * N);
-      for (Eigen::Index i = 0, j = 0; i < N; ++i) {
-        auto it = uniq.emplace(Tin(i), j);
-        idx_vec(i) = it.first->second;
-        if (it.second) {
-          ++j;
+      const auto* worker_threads =
+          context->device()->tensorflow_cpu_worker_threads();
+      if (worker_threads->num_threads > 1 && N >= kMinParallelSize) {
+        ParallelUnique(context, input.shape(), axis, Tin, idx_vec, &uniq_size);
+        if (!context->status().ok()) return;
+      } else {
+        typename UniqueOpHashMap<T, TIndex>::map_type uniq;
+        uniq.reserve(2 * N);
+        for (Eigen::Index i = 0, j = 0; i < N; ++i) {
+          auto it = uniq.emplace(Tin(i), j);
+          idx_vec(i) = it.first->second;
+          if (it.second) {
+            ++j;
+          }
         }
-      }
 
-      uniq_size = static_cast<int64_t>(uniq.size());
-      TensorShape output_shape(input.shape());
-      output_shape.set_dim(axis, uniq_size);
-      Tensor* output = nullptr;
-      OP_REQUIRES_OK(context,
-                     context->allocate_output(0, output_shape, &output));
-      auto Tout = output->flat<T>();
+        uniq_size = static_cast<int64_t>(uniq.size());
+        TensorShape output_shape(input.shape());
+        output_shape.set_dim(axis, uniq_size);
+        Tensor* output = nullptr;
+        OP_REQUIRES_OK(context,
+                       context->allocate_output(0, output_shape, &output));
+        auto Tout = output->flat<T>();
 
-      for (const auto& it : uniq) {
-        Tout(it.second) = it.first;
+        for (const auto& it : uniq) {
+          Tout(it.second) = it.first;
+        }
       }
     } else {
       // General implementation when unique is run over multiple elements.
@@ -237,6 +247,148 @@ class UniqueOp : public OpKernel {
       }
     }
   }
+
+ private:
+  using MapType = typename UniqueOpHashMap<T, TIndex>::map_type;
+
+  // Minimum number of input elements for which the elements are uniquified
+  // in parallel.
+  static constexpr int64_t kMinParallelSize = 1 << 16;
+  // Maximum number of hash partitions, so that a partition fits in a byte.
+  static constexpr int kMaxPartitions = 128;
+
+  // Uniquifies the elements `Tin` using the worker threads, writing the unique
+  // elements to output 0, the index of every element into `idx_vec` and the
+  // number of unique elements into `uniq_size`. The elements are
+  // radix-partitioned
+  // by hash, every partition is uniquified on its own, and the unique elements
+  // are numbered by a prefix sum over the positions of their first
+  // occurrences, so that the output is the same as the sequential version.
+  void ParallelUnique(OpKernelContext* context, const TensorShape& input_shape,
+                      int64_t axis, typename TTypes<T>::ConstFlat Tin,
+                      typename TTypes<TIndex>::Vec idx_vec,
+                      int64_t* uniq_size) {
+    const auto* worker_threads =
+        context->device()->tensorflow_cpu_worker_threads();
+    const int64_t N = Tin.size();
+    int num_partitions = 1;
+    while (num_partitions < worker_threads->num_threads &&
+           num_partitions < kMaxPartitions) {
+      num_partitions *= 2;
+    }
+    const int partition_shift = 64 - Log2Floor(num_partitions);
+    auto partition_of = [partition_shift](const T& value) -> uint8 {
+      const uint64 h = typename MapType::hasher{}(
+          static_cast<typename MapType::key_type>(value));
+      // The hashes of some types are not well distributed in the high bits.
+      return (h * 0x9E3779B97F4A7C15ull) >> partition_shift;
+    };
+
+    // Splits [0, N) into `num_chunks` contiguous chunks.
+    const int64_t num_chunks = worker_threads->num_threads;
+    const int64_t chunk_size = Eigen::divup(N, num_chunks);
+    auto parallel_for_chunks = [&](const std::function<void(int64_t)>& fn) {
+      Shard(worker_threads->num_threads, worker_threads->workers, num_chunks,
+            chunk_size * 100, [&fn](int64_t first, int64_t last) {
+              for (int64_t chunk = first; chunk < last; ++chunk) fn(chunk);
+            });
+    };
+
+    // Find the partition of every element and count the elements of every
+    // partition in every chunk.
+    std::vector<uint8> partitions(N);
+    std::vector<int64_t> counts(num_chunks * num_partitions, 0);
+    parallel_for_chunks([&](int64_t chunk) {
+      int64_t* chunk_counts = &counts[chunk * num_partitions];
+      const int64_t end = std::min(N, (chunk + 1) * chunk_size);
+      for (int64_t i = chunk * chunk_size; i < end; ++i) {
+        partitions[i] = partition_of(Tin(i));
+        ++chunk_counts[partitions[i]];
+      }
+    });
+
+    // Scatter the positions of the elements by partition. The positions of
+    // every partition stay in increasing order.
+    std::vector<int64_t> partition_begin(num_partitions + 1, 0);
+    int64_t offset = 0;
+    for (int p = 0; p < num_partitions; ++p) {
+      partition_begin[p] = offset;
+      for (int64_t chunk = 0; chunk < num_chunks; ++chunk) {
+        const int64_t count = counts[chunk * num_partitions + p];
+        counts[chunk * num_partitions + p] = offset;
+        offset += count;
+      }
+    }
+    partition_begin[num_partitions] = offset;
+    std::vector<int32> positions(N);
+    parallel_for_chunks([&](int64_t chunk) {
+      int64_t* chunk_offsets = &counts[chunk * num_partitions];
+      const int64_t end = std::min(N, (chunk + 1) * chunk_size);
+      for (int64_t i = chunk * chunk_size; i < end; ++i) {
+        positions[chunk_offsets[partitions[i]]++] = static_cast<int32>(i);
+      }
+    });
+
+    // Uniquify every partition, numbering its unique elements locally and
+    // marking their first occurrences.
+    std::vector<uint8> is_first(N, 0);
+    std::vector<std::vector<TIndex>> global_ids(num_partitions);
+    Shard(worker_threads->num_threads, worker_threads->workers, num_partitions,
+          Eigen::divup<int64_t>(N, num_partitions) * 100,
+          [&](int64_t first, int64_t last) {
+            for (int64_t p = first; p < last; ++p) {
+              MapType uniq;
+              uniq.reserve(2 * (partition_begin[p + 1] - partition_begin[p]));
+              TIndex j = 0;
+              for (int64_t k = partition_begin[p]; k < partition_begin[p + 1];
+                   ++k) {
+                const int32 i = positions[k];
+                auto it = uniq.emplace(Tin(i), j);
+                idx_vec(i) = it.first->second;
+                if (it.second) {
+                  is_first[i] = 1;
+                  ++j;
+                }
+              }
+              global_ids[p].resize(j);
+            }
+          });
+
+    // Number the unique elements in the order of their first occurrences.
+    std::vector<int64_t> chunk_first_ids(num_chunks + 1, 0);
+    parallel_for_chunks([&](int64_t chunk) {
+      const int64_t end = std::min(N, (chunk + 1) * chunk_size);
+      int64_t count = 0;
+      for (int64_t i = chunk * chunk_size; i < end; ++i) count += is_first[i];
+      chunk_first_ids[chunk + 1] = count;
+    });
+    for (int64_t chunk = 0; chunk < num_chunks; ++chunk) {
+      chunk_first_ids[chunk + 1] += chunk_first_ids[chunk];
+    }
+    *uniq_size = chunk_first_ids[num_chunks];
+
+    TensorShape output_shape(input_shape);
+    output_shape.set_dim(axis, *uniq_size);
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(0, output_shape, &output));
+    auto Tout = output->flat<T>();
+    parallel_for_chunks([&](int64_t chunk) {
+      const int64_t end = std::min(N, (chunk + 1) * chunk_size);
+      TIndex global_id = chunk_first_ids[chunk];
+      for (int64_t i = chunk * chunk_size; i < end; ++i) {
+        if (!is_first[i]) continue;
+        global_ids[partitions[i]][idx_vec(i)] = global_id;
+        Tout(global_id) = Tin(i);
+        ++global_id;
+      }
+    });
+    parallel_for_chunks([&](int64_t chunk) {
+      const int64_t end = std::min(N, (chunk + 1) * chunk_size);
+      for (int64_t i = chunk * chunk_size; i < end; ++i) {
+        idx_vec(i) = global_ids[partitions[i]][idx_vec(i)];
+      }
+    });
+  }
 };
 
 #define REGISTER_UNIQUE(type)                                      \
@@ -15,12 +15,17 @@ limitations under the License.
 
 #include <functional>
 #include <memory>
+#include <unordered_map>
+#include <vector>
 
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
 #include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/graph/algorithm.h"
 #include "tensorflow/core/graph/node_builder.h"
@@ -37,6 +42,48 @@ namespace {
 
 const int kMaxStrLen = 40;
 
+class UniqueOpTest : public OpsTestBase {};
+
+// Large enough inputs are uniquified in parallel, which must preserve the
+// order of the first occurrences.
+TEST_F(UniqueOpTest, LargeInputKeepsFirstOccurrenceOrder) {
+  TF_ASSERT_OK(NodeDefBuilder("unique", "UniqueWithCounts")
+                   .Input(FakeInput(DT_INT64))
+                   .Attr("out_idx", DT_INT32)
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+
+  const int kSize = 1 << 18;
+  std::vector<int64_t> input(kSize);
+  for (int i = 0; i < kSize; ++i) {
+    input[i] = (static_cast<int64_t>(i) * 7919) % 10007 - 5000;
+  }
+  AddInputFromArray<int64_t>(TensorShape({kSize}), input);
+  TF_ASSERT_OK(RunOpKernel());
+
+  std::vector<int64_t> expected_y;
+  std::vector<int32> expected_idx;
+  std::vector<int32> expected_count;
+  std::unordered_map<int64_t, int32> ids;
+  for (int64_t value : input) {
+    auto it = ids.emplace(value, expected_y.size());
+    if (it.second) {
+      expected_y.push_back(value);
+      expected_count.push_back(0);
+    }
+    expected_idx.push_back(it.first->second);
+    ++expected_count[it.first->second];
+  }
+
+  const int64_t num_unique = expected_y.size();
+  test::ExpectTensorEqual<int64_t>(
+      *GetOutput(0), test::AsTensor<int64_t>(expected_y, {num_unique}));
+  test::ExpectTensorEqual<int32>(*GetOutput(1),
+                                 test::AsTensor<int32>(expected_idx, {kSize}));
+  test::ExpectTensorEqual<int32>(
+      *GetOutput(2), test::AsTensor<int32>(expected_count, {num_unique}));
+}
+
 TensorProto GetRandomInt32TensorProto(int dim, int max_int) {
   TensorProto tensor_proto;
   tensor_proto.set_dtype(DT_INT32);
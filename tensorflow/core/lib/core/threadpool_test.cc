@@ -21,8 +21,10 @@ limitations under the License.
 #include "absl/synchronization/blocking_counter.h"
 #include "absl/types/optional.h"
 #include "tensorflow/core/platform/context.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/notification.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
 
@@ -315,6 +317,104 @@ TEST(ThreadPool, ParallelForWithAdaptiveSchedulingStrategy) {
   }
 }
 
+TEST(ThreadPool, ParallelForWithWorkStealingStrategy) {
+  Context outer_context(ContextKind::kThread);
+  for (int num_threads = 1; num_threads < kNumThreads; num_threads++) {
+    fprintf(stderr, "Testing with %d threads\n", num_threads);
+    ThreadPool pool(Env::Default(), "test", num_threads);
+    for (int64_t total : {0, 1, 15, 1000}) {
+      for (absl::optional<int64_t> block_size :
+           {absl::optional<int64_t>(), absl::optional<int64_t>(7)}) {
+        std::vector<std::atomic<bool>> work(total);
+        for (int64_t i = 0; i < total; i++) {
+          work[i] = false;
+        }
+        pool.ParallelFor(
+            total,
+            ThreadPool::SchedulingParams(
+                ThreadPool::SchedulingStrategy::kWorkStealing /* strategy */,
+                absl::nullopt /* cost_per_unit */, block_size /* block_size */),
+            [&outer_context, &work](int64_t begin, int64_t end) {
+              Context inner_context(ContextKind::kThread);
+              ASSERT_EQ(outer_context, inner_context);
+              for (int64_t i = begin; i < end; ++i) {
+                ASSERT_FALSE(work[i].exchange(true));
+              }
+            });
+        for (int64_t i = 0; i < total; i++) {
+          ASSERT_TRUE(work[i]);
+        }
+      }
+    }
+  }
+}
+
+TEST(ThreadPool, ParallelForWithWorkStealingStrategySteals) {
+  // With one pool thread the units are split into [0, 2) for the caller and
+  // [2, 4) for the pool thread. Unit 2 only finishes after unit 3, so unit 3
+  // has to be stolen by the caller, whether or not the pool thread started.
+  ThreadPool pool(Env::Default(), "test", 1);
+  Notification unit3_done;
+  pool.ParallelFor(
+      4,
+      ThreadPool::SchedulingParams(
+          ThreadPool::SchedulingStrategy::kWorkStealing /* strategy */,
+          absl::nullopt /* cost_per_unit */, absl::nullopt /* block_size */),
+      [&unit3_done](int64_t begin, int64_t end) {
+        for (int64_t i = begin; i < end; ++i) {
+          if (i == 2) unit3_done.WaitForNotification();
+          if (i == 3) unit3_done.Notify();
+        }
+      });
+  EXPECT_GE(pool.GetStats().steals, 1);
+}
+
+TEST(ThreadPool, QueueStats) {
+  const int kWorkItems = 5;
+  Notification first_started;
+  Notification release;
+  absl::BlockingCounter counter(kWorkItems);
+  ThreadPool pool(Env::Default(), "test", 1);
+  pool.Schedule([&]() {
+    first_started.Notify();
+    release.WaitForNotification();
+    counter.DecrementCount();
+  });
+  first_started.WaitForNotification();
+  for (int i = 1; i < kWorkItems; i++) {
+    pool.Schedule([&counter]() { counter.DecrementCount(); });
+  }
+  EXPECT_EQ(kWorkItems - 1, pool.GetStats().queue_depth);
+  EXPECT_EQ(1, pool.GetStats().tasks_started);
+  release.Notify();
+  counter.Wait();
+  EXPECT_EQ(0, pool.GetStats().queue_depth);
+  EXPECT_EQ(kWorkItems, pool.GetStats().tasks_started);
+}
+
+#if defined(__linux__)
+TEST(ThreadPool, CpuSet) {
+  const int cpu = port::GetCurrentCPU();
+  if (cpu < 0) GTEST_SKIP() << "The current CPU is unknown.";
+  for (bool pin_threads_to_cpus : {false, true}) {
+    ThreadOptions thread_options;
+    thread_options.cpu_set = {cpu};
+    thread_options.pin_threads_to_cpus = pin_threads_to_cpus;
+    ThreadPool pool(Env::Default(), thread_options, "test", 2);
+    absl::BlockingCounter counter(10);
+    std::atomic<int> other_cpus(0);
+    for (int i = 0; i < 10; i++) {
+      pool.Schedule([&counter, &other_cpus, cpu]() {
+        if (port::GetCurrentCPU() != cpu) other_cpus++;
+        counter.DecrementCount();
+      });
+    }
+    counter.Wait();
+    EXPECT_EQ(0, other_cpus);
+  }
+}
+#endif  // __linux__
+
 TEST(ThreadPool, ParallelForWithWorkerId) {
   // Make ParallelForWithWorkerId use as many threads as possible.
   int64_t kHugeCost = 1 << 30;
@@ -24,6 +24,7 @@ using tsl::Slice;  // NOLINT(misc-unused-using-decls)
 namespace table {
 // NOLINTBEGIN(misc-unused-using-decls)
 using tsl::table::Cache;
+using tsl::table::NewClockCache;
 using tsl::table::NewLRUCache;
 // NOLINTEND(misc-unused-using-decls)
 }  // namespace table
@@ -26,6 +26,7 @@ namespace tensorflow {
 namespace random {
 // NOLINTBEGIN(misc-unused-using-decls)
 using tsl::random::Array;
+using tsl::random::BatchedPhiloxRandom;
 using tsl::random::PhiloxRandom;
 // NOLINTEND(misc-unused-using-decls)
 
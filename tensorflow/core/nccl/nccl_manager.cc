@@ -713,6 +713,10 @@ size_t ComputeBufferSize(const NcclManager::Participant* p,
   }
   return num_elements * DataTypeSize(data_type);
 }
+
+// Upper bound on the total size of the all-reduces that LoopKernelLaunches
+// issues as one NCCL group.
+constexpr size_t kMaxGroupedAllReduceBytes = 64 << 20;
 }  // namespace
 
 void NcclManager::LoopKernelLaunches(NcclStream* nccl_stream) {
@@ -725,9 +729,32 @@ void NcclManager::LoopKernelLaunches(NcclStream* nccl_stream) {
   const cudaStream_t* cu_stream = reinterpret_cast<const cudaStream_t*>(
       comm_stream->implementation()->GpuStreamMemberHack());
 
+  // Returns the closure that runs the done_callback of participant `p_idx` of
+  // `collective` once its nccl kernel has finished running.
+  auto make_done_callback = [](Collective* collective, int p_idx,
+                               ncclResult_t nccl_result) {
+    return [collective, p_idx, nccl_result]() {
+      VLOG(2) << "done Nccl kernel collective_key "
+              << collective->collective_key << " participant " << p_idx
+              << " ncclResult " << nccl_result;
+      if (nccl_result == ncclSuccess) {
+        collective->participants[p_idx]->done_callback(OkStatus());
+      } else {
+        // Propagate the error, but note that if other members of the collective
+        // did launch their kernels, then they are hanging.
+        collective->participants[p_idx]->done_callback(errors::Unknown(
+            "Error invoking NCCL: ", ncclGetErrorString(nccl_result)));
+      }
+      collective->Unref();
+    };
+  };
+
   while (true) {
     // Find collective to run.
     std::pair<Collective*, int> next_launch;
+    // All-reduces that are launched together with `next_launch`.
+    std::vector<std::pair<Collective*, int>> grouped_launches;
+    NcclAllReduceGroup group(kMaxGroupedAllReduceBytes);
     {
       VLOG(3) << "Locking mutex nccl_stream " << nccl_stream;
       mutex_lock l(nccl_stream->mu);
@@ -740,6 +767,71 @@ void NcclManager::LoopKernelLaunches(NcclStream* nccl_stream) {
       }
       next_launch = nccl_stream->pending_launches_.back();
       nccl_stream->pending_launches_.pop_back();
+      // Models with many small gradients queue up all-reduces faster than
+      // their kernels can be launched one by one.  Take the all-reduces that
+      // are already queued behind `next_launch`, up to a size bound, so that
+      // they are issued as a single NCCL group.  Every stream of a collective
+      // sees the same launch order, so the order per communicator is kept.
+      const Collective* first = next_launch.first;
+      if (group.Add(first->type == kAllReduce,
+                    ComputeBufferSize(
+                        first->participants[next_launch.second].get(),
+                        first->data_type))) {
+        while (!nccl_stream->pending_launches_.empty()) {
+          const auto& launch = nccl_stream->pending_launches_.back();
+          if (!group.Add(launch.first->type == kAllReduce,
+                         ComputeBufferSize(
+                             launch.first->participants[launch.second].get(),
+                             launch.first->data_type))) {
+            break;
+          }
+          grouped_launches.push_back(launch);
+          nccl_stream->pending_launches_.pop_back();
+        }
+      }
+    }
+
+    if (!grouped_launches.empty()) {
+      grouped_launches.insert(grouped_launches.begin(), next_launch);
+      VLOG(2) << "call NcclAllReduce for " << grouped_launches.size()
+              << " collectives in one group, first collective_key "
+              << next_launch.first->collective_key << " comm_stream "
+              << comm_stream << " cuda_stream " << cu_stream;
+      profiler::AnnotatedTraceMe traceme([&] {
+        return profiler::TraceMeEncode(
+            "ncclAllReduce",
+            {{"buffer_size", group.bytes()},
+             {"num_collectives", grouped_launches.size()},
+             {"collective_type", "all_reduce"}});
+      });
+      std::vector<ncclResult_t> nccl_results(grouped_launches.size(),
+                                             ncclSuccess);
+      ncclResult_t group_result = ncclGroupStart();
+      if (group_result == ncclSuccess) {
+        for (int i = 0; i < grouped_launches.size(); ++i) {
+          Collective* collective = grouped_launches[i].first;
+          const int p_idx = grouped_launches[i].second;
+          Participant* p = collective->participants[p_idx].get();
+          tensorflow::profiler::TraceMeConsumer consumer(
+              "Run Collective", collective->trace_context);
+          nccl_results[i] = ncclAllReduce(
+              p->input->tensor_data().data(),
+              const_cast<char*>(p->output->tensor_data().data()),
+              p->input->NumElements(), ToNcclType(collective->data_type),
+              collective->reduction_op,
+              collective->communicator->members[p_idx].nccl_comm, *cu_stream);
+        }
+        group_result = ncclGroupEnd();
+      }
+      for (int i = 0; i < grouped_launches.size(); ++i) {
+        Collective* collective = grouped_launches[i].first;
+        const int p_idx = grouped_launches[i].second;
+        const ncclResult_t nccl_result =
+            nccl_results[i] == ncclSuccess ? group_result : nccl_results[i];
+        collective->participants[p_idx]->event_mgr->ThenExecute(
+            comm_stream, make_done_callback(collective, p_idx, nccl_result));
+      }
+      continue;
     }
 
     // Launch the nccl kernel.
@@ -904,21 +996,8 @@ void NcclManager::LoopKernelLaunches(NcclStream* nccl_stream) {
     }
 
     // Run the done_callback when the nccl kernel finishes running.
-    auto done_callback = [collective, p_idx, nccl_result]() {
-      VLOG(2) << "done Nccl kernel collective_key "
-              << collective->collective_key << " participant " << p_idx
-              << " ncclResult " << nccl_result;
-      if (nccl_result == ncclSuccess) {
-        collective->participants[p_idx]->done_callback(OkStatus());
-      } else {
-        // Propagate the error, but note that if other members of the collective
-        // did launch their kernels, then they are hanging.
-        collective->participants[p_idx]->done_callback(errors::Unknown(
-            "Error invoking NCCL: ", ncclGetErrorString(nccl_result)));
-      }
-      collective->Unref();
-    };
-    p->event_mgr->ThenExecute(comm_stream, done_callback);
+    p->event_mgr->ThenExecute(
+        comm_stream, make_done_callback(collective, p_idx, nccl_result));
   }
 }
 
@@ -45,6 +45,36 @@ limitations under the License.
 
 namespace tensorflow {
 
+// Decides which of the all-reduces queued on an NCCL stream are launched
+// between a single ncclGroupStart/ncclGroupEnd pair.  Queued collectives are
+// added in launch order.  A group starts with an all-reduce of any size and
+// takes the following all-reduces while their total size is at most
+// `max_bytes`.
+class NcclAllReduceGroup {
+ public:
+  explicit NcclAllReduceGroup(size_t max_bytes) : max_bytes_(max_bytes) {}
+
+  // Adds the next queued collective to the group and returns true, or returns
+  // false if it is launched after the group.  Once this returns false the
+  // group is complete.
+  bool Add(bool is_all_reduce, size_t bytes) {
+    if (!is_all_reduce || (size_ > 0 && bytes_ + bytes > max_bytes_)) {
+      return false;
+    }
+    bytes_ += bytes;
+    ++size_;
+    return true;
+  }
+
+  int size() const { return size_; }
+  size_t bytes() const { return bytes_; }
+
+ private:
+  const size_t max_bytes_;
+  int size_ = 0;
+  size_t bytes_ = 0;
+};
+
 // NCCL manager is used to make the asynchronous communicator calls and to
 // manage the per-device streams used for communication.
 //
@@ -630,6 +630,34 @@ TYPED_TEST(NcclManagerTest, BroadcastWithDifferentRanks) {
   }
 }
 
+TEST(NcclAllReduceGroupTest, TakesAllReducesUpToMaxBytes) {
+  NcclAllReduceGroup group(/*max_bytes=*/100);
+  EXPECT_TRUE(group.Add(/*is_all_reduce=*/true, 40));
+  EXPECT_TRUE(group.Add(/*is_all_reduce=*/true, 60));
+  EXPECT_FALSE(group.Add(/*is_all_reduce=*/true, 1));
+  EXPECT_EQ(group.size(), 2);
+  EXPECT_EQ(group.bytes(), 100);
+}
+
+TEST(NcclAllReduceGroupTest, StopsAtOtherCollectives) {
+  NcclAllReduceGroup group(/*max_bytes=*/100);
+  EXPECT_TRUE(group.Add(/*is_all_reduce=*/true, 10));
+  EXPECT_FALSE(group.Add(/*is_all_reduce=*/false, 10));
+  EXPECT_EQ(group.size(), 1);
+
+  NcclAllReduceGroup broadcast_first(/*max_bytes=*/100);
+  EXPECT_FALSE(broadcast_first.Add(/*is_all_reduce=*/false, 10));
+  EXPECT_EQ(broadcast_first.size(), 0);
+}
+
+TEST(NcclAllReduceGroupTest, StartsWithAllReduceOfAnySize) {
+  NcclAllReduceGroup group(/*max_bytes=*/100);
+  EXPECT_TRUE(group.Add(/*is_all_reduce=*/true, 1000));
+  EXPECT_FALSE(group.Add(/*is_all_reduce=*/true, 1));
+  EXPECT_EQ(group.size(), 1);
+  EXPECT_EQ(group.bytes(), 1000);
+}
+
 // Multi-node NCCL tests.
 
 TEST(NcclManagerTest, CommunicatorKey) {
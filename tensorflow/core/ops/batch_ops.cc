@@ -54,6 +54,7 @@ REGISTER_OP("BatchFunction")
     // NOTE: Support for `enable_large_batch_splitting == true` is still
     // developed in progress.
     .Attr("enable_large_batch_splitting: bool = false")
+    .Attr("batch_padding_policy: {'PAD_UP', 'MINIMIZE_LATENCY'} = 'PAD_UP'")
     // TODO(apassos): Fix this shape inference function. It requires shape
     // inference of function calls.
     .SetShapeFn(shape_inference::UnknownShape)
@@ -117,5 +117,6 @@ REGISTER_OP("DebugNumericSummaryV2")
     .Attr("T: type")
     .Attr("tensor_debug_mode: int = -1")
     .Attr("tensor_id: int = -1")
+    .Attr("sampling_period: int >= 1 = 1")
     .SetShapeFn(shape_inference::UnknownShape);
 }  // namespace tensorflow
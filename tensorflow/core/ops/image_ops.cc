@@ -320,6 +320,35 @@ REGISTER_OP("ResizeBilinear")
     .Attr("half_pixel_centers: bool = false")
     .SetShapeFn(ResizeShapeFn);
 
+// --------------------------------------------------------------------------
+// Computes `(ResizeBilinear(images, size) - mean) * scale`, broadcasting `mean`
+// and `scale` along the channels, and casts the result to `out_type` in the
+// layout given by `data_format`. Inserted by the grappler remapper.
+REGISTER_OP("_FusedImagePreprocess")
+    .Input("images: T")
+    .Input("size: int32")
+    .Input("mean: float")
+    .Input("scale: float")
+    .Output("output: out_type")
+    .Attr(
+        "T: {int8, uint8, int16, uint16, int32, int64, bfloat16, half, "
+        "float, double}")
+    .Attr("out_type: {float, bfloat16} = DT_FLOAT")
+    .Attr("align_corners: bool = false")
+    .Attr("half_pixel_centers: bool = false")
+    .Attr("data_format: {'NHWC', 'NCHW'} = 'NHWC'")
+    .SetShapeFn([](InferenceContext* c) {
+      TF_RETURN_IF_ERROR(ResizeShapeFn(c));
+      string data_format;
+      TF_RETURN_IF_ERROR(c->GetAttr("data_format", &data_format));
+      if (data_format == "NCHW") {
+        ShapeHandle nhwc = c->output(0);
+        c->set_output(0, c->MakeShape({c->Dim(nhwc, 0), c->Dim(nhwc, 3),
+                                       c->Dim(nhwc, 1), c->Dim(nhwc, 2)}));
+      }
+      return OkStatus();
+    });
+
 // --------------------------------------------------------------------------
 REGISTER_OP("ScaleAndTranslate")
     .Input("images: T")
@@ -526,6 +555,42 @@ REGISTER_OP("DecodeAndCropJpeg")
       return OkStatus();
     });
 
+// --------------------------------------------------------------------------
+REGISTER_OP("DecodeJpegCropResize")
+    .Input("contents: string")
+    .Input("crop_window: int32")
+    .Input("size: int32")
+    .Attr("channels: int = 0")
+    .Attr("fancy_upscaling: bool = true")
+    .Attr("dct_method: string = ''")
+    .Output("image: float")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 0, &unused));
+      DimensionHandle unused_dim;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 1, &unused));
+      TF_RETURN_IF_ERROR(c->WithValue(c->Dim(unused, 0), 4, &unused_dim));
+
+      int32_t channels;
+      TF_RETURN_IF_ERROR(c->GetAttr("channels", &channels));
+      DimensionHandle channels_dim = c->UnknownDim();
+      if (channels != 0) {
+        if (channels < 0) {
+          return errors::InvalidArgument("channels must be non-negative, got ",
+                                         channels);
+        }
+        channels_dim = c->MakeDim(channels);
+      }
+
+      ShapeHandle size;
+      TF_RETURN_IF_ERROR(c->MakeShapeFromShapeTensor(2, &size));
+      TF_RETURN_IF_ERROR(c->WithRank(size, 2, &size));
+      ShapeHandle out;
+      TF_RETURN_IF_ERROR(c->Concatenate(size, c->Vector(channels_dim), &out));
+      c->set_output(0, out);
+      return OkStatus();
+    });
+
 // --------------------------------------------------------------------------
 REGISTER_OP("EncodeJpeg")
     .Input("image: uint8")
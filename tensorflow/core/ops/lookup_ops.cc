@@ -384,6 +384,22 @@ REGISTER_OP("AnonymousHashTable")
     .SetIsStateful()
     .SetShapeFn(ScalarOutput);
 
+REGISTER_OP("MappedHashTable")
+    .Input("filename: string")
+    .Output("table_handle: resource")
+    .Attr("container: string = ''")
+    .Attr("shared_name: string = ''")
+    .Attr("use_node_name_sharing: bool = false")
+    .Attr("key_dtype: {int64, string}")
+    .Attr("value_dtype: {int64, string}")
+    .SetIsStateful()
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 0, &unused));
+      c->set_output(0, c->Scalar());
+      return OkStatus();
+    });
+
 REGISTER_OP("MutableHashTable")
     .Output("table_handle: Ref(string)")
     .Attr("container: string = ''")
@@ -550,4 +566,21 @@ REGISTER_OP("InitializeTableFromTextFileV2")
       return OkStatus();
     });
 
+REGISTER_OP("WriteMappedHashTableFile")
+    .Input("filename: string")
+    .Input("keys: Tkey")
+    .Input("values: Tval")
+    .Attr("Tkey: {int64, string}")
+    .Attr("Tval: {int64, string}")
+    .SetIsStateful()
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 0, &unused));
+
+      ShapeHandle keys;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 1, &keys));
+      TF_RETURN_IF_ERROR(c->Merge(keys, c->input(2), &keys));
+      return OkStatus();
+    });
+
 }  // namespace tensorflow
@@ -1282,6 +1282,47 @@ REGISTER_OP("LogSoftmax")
 
 // --------------------------------------------------------------------------
 
+REGISTER_OP("_FusedAttention")
+    .Input("query: T")
+    .Input("key: T")
+    .Input("value: T")
+    .Input("scale: T")
+    .Input("args: num_args * T")
+    .Output("output: T")
+    .Attr("T: {float}")
+    .Attr("num_args: int >= 0 = 0")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle query;
+      TF_RETURN_IF_ERROR(c->WithRankAtLeast(c->input(0), 3, &query));
+      ShapeHandle key;
+      TF_RETURN_IF_ERROR(c->WithRankAtLeast(c->input(1), 3, &key));
+      ShapeHandle value;
+      TF_RETURN_IF_ERROR(c->WithRankAtLeast(c->input(2), 3, &value));
+      ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(3), 0, &unused));
+      ShapeHandle output;
+      TF_RETURN_IF_ERROR(c->Subshape(query, 0, -1, &output));
+      TF_RETURN_IF_ERROR(
+          c->Concatenate(output, c->Vector(c->Dim(value, -1)), &output));
+      c->set_output(0, output);
+      return OkStatus();
+    })
+    .Doc(R"doc(
+Computes scaled dot-product attention,
+`BatchMatMul(Softmax(BatchMatMul(query, key, adj_y=True) * scale + mask),
+value)`.
+
+`query` has shape `[..., Sq, D]`, `key` has shape `[..., Sk, D]` and `value`
+has shape `[..., Sk, Dv]`, with identical batch dimensions. If `num_args` is 1,
+`args` holds the additive mask, which has the rank of the attention scores and
+broadcasts to `[..., Sq, Sk]`.
+
+*NOTE*: Do not invoke this operator directly in Python. Grappler is
+expected to create these operators.
+)doc");
+
+// --------------------------------------------------------------------------
+
 REGISTER_OP("SoftmaxCrossEntropyWithLogits")
     .Input("features: T")
     .Input("labels: T")
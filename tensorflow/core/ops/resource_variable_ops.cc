@@ -23,6 +23,7 @@
 #include "tensorflow/core/framework/shape_inference.h"
 #include "tensorflow/core/lib/core/errors.h"
 
+using ::tensorflow::shape_inference::DimensionHandle;
 using ::tensorflow::shape_inference::InferenceContext;
 using ::tensorflow::shape_inference::ShapeAndType;
 using ::tensorflow::shape_inference::ShapeHandle;
@@ -309,6 +310,62 @@ REGISTER_OP("ResourceGather")
       return OkStatus();
     });
 
+// Fusion of ResourceGather followed by a SparseSegmentSum, SparseSegmentMean or
+// SparseSegmentSqrtN, created by the grappler remapper. Row i of the output is
+// the combination of the rows `ids[indices[k]]` of the variable for which
+// `segment_ids[k] == i`. A negative `num_segments` means the last segment id
+// plus one.
+REGISTER_OP("_EmbeddingLookupCombine")
+    .Input("resource: resource")
+    .Input("ids: Tids")
+    .Input("indices: Tidx")
+    .Input("segment_ids: Tsegmentids")
+    .Input("num_segments: Tnumsegments")
+    .Output("output: dtype")
+    .Attr("dtype: {bfloat16, half, float}")
+    .Attr("combiner: {'sum', 'mean', 'sqrtn'}")
+    .Attr("Tids: {int32, int64} = DT_INT32")
+    .Attr("Tidx: {int32, int64} = DT_INT32")
+    .Attr("Tsegmentids: {int32, int64} = DT_INT32")
+    .Attr("Tnumsegments: {int32, int64} = DT_INT32")
+    .SetShapeFn([](InferenceContext* c) {
+      std::vector<ShapeAndType> handle_shape_and_type;
+      TF_RETURN_IF_ERROR(shape_inference::ValidateVariableResourceHandle(
+          c, &handle_shape_and_type));
+
+      ShapeHandle params_shape;
+      TF_RETURN_IF_ERROR(c->WithRankAtLeast(handle_shape_and_type[0].shape, 1,
+                                            &params_shape));
+
+      ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 1, &unused));
+      ShapeHandle indices_shape;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 1, &indices_shape));
+      ShapeHandle segment_ids_shape;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(3), 1, &segment_ids_shape));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(4), 0, &unused));
+
+      // indices and segment_ids should merge cleanly.
+      TF_RETURN_IF_ERROR(c->Merge(indices_shape, segment_ids_shape, &unused));
+
+      ShapeHandle subshape;
+      TF_RETURN_IF_ERROR(c->Subshape(params_shape, 1, &subshape));
+
+      DimensionHandle dim0 = c->UnknownDim();
+      const Tensor* num_segments = c->input_tensor(4);
+      if (num_segments != nullptr) {
+        const int64_t value = num_segments->dtype() == DT_INT32
+                                  ? num_segments->scalar<int32>()()
+                                  : num_segments->scalar<int64_t>()();
+        if (value >= 0) dim0 = c->MakeDim(value);
+      }
+
+      ShapeHandle out;
+      TF_RETURN_IF_ERROR(c->Concatenate(c->Vector(dim0), subshape, &out));
+      c->set_output(0, out);
+      return OkStatus();
+    });
+
 REGISTER_OP("ResourceGatherNd")
     .Input("resource: resource")
     .Input("indices: Tindices")
@@ -826,6 +826,50 @@ REGISTER_OP("ResourceApplyAdam")
     .Attr("use_nesterov: bool = false")
     .SetShapeFn(ApplyAdamShapeFn</*is_resource=*/true>);
 
+static Status MultiTensorApplyAdamShapeFn(InferenceContext* c) {
+  int num_tensors;
+  TF_RETURN_IF_ERROR(c->GetAttr("N", &num_tensors));
+  ShapeHandle unused;
+  const int scalars_idx = 3 * num_tensors;
+  for (int i = scalars_idx; i < scalars_idx + 6; ++i) {
+    // beta1_power, beta2_power, lr, beta1, beta2, epsilon
+    TF_RETURN_IF_ERROR(c->WithRank(c->input(i), 0, &unused));
+  }
+  const int grad_idx = scalars_idx + 6;
+  for (int i = 0; i < num_tensors; ++i) {
+    ShapeHandle s = ShapeOrHandleShape</*is_resource=*/true>(c, i);  // var
+    TF_RETURN_IF_ERROR(c->Merge(
+        s, ShapeOrHandleShape</*is_resource=*/true>(c, num_tensors + i),
+        &s));  // m
+    TF_RETURN_IF_ERROR(c->Merge(
+        s, ShapeOrHandleShape</*is_resource=*/true>(c, 2 * num_tensors + i),
+        &s));  // v
+    TF_RETURN_IF_ERROR(
+        HandleGradAndIndicesInputs</*is_sparse=*/false, /*is_resource=*/true>(
+            c, grad_idx + i, &s));
+  }
+  return OkStatus();
+}
+
+// Applies ResourceApplyAdam to N variables that share the hyperparameters in
+// one kernel. Generated by the remapper from groups of ResourceApplyAdam ops.
+REGISTER_OP("_MultiTensorResourceApplyAdam")
+    .Input("var: N * resource")
+    .Input("m: N * resource")
+    .Input("v: N * resource")
+    .Input("beta1_power: T")
+    .Input("beta2_power: T")
+    .Input("lr: T")
+    .Input("beta1: T")
+    .Input("beta2: T")
+    .Input("epsilon: T")
+    .Input("grad: N * T")
+    .Attr("N: int >= 1")
+    .Attr("T: {bfloat16, half, float, double}")
+    .Attr("use_locking: bool = false")
+    .Attr("use_nesterov: bool = false")
+    .SetShapeFn(MultiTensorApplyAdamShapeFn);
+
 template <bool is_resource>
 static Status ApplyAdamWithAmsgradShapeFn(InferenceContext* c) {
   ShapeHandle unused;
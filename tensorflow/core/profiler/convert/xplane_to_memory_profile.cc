@@ -47,6 +47,9 @@ namespace {
 
 constexpr int64_t kInvalidStepId = -1;
 
+// Maximum number of buffer lifetimes kept in the memory profile of each step.
+constexpr size_t kMaxBufferLifetimesPerStep = 100;
+
 // Index of the time-sorted memory_profile_snapshots list, and the
 // MemoryActivityMetadata proto it contains.
 using IndexMetaPair =
@@ -396,6 +399,137 @@ void ProcessActiveAllocations(int64_t peak_bytes_profile_step_id,
           << memory_profile->active_allocations_size();
 }
 
+// Returns the memory usage (heap and stack) at the time of `snapshot`.
+int64_t GetBytesInUse(const MemoryProfileSnapshot& snapshot) {
+  return snapshot.aggregation_stats().heap_allocated_bytes() +
+         snapshot.aggregation_stats().stack_reserved_bytes();
+}
+
+// Generate the memory profile of each step: its peak memory usage and
+// fragmentation, the allocations live at the peak broken down by TF Op, and
+// the allocations made within the step with the largest live ranges.
+void ProcessStepMemoryProfiles(PerAllocatorMemoryProfile* memory_profile) {
+  const protobuf::RepeatedPtrField<MemoryProfileSnapshot>& snapshots =
+      memory_profile->memory_profile_snapshots();
+  if (snapshots.empty()) return;
+
+  absl::flat_hash_map<int64_t /*step_id*/, StepMemoryProfile> step_profiles;
+  absl::flat_hash_map<int64_t /*step_id*/, int /*index*/> peak_indices;
+  for (int i = 0; i < snapshots.size(); i++) {
+    const MemoryProfileSnapshot& snapshot = snapshots.at(i);
+    int64_t step_id = snapshot.activity_metadata().step_id();
+    int64_t bytes_in_use = GetBytesInUse(snapshot);
+    auto [it, inserted] = step_profiles.try_emplace(step_id);
+    StepMemoryProfile& step_profile = it->second;
+    if (inserted || bytes_in_use >= step_profile.peak_bytes_in_use()) {
+      step_profile.set_step_id(step_id);
+      step_profile.set_peak_bytes_in_use(bytes_in_use);
+      step_profile.set_peak_time_offset_ps(snapshot.time_offset_ps());
+      peak_indices[step_id] = i;
+    }
+    step_profile.set_max_fragmentation(
+        std::max(step_profile.max_fragmentation(),
+                 snapshot.aggregation_stats().fragmentation()));
+  }
+
+  // Replay the memory activities to find the allocations live at the peak of
+  // each step, and the live range of each allocation.
+  absl::flat_hash_map<uint64 /*address*/, int /*index*/> live_allocs;
+  absl::flat_hash_map<int64_t /*step_id*/, std::vector<BufferLifetime>>
+      lifetimes;
+  auto add_lifetime = [&](int alloc_index, int64_t deallocation_time_ps) {
+    const MemoryProfileSnapshot& alloc = snapshots.at(alloc_index);
+    const MemoryActivityMetadata& metadata = alloc.activity_metadata();
+    BufferLifetime& lifetime = lifetimes[metadata.step_id()].emplace_back();
+    lifetime.set_tf_op_name(metadata.tf_op_name());
+    lifetime.set_address(metadata.address());
+    lifetime.set_allocation_bytes(metadata.allocation_bytes());
+    lifetime.set_allocation_time_ps(alloc.time_offset_ps());
+    lifetime.set_deallocation_time_ps(deallocation_time_ps);
+  };
+  for (int i = 0; i < snapshots.size(); i++) {
+    const MemoryProfileSnapshot& snapshot = snapshots.at(i);
+    const MemoryActivityMetadata& metadata = snapshot.activity_metadata();
+    if (metadata.memory_activity() == ALLOCATION) {
+      // Like UpdateDeallocation, keep the first of two allocations recorded
+      // for the same address.
+      live_allocs.try_emplace(metadata.address(), i);
+    } else if (metadata.memory_activity() == DEALLOCATION) {
+      auto it = live_allocs.find(metadata.address());
+      if (it != live_allocs.end()) {
+        add_lifetime(it->second, snapshot.time_offset_ps());
+        live_allocs.erase(it);
+      }
+    }
+    if (peak_indices[metadata.step_id()] != i) continue;
+
+    absl::flat_hash_map<absl::string_view, OpMemoryBreakdown> breakdown_by_op;
+    for (const auto& [address, index] : live_allocs) {
+      const MemoryActivityMetadata& live =
+          snapshots.at(index).activity_metadata();
+      OpMemoryBreakdown& breakdown = breakdown_by_op[live.tf_op_name()];
+      breakdown.set_allocation_bytes(breakdown.allocation_bytes() +
+                                     live.allocation_bytes());
+      breakdown.set_num_allocations(breakdown.num_allocations() + 1);
+    }
+    std::vector<OpMemoryBreakdown> breakdowns;
+    breakdowns.reserve(breakdown_by_op.size());
+    for (auto& [tf_op_name, breakdown] : breakdown_by_op) {
+      breakdown.set_tf_op_name(std::string(tf_op_name));
+      breakdowns.push_back(std::move(breakdown));
+    }
+    absl::c_sort(breakdowns, [](const OpMemoryBreakdown& a,
+                                const OpMemoryBreakdown& b) {
+      return std::make_tuple(-a.allocation_bytes(), a.tf_op_name()) <
+             std::make_tuple(-b.allocation_bytes(), b.tf_op_name());
+    });
+    StepMemoryProfile& step_profile = step_profiles[metadata.step_id()];
+    for (auto& breakdown : breakdowns) {
+      *step_profile.add_peak_op_breakdown() = std::move(breakdown);
+    }
+  }
+  for (const auto& [address, index] : live_allocs) {
+    add_lifetime(index, /*deallocation_time_ps=*/-1);
+  }
+
+  // Keep the allocations of each step that hold the most memory over time.
+  const int64_t end_time_ps = snapshots.rbegin()->time_offset_ps();
+  auto live_byte_ps = [end_time_ps](const BufferLifetime& lifetime) {
+    int64_t deallocation_time_ps = lifetime.deallocation_time_ps() < 0
+                                       ? end_time_ps
+                                       : lifetime.deallocation_time_ps();
+    return static_cast<double>(lifetime.allocation_bytes()) *
+           (deallocation_time_ps - lifetime.allocation_time_ps());
+  };
+  for (auto& [step_id, step_lifetimes] : lifetimes) {
+    absl::c_sort(step_lifetimes, [&](const BufferLifetime& a,
+                                     const BufferLifetime& b) {
+      return std::make_tuple(-live_byte_ps(a), a.allocation_time_ps()) <
+             std::make_tuple(-live_byte_ps(b), b.allocation_time_ps());
+    });
+    if (step_lifetimes.size() > kMaxBufferLifetimesPerStep) {
+      step_lifetimes.resize(kMaxBufferLifetimesPerStep);
+    }
+    StepMemoryProfile& step_profile = step_profiles[step_id];
+    for (auto& lifetime : step_lifetimes) {
+      *step_profile.add_buffer_lifetimes() = std::move(lifetime);
+    }
+  }
+
+  std::vector<StepMemoryProfile> sorted_step_profiles;
+  sorted_step_profiles.reserve(step_profiles.size());
+  for (auto& [step_id, step_profile] : step_profiles) {
+    sorted_step_profiles.push_back(std::move(step_profile));
+  }
+  absl::c_sort(sorted_step_profiles, [](const StepMemoryProfile& a,
+                                        const StepMemoryProfile& b) {
+    return a.step_id() < b.step_id();
+  });
+  for (auto& step_profile : sorted_step_profiles) {
+    *memory_profile->add_step_memory_profiles() = std::move(step_profile);
+  }
+}
+
 // This function saves the MemoryProfileSnapshots referenced by
 // <active_allocations> max_num_snapshots.
 void SaveActiveAllocationSnapshots(
@@ -521,6 +655,7 @@ void ProcessMemoryProfileProto(int64_t max_num_snapshots,
                               .peak_bytes_in_use(),
                           allocator_memory_profile);
     ProcessActiveAllocations(peak_step_id, allocator_memory_profile);
+    ProcessStepMemoryProfiles(allocator_memory_profile);
     SaveActiveAllocationSnapshots(
         snapshots, allocator_memory_profile->mutable_active_allocations());
   }
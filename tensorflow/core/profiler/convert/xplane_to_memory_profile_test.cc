@@ -122,6 +122,69 @@ TEST(ConvertXPlaneToMemoryProfile, OneAllocatorMultiActivitiesTest) {
       2000);
 }
 
+// Tests the per-step memory profiles of a profile with two steps, where an
+// allocation of the first step is freed in the second one.
+TEST(ConvertXPlaneToMemoryProfile, StepMemoryProfilesTest) {
+  XSpace space;
+  XPlane* host_plane = GetOrCreateHostXPlane(&space);
+  XPlaneBuilder host_plane_builder(host_plane);
+  host_plane_builder.ReserveLines(1);
+
+  auto tf_executor_thread = host_plane_builder.GetOrCreateLine(0);
+  auto add_event = [&](absl::string_view name, int64_t offset_ps,
+                       int64_t step_id, int64_t address, int64_t bytes,
+                       int64_t bytes_allocated, absl::string_view tf_op) {
+    CreateXEvent(&host_plane_builder, &tf_executor_thread, name, offset_ps,
+                 1000,
+                 {{StatType::kBytesAllocated, bytes_allocated},
+                  {StatType::kAllocationBytes, bytes},
+                  {StatType::kAddress, address},
+                  {StatType::kGroupId, step_id},
+                  {StatType::kAllocatorName, "GPU_0_bfc"},
+                  {StatType::kTfOp, tf_op}});
+  };
+  add_event("MemoryAllocation", 1000, 1, 111, 100, 100, "a");
+  add_event("MemoryAllocation", 2000, 1, 222, 300, 400, "b");
+  add_event("MemoryDeallocation", 3000, 1, 111, 100, 300, "");
+  add_event("MemoryAllocation", 4000, 2, 333, 200, 500, "a");
+  add_event("MemoryDeallocation", 5000, 2, 222, 300, 200, "");
+
+  MemoryProfile memory_profile = ConvertXPlaneToMemoryProfile(*host_plane);
+  const auto& allocator_memory_profile =
+      memory_profile.memory_profile_per_allocator().at("GPU_0_bfc");
+  ASSERT_EQ(allocator_memory_profile.step_memory_profiles_size(), 2);
+
+  const StepMemoryProfile& step1 =
+      allocator_memory_profile.step_memory_profiles(0);
+  EXPECT_EQ(step1.step_id(), 1);
+  EXPECT_EQ(step1.peak_bytes_in_use(), 400);
+  EXPECT_EQ(step1.peak_time_offset_ps(), 2000);
+  ASSERT_EQ(step1.peak_op_breakdown_size(), 2);
+  EXPECT_EQ(step1.peak_op_breakdown(0).tf_op_name(), "b");
+  EXPECT_EQ(step1.peak_op_breakdown(0).allocation_bytes(), 300);
+  EXPECT_EQ(step1.peak_op_breakdown(1).tf_op_name(), "a");
+  EXPECT_EQ(step1.peak_op_breakdown(1).allocation_bytes(), 100);
+  ASSERT_EQ(step1.buffer_lifetimes_size(), 2);
+  EXPECT_EQ(step1.buffer_lifetimes(0).tf_op_name(), "b");
+  EXPECT_EQ(step1.buffer_lifetimes(0).allocation_time_ps(), 2000);
+  EXPECT_EQ(step1.buffer_lifetimes(0).deallocation_time_ps(), 5000);
+  EXPECT_EQ(step1.buffer_lifetimes(1).tf_op_name(), "a");
+  EXPECT_EQ(step1.buffer_lifetimes(1).deallocation_time_ps(), 3000);
+
+  const StepMemoryProfile& step2 =
+      allocator_memory_profile.step_memory_profiles(1);
+  EXPECT_EQ(step2.step_id(), 2);
+  EXPECT_EQ(step2.peak_bytes_in_use(), 500);
+  EXPECT_EQ(step2.peak_time_offset_ps(), 4000);
+  ASSERT_EQ(step2.peak_op_breakdown_size(), 2);
+  EXPECT_EQ(step2.peak_op_breakdown(0).tf_op_name(), "b");
+  EXPECT_EQ(step2.peak_op_breakdown(1).tf_op_name(), "a");
+  EXPECT_EQ(step2.peak_op_breakdown(1).allocation_bytes(), 200);
+  ASSERT_EQ(step2.buffer_lifetimes_size(), 1);
+  EXPECT_EQ(step2.buffer_lifetimes(0).address(), 333);
+  EXPECT_EQ(step2.buffer_lifetimes(0).deallocation_time_ps(), -1);
+}
+
 }  // namespace
 }  // namespace profiler
 }  // namespace tensorflow
@@ -14,6 +14,8 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/summary/summary_file_writer.h"
 
+#include <deque>
+#include <functional>
 #include <memory>
 
 #include "absl/strings/match.h"
@@ -32,11 +34,14 @@ namespace {
 
 class SummaryFileWriter : public SummaryWriterInterface {
  public:
-  SummaryFileWriter(int max_queue, int flush_millis, Env* env)
+  SummaryFileWriter(const SummaryFileWriterOptions& options, Env* env)
       : SummaryWriterInterface(),
         is_initialized_(false),
-        max_queue_(max_queue),
-        flush_millis_(flush_millis),
+        max_queue_(options.max_queue),
+        flush_millis_(options.flush_millis),
+        async_(options.async),
+        max_pending_bytes_(options.max_pending_bytes),
+        drop_when_full_(options.drop_when_full),
         env_(env) {}
 
   Status Initialize(const string& logdir, const string& filename_suffix) {
@@ -63,10 +68,21 @@ class SummaryFileWriter : public SummaryWriterInterface {
         "Could not initialize events writer.");
     last_flush_ = env_->NowMicros();
     is_initialized_ = true;
+    if (async_) {
+      background_thread_.reset(env_->StartThread(
+          ThreadOptions(), "summary_file_writer", [this]() { WriterLoop(); }));
+    }
     return OkStatus();
   }
 
   Status Flush() override {
+    if (async_) {
+      mutex_lock l(pending_mu_);
+      while (!pending_.empty() || converting_) {
+        pending_cv_.wait(l);
+      }
+      TF_RETURN_IF_ERROR(ConsumeAsyncStatus());
+    }
     mutex_lock ml(mu_);
     if (!is_initialized_) {
       return errors::FailedPrecondition("Class was not properly initialized.");
@@ -75,98 +91,199 @@ class SummaryFileWriter : public SummaryWriterInterface {
   }
 
   ~SummaryFileWriter() override {
+    if (background_thread_ != nullptr) {
+      {
+        mutex_lock l(pending_mu_);
+        shutting_down_ = true;
+      }
+      pending_cv_.notify_all();
+      // Joins the thread once it has converted all pending summaries.
+      background_thread_.reset();
+    }
     (void)Flush();  // Ignore errors.
   }
 
   Status WriteTensor(int64_t global_step, Tensor t, const string& tag,
                      const string& serialized_metadata) override {
-    std::unique_ptr<Event> e{new Event};
-    e->set_step(global_step);
-    e->set_wall_time(GetWallTime());
-    Summary::Value* v = e->mutable_summary()->add_value();
-
-    if (t.dtype() == DT_STRING) {
-      // Treat DT_STRING specially, so that tensor_util.MakeNdarray in Python
-      // can convert the TensorProto to string-type numpy array. MakeNdarray
-      // does not work with strings encoded by AsProtoTensorContent() in
-      // tensor_content.
-      t.AsProtoField(v->mutable_tensor());
-    } else {
-      t.AsProtoTensorContent(v->mutable_tensor());
-    }
-    v->set_tag(tag);
-    if (!serialized_metadata.empty()) {
-      v->mutable_metadata()->ParseFromString(serialized_metadata);
-    }
-    return WriteEvent(std::move(e));
+    return WriteSummary(
+        global_step, t.TotalBytes(),
+        [t, tag, serialized_metadata](Event* e) {
+          Summary::Value* v = e->mutable_summary()->add_value();
+          if (t.dtype() == DT_STRING) {
+            // Treat DT_STRING specially, so that tensor_util.MakeNdarray in
+            // Python can convert the TensorProto to string-type numpy array.
+            // MakeNdarray does not work with strings encoded by
+            // AsProtoTensorContent() in tensor_content.
+            t.AsProtoField(v->mutable_tensor());
+          } else {
+            t.AsProtoTensorContent(v->mutable_tensor());
+          }
+          v->set_tag(tag);
+          if (!serialized_metadata.empty()) {
+            v->mutable_metadata()->ParseFromString(serialized_metadata);
+          }
+          return OkStatus();
+        });
   }
 
   Status WriteScalar(int64_t global_step, Tensor t,
                      const string& tag) override {
-    std::unique_ptr<Event> e{new Event};
-    e->set_step(global_step);
-    e->set_wall_time(GetWallTime());
-    TF_RETURN_IF_ERROR(
-        AddTensorAsScalarToSummary(t, tag, e->mutable_summary()));
-    return WriteEvent(std::move(e));
+    return WriteSummary(global_step, t.TotalBytes(), [t, tag](Event* e) {
+      return AddTensorAsScalarToSummary(t, tag, e->mutable_summary());
+    });
   }
 
   Status WriteHistogram(int64_t global_step, Tensor t,
                         const string& tag) override {
-    std::unique_ptr<Event> e{new Event};
-    e->set_step(global_step);
-    e->set_wall_time(GetWallTime());
-    TF_RETURN_IF_ERROR(
-        AddTensorAsHistogramToSummary(t, tag, e->mutable_summary()));
-    return WriteEvent(std::move(e));
+    return WriteSummary(global_step, t.TotalBytes(), [t, tag](Event* e) {
+      return AddTensorAsHistogramToSummary(t, tag, e->mutable_summary());
+    });
   }
 
   Status WriteImage(int64_t global_step, Tensor t, const string& tag,
                     int max_images, Tensor bad_color) override {
-    std::unique_ptr<Event> e{new Event};
-    e->set_step(global_step);
-    e->set_wall_time(GetWallTime());
-    TF_RETURN_IF_ERROR(AddTensorAsImageToSummary(t, tag, max_images, bad_color,
-                                                 e->mutable_summary()));
-    return WriteEvent(std::move(e));
+    return WriteSummary(
+        global_step, t.TotalBytes() + bad_color.TotalBytes(),
+        [t, tag, max_images, bad_color](Event* e) {
+          return AddTensorAsImageToSummary(t, tag, max_images, bad_color,
+                                           e->mutable_summary());
+        });
   }
 
   Status WriteAudio(int64_t global_step, Tensor t, const string& tag,
                     int max_outputs, float sample_rate) override {
-    std::unique_ptr<Event> e{new Event};
-    e->set_step(global_step);
-    e->set_wall_time(GetWallTime());
-    TF_RETURN_IF_ERROR(AddTensorAsAudioToSummary(
-        t, tag, max_outputs, sample_rate, e->mutable_summary()));
-    return WriteEvent(std::move(e));
+    return WriteSummary(global_step, t.TotalBytes(),
+                        [t, tag, max_outputs, sample_rate](Event* e) {
+                          return AddTensorAsAudioToSummary(
+                              t, tag, max_outputs, sample_rate,
+                              e->mutable_summary());
+                        });
   }
 
   Status WriteGraph(int64_t global_step,
                     std::unique_ptr<GraphDef> graph) override {
-    std::unique_ptr<Event> e{new Event};
-    e->set_step(global_step);
-    e->set_wall_time(GetWallTime());
-    graph->SerializeToString(e->mutable_graph_def());
-    return WriteEvent(std::move(e));
+    const int64_t bytes = graph->ByteSizeLong();
+    std::shared_ptr<GraphDef> g(std::move(graph));
+    return WriteSummary(global_step, bytes, [g](Event* e) {
+      g->SerializeToString(e->mutable_graph_def());
+      return OkStatus();
+    });
   }
 
   Status WriteEvent(std::unique_ptr<Event> event) override {
-    mutex_lock ml(mu_);
-    queue_.emplace_back(std::move(event));
-    if (queue_.size() > max_queue_ ||
-        env_->NowMicros() - last_flush_ > 1000 * flush_millis_) {
-      return InternalFlush();
-    }
-    return OkStatus();
+    if (!async_) return AppendEvent(std::move(event));
+    const int64_t bytes = event->ByteSizeLong();
+    std::shared_ptr<Event> shared(std::move(event));
+    return Enqueue(bytes, [shared](Event* e) {
+      e->Swap(shared.get());
+      return OkStatus();
+    });
   }
 
   string DebugString() const override { return "SummaryFileWriter"; }
 
  private:
+  // Fills in an Event, see WriteSummary().
+  using EventBuilder = std::function<Status(Event*)>;
+
   double GetWallTime() {
     return static_cast<double>(env_->NowMicros()) / 1.0e6;
   }
 
+  // Writes an Event with the given step and the current wall time, filled in
+  // by `builder`. `bytes` is the size of the tensors captured by `builder`.
+  Status WriteSummary(int64_t global_step, int64_t bytes,
+                      EventBuilder builder) {
+    const double wall_time = GetWallTime();
+    EventBuilder fill = [global_step, wall_time,
+                         builder = std::move(builder)](Event* e) {
+      e->set_step(global_step);
+      e->set_wall_time(wall_time);
+      return builder(e);
+    };
+    if (async_) return Enqueue(bytes, std::move(fill));
+    std::unique_ptr<Event> e{new Event};
+    TF_RETURN_IF_ERROR(fill(e.get()));
+    return AppendEvent(std::move(e));
+  }
+
+  // Hands `builder` to the background thread, waiting for (or dropping
+  // the summary if) the pending summaries exceed max_pending_bytes_.
+  Status Enqueue(int64_t bytes, EventBuilder builder) {
+    {
+      mutex_lock l(pending_mu_);
+      TF_RETURN_IF_ERROR(ConsumeAsyncStatus());
+      // A single summary larger than the limit is let through once all
+      // pending summaries are written.
+      if (pending_bytes_ > 0 && pending_bytes_ + bytes > max_pending_bytes_ &&
+          drop_when_full_) {
+        ++num_dropped_;
+        LOG_EVERY_N_SEC(WARNING, 60)
+            << "Dropped " << num_dropped_
+            << " summaries because the summary writer fell behind.";
+        return OkStatus();
+      }
+      while (pending_bytes_ > 0 &&
+             pending_bytes_ + bytes > max_pending_bytes_) {
+        pending_cv_.wait(l);
+      }
+      pending_bytes_ += bytes;
+      pending_.push_back({bytes, std::move(builder)});
+    }
+    pending_cv_.notify_all();
+    return OkStatus();
+  }
+
+  // Converts and writes the pending summaries until the writer is destroyed.
+  void WriterLoop() {
+    std::deque<PendingSummary> batch;
+    while (true) {
+      {
+        mutex_lock l(pending_mu_);
+        converting_ = false;
+        pending_cv_.notify_all();
+        while (pending_.empty() && !shutting_down_) {
+          pending_cv_.wait(l);
+        }
+        if (pending_.empty()) return;
+        batch.swap(pending_);
+        converting_ = true;
+      }
+      int64_t bytes = 0;
+      Status status;
+      for (PendingSummary& summary : batch) {
+        std::unique_ptr<Event> e{new Event};
+        Status s = summary.builder(e.get());
+        if (s.ok()) s = AppendEvent(std::move(e));
+        status.Update(s);
+        bytes += summary.bytes;
+      }
+      // Releases the captured tensors before their bytes are returned.
+      batch.clear();
+      mutex_lock l(pending_mu_);
+      pending_bytes_ -= bytes;
+      async_status_.Update(status);
+    }
+  }
+
+  // Returns and clears the first error of the background thread.
+  Status ConsumeAsyncStatus() TF_EXCLUSIVE_LOCKS_REQUIRED(pending_mu_) {
+    Status s = async_status_;
+    async_status_ = OkStatus();
+    return s;
+  }
+
+  // Queues a complete Event for the events file.
+  Status AppendEvent(std::unique_ptr<Event> event) {
+    mutex_lock ml(mu_);
+    queue_.emplace_back(std::move(event));
+    if (queue_.size() > max_queue_ ||
+        env_->NowMicros() - last_flush_ > 1000 * flush_millis_) {
+      return InternalFlush();
+    }
+    return OkStatus();
+  }
+
   Status InternalFlush() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
     for (const std::unique_ptr<Event>& e : queue_) {
       events_writer_->WriteEvent(*e);
@@ -178,9 +295,17 @@ class SummaryFileWriter : public SummaryWriterInterface {
     return OkStatus();
   }
 
+  struct PendingSummary {
+    int64_t bytes;
+    EventBuilder builder;
+  };
+
   bool is_initialized_;
   const int max_queue_;
   const int flush_millis_;
+  const bool async_;
+  const int64_t max_pending_bytes_;
+  const bool drop_when_full_;
   uint64 last_flush_;
   Env* env_;
   mutex mu_;
@@ -189,6 +314,19 @@ class SummaryFileWriter : public SummaryWriterInterface {
   std::unique_ptr<EventsWriter> events_writer_ TF_GUARDED_BY(mu_);
   std::vector<std::pair<string, SummaryMetadata>> registered_summaries_
       TF_GUARDED_BY(mu_);
+
+  // State of the async mode. Summaries are handed to the background thread
+  // through pending_.
+  mutex pending_mu_;
+  condition_variable pending_cv_;
+  std::deque<PendingSummary> pending_ TF_GUARDED_BY(pending_mu_);
+  int64_t pending_bytes_ TF_GUARDED_BY(pending_mu_) = 0;
+  int64_t num_dropped_ TF_GUARDED_BY(pending_mu_) = 0;
+  // Whether the background thread is converting a batch of summaries.
+  bool converting_ TF_GUARDED_BY(pending_mu_) = false;
+  bool shutting_down_ TF_GUARDED_BY(pending_mu_) = false;
+  Status async_status_ TF_GUARDED_BY(pending_mu_);
+  std::unique_ptr<Thread> background_thread_;
 };
 
 }  // namespace
@@ -197,7 +335,18 @@ Status CreateSummaryFileWriter(int max_queue, int flush_millis,
                                const string& logdir,
                                const string& filename_suffix, Env* env,
                                SummaryWriterInterface** result) {
-  SummaryFileWriter* w = new SummaryFileWriter(max_queue, flush_millis, env);
+  SummaryFileWriterOptions options;
+  options.max_queue = max_queue;
+  options.flush_millis = flush_millis;
+  return CreateSummaryFileWriter(options, logdir, filename_suffix, env,
+                                 result);
+}
+
+Status CreateSummaryFileWriter(const SummaryFileWriterOptions& options,
+                               const string& logdir,
+                               const string& filename_suffix, Env* env,
+                               SummaryWriterInterface** result) {
+  SummaryFileWriter* w = new SummaryFileWriter(options, env);
   const Status s = w->Initialize(logdir, filename_suffix);
   if (!s.ok()) {
     w->Unref();
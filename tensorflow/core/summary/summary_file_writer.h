@@ -38,6 +38,33 @@ Status CreateSummaryFileWriter(int max_queue, int flush_millis,
                                const string& filename_suffix, Env* env,
                                SummaryWriterInterface** result);
 
+struct SummaryFileWriterOptions {
+  // Number of events enqueued before the events file is flushed.
+  int max_queue = 10;
+  // Maximum time between flushes of the events file.
+  int flush_millis = 120000;
+
+  // If true, the Write* calls only capture their tensors (sharing their
+  // buffers, not copying them) and return. Converting the tensors to Event
+  // protos, encoding and writing them happens on a background thread.
+  // Errors of the conversion are returned by a later Write* or Flush call.
+  bool async = false;
+  // Upper bound on the bytes of tensors held by summaries that were not yet
+  // converted in async mode.
+  int64_t max_pending_bytes = 64 << 20;
+  // In async mode, whether summaries that would exceed max_pending_bytes are
+  // dropped. Otherwise the writing thread blocks until the background thread
+  // has caught up.
+  bool drop_when_full = false;
+};
+
+/// \brief Creates SummaryWriterInterface which writes to a file, configured
+/// by `options`. See above.
+Status CreateSummaryFileWriter(const SummaryFileWriterOptions& options,
+                               const string& logdir,
+                               const string& filename_suffix, Env* env,
+                               SummaryWriterInterface** result);
+
 }  // namespace tensorflow
 
 #endif  // TENSORFLOW_CORE_SUMMARY_SUMMARY_FILE_WRITER_H_
@@ -14,12 +14,15 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/summary/summary_file_writer.h"
 
+#include <atomic>
+
 #include "tensorflow/core/framework/summary.pb.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/lib/io/record_reader.h"
 #include "tensorflow/core/platform/env.h"
@@ -37,11 +40,16 @@ class FakeClockEnv : public EnvWrapper {
   uint64 NowSeconds() const override { return current_millis_ * 1000; }
 
  private:
-  uint64 current_millis_;
+  std::atomic<uint64> current_millis_;
 };
 
 class SummaryFileWriterTest : public ::testing::Test {
  protected:
+  SummaryFileWriterTest() {
+    options_.max_queue = 1;
+    options_.flush_millis = 1;
+  }
+
   Status SummaryTestHelper(
       const string& test_name,
       const std::function<Status(SummaryWriterInterface*)>& writer_fn,
@@ -50,7 +58,7 @@ class SummaryFileWriterTest : public ::testing::Test {
     CHECK(tests->insert(test_name).second) << ": " << test_name;
 
     SummaryWriterInterface* writer;
-    TF_CHECK_OK(CreateSummaryFileWriter(1, 1, testing::TmpDir(), test_name,
+    TF_CHECK_OK(CreateSummaryFileWriter(options_, testing::TmpDir(), test_name,
                                         &env_, &writer));
     core::ScopedUnref deleter(writer);
 
@@ -87,6 +95,7 @@ class SummaryFileWriterTest : public ::testing::Test {
     return OkStatus();
   }
 
+  SummaryFileWriterOptions options_;
   FakeClockEnv env_;
 };
 
@@ -259,6 +268,61 @@ TEST_F(SummaryFileWriterTest, WallTime) {
       [](const Event& e) { EXPECT_EQ(e.wall_time(), 7.023); }));
 }
 
+TEST_F(SummaryFileWriterTest, AsyncWriteHistogram) {
+  options_.async = true;
+  TF_CHECK_OK(SummaryTestHelper(
+      "async_hist_test",
+      [](SummaryWriterInterface* writer) {
+        Tensor one(DT_FLOAT, TensorShape({}));
+        one.scalar<float>()() = 1.0;
+        TF_RETURN_IF_ERROR(writer->WriteHistogram(2, one, "name"));
+        TF_RETURN_IF_ERROR(writer->Flush());
+        return OkStatus();
+      },
+      [](const Event& e) {
+        EXPECT_EQ(e.step(), 2);
+        CHECK_EQ(e.summary().value_size(), 1);
+        EXPECT_EQ(e.summary().value(0).tag(), "name");
+        EXPECT_TRUE(e.summary().value(0).has_histo());
+      }));
+}
+
+TEST_F(SummaryFileWriterTest, AsyncWallTimeIsTakenAtWrite) {
+  options_.async = true;
+  // Keeps the summary pending until the Flush below.
+  options_.max_queue = 10;
+  options_.flush_millis = 1000000;
+  env_.AdvanceByMillis(7023);
+  TF_CHECK_OK(SummaryTestHelper(
+      "async_wall_time_test",
+      [this](SummaryWriterInterface* writer) {
+        Tensor one(DT_FLOAT, TensorShape({}));
+        one.scalar<float>()() = 1.0;
+        TF_RETURN_IF_ERROR(writer->WriteScalar(2, one, "name"));
+        env_.AdvanceByMillis(1000);
+        TF_RETURN_IF_ERROR(writer->Flush());
+        return OkStatus();
+      },
+      [](const Event& e) { EXPECT_EQ(e.wall_time(), 7.023); }));
+}
+
+TEST_F(SummaryFileWriterTest, AsyncErrorIsReturnedLater) {
+  options_.async = true;
+  SummaryWriterInterface* writer;
+  TF_CHECK_OK(CreateSummaryFileWriter(options_, testing::TmpDir(),
+                                      "async_error_test", &env_, &writer));
+  core::ScopedUnref deleter(writer);
+  Tensor bad_color(DT_UINT8, TensorShape({1}));
+  bad_color.scalar<uint8>()() = 0;
+  // Images have to be 4-D.
+  Tensor image(DT_UINT8, TensorShape({1, 1}));
+  image.flat<uint8>().setZero();
+  TF_EXPECT_OK(writer->WriteImage(2, image, "name", 1, bad_color));
+  EXPECT_TRUE(errors::IsInvalidArgument(writer->Flush()));
+  // The error is only reported once.
+  TF_EXPECT_OK(writer->Flush());
+}
+
 TEST_F(SummaryFileWriterTest, AvoidFilenameCollision) {
   // Keep unique with all other test names in this file.
   string test_name = "avoid_filename_collision_test";
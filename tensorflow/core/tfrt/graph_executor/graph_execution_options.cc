@@ -97,6 +97,9 @@ std::ostream& operator<<(std::ostream& os,
             << ", enable_tfrt_gpu = " << options.enable_tfrt_gpu
             << ", runtime = " << options.runtime
             << ", model_metadata = " << options.model_metadata.DebugString()
+            << ", enable_mlrt = " << options.enable_mlrt
+            << ", compiled_graph_cache_dir = "
+            << options.compiled_graph_cache_dir
             << ", compile_options = " << options.compile_options << "}";
 }
 
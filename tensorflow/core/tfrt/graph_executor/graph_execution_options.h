@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <optional>
 #include <ostream>
+#include <string>
 
 #include "absl/types/optional.h"
 #include "tensorflow/compiler/mlir/tfrt/translate/tfrt_compile_options.h"
@@ -68,10 +69,25 @@ struct GraphExecutionOptions {
   // TODO(b/278298965): Maybe remove normalization.
   uint64_t online_cost_analysis_normalize_ratio = 1;
 
+  // The number of requests of each client graph whose op costs are recorded
+  // for online cost analysis. The client graph is re-compiled with the average
+  // costs once all of them are done. Recording more requests makes the costs,
+  // and hence which ops run inline and which run as separate tasks, less
+  // sensitive to the noise of a single request such as cold caches.
+  int online_cost_analysis_num_requests = 1;
+
   // If true, the MLRT interpreter will be used instead of the BEF executor.
   // This option is experimental.
   bool enable_mlrt = false;
 
+  // If non-empty, the executables compiled for client graphs are cached in
+  // this directory, keyed by the fingerprint of the model graph, the client
+  // graph and the compile options. A client graph found in the cache, e.g.
+  // after the model is reloaded, is loaded from it instead of being imported
+  // and compiled again. The cache is not used with online cost analysis or
+  // when compiling to the sync TFRT dialect.
+  std::string compiled_graph_cache_dir;
+
   tensorflow::TfrtCompileOptions compile_options;
 };
 
@@ -17,15 +17,16 @@ limitations under the License.
 #include <algorithm>
 #include <array>
 #include <cstdint>
+#include <cstring>
 #include <functional>
 #include <memory>
 #include <numeric>
 #include <optional>
+#include <sstream>
 #include <string>
 #include <utility>
 #include <vector>
 
-#include "absl/base/call_once.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
@@ -51,13 +52,19 @@ limitations under the License.
 #include "tensorflow/compiler/mlir/tfrt/translate/tfrt_compile_options.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
+#include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/statusor.h"
 #include "tensorflow/core/profiler/lib/connected_traceme.h"
 #include "tensorflow/core/profiler/lib/traceme_encode.h"
 #include "tensorflow/core/protobuf/config.pb.h"
 #include "tensorflow/core/public/session.h"
+#include "tensorflow/core/public/version.h"
 #include "tensorflow/core/runtime_fallback/kernel/kernel_fallback_utils.h"
 #include "tensorflow/core/tfrt/fallback/cost_recorder.h"
 #include "tensorflow/core/tfrt/fallback/fallback_state.h"
@@ -438,13 +445,20 @@ StatusOr<std::unique_ptr<GraphExecutor>> GraphExecutor::Create(
   options.compile_options.fuse_get_resource_ops_in_hoisting =
       !options.enable_mlrt;
 
+  const uint64_t graph_fingerprint =
+      options.compiled_graph_cache_dir.empty()
+          ? 0
+          : DeterministicProtoHash64(graph_def);
+
   TF_ASSIGN_OR_RETURN(
       auto graph_execution_state,
       TfrtGraphExecutionState::Create(graph_execution_state_options,
                                       std::move(graph_def), fallback_state));
-  return std::make_unique<GraphExecutor>(
+  auto graph_executor = std::make_unique<GraphExecutor>(
       std::move(options), fallback_state, std::move(resource_context),
       std::move(graph_execution_state), std::move(kernel_registry));
+  graph_executor->graph_fingerprint_ = graph_fingerprint;
+  return graph_executor;
 }
 
 namespace {
@@ -541,27 +555,32 @@ tensorflow::Status GraphExecutor::Run(
     flat_inputs.push_back(inputs.at(original_index).second);
   }
 
-  // Conduct cost analysis for the first request on this `loaded_client_graph`.
-  std::unique_ptr<CostRecorder> cost_recorder;
+  // Conduct cost analysis for the first requests on this
+  // `loaded_client_graph`.
+  std::shared_ptr<CostRecorder> cost_recorder;
   if (options_.enable_online_cost_analysis) {
     cost_recorder = loaded_client_graph.MaybeCreateCostRecorder(
-        options_.online_cost_analysis_normalize_ratio);
+        options_.online_cost_analysis_normalize_ratio,
+        options_.online_cost_analysis_num_requests);
   }
 
   std::vector<tensorflow::Tensor> flat_outputs;
-  TF_RETURN_IF_ERROR(GraphExecutionRunOnFunction(
+  Status status = GraphExecutionRunOnFunction(
       options_, run_options, loaded_client_graph.name(),
       loaded_client_graph.symbol_uids(), func, loaded_executable, flat_inputs,
       &flat_outputs, resource_context_.get(),
       &executable_context->resource_context,
       &loaded_client_graph.runner_table(),
       &loaded_client_graph.resource_array(), runtime(), fallback_state_,
-      &req_deadline_tracker_, cost_recorder.get()));
+      &req_deadline_tracker_, cost_recorder.get());
 
   if (cost_recorder != nullptr) {
-    TF_RETURN_IF_ERROR(
-        loaded_client_graph.UpdateCost(*cost_recorder, runtime()));
+    // Failed requests are done too, so that they do not hold back the update.
+    status.Update(loaded_client_graph.MaybeUpdateCost(
+        *cost_recorder, options_.online_cost_analysis_num_requests,
+        runtime()));
   }
+  TF_RETURN_IF_ERROR(status);
 
   // Create the outputs from the actual function results, which are sorted
   // according to the output tensor names.
@@ -576,17 +595,146 @@ tensorflow::Status GraphExecutor::Run(
 }
 
 tensorflow::Status GraphExecutor::Extend(const GraphDef& graph) {
-  return graph_execution_state_->Extend(graph);
+  TF_RETURN_IF_ERROR(graph_execution_state_->Extend(graph));
+  if (!options_.compiled_graph_cache_dir.empty()) {
+    graph_fingerprint_ =
+        FingerprintCat64(graph_fingerprint_, DeterministicProtoHash64(graph));
+  }
+  return OkStatus();
+}
+
+namespace {
+
+// Reads the `size` bytes of `file` into `buffer`.
+tensorflow::Status ReadFileToBuffer(const std::string& path,
+                                    const RandomAccessFile& file, uint64_t size,
+                                    char* buffer) {
+  absl::string_view result;
+  TF_RETURN_IF_ERROR(file.Read(/*offset=*/0, size, &result, buffer));
+  if (result.size() != size) {
+    return errors::DataLoss("Truncated compiled graph cache file ", path);
+  }
+  if (result.data() != buffer) {
+    std::memcpy(buffer, result.data(), size);
+  }
+  return OkStatus();
+}
+
+}  // namespace
+
+std::string GraphExecutor::GetCompiledGraphCachePath(
+    const GraphExecutor::ClientGraph& client_graph) const {
+  if (options_.compiled_graph_cache_dir.empty() ||
+      options_.enable_online_cost_analysis ||
+      options_.compile_options.compile_to_sync_tfrt_dialect) {
+    return "";
+  }
+  // Everything that affects the compiled executable is part of the key.
+  std::ostringstream key;
+  key << TF_VERSION_STRING << "\n"
+      << graph_fingerprint_.load() << "\n"
+      << client_graph.name << "\n"
+      << options_.run_placer_grappler_on_functions
+      << options_.enable_grappler_function_optimizer
+      << options_.enable_tfrt_gpu << options_.enable_mlrt << "\n"
+      << options_.compile_options;
+  return io::JoinPath(
+      options_.compiled_graph_cache_dir,
+      absl::StrCat(absl::Hex(Fingerprint64(key.str()), absl::kZeroPad16),
+                   options_.enable_mlrt ? ".mlrt" : ".bef"));
+}
+
+StatusOr<std::shared_ptr<ExecutableContext>> GraphExecutor::LoadCompiledGraph(
+    const std::string& path) const {
+  Env* env = Env::Default();
+  uint64_t file_size = 0;
+  TF_RETURN_IF_ERROR(env->GetFileSize(path, &file_size));
+  if (file_size == 0) {
+    return errors::DataLoss("Empty compiled graph cache file ", path);
+  }
+  std::unique_ptr<RandomAccessFile> file;
+  TF_RETURN_IF_ERROR(env->NewRandomAccessFile(path, &file));
+
+  if (options_.enable_mlrt) {
+    if (kernel_registry_ == nullptr) {
+      return tensorflow::errors::Internal("Missing kernel registry in MLRT.");
+    }
+    mlrt::bc::Buffer bytecode_buffer;
+    mlrt::bc::Allocator allocator(&bytecode_buffer);
+    allocator.Allocate(file_size, /*alignment=*/8);
+    TF_RETURN_IF_ERROR(
+        ReadFileToBuffer(path, *file, file_size, bytecode_buffer.data()));
+    mlrt::bc::Executable executable(bytecode_buffer.data());
+    auto bytecode_executable =
+        std::make_unique<mlrt::LoadedExecutable>(executable, *kernel_registry_);
+    return std::make_shared<ExecutableContext>(std::move(bytecode_buffer),
+                                               std::move(bytecode_executable));
+  }
+
+  tfrt::BefBuffer bef(file_size);
+  TF_RETURN_IF_ERROR(ReadFileToBuffer(path, *file, file_size,
+                                      reinterpret_cast<char*>(bef.data())));
+  TF_ASSIGN_OR_RETURN(auto bef_file,
+                      tfrt::CreateBefFileFromBefBuffer(runtime(), bef));
+  return std::make_shared<ExecutableContext>(std::move(bef),
+                                             std::move(bef_file));
+}
+
+tensorflow::Status GraphExecutor::SaveCompiledGraph(
+    const std::string& path,
+    const ExecutableContext& executable_context) const {
+  absl::string_view data;
+  if (executable_context.IsForMlrt()) {
+    data = absl::string_view(executable_context.bytecode_buffer.data(),
+                             executable_context.bytecode_buffer.size());
+  } else {
+    data = absl::string_view(
+        reinterpret_cast<const char*>(executable_context.bef.data()),
+        executable_context.bef.size());
+  }
+  // Write to a temporary file first, so that concurrent loaders never read a
+  // partially written executable.
+  Env* env = Env::Default();
+  TF_RETURN_IF_ERROR(
+      env->RecursivelyCreateDir(options_.compiled_graph_cache_dir));
+  const std::string tmp_path =
+      absl::StrCat(path, ".tmp", absl::Hex(random::New64()));
+  TF_RETURN_IF_ERROR(WriteStringToFile(env, tmp_path, data));
+  return env->RenameFile(tmp_path, path);
 }
 
 StatusOr<std::unique_ptr<GraphExecutor::LoadedClientGraph>>
 GraphExecutor::ImportAndCompileClientGraph(
     const GraphExecutor::ClientGraph& client_graph) {
-  // Step 1 of loading: Import the client graph from proto to an MLIR module.
-  auto import_start_time = absl::Now();
   mlir::DialectRegistry registry;
   RegisterMlirDialect(registry);
   auto context = std::make_unique<mlir::MLIRContext>(registry);
+
+  // If the executable of the client graph has been compiled before, load it
+  // from the cache and skip importing and compiling.
+  const std::string cache_path = GetCompiledGraphCachePath(client_graph);
+  if (!cache_path.empty()) {
+    auto cache_start_time = absl::Now();
+    auto executable_context = LoadCompiledGraph(cache_path);
+    if (executable_context.ok()) {
+      LOG(INFO) << "TFRT loaded compiled client graph (" << &client_graph
+                << ") from " << cache_path << ". Took "
+                << absl::ToInt64Milliseconds(absl::Now() - cache_start_time)
+                << " ms. Client graph name: " << client_graph.name;
+      return std::make_unique<LoadedClientGraph>(
+          client_graph.name, SymbolUids(), this, std::move(context),
+          /*tf_mlir_with_op_keys=*/nullptr, /*tfrt_mlir=*/nullptr,
+          *std::move(executable_context),
+          options_.enable_online_cost_analysis);
+    }
+    if (!errors::IsNotFound(executable_context.status())) {
+      LOG(WARNING) << "Failed to load compiled client graph from "
+                   << cache_path << ": " << executable_context.status();
+    }
+  }
+
+  // Step 1 of loading: Import the client graph from proto to an MLIR module.
+  auto import_start_time = absl::Now();
   ASSIGN_OR_RETURN_IN_IMPORT(
       auto module, ImportClientGraphToMlirModule(client_graph, context.get()));
   // TODO(b/278143179): Upload module w/o control flow.
@@ -649,6 +797,14 @@ GraphExecutor::ImportAndCompileClientGraph(
             << "). Took " << absl::ToInt64Milliseconds(compile_duration)
             << " ms. Client graph name: " << client_graph.name;
 
+  if (!cache_path.empty()) {
+    if (auto status = SaveCompiledGraph(cache_path, *executable_context);
+        !status.ok()) {
+      LOG(WARNING) << "Failed to cache compiled client graph to " << cache_path
+                   << ": " << status;
+    }
+  }
+
   return std::make_unique<LoadedClientGraph>(
       client_graph.name, std::move(symbol_uids), this, std::move(context),
       std::move(module_with_op_keys), std::move(module),
@@ -878,14 +1034,28 @@ tensorflow::Status GraphExecutor::RunWithSyncInterpreter(
   return execution_context.status();
 }
 
-std::unique_ptr<CostRecorder>
+std::shared_ptr<CostRecorder>
 GraphExecutor::LoadedClientGraph::MaybeCreateCostRecorder(
-    uint64_t normalize_ratio) const {
-  std::unique_ptr<CostRecorder> cost_recorder;
-  absl::call_once(create_cost_recorder_once_, [&]() {
-    cost_recorder = std::make_unique<CostRecorder>(normalize_ratio);
-  });
-  return cost_recorder;
+    uint64_t normalize_ratio, int num_requests) const {
+  tensorflow::mutex_lock lock(cost_recorder_mu_);
+  if (num_cost_recorded_requests_ >= num_requests) return nullptr;
+  if (cost_recorder_ == nullptr) {
+    cost_recorder_ = std::make_shared<CostRecorder>(normalize_ratio);
+  }
+  ++num_cost_recorded_requests_;
+  return cost_recorder_;
+}
+
+Status GraphExecutor::LoadedClientGraph::MaybeUpdateCost(
+    const CostRecorder& cost_recorder, int num_requests,
+    const Runtime& runtime) {
+  {
+    tensorflow::mutex_lock lock(cost_recorder_mu_);
+    if (++num_cost_recorded_requests_done_ < num_requests) return OkStatus();
+    // The recorder is no longer needed once the last request is done.
+    cost_recorder_.reset();
+  }
+  return UpdateCost(cost_recorder, runtime);
 }
 
 Status GraphExecutor::LoadedClientGraph::UpdateCost(
@@ -15,6 +15,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_TFRT_GRAPH_EXECUTOR_GRAPH_EXECUTOR_H_
 #define TENSORFLOW_CORE_TFRT_GRAPH_EXECUTOR_GRAPH_EXECUTOR_H_
 
+#include <atomic>
 #include <cstdint>
 #include <functional>
 #include <memory>
@@ -23,7 +24,6 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
-#include "absl/base/call_once.h"
 #include "absl/strings/string_view.h"
 #include "mlir/IR/BuiltinOps.h"  // from @llvm-project
 #include "mlir/IR/OwningOpRef.h"  // from @llvm-project
@@ -143,10 +143,17 @@ class GraphExecutor {
       }
     }
 
-    // Returns a `CostRecorder` if none has been created before for this
-    // `LoadedClientGraph`.
-    std::unique_ptr<CostRecorder> MaybeCreateCostRecorder(
-        uint64_t normalize_ratio = 1) const;
+    // Returns a `CostRecorder` to record the op costs of a request with, if
+    // fewer than `num_requests` requests of this `LoadedClientGraph` have been
+    // given one. These requests share the same `CostRecorder`.
+    std::shared_ptr<CostRecorder> MaybeCreateCostRecorder(
+        uint64_t normalize_ratio = 1, int num_requests = 1) const;
+
+    // Called when a request given `cost_recorder` by MaybeCreateCostRecorder()
+    // is done. Once `num_requests` such requests are done, updates the op cost
+    // values with the records from `cost_recorder`.
+    Status MaybeUpdateCost(const CostRecorder& cost_recorder, int num_requests,
+                           const Runtime& runtime);
 
     // Updates the op cost values in this `LoadedClientGraph` with records from
     // `cost_recorder`.
@@ -174,7 +181,7 @@ class GraphExecutor {
     std::unique_ptr<mlir::MLIRContext> mlir_context_;
     OpKernelRunnerTable runner_table_;
     tfd::FallbackResourceArray resource_array_;
-    // Thread-safety resulted from `create_cost_recorder_once_`.
+    // Thread-safety resulted from `num_cost_recorded_requests_done_`.
     // These OwningOpRefs are temporary storage for recompilation.
     mlir::OwningOpRef<mlir::ModuleOp>
         tf_mlir_with_op_keys_;                     // For recompilation in MLRT.
@@ -183,7 +190,13 @@ class GraphExecutor {
     // Can be updated if online cost analysis is enabled.
     std::shared_ptr<ExecutableContext> executable_context_
         TF_GUARDED_BY(executable_context_mu_);
-    mutable absl::once_flag create_cost_recorder_once_;
+    mutable tensorflow::mutex cost_recorder_mu_;
+    // Shared by the requests whose op costs are recorded.
+    mutable std::shared_ptr<CostRecorder> cost_recorder_
+        TF_GUARDED_BY(cost_recorder_mu_);
+    mutable int num_cost_recorded_requests_ TF_GUARDED_BY(cost_recorder_mu_) =
+        0;
+    int num_cost_recorded_requests_done_ TF_GUARDED_BY(cost_recorder_mu_) = 0;
     SyncResourceState sync_resource_state_;
   };
 
@@ -278,6 +291,20 @@ class GraphExecutor {
                                 mlir::MLIRContext* context) const;
   StatusOr<tfrt::BefBuffer> CompileMlirModuleToBef(mlir::ModuleOp module) const;
 
+  // Returns the path of the cached executable of `client_graph` in
+  // `options_.compiled_graph_cache_dir`, or an empty string if the cache is
+  // not used.
+  std::string GetCompiledGraphCachePath(
+      const GraphExecutor::ClientGraph& client_graph) const;
+  // Loads the executable cached at `path`. Returns a NotFound error if there
+  // is none.
+  StatusOr<std::shared_ptr<ExecutableContext>> LoadCompiledGraph(
+      const std::string& path) const;
+  // Writes the executable in `executable_context` to the cache at `path`.
+  tensorflow::Status SaveCompiledGraph(
+      const std::string& path,
+      const ExecutableContext& executable_context) const;
+
   tensorflow::Status InitBef(
       LoadedClientGraph* loaded_client_graph,
       tensorflow::tfrt_stub::WorkQueueInterface* work_queue);
@@ -303,6 +330,10 @@ class GraphExecutor {
   std::unique_ptr<tensorflow::tfrt_stub::TfrtGraphExecutionState>
       graph_execution_state_;
 
+  // Fingerprint of the graph given at creation and all its extensions, used to
+  // key the compiled graph cache.
+  std::atomic<uint64_t> graph_fingerprint_ = 0;
+
   tfrt::RequestDeadlineTracker req_deadline_tracker_;
 
   tensorflow::mutex loaded_client_graphs_mu_;
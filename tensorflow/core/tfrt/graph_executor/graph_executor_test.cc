@@ -28,7 +28,10 @@ limitations under the License.
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/grappler/utils/grappler_test.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/protobuf/rewriter_config.pb.h"
 #include "tensorflow/core/tfrt/mlrt/interpreter/context.h"
 #include "tensorflow/core/tfrt/mlrt/interpreter/value.h"
@@ -145,6 +148,51 @@ TEST_P(GraphExecutorTest, BasicWithOnlineCostAnalysis) {
               ::testing::ElementsAreArray({2}));
 }
 
+TEST_P(GraphExecutorTest, CompiledGraphCache) {
+  GraphDef graph_def;
+  TF_ASSERT_OK(GetSimpleGraphDef(graph_def));
+
+  auto runtime = DefaultTfrtRuntime(/*num_threads=*/1);
+  const std::string cache_dir = io::JoinPath(
+      testing::TmpDir(),
+      GetParam() ? "compiled_graph_cache_mlrt" : "compiled_graph_cache_bef");
+
+  std::vector<std::pair<std::string, tensorflow::Tensor>> inputs;
+  inputs.push_back({"input", CreateTfTensor<int32_t>(
+                                 /*shape=*/{1, 3}, /*data=*/{1, 1, 1})});
+
+  // The first executor compiles the client graph and caches it, and the
+  // second one loads it from the cache.
+  for (int i = 0; i < 2; ++i) {
+    GraphExecutor::Options options(runtime.get());
+    options.enable_mlrt = GetParam();
+    options.compiled_graph_cache_dir = cache_dir;
+
+    TF_ASSERT_OK_AND_ASSIGN(
+        auto fallback_state,
+        tensorflow::tfrt_stub::FallbackState::Create(
+            CreateDefaultSessionOptions(options), graph_def.library()));
+    auto resource_context = std::make_unique<tfrt::ResourceContext>();
+    TF_ASSERT_OK_AND_ASSIGN(
+        auto graph_executor,
+        GraphExecutor::Create(std::move(options), *fallback_state,
+                              std::move(resource_context), graph_def,
+                              GetKernelRegistry()));
+
+    std::vector<tensorflow::Tensor> outputs;
+    TF_ASSERT_OK(graph_executor->Run(/*run_options=*/{}, inputs,
+                                     /*output_tensor_names=*/{"rank"},
+                                     /*target_tensor_names=*/{}, &outputs));
+    ASSERT_EQ(outputs.size(), 1);
+    EXPECT_THAT(GetTfTensorData<int32_t>(outputs[0]),
+                ::testing::ElementsAreArray({2}));
+
+    std::vector<std::string> cached_files;
+    TF_ASSERT_OK(Env::Default()->GetChildren(cache_dir, &cached_files));
+    EXPECT_EQ(cached_files.size(), 1);
+  }
+}
+
 INSTANTIATE_TEST_SUITE_P(GraphExecutorTestSuite, GraphExecutorTest,
                          ::testing::Bool());
 
@@ -172,6 +220,26 @@ TEST_F(GraphExecutorTest, DoOnlineCostAnalysisExactlyOnce) {
   EXPECT_TRUE(loaded_client_graph_1.MaybeCreateCostRecorder() == nullptr);
 }
 
+TEST_F(GraphExecutorTest, DoOnlineCostAnalysisOverMultipleRequests) {
+  GraphExecutor::LoadedClientGraph loaded_client_graph(
+      "name", /*symbol_uids=*/{},
+      /*graph_executor=*/nullptr,
+      /*mlir_context=*/nullptr,
+      /*tf_mlir_with_op_keys=*/{}, /*tfrt_mlir=*/{},
+      /*executable_context=*/nullptr,
+      /*enable_online_cost_analysis=*/true);
+
+  // The first `num_requests` requests share the same cost recorder.
+  auto cost_recorder_0 = loaded_client_graph.MaybeCreateCostRecorder(
+      /*normalize_ratio=*/1, /*num_requests=*/2);
+  auto cost_recorder_1 = loaded_client_graph.MaybeCreateCostRecorder(
+      /*normalize_ratio=*/1, /*num_requests=*/2);
+  ASSERT_TRUE(cost_recorder_0 != nullptr);
+  EXPECT_EQ(cost_recorder_0, cost_recorder_1);
+  EXPECT_TRUE(loaded_client_graph.MaybeCreateCostRecorder(
+                  /*normalize_ratio=*/1, /*num_requests=*/2) == nullptr);
+}
+
 TEST_F(GraphExecutorTest, Extend) {
   GraphDef graph_def;
   {
@@ -44,8 +44,16 @@ LoadedExecutable::LoadedExecutable(bc::Executable executable,
   }
 
   functions_.reserve(executable_.functions().size());
+  function_kernel_offsets_.reserve(executable_.functions().size());
   for (auto function : executable_.functions()) {
     functions_[function.name().Get()] = function;
+
+    auto kernels = function.kernels();
+    if (kernels.empty()) continue;
+    function_kernel_offsets_[kernels.data()] = function_kernels_.size();
+    for (auto kernel : kernels) {
+      function_kernels_.push_back(kernels_[kernel.code()]);
+    }
   }
 }
 
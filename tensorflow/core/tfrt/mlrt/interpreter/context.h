@@ -75,6 +75,20 @@ class LoadedExecutable {
 
   absl::Span<const KernelImplementation> kernels() const { return kernels_; }
 
+  // Returns the implementations of the kernels of `function` in program
+  // order. They are resolved when the executable is loaded, and looked up
+  // once per call of `function`, so that the interpreter can dispatch a kernel
+  // without first reading its kernel code.
+  absl::Span<const KernelImplementation> GetFunctionKernels(
+      bc::Function function) const {
+    auto kernels = function.kernels();
+    if (kernels.empty()) return {};
+    auto iter = function_kernel_offsets_.find(kernels.data());
+    DCHECK(iter != function_kernel_offsets_.end());
+    return absl::MakeConstSpan(function_kernels_)
+        .subspan(iter->second, kernels.size());
+  }
+
   bc::Function GetFunction(absl::string_view name) const {
     if (auto iter = functions_.find(name); iter != functions_.end()) {
       return iter->second;
@@ -90,6 +104,11 @@ class LoadedExecutable {
 
   absl::flat_hash_map<std::string, bc::Function> functions_;
   std::vector<KernelImplementation> kernels_;
+
+  // The kernel implementations of all functions, and the offset of the first
+  // kernel of each function in it, keyed by the address of its kernels.
+  std::vector<KernelImplementation> function_kernels_;
+  absl::flat_hash_map<const char*, size_t> function_kernel_offsets_;
 };
 
 // A helper structure that holds states for a kernel. Typical usuage is that a
@@ -110,10 +129,13 @@ void UnwindOnError(ExecutionContext& context, int64_t pc);
 
 class FunctionContext {
  public:
-  FunctionContext(bc::Function function, ExecutionContext* execution_context)
+  FunctionContext(bc::Function function,
+                  absl::Span<const KernelImplementation> kernels,
+                  ExecutionContext* execution_context)
       : pc_(0),
         registers_(function.num_regs()),
         function_object_(function),
+        kernels_(kernels),
         execution_context_(execution_context) {
     DCHECK(execution_context);
   }
@@ -127,6 +149,9 @@ class FunctionContext {
 
   const bc::Function& function_object() const { return function_object_; }
 
+  // The implementations of the kernels of the function, indexed by pc.
+  absl::Span<const KernelImplementation> kernels() const { return kernels_; }
+
   absl::Span<Value> regs() { return absl::MakeSpan(registers_); }
 
   // Argument passing is via either copy or move.
@@ -199,6 +224,7 @@ class FunctionContext {
   std::vector<Value> registers_;
   std::vector<Value*> results_;
   bc::Function function_object_;
+  absl::Span<const KernelImplementation> kernels_;
   KernelContext kernel_context_;
 
   ExecutionContext* execution_context_ = nullptr;
@@ -269,7 +295,9 @@ class ExecutionContext {
   void Call(bc::Function function_object, bc::Span<uint8_t> last_uses,
             Args args, Results results) {
     auto& function_context =
-        function_stack_.emplace_back(function_object, this);
+        function_stack_.emplace_back(
+            function_object,
+            loaded_executable_->GetFunctionKernels(function_object), this);
     function_context.Call(last_uses, args, results);
     state_ = State::kReady;
   }
@@ -277,7 +305,9 @@ class ExecutionContext {
   template <typename Args, typename Results>
   void CallByMove(bc::Function function_object, Args args, Results results) {
     auto& function_context =
-        function_stack_.emplace_back(function_object, this);
+        function_stack_.emplace_back(
+            function_object,
+            loaded_executable_->GetFunctionKernels(function_object), this);
     function_context.CallByMove(args, results);
     state_ = State::kReady;
   }
@@ -35,7 +35,7 @@ void Execute(ExecutionContext& context) {
     FunctionContext* current_function = &context.function_stack_.back();
     int64_t pc = current_function->pc_;
 
-    auto kernels = context.loaded_executable().kernels();
+    auto kernels = current_function->kernels();
 
     auto kernel_object_iter =
         current_function->function_object().kernels().begin();
@@ -50,9 +50,9 @@ void Execute(ExecutionContext& context) {
     for (; context.state_ == ExecutionContext::State::kRunning; ++pc) {
       DCHECK(kernel_object_iter <
              current_function->function_object().kernels().end());
-      bc::Kernel kernel_object = *kernel_object_iter;
-      frame.set_kernel(kernel_object);
-      kernels[kernel_object.code()](frame);
+      DCHECK_LT(pc, static_cast<int64_t>(kernels.size()));
+      frame.set_kernel(*kernel_object_iter);
+      kernels[pc](frame);
       ++kernel_object_iter;
     }
 
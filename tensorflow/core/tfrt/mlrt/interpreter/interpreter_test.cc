@@ -322,6 +322,39 @@ TEST(InterpreterTest, Call) {
   EXPECT_TRUE(input.HasValue());
 }
 
+TEST(InterpreterTest, FunctionKernelsFollowProgramOrder) {
+  auto buffer = CreateCallExecutable();
+
+  bc::Executable executable(buffer.data());
+
+  KernelRegistry kernel_registry;
+  RegisterBuiltinKernels(kernel_registry);
+
+  LoadedExecutable loaded_executable(executable, kernel_registry);
+
+  auto caller_kernels = loaded_executable.GetFunctionKernels(
+      loaded_executable.GetFunction("caller"));
+  ASSERT_EQ(caller_kernels.size(), 2);
+  EXPECT_EQ(caller_kernels[0], kernel_registry.Get("call"));
+  EXPECT_EQ(caller_kernels[1], kernel_registry.Get("return"));
+
+  auto callee_kernels = loaded_executable.GetFunctionKernels(
+      loaded_executable.GetFunction("callee"));
+  ASSERT_EQ(callee_kernels.size(), 1);
+  EXPECT_EQ(callee_kernels[0], kernel_registry.Get("return"));
+
+  // The kernels are resolved when the function is called.
+  ExecutionContext execution_context(&loaded_executable);
+  Value input(123);
+  Value output;
+  std::vector<uint8_t> last_uses = {false};
+  execution_context.Call(loaded_executable.GetFunction("callee"), last_uses,
+                         absl::Span<Value>(&input, 1),
+                         absl::Span<Value>(&output, 1));
+  EXPECT_EQ(execution_context.function_context().kernels().data(),
+            callee_kernels.data());
+}
+
 bc::Buffer CreateCondExecutable() {
   bc::Buffer buffer;
   bc::Allocator allocator(&buffer);
@@ -2904,5 +2937,31 @@ void BM_SequentialAddAttributes(benchmark::State& state) {
 }
 BENCHMARK(BM_SequentialAddAttributes);
 
+void BM_Call(benchmark::State& state) {
+  auto buffer = CreateCallExecutable();
+
+  bc::Executable executable(buffer.data());
+
+  KernelRegistry kernel_registry;
+  RegisterBuiltinKernels(kernel_registry);
+
+  LoadedExecutable loaded_executable(executable, kernel_registry);
+
+  auto function = loaded_executable.GetFunction("caller");
+  CHECK(function);
+
+  Value input(123);
+  Value output;
+  std::vector<uint8_t> last_uses = {false};
+
+  for (auto s : state) {
+    ExecutionContext execution_context(&loaded_executable);
+    execution_context.Call(function, last_uses, absl::Span<Value>(&input, 1),
+                           absl::Span<Value>(&output, 1));
+    Execute(execution_context);
+  }
+}
+BENCHMARK(BM_Call);
+
 }  // namespace
 }  // namespace mlrt
@@ -25,8 +25,10 @@ limitations under the License.
 
 #include <optional>
 
+#include "absl/strings/string_view.h"
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/lib/core/threadpool_interface.h"
+#include "tensorflow/core/lib/monitoring/counter.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/context.h"
 #include "tensorflow/core/platform/denormal.h"
@@ -48,6 +50,30 @@ namespace {
 typedef typename internal::RunHandlerEnvironment::Task Task;
 typedef Eigen::RunQueue<Task, 1024> Queue;
 
+auto* run_handler_blocking_thread_tasks =
+    tensorflow::monitoring::Counter<1>::New(
+        "/tensorflow/tfrt/run_handler/blocking_thread_tasks",
+        "The number of tasks run by the inter-op threads of RunHandler thread "
+        "pools, by whether they come from the requests of the thread's own sub "
+        "thread pool or are stolen from a higher or lower priority one.",
+        "source");
+
+// Returns the cell of `run_handler_blocking_thread_tasks` for `source`, which
+// is one of "own", "higher_priority" and "lower_priority". The cells are only
+// looked up once as tasks are run at a high rate.
+tensorflow::monitoring::CounterCell* GetBlockingThreadTaskCell(
+    absl::string_view source) {
+  static auto* const own_cell =
+      run_handler_blocking_thread_tasks->GetCell("own");
+  static auto* const higher_priority_cell =
+      run_handler_blocking_thread_tasks->GetCell("higher_priority");
+  static auto* const lower_priority_cell =
+      run_handler_blocking_thread_tasks->GetCell("lower_priority");
+  if (source == "own") return own_cell;
+  return source == "higher_priority" ? higher_priority_cell
+                                     : lower_priority_cell;
+}
+
 }  // namespace
 
 namespace internal {
@@ -363,7 +389,28 @@ RunHandlerThreadPool::RunHandlerThreadPool(
       queue_waiters_(queue_waiters),
       num_threads_in_sub_thread_pool_(options.num_threads_in_sub_thread_pool),
       sub_thread_pool_end_request_percentage_(
-          options.sub_thread_request_percentage) {
+          options.sub_thread_request_percentage),
+      max_lower_priority_stealing_threads_(
+          options.num_threads_in_sub_thread_pool.size(), 0),
+      num_lower_priority_stealing_threads_(new std::atomic<int>[
+          options.num_threads_in_sub_thread_pool.size()]) {
+  // Blocking threads are assigned to sub thread pools as in Start().
+  for (int i = 0; i < num_blocking_threads_; ++i) {
+    int sub_thread_pool_id = num_threads_in_sub_thread_pool_.size() - 1;
+    for (int j = 0; j < num_threads_in_sub_thread_pool_.size(); ++j) {
+      if (i < num_threads_in_sub_thread_pool_[j]) {
+        sub_thread_pool_id = j;
+        break;
+      }
+    }
+    ++max_lower_priority_stealing_threads_[sub_thread_pool_id];
+  }
+  for (int j = 0; j < num_threads_in_sub_thread_pool_.size(); ++j) {
+    max_lower_priority_stealing_threads_[j] =
+        static_cast<int>(max_lower_priority_stealing_threads_[j] *
+                         options.max_lower_priority_steal_fraction);
+    num_lower_priority_stealing_threads_[j] = 0;
+  }
   thread_data_.resize(num_threads_);
   for (int i = 0; i < num_threads_; ++i) {
     thread_data_[i].new_thread_work_sources =
@@ -515,6 +562,77 @@ Task RunHandlerThreadPool::FindTask(
   return t;
 }
 
+std::pair<int, int> RunHandlerThreadPool::GetSubThreadPoolRequestRange(
+    int active_requests, int sub_thread_pool_id) const {
+  int start =
+      sub_thread_pool_id == 0
+          ? 0
+          : active_requests *
+                sub_thread_pool_end_request_percentage_[sub_thread_pool_id - 1];
+  int end = sub_thread_pool_id + 1 ==
+                    sub_thread_pool_end_request_percentage_.size()
+                ? active_requests
+                : active_requests *
+                      sub_thread_pool_end_request_percentage_
+                          [sub_thread_pool_id];
+  end = std::min(active_requests, std::max(end, start + 1));
+  return {start, end};
+}
+
+bool RunHandlerThreadPool::TryStartLowerPriorityStealing(
+    int sub_thread_pool_id) {
+  std::atomic<int>& num_stealing_threads =
+      num_lower_priority_stealing_threads_[sub_thread_pool_id];
+  int current = num_stealing_threads.load(std::memory_order_relaxed);
+  while (current < max_lower_priority_stealing_threads_[sub_thread_pool_id]) {
+    if (num_stealing_threads.compare_exchange_weak(
+            current, current + 1, std::memory_order_relaxed)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void RunHandlerThreadPool::FinishLowerPriorityStealing(
+    int sub_thread_pool_id) {
+  num_lower_priority_stealing_threads_[sub_thread_pool_id].fetch_sub(
+      1, std::memory_order_relaxed);
+}
+
+Task RunHandlerThreadPool::StealTask(
+    int active_requests, int thread_id, int sub_thread_pool_id,
+    int max_blocking_inflight,
+    const Eigen::MaxSizeVector<ThreadWorkSource*>& thread_work_sources,
+    bool* task_from_blocking_queue, ThreadWorkSource** tws,
+    bool* lower_priority_steal) {
+  Task t;
+  *lower_priority_steal = false;
+  const int num_sub_thread_pools =
+      sub_thread_pool_end_request_percentage_.size();
+  for (int distance = 1; distance < num_sub_thread_pools; ++distance) {
+    // Higher priority sub thread pools come first at each distance.
+    for (int victim : {sub_thread_pool_id - distance,
+                       sub_thread_pool_id + distance}) {
+      if (victim < 0 || victim >= num_sub_thread_pools) continue;
+      auto [start, end] = GetSubThreadPoolRequestRange(active_requests, victim);
+      if (start >= end) continue;
+      const bool lower_priority = victim > sub_thread_pool_id;
+      if (lower_priority && !TryStartLowerPriorityStealing(sub_thread_pool_id)) {
+        continue;
+      }
+      t = FindTask(start, end, thread_id, sub_thread_pool_id,
+                   max_blocking_inflight, /*may_steal_blocking_work=*/true,
+                   thread_work_sources, task_from_blocking_queue, tws);
+      if (t.f) {
+        *lower_priority_steal = lower_priority;
+        return t;
+      }
+      if (lower_priority) FinishLowerPriorityStealing(sub_thread_pool_id);
+    }
+  }
+  return t;
+}
+
 // Main worker thread loop.
 void RunHandlerThreadPool::WorkerLoop(int thread_id,
                                       bool may_steal_blocking_work) {
@@ -527,6 +645,7 @@ void RunHandlerThreadPool::WorkerLoop(int thread_id,
     Task t;
     ThreadWorkSource* tws = nullptr;
     bool task_from_blocking_queue = true;
+    bool lower_priority_steal = false;
     int sub_thread_pool_id;
     // Get the current thread work sources.
     {
@@ -546,29 +665,27 @@ void RunHandlerThreadPool::WorkerLoop(int thread_id,
     if (may_steal_blocking_work) {
       // Each thread will first look for tasks from requests that belongs to
       // its sub thread pool.
-      int search_range_start =
-          sub_thread_pool_id == 0
-              ? 0
-              : active_requests *
-                    sub_thread_pool_end_request_percentage_[sub_thread_pool_id -
-                                                            1];
-      int search_range_end =
-          active_requests *
-          sub_thread_pool_end_request_percentage_[sub_thread_pool_id];
-      search_range_end = std::min(
-          active_requests, std::max(search_range_end, search_range_start + 1));
+      auto [search_range_start, search_range_end] =
+          GetSubThreadPoolRequestRange(active_requests, sub_thread_pool_id);
 
       t = FindTask(search_range_start, search_range_end, thread_id,
                    sub_thread_pool_id, kMaxBlockingInflight,
                    /*may_steal_blocking_work=*/true, *thread_work_sources,
                    &task_from_blocking_queue, &tws);
-      if (!t.f) {
-        // Search from all requests if the thread cannot find tasks from
-        // requests that belong to its own sub thread pool.
-        t = FindTask(0, active_requests, thread_id, sub_thread_pool_id,
-                     kMaxBlockingInflight,
-                     /*may_steal_blocking_work=*/true, *thread_work_sources,
-                     &task_from_blocking_queue, &tws);
+      if (t.f) {
+        GetBlockingThreadTaskCell("own")->IncrementBy(1);
+      } else {
+        // Steal from the requests of other sub thread pools if the thread
+        // cannot find tasks from requests that belong to its own sub thread
+        // pool.
+        t = StealTask(active_requests, thread_id, sub_thread_pool_id,
+                      kMaxBlockingInflight, *thread_work_sources,
+                      &task_from_blocking_queue, &tws, &lower_priority_steal);
+        if (t.f) {
+          GetBlockingThreadTaskCell(lower_priority_steal ? "lower_priority"
+                                                         : "higher_priority")
+              ->IncrementBy(1);
+        }
       }
     } else {
       // For non-blocking threads, it will always search from all pending
@@ -585,6 +702,9 @@ void RunHandlerThreadPool::WorkerLoop(int thread_id,
       env_.ExecuteTask(t);
       tws->DecrementInflightTaskCount(task_from_blocking_queue);
       tws->DecrementPendingTaskCount();
+      if (lower_priority_steal) {
+        FinishLowerPriorityStealing(sub_thread_pool_id);
+      }
     } else {
       tensorflow::profiler::TraceMe activity(
           [thread_id] {
@@ -714,6 +834,25 @@ class RunHandler::Impl {
   RunHandlerOptions options_;
 };
 
+namespace {
+
+internal::RunHandlerThreadPool::Options GetThreadPoolOptions(
+    const RunHandlerPool::Options& options) {
+  internal::RunHandlerThreadPool::Options thread_pool_options(
+      options.num_inter_op_threads, options.num_intra_op_threads,
+      options.wait_if_no_active_request,
+      options.non_blocking_threads_sleep_time_micro_sec,
+      options.blocking_threads_max_sleep_time_micro_sec,
+      options.use_adaptive_waiting_time, options.enable_wake_up,
+      options.max_concurrent_handler, options.num_threads_in_sub_thread_pool,
+      options.sub_thread_request_percentage);
+  thread_pool_options.max_lower_priority_steal_fraction =
+      options.max_lower_priority_steal_fraction;
+  return thread_pool_options;
+}
+
+}  // namespace
+
 // Contains shared state across all run handlers present in the pool. Also
 // responsible for pool management decisions.
 // This class is thread safe.
@@ -724,16 +863,7 @@ class RunHandlerPool::Impl {
         waiters_mu_(options.num_sub_thread_pool),
         queue_waiters_(options.num_sub_thread_pool),
         run_handler_thread_pool_(new internal::RunHandlerThreadPool(
-            internal::RunHandlerThreadPool::Options(
-                options.num_inter_op_threads, options.num_intra_op_threads,
-                options.wait_if_no_active_request,
-                options.non_blocking_threads_sleep_time_micro_sec,
-                options.blocking_threads_max_sleep_time_micro_sec,
-                options.use_adaptive_waiting_time, options.enable_wake_up,
-                options.max_concurrent_handler,
-                options.num_threads_in_sub_thread_pool,
-                options.sub_thread_request_percentage),
-            tensorflow::Env::Default(), tensorflow::ThreadOptions(),
+            GetThreadPoolOptions(options), tensorflow::Env::Default(), tensorflow::ThreadOptions(),
             "tf_run_handler_pool", &waiters_mu_, &queue_waiters_)),
         iterations_(0),
         version_(0),
@@ -108,6 +108,14 @@ class RunHandlerPool {
 
     // If true, threads will be waken up by new tasks.
     bool enable_wake_up = true;
+
+    // Threads of a sub thread pool that find no work in their own requests
+    // steal from the requests of the other sub thread pools, closest sub
+    // thread pool first. This is the maximum fraction of the inter-op threads
+    // of a sub thread pool that can run tasks stolen from the requests of
+    // lower priority sub thread pools at the same time, so that low priority
+    // requests cannot take over the threads reserved for high priority ones.
+    double max_lower_priority_steal_fraction = 1.0;
   };
   explicit RunHandlerPool(Options options);
   ~RunHandlerPool();
@@ -301,6 +309,8 @@ class RunHandlerThreadPool {
     int max_concurrent_handler;
     std::vector<int> num_threads_in_sub_thread_pool;
     std::vector<double> sub_thread_request_percentage;
+    // See RunHandlerPool::Options::max_lower_priority_steal_fraction.
+    double max_lower_priority_steal_fraction = 1.0;
     Options(int num_blocking_threads, int num_non_blocking_threads,
             bool wait_if_no_active_request,
             int non_blocking_threads_sleep_time_micro_sec,
@@ -369,10 +379,31 @@ class RunHandlerThreadPool {
       const Eigen::MaxSizeVector<ThreadWorkSource*>& thread_work_sources,
       bool* task_from_blocking_queue, ThreadWorkSource** tws);
 
+  // Searches tasks from the requests of the sub thread pools other than
+  // `sub_thread_pool_id`, in the order of their distance to it. Tasks are only
+  // stolen from lower priority sub thread pools while fewer than the maximum
+  // number of threads of the sub thread pool are running stolen tasks, in
+  // which case `*lower_priority_steal` is set and the caller must call
+  // FinishLowerPriorityStealing() once the task is done.
+  Task StealTask(
+      int active_requests, int thread_id, int sub_thread_pool_id,
+      int max_blocking_inflight,
+      const Eigen::MaxSizeVector<ThreadWorkSource*>& thread_work_sources,
+      bool* task_from_blocking_queue, ThreadWorkSource** tws,
+      bool* lower_priority_steal);
+
   void WaitForWorkInSubThreadPool(int thread_id, bool is_blocking,
                                   int sub_thread_pool_id);
 
  private:
+  // Returns the range [start, end) of the requests handled by the sub thread
+  // pool `sub_thread_pool_id` when there are `active_requests` requests.
+  std::pair<int, int> GetSubThreadPoolRequestRange(
+      int active_requests, int sub_thread_pool_id) const;
+
+  bool TryStartLowerPriorityStealing(int sub_thread_pool_id);
+  void FinishLowerPriorityStealing(int sub_thread_pool_id);
+
   struct ThreadData {
     ThreadData();
     tensorflow::mutex mu;
@@ -412,6 +443,11 @@ class RunHandlerThreadPool {
   // the end_request_percentage of previous sub thread pool to its own
   // end_request_percentage in a round robin fashion.
   std::vector<double> sub_thread_pool_end_request_percentage_;
+
+  // The maximum number of threads of each sub thread pool that can run tasks
+  // stolen from lower priority sub thread pools, and the number that do.
+  std::vector<int> max_lower_priority_stealing_threads_;
+  std::unique_ptr<std::atomic<int>[]> num_lower_priority_stealing_threads_;
 };
 
 }  // namespace internal
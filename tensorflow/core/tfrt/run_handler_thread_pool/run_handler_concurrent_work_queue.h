@@ -79,6 +79,10 @@ class RunHandlerThreadWorkQueue
 
     // If true, threads will be waken up by new tasks.
     bool enable_wake_up = true;
+
+    // The maximum fraction of the main threads of a sub thread pool that can
+    // run tasks stolen from lower priority sub thread pools at the same time.
+    double max_lower_priority_steal_fraction = 1.0;
   };
 
   explicit RunHandlerThreadWorkQueue(const Options& options);
@@ -638,6 +638,82 @@ TEST_P(RunHandlerThreadPoolTest, MultipleSubThreadPool) {
   delete run_handler_thread_pool;
 }
 
+TEST_P(RunHandlerThreadPoolTest, StealTask) {
+  Eigen::MaxSizeVector<tensorflow::mutex> waiters_mu(3);
+  waiters_mu.resize(3);
+  Eigen::MaxSizeVector<internal::Waiter> waiters(3);
+  waiters.resize(3);
+  for (double max_lower_priority_steal_fraction : {1.0, 0.0}) {
+    internal::RunHandlerThreadPool::Options options(
+        /*num_blocking_threads=*/3, /*num_non_blocking_threads=*/0,
+        /*wait_if_no_active_request=*/true,
+        /*non_blocking_threads_sleep_time_micro_sec=*/250,
+        /*blocking_threads_max_sleep_time_micro_sec=*/250,
+        /*use_adaptive_waiting_time=*/true, /*enable_wake_up=*/true,
+        /*max_concurrent_handler=*/128,
+        /*num_threads_in_sub_thread_pool=*/{1, 2, 3},
+        /*sub_thread_request_percentage=*/{0.4, 0.7, 1});
+    options.max_lower_priority_steal_fraction =
+        max_lower_priority_steal_fraction;
+    internal::RunHandlerThreadPool run_handler_thread_pool(
+        options, tensorflow::Env::Default(), tensorflow::ThreadOptions(),
+        "tf_run_handler_pool", &waiters_mu, &waiters);
+
+    // One request for each sub thread pool, in the order of priority.
+    Eigen::MaxSizeVector<internal::ThreadWorkSource*> thread_work_sources(3);
+    thread_work_sources.resize(3);
+    internal::ThreadWorkSource tws[3];
+    for (int i = 0; i < 3; ++i) {
+      tws[i].SetWaiter(1, &waiters[i], &waiters_mu[i]);
+      thread_work_sources[i] = &tws[i];
+    }
+
+    int result = -1;
+    for (int i : {0, 2}) {
+      run_handler_thread_pool.AddWorkToQueue(
+          &tws[i], /*is_blocking=*/true,
+          TaskFunction([&result, i] { result = i; }));
+    }
+
+    const auto steal_task = [&](bool* lower_priority_steal) {
+      bool task_from_blocking_queue;
+      internal::ThreadWorkSource* tws;
+      return run_handler_thread_pool.StealTask(
+          /*active_requests=*/3, /*thread_id=*/1, /*sub_thread_pool_id=*/1,
+          /*max_blocking_inflight=*/10, thread_work_sources,
+          &task_from_blocking_queue, &tws, lower_priority_steal);
+    };
+
+    // The higher priority request is helped first.
+    bool lower_priority_steal;
+    internal::Task t = steal_task(&lower_priority_steal);
+    ASSERT_NE(t.f, nullptr);
+    EXPECT_FALSE(lower_priority_steal);
+    t.f->f();
+    EXPECT_EQ(result, 0);
+
+    t = steal_task(&lower_priority_steal);
+    if (max_lower_priority_steal_fraction == 0.0) {
+      // The sub thread pool is not allowed to run lower priority tasks.
+      EXPECT_EQ(t.f, nullptr);
+
+      // Clean up the queue.
+      bool task_from_blocking_queue;
+      internal::ThreadWorkSource* tws;
+      t = run_handler_thread_pool.FindTask(
+          /*searching_range_start=*/2, /*searching_range_end=*/3,
+          /*thread_id=*/2, /*sub_thread_pool_id=*/2,
+          /*max_blocking_inflight=*/10, /*may_steal_blocking_work=*/true,
+          thread_work_sources, &task_from_blocking_queue, &tws);
+    } else {
+      EXPECT_TRUE(lower_priority_steal);
+    }
+    ASSERT_NE(t.f, nullptr);
+    t.f->f();
+    EXPECT_EQ(result, 2);
+  }
+}
+
 INSTANTIATE_TEST_SUITE_P(Parameter, RunHandlerThreadPoolTest,
                          testing::Combine(::testing::Bool(),
                                           ::testing::Bool()));
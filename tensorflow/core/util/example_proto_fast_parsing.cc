@@ -15,6 +15,7 @@ limitations under the License.
 #include "tensorflow/core/util/example_proto_fast_parsing.h"
 
 #include <algorithm>
+#include <cstring>
 #include <functional>
 #include <optional>
 #include <utility>
@@ -22,6 +23,7 @@ limitations under the License.
 
 #include "absl/base/casts.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/numeric/bits.h"
 #include "tensorflow/core/example/example.pb.h"
 #include "tensorflow/core/example/feature.pb.h"
 #include "tensorflow/core/framework/allocator.h"
@@ -105,6 +107,91 @@ auto EnableAliasing(A* a) -> decltype(a->EnableAliasing(true), void()) {
 template <typename A>
 void EnableAliasing(A&& a) {}
 
+// Varints store 7 bits per byte, and every byte but the last one of a varint
+// has its most significant bit set.
+constexpr uint64 kVarintContinuationBits = 0x8080808080808080ULL;
+
+// Returns the number of varints packed in [begin, end), assuming the last one
+// is complete.
+size_t CountPackedVarints(const uint8* begin, const uint8* end) {
+  size_t count = 0;
+  const uint8* p = begin;
+  if (port::kLittleEndian) {
+    for (; end - p >= 8; p += 8) {
+      uint64 word;
+      std::memcpy(&word, p, sizeof(word));
+      count += absl::popcount(~word & kVarintContinuationBits);
+    }
+  }
+  for (; p < end; ++p) {
+    count += *p < 0x80;
+  }
+  return count;
+}
+
+// Decodes the single varint at `*p`, advancing `*p` past it. Returns false if
+// the varint is truncated or longer than 10 bytes.
+inline bool DecodeVarint(const uint8** p, const uint8* end, int64_t* value) {
+  uint64 result = 0;
+  for (int shift = 0; shift < 64 && *p < end; shift += 7) {
+    const uint8 byte = *(*p)++;
+    result |= static_cast<uint64>(byte & 0x7f) << shift;
+    if (byte < 0x80) {
+      *value = static_cast<int64_t>(result);
+      return true;
+    }
+  }
+  return false;
+}
+
+// Decodes the varints packed in [begin, end) into `values`, which must have
+// room for `CountPackedVarints(begin, end)` elements.
+//
+// Rather than decoding a byte at a time, this loads 8 bytes at once. Eight
+// single-byte varints are widened directly, and a varint of up to 8 bytes is
+// extracted by locating its last byte and squeezing out the continuation bits
+// of the word with three shift-and-mask steps. Longer varints (e.g. negative
+// values, which always take 10 bytes) go through `DecodeVarint`.
+bool DecodePackedVarints(const uint8* begin, const uint8* end,
+                         int64_t* values) {
+  const uint8* p = begin;
+  if (port::kLittleEndian) {
+    while (end - p >= 8) {
+      uint64 word;
+      std::memcpy(&word, p, sizeof(word));
+      const uint64 last_bytes = ~word & kVarintContinuationBits;
+      if (last_bytes == kVarintContinuationBits) {
+        for (int i = 0; i < 8; ++i) {
+          values[i] = static_cast<uint8>(word >> (8 * i));
+        }
+        values += 8;
+        p += 8;
+        continue;
+      }
+      if (last_bytes == 0) {
+        if (!DecodeVarint(&p, end, values++)) return false;
+        continue;
+      }
+      // Keeps the bytes up to and including the first one without the
+      // continuation bit, then packs their 7-bit groups together.
+      uint64 value = word & (last_bytes ^ (last_bytes - 1)) &
+                     ~kVarintContinuationBits;
+      value = ((value & 0x7f007f007f007f00ULL) >> 1) |
+              (value & 0x007f007f007f007fULL);
+      value = ((value & 0x3fff00003fff0000ULL) >> 2) |
+              (value & 0x00003fff00003fffULL);
+      value = ((value & 0x0fffffff00000000ULL) >> 4) |
+              (value & 0x000000000fffffffULL);
+      *values++ = static_cast<int64_t>(value);
+      p += absl::countr_zero(last_bytes) / 8 + 1;
+    }
+  }
+  while (p < end) {
+    if (!DecodeVarint(&p, end, values++)) return false;
+  }
+  return true;
+}
+
 uint8 PeekTag(protobuf::io::CodedInputStream* stream) {
   DCHECK(stream != nullptr);
   const void* ptr;
@@ -305,6 +392,33 @@ class Feature {
         if (!stream.ReadVarint32(&packed_length)) return false;
         auto packed_limit = stream.PushLimit(packed_length);
 
+        const int packed_size = stream.BytesUntilLimit();
+        const void* buffer;
+        int buffer_size;
+        if (packed_size > 0 &&
+            stream.GetDirectBufferPointer(&buffer, &buffer_size) &&
+            buffer_size >= packed_size) {
+          const uint8* begin = static_cast<const uint8*>(buffer);
+          const uint8* end = begin + packed_size;
+          if (end[-1] >= 0x80) return false;  // truncated varint
+          // Store the initial size to know the offset we have to start
+          // writing data from before resizing the output "vector".
+          const size_t initial_size = int64_list->size();
+          const size_t num_elements = CountPackedVarints(begin, end);
+          int64_list->resize(initial_size + num_elements);
+          if (int64_list->size() == initial_size + num_elements) {
+            if (!DecodePackedVarints(begin, end,
+                                     int64_list->data() + initial_size)) {
+              return false;
+            }
+            stream.Skip(packed_size);
+          } else {
+            // A LimitedArraySlice that is too small: let push_back record the
+            // overflow.
+            int64_list->resize(initial_size);
+          }
+        }
+
         while (!stream.ExpectAtEnd()) {
           protobuf_uint64 n;  // There is no API for int64
           if (!stream.ReadVarint64(&n)) return false;
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/util/example_proto_fast_parsing.h"
 
+#include <limits>
 #include <unordered_set>
 #include <utility>
 #include <vector>
@@ -219,6 +220,36 @@ TEST(FastParse, SingleInt64) {
   TestCorrectness(Serialize(example));
 }
 
+TEST(FastParse, PackedInt64WithMultiByteValues) {
+  Example example;
+  auto* int64_list = (*example.mutable_features()->mutable_feature())["age"]
+                         .mutable_int64_list();
+  // Every varint length from 1 to 10 bytes, with runs of single-byte values
+  // in between.
+  for (int i = 0; i < 3; ++i) {
+    for (int shift = 0; shift < 64; shift += 7) {
+      int64_list->add_value(int64_t{1} << shift);
+      int64_list->add_value((int64_t{1} << shift) - 1);
+      for (int j = 0; j < i * 5; ++j) int64_list->add_value(j);
+    }
+    int64_list->add_value(-1);
+    int64_list->add_value(std::numeric_limits<int64_t>::min());
+    int64_list->add_value(std::numeric_limits<int64_t>::max());
+  }
+  TestCorrectness(Serialize(example));
+}
+
+TEST(FastParse, TruncatedPackedInt64) {
+  // The packed list of "age" ends in the middle of a varint.
+  const string serialized(
+      "\x0a\x0f\x0a\x0d\x0a\x03\x61\x67\x65\x12\x06\x1a\x04\x0a\x02"
+      "\x80\x80");
+  Example example;
+  EXPECT_FALSE(example.ParseFromString(serialized));
+  Example fast_example;
+  EXPECT_FALSE(TestFastParse(serialized, &fast_example));
+}
+
 static string ExampleWithSomeFeatures() {
   Example example;
 
@@ -429,6 +460,29 @@ TEST(TestFastParseExample, Empty) {
   EXPECT_TRUE(status.ok()) << status;
 }
 
+// The argument is the number of bytes taken by each varint.
+static void BM_FastParsePackedInt64(::testing::benchmark::State& state) {
+  const int value_bytes = state.range(0);
+  constexpr int kNumValues = 1000;
+  const int64_t value =
+      value_bytes == 10 ? -1 : int64_t{1} << (7 * (value_bytes - 1));
+  Example example;
+  auto* int64_list = (*example.mutable_features()->mutable_feature())["age"]
+                         .mutable_int64_list();
+  for (int i = 0; i < kNumValues; ++i) int64_list->add_value(value);
+  std::vector<tstring> serialized = {Serialize(example)};
+
+  FastParseExampleConfig config;
+  config.sparse.push_back({"age", DT_INT64});
+  for (auto s : state) {
+    Result result;
+    TF_CHECK_OK(FastParseExample(config, serialized, {}, nullptr, &result));
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                          kNumValues);
+}
+BENCHMARK(BM_FastParsePackedInt64)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->Arg(10);
+
 }  // namespace
 }  // namespace example
 }  // namespace tensorflow
@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_UTIL_MKL_UTIL_H_
 #ifdef INTEL_MKL
 
+#include <algorithm>
 #include <list>
 #include <memory>
 #include <string>
@@ -25,6 +26,7 @@ limitations under the License.
 #include <vector>
 
 #include "dnnl.hpp"
+#include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
@@ -1950,7 +1952,9 @@ class MklPrimitiveFactory {
   MklPrimitive* GetOp(const string& key) {
 #ifndef DNNL_AARCH64_USE_ACL
     auto& lru_cache = MklPrimitiveFactory<T>::GetLRUCache();
-    return lru_cache.GetOp(key);
+    MklPrimitive* primitive = lru_cache.GetOp(key);
+    metrics::RecordMklPrimitiveCacheLookup(primitive != nullptr);
+    return primitive;
 #else
     while (true) {
       // TODO(milpuz01): Consider if it is possible to narrow scope to be
@@ -1961,11 +1965,13 @@ class MklPrimitiveFactory {
       // Check to see whether primitive already exists.
       MklPrimitive* primitive = lru_cache.GetOp(key);
       if (primitive != nullptr) {
+        metrics::RecordMklPrimitiveCacheLookup(/*hit=*/true);
         return primitive;
       }
 
       // Now check whether some other thread is creating this primitive.
       if (!lru_cache.IsAllocating(key)) {
+        metrics::RecordMklPrimitiveCacheLookup(/*hit=*/false);
         // This thread is going to pick it up and create the primitive.
         lru_cache.Allocate(key);
         return nullptr;
@@ -2033,7 +2039,19 @@ class MklPrimitiveFactory {
 
  private:
   static inline LRUCache<MklPrimitive>& GetLRUCache() {
-    static const int kCapacity = 1024;  // cache capacity
+    // Cache capacity, which can be changed with an environment variable for
+    // models with many distinct shapes.
+    static const int64_t kCapacity = [] {
+      constexpr int64_t kDefaultCapacity = 1024;
+      int64_t capacity;
+      Status status = ReadInt64FromEnvVar("TF_MKL_PRIMITIVE_CACHE_CAPACITY",
+                                          kDefaultCapacity, &capacity);
+      if (!status.ok()) {
+        LOG(WARNING) << status.message();
+        capacity = kDefaultCapacity;
+      }
+      return std::max<int64_t>(capacity, 1);
+    }();
 #ifndef DNNL_AARCH64_USE_ACL
     static thread_local LRUCache<MklPrimitive> lru_cache_(kCapacity);
 #else
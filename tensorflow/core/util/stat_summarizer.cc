@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/util/stat_summarizer.h"
 
+#include <algorithm>
 #include <iomanip>
 #include <map>
 #include <queue>
@@ -37,10 +38,10 @@ namespace tensorflow {
 using Detail = StatsCalculator::Detail;
 
 StatSummarizer::StatSummarizer(const StatSummarizerOptions& options)
-    : stats_calculator_(new StatsCalculator(options)) {}
+    : options_(options), stats_calculator_(new StatsCalculator(options)) {}
 
 StatSummarizer::StatSummarizer(const tensorflow::GraphDef& tensorflow_graph)
-    : stats_calculator_(new StatsCalculator(StatSummarizerOptions())) {}
+    : stats_calculator_(new StatsCalculator(options_)) {}
 
 StatSummarizer::~StatSummarizer() = default;
 
@@ -212,6 +213,15 @@ void StatSummarizer::ProcessStepStats(const StepStats& step_stats) {
       stats_calculator_->AddNodeStats(name, op_type, node_num, rel_end_us,
                                       curr_node_mem);
 
+      if (ns.has_hardware_counters()) {
+        const HardwareCounters& counters = ns.hardware_counters();
+        HardwareCounterStats& counter_stats = hardware_counters_[name];
+        counter_stats.cycles.UpdateStat(counters.cycles());
+        counter_stats.instructions.UpdateStat(counters.instructions());
+        counter_stats.llc_misses.UpdateStat(counters.llc_misses());
+        counter_stats.branch_misses.UpdateStat(counters.branch_misses());
+      }
+
       mem_total += curr_node_mem;
 
       Validate(outputs, ns);
@@ -222,6 +232,47 @@ void StatSummarizer::ProcessStepStats(const StepStats& step_stats) {
   stats_calculator_->UpdateMemoryUsed(mem_total);
 }
 
+std::string StatSummarizer::GetOutputString() const {
+  std::string output = stats_calculator_->GetOutputString();
+  const std::string counters = GetHardwareCountersString();
+  if (!counters.empty()) output += "\n" + counters;
+  return output;
+}
+
+std::string StatSummarizer::GetHardwareCountersString() const {
+  if (hardware_counters_.empty()) return "";
+
+  std::vector<std::pair<double, const std::string*>> by_cycles;
+  for (const auto& it : hardware_counters_) {
+    by_cycles.emplace_back(it.second.cycles.avg(), &it.first);
+  }
+  std::sort(by_cycles.begin(), by_cycles.end(),
+            [](const auto& a, const auto& b) { return a.first > b.first; });
+  const size_t num_nodes =
+      options_.time_limit > 0
+          ? std::min<size_t>(by_cycles.size(), options_.time_limit)
+          : by_cycles.size();
+
+  std::stringstream stream;
+  const char* sep = options_.format_as_csv ? ", " : "\t";
+  stream << "============================== Top by hardware cycles "
+            "==============================\n";
+  stream << "[cycles]" << sep << "[instructions]" << sep << "[IPC]" << sep
+         << "[LLC misses]" << sep << "[branch misses]" << sep << "[Name]\n";
+  for (size_t i = 0; i < num_nodes; ++i) {
+    const HardwareCounterStats& stats =
+        hardware_counters_.at(*by_cycles[i].second);
+    const double cycles = stats.cycles.avg();
+    const double instructions = stats.instructions.avg();
+    stream << std::fixed << std::setprecision(0) << cycles << sep
+           << instructions << sep << std::setprecision(2)
+           << (cycles > 0 ? instructions / cycles : 0.0) << sep
+           << std::setprecision(0) << stats.llc_misses.avg() << sep
+           << stats.branch_misses.avg() << sep << *by_cycles[i].second
+           << "\n";
+  }
+  return stream.str();
+}
 
 void StatSummarizer::PrintOutputs() const {
   std::priority_queue<
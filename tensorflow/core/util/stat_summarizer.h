@@ -60,9 +60,7 @@ class StatSummarizer {
 
   // Returns a string detailing the accumulated runtime stats in a tab-separated
   // format which can be pasted into a spreadsheet for further analysis.
-  std::string GetOutputString() const {
-    return stats_calculator_->GetOutputString();
-  }
+  std::string GetOutputString() const;
 
   std::string ShortSummary() const {
     return stats_calculator_->GetShortSummary();
@@ -96,6 +94,11 @@ class StatSummarizer {
                                                num_stats);
   }
 
+  // Returns the nodes with the most cycles per run, along with their
+  // instructions per cycle, last level cache misses and branch misses, or an
+  // empty string if the StepStats had no hardware counters.
+  std::string GetHardwareCountersString() const;
+
   int num_runs() const { return stats_calculator_->num_runs(); }
 
   // Returns stats of total microseconds spent by all nodes in each run.
@@ -107,7 +110,18 @@ class StatSummarizer {
   void Validate(const std::vector<TensorDescription>* outputs,
                 const NodeExecStats& ns) const;
 
+  // Hardware counters of a node across runs.
+  struct HardwareCounterStats {
+    Stat<int64_t> cycles;
+    Stat<int64_t> instructions;
+    Stat<int64_t> llc_misses;
+    Stat<int64_t> branch_misses;
+  };
+
+  StatSummarizerOptions options_;
+
   std::map<std::string, std::vector<TensorDescription> > outputs_;
+  std::map<std::string, HardwareCounterStats> hardware_counters_;
 
   std::unique_ptr<StatsCalculator> stats_calculator_;
 };
@@ -88,5 +88,48 @@ versions {
   ASSERT_TRUE(absl::StrContains(by_node_type, "Const")) << by_node_type;
 }
 
+TEST(StatSummarizerTest, SummarizesHardwareCounters) {
+  StepStats step_stats;
+  ASSERT_TRUE(protobuf::TextFormat::ParseFromString(R"EOF(
+dev_stats {
+  device: "/job:localhost/replica:0/task:0/device:CPU:0"
+  node_stats {
+    node_name: "matmul"
+    timeline_label: "matmul = MatMul(a, b)"
+    all_end_rel_micros: 10
+    hardware_counters {
+      cycles: 4000
+      instructions: 8000
+      llc_misses: 30
+      branch_misses: 5
+    }
+  }
+  node_stats {
+    node_name: "relu"
+    timeline_label: "relu = Relu(matmul)"
+    all_end_rel_micros: 1
+    hardware_counters {
+      cycles: 1000
+      instructions: 500
+    }
+  }
+}
+  )EOF",
+                                                    &step_stats));
+
+  StatSummarizer stats((StatSummarizerOptions()));
+  EXPECT_EQ(stats.GetHardwareCountersString(), "");
+  stats.ProcessStepStats(step_stats);
+
+  const std::string counters = stats.GetHardwareCountersString();
+  EXPECT_TRUE(absl::StrContains(counters, "4000\t8000\t2.00\t30\t5\tmatmul"))
+      << counters;
+  EXPECT_TRUE(absl::StrContains(counters, "1000\t500\t0.50\t0\t0\trelu"))
+      << counters;
+  // Sorted by cycles.
+  EXPECT_LT(counters.find("matmul"), counters.find("relu")) << counters;
+  EXPECT_TRUE(absl::StrContains(stats.GetOutputString(), counters));
+}
+
 }  // namespace
 }  // namespace tensorflow
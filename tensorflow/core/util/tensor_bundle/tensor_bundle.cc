@@ -21,6 +21,7 @@ limitations under the License.
 #include <memory>
 #include <utility>
 
+#include "tensorflow/core/framework/allocation_description.pb.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
@@ -33,7 +34,9 @@ limitations under the License.
 #include "tensorflow/core/framework/versions.pb.h"
 #include "tensorflow/core/lib/core/coding.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
 #include "tensorflow/core/lib/hash/crc32c.h"
 #include "tensorflow/core/lib/io/path.h"
@@ -80,6 +83,30 @@ const int64_t kMinSectionSize = static_cast<int64_t>(1) << 31;
 
 namespace {
 
+// A tensor buffer aliasing part of a memory-mapped data file. It does not own
+// its memory, so that it is copied instead of being updated in place.
+class MappedTensorBuffer : public TensorBuffer {
+ public:
+  MappedTensorBuffer(std::shared_ptr<ReadOnlyMemoryRegion> region,
+                     const char* data, size_t size)
+      : TensorBuffer(const_cast<char*>(data)),
+        region_(std::move(region)),
+        size_(size) {}
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name("MappedTensorBundle");
+  }
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  // Keeps the mapping alive.
+  const std::shared_ptr<ReadOnlyMemoryRegion> region_;
+  const size_t size_;
+};
+
 // Reads "num_elements" string elements from file[offset, offset+size) into the
 // length-N "destination".  Discards the original content of "destination".
 //
@@ -768,6 +795,11 @@ Status MergeBundles(Env* env, gtl::ArraySlice<tstring> prefixes,
 BundleReader::BundleReader(
     Env* env, StringPiece prefix,
     bool enable_multi_threading_for_testing /* = false */)
+    : BundleReader(env, prefix,
+                   {/*mmap_data_files=*/false,
+                    enable_multi_threading_for_testing}) {}
+
+BundleReader::BundleReader(Env* env, StringPiece prefix, const Options& options)
     : env_(env),
       prefix_(prefix),
       metadata_(nullptr),
@@ -775,7 +807,7 @@ BundleReader::BundleReader(
       index_cache_(nullptr),
       iter_(nullptr),
       need_to_swap_bytes_(false),
-      enable_multi_threading_for_testing_(enable_multi_threading_for_testing) {
+      options_(options) {
   const string filename = MetaFilename(prefix_);
   uint64 file_size;
   status_ = env_->GetFileSize(filename, &file_size);
@@ -867,10 +899,56 @@ Status BundleReader::GetBundleEntryProto(StringPiece key,
   return OkStatus();
 }
 
+Status BundleReader::GetMappedValue(const BundleEntryProto& entry,
+                                    Tensor* val, bool* mapped) {
+  *mapped = false;
+  if (!options_.mmap_data_files || need_to_swap_bytes_ ||
+      !DataTypeCanUseMemcpy(entry.dtype())) {
+    return OkStatus();
+  }
+  const TensorShape stored_shape(TensorShape(entry.shape()));
+  // Invalid sizes are reported when reading the value instead.
+  if (entry.size() == 0 || entry.size() != stored_shape.num_elements() *
+                                               DataTypeSize(entry.dtype())) {
+    return OkStatus();
+  }
+
+  auto it = mapped_data_.find(entry.shard_id());
+  if (it == mapped_data_.end()) {
+    std::unique_ptr<ReadOnlyMemoryRegion> region;
+    const string filename =
+        DataFilename(prefix_, entry.shard_id(), num_shards_);
+    Status s = env_->NewReadOnlyMemoryRegionFromFile(filename, &region);
+    if (!s.ok()) {
+      VLOG(1) << "Reading " << filename << " instead of mapping it: " << s;
+      region.reset();
+    }
+    it = mapped_data_.emplace(entry.shard_id(), std::move(region)).first;
+  }
+  const std::shared_ptr<ReadOnlyMemoryRegion>& region = it->second;
+  if (region == nullptr || entry.offset() + entry.size() > region->length()) {
+    return OkStatus();
+  }
+  const char* data = static_cast<const char*>(region->data()) + entry.offset();
+  if (reinterpret_cast<uintptr_t>(data) % EIGEN_MAX_ALIGN_BYTES != 0) {
+    return OkStatus();
+  }
+
+  MappedTensorBuffer* buffer =
+      new MappedTensorBuffer(region, data, entry.size());
+  *val = Tensor(entry.dtype(), stored_shape, buffer);
+  buffer->Unref();
+  *mapped = true;
+  return OkStatus();
+}
+
 Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
   Tensor* ret = val;
   const TensorShape stored_shape(TensorShape(entry.shape()));
   if (val->NumElements() == 0) {
+    bool mapped = false;
+    TF_RETURN_IF_ERROR(GetMappedValue(entry, val, &mapped));
+    if (mapped) return OkStatus();
     ret = new Tensor(entry.dtype(), stored_shape);
   }
 
@@ -914,9 +992,10 @@ Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
   if (DataTypeCanUseMemcpy(entry.dtype())) {
     char* backing_buffer = const_cast<char*>((ret->tensor_data().data()));
     size_t unused_bytes_read;
+    bool checksummed = false;
     if (entry.size() > kBufferSize) {
       StringPiece sp;
-      if (!enable_multi_threading_for_testing_ &&
+      if (!options_.enable_multi_threading_for_testing &&
           entry.size() < kLargeTensorThreshold) {
         TF_RETURN_IF_ERROR(buffered_file->file()->Read(
             entry.offset(), entry.size(), &sp, backing_buffer));
@@ -928,13 +1007,14 @@ Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
         int64_t thread_pool_size =
             (entry.size() + kMinSectionSize - 1) / kMinSectionSize;
         if (thread_pool_size > kMaxFileReadThreads ||
-            enable_multi_threading_for_testing_) {
+            options_.enable_multi_threading_for_testing) {
           thread_pool_size = kMaxFileReadThreads;
           section_size =
               (entry.size() + kMaxFileReadThreads - 1) / kMaxFileReadThreads;
         }
 
         std::vector<Status> statuses(thread_pool_size);
+        std::vector<Notification> sections_read(thread_pool_size);
         auto reader_pool = std::make_unique<thread::ThreadPool>(
             Env::Default(), "restore_large_tensor", thread_pool_size);
 
@@ -945,6 +1025,7 @@ Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
                                                      : section_size;
             std::unique_ptr<RandomAccessFile> section_reader = nullptr;
             StringPiece sp;
+            auto notify = gtl::MakeCleanup([&] { sections_read[i].Notify(); });
             if (auto file_status = env_->NewRandomAccessFile(
                     DataFilename(prefix_, entry.shard_id(), num_shards_),
                     &section_reader);
@@ -962,9 +1043,20 @@ Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
             statuses[i] = std::move(status);
           });
         }
-        for (const auto& status : statuses) {
-          TF_RETURN_IF_ERROR(status);
+        // Checksums the sections in order as soon as they are read, while
+        // the following ones are still being read. Returning early is safe,
+        // as destroying the pool waits for the pending reads.
+        for (int i = 0; i < thread_pool_size; ++i) {
+          sections_read[i].WaitForNotification();
+          TF_RETURN_IF_ERROR(statuses[i]);
+          const int64_t offset = i * section_size;
+          const int64_t size = i == thread_pool_size - 1
+                                   ? entry.size() - offset
+                                   : section_size;
+          actual_crc32c =
+              crc32c::Extend(actual_crc32c, backing_buffer + offset, size);
         }
+        checksummed = true;
       }
     } else {
       TF_RETURN_IF_ERROR(buffered_file->ReadNBytes(entry.size(), backing_buffer,
@@ -972,7 +1064,9 @@ Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
     }
     // Note that we compute the checksum *before* byte-swapping. The checksum
     // should be on the bytes in the order they appear in the file.
-    actual_crc32c = crc32c::Value(backing_buffer, entry.size());
+    if (!checksummed) {
+      actual_crc32c = crc32c::Value(backing_buffer, entry.size());
+    }
     if (need_to_swap_bytes_) {
       TF_RETURN_IF_ERROR(ByteSwapTensor(ret));
     }
@@ -196,8 +196,23 @@ Status MergeBundles(Env* env, gtl::ArraySlice<tstring> prefixes,
 // All threads accessing the same BundleReader must synchronize.
 class BundleReader {
  public:
+  struct Options {
+    // If true, the data files are memory-mapped, and tensors looked up into an
+    // empty "val" alias the mapped pages instead of being read into freshly
+    // allocated buffers, when the file system supports it and the stored
+    // bytes are suitably aligned and in native byte order. Such tensors do
+    // not own their memory, so resource variables holding them copy them
+    // before their first update, and processes restoring the same bundle
+    // share the physical pages. The stored checksums of aliased tensors are
+    // not verified, since that would read all of their pages.
+    bool mmap_data_files = false;
+
+    bool enable_multi_threading_for_testing = false;
+  };
+
   BundleReader(Env* const env, StringPiece prefix,
                bool enable_multi_threading_for_testing = false);
+  BundleReader(Env* const env, StringPiece prefix, const Options& options);
   ~BundleReader();
 
   // Is ok() iff the reader construction is successful (completed the read of
@@ -238,6 +253,8 @@ class BundleReader {
   // Caller must make sure "val" has the same shape and dtype as the
   // corresponding contents, so that its buffer can be filled without needing
   // extra allocation.  These can be queried via "LookupDtypeAndShape()".
+  // Alternatively "val" can be empty, in which case the reader allocates it,
+  // or aliases the mapped data file if "Options::mmap_data_files" is set.
   //
   // On error, "val" may contain nonsense data.  Returns a NotFound error if
   // tensor keyed by "key" does not exist in this bundle.
@@ -302,6 +319,12 @@ class BundleReader {
   Status GetValue(const BundleEntryProto& entry,
                   Tensor* val) TF_MUST_USE_RESULT;
 
+  // Sets "val" to a tensor aliasing the mapped data file that holds "entry",
+  // and "mapped" to true, if "Options::mmap_data_files" is set and the entry
+  // can be aliased. Otherwise leaves "val" untouched.
+  Status GetMappedValue(const BundleEntryProto& entry, Tensor* val,
+                        bool* mapped) TF_MUST_USE_RESULT;
+
   // Reads the slice described by "slice_spec".  The corresponding full tensor
   // has key "ful_tensor_key" and metadata proto "full_tensor_entry".
   // REQUIRES: full_tensor_entry.slices_size() > 0
@@ -320,6 +343,10 @@ class BundleReader {
   table::Iterator* iter_;
   // Owned the InputBuffer objects and their underlying RandomAccessFile's.
   std::unordered_map<int32, io::InputBuffer*> data_;
+  // The mapped data files, shared with the tensors aliasing them, or nullptr
+  // for the ones that could not be mapped.
+  std::unordered_map<int32, std::shared_ptr<ReadOnlyMemoryRegion>>
+      mapped_data_;
 
   // Maps each partitioned tensor's key to its stored slices (represented in a
   // TensorSliceSet).  Populated on-demand.
@@ -335,7 +362,7 @@ class BundleReader {
 
   friend class TensorBundleAlignmentTest;  // For testing data alignment.
 
-  bool enable_multi_threading_for_testing_ = false;
+  const Options options_;
 
   TF_DISALLOW_COPY_AND_ASSIGN(BundleReader);
 };
@@ -1147,6 +1147,41 @@ TEST(TensorBundleTest, LargeVariableLoadingTest) {
   }
 }
 
+TEST(TensorBundleTest, MmapDataFiles) {
+  {
+    BundleWriter::Options opts;
+    opts.data_alignment = EIGEN_MAX_ALIGN_BYTES;
+    BundleWriter writer(Env::Default(), Prefix("foo"), opts);
+    TF_EXPECT_OK(writer.Add("foo_000", Constant_100x100<float>(0)));
+    TF_EXPECT_OK(writer.Add("foo_001", Constant_100x100<float>(1)));
+    TF_EXPECT_OK(
+        writer.Add("foo_002", Constant<tstring>("bar", TensorShape({2}))));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  BundleReader::Options options;
+  options.mmap_data_files = true;
+  BundleReader reader(Env::Default(), Prefix("foo"), options);
+  TF_ASSERT_OK(reader.status());
+
+  Tensor mapped;
+  TF_ASSERT_OK(reader.Lookup("foo_001", &mapped));
+  test::ExpectTensorEqual<float>(mapped, Constant_100x100<float>(1));
+  // The tensor aliases the data file, so updates must copy it first.
+  EXPECT_FALSE(mapped.RefCountIsOne());
+
+  // Tensors read into an allocated buffer are still copied into it.
+  Tensor allocated(DT_FLOAT, TensorShape({100, 100}));
+  TF_ASSERT_OK(reader.Lookup("foo_000", &allocated));
+  test::ExpectTensorEqual<float>(allocated, Constant_100x100<float>(0));
+  EXPECT_TRUE(allocated.RefCountIsOne());
+
+  // Strings can't be aliased.
+  Tensor strings;
+  TF_ASSERT_OK(reader.Lookup("foo_002", &strings));
+  test::ExpectTensorEqual<tstring>(strings,
+                                   Constant<tstring>("bar", TensorShape({2})));
+}
+
 class TensorBundleAlignmentTest : public ::testing::Test {
  protected:
   template <typename T>
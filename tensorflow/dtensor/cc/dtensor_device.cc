@@ -1624,7 +1624,8 @@ DTensorDevice::DTensorOperationToModule(
     TF_ASSIGN_OR_RETURN(
         cached_key_and_module,
         module_manager_->GetCachedExecutable(doperation, eager_attributes,
-                                             inputs, result.output_layouts));
+                                             inputs, result.output_layouts,
+                                             flib_def));
   }
   auto [cache_key, cached_mlir_module] = cached_key_and_module;
   result.doperation_cache_key = cache_key;
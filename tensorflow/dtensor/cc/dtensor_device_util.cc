@@ -24,6 +24,7 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/memory/memory.h"
 #include "absl/status/status.h"
@@ -1287,6 +1288,83 @@ tensorflow::Fprint128 ExecutableManagerImpl::CacheKeyForDTensorOperation(
   return tensorflow::Fingerprint128(doperation.name);
 }
 
+tensorflow::Fprint128 ExecutableManagerImpl::FunctionFingerprint(
+    const FunctionDef& function_def,
+    const FunctionLibraryDefinition& flib_def) {
+  const std::string& name = function_def.signature().name();
+  {
+    mutex_lock lock(function_fingerprints_mu_);
+    auto iter = function_fingerprints_.find(name);
+    if (iter != function_fingerprints_.end() &&
+        absl::c_all_of(iter->second.dependencies, [&](const auto& dependency) {
+          return flib_def.FindRecord(dependency.first).get() ==
+                 dependency.second.get();
+        })) {
+      return iter->second.fingerprint;
+    }
+  }
+
+  FunctionRecords dependencies;
+  const tensorflow::Fprint128 fingerprint =
+      FunctionFingerprint(function_def, flib_def, /*depth=*/0, &dependencies);
+  // Only functions of the library can be validated later.
+  core::RefCountPtr<FunctionRecord> record = flib_def.FindRecord(name);
+  if (record == nullptr || &record->fdef() != &function_def) {
+    return fingerprint;
+  }
+  dependencies[name] = std::move(record);
+
+  mutex_lock lock(function_fingerprints_mu_);
+  if (function_fingerprints_.size() >= kMaxFunctionFingerprints) {
+    function_fingerprints_.clear();
+  }
+  function_fingerprints_[name] = {std::move(dependencies), fingerprint};
+  return fingerprint;
+}
+
+tensorflow::Fprint128 ExecutableManagerImpl::FunctionFingerprint(
+    const FunctionDef& function_def, const FunctionLibraryDefinition& flib_def,
+    int depth, FunctionRecords* dependencies) {
+  // Bounds the recursion through the called functions.
+  constexpr int kMaxDepth = 32;
+  const std::string& name = function_def.signature().name();
+
+  FunctionDef unnamed = function_def;
+  unnamed.mutable_signature()->clear_name();
+  // Replaces the name of a called function with the fingerprint of its body.
+  auto replace_function_name = [&](std::string* function_name) {
+    if (*function_name == name || depth >= kMaxDepth) return;
+    core::RefCountPtr<FunctionRecord> callee =
+        flib_def.FindRecord(*function_name);
+    if (callee == nullptr) {
+      // Most names are ops. The fingerprint changes if a function with this
+      // name is added later.
+      dependencies->try_emplace(*function_name, nullptr);
+      return;
+    }
+    const tensorflow::Fprint128 callee_fingerprint =
+        FunctionFingerprint(callee->fdef(), flib_def, depth + 1, dependencies);
+    dependencies->try_emplace(*function_name, std::move(callee));
+    *function_name = absl::StrCat(callee_fingerprint.low64, "_",
+                                  callee_fingerprint.high64);
+  };
+  for (NodeDef& node : *unnamed.mutable_node_def()) {
+    replace_function_name(node.mutable_op());
+    for (auto& [attr_name, attr_value] : *node.mutable_attr()) {
+      if (attr_value.has_func()) {
+        replace_function_name(attr_value.mutable_func()->mutable_name());
+      } else if (attr_value.has_list()) {
+        for (NameAttrList& func : *attr_value.mutable_list()->mutable_func()) {
+          replace_function_name(func.mutable_name());
+        }
+      }
+    }
+  }
+  std::string serialized;
+  SerializeToStringDeterministic(unnamed, &serialized);
+  return tensorflow::Fingerprint128(serialized);
+}
+
 absl::flat_hash_map<int, NodeDef>
 ExecutableManagerImpl::GetConstantFoldableTensors(
     const std::vector<TensorWithLayout*>& inputs) {
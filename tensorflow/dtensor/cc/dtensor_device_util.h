@@ -24,6 +24,7 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/memory/memory.h"
 #include "llvm/Support/ExtensibleRTTI.h"
 #include "mlir/IR/BuiltinOps.h"  // from @llvm-project
@@ -478,8 +479,41 @@ class ExecutableManagerImpl {
   tensorflow::Fprint128 CacheKeyForDTensorOperation(
       const DTensorOperation& doperation) const;
 
+  // Fingerprint of the body of a function and of the functions it calls,
+  // ignoring the function names. Retracing a tf.function creates new
+  // functions with new names, this lets the retraced functions share cache
+  // entries with the previous traces when their bodies are identical.
+  tensorflow::Fprint128 FunctionFingerprint(
+      const FunctionDef& function_def,
+      const FunctionLibraryDefinition& flib_def);
+
  private:
   ExecutableManagerImpl() = default;
+
+  // Records of a function and of the functions it calls, by name. A null
+  // record stands for a name that wasn't in the library.
+  using FunctionRecords =
+      absl::flat_hash_map<std::string, core::RefCountPtr<FunctionRecord>>;
+
+  tensorflow::Fprint128 FunctionFingerprint(
+      const FunctionDef& function_def,
+      const FunctionLibraryDefinition& flib_def, int depth,
+      FunctionRecords* dependencies);
+
+  struct FunctionFingerprintEntry {
+    // The fingerprint is valid while `flib_def` still maps these names to
+    // these records. Holding the records also keeps their FunctionDefs from
+    // being freed and their addresses from being reused.
+    FunctionRecords dependencies;
+    tensorflow::Fprint128 fingerprint;
+  };
+
+  mutex function_fingerprints_mu_;
+  // Maps function names to the fingerprint of their body. Cleared when it
+  // reaches kMaxFunctionFingerprints entries.
+  absl::flat_hash_map<std::string, FunctionFingerprintEntry>
+      function_fingerprints_ TF_GUARDED_BY(function_fingerprints_mu_);
+  static constexpr int kMaxFunctionFingerprints = 1024;
 };
 
 struct ExecutionManagerStats {
@@ -515,10 +549,13 @@ class ExecutableManager : public tsl::core::WeakRefCounted {
   // Returns a nullptr for the lowered executable if there is a cache miss.
   // Upon a cache miss, this will save some metadata about the function
   // and the small inputs to keep track of information for constant folding.
+  // If `flib_def` is set, functions are keyed by their body rather than by
+  // their name, see ExecutableManagerImpl::FunctionFingerprint.
   StatusOr<std::pair<tensorflow::Fprint128, const T*>> GetCachedExecutable(
       const DTensorOperation& doperation, const NameAttrList& attributes,
       const std::vector<TensorWithLayout*>& inputs,
-      const std::vector<const Layout*>& output_layouts);
+      const std::vector<const Layout*>& output_layouts,
+      const FunctionLibraryDefinition* flib_def = nullptr);
 
   // Returns the cached lowered graph for the function.
   // Returns a nullptr for the lowered graph if there is a cache miss.
@@ -552,7 +589,8 @@ class ExecutableManager : public tsl::core::WeakRefCounted {
   StatusOr<tensorflow::Fprint128> CacheKeyForGraph(
       const DTensorOperation& doperation, const NameAttrList& attributes,
       const std::vector<TensorWithLayout*>& inputs,
-      const std::vector<const Layout*>& output_layouts);
+      const std::vector<const Layout*>& output_layouts,
+      const FunctionLibraryDefinition* flib_def);
 
   // Returns true for a missing entry in the small inputs cache.
   bool UpdateDTensorOpAndSmallInputsCache(
@@ -636,7 +674,7 @@ Status InsertFunctionForTPUEmbeddingCheckpoint(
 // Cache key computation should consider all features of an op that affects
 // the SPMD lowering. The cache keys of two ops must be different if the
 // translated functions are different.
-// - op name and attr
+// - op name and attr, or the function body for functions
 // - input shapes and layouts
 // - default layout of outputs.
 // - default mesh.
@@ -645,10 +683,21 @@ template <typename T>
 StatusOr<tensorflow::Fprint128> ExecutableManager<T>::CacheKeyForGraph(
     const DTensorOperation& doperation, const NameAttrList& attributes,
     const std::vector<TensorWithLayout*>& inputs,
-    const std::vector<const Layout*>& output_layouts) {
-  tensorflow::Fprint128 cache_key = tensorflow::Fingerprint128(doperation.name);
+    const std::vector<const Layout*>& output_layouts,
+    const FunctionLibraryDefinition* flib_def) {
+  tensorflow::Fprint128 cache_key;
   std::string serialized;
-  SerializeToStringDeterministic(attributes, &serialized);
+  if (doperation.is_func() && flib_def != nullptr) {
+    cache_key = executable_manager_impl_.FunctionFingerprint(
+        *doperation.function_def, *flib_def);
+    // The attributes carry the function name too.
+    NameAttrList unnamed_attributes = attributes;
+    unnamed_attributes.clear_name();
+    SerializeToStringDeterministic(unnamed_attributes, &serialized);
+  } else {
+    cache_key = tensorflow::Fingerprint128(doperation.name);
+    SerializeToStringDeterministic(attributes, &serialized);
+  }
   cache_key =
       FingerprintCat128(cache_key, tensorflow::Fingerprint128(serialized));
   cache_key = FingerprintCat128(
@@ -683,10 +732,11 @@ StatusOr<std::pair<tensorflow::Fprint128, const T*>>
 ExecutableManager<T>::GetCachedExecutable(
     const DTensorOperation& doperation, const NameAttrList& attributes,
     const std::vector<TensorWithLayout*>& inputs,
-    const std::vector<const Layout*>& output_layouts) {
-  TF_ASSIGN_OR_RETURN(
-      tensorflow::Fprint128 cache_key,
-      CacheKeyForGraph(doperation, attributes, inputs, output_layouts));
+    const std::vector<const Layout*>& output_layouts,
+    const FunctionLibraryDefinition* flib_def) {
+  TF_ASSIGN_OR_RETURN(tensorflow::Fprint128 cache_key,
+                      CacheKeyForGraph(doperation, attributes, inputs,
+                                       output_layouts, flib_def));
 
   {
     mutex_lock lock(mu_);
@@ -706,8 +756,9 @@ ExecutableManager<T>::GetCachedExecutable(
   }
   // Generate a new cache key since we updated small const inputs which change
   // the cache key.
-  TF_ASSIGN_OR_RETURN(cache_key, CacheKeyForGraph(doperation, attributes,
-                                                  inputs, output_layouts));
+  TF_ASSIGN_OR_RETURN(cache_key,
+                      CacheKeyForGraph(doperation, attributes, inputs,
+                                       output_layouts, flib_def));
 
   stats_.misses++;
   return {{cache_key, nullptr}};
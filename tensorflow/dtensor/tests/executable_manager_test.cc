@@ -18,7 +18,10 @@ limitations under the License.
 #include "mlir/IR/BuiltinOps.h"  // from @llvm-project
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/function.pb.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/dtensor/cc/dtensor_device_util.h"
+#include "tensorflow/tsl/lib/core/status_test_util.h"
 #include "tensorflow/tsl/platform/errors.h"
 #include "tensorflow/tsl/platform/status_matchers.h"
 
@@ -36,7 +39,38 @@ class ExecutableManagerTest : public ::testing::Test {
     return DTensorOperation{"test_fn", nullptr, empty_mesh_, {}};
   }
 
+  // Returns the cache key of a call to the function `name` of `flib_def_`.
+  tensorflow::Fprint128 FunctionCacheKey(const std::string& name) {
+    DTensorOperation doperation{name.c_str(), flib_def_.Find(name),
+                                empty_mesh_, stack_traces_};
+    NameAttrList func_attr;
+    func_attr.set_name(name);
+    auto result = function_manager_->GetCachedExecutable(
+        doperation, func_attr, {}, {}, &flib_def_);
+    TF_CHECK_OK(result.status());
+    EXPECT_EQ(result->second, nullptr);
+    return result->first;
+  }
+
+  // Returns a function computing `op` of its input.
+  static FunctionDef UnaryFunction(const std::string& name,
+                                   const std::string& op) {
+    return FunctionDefHelper::Create(
+        name, {"x: float"}, {"y: float"}, {},
+        {{{"op"}, op, {"x"}, {{"T", DT_FLOAT}}}}, {{"y", "op:y:0"}});
+  }
+
+  // Returns a function calling the function `callee` on its input.
+  static FunctionDef CallerFunction(const std::string& name,
+                                    const std::string& callee) {
+    return FunctionDefHelper::Create(name, {"x: float"}, {"y: float"}, {},
+                                     {{{"call"}, callee, {"x"}}},
+                                     {{"y", "call:y:0"}});
+  }
+
   Mesh empty_mesh_ = Mesh::Empty();
+  StackTracesMap stack_traces_;
+  FunctionLibraryDefinition flib_def_{OpRegistry::Global(), {}};
 
   core::RefCountPtr<ExecutableManager<ExecutionFunctions>> function_manager_{
       new ExecutableManager<ExecutionFunctions>()};
@@ -61,6 +95,41 @@ TEST_F(ExecutableManagerTest, GetCachedExecutableUnavailable) {
   EXPECT_THAT(result, StatusIs(UNAVAILABLE));
 }
 
+TEST_F(ExecutableManagerTest, FunctionCacheKeyIgnoresFunctionName) {
+  TF_ASSERT_OK(flib_def_.AddFunctionDef(UnaryFunction("neg_1", "Neg")));
+  TF_ASSERT_OK(flib_def_.AddFunctionDef(UnaryFunction("neg_2", "Neg")));
+  TF_ASSERT_OK(flib_def_.AddFunctionDef(UnaryFunction("abs", "Abs")));
+
+  EXPECT_TRUE(FunctionCacheKey("neg_1") == FunctionCacheKey("neg_2"));
+  EXPECT_FALSE(FunctionCacheKey("neg_1") == FunctionCacheKey("abs"));
+}
+
+TEST_F(ExecutableManagerTest, FunctionCacheKeyFollowsRedefinition) {
+  TF_ASSERT_OK(flib_def_.AddFunctionDef(UnaryFunction("f", "Neg")));
+  const tensorflow::Fprint128 neg_key = FunctionCacheKey("f");
+  EXPECT_TRUE(FunctionCacheKey("f") == neg_key);
+
+  TF_ASSERT_OK(flib_def_.ReplaceFunction("f", UnaryFunction("f", "Abs")));
+  const tensorflow::Fprint128 abs_key = FunctionCacheKey("f");
+  EXPECT_FALSE(abs_key == neg_key);
+
+  // Removing and adding the function again also invalidates the fingerprint.
+  TF_ASSERT_OK(flib_def_.RemoveFunction("f"));
+  TF_ASSERT_OK(flib_def_.AddFunctionDef(UnaryFunction("f", "Neg")));
+  EXPECT_TRUE(FunctionCacheKey("f") == neg_key);
+}
+
+TEST_F(ExecutableManagerTest, FunctionCacheKeyFollowsCalleeRedefinition) {
+  TF_ASSERT_OK(flib_def_.AddFunctionDef(UnaryFunction("callee", "Neg")));
+  TF_ASSERT_OK(flib_def_.AddFunctionDef(CallerFunction("caller", "callee")));
+  const tensorflow::Fprint128 neg_key = FunctionCacheKey("caller");
+
+  // Only the callee changes.
+  TF_ASSERT_OK(
+      flib_def_.ReplaceFunction("callee", UnaryFunction("callee", "Abs")));
+  EXPECT_FALSE(FunctionCacheKey("caller") == neg_key);
+}
+
 }  // namespace
 }  // namespace dtensor
 }  // namespace tensorflow
@@ -97,6 +97,11 @@ class MMAPAllocation : public Allocation {
 
   static bool IsSupported();
 
+  /// Hints the OS that the `bytes` bytes at `data`, which must lie within the
+  /// mapped region, will be read soon so that they are paged in ahead of
+  /// use. This is a best-effort no-op where unsupported.
+  void Prefetch(const void* data, size_t bytes) const;
+
  protected:
   // Data required for mmap.
   int mmap_fd_ = -1;  // mmap file descriptor
@@ -62,6 +62,87 @@ std::intptr_t ArenaPlanner::BasePointer(TfLiteAllocationType type) {
   return 0;
 }
 
+void ArenaPlanner::SetOfflineMemoryPlans(std::vector<ArenaMemoryPlan> plans) {
+  offline_memory_plans_ = std::move(plans);
+}
+
+TfLiteStatus ArenaPlanner::ComputeOfflineMemoryPlan(ArenaMemoryPlan* plan) {
+  const size_t num_tensors = graph_info_->num_tensors();
+  TF_LITE_ENSURE(context_, allocs_.size() >= num_tensors);
+  TfLiteTensor* tensors = graph_info_->tensors();
+  plan->assign(num_tensors, {0, -1});
+  // Allocations of the tensors owning their buffer in the non-persistent
+  // arena, in tensor index order.
+  std::vector<ArenaAllocWithUsageInterval> owned_allocs;
+  for (int i = 0; i < static_cast<int>(num_tensors); ++i) {
+    TF_LITE_ENSURE(context_, tensors[i].bytes <=
+                                 std::numeric_limits<int32_t>::max());
+    (*plan)[i].first = static_cast<int32_t>(tensors[i].bytes);
+    if (tensors[i].allocation_type == kTfLiteArenaRw &&
+        allocs_[i].tensor == i && allocs_[i].size > 0 &&
+        actual_tensor_id_.find(i) == actual_tensor_id_.end()) {
+      owned_allocs.push_back(allocs_[i]);
+    }
+  }
+
+  const auto arena_size =
+      [](const std::vector<ArenaAllocWithUsageInterval>& allocs) {
+        size_t size = 0;
+        for (const auto& alloc : allocs) {
+          size = std::max(size, alloc.offset + alloc.size);
+        }
+        return size;
+      };
+  using AllocOrder = bool (*)(const ArenaAllocWithUsageInterval&,
+                              const ArenaAllocWithUsageInterval&);
+  const AllocOrder orders[] = {
+      // Largest first, as done at runtime.
+      [](const ArenaAllocWithUsageInterval& a,
+         const ArenaAllocWithUsageInterval& b) { return a.size > b.size; },
+      // Longest lived first.
+      [](const ArenaAllocWithUsageInterval& a,
+         const ArenaAllocWithUsageInterval& b) {
+        return int64_t{a.last_node} - a.first_node >
+               int64_t{b.last_node} - b.first_node;
+      },
+      // Largest size times lifetime first.
+      [](const ArenaAllocWithUsageInterval& a,
+         const ArenaAllocWithUsageInterval& b) {
+        return static_cast<double>(a.size) *
+                   (int64_t{a.last_node} - a.first_node + 1) >
+               static_cast<double>(b.size) *
+                   (int64_t{b.last_node} - b.first_node + 1);
+      },
+      // In order of first use.
+      [](const ArenaAllocWithUsageInterval& a,
+         const ArenaAllocWithUsageInterval& b) {
+        return a.first_node < b.first_node;
+      },
+  };
+  std::vector<ArenaAllocWithUsageInterval> best_allocs = owned_allocs;
+  size_t best_size = arena_size(best_allocs);
+  for (const AllocOrder order : orders) {
+    std::vector<ArenaAllocWithUsageInterval> allocs = owned_allocs;
+    std::stable_sort(allocs.begin(), allocs.end(), order);
+    SimpleMemoryArena arena(kDefaultArenaAlignment);
+    for (auto& alloc : allocs) {
+      TF_LITE_ENSURE_STATUS(arena.Allocate(
+          context_, tensor_alignment_, alloc.size, alloc.tensor,
+          alloc.first_node, alloc.last_node, &alloc));
+    }
+    const size_t size = arena_size(allocs);
+    if (size < best_size) {
+      best_size = size;
+      best_allocs = std::move(allocs);
+    }
+  }
+  TF_LITE_ENSURE(context_, best_size <= std::numeric_limits<int32_t>::max());
+  for (const auto& alloc : best_allocs) {
+    (*plan)[alloc.tensor].second = static_cast<int32_t>(alloc.offset);
+  }
+  return kTfLiteOk;
+}
+
 TfLiteStatus ArenaPlanner::ResetAllocations() {
   TF_LITE_ENSURE_STATUS(arena_.ClearPlan());
   TF_LITE_ENSURE_STATUS(persistent_arena_.ClearPlan());
@@ -510,7 +591,24 @@ TfLiteStatus ArenaPlanner::CalculateAllocations(
     last_active_node_ = last_node;
     return kTfLiteOk;
   }
-  if (first_node < last_active_node_) {
+  // An offline plan places all the arena tensors of the subgraph at once, so
+  // it can only be adopted when every node is being allocated.
+  const ArenaMemoryPlan* offline_plan = nullptr;
+  if (first_node == 0 &&
+      last_node + 1 == static_cast<int>(graph_info_->num_execution_nodes())) {
+    offline_plan = FindOfflineMemoryPlan(tensors_to_allocate);
+  }
+  if (offline_plan != nullptr) {
+    // Tensors keeping their previous allocation could overlap planned ones.
+    tensors_allocated->clear();
+    for (const auto& tensor_index : tensors_to_allocate) {
+      const TfLiteAllocationType type = tensors[tensor_index].allocation_type;
+      if (type == kTfLiteArenaRw || type == kTfLiteArenaRwPersistent) {
+        tensors_allocated->push_back(tensor_index);
+      }
+    }
+  }
+  if (first_node < last_active_node_ || offline_plan != nullptr) {
     arena_.ResetAllocs();
     last_active_node_ = first_node;
   } else {
@@ -542,10 +640,20 @@ TfLiteStatus ArenaPlanner::CalculateAllocations(
       }
     }
     if (tensor.allocation_type == kTfLiteArenaRw) {
-      TF_LITE_ENSURE_STATUS(
-          arena_.Allocate(context_, tensor_alignment_, tensor.bytes,
-                          tensor_index, alloc_node_[tensor_index],
-                          dealloc_node_[tensor_index], &allocs_[tensor_index]));
+      const bool planned =
+          offline_plan != nullptr &&
+          (*offline_plan)[tensor_index].second >= 0 &&
+          arena_.AllocateAt(tensor_alignment_, tensor.bytes, tensor_index,
+                            alloc_node_[tensor_index],
+                            dealloc_node_[tensor_index],
+                            (*offline_plan)[tensor_index].second,
+                            &allocs_[tensor_index]) == kTfLiteOk;
+      if (!planned) {
+        TF_LITE_ENSURE_STATUS(arena_.Allocate(
+            context_, tensor_alignment_, tensor.bytes, tensor_index,
+            alloc_node_[tensor_index], dealloc_node_[tensor_index],
+            &allocs_[tensor_index]));
+      }
     }
     // Check allocs_[].size to prevent from reallocation of persistent tensors.
     // Only allocate ArenaRwPersistent tensors which own their buffer.
@@ -564,6 +672,25 @@ TfLiteStatus ArenaPlanner::CalculateAllocations(
   return kTfLiteOk;
 }
 
+const ArenaMemoryPlan* ArenaPlanner::FindOfflineMemoryPlan(
+    const std::vector<int32_t>& tensors_to_allocate) {
+  const TfLiteTensor* tensors = graph_info_->tensors();
+  for (const ArenaMemoryPlan& plan : offline_memory_plans_) {
+    if (plan.size() != graph_info_->num_tensors()) continue;
+    const bool sizes_match = std::all_of(
+        tensors_to_allocate.begin(), tensors_to_allocate.end(),
+        [&](int32_t tensor_index) {
+          const TfLiteTensor& tensor = tensors[tensor_index];
+          return tensor.allocation_type != kTfLiteArenaRw ||
+                 (plan[tensor_index].first >= 0 &&
+                  static_cast<size_t>(plan[tensor_index].first) ==
+                      tensor.bytes);
+        });
+    if (sizes_match) return &plan;
+  }
+  return nullptr;
+}
+
 bool AreTensorsAllocatedInSameArena(int32_t root_tensor_index,
                                     int32_t tensor_index,
                                     const TfLiteTensor* tensors) {
@@ -22,6 +22,7 @@ limitations under the License.
 #include <vector>
 
 #include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/experimental/remat/metadata_util.h"
 #include "tensorflow/lite/graph_info.h"
 #include "tensorflow/lite/memory_planner.h"
 #include "tensorflow/lite/simple_memory_arena.h"
@@ -72,6 +73,20 @@ class ArenaPlanner : public MemoryPlanner {
   // Returns the base arena location for a given allocation type.
   std::intptr_t BasePointer(TfLiteAllocationType type);
 
+  // Sets the offline memory plans of this subgraph, e.g. read from the model
+  // metadata. When the tensors of all nodes are (re)allocated at once and the
+  // tensor sizes match those of a plan, tensors are placed at the offsets of
+  // that plan instead of the ones found by the greedy search. A tensor whose
+  // planned offset turns out to be unusable falls back to the greedy search.
+  void SetOfflineMemoryPlans(std::vector<ArenaMemoryPlan> plans);
+
+  // Computes an offline memory plan for the current tensor sizes and usage
+  // intervals, suitable for storing in the model metadata. This tries several
+  // placement orders, which is too slow to do at runtime, and keeps the one
+  // needing the smallest arena; the result is never larger than the current
+  // allocation. ExecuteAllocations must have been called on all nodes.
+  TfLiteStatus ComputeOfflineMemoryPlan(ArenaMemoryPlan* plan);
+
  private:
   // Check whether the input tensor's memory may be shared the output tensor.
   // tensor_changed: true if the output tensor modifies the tensor data. For
@@ -120,6 +135,11 @@ class ArenaPlanner : public MemoryPlanner {
   // Return the index of the tensor owing `tensor_index's` buffer.
   int FindSharedTensor(int tensor_index);
 
+  // Returns the offline memory plan whose tensor sizes match those of the
+  // arena tensors in `tensors_to_allocate`, or nullptr if there is none.
+  const ArenaMemoryPlan* FindOfflineMemoryPlan(
+      const std::vector<int32_t>& tensors_to_allocate);
+
   TfLiteContext* context_;
   std::unique_ptr<GraphInfo> graph_info_;
 
@@ -164,6 +184,9 @@ class ArenaPlanner : public MemoryPlanner {
 
   // Store number of references to each tensor.
   std::vector<int> refcounts_;
+
+  // Offline memory plans for this subgraph, see SetOfflineMemoryPlans.
+  std::vector<ArenaMemoryPlan> offline_memory_plans_;
 };
 
 }  // namespace tflite
@@ -959,6 +959,80 @@ TEST_F(ArenaPlannerTest, DebugTensors) {
   EXPECT_EQ(tensorOffsets.size(), 8);
 }
 
+TEST_F(ArenaPlannerTest, OfflineMemoryPlan) {
+  TestGraph graph({0, 1},
+                  {
+                      /* in, out, tmp */
+                      {{0, 1}, {2}, {}},     // First op
+                      {{2, 0}, {4, 5}, {}},  // Second op
+                      {{4, 5}, {3}, {}}      // Third op
+                  },
+                  {3});
+  SetGraph(&graph);
+  // Tensor sizes are (i + 1) * 3; tensor 3 reuses the buffer of tensor 2.
+  ArenaMemoryPlan plan = {{3, 0}, {6, 4}, {9, 12}, {12, 12}, {15, 24},
+                          {18, 40}};
+  planner_->SetOfflineMemoryPlans({{{3, 0}}, plan});
+  Execute(0, graph.nodes().size() - 1);
+  for (int i = 0; i < plan.size(); ++i) {
+    EXPECT_EQ(GetOffset(i), plan[i].second) << i;
+  }
+
+  // A plan whose sizes don't match is ignored.
+  SetGraph(&graph);
+  plan[4].first = 16;
+  planner_->SetOfflineMemoryPlans({plan});
+  Execute(0, graph.nodes().size() - 1);
+  EXPECT_EQ(GetOffset(5), 12);
+
+  // Planned offsets overlapping live tensors fall back to the greedy search.
+  SetGraph(&graph);
+  plan[4] = {15, 40};
+  planner_->SetOfflineMemoryPlans({plan});
+  Execute(0, graph.nodes().size() - 1);
+  EXPECT_EQ(GetOffset(5), 40);
+  EXPECT_TRUE(GetOffsetAfter(4) <= GetOffset(5) ||
+              GetOffset(4) >= GetOffsetAfter(5));
+}
+
+TEST_F(ArenaPlannerTest, ComputeOfflineMemoryPlan) {
+  TestGraph graph({0, 1},
+                  {
+                      /* in, out, tmp */
+                      {{0, 1}, {2}, {}},      // First op
+                      {{2, 0}, {4, 5}, {7}},  // Second op
+                      {{4, 5}, {3}, {}},      // Third op
+                      {{3}, {6}, {}}          // Fourth op
+                  },
+                  {6});
+  SetGraph(&graph);
+  Execute(0, graph.nodes().size() - 1);
+  size_t greedy_arena_size = 0;
+  for (int i = 0; i < graph.tensors()->size(); ++i) {
+    greedy_arena_size = std::max<size_t>(greedy_arena_size,
+                                         GetOffset(i) + (i + 1) * 3);
+  }
+  ArenaMemoryPlan plan;
+  ASSERT_EQ(planner_->ComputeOfflineMemoryPlan(&plan), kTfLiteOk);
+  ASSERT_EQ(plan.size(), graph.tensors()->size());
+  size_t planned_arena_size = 0;
+  for (int i = 0; i < plan.size(); ++i) {
+    EXPECT_EQ(plan[i].first, (i + 1) * 3);
+    ASSERT_GE(plan[i].second, 0);
+    planned_arena_size =
+        std::max<size_t>(planned_arena_size, plan[i].second + plan[i].first);
+  }
+  EXPECT_LE(planned_arena_size, greedy_arena_size);
+
+  // The computed plan is adopted as is.
+  SetGraph(&graph);
+  planner_->SetOfflineMemoryPlans({plan});
+  Execute(0, graph.nodes().size() - 1);
+  for (int i = 0; i < plan.size(); ++i) {
+    EXPECT_EQ(GetOffset(i), plan[i].second) << i;
+  }
+}
+
 TEST_F(ArenaPlannerTest, SimpleProfilerTest) {
   gNumAlloc = 0;
   gNumDealloc = 0;
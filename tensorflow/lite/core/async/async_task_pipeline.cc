@@ -0,0 +1,80 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/core/async/async_task_pipeline.h"
+
+#include "tensorflow/lite/core/async/async_signature_runner.h"
+#include "tensorflow/lite/core/async/c/types.h"
+#include "tensorflow/lite/core/async/task_internal.h"
+#include "tensorflow/lite/core/c/c_api_types.h"
+#include "tensorflow/lite/minimal_logging.h"
+
+namespace tflite {
+namespace async {
+
+AsyncTaskPipeline::AsyncTaskPipeline(AsyncSignatureRunner* runner,
+                                     int num_tasks)
+    : runner_(runner) {
+  for (int i = 0; i < num_tasks; ++i) {
+    tasks_.push_back(runner_->CreateTask());
+  }
+}
+
+AsyncTaskPipeline::~AsyncTaskPipeline() {
+  while (num_in_flight_ > 0) {
+    WaitOldest(nullptr);
+  }
+  for (TfLiteExecutionTask* task : tasks_) {
+    runner_->Finish(task);
+  }
+}
+
+TfLiteExecutionTask* AsyncTaskPipeline::NextTask() const {
+  if (num_in_flight_ == num_tasks()) return nullptr;
+  return tasks_[next_];
+}
+
+TfLiteStatus AsyncTaskPipeline::InvokeAsync() {
+  TfLiteExecutionTask* task = NextTask();
+  if (task == nullptr) {
+    TFLITE_LOG(tflite::TFLITE_LOG_ERROR,
+               "All the tasks of the pipeline are in flight.");
+    return kTfLiteError;
+  }
+  if (runner_->InvokeAsync(task) != kTfLiteOk) {
+    // The task is marked as scheduled even if the backend failed to schedule
+    // it; reset it so that it can be scheduled again.
+    task->task->SetScheduled(false);
+    return kTfLiteError;
+  }
+  next_ = (next_ + 1) % num_tasks();
+  ++num_in_flight_;
+  return kTfLiteOk;
+}
+
+TfLiteStatus AsyncTaskPipeline::WaitOldest(TfLiteExecutionTask** task) {
+  if (num_in_flight_ == 0) {
+    TFLITE_LOG(tflite::TFLITE_LOG_ERROR,
+               "No execution of the pipeline is in flight.");
+    return kTfLiteError;
+  }
+  TfLiteExecutionTask* oldest =
+      tasks_[(next_ - num_in_flight_ + num_tasks()) % num_tasks()];
+  --num_in_flight_;
+  if (task != nullptr) *task = oldest;
+  return runner_->Wait(oldest);
+}
+
+}  // namespace async
+}  // namespace tflite
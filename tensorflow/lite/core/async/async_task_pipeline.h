@@ -0,0 +1,110 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_CORE_ASYNC_ASYNC_TASK_PIPELINE_H_
+#define TENSORFLOW_LITE_CORE_ASYNC_ASYNC_TASK_PIPELINE_H_
+
+#include <vector>
+
+#include "tensorflow/lite/core/async/async_signature_runner.h"
+#include "tensorflow/lite/core/async/c/types.h"
+#include "tensorflow/lite/core/c/c_api_types.h"
+
+namespace tflite {
+namespace async {
+
+// WARNING: Experimental interface, subject to change
+//
+// Pipelines several executions of an AsyncSignatureRunner, e.g. so that the
+// preprocessing of a camera frame overlaps with the execution of the previous
+// frames on the backend.
+//
+// The pipeline owns a fixed set of tasks, used in turn. The application binds
+// the I/O buffers (and synchronizations) of each task once, so every task has
+// its own buffers that are reused by all of its executions. Up to
+// `num_tasks()` executions can be in flight, and they are waited for in the
+// order they were scheduled:
+//
+//   AsyncTaskPipeline pipeline(runner, 3);
+//   for (int i = 0; i < pipeline.num_tasks(); ++i) {
+//     TfLiteExecutionTaskSetBuffer(pipeline.task(i), ...);
+//   }
+//   while (...) {
+//     if (pipeline.NextTask() == nullptr) {
+//       pipeline.WaitOldest(&task);
+//       // Consume the outputs of `task`.
+//     }
+//     // Fill the inputs of pipeline.NextTask().
+//     pipeline.InvokeAsync();
+//   }
+//
+// The runner must be prepared (see AsyncSignatureRunner::PrepareBackends)
+// before the pipeline is created, and must outlive it.
+// This class is not thread safe.
+class AsyncTaskPipeline {
+ public:
+  // Creates `num_tasks` tasks on `runner`. `num_tasks` should be positive.
+  AsyncTaskPipeline(AsyncSignatureRunner* runner, int num_tasks);
+
+  // Waits for all executions in flight and finishes all tasks.
+  ~AsyncTaskPipeline();
+
+  AsyncTaskPipeline(const AsyncTaskPipeline&) = delete;
+  AsyncTaskPipeline& operator=(const AsyncTaskPipeline&) = delete;
+
+  // Returns the number of tasks of the pipeline, i.e. the maximum number of
+  // executions in flight.
+  int num_tasks() const { return tasks_.size(); }
+
+  // Returns the task at `index`, to bind its I/O buffers and synchronizations.
+  TfLiteExecutionTask* task(int index) const { return tasks_[index]; }
+
+  // Returns the number of executions scheduled and not waited for yet.
+  int num_in_flight() const { return num_in_flight_; }
+
+  // Returns the task that the next call to InvokeAsync will schedule, so that
+  // the application can fill its inputs. Returns nullptr if all the tasks are
+  // in flight, in which case WaitOldest must be called first.
+  TfLiteExecutionTask* NextTask() const;
+
+  // Schedules an execution of the task returned by NextTask.
+  // Returns kTfLiteError if all the tasks are in flight or the backend failed
+  // to schedule the execution; the task is then not in flight.
+  TfLiteStatus InvokeAsync();
+
+  // Blocks until the oldest execution in flight finishes and sets `*task` to
+  // its task, if `task` isn't nullptr. The outputs of the task can be read
+  // until it is scheduled again, i.e. until `num_tasks()` executions later.
+  // Returns kTfLiteError if no execution is in flight or the execution failed.
+  TfLiteStatus WaitOldest(TfLiteExecutionTask** task);
+
+ private:
+  // Not owned.
+  AsyncSignatureRunner* runner_ = nullptr;
+
+  // Tasks of the pipeline, used in turn.
+  std::vector<TfLiteExecutionTask*> tasks_;
+
+  // Index in `tasks_` of the task to schedule next.
+  int next_ = 0;
+
+  // Number of executions in flight, which are those of the tasks preceding
+  // `next_`.
+  int num_in_flight_ = 0;
+};
+
+}  // namespace async
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_CORE_ASYNC_ASYNC_TASK_PIPELINE_H_
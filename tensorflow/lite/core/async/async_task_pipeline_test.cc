@@ -0,0 +1,160 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/core/async/async_task_pipeline.h"
+
+#include <memory>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/lite/core/async/async_signature_runner.h"
+#include "tensorflow/lite/core/async/c/task.h"
+#include "tensorflow/lite/core/async/c/types.h"
+#include "tensorflow/lite/core/async/testing/mock_async_kernel.h"
+#include "tensorflow/lite/core/async/testing/test_backend.h"
+#include "tensorflow/lite/core/c/c_api_types.h"
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/interpreter.h"
+#include "tensorflow/lite/core/kernels/builtin_op_kernels.h"
+
+using ::testing::_;
+using ::testing::Invoke;
+using ::testing::Return;
+
+namespace tflite {
+namespace async {
+
+class AsyncTaskPipelineTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    kernel_ = std::make_unique<::testing::NiceMock<testing::MockAsyncKernel>>();
+    backend_ = std::make_unique<testing::TestBackend>(kernel_->kernel());
+
+    interpreter_ = std::make_unique<Interpreter>();
+    interpreter_->AddTensors(2);
+    interpreter_->SetInputs({0});
+    interpreter_->SetOutputs({1});
+    TfLiteQuantizationParams quant;
+    interpreter_->SetTensorParametersReadWrite(0, kTfLiteFloat32, "x", {3},
+                                               quant);
+    interpreter_->SetTensorParametersReadWrite(1, kTfLiteFloat32, "a", {3},
+                                               quant);
+    TfLiteRegistration* reg = ops::builtin::Register_ADD();
+    void* builtin_data_1 = malloc(sizeof(int));
+    interpreter_->AddNodeWithParameters({0, 0}, {1}, nullptr, 0, builtin_data_1,
+                                        reg);
+    interpreter_->ModifyGraphWithDelegate(backend_->get_delegate());
+    runner_ = interpreter_->GetAsyncSignatureRunner(nullptr);
+
+    // Records the input buffer of each execution and of each wait.
+    ON_CALL(*kernel_, Eval(_, _, _))
+        .WillByDefault(Invoke([this](TfLiteOpaqueContext*, TfLiteOpaqueNode*,
+                                     TfLiteExecutionTask* task) {
+          evaluated_.push_back(TfLiteExecutionTaskGetBufferByIndex(task, 0));
+          return kTfLiteOk;
+        }));
+    ON_CALL(*kernel_, Wait(_, _))
+        .WillByDefault(
+            Invoke([this](TfLiteOpaqueContext*, TfLiteExecutionTask* task) {
+              waited_.push_back(TfLiteExecutionTaskGetBufferByIndex(task, 0));
+              return kTfLiteOk;
+            }));
+  }
+
+  // Binds input buffer `i` and output buffer `i + 100` to task `i`.
+  void BindBuffers(AsyncTaskPipeline& pipeline) {
+    for (int i = 0; i < pipeline.num_tasks(); ++i) {
+      TfLiteExecutionTaskSetBufferByIndex(pipeline.task(i), 0, i);
+      TfLiteExecutionTaskSetBufferByIndex(pipeline.task(i), 1, i + 100);
+    }
+  }
+
+  std::unique_ptr<::testing::NiceMock<testing::MockAsyncKernel>> kernel_;
+  std::unique_ptr<testing::TestBackend> backend_;
+  std::unique_ptr<Interpreter> interpreter_;
+  AsyncSignatureRunner* runner_ = nullptr;
+  std::vector<TfLiteBufferHandle> evaluated_;
+  std::vector<TfLiteBufferHandle> waited_;
+};
+
+TEST_F(AsyncTaskPipelineTest, TasksInFlight) {
+  AsyncTaskPipeline pipeline(runner_, 3);
+  ASSERT_EQ(3, pipeline.num_tasks());
+  BindBuffers(pipeline);
+
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(pipeline.task(i), pipeline.NextTask());
+    EXPECT_EQ(kTfLiteOk, pipeline.InvokeAsync());
+  }
+  EXPECT_EQ(3, pipeline.num_in_flight());
+  EXPECT_EQ(nullptr, pipeline.NextTask());
+  EXPECT_EQ(kTfLiteError, pipeline.InvokeAsync());
+  EXPECT_THAT(evaluated_, ::testing::ElementsAre(0, 1, 2));
+  EXPECT_TRUE(waited_.empty());
+
+  TfLiteExecutionTask* task = nullptr;
+  EXPECT_EQ(kTfLiteOk, pipeline.WaitOldest(&task));
+  EXPECT_EQ(pipeline.task(0), task);
+  EXPECT_EQ(100, TfLiteExecutionTaskGetBufferByIndex(task, 1));
+  EXPECT_EQ(pipeline.task(0), pipeline.NextTask());
+}
+
+TEST_F(AsyncTaskPipelineTest, WaitsInOrder) {
+  AsyncTaskPipeline pipeline(runner_, 2);
+  BindBuffers(pipeline);
+
+  // Keeps both tasks in flight for 5 executions.
+  for (int i = 0; i < 5; ++i) {
+    if (pipeline.NextTask() == nullptr) {
+      EXPECT_EQ(kTfLiteOk, pipeline.WaitOldest(nullptr));
+    }
+    EXPECT_EQ(kTfLiteOk, pipeline.InvokeAsync());
+  }
+  while (pipeline.num_in_flight() > 0) {
+    EXPECT_EQ(kTfLiteOk, pipeline.WaitOldest(nullptr));
+  }
+  EXPECT_EQ(kTfLiteError, pipeline.WaitOldest(nullptr));
+
+  EXPECT_THAT(evaluated_, ::testing::ElementsAre(0, 1, 0, 1, 0));
+  EXPECT_THAT(waited_, ::testing::ElementsAre(0, 1, 0, 1, 0));
+}
+
+TEST_F(AsyncTaskPipelineTest, FailedInvoke) {
+  AsyncTaskPipeline pipeline(runner_, 2);
+  BindBuffers(pipeline);
+
+  EXPECT_CALL(*kernel_, Eval(_, _, _)).WillOnce(Return(kTfLiteError));
+  EXPECT_EQ(kTfLiteError, pipeline.InvokeAsync());
+  EXPECT_EQ(0, pipeline.num_in_flight());
+  EXPECT_EQ(pipeline.task(0), pipeline.NextTask());
+
+  EXPECT_CALL(*kernel_, Eval(_, _, _)).WillOnce(Return(kTfLiteOk));
+  EXPECT_EQ(kTfLiteOk, pipeline.InvokeAsync());
+  EXPECT_EQ(1, pipeline.num_in_flight());
+}
+
+TEST_F(AsyncTaskPipelineTest, DestructorWaitsAndFinishes) {
+  EXPECT_CALL(*kernel_, Finish(_, _)).Times(2);
+  {
+    AsyncTaskPipeline pipeline(runner_, 2);
+    BindBuffers(pipeline);
+    EXPECT_EQ(kTfLiteOk, pipeline.InvokeAsync());
+    EXPECT_EQ(kTfLiteOk, pipeline.InvokeAsync());
+  }
+  EXPECT_THAT(waited_, ::testing::ElementsAre(0, 1));
+}
+
+}  // namespace async
+}  // namespace tflite
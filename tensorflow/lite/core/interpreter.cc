@@ -433,12 +433,35 @@ TfLiteStatus Interpreter::SetMetadata(
           &model_control_dependencies_)) {
     model_control_dependencies_.clear();
   }
+  const auto maybe_model_memory_plans =
+      metadata_.find(kModelMemoryPlansMetadataKey);
+  if (maybe_model_memory_plans == metadata_.end() ||
+      !ParseModelMemoryPlans(maybe_model_memory_plans->second.data(),
+                             maybe_model_memory_plans->second.size(),
+                             &model_memory_plans_)) {
+    model_memory_plans_.clear();
+  }
+  const auto maybe_model_remat_segments =
+      metadata_.find(kModelRematSegmentsMetadataKey);
+  if (maybe_model_remat_segments == metadata_.end() ||
+      !ParseModelRematSegments(maybe_model_remat_segments->second.data(),
+                               maybe_model_remat_segments->second.size(),
+                               &model_remat_segments_)) {
+    model_remat_segments_.clear();
+  }
   for (int subgraph_index = 0; subgraph_index < subgraphs_.size();
        ++subgraph_index) {
     TF_LITE_ENSURE_STATUS(subgraphs_[subgraph_index]->SetMetadata(
-        &metadata_, model_control_dependencies_.empty()
-                        ? nullptr
-                        : &model_control_dependencies_[subgraph_index]));
+        &metadata_,
+        model_control_dependencies_.empty()
+            ? nullptr
+            : &model_control_dependencies_[subgraph_index],
+        subgraph_index < model_memory_plans_.size()
+            ? &model_memory_plans_[subgraph_index]
+            : nullptr,
+        subgraph_index < model_remat_segments_.size()
+            ? &model_remat_segments_[subgraph_index]
+            : nullptr));
   }
   return kTfLiteOk;
 }
@@ -993,6 +993,18 @@ class Interpreter {
   // checks when dereferencing by subgraph and operator index) will take place.
   ModelControlDependencies model_control_dependencies_;
 
+  // Offline arena memory plans that are encoded in the metadata of the model,
+  // indexed by subgraph. Updated in SetMetadata; empty if there were none or
+  // they could not be parsed. A plan is only used by a subgraph's memory
+  // planner if its tensor sizes match, so no further consistency check is
+  // needed.
+  ModelMemoryPlans model_memory_plans_;
+
+  // Rematerialization segments that are encoded in the metadata of the model,
+  // indexed by subgraph. Updated in SetMetadata; empty if there were none or
+  // they could not be parsed. Subgraphs check the segments when applying them.
+  ModelRematSegments model_remat_segments_;
+
   // Flag indicating whether to continue or cancel in flight invocation.
   // If false, the in flight invocation will be cancelled.
   // Will be set true when application starts a new invocation.
@@ -326,10 +326,12 @@ class MallocDataAllocator : public BuiltinDataAllocator {
   void Deallocate(void* data) override { free(data); }
 };
 
-}  // namespace
-
-TfLiteStatus InterpreterBuilder::ParseNodes(
+// Adds the nodes of `operators` to `subgraph`. `registrations` maps the op code
+// indices of the model to their registrations.
+TfLiteStatus ParseOperators(
     const flatbuffers::Vector<flatbuffers::Offset<Operator>>* operators,
+    const std::vector<const TfLiteRegistration*>& registrations,
+    const Allocation* allocation, ErrorReporter* error_reporter,
     Subgraph* subgraph) {
   TfLiteStatus status = kTfLiteOk;
 
@@ -339,17 +341,16 @@ TfLiteStatus InterpreterBuilder::ParseNodes(
   for (int i = 0; i < operators->size(); ++i) {
     const auto* op = operators->Get(i);
     int index = op->opcode_index();
-    if (index < 0 || index >= flatbuffer_op_index_to_registration_.size()) {
-      TF_LITE_REPORT_ERROR(error_reporter_,
+    if (index < 0 || index >= registrations.size()) {
+      TF_LITE_REPORT_ERROR(error_reporter,
                            "Missing registration for opcode_index %d\n", index);
       status = kTfLiteError;
       continue;
     }
 
-    const TfLiteRegistration* registration =
-        flatbuffer_op_index_to_registration_[index];
+    const TfLiteRegistration* registration = registrations[index];
     if (registration == nullptr) {
-      TF_LITE_REPORT_ERROR(error_reporter_, "Skipping op for opcode_index %d\n",
+      TF_LITE_REPORT_ERROR(error_reporter, "Skipping op for opcode_index %d\n",
                            index);
       status = kTfLiteError;
       continue;
@@ -359,7 +360,7 @@ TfLiteStatus InterpreterBuilder::ParseNodes(
         static_cast<BuiltinOperator>(registration->builtin_code);
 
     if (op_type != BuiltinOperator_CUSTOM && op->custom_options()) {
-      TF_LITE_REPORT_ERROR(error_reporter_,
+      TF_LITE_REPORT_ERROR(error_reporter,
                            "Found builtin operator %s with custom options.\n",
                            EnumNameBuiltinOperator(op_type));
     }
@@ -372,12 +373,12 @@ TfLiteStatus InterpreterBuilder::ParseNodes(
             FlatBufferIntArrayToVector(op->intermediates()),
             reinterpret_cast<const char*>(op->custom_options()->data()),
             op->custom_options()->size(), nullptr, registration);
-      } else if (op->large_custom_options_offset() > 1 && allocation_) {
+      } else if (op->large_custom_options_offset() > 1 && allocation) {
         if (op->large_custom_options_offset() +
                 op->large_custom_options_size() >
-            allocation_->bytes()) {
+            allocation->bytes()) {
           TF_LITE_REPORT_ERROR(
-              error_reporter_,
+              error_reporter,
               "Custom Option Offset for opcode_index %d is out of bound\n",
               index);
           return kTfLiteError;
@@ -387,7 +388,7 @@ TfLiteStatus InterpreterBuilder::ParseNodes(
             FlatBufferIntArrayToVector(op->inputs()),
             FlatBufferIntArrayToVector(op->outputs()),
             FlatBufferIntArrayToVector(op->intermediates()),
-            reinterpret_cast<const char*>(allocation_->base()) +
+            reinterpret_cast<const char*>(allocation->base()) +
                 op->large_custom_options_offset(),
             op->large_custom_options_size(), nullptr, registration);
       } else {
@@ -400,7 +401,7 @@ TfLiteStatus InterpreterBuilder::ParseNodes(
     } else {
       void* builtin_data = nullptr;
       MallocDataAllocator malloc_allocator;
-      TF_LITE_ENSURE_STATUS(ParseOpData(op, op_type, error_reporter_,
+      TF_LITE_ENSURE_STATUS(ParseOpData(op, op_type, error_reporter,
                                         &malloc_allocator, &builtin_data));
       subgraph->AddNodeWithParameters(
           FlatBufferIntArrayToVector(op->inputs()),
@@ -413,6 +414,61 @@ TfLiteStatus InterpreterBuilder::ParseNodes(
   return status;
 }
 
+// Hints the OS to page in the read-only constant tensors of `subgraph` in the
+// order its nodes first use them, if they are memory mapped from `allocation`.
+void PrefetchConstantTensors(const Allocation* allocation,
+                             const Subgraph& subgraph) {
+  if (allocation == nullptr ||
+      allocation->type() != Allocation::Type::kMMap) {
+    return;
+  }
+  const auto* mmap_allocation = static_cast<const MMAPAllocation*>(allocation);
+  std::vector<bool> prefetched(subgraph.tensors_size(), false);
+  for (int node_index : subgraph.execution_plan()) {
+    const TfLiteNode& node = subgraph.node_and_registration(node_index)->first;
+    for (int i = 0; i < node.inputs->size; ++i) {
+      const int tensor_index = node.inputs->data[i];
+      if (tensor_index < 0 || prefetched[tensor_index]) continue;
+      prefetched[tensor_index] = true;
+      const TfLiteTensor* tensor = subgraph.tensor(tensor_index);
+      if (tensor->allocation_type == kTfLiteMmapRo) {
+        mmap_allocation->Prefetch(tensor->data.raw_const, tensor->bytes);
+      }
+    }
+  }
+}
+
+// Registrations of the op codes of a model, shared by the subgraphs whose
+// nodes are added after the InterpreterBuilder is gone.
+struct SharedRegistrations {
+  std::vector<TfLiteRegistration> storage;
+  std::vector<const TfLiteRegistration*> by_op_code_index;
+};
+
+std::shared_ptr<const SharedRegistrations> CopyRegistrations(
+    const std::vector<const TfLiteRegistration*>& registrations) {
+  auto copy = std::make_shared<SharedRegistrations>();
+  copy->storage.reserve(registrations.size());
+  for (const TfLiteRegistration* registration : registrations) {
+    copy->storage.push_back(registration ? *registration
+                                         : TfLiteRegistration{});
+  }
+  for (size_t i = 0; i < registrations.size(); ++i) {
+    copy->by_op_code_index.push_back(registrations[i] ? &copy->storage[i]
+                                                      : nullptr);
+  }
+  return copy;
+}
+
+}  // namespace
+
+TfLiteStatus InterpreterBuilder::ParseNodes(
+    const flatbuffers::Vector<flatbuffers::Offset<Operator>>* operators,
+    Subgraph* subgraph) {
+  return ParseOperators(operators, flatbuffer_op_index_to_registration_,
+                        allocation_, error_reporter_, subgraph);
+}
+
 TfLiteStatus InterpreterBuilder::ParseQuantization(
     const QuantizationParameters* src_quantization,
     TfLiteQuantization* quantization, const std::vector<int>& dims) {
@@ -834,6 +890,8 @@ TfLiteStatus InterpreterBuilder::operator()(
     telemetry_settings->subgraph_infos.resize(subgraphs->size());
   }
 
+  const bool defer_construction = options_.GetDeferSubgraphConstruction();
+  std::shared_ptr<const SharedRegistrations> shared_registrations;
   for (int subgraph_index = 0; subgraph_index < subgraphs->size();
        ++subgraph_index) {
     const tflite::SubGraph* subgraph = (*subgraphs)[subgraph_index];
@@ -866,8 +924,30 @@ TfLiteStatus InterpreterBuilder::operator()(
     if (ParseTensors(buffers, tensors, modified_subgraph, subgraph_info) !=
         kTfLiteOk)
       return cleanup_and_error();
-    if (operators && ParseNodes(operators, modified_subgraph) != kTfLiteOk)
-      return cleanup_and_error();
+    if (operators && defer_construction && subgraph_index > 0) {
+      if (!shared_registrations) {
+        shared_registrations =
+            CopyRegistrations(flatbuffer_op_index_to_registration_);
+      }
+      const Allocation* allocation = allocation_;
+      ErrorReporter* error_reporter = error_reporter_;
+      modified_subgraph->SetDeferredNodesBuilder(
+          [shared_registrations, operators, allocation,
+           error_reporter](Subgraph* deferred_subgraph) {
+            TF_LITE_ENSURE_STATUS(ParseOperators(
+                operators, shared_registrations->by_op_code_index, allocation,
+                error_reporter, deferred_subgraph));
+            PrefetchConstantTensors(allocation, *deferred_subgraph);
+            return kTfLiteOk;
+          });
+    } else if (operators) {
+      if (ParseNodes(operators, modified_subgraph) != kTfLiteOk) {
+        return cleanup_and_error();
+      }
+      if (defer_construction) {
+        PrefetchConstantTensors(allocation_, *modified_subgraph);
+      }
+    }
 
     std::vector<int> variables;
     for (int i = 0; i < modified_subgraph->tensors_size(); ++i) {
@@ -856,6 +856,56 @@ TEST(BasicFlatBufferModel, TestHandleModelWithWhileOpContainsForwardingInput) {
   ASSERT_EQ(interpreter->Invoke(), kTfLiteOk);
 }
 
+TEST(BasicFlatBufferModel, TestDeferSubgraphConstruction) {
+  const auto model_path = tensorflow::GetDataDependencyFilepath(
+      "tensorflow/lite/testdata/while_op_with_forwarding_input.bin");
+  std::unique_ptr<tflite::FlatBufferModel> model =
+      FlatBufferModel::BuildFromFile(model_path.c_str());
+  ASSERT_NE(model, nullptr);
+
+  // Runs the model and returns the contents of its first output.
+  auto run = [&model](bool defer_subgraph_construction, std::string* result) {
+    tflite::ops::builtin::BuiltinOpResolver resolver;
+    InterpreterOptions options;
+    options.SetDeferSubgraphConstruction(defer_subgraph_construction);
+    std::unique_ptr<Interpreter> interpreter;
+    ASSERT_EQ(InterpreterBuilder(*model, resolver, &options)(&interpreter),
+              kTfLiteOk);
+    ASSERT_NE(interpreter, nullptr);
+    ASSERT_GT(interpreter->subgraphs_size(), 1);
+    for (int i = 1; i < interpreter->subgraphs_size(); ++i) {
+      Subgraph* subgraph = interpreter->subgraph(i);
+      EXPECT_EQ(subgraph->HasDeferredNodes(), defer_subgraph_construction);
+      // The tensors are always created up front.
+      EXPECT_GT(subgraph->tensors_size(), 0);
+      if (defer_subgraph_construction) {
+        EXPECT_EQ(subgraph->nodes_size(), 0);
+      }
+    }
+
+    // The while op prepares its subgraphs, which adds their nodes.
+    ASSERT_EQ(interpreter->AllocateTensors(), kTfLiteOk);
+    for (int i = 1; i < interpreter->subgraphs_size(); ++i) {
+      EXPECT_FALSE(interpreter->subgraph(i)->HasDeferredNodes());
+      EXPECT_GT(interpreter->subgraph(i)->nodes_size(), 0);
+    }
+
+    interpreter->typed_tensor<int32_t>(0)[0] = 20;
+    DynamicBuffer buf;
+    buf.AddString("a", 1);
+    buf.WriteToTensor(interpreter->tensor(1), /*new_shape=*/nullptr);
+    ASSERT_EQ(interpreter->Invoke(), kTfLiteOk);
+    const TfLiteTensor* output = interpreter->output_tensor(0);
+    *result = std::string(output->data.raw_const, output->bytes);
+  };
+
+  std::string eager_result;
+  std::string deferred_result;
+  run(/*defer_subgraph_construction=*/false, &eager_result);
+  run(/*defer_subgraph_construction=*/true, &deferred_result);
+  EXPECT_EQ(deferred_result, eager_result);
+}
+
 TEST(BasicFlatBufferModel, TestHandleZeroSizeConstant) {
   TestErrorReporter reporter;
   FileCopyAllocation model_allocation(
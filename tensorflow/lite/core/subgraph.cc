@@ -38,6 +38,7 @@ limitations under the License.
 #include "tensorflow/lite/core/api/tensor_utils.h"
 #include "tensorflow/lite/core/c/c_api_types.h"
 #include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/experimental/remat/remat_planner.h"
 #include "tensorflow/lite/experimental/resource/resource_base.h"
 #include "tensorflow/lite/graph_info.h"
 #include "tensorflow/lite/memory_planner.h"
@@ -67,6 +68,25 @@ struct TfLiteQuantizationDeleter {
 using ScopedTfLiteQuantization =
     std::unique_ptr<TfLiteQuantization, TfLiteQuantizationDeleter>;
 
+// Returns a deep copy of `quantization`.
+TfLiteQuantization CopyQuantization(const TfLiteQuantization& quantization) {
+  TfLiteQuantization copy = {kTfLiteNoQuantization, nullptr};
+  if (quantization.type != kTfLiteAffineQuantization ||
+      quantization.params == nullptr) {
+    return copy;
+  }
+  const auto* params =
+      static_cast<const TfLiteAffineQuantization*>(quantization.params);
+  auto* copy_params = static_cast<TfLiteAffineQuantization*>(
+      malloc(sizeof(TfLiteAffineQuantization)));
+  copy_params->scale = TfLiteFloatArrayCopy(params->scale);
+  copy_params->zero_point = TfLiteIntArrayCopy(params->zero_point);
+  copy_params->quantized_dimension = params->quantized_dimension;
+  copy.type = kTfLiteAffineQuantization;
+  copy.params = copy_params;
+  return copy;
+}
+
 struct TfLiteSparsityDeleter {
   void operator()(TfLiteSparsity* s) {
     if (s) TfLiteSparsityFree(s);
@@ -308,7 +328,9 @@ void Subgraph::CleanupNode(int node_index) {
   TfLiteIntArrayFree(node.outputs);
   TfLiteIntArrayFree(node.temporaries);
   TfLiteIntArrayFree(node.intermediates);
-  if (node.builtin_data) free(node.builtin_data);
+  if (node.builtin_data && nodes_sharing_builtin_data_.count(node_index) == 0) {
+    free(node.builtin_data);
+  }
   OpFree(registration, node.user_data);
   node.builtin_data = nullptr;
 }
@@ -771,9 +793,14 @@ TfLiteStatus Subgraph::SetVariables(std::vector<int> variables) {
 
 TfLiteStatus Subgraph::SetMetadata(
     const std::map<std::string, std::string>* metadata,
-    const ControlEdges* control_edges) {
+    const ControlEdges* control_edges,
+    const std::vector<ArenaMemoryPlan>* memory_plans,
+    const std::vector<RematSegment>* remat_segments) {
   metadata_ = metadata;
   control_edges_ = control_edges;
+  memory_plans_ = memory_plans;
+  remat_segments_ = remat_segments;
+  if (!HasDeferredNodes()) ApplyMetadataRematSegments();
   return kTfLiteOk;
 }
 
@@ -880,6 +907,8 @@ TfLiteStatus Subgraph::AllocateTensors() {
     return kTfLiteError;
   }
 
+  TF_LITE_ENSURE_STATUS(EnsureNodesBuilt());
+
   // Restore delegation state if applicable.
   TF_LITE_ENSURE_STATUS(RedoAllDelegates());
 
@@ -920,6 +949,21 @@ TfLiteStatus Subgraph::AllocateTensors() {
 
   TF_LITE_ENSURE_STATUS(PrepareOpsAndTensors());
 
+  if (ShouldRematerializeForMemoryBudget()) {
+    remat_budget_planned_ = true;
+    // The tensor sizes are needed, so nodes after a dynamic tensor must have
+    // been prepared as well.
+    if (!has_dynamic_tensors_) {
+      const std::vector<RematSegment> segments =
+          PlanRematerialization(CreateGraphInfo().get(),
+                                options_->GetRematerializationMemoryBudget());
+      if (!segments.empty()) {
+        TF_LITE_ENSURE_STATUS(RematerializeSegments(segments));
+        return AllocateTensors();
+      }
+    }
+  }
+
   state_ = kStateInvokable;
 
   // Reset the variable tensors to zero after (re)allocating the tensors.
@@ -1431,9 +1475,13 @@ TfLiteStatus Subgraph::PrepareOpsAndTensors() {
 #ifdef TFLITE_USE_SIMPLE_MEMORY_PLANNER
     memory_planner_.reset(new SimplePlanner(&context_, CreateGraphInfo()));
 #else
-    memory_planner_ = std::make_unique<ArenaPlanner>(
+    auto arena_planner = std::make_unique<ArenaPlanner>(
         &context_, CreateGraphInfo(), ShouldPreserveAllTensors(),
         kDefaultTensorAlignment, subgraph_index_);
+    if (memory_plans_ != nullptr) {
+      arena_planner->SetOfflineMemoryPlans(*memory_plans_);
+    }
+    memory_planner_ = std::move(arena_planner);
 #endif
     memory_planner_->PlanAllocations();
   }
@@ -2085,6 +2133,11 @@ TfLiteStatus Subgraph::RedoAllDelegates() {
 }
 
 TfLiteStatus Subgraph::RemoveAllDelegates() {
+  if (HasDeferredNodes()) {
+    // Nothing was delegated yet.
+    deferred_delegates_.clear();
+    return kTfLiteOk;
+  }
   TF_LITE_ENSURE_STATUS(UndoAllDelegates());
   delegates_applied_.clear();
   delegates_undone_ = false;
@@ -2094,6 +2147,183 @@ TfLiteStatus Subgraph::RemoveAllDelegates() {
 
 bool Subgraph::HasDelegates() { return !delegates_applied_.empty(); }
 
+TfLiteStatus Subgraph::EnsureNodesBuilt() {
+  if (!HasDeferredNodes()) return kTfLiteOk;
+  TFLITE_SCOPED_TAGGED_DEFAULT_PROFILE(profiler_.get(), "BuildDeferredNodes");
+  // Cleared first so that the delegates below are applied right away.
+  auto nodes_builder = std::move(deferred_nodes_builder_);
+  deferred_nodes_builder_ = nullptr;
+  if (nodes_builder(this) != kTfLiteOk) {
+    consistent_ = false;
+    return kTfLiteError;
+  }
+  ApplyMetadataRematSegments();
+  std::vector<TfLiteDelegate*> delegates_to_apply;
+  deferred_delegates_.swap(delegates_to_apply);
+  for (TfLiteDelegate* delegate : delegates_to_apply) {
+    const TfLiteStatus status = ModifyGraphWithDelegateImpl(delegate);
+    if (status == kTfLiteError) return kTfLiteError;
+    if (status != kTfLiteOk) {
+      // The failed delegate removed the ones applied before it.
+      TFLITE_LOG(TFLITE_LOG_WARNING,
+                 "Failed to apply a delegate to subgraph %d after adding its "
+                 "deferred nodes, running it without delegates.",
+                 subgraph_index_);
+      break;
+    }
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus Subgraph::RematerializeSegments(
+    const std::vector<RematSegment>& segments) {
+  for (const RematSegment& segment : segments) {
+    TF_LITE_ENSURE_STATUS(RematerializeSegment(segment));
+  }
+  if (memory_planner_ && !segments.empty()) {
+    TF_LITE_ENSURE_STATUS(memory_planner_->PlanAllocations());
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus Subgraph::RematerializeSegment(const RematSegment& segment) {
+  if (!pre_delegation_execution_plan_.empty() ||
+      state_ == kStateInvokableAndImmutable) {
+    ReportError("Rematerialization isn't supported after delegation.");
+    return kTfLiteError;
+  }
+  const int segment_size = segment.end - segment.begin;
+  const auto begin_it = std::find(execution_plan_.begin(),
+                                  execution_plan_.end(), segment.begin);
+  const auto insert_it =
+      std::find(execution_plan_.begin(), execution_plan_.end(),
+                segment.insert_before);
+  const int begin_position = begin_it - execution_plan_.begin();
+  const int insert_position = insert_it - execution_plan_.begin();
+  bool valid = segment_size > 0 && begin_it != execution_plan_.end() &&
+               insert_it != execution_plan_.end() &&
+               insert_position >= begin_position + segment_size;
+  for (int i = 0; valid && i < segment_size; ++i) {
+    const int node_index = segment.begin + i;
+    valid = execution_plan_[begin_position + i] == node_index &&
+            IsRematerializable(nodes_and_registration_[node_index].first,
+                               nodes_and_registration_[node_index].second,
+                               tensors_.data());
+  }
+  if (!valid) {
+    ReportError("Cannot rematerialize nodes %d to %d before node %d.",
+                segment.begin, segment.end - 1, segment.insert_before);
+    return kTfLiteError;
+  }
+
+  // Adds a copy of each tensor written by the segment.
+  std::vector<int> outputs;
+  for (int node_index = segment.begin; node_index < segment.end;
+       ++node_index) {
+    const TfLiteIntArray* node_outputs =
+        nodes_and_registration_[node_index].first.outputs;
+    for (int i = 0; i < node_outputs->size; ++i) {
+      if (node_outputs->data[i] >= 0) outputs.push_back(node_outputs->data[i]);
+    }
+  }
+  int first_copy_index;
+  TF_LITE_ENSURE_STATUS(AddTensors(outputs.size(), &first_copy_index));
+  std::vector<int> copies(tensors_.size(), -1);
+  for (int i = 0; i < outputs.size(); ++i) {
+    const TfLiteTensor& output = tensors_[outputs[i]];
+    const std::vector<int> dims(output.dims->data,
+                                output.dims->data + output.dims->size);
+    std::vector<int> dims_signature;
+    if (output.dims_signature != nullptr) {
+      dims_signature.assign(
+          output.dims_signature->data,
+          output.dims_signature->data + output.dims_signature->size);
+    }
+    TF_LITE_ENSURE_STATUS(SetTensorParametersReadWrite(
+        first_copy_index + i, output.type, output.name, dims,
+        CopyQuantization(output.quantization), /*is_variable=*/false,
+        dims_signature));
+    copies[outputs[i]] = first_copy_index + i;
+  }
+  auto map_to_copies = [&copies](const TfLiteIntArray* tensor_indices) {
+    std::vector<int> mapped(tensor_indices->data,
+                            tensor_indices->data + tensor_indices->size);
+    for (int& tensor_index : mapped) {
+      if (tensor_index >= 0 && copies[tensor_index] >= 0) {
+        tensor_index = copies[tensor_index];
+      }
+    }
+    return mapped;
+  };
+
+  // Adds the recomputing nodes, which share the builtin data of the nodes
+  // they recompute. They are appended to the execution plan and moved below.
+  std::vector<int> copy_nodes;
+  for (int node_index = segment.begin; node_index < segment.end;
+       ++node_index) {
+    // Copied since adding a node may move the others.
+    const TfLiteNode node = nodes_and_registration_[node_index].first;
+    const TfLiteRegistration registration =
+        nodes_and_registration_[node_index].second;
+    const bool is_custom = registration.builtin_code == kTfLiteBuiltinCustom;
+    const char* init_data = static_cast<const char*>(
+        is_custom ? node.custom_initial_data : node.builtin_data);
+    int copy_node_index;
+    TF_LITE_ENSURE_STATUS(AddNodeWithParameters(
+        map_to_copies(node.inputs), map_to_copies(node.outputs),
+        std::vector<int>(node.intermediates->data,
+                         node.intermediates->data + node.intermediates->size),
+        init_data, is_custom ? node.custom_initial_data_size : 0,
+        /*builtin_data=*/nullptr, &registration, &copy_node_index));
+    nodes_and_registration_[copy_node_index].first.builtin_data =
+        node.builtin_data;
+    nodes_sharing_builtin_data_.insert(copy_node_index);
+    copy_nodes.push_back(copy_node_index);
+  }
+  execution_plan_.resize(execution_plan_.size() - copy_nodes.size());
+
+  // The node the segment is recomputed for and the ones after it read the
+  // copies.
+  for (int position = insert_position; position < execution_plan_.size();
+       ++position) {
+    TfLiteIntArray* inputs =
+        nodes_and_registration_[execution_plan_[position]].first.inputs;
+    for (int i = 0; i < inputs->size; ++i) {
+      if (inputs->data[i] >= 0 && copies[inputs->data[i]] >= 0) {
+        inputs->data[i] = copies[inputs->data[i]];
+      }
+    }
+  }
+  execution_plan_.insert(execution_plan_.begin() + insert_position,
+                         copy_nodes.begin(), copy_nodes.end());
+  return kTfLiteOk;
+}
+
+void Subgraph::ApplyMetadataRematSegments() {
+  if (remat_segments_ == nullptr || remat_segments_applied_) return;
+  remat_segments_applied_ = true;
+  if (!delegates_applied_.empty()) {
+    TFLITE_LOG(TFLITE_LOG_WARNING,
+               "Ignoring the rematerialization segments of subgraph %d, which "
+               "is already delegated.",
+               subgraph_index_);
+    return;
+  }
+  if (RematerializeSegments(*remat_segments_) != kTfLiteOk) {
+    TFLITE_LOG(TFLITE_LOG_WARNING,
+               "Ignoring the invalid rematerialization segments of subgraph "
+               "%d.",
+               subgraph_index_);
+  }
+}
+
+bool Subgraph::ShouldRematerializeForMemoryBudget() const {
+  return options_ != nullptr &&
+         options_->GetRematerializationMemoryBudget() > 0 &&
+         !remat_budget_planned_ && delegates_applied_.empty() &&
+         state_ != kStateInvokableAndImmutable;
+}
+
 bool Subgraph::IsFullyDelegated() const {
   for (const int nid : execution_plan_) {
     const TfLiteNode& node = nodes_and_registration_[nid].first;
@@ -2141,6 +2371,11 @@ TfLiteStatus Subgraph::ModifyGraphWithDelegateImpl(TfLiteDelegate* delegate) {
     return kTfLiteDelegateError;
   }
 
+  if (HasDeferredNodes()) {
+    deferred_delegates_.push_back(delegate);
+    return kTfLiteOk;
+  }
+
   // Resets delegation & leaves graph in consistent state if delegate status is
   // not okay.
   auto reset_delegation_if_not_ok = [this](TfLiteStatus status) {
@@ -2160,6 +2395,16 @@ TfLiteStatus Subgraph::ModifyGraphWithDelegateImpl(TfLiteDelegate* delegate) {
   // Restore delegation state if applicable.
   TF_LITE_ENSURE_STATUS(RedoAllDelegates());
 
+  // Rematerialization for the memory budget is chosen on the graph before it
+  // is delegated, which needs the tensor sizes.
+  if (ShouldRematerializeForMemoryBudget() && AllocateTensors() != kTfLiteOk) {
+    TFLITE_LOG(TFLITE_LOG_WARNING,
+               "Failed to allocate the tensors of subgraph %d to choose its "
+               "rematerialization before delegation.",
+               subgraph_index_);
+    remat_budget_planned_ = true;
+  }
+
   const bool delegate_supports_dynamic_shapes =
       TfLiteDelegateGetFlagsInternal(delegate) &
       kTfLiteDelegateFlagsAllowDynamicTensors;
@@ -2288,6 +2533,20 @@ void Subgraph::DumpMemoryPlannerDebugInfo() const {
   memory_planner_->DumpDebugInfo(execution_plan());
 }
 
+TfLiteStatus Subgraph::ComputeOfflineMemoryPlan(ArenaMemoryPlan* plan) {
+#ifdef TFLITE_USE_SIMPLE_MEMORY_PLANNER
+  ReportError("Offline memory plans require the arena planner.");
+  return kTfLiteError;
+#else
+  if (memory_planner_ == nullptr) {
+    ReportError("Tensors must be allocated to compute an offline memory plan.");
+    return kTfLiteError;
+  }
+  return static_cast<ArenaPlanner*>(memory_planner_.get())
+      ->ComputeOfflineMemoryPlan(plan);
+#endif
+}
+
 void Subgraph::GetMemoryAllocInfo(SubgraphAllocInfo* alloc_info) const {
   memset(alloc_info, 0, sizeof(SubgraphAllocInfo));
   if (memory_planner_ == nullptr) return;
@@ -20,6 +20,7 @@ limitations under the License.
 
 #include <atomic>
 #include <cstdint>
+#include <functional>
 #include <map>
 #include <memory>
 #include <string>
@@ -33,6 +34,7 @@ limitations under the License.
 #include "tensorflow/lite/core/api/profiler.h"
 #include "tensorflow/lite/core/c/common.h"
 #include "tensorflow/lite/core/macros.h"
+#include "tensorflow/lite/experimental/remat/metadata_util.h"
 #include "tensorflow/lite/experimental/resource/initialization_status.h"
 #include "tensorflow/lite/experimental/resource/resource_base.h"
 #include "tensorflow/lite/graph_info.h"
@@ -414,6 +416,12 @@ class Subgraph {
   // Returns memory allocation status.
   void GetMemoryAllocInfo(SubgraphAllocInfo* alloc_info) const;
 
+  // WARNING: This is an experimental API and subject to change.
+  // Computes an offline arena memory plan for the current tensor shapes, to be
+  // stored in the model metadata under kModelMemoryPlansMetadataKey by the
+  // conversion tooling. Tensors must have been allocated.
+  TfLiteStatus ComputeOfflineMemoryPlan(ArenaMemoryPlan* plan);
+
   // WARNING: This is an experimental API and subject to change.
   // Set the given `InterpreterOptions` object.
   void SetOptions(InterpreterOptions* options) { options_ = options; }
@@ -528,6 +536,36 @@ class Subgraph {
   // be skipped by the interpreter.
   void MarkAsDelegationSkippable() { is_delegation_skippable_ = true; }
 
+  // Sets the function that adds the nodes of this subgraph. It is run once, by
+  // the first call to `AllocateTensors()` or `EnsureNodesBuilt()`. Delegates
+  // applied before then are queued and applied right after the nodes are
+  // added.
+  // WARNING: This is an experimental API and subject to change.
+  void SetDeferredNodesBuilder(
+      std::function<TfLiteStatus(Subgraph*)> nodes_builder) {
+    deferred_nodes_builder_ = std::move(nodes_builder);
+  }
+
+  // Returns true if the nodes of this subgraph haven't been added yet.
+  bool HasDeferredNodes() const { return deferred_nodes_builder_ != nullptr; }
+
+  // Adds the deferred nodes of this subgraph, if any, and applies the
+  // delegates queued meanwhile. A delegate that fails to apply leaves the
+  // subgraph without delegates, unless it fails with kTfLiteError.
+  // WARNING: This is an experimental API and subject to change.
+  TfLiteStatus EnsureNodesBuilt();
+
+  // Applies the given rematerialization segments in order: the nodes of each
+  // segment are added again right before its `insert_before` node, writing
+  // new copies of their output tensors which that node and the ones after it
+  // read instead. The tensors computed first can then be freed in between.
+  // Stops with an error at the first segment whose nodes aren't consecutive in
+  // the execution plan, come after its `insert_before` node or aren't all
+  // rematerializable (see IsRematerializable), leaving the graph as the
+  // previous segments left it. Must be called before delegates are applied.
+  // WARNING: This is an experimental API and subject to change.
+  TfLiteStatus RematerializeSegments(const std::vector<RematSegment>& segments);
+
  private:
 #ifndef DOXYGEN_SKIP
   friend class tflite::impl::InterpreterBuilder;
@@ -829,6 +867,17 @@ class Subgraph {
   // registration} pair from nodes_and_registrations_.
   void CleanupNode(int node_index);
 
+  // Applies one segment, see RematerializeSegments.
+  TfLiteStatus RematerializeSegment(const RematSegment& segment);
+
+  // Applies the rematerialization segments of the model metadata, once.
+  // Invalid segments are reported and ignored.
+  void ApplyMetadataRematSegments();
+
+  // True if rematerialization segments remain to be chosen for the memory
+  // budget set in the options.
+  bool ShouldRematerializeForMemoryBudget() const;
+
   // Ensures that `tensors_` has at least `kTensorsCapacityHeadroom` extra
   // capacity. Calling this function may invalidate existing pointers to
   // tensors. After calling this function, adding `kTensorsCapacityHeadroom`
@@ -869,8 +918,14 @@ class Subgraph {
   // Since the lifetime of the Interpreter exceeds the Subgraph, metadata
   // remains valid for the latter's lifetime.
   // Also sets relevant fields on context_ based on known metadata.
-  TfLiteStatus SetMetadata(const std::map<std::string, std::string>* metadata,
-                           const ControlEdges* control_edges = nullptr);
+  // `memory_plans`, if not nullptr, holds the offline arena memory plans of
+  // this subgraph and must be owned by the Interpreter as well, and so must
+  // `remat_segments`, its rematerialization segments.
+  TfLiteStatus SetMetadata(
+      const std::map<std::string, std::string>* metadata,
+      const ControlEdges* control_edges = nullptr,
+      const std::vector<ArenaMemoryPlan>* memory_plans = nullptr,
+      const std::vector<RematSegment>* remat_segments = nullptr);
 
   // Initializes the mapping between tensor index to the index of the
   // last operation that uses the tensor as input.
@@ -997,6 +1052,13 @@ class Subgraph {
   // RedoAllDelegates.
   bool delegates_undone_ = false;
 
+  // Adds the nodes of this subgraph when its construction is deferred, see
+  // SetDeferredNodesBuilder.
+  std::function<TfLiteStatus(Subgraph*)> deferred_nodes_builder_;
+
+  // Delegates to apply once the deferred nodes are added, in order.
+  std::vector<TfLiteDelegate*> deferred_delegates_;
+
   // In the future, we'd like a TfLiteIntArray compatible representation.
   // TODO(aselle): replace execution_plan_ with this.
   IntArrayUniquePtr plan_cache_;
@@ -1082,6 +1144,24 @@ class Subgraph {
   // metadata_ by appropriately parametrized SetMetadata method calls.
   const ControlEdges* control_edges_ = nullptr;
 
+  // Offline arena memory plans of this subgraph; can be nullptr. Initialized
+  // from metadata like control_edges_ and handed to the memory planner when
+  // it is created.
+  const std::vector<ArenaMemoryPlan>* memory_plans_ = nullptr;
+
+  // Rematerialization segments of this subgraph; can be nullptr. Initialized
+  // from metadata like control_edges_ and applied once the nodes are added.
+  const std::vector<RematSegment>* remat_segments_ = nullptr;
+  bool remat_segments_applied_ = false;
+
+  // Set once segments were chosen for the rematerialization memory budget.
+  bool remat_budget_planned_ = false;
+
+  // Nodes added by rematerialization, whose builtin data is owned by the node
+  // they recompute.
+  // NOLINTNEXTLINE - absl::flat_hash_set increases binary size by 106kB.
+  std::unordered_set<int> nodes_sharing_builtin_data_;
+
   // Whether this subgraph is "delegation skippable". If a subgraph is
   // delegation-skippable, then the subgraph will be handled by a TfLiteDelegate
   // (and that the delegate is supposed to be already aware of this state), and
@@ -779,7 +779,8 @@ TfLiteStatus DelegateKernel::Eval(TfLiteContext* context, TfLiteNode* node) {
     // For dynamic tensors, copy shape and put buffer_handle for the later
     // CopyFromBufferHandle() call.
     TfLiteTensor* tensor = &context->tensors[tensor_index];
-    const tensorflow::Tensor& tf_tensor = buffer_map->GetTensor(tensor_index);
+    const tensorflow::Tensor& tf_tensor =
+        *buffer_map->GetTensorPtr(tensor_index);
     if (tensor->allocation_type == kTfLiteDynamic) {
       TF_LITE_ENSURE_OK(context, CopyShapeAndType(context, tf_tensor, tensor));
       tensor->buffer_handle = tensor_index;
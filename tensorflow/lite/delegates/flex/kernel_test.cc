@@ -109,6 +109,34 @@ TEST_F(KernelTest, FullGraph) {
   ASSERT_THAT(GetValues(8), ElementsAre(24.0f, 32.0f, 48.0f));
 }
 
+TEST_F(KernelTest, ChainOutputsAcrossInvocations) {
+  // A chain of consecutive TF ops runs as a single partition. Tensor 3 is
+  // both consumed inside the partition and one of its outputs, which are read
+  // from the buffer map after the last op of every invocation.
+  AddTensors(5, {0}, {3, 4}, kTfLiteFloat32, {2});
+
+  AddTfOp(testing::kIdentity, {0}, {1});
+  AddTfOp(testing::kAdd, {1, 1}, {2});
+  AddTfOp(testing::kMul, {2, 2}, {3});
+  AddTfOp(testing::kAdd, {3, 2}, {4});
+
+  ApplyFlexDelegate();
+  ASSERT_EQ(interpreter_->execution_plan().size(), 1);
+
+  SetShape(0, {2});
+  SetValues(0, {1.0f, 2.0f});
+  ASSERT_TRUE(Invoke());
+  ASSERT_THAT(GetValues(3), ElementsAre(4.0f, 16.0f));
+  ASSERT_THAT(GetValues(4), ElementsAre(6.0f, 20.0f));
+
+  SetShape(0, {1});
+  SetValues(0, {3.0f});
+  ASSERT_TRUE(Invoke());
+  ASSERT_THAT(GetShape(3), ElementsAre(1));
+  ASSERT_THAT(GetValues(3), ElementsAre(36.0f));
+  ASSERT_THAT(GetValues(4), ElementsAre(42.0f));
+}
+
 TEST_F(KernelTest, ValidateTensorReleaseMap) {
   // Define the graph.
   //        0           3
@@ -24,6 +24,7 @@ limitations under the License.
 #include <algorithm>
 #include <cstring>
 #include <memory>
+#include <string>
 #include <variant>
 #include <vector>
 
@@ -865,6 +866,10 @@ class InferenceEnvironmentImpl : public InferenceEnvironment {
     } else {
       RETURN_IF_ERROR(CreateDefaultGPUDevice(&device));
     }
+    const OpenClInfo& opencl_info = device.GetInfo().opencl_info;
+    properties_.device_description =
+        opencl_info.vendor_name + ";" + opencl_info.device_name + ";" +
+        opencl_info.platform_version + ";" + opencl_info.driver_version;
 
 #ifdef CL_DELEGATE_ALLOW_GL
     properties_.is_gl_sharing_supported = IsGlSharingSupported(device);
@@ -24,6 +24,7 @@ limitations under the License.
 
 #include <cstdint>
 #include <memory>
+#include <string>
 
 #include "absl/types/span.h"
 #include "tensorflow/lite/delegates/gpu/api.h"
@@ -67,6 +68,11 @@ struct InferenceEnvironmentProperties {
 
   // Indicates whether fast CL->GL synchronization is supported.
   bool is_cl_to_gl_fast_sync_supported = false;
+
+  // Vendor and name of the device, with its OpenCL platform and driver
+  // versions. A serialized model built on one device and driver should be
+  // rebuilt when this changes.
+  std::string device_description;
 };
 
 // Environment manages all resources that need to stay until any inference is
@@ -121,6 +121,18 @@ using delegates::SerializationParams;
 
 constexpr char kSerializedDataPrefix[] = "gpuv2_data_";
 
+// Returns the custom key of the serialized model built with `options` on the
+// device described in `properties`, so that a driver update invalidates it.
+std::string SerializedModelKey(
+    const cl::InferenceOptions& options,
+    const cl::InferenceEnvironmentProperties& properties) {
+  return std::string(kSerializedDataPrefix) +
+         delegates::StrFingerprint(&options, sizeof(cl::InferenceOptions)) +
+         "_" +
+         delegates::StrFingerprint(properties.device_description.data(),
+                                   properties.device_description.size());
+}
+
 #if defined(__ANDROID__)
 // Xeno API does not impose alignment or padding requirements.
 constexpr size_t kRequiredByteAlignment = 1;
@@ -176,18 +188,25 @@ class Delegate {
     if (options_.max_delegated_partitions <= 0) {
       options_.max_delegated_partitions = 1;
     }
-    if (options_.experimental_flags &
-            TFLITE_GPU_EXPERIMENTAL_FLAGS_ENABLE_SERIALIZATION &&
-        options_.model_token && options_.serialization_dir) {
-      SerializationParams params;
-      params.model_token = options_.model_token;
-      params.cache_dir = options_.serialization_dir;
-      serialization_ = std::make_unique<Serialization>(params);
+    if (IsSerializationEnabled()) {
+      // Without a model token, serialization is set up for each graph in
+      // PrepareSerialization.
+      if (options_.model_token) {
+        serialization_ = CreateSerialization(options_.model_token);
+      }
       telemetry_settings_ =
           std::make_unique<TfLiteTelemetryGpuDelegateSettings>();
     }
   }
 
+  // Keys the serialized data of the graph in `context` by a fingerprint of
+  // the graph, unless the options provide a model token.
+  void PrepareSerialization(TfLiteContext* context) {
+    if (!IsSerializationEnabled() || options_.model_token) return;
+    const std::string model_token = delegates::StrFingerprintGraph(context);
+    serialization_ = CreateSerialization(model_token.c_str());
+  }
+
   TfLiteDelegate* tflite_delegate() { return &delegate_; }
   Serialization* serialization() { return serialization_.get(); }
   const TfLiteGpuDelegateOptionsV2& options() const { return options_; }
@@ -206,6 +225,20 @@ class Delegate {
   }
 
  private:
+  bool IsSerializationEnabled() const {
+    return (options_.experimental_flags &
+            TFLITE_GPU_EXPERIMENTAL_FLAGS_ENABLE_SERIALIZATION) &&
+           options_.serialization_dir;
+  }
+
+  std::unique_ptr<Serialization> CreateSerialization(const char* model_token) {
+    SerializationParams params;
+    params.model_token = model_token;
+    params.cache_dir = options_.serialization_dir;
+    params.max_cache_size_bytes = options_.serialization_max_size_bytes;
+    return std::make_unique<Serialization>(params);
+  }
+
   TfLiteDelegate delegate_;
   TfLiteGpuDelegateOptionsV2 options_;
   std::atomic<int> num_delegate_kernels_ = 0;
@@ -273,13 +306,14 @@ class DelegateKernelCore {
   absl::Status MaybeInitializeSerializedOpenCL(
       TfLiteContext* context, const TfLiteDelegateParams* delegate_params,
       std::unique_ptr<InferenceBuilder>* builder, cl::InferenceOptions* options,
-      cl::InferenceEnvironmentOptions* env_options,
-      cl::InferenceEnvironmentProperties* properties,
+      const cl::InferenceEnvironmentProperties& properties,
       Serialization* serialization);
 
   absl::Status SaveSerializedOpenCL(
       TfLiteContext* context, const TfLiteDelegateParams* delegate_params,
-      cl::InferenceOptions* options, Serialization* serialization,
+      cl::InferenceOptions* options,
+      const cl::InferenceEnvironmentProperties& properties,
+      Serialization* serialization,
       const std::vector<uint8_t>& serialized_model);
 
   // The Delegate instance that's shared across all DelegateKernel instances.
@@ -495,16 +529,17 @@ absl::Status DelegateKernelCore::InitializeOpenClApi(
     RETURN_IF_ERROR(cl_environment_->NewInferenceBuilder(
         options, std::move(*graph), builder));
   } else {
+    // The serialized data is keyed by the device and driver of the
+    // environment.
+    RETURN_IF_ERROR(cl::NewInferenceEnvironment(env_options, &cl_environment_,
+                                                &properties));
     // If serialization data is found, initialize CL from it & return early.
     if (MaybeInitializeSerializedOpenCL(context, delegate_params, builder,
-                                        &options, &env_options, &properties,
-                                        serialization)
+                                        &options, properties, serialization)
             .ok()) {
       return absl::OkStatus();
     }
 
-    RETURN_IF_ERROR(cl::NewInferenceEnvironment(env_options, &cl_environment_,
-                                                &properties));
     *graph_is_destroyed = true;
     std::vector<uint8_t> serialized_model;
     RETURN_IF_ERROR(cl_environment_->BuildSerializedModel(
@@ -513,7 +548,8 @@ absl::Status DelegateKernelCore::InitializeOpenClApi(
         cl_environment_->NewInferenceBuilder(serialized_model, builder));
 
     RETURN_IF_ERROR(SaveSerializedOpenCL(context, delegate_params, &options,
-                                         serialization, serialized_model));
+                                         properties, serialization,
+                                         serialized_model));
   }
 
   TFLITE_LOG_PROD_ONCE(tflite::TFLITE_LOG_INFO,
@@ -556,24 +592,18 @@ absl::Status DelegateKernelCore::InitializeOpenGlApi(
 absl::Status DelegateKernelCore::MaybeInitializeSerializedOpenCL(
     TfLiteContext* context, const TfLiteDelegateParams* delegate_params,
     std::unique_ptr<InferenceBuilder>* builder, cl::InferenceOptions* options,
-    cl::InferenceEnvironmentOptions* env_options,
-    cl::InferenceEnvironmentProperties* properties,
+    const cl::InferenceEnvironmentProperties& properties,
     Serialization* serialization) {
   if (!serialization) return absl::InvalidArgumentError("No serialization");
-  // We use a fingerprint of the options to ensure compatibility.
-  std::string options_fingerprint =
-      delegates::StrFingerprint(options, sizeof(cl::InferenceOptions));
+  // We use a fingerprint of the options & device to ensure compatibility.
   auto data_key = serialization->GetEntryForKernel(
-      std::string(kSerializedDataPrefix) + options_fingerprint, context,
-      delegate_params);
+      SerializedModelKey(*options, properties), context, delegate_params);
 
   std::string model_data;
   auto model_data_status = data_key.GetData(context, &model_data);
   if (model_data_status == kTfLiteOk) {
     absl::Span<const uint8_t> model_span = absl::Span<const uint8_t>{
         reinterpret_cast<const uint8_t*>(model_data.data()), model_data.size()};
-    RETURN_IF_ERROR(cl::NewInferenceEnvironment(*env_options, &cl_environment_,
-                                                properties));
     RETURN_IF_ERROR(cl_environment_->NewInferenceBuilder(model_span, builder));
     TFLITE_LOG_PROD_ONCE(tflite::TFLITE_LOG_INFO,
                          "Initialized OpenCL-based API from serialized data.");
@@ -586,17 +616,16 @@ absl::Status DelegateKernelCore::MaybeInitializeSerializedOpenCL(
 // Returns Ok only if serialization happens successfully.
 absl::Status DelegateKernelCore::SaveSerializedOpenCL(
     TfLiteContext* context, const TfLiteDelegateParams* delegate_params,
-    cl::InferenceOptions* options, Serialization* serialization,
+    cl::InferenceOptions* options,
+    const cl::InferenceEnvironmentProperties& properties,
+    Serialization* serialization,
     const std::vector<uint8_t>& serialized_model) {
   if (!serialization) return absl::InvalidArgumentError("No serialization");
-  // We use a fingerprint of the options to ensure compatibility.
-  std::string options_fingerprint =
-      delegates::StrFingerprint(options, sizeof(cl::InferenceOptions));
+  // We use a fingerprint of the options & device to ensure compatibility.
+  auto data_key = serialization->GetEntryForKernel(
+      SerializedModelKey(*options, properties), context, delegate_params);
 
   // Save data.
-  auto data_key = serialization->GetEntryForKernel(
-      std::string(kSerializedDataPrefix) + options_fingerprint, context,
-      delegate_params);
   auto save_status = data_key.SetData(
       context, reinterpret_cast<const char*>(serialized_model.data()),
       serialized_model.size());
@@ -1462,6 +1491,7 @@ TfLiteRegistration CreateAsyncRegistration() {
 
 TfLiteStatus DelegatePrepare(TfLiteContext* context, TfLiteDelegate* delegate) {
   auto* gpu_delegate = GetDelegate(delegate);
+  gpu_delegate->PrepareSerialization(context);
 
   const TfLiteRegistration kRegistration =
 #if defined(__ANDROID__)
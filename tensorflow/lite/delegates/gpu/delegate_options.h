@@ -67,8 +67,8 @@ enum TfLiteGpuExperimentalFlags {
   // model or inference params. Later initializations are fast.
   // ModifyGraphWithDelegate will fail if data cannot be serialized.
   //
-  // NOTE: User also needs to set serialization_dir & model_token in
-  // TfLiteGpuDelegateOptionsV2.
+  // NOTE: User also needs to set serialization_dir in
+  // TfLiteGpuDelegateOptionsV2, and may set model_token.
   // Currently works only if CL backend is used.
   TFLITE_GPU_EXPERIMENTAL_FLAGS_ENABLE_SERIALIZATION = 1 << 3,
 };
@@ -134,9 +134,16 @@ typedef struct {
   // StrFingerprint() in lite/delegates/serialization.h.
   //
   // Set to nullptr in TfLiteGpuDelegateOptionsV2Default(), which implies the
-  // delegate will not try serialization.
+  // delegate derives the token from the graph it is applied to, hashing its
+  // constant tensors (see StrFingerprintGraph()).
   const char* model_token;
 
+  // Maximum total size in bytes of the serialized data in serialization_dir,
+  // which can then be shared by all the models of an app. Serializing new data
+  // evicts the least recently used data beyond this size.
+  // Set to 0 in TfLiteGpuDelegateOptionsV2Default(), which means unbounded.
+  int64_t serialization_max_size_bytes;
+
 #ifdef TFLITE_DEBUG_DELEGATE
   // This sets the index of the first node that could be delegated.
   int first_delegate_node_index;
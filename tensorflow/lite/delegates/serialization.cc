@@ -18,20 +18,22 @@ limitations under the License.
 #include <fstream>
 #include <iostream>
 #else
+#include <dirent.h>
 #include <errno.h>
 #include <fcntl.h>
 #include <sys/file.h>
+#include <sys/stat.h>
 #include <unistd.h>
-
-#include <cstring>
 #endif  // defined(_WIN32)
 
 #include <time.h>
 
 #include <algorithm>
 #include <cstdint>
+#include <cstring>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "tensorflow/lite/core/c/common.h"
@@ -43,6 +45,7 @@ namespace delegates {
 namespace {
 
 static const char kDelegatedNodesSuffix[] = "_dnodes";
+static const char kDataFileSuffix[] = ".bin";
 
 // Farmhash Fingerprint
 inline uint64_t CombineFingerprints(uint64_t l, uint64_t h) {
@@ -66,10 +69,63 @@ inline std::string JoinPath(const std::string& path1,
 inline std::string GetFilePath(const std::string& cache_dir,
                                const std::string& model_token,
                                const uint64_t fingerprint) {
-  auto file_name = (model_token + "_" + std::to_string(fingerprint) + ".bin");
+  auto file_name =
+      (model_token + "_" + std::to_string(fingerprint) + kDataFileSuffix);
   return JoinPath(cache_dir, file_name);
 }
 
+#if !defined(_WIN32)
+// Removes the least recently used data files in `cache_dir`, other than
+// `keep_filepath`, until they take at most `max_size` bytes. Recency is the
+// modification time, which GetData updates.
+void EvictLeastRecentlyUsed(const std::string& cache_dir,
+                            const std::string& keep_filepath,
+                            const int64_t max_size) {
+  DIR* dir = opendir(cache_dir.c_str());
+  if (!dir) return;
+  struct DataFile {
+    std::string path;
+    int64_t size;
+    time_t last_used;
+  };
+  std::vector<DataFile> files;
+  int64_t total_size = 0;
+  const size_t suffix_length = sizeof(kDataFileSuffix) - 1;
+  while (const struct dirent* entry = readdir(dir)) {
+    const std::string name = entry->d_name;
+    if (name.size() <= suffix_length ||
+        name.compare(name.size() - suffix_length, suffix_length,
+                     kDataFileSuffix) != 0) {
+      continue;
+    }
+    std::string path = JoinPath(cache_dir, name);
+    struct stat file_stat;
+    if (stat(path.c_str(), &file_stat) < 0 || !S_ISREG(file_stat.st_mode)) {
+      continue;
+    }
+    total_size += file_stat.st_size;
+    files.push_back({std::move(path), file_stat.st_size, file_stat.st_mtime});
+  }
+  closedir(dir);
+  if (total_size <= max_size) return;
+
+  std::sort(files.begin(), files.end(),
+            [](const DataFile& a, const DataFile& b) {
+              return a.last_used < b.last_used;
+            });
+  for (const DataFile& file : files) {
+    if (total_size <= max_size) break;
+    if (file.path == keep_filepath) continue;
+    // Another process sharing the directory may have removed it already.
+    if (unlink(file.path.c_str()) == 0 || errno == ENOENT) {
+      total_size -= file.size;
+      TFLITE_LOG(TFLITE_LOG_INFO, "Evicted serialized data %s",
+                 file.path.c_str());
+    }
+  }
+}
+#endif  // !defined(_WIN32)
+
 }  // namespace
 
 std::string StrFingerprint(const void* data, const size_t num_bytes) {
@@ -77,12 +133,61 @@ std::string StrFingerprint(const void* data, const size_t num_bytes) {
       ::util::Fingerprint64(reinterpret_cast<const char*>(data), num_bytes));
 }
 
+std::string StrFingerprintGraph(TfLiteContext* context) {
+  uint64_t fingerprint = 0;
+  auto incorporate = [&fingerprint](const void* data, size_t num_bytes) {
+    fingerprint = CombineFingerprints(
+        fingerprint,
+        ::util::Fingerprint64(reinterpret_cast<const char*>(data), num_bytes));
+  };
+  auto incorporate_array = [&incorporate](const TfLiteIntArray* array) {
+    const int size = array ? array->size : -1;
+    incorporate(&size, sizeof(size));
+    if (size > 0) incorporate(array->data, size * sizeof(int));
+  };
+
+  for (size_t i = 0; i < context->tensors_size; ++i) {
+    const TfLiteTensor& tensor = context->tensors[i];
+    const int32_t tensor_data[] = {tensor.type, tensor.allocation_type};
+    incorporate(tensor_data, sizeof(tensor_data));
+    incorporate_array(tensor.dims);
+    if (tensor.allocation_type == kTfLiteMmapRo && tensor.data.raw) {
+      incorporate(tensor.data.raw, tensor.bytes);
+    }
+  }
+
+  TfLiteIntArray* execution_plan = nullptr;
+  if (context->GetExecutionPlan &&
+      context->GetExecutionPlan(context, &execution_plan) == kTfLiteOk) {
+    for (int i = 0; i < execution_plan->size; ++i) {
+      TfLiteNode* node;
+      TfLiteRegistration* registration;
+      if (context->GetNodeAndRegistration(context, execution_plan->data[i],
+                                          &node, &registration) != kTfLiteOk) {
+        continue;
+      }
+      const int32_t op_data[] = {registration->builtin_code,
+                                 registration->version};
+      incorporate(op_data, sizeof(op_data));
+      if (registration->custom_name) {
+        incorporate(registration->custom_name,
+                    std::strlen(registration->custom_name));
+      }
+      incorporate_array(node->inputs);
+      incorporate_array(node->outputs);
+    }
+  }
+  return std::to_string(fingerprint);
+}
+
 SerializationEntry::SerializationEntry(const std::string& cache_dir,
                                        const std::string& model_token,
-                                       const uint64_t fingerprint)
+                                       const uint64_t fingerprint,
+                                       const int64_t max_cache_size_bytes)
     : cache_dir_(cache_dir),
       model_token_(model_token),
-      fingerprint_(fingerprint) {}
+      fingerprint_(fingerprint),
+      max_cache_size_bytes_(max_cache_size_bytes) {}
 
 TfLiteStatus SerializationEntry::SetData(TfLiteContext* context,
                                          const char* data,
@@ -149,6 +254,9 @@ TfLiteStatus SerializationEntry::SetData(TfLiteContext* context,
                        filepath.c_str(), std::strerror(errno));
     return kTfLiteDelegateDataWriteError;
   }
+  if (max_cache_size_bytes_ > 0) {
+    EvictLeastRecentlyUsed(cache_dir_, filepath, max_cache_size_bytes_);
+  }
 #endif  // defined(_WIN32)
 
   TFLITE_LOG(TFLITE_LOG_INFO, "Wrote serialized data for model %s (%d B) to %s",
@@ -198,6 +306,9 @@ TfLiteStatus SerializationEntry::GetData(TfLiteContext* context,
     int bytes_read = read(fd, buffer, 512);
     if (bytes_read == 0) {
       // EOF
+      // Marks the file as recently used for EvictLeastRecentlyUsed; this
+      // fails harmlessly on a read-only directory.
+      futimens(fd, nullptr);
       close(fd);
       return kTfLiteOk;
     } else if (bytes_read < 0) {
@@ -288,7 +399,8 @@ SerializationEntry Serialization::GetEntryImpl(
 
   // Get a fingerprint-specific lock that is passed to the SerializationKey, to
   // ensure noone else gets access to an equivalent SerializationKey.
-  return SerializationEntry(cache_dir_, model_token_, fingerprint);
+  return SerializationEntry(cache_dir_, model_token_, fingerprint,
+                            max_cache_size_bytes_);
 }
 
 TfLiteStatus SaveDelegatedNodes(TfLiteContext* context,
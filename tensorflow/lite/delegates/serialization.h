@@ -80,6 +80,15 @@ namespace delegates {
 //    model_token.
 std::string StrFingerprint(const void* data, const size_t num_bytes);
 
+// Helper to generate a model_token from the graph in `context` when the model
+// flatbuffer isn't at hand, e.g. in TfLiteDelegate::Prepare(). Incorporates the
+// type, shape & data of every constant tensor, the type & shape of the other
+// tensors, and the ops of the nodes in the execution plan with their inputs &
+// outputs. Op parameters aren't, so this relies on the constants to tell
+// models apart. Hashing the constants takes time proportional to the model
+// size, so this should be called once per graph.
+std::string StrFingerprintGraph(TfLiteContext* context);
+
 // Encapsulates a unique blob of data serialized by a delegate.
 // Needs to be initialized with a Serialization instance.
 // Any data set with this entry is 'keyed' by a 64-bit fingerprint unique to the
@@ -99,7 +108,9 @@ class SerializationEntry {
   uint64_t GetFingerprint() const { return fingerprint_; }
 
   // Stores `data` into a file that is unique to this SerializationKey.
-  // Overwrites any existing data if present.
+  // Overwrites any existing data if present. If the Serialization has a
+  // max_cache_size_bytes, the least recently used files in the cache directory
+  // are then removed to fit within it.
   //
   // Returns:
   //   kTfLiteOk if data is successfully stored
@@ -112,6 +123,7 @@ class SerializationEntry {
                        const size_t size) const;
 
   // Get `data` corresponding to this key, if available.
+  // Marks the data as recently used, for eviction by SetData.
   //
   // Returns:
   //   kTfLiteOk if data is successfully stored
@@ -127,7 +139,8 @@ class SerializationEntry {
  protected:
   SerializationEntry(const std::string& cache_dir,
                      const std::string& model_token,
-                     const uint64_t fingerprint_64);
+                     const uint64_t fingerprint_64,
+                     const int64_t max_cache_size_bytes = 0);
 
   // Caching directory.
   const std::string cache_dir_;
@@ -135,6 +148,8 @@ class SerializationEntry {
   const std::string model_token_;
   // For most applications, 64-bit fingerprints are enough.
   const uint64_t fingerprint_ = 0;
+  // Size bound of the caching directory, 0 if unbounded.
+  const int64_t max_cache_size_bytes_ = 0;
 };
 
 // Encapsulates all the data that clients can use to parametrize a Serialization
@@ -143,7 +158,7 @@ typedef struct SerializationParams {
   // Acts as a 'namespace' for all SerializationEntry instances.
   // Clients should ensure that the token is unique to the model graph & data.
   // StrFingerprint() can be used with the flatbuffer data to generate a unique
-  // 64-bit token.
+  // 64-bit token, or StrFingerprintGraph() with the TfLiteContext.
   // TODO(b/190055017): Add 64-bit fingerprints to TFLite flatbuffers to ensure
   // different model constants automatically lead to different fingerprints.
   // Required.
@@ -154,6 +169,11 @@ typedef struct SerializationParams {
   // On Android, `getCodeCacheDir()` is recommended.
   // Required.
   const char* cache_dir;
+  // Maximum total size of the data files in `cache_dir`, which can be shared
+  // by several models & delegates. Writing an entry evicts the least recently
+  // used files beyond this size. 0 means unbounded.
+  // Optional.
+  int64_t max_cache_size_bytes = 0;
 } SerializationParams;
 
 // Utility to enable caching abilities for delegates.
@@ -164,7 +184,9 @@ class Serialization {
  public:
   // Initialize a Serialization interface for applicable delegates.
   explicit Serialization(const SerializationParams& params)
-      : cache_dir_(params.cache_dir), model_token_(params.model_token) {}
+      : cache_dir_(params.cache_dir),
+        model_token_(params.model_token),
+        max_cache_size_bytes_(params.max_cache_size_bytes) {}
 
   // Generate a SerializationEntry that incorporates both `custom_key` &
   // `context` into its unique fingerprint.
@@ -199,6 +221,7 @@ class Serialization {
 
   const std::string cache_dir_;
   const std::string model_token_;
+  const int64_t max_cache_size_bytes_;
 };
 
 // Helper for delegates to save their delegation decisions (which nodes to
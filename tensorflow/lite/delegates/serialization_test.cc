@@ -14,11 +14,17 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/lite/delegates/serialization.h"
 
+#include <sys/stat.h>
+#include <utime.h>
+
 #include <cstdint>
+#include <cstdio>
+#include <ctime>
 #include <string>
 #include <vector>
 
 #include <gtest/gtest.h>
+#include "tensorflow/lite/builtin_ops.h"
 #include "tensorflow/lite/core/c/common.h"
 #include "tensorflow/lite/util.h"
 
@@ -310,6 +316,112 @@ TEST_F(SerializationTest, SerializationData) {
   }
 }
 
+TEST_F(SerializationTest, EvictsLeastRecentlyUsedData) {
+  const std::string test_dir = getSerializationDir() + "/evict_lru";
+  mkdir(test_dir.c_str(), 0700);
+  const char data[100] = {};
+  TfLiteContext context = GenerateTfLiteContext(/*num_tensors*/ 30);
+
+  // Room for two entries, shared by two models.
+  const std::string model_token1 = "model1";
+  const std::string model_token2 = "model2";
+  SerializationParams params1 = {model_token1.c_str(), test_dir.c_str(),
+                                 /*max_cache_size_bytes=*/2 * sizeof(data)};
+  SerializationParams params2 = {model_token2.c_str(), test_dir.c_str(),
+                                 /*max_cache_size_bytes=*/2 * sizeof(data)};
+  Serialization serialization1(params1);
+  Serialization serialization2(params2);
+  auto entry1 = serialization1.GetEntryForDelegate("entry1", &context);
+  auto entry2 = serialization1.GetEntryForDelegate("entry2", &context);
+  auto entry3 = serialization2.GetEntryForDelegate("entry3", &context);
+  auto data_path = [&](const std::string& model_token,
+                       const SerializationEntry& entry) {
+    return test_dir + "/" + model_token + "_" +
+           std::to_string(entry.GetFingerprint()) + ".bin";
+  };
+  auto set_last_used = [&](const std::string& model_token,
+                           const SerializationEntry& entry, time_t time) {
+    struct utimbuf times = {time, time};
+    ASSERT_EQ(utime(data_path(model_token, entry).c_str(), &times), 0);
+  };
+  // Data left by previous runs would be evicted first.
+  std::remove(data_path(model_token2, entry3).c_str());
+
+  ASSERT_EQ(entry1.SetData(&context, data, sizeof(data)), kTfLiteOk);
+  ASSERT_EQ(entry2.SetData(&context, data, sizeof(data)), kTfLiteOk);
+  const time_t now = time(nullptr);
+  set_last_used(model_token1, entry1, now - 200);
+  set_last_used(model_token1, entry2, now - 100);
+  // Reading entry1 makes entry2 the least recently used.
+  std::string read_back;
+  ASSERT_EQ(entry1.GetData(&context, &read_back), kTfLiteOk);
+
+  ASSERT_EQ(entry3.SetData(&context, data, sizeof(data)), kTfLiteOk);
+  EXPECT_EQ(entry1.GetData(&context, &read_back), kTfLiteOk);
+  EXPECT_EQ(entry2.GetData(&context, &read_back),
+            kTfLiteDelegateDataNotFound);
+  EXPECT_EQ(entry3.GetData(&context, &read_back), kTfLiteOk);
+}
+
+TfLiteStatus GetTestExecutionPlan(TfLiteContext* context,
+                                  TfLiteIntArray** execution_plan) {
+  static TfLiteIntArray* plan = ConvertVectorToTfLiteIntArray({0});
+  *execution_plan = plan;
+  return kTfLiteOk;
+}
+
+TfLiteStatus GetTestNodeAndRegistration(TfLiteContext* context, int node_index,
+                                        TfLiteNode** node,
+                                        TfLiteRegistration** registration) {
+  static TfLiteIntArray* inputs = ConvertVectorToTfLiteIntArray({0, 1});
+  static TfLiteIntArray* outputs = ConvertVectorToTfLiteIntArray({2});
+  static TfLiteNode test_node = {};
+  static TfLiteRegistration test_registration = {};
+  test_node.inputs = inputs;
+  test_node.outputs = outputs;
+  test_registration.builtin_code = kTfLiteBuiltinAdd;
+  test_registration.version = 1;
+  *node = &test_node;
+  *registration = &test_registration;
+  return kTfLiteOk;
+}
+
+TEST_F(SerializationTest, GraphFingerprint) {
+  float weights[] = {1.0, 2.0};
+  std::vector<TfLiteTensor> tensors(3);
+  for (TfLiteTensor& tensor : tensors) {
+    tensor.type = kTfLiteFloat32;
+    tensor.allocation_type = kTfLiteArenaRw;
+    tensor.dims = ConvertVectorToTfLiteIntArray({2});
+  }
+  tensors[1].allocation_type = kTfLiteMmapRo;
+  tensors[1].data.f = weights;
+  tensors[1].bytes = sizeof(weights);
+  TfLiteContext context = {};
+  context.tensors_size = tensors.size();
+  context.tensors = tensors.data();
+  context.GetExecutionPlan = GetTestExecutionPlan;
+  context.GetNodeAndRegistration = GetTestNodeAndRegistration;
+
+  const std::string fingerprint = StrFingerprintGraph(&context);
+  EXPECT_EQ(fingerprint, StrFingerprintGraph(&context));
+
+  // Constants are incorporated.
+  weights[1] = 3.0;
+  EXPECT_NE(fingerprint, StrFingerprintGraph(&context));
+  weights[1] = 2.0;
+  EXPECT_EQ(fingerprint, StrFingerprintGraph(&context));
+
+  // So are the shapes and ops.
+  tensors[2].dims->data[0] = 3;
+  EXPECT_NE(fingerprint, StrFingerprintGraph(&context));
+  tensors[2].dims->data[0] = 2;
+  context.GetExecutionPlan = nullptr;
+  EXPECT_NE(fingerprint, StrFingerprintGraph(&context));
+
+  for (TfLiteTensor& tensor : tensors) TfLiteIntArrayFree(tensor.dims);
+}
+
 TEST_F(SerializationTest, CachingDelegatedNodes) {
   std::string model_token = "model1";
   std::string test_dir = getSerializationDir();
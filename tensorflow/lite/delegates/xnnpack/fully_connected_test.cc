@@ -610,5 +610,44 @@ TEST(FullyConnected, WeightsCache) {
       .Test(xnnpack_delegate.get());
 }
 
+TEST(FullyConnected, ResizeRoundTrip) {
+  std::unique_ptr<TfLiteDelegate, decltype(&TfLiteXNNPackDelegateDelete)>
+      xnnpack_delegate(TfLiteXNNPackDelegateCreate(nullptr),
+                       TfLiteXNNPackDelegateDelete);
+
+  std::random_device random_device;
+  auto rng = std::mt19937(random_device());
+  auto channels_rng =
+      std::bind(std::uniform_int_distribution<int32_t>(2, 9), std::ref(rng));
+  const auto input_channels = channels_rng();
+  const auto output_channels = channels_rng();
+
+  // Going back to a batch size used before reuses the runtime created for it.
+  FullyConnectedTester()
+      .InputShape({3, input_channels})
+      .InputChannels(input_channels)
+      .OutputChannels(output_channels)
+      .ResizeBatches({5, 2, 5, 3, 2})
+      .Test(xnnpack_delegate.get());
+}
+
+TEST(FullyConnected, ReuseDelegateAcrossModels) {
+  std::unique_ptr<TfLiteDelegate, decltype(&TfLiteXNNPackDelegateDelete)>
+      xnnpack_delegate(TfLiteXNNPackDelegateCreate(nullptr),
+                       TfLiteXNNPackDelegateDelete);
+
+  // Every model has the same structure and new random weights, and is often
+  // allocated at the address of the previous one, together with its
+  // interpreter. None of them may use a runtime created for another.
+  for (int i = 0; i < 4; i++) {
+    FullyConnectedTester()
+        .InputShape({2, 5})
+        .InputChannels(5)
+        .OutputChannels(3)
+        .ResizeBatches({4, 2})
+        .Test(xnnpack_delegate.get());
+  }
+}
+
 }  // namespace xnnpack
 }  // namespace tflite
@@ -139,6 +139,43 @@ void FullyConnectedTester::Test(TfLiteDelegate* delegate) const {
                 std::numeric_limits<float>::epsilon() *
                     std::max(std::abs(default_output_data[i]) * 20.0f, 1.0f));
   }
+
+  if (!ResizeBatches().empty()) {
+    // Dynamic weights and bias would be lost when reallocating the tensors.
+    ASSERT_EQ(InputShape().size(), 2);
+    ASSERT_NE(WeightsType(), WeightsType::kDynamic);
+    ASSERT_NE(BiasType(), BiasType::kDynamic);
+  }
+  for (int32_t batch : ResizeBatches()) {
+    const std::vector<int> input_shape = {batch, InputChannels()};
+    ASSERT_EQ(default_interpreter->ResizeInputTensor(
+                  default_interpreter->inputs()[0], input_shape),
+              kTfLiteOk);
+    ASSERT_EQ(delegate_interpreter->ResizeInputTensor(
+                  delegate_interpreter->inputs()[0], input_shape),
+              kTfLiteOk);
+    ASSERT_EQ(default_interpreter->AllocateTensors(), kTfLiteOk);
+    ASSERT_EQ(delegate_interpreter->AllocateTensors(), kTfLiteOk);
+
+    default_input_data = default_interpreter->typed_input_tensor<float>(0);
+    std::generate_n(default_input_data, batch * InputChannels(),
+                    std::ref(input_rng));
+    delegate_input_data = delegate_interpreter->typed_input_tensor<float>(0);
+    std::copy_n(default_input_data, batch * InputChannels(),
+                delegate_input_data);
+
+    ASSERT_EQ(default_interpreter->Invoke(), kTfLiteOk);
+    ASSERT_EQ(delegate_interpreter->Invoke(), kTfLiteOk);
+
+    default_output_data = default_interpreter->typed_output_tensor<float>(0);
+    delegate_output_data = delegate_interpreter->typed_output_tensor<float>(0);
+    for (int32_t i = 0; i < batch * OutputChannels(); i++) {
+      ASSERT_NEAR(default_output_data[i], delegate_output_data[i],
+                  std::numeric_limits<float>::epsilon() *
+                      std::max(std::abs(default_output_data[i]) * 20.0f,
+                               1.0f));
+    }
+  }
 }
 
 std::vector<char> FullyConnectedTester::CreateTfLiteModel() const {
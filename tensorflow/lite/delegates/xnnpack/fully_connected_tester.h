@@ -143,6 +143,21 @@ class FullyConnectedTester {
     return *this;
   }
 
+  // Resizes the batch of a 2D input to each of `batches` in turn after the
+  // first inference, and runs inference again.
+  inline FullyConnectedTester& ResizeBatches(
+      std::initializer_list<int32_t> batches) {
+    for (auto it = batches.begin(); it != batches.end(); ++it) {
+      EXPECT_GT(*it, 0);
+    }
+    resize_batches_ = std::vector<int32_t>(batches.begin(), batches.end());
+    return *this;
+  }
+
+  inline const std::vector<int32_t>& ResizeBatches() const {
+    return resize_batches_;
+  }
+
   void Test(TfLiteDelegate* delegate) const;
 
  private:
@@ -170,6 +185,7 @@ class FullyConnectedTester {
   ::tflite::ActivationFunctionType activation_ =
       ::tflite::ActivationFunctionType_NONE;
   TfLiteXNNPackDelegateWeightsCache* weights_cache_ = nullptr;
+  std::vector<int32_t> resize_batches_;
 };
 
 }  // namespace xnnpack
@@ -21,9 +21,11 @@ limitations under the License.
 #include <cstdint>
 #include <cstring>
 #include <limits>
+#include <list>
 #include <map>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
@@ -548,6 +550,29 @@ class Delegate {
 
   xnn_workspace_t workspace() const { return workspace_.get(); }
 
+  // Returns the runtime cached for `key` by CacheRuntime, or nullptr.
+  std::shared_ptr<xnn_runtime> GetCachedRuntime(
+      const std::vector<int64_t>& key) {
+    for (auto it = runtime_cache_.begin(); it != runtime_cache_.end(); ++it) {
+      if (it->first == key) {
+        // Keep the cache in least recently used first order.
+        runtime_cache_.splice(runtime_cache_.end(), runtime_cache_, it);
+        return runtime_cache_.back().second;
+      }
+    }
+    return nullptr;
+  }
+
+  // Caches `runtime` under `key`, evicting the least recently used runtime if
+  // the cache is full.
+  void CacheRuntime(std::vector<int64_t> key,
+                    std::shared_ptr<xnn_runtime> runtime) {
+    if (runtime_cache_.size() >= kMaxCachedRuntimes) {
+      runtime_cache_.pop_front();
+    }
+    runtime_cache_.emplace_back(std::move(key), std::move(runtime));
+  }
+
   TfLiteStatus AssociateVariableWithDimAndType(int local_id,
                                                const TfLiteTensor* tensor,
                                                TfLiteContext* logging_context) {
@@ -615,6 +640,17 @@ class Delegate {
   std::unique_ptr<xnn_workspace, decltype(&xnn_release_workspace)> workspace_{
       nullptr, &xnn_release_workspace};
 
+  // Maximum number of runtimes kept in runtime_cache_.
+  static constexpr size_t kMaxCachedRuntimes = 8;
+  // Runtimes of delegated partitions, keyed by Subgraph::RuntimeCacheKey, in
+  // least recently used first order. Resizing an input undoes and re-applies
+  // the delegate; this lets the re-applied partition reuse the operators and
+  // packed weights of a runtime created for the same shapes before, which is
+  // common for variable length inputs. Declared after the workspace and thread
+  // pool, which the runtimes use, so it's destroyed first.
+  std::list<std::pair<std::vector<int64_t>, std::shared_ptr<xnn_runtime>>>
+      runtime_cache_;
+
   TfLiteXNNPackDelegateOptions options_;
   VariableHolder variable_holder_;
 };
@@ -973,6 +1009,18 @@ class Subgraph {
     if (context->profiler) {
       flags |= XNN_FLAG_BASIC_PROFILING;
     }
+
+    std::vector<int64_t> runtime_key;
+    const bool cache_runtime =
+        RuntimeCacheKey(context, params, delegate, flags, &runtime_key);
+    if (cache_runtime) {
+      std::shared_ptr<xnn_runtime> runtime =
+          delegate.GetCachedRuntime(runtime_key);
+      if (runtime != nullptr) {
+        return new Subgraph(delegate, std::move(runtime), externals);
+      }
+    }
+
     status = xnn_create_runtime_v4(subgraph.get(), delegate.weights_cache(),
                                    delegate.workspace(), delegate.threadpool(),
                                    flags, &runtime_ptr);
@@ -981,7 +1029,178 @@ class Subgraph {
       return nullptr;
     }
 
-    return new Subgraph(delegate, runtime_ptr, externals);
+    std::shared_ptr<xnn_runtime> runtime(runtime_ptr, &xnn_delete_runtime);
+    if (cache_runtime) {
+      delegate.CacheRuntime(std::move(runtime_key), runtime);
+    }
+    return new Subgraph(delegate, std::move(runtime), externals);
+  }
+
+  // Returns the size of the builtin parameters of `builtin_code` operators
+  // read when defining their XNNPACK nodes, or 0 if they aren't read.
+  static size_t BuiltinDataSize(int builtin_code) {
+    switch (builtin_code) {
+      case kTfLiteBuiltinAdd:
+        return sizeof(TfLiteAddParams);
+      case kTfLiteBuiltinAveragePool2d:
+      case kTfLiteBuiltinMaxPool2d:
+        return sizeof(TfLitePoolParams);
+      case kTfLiteBuiltinConcatenation:
+        return sizeof(TfLiteConcatenationParams);
+      case kTfLiteBuiltinConv2d:
+        return sizeof(TfLiteConvParams);
+      case kTfLiteBuiltinDepthwiseConv2d:
+        return sizeof(TfLiteDepthwiseConvParams);
+      case kTfLiteBuiltinDepthToSpace:
+        return sizeof(TfLiteDepthToSpaceParams);
+      case kTfLiteBuiltinDiv:
+        return sizeof(TfLiteDivParams);
+      case kTfLiteBuiltinFullyConnected:
+        return sizeof(TfLiteFullyConnectedParams);
+      case kTfLiteBuiltinLeakyRelu:
+        return sizeof(TfLiteLeakyReluParams);
+      case kTfLiteBuiltinMean:
+      case kTfLiteBuiltinSum:
+        return sizeof(TfLiteReducerParams);
+      case kTfLiteBuiltinMul:
+        return sizeof(TfLiteMulParams);
+      case kTfLiteBuiltinReshape:
+        return sizeof(TfLiteReshapeParams);
+      case kTfLiteBuiltinResizeBilinear:
+        return sizeof(TfLiteResizeBilinearParams);
+      case kTfLiteBuiltinSoftmax:
+        return sizeof(TfLiteSoftmaxParams);
+      case kTfLiteBuiltinSpaceToDepth:
+        return sizeof(TfLiteSpaceToDepthParams);
+      case kTfLiteBuiltinSplit:
+        return sizeof(TfLiteSplitParams);
+      case kTfLiteBuiltinStridedSlice:
+        return sizeof(TfLiteStridedSliceParams);
+      case kTfLiteBuiltinSub:
+        return sizeof(TfLiteSubParams);
+      case kTfLiteBuiltinTransposeConv:
+        return sizeof(TfLiteTransposeConvParams);
+      default:
+        return 0;
+    }
+  }
+
+  static int64_t HashBytes(const void* data, size_t size) {
+    return static_cast<int64_t>(std::hash<std::string_view>()(
+        std::string_view(static_cast<const char*>(data), size)));
+  }
+
+  static int64_t FloatBits(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+  }
+
+  // Computes into `key` the key identifying the runtime of the partition
+  // described by `params`, and returns false if the runtime can't be cached.
+  //
+  // TFLite doesn't tell delegates when a context goes away, so another
+  // interpreter may reuse its address and the addresses of its buffers. The
+  // key therefore describes everything the runtime is built from: the
+  // operators of the partition with the parameters they read, and the type,
+  // shape and quantization of its tensors. Static tensors are identified by
+  // their address, which the runtime may refer to, and by a hash of their
+  // contents. Anything left out of the key only causes a cache miss.
+  static bool RuntimeCacheKey(TfLiteContext* context,
+                              const TfLiteDelegateParams* params,
+                              const Delegate& delegate, uint32_t flags,
+                              std::vector<int64_t>* key) {
+    key->assign({flags, params->nodes_to_replace->size});
+    std::unordered_set<int> tensors;
+    for (int i = 0; i < params->nodes_to_replace->size; ++i) {
+      const int node_index = params->nodes_to_replace->data[i];
+      TfLiteNode* node = nullptr;
+      TfLiteRegistration* registration = nullptr;
+      if (context->GetNodeAndRegistration(context, node_index, &node,
+                                          &registration) != kTfLiteOk) {
+        return false;
+      }
+      switch (registration->builtin_code) {
+        case kTfLiteBuiltinAssignVariable:
+        case kTfLiteBuiltinReadVariable:
+        case kTfLiteBuiltinVarHandle:
+          // The state of variables must not be carried over to a re-applied
+          // delegate.
+          return false;
+        case kTfLiteBuiltinCustom:
+          key->push_back(HashBytes(registration->custom_name,
+                                   std::strlen(registration->custom_name)));
+          key->push_back(HashBytes(node->custom_initial_data,
+                                   node->custom_initial_data_size));
+          break;
+        default: {
+          const size_t builtin_data_size =
+              BuiltinDataSize(registration->builtin_code);
+          key->push_back(
+              builtin_data_size == 0
+                  ? 0
+                  : HashBytes(node->builtin_data, builtin_data_size));
+          break;
+        }
+      }
+      key->push_back(node_index);
+      key->push_back(registration->builtin_code);
+      key->push_back(registration->version);
+      for (const TfLiteIntArray* array : {node->inputs, node->outputs}) {
+        key->push_back(array->size);
+        key->insert(key->end(), array->data, array->data + array->size);
+        tensors.insert(array->data, array->data + array->size);
+      }
+    }
+    // Ordered so that equal partitions have equal keys.
+    std::vector<int> sorted_tensors(tensors.begin(), tensors.end());
+    std::sort(sorted_tensors.begin(), sorted_tensors.end());
+    for (int t : sorted_tensors) {
+      if (t == kTfLiteOptionalTensor) continue;
+      if (delegate.static_unpacked_data_map_.count(t) != 0) {
+        // Re-applying the delegate reallocates unpacked static data.
+        return false;
+      }
+      const TfLiteTensor& tensor = context->tensors[t];
+      key->push_back(t);
+      key->push_back(tensor.type);
+      key->push_back(tensor.allocation_type);
+      key->push_back(tensor.dims->size);
+      key->insert(key->end(), tensor.dims->data,
+                  tensor.dims->data + tensor.dims->size);
+      key->push_back(FloatBits(tensor.params.scale));
+      key->push_back(tensor.params.zero_point);
+      if (tensor.quantization.type == kTfLiteAffineQuantization) {
+        const auto* quantization = static_cast<const TfLiteAffineQuantization*>(
+            tensor.quantization.params);
+        key->push_back(quantization->quantized_dimension);
+        if (quantization->scale != nullptr) {
+          key->push_back(quantization->scale->size);
+          for (int i = 0; i < quantization->scale->size; ++i) {
+            key->push_back(FloatBits(quantization->scale->data[i]));
+          }
+        }
+        if (quantization->zero_point != nullptr) {
+          key->push_back(quantization->zero_point->size);
+          key->insert(key->end(), quantization->zero_point->data,
+                      quantization->zero_point->data +
+                          quantization->zero_point->size);
+        }
+      }
+      if (tensor.allocation_type == kTfLiteMmapRo) {
+        key->push_back(reinterpret_cast<intptr_t>(tensor.data.raw));
+        key->push_back(HashBytes(tensor.data.raw, tensor.bytes));
+      }
+    }
+    // Every partition defines all the variables of the delegate.
+    for (const auto& variable : delegate.GetAllVariableTensors()) {
+      key->push_back(variable.first);
+      key->push_back(variable.second.type);
+      key->push_back(variable.second.dims.size());
+      key->insert(key->end(), variable.second.dims.begin(),
+                  variable.second.dims.end());
+    }
+    return true;
   }
 
   TfLiteStatus Prepare(TfLiteContext* context) { return kTfLiteOk; }
@@ -5894,9 +6113,9 @@ class Subgraph {
   }
 
  private:
-  Subgraph(const Delegate& delegate, xnn_runtime_t runtime,
+  Subgraph(const Delegate& delegate, std::shared_ptr<xnn_runtime> runtime,
            const std::unordered_set<int>& externals)
-      : runtime_(runtime, &xnn_delete_runtime) {
+      : runtime_(std::move(runtime)) {
     for (int t : externals) {
       externals_[t] = nullptr;
     }
@@ -5904,9 +6123,8 @@ class Subgraph {
   }
 
   // XNNPACK Runtime (subgraph + workspace) with smart-pointer for lifetime
-  // management.
-  std::unique_ptr<xnn_runtime, decltype(&xnn_delete_runtime)> runtime_{
-      nullptr, &xnn_delete_runtime};
+  // management; shared with the runtime cache of the delegate.
+  std::shared_ptr<xnn_runtime> runtime_;
   // Mapping from TFLite Tensor IDs (same as XNNPACK Value IDs) for
   // input/output tensors in the delegated subgraph to their data locations.
   std::unordered_map<int, void*> externals_;
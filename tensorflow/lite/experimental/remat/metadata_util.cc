@@ -74,6 +74,19 @@ bool Parse(const char** data, size_t* size, std::pair<First, Second>* out) {
   return Parse(data, size, &(out->first)) && Parse(data, size, &(out->second));
 }
 
+// Rematerialization segments are serialized as the concatenation of their
+// fields' serialization.
+void Serialize(std::string* out, const tflite::RematSegment& in) {
+  Serialize(out, in.begin);
+  Serialize(out, in.end);
+  Serialize(out, in.insert_before);
+}
+
+bool Parse(const char** data, size_t* size, tflite::RematSegment* out) {
+  return Parse(data, size, &(out->begin)) && Parse(data, size, &(out->end)) &&
+         Parse(data, size, &(out->insert_before));
+}
+
 // Vectors are serialized as the concetation of the serialization of their size
 // and the the serializations of their elements.
 template <class Value>
@@ -119,4 +132,36 @@ bool ParseModelControlDependencies(const char* data, size_t size,
          Parse(&data, &size, out) && (size == 0);
 }
 
+std::string SerializeModelMemoryPlans(const ModelMemoryPlans& in) {
+  std::string out;
+  Serialize(&out, kModelMemoryPlansMetadataVersion);
+  Serialize(&out, in);
+  return out;
+}
+
+bool ParseModelMemoryPlans(const char* data, size_t size,
+                           ModelMemoryPlans* out) {
+  out->clear();
+  uint32_t version = 0;
+  return Parse(&data, &size, &version) &&
+         (version == kModelMemoryPlansMetadataVersion) &&
+         Parse(&data, &size, out) && (size == 0);
+}
+
+std::string SerializeModelRematSegments(const ModelRematSegments& in) {
+  std::string out;
+  Serialize(&out, kModelRematSegmentsMetadataVersion);
+  Serialize(&out, in);
+  return out;
+}
+
+bool ParseModelRematSegments(const char* data, size_t size,
+                             ModelRematSegments* out) {
+  out->clear();
+  uint32_t version = 0;
+  return Parse(&data, &size, &version) &&
+         (version == kModelRematSegmentsMetadataVersion) &&
+         Parse(&data, &size, out) && (size == 0);
+}
+
 }  // namespace tflite
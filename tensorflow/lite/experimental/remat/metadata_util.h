@@ -15,13 +15,16 @@ limitations under the License.
 /// \file
 ///
 /// Functions for serializiation/deserialization of control dependency
-/// information to/from model metadata.
+/// information, offline arena memory plans and rematerialization segments
+/// to/from model metadata.
 ///
 
 #ifndef TENSORFLOW_LITE_EXPERIMENTAL_REMAT_METADATA_UTIL_H_
 #define TENSORFLOW_LITE_EXPERIMENTAL_REMAT_METADATA_UTIL_H_
 
+#include <cstdint>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "tensorflow/lite/graph_info.h"
@@ -53,6 +56,71 @@ constexpr char kModelControlDependenciesMetadataKey[] =
 /// serialization.  For deserialization, past versions should remain parseable.
 constexpr uint32_t kModelControlDependenciesMetadataVersion = 1;
 
+/// An offline arena memory plan for one subgraph, computed for one set of
+/// representative input shapes. For each tensor of the subgraph, in tensor
+/// index order, holds (size in bytes, offset in the non-persistent arena);
+/// tensors not allocated in that arena have an offset of -1.
+using ArenaMemoryPlan = std::vector<std::pair<int32_t, int32_t>>;
+
+/// Memory plans for the model: for each subgraph, the collection of plans
+/// computed for different representative input shapes.
+using ModelMemoryPlans = std::vector<std::vector<ArenaMemoryPlan>>;
+
+/// Serializes `in` into the returned string. The result is parseable with
+/// ParseModelMemoryPlans.
+std::string SerializeModelMemoryPlans(const ModelMemoryPlans& in);
+
+/// Deserializes `*out` from a character buffer of size `size` at `data`.
+/// Returns true iff successful. `*out` needn't be empty before invocation.
+/// When returning false, `*out`'s state is undefined.
+bool ParseModelMemoryPlans(const char* data, size_t size,
+                           ModelMemoryPlans* out);
+
+/// The key under which to store the serialized memory plans in the model's
+/// metadata.
+constexpr char kModelMemoryPlansMetadataKey[] = "model_memory_plans";
+
+/// Version of the serialized memory plan format; see
+/// kModelControlDependenciesMetadataVersion.
+constexpr uint32_t kModelMemoryPlansMetadataVersion = 1;
+
+/// A rematerialization segment of a subgraph: the nodes `begin` to `end - 1`,
+/// which must be consecutive in the execution plan, are run a second time
+/// right before node `insert_before`. That node and the ones after it read the
+/// recomputed tensors, so the ones computed first can be freed in between.
+struct RematSegment {
+  int32_t begin;
+  int32_t end;
+  int32_t insert_before;
+
+  bool operator==(const RematSegment& other) const {
+    return begin == other.begin && end == other.end &&
+           insert_before == other.insert_before;
+  }
+};
+
+/// Rematerialization segments for the model: for each subgraph, the segments
+/// to apply in order. Node indices refer to the nodes of the model.
+using ModelRematSegments = std::vector<std::vector<RematSegment>>;
+
+/// Serializes `in` into the returned string. The result is parseable with
+/// ParseModelRematSegments.
+std::string SerializeModelRematSegments(const ModelRematSegments& in);
+
+/// Deserializes `*out` from a character buffer of size `size` at `data`.
+/// Returns true iff successful. `*out` needn't be empty before invocation.
+/// When returning false, `*out`'s state is undefined.
+bool ParseModelRematSegments(const char* data, size_t size,
+                             ModelRematSegments* out);
+
+/// The key under which to store the serialized rematerialization segments in
+/// the model's metadata.
+constexpr char kModelRematSegmentsMetadataKey[] = "model_remat_segments";
+
+/// Version of the serialized rematerialization segment format; see
+/// kModelControlDependenciesMetadataVersion.
+constexpr uint32_t kModelRematSegmentsMetadataVersion = 1;
+
 }  // namespace tflite
 
 #endif  // TENSORFLOW_LITE_EXPERIMENTAL_REMAT_METADATA_UTIL_H_
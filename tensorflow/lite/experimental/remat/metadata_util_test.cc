@@ -38,6 +38,24 @@ class MetadataSerializerTest : public ::testing::Test {
                ? (out == in) ? "ok" : "mismatch"
                : "malformed";
   }
+
+  std::string RoundTripPlans(const ModelMemoryPlans &in) const {
+    ModelMemoryPlans out = {{{{-1, -1}}}};
+    const std::string serialized = tflite::SerializeModelMemoryPlans(in);
+    return tflite::ParseModelMemoryPlans(serialized.data(), serialized.size(),
+                                         &out)
+               ? (out == in) ? "ok" : "mismatch"
+               : "malformed";
+  }
+
+  std::string RoundTripSegments(const ModelRematSegments &in) const {
+    ModelRematSegments out = {{{-1, -1, -1}}};
+    const std::string serialized = tflite::SerializeModelRematSegments(in);
+    return tflite::ParseModelRematSegments(serialized.data(),
+                                           serialized.size(), &out)
+               ? (out == in) ? "ok" : "mismatch"
+               : "malformed";
+  }
 };
 
 TEST_F(MetadataSerializerTest, nothing) { EXPECT_THAT(RoundTrip({}), "ok"); }
@@ -51,5 +69,36 @@ TEST_F(MetadataSerializerTest, something) {
       "ok");
 }
 
+TEST_F(MetadataSerializerTest, memory_plans) {
+  EXPECT_THAT(RoundTripPlans({}), "ok");
+  EXPECT_THAT(
+      RoundTripPlans({{{{16, 0}, {32, 64}, {8, -1}}, {{kHuge, 0}, {0, -1}}},
+                      {},
+                      {{}}}),
+      "ok");
+}
+
+TEST_F(MetadataSerializerTest, truncated_memory_plans) {
+  const std::string serialized =
+      tflite::SerializeModelMemoryPlans({{{{16, 0}, {32, 64}}}});
+  ModelMemoryPlans out;
+  EXPECT_FALSE(tflite::ParseModelMemoryPlans(serialized.data(),
+                                             serialized.size() - 1, &out));
+}
+
+TEST_F(MetadataSerializerTest, remat_segments) {
+  EXPECT_THAT(RoundTripSegments({}), "ok");
+  EXPECT_THAT(RoundTripSegments({{{0, 1, 5}, {3, 6, kHuge}}, {}, {{1, 2, 3}}}),
+              "ok");
+}
+
+TEST_F(MetadataSerializerTest, truncated_remat_segments) {
+  const std::string serialized =
+      tflite::SerializeModelRematSegments({{{0, 1, 5}}});
+  ModelRematSegments out;
+  EXPECT_FALSE(tflite::ParseModelRematSegments(serialized.data(),
+                                               serialized.size() - 1, &out));
+}
+
 }  // namespace
 }  // namespace tflite
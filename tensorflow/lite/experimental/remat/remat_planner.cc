@@ -0,0 +1,235 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/experimental/remat/remat_planner.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "tensorflow/lite/builtin_ops.h"
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/experimental/remat/metadata_util.h"
+#include "tensorflow/lite/graph_info.h"
+
+namespace tflite {
+namespace {
+
+// Execution plan positions `first` to `last` during which `bytes` of the arena
+// are in use.
+struct LiveRange {
+  int first;
+  int last;
+  size_t bytes;
+};
+
+// Returns the total size of the ranges alive at each of the `num_nodes`
+// positions.
+std::vector<size_t> ComputeLiveBytes(const std::vector<LiveRange>& ranges,
+                                     int num_nodes) {
+  std::vector<int64_t> deltas(num_nodes + 1, 0);
+  for (const LiveRange& range : ranges) {
+    deltas[range.first] += range.bytes;
+    deltas[range.last + 1] -= range.bytes;
+  }
+  std::vector<size_t> live_bytes(num_nodes);
+  int64_t total = 0;
+  for (int i = 0; i < num_nodes; ++i) {
+    total += deltas[i];
+    live_bytes[i] = total;
+  }
+  return live_bytes;
+}
+
+bool AnyVariableTensor(const TfLiteIntArray* tensor_indices,
+                       const TfLiteTensor* tensors) {
+  for (int i = 0; i < tensor_indices->size; ++i) {
+    const int tensor_index = tensor_indices->data[i];
+    if (tensor_index >= 0 && tensors[tensor_index].is_variable) return true;
+  }
+  return false;
+}
+
+}  // namespace
+
+bool IsRematerializable(const TfLiteNode& node,
+                        const TfLiteRegistration& registration,
+                        const TfLiteTensor* tensors) {
+  if (node.delegate != nullptr || node.might_have_side_effect ||
+      node.intermediates->size > 0) {
+    return false;
+  }
+  switch (registration.builtin_code) {
+    case kTfLiteBuiltinCustom:
+    case kTfLiteBuiltinDelegate:
+    case kTfLiteBuiltinMultinomial:
+    case kTfLiteBuiltinRandomStandardNormal:
+    case kTfLiteBuiltinRandomUniform:
+      return false;
+    default:
+      break;
+  }
+  return !AnyVariableTensor(node.inputs, tensors) &&
+         !AnyVariableTensor(node.outputs, tensors);
+}
+
+std::vector<RematSegment> PlanRematerialization(GraphInfo* info,
+                                                size_t memory_budget) {
+  const int num_nodes = info->num_execution_nodes();
+  if (num_nodes == 0) return {};
+  const int num_tensors = info->num_tensors();
+  const TfLiteTensor* tensors = info->tensors();
+
+  // Execution plan positions of the producer and of the consumers of each
+  // tensor.
+  std::vector<int> producers(num_tensors, -1);
+  std::vector<std::vector<int>> consumers(num_tensors);
+  for (int i = 0; i < num_nodes; ++i) {
+    const TfLiteNode& node = info->node(i);
+    for (int j = 0; j < node.inputs->size; ++j) {
+      const int tensor_index = node.inputs->data[j];
+      if (tensor_index < 0) continue;
+      std::vector<int>& tensor_consumers = consumers[tensor_index];
+      if (tensor_consumers.empty() || tensor_consumers.back() != i) {
+        tensor_consumers.push_back(i);
+      }
+    }
+    for (int j = 0; j < node.outputs->size; ++j) {
+      const int tensor_index = node.outputs->data[j];
+      if (tensor_index >= 0 && producers[tensor_index] < 0) {
+        producers[tensor_index] = i;
+      }
+    }
+  }
+
+  // Like the arena planner, keeps the inputs, outputs and variables of the
+  // graph alive until the end.
+  std::vector<bool> preserved(num_tensors, false);
+  for (const std::vector<int>* tensor_indices :
+       {&info->inputs(), &info->outputs(), &info->variables()}) {
+    for (int tensor_index : *tensor_indices) {
+      if (tensor_index >= 0) preserved[tensor_index] = true;
+    }
+  }
+
+  std::vector<LiveRange> ranges;
+  // Index in `ranges` of the range of each tensor, or -1 if it isn't in the
+  // arena.
+  std::vector<int> tensor_ranges(num_tensors, -1);
+  for (int i = 0; i < num_tensors; ++i) {
+    if (tensors[i].allocation_type != kTfLiteArenaRw) continue;
+    const int producer = producers[i];
+    const std::vector<int>& tensor_consumers = consumers[i];
+    LiveRange range;
+    if (preserved[i]) {
+      range.first = std::max(producer, 0);
+      range.last = num_nodes - 1;
+    } else if (producer >= 0) {
+      range.first = producer;
+      range.last = tensor_consumers.empty()
+                       ? producer
+                       : std::max(producer, tensor_consumers.back());
+    } else if (!tensor_consumers.empty()) {
+      range.first = tensor_consumers.front();
+      range.last = tensor_consumers.back();
+    } else {
+      continue;
+    }
+    range.bytes = tensors[i].bytes;
+    tensor_ranges[i] = ranges.size();
+    ranges.push_back(range);
+  }
+  // Adds the temporaries of the node at `position` to `ranges` as if it ran at
+  // `run_position`.
+  auto add_temporaries = [&](int position, int run_position) {
+    const TfLiteIntArray* temporaries = info->node(position).temporaries;
+    for (int i = 0; i < temporaries->size; ++i) {
+      const TfLiteTensor& temporary = tensors[temporaries->data[i]];
+      if (temporary.allocation_type != kTfLiteArenaRw) continue;
+      ranges.push_back({run_position, run_position, temporary.bytes});
+    }
+  };
+  for (int i = 0; i < num_nodes; ++i) add_temporaries(i, i);
+
+  std::vector<RematSegment> segments;
+  std::vector<bool> rematerialized(num_tensors, false);
+  while (true) {
+    const std::vector<size_t> live_bytes = ComputeLiveBytes(ranges, num_nodes);
+    const int peak = std::max_element(live_bytes.begin(), live_bytes.end()) -
+                     live_bytes.begin();
+    if (live_bytes[peak] <= memory_budget) break;
+
+    // Finds the largest tensor alive at the peak that its node doesn't use.
+    int best_tensor = -1;
+    int best_previous_use = 0;
+    int best_next_use = 0;
+    for (int i = 0; i < num_tensors; ++i) {
+      const int producer = producers[i];
+      if (tensor_ranges[i] < 0 || preserved[i] || rematerialized[i] ||
+          producer < 0 || producer >= peak ||
+          ranges[tensor_ranges[i]].last <= peak) {
+        continue;
+      }
+      if (best_tensor >= 0 && tensors[i].bytes <= tensors[best_tensor].bytes) {
+        continue;
+      }
+      const std::vector<int>& tensor_consumers = consumers[i];
+      const auto next_use = std::lower_bound(
+          tensor_consumers.begin(), tensor_consumers.end(), peak);
+      if (next_use == tensor_consumers.end() || *next_use == peak) continue;
+
+      const TfLiteNode& node = info->node(producer);
+      if (node.outputs->size != 1 ||
+          !IsRematerializable(node, info->registration(producer), tensors)) {
+        continue;
+      }
+      // Recomputing the tensor mustn't extend the lifetime of the inputs.
+      bool inputs_alive = true;
+      for (int j = 0; j < node.inputs->size; ++j) {
+        const int input = node.inputs->data[j];
+        if (input >= 0 && tensor_ranges[input] >= 0 &&
+            ranges[tensor_ranges[input]].last < *next_use) {
+          inputs_alive = false;
+          break;
+        }
+      }
+      if (!inputs_alive) continue;
+
+      best_tensor = i;
+      best_previous_use =
+          next_use == tensor_consumers.begin() ? producer : *(next_use - 1);
+      best_next_use = *next_use;
+    }
+    if (best_tensor < 0) break;
+
+    // The tensor computed first is freed after its previous use, and the
+    // recomputed one lives from its next use on.
+    LiveRange& range = ranges[tensor_ranges[best_tensor]];
+    const LiveRange recomputed_range = {best_next_use, range.last,
+                                        range.bytes};
+    range.last = best_previous_use;
+    ranges.push_back(recomputed_range);
+    const int producer = producers[best_tensor];
+    add_temporaries(producer, best_next_use);
+    rematerialized[best_tensor] = true;
+
+    const int node_index = info->node_index(producer);
+    segments.push_back({node_index, node_index + 1,
+                        static_cast<int32_t>(info->node_index(best_next_use))});
+  }
+  return segments;
+}
+
+}  // namespace tflite
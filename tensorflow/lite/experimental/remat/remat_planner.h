@@ -0,0 +1,57 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+/// \file
+///
+/// Chooses the rematerialization segments of a subgraph at runtime.
+///
+
+#ifndef TENSORFLOW_LITE_EXPERIMENTAL_REMAT_REMAT_PLANNER_H_
+#define TENSORFLOW_LITE_EXPERIMENTAL_REMAT_REMAT_PLANNER_H_
+
+#include <cstddef>
+#include <vector>
+
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/experimental/remat/metadata_util.h"
+#include "tensorflow/lite/graph_info.h"
+
+namespace tflite {
+
+/// Returns true if running `node` a second time produces the same outputs and
+/// has no other effect, so that it can be part of a rematerialization segment.
+/// This is only assumed of builtin ops that aren't delegated, random, or
+/// reading or writing resources or variable tensors.
+bool IsRematerializable(const TfLiteNode& node,
+                        const TfLiteRegistration& registration,
+                        const TfLiteTensor* tensors);
+
+/// Chooses rematerialization segments to bring the peak size of the
+/// non-persistent arena of the graph in `info` under `memory_budget` bytes.
+/// The peak is estimated as the largest total size of the arena tensors alive
+/// while a node runs, so tensor sizes must be known, i.e. all nodes must have
+/// been prepared.
+///
+/// Segments are picked greedily: while the estimate exceeds the budget, the
+/// largest tensor alive but unused by the node at the peak is recomputed by
+/// its producer right before its next use, provided the producer is
+/// rematerializable, has a single output and its inputs are kept alive until
+/// that use anyway. Returns the segments in the order they must be applied,
+/// which may not reach the budget if no tensor is left to rematerialize.
+std::vector<RematSegment> PlanRematerialization(GraphInfo* info,
+                                                size_t memory_budget);
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_EXPERIMENTAL_REMAT_REMAT_PLANNER_H_
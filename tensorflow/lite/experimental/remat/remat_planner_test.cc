@@ -0,0 +1,165 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/experimental/remat/remat_planner.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/lite/builtin_ops.h"
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/experimental/remat/metadata_util.h"
+#include "tensorflow/lite/graph_info.h"
+
+namespace tflite {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+constexpr size_t kTensorBytes = 100;
+
+struct TestNode {
+  std::vector<int> inputs;
+  std::vector<int> outputs;
+};
+
+// A graph whose nodes run in order and whose tensors are all in the arena and
+// of kTensorBytes.
+class TestGraphInfo : public GraphInfo {
+ public:
+  TestGraphInfo(std::vector<int> inputs, const std::vector<TestNode>& nodes,
+                std::vector<int> outputs)
+      : inputs_(std::move(inputs)), outputs_(std::move(outputs)) {
+    int num_tensors = 0;
+    for (const TestNode& test_node : nodes) {
+      TfLiteNode node = {};
+      node.inputs = ConvertVector(test_node.inputs);
+      node.outputs = ConvertVector(test_node.outputs);
+      node.intermediates = TfLiteIntArrayCreate(0);
+      node.temporaries = TfLiteIntArrayCreate(0);
+      nodes_.push_back(node);
+      TfLiteRegistration registration = {};
+      registration.builtin_code = kTfLiteBuiltinAdd;
+      registrations_.push_back(registration);
+      for (int tensor_index : test_node.outputs) {
+        num_tensors = std::max(num_tensors, tensor_index + 1);
+      }
+    }
+    for (int tensor_index : inputs_) {
+      num_tensors = std::max(num_tensors, tensor_index + 1);
+    }
+    tensors_.resize(num_tensors);
+    for (TfLiteTensor& tensor : tensors_) {
+      tensor.allocation_type = kTfLiteArenaRw;
+      tensor.bytes = kTensorBytes;
+    }
+  }
+
+  ~TestGraphInfo() override {
+    for (TfLiteNode& node : nodes_) {
+      TfLiteIntArrayFree(node.inputs);
+      TfLiteIntArrayFree(node.outputs);
+      TfLiteIntArrayFree(node.intermediates);
+      TfLiteIntArrayFree(node.temporaries);
+    }
+  }
+
+  size_t num_tensors() const override { return tensors_.size(); }
+  TfLiteTensor* tensor(size_t index) override { return &tensors_[index]; }
+  TfLiteTensor* tensors() override { return tensors_.data(); }
+  size_t num_execution_nodes() const override { return nodes_.size(); }
+  size_t num_total_nodes() const override { return nodes_.size(); }
+  const TfLiteNode& node(size_t index) const override {
+    return nodes_[index];
+  }
+  const TfLiteRegistration& registration(size_t index) const override {
+    return registrations_[index];
+  }
+  size_t node_index(size_t index) const override { return index; }
+  const std::vector<int>& inputs() const override { return inputs_; }
+  const std::vector<int>& outputs() const override { return outputs_; }
+  const std::vector<int>& variables() const override { return variables_; }
+
+  void SetBuiltinCode(int node_index, int builtin_code) {
+    registrations_[node_index].builtin_code = builtin_code;
+  }
+
+ private:
+  static TfLiteIntArray* ConvertVector(const std::vector<int>& values) {
+    TfLiteIntArray* array = TfLiteIntArrayCreate(values.size());
+    std::copy(values.begin(), values.end(), array->data);
+    return array;
+  }
+
+  std::vector<TfLiteNode> nodes_;
+  std::vector<TfLiteRegistration> registrations_;
+  std::vector<TfLiteTensor> tensors_;
+  std::vector<int> inputs_;
+  std::vector<int> outputs_;
+  std::vector<int> variables_;
+};
+
+// Tensor 1 is used by the first and last nodes, and is alive while tensors 2
+// to 4 are. Up to 5 tensors are alive at once, at node 3.
+TestGraphInfo CreateLongLivedTensorGraph() {
+  return TestGraphInfo(
+      /*inputs=*/{0},
+      /*nodes=*/
+      {{{0}, {1}}, {{1}, {2}}, {{2}, {3}}, {{2, 3}, {4}}, {{1, 4}, {5}}},
+      /*outputs=*/{5});
+}
+
+TEST(RematPlannerTest, WithinBudget) {
+  TestGraphInfo info = CreateLongLivedTensorGraph();
+  EXPECT_THAT(PlanRematerialization(&info, 5 * kTensorBytes), IsEmpty());
+}
+
+TEST(RematPlannerTest, RecomputesLongLivedTensor) {
+  TestGraphInfo info = CreateLongLivedTensorGraph();
+  // Recomputing tensor 1 before node 4 brings the peak down to 4 tensors.
+  EXPECT_THAT(PlanRematerialization(&info, 4 * kTensorBytes),
+              ElementsAre(RematSegment{0, 1, 4}));
+  // There is nothing else to recompute.
+  EXPECT_THAT(PlanRematerialization(&info, kTensorBytes),
+              ElementsAre(RematSegment{0, 1, 4}));
+}
+
+TEST(RematPlannerTest, SkipsNonRematerializableNodes) {
+  TestGraphInfo info = CreateLongLivedTensorGraph();
+  info.SetBuiltinCode(0, kTfLiteBuiltinCustom);
+  EXPECT_THAT(PlanRematerialization(&info, kTensorBytes), IsEmpty());
+}
+
+TEST(RematPlannerTest, KeepsInputLifetimes) {
+  // Recomputing tensor 1 before node 5 would keep tensor 6 alive until then.
+  TestGraphInfo info(
+      /*inputs=*/{0},
+      /*nodes=*/
+      {{{0}, {6}},
+       {{6}, {1}},
+       {{1}, {2}},
+       {{2}, {3}},
+       {{2, 3}, {4}},
+       {{1, 4}, {5}}},
+      /*outputs=*/{5});
+  EXPECT_THAT(PlanRematerialization(&info, kTensorBytes), IsEmpty());
+}
+
+}  // namespace
+}  // namespace tflite
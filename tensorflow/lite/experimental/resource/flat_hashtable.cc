@@ -0,0 +1,339 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/experimental/resource/flat_hashtable.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#include "tensorflow/lite/string_util.h"
+
+namespace tflite {
+namespace resource {
+namespace internal {
+namespace {
+
+constexpr uint32_t kMagic = 0x54464854;  // "THFT" when little-endian.
+constexpr uint32_t kVersion = 1;
+constexpr int8_t kEmpty = -128;
+
+struct Header {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t num_entries;
+  uint32_t capacity;
+  uint32_t arena_size;
+  uint32_t reserved;
+};
+
+// Offsets of the sections of a table with `capacity` slots.
+struct Layout {
+  explicit Layout(size_t capacity, size_t slot_size, size_t arena_size)
+      : control_offset(sizeof(Header)),
+        slots_offset((control_offset + capacity +
+                      FlatHashtable::kGroupWidth + 3) & ~size_t{3}),
+        arena_offset(slots_offset + capacity * slot_size),
+        bytes(arena_offset + arena_size) {}
+
+  size_t control_offset;
+  size_t slots_offset;
+  size_t arena_offset;
+  size_t bytes;
+};
+
+// MurmurHash64A, stable across runs so that serialized tables stay valid.
+uint64_t Hash(const char* data, size_t size) {
+  constexpr uint64_t kMul = 0xc6a4a7935bd1e995ULL;
+  constexpr int kShift = 47;
+  uint64_t hash = 0x9ae16a3b2f90404fULL ^ (size * kMul);
+  for (; size >= 8; data += 8, size -= 8) {
+    uint64_t k;
+    std::memcpy(&k, data, sizeof(k));
+    k *= kMul;
+    k ^= k >> kShift;
+    k *= kMul;
+    hash ^= k;
+    hash *= kMul;
+  }
+  if (size > 0) {
+    for (size_t i = 0; i < size; ++i) {
+      hash ^= static_cast<uint64_t>(static_cast<uint8_t>(data[i])) << (8 * i);
+    }
+    hash *= kMul;
+  }
+  hash ^= hash >> kShift;
+  hash *= kMul;
+  hash ^= hash >> kShift;
+  return hash;
+}
+
+// The slot of a key is searched from the position given by the upper bits of
+// its hash, and the lower 7 bits are stored in its control byte.
+size_t HashPosition(uint64_t hash) { return static_cast<size_t>(hash >> 7); }
+int8_t HashTag(uint64_t hash) { return static_cast<int8_t>(hash & 0x7f); }
+
+int CountTrailingZeros(uint64_t bits) {
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_ctzll(bits);
+#else
+  int count = 0;
+  for (; (bits & 1) == 0; bits >>= 1) ++count;
+  return count;
+#endif
+}
+
+// The control bytes of kGroupWidth consecutive slots. The Match functions
+// return a mask with one bit set per matching slot, which NextIndex turns
+// into the index of the first of these slots in the group.
+class Group {
+ public:
+#if defined(__SSE2__)
+  explicit Group(const int8_t* control)
+      : control_(_mm_loadu_si128(reinterpret_cast<const __m128i*>(control))) {}
+
+  uint64_t Match(int8_t tag) const {
+    return static_cast<uint32_t>(
+        _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(tag), control_)));
+  }
+
+  // kEmpty is the only control byte with its sign bit set.
+  uint64_t MatchEmpty() const {
+    return static_cast<uint32_t>(_mm_movemask_epi8(control_));
+  }
+
+  static int NextIndex(uint64_t mask) { return CountTrailingZeros(mask); }
+
+ private:
+  __m128i control_;
+#elif defined(__ARM_NEON)
+  explicit Group(const int8_t* control) : control_(vld1q_s8(control)) {}
+
+  uint64_t Match(int8_t tag) const {
+    return ToMask(vceqq_s8(control_, vdupq_n_s8(tag)));
+  }
+
+  uint64_t MatchEmpty() const {
+    return ToMask(vcltq_s8(control_, vdupq_n_s8(0)));
+  }
+
+  // Each slot has 4 bits in the mask.
+  static int NextIndex(uint64_t mask) { return CountTrailingZeros(mask) >> 2; }
+
+ private:
+  // Narrows the 0x00/0xff bytes of `matches` to nibbles and keeps one bit of
+  // each.
+  static uint64_t ToMask(uint8x16_t matches) {
+    const uint8x8_t nibbles =
+        vshrn_n_u16(vreinterpretq_u16_u8(matches), 4);
+    return vget_lane_u64(vreinterpret_u64_u8(nibbles), 0) &
+           0x8888888888888888ULL;
+  }
+
+  int8x16_t control_;
+#else
+  explicit Group(const int8_t* control) : control_(control) {}
+
+  uint64_t Match(int8_t tag) const {
+    uint64_t mask = 0;
+    for (int i = 0; i < FlatHashtable::kGroupWidth; ++i) {
+      if (control_[i] == tag) mask |= uint64_t{1} << i;
+    }
+    return mask;
+  }
+
+  uint64_t MatchEmpty() const { return Match(kEmpty); }
+
+  static int NextIndex(uint64_t mask) { return CountTrailingZeros(mask); }
+
+ private:
+  const int8_t* control_;
+#endif
+};
+
+size_t ComputeCapacity(size_t num_entries) {
+  // Keep the load factor at most 7/8 so that probing ends quickly on the
+  // empty slots.
+  size_t capacity = FlatHashtable::kGroupWidth;
+  while (capacity - capacity / 8 < num_entries) capacity *= 2;
+  return capacity;
+}
+
+}  // namespace
+
+FlatHashtable::FlatHashtable() = default;
+
+size_t FlatHashtable::Probe(const int8_t* control, const Slot* slots,
+                            const char* arena, size_t capacity_mask,
+                            const StringRef& key, uint64_t hash,
+                            bool* found) {
+  const int8_t tag = HashTag(hash);
+  size_t position = HashPosition(hash) & capacity_mask;
+  // Triangular probing over groups visits every group once as the capacity
+  // is a power of 2.
+  for (size_t step = kGroupWidth;; step += kGroupWidth) {
+    const Group group(control + position);
+    for (uint64_t mask = group.Match(tag); mask != 0; mask &= mask - 1) {
+      const size_t index =
+          (position + Group::NextIndex(mask)) & capacity_mask;
+      const Slot& slot = slots[index];
+      if (slot.key_size == key.len &&
+          std::memcmp(arena + slot.key_offset, key.str, key.len) == 0) {
+        *found = true;
+        return index;
+      }
+    }
+    const uint64_t empty = group.MatchEmpty();
+    if (empty != 0) {
+      *found = false;
+      return (position + Group::NextIndex(empty)) & capacity_mask;
+    }
+    position = (position + step) & capacity_mask;
+  }
+}
+
+bool FlatHashtable::Build(const std::vector<StringRef>& keys,
+                          const std::vector<StringRef>& values,
+                          FlatHashtable* table) {
+  if (keys.size() != values.size()) return false;
+  constexpr size_t kMaxSize = std::numeric_limits<uint32_t>::max();
+  size_t arena_size = 0;
+  for (size_t i = 0; i < keys.size(); ++i) {
+    arena_size += keys[i].len + values[i].len;
+  }
+  const size_t capacity = ComputeCapacity(keys.size());
+  const Layout layout(capacity, sizeof(Slot), arena_size);
+  if (layout.bytes > kMaxSize) return false;
+
+  std::vector<uint64_t> buffer((layout.bytes + 7) / 8);
+  char* data = reinterpret_cast<char*>(buffer.data());
+  auto* control = reinterpret_cast<int8_t*>(data + layout.control_offset);
+  auto* slots = reinterpret_cast<Slot*>(data + layout.slots_offset);
+  char* arena = data + layout.arena_offset;
+  std::memset(control, kEmpty, capacity + kGroupWidth);
+
+  uint32_t num_entries = 0;
+  uint32_t arena_used = 0;
+  for (size_t i = 0; i < keys.size(); ++i) {
+    bool found;
+    const uint64_t hash = Hash(keys[i].str, keys[i].len);
+    const size_t index =
+        Probe(control, slots, arena, capacity - 1, keys[i], hash, &found);
+    if (found) continue;
+    Slot& slot = slots[index];
+    slot.key_offset = arena_used;
+    slot.key_size = static_cast<uint32_t>(keys[i].len);
+    std::memcpy(arena + arena_used, keys[i].str, keys[i].len);
+    arena_used += slot.key_size;
+    slot.value_offset = arena_used;
+    slot.value_size = static_cast<uint32_t>(values[i].len);
+    std::memcpy(arena + arena_used, values[i].str, values[i].len);
+    arena_used += slot.value_size;
+    const int8_t tag = HashTag(hash);
+    control[index] = tag;
+    // The control bytes of the first group are mirrored after the last slot
+    // so that groups can be loaded from any position without wrapping.
+    if (index < kGroupWidth) control[capacity + index] = tag;
+    ++num_entries;
+  }
+
+  const Header header = {kMagic,     kVersion,
+                         num_entries, static_cast<uint32_t>(capacity),
+                         arena_used,  0};
+  std::memcpy(data, &header, sizeof(header));
+  table->owned_buffer_ = std::move(buffer);
+  table->SetData(reinterpret_cast<const char*>(table->owned_buffer_.data()),
+                 layout.arena_offset + arena_used);
+  return true;
+}
+
+bool FlatHashtable::FromBuffer(const char* data, size_t size,
+                               FlatHashtable* table) {
+  if (data == nullptr || size < sizeof(Header) ||
+      reinterpret_cast<uintptr_t>(data) % alignof(Slot) != 0) {
+    return false;
+  }
+  Header header;
+  std::memcpy(&header, data, sizeof(header));
+  const size_t capacity = header.capacity;
+  if (header.magic != kMagic || header.version != kVersion ||
+      capacity < kGroupWidth || (capacity & (capacity - 1)) != 0 ||
+      capacity > size / sizeof(Slot) || header.arena_size > size) {
+    return false;
+  }
+  const Layout layout(capacity, sizeof(Slot), header.arena_size);
+  if (layout.bytes > size) return false;
+
+  // Check that every entry lies within the arena, so that lookups never read
+  // out of the buffer.
+  const auto* control =
+      reinterpret_cast<const int8_t*>(data + layout.control_offset);
+  const auto* slots = reinterpret_cast<const Slot*>(data + layout.slots_offset);
+  size_t num_entries = 0;
+  for (size_t i = 0; i < capacity; ++i) {
+    if (control[i] == kEmpty) continue;
+    const Slot& slot = slots[i];
+    if (size_t{slot.key_offset} + slot.key_size > header.arena_size ||
+        size_t{slot.value_offset} + slot.value_size > header.arena_size) {
+      return false;
+    }
+    ++num_entries;
+  }
+  if (num_entries != header.num_entries || num_entries == capacity) {
+    return false;
+  }
+  for (int i = 0; i < kGroupWidth; ++i) {
+    if (control[capacity + i] != control[i]) return false;
+  }
+
+  table->owned_buffer_.clear();
+  table->SetData(data, layout.bytes);
+  return true;
+}
+
+void FlatHashtable::SetData(const char* data, size_t bytes) {
+  Header header;
+  std::memcpy(&header, data, sizeof(header));
+  const Layout layout(header.capacity, sizeof(Slot), header.arena_size);
+  data_ = data;
+  bytes_ = bytes;
+  num_entries_ = header.num_entries;
+  capacity_mask_ = header.capacity - 1;
+  control_ = reinterpret_cast<const int8_t*>(data + layout.control_offset);
+  slots_ = reinterpret_cast<const Slot*>(data + layout.slots_offset);
+  arena_ = data + layout.arena_offset;
+}
+
+bool FlatHashtable::Find(const StringRef& key, StringRef* value) const {
+  if (num_entries_ == 0) return false;
+  bool found;
+  const size_t index = Probe(control_, slots_, arena_, capacity_mask_, key,
+                             Hash(key.str, key.len), &found);
+  if (!found) return false;
+  value->str = arena_ + slots_[index].value_offset;
+  value->len = slots_[index].value_size;
+  return true;
+}
+
+}  // namespace internal
+}  // namespace resource
+}  // namespace tflite
@@ -0,0 +1,109 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_EXPERIMENTAL_RESOURCE_FLAT_HASHTABLE_H_
+#define TENSORFLOW_LITE_EXPERIMENTAL_RESOURCE_FLAT_HASHTABLE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "tensorflow/lite/string_util.h"
+
+namespace tflite {
+namespace resource {
+namespace internal {
+
+/// WARNING: Experimental interface, subject to change.
+/// An immutable hash table from byte strings to byte strings, stored in a
+/// single flat buffer:
+///  - a header,
+///  - one control byte per slot, holding 7 bits of the hash of the key of the
+///    slot or marking it empty. Slots are probed in groups of kGroupWidth
+///    whose control bytes are compared to the searched hash at once with SIMD
+///    instructions where available,
+///  - the slots, each holding the offsets and sizes of its key and value,
+///  - the arena holding all the keys and values back to back.
+/// The buffer is the serialized form of the table: it can be written out and
+/// viewed later, e.g. from a memory mapped file, without being parsed or
+/// copied. It is only portable between hosts of the same endianness.
+class FlatHashtable {
+ public:
+  static constexpr int kGroupWidth = 16;
+
+  /// Creates an empty table.
+  FlatHashtable();
+
+  FlatHashtable(FlatHashtable&&) = default;
+  FlatHashtable& operator=(FlatHashtable&&) = default;
+  FlatHashtable(const FlatHashtable&) = delete;
+  FlatHashtable& operator=(const FlatHashtable&) = delete;
+
+  /// Builds a table mapping `keys[i]` to `values[i]` in `table`. If a key is
+  /// repeated, its first value is kept. Returns false if the table would
+  /// exceed 4GB or the inputs have different sizes.
+  static bool Build(const std::vector<StringRef>& keys,
+                    const std::vector<StringRef>& values,
+                    FlatHashtable* table);
+
+  /// Makes `table` a view of the serialized table `data` of `size` bytes,
+  /// which must be 4 bytes aligned and outlive the table. Returns false if
+  /// `data` isn't a valid table.
+  static bool FromBuffer(const char* data, size_t size, FlatHashtable* table);
+
+  /// Finds the value of `key`. Returns false if `key` isn't in the table.
+  bool Find(const StringRef& key, StringRef* value) const;
+
+  /// Returns the number of entries.
+  size_t size() const { return num_entries_; }
+
+  /// Returns the serialized table.
+  const char* data() const { return data_; }
+  size_t bytes() const { return bytes_; }
+
+ private:
+  struct Slot {
+    uint32_t key_offset;
+    uint32_t key_size;
+    uint32_t value_offset;
+    uint32_t value_size;
+  };
+
+  // Points the members below into the valid table of `bytes` at `data`.
+  void SetData(const char* data, size_t bytes);
+
+  // Returns the index of the slot holding `key` and sets `*found` to true, or
+  // returns the index of the empty slot where `key` would be inserted.
+  static size_t Probe(const int8_t* control, const Slot* slots,
+                      const char* arena, size_t capacity_mask,
+                      const StringRef& key, uint64_t hash, bool* found);
+
+  // Backs data_ when the table owns its buffer. uint64_t keeps it aligned.
+  std::vector<uint64_t> owned_buffer_;
+  const char* data_ = nullptr;
+  size_t bytes_ = 0;
+
+  size_t num_entries_ = 0;
+  // The number of slots minus one, the number of slots being a power of 2.
+  size_t capacity_mask_ = 0;
+  const int8_t* control_ = nullptr;
+  const Slot* slots_ = nullptr;
+  const char* arena_ = nullptr;
+};
+
+}  // namespace internal
+}  // namespace resource
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_EXPERIMENTAL_RESOURCE_FLAT_HASHTABLE_H_
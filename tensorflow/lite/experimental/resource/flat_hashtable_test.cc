@@ -0,0 +1,160 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/experimental/resource/flat_hashtable.h"
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/string_util.h"
+
+namespace tflite {
+namespace resource {
+namespace internal {
+namespace {
+
+StringRef ToRef(const std::string& str) { return {str.data(), str.size()}; }
+
+std::string ToString(const StringRef& ref) {
+  return std::string(ref.str, ref.len);
+}
+
+// Builds a table from the given keys and values, which must outlive it.
+FlatHashtable BuildTable(const std::vector<std::string>& keys,
+                         const std::vector<std::string>& values) {
+  std::vector<StringRef> key_refs, value_refs;
+  for (const std::string& key : keys) key_refs.push_back(ToRef(key));
+  for (const std::string& value : values) value_refs.push_back(ToRef(value));
+  FlatHashtable table;
+  EXPECT_TRUE(FlatHashtable::Build(key_refs, value_refs, &table));
+  return table;
+}
+
+TEST(FlatHashtableTest, Find) {
+  const std::vector<std::string> keys = {"a", "bc", "", "long key 0123456789"};
+  const std::vector<std::string> values = {"1", "", "3", "4"};
+  FlatHashtable table = BuildTable(keys, values);
+  EXPECT_EQ(table.size(), 4);
+  for (size_t i = 0; i < keys.size(); ++i) {
+    StringRef value;
+    ASSERT_TRUE(table.Find(ToRef(keys[i]), &value)) << keys[i];
+    EXPECT_EQ(ToString(value), values[i]);
+  }
+  StringRef value;
+  EXPECT_FALSE(table.Find(ToRef("b"), &value));
+  EXPECT_FALSE(table.Find(ToRef("abc"), &value));
+}
+
+TEST(FlatHashtableTest, FirstDuplicateWins) {
+  FlatHashtable table = BuildTable({"a", "b", "a"}, {"1", "2", "3"});
+  EXPECT_EQ(table.size(), 2);
+  StringRef value;
+  ASSERT_TRUE(table.Find(ToRef("a"), &value));
+  EXPECT_EQ(ToString(value), "1");
+}
+
+TEST(FlatHashtableTest, Empty) {
+  StringRef value;
+  FlatHashtable default_table;
+  EXPECT_EQ(default_table.size(), 0);
+  EXPECT_FALSE(default_table.Find(ToRef("a"), &value));
+
+  FlatHashtable table = BuildTable({}, {});
+  EXPECT_EQ(table.size(), 0);
+  EXPECT_FALSE(table.Find(ToRef("a"), &value));
+}
+
+TEST(FlatHashtableTest, MismatchedSizes) {
+  const std::string key = "a";
+  FlatHashtable table;
+  EXPECT_FALSE(FlatHashtable::Build({ToRef(key)}, {}, &table));
+}
+
+TEST(FlatHashtableTest, ManyInt64Keys) {
+  constexpr int kNumKeys = 10000;
+  std::vector<int64_t> keys(kNumKeys);
+  std::vector<std::string> values(kNumKeys);
+  std::vector<StringRef> key_refs, value_refs;
+  for (int i = 0; i < kNumKeys; ++i) {
+    keys[i] = static_cast<int64_t>(i) * 7919;
+    values[i] = std::to_string(i);
+  }
+  for (int i = 0; i < kNumKeys; ++i) {
+    key_refs.push_back(
+        {reinterpret_cast<const char*>(&keys[i]), sizeof(int64_t)});
+    value_refs.push_back(ToRef(values[i]));
+  }
+  FlatHashtable table;
+  ASSERT_TRUE(FlatHashtable::Build(key_refs, value_refs, &table));
+  EXPECT_EQ(table.size(), kNumKeys);
+  for (int i = 0; i < kNumKeys; ++i) {
+    StringRef value;
+    ASSERT_TRUE(table.Find(key_refs[i], &value));
+    EXPECT_EQ(ToString(value), values[i]);
+  }
+  const int64_t missing_key = 1;
+  StringRef value;
+  EXPECT_FALSE(table.Find(
+      {reinterpret_cast<const char*>(&missing_key), sizeof(int64_t)}, &value));
+}
+
+TEST(FlatHashtableTest, FromBuffer) {
+  FlatHashtable table = BuildTable({"a", "b"}, {"1", "2"});
+  std::vector<uint32_t> buffer((table.bytes() + 3) / 4);
+  memcpy(buffer.data(), table.data(), table.bytes());
+  const char* data = reinterpret_cast<const char*>(buffer.data());
+
+  FlatHashtable view;
+  ASSERT_TRUE(FlatHashtable::FromBuffer(data, table.bytes(), &view));
+  EXPECT_EQ(view.data(), data);
+  EXPECT_EQ(view.size(), 2);
+  StringRef value;
+  ASSERT_TRUE(view.Find(ToRef("b"), &value));
+  EXPECT_EQ(ToString(value), "2");
+  EXPECT_FALSE(view.Find(ToRef("c"), &value));
+}
+
+TEST(FlatHashtableTest, FromBufferRejectsInvalidData) {
+  FlatHashtable table = BuildTable({"a", "b"}, {"1", "2"});
+  std::vector<uint32_t> buffer((table.bytes() + 3) / 4);
+  memcpy(buffer.data(), table.data(), table.bytes());
+  const char* data = reinterpret_cast<const char*>(buffer.data());
+  FlatHashtable view;
+
+  // Truncated.
+  EXPECT_FALSE(FlatHashtable::FromBuffer(data, table.bytes() - 1, &view));
+  EXPECT_FALSE(FlatHashtable::FromBuffer(data, 4, &view));
+  // Bad magic number.
+  buffer[0] ^= 1;
+  EXPECT_FALSE(FlatHashtable::FromBuffer(data, table.bytes(), &view));
+  buffer[0] ^= 1;
+  // Capacity isn't a power of 2.
+  buffer[3] += 1;
+  EXPECT_FALSE(FlatHashtable::FromBuffer(data, table.bytes(), &view));
+  buffer[3] -= 1;
+  // Entry count doesn't match the control bytes.
+  buffer[2] += 1;
+  EXPECT_FALSE(FlatHashtable::FromBuffer(data, table.bytes(), &view));
+  buffer[2] -= 1;
+
+  EXPECT_TRUE(FlatHashtable::FromBuffer(data, table.bytes(), &view));
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace resource
+}  // namespace tflite
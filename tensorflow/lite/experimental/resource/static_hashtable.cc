@@ -15,14 +15,66 @@ limitations under the License.
 
 #include "tensorflow/lite/experimental/resource/static_hashtable.h"
 
+#include <cstring>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "tensorflow/lite/experimental/resource/lookup_interfaces.h"
 
 namespace tflite {
 namespace resource {
 namespace internal {
+namespace {
+
+// Returns the bytes of the element of `tensor` at the given index position, as
+// they are stored in the FlatHashtable.
+template <typename T>
+StringRef GetElement(const TfLiteTensor* tensor, int index) {
+  return {reinterpret_cast<const char*>(GetTensorData<T>(tensor) + index),
+          sizeof(T)};
+}
+
+template <>
+StringRef GetElement<std::string>(const TfLiteTensor* tensor, int index) {
+  return GetString(tensor, index);
+}
+
+// Writes the elements of a tensor from their bytes as stored in the
+// FlatHashtable.
+template <typename T>
+class ElementWriter {
+ public:
+  explicit ElementWriter(TfLiteTensor* tensor)
+      : output_data_(GetTensorData<T>(tensor)) {}
+
+  void SetData(int index, const StringRef& value) {
+    std::memcpy(output_data_ + index, value.str, sizeof(T));
+  }
+
+  void Commit() {}
+
+ private:
+  T* output_data_;
+};
+
+// The strings are queued and written to the tensor storage by Commit,
+// regardless of the index.
+template <>
+class ElementWriter<std::string> {
+ public:
+  explicit ElementWriter(TfLiteTensor* tensor) : tensor_(tensor) {}
+
+  void SetData(int index, const StringRef& value) { buf_.AddString(value); }
+
+  void Commit() { buf_.WriteToTensor(tensor_, nullptr); }
+
+ private:
+  TfLiteTensor* tensor_;
+  DynamicBuffer buf_;
+};
+
+}  // namespace
 
 template <typename KeyType, typename ValueType>
 TfLiteStatus StaticHashtable<KeyType, ValueType>::Lookup(
@@ -36,15 +88,14 @@ TfLiteStatus StaticHashtable<KeyType, ValueType>::Lookup(
   const int size =
       MatchingFlatSize(GetTensorShape(keys), GetTensorShape(values));
 
-  auto key_tensor_reader = TensorReader<KeyType>(keys);
-  auto value_tensor_writer = TensorWriter<ValueType>(values);
-  auto default_value_tensor_reader = TensorReader<ValueType>(default_value);
-  ValueType first_default_value = default_value_tensor_reader.GetData(0);
+  ElementWriter<ValueType> value_tensor_writer(values);
+  const StringRef first_default_value =
+      GetElement<ValueType>(default_value, 0);
 
   for (int i = 0; i < size; ++i) {
-    auto result = map_.find(key_tensor_reader.GetData(i));
-    if (result != map_.end()) {
-      value_tensor_writer.SetData(i, result->second);
+    StringRef result;
+    if (table_.Find(GetElement<KeyType>(keys, i), &result)) {
+      value_tensor_writer.SetData(i, result);
     } else {
       value_tensor_writer.SetData(i, first_default_value);
     }
@@ -72,10 +123,17 @@ TfLiteStatus StaticHashtable<KeyType, ValueType>::Import(
   const int size =
       MatchingFlatSize(GetTensorShape(keys), GetTensorShape(values));
 
-  auto key_tensor_reader = TensorReader<KeyType>(keys);
-  auto value_tensor_writer = TensorReader<ValueType>(values);
+  std::vector<StringRef> key_refs(size);
+  std::vector<StringRef> value_refs(size);
   for (int i = 0; i < size; ++i) {
-    map_.insert({key_tensor_reader.GetData(i), value_tensor_writer.GetData(i)});
+    key_refs[i] = GetElement<KeyType>(keys, i);
+    value_refs[i] = GetElement<ValueType>(values, i);
+  }
+  // The table copies the keys and values, so they don't need to outlive the
+  // tensors.
+  if (!FlatHashtable::Build(key_refs, value_refs, &table_)) {
+    TF_LITE_KERNEL_LOG(context, "hashtable is too large");
+    return kTfLiteError;
   }
 
   is_initialized_ = true;
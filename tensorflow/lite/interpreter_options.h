@@ -19,6 +19,8 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_INTERPRETER_OPTIONS_H_
 #define TENSORFLOW_LITE_INTERPRETER_OPTIONS_H_
 
+#include <cstddef>
+
 namespace tflite {
 
 /// Options class for `Interpreter`.
@@ -29,7 +31,9 @@ class InterpreterOptions {
       : experimental_preserve_all_tensors_(false),
         experimental_ensure_dynamic_tensors_are_released_(false),
         experimental_optimize_memory_for_large_tensors_(0),
-        experimental_disable_delegate_clustering_(false) {}
+        experimental_disable_delegate_clustering_(false),
+        experimental_defer_subgraph_construction_(false),
+        experimental_rematerialization_memory_budget_(0) {}
 
   /// Preserving all intermediates tensors for debugging.
   /// WARNING: This is an experimental API and subject to change.
@@ -93,11 +97,55 @@ class InterpreterOptions {
     experimental_disable_delegate_clustering_ = value;
   }
 
+  /// Defers building the nodes of the non-primary subgraphs (e.g. the
+  /// branches of control flow ops and the subgraphs of other signatures) until
+  /// they are first prepared with `AllocateTensors`. Their tensors are still
+  /// created when the interpreter is built. The constant buffers of each
+  /// subgraph are also prefetched in execution order when its nodes are built
+  /// if the model is memory mapped.
+  /// Delegates applied to a subgraph whose nodes aren't built yet are applied
+  /// once they are; if that fails, the subgraph runs without them. The op
+  /// resolver used to build the interpreter must outlive it.
+  /// WARNING: This is an experimental API and subject to change.
+  void SetDeferSubgraphConstruction(bool value = true) {
+    experimental_defer_subgraph_construction_ = value;
+  }
+
+  /// Returns if the `experimental_defer_subgraph_construction_` feature is
+  /// enabled.
+  /// WARNING: This is an experimental API and subject to change.
+  bool GetDeferSubgraphConstruction() {
+    return experimental_defer_subgraph_construction_;
+  }
+
+  /// Recomputes some intermediate tensors right before their later uses
+  /// instead of keeping them alive in between, to bring the non-persistent
+  /// arena of each subgraph under `bytes`. The ops to rerun are chosen the
+  /// first time the tensors of a subgraph are allocated, among the builtin ops
+  /// without side effects, which trades inference time for peak memory. The
+  /// peak is estimated from the tensor sizes and the budget may not be reached.
+  /// Subgraphs with dynamic tensors or already delegated are left unchanged,
+  /// while delegates applied afterwards see the recomputing ops as any other.
+  /// Rematerialization segments stored in the model metadata are applied
+  /// regardless of this option. 0 disables the feature.
+  /// WARNING: This is an experimental API and subject to change.
+  void SetRematerializationMemoryBudget(size_t bytes) {
+    experimental_rematerialization_memory_budget_ = bytes;
+  }
+
+  /// Returns the memory budget for rematerialization, 0 if disabled.
+  /// WARNING: This is an experimental API and subject to change.
+  size_t GetRematerializationMemoryBudget() {
+    return experimental_rematerialization_memory_budget_;
+  }
+
  private:
   bool experimental_preserve_all_tensors_;
   bool experimental_ensure_dynamic_tensors_are_released_;
   int experimental_optimize_memory_for_large_tensors_;
   bool experimental_disable_delegate_clustering_;
+  bool experimental_defer_subgraph_construction_;
+  size_t experimental_rematerialization_memory_budget_;
 };
 
 }  // namespace tflite
@@ -1127,6 +1127,72 @@ TEST(BasicInterpreter, ReleaseDynamicTensors) {
   ASSERT_EQ(interpreter.tensor(3)->bytes, sizeof(float) * 6 * 6);
 }
 
+// Builds in -> NEG -> a -> NEG -> b -> NEG -> c, ADD(b, c) -> d and
+// ADD(a, d) -> out, where `a` is alive while the others are computed.
+void BuildRematerializationGraph(Interpreter* interpreter) {
+  ASSERT_EQ(interpreter->AddTensors(6), kTfLiteOk);
+  interpreter->SetInputs({0});
+  interpreter->SetOutputs({5});
+  for (int i = 0; i < 6; ++i) {
+    ASSERT_EQ(interpreter->SetTensorParametersReadWrite(
+                  i, kTfLiteFloat32, "", {256}, TfLiteQuantizationParams()),
+              kTfLiteOk);
+  }
+  TfLiteRegistration* neg_op = ops::builtin::Register_NEG();
+  TfLiteRegistration* add_op = ops::builtin::Register_ADD();
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_EQ(interpreter->AddNodeWithParameters({i}, {i + 1}, nullptr, 0,
+                                                 nullptr, neg_op),
+              kTfLiteOk);
+  }
+  const std::vector<std::vector<int>> add_inputs = {{2, 3}, {1, 4}};
+  for (int i = 0; i < add_inputs.size(); ++i) {
+    auto* params =
+        reinterpret_cast<TfLiteAddParams*>(malloc(sizeof(TfLiteAddParams)));
+    params->activation = kTfLiteActNone;
+    params->pot_scale_int16 = false;
+    ASSERT_EQ(interpreter->AddNodeWithParameters(add_inputs[i], {4 + i},
+                                                 nullptr, 0, params, add_op),
+              kTfLiteOk);
+  }
+}
+
+void CheckRematerializationGraphOutput(Interpreter* interpreter) {
+  float* input = interpreter->typed_input_tensor<float>(0);
+  for (int i = 0; i < 256; ++i) input[i] = i;
+  ASSERT_EQ(interpreter->Invoke(), kTfLiteOk);
+  const float* output = interpreter->typed_output_tensor<float>(0);
+  for (int i = 0; i < 256; ++i) EXPECT_EQ(output[i], -i);
+}
+
+TEST(InterpreterRematerializationTest, RematerializeSegments) {
+  Interpreter interpreter;
+  BuildRematerializationGraph(&interpreter);
+  ASSERT_EQ(interpreter.primary_subgraph().RematerializeSegments(
+                {RematSegment{0, 1, 4}}),
+            kTfLiteOk);
+  EXPECT_THAT(interpreter.execution_plan(), ElementsAre(0, 1, 2, 3, 5, 4));
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  CheckRematerializationGraphOutput(&interpreter);
+
+  // The segment must come before the node it is recomputed for.
+  EXPECT_EQ(interpreter.primary_subgraph().RematerializeSegments(
+                {RematSegment{3, 4, 1}}),
+            kTfLiteError);
+}
+
+TEST(InterpreterRematerializationTest, MemoryBudget) {
+  Interpreter interpreter;
+  BuildRematerializationGraph(&interpreter);
+  InterpreterOptions options;
+  // Five tensors are alive when computing `d` without rematerialization.
+  options.SetRematerializationMemoryBudget(4 * 256 * sizeof(float));
+  interpreter.ApplyOptions(&options);
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  EXPECT_THAT(interpreter.execution_plan(), ElementsAre(0, 1, 2, 3, 5, 4));
+  CheckRematerializationGraphOutput(&interpreter);
+}
+
 TEST(InterpreterTensorsCapacityTest, TestWithinHeadroom) {
   Interpreter interpreter;
   ASSERT_EQ(interpreter.AddTensors(Interpreter::kTensorsReservedCapacity),
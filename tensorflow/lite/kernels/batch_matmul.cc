@@ -65,6 +65,14 @@ struct OpData {
   int scratch_tensor_index;
   bool rhs_transposed;
   bool compute_row_sums = false;
+  // Whether the RHS is a constant tensor, so that the GEMM backend can cache
+  // its packed form across invocations. The RHS passed to the Eval helpers may
+  // be its transposed copy, which is only rewritten when the RHS changes.
+  bool rhs_cacheable = false;
+  // Whether the LHS passed to the Eval helpers is a constant tensor. Its
+  // transposed copy lives in the arena, whose addresses are reused by other
+  // tensors, so it is never cacheable.
+  bool lhs_cacheable = false;
 };
 
 struct OpContext {
@@ -530,8 +538,9 @@ TfLiteStatus EvalInt8Int8(TfLiteContext* context, const OpData* data,
   op_params.output_shift = data->output_shift;
   op_params.quantized_activation_min = data->output_activation_min;
   op_params.quantized_activation_max = data->output_activation_max;
-  op_params.lhs_cacheable = IsConstantTensor(lhs);
-  op_params.rhs_cacheable = IsConstantTensor(rhs);
+  // The kernel computes rhs * lhs, see the comment of Eval().
+  op_params.lhs_cacheable = data->rhs_cacheable;
+  op_params.rhs_cacheable = data->lhs_cacheable;
 
   if (kernel_type == kReference) {
     reference_ops::BatchMatMul<int8_t, int32_t>(
@@ -568,8 +577,9 @@ TfLiteStatus EvalInt8Int32(TfLiteContext* context, const OpData* data,
   op_params.output_shift = data->output_shift;
   op_params.quantized_activation_min = data->output_activation_min;
   op_params.quantized_activation_max = data->output_activation_max;
-  op_params.lhs_cacheable = IsConstantTensor(lhs);
-  op_params.rhs_cacheable = IsConstantTensor(rhs);
+  // The kernel computes rhs * lhs, see the comment of Eval().
+  op_params.lhs_cacheable = data->rhs_cacheable;
+  op_params.rhs_cacheable = data->lhs_cacheable;
 
   // Set BatchMatMul lhs param to rhs(filter) and rhs param to lhs(input). For
   // the reason, see comment of Eval() function.
@@ -757,6 +767,8 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
   if (adj_x) {
     TransposeRowsColumns(context, lhs, GetTemporary(context, node, 0));
   }
+  op_data->rhs_cacheable = IsConstantTensor(rhs);
+  op_data->lhs_cacheable = IsConstantTensor(lhs) && !adj_x;
   RuntimeShape rhs_shape =
       adj_y ? orig_rhs_shape : SwapRowColumnDims(orig_rhs_shape);
   RuntimeShape lhs_shape =
@@ -770,7 +782,9 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
                                    lhs_shape, GetTensorData<float>(lhs_tensor),
                                    GetTensorShape(output),
                                    GetTensorData<float>(output),
-                                   CpuBackendContext::GetFromContext(context));
+                                   CpuBackendContext::GetFromContext(context),
+                                   /*lhs_cacheable=*/op_data->rhs_cacheable,
+                                   /*rhs_cacheable=*/op_data->lhs_cacheable);
       } else {
         reference_ops::BatchMatMul(rhs_shape, GetTensorData<float>(rhs_tensor),
                                    lhs_shape, GetTensorData<float>(lhs_tensor),
@@ -416,6 +416,84 @@ TEST(ConstRHSBatchMatMulOpModel, RHSNotAdjoint) {
   EXPECT_THAT(model.GetOutputShape(), ElementsAreArray({1, 6, 3}));
 }
 
+// Two BatchMatMuls with adjoint constant LHS of shape [k, m] and a shared
+// RHS input of shape [k, n]. The transposed copies of both LHS live in the
+// arena and may share an address, so they must not be cached by the GEMM
+// backend.
+class ConstLHSAdjointBatchMatMulOpModel : public MultiOpModel {
+ public:
+  ConstLHSAdjointBatchMatMulOpModel(int k, int m, int n,
+                                    const std::vector<float>& lhs1_data,
+                                    const std::vector<float>& lhs2_data) {
+    const int lhs1_id = AddConstInput<float>(TensorType_FLOAT32, lhs1_data,
+                                             {k, m});
+    const int lhs2_id = AddConstInput<float>(TensorType_FLOAT32, lhs2_data,
+                                             {k, m});
+    rhs_id_ = AddInput({TensorType_FLOAT32, {k, n}});
+    output1_id_ = AddOutput(TensorType_FLOAT32);
+    output2_id_ = AddOutput(TensorType_FLOAT32);
+    AddBuiltinOp(BuiltinOperator_BATCH_MATMUL,
+                 BuiltinOptions_BatchMatMulOptions,
+                 CreateBatchMatMulOptions(builder_, /*adj_x=*/true,
+                                          /*adj_y=*/false)
+                     .Union(),
+                 {lhs1_id, rhs_id_}, {output1_id_});
+    AddBuiltinOp(BuiltinOperator_BATCH_MATMUL,
+                 BuiltinOptions_BatchMatMulOptions,
+                 CreateBatchMatMulOptions(builder_, /*adj_x=*/true,
+                                          /*adj_y=*/false)
+                     .Union(),
+                 {lhs2_id, rhs_id_}, {output2_id_});
+    BuildInterpreter({{k, m}, {k, m}, {k, n}});
+  }
+
+  int rhs() const { return rhs_id_; }
+  std::vector<float> GetOutput1() { return ExtractVector<float>(output1_id_); }
+  std::vector<float> GetOutput2() { return ExtractVector<float>(output2_id_); }
+
+ private:
+  int rhs_id_;
+  int output1_id_;
+  int output2_id_;
+};
+
+// Returns lhs^T * rhs for a [k, m] lhs and a [k, n] rhs.
+std::vector<float> AdjointMatMul(int k, int m, int n,
+                                 const std::vector<float>& lhs,
+                                 const std::vector<float>& rhs) {
+  std::vector<float> result(m * n, 0.0f);
+  for (int i = 0; i < m; ++i) {
+    for (int j = 0; j < n; ++j) {
+      for (int l = 0; l < k; ++l) {
+        result[i * n + j] += lhs[l * m + i] * rhs[l * n + j];
+      }
+    }
+  }
+  return result;
+}
+
+TEST(ConstLHSAdjointBatchMatMulOpModel, InvokeTwiceWithDifferentData) {
+  const int k = 32, m = 48, n = 64;
+  std::vector<float> lhs1(k * m), lhs2(k * m), rhs1(k * n), rhs2(k * n);
+  for (int i = 0; i < k * m; ++i) {
+    lhs1[i] = i % 7;
+    lhs2[i] = -(i % 5);
+  }
+  for (int i = 0; i < k * n; ++i) {
+    rhs1[i] = i % 3;
+    rhs2[i] = 1 - i % 4;
+  }
+  ConstLHSAdjointBatchMatMulOpModel model(k, m, n, lhs1, lhs2);
+  for (const std::vector<float>* rhs : {&rhs1, &rhs2}) {
+    model.PopulateTensor<float>(model.rhs(), *rhs);
+    ASSERT_EQ(model.Invoke(), kTfLiteOk);
+    EXPECT_THAT(model.GetOutput1(),
+                ElementsAreArray(AdjointMatMul(k, m, n, lhs1, *rhs)));
+    EXPECT_THAT(model.GetOutput2(),
+                ElementsAreArray(AdjointMatMul(k, m, n, lhs2, *rhs)));
+  }
+}
+
 // In the hybrid model the weights are quantized int8. But the input
 // and output are expected to be in float precision.
 class HybridBatchMatMulOpModel : public SingleOpModel {
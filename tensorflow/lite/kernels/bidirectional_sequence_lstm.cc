@@ -151,13 +151,19 @@ enum TemporaryTensor {
   kFwRowSums = 16,
   kBwRowSums = 17,
   kAuxInputQuantized = 18,  // Optional, quantized tensor for auxiliary input.
-  kNumTemporaryTensors = 19,
+  // Input projections of the gates over the whole sequence, shared by the
+  // forward and backward passes.
+  kInputProjections = 19,
+  kNumTemporaryTensors = 20,
 };
 
 struct OpData {
   int scratch_tensor_index;
   bool compute_fw_row_sums = false;
   bool compute_bw_row_sums = false;
+  // Index of the input projections in node->temporaries, or -1 if the
+  // sequence is evaluated step by step.
+  int input_projections_index = -1;
 };
 
 void* Init(TfLiteContext* context, const char* buffer, size_t length) {
@@ -558,13 +564,24 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   // The weights are of consistent type, so it suffices to check one.
   const bool is_hybrid_op = IsHybridOp(input, fw_input_to_output_weights);
 
-  TfLiteIntArrayFree(node->temporaries);
+  // Compute the input part of the gates for the whole sequence at once, with
+  // one matrix multiplication per gate instead of one per time step. Inputs
+  // related temporaries then hold all the rows of the sequence.
+  const bool use_input_projections = max_time > 1;
+  const int n_input_rows = use_input_projections ? max_time * n_batch : n_batch;
+
+  int num_temporaries;
   if (is_hybrid_op) {
-    node->temporaries = TfLiteIntArrayCreate(
-        has_aux_input ? kNumTemporaryTensors : kNumTemporaryTensors - 1);
+    // The quantized auxiliary input is only needed with an auxiliary input.
+    num_temporaries = has_aux_input ? kInputProjections : kAuxInputQuantized;
   } else {
-    node->temporaries = TfLiteIntArrayCreate(2);  // the two scratch buffers.
+    num_temporaries = 2;  // the two scratch buffers.
   }
+  op_data->input_projections_index =
+      use_input_projections ? num_temporaries : -1;
+  TfLiteIntArrayFree(node->temporaries);
+  node->temporaries =
+      TfLiteIntArrayCreate(num_temporaries + (use_input_projections ? 1 : 0));
   // Create a scratch buffer tensor.
   node->temporaries->data[kFwScratchBuffer] =
       op_data->scratch_tensor_index + kFwScratchBuffer;
@@ -756,9 +773,10 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
     input_sf->type = kTfLiteFloat32;
     input_sf->allocation_type = kTfLiteArenaRw;
     int scaling_dims[1] = {n_batch};
-    if (!TfLiteIntArrayEqualsArray(input_sf->dims, 1, scaling_dims)) {
+    int input_scaling_dims[1] = {n_input_rows};
+    if (!TfLiteIntArrayEqualsArray(input_sf->dims, 1, input_scaling_dims)) {
       TfLiteIntArray* input_sf_size = TfLiteIntArrayCreate(1);
-      input_sf_size->data[0] = n_batch;
+      input_sf_size->data[0] = n_input_rows;
       TF_LITE_ENSURE_OK(
           context, context->ResizeTensor(context, input_sf, input_sf_size));
     }
@@ -799,9 +817,9 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
     prod_scaling_factors->type = kTfLiteFloat32;
     prod_scaling_factors->allocation_type = kTfLiteArenaRw;
     if (!TfLiteIntArrayEqualsArray(prod_scaling_factors->dims, 1,
-                                   scaling_dims)) {
+                                   input_scaling_dims)) {
       TfLiteIntArray* prod_scaling_factors_size = TfLiteIntArrayCreate(1);
-      prod_scaling_factors_size->data[0] = n_batch;
+      prod_scaling_factors_size->data[0] = n_input_rows;
       TF_LITE_ENSURE_OK(context,
                         context->ResizeTensor(context, prod_scaling_factors,
                                               prod_scaling_factors_size));
@@ -841,12 +859,12 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
       n_cell = std::max(n_cell, fw_aux_input_to_output_weights->dims->data[0]);
       n_cell = std::max(n_cell, bw_aux_input_to_output_weights->dims->data[0]);
     }
-    int accum_scratch_dims[2] = {n_cell, n_batch};
+    int accum_scratch_dims[2] = {n_cell, n_input_rows};
     if (!TfLiteIntArrayEqualsArray(accum_scratch->dims, 2,
                                    accum_scratch_dims)) {
       TfLiteIntArray* accum_size = TfLiteIntArrayCreate(2);
       accum_size->data[0] = n_cell;
-      accum_size->data[1] = n_batch;
+      accum_size->data[1] = n_input_rows;
       TF_LITE_ENSURE_OK(
           context, context->ResizeTensor(context, accum_scratch, accum_size));
     }
@@ -859,9 +877,9 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
         context, GetTemporarySafe(context, node, kInputZeroPoints, &input_zp));
     input_zp->type = kTfLiteFloat32;
     input_zp->allocation_type = kTfLiteArenaRw;
-    if (!TfLiteIntArrayEqualsArray(input_zp->dims, 1, scaling_dims)) {
+    if (!TfLiteIntArrayEqualsArray(input_zp->dims, 1, input_scaling_dims)) {
       TfLiteIntArray* input_zp_size = TfLiteIntArrayCreate(1);
-      input_zp_size->data[0] = n_batch;
+      input_zp_size->data[0] = n_input_rows;
       TF_LITE_ENSURE_OK(
           context, context->ResizeTensor(context, input_zp, input_zp_size));
     }
@@ -966,6 +984,34 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
       }
     }
   }
+
+  if (use_input_projections) {
+    // Allocate a temporary tensor to store the input projections of all the
+    // gates. The passes run one after the other, so it is sized for the
+    // largest of the two.
+    node->temporaries->data[op_data->input_projections_index] =
+        op_data->scratch_tensor_index + kInputProjections;
+    TfLiteTensor* input_projections;
+    TF_LITE_ENSURE_OK(context,
+                      GetTemporarySafe(context, node,
+                                       op_data->input_projections_index,
+                                       &input_projections));
+    input_projections->type = kTfLiteFloat32;
+    input_projections->allocation_type = kTfLiteArenaRw;
+    const int input_projections_dims[3] = {
+        (fw_use_cifg && bw_use_cifg) ? 3 : 4, n_input_rows,
+        std::max(n_fw_cell, n_bw_cell)};
+    if (!TfLiteIntArrayEqualsArray(input_projections->dims, 3,
+                                   input_projections_dims)) {
+      TfLiteIntArray* input_projections_size = TfLiteIntArrayCreate(3);
+      input_projections_size->data[0] = input_projections_dims[0];
+      input_projections_size->data[1] = input_projections_dims[1];
+      input_projections_size->data[2] = input_projections_dims[2];
+      TF_LITE_ENSURE_OK(context,
+                        context->ResizeTensor(context, input_projections,
+                                              input_projections_size));
+    }
+  }
   return kTfLiteOk;
 }
 
@@ -1174,6 +1220,14 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
   const TfLiteTensor* bw_input = non_stacking_mode ? aux_input : input;
   const TfLiteTensor* real_aux_input = non_stacking_mode ? nullptr : aux_input;
 
+  TfLiteTensor* input_projections = nullptr;
+  if (op_data->input_projections_index >= 0) {
+    TF_LITE_ENSURE_OK(context,
+                      GetTemporarySafe(context, node,
+                                       op_data->input_projections_index,
+                                       &input_projections));
+  }
+
   switch (fw_input_to_output_weights->type) {
     case kTfLiteFloat32: {
       TfLiteStatus fw_pass_status = lstm_eval::EvalFloat(
@@ -1198,7 +1252,7 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
           /*recurrent_to_forget_is_diag=*/false,
           /*recurrent_to_cell_is_diag=*/false,
           /*recurrent_to_output_is_diag=*/false,
-          CpuBackendContext::GetFromContext(context));
+          CpuBackendContext::GetFromContext(context), input_projections);
       TF_LITE_ENSURE_OK(context, fw_pass_status);
 
       TfLiteStatus bw_pass_status = lstm_eval::EvalFloat(
@@ -1224,7 +1278,7 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
           /*recurrent_to_forget_is_diag=*/false,
           /*recurrent_to_cell_is_diag=*/false,
           /*recurrent_to_output_is_diag=*/false,
-          CpuBackendContext::GetFromContext(context));
+          CpuBackendContext::GetFromContext(context), input_projections);
       TF_LITE_ENSURE_OK(context, bw_pass_status);
       return kTfLiteOk;
     }
@@ -1315,7 +1369,7 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
           /*recurrent_to_forget_is_diag=*/false,
           /*recurrent_to_cell_is_diag=*/false,
           /*recurrent_to_output_is_diag=*/false,
-          CpuBackendContext::GetFromContext(context));
+          CpuBackendContext::GetFromContext(context), input_projections);
       TF_LITE_ENSURE_OK(context, fw_pass_status);
 
       TfLiteStatus bw_pass_status = lstm_eval::EvalHybrid(
@@ -1360,7 +1414,7 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
           /*recurrent_to_forget_is_diag=*/false,
           /*recurrent_to_cell_is_diag=*/false,
           /*recurrent_to_output_is_diag=*/false,
-          CpuBackendContext::GetFromContext(context));
+          CpuBackendContext::GetFromContext(context), input_projections);
       TF_LITE_ENSURE_OK(context, bw_pass_status);
       return kTfLiteOk;
     }
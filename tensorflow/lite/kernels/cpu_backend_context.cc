@@ -16,6 +16,8 @@ limitations under the License.
 #include "tensorflow/lite/kernels/cpu_backend_context.h"
 
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include "pthreadpool.h"  // from @pthreadpool
 
@@ -127,7 +129,8 @@ CpuBackendContext* CpuBackendContext::GetFromContext(TfLiteContext* context) {
 CpuBackendContext::CpuBackendContext()
     : TfLiteInternalBackendContext(),
       ruy_context_(new ruy::Context),
-      gemmlowp_context_(new gemmlowp::GemmContext) {
+      gemmlowp_context_(new gemmlowp::GemmContext),
+      max_num_threads_(kDefaultNumThreadpoolThreads) {
   SetMaxNumThreads(kDefaultNumThreadpoolThreads);
 // TODO(b/148289189) Remove when clients have transitioned to runtime flag.
 #ifdef TFLITE_WITH_RUY_GEMV
@@ -142,6 +145,7 @@ CpuBackendContext::~CpuBackendContext() {}
 void CpuBackendContext::SetMaxNumThreads(int max_num_threads) {
   const int target_num_threads =
       max_num_threads > -1 ? max_num_threads : kDefaultNumThreadpoolThreads;
+  if (max_num_threads_ != target_num_threads) thread_pool_.reset();
   max_num_threads_ = target_num_threads;
   ruy_context_->set_max_num_threads(target_num_threads);
   gemmlowp_context_->set_max_num_threads(target_num_threads);
@@ -157,6 +161,20 @@ pthreadpool_t CpuBackendContext::get_xnnpack_threadpool() {
   return xnnpack_threadpool_.get();
 }
 
+WorkStealingThreadPool* CpuBackendContext::thread_pool() {
+  if (!thread_pool_ && max_num_threads_ > 1) {
+    thread_pool_ = std::make_unique<WorkStealingThreadPool>(
+        max_num_threads_ - 1, thread_pool_cpus_);
+  }
+  return thread_pool_.get();
+}
+
+void CpuBackendContext::SetThreadPoolCpus(std::vector<int> cpus) {
+  if (thread_pool_cpus_ == cpus) return;
+  thread_pool_cpus_ = std::move(cpus);
+  thread_pool_.reset();
+}
+
 bool CpuBackendContext::PreferGemmlowpOnX86() {
   bool use_gemmlowp_on_x86 = false;
 #if defined(TFLITE_X86_PLATFORM) && TFLITE_HAS_ATTRIBUTE_WEAK && \
@@ -22,12 +22,14 @@ limitations under the License.
 #endif
 
 #include <memory>
+#include <vector>
 
 #include "public/gemmlowp.h"
 #include "pthreadpool.h"  // from @pthreadpool
 #include "ruy/context.h"  // from @ruy
 #include "tensorflow/lite/core/c/common.h"
 #include "tensorflow/lite/external_cpu_backend_context.h"
+#include "tensorflow/lite/kernels/work_stealing_thread_pool.h"
 
 namespace tflite {
 
@@ -56,6 +58,16 @@ class CpuBackendContext final : public TfLiteInternalBackendContext {
 
   pthreadpool_t get_xnnpack_threadpool();
 
+  // Returns the pool shared by cpu_backend_threadpool::Execute and the Eigen
+  // device of eigen_support, creating it if necessary. It has
+  // max_num_threads() - 1 workers, as the calling thread takes part in the
+  // work, and is null if max_num_threads() <= 1.
+  WorkStealingThreadPool* thread_pool();
+
+  // Pins the workers of the thread pool to `cpus`, e.g. the big cores of a
+  // big.LITTLE CPU. An empty list lets them run on any CPU.
+  void SetThreadPoolCpus(std::vector<int> cpus);
+
   void ClearCaches() override { ruy_context_->ClearPrepackedCache(); }
 
   // Gemmlowp on x86 is a deprecated path but some clients may still use
@@ -101,11 +113,10 @@ class CpuBackendContext final : public TfLiteInternalBackendContext {
   const std::unique_ptr<gemmlowp::GemmContext> gemmlowp_context_;
   CpuInfo cpuinfo_;
 
-  // The maximum of threads used for parallelizing TfLite ops. However,
-  // cpu_backend_threadpool::Execute creates as many threads as it's
-  // asked to, regardless of this. Typically a call site would query
-  // cpu_backend_context->max_num_threads() and used that to determine
-  // the number of tasks to create and to give to
+  // The maximum of threads used for parallelizing TfLite ops. It caps the
+  // threads of the pool used by cpu_backend_threadpool::Execute. Typically a
+  // call site would query cpu_backend_context->max_num_threads() and used
+  // that to determine the number of tasks to create and to give to
   // cpu_backend_threadpool::Execute.
   //
   // This value also gets propagated to back-ends, where it plays the same
@@ -123,6 +134,11 @@ class CpuBackendContext final : public TfLiteInternalBackendContext {
   std::unique_ptr<pthreadpool, decltype(&pthreadpool_destroy)>
       xnnpack_threadpool_{nullptr, &pthreadpool_destroy};
 
+  // Lazily created by thread_pool(), and reset whenever its number of threads
+  // or CPUs change.
+  std::unique_ptr<WorkStealingThreadPool> thread_pool_;
+  std::vector<int> thread_pool_cpus_;
+
   CpuBackendContext(const CpuBackendContext&) = delete;
 };
 
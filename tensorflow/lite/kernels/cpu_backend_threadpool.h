@@ -18,9 +18,9 @@ limitations under the License.
 
 #include "tensorflow/lite/kernels/cpu_backend_context.h"
 #include "tensorflow/lite/kernels/internal/compatibility.h"
+#include "tensorflow/lite/kernels/work_stealing_thread_pool.h"
 
 #ifdef TFLITE_WITH_RUY
-#include "ruy/context.h"  // from @ruy
 #include "ruy/thread_pool.h"  // from @ruy
 #else
 #include "public/gemmlowp.h"
@@ -30,31 +30,27 @@ namespace tflite {
 namespace cpu_backend_threadpool {
 
 #ifdef TFLITE_WITH_RUY
-
 using Task = ruy::Task;
-
-template <typename TaskType>
-void Execute(int tasks_count, TaskType* tasks,
-             CpuBackendContext* cpu_backend_context) {
-  TFLITE_DCHECK_LE(tasks_count, cpu_backend_context->max_num_threads());
-  cpu_backend_context->ruy_context()->mutable_thread_pool()->Execute(
-      tasks_count, tasks);
-}
-
-#else  // not TFLITE_WITH_RUY
-
+#else
 using Task = gemmlowp::Task;
+#endif
 
+// Runs the tasks on the thread pool of `cpu_backend_context`, which the
+// workers share by stealing tasks from each other, and returns once all are
+// done. The calling thread runs the first task.
 template <typename TaskType>
 void Execute(int tasks_count, TaskType* tasks,
              CpuBackendContext* cpu_backend_context) {
   TFLITE_DCHECK_LE(tasks_count, cpu_backend_context->max_num_threads());
-  cpu_backend_context->gemmlowp_context()->workers_pool()->Execute(tasks_count,
-                                                                   tasks);
+  WorkStealingThreadPool* thread_pool =
+      tasks_count > 1 ? cpu_backend_context->thread_pool() : nullptr;
+  if (thread_pool == nullptr) {
+    for (int i = 0; i < tasks_count; ++i) tasks[i].Run();
+    return;
+  }
+  thread_pool->ParallelFor(tasks_count, [tasks](int i) { tasks[i].Run(); });
 }
 
-#endif
-
 }  // namespace cpu_backend_threadpool
 }  // namespace tflite
 
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/lite/kernels/cpu_backend_threadpool.h"
 
+#include <utility>
 #include <vector>
 
 #include <gtest/gtest.h>
@@ -42,7 +43,8 @@ class TestGenerateArrayOfIncrementingIntsTask
   int end_;
 };
 
-void TestGenerateArrayOfIncrementingInts(int num_threads, int size) {
+void TestGenerateArrayOfIncrementingInts(int num_threads, int size,
+                                         std::vector<int> cpus = {}) {
   // The buffer that our threads will write to.
   std::vector<int> buffer(size);
 
@@ -63,10 +65,10 @@ void TestGenerateArrayOfIncrementingInts(int num_threads, int size) {
   ASSERT_EQ(num_threads, tasks.size());
 
   CpuBackendContext context;
-  // This SetMaxNumThreads is only to satisfy an assertion in Execute.
-  // What actually determines the number of threads used is the parameter
-  // passed to Execute, since Execute does 1:1 mapping of tasks to threads.
+  // Execute runs the tasks on a pool of num_threads - 1 workers and the
+  // calling thread.
   context.SetMaxNumThreads(num_threads);
+  context.SetThreadPoolCpus(std::move(cpus));
 
   // Execute tasks on the threadpool.
   cpu_backend_threadpool::Execute(tasks.size(), tasks.data(), &context);
@@ -89,6 +91,10 @@ TEST(CpuBackendThreadpoolTest, TenThreadsSize1234567) {
   TestGenerateArrayOfIncrementingInts(10, 1234567);
 }
 
+TEST(CpuBackendThreadpoolTest, ThreeThreadsPinnedSize1000000) {
+  TestGenerateArrayOfIncrementingInts(3, 1000000, /*cpus=*/{0});
+}
+
 }  // namespace
 
 }  // namespace tflite
@@ -20,8 +20,10 @@ limitations under the License.
 
 #include "tensorflow/lite/arena_planner.h"
 #include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/kernels/cpu_backend_context.h"
 #include "tensorflow/lite/kernels/internal/optimized/eigen_spatial_convolutions.h"
 #include "tensorflow/lite/kernels/op_macros.h"
+#include "tensorflow/lite/kernels/work_stealing_thread_pool.h"
 
 namespace tflite {
 namespace eigen_support {
@@ -90,6 +92,36 @@ class EigenThreadPoolWrapper : public Eigen::ThreadPoolInterface {
   std::unique_ptr<Eigen::ThreadPool> pool_;
 };
 
+// Runs the Eigen work on the thread pool of the CpuBackendContext, so that
+// Eigen and the other TFLite kernels don't oversubscribe the cores with
+// separate pools.
+class SharedThreadPoolWrapper : public Eigen::ThreadPoolInterface {
+ public:
+  explicit SharedThreadPoolWrapper(WorkStealingThreadPool* pool)
+      : pool_(pool) {}
+
+  void Schedule(std::function<void()> fn) override {
+    pool_->Schedule(std::move(fn));
+  }
+  int NumThreads() const override { return pool_->NumThreads(); }
+  int CurrentThreadId() const override { return pool_->CurrentThreadId(); }
+
+ private:
+  WorkStealingThreadPool* const pool_;
+};
+
+// Returns the thread pool of the CpuBackendContext of `context`, or null if
+// there is no such context or it runs single-threaded.
+WorkStealingThreadPool* GetSharedThreadPool(TfLiteContext* context) {
+  auto* external_context =
+      context->GetExternalContext(context, kTfLiteCpuBackendContext);
+  if (external_context == nullptr ||
+      external_context->type != kTfLiteCpuBackendContext) {
+    return nullptr;
+  }
+  return CpuBackendContext::GetFromContext(context)->thread_pool();
+}
+
 // Utility class for lazily creating an Eigen thread pool/device only when used.
 class LazyEigenThreadPoolHolder {
  public:
@@ -97,13 +129,31 @@ class LazyEigenThreadPoolHolder {
     SetNumThreads(num_threads);
   }
 
-  // Gets the ThreadPoolDevice, creating if necessary.
-  const Eigen::ThreadPoolDevice* GetThreadPoolDevice() {
+  // Gets the ThreadPoolDevice, creating if necessary. The device runs on
+  // `shared_pool` if not null, and else on a pool of its own.
+  const Eigen::ThreadPoolDevice* GetThreadPoolDevice(
+      WorkStealingThreadPool* shared_pool) {
+    // A new pool may reuse the address of the one it replaces, so its size is
+    // compared as well.
+    if (device_ && (shared_pool != shared_pool_ ||
+                    (shared_pool &&
+                     shared_pool->NumThreads() != device_->numThreads()))) {
+      device_.reset();
+      thread_pool_wrapper_.reset();
+    }
     if (!device_) {
-      thread_pool_wrapper_ =
-          std::make_unique<EigenThreadPoolWrapper>(target_num_threads_);
+      shared_pool_ = shared_pool;
+      int num_threads = target_num_threads_;
+      if (shared_pool) {
+        thread_pool_wrapper_ =
+            std::make_unique<SharedThreadPoolWrapper>(shared_pool);
+        num_threads = shared_pool->NumThreads();
+      } else {
+        thread_pool_wrapper_ =
+            std::make_unique<EigenThreadPoolWrapper>(target_num_threads_);
+      }
       device_ = std::make_unique<Eigen::ThreadPoolDevice>(
-          thread_pool_wrapper_.get(), target_num_threads_);
+          thread_pool_wrapper_.get(), num_threads);
     }
     return device_.get();
   }
@@ -121,6 +171,9 @@ class LazyEigenThreadPoolHolder {
 
  private:
   int target_num_threads_ = kDefaultNumThreadpoolThreads;
+  // The pool of the CpuBackendContext that thread_pool_wrapper_ runs on, if
+  // any. It is checked on every use, as the context may replace its pool.
+  WorkStealingThreadPool* shared_pool_ = nullptr;
   // Both device_ and thread_pool_wrapper_ are lazily created.
   std::unique_ptr<Eigen::ThreadPoolDevice> device_;
   std::unique_ptr<Eigen::ThreadPoolInterface> thread_pool_wrapper_;
@@ -187,7 +240,8 @@ const Eigen::ThreadPoolDevice* GetThreadPoolDevice(TfLiteContext* context) {
     TF_LITE_FATAL(
         "Call to GetFromContext() not preceded by IncrementUsageCounter()");
   }
-  return ptr->thread_pool_holder->GetThreadPoolDevice();
+  return ptr->thread_pool_holder->GetThreadPoolDevice(
+      GetSharedThreadPool(context));
 }
 
 }  // namespace eigen_support
@@ -19,6 +19,8 @@ limitations under the License.
 
 #include <gtest/gtest.h>
 #include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/external_cpu_backend_context.h"
+#include "tensorflow/lite/kernels/cpu_backend_context.h"
 #include "tensorflow/lite/kernels/internal/optimized/eigen_spatial_convolutions.h"
 
 namespace tflite {
@@ -150,6 +152,57 @@ TEST(EigenSupport, NumThreadsChanged) {
   DecrementUsageCounter(&context);
 }
 
+// A context with a CpuBackendContext, on whose thread pool the Eigen device
+// runs.
+struct TestTfLiteContextWithCpuBackend : public TestTfLiteContext {
+  TestTfLiteContextWithCpuBackend() {
+    GetExternalContext = GetExternalContextImpl;
+  }
+
+  static TfLiteExternalContext* GetExternalContextImpl(
+      TfLiteContext* context, TfLiteExternalContextType type) {
+    auto* test_context = static_cast<TestTfLiteContextWithCpuBackend*>(context);
+    if (type == kTfLiteCpuBackendContext) {
+      return &test_context->cpu_backend_context;
+    }
+    return test_context->external_context;
+  }
+
+  ExternalCpuBackendContext cpu_backend_context;
+};
+
+TEST(EigenSupport, SharesCpuBackendThreadPool) {
+  TestTfLiteContextWithCpuBackend context;
+  context.recommended_num_threads = 3;
+  IncrementUsageCounter(&context);
+
+  auto thread_pool_device = GetThreadPoolDevice(&context);
+  ASSERT_NE(thread_pool_device, nullptr);
+  CpuBackendContext* cpu_backend_context =
+      CpuBackendContext::GetFromContext(&context);
+  // The calling thread takes part in the work, so the pool has one thread
+  // less than the context.
+  EXPECT_EQ(thread_pool_device->numThreads(), 2);
+  EXPECT_EQ(thread_pool_device->getPool()->NumThreads(),
+            cpu_backend_context->thread_pool()->NumThreads());
+
+  bool executed = false;
+  auto notification =
+      thread_pool_device->enqueue([&executed]() { executed = true; });
+  ASSERT_NE(notification, nullptr);
+  notification->Wait();
+  delete notification;
+  EXPECT_TRUE(executed);
+
+  // The device follows the pool when the context replaces it.
+  cpu_backend_context->SetMaxNumThreads(4);
+  thread_pool_device = GetThreadPoolDevice(&context);
+  ASSERT_NE(thread_pool_device, nullptr);
+  EXPECT_EQ(thread_pool_device->numThreads(), 3);
+
+  DecrementUsageCounter(&context);
+}
+
 TEST(EigenSupport, RefCounting) {
   TestTfLiteContext context;
   EXPECT_EQ(context.external_context, nullptr);
@@ -25,16 +25,20 @@ limitations under the License.
 //   Output.dim[0] == Tensor[0].dim[0], num of lookups
 //   Output.dim[1] == Tensor[1].dim[1],  num of items per row
 //   Each item in output is a raw bytes copy of the corresponding item in input,
-//   or a dequantized value in the case of a uint8 input.
+//   or a dequantized value in the case of a uint8, int8 or int4 input. Int8 and
+//   int4 inputs may be quantized per row, with a scale and zero point for each
+//   row.
 //   When indices are out of bound, the ops will not succeed.
 //
 
 #include <stdint.h>
 
 #include <cstring>
+#include <vector>
 
 #include "tensorflow/lite/core/c/common.h"
 #include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
+#include "tensorflow/lite/kernels/internal/tensor_utils.h"
 #include "tensorflow/lite/kernels/kernel_util.h"
 
 namespace tflite {
@@ -57,6 +61,27 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
 
   TfLiteTensor* output;
   TF_LITE_ENSURE_OK(context, GetOutputSafe(context, node, 0, &output));
+  if (value->type == kTfLiteInt4) {
+    TF_LITE_ENSURE_TYPES_EQ(context, output->type, kTfLiteFloat32);
+  }
+  if (value->quantization.type == kTfLiteAffineQuantization) {
+    const auto* affine_quantization =
+        reinterpret_cast<TfLiteAffineQuantization*>(
+            value->quantization.params);
+    TF_LITE_ENSURE(context, affine_quantization);
+    TF_LITE_ENSURE(context, affine_quantization->scale);
+    if (affine_quantization->scale->size > 1) {
+      // Per-row quantization.
+      TF_LITE_ENSURE(context,
+                     value->type == kTfLiteInt8 || value->type == kTfLiteInt4);
+      TF_LITE_ENSURE_EQ(context, affine_quantization->quantized_dimension, 0);
+      TF_LITE_ENSURE_EQ(context, affine_quantization->scale->size,
+                        SizeOfDimension(value, 0));
+      TF_LITE_ENSURE(context, affine_quantization->zero_point);
+      TF_LITE_ENSURE_EQ(context, affine_quantization->zero_point->size,
+                        affine_quantization->scale->size);
+    }
+  }
   TfLiteIntArray* outputSize = TfLiteIntArrayCreate(NumDimensions(value));
 
   outputSize->data[0] = SizeOfDimension(lookup, 0);
@@ -97,11 +122,36 @@ TfLiteStatus EvalSimple(TfLiteContext* context, TfLiteNode* node,
   return kTfLiteOk;
 }
 
+// Unpacks the `num_elements` int4 values starting at element `offset` of the
+// densely packed `packed` into `unpacked`.
+void UnpackInt4Row(const int8_t* packed, int offset, int num_elements,
+                   int8_t* unpacked) {
+  packed += offset / 2;
+  if (offset % 2 != 0 && num_elements > 0) {
+    // The row starts in the high nibble of a byte.
+    *unpacked++ = *packed++ >> 4;
+    --num_elements;
+  }
+  tensor_utils::UnpackDenseInt4IntoInt8(packed, num_elements, unpacked);
+}
+
 TfLiteStatus EvalHybrid(TfLiteContext* context, TfLiteNode* node,
                         const TfLiteTensor* lookup, const TfLiteTensor* value,
                         TfLiteTensor* output) {
   const int row_size = SizeOfDimension(value, 0);
   const double scaling_factor = value->params.scale;
+  // The scale and zero point of each row, if quantized per row.
+  const float* row_scales = nullptr;
+  const int* row_zero_points = nullptr;
+  if (value->quantization.type == kTfLiteAffineQuantization) {
+    const auto* affine_quantization =
+        reinterpret_cast<TfLiteAffineQuantization*>(
+            value->quantization.params);
+    if (affine_quantization->scale->size > 1) {
+      row_scales = affine_quantization->scale->data;
+      row_zero_points = affine_quantization->zero_point->data;
+    }
+  }
 
   // col_size after we flatten tensor into 2D.
   int col_size = 1;
@@ -112,6 +162,9 @@ TfLiteStatus EvalHybrid(TfLiteContext* context, TfLiteNode* node,
   float* output_ptr = GetTensorData<float>(output);
   const int8_t* value_ptr = GetTensorData<int8_t>(value);
   const int32_t* lookup_data = GetTensorData<int32_t>(lookup);
+  // Int4 tables pack two values in a byte. Only the looked up rows are
+  // unpacked, one at a time.
+  std::vector<int8_t> unpacked_row(value->type == kTfLiteInt4 ? col_size : 0);
 
   for (int i = 0; i < SizeOfDimension(lookup, 0); i++) {
     int idx = lookup_data[i];
@@ -122,12 +175,26 @@ TfLiteStatus EvalHybrid(TfLiteContext* context, TfLiteNode* node,
                          idx, row_size - 1);
       return kTfLiteError;
     } else {
+      const int8_t* row_ptr = value_ptr + idx * col_size;
+      if (value->type == kTfLiteInt4) {
+        UnpackInt4Row(value_ptr, idx * col_size, col_size,
+                      unpacked_row.data());
+        row_ptr = unpacked_row.data();
+      }
       // Dequantize embedding values.
       // TODO(alanchiao): refactor scalar multiply into separate function
       // for ease of adding a neon equivalent if ever necessary.
-      for (int j = 0; j < col_size; j++) {
-        output_ptr[j + i * col_size] =
-            value_ptr[j + idx * col_size] * scaling_factor;
+      if (row_scales != nullptr) {
+        const float row_scale = row_scales[idx];
+        const int row_zero_point = row_zero_points[idx];
+        for (int j = 0; j < col_size; j++) {
+          output_ptr[j + i * col_size] =
+              (row_ptr[j] - row_zero_point) * row_scale;
+        }
+      } else {
+        for (int j = 0; j < col_size; j++) {
+          output_ptr[j + i * col_size] = row_ptr[j] * scaling_factor;
+        }
       }
     }
   }
@@ -152,6 +219,8 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
       } else {
         return EvalSimple(context, node, lookup, value, output);
       }
+    case kTfLiteInt4:
+      return EvalHybrid(context, node, lookup, value, output);
     default:
       TF_LITE_KERNEL_LOG(context, "Type not currently supported.");
       return kTfLiteError;
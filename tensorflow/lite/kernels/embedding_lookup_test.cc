@@ -101,6 +101,37 @@ class HybridEmbeddingLookupOpModel : public BaseEmbeddingLookupOpModel {
   }
 };
 
+class PerRowHybridEmbeddingLookupOpModel : public SingleOpModel {
+ public:
+  PerRowHybridEmbeddingLookupOpModel(std::initializer_list<int> index_shape,
+                                     const TensorData& weight) {
+    input_ = AddInput(TensorType_INT32);
+    weight_ = AddInput(weight);
+    output_ = AddOutput(TensorType_FLOAT32);
+    SetBuiltinOp(BuiltinOperator_EMBEDDING_LOOKUP, BuiltinOptions_NONE, 0);
+    BuildInterpreter({index_shape, weight.shape});
+  }
+
+  void SetInput(std::initializer_list<int> data) {
+    PopulateTensor(input_, data);
+  }
+
+  void SetWeight(const std::vector<float>& data) {
+    PerChannelSymmetricQuantizeAndPopulate(weight_, data);
+  }
+
+  void SetQuantizedWeight(std::initializer_list<int8_t> data) {
+    PopulateTensor(weight_, data);
+  }
+
+  std::vector<float> GetOutput() { return ExtractVector<float>(output_); }
+
+ private:
+  int input_;
+  int weight_;
+  int output_;
+};
+
 // TODO(ahentz): write more tests that exercise the details of the op, such as
 // lookup errors and variable input shapes.
 TEST(EmbeddingLookupOpTest, SimpleTest) {
@@ -245,6 +276,63 @@ TEST(HybridEmbeddingLookupHybridOpTest, Simple4DTestInt8) {
                   kTestTolerance)));
 }
 
+TEST(HybridEmbeddingLookupHybridOpTest, PerRowInt8) {
+  PerRowHybridEmbeddingLookupOpModel m(
+      {3}, {TensorType_INT8,
+            {3, 4},
+            0,
+            0,
+            0,
+            0,
+            /*per_channel_quantization=*/true,
+            /*per_channel_quantization_scales=*/{0.5, 1, 2},
+            /*per_channel_quantization_offsets=*/{0, 1, -1},
+            /*channel_index=*/0});
+  m.SetInput({1, 0, 2});
+  m.SetQuantizedWeight({
+      0, 1, -2, 3,    // Row 0
+      1, 2, -1, 10,   // Row 1
+      -1, 0, 4, -11,  // Row 2
+  });
+
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+
+  EXPECT_THAT(m.GetOutput(), ElementsAreArray(ArrayFloatNear({
+                                 0, 1, -2, 9,      // Row 1
+                                 0, 0.5, -1, 1.5,  // Row 0
+                                 0, 2, 10, -20,    // Row 2
+                             })));
+}
+
+TEST(HybridEmbeddingLookupHybridOpTest, PerRowInt4OddRowLength) {
+  PerRowHybridEmbeddingLookupOpModel m(
+      {4}, {TensorType_INT4,
+            {3, 3},
+            0,
+            0,
+            0,
+            0,
+            /*per_channel_quantization=*/true,
+            /*per_channel_quantization_scales=*/{1, 0.5, 2},
+            /*per_channel_quantization_offsets=*/{0, 0, 0},
+            /*channel_index=*/0});
+  m.SetInput({2, 0, 1, 2});
+  m.SetWeight({
+      1, -2, 7,      // Row 0
+      0.5, -3.5, 2,  // Row 1
+      -14, 4, 6,     // Row 2
+  });
+
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+
+  EXPECT_THAT(m.GetOutput(), ElementsAreArray(ArrayFloatNear({
+                                 -14, 4, 6,     // Row 2
+                                 1, -2, 7,      // Row 0
+                                 0.5, -3.5, 2,  // Row 1
+                                 -14, 4, 6,     // Row 2
+                             })));
+}
+
 TEST(EmbeddingLookupHybridOpTest, Simple3DTestQuantized) {
   EmbeddingLookupOpModel m({3}, {3, 2, 4}, TensorType_UINT8, TensorType_INT8);
   m.SetInput({1, 0, 2});
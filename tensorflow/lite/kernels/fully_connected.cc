@@ -854,6 +854,47 @@ struct SparseHybridFullyConnectedTask : cpu_backend_threadpool::Task {
   TfLiteTensor* output;
 };
 
+// Computes the integer sums of a range of filter rows, which must be a multiple
+// of optimized_4bit::FilterWidth, for all the batches.
+struct FullyConnected4BitTask : cpu_backend_threadpool::Task {
+  FullyConnected4BitTask(int rhs_width, const uint8_t* lhs, const int8_t* rhs,
+                         int32_t* dst, int row_start, int row_end,
+                         int lhs_layout_cols, int rhs_layout_rows,
+                         int rhs_layout_cols, int dst_layout_rows)
+      : rhs_width(rhs_width),
+        lhs(lhs),
+        rhs(rhs),
+        dst(dst),
+        row_start(row_start),
+        row_end(row_end),
+        lhs_layout_cols(lhs_layout_cols),
+        rhs_layout_rows(rhs_layout_rows),
+        rhs_layout_cols(rhs_layout_cols),
+        dst_layout_rows(dst_layout_rows) {}
+
+  void Run() override {
+    // The packed filter holds lhs_layout_cols / 2 bytes per row, and dst holds
+    // dst_layout_rows sums per filter row.
+    const int rows = row_end - row_start;
+    optimized_4bit::RunKernelForWidth(
+        rhs_width, lhs + row_start * lhs_layout_cols / 2, rhs,
+        dst + row_start * dst_layout_rows, rows, lhs_layout_cols,
+        rhs_layout_rows, rhs_layout_cols, dst_layout_rows, rows);
+  }
+
+ private:
+  const int rhs_width;
+  const uint8_t* lhs;
+  const int8_t* rhs;
+  int32_t* dst;
+  const int row_start;
+  const int row_end;
+  const int lhs_layout_cols;
+  const int rhs_layout_rows;
+  const int rhs_layout_cols;
+  const int dst_layout_rows;
+};
+
 TfLiteStatus EvalHybridDense4Bit(
     TfLiteContext* context, TfLiteNode* node,
     TfLiteFullyConnectedParams* params, OpData* data, const TfLiteTensor* input,
@@ -906,11 +947,39 @@ TfLiteStatus EvalHybridDense4Bit(
       GetTensorData<float>(output), output_depth, batch_size);
   const uint8_t* lhs = data->op_data_4bit->prepacked_cache;
   int32_t* dst = GetTensorData<int32_t>(accum_scratch);
-  optimized_4bit::RunAndUnpack(
-      data->op_data_4bit->rows_right, lhs, quant_data, dst, output_depth,
-      batch_size, lhs_layout_rows, lhs_layout_cols, rhs_layout_rows,
-      rhs_layout_cols, dst_layout_rows, dst_layout_cols,
-      GetTensorData<float>(output), scaling_factors_ptr, filter_scales.data());
+  // The kernel is sliced along the output channels, in whole filter blocks.
+  // The sums are then unpacked to the output once all the slices are done.
+  CpuBackendContext* cpu_backend_context =
+      CpuBackendContext::GetFromContext(context);
+  const int filter_blocks = lhs_layout_rows / lhs_width;
+  const int thread_count = std::max(
+      1, std::min(filter_blocks, cpu_backend_context->max_num_threads()));
+  if (thread_count == 1) {
+    optimized_4bit::RunKernelForWidth(
+        rhs_width, lhs, quant_data, dst, lhs_layout_rows, lhs_layout_cols,
+        rhs_layout_rows, rhs_layout_cols, dst_layout_rows, dst_layout_cols);
+  } else {
+    std::vector<FullyConnected4BitTask> tasks;
+    tasks.reserve(thread_count);
+    int row_start = 0;
+    for (int i = 0; i < thread_count; ++i) {
+      // The first mod(filter_blocks, thread_count) tasks process one more
+      // filter block than the rest.
+      int blocks = filter_blocks / thread_count;
+      if (i < filter_blocks % thread_count) blocks++;
+      const int row_end = row_start + blocks * lhs_width;
+      tasks.emplace_back(rhs_width, lhs, quant_data, dst, row_start, row_end,
+                         lhs_layout_cols, rhs_layout_rows, rhs_layout_cols,
+                         dst_layout_rows);
+      row_start = row_end;
+    }
+    cpu_backend_threadpool::Execute(tasks.size(), tasks.data(),
+                                    cpu_backend_context);
+  }
+  optimized_4bit::UnpackForWidth(rhs_width, GetTensorData<float>(output), dst,
+                                 batch_size, output_depth, scaling_factors_ptr,
+                                 filter_scales.data(), dst_layout_rows,
+                                 dst_layout_cols);
   tensor_utils::ApplyActivationToVector(
       GetTensorData<float>(output), batch_size * output_depth,
       params->activation, GetTensorData<float>(output));
@@ -152,39 +152,70 @@ inline void RunKernel<4, 4, 32>(const uint8_t* lhs, const int8_t* rhs,
 }
 #endif
 
-// Compute sum of lhs * rhs columnwise and write output to output_ptr.
-inline void RunAndUnpack(int rhs_width, const uint8_t* lhs, int8_t* rhs,
-                         int32_t* dst, int output_depth, int batch_size,
-                         int lhs_layout_rows, int lhs_layout_cols,
-                         int rhs_layout_rows, int rhs_layout_cols,
-                         int dst_layout_rows, int dst_layout_cols,
-                         float* output_ptr, const float* scaling_factors,
-                         const float* filter_scales) {
+// Compute sum of lhs * rhs columnwise with the kernel for `rhs_width`.
+inline void RunKernelForWidth(int rhs_width, const uint8_t* lhs,
+                              const int8_t* rhs, int32_t* dst,
+                              int lhs_layout_rows, int lhs_layout_cols,
+                              int rhs_layout_rows, int rhs_layout_cols,
+                              int dst_layout_rows, int dst_layout_cols) {
 #ifdef __aarch64__
   if (rhs_width >= 4) {
     NeonRunKernel<4, 4, 32>(lhs, rhs, dst, lhs_layout_rows, lhs_layout_cols,
                             rhs_layout_rows, rhs_layout_cols, dst_layout_rows,
                             dst_layout_cols);
-    NeonUnpack<4, 4>(output_ptr, dst, batch_size, output_depth, scaling_factors,
-                     filter_scales, dst_layout_rows, dst_layout_cols);
     return;
   }
   if (rhs_width >= 2) {
     NeonRunKernel<4, 2, 32>(lhs, rhs, dst, lhs_layout_rows, lhs_layout_cols,
                             rhs_layout_rows, rhs_layout_cols, dst_layout_rows,
                             dst_layout_cols);
-    NeonUnpack<4, 2>(output_ptr, dst, batch_size, output_depth, scaling_factors,
-                     filter_scales, dst_layout_rows, dst_layout_cols);
     return;
   }
 #endif
   NeonRunKernel<4, 1, 32>(lhs, rhs, dst, lhs_layout_rows, lhs_layout_cols,
                           rhs_layout_rows, rhs_layout_cols, dst_layout_rows,
                           dst_layout_cols);
-  NeonUnpack<4, 1>(output_ptr, dst, batch_size, output_depth, scaling_factors,
+}
+
+// Add accumulated integer sums in dst, computed by RunKernelForWidth with
+// the same `rhs_width`, to float output.
+inline void UnpackForWidth(int rhs_width, float* output_ptr,
+                           const int32_t* dst, int batch_size, int num_units,
+                           const float* scaling_factors,
+                           const float* filter_scales, int dst_layout_rows,
+                           int dst_layout_cols) {
+#ifdef __aarch64__
+  if (rhs_width >= 4) {
+    NeonUnpack<4, 4>(output_ptr, dst, batch_size, num_units, scaling_factors,
+                     filter_scales, dst_layout_rows, dst_layout_cols);
+    return;
+  }
+  if (rhs_width >= 2) {
+    NeonUnpack<4, 2>(output_ptr, dst, batch_size, num_units, scaling_factors,
+                     filter_scales, dst_layout_rows, dst_layout_cols);
+    return;
+  }
+#endif
+  NeonUnpack<4, 1>(output_ptr, dst, batch_size, num_units, scaling_factors,
                    filter_scales, dst_layout_rows, dst_layout_cols);
 }
 
+// Compute sum of lhs * rhs columnwise and write output to output_ptr.
+inline void RunAndUnpack(int rhs_width, const uint8_t* lhs, int8_t* rhs,
+                         int32_t* dst, int output_depth, int batch_size,
+                         int lhs_layout_rows, int lhs_layout_cols,
+                         int rhs_layout_rows, int rhs_layout_cols,
+                         int dst_layout_rows, int dst_layout_cols,
+                         float* output_ptr, const float* scaling_factors,
+                         const float* filter_scales) {
+  RunKernelForWidth(rhs_width, lhs, rhs, dst, lhs_layout_rows, lhs_layout_cols,
+                    rhs_layout_rows, rhs_layout_cols, dst_layout_rows,
+                    dst_layout_cols);
+  UnpackForWidth(rhs_width, output_ptr, dst, batch_size, output_depth,
+                 scaling_factors, filter_scales, dst_layout_rows,
+                 dst_layout_cols);
+}
+
 }  // namespace optimized_4bit
 }  // namespace tflite
 
@@ -0,0 +1,135 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#if defined(FC_4BIT_SSE) && defined(__AVX2__)
+
+#include <stdint.h>
+
+// NOLINTBEGIN
+#include <immintrin.h>
+
+#include <algorithm>
+
+#include "tensorflow/lite/kernels/internal/optimized/4bit/sse_fully_connected_impl.h"
+
+namespace tflite {
+namespace optimized_4bit {
+namespace {
+
+// Returns [sum(a), sum(b), sum(c), sum(d)].
+inline __m128i ReduceInt32x4x4(__m128i a, __m128i b, __m128i c, __m128i d) {
+  const __m128i a_b = _mm_add_epi32(_mm_unpacklo_epi32(a, b),
+                                    _mm_unpackhi_epi32(a, b));
+  const __m128i c_d = _mm_add_epi32(_mm_unpacklo_epi32(c, d),
+                                    _mm_unpackhi_epi32(c, d));
+  return _mm_add_epi32(_mm_unpacklo_epi64(a_b, c_d),
+                       _mm_unpackhi_epi64(a_b, c_d));
+}
+
+}  // namespace
+
+// Each 16 bytes of lhs hold one row of a 4x32 block: the upper nibbles are
+// multiplied with the first 16 values of the rhs row and the lower nibbles
+// with the last 16. Two lhs rows are processed per 256-bit register, against
+// the two halves of the rhs row broadcast to both lanes.
+template <int RowsLeft, int RowsRight, int Cols>
+void SseRunKernelAvx2(const uint8_t* lhs, const int8_t* rhs, int32_t* dst,
+                      int lhs_layout_rows, int lhs_layout_cols,
+                      int rhs_layout_rows, int rhs_layout_cols,
+                      int dst_layout_rows, int dst_layout_cols) {
+  static_assert(RowsLeft == 4 && Cols == 32, "Unsupported block size");
+  const int clamped_end_row = std::min(lhs_layout_rows, dst_layout_cols);
+  const int clamped_end_col = std::min(rhs_layout_rows, dst_layout_rows);
+  int32_t* elementPtr = dst;
+  const int outer_rows = (clamped_end_row + RowsLeft - 1) / RowsLeft;
+  const int outer_cols = (clamped_end_col + RowsRight - 1) / RowsRight;
+  const int depth = std::min(lhs_layout_cols / Cols, rhs_layout_cols / Cols);
+  const __m256i bitmask = _mm256_set1_epi8(15);
+  const __m256i ones = _mm256_set1_epi16(1);
+  for (int i = 0; i < outer_rows; ++i) {
+    const uint8_t* lhs_val_data = lhs + i * RowsLeft * lhs_layout_cols / 2;
+    for (int j = 0; j < outer_cols; ++j) {
+      const uint8_t* lhs_val = lhs_val_data;
+      const int8_t* rhs_val = rhs + j * RowsRight * rhs_layout_cols;
+      // Rows 0 and 1, and rows 2 and 3 of lhs, for each rhs row.
+      __m256i accum[RowsRight][2];
+      for (int r = 0; r < RowsRight; ++r) {
+        accum[r][0] = _mm256_setzero_si256();
+        accum[r][1] = _mm256_setzero_si256();
+      }
+      for (int k = 0; k < depth; ++k) {
+        const __m256i lhs_01 = _mm256_loadu_si256((const __m256i*)lhs_val);
+        const __m256i lhs_23 =
+            _mm256_loadu_si256((const __m256i*)(lhs_val + 32));
+        lhs_val += 64;
+        const __m256i upper_01 =
+            _mm256_and_si256(_mm256_srli_epi16(lhs_01, 4), bitmask);
+        const __m256i lower_01 = _mm256_and_si256(lhs_01, bitmask);
+        const __m256i upper_23 =
+            _mm256_and_si256(_mm256_srli_epi16(lhs_23, 4), bitmask);
+        const __m256i lower_23 = _mm256_and_si256(lhs_23, bitmask);
+        for (int r = 0; r < RowsRight; ++r) {
+          const __m256i rhs_first = _mm256_broadcastsi128_si256(
+              _mm_loadu_si128((const __m128i*)rhs_val));
+          const __m256i rhs_last = _mm256_broadcastsi128_si256(
+              _mm_loadu_si128((const __m128i*)(rhs_val + 16)));
+          rhs_val += 32;
+          // Pairwise products are at most 2 * 15 * 128 in magnitude, so the
+          // sum of both halves still fits in 16 bits.
+          const __m256i sum_01 =
+              _mm256_add_epi16(_mm256_maddubs_epi16(upper_01, rhs_first),
+                               _mm256_maddubs_epi16(lower_01, rhs_last));
+          const __m256i sum_23 =
+              _mm256_add_epi16(_mm256_maddubs_epi16(upper_23, rhs_first),
+                               _mm256_maddubs_epi16(lower_23, rhs_last));
+          accum[r][0] =
+              _mm256_add_epi32(accum[r][0], _mm256_madd_epi16(sum_01, ones));
+          accum[r][1] =
+              _mm256_add_epi32(accum[r][1], _mm256_madd_epi16(sum_23, ones));
+        }
+      }
+      for (int r = 0; r < RowsRight; ++r) {
+        const __m128i sum = ReduceInt32x4x4(
+            _mm256_castsi256_si128(accum[r][0]),
+            _mm256_extracti128_si256(accum[r][0], 1),
+            _mm256_castsi256_si128(accum[r][1]),
+            _mm256_extracti128_si256(accum[r][1], 1));
+        _mm_storeu_si128((__m128i*)elementPtr, sum);
+        elementPtr += 4;
+      }
+    }
+  }
+}
+// NOLINTEND
+
+template void SseRunKernelAvx2<4, 1, 32>(
+    const uint8_t* lhs, const int8_t* rhs, int32_t* dst, int lhs_layout_rows,
+    int lhs_layout_cols, int rhs_layout_rows, int rhs_layout_cols,
+    int dst_layout_rows, int dst_layout_cols);
+
+template void SseRunKernelAvx2<4, 2, 32>(
+    const uint8_t* lhs, const int8_t* rhs, int32_t* dst, int lhs_layout_rows,
+    int lhs_layout_cols, int rhs_layout_rows, int rhs_layout_cols,
+    int dst_layout_rows, int dst_layout_cols);
+
+template void SseRunKernelAvx2<4, 4, 32>(
+    const uint8_t* lhs, const int8_t* rhs, int32_t* dst, int lhs_layout_rows,
+    int lhs_layout_cols, int rhs_layout_rows, int rhs_layout_cols,
+    int dst_layout_rows, int dst_layout_cols);
+
+}  // namespace optimized_4bit
+}  // namespace tflite
+
+#endif  // defined(FC_4BIT_SSE) && defined(__AVX2__)
@@ -0,0 +1,117 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#if defined(FC_4BIT_SSE) && defined(__AVX512VNNI__) && defined(__AVX512BW__)
+
+#include <stdint.h>
+
+// NOLINTBEGIN
+#include <immintrin.h>
+
+#include <algorithm>
+
+#include "tensorflow/lite/kernels/internal/optimized/4bit/sse_fully_connected_impl.h"
+
+namespace tflite {
+namespace optimized_4bit {
+namespace {
+
+// Returns [sum(a), sum(b), sum(c), sum(d)].
+inline __m128i ReduceInt32x4x4(__m128i a, __m128i b, __m128i c, __m128i d) {
+  const __m128i a_b = _mm_add_epi32(_mm_unpacklo_epi32(a, b),
+                                    _mm_unpackhi_epi32(a, b));
+  const __m128i c_d = _mm_add_epi32(_mm_unpacklo_epi32(c, d),
+                                    _mm_unpackhi_epi32(c, d));
+  return _mm_add_epi32(_mm_unpacklo_epi64(a_b, c_d),
+                       _mm_unpackhi_epi64(a_b, c_d));
+}
+
+}  // namespace
+
+// Same as SseRunKernelAvx2, with the 4 lhs rows of a block in the 4 lanes of a
+// 512-bit register and the products accumulated by VPDPBUSD, which multiplies
+// the unsigned lhs nibbles with the signed rhs values.
+template <int RowsLeft, int RowsRight, int Cols>
+void SseRunKernelAvx512Vnni(const uint8_t* lhs, const int8_t* rhs,
+                            int32_t* dst, int lhs_layout_rows,
+                            int lhs_layout_cols, int rhs_layout_rows,
+                            int rhs_layout_cols, int dst_layout_rows,
+                            int dst_layout_cols) {
+  static_assert(RowsLeft == 4 && Cols == 32, "Unsupported block size");
+  const int clamped_end_row = std::min(lhs_layout_rows, dst_layout_cols);
+  const int clamped_end_col = std::min(rhs_layout_rows, dst_layout_rows);
+  int32_t* elementPtr = dst;
+  const int outer_rows = (clamped_end_row + RowsLeft - 1) / RowsLeft;
+  const int outer_cols = (clamped_end_col + RowsRight - 1) / RowsRight;
+  const int depth = std::min(lhs_layout_cols / Cols, rhs_layout_cols / Cols);
+  const __m512i bitmask = _mm512_set1_epi8(15);
+  for (int i = 0; i < outer_rows; ++i) {
+    const uint8_t* lhs_val_data = lhs + i * RowsLeft * lhs_layout_cols / 2;
+    for (int j = 0; j < outer_cols; ++j) {
+      const uint8_t* lhs_val = lhs_val_data;
+      const int8_t* rhs_val = rhs + j * RowsRight * rhs_layout_cols;
+      __m512i accum[RowsRight];
+      for (int r = 0; r < RowsRight; ++r) {
+        accum[r] = _mm512_setzero_si512();
+      }
+      for (int k = 0; k < depth; ++k) {
+        const __m512i lhs_rows = _mm512_loadu_si512(lhs_val);
+        lhs_val += 64;
+        const __m512i upper =
+            _mm512_and_si512(_mm512_srli_epi16(lhs_rows, 4), bitmask);
+        const __m512i lower = _mm512_and_si512(lhs_rows, bitmask);
+        for (int r = 0; r < RowsRight; ++r) {
+          const __m512i rhs_first = _mm512_broadcast_i32x4(
+              _mm_loadu_si128((const __m128i*)rhs_val));
+          const __m512i rhs_last = _mm512_broadcast_i32x4(
+              _mm_loadu_si128((const __m128i*)(rhs_val + 16)));
+          rhs_val += 32;
+          accum[r] = _mm512_dpbusd_epi32(accum[r], upper, rhs_first);
+          accum[r] = _mm512_dpbusd_epi32(accum[r], lower, rhs_last);
+        }
+      }
+      for (int r = 0; r < RowsRight; ++r) {
+        const __m128i sum =
+            ReduceInt32x4x4(_mm512_extracti32x4_epi32(accum[r], 0),
+                            _mm512_extracti32x4_epi32(accum[r], 1),
+                            _mm512_extracti32x4_epi32(accum[r], 2),
+                            _mm512_extracti32x4_epi32(accum[r], 3));
+        _mm_storeu_si128((__m128i*)elementPtr, sum);
+        elementPtr += 4;
+      }
+    }
+  }
+}
+// NOLINTEND
+
+template void SseRunKernelAvx512Vnni<4, 1, 32>(
+    const uint8_t* lhs, const int8_t* rhs, int32_t* dst, int lhs_layout_rows,
+    int lhs_layout_cols, int rhs_layout_rows, int rhs_layout_cols,
+    int dst_layout_rows, int dst_layout_cols);
+
+template void SseRunKernelAvx512Vnni<4, 2, 32>(
+    const uint8_t* lhs, const int8_t* rhs, int32_t* dst, int lhs_layout_rows,
+    int lhs_layout_cols, int rhs_layout_rows, int rhs_layout_cols,
+    int dst_layout_rows, int dst_layout_cols);
+
+template void SseRunKernelAvx512Vnni<4, 4, 32>(
+    const uint8_t* lhs, const int8_t* rhs, int32_t* dst, int lhs_layout_rows,
+    int lhs_layout_cols, int rhs_layout_rows, int rhs_layout_cols,
+    int dst_layout_rows, int dst_layout_cols);
+
+}  // namespace optimized_4bit
+}  // namespace tflite
+
+#endif  // defined(FC_4BIT_SSE) && defined(__AVX512VNNI__) ...
@@ -57,6 +57,34 @@ extern void SseRunKernel(const uint8_t* lhs, const int8_t* rhs, int32_t* dst,
                          int rhs_layout_rows, int rhs_layout_cols,
                          int dst_layout_rows, int dst_layout_cols);
 
+template <int RowsLeft, int RowsRight, int Cols>
+extern void SseRunKernelSsse3(const uint8_t* lhs, const int8_t* rhs,
+                              int32_t* dst, int lhs_layout_rows,
+                              int lhs_layout_cols, int rhs_layout_rows,
+                              int rhs_layout_cols, int dst_layout_rows,
+                              int dst_layout_cols);
+
+// Returns whether the CPU supports AVX2, and AVX-512 VNNI (with AVX-512 F and
+// BW), respectively.
+bool HasAvx2();
+bool HasAvx512Vnni();
+
+// Built with AVX2 enabled, must only be called if the CPU supports it.
+template <int RowsLeft, int RowsRight, int Cols>
+extern void SseRunKernelAvx2(const uint8_t* lhs, const int8_t* rhs,
+                             int32_t* dst, int lhs_layout_rows,
+                             int lhs_layout_cols, int rhs_layout_rows,
+                             int rhs_layout_cols, int dst_layout_rows,
+                             int dst_layout_cols);
+
+// Built with AVX-512 VNNI enabled, must only be called if the CPU supports it.
+template <int RowsLeft, int RowsRight, int Cols>
+extern void SseRunKernelAvx512Vnni(const uint8_t* lhs, const int8_t* rhs,
+                                   int32_t* dst, int lhs_layout_rows,
+                                   int lhs_layout_cols, int rhs_layout_rows,
+                                   int rhs_layout_cols, int dst_layout_rows,
+                                   int dst_layout_cols);
+
 }  // namespace optimized_4bit
 }  // namespace tflite
 
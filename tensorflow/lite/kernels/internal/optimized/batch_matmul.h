@@ -25,10 +25,14 @@ limitations under the License.
 namespace tflite {
 namespace optimized_ops {
 
+// `lhs_cacheable` and `rhs_cacheable` mark operands whose data does not change
+// between invocations, such as weights, so that their packed form is cached by
+// the GEMM backend instead of being repacked on every call.
 inline void BatchMatMul(const RuntimeShape& lhs_shape, const float* lhs_data,
                         const RuntimeShape& rhs_shape, const float* rhs_data,
                         const RuntimeShape& output_shape, float* output_data,
-                        CpuBackendContext* context) {
+                        CpuBackendContext* context, bool lhs_cacheable = false,
+                        bool rhs_cacheable = false) {
   using ::tflite::cpu_backend_gemm::Gemm;
   using ::tflite::cpu_backend_gemm::GemmParams;
   using ::tflite::cpu_backend_gemm::MatrixParams;
@@ -81,11 +85,13 @@ inline void BatchMatMul(const RuntimeShape& lhs_shape, const float* lhs_data,
   lhs_params.order = cpu_backend_gemm::Order::kRowMajor;
   lhs_params.rows = lhs_rows;
   lhs_params.cols = accum_depth;
+  lhs_params.cache_policy = cpu_backend_gemm::DefaultCachePolicy(lhs_cacheable);
 
   MatrixParams<float> rhs_params;
   rhs_params.order = cpu_backend_gemm::Order::kColMajor;
   rhs_params.rows = accum_depth;
   rhs_params.cols = rhs_cols;
+  rhs_params.cache_policy = cpu_backend_gemm::DefaultCachePolicy(rhs_cacheable);
 
   MatrixParams<float> dst_params;
   dst_params.order = cpu_backend_gemm::Order::kColMajor;
@@ -285,12 +291,16 @@ inline void BatchMatMul(const FullyConnectedParams& params,
   lhs_params.rows = lhs_rows;
   lhs_params.cols = accum_depth;
   lhs_params.zero_point = -filter_offset;
+  lhs_params.cache_policy =
+      cpu_backend_gemm::DefaultCachePolicy(params.lhs_cacheable);
 
   MatrixParams<int8_t> rhs_params;
   rhs_params.order = cpu_backend_gemm::Order::kColMajor;
   rhs_params.rows = accum_depth;
   rhs_params.cols = rhs_cols;
   rhs_params.zero_point = -input_offset;
+  rhs_params.cache_policy =
+      cpu_backend_gemm::DefaultCachePolicy(params.rhs_cacheable);
 
   MatrixParams<int8_t> dst_params;
   dst_params.order = cpu_backend_gemm::Order::kColMajor;
@@ -391,12 +401,16 @@ inline void BatchMatMul(const FullyConnectedParams& params,
   lhs_params.rows = lhs_rows;
   lhs_params.cols = accum_depth;
   lhs_params.zero_point = -weights_offset;
+  lhs_params.cache_policy =
+      cpu_backend_gemm::DefaultCachePolicy(params.lhs_cacheable);
 
   MatrixParams<int8_t> rhs_params;
   rhs_params.order = cpu_backend_gemm::Order::kColMajor;
   rhs_params.rows = accum_depth;
   rhs_params.cols = rhs_cols;
   rhs_params.zero_point = -input_offset;
+  rhs_params.cache_policy =
+      cpu_backend_gemm::DefaultCachePolicy(params.rhs_cacheable);
 
   MatrixParams<int32_t> dst_params;
   dst_params.order = cpu_backend_gemm::Order::kColMajor;
@@ -489,7 +489,7 @@ TEST_P(RunKernelTests, RunKernelTests) {
 
   index = 0;
   switch (rhs_width) {
-#if defined(FC_4BIT_NEON) && defined(__aarch64__)
+#if (defined(FC_4BIT_NEON) && defined(__aarch64__)) || defined(FC_4BIT_SSE)
     case 4:
       optimized_4bit::RunKernel<optimized_4bit::FilterWidth, 4,
                                 optimized_4bit::FilterDepth>(
@@ -521,8 +521,104 @@ TEST_P(RunKernelTests, RunKernelTests) {
     int32_t val = test_accum[i];
     EXPECT_EQ(val, expected_val);
   }
+
+#if defined(FC_4BIT_SSE)
+  // RunKernel picks the widest kernel supported by the CPU, also check the
+  // narrower ones.
+  using KernelFn = void (*)(const uint8_t*, const int8_t*, int32_t*, int, int,
+                            int, int, int, int);
+  std::vector<KernelFn> kernels;
+  switch (rhs_width) {
+    case 4:
+      kernels.push_back(optimized_4bit::SseRunKernelSsse3<4, 4, 32>);
+      if (optimized_4bit::HasAvx2()) {
+        kernels.push_back(optimized_4bit::SseRunKernelAvx2<4, 4, 32>);
+      }
+      if (optimized_4bit::HasAvx512Vnni()) {
+        kernels.push_back(optimized_4bit::SseRunKernelAvx512Vnni<4, 4, 32>);
+      }
+      break;
+    case 2:
+      kernels.push_back(optimized_4bit::SseRunKernelSsse3<4, 2, 32>);
+      if (optimized_4bit::HasAvx2()) {
+        kernels.push_back(optimized_4bit::SseRunKernelAvx2<4, 2, 32>);
+      }
+      if (optimized_4bit::HasAvx512Vnni()) {
+        kernels.push_back(optimized_4bit::SseRunKernelAvx512Vnni<4, 2, 32>);
+      }
+      break;
+    default:
+      kernels.push_back(optimized_4bit::SseRunKernelSsse3<4, 1, 32>);
+      if (optimized_4bit::HasAvx2()) {
+        kernels.push_back(optimized_4bit::SseRunKernelAvx2<4, 1, 32>);
+      }
+      if (optimized_4bit::HasAvx512Vnni()) {
+        kernels.push_back(optimized_4bit::SseRunKernelAvx512Vnni<4, 1, 32>);
+      }
+      break;
+  }
+  for (KernelFn kernel : kernels) {
+    std::fill(test_accum.begin(), test_accum.end(), 0);
+    kernel(test_lhs.data(), test_rhs.data(), test_accum.data(),
+           lhs_layout_rows, lhs_layout_cols, rhs_layout_rows, rhs_layout_cols,
+           rhs_layout_rows, lhs_layout_rows);
+    EXPECT_EQ(test_accum, expected_accum);
+  }
+#endif
+}
+
+class RunKernelSlicedTests
+    : public ::testing::TestWithParam<::testing::tuple<int, int>> {};
+
+// Runs the kernel on slices of whole filter blocks, as the multi-threaded
+// fully connected op does, and checks it matches a single run.
+TEST_P(RunKernelSlicedTests, RunKernelSlicedTests) {
+  auto params = GetParam();
+  int rhs_width = std::get<0>(params);
+  int slices = std::get<1>(params);
+  const int lhs_layout_rows = 6 * optimized_4bit::FilterWidth;
+  const int lhs_layout_cols = 2 * optimized_4bit::FilterDepth;
+  const int rhs_layout_rows = 2 * rhs_width;
+  const int rhs_layout_cols = lhs_layout_cols;
+  std::vector<uint8_t> test_lhs(lhs_layout_rows * lhs_layout_cols / 2);
+  for (uint8_t& v : test_lhs) {
+    v = static_cast<uint8_t>(((int_dist(random_engine) + 7) << 4) |
+                             (int_dist(random_engine) + 7));
+  }
+  std::vector<int8_t> test_rhs(rhs_layout_rows * rhs_layout_cols);
+  for (int8_t& v : test_rhs) {
+    v = static_cast<int8_t>(int_dist(random_engine));
+  }
+  std::vector<int32_t> expected_accum(lhs_layout_rows * rhs_layout_rows, 0);
+  optimized_4bit::RunKernelForWidth(
+      rhs_width, test_lhs.data(), test_rhs.data(), expected_accum.data(),
+      lhs_layout_rows, lhs_layout_cols, rhs_layout_rows, rhs_layout_cols,
+      rhs_layout_rows, lhs_layout_rows);
+
+  std::vector<int32_t> test_accum(lhs_layout_rows * rhs_layout_rows, 0);
+  const int blocks = lhs_layout_rows / optimized_4bit::FilterWidth;
+  int row_start = 0;
+  for (int i = 0; i < slices; ++i) {
+    int slice_blocks = blocks / slices + (i < blocks % slices ? 1 : 0);
+    int rows = slice_blocks * optimized_4bit::FilterWidth;
+    optimized_4bit::RunKernelForWidth(
+        rhs_width, test_lhs.data() + row_start * lhs_layout_cols / 2,
+        test_rhs.data(), test_accum.data() + row_start * rhs_layout_rows, rows,
+        lhs_layout_cols, rhs_layout_rows, rhs_layout_cols, rhs_layout_rows,
+        rows);
+    row_start += rows;
+  }
+  EXPECT_EQ(test_accum, expected_accum);
 }
 
+INSTANTIATE_TEST_SUITE_P(RunKernelSlicedTests, RunKernelSlicedTests,
+                         ::testing::ValuesIn({
+                             std::make_tuple(1, 2),
+                             std::make_tuple(1, 4),
+                             std::make_tuple(2, 3),
+                             std::make_tuple(4, 5),
+                         }));
+
 INSTANTIATE_TEST_SUITE_P(
     RunKernelTests, RunKernelTests, ::testing::ValuesIn({
       std::make_tuple(1, 4, 1, 32), std::make_tuple(1, 8, 1, 32),
@@ -530,7 +626,7 @@ INSTANTIATE_TEST_SUITE_P(
           std::make_tuple(1, 8, 1, 64), std::make_tuple(1, 16, 1, 64),
           std::make_tuple(1, 4, 5, 64), std::make_tuple(1, 8, 9, 64),
           std::make_tuple(1, 16, 17, 64),
-#if defined(FC_4BIT_NEON) && defined(__aarch64__)
+#if (defined(FC_4BIT_NEON) && defined(__aarch64__)) || defined(FC_4BIT_SSE)
           std::make_tuple(2, 8, 2, 32), std::make_tuple(2, 16, 2, 32),
           std::make_tuple(2, 4, 4, 64), std::make_tuple(2, 8, 4, 64),
           std::make_tuple(2, 16, 4, 64), std::make_tuple(2, 4, 4, 64),
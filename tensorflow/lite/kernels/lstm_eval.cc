@@ -181,6 +181,8 @@ inline float GetTensorScale(const TfLiteTensor* tensor) {
 //   cell_to_gate_weights      | n_cell               | y (peephole)
 //   gate_bias                 | n_cell               |
 //   layer_norm_coefficients   | n_cell               | y (layer norm)
+// Precomputed vectors:
+//   input_projection          | n_cell               | y (sequence batched)
 // Output vector:
 //   gate                      | n_cell               |
 // Scalar parameters:
@@ -189,6 +191,10 @@ inline float GetTensorScale(const TfLiteTensor* tensor) {
 //   activation                                 - activation to use.
 //   is_input_all_zeros, is_aux_input_all_zeros - if input vectors are all zero.
 //   use_layer_norm                             - if doing layer norm LSTM.
+//
+// If input_projection is given, it holds gate_bias + W_input * input (without
+// the bias with layer norm), computed for the whole sequence by
+// CalculateLstmGateInputProjectionFloat, and the input isn't used.
 inline void CalculateLstmGateFloat(
     const float* input, const float* input_to_gate_weights,
     const float* aux_input, const float* aux_input_to_gate_weights,
@@ -199,21 +205,24 @@ inline void CalculateLstmGateFloat(
     const int n_output, const int n_cell,
     const TfLiteFusedActivation activation, float* gate,
     const bool is_input_all_zeros, const bool is_aux_input_all_zeros,
-    float* output, bool recurrent_is_diag, CpuBackendContext* context) {
+    float* output, bool recurrent_is_diag, const float* input_projection,
+    CpuBackendContext* context) {
   const bool use_peephole = (cell_to_gate_weights != nullptr);
   const bool use_layer_norm = (layer_norm_coefficients != nullptr);
 
   // Initialize scratch buffers with bias for regular lstm or initialize with
-  // zero for layer norm lstm.
-  if (use_layer_norm) {
+  // zero for layer norm lstm. The input projection already includes them.
+  if (input_projection != nullptr) {
+    std::copy_n(input_projection, n_cell * n_batch, gate);
+  } else if (use_layer_norm) {
     std::fill_n(gate, n_cell * n_batch, 0.0f);
   } else {
     tensor_utils::VectorBatchVectorAssign(gate_bias, n_cell, n_batch, gate);
   }
   // For each batch and cell: compute input_weight * input.
-  // Skip if input is all zeros.
+  // Skip if input is all zeros or already projected.
   float* accumulation_buffer = gate;
-  if (!is_input_all_zeros) {
+  if (input_projection == nullptr && !is_input_all_zeros) {
     MatrixBatchVectorMultiplyAccumulate(input_to_gate_weights, input,
                                         accumulation_buffer, output, n_cell,
                                         n_input, n_batch, context);
@@ -255,6 +264,42 @@ inline void CalculateLstmGateFloat(
                                         gate);
 }
 
+// Calculates the part of a LSTM gate that only depends on the input, for all
+// the time steps of a sequence at once:
+//   input_projection = W_input * input + gate_bias
+// With layer norm, the bias is added after normalization and is left out.
+// This replaces n_rows / n_batch matrix-vector products with a single matrix
+// multiplication, so that the weights are only streamed once per sequence.
+//
+// Parameters:
+//  - input: input vectors of all the time steps, size n_rows * n_input.
+//  - input_to_gate_weights: size n_cell * n_input.
+//  - layer_norm_coefficients: only checked for nullptr, see above.
+//  - gate_bias: size n_cell.
+//  - input_projection: output vectors, size n_rows * n_cell, in the same
+//      order as the input vectors.
+void CalculateLstmGateInputProjectionFloat(
+    const float* input, const float* input_to_gate_weights,
+    const float* layer_norm_coefficients, const float* gate_bias,
+    const int n_rows, const int n_input, const int n_cell,
+    float* input_projection, CpuBackendContext* context) {
+  tflite::FullyConnectedParams float_fc_params;
+  float_fc_params.float_activation_min = std::numeric_limits<float>::lowest();
+  float_fc_params.float_activation_max = std::numeric_limits<float>::max();
+  float_fc_params.lhs_cacheable = true;
+  float_fc_params.rhs_cacheable = false;
+
+  tflite::RuntimeShape weight_shape({n_cell, n_input});
+  tflite::RuntimeShape input_shape({n_rows, n_input});
+  tflite::RuntimeShape bias_shape({n_cell});
+  tflite::RuntimeShape output_shape({n_rows, n_cell});
+  const float* bias =
+      (layer_norm_coefficients != nullptr) ? nullptr : gate_bias;
+  tflite::optimized_ops::FullyConnected(
+      float_fc_params, input_shape, input, weight_shape, input_to_gate_weights,
+      bias_shape, bias, output_shape, input_projection, context);
+}
+
 // Updates the LSTM cell state, used by both float and hybrid LSTM versions.
 //
 // Implements the following formula:
@@ -354,7 +399,8 @@ void CalculateLstmOutputFloat(int n_batch, int n_cell, int n_output,
 //                 ../experimental/kernels/fp16/lstm_eval.cc)
 
 // Calculates a single LSTM gate, hybrid version.
-// Implements the same functionality as CalculateLstmGateFloat.
+// Implements the same functionality as CalculateLstmGateFloat, with the
+// input projection computed by CalculateLstmGateInputProjectionHybrid.
 void CalculateLstmGateHybrid(
     // Input and weights
     const int8_t* input, const float* input_sf, const int32_t* input_zp,
@@ -393,20 +439,24 @@ void CalculateLstmGateHybrid(
     float* scratch0,         // size: n_batch
     float* scratch1,         // size: n_cell, only used if peephole LSTM
     int32_t* accum_scratch,  // For MatrixBatchVectorMultiplyAccumulate
-    bool recurrent_is_diag) {
+    bool recurrent_is_diag,
+    // Precomputed input projection (sequence batched LSTM), optional
+    const float* input_projection) {
   const bool use_peephole = (cell_to_gate_weights != nullptr);
   const bool use_layer_norm = (layer_norm_coefficients != nullptr);
 
   // Initialize scratch buffers with bias for regular lstm or initialize with
-  // zero for layer norm lstm.
-  if (use_layer_norm) {
+  // zero for layer norm lstm. The input projection already includes them.
+  if (input_projection != nullptr) {
+    std::copy_n(input_projection, n_cell * n_batch, gate);
+  } else if (use_layer_norm) {
     std::fill_n(gate, n_cell * n_batch, 0.0f);
   } else {
     tensor_utils::VectorBatchVectorAssign(gate_bias, n_cell, n_batch, gate);
   }
   // For each batch and cell: compute input_weight * input.
-  // Skip if input is all zeros.
-  if (!is_input_all_zeros) {
+  // Skip if input is all zeros or already projected.
+  if (input_projection == nullptr && !is_input_all_zeros) {
     if (input_to_gate_weights_ledger != nullptr) {
       std::vector<float> scales(n_batch);
       for (int i = 0; i < n_batch; i++) {
@@ -478,6 +528,52 @@ void CalculateLstmGateHybrid(
                                         gate);
 }
 
+// Calculates the part of a LSTM gate that only depends on the input, for all
+// the time steps of a sequence at once, hybrid version. See
+// CalculateLstmGateInputProjectionFloat.
+//
+// The input must be quantized, with one scaling factor (and zero point, if
+// asymmetric) per input vector.
+//
+// Parameters:
+//  - input: quantized input vectors, size n_rows * n_input.
+//  - input_sf, input_zp: size n_rows.
+//  - input_to_gate_row_sums: size n_cell, updated if compute_row_sums.
+//  - input_projection: output vectors, size n_rows * n_cell.
+//  - scratch0: scratch area of size n_rows.
+//  - accum_scratch: scratch area of size n_rows * n_cell.
+void CalculateLstmGateInputProjectionHybrid(
+    const int8_t* input, const float* input_sf, const int32_t* input_zp,
+    const int8_t* input_to_gate_weights,
+    const uint8_t* input_to_gate_weights_ledger,
+    const float input_to_gate_weights_scale, int32_t* input_to_gate_row_sums,
+    bool compute_row_sums, const float* layer_norm_coefficients,
+    const float* gate_bias, const int n_rows, const int n_input,
+    const int n_cell, float* input_projection, CpuBackendContext* context,
+    float* scratch0, int32_t* accum_scratch) {
+  if (layer_norm_coefficients != nullptr) {
+    std::fill_n(input_projection, n_cell * n_rows, 0.0f);
+  } else {
+    tensor_utils::VectorBatchVectorAssign(gate_bias, n_cell, n_rows,
+                                          input_projection);
+  }
+  if (input_to_gate_weights_ledger != nullptr) {
+    std::vector<float> scales(n_rows);
+    for (int i = 0; i < n_rows; i++) {
+      scales[i] = input_to_gate_weights_scale * input_sf[i];
+    }
+    tensor_utils::SparseMatrixBatchVectorMultiplyAccumulate(
+        input_to_gate_weights, input_to_gate_weights_ledger, n_cell, n_input,
+        input, scales.data(), n_rows, input_projection);
+  } else {
+    tensor_utils::MatrixBatchVectorMultiplyAccumulate(
+        input_to_gate_weights, n_cell, n_input, input,
+        input_to_gate_weights_scale, input_sf, n_rows, input_projection,
+        /*per_channel_scale=*/nullptr, input_zp, accum_scratch,
+        input_to_gate_row_sums, &compute_row_sums, scratch0, context);
+  }
+}
+
 // Calculates the output state tensor of an LSTM step. See Float version too.
 //
 // Parameters:
@@ -550,7 +646,8 @@ void CalculateLstmOutputHybrid(
 }
 
 // Calculates a single LSTM gate, int8x8_16 version.
-// Implements the same functionality as CalculateLstmGateFloat.
+// Implements the same functionality as CalculateLstmGateFloat, with the
+// input projection computed by CalculateLstmGateInputProjectionInteger8x8_16.
 void CalculateLstmGateInteger8x8_16(
     // Input and weights
     const int8_t* input, const int8_t* input_to_gate_weights,
@@ -577,18 +674,24 @@ void CalculateLstmGateInteger8x8_16(
     // Parameters for performance optimizations
     CpuBackendContext* context,
     // Scratch arrays
-    int32_t* scratch5) {
+    int32_t* scratch5,
+    // Precomputed input projection (sequence batched LSTM), optional
+    const int16_t* input_projection) {
   const bool use_peephole = (cell_to_gate_weights != nullptr);
   const bool use_layer_norm = (layer_norm_coefficients != nullptr);
 
-  // Initialize scratch buffers with zeros. Note that unlike float and hybrid
-  // versions, bias is only used in layer normalization.
-  std::fill_n(gate, n_batch * n_cell, 0);
-  // For each batch and cell: compute input_weight * input.
-  tensor_utils::MatrixBatchVectorMultiplyAccumulate(
-      input, input_to_gate_bias, input_to_gate_weights, input_to_gate_scale_a,
-      input_to_gate_scale_b, n_batch, n_input, n_cell, 0, scratch5, gate,
-      context);
+  if (input_projection != nullptr) {
+    std::copy_n(input_projection, n_batch * n_cell, gate);
+  } else {
+    // Initialize scratch buffers with zeros. Note that unlike float and hybrid
+    // versions, bias is only used in layer normalization.
+    std::fill_n(gate, n_batch * n_cell, 0);
+    // For each batch and cell: compute input_weight * input.
+    tensor_utils::MatrixBatchVectorMultiplyAccumulate(
+        input, input_to_gate_bias, input_to_gate_weights,
+        input_to_gate_scale_a, input_to_gate_scale_b, n_batch, n_input, n_cell,
+        0, scratch5, gate, context);
+  }
   // Note: no aux_input.
 
   // For each batch and cell: compute recurrent_weight * output_state.
@@ -623,6 +726,28 @@ void CalculateLstmGateInteger8x8_16(
   }
 }
 
+// Calculates the part of a LSTM gate that only depends on the input, for all
+// the time steps of a sequence at once, int8x8_16 version. See
+// CalculateLstmGateInputProjectionFloat. The result is bit exact with the
+// step by step computation, as the gate accumulation starts from it.
+//
+// Parameters:
+//  - input: input vectors of all the time steps, size n_rows * n_input.
+//  - input_projection: output vectors, size n_rows * n_cell.
+//  - scratch5: scratch area of size n_rows * n_cell.
+void CalculateLstmGateInputProjectionInteger8x8_16(
+    const int8_t* input, const int8_t* input_to_gate_weights,
+    const int32_t* input_to_gate_bias, const int32_t input_to_gate_scale_a,
+    const int32_t input_to_gate_scale_b, const int n_rows, const int n_input,
+    const int n_cell, int16_t* input_projection, CpuBackendContext* context,
+    int32_t* scratch5) {
+  std::fill_n(input_projection, n_rows * n_cell, 0);
+  tensor_utils::MatrixBatchVectorMultiplyAccumulate(
+      input, input_to_gate_bias, input_to_gate_weights, input_to_gate_scale_a,
+      input_to_gate_scale_b, n_rows, n_input, n_cell, 0, scratch5,
+      input_projection, context);
+}
+
 // Updates the LSTM cell state, used by both integer LSTM versions.
 // Also see UpdateLstmCellFloat.
 //
@@ -863,6 +988,13 @@ void CalculateLstmOutputInteger8x8_8(
 //   cell_layer_norm_coefficients_ptr   - optional
 //   output_layer_norm_coefficients_ptr - optional
 //
+// Precomputed input projections of size 'n_batch * n_cell', see
+// CalculateLstmGateFloat:
+//   input_gate_projection_ptr          - optional
+//   forget_gate_projection_ptr         - optional
+//   cell_gate_projection_ptr           - optional
+//   output_gate_projection_ptr         - optional
+//
 // The pointers to the cell and output state and the output are updated.
 //
 // The pointers input_ptr, aux_input_ptr, and output_ptr point to data aligned
@@ -905,7 +1037,10 @@ inline void LstmStepFloat(
     float* scratch1, float* scratch2, float* scratch3, float* scratch4,
     float* output_ptr, bool recurrent_to_input_is_diag,
     bool recurrent_to_forget_is_diag, bool recurrent_to_cell_is_diag,
-    bool recurrent_to_output_is_diag, CpuBackendContext* context) {
+    bool recurrent_to_output_is_diag, const float* input_gate_projection_ptr,
+    const float* forget_gate_projection_ptr,
+    const float* cell_gate_projection_ptr,
+    const float* output_gate_projection_ptr, CpuBackendContext* context) {
   ruy::profiler::ScopeLabel label("LstmStepFloat");
   // Since we have already checked that weights are all there or none, we can
   // check the existence of only one to the get the condition.
@@ -937,7 +1072,7 @@ inline void LstmStepFloat(
         n_input, n_aux_input, n_output, n_cell,
         /*activation=*/kTfLiteActSigmoid, input_gate_scratch,
         is_input_all_zeros, is_aux_input_all_zeros, accumulation_scratch_buffer,
-        recurrent_to_input_is_diag, context);
+        recurrent_to_input_is_diag, input_gate_projection_ptr, context);
   }
   // Calculate the forget gate.
   CalculateLstmGateFloat(
@@ -950,7 +1085,7 @@ inline void LstmStepFloat(
       n_input, n_aux_input, n_output, n_cell,
       /*activation=*/kTfLiteActSigmoid, forget_gate_scratch, is_input_all_zeros,
       is_aux_input_all_zeros, accumulation_scratch_buffer,
-      recurrent_to_forget_is_diag, context);
+      recurrent_to_forget_is_diag, forget_gate_projection_ptr, context);
   // Calculate the cell update gate.
   CalculateLstmGateFloat(
       input_ptr, input_to_cell_weights_ptr, aux_input_ptr,
@@ -962,7 +1097,7 @@ inline void LstmStepFloat(
       cell_gate_bias_ptr, n_batch, n_input, n_aux_input, n_output, n_cell,
       params->activation, cell_gate_scratch, is_input_all_zeros,
       is_aux_input_all_zeros, accumulation_scratch_buffer,
-      recurrent_to_cell_is_diag, context);
+      recurrent_to_cell_is_diag, cell_gate_projection_ptr, context);
   // Update the cell state.
   UpdateLstmCellFloat(n_batch, n_cell, cell_state_ptr, input_gate_scratch,
                       forget_gate_scratch, cell_gate_scratch, use_cifg,
@@ -978,7 +1113,7 @@ inline void LstmStepFloat(
       n_input, n_aux_input, n_output, n_cell,
       /*activation=*/kTfLiteActSigmoid, output_gate_scratch, is_input_all_zeros,
       is_aux_input_all_zeros, accumulation_scratch_buffer,
-      recurrent_to_output_is_diag, context);
+      recurrent_to_output_is_diag, output_gate_projection_ptr, context);
   // Update the output state.
   CalculateLstmOutputFloat(n_batch, n_cell, n_output, cell_state_ptr,
                            output_gate_scratch, params->activation,
@@ -1059,6 +1194,15 @@ inline void LstmStepFloat(
 // Temporary pre-allocated storage for recovered values:
 //   recovered_cell_weights (same size as cell_to_*_weights)
 //
+// Precomputed input projections of size 'n_batch * n_cell', see
+// CalculateLstmGateHybrid. When given, the input isn't quantized again and
+// input_sf/input_zp must hold the scaling factors/zero points it was
+// quantized with:
+//   input_gate_projection_ptr          - optional
+//   forget_gate_projection_ptr         - optional
+//   cell_gate_projection_ptr           - optional
+//   output_gate_projection_ptr         - optional
+//
 // Outputs:
 //   output_state_ptr - size 'n_batch * n_output'
 //   cell_state_ptr   - size 'n_batch * n_cell'
@@ -1127,7 +1271,10 @@ inline void LstmStepHybrid(
     bool* compute_row_sums, bool asymmetric_quantize_inputs,
     bool recurrent_to_input_is_diag, bool recurrent_to_forget_is_diag,
     bool recurrent_to_cell_is_diag, bool recurrent_to_output_is_diag,
-    CpuBackendContext* context) {
+    const float* input_gate_projection_ptr,
+    const float* forget_gate_projection_ptr,
+    const float* cell_gate_projection_ptr,
+    const float* output_gate_projection_ptr, CpuBackendContext* context) {
   ruy::profiler::ScopeLabel label("LstmStepHybrid");
   // Since we have already checked that weights are all there or none, we
   // can check the existence of only one to the get the condition.
@@ -1215,8 +1362,8 @@ inline void LstmStepHybrid(
        tensor_utils::IsZeroVector(aux_input_ptr, n_batch * n_aux_input));
   const bool is_output_state_all_zeros =
       tensor_utils::IsZeroVector(output_state_ptr, n_batch * n_output);
-  // Quantize inputs.
-  if (!is_input_all_zeros) {
+  // Quantize inputs, unless already projected.
+  if (!is_input_all_zeros && forget_gate_projection_ptr == nullptr) {
     tensor_utils::BatchQuantizeFloats(input_ptr, n_batch, n_input,
                                       quantized_input_ptr, input_sf, input_zp,
                                       asymmetric_quantize_inputs);
@@ -1249,7 +1396,7 @@ inline void LstmStepHybrid(
         input_gate_scratch, is_input_all_zeros, is_aux_input_all_zeros,
         is_output_state_all_zeros, compute_row_sums, context,
         scaling_factors_scratch, recovered_cell_weights, accum_scratch_ptr,
-        recurrent_to_input_is_diag);
+        recurrent_to_input_is_diag, input_gate_projection_ptr);
   }
   // Calculate the forget gate.
   CalculateLstmGateHybrid(
@@ -1268,7 +1415,7 @@ inline void LstmStepHybrid(
       forget_gate_scratch, is_input_all_zeros, is_aux_input_all_zeros,
       is_output_state_all_zeros, compute_row_sums, context,
       scaling_factors_scratch, recovered_cell_weights, accum_scratch_ptr,
-      recurrent_to_forget_is_diag);
+      recurrent_to_forget_is_diag, forget_gate_projection_ptr);
   // Calculate the cell update gate.
   CalculateLstmGateHybrid(
       quantized_input_ptr, input_sf, input_zp, input_to_cell_weights_ptr,
@@ -1286,7 +1433,7 @@ inline void LstmStepHybrid(
       params->activation, cell_gate_scratch, is_input_all_zeros,
       is_aux_input_all_zeros, is_output_state_all_zeros, compute_row_sums,
       context, scaling_factors_scratch, recovered_cell_weights,
-      accum_scratch_ptr, recurrent_to_cell_is_diag);
+      accum_scratch_ptr, recurrent_to_cell_is_diag, cell_gate_projection_ptr);
   // Update the cell state.
   UpdateLstmCellFloat(n_batch, n_cell, cell_state_ptr, input_gate_scratch,
                       forget_gate_scratch, cell_gate_scratch, use_cifg,
@@ -1308,7 +1455,7 @@ inline void LstmStepHybrid(
       output_gate_scratch, is_input_all_zeros, is_aux_input_all_zeros,
       is_output_state_all_zeros, compute_row_sums, context,
       scaling_factors_scratch, recovered_cell_weights, accum_scratch_ptr,
-      recurrent_to_output_is_diag);
+      recurrent_to_output_is_diag, output_gate_projection_ptr);
   // Update the output state.
   CalculateLstmOutputHybrid(
       n_batch, n_cell, n_output, cell_state_ptr, output_gate_scratch,
@@ -1412,6 +1559,13 @@ inline void LstmStepHybrid(
 //   scratch5: this scratch buffer is created purely for optimizing the
 //              MatrixBatchVectorMultiplyAccumulate.
 //
+// Precomputed input projections of size 'n_batch * n_cell', see
+// CalculateLstmGateInteger8x8_16:
+//   input_gate_projection_ptr          - optional
+//   forget_gate_projection_ptr         - optional
+//   cell_gate_projection_ptr           - optional
+//   output_gate_projection_ptr         - optional
+//
 // Outputs:
 //   output_state_ptr - size 'n_batch * n_output'
 //   cell_state_ptr   - size 'n_batch * n_cell'
@@ -1480,7 +1634,11 @@ inline void LstmStepInteger8x8_16(
     int n_input, int n_output, int8_t* output_state_ptr,
     int32_t output_state_zp, int16_t* cell_state_ptr, int8_t* output_ptr,
     int16_t* scratch0, int16_t* scratch1, int16_t* scratch2, int16_t* scratch3,
-    int8_t* scratch4, int32_t* scratch5, CpuBackendContext* context) {
+    int8_t* scratch4, int32_t* scratch5,
+    const int16_t* input_gate_projection_ptr,
+    const int16_t* forget_gate_projection_ptr,
+    const int16_t* cell_gate_projection_ptr,
+    const int16_t* output_gate_projection_ptr, CpuBackendContext* context) {
   ruy::profiler::ScopeLabel label("LstmStepInteger8x8_16");
   // Make named scratch buffers for the different gates.
   int16_t* input_gate_scratch = scratch0;
@@ -1519,7 +1677,8 @@ inline void LstmStepInteger8x8_16(
         effective_cell_to_input_scale_b, layer_norm_input_weight_ptr,
         input_gate_bias_ptr, layer_norm_input_scale_a, layer_norm_input_scale_b,
         input_variance_guard, n_batch, n_input, n_output, n_cell,
-        kTfLiteActSigmoid, input_gate_scratch, context, scratch5);
+        kTfLiteActSigmoid, input_gate_scratch, context, scratch5,
+        input_gate_projection_ptr);
   }
   // Calculate the forget gate.
   CalculateLstmGateInteger8x8_16(
@@ -1533,7 +1692,7 @@ inline void LstmStepInteger8x8_16(
       forget_gate_bias_ptr, layer_norm_forget_scale_a,
       layer_norm_forget_scale_b, forget_variance_guard, n_batch, n_input,
       n_output, n_cell, kTfLiteActSigmoid, forget_gate_scratch, context,
-      scratch5);
+      scratch5, forget_gate_projection_ptr);
   // Calculate the cell update gate.
   CalculateLstmGateInteger8x8_16(
       input_ptr, input_to_cell_weight_ptr, input_to_cell_effective_bias,
@@ -1545,7 +1704,7 @@ inline void LstmStepInteger8x8_16(
       /*cell_to_gate_scale_b=*/0, layer_norm_cell_weight_ptr,
       cell_gate_bias_ptr, layer_norm_cell_scale_a, layer_norm_cell_scale_b,
       cell_variance_guard, n_batch, n_input, n_output, n_cell, kTfLiteActTanh,
-      cell_gate_scratch, context, scratch5);
+      cell_gate_scratch, context, scratch5, cell_gate_projection_ptr);
   // Update the cell state.
   UpdateLstmCellInteger(n_batch, n_cell, cell_state_ptr, cell_state_scale,
                         input_gate_scratch, forget_gate_scratch,
@@ -1562,7 +1721,7 @@ inline void LstmStepInteger8x8_16(
       output_gate_bias_ptr, layer_norm_output_scale_a,
       layer_norm_output_scale_b, output_variance_guard, n_batch, n_input,
       n_output, n_cell, kTfLiteActSigmoid, output_gate_scratch, context,
-      scratch5);
+      scratch5, output_gate_projection_ptr);
   // Update the output state.
   CalculateLstmOutputInteger8x8_16(
       n_batch, n_cell, n_output, cell_state_ptr, cell_state_scale,
@@ -1787,6 +1946,32 @@ inline void LstmStepInteger8x8_8(
   std::copy_n(output_state_ptr, n_batch * n_output, output_ptr);
 }
 
+// Splits the input projections of a whole sequence, stored gate after gate
+// (without the input gate with CIFG), into one 'n_rows * n_cell' buffer per
+// gate. The buffers are left to nullptr if input_projections is nullptr.
+template <typename T>
+void GetInputProjections(TfLiteTensor* input_projections, bool use_cifg,
+                         int n_rows, int n_cell, T** input_gate,
+                         T** forget_gate, T** cell_gate, T** output_gate) {
+  *input_gate = *forget_gate = *cell_gate = *output_gate = nullptr;
+  if (input_projections == nullptr) return;
+  T* input_projections_ptr = GetTensorData<T>(input_projections);
+  if (!use_cifg) {
+    *input_gate = input_projections_ptr;
+    input_projections_ptr += n_rows * n_cell;
+  }
+  *forget_gate = input_projections_ptr;
+  *cell_gate = *forget_gate + n_rows * n_cell;
+  *output_gate = *cell_gate + n_rows * n_cell;
+}
+
+// Returns the input projection of the given row of the sequence, or nullptr
+// if the sequence is evaluated step by step.
+template <typename T>
+inline const T* InputProjectionAt(const T* projection, int row, int n_cell) {
+  return projection == nullptr ? nullptr : projection + row * n_cell;
+}
+
 }  // namespace
 
 // LINT.IfChange
@@ -1819,7 +2004,7 @@ TfLiteStatus EvalFloat(
     TfLiteTensor* cell_state, TfLiteTensor* output,
     bool recurrent_to_input_is_diag, bool recurrent_to_forget_is_diag,
     bool recurrent_to_cell_is_diag, bool recurrent_to_output_is_diag,
-    CpuBackendContext* context) {
+    CpuBackendContext* context, TfLiteTensor* input_projections) {
   TF_LITE_ASSERT(input->dims->size >= 2 && input->dims->size <= 3);
 
   int max_time, n_batch;
@@ -1864,6 +2049,45 @@ TfLiteStatus EvalFloat(
     accumulation_scratch_buffer = scratch_buffer_ptr + 4 * n_cell * n_batch;
   }
 
+  // Compute the input part of the gates for the whole sequence at once, if a
+  // buffer was provided for it. Rows are in the same order as in the input.
+  float* input_gate_projection;
+  float* forget_gate_projection;
+  float* cell_gate_projection;
+  float* output_gate_projection;
+  GetInputProjections(input_projections, use_cifg, max_time * n_batch, n_cell,
+                      &input_gate_projection, &forget_gate_projection,
+                      &cell_gate_projection, &output_gate_projection);
+  if (input_projections != nullptr) {
+    const int n_rows = max_time * n_batch;
+    if (!use_cifg) {
+      CalculateLstmGateInputProjectionFloat(
+          GetTensorData<float>(input),
+          GetTensorData<float>(input_to_input_weights),
+          GetTensorData<float>(input_layer_norm_coefficients),
+          GetTensorData<float>(input_gate_bias), n_rows, n_input, n_cell,
+          input_gate_projection, context);
+    }
+    CalculateLstmGateInputProjectionFloat(
+        GetTensorData<float>(input),
+        GetTensorData<float>(input_to_forget_weights),
+        GetTensorData<float>(forget_layer_norm_coefficients),
+        GetTensorData<float>(forget_gate_bias), n_rows, n_input, n_cell,
+        forget_gate_projection, context);
+    CalculateLstmGateInputProjectionFloat(
+        GetTensorData<float>(input),
+        GetTensorData<float>(input_to_cell_weights),
+        GetTensorData<float>(cell_layer_norm_coefficients),
+        GetTensorData<float>(cell_gate_bias), n_rows, n_input, n_cell,
+        cell_gate_projection, context);
+    CalculateLstmGateInputProjectionFloat(
+        GetTensorData<float>(input),
+        GetTensorData<float>(input_to_output_weights),
+        GetTensorData<float>(output_layer_norm_coefficients),
+        GetTensorData<float>(output_gate_bias), n_rows, n_input, n_cell,
+        output_gate_projection, context);
+  }
+
   const int output_batch_leading_dim =
       output->dims->data[output->dims->size - 1];
   if (time_major) {
@@ -1913,7 +2137,12 @@ TfLiteStatus EvalFloat(
           input_gate_scratch, forget_gate_scratch, cell_gate_scratch,
           output_gate_scratch, accumulation_scratch_buffer, output_ptr,
           recurrent_to_input_is_diag, recurrent_to_forget_is_diag,
-          recurrent_to_cell_is_diag, recurrent_to_output_is_diag, context);
+          recurrent_to_cell_is_diag, recurrent_to_output_is_diag,
+          InputProjectionAt(input_gate_projection, t_rel * n_batch, n_cell),
+          InputProjectionAt(forget_gate_projection, t_rel * n_batch, n_cell),
+          InputProjectionAt(cell_gate_projection, t_rel * n_batch, n_cell),
+          InputProjectionAt(output_gate_projection, t_rel * n_batch, n_cell),
+          context);
     }
   } else {
     for (int b = 0; b < n_batch; b++) {
@@ -1976,7 +2205,12 @@ TfLiteStatus EvalFloat(
             forget_gate_scratch_ptr, cell_gate_scratch_ptr,
             output_gate_scratch_ptr, accumulation_scratch_buffer, output_ptr,
             recurrent_to_input_is_diag, recurrent_to_forget_is_diag,
-            recurrent_to_cell_is_diag, recurrent_to_output_is_diag, context);
+            recurrent_to_cell_is_diag, recurrent_to_output_is_diag,
+            InputProjectionAt(input_gate_projection, time_offset, n_cell),
+            InputProjectionAt(forget_gate_projection, time_offset, n_cell),
+            InputProjectionAt(cell_gate_projection, time_offset, n_cell),
+            InputProjectionAt(output_gate_projection, time_offset, n_cell),
+            context);
       }
     }
   }
@@ -2030,7 +2264,8 @@ TfLiteStatus EvalHybrid(
     TfLiteTensor* output_state_zp, TfLiteTensor* row_sums, int row_sums_size,
     bool* compute_row_sums, bool recurrent_to_input_is_diag,
     bool recurrent_to_forget_is_diag, bool recurrent_to_cell_is_diag,
-    bool recurrent_to_output_is_diag, CpuBackendContext* context) {
+    bool recurrent_to_output_is_diag, CpuBackendContext* context,
+    TfLiteTensor* input_projections) {
   TF_LITE_ASSERT(input->dims->size >= 2 && input->dims->size <= 3);
   const int n_input = input->dims->data[input->dims->size - 1];
   int max_time, n_batch;
@@ -2083,6 +2318,81 @@ TfLiteStatus EvalHybrid(
     row_sums_ptr = GetTensorData<int32_t>(row_sums);
   }
 
+  // Compute the input part of the gates for the whole sequence at once, if a
+  // buffer was provided for it. The whole input is then quantized upfront,
+  // with the scaling factors and zero points of all its rows kept in
+  // input_sf/input_zp. See EvalFloat.
+  float* input_gate_projection;
+  float* forget_gate_projection;
+  float* cell_gate_projection;
+  float* output_gate_projection;
+  GetInputProjections(input_projections, use_cifg, max_time * n_batch, n_cell,
+                      &input_gate_projection, &forget_gate_projection,
+                      &cell_gate_projection, &output_gate_projection);
+  if (input_projections != nullptr) {
+    const int n_rows = max_time * n_batch;
+    int8_t* quantized_input_ptr = GetTensorData<int8_t>(input_quantized);
+    float* input_sf_ptr = GetTensorData<float>(input_sf);
+    tensor_utils::BatchQuantizeFloats(
+        GetTensorData<float>(input), n_rows, n_input, quantized_input_ptr,
+        input_sf_ptr, input_zp_ptr, params->asymmetric_quantize_inputs);
+    // Same layout as in LstmStepHybrid. The row sums of the input weights are
+    // only updated here, LstmStepHybrid still computes all of them.
+    int32_t* input_to_input_row_sums = row_sums_ptr;
+    int32_t* input_to_forget_row_sums = nullptr;
+    int32_t* input_to_cell_row_sums = nullptr;
+    int32_t* input_to_output_row_sums = nullptr;
+    if (row_sums_ptr != nullptr) {
+      input_to_forget_row_sums = use_cifg ? input_to_input_row_sums
+                                          : input_to_input_row_sums + n_cell;
+      input_to_cell_row_sums = input_to_forget_row_sums + n_cell;
+      input_to_output_row_sums = input_to_cell_row_sums + n_cell;
+    }
+    float* scaling_factors_scratch = GetTensorData<float>(prod_scaling_factors);
+    int32_t* accum_scratch = GetTensorData<int32_t>(output_scratch_buffer);
+    if (!use_cifg) {
+      CalculateLstmGateInputProjectionHybrid(
+          quantized_input_ptr, input_sf_ptr, input_zp_ptr,
+          GetTensorData<int8_t>(input_to_input_weights),
+          GetTensorData<uint8_t>(input_to_input_weights_ledger),
+          GetTensorScale(input_to_input_weights), input_to_input_row_sums,
+          *compute_row_sums,
+          GetTensorData<float>(input_layer_norm_coefficients),
+          GetTensorData<float>(input_gate_bias), n_rows, n_input, n_cell,
+          input_gate_projection, context, scaling_factors_scratch,
+          accum_scratch);
+    }
+    CalculateLstmGateInputProjectionHybrid(
+        quantized_input_ptr, input_sf_ptr, input_zp_ptr,
+        GetTensorData<int8_t>(input_to_forget_weights),
+        GetTensorData<uint8_t>(input_to_forget_weights_ledger),
+        GetTensorScale(input_to_forget_weights), input_to_forget_row_sums,
+        *compute_row_sums,
+        GetTensorData<float>(forget_layer_norm_coefficients),
+        GetTensorData<float>(forget_gate_bias), n_rows, n_input, n_cell,
+        forget_gate_projection, context, scaling_factors_scratch,
+        accum_scratch);
+    CalculateLstmGateInputProjectionHybrid(
+        quantized_input_ptr, input_sf_ptr, input_zp_ptr,
+        GetTensorData<int8_t>(input_to_cell_weights),
+        GetTensorData<uint8_t>(input_to_cell_weights_ledger),
+        GetTensorScale(input_to_cell_weights), input_to_cell_row_sums,
+        *compute_row_sums, GetTensorData<float>(cell_layer_norm_coefficients),
+        GetTensorData<float>(cell_gate_bias), n_rows, n_input, n_cell,
+        cell_gate_projection, context, scaling_factors_scratch,
+        accum_scratch);
+    CalculateLstmGateInputProjectionHybrid(
+        quantized_input_ptr, input_sf_ptr, input_zp_ptr,
+        GetTensorData<int8_t>(input_to_output_weights),
+        GetTensorData<uint8_t>(input_to_output_weights_ledger),
+        GetTensorScale(input_to_output_weights), input_to_output_row_sums,
+        *compute_row_sums,
+        GetTensorData<float>(output_layer_norm_coefficients),
+        GetTensorData<float>(output_gate_bias), n_rows, n_input, n_cell,
+        output_gate_projection, context, scaling_factors_scratch,
+        accum_scratch);
+  }
+
   if (time_major) {
     // Feed the sequence into the LSTM step-by-step.
     const int input_step = n_batch * n_input;
@@ -2098,6 +2408,9 @@ TfLiteStatus EvalHybrid(
       }
       float* output_ptr =
           GetTensorData<float>(output) + t_rel * output_step + output_offset;
+      // With input projections, the step uses the scaling factors and zero
+      // points its input was quantized with.
+      const int row = (input_projections != nullptr) ? t_rel * n_batch : 0;
       LstmStepHybrid(
           input_ptr, GetTensorData<int8_t>(input_to_input_weights),
           GetTensorData<uint8_t>(input_to_input_weights_ledger),
@@ -2155,7 +2468,7 @@ TfLiteStatus EvalHybrid(
           GetTensorData<float>(projection_bias), params, n_batch, n_cell,
           n_input, aux_input_size, n_output, output_batch_leading_dim,
           input_gate_scratch, forget_gate_scratch, cell_gate_scratch,
-          output_gate_scratch, GetTensorData<float>(input_sf),
+          output_gate_scratch, GetTensorData<float>(input_sf) + row,
           GetTensorData<float>(aux_input_sf),
           GetTensorData<float>(output_state_sf),
           GetTensorData<float>(prod_scaling_factors),
@@ -2166,10 +2479,16 @@ TfLiteStatus EvalHybrid(
           GetTensorData<int8_t>(cell_state_quantized),
           GetTensorData<float>(output_state), GetTensorData<float>(cell_state),
           GetTensorData<int32_t>(output_scratch_buffer), output_ptr,
-          input_zp_ptr, aux_input_zp_ptr, output_state_zp_ptr, row_sums_ptr,
-          row_sums_size, compute_row_sums, params->asymmetric_quantize_inputs,
-          recurrent_to_input_is_diag, recurrent_to_forget_is_diag,
-          recurrent_to_cell_is_diag, recurrent_to_output_is_diag, context);
+          input_zp_ptr ? input_zp_ptr + row : nullptr, aux_input_zp_ptr,
+          output_state_zp_ptr, row_sums_ptr, row_sums_size, compute_row_sums,
+          params->asymmetric_quantize_inputs, recurrent_to_input_is_diag,
+          recurrent_to_forget_is_diag, recurrent_to_cell_is_diag,
+          recurrent_to_output_is_diag,
+          InputProjectionAt(input_gate_projection, t_rel * n_batch, n_cell),
+          InputProjectionAt(forget_gate_projection, t_rel * n_batch, n_cell),
+          InputProjectionAt(cell_gate_projection, t_rel * n_batch, n_cell),
+          InputProjectionAt(output_gate_projection, t_rel * n_batch, n_cell),
+          context);
     }
   } else {
     for (int b = 0; b < n_batch; b++) {
@@ -2200,6 +2519,9 @@ TfLiteStatus EvalHybrid(
         float* forget_gate_scratch_ptr = forget_gate_scratch + b * n_cell;
         float* cell_gate_scratch_ptr = cell_gate_scratch + b * n_cell;
         float* output_gate_scratch_ptr = output_gate_scratch + b * n_cell;
+        // With input projections, the step uses the scaling factor and zero
+        // point its input was quantized with.
+        const int row = (input_projections != nullptr) ? time_offset : 0;
 
         LstmStepHybrid(
             input_ptr, GetTensorData<int8_t>(input_to_input_weights),
@@ -2259,7 +2581,7 @@ TfLiteStatus EvalHybrid(
             /*n_batch=*/1, n_cell, n_input, aux_input_size, n_output,
             output_batch_leading_dim, input_gate_scratch_ptr,
             forget_gate_scratch_ptr, cell_gate_scratch_ptr,
-            output_gate_scratch_ptr, GetTensorData<float>(input_sf),
+            output_gate_scratch_ptr, GetTensorData<float>(input_sf) + row,
             GetTensorData<float>(aux_input_sf),
             GetTensorData<float>(output_state_sf),
             GetTensorData<float>(prod_scaling_factors),
@@ -2269,11 +2591,17 @@ TfLiteStatus EvalHybrid(
             GetTensorData<int8_t>(output_state_quantized),
             GetTensorData<int8_t>(cell_state_quantized), output_state_ptr,
             cell_state_ptr, GetTensorData<int32_t>(output_scratch_buffer),
-            output_ptr, input_zp_ptr, aux_input_zp_ptr, output_state_zp_ptr,
-            row_sums_ptr, row_sums_size, compute_row_sums,
+            output_ptr, input_zp_ptr ? input_zp_ptr + row : nullptr,
+            aux_input_zp_ptr, output_state_zp_ptr, row_sums_ptr,
+            row_sums_size, compute_row_sums,
             params->asymmetric_quantize_inputs, recurrent_to_input_is_diag,
             recurrent_to_forget_is_diag, recurrent_to_cell_is_diag,
-            recurrent_to_output_is_diag, context);
+            recurrent_to_output_is_diag,
+            InputProjectionAt(input_gate_projection, time_offset, n_cell),
+            InputProjectionAt(forget_gate_projection, time_offset, n_cell),
+            InputProjectionAt(cell_gate_projection, time_offset, n_cell),
+            InputProjectionAt(output_gate_projection, time_offset, n_cell),
+            context);
       }
     }
   }
@@ -2305,7 +2633,7 @@ TfLiteStatus EvalInteger8x8_16(
     TfLiteTensor* output_state, TfLiteTensor* cell_state, TfLiteTensor* output,
     TfLiteTensor* scratch0, TfLiteTensor* scratch1, TfLiteTensor* scratch2,
     TfLiteTensor* scratch3, TfLiteTensor* scratch4, TfLiteTensor* scratch5,
-    CpuBackendContext* context) {
+    CpuBackendContext* context, TfLiteTensor* input_projections) {
   TF_LITE_ASSERT(input->dims->size >= 2 && input->dims->size <= 3);
   const int n_input = input->dims->data[input->dims->size - 1];
   int max_time, n_batch;
@@ -2321,6 +2649,55 @@ TfLiteStatus EvalInteger8x8_16(
   const int n_cell = input_to_output_weights->dims->data[0];
   const int n_output = recurrent_to_output_weights->dims->data[1];
 
+  // Compute the input part of the gates for the whole sequence at once, if a
+  // buffer was provided for it. scratch5 must then hold n_rows * n_cell
+  // values. See EvalFloat.
+  const bool use_cifg = (input_to_input_weights == nullptr);
+  int16_t* input_gate_projection;
+  int16_t* forget_gate_projection;
+  int16_t* cell_gate_projection;
+  int16_t* output_gate_projection;
+  GetInputProjections(input_projections, use_cifg, max_time * n_batch, n_cell,
+                      &input_gate_projection, &forget_gate_projection,
+                      &cell_gate_projection, &output_gate_projection);
+  if (input_projections != nullptr) {
+    const int n_rows = max_time * n_batch;
+    if (!use_cifg) {
+      CalculateLstmGateInputProjectionInteger8x8_16(
+          GetTensorData<int8_t>(input),
+          GetTensorData<int8_t>(input_to_input_weights),
+          integer_lstm_param->input_to_input_effective_bias.get(),
+          integer_lstm_param->effective_input_to_input_scale_a,
+          integer_lstm_param->effective_input_to_input_scale_b, n_rows,
+          n_input, n_cell, input_gate_projection, context,
+          GetTensorData<int32_t>(scratch5));
+    }
+    CalculateLstmGateInputProjectionInteger8x8_16(
+        GetTensorData<int8_t>(input),
+        GetTensorData<int8_t>(input_to_forget_weights),
+        integer_lstm_param->input_to_forget_effective_bias.get(),
+        integer_lstm_param->effective_input_to_forget_scale_a,
+        integer_lstm_param->effective_input_to_forget_scale_b, n_rows,
+        n_input, n_cell, forget_gate_projection, context,
+        GetTensorData<int32_t>(scratch5));
+    CalculateLstmGateInputProjectionInteger8x8_16(
+        GetTensorData<int8_t>(input),
+        GetTensorData<int8_t>(input_to_cell_weights),
+        integer_lstm_param->input_to_cell_effective_bias.get(),
+        integer_lstm_param->effective_input_to_cell_scale_a,
+        integer_lstm_param->effective_input_to_cell_scale_b, n_rows, n_input,
+        n_cell, cell_gate_projection, context,
+        GetTensorData<int32_t>(scratch5));
+    CalculateLstmGateInputProjectionInteger8x8_16(
+        GetTensorData<int8_t>(input),
+        GetTensorData<int8_t>(input_to_output_weights),
+        integer_lstm_param->input_to_output_effective_bias.get(),
+        integer_lstm_param->effective_input_to_output_scale_a,
+        integer_lstm_param->effective_input_to_output_scale_b, n_rows,
+        n_input, n_cell, output_gate_projection, context,
+        GetTensorData<int32_t>(scratch5));
+  }
+
   // Activation zero point
   int output_state_zp = output_state->params.zero_point;
 
@@ -2413,6 +2790,10 @@ TfLiteStatus EvalInteger8x8_16(
           GetTensorData<int16_t>(scratch0), GetTensorData<int16_t>(scratch1),
           GetTensorData<int16_t>(scratch2), GetTensorData<int16_t>(scratch3),
           GetTensorData<int8_t>(scratch4), GetTensorData<int32_t>(scratch5),
+          InputProjectionAt(input_gate_projection, t_rel * n_batch, n_cell),
+          InputProjectionAt(forget_gate_projection, t_rel * n_batch, n_cell),
+          InputProjectionAt(cell_gate_projection, t_rel * n_batch, n_cell),
+          InputProjectionAt(output_gate_projection, t_rel * n_batch, n_cell),
           context);
     }
   } else {
@@ -2511,7 +2892,12 @@ TfLiteStatus EvalInteger8x8_16(
             cell_state_ptr, output_ptr, GetTensorData<int16_t>(scratch0),
             GetTensorData<int16_t>(scratch1), GetTensorData<int16_t>(scratch2),
             GetTensorData<int16_t>(scratch3), GetTensorData<int8_t>(scratch4),
-            GetTensorData<int32_t>(scratch5), context);
+            GetTensorData<int32_t>(scratch5),
+            InputProjectionAt(input_gate_projection, time_offset, n_cell),
+            InputProjectionAt(forget_gate_projection, time_offset, n_cell),
+            InputProjectionAt(cell_gate_projection, time_offset, n_cell),
+            InputProjectionAt(output_gate_projection, time_offset, n_cell),
+            context);
       }
     }
   }
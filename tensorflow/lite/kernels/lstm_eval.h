@@ -95,6 +95,13 @@ struct IntegerLstmParameter {
   int32_t intermediate_zp[12];
 };
 
+// The Eval functions below run the LSTM over a whole sequence. If
+// input_projections is given, the part of the gates that only depends on the
+// input is computed for all the time steps upfront, with one matrix
+// multiplication per gate, and stored in it. It must then hold
+// 'num_gates * max_time * n_batch * n_cell' values, with num_gates = 3 with
+// CIFG and 4 otherwise, of the gate type (float, or int16 for integer LSTM).
+// Otherwise, the LSTM is evaluated step by step.
 TfLiteStatus EvalFloat(
     const TfLiteTensor* input, const TfLiteTensor* input_to_input_weights,
     const TfLiteTensor* input_to_forget_weights,
@@ -124,8 +131,11 @@ TfLiteStatus EvalFloat(
     TfLiteTensor* cell_state, TfLiteTensor* output,
     bool recurrent_to_input_is_diag, bool recurrent_to_forget_is_diag,
     bool recurrent_to_cell_is_diag, bool recurrent_to_output_is_diag,
-    CpuBackendContext* context);
+    CpuBackendContext* context, TfLiteTensor* input_projections = nullptr);
 
+// With input_projections, input_quantized must be as large as the input and
+// input_sf, input_zp and prod_scaling_factors must hold 'max_time * n_batch'
+// values, and output_scratch_buffer 'max_time * n_batch * n_cell'.
 TfLiteStatus EvalHybrid(
     const TfLiteTensor* input, const TfLiteTensor* input_to_input_weights,
     const TfLiteTensor* input_to_input_weights_ledger,
@@ -172,8 +182,11 @@ TfLiteStatus EvalHybrid(
     TfLiteTensor* output_state_zp, TfLiteTensor* row_sums, int row_sums_size,
     bool* compute_row_sums, bool recurrent_to_input_is_diag,
     bool recurrent_to_forget_is_diag, bool recurrent_to_cell_is_diag,
-    bool recurrent_to_output_is_diag, CpuBackendContext* context);
+    bool recurrent_to_output_is_diag, CpuBackendContext* context,
+    TfLiteTensor* input_projections = nullptr);
 
+// With input_projections, scratch5 must hold 'max_time * n_batch * n_cell'
+// values.
 TfLiteStatus EvalInteger8x8_16(
     const TfLiteTensor* input, const TfLiteTensor* input_to_input_weights,
     const TfLiteTensor* input_to_forget_weights,
@@ -198,7 +211,7 @@ TfLiteStatus EvalInteger8x8_16(
     TfLiteTensor* output_state, TfLiteTensor* cell_state, TfLiteTensor* output,
     TfLiteTensor* scratch0, TfLiteTensor* scratch1, TfLiteTensor* scratch2,
     TfLiteTensor* scratch3, TfLiteTensor* scratch4, TfLiteTensor* scratch5,
-    CpuBackendContext* context);
+    CpuBackendContext* context, TfLiteTensor* input_projections = nullptr);
 
 TfLiteStatus EvalInteger8x8_8(
     const TfLiteTensor* input, const TfLiteTensor* input_to_input_weights,
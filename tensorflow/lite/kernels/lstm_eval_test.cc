@@ -493,6 +493,12 @@ class QuantizedLstmParam : public BaseLstmParam {
     scratch5_tensor_.data.i32 = scratch5_.data();
     return &scratch5_tensor_;
   }
+  TfLiteTensor* GetInputProjections() {
+    PackWeightToTensor(&input_projections_tensor_, input_projections_,
+                       input_projections_size_);
+    input_projections_tensor_.data.i16 = input_projections_.data();
+    return &input_projections_tensor_;
+  }
   TfLiteTensor* GetActivation() {
     PackWeightToTensor(&activation_tensor_, activation_, activation_size_);
     activation_tensor_.data.int8 = activation_.data();
@@ -516,6 +522,7 @@ class QuantizedLstmParam : public BaseLstmParam {
     TfLiteIntArrayFree(scratch3_tensor_.dims);
     TfLiteIntArrayFree(scratch4_tensor_.dims);
     TfLiteIntArrayFree(scratch5_tensor_.dims);
+    TfLiteIntArrayFree(input_projections_tensor_.dims);
   }
 
  private:
@@ -599,9 +606,14 @@ class QuantizedLstmParam : public BaseLstmParam {
   std::vector<int32_t> scratch5_;
   std::vector<int32_t> scratch5_size_ = {n_batch_, n_cell_};
   TfLiteTensor scratch5_tensor_;
+
+  // Input projections of the 4 gates.
+  std::vector<int16_t> input_projections_;
+  std::vector<int32_t> input_projections_size_ = {4, n_batch_, n_cell_};
+  TfLiteTensor input_projections_tensor_ = {};
 };
 
-void TestOneFullyQuantizedLSTM() {
+void TestOneFullyQuantizedLSTM(bool use_input_projections) {
   CpuBackendContext context;
   QuantizedLstmParam one_parameter;
   auto activation = one_parameter.GetActivation();
@@ -621,7 +633,8 @@ void TestOneFullyQuantizedLSTM() {
       /*time_major=*/true, param, activation, cell, output,
       one_parameter.GetScratch0(), one_parameter.GetScratch1(),
       one_parameter.GetScratch2(), one_parameter.GetScratch3(),
-      one_parameter.GetScratch4(), one_parameter.GetScratch5(), &context);
+      one_parameter.GetScratch4(), one_parameter.GetScratch5(), &context,
+      use_input_projections ? one_parameter.GetInputProjections() : nullptr);
 
   // Verify results.
   const std::vector<int16_t> expected_cell = {
@@ -636,7 +649,11 @@ void TestOneFullyQuantizedLSTM() {
 }
 
 TEST(TestOneFullyQuantizedLSTM, TestOneFullyQuantizedLSTM) {
-  TestOneFullyQuantizedLSTM();
+  TestOneFullyQuantizedLSTM(/*use_input_projections=*/false);
+}
+
+TEST(TestOneFullyQuantizedLSTM, TestOneFullyQuantizedLSTMInputProjections) {
+  TestOneFullyQuantizedLSTM(/*use_input_projections=*/true);
 }
 
 class HybridLstmParam : public BaseLstmParam {
@@ -740,6 +757,12 @@ class HybridLstmParam : public BaseLstmParam {
     accum_scratch_tensor_.data.i32 = accum_scratch_.data();
     return &accum_scratch_tensor_;
   }
+  TfLiteTensor* GetInputProjections() {
+    PackWeightToTensor(&input_projections_tensor_, input_projections_,
+                       input_projections_size_);
+    input_projections_tensor_.data.f = input_projections_.data();
+    return &input_projections_tensor_;
+  }
   TfLiteTensor* GetInputBias() {
     PackWeightToTensor(&input_gate_bias_tensor_, input_float_bias_,
                        input_gate_bias_size_);
@@ -802,6 +825,7 @@ class HybridLstmParam : public BaseLstmParam {
   ~HybridLstmParam() {
     TfLiteIntArrayFree(scratch_buffer_tensor_.dims);
     TfLiteIntArrayFree(accum_scratch_tensor_.dims);
+    TfLiteIntArrayFree(input_projections_tensor_.dims);
     TfLiteIntArrayFree(input_sf_tensor_.dims);
     TfLiteIntArrayFree(aux_input_sf_tensor_.dims);
     TfLiteIntArrayFree(output_state_sf_tensor_.dims);
@@ -862,6 +886,11 @@ class HybridLstmParam : public BaseLstmParam {
   std::vector<int32_t> accum_scratch_;
   std::vector<int32_t> accum_scratch_size_ = {n_cell_, n_batch_};
   TfLiteTensor accum_scratch_tensor_;
+
+  // Input projections of the 4 gates.
+  std::vector<float> input_projections_;
+  std::vector<int32_t> input_projections_size_ = {4, n_batch_, n_cell_};
+  TfLiteTensor input_projections_tensor_ = {};
   std::vector<float> output_float_ = {
       1, 1, 3, 4, -5, 6,  //
       1, 4, 3, 4, -5, 6,  //
@@ -896,7 +925,7 @@ class HybridLstmParam : public BaseLstmParam {
   };
 };
 
-void TestOneHybridAsymmLSTM() {
+void TestOneHybridAsymmLSTM(bool use_input_projections) {
   CpuBackendContext context;
   HybridLstmParam one_parameter;
   auto activation = one_parameter.GetActivation();
@@ -947,7 +976,8 @@ void TestOneHybridAsymmLSTM() {
       /*recurrent_to_input_is_diag=*/false,
       /*recurrent_to_forget_is_diag=*/false,
       /*recurrent_to_cell_is_diag=*/false,
-      /*recurrent_to_output_is_diag=*/false, &context);
+      /*recurrent_to_output_is_diag=*/false, &context,
+      use_input_projections ? one_parameter.GetInputProjections() : nullptr);
   const std::vector<float> expected_cell = {
       7.83134,  1.96158, 2.18285, 3.28739,  0.483214,
       0.618206, 1.21539, 1.4052,  -3.17735, 2.24296,  //
@@ -966,7 +996,11 @@ void TestOneHybridAsymmLSTM() {
 }
 
 TEST(TestOneHybridAsymmLSTM, TestOneHybridAsymmLSTM) {
-  TestOneHybridAsymmLSTM();
+  TestOneHybridAsymmLSTM(/*use_input_projections=*/false);
+}
+
+TEST(TestOneHybridAsymmLSTM, TestOneHybridAsymmLSTMInputProjections) {
+  TestOneHybridAsymmLSTM(/*use_input_projections=*/true);
 }
 
 }  // namespace
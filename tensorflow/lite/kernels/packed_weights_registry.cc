@@ -0,0 +1,236 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/kernels/packed_weights_registry.h"
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <farmhash.h>
+#include "tensorflow/lite/allocation.h"
+#include "tensorflow/lite/minimal_logging.h"
+#include "tensorflow/lite/stderr_reporter.h"
+
+namespace tflite {
+namespace {
+
+// Files start with this magic, followed by the number of entries and the
+// entries. Each entry holds the size and characters of its kind, the
+// fingerprint and size of its source, and its packed size, followed by the
+// packed data at the next multiple of kAlignment.
+constexpr char kFileMagic[8] = {'T', 'F', 'L', 'P', 'W', 'R', '0', '1'};
+
+size_t AlignTo(size_t offset) {
+  constexpr size_t kAlignment = PackedWeightsRegistry::kAlignment;
+  return (offset + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+uint64_t Fingerprint(const void* data, size_t size) {
+  return ::util::Fingerprint64(static_cast<const char*>(data), size);
+}
+
+// Reads a uint64_t at `*offset` of `data`, advancing `*offset`.
+bool ReadUint64(const char* data, size_t size, size_t* offset,
+                uint64_t* value) {
+  if (size - *offset < sizeof(*value)) return false;
+  memcpy(value, data + *offset, sizeof(*value));
+  *offset += sizeof(*value);
+  return true;
+}
+
+}  // namespace
+
+PackedWeightsRegistry& PackedWeightsRegistry::Get() {
+  static PackedWeightsRegistry* registry = new PackedWeightsRegistry;
+  return *registry;
+}
+
+PackedWeightsRegistry::~PackedWeightsRegistry() = default;
+
+std::shared_ptr<const void> PackedWeightsRegistry::GetOrPack(
+    const std::string& kind, const void* source, size_t source_size,
+    size_t packed_size, const std::function<void(void*)>& pack) {
+  Key key(kind, Fingerprint(source, source_size), source_size);
+  std::shared_ptr<Packed> packed;
+  std::shared_ptr<const void> mapped_data;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = packed_.find(key);
+    if (it == packed_.end()) {
+      // Pruning whenever the number of entries doubles keeps its cost
+      // amortized over the insertions.
+      if (packed_.size() >= prune_threshold_) {
+        PruneExpired();
+        prune_threshold_ = std::max(kMinPruneThreshold, 2 * packed_.size());
+      }
+      it = packed_.emplace(key, std::make_shared<Packed>()).first;
+    }
+    packed = it->second;
+    auto mapped = mapped_.find(key);
+    if (mapped != mapped_.end() && mapped->second.size == packed_size) {
+      // Keep the mapping alive as long as the packed weights are.
+      mapped_data = std::shared_ptr<const void>(mapped->second.file,
+                                                mapped->second.data);
+    }
+  }
+
+  // Only the weights of this key are locked while they are packed.
+  std::lock_guard<std::mutex> lock(packed->mutex);
+  if (std::shared_ptr<const void> data = packed->data.lock()) {
+    if (packed->size == packed_size) return data;
+  }
+  std::shared_ptr<const void> data = std::move(mapped_data);
+  if (data == nullptr) {
+    std::shared_ptr<char> buffer(new char[packed_size + kAlignment],
+                                 std::default_delete<char[]>());
+    const uintptr_t address = reinterpret_cast<uintptr_t>(buffer.get());
+    char* aligned = buffer.get() + (AlignTo(address) - address);
+    pack(aligned);
+    data = std::shared_ptr<const void>(std::move(buffer), aligned);
+  }
+  packed->data = data;
+  packed->size = packed_size;
+  return data;
+}
+
+void PackedWeightsRegistry::PruneExpired() {
+  for (auto it = packed_.begin(); it != packed_.end();) {
+    // Other threads only get a reference to an entry while holding `mutex_`,
+    // so an entry referenced by the registry alone stays unused.
+    bool expired = false;
+    if (it->second.use_count() == 1) {
+      std::lock_guard<std::mutex> lock(it->second->mutex);
+      expired = it->second->data.expired();
+    }
+    it = expired ? packed_.erase(it) : std::next(it);
+  }
+}
+
+size_t PackedWeightsRegistry::NumEntriesForTesting() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return packed_.size();
+}
+
+bool PackedWeightsRegistry::SaveToFile(const std::string& path) {
+  std::vector<std::pair<Key, std::shared_ptr<Packed>>> all_packed;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    all_packed.assign(packed_.begin(), packed_.end());
+  }
+  struct Entry {
+    const Key* key;
+    std::shared_ptr<const void> data;
+    uint64_t size;
+  };
+  std::vector<Entry> entries;
+  for (const auto& [key, packed] : all_packed) {
+    std::lock_guard<std::mutex> lock(packed->mutex);
+    std::shared_ptr<const void> data = packed->data.lock();
+    if (data == nullptr) continue;
+    entries.push_back({&key, std::move(data), packed->size});
+  }
+
+  FILE* file = fopen(path.c_str(), "wb");
+  if (file == nullptr) {
+    TFLITE_LOG(TFLITE_LOG_ERROR, "Could not open %s for writing.",
+               path.c_str());
+    return false;
+  }
+  bool ok = true;
+  size_t offset = 0;
+  const auto write = [&](const void* data, size_t size) {
+    ok = ok && fwrite(data, 1, size, file) == size;
+    offset += size;
+  };
+  const auto write_uint64 = [&](uint64_t value) {
+    write(&value, sizeof(value));
+  };
+  const std::vector<char> padding(kAlignment, 0);
+  write(kFileMagic, sizeof(kFileMagic));
+  write_uint64(entries.size());
+  for (const Entry& entry : entries) {
+    const auto& [kind, fingerprint, source_size] = *entry.key;
+    write_uint64(kind.size());
+    write(kind.data(), kind.size());
+    write_uint64(fingerprint);
+    write_uint64(source_size);
+    write_uint64(entry.size);
+    write(padding.data(), AlignTo(offset) - offset);
+    write(entry.data.get(), entry.size);
+  }
+  ok = (fclose(file) == 0) && ok;
+  if (!ok) {
+    TFLITE_LOG(TFLITE_LOG_ERROR, "Could not write packed weights to %s.",
+               path.c_str());
+  }
+  return ok;
+}
+
+bool PackedWeightsRegistry::LoadFromFile(const std::string& path) {
+  if (!MMAPAllocation::IsSupported()) return false;
+  auto file =
+      std::make_shared<MMAPAllocation>(path.c_str(), DefaultErrorReporter());
+  if (!file->valid()) return false;
+  const char* data = static_cast<const char*>(file->base());
+  const size_t size = file->bytes();
+  // Packed data offsets in the file must be aligned in memory as well.
+  if (reinterpret_cast<uintptr_t>(data) % kAlignment != 0) return false;
+
+  size_t offset = sizeof(kFileMagic);
+  uint64_t num_entries = 0;
+  if (size < offset || memcmp(data, kFileMagic, offset) != 0 ||
+      !ReadUint64(data, size, &offset, &num_entries)) {
+    TFLITE_LOG(TFLITE_LOG_ERROR, "%s is not a packed weights file.",
+               path.c_str());
+    return false;
+  }
+  std::map<Key, Mapped> mapped;
+  for (uint64_t i = 0; i < num_entries; ++i) {
+    uint64_t kind_size = 0, fingerprint = 0, source_size = 0, packed_size = 0;
+    if (!ReadUint64(data, size, &offset, &kind_size) ||
+        size - offset < kind_size) {
+      return false;
+    }
+    std::string kind(data + offset, kind_size);
+    offset += kind_size;
+    if (!ReadUint64(data, size, &offset, &fingerprint) ||
+        !ReadUint64(data, size, &offset, &source_size) ||
+        !ReadUint64(data, size, &offset, &packed_size)) {
+      return false;
+    }
+    offset = AlignTo(offset);
+    if (offset > size || size - offset < packed_size) return false;
+    mapped[std::make_tuple(std::move(kind), fingerprint, source_size)] = {
+        file, data + offset, packed_size};
+    offset += packed_size;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  mapped.merge(mapped_);
+  mapped_ = std::move(mapped);
+  return true;
+}
+
+}  // namespace tflite
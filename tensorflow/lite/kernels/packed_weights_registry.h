@@ -0,0 +1,120 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_KERNELS_PACKED_WEIGHTS_REGISTRY_H_
+#define TENSORFLOW_LITE_KERNELS_PACKED_WEIGHTS_REGISTRY_H_
+
+#include <stddef.h>
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <tuple>
+
+namespace tflite {
+
+class MMAPAllocation;
+
+// A process-wide registry of constant weights that kernels repack into a
+// layout of their own.
+//
+// Packed weights are keyed by the fingerprint and size of their source data,
+// so that all the interpreters created on a model, or on copies of it, use a
+// single packed copy instead of one per instance, and memory doesn't grow
+// with the number of interpreters. Keying by content rather than by source
+// address also means that a source freed and reallocated at the same address
+// with other data is never given stale weights.
+//
+// The packed weights alive in the process can also be saved to a file. A later
+// process can map that file at startup, and weights whose content matches an
+// entry of the file are then used from the mapping without being repacked.
+//
+// All methods are thread-safe. Weights are packed without holding the lock of
+// the registry, so that packing some weights doesn't block interpreters that
+// use others.
+class PackedWeightsRegistry {
+ public:
+  // Returns the registry shared by the whole process.
+  static PackedWeightsRegistry& Get();
+
+  PackedWeightsRegistry() = default;
+  ~PackedWeightsRegistry();
+  PackedWeightsRegistry(const PackedWeightsRegistry&) = delete;
+  PackedWeightsRegistry& operator=(const PackedWeightsRegistry&) = delete;
+
+  // Returns `packed_size` bytes of weights packed from the `source_size` bytes
+  // of constant data at `source`. `kind` identifies the packing, e.g. the
+  // kernel and layout, so that several kernels can pack the same source.
+  // `pack` fills the packed buffer; it is only called if the weights aren't
+  // already alive in the process or available from a mapped file. The packed
+  // weights are aligned to kAlignment and stay alive as long as any pointer
+  // returned for them.
+  std::shared_ptr<const void> GetOrPack(const std::string& kind,
+                                        const void* source, size_t source_size,
+                                        size_t packed_size,
+                                        const std::function<void(void*)>& pack);
+
+  // Writes all the packed weights currently alive to `path`. Returns false on
+  // failure.
+  bool SaveToFile(const std::string& path);
+
+  // Maps `path`, previously written by SaveToFile, so that its packed weights
+  // are used by later GetOrPack calls with matching sources. Returns false if
+  // the file can't be mapped or isn't well formed.
+  bool LoadFromFile(const std::string& path);
+
+  // Returns the number of entries of the registry, including those whose
+  // weights are no longer alive and haven't been pruned yet.
+  size_t NumEntriesForTesting();
+
+  // Alignment of the packed weights, in bytes.
+  static constexpr size_t kAlignment = 64;
+
+ private:
+  // (kind, source fingerprint, source size).
+  using Key = std::tuple<std::string, uint64_t, size_t>;
+
+  // The packed weights of a key. Its mutex serializes packing, so that
+  // concurrent interpreters don't pack the same weights twice.
+  struct Packed {
+    std::mutex mutex;
+    std::weak_ptr<const void> data;
+    size_t size = 0;
+  };
+  struct Mapped {
+    std::shared_ptr<MMAPAllocation> file;
+    const void* data;
+    size_t size;
+  };
+
+  // Erases the entries whose weights are no longer alive and that no thread
+  // is packing. Requires `mutex_`.
+  void PruneExpired();
+
+  std::mutex mutex_;
+  std::map<Key, std::shared_ptr<Packed>> packed_;
+  // Number of entries above which expired entries are pruned.
+  size_t prune_threshold_ = kMinPruneThreshold;
+  // Packed weights from mapped files.
+  std::map<Key, Mapped> mapped_;
+
+  static constexpr size_t kMinPruneThreshold = 64;
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_KERNELS_PACKED_WEIGHTS_REGISTRY_H_
@@ -0,0 +1,179 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/kernels/packed_weights_registry.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace tflite {
+namespace {
+
+// Packs by reversing the source bytes, counting the calls in `num_packs`.
+std::shared_ptr<const void> GetOrPack(PackedWeightsRegistry& registry,
+                                      const std::vector<char>& source,
+                                      int* num_packs) {
+  return registry.GetOrPack(
+      "reverse", source.data(), source.size(), source.size(),
+      [&](void* packed) {
+        ++*num_packs;
+        std::copy(source.rbegin(), source.rend(), static_cast<char*>(packed));
+      });
+}
+
+TEST(PackedWeightsRegistryTest, SharesWeightsPackedFromSameSource) {
+  PackedWeightsRegistry registry;
+  const std::vector<char> source = {1, 2, 3, 4};
+  int num_packs = 0;
+  std::shared_ptr<const void> packed = GetOrPack(registry, source, &num_packs);
+  EXPECT_EQ(num_packs, 1);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(packed.get()) %
+                PackedWeightsRegistry::kAlignment,
+            0);
+  EXPECT_EQ(std::vector<char>(static_cast<const char*>(packed.get()),
+                              static_cast<const char*>(packed.get()) + 4),
+            std::vector<char>({4, 3, 2, 1}));
+
+  EXPECT_EQ(GetOrPack(registry, source, &num_packs), packed);
+  EXPECT_EQ(num_packs, 1);
+
+  // Weights are found by content, so a copy of the source shares them.
+  const std::vector<char> copy = source;
+  EXPECT_EQ(GetOrPack(registry, copy, &num_packs), packed);
+  EXPECT_EQ(num_packs, 1);
+
+  // Weights are freed when no longer used, and packed again when needed.
+  packed.reset();
+  packed = GetOrPack(registry, source, &num_packs);
+  EXPECT_EQ(num_packs, 2);
+}
+
+TEST(PackedWeightsRegistryTest, PacksSourcesWithOtherContent) {
+  PackedWeightsRegistry registry;
+  std::vector<char> source = {1, 2, 3, 4};
+  int num_packs = 0;
+  std::shared_ptr<const void> packed = GetOrPack(registry, source, &num_packs);
+  // The same buffer with new content must not get the old weights.
+  source[0] = 5;
+  std::shared_ptr<const void> repacked =
+      GetOrPack(registry, source, &num_packs);
+  EXPECT_EQ(num_packs, 2);
+  EXPECT_NE(repacked, packed);
+  EXPECT_EQ(memcmp(repacked.get(), "\4\3\2\5", 4), 0);
+}
+
+TEST(PackedWeightsRegistryTest, PrunesExpiredEntries) {
+  PackedWeightsRegistry registry;
+  int num_packs = 0;
+  const std::vector<char> kept = {0, 0, 0, 0};
+  std::shared_ptr<const void> packed = GetOrPack(registry, kept, &num_packs);
+  for (int i = 1; i <= 1000; ++i) {
+    const std::vector<char> source = {static_cast<char>(i),
+                                      static_cast<char>(i >> 8), 0, 0};
+    GetOrPack(registry, source, &num_packs);
+  }
+  EXPECT_EQ(num_packs, 1001);
+  // Only the entries created since the last pruning are left, and the weights
+  // still in use are kept.
+  EXPECT_LT(registry.NumEntriesForTesting(), 200);
+  EXPECT_EQ(GetOrPack(registry, kept, &num_packs), packed);
+  EXPECT_EQ(num_packs, 1001);
+}
+
+TEST(PackedWeightsRegistryTest, PacksWithoutHoldingTheRegistryLock) {
+  PackedWeightsRegistry registry;
+  const std::vector<char> outer = {1, 2};
+  const std::vector<char> inner = {3, 4};
+  int num_packs = 0;
+  std::shared_ptr<const void> inner_packed;
+  // Packing can use the registry for other weights without deadlocking.
+  std::shared_ptr<const void> outer_packed = registry.GetOrPack(
+      "reverse", outer.data(), outer.size(), outer.size(), [&](void* packed) {
+        inner_packed = GetOrPack(registry, inner, &num_packs);
+        std::copy(outer.rbegin(), outer.rend(), static_cast<char*>(packed));
+      });
+  EXPECT_EQ(num_packs, 1);
+  EXPECT_EQ(memcmp(outer_packed.get(), "\2\1", 2), 0);
+  EXPECT_EQ(memcmp(inner_packed.get(), "\4\3", 2), 0);
+}
+
+TEST(PackedWeightsRegistryTest, ConcurrentInterpretersPackOnce) {
+  PackedWeightsRegistry registry;
+  const std::vector<char> source(1 << 20, 7);
+  std::atomic<int> num_packs{0};
+  std::vector<std::shared_ptr<const void>> packed(8);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < packed.size(); ++i) {
+    threads.emplace_back([&, i]() {
+      packed[i] = registry.GetOrPack(
+          "copy", source.data(), source.size(), source.size(),
+          [&](void* data) {
+            ++num_packs;
+            memcpy(data, source.data(), source.size());
+          });
+    });
+  }
+  for (std::thread& thread : threads) thread.join();
+  EXPECT_EQ(num_packs, 1);
+  for (const auto& data : packed) EXPECT_EQ(data, packed[0]);
+}
+
+TEST(PackedWeightsRegistryTest, LoadsSavedWeights) {
+  const std::string path =
+      ::testing::TempDir() + "/packed_weights_registry_test.bin";
+  const std::vector<char> source = {1, 2, 3, 4, 5};
+  int num_packs = 0;
+  {
+    PackedWeightsRegistry registry;
+    std::shared_ptr<const void> packed =
+        GetOrPack(registry, source, &num_packs);
+    ASSERT_TRUE(registry.SaveToFile(path));
+  }
+
+  PackedWeightsRegistry registry;
+  ASSERT_TRUE(registry.LoadFromFile(path));
+  // Weights are found by content, not by source buffer.
+  const std::vector<char> copy = source;
+  std::shared_ptr<const void> packed = GetOrPack(registry, copy, &num_packs);
+  EXPECT_EQ(num_packs, 1);
+  EXPECT_EQ(memcmp(packed.get(), "\5\4\3\2\1", 5), 0);
+
+  const std::vector<char> other = {1, 2, 3, 4, 6};
+  GetOrPack(registry, other, &num_packs);
+  EXPECT_EQ(num_packs, 2);
+}
+
+TEST(PackedWeightsRegistryTest, RejectsMalformedFiles) {
+  const std::string path =
+      ::testing::TempDir() + "/packed_weights_registry_bad.bin";
+  FILE* file = fopen(path.c_str(), "wb");
+  ASSERT_NE(file, nullptr);
+  fputs("not packed weights", file);
+  fclose(file);
+  PackedWeightsRegistry registry;
+  EXPECT_FALSE(registry.LoadFromFile(path));
+  EXPECT_FALSE(registry.LoadFromFile(path + ".missing"));
+}
+
+}  // namespace
+}  // namespace tflite
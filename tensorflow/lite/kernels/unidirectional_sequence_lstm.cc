@@ -48,6 +48,10 @@ struct OpData {
   bool recurrent_to_cell_is_diag = false;
   bool recurrent_to_output_is_diag = false;
 
+  // Index of the input projections in node->temporaries, or -1 if the
+  // sequence is evaluated step by step.
+  int input_projections_index = -1;
+
   lstm_eval::IntegerLstmParameter integer_lstm_param;
 };
 
@@ -404,7 +408,8 @@ enum TemporaryTensor {
   kInputZeroPoints = 9,
   kOutputStateZeroPoints = 10,
   kRowSums = 11,
-  kNumTemporaryTensors = 12,
+  kInputProjections = 12,
+  kNumTemporaryTensors = 13,
 };
 
 void* Init(TfLiteContext* context, const char* buffer, size_t length) {
@@ -918,6 +923,7 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
       reinterpret_cast<TfLiteUnidirectionalSequenceLSTMParams*>(
           node->builtin_data);
   const bool time_major = params->time_major;
+  const int max_time = time_major ? input->dims->data[0] : input->dims->data[1];
   const int n_batch = time_major ? input->dims->data[1] : input->dims->data[0];
   const int n_input = input->dims->data[2];
 
@@ -984,14 +990,25 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
     TF_LITE_ENSURE(context, num_intermediate_tensors == 5);
   }
 
-  TfLiteIntArrayFree(node->temporaries);
+  // Compute the input part of the gates for the whole sequence at once, with
+  // one matrix multiplication per gate instead of one per time step. Inputs
+  // related temporaries then hold all the rows of the sequence.
+  const bool use_input_projections = max_time > 1;
+  const int n_input_rows = use_input_projections ? max_time * n_batch : n_batch;
+
+  int num_temporaries;
   if (IsHybridOp(input, input_to_output_weights)) {
-    node->temporaries = TfLiteIntArrayCreate(kNumTemporaryTensors);
+    num_temporaries = kInputProjections;
   } else if (is_integer) {
-    node->temporaries = TfLiteIntArrayCreate(6);
+    num_temporaries = 6;
   } else {
-    node->temporaries = TfLiteIntArrayCreate(1);
+    num_temporaries = 1;
   }
+  op_data->input_projections_index =
+      use_input_projections ? num_temporaries : -1;
+  TfLiteIntArrayFree(node->temporaries);
+  node->temporaries =
+      TfLiteIntArrayCreate(num_temporaries + (use_input_projections ? 1 : 0));
   node->temporaries->data[kScratchBuffer] =
       scratch_tensor_index + kScratchBuffer;
 
@@ -1081,9 +1098,10 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
     input_sf->type = kTfLiteFloat32;
     input_sf->allocation_type = kTfLiteArenaRw;
     int scaling_dims[1] = {n_batch};
-    if (!TfLiteIntArrayEqualsArray(input_sf->dims, 1, scaling_dims)) {
+    int input_scaling_dims[1] = {n_input_rows};
+    if (!TfLiteIntArrayEqualsArray(input_sf->dims, 1, input_scaling_dims)) {
       TfLiteIntArray* input_sf_size = TfLiteIntArrayCreate(1);
-      input_sf_size->data[0] = n_batch;
+      input_sf_size->data[0] = n_input_rows;
       TF_LITE_ENSURE_OK(
           context, context->ResizeTensor(context, input_sf, input_sf_size));
     }
@@ -1110,9 +1128,9 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
     prod_scaling_factors->type = kTfLiteFloat32;
     prod_scaling_factors->allocation_type = kTfLiteArenaRw;
     if (!TfLiteIntArrayEqualsArray(prod_scaling_factors->dims, 1,
-                                   scaling_dims)) {
+                                   input_scaling_dims)) {
       TfLiteIntArray* prod_scaling_factors_size = TfLiteIntArrayCreate(1);
-      prod_scaling_factors_size->data[0] = n_batch;
+      prod_scaling_factors_size->data[0] = n_input_rows;
       TF_LITE_ENSURE_OK(context,
                         context->ResizeTensor(context, prod_scaling_factors,
                                               prod_scaling_factors_size));
@@ -1146,12 +1164,12 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
                                                 &accum_scratch));
     accum_scratch->type = kTfLiteInt32;
     accum_scratch->allocation_type = kTfLiteArenaRw;
-    int accum_scratch_dims[2] = {n_cell, n_batch};
+    int accum_scratch_dims[2] = {n_cell, n_input_rows};
     if (!TfLiteIntArrayEqualsArray(accum_scratch->dims, 2,
                                    accum_scratch_dims)) {
       TfLiteIntArray* accum_size = TfLiteIntArrayCreate(2);
       accum_size->data[0] = n_cell;
-      accum_size->data[1] = n_batch;
+      accum_size->data[1] = n_input_rows;
       TF_LITE_ENSURE_OK(
           context, context->ResizeTensor(context, accum_scratch, accum_size));
     }
@@ -1162,9 +1180,9 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
         context, GetTemporarySafe(context, node, kInputZeroPoints, &input_zp));
     input_zp->type = kTfLiteFloat32;
     input_zp->allocation_type = kTfLiteArenaRw;
-    if (!TfLiteIntArrayEqualsArray(input_zp->dims, 1, scaling_dims)) {
+    if (!TfLiteIntArrayEqualsArray(input_zp->dims, 1, input_scaling_dims)) {
       TfLiteIntArray* input_zp_size = TfLiteIntArrayCreate(1);
-      input_zp_size->data[0] = n_batch;
+      input_zp_size->data[0] = n_input_rows;
       TF_LITE_ENSURE_OK(
           context, context->ResizeTensor(context, input_zp, input_zp_size));
     }
@@ -1213,7 +1231,8 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
                                       &op_data->integer_lstm_param);
     // Allocate scratch buffer. Need 6 16bit buffer with size n_batch * n_cell
     // and 1 8bit buffer with size n_batch * n_cell. We also need 1 32 bit
-    // buffer with size n_batch * n_cell.
+    // buffer with size n_batch * n_cell, or n_input_rows * n_cell for the
+    // input projections.
     //
     // Handle cifg case as well, which might save one buffer.
     for (int scratch_index = 0; scratch_index < 6; ++scratch_index) {
@@ -1231,12 +1250,13 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
       }
 
       scratch_tensor->allocation_type = kTfLiteArenaRw;
-      const int scratch_dimension[2] = {n_batch, n_cell};
+      const int scratch_dimension[2] = {
+          scratch_index == 5 ? n_input_rows : n_batch, n_cell};
       if (!TfLiteIntArrayEqualsArray(scratch_tensor->dims, 2,
                                      scratch_dimension)) {
         TfLiteIntArray* scratch_buffer_size = TfLiteIntArrayCreate(2);
-        scratch_buffer_size->data[0] = n_batch;
-        scratch_buffer_size->data[1] = n_cell;
+        scratch_buffer_size->data[0] = scratch_dimension[0];
+        scratch_buffer_size->data[1] = scratch_dimension[1];
         TF_LITE_ENSURE_OK(context,
                           context->ResizeTensor(context, scratch_tensor,
                                                 scratch_buffer_size));
@@ -1248,6 +1268,32 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
                                    context, op_data, node));
   }
 
+  if (use_input_projections) {
+    // Allocate a temporary tensor to store the input projections of all the
+    // gates, in the gate type.
+    node->temporaries->data[op_data->input_projections_index] =
+        scratch_tensor_index + kInputProjections;
+    TfLiteTensor* input_projections;
+    TF_LITE_ENSURE_OK(context,
+                      GetTemporarySafe(context, node,
+                                       op_data->input_projections_index,
+                                       &input_projections));
+    input_projections->type = is_integer ? kTfLiteInt16 : kTfLiteFloat32;
+    input_projections->allocation_type = kTfLiteArenaRw;
+    const int input_projections_dims[3] = {use_cifg ? 3 : 4, n_input_rows,
+                                           n_cell};
+    if (!TfLiteIntArrayEqualsArray(input_projections->dims, 3,
+                                   input_projections_dims)) {
+      TfLiteIntArray* input_projections_size = TfLiteIntArrayCreate(3);
+      input_projections_size->data[0] = input_projections_dims[0];
+      input_projections_size->data[1] = input_projections_dims[1];
+      input_projections_size->data[2] = input_projections_dims[2];
+      TF_LITE_ENSURE_OK(context,
+                        context->ResizeTensor(context, input_projections,
+                                              input_projections_size));
+    }
+  }
+
   return kTfLiteOk;
 }
 
@@ -1360,6 +1406,14 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
   lstm_params.proj_clip = params->proj_clip;
   lstm_params.asymmetric_quantize_inputs = params->asymmetric_quantize_inputs;
 
+  TfLiteTensor* input_projections = nullptr;
+  if (op_data->input_projections_index >= 0) {
+    TF_LITE_ENSURE_OK(context,
+                      GetTemporarySafe(context, node,
+                                       op_data->input_projections_index,
+                                       &input_projections));
+  }
+
   switch (input_to_output_weights->type) {
     case kTfLiteFloat32: {
       // Index the scratch buffers pointers to the global scratch buffer.
@@ -1392,7 +1446,7 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
           (recurrent_to_cell_weights->dims->size == 1),
           /*recurrent_to_output_is_diag=*/
           (recurrent_to_output_weights->dims->size == 1),
-          CpuBackendContext::GetFromContext(context));
+          CpuBackendContext::GetFromContext(context), input_projections);
     }
     case kTfLiteUInt8:
     case kTfLiteInt8: {
@@ -1459,7 +1513,7 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
             (recurrent_to_cell_weights->dims->size == 1),
             /*recurrent_to_output_is_diag=*/
             (recurrent_to_output_weights->dims->size == 1),
-            CpuBackendContext::GetFromContext(context));
+            CpuBackendContext::GetFromContext(context), input_projections);
       } else {
         TfLiteTensor* scratch0;
         TF_LITE_ENSURE_OK(context,
@@ -1492,7 +1546,7 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
             projection_bias, &lstm_params, /*forward_sequence=*/true,
             time_major, &op_data->integer_lstm_param, output_state, cell_state,
             output, scratch0, scratch1, scratch2, scratch3, scratch4, scratch5,
-            CpuBackendContext::GetFromContext(context));
+            CpuBackendContext::GetFromContext(context), input_projections);
       }
     }
     default:
@@ -0,0 +1,176 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/kernels/work_stealing_thread_pool.h"
+
+#if defined(__linux__) || defined(__ANDROID__)
+#include <sched.h>
+#endif
+
+#include <chrono>  // NOLINT(build/c++11)
+#include <functional>
+#include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+#include <thread>  // NOLINT(build/c++11)
+#include <utility>
+#include <vector>
+
+namespace tflite {
+namespace {
+
+// How long an idle worker keeps looking for tasks before blocking.
+constexpr std::chrono::microseconds kSpinDuration(200);
+
+// The pool and index of the worker running on this thread, if any.
+thread_local const WorkStealingThreadPool* current_pool = nullptr;
+thread_local int current_worker_index = -1;
+
+void PinCurrentThread(const std::vector<int>& cpus) {
+#if defined(__linux__) || defined(__ANDROID__)
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  for (int cpu : cpus) {
+    if (cpu >= 0 && cpu < CPU_SETSIZE) CPU_SET(cpu, &cpu_set);
+  }
+  // Pinning is only a hint, so a failure, e.g. for an offline CPU, is ignored.
+  sched_setaffinity(0, sizeof(cpu_set), &cpu_set);
+#endif
+}
+
+}  // namespace
+
+WorkStealingThreadPool::WorkStealingThreadPool(int num_threads,
+                                               const std::vector<int>& cpus) {
+  workers_.reserve(num_threads);
+  for (int i = 0; i < num_threads; ++i) {
+    workers_.push_back(std::make_unique<Worker>());
+  }
+  // The workers steal from each other, so all must exist before any starts.
+  for (int i = 0; i < num_threads; ++i) {
+    workers_[i]->thread =
+        std::thread([this, i, cpus]() { WorkerLoop(i, cpus); });
+  }
+}
+
+WorkStealingThreadPool::~WorkStealingThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(wake_mutex_);
+    stopping_ = true;
+  }
+  wake_.notify_all();
+  for (auto& worker : workers_) worker->thread.join();
+}
+
+int WorkStealingThreadPool::CurrentThreadId() const {
+  return current_pool == this ? current_worker_index : -1;
+}
+
+void WorkStealingThreadPool::Schedule(std::function<void()> task) {
+  int index = CurrentThreadId();
+  if (index < 0) index = next_queue_++ % workers_.size();
+  Worker& worker = *workers_[index];
+  {
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    worker.tasks.push_back(std::move(task));
+    ++num_pending_tasks_;
+  }
+  // Taking the lock orders the new task before the wait of an idle worker.
+  { std::lock_guard<std::mutex> lock(wake_mutex_); }
+  wake_.notify_one();
+}
+
+void WorkStealingThreadPool::ParallelFor(int count,
+                                         const std::function<void(int)>& fn) {
+  if (count <= 0) return;
+  if (count == 1 || workers_.empty()) {
+    for (int i = 0; i < count; ++i) fn(i);
+    return;
+  }
+  // Shared with the tasks, which may still hold it once ParallelFor returns.
+  struct State {
+    std::mutex mutex;
+    std::condition_variable done;
+    int num_remaining;
+  };
+  auto state = std::make_shared<State>();
+  state->num_remaining = count - 1;
+  for (int i = 1; i < count; ++i) {
+    Schedule([state, &fn, i]() {
+      fn(i);
+      std::lock_guard<std::mutex> lock(state->mutex);
+      if (--state->num_remaining == 0) state->done.notify_all();
+    });
+  }
+  fn(0);
+
+  const int index = CurrentThreadId();
+  while (true) {
+    {
+      std::lock_guard<std::mutex> lock(state->mutex);
+      if (state->num_remaining == 0) return;
+    }
+    if (!TryRunTask(index)) break;
+  }
+  // The remaining calls are running on workers.
+  std::unique_lock<std::mutex> lock(state->mutex);
+  state->done.wait(lock, [&state]() { return state->num_remaining == 0; });
+}
+
+void WorkStealingThreadPool::WorkerLoop(int index,
+                                        const std::vector<int>& cpus) {
+  current_pool = this;
+  current_worker_index = index;
+  if (!cpus.empty()) PinCurrentThread(cpus);
+  while (true) {
+    if (TryRunTask(index)) continue;
+
+    const auto spin_end = std::chrono::steady_clock::now() + kSpinDuration;
+    while (num_pending_tasks_ == 0 &&
+           std::chrono::steady_clock::now() < spin_end) {
+      std::this_thread::yield();
+    }
+    if (num_pending_tasks_ > 0) continue;
+
+    std::unique_lock<std::mutex> lock(wake_mutex_);
+    wake_.wait(lock,
+               [this]() { return stopping_ || num_pending_tasks_ > 0; });
+    if (stopping_ && num_pending_tasks_ == 0) return;
+  }
+}
+
+bool WorkStealingThreadPool::TryRunTask(int index) {
+  const int num_workers = workers_.size();
+  std::function<void()> task;
+  // Looks at the own queue first, then at the next ones.
+  const int first = index < 0 ? next_queue_ % num_workers : index;
+  for (int i = 0; i < num_workers && !task; ++i) {
+    const int victim = (first + i) % num_workers;
+    Worker& worker = *workers_[victim];
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    if (worker.tasks.empty()) continue;
+    if (victim == index) {
+      task = std::move(worker.tasks.back());
+      worker.tasks.pop_back();
+    } else {
+      task = std::move(worker.tasks.front());
+      worker.tasks.pop_front();
+    }
+    --num_pending_tasks_;
+  }
+  if (!task) return false;
+  task();
+  return true;
+}
+
+}  // namespace tflite
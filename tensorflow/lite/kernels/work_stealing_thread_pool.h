@@ -0,0 +1,95 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_KERNELS_WORK_STEALING_THREAD_POOL_H_
+#define TENSORFLOW_LITE_KERNELS_WORK_STEALING_THREAD_POOL_H_
+
+#include <atomic>
+#include <condition_variable>  // NOLINT(build/c++11)
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+namespace tflite {
+
+// A thread pool in which each worker has its own task queue. A worker runs the
+// tasks it schedules itself last-in first-out, which keeps their data in its
+// caches, and steals the oldest tasks of the other workers when it has none.
+// Idle workers keep spinning for a short while before blocking, so that the
+// parallel sections of consecutive ops find them awake.
+//
+// This is the pool shared by the TFLite kernels parallelized with
+// cpu_backend_threadpool::Execute and the Eigen device of eigen_support; see
+// CpuBackendContext::GetThreadPool.
+class WorkStealingThreadPool {
+ public:
+  // Starts `num_threads` workers. If `cpus` isn't empty, the workers are
+  // pinned to these CPUs, e.g. the big cores of a big.LITTLE CPU. Pinning is
+  // only supported on Linux and Android, and ignored elsewhere.
+  explicit WorkStealingThreadPool(int num_threads,
+                                  const std::vector<int>& cpus = {});
+
+  // Runs the scheduled tasks that are left, then joins the workers.
+  ~WorkStealingThreadPool();
+
+  int NumThreads() const { return workers_.size(); }
+
+  // Returns the index of the calling worker, or -1 if it isn't one of this
+  // pool's workers.
+  int CurrentThreadId() const;
+
+  // Runs `task` on one of the workers. A task scheduled by a worker goes to
+  // its own queue.
+  void Schedule(std::function<void()> task);
+
+  // Calls `fn` with every index in [0, count) and returns once all calls are
+  // done. The calling thread makes the first call and then helps running the
+  // pending tasks of the pool.
+  void ParallelFor(int count, const std::function<void(int)>& fn);
+
+  WorkStealingThreadPool(const WorkStealingThreadPool&) = delete;
+  WorkStealingThreadPool& operator=(const WorkStealingThreadPool&) = delete;
+
+ private:
+  struct Worker {
+    std::mutex mutex;
+    std::deque<std::function<void()>> tasks;
+    std::thread thread;
+  };
+
+  void WorkerLoop(int index, const std::vector<int>& cpus);
+
+  // Runs one pending task, taken from the back of the queue of worker `index`
+  // if it is one, or else from the front of another queue. Returns false if
+  // there was none.
+  bool TryRunTask(int index);
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+  // Number of tasks in the queues.
+  std::atomic<int> num_pending_tasks_{0};
+  // Queue that the next task scheduled from outside the pool goes to.
+  std::atomic<unsigned int> next_queue_{0};
+
+  // Guards the waits of the idle workers.
+  std::mutex wake_mutex_;
+  std::condition_variable wake_;
+  bool stopping_ = false;
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_KERNELS_WORK_STEALING_THREAD_POOL_H_
@@ -0,0 +1,73 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/kernels/work_stealing_thread_pool.h"
+
+#include <atomic>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace tflite {
+namespace {
+
+TEST(WorkStealingThreadPoolTest, ParallelForCallsEveryIndexOnce) {
+  WorkStealingThreadPool pool(3);
+  EXPECT_EQ(pool.NumThreads(), 3);
+  std::vector<std::atomic<int>> calls(1000);
+  pool.ParallelFor(calls.size(), [&calls](int i) { ++calls[i]; });
+  for (const auto& count : calls) EXPECT_EQ(count, 1);
+}
+
+TEST(WorkStealingThreadPoolTest, NestedParallelFor) {
+  WorkStealingThreadPool pool(2);
+  std::atomic<int> sum(0);
+  pool.ParallelFor(8, [&pool, &sum](int i) {
+    pool.ParallelFor(8, [&sum, i](int j) { sum += i * 8 + j; });
+  });
+  EXPECT_EQ(sum, 64 * 63 / 2);
+}
+
+TEST(WorkStealingThreadPoolTest, CurrentThreadId) {
+  WorkStealingThreadPool pool(2);
+  EXPECT_EQ(pool.CurrentThreadId(), -1);
+  std::vector<int> ids(64, -2);
+  pool.ParallelFor(ids.size(),
+                   [&pool, &ids](int i) { ids[i] = pool.CurrentThreadId(); });
+  // The first call runs on the calling thread.
+  EXPECT_EQ(ids[0], -1);
+  for (int id : ids) {
+    EXPECT_GE(id, -1);
+    EXPECT_LT(id, 2);
+  }
+}
+
+TEST(WorkStealingThreadPoolTest, DestructorRunsScheduledTasks) {
+  std::atomic<int> count(0);
+  {
+    WorkStealingThreadPool pool(2);
+    for (int i = 0; i < 100; ++i) pool.Schedule([&count]() { ++count; });
+  }
+  EXPECT_EQ(count, 100);
+}
+
+TEST(WorkStealingThreadPoolTest, PinnedWorkers) {
+  WorkStealingThreadPool pool(2, /*cpus=*/{0});
+  std::atomic<int> count(0);
+  pool.ParallelFor(10, [&count](int i) { ++count; });
+  EXPECT_EQ(count, 10);
+}
+
+}  // namespace
+}  // namespace tflite
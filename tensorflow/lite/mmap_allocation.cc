@@ -19,7 +19,9 @@ limitations under the License.
 #include <sys/stat.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <cerrno>
+#include <cstdint>
 
 #include "tensorflow/lite/allocation.h"
 #include "tensorflow/lite/core/api/error_reporter.h"
@@ -131,4 +133,18 @@ bool MMAPAllocation::valid() const { return mmapped_buffer_ != MAP_FAILED; }
 
 bool MMAPAllocation::IsSupported() { return true; }
 
+void MMAPAllocation::Prefetch(const void* data, size_t bytes) const {
+  if (!valid() || bytes == 0) return;
+  const uintptr_t begin = reinterpret_cast<uintptr_t>(mmapped_buffer_);
+  const uintptr_t end = begin + mmapped_buffer_size();
+  uintptr_t start = reinterpret_cast<uintptr_t>(data);
+  if (start < begin || start >= end) return;
+  const uintptr_t stop = std::min<uintptr_t>(start + bytes, end);
+  // madvise requires a page aligned start address. mmapped_buffer_ is page
+  // aligned so rounding down never leaves the mapping.
+  static const uintptr_t page_size = sysconf(_SC_PAGESIZE);
+  start = begin + (start - begin) / page_size * page_size;
+  madvise(reinterpret_cast<void*>(start), stop - start, MADV_WILLNEED);
+}
+
 }  // namespace tflite
@@ -47,4 +47,6 @@ bool MMAPAllocation::valid() const { return false; }
 
 bool MMAPAllocation::IsSupported() { return false; }
 
+void MMAPAllocation::Prefetch(const void* data, size_t bytes) const {}
+
 }  // namespace tflite
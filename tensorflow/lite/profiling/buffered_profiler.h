@@ -116,6 +116,11 @@ class BufferedProfiler : public tflite::Profiler {
                      event_metadata2);
   }
 
+  // Also records the memory usage around each operator invocation, see
+  // ProfileBuffer::SetRecordOpMemoryUsage.
+  void SetRecordOpMemoryUsage(bool record) {
+    buffer_.SetRecordOpMemoryUsage(record);
+  }
   void StartProfiling() { buffer_.SetEnabled(true); }
   void StopProfiling() { buffer_.SetEnabled(false); }
   void Reset() { buffer_.Reset(); }
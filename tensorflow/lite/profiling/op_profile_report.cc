@@ -0,0 +1,281 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/profiling/op_profile_report.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/profiling/memory_info.h"
+
+namespace tflite {
+namespace profiling {
+namespace {
+
+std::string GetNodeName(const Subgraph& subgraph, const TfLiteNode& node,
+                        int node_index) {
+  std::string name = "[";
+  for (int i = 0; i < node.outputs->size; ++i) {
+    const TfLiteTensor* tensor = subgraph.tensor(node.outputs->data[i]);
+    if (i > 0) name += ", ";
+    name += (tensor == nullptr || tensor->name == nullptr) ? "Unknown"
+                                                           : tensor->name;
+  }
+  // The node index distinguishes nodes w/ the same outputs names.
+  return name + "]:" + std::to_string(node_index);
+}
+
+// Adds the size of the tensors of `tensor_indices` to `arena_bytes` or
+// `dynamic_bytes` depending on how they are allocated.
+void AddTensorBytes(const Subgraph& subgraph,
+                    const TfLiteIntArray* tensor_indices, int64_t* arena_bytes,
+                    int64_t* dynamic_bytes) {
+  if (tensor_indices == nullptr) return;
+  for (int i = 0; i < tensor_indices->size; ++i) {
+    if (tensor_indices->data[i] == kTfLiteOptionalTensor) continue;
+    const TfLiteTensor* tensor = subgraph.tensor(tensor_indices->data[i]);
+    if (tensor == nullptr) continue;
+    switch (tensor->allocation_type) {
+      case kTfLiteArenaRw:
+      case kTfLiteArenaRwPersistent:
+        *arena_bytes += tensor->bytes;
+        break;
+      case kTfLiteDynamic:
+        *dynamic_bytes += tensor->bytes;
+        break;
+      default:
+        break;
+    }
+  }
+}
+
+int64_t GetHeapGrowth(const ProfileEvent& event) {
+  const size_t begin = event.begin_mem_usage.in_use_allocated_bytes;
+  const size_t end = event.end_mem_usage.in_use_allocated_bytes;
+  if (begin == memory::MemoryUsage::kValueNotSet ||
+      end == memory::MemoryUsage::kValueNotSet || end <= begin) {
+    return 0;
+  }
+  return static_cast<int64_t>(end - begin);
+}
+
+std::string EscapeCsv(const std::string& value) {
+  std::string escaped = "\"";
+  for (char c : value) {
+    if (c == '"') escaped += '"';
+    escaped += c;
+  }
+  return escaped + "\"";
+}
+
+std::string EscapeJson(const std::string& value) {
+  std::string escaped = "\"";
+  for (char c : value) {
+    switch (c) {
+      case '"':
+        escaped += "\\\"";
+        break;
+      case '\\':
+        escaped += "\\\\";
+        break;
+      case '\n':
+        escaped += "\\n";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) continue;
+        escaped += c;
+    }
+  }
+  return escaped + "\"";
+}
+
+// Writes the fields of `op` as the members of a JSON object.
+void WriteJsonFields(const OpProfileReport::OpProfile& op,
+                     std::ostream* stream) {
+  *stream << "\"name\": " << EscapeJson(op.name)
+          << ", \"type\": " << EscapeJson(op.type)
+          << ", \"subgraph\": " << op.subgraph_index
+          << ", \"node\": " << op.node_index
+          << ", \"delegated\": " << (op.delegated ? "true" : "false")
+          << ", \"count\": " << op.latency_us.count()
+          << ", \"avg_us\": " << op.latency_us.avg()
+          << ", \"std_dev_us\": " << op.latency_us.std_deviation()
+          << ", \"min_us\": " << op.latency_us.min()
+          << ", \"max_us\": " << op.latency_us.max()
+          << ", \"arena_bytes\": " << op.arena_bytes
+          << ", \"dynamic_bytes\": " << op.dynamic_bytes
+          << ", \"heap_growth_bytes\": " << op.heap_growth_bytes;
+}
+
+bool IsDelegateOpEvent(Profiler::EventType event_type) {
+  return event_type == Profiler::EventType::DELEGATE_OPERATOR_INVOKE_EVENT ||
+         event_type ==
+             Profiler::EventType::DELEGATE_PROFILED_OPERATOR_INVOKE_EVENT;
+}
+
+}  // namespace
+
+bool OpProfileReport::ParseFormat(const std::string& name, Format* format) {
+  if (name == "csv") {
+    *format = Format::kCsv;
+  } else if (name == "json") {
+    *format = Format::kJson;
+  } else if (name == "chrome_trace") {
+    *format = Format::kChromeTrace;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+void OpProfileReport::ProcessProfiles(
+    const std::vector<const ProfileEvent*>& profile_stats,
+    const tflite::Interpreter& interpreter) {
+  if (profile_stats.empty()) return;
+
+  last_run_events_.clear();
+  for (const ProfileEvent* event : profile_stats) {
+    OpProfile* op = nullptr;
+    if (event->event_type == Profiler::EventType::OPERATOR_INVOKE_EVENT) {
+      const int64_t subgraph_index = event->extra_event_metadata;
+      const int64_t node_index = event->event_metadata;
+      if (subgraph_index < 0 ||
+          subgraph_index >= interpreter.subgraphs_size()) {
+        continue;
+      }
+      const Subgraph& subgraph = *const_cast<tflite::Interpreter&>(interpreter)
+                                      .subgraph(subgraph_index);
+      const auto* node_reg = subgraph.node_and_registration(node_index);
+      if (node_reg == nullptr) continue;
+      const TfLiteNode& node = node_reg->first;
+      const std::string name = GetNodeName(subgraph, node, node_index);
+      op = GetOpProfile(std::to_string(subgraph_index) + "/" + name);
+      op->name = name;
+      op->type = event->tag;
+      op->subgraph_index = subgraph_index;
+      op->node_index = node_index;
+      op->delegated = node.delegate != nullptr;
+      // Tensor sizes may change between runs when inputs are resized, keep
+      // the largest ones.
+      int64_t arena_bytes = 0;
+      int64_t dynamic_bytes = 0;
+      AddTensorBytes(subgraph, node.outputs, &arena_bytes, &dynamic_bytes);
+      AddTensorBytes(subgraph, node.temporaries, &arena_bytes, &dynamic_bytes);
+      op->arena_bytes = std::max(op->arena_bytes, arena_bytes);
+      op->dynamic_bytes = std::max(op->dynamic_bytes, dynamic_bytes);
+    } else if (IsDelegateOpEvent(event->event_type)) {
+      const std::string name = "Delegate/" + event->tag + ":" +
+                               std::to_string(event->event_metadata);
+      op = GetOpProfile(name);
+      op->name = name;
+      op->type = event->tag;
+      op->delegated = true;
+    } else {
+      continue;
+    }
+    op->latency_us.UpdateStat(event->elapsed_time);
+    op->heap_growth_bytes =
+        std::max(op->heap_growth_bytes, GetHeapGrowth(*event));
+    // Events added after the fact by delegates have no timestamp.
+    if (event->begin_timestamp_us != 0) {
+      last_run_events_.push_back(
+          {static_cast<size_t>(op - op_profiles_.data()),
+           event->begin_timestamp_us, event->elapsed_time});
+    }
+  }
+  ++num_runs_;
+}
+
+OpProfileReport::OpProfile* OpProfileReport::GetOpProfile(
+    const std::string& name) {
+  auto it = op_profile_indices_.find(name);
+  if (it == op_profile_indices_.end()) {
+    it = op_profile_indices_.emplace(name, op_profiles_.size()).first;
+    op_profiles_.emplace_back();
+  }
+  return &op_profiles_[it->second];
+}
+
+std::string OpProfileReport::GetOutputString(Format format) const {
+  switch (format) {
+    case Format::kCsv:
+      return ToCsv();
+    case Format::kJson:
+      return ToJson();
+    case Format::kChromeTrace:
+      return ToChromeTrace();
+  }
+  return "";
+}
+
+std::string OpProfileReport::ToCsv() const {
+  std::stringstream stream;
+  stream << "subgraph,node,name,type,delegated,count,avg_us,std_dev_us,min_us,"
+            "max_us,arena_bytes,dynamic_bytes,heap_growth_bytes\n";
+  for (const OpProfile& op : op_profiles_) {
+    stream << op.subgraph_index << "," << op.node_index << ","
+           << EscapeCsv(op.name) << "," << EscapeCsv(op.type) << ","
+           << (op.delegated ? 1 : 0) << "," << op.latency_us.count() << ","
+           << op.latency_us.avg() << "," << op.latency_us.std_deviation()
+           << "," << op.latency_us.min() << "," << op.latency_us.max() << ","
+           << op.arena_bytes << "," << op.dynamic_bytes << ","
+           << op.heap_growth_bytes << "\n";
+  }
+  return stream.str();
+}
+
+std::string OpProfileReport::ToJson() const {
+  std::stringstream stream;
+  stream << "{\"num_runs\": " << num_runs_ << ", \"ops\": [";
+  for (size_t i = 0; i < op_profiles_.size(); ++i) {
+    stream << (i == 0 ? "\n  {" : ",\n  {");
+    WriteJsonFields(op_profiles_[i], &stream);
+    stream << "}";
+  }
+  stream << "\n]}\n";
+  return stream.str();
+}
+
+std::string OpProfileReport::ToChromeTrace() const {
+  std::stringstream stream;
+  stream << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+  uint64_t start_us = UINT64_MAX;
+  for (const TraceEvent& event : last_run_events_) {
+    start_us = std::min(start_us, event.begin_us);
+  }
+  for (size_t i = 0; i < last_run_events_.size(); ++i) {
+    const TraceEvent& event = last_run_events_[i];
+    const OpProfile& op = op_profiles_[event.op_profile_index];
+    // Ops executed inside a delegate go on their own track, as they overlap
+    // the delegate kernel that runs them.
+    const int tid = op.node_index < 0 ? 1 : 0;
+    stream << (i == 0 ? "\n  " : ",\n  ") << "{\"name\": "
+           << EscapeJson(op.type) << ", \"cat\": "
+           << (op.delegated ? "\"delegated\"" : "\"cpu\"")
+           << ", \"ph\": \"X\", \"pid\": 0, \"tid\": " << tid
+           << ", \"ts\": " << event.begin_us - start_us
+           << ", \"dur\": " << event.duration_us << ", \"args\": {";
+    WriteJsonFields(op, &stream);
+    stream << "}}";
+  }
+  stream << "\n]}\n";
+  return stream.str();
+}
+
+}  // namespace profiling
+}  // namespace tflite
@@ -0,0 +1,102 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_PROFILING_OP_PROFILE_REPORT_H_
+#define TENSORFLOW_LITE_PROFILING_OP_PROFILE_REPORT_H_
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/util/stats_calculator.h"
+#include "tensorflow/lite/core/interpreter.h"
+#include "tensorflow/lite/profiling/profile_buffer.h"
+
+namespace tflite {
+namespace profiling {
+
+// Aggregates the profile events of several runs into a per-op report that
+// combines the latency statistics of each op with the memory attributed to
+// it:
+//  - arena_bytes: size of the arena allocated outputs and temporaries of the
+//    node.
+//  - dynamic_bytes: largest total size seen for the dynamically allocated
+//    outputs and temporaries of the node.
+//  - heap_growth_bytes: largest growth of the in-use heap allocations seen
+//    across one invocation of the op. For delegate kernels this is the memory
+//    allocated internally by the delegate.
+// Tensor memory is only attributed to ops executed by the interpreter, the
+// ops reported from inside a delegate have no arena or dynamic bytes.
+// heap_growth_bytes requires the profiler to record the memory usage of
+// operator events, see BufferedProfiler::SetRecordOpMemoryUsage.
+class OpProfileReport {
+ public:
+  enum class Format { kCsv, kJson, kChromeTrace };
+
+  struct OpProfile {
+    std::string name;
+    std::string type;
+    // -1 for the ops reported from inside a delegate.
+    int64_t subgraph_index = -1;
+    int64_t node_index = -1;
+    bool delegated = false;
+    tensorflow::Stat<int64_t> latency_us;
+    int64_t arena_bytes = 0;
+    int64_t dynamic_bytes = 0;
+    int64_t heap_growth_bytes = 0;
+  };
+
+  // Parses "csv", "json" or "chrome_trace" into `format`. Returns false if the
+  // name is not recognized.
+  static bool ParseFormat(const std::string& name, Format* format);
+
+  // Processes the profile events of one run.
+  void ProcessProfiles(const std::vector<const ProfileEvent*>& profile_stats,
+                       const tflite::Interpreter& interpreter);
+
+  // Returns the per-op profiles in order of first execution.
+  const std::vector<OpProfile>& op_profiles() const { return op_profiles_; }
+
+  int64_t num_runs() const { return num_runs_; }
+
+  // Returns the report in `format`. The Chrome trace holds the op events of
+  // the last processed run, with the aggregated statistics of each op as its
+  // arguments, and can be loaded in chrome://tracing or Perfetto.
+  std::string GetOutputString(Format format) const;
+
+ private:
+  struct TraceEvent {
+    size_t op_profile_index;
+    uint64_t begin_us;
+    uint64_t duration_us;
+  };
+
+  OpProfile* GetOpProfile(const std::string& name);
+
+  std::string ToCsv() const;
+  std::string ToJson() const;
+  std::string ToChromeTrace() const;
+
+  std::vector<OpProfile> op_profiles_;
+  // Maps the name of an op to its index in op_profiles_.
+  std::map<std::string, size_t> op_profile_indices_;
+  std::vector<TraceEvent> last_run_events_;
+  int64_t num_runs_ = 0;
+};
+
+}  // namespace profiling
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_PROFILING_OP_PROFILE_REPORT_H_
@@ -0,0 +1,149 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/profiling/op_profile_report.h"
+
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/lite/kernels/kernel_util.h"
+#include "tensorflow/lite/kernels/test_util.h"
+#include "tensorflow/lite/profiling/buffered_profiler.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+namespace profiling {
+namespace {
+
+using ::testing::HasSubstr;
+
+const char* kOpName = "SimpleOpEval";
+
+TfLiteStatus SimpleOpEval(TfLiteContext* context, TfLiteNode* node) {
+  const TfLiteTensor* input1;
+  TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, /*index=*/0, &input1));
+  const TfLiteTensor* input2;
+  TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, /*index=*/1, &input2));
+
+  TfLiteTensor* output;
+  TF_LITE_ENSURE_OK(context,
+                    GetOutputSafe(context, node, /*index=*/0, &output));
+
+  int32_t* output_data = output->data.i32;
+  *output_data = *(input1->data.i32) + *(input2->data.i32);
+  return kTfLiteOk;
+}
+
+TfLiteRegistration* RegisterSimpleOp() {
+  static TfLiteRegistration registration = {
+      nullptr,      nullptr, nullptr, SimpleOpEval,
+      nullptr,      tflite::BuiltinOperator_CUSTOM,
+      kOpName,      1};
+  return &registration;
+}
+
+class SimpleOpModel : public SingleOpModel {
+ public:
+  SimpleOpModel() {
+    inputs_[0] = AddInput({TensorType_INT32, {1}});
+    inputs_[1] = AddInput({TensorType_INT32, {1}});
+    AddOutput({TensorType_INT32, {1}});
+    SetCustomOp(kOpName, {}, RegisterSimpleOp);
+    BuildInterpreter({GetShape(inputs_[0]), GetShape(inputs_[1])});
+  }
+  tflite::Interpreter* GetInterpreter() { return interpreter_.get(); }
+  void SetInputs(int32_t x, int32_t y) {
+    PopulateTensor(inputs_[0], {x});
+    PopulateTensor(inputs_[1], {y});
+  }
+
+ private:
+  int inputs_[2];
+};
+
+// Runs the model `num_runs` times and adds the profiles of each run to
+// `report`.
+void ProfileRuns(SimpleOpModel* model, int num_runs, OpProfileReport* report) {
+  BufferedProfiler profiler(1024);
+  profiler.SetRecordOpMemoryUsage(true);
+  model->GetInterpreter()->SetProfiler(&profiler);
+  model->SetInputs(1, 2);
+  for (int i = 0; i < num_runs; ++i) {
+    profiler.Reset();
+    profiler.StartProfiling();
+    ASSERT_EQ(model->Invoke(), kTfLiteOk);
+    profiler.StopProfiling();
+    report->ProcessProfiles(profiler.GetProfileEvents(),
+                            *model->GetInterpreter());
+  }
+  model->GetInterpreter()->SetProfiler(nullptr);
+}
+
+TEST(OpProfileReportTest, ParseFormat) {
+  OpProfileReport::Format format;
+  ASSERT_TRUE(OpProfileReport::ParseFormat("csv", &format));
+  EXPECT_EQ(format, OpProfileReport::Format::kCsv);
+  ASSERT_TRUE(OpProfileReport::ParseFormat("json", &format));
+  EXPECT_EQ(format, OpProfileReport::Format::kJson);
+  ASSERT_TRUE(OpProfileReport::ParseFormat("chrome_trace", &format));
+  EXPECT_EQ(format, OpProfileReport::Format::kChromeTrace);
+  EXPECT_FALSE(OpProfileReport::ParseFormat("xml", &format));
+}
+
+TEST(OpProfileReportTest, AggregatesRuns) {
+  SimpleOpModel m;
+  OpProfileReport report;
+  ProfileRuns(&m, /*num_runs=*/3, &report);
+
+  EXPECT_EQ(report.num_runs(), 3);
+  ASSERT_EQ(report.op_profiles().size(), 1);
+  const OpProfileReport::OpProfile& op = report.op_profiles()[0];
+  EXPECT_EQ(op.type, kOpName);
+  EXPECT_EQ(op.subgraph_index, 0);
+  EXPECT_EQ(op.node_index, 0);
+  EXPECT_FALSE(op.delegated);
+  EXPECT_EQ(op.latency_us.count(), 3);
+  // The int32 output is allocated in the arena.
+  EXPECT_EQ(op.arena_bytes, static_cast<int64_t>(sizeof(int32_t)));
+  EXPECT_EQ(op.dynamic_bytes, 0);
+}
+
+TEST(OpProfileReportTest, OutputFormats) {
+  SimpleOpModel m;
+  OpProfileReport report;
+  ProfileRuns(&m, /*num_runs=*/2, &report);
+
+  const std::string csv =
+      report.GetOutputString(OpProfileReport::Format::kCsv);
+  EXPECT_THAT(csv, HasSubstr("subgraph,node,name,type,delegated,count"));
+  EXPECT_THAT(csv, HasSubstr("\"SimpleOpEval\",0,2,"));
+
+  const std::string json =
+      report.GetOutputString(OpProfileReport::Format::kJson);
+  EXPECT_THAT(json, HasSubstr("\"num_runs\": 2"));
+  EXPECT_THAT(json, HasSubstr("\"type\": \"SimpleOpEval\""));
+  EXPECT_THAT(json, HasSubstr("\"arena_bytes\": 4"));
+
+  const std::string trace =
+      report.GetOutputString(OpProfileReport::Format::kChromeTrace);
+  EXPECT_THAT(trace, HasSubstr("\"traceEvents\""));
+  EXPECT_THAT(trace, HasSubstr("\"name\": \"SimpleOpEval\""));
+  EXPECT_THAT(trace, HasSubstr("\"ph\": \"X\""));
+}
+
+}  // namespace
+}  // namespace profiling
+}  // namespace tflite
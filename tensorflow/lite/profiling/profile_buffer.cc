@@ -40,8 +40,12 @@ uint32_t ProfileBuffer::BeginEvent(const char* tag,
   event_buffer_[index].extra_event_metadata = event_metadata2;
   event_buffer_[index].begin_timestamp_us = timestamp;
   event_buffer_[index].elapsed_time = 0;
-  if (event_type != Profiler::EventType::OPERATOR_INVOKE_EVENT) {
+  if (ShouldRecordMemoryUsage(event_type)) {
     event_buffer_[index].begin_mem_usage = memory::GetMemoryUsage();
+  } else {
+    // Clears the values left by a previous event of the entry.
+    event_buffer_[index].begin_mem_usage = memory::MemoryUsage();
+    event_buffer_[index].end_mem_usage = memory::MemoryUsage();
   }
   current_index_++;
   return index;
@@ -63,8 +67,7 @@ void ProfileBuffer::EndEvent(uint32_t event_handle,
   int event_index = event_handle % max_size;
   event_buffer_[event_index].elapsed_time =
       time::NowMicros() - event_buffer_[event_index].begin_timestamp_us;
-  if (event_buffer_[event_index].event_type !=
-      Profiler::EventType::OPERATOR_INVOKE_EVENT) {
+  if (ShouldRecordMemoryUsage(event_buffer_[event_index].event_type)) {
     event_buffer_[event_index].end_mem_usage = memory::GetMemoryUsage();
   }
   if (event_metadata1) {
@@ -105,6 +108,8 @@ void ProfileBuffer::AddEvent(const char* tag,
   event_buffer_[index].extra_event_metadata = event_metadata2;
   event_buffer_[index].begin_timestamp_us = 0;
   event_buffer_[index].elapsed_time = elapsed_time;
+  event_buffer_[index].begin_mem_usage = memory::MemoryUsage();
+  event_buffer_[index].end_mem_usage = memory::MemoryUsage();
   current_index_++;
 }
 
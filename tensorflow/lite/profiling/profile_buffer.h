@@ -83,6 +83,10 @@ class ProfileBuffer {
   // Sets the enabled state of buffer to |enabled|
   void SetEnabled(bool enabled) { enabled_ = enabled; }
 
+  // Sets whether the memory usage is also recorded for operator invoke events.
+  // This is off by default as it adds overhead to every op invocation.
+  void SetRecordOpMemoryUsage(bool record) { record_op_memory_usage_ = record; }
+
   // Sets the end timestamp for event for the handle to current time.
   // If the buffer is disabled or previous event has been overwritten this
   // operation has not effect.
@@ -115,7 +119,14 @@ class ProfileBuffer {
   // the 2nd element refers to whether the buffer reaches its allowed capacity.
   std::pair<int, bool> GetNextEntryIndex();
 
+  // Returns whether the memory usage should be recorded for `event_type`.
+  bool ShouldRecordMemoryUsage(ProfileEvent::EventType event_type) const {
+    return record_op_memory_usage_ ||
+           event_type != ProfileEvent::EventType::OPERATOR_INVOKE_EVENT;
+  }
+
   bool enabled_;
+  bool record_op_memory_usage_ = false;
   uint32_t current_index_;
   std::vector<ProfileEvent> event_buffer_;
   const bool allow_dynamic_expansion_;
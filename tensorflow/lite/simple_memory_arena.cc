@@ -141,6 +141,39 @@ TfLiteStatus SimpleMemoryArena::Allocate(
   return kTfLiteOk;
 }
 
+TfLiteStatus SimpleMemoryArena::AllocateAt(
+    size_t alignment, size_t size, int32_t tensor, int32_t first_node,
+    int32_t last_node, size_t offset, ArenaAllocWithUsageInterval* new_alloc) {
+  if (alignment > arena_alignment_ || AlignTo(alignment, offset) != offset) {
+    return kTfLiteError;
+  }
+  if (size != 0) {
+    for (const auto& alloc : active_allocs_) {
+      if (alloc.last_node < first_node || alloc.first_node > last_node) {
+        continue;
+      }
+      if (alloc.offset < offset + size && offset < alloc.offset + alloc.size) {
+        return kTfLiteError;
+      }
+    }
+  }
+  new_alloc->tensor = tensor;
+  new_alloc->first_node = first_node;
+  new_alloc->last_node = last_node;
+  new_alloc->size = size;
+  if (size == 0) {
+    new_alloc->offset = 0;
+    return kTfLiteOk;
+  }
+  high_water_mark_ = std::max(high_water_mark_, offset + size);
+  new_alloc->offset = offset;
+
+  auto insertion_it = std::upper_bound(active_allocs_.begin(),
+                                       active_allocs_.end(), *new_alloc);
+  active_allocs_.insert(insertion_it, *new_alloc);
+  return kTfLiteOk;
+}
+
 TfLiteStatus SimpleMemoryArena::Commit(TfLiteContext* context,
                                        bool* arena_reallocated) {
   size_t required_size = RequiredBufferSize();
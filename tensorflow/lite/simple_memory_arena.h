@@ -99,6 +99,15 @@ class SimpleMemoryArena {
                         int32_t tensor, int32_t first_node, int32_t last_node,
                         ArenaAllocWithUsageInterval* new_alloc);
 
+  // Schedule memory allocation for a tensor like Allocate, but at a fixed
+  // `offset` given by an offline memory plan. Returns kTfLiteError, without
+  // reporting it, if `offset` is misaligned or if the allocation would overlap
+  // an active allocation whose usage interval intersects
+  // [first_node, last_node]; the arena is then left unchanged.
+  TfLiteStatus AllocateAt(size_t alignment, size_t size, int32_t tensor,
+                          int32_t first_node, int32_t last_node, size_t offset,
+                          ArenaAllocWithUsageInterval* new_alloc);
+
   inline size_t RequiredBufferSize() {
     // Add in a small amount of padding to reduce the chance of resize events
     // for small allocations.
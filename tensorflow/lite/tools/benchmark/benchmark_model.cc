@@ -26,6 +26,7 @@ limitations under the License.
 
 #include "tensorflow/lite/profiling/memory_info.h"
 #include "tensorflow/lite/profiling/time.h"
+#include "tensorflow/lite/tools/benchmark/benchmark_multi_stream.h"
 #include "tensorflow/lite/tools/benchmark/benchmark_utils.h"
 #include "tensorflow/lite/tools/logging.h"
 
@@ -71,6 +72,10 @@ BenchmarkParams BenchmarkModel::DefaultParams() {
                   BenchmarkParam::Create<bool>(false));
   params.AddParam("memory_footprint_check_interval_ms",
                   BenchmarkParam::Create<int32_t>(kMemoryCheckIntervalMs));
+  params.AddParam("num_streams", BenchmarkParam::Create<int32_t>(1));
+  params.AddParam("stream_arrival_rate", BenchmarkParam::Create<float>(-1.0f));
+  params.AddParam("stream_cpu_affinity",
+                  BenchmarkParam::Create<std::string>(""));
   return params;
 }
 
@@ -171,7 +176,23 @@ std::vector<Flag> BenchmarkModel::GetFlags() {
       CreateFlag<int32_t>("memory_footprint_check_interval_ms", &params_,
                           "The interval in millisecond between two consecutive "
                           "memory footprint checks. This is only used when "
-                          "--report_peak_memory_footprint is set to true.")};
+                          "--report_peak_memory_footprint is set to true."),
+      CreateFlag<int32_t>(
+          "num_streams", &params_,
+          "If greater than 1, after the single-stream benchmark, run this "
+          "many instances of the model concurrently, each on its own thread, "
+          "and report their aggregate QPS and latency percentiles. The run "
+          "durations and counts follow num_runs, min_secs and max_secs."),
+      CreateFlag<float>(
+          "stream_arrival_rate", &params_,
+          "Requests per second issued to the streams as a Poisson process "
+          "(open loop), the latency then includes the time spent waiting for "
+          "an idle stream. If <= 0, each stream runs back to back (closed "
+          "loop)."),
+      CreateFlag<std::string>(
+          "stream_cpu_affinity", &params_,
+          "Comma-separated list of CPUs to pin the streams to, stream i is "
+          "pinned to the (i % list size)-th CPU, e.g. 0,1,2,3.")};
 }
 
 void BenchmarkModel::LogParams() {
@@ -198,12 +219,27 @@ void BenchmarkModel::LogParams() {
                       "Report the peak memory footprint", verbose);
   LOG_BENCHMARK_PARAM(int32_t, "memory_footprint_check_interval_ms",
                       "Memory footprint check interval (ms)", verbose);
+  LOG_BENCHMARK_PARAM(int32_t, "num_streams", "Num concurrent streams",
+                      verbose);
+  LOG_BENCHMARK_PARAM(float, "stream_arrival_rate",
+                      "Stream request arrival rate (per second)", verbose);
+  LOG_BENCHMARK_PARAM(std::string, "stream_cpu_affinity",
+                      "Stream CPU affinity", verbose);
 }
 
 TfLiteStatus BenchmarkModel::PrepareInputData() { return kTfLiteOk; }
 
 TfLiteStatus BenchmarkModel::ResetInputsAndOutputs() { return kTfLiteOk; }
 
+TfLiteStatus BenchmarkModel::InitStreams(int num_streams) {
+  TFLITE_LOG(ERROR) << "This benchmark doesn't support multiple streams.";
+  return kTfLiteError;
+}
+
+TfLiteStatus BenchmarkModel::RunStreamImpl(int stream_index) {
+  return kTfLiteError;
+}
+
 Stat<int64_t> BenchmarkModel::Run(int min_num_times, float min_secs,
                                   float max_secs, RunType run_type,
                                   TfLiteStatus* invoke_status) {
@@ -268,6 +304,17 @@ TfLiteStatus BenchmarkModel::ValidateParams() {
                            kMemoryCheckIntervalMs);
     }
   }
+  if (params_.Get<int32_t>("num_streams") < 1) {
+    TFLITE_LOG(ERROR) << "--num_streams should be at least 1.";
+    return kTfLiteError;
+  }
+  std::vector<int> cpus;
+  if (!util::SplitAndParse(params_.Get<std::string>("stream_cpu_affinity"),
+                           ',', &cpus)) {
+    TFLITE_LOG(ERROR) << "Failed to parse --stream_cpu_affinity: "
+                      << params_.Get<std::string>("stream_cpu_affinity");
+    return kTfLiteError;
+  }
   return kTfLiteOk;
 }
 
@@ -337,9 +384,59 @@ TfLiteStatus BenchmarkModel::Run() {
   listeners_.OnBenchmarkEnd({model_size_mb, startup_latency_us, input_bytes,
                              warmup_time_us, inference_time_us, init_mem_usage,
                              overall_mem_usage, peak_mem_mb});
+  if (status == kTfLiteOk && params_.Get<int32_t>("num_streams") > 1) {
+    status = RunStreams();
+  }
   return status;
 }
 
+TfLiteStatus BenchmarkModel::RunStreams() {
+  const int num_streams = params_.Get<int32_t>("num_streams");
+  const int64_t init_start_us = profiling::time::NowMicros();
+  TfLiteStatus status = InitStreams(num_streams);
+  if (status != kTfLiteOk) {
+    CleanUpStreams();
+    return status;
+  }
+  TFLITE_LOG(INFO) << "Initialized " << num_streams << " streams in "
+                   << (profiling::time::NowMicros() - init_start_us) / 1e3
+                   << "ms.";
+
+  MultiStreamRunner::Options options;
+  options.num_streams = num_streams;
+  options.arrival_rate = params_.Get<float>("stream_arrival_rate");
+  util::SplitAndParse(params_.Get<std::string>("stream_cpu_affinity"), ',',
+                      &options.cpu_affinity);
+  options.warmup_runs_per_stream = params_.Get<int32_t>("warmup_runs");
+  options.min_num_requests = params_.Get<int32_t>("num_runs");
+  options.min_secs = params_.Get<float>("min_secs");
+  options.max_secs = params_.Get<float>("max_secs");
+  MultiStreamRunner::Results results;
+  status = MultiStreamRunner(options).Run(
+      [this](int stream_index) { return RunStreamImpl(stream_index); },
+      &results);
+  CleanUpStreams();
+  if (status != kTfLiteOk) return status;
+
+  TFLITE_LOG(INFO) << "Multi-stream results: " << num_streams << " streams, "
+                   << results.num_requests << " requests in "
+                   << results.duration_secs << "s, QPS: " << results.qps;
+  TFLITE_LOG(INFO) << "Multi-stream latency in us: "
+                   << "avg: " << results.latency_us.avg() << ", "
+                   << "p50: " << results.p50_us << ", "
+                   << "p99: " << results.p99_us << ", "
+                   << "p999: " << results.p999_us << ", "
+                   << "max: " << results.latency_us.max();
+  TFLITE_MAY_LOG(WARN, results.num_dropped > 0)
+      << results.num_dropped << " requests were dropped as they couldn't be "
+      << "run before --max_secs, the arrival rate is likely too high.";
+  if (results.num_failures > 0) {
+    TFLITE_LOG(ERROR) << results.num_failures << " requests failed.";
+    return kTfLiteError;
+  }
+  return kTfLiteOk;
+}
+
 TfLiteStatus BenchmarkModel::ParseFlags(int* argc, char** argv) {
   auto flag_list = GetFlags();
   const bool parse_result =
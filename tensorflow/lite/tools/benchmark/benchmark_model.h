@@ -226,12 +226,26 @@ class BenchmarkModel {
   virtual TfLiteStatus ResetInputsAndOutputs();
   virtual TfLiteStatus RunImpl() = 0;
 
+  // Creates the independent instances of the model run concurrently when
+  // --num_streams is greater than 1, with their inputs set. Called after the
+  // single-stream benchmark completes.
+  virtual TfLiteStatus InitStreams(int num_streams);
+  // Runs one inference on the instance of the given stream. Called from the
+  // thread of that stream only.
+  virtual TfLiteStatus RunStreamImpl(int stream_index);
+  // Releases the instances created by InitStreams.
+  virtual void CleanUpStreams() {}
+
   // Create a MemoryUsageMonitor to report peak memory footprint if specified.
   virtual std::unique_ptr<profiling::memory::MemoryUsageMonitor>
   MayCreateMemoryUsageMonitor() const;
 
   BenchmarkParams params_;
   BenchmarkListeners listeners_;
+
+ private:
+  // Runs the multi-stream benchmark and logs its results.
+  TfLiteStatus RunStreams();
 };
 
 }  // namespace benchmark
@@ -0,0 +1,267 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/tools/benchmark/benchmark_multi_stream.h"
+
+#if defined(__linux__) || defined(__ANDROID__)
+#include <sched.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>  // NOLINT(build/c++11)
+#include <cstdint>
+#include <deque>
+#include <mutex>  // NOLINT(build/c++11)
+#include <random>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "tensorflow/lite/profiling/time.h"
+#include "tensorflow/lite/tools/logging.h"
+
+namespace tflite {
+namespace benchmark {
+namespace {
+
+void PinCurrentThreadToCpu(int cpu) {
+#if defined(__linux__) || defined(__ANDROID__)
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  CPU_SET(cpu, &cpu_set);
+  if (sched_setaffinity(0, sizeof(cpu_set), &cpu_set) != 0) {
+    TFLITE_LOG(WARN) << "Failed to pin a stream to CPU " << cpu << ".";
+  }
+#else
+  TFLITE_LOG(WARN) << "Pinning streams to CPUs isn't supported on this "
+                      "platform.";
+#endif
+}
+
+// Arrival times of the open-loop requests waiting for a stream.
+class RequestQueue {
+ public:
+  void Push(int64_t arrival_us) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      arrivals_us_.push_back(arrival_us);
+    }
+    cond_.notify_one();
+  }
+
+  // Blocks until a request is queued, or returns false once the queue is
+  // closed and empty.
+  bool Pop(int64_t* arrival_us) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cond_.wait(lock, [this] { return closed_ || !arrivals_us_.empty(); });
+    if (arrivals_us_.empty()) return false;
+    *arrival_us = arrivals_us_.front();
+    arrivals_us_.pop_front();
+    return true;
+  }
+
+  void Close() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      closed_ = true;
+    }
+    cond_.notify_all();
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  std::deque<int64_t> arrivals_us_;
+  bool closed_ = false;
+};
+
+// Lets the measurement start once all the streams are warmed up.
+class StartGate {
+ public:
+  explicit StartGate(int num_streams) : num_waiting_(num_streams) {}
+
+  // Called by each stream when it is ready.
+  void Arrive() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      --num_waiting_;
+    }
+    cond_.notify_all();
+  }
+
+  void WaitForAllArrived() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cond_.wait(lock, [this] { return num_waiting_ == 0; });
+  }
+
+  void Open() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      open_ = true;
+    }
+    cond_.notify_all();
+  }
+
+  void WaitForOpen() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cond_.wait(lock, [this] { return open_; });
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  int num_waiting_;
+  bool open_ = false;
+};
+
+struct StreamResults {
+  std::vector<int64_t> latencies_us;
+  int64_t num_failures = 0;
+  int64_t num_dropped = 0;
+};
+
+}  // namespace
+
+int64_t MultiStreamRunner::GetPercentile(
+    const std::vector<int64_t>& sorted_values, double percentile) {
+  if (sorted_values.empty()) return 0;
+  // Nearest-rank method, the epsilon absorbs the rounding of e.g. 99.9 / 100.
+  const int64_t rank = static_cast<int64_t>(
+      std::ceil(percentile / 100.0 * sorted_values.size() - 1e-9));
+  const int64_t index = std::min<int64_t>(
+      std::max<int64_t>(rank - 1, 0), sorted_values.size() - 1);
+  return sorted_values[index];
+}
+
+TfLiteStatus MultiStreamRunner::Run(const RunRequestFn& run_request,
+                                    Results* results) const {
+  const int num_streams = std::max(options_.num_streams, 1);
+  const bool open_loop = options_.arrival_rate > 0;
+  TFLITE_LOG(INFO) << "Running " << num_streams << " streams "
+                   << (open_loop ? "open-loop" : "closed-loop")
+                   << " for at least " << options_.min_num_requests
+                   << " requests and at least " << options_.min_secs
+                   << " seconds but terminate if exceeding "
+                   << options_.max_secs << " seconds.";
+
+  StartGate start_gate(num_streams);
+  RequestQueue queue;
+  std::atomic<bool> warmup_failed(false);
+  std::atomic<int64_t> num_completed(0);
+  // Set before the start gate is opened.
+  int64_t min_finish_us = 0;
+  int64_t max_finish_us = 0;
+  auto should_stop = [&](int64_t count) {
+    const int64_t now_us = profiling::time::NowMicros();
+    return now_us > max_finish_us ||
+           (count >= options_.min_num_requests && now_us >= min_finish_us);
+  };
+
+  std::vector<StreamResults> stream_results(num_streams);
+  std::vector<std::thread> threads;
+  threads.reserve(num_streams);
+  for (int i = 0; i < num_streams; ++i) {
+    threads.emplace_back([&, i] {
+      if (!options_.cpu_affinity.empty()) {
+        PinCurrentThreadToCpu(
+            options_.cpu_affinity[i % options_.cpu_affinity.size()]);
+      }
+      for (int run = 0; run < options_.warmup_runs_per_stream; ++run) {
+        if (run_request(i) != kTfLiteOk) warmup_failed = true;
+      }
+      start_gate.Arrive();
+      start_gate.WaitForOpen();
+      if (warmup_failed) return;
+
+      StreamResults& stream = stream_results[i];
+      if (open_loop) {
+        int64_t arrival_us;
+        while (queue.Pop(&arrival_us)) {
+          if (profiling::time::NowMicros() > max_finish_us) {
+            ++stream.num_dropped;
+            continue;
+          }
+          if (run_request(i) != kTfLiteOk) ++stream.num_failures;
+          stream.latencies_us.push_back(profiling::time::NowMicros() -
+                                        arrival_us);
+        }
+      } else {
+        while (!should_stop(num_completed.load())) {
+          const int64_t start_us = profiling::time::NowMicros();
+          if (run_request(i) != kTfLiteOk) ++stream.num_failures;
+          stream.latencies_us.push_back(profiling::time::NowMicros() -
+                                        start_us);
+          ++num_completed;
+        }
+      }
+    });
+  }
+
+  start_gate.WaitForAllArrived();
+  const int64_t start_us = profiling::time::NowMicros();
+  min_finish_us = start_us + static_cast<int64_t>(options_.min_secs * 1.e6f);
+  max_finish_us = start_us + static_cast<int64_t>(options_.max_secs * 1.e6f);
+  start_gate.Open();
+
+  if (open_loop && !warmup_failed) {
+    std::mt19937 random_engine(std::random_device{}());
+    std::exponential_distribution<double> inter_arrival_secs(
+        options_.arrival_rate);
+    double next_arrival_us = start_us;
+    for (int64_t count = 0; !should_stop(count); ++count) {
+      const int64_t now_us = profiling::time::NowMicros();
+      if (next_arrival_us > now_us) {
+        profiling::time::SleepForMicros(
+            static_cast<uint64_t>(next_arrival_us - now_us));
+      }
+      queue.Push(static_cast<int64_t>(next_arrival_us));
+      next_arrival_us += inter_arrival_secs(random_engine) * 1e6;
+    }
+  }
+  queue.Close();
+  for (std::thread& thread : threads) thread.join();
+  const int64_t end_us = profiling::time::NowMicros();
+
+  if (warmup_failed) {
+    TFLITE_LOG(ERROR) << "A warmup request failed.";
+    return kTfLiteError;
+  }
+
+  *results = Results();
+  std::vector<int64_t> latencies_us;
+  for (const StreamResults& stream : stream_results) {
+    latencies_us.insert(latencies_us.end(), stream.latencies_us.begin(),
+                        stream.latencies_us.end());
+    results->num_failures += stream.num_failures;
+    results->num_dropped += stream.num_dropped;
+  }
+  for (int64_t latency_us : latencies_us) {
+    results->latency_us.UpdateStat(latency_us);
+  }
+  std::sort(latencies_us.begin(), latencies_us.end());
+  results->num_requests = latencies_us.size();
+  results->duration_secs = (end_us - start_us) * 1e-6;
+  if (results->duration_secs > 0) {
+    results->qps = results->num_requests / results->duration_secs;
+  }
+  results->p50_us = GetPercentile(latencies_us, 50.0);
+  results->p99_us = GetPercentile(latencies_us, 99.0);
+  results->p999_us = GetPercentile(latencies_us, 99.9);
+  return kTfLiteOk;
+}
+
+}  // namespace benchmark
+}  // namespace tflite
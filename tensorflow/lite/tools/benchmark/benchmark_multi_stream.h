@@ -0,0 +1,94 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_TOOLS_BENCHMARK_BENCHMARK_MULTI_STREAM_H_
+#define TENSORFLOW_LITE_TOOLS_BENCHMARK_BENCHMARK_MULTI_STREAM_H_
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "tensorflow/core/util/stats_calculator.h"
+#include "tensorflow/lite/core/c/common.h"
+
+namespace tflite {
+namespace benchmark {
+
+// Runs requests on several streams concurrently, each stream on its own
+// thread, and measures the throughput and latency distribution of all of them.
+//
+// In closed-loop mode (arrival_rate <= 0) every stream issues its next request
+// as soon as the previous one completes, and the latency of a request is the
+// time spent running it. In open-loop mode requests arrive at `arrival_rate`
+// per second following a Poisson process regardless of how fast they are
+// served, and are dispatched to the first idle stream. Their latency then also
+// includes the time spent waiting for a stream.
+class MultiStreamRunner {
+ public:
+  struct Options {
+    int num_streams = 1;
+    // Requests per second over all the streams, closed-loop if <= 0.
+    double arrival_rate = -1.0;
+    // If not empty, the thread of stream i is pinned to CPU
+    // cpu_affinity[i % cpu_affinity.size()]. Only supported on Linux and
+    // Android.
+    std::vector<int> cpu_affinity;
+    // Requests run by each stream before measuring, not reported.
+    int warmup_runs_per_stream = 1;
+    // The measurement lasts until at least `min_num_requests` requests
+    // completed and `min_secs` elapsed, or until `max_secs` elapsed.
+    int min_num_requests = 50;
+    float min_secs = 1.0f;
+    float max_secs = 150.0f;
+  };
+
+  struct Results {
+    // Requests completed during the measurement.
+    int64_t num_requests = 0;
+    // Requests that failed, included in num_requests.
+    int64_t num_failures = 0;
+    // Open-loop requests that arrived but weren't run before max_secs.
+    int64_t num_dropped = 0;
+    double duration_secs = 0.0;
+    double qps = 0.0;
+    tensorflow::Stat<int64_t> latency_us;
+    int64_t p50_us = 0;
+    int64_t p99_us = 0;
+    int64_t p999_us = 0;
+  };
+
+  // Runs one request on the stream of the given index. Only called from the
+  // thread of that stream.
+  using RunRequestFn = std::function<TfLiteStatus(int stream_index)>;
+
+  explicit MultiStreamRunner(const Options& options) : options_(options) {}
+
+  // Returns kTfLiteError if any warmup request fails, in which case `results`
+  // is left unchanged.
+  TfLiteStatus Run(const RunRequestFn& run_request, Results* results) const;
+
+  // Returns the value below which `percentile` percent of the sorted
+  // `values` fall, or 0 if there are none.
+  static int64_t GetPercentile(const std::vector<int64_t>& sorted_values,
+                               double percentile);
+
+ private:
+  const Options options_;
+};
+
+}  // namespace benchmark
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_TOOLS_BENCHMARK_BENCHMARK_MULTI_STREAM_H_
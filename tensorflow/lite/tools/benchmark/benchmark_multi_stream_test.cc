@@ -0,0 +1,119 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/tools/benchmark/benchmark_multi_stream.h"
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/profiling/time.h"
+
+namespace tflite {
+namespace benchmark {
+namespace {
+
+constexpr int kNumStreams = 3;
+constexpr int kRequestUs = 1000;
+
+TEST(MultiStreamRunnerTest, GetPercentile) {
+  std::vector<int64_t> values;
+  for (int i = 1; i <= 1000; ++i) values.push_back(i);
+  EXPECT_EQ(MultiStreamRunner::GetPercentile(values, 50.0), 500);
+  EXPECT_EQ(MultiStreamRunner::GetPercentile(values, 99.0), 990);
+  EXPECT_EQ(MultiStreamRunner::GetPercentile(values, 99.9), 999);
+  EXPECT_EQ(MultiStreamRunner::GetPercentile(values, 100.0), 1000);
+  EXPECT_EQ(MultiStreamRunner::GetPercentile({}, 50.0), 0);
+}
+
+TEST(MultiStreamRunnerTest, ClosedLoop) {
+  MultiStreamRunner::Options options;
+  options.num_streams = kNumStreams;
+  options.warmup_runs_per_stream = 2;
+  options.min_num_requests = 30;
+  options.min_secs = 0.0f;
+  std::atomic<int> num_runs[kNumStreams] = {};
+  MultiStreamRunner runner(options);
+  MultiStreamRunner::Results results;
+  ASSERT_EQ(runner.Run(
+                [&](int stream_index) {
+                  ++num_runs[stream_index];
+                  profiling::time::SleepForMicros(kRequestUs);
+                  return kTfLiteOk;
+                },
+                &results),
+            kTfLiteOk);
+
+  EXPECT_GE(results.num_requests, options.min_num_requests);
+  EXPECT_EQ(results.num_failures, 0);
+  EXPECT_EQ(results.num_dropped, 0);
+  EXPECT_GT(results.qps, 0.0);
+  EXPECT_GE(results.p50_us, kRequestUs);
+  EXPECT_LE(results.p50_us, results.p99_us);
+  EXPECT_LE(results.p99_us, results.p999_us);
+  int total_runs = 0;
+  for (int i = 0; i < kNumStreams; ++i) {
+    // Every stream ran its warmup requests and some measured ones.
+    EXPECT_GT(num_runs[i], options.warmup_runs_per_stream);
+    total_runs += num_runs[i];
+  }
+  EXPECT_EQ(total_runs, results.num_requests +
+                            kNumStreams * options.warmup_runs_per_stream);
+}
+
+TEST(MultiStreamRunnerTest, OpenLoop) {
+  MultiStreamRunner::Options options;
+  options.num_streams = kNumStreams;
+  options.arrival_rate = 500.0;
+  options.warmup_runs_per_stream = 0;
+  options.min_num_requests = 20;
+  options.min_secs = 0.0f;
+  std::atomic<int> num_failures(0);
+  MultiStreamRunner runner(options);
+  MultiStreamRunner::Results results;
+  ASSERT_EQ(runner.Run(
+                [&](int stream_index) {
+                  profiling::time::SleepForMicros(kRequestUs);
+                  // Fail every other request.
+                  return (num_failures++ % 2) ? kTfLiteError : kTfLiteOk;
+                },
+                &results),
+            kTfLiteOk);
+
+  EXPECT_EQ(results.num_requests, options.min_num_requests);
+  EXPECT_EQ(results.num_failures, options.min_num_requests / 2);
+  EXPECT_EQ(results.num_dropped, 0);
+  // The latency includes the time spent waiting for a stream.
+  EXPECT_GE(results.latency_us.min(), kRequestUs);
+}
+
+TEST(MultiStreamRunnerTest, WarmupFailure) {
+  MultiStreamRunner::Options options;
+  options.num_streams = kNumStreams;
+  MultiStreamRunner runner(options);
+  MultiStreamRunner::Results results;
+  EXPECT_EQ(runner.Run(
+                [](int stream_index) {
+                  return stream_index == 1 ? kTfLiteError : kTfLiteOk;
+                },
+                &results),
+            kTfLiteError);
+  EXPECT_EQ(results.num_requests, 0);
+}
+
+}  // namespace
+}  // namespace benchmark
+}  // namespace tflite
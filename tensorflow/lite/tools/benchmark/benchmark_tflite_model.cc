@@ -45,6 +45,7 @@ limitations under the License.
 #include "tensorflow/lite/kernels/cpu_backend_context.h"
 #include "tensorflow/lite/op_resolver.h"
 #include "tensorflow/lite/optional_debug_tools.h"
+#include "tensorflow/lite/profiling/op_profile_report.h"
 #include "tensorflow/lite/profiling/profile_summary_formatter.h"
 #include "tensorflow/lite/string_util.h"
 #include "tensorflow/lite/tools/benchmark/benchmark_utils.h"
@@ -370,6 +371,10 @@ BenchmarkParams BenchmarkTfLiteModel::DefaultParams() {
                           BenchmarkParam::Create<bool>(false));
   default_params.AddParam("profiling_output_csv_file",
                           BenchmarkParam::Create<std::string>(""));
+  default_params.AddParam("op_profiling_report_file",
+                          BenchmarkParam::Create<std::string>(""));
+  default_params.AddParam("op_profiling_report_format",
+                          BenchmarkParam::Create<std::string>("csv"));
 
   default_params.AddParam("print_preinvoke_state",
                           BenchmarkParam::Create<bool>(false));
@@ -410,6 +415,7 @@ void BenchmarkTfLiteModel::CleanUp() {
 
 BenchmarkTfLiteModel::~BenchmarkTfLiteModel() {
   CleanUp();
+  CleanUpStreams();
 
   // Destory the owned interpreter earlier than other objects (specially
   // 'owned_delegates_').
@@ -452,6 +458,14 @@ std::vector<Flag> BenchmarkTfLiteModel::GetFlags() {
           "profiling_output_csv_file", &params_,
           "File path to export profile data as CSV, if not set "
           "prints to stdout."),
+      CreateFlag<std::string>(
+          "op_profiling_report_file", &params_,
+          "File path to export a per-op report of latency statistics and "
+          "attributed memory to. Requires enable_op_profiling."),
+      CreateFlag<std::string>(
+          "op_profiling_report_format", &params_,
+          "Format of the op profiling report: 'csv', 'json' or "
+          "'chrome_trace'."),
       CreateFlag<bool>(
           "print_preinvoke_state", &params_,
           "print out the interpreter internals just before calling Invoke. The "
@@ -518,6 +532,10 @@ void BenchmarkTfLiteModel::LogParams() {
                       verbose);
   LOG_BENCHMARK_PARAM(std::string, "profiling_output_csv_file",
                       "CSV File to export profiling data to", verbose);
+  LOG_BENCHMARK_PARAM(std::string, "op_profiling_report_file",
+                      "File to export the op profiling report to", verbose);
+  LOG_BENCHMARK_PARAM(std::string, "op_profiling_report_format",
+                      "Op profiling report format", verbose);
   LOG_BENCHMARK_PARAM(bool, "print_preinvoke_state",
                       "Print pre-invoke interpreter state", verbose);
   LOG_BENCHMARK_PARAM(bool, "print_postinvoke_state",
@@ -552,6 +570,15 @@ TfLiteStatus BenchmarkTfLiteModel::ValidateParams() {
     return kTfLiteError;
   }
 
+  profiling::OpProfileReport::Format op_report_format;
+  if (!profiling::OpProfileReport::ParseFormat(
+          params_.Get<std::string>("op_profiling_report_format"),
+          &op_report_format)) {
+    TFLITE_LOG(ERROR) << "Unsupported op_profiling_report_format: "
+                      << params_.Get<std::string>("op_profiling_report_format");
+    return kTfLiteError;
+  }
+
   return PopulateInputLayerInfo(
       params_.Get<std::string>("input_layer"),
       params_.Get<std::string>("input_layer_shape"),
@@ -688,11 +715,16 @@ TfLiteStatus BenchmarkTfLiteModel::PrepareInputData() {
 }
 
 TfLiteStatus BenchmarkTfLiteModel::ResetInputsAndOutputs() {
-  auto interpreter_inputs = interpreter_->inputs();
+  SetInputsFromData(interpreter_.get());
+  return kTfLiteOk;
+}
+
+void BenchmarkTfLiteModel::SetInputsFromData(tflite::Interpreter* interpreter) {
+  auto interpreter_inputs = interpreter->inputs();
   // Set the values of the input tensors from inputs_data_.
   for (int j = 0; j < interpreter_inputs.size(); ++j) {
     int i = interpreter_inputs[j];
-    TfLiteTensor* t = interpreter_->tensor(i);
+    TfLiteTensor* t = interpreter->tensor(i);
     if (t->type == kTfLiteString) {
       if (inputs_data_[j].data) {
         static_cast<DynamicBuffer*>(inputs_data_[j].data.get())
@@ -710,15 +742,9 @@ TfLiteStatus BenchmarkTfLiteModel::ResetInputsAndOutputs() {
                   inputs_data_[j].bytes);
     }
   }
-
-  return kTfLiteOk;
 }
 
-TfLiteStatus BenchmarkTfLiteModel::InitInterpreter() {
-  auto resolver = GetOpResolver();
-  const int32_t num_threads = params_.Get<int32_t>("num_threads");
-  const bool use_caching = params_.Get<bool>("use_caching");
-
+InterpreterOptions BenchmarkTfLiteModel::GetInterpreterOptions() const {
   InterpreterOptions options;
   options.SetEnsureDynamicTensorsAreReleased(
       params_.Get<bool>("release_dynamic_tensors"));
@@ -726,7 +752,15 @@ TfLiteStatus BenchmarkTfLiteModel::InitInterpreter() {
       params_.Get<int32_t>("optimize_memory_for_large_tensors"));
   options.SetDisableDelegateClustering(
       params_.Get<bool>("disable_delegate_clustering"));
+  return options;
+}
 
+TfLiteStatus BenchmarkTfLiteModel::InitInterpreter() {
+  auto resolver = GetOpResolver();
+  const int32_t num_threads = params_.Get<int32_t>("num_threads");
+  const bool use_caching = params_.Get<bool>("use_caching");
+
+  InterpreterOptions options = GetInterpreterOptions();
   tflite::InterpreterBuilder builder(*model_, *resolver, &options);
   if (builder.SetNumThreads(num_threads) != kTfLiteOk) {
     TFLITE_LOG(ERROR) << "Failed to set thread number";
@@ -952,15 +986,84 @@ std::unique_ptr<BenchmarkListener>
 BenchmarkTfLiteModel::MayCreateProfilingListener() const {
   if (!params_.Get<bool>("enable_op_profiling")) return nullptr;
 
+  profiling::OpProfileReport::Format op_report_format =
+      profiling::OpProfileReport::Format::kCsv;
+  profiling::OpProfileReport::ParseFormat(
+      params_.Get<std::string>("op_profiling_report_format"),
+      &op_report_format);
   return std::unique_ptr<BenchmarkListener>(new ProfilingListener(
       interpreter_.get(), params_.Get<int32_t>("max_profiling_buffer_entries"),
       params_.Get<bool>("allow_dynamic_profiling_buffer_increase"),
       params_.Get<std::string>("profiling_output_csv_file"),
       CreateProfileSummaryFormatter(
-          !params_.Get<std::string>("profiling_output_csv_file").empty())));
+          !params_.Get<std::string>("profiling_output_csv_file").empty()),
+      params_.Get<std::string>("op_profiling_report_file"), op_report_format));
 }
 
 TfLiteStatus BenchmarkTfLiteModel::RunImpl() { return interpreter_->Invoke(); }
 
+TfLiteStatus BenchmarkTfLiteModel::InitStreams(int num_streams) {
+  CleanUpStreams();
+  for (int i = 0; i < num_streams; ++i) {
+    streams_.emplace_back(new Stream());
+    if (InitStream(streams_.back().get()) != kTfLiteOk) {
+      TFLITE_LOG(ERROR) << "Failed to initialize stream #" << i << ".";
+      return kTfLiteError;
+    }
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus BenchmarkTfLiteModel::InitStream(Stream* stream) {
+  // The interpreter of the single-stream benchmark already validated the
+  // model, inputs and delegates so this only replicates its setup.
+  auto resolver = GetOpResolver();
+  const int32_t num_threads = params_.Get<int32_t>("num_threads");
+  InterpreterOptions options = GetInterpreterOptions();
+  tflite::InterpreterBuilder builder(*model_, *resolver, &options);
+  TF_LITE_ENSURE_STATUS(builder.SetNumThreads(num_threads));
+  TF_LITE_ENSURE_STATUS(builder(&stream->interpreter));
+  Interpreter* interpreter = stream->interpreter.get();
+  // Each stream has its own CPU backend context, as they can't be shared by
+  // interpreters running concurrently.
+  if (params_.Get<bool>("use_caching")) {
+    stream->external_context =
+        std::make_unique<tflite::ExternalCpuBackendContext>();
+    auto cpu_backend_context = std::make_unique<tflite::CpuBackendContext>();
+    cpu_backend_context->SetUseCaching(true);
+    cpu_backend_context->SetMaxNumThreads(num_threads);
+    stream->external_context->set_internal_backend_context(
+        std::move(cpu_backend_context));
+    interpreter->SetExternalContext(kTfLiteCpuBackendContext,
+                                    stream->external_context.get());
+  }
+  interpreter->SetAllowFp16PrecisionForFp32(params_.Get<bool>("allow_fp16"));
+
+  tools::ProvidedDelegateList delegate_providers(&params_);
+  for (auto& created_delegate :
+       delegate_providers.CreateAllRankedDelegates()) {
+    stream->delegates.emplace_back(std::move(created_delegate.delegate));
+    TF_LITE_ENSURE_STATUS(
+        interpreter->ModifyGraphWithDelegate(stream->delegates.back().get()));
+  }
+
+  for (int j = 0; j < inputs_.size(); ++j) {
+    const int i = interpreter->inputs()[j];
+    if (interpreter->tensor(i)->type != kTfLiteString) {
+      TF_LITE_ENSURE_STATUS(
+          interpreter->ResizeInputTensor(i, inputs_[j].shape));
+    }
+  }
+  TF_LITE_ENSURE_STATUS(interpreter->AllocateTensors());
+  SetInputsFromData(interpreter);
+  return kTfLiteOk;
+}
+
+TfLiteStatus BenchmarkTfLiteModel::RunStreamImpl(int stream_index) {
+  return streams_[stream_index]->interpreter->Invoke();
+}
+
+void BenchmarkTfLiteModel::CleanUpStreams() { streams_.clear(); }
+
 }  // namespace benchmark
 }  // namespace tflite
@@ -89,6 +89,10 @@ class BenchmarkTfLiteModel : public BenchmarkModel {
   TfLiteStatus PrepareInputData() override;
   TfLiteStatus ResetInputsAndOutputs() override;
 
+  TfLiteStatus InitStreams(int num_streams) override;
+  TfLiteStatus RunStreamImpl(int stream_index) override;
+  void CleanUpStreams() override;
+
   int64_t MayGetModelFileSize() override;
 
   virtual TfLiteStatus LoadModel();
@@ -115,9 +119,26 @@ class BenchmarkTfLiteModel : public BenchmarkModel {
   std::unique_ptr<tflite::ExternalCpuBackendContext> external_context_;
 
  private:
+  // An interpreter of the model run concurrently with the others in the
+  // multi-stream benchmark. All of them share the weights of model_.
+  struct Stream {
+    // The interpreter depends on these, so it's declared last to be destroyed
+    // first.
+    std::vector<Interpreter::TfLiteDelegatePtr> delegates;
+    std::unique_ptr<tflite::ExternalCpuBackendContext> external_context;
+    std::unique_ptr<tflite::Interpreter> interpreter;
+  };
+
   utils::InputTensorData CreateRandomTensorData(
       const TfLiteTensor& t, const InputLayerInfo* layer_info);
 
+  InterpreterOptions GetInterpreterOptions() const;
+
+  // Sets the inputs of `interpreter` from inputs_data_.
+  void SetInputsFromData(tflite::Interpreter* interpreter);
+
+  TfLiteStatus InitStream(Stream* stream);
+
   void AddOwnedListener(std::unique_ptr<BenchmarkListener> listener) {
     if (listener == nullptr) return;
     owned_listeners_.emplace_back(std::move(listener));
@@ -130,6 +151,7 @@ class BenchmarkTfLiteModel : public BenchmarkModel {
   // Always TFLITE_LOG the benchmark result.
   BenchmarkLoggingListener log_output_;
   std::unique_ptr<tools::ModelLoader> model_loader_;
+  std::vector<std::unique_ptr<Stream>> streams_;
 };
 
 }  // namespace benchmark
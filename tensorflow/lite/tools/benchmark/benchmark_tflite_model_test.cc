@@ -79,6 +79,19 @@ TEST(BenchmarkTfLiteModelTest, GetModelSizeFromFileDescriptorSucceeded) {
   EXPECT_EQ(listener.results_.model_size_mb(), stat_buf.st_size / 1e6);
 }
 
+TEST(BenchmarkTfLiteModelTest, RunMultipleStreamsSucceeded) {
+  BenchmarkParams params = BenchmarkTfLiteModel::DefaultParams();
+  params.Set<std::string>("graph", kModelPath);
+  params.Set<int>("num_runs", 4);
+  params.Set<float>("min_secs", 0.0f);
+  params.Set<int>("warmup_runs", 0);
+  params.Set<int>("num_streams", 2);
+  params.Set<float>("stream_arrival_rate", 100.0f);
+  BenchmarkTfLiteModel benchmark = BenchmarkTfLiteModel(std::move(params));
+
+  EXPECT_EQ(benchmark.Run(), kTfLiteOk);
+}
+
 }  // namespace
 }  // namespace benchmark
 }  // namespace tflite
@@ -26,14 +26,20 @@ namespace benchmark {
 ProfilingListener::ProfilingListener(
     Interpreter* interpreter, uint32_t max_num_initial_entries,
     bool allow_dynamic_buffer_increase, const std::string& csv_file_path,
-    std::shared_ptr<profiling::ProfileSummaryFormatter> summarizer_formatter)
+    std::shared_ptr<profiling::ProfileSummaryFormatter> summarizer_formatter,
+    const std::string& op_report_file_path,
+    profiling::OpProfileReport::Format op_report_format)
     : run_summarizer_(summarizer_formatter),
       init_summarizer_(summarizer_formatter),
       csv_file_path_(csv_file_path),
+      op_report_file_path_(op_report_file_path),
+      op_report_format_(op_report_format),
       interpreter_(interpreter),
       profiler_(max_num_initial_entries, allow_dynamic_buffer_increase) {
   TFLITE_TOOLS_CHECK(interpreter);
   interpreter_->SetProfiler(&profiler_);
+  // The op report attributes the heap allocations made during each op to it.
+  profiler_.SetRecordOpMemoryUsage(!op_report_file_path_.empty());
 
   // We start profiling here in order to catch events that are recorded during
   // the benchmark run preparation stage where TFLite interpreter is
@@ -63,6 +69,9 @@ void ProfilingListener::OnSingleRunEnd() {
   profiler_.StopProfiling();
   auto profile_events = profiler_.GetProfileEvents();
   run_summarizer_.ProcessProfiles(profile_events, *interpreter_);
+  if (!op_report_file_path_.empty()) {
+    op_report_.ProcessProfiles(profile_events, *interpreter_);
+  }
 }
 
 void ProfilingListener::OnBenchmarkEnd(const BenchmarkResults& results) {
@@ -81,6 +90,15 @@ void ProfilingListener::OnBenchmarkEnd(const BenchmarkResults& results) {
                 run_summarizer_.GetOutputString(),
                 output_stream == nullptr ? &TFLITE_LOG(INFO) : output_stream);
   }
+  if (op_report_.num_runs() > 0) {
+    std::ofstream op_report_file(op_report_file_path_);
+    if (op_report_file.good()) {
+      op_report_file << op_report_.GetOutputString(op_report_format_);
+    } else {
+      TFLITE_LOG(ERROR) << "Failed to open " << op_report_file_path_
+                        << " to write the op profiling report.";
+    }
+  }
 }
 
 void ProfilingListener::WriteOutput(const std::string& header,
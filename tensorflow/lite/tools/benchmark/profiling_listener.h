@@ -20,6 +20,7 @@ limitations under the License.
 #include <string>
 
 #include "tensorflow/lite/profiling/buffered_profiler.h"
+#include "tensorflow/lite/profiling/op_profile_report.h"
 #include "tensorflow/lite/profiling/profile_summarizer.h"
 #include "tensorflow/lite/profiling/profile_summary_formatter.h"
 #include "tensorflow/lite/tools/benchmark/benchmark_model.h"
@@ -28,13 +29,18 @@ namespace tflite {
 namespace benchmark {
 
 // Dumps profiling events if profiling is enabled.
+// If `op_report_file_path` is set, a per-op report of the regular runs that
+// also attributes memory to the ops is written to it in `op_report_format`.
 class ProfilingListener : public BenchmarkListener {
  public:
   ProfilingListener(
       Interpreter* interpreter, uint32_t max_num_initial_entries,
       bool allow_dynamic_buffer_increase, const std::string& csv_file_path = "",
       std::shared_ptr<profiling::ProfileSummaryFormatter> summarizer_formatter =
-          std::make_shared<profiling::ProfileSummaryDefaultFormatter>());
+          std::make_shared<profiling::ProfileSummaryDefaultFormatter>(),
+      const std::string& op_report_file_path = "",
+      profiling::OpProfileReport::Format op_report_format =
+          profiling::OpProfileReport::Format::kCsv);
 
   void OnBenchmarkStart(const BenchmarkParams& params) override;
 
@@ -48,6 +54,9 @@ class ProfilingListener : public BenchmarkListener {
   profiling::ProfileSummarizer run_summarizer_;
   profiling::ProfileSummarizer init_summarizer_;
   std::string csv_file_path_;
+  profiling::OpProfileReport op_report_;
+  std::string op_report_file_path_;
+  profiling::OpProfileReport::Format op_report_format_;
 
  private:
   void WriteOutput(const std::string& header, const string& data,
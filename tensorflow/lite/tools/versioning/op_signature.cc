@@ -239,6 +239,18 @@ OpSignature GetOpSignature(const OperatorCode* op_code, const Operator* op,
       }
     } break;
 
+    case BuiltinOperator_EMBEDDING_LOOKUP: {
+      const Tensor* value_tensor =
+          subgraph->tensors()->Get(op->inputs()->Get(1));
+      const QuantizationParameters* value_quant = value_tensor->quantization();
+      if (value_quant && value_quant->scale() &&
+          value_quant->scale()->Length() > 1 &&
+          value_quant->scale()->Length() ==
+              value_tensor->shape()->Get(value_quant->quantized_dimension())) {
+        op_sig.ext_options.embedding_lookup.is_per_channel_quantized = true;
+      }
+    } break;
+
     case BuiltinOperator_QUANTIZE: {
       const Tensor* output_tensor =
           subgraph->tensors()->Get(op->outputs()->Get(0));
@@ -68,6 +68,9 @@ typedef struct {
     struct {
       bool is_per_channel_quantized;
     } dequantize;
+    struct {
+      bool is_per_channel_quantized;
+    } embedding_lookup;
     struct {
       bool is_per_channel_quantized;
     } quantize;
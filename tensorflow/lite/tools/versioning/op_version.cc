@@ -443,6 +443,14 @@ int GetBuiltinOperatorVersion(const OpSignature& op_sig) {
       }
       return 1;
 
+    case BuiltinOperator_EMBEDDING_LOOKUP:
+      // Version 4 supports int4 tables and tables quantized per row.
+      if (op_sig.inputs.at(1).type == kTfLiteInt4 ||
+          op_sig.ext_options.embedding_lookup.is_per_channel_quantized) {
+        return 4;
+      }
+      return 1;
+
     case BuiltinOperator_DEQUANTIZE:
       if (op_sig.inputs.at(0).type == kTfLiteInt4) {
         return 6;
@@ -116,6 +116,7 @@ std::string FindMinimumRuntimeVersionForOp(tflite::BuiltinOperator op_code,
            {{BuiltinOperator_EMBEDDING_LOOKUP, 1}, "1.13.0"},
            {{BuiltinOperator_EMBEDDING_LOOKUP, 2}, "1.14.0"},
            {{BuiltinOperator_EMBEDDING_LOOKUP, 3}, "1.14.0"},
+           {{BuiltinOperator_EMBEDDING_LOOKUP, 4}, "2.15.0"},
            {{BuiltinOperator_EMBEDDING_LOOKUP_SPARSE, 1}, "1.5.0"},
            {{BuiltinOperator_FAKE_QUANT, 1}, "1.5.0"},
            {{BuiltinOperator_FAKE_QUANT, 2}, "1.10.0"},
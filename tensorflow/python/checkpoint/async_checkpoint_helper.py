@@ -16,6 +16,7 @@
 
 import atexit
 import collections
+import contextlib
 import copy
 import queue
 import threading
@@ -124,6 +125,9 @@ class AsyncCheckpointHelper:
 
     self._save_file_prefix = None
     self._use_checkpoint_save = False
+    # Whether the pending save was requested in a preemption save context, in
+    # which case the async thread records it as a preemption checkpoint.
+    self._preemption_save = False
     self._async_save_thread = None
     # Concurrent queue that coordinates the events for writing/reading the
     # cpu-copied variables. A 'True' in the queue triggers the async thread to
@@ -298,6 +302,12 @@ class AsyncCheckpointHelper:
     finally:
       self._check_async_thread_error()
 
+  def _async_save_context(self):
+    """Returns the checkpoint context the async thread saves in."""
+    if self._preemption_save:
+      return checkpoint_context.preemption_save_context()
+    return contextlib.nullcontext()
+
   def _async_save(self):
     """The thread function for the async checkpoint save."""
     with context.executor_scope(
@@ -318,7 +328,8 @@ class AsyncCheckpointHelper:
         # master worker's CPU:0.
         try:
           with ops.device(self._default_device):
-            with checkpoint_context.async_metrics_context():
+            with checkpoint_context.async_metrics_context(), \
+                self._async_save_context():
               if self._use_checkpoint_save:
                 self.checkpointer().save(
                     self._save_file_prefix, self._checkpoint_options
@@ -493,6 +504,7 @@ class AsyncCheckpointHelper:
     # Need to wait until the weight copying finishes before checkpoint save.
     context.async_wait()
     self._save_file_prefix = save_path
+    self._preemption_save = checkpoint_context.in_preemption_save_context()
     self._use_checkpoint_save = False
 
     # Ensure that we do not request async checkpointing to the underlying
@@ -556,6 +568,7 @@ class AsyncCheckpointHelper:
     # Need to wait until the weight copying finishes before checkpoint save.
     context.async_wait()
     self._save_file_prefix = save_path
+    self._preemption_save = checkpoint_context.in_preemption_save_context()
     self._use_checkpoint_save = True
 
     # Ensure that we do not request async checkpointing to the underlying
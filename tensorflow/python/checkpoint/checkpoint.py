@@ -2305,6 +2305,14 @@ class Checkpoint(autotrackable.AutoTrackable):
         # final preemption checkpoint.
         if self._async_checkpointer_impl is not None:
           self._async_checkpointer_impl.sync()
+      if (checkpoint_context.async_preemption_save_allowed() and
+          context.executing_eagerly()):
+        # Only the copy to host memory happens on this thread; the file write
+        # overlaps with the shutdown of training, and the caller syncs before
+        # exiting.
+        return self._async_checkpointer()._write(  # pylint: disable=protected-access
+            file_prefix, options, write_done_callback)
+      elif checkpoint_context.in_preemption_save_context():
         # Additional work done will not be saved in a future checkpoint, so
         # we use regular sync checkpoint to avoid overhead of dispatching
         # checkpoint write to a new thread.
@@ -2429,6 +2437,13 @@ class Checkpoint(autotrackable.AutoTrackable):
         # final preemption checkpoint.
         if self._async_checkpointer_impl is not None:
           self._async_checkpointer_impl.sync()
+      if (checkpoint_context.async_preemption_save_allowed() and
+          context.executing_eagerly()):
+        # Only the copy to host memory happens on this thread; the file write
+        # overlaps with the shutdown of training, and the caller syncs before
+        # exiting.
+        return self._async_checkpointer().save(file_prefix, options)
+      elif checkpoint_context.in_preemption_save_context():
         # Additional work done will not be saved in a future checkpoint, so
         # we use regular sync checkpoint to avoid overhead of dispatching
         # checkpoint write to a new thread.
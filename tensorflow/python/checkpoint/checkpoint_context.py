@@ -24,23 +24,41 @@ class PreemptionSaveContext(threading.local):
   def __init__(self):
     super().__init__()
     self._in_preemption_save_context = False
+    self._allow_async = False
 
-  def enter_preemption_save_context(self):
+  def enter_preemption_save_context(self, allow_async=False):
     self._in_preemption_save_context = True
+    self._allow_async = allow_async
 
   def exit_preemption_save_context(self):
     self._in_preemption_save_context = False
+    self._allow_async = False
 
   def in_preemption_save_context(self):
     return self._in_preemption_save_context
 
+  def async_preemption_save_allowed(self):
+    return self._in_preemption_save_context and self._allow_async
+
 
 _preemption_save_context = PreemptionSaveContext()
 
 
 @contextlib.contextmanager
-def preemption_save_context():
-  _preemption_save_context.enter_preemption_save_context()
+def preemption_save_context(allow_async=False):
+  """Marks checkpoint saves in this thread as preemption saves.
+
+  Args:
+    allow_async: If True, saves with async checkpointing enabled in their
+      `CheckpointOptions` copy the variables to host memory and return, leaving
+      the file write to a background thread. The caller must call `sync()` on
+      the checkpoint before exiting. Otherwise such saves fall back to a
+      regular sync checkpoint.
+
+  Yields:
+    Nothing.
+  """
+  _preemption_save_context.enter_preemption_save_context(allow_async)
   try:
     yield
   finally:
@@ -51,6 +69,10 @@ def in_preemption_save_context():
   return _preemption_save_context.in_preemption_save_context()
 
 
+def async_preemption_save_allowed():
+  return _preemption_save_context.async_preemption_save_allowed()
+
+
 class AsyncMetricsContext(threading.local):
   """A context for controlling metrics recording when async checkpoint is used.
   """
@@ -21,7 +21,12 @@ from tensorflow.python.saved_model import nested_structure_coder
 
 
 # TODO(b/250921378): Add example to docstring and export to TF API.
-def distributed_save(dataset, path, dispatcher_address, compression="AUTO"):
+def distributed_save(dataset,
+                     path,
+                     dispatcher_address,
+                     compression="AUTO",
+                     chunk_format="TFRECORD",
+                     compression_level=0):
   """Initiates the process of distributedly saving a dataset to disk.
 
   Args:
@@ -34,6 +39,11 @@ def distributed_save(dataset, path, dispatcher_address, compression="AUTO"):
       `dataset` materialization.  If `"AUTO"`, the tf.data runtime decides which
       algorithm to use.  If `"GZIP"` or `"SNAPPY"`, that specific algorithm is
       used.  If `None`, the `dataset` materialization is not compressed.
+    chunk_format: (Optional.) The layout of the chunk files, `"TFRECORD"` or
+      `"COLUMNAR"`.  Columnar chunks store each component of a block of
+      elements contiguously, which makes them smaller and faster to read.
+    compression_level: (Optional.) The `"GZIP"` or `"ZLIB"` compression level
+      of columnar chunks.  0 selects the default level.
 
   Returns:
     An operation which when executed performs the distributed save.
@@ -51,6 +61,8 @@ def distributed_save(dataset, path, dispatcher_address, compression="AUTO"):
       element_spec=nested_structure_coder.encode_structure(
           dataset.element_spec).SerializeToString(),
       compression=compression,
+      chunk_format=chunk_format,
+      compression_level=compression_level,
   )
 
   return gen_experimental_dataset_ops.distributed_save(
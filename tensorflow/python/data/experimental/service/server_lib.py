@@ -313,7 +313,9 @@ class WorkerConfig(
     dispatcher_timeout_ms: How long, in milliseconds, to retry requests to the
       dispatcher before giving up and reporting an error. Defaults to 1 hour.
     data_transfer_protocol: A string indicating the protocol to be used by the
-      worker to transfer data to the client. E.g. "grpc".
+      worker to transfer data to the client. E.g. "grpc". With "shm", clients
+      on the same host as the worker read elements through shared memory,
+      and other clients use gRPC.
     data_transfer_address: A string indicating the data transfer address of the
       worker server.
   """
@@ -146,6 +146,7 @@ class OptionsTest(test_base.DatasetTestBase, parameterized.TestCase):
     options.experimental_optimization.map_and_filter_fusion = True
     options.experimental_optimization.map_fusion = True
     options.experimental_optimization.map_parallelization = True
+    options.experimental_optimization.map_vectorization = True
     options.experimental_optimization.noop_elimination = True
     options.experimental_optimization.parallel_batch = True
     options.experimental_optimization.shuffle_and_repeat_fusion = True
@@ -153,6 +154,8 @@ class OptionsTest(test_base.DatasetTestBase, parameterized.TestCase):
     options.experimental_slack = True
     options.threading.max_intra_op_parallelism = 30
     options.threading.private_threadpool_size = 40
+    options.threading.numa_node = 1
+    options.threading.spread_across_numa_nodes = True
     pb = options._to_proto()
     result = options_lib.Options()
     result._from_proto(pb)
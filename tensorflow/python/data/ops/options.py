@@ -371,6 +371,15 @@ class OptimizationOptions(options_lib.OptionsBase):
       "Whether to parallelize stateless map transformations. If None, defaults "
       "to True.")
 
+  map_vectorization = options_lib.create_option(
+      name="map_vectorization",
+      ty=bool,
+      docstring=
+      "Whether to swap a map transformation with the batch transformation that "
+      "follows it when the map function is elementwise, so that the function "
+      "is applied once per batch instead of once per element. If None, "
+      "defaults to False.")
+
   noop_elimination = options_lib.create_option(
       name="noop_elimination",
       ty=bool,
@@ -421,6 +430,8 @@ class OptimizationOptions(options_lib.OptionsBase):
       pb.map_fusion = self.map_fusion
     if self.map_parallelization is not None:
       pb.map_parallelization = self.map_parallelization
+    if self.map_vectorization is not None:
+      pb.map_vectorization = self.map_vectorization
     if self.noop_elimination is not None:
       pb.noop_elimination = self.noop_elimination
     if self.parallel_batch is not None:
@@ -448,6 +459,8 @@ class OptimizationOptions(options_lib.OptionsBase):
       self.map_fusion = pb.map_fusion
     if pb.WhichOneof("optional_map_parallelization") is not None:
       self.map_parallelization = pb.map_parallelization
+    if pb.WhichOneof("optional_map_vectorization") is not None:
+      self.map_vectorization = pb.map_vectorization
     if pb.WhichOneof("optional_noop_elimination") is not None:
       self.noop_elimination = pb.noop_elimination
     if pb.WhichOneof("optional_parallel_batch") is not None:
@@ -493,12 +506,32 @@ class ThreadingOptions(options_lib.OptionsBase):
       "The value 0 can be used to indicate that the threadpool size should be "
       "determined at runtime based on the number of available CPU cores.")
 
+  numa_node = options_lib.create_option(
+      name="numa_node",
+      ty=int,
+      docstring=
+      "If set, the threads of the dataset's iterators are pinned to the given "
+      "NUMA node and the buffers they allocate come from memory local to that "
+      "node. Ignored if NUMA is not supported or the node does not exist.")
+
+  spread_across_numa_nodes = options_lib.create_option(
+      name="spread_across_numa_nodes",
+      ty=bool,
+      docstring=
+      "If true, each iterator of the dataset is pinned to the next NUMA node in "
+      "round-robin order, so that replicas of an input pipeline are spread "
+      "across sockets. Takes precedence over `numa_node`.")
+
   def _to_proto(self):
     pb = dataset_options_pb2.ThreadingOptions()
     if self.max_intra_op_parallelism is not None:
       pb.max_intra_op_parallelism = self.max_intra_op_parallelism
     if self.private_threadpool_size is not None:
       pb.private_threadpool_size = self.private_threadpool_size
+    if self.numa_node is not None:
+      pb.numa_node = self.numa_node
+    if self.spread_across_numa_nodes is not None:
+      pb.spread_across_numa_nodes = self.spread_across_numa_nodes
     return pb
 
   def _from_proto(self, pb):
@@ -506,6 +539,10 @@ class ThreadingOptions(options_lib.OptionsBase):
       self.max_intra_op_parallelism = pb.max_intra_op_parallelism
     if pb.WhichOneof("optional_private_threadpool_size") is not None:
       self.private_threadpool_size = pb.private_threadpool_size
+    if pb.WhichOneof("optional_numa_node") is not None:
+      self.numa_node = pb.numa_node
+    if pb.WhichOneof("optional_spread_across_numa_nodes") is not None:
+      self.spread_across_numa_nodes = pb.spread_across_numa_nodes
 
 
 @tf_export("data.Options")
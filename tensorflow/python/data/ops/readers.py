@@ -138,7 +138,7 @@ class _TextLineDataset(dataset_ops.DatasetSource):
     Args:
       filenames: A `tf.string` tensor containing one or more filenames.
       compression_type: (Optional.) A `tf.string` scalar evaluating to one of
-        `""` (no compression), `"ZLIB"`, or `"GZIP"`.
+        `""` (no compression), `"ZLIB"`, `"GZIP"`, `"ZSTD"` or `"LZ4"`.
       buffer_size: (Optional.) A `tf.int64` scalar denoting the number of bytes
         to buffer. A value of 0 results in the default buffering values chosen
         based on the compression type.
@@ -221,7 +221,7 @@ class TextLineDatasetV2(dataset_ops.DatasetSource):
         `tf.string` tensor, or a value that can be converted to a `tf.string`
         tensor (such as a list of Python strings).
       compression_type: (Optional.) A `tf.string` scalar evaluating to one of
-        `""` (no compression), `"ZLIB"`, or `"GZIP"`.
+        `""` (no compression), `"ZLIB"`, `"GZIP"`, `"ZSTD"` or `"LZ4"`.
       buffer_size: (Optional.) A `tf.int64` scalar denoting the number of bytes
         to buffer. A value of 0 results in the default buffering values chosen
         based on the compression type.
@@ -291,7 +291,7 @@ class _TFRecordDataset(dataset_ops.DatasetSource):
     Args:
       filenames: A `tf.string` tensor containing one or more filenames.
       compression_type: (Optional.) A `tf.string` scalar evaluating to one of
-        `""` (no compression), `"ZLIB"`, or `"GZIP"`.
+        `""` (no compression), `"ZLIB"`, `"GZIP"`, `"ZSTD"` or `"LZ4"`.
       buffer_size: (Optional.) A `tf.int64` scalar representing the number of
         bytes in the read buffer. 0 means no buffering.
       name: (Optional.) A name for the tf.data operation.
@@ -442,7 +442,7 @@ class TFRecordDatasetV2(dataset_ops.DatasetV2):
       filenames: A `tf.string` tensor or `tf.data.Dataset` containing one or
         more filenames.
       compression_type: (Optional.) A `tf.string` scalar evaluating to one of
-        `""` (no compression), `"ZLIB"`, or `"GZIP"`.
+        `""` (no compression), `"ZLIB"`, `"GZIP"`, `"ZSTD"` or `"LZ4"`.
       buffer_size: (Optional.) A `tf.int64` scalar representing the number of
         bytes in the read buffer. If your input pipeline is I/O bottlenecked,
         consider setting this parameter to a value 1-100 MBs. If `None`, a
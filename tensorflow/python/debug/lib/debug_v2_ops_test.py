@@ -278,6 +278,49 @@ class DebugIdentityV2OpUninitializedWriterTest(
             [(i + circular_buffer_size)**2.0])
 
 
+  def testSampledSummariesAreWrittenOnlyWhenSampled(self):
+
+    @def_function.function
+    def write_debug_trace(x):
+      summary = gen_debug_ops.debug_numeric_summary_v2(
+          x,
+          tensor_debug_mode=debug_event_pb2.TensorDebugMode.CURT_HEALTH,
+          tensor_id=7,
+          sampling_period=2,
+          output_dtype=dtypes.float64)
+      gen_debug_ops.debug_identity_v2(
+          summary,
+          tfdbg_context_id="deadbeaf",
+          op_name="Identity",
+          output_slot=0,
+          tensor_debug_mode=debug_event_pb2.TensorDebugMode.CURT_HEALTH,
+          debug_urls=["file://%s" % self.dump_root],
+          circular_buffer_size=self.circular_buffer_size,
+          tfdbg_run_id=self.tfdbg_run_id)
+      return summary
+
+    sizes = [
+        self.evaluate(write_debug_trace(constant_op.constant([1.0]))).size
+        for _ in range(4)
+    ]
+    self.assertAllEqual(sizes, [2, 0, 2, 0])
+    self.writer.FlushExecutionFiles()
+
+    with debug_events_reader.DebugEventsReader(self.dump_root) as reader:
+      graph_trace_iter = reader.graph_execution_traces_iterators()[0]
+      graph_execution_traces = []
+      while True:
+        try:
+          graph_execution_traces.append(
+              next(graph_trace_iter).debug_event.graph_execution_trace)
+        except StopIteration:
+          break
+      self.assertLen(graph_execution_traces, 2)
+      for trace in graph_execution_traces:
+        self.assertAllEqual(
+            tensor_util.MakeNdarray(trace.tensor_proto), [7, 0])
+
+
 class DebugNumericSummaryV2Test(test_util.TensorFlowTestCase):
 
   @test_util.run_in_graph_and_eager_modes
@@ -767,6 +810,53 @@ class DebugNumericSummaryV2Test(test_util.TensorFlowTestCase):
     self.assertAllEqual(tensor_1, tensor_2)
     self.assertEqual(tensor_id_1, tensor_id_2)
 
+  @test_util.run_in_graph_and_eager_modes
+  def testDebugNumericSummaryV2OpFullNumericsSmall(self):
+
+    def debug_summary(x):
+      return self.evaluate(
+          gen_debug_ops.debug_numeric_summary_v2(
+              x,
+              tensor_debug_mode=(
+                  debug_event_pb2.TensorDebugMode.FULL_NUMERICS),
+              tensor_id=x._id,
+              output_dtype=dtypes.float64)), x._id
+
+    tensor, tensor_id = debug_summary(constant_op.constant([]))
+    expected = [tensor_id, -1, 1, 1, 0, 0, 0, 0, 0, 0,
+                0, 0, 0, 0, 0, 0, 0, 0, np.inf, -np.inf, np.nan, np.nan]
+    self.assertAllClose(tensor, expected)
+
+    tensor, tensor_id = debug_summary(
+        constant_op.constant(
+            np.array([[-2, 0], [np.inf, 4]], dtype=np.float32)))
+    expected = [tensor_id, -1, 1, 2, 2, 2, 0, 0, 0, 0,
+                4, 0, 1, 0, 0, 1, 1, 1, -2, 4, 2 / 3, np.var([-2, 0, 4])]
+    self.assertAllClose(tensor, expected)
+
+    tensor, tensor_id = debug_summary(
+        constant_op.constant(np.array([3, np.nan], dtype=np.float16)))
+    expected = [tensor_id, -1, 19, 1, 2, 0, 0, 0, 0, 0,
+                2, 0, 0, 1, 0, 0, 0, 1, 3, 3, 3, 0]
+    self.assertAllClose(tensor, expected)
+
+  def testDebugNumericSummaryV2OpSamplingPeriod(self):
+
+    @def_function.function
+    def debug_summary(x):
+      return gen_debug_ops.debug_numeric_summary_v2(
+          x,
+          tensor_debug_mode=debug_event_pb2.TensorDebugMode.CONCISE_HEALTH,
+          tensor_id=1,
+          sampling_period=3,
+          output_dtype=dtypes.float64)
+
+    x = constant_op.constant([1.0, np.nan])
+    summaries = [self.evaluate(debug_summary(x)) for _ in range(7)]
+    self.assertAllEqual([summary.size for summary in summaries],
+                        [5, 0, 0, 5, 0, 0, 5])
+    self.assertAllEqual(summaries[3], [1, 2, 0, 0, 1])
+
   def testCheckNumericsV2OpNegativeAndPositiveInf(self):
     """Test that CheckNumericsV2 op distinguishes negative and positive infs."""
     with self.session(graph=ops.Graph()):
@@ -133,7 +133,8 @@ class PreemptionCheckpointTest(test.TestCase, parameterized.TestCase):
                 training_restarted=None,
                 training_finished=None,
                 termination_config=failure_handling.TerminationConfig(),
-                api_wrapping_train=True):
+                api_wrapping_train=True,
+                enable_async_checkpoint=False):
 
     if strategy_option == 'MS':
       strategy = mirrored_strategy.MirroredStrategy()
@@ -175,7 +176,8 @@ class PreemptionCheckpointTest(test.TestCase, parameterized.TestCase):
         preemption_handler = (
             failure_handling.PreemptionCheckpointHandler(
                 strategy.cluster_resolver, checkpoint_or_manager,
-                checkpoint_dir, termination_config))
+                checkpoint_dir, termination_config,
+                enable_async_checkpoint=enable_async_checkpoint))
 
       def distributed_train_step(current_epoch, current_step):
 
@@ -257,9 +259,11 @@ class PreemptionCheckpointTest(test.TestCase, parameterized.TestCase):
               'MWMS_local',
               'MWMS_multi_worker',
           ],
-          api_wrapping_train=[True, False]))
+          api_wrapping_train=[True, False],
+          enable_async_checkpoint=[True, False]))
   def test_preemption_checkpointing(self, input_arg, strategy_option,
-                                    api_wrapping_train):
+                                    api_wrapping_train,
+                                    enable_async_checkpoint):
     has_chief = False
 
     if _is_oss():
@@ -289,7 +293,10 @@ class PreemptionCheckpointTest(test.TestCase, parameterized.TestCase):
           args=(checkpoint_dir, cluster_spec, input_arg, strategy_option,
                 [training_started_event], None, training_restarted,
                 training_finished, termination_config),
-          kwargs={'api_wrapping_train': api_wrapping_train},
+          kwargs={
+              'api_wrapping_train': api_wrapping_train,
+              'enable_async_checkpoint': enable_async_checkpoint
+          },
           rpc_layer=rpc_layer,
           return_output=True,
           dependence_on_chief=has_chief)
@@ -336,7 +343,8 @@ class PreemptionCheckpointTest(test.TestCase, parameterized.TestCase):
       try:
         self.worker_fn(checkpoint_dir, cluster_spec, strategy_option, input_arg,
                        [training_started_event], None, training_restarted,
-                       training_finished)
+                       training_finished,
+                       enable_async_checkpoint=enable_async_checkpoint)
 
       except SystemExit as exit_error:
         caught_exit = True
@@ -352,7 +360,8 @@ class PreemptionCheckpointTest(test.TestCase, parameterized.TestCase):
         training_restarted.set()
         self.worker_fn(checkpoint_dir, cluster_spec, strategy_option, input_arg,
                        [training_started_event], None, training_restarted,
-                       training_finished)
+                       training_finished,
+                       enable_async_checkpoint=enable_async_checkpoint)
 
   def test_error_propagation(self):
     error_worker = random.randint(0, CLUSTER_SIZE)
@@ -908,11 +908,114 @@ def embedding_lookup(params,
                      max_norm=None):
   if isinstance(params, list):
     params = params[0]
+  if (partition_strategy == 'div' and max_norm is None and
+      _is_div_sharded(params.variables)):
+    return _embedding_lookup_by_device(params.variables, ids, name)
   return embedding_ops.embedding_lookup(params.variables, ids,
                                         partition_strategy, name,
                                         validate_indices, max_norm)
 
 
+def _is_div_sharded(variables):
+  """Whether `variables` are the shards of a table with "div" sharding."""
+  if len(variables) < 2:
+    return False
+  sizes = [v.shape[0] for v in variables]
+  if any(size is None for size in sizes):
+    return False
+  base, extra = divmod(sum(sizes), len(variables))
+  return base > 0 and sizes == [base + 1] * extra + [base] * (len(variables) - extra)
+
+
+def _div_assignments(ids, variables):
+  """Returns the shard and the id within the shard of "div" sharded `ids`."""
+  base, extra = divmod(sum(v.shape[0] for v in variables), len(variables))
+  # See `ShardedVariable._decompose_indices`.
+  assignments = math_ops.maximum(ids // (base + 1), (ids - extra) // base)
+  local_ids = array_ops.where(assignments < extra, ids % (base + 1),
+                              (ids - extra) % base)
+  return math_ops.cast(assignments, dtypes.int32), local_ids
+
+
+def _embedding_lookup_by_device(variables, ids, name=None):
+  """Looks up `ids` in "div" sharded `variables`, batched by device.
+
+  The ids are deduplicated, and the ids of all the shards placed on the same
+  device are sent to it as one tensor and gathered and stitched there, so
+  that a lookup exchanges one tensor of ids and one of embeddings with each
+  parameter server instead of with each shard.
+
+  Args:
+    variables: The shards of the table, in order, with "div" sharding.
+    ids: A `Tensor` of int32 or int64 ids of any shape.
+    name: A name for the operation.
+
+  Returns:
+    A `Tensor` of shape `ids.shape + variables[0].shape[1:]`.
+  """
+  devices = []
+  device_shards = []
+  for i, v in enumerate(variables):
+    if v.device not in devices:
+      devices.append(v.device)
+      device_shards.append([])
+    device_shards[devices.index(v.device)].append(i)
+  shard_to_device = [0] * len(variables)
+  for d, shards in enumerate(device_shards):
+    for i in shards:
+      shard_to_device[i] = d
+
+  with ops.name_scope(name, 'embedding_lookup', [ids]):
+    ids = ops.convert_to_tensor(ids, name='ids')
+    unique_ids, idx = array_ops.unique(array_ops.reshape(ids, [-1]))
+    positions = math_ops.range(array_ops.size(unique_ids))
+    assignments, _ = _div_assignments(unique_ids, variables)
+    device_assignments = array_ops.gather(shard_to_device, assignments)
+    per_device_ids = data_flow_ops.dynamic_partition(unique_ids,
+                                                     device_assignments,
+                                                     len(devices))
+    per_device_positions = data_flow_ops.dynamic_partition(
+        positions, device_assignments, len(devices))
+
+    per_device_rows = []
+    for d, shards in enumerate(device_shards):
+      with ops.colocate_with(variables[shards[0]]):
+        shard_assignments, local_ids = _div_assignments(per_device_ids[d],
+                                                        variables)
+        if len(shards) == 1:
+          per_device_rows.append(
+              array_ops.gather(variables[shards[0]], local_ids))
+          continue
+        # Index of each shard among the shards of this device.
+        shard_to_local = [0] * len(variables)
+        for j, i in enumerate(shards):
+          shard_to_local[i] = j
+        local_assignments = array_ops.gather(shard_to_local, shard_assignments)
+        per_shard_ids = data_flow_ops.dynamic_partition(local_ids,
+                                                        local_assignments,
+                                                        len(shards))
+        per_shard_positions = data_flow_ops.dynamic_partition(
+            math_ops.range(array_ops.size(local_ids)), local_assignments,
+            len(shards))
+        per_shard_rows = [
+            array_ops.gather(variables[i], per_shard_ids[j])
+            for j, i in enumerate(shards)
+        ]
+        per_device_rows.append(
+            data_flow_ops.parallel_dynamic_stitch(per_shard_positions,
+                                                  per_shard_rows))
+
+    unique_rows = data_flow_ops.parallel_dynamic_stitch(per_device_positions,
+                                                        per_device_rows)
+    rows = array_ops.gather(unique_rows, idx)
+    ret = array_ops.reshape(
+        rows,
+        array_ops.concat([array_ops.shape(ids),
+                          array_ops.shape(rows)[1:]], 0))
+    ret.set_shape(ids.get_shape().concatenate(variables[0].shape[1:]))
+    return ret
+
+
 # Separately override safe_embedding_lookup_sparse, to avoid conversion of
 # ShardedVariable to tensor.
 @dispatch.dispatch_for_api(embedding_ops.safe_embedding_lookup_sparse)
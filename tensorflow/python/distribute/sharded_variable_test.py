@@ -28,6 +28,7 @@ from tensorflow.python.distribute import sharded_variable
 from tensorflow.python.distribute.cluster_resolver import cluster_resolver as cluster_resolver_lib
 from tensorflow.python.distribute.test_util import get_cluster_def
 from tensorflow.python.distribute.test_util import TestClusterParams
+from tensorflow.python.eager import backprop
 from tensorflow.python.eager import context
 from tensorflow.python.eager import def_function
 from tensorflow.python.framework import constant_op
@@ -568,6 +569,36 @@ class ShardedVariableTest(test.TestCase, parameterized.TestCase):
     self.assertAllClose(sparse_lookup(), [[4., 5.], [9., 10.], [3., 4.]])
     self.assertAllClose(safe_sparse_lookup(), [[1., 2.], [0., 0.], [3., 4.]])
 
+  def test_embedding_lookup_deduplicates_ids(self):
+    v = [
+        variables_lib.Variable([[1., 2.], [3., 4.]]),
+        variables_lib.Variable([[5., 6.], [7., 8.]]),
+        variables_lib.Variable([[9., 10.]])
+    ]
+    sv = sharded_variable.ShardedVariable(v)
+
+    @def_function.function
+    def lookup(ids):
+      return embedding_ops.embedding_lookup_v2(sv, ids)
+
+    ids = constant_op.constant([[4, 0, 4], [3, 0, 1]], dtype=dtypes.int64)
+    self.assertAllEqual(
+        lookup(ids),
+        [[[9., 10.], [1., 2.], [9., 10.]], [[7., 8.], [1., 2.], [3., 4.]]])
+    graph = lookup.get_concrete_function(ids).graph
+    op_types = [op.type for op in graph.get_operations()]
+    self.assertIn('Unique', op_types)
+    self.assertEqual(op_types.count('ResourceGather'), len(v))
+
+    with backprop.GradientTape() as tape:
+      loss = math_ops.reduce_sum(embedding_ops.embedding_lookup_v2(sv, ids))
+    grads = tape.gradient(loss, v)
+    self.assertAllEqual(
+        ops.convert_to_tensor(grads[0]), [[2., 2.], [1., 1.]])
+    self.assertAllEqual(
+        ops.convert_to_tensor(grads[1]), [[0., 0.], [1., 1.]])
+    self.assertAllEqual(ops.convert_to_tensor(grads[2]), [[2., 2.]])
+
   def test_slicing(self):
     v = [
         variables_lib.Variable([[1, 2], [3, 4], [5, 6]]),
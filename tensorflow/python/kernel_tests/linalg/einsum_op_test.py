@@ -105,6 +105,19 @@ class EinsumOpTest(test.TestCase):
     # Based on https://github.com/google/jax/issues/37#issuecomment-448572187
     self._check('sa,shb->shab', (2, 1), (2, 3, 4))
 
+  def testBinarySwappedOperands(self):
+    # The output lists the free dimensions of the second operand first, so the
+    # kernel contracts the operands in the opposite order.
+    self._check('ij,jk->ki', (3, 4), (4, 5))
+    self._check('ji,jk->ki', (4, 3), (4, 5))
+    self._check('ij,kj->ki', (3, 4), (5, 4))
+    self._check('bij,bjk->bki', (2, 3, 4), (2, 4, 5))
+    self._check('abc,cd->dab', (2, 3, 4), (4, 5))
+    self._check('a...c,cd->...da', (2, 3, 4), (4, 5))
+    # Interleaved free dimensions are transposed as before.
+    self._check('abc,cd->adb', (2, 3, 4), (4, 5))
+    self._check('ab,cd->cabd', (2, 3), (4, 5))
+
   def testReducedIndices(self):
     self._check('ba,b->', (3, 2), (3,))
     self._check('ab,ab->', (3, 4), (3, 4))
@@ -347,6 +360,9 @@ class EinsumGradTest(test.TestCase):
     self._check_gradient('abc,bad->abcd', (1, 2, 3), (2, 1, 4))
     # Based on https://github.com/google/jax/issues/37#issuecomment-448572187
     self._check_gradient('sa,shb->shab', (2, 1), (2, 3, 4))
+    # Contracted in the opposite order by the kernel.
+    self._check_gradient('ij,jk->ki', (3, 4), (4, 5))
+    self._check_gradient('bij,bjk->bki', (2, 3, 4), (2, 4, 5))
 
   def testEmpty(self):
     # From Transformer XL.
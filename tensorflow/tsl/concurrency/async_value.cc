@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/tsl/concurrency/async_value.h"
 
 #include <atomic>
+#include <cstddef>
 #include <cstdlib>
 #include <functional>
 #include <utility>
@@ -40,9 +41,9 @@ void* AlignedAlloc(size_t alignment, size_t size) {
   return memalign(alignment, size);
 #else
   // posix_memalign requires that the requested alignment be at least
-  // alignof(void*). In this case, fall back on malloc which should return
-  // memory aligned to at least the size of a pointer.
-  if (alignment <= alignof(void*)) return std::malloc(size);
+  // alignof(void*). malloc returns memory suitably aligned for any fundamental
+  // type, so use it for all alignments up to alignof(std::max_align_t).
+  if (alignment <= alignof(std::max_align_t)) return std::malloc(size);
   void* ptr = nullptr;
   if (posix_memalign(&ptr, alignment, size) != 0)
     return nullptr;
@@ -63,16 +64,148 @@ void AlignedFree(void* ptr) {
 #endif
 }
 
+namespace {
+
+// Async value storage is pooled in size classes of kSizeClassGranularity bytes
+// up to kMaxPooledSize bytes. Pooled blocks are aligned to kPoolAlignment, and
+// are always allocated with the rounded up size class size, so that a block
+// allocated while pooling is disabled can be pooled when it is freed.
+constexpr size_t kSizeClassGranularity = 16;
+constexpr size_t kMaxPooledSize = 256;
+constexpr size_t kNumSizeClasses = kMaxPooledSize / kSizeClassGranularity;
+constexpr size_t kPoolAlignment = alignof(std::max_align_t);
+
+// Upper bound on the number of free blocks cached by a thread per size class.
+// Async values are often produced on one thread and dropped on another, so the
+// dropping thread's free lists can't grow without bounds.
+constexpr size_t kMaxFreeBlocksPerSizeClass = 1024;
+
+std::atomic<bool> async_value_pooling_enabled{false};
+
+bool IsPooledAllocation(size_t size, size_t alignment) {
+  return size <= kMaxPooledSize && alignment <= kPoolAlignment;
+}
+
+size_t SizeClass(size_t size) {
+  return (size + kSizeClassGranularity - 1) / kSizeClassGranularity - 1;
+}
+
+size_t SizeClassSize(size_t size_class) {
+  return (size_class + 1) * kSizeClassGranularity;
+}
+
+// Per-thread free lists of pooled blocks. Free blocks are linked through their
+// first word.
+class FreeLists {
+ public:
+  FreeLists() = default;
+  FreeLists(const FreeLists&) = delete;
+  FreeLists& operator=(const FreeLists&) = delete;
+  ~FreeLists();
+
+  void* Pop(size_t size_class) {
+    FreeBlock* block = heads_[size_class];
+    if (block == nullptr) return nullptr;
+    heads_[size_class] = block->next;
+    --sizes_[size_class];
+    return block;
+  }
+
+  // Returns false if the free list of the size class is full.
+  bool Push(size_t size_class, void* ptr) {
+    if (sizes_[size_class] >= kMaxFreeBlocksPerSizeClass) return false;
+    heads_[size_class] = new (ptr) FreeBlock{heads_[size_class]};
+    ++sizes_[size_class];
+    return true;
+  }
+
+ private:
+  struct FreeBlock {
+    FreeBlock* next;
+  };
+
+  FreeBlock* heads_[kNumSizeClasses] = {};
+  size_t sizes_[kNumSizeClasses] = {};
+};
+
+// Async values can be dropped by destructors of other thread local objects
+// that run after the free lists are destroyed. Such blocks are returned
+// directly to the system allocator.
+thread_local bool free_lists_destroyed = false;
+
+FreeLists::~FreeLists() {
+  free_lists_destroyed = true;
+  for (size_t i = 0; i < kNumSizeClasses; ++i) {
+    while (void* ptr = Pop(i)) AlignedFree(ptr);
+  }
+}
+
+FreeLists* GetFreeLists() {
+  if (free_lists_destroyed) return nullptr;
+  static thread_local FreeLists free_lists;
+  return &free_lists;
+}
+
+}  // namespace
+
+void* AllocateAsyncValueStorage(size_t size, size_t alignment) {
+  if (!IsPooledAllocation(size, alignment)) {
+    return AlignedAlloc(alignment, size);
+  }
+  size_t size_class = SizeClass(size);
+  if (async_value_pooling_enabled.load(std::memory_order_relaxed)) {
+    if (FreeLists* free_lists = GetFreeLists()) {
+      if (void* ptr = free_lists->Pop(size_class)) return ptr;
+    }
+  }
+  return AlignedAlloc(kPoolAlignment, SizeClassSize(size_class));
+}
+
+void FreeAsyncValueStorage(void* ptr, size_t size, size_t alignment) {
+  if (IsPooledAllocation(size, alignment) &&
+      async_value_pooling_enabled.load(std::memory_order_relaxed)) {
+    FreeLists* free_lists = GetFreeLists();
+    if (free_lists && free_lists->Push(SizeClass(size), ptr)) return;
+  }
+  AlignedFree(ptr);
+}
+
 }  // namespace internal
 
+void SetAsyncValuePoolingEnabled(bool enabled) {
+  internal::async_value_pooling_enabled.store(enabled,
+                                              std::memory_order_relaxed);
+}
+
+bool IsAsyncValuePoolingEnabled() {
+  return internal::async_value_pooling_enabled.load(std::memory_order_relaxed);
+}
+
 // This is a singly linked list of nodes waiting for notification, hanging off
 // of AsyncValue.  When the value becomes available or if an error occurs, the
 // callbacks are informed.
+//
+// Nodes are allocated with the async value storage allocator, so with pooling
+// enabled the common case of a single waiter on a value doesn't hit malloc:
+// small callbacks are stored inline in the `absl::AnyInvocable` and the node
+// itself comes from the thread local free list.
 class NotifierListNode {
  public:
   explicit NotifierListNode(absl::AnyInvocable<void()> notification)
       : next_(nullptr), notification_(std::move(notification)) {}
 
+  static NotifierListNode* Create(absl::AnyInvocable<void()> notification) {
+    void* buf = internal::AllocateAsyncValueStorage(sizeof(NotifierListNode),
+                                                    alignof(NotifierListNode));
+    return new (buf) NotifierListNode(std::move(notification));
+  }
+
+  static void Delete(NotifierListNode* node) {
+    node->~NotifierListNode();
+    internal::FreeAsyncValueStorage(node, sizeof(NotifierListNode),
+                                    alignof(NotifierListNode));
+  }
+
  private:
   friend class AsyncValue;
   // This is the next thing waiting on the AsyncValue.
@@ -131,7 +264,7 @@ void AsyncValue::RunWaiters(NotifierListNode* list) {
     // check atomic state again.
     node->notification_();
     list = node->next_;
-    delete node;
+    NotifierListNode::Delete(node);
   }
 }
 
@@ -141,7 +274,7 @@ void AsyncValue::RunWaiters(NotifierListNode* list) {
 void AsyncValue::EnqueueWaiter(absl::AnyInvocable<void()> waiter,
                                WaitersAndState old_value) {
   // Create the node for our waiter.
-  auto* node = new NotifierListNode(std::move(waiter));
+  auto* node = NotifierListNode::Create(std::move(waiter));
   auto old_state = old_value.state();
 
   // Swap the next link in. old_value.state() must be unavailable when
@@ -160,7 +293,7 @@ void AsyncValue::EnqueueWaiter(absl::AnyInvocable<void()> waiter,
         old_value.state() == State::kError) {
       assert(old_value.waiter() == nullptr);
       node->notification_();
-      delete node;
+      NotifierListNode::Delete(node);
       return;
     }
     // Update the waiter list in new_value.
@@ -50,8 +50,26 @@ constexpr bool kMaybeBase = std::is_class<T>::value && !std::is_final<T>::value;
 void* AlignedAlloc(size_t alignment, size_t size);
 void AlignedFree(void* ptr);
 
+// Allocates storage for a reference-counted async value or for a waiter list
+// node. Small allocations are rounded up to a size class, and when async value
+// pooling is enabled they are served from a thread local free list.
+void* AllocateAsyncValueStorage(size_t size, size_t alignment);
+
+// Releases storage returned by `AllocateAsyncValueStorage` for the same size
+// and alignment. When async value pooling is enabled small blocks are kept in
+// the calling thread's free list for reuse.
+void FreeAsyncValueStorage(void* ptr, size_t size, size_t alignment);
+
 }  // namespace internal
 
+// Enables or disables pooled allocation of reference-counted async values and
+// waiter list nodes. Pooling is disabled by default. Runtimes that create and
+// drop many small async values (chains, scalars) can enable it at startup to
+// avoid a malloc/free pair per value. It is safe to toggle at any time: blocks
+// allocated with pooling disabled can be pooled later and vice versa.
+void SetAsyncValuePoolingEnabled(bool enabled);
+bool IsAsyncValuePoolingEnabled();
+
 // This is a future of the specified value type. Arbitrary C++ types may be used
 // here, even non-copyable types and expensive ones like tensors.
 //
@@ -410,6 +428,8 @@ class AsyncValue {
     GetErrorFn get_error;
     SetErrorFn set_error;
     HasDataFn has_data;
+    // Alignment of the derived AsyncValue, needed to deallocate it.
+    size_t alignment;
   };
 
   template <typename Derived>
@@ -428,6 +448,7 @@ class AsyncValue {
         [](const AsyncValue* v) {
           return static_cast<const Derived*>(v)->HasData();
         },
+        alignof(Derived),
     };
   }
 
@@ -968,12 +989,20 @@ inline void AsyncValue::Destroy() {
     // explicit check and instead make ~IndirectAsyncValue go through the
     // GetTypeInfo().destructor case below.
     static_cast<IndirectAsyncValue*>(this)->~IndirectAsyncValue();
-    if (was_ref_counted) internal::AlignedFree(this);
+    if (was_ref_counted) {
+      internal::FreeAsyncValueStorage(this, sizeof(IndirectAsyncValue),
+                                      alignof(IndirectAsyncValue));
+    }
     return;
   }
 
-  GetTypeInfo().destructor(this);
-  if (was_ref_counted) internal::AlignedFree(this);
+  // Look up the type info before running the destructor, which resets the
+  // type id.
+  const TypeInfo& type_info = GetTypeInfo();
+  size_t size = type_info.destructor(this);
+  if (was_ref_counted) {
+    internal::FreeAsyncValueStorage(this, size, type_info.alignment);
+  }
 }
 
 }  // namespace tsl
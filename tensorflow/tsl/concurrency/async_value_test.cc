@@ -15,11 +15,14 @@ limitations under the License.
 
 #include "tensorflow/tsl/concurrency/async_value.h"
 
+#include <cstdint>
 #include <memory>
 #include <utility>
 
 #include "tensorflow/tsl/concurrency/async_value_ref.h"
+#include "tensorflow/tsl/concurrency/chain.h"
 #include "tensorflow/tsl/platform/test.h"
+#include "tensorflow/tsl/platform/test_benchmark.h"
 
 namespace tsl {
 
@@ -179,4 +182,85 @@ TEST(AsyncValueTest, StackAllocatedAsyncValue) {
   EXPECT_EQ(2, counter);
 }
 
+TEST(AsyncValueTest, PooledAllocationReusesStorage) {
+  SetAsyncValuePoolingEnabled(true);
+
+  AsyncValue* value = MakeAvailableAsyncValueRef<int32_t>(1).release();
+  value->DropRef();
+
+  // The next value of the same size class is allocated from the thread local
+  // free list.
+  AsyncValueRef<int32_t> reused = MakeAvailableAsyncValueRef<int32_t>(2);
+  EXPECT_EQ(reused.GetAsyncValue(), value);
+  EXPECT_EQ(2, reused.get());
+
+  SetAsyncValuePoolingEnabled(false);
+}
+
+TEST(AsyncValueTest, PooledAllocationWithWaiters) {
+  SetAsyncValuePoolingEnabled(true);
+
+  for (int i = 0; i < 100; ++i) {
+    AsyncValueRef<int32_t> value = MakeConstructedAsyncValueRef<int32_t>(i);
+    AsyncValueRef<Chain> chain = MakeUnconstructedAsyncValueRef<Chain>();
+    RCReference<IndirectAsyncValue> indirect = MakeIndirectAsyncValue();
+
+    int32_t num_notified = 0;
+    for (int j = 0; j < i % 3; ++j) {
+      value.AndThen([&] { ++num_notified; });
+      chain.AndThen([&] { ++num_notified; });
+      indirect->AndThen([&] { ++num_notified; });
+    }
+
+    value.SetStateConcrete();
+    chain.emplace();
+    indirect->ForwardTo(value.CopyRCRef());
+
+    EXPECT_EQ(3 * (i % 3), num_notified);
+    EXPECT_EQ(i, indirect->get<int32_t>());
+  }
+
+  // Values allocated while pooling was enabled can be freed after it was
+  // disabled and vice versa.
+  AsyncValueRef<int32_t> pooled = MakeAvailableAsyncValueRef<int32_t>(1);
+  SetAsyncValuePoolingEnabled(false);
+  AsyncValueRef<int32_t> unpooled = MakeAvailableAsyncValueRef<int32_t>(2);
+  pooled.reset();
+  SetAsyncValuePoolingEnabled(true);
+  unpooled.reset();
+  SetAsyncValuePoolingEnabled(false);
+}
+
+//===----------------------------------------------------------------------===//
+// Performance benchmarks below
+//===----------------------------------------------------------------------===//
+
+// Allocates and drops an available async value, with pooling disabled (0) and
+// enabled (1).
+void BM_MakeAvailableAsyncValueRef(::testing::benchmark::State& state) {
+  SetAsyncValuePoolingEnabled(state.range(0));
+  for (auto _ : state) {
+    AsyncValueRef<int32_t> value = MakeAvailableAsyncValueRef<int32_t>(42);
+    testing::DoNotOptimize(value);
+  }
+  SetAsyncValuePoolingEnabled(false);
+}
+
+// Allocates an unavailable chain, adds a single waiter and makes it available,
+// with pooling disabled (0) and enabled (1).
+void BM_ChainWithSingleWaiter(::testing::benchmark::State& state) {
+  SetAsyncValuePoolingEnabled(state.range(0));
+  int64_t num_notified = 0;
+  for (auto _ : state) {
+    AsyncValueRef<Chain> chain = MakeConstructedAsyncValueRef<Chain>();
+    chain.AndThen([&] { ++num_notified; });
+    chain.SetStateConcrete();
+  }
+  testing::DoNotOptimize(num_notified);
+  SetAsyncValuePoolingEnabled(false);
+}
+
+BENCHMARK(BM_MakeAvailableAsyncValueRef)->Arg(0)->Arg(1);
+BENCHMARK(BM_ChainWithSingleWaiter)->Arg(0)->Arg(1);
+
 }  // namespace tsl
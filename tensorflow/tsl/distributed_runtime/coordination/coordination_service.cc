@@ -54,6 +54,7 @@ using tensorflow::CoordinatedTaskStateInfo;
 using tensorflow::CoordinationServiceConfig;
 using tensorflow::CoordinationServiceError;
 using tensorflow::DeviceInfo;
+using tensorflow::HeartbeatRequest;
 using tensorflow::KeyValueEntry;
 
 constexpr absl::Duration kDevicePropagationTimeout = absl::Hours(1);
@@ -113,6 +114,8 @@ class CoordinationServiceStandaloneImpl : public CoordinationServiceInterface {
   Status ResetTask(const CoordinatedTask& task) override;
   Status RecordHeartbeat(const CoordinatedTask& task,
                          uint64_t incarnation) override;
+  void RecordForwardedHeartbeats(
+      const protobuf::RepeatedPtrField<HeartbeatRequest>& heartbeats) override;
   Status ReportTaskError(const CoordinatedTask& task, Status error) override;
   std::vector<CoordinatedTaskStateInfo> GetTaskState(
       const std::vector<CoordinatedTask>& task) override;
@@ -149,6 +152,18 @@ class CoordinationServiceStandaloneImpl : public CoordinationServiceInterface {
   void SetTaskError(absl::string_view task_name, Status error)
       TF_EXCLUSIVE_LOCKS_REQUIRED(state_mu_);
   void AggregateClusterDevices() TF_EXCLUSIVE_LOCKS_REQUIRED(state_mu_);
+  // Returns the position of `task` in the per-task arrays, or -1 if the task
+  // is not in the cluster or the service has stopped.
+  int GetTaskIndex(const CoordinatedTask& task)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(state_mu_);
+  // Validates a heartbeat of `task` and updates its timestamp to `now_us`.
+  // Returns the error to reply to the heartbeat with. `task_failed` is set if
+  // the heartbeat put the task in error state, in which case the caller must
+  // propagate the error once `state_mu_` is released.
+  Status RecordHeartbeatLocked(const CoordinatedTask& task,
+                               uint64_t incarnation, uint64_t now_us,
+                               bool* task_failed)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(state_mu_);
   Status DisconnectTask(const CoordinatedTask& task)
       TF_EXCLUSIVE_LOCKS_REQUIRED(state_mu_);
 
@@ -192,7 +207,7 @@ class CoordinationServiceStandaloneImpl : public CoordinationServiceInterface {
     uint64_t GetTaskIncarnation() { return task_incarnation_; }
     void SetConnected(uint64_t task_incarnation);
     void Disconnect(uint64_t grace_period_duration_us);
-    Status RecordHeartbeat(uint64_t task_incarnation);
+    Status RecordHeartbeat(uint64_t task_incarnation, uint64_t now_us);
     int64_t TimeSinceLastHeartbeatMs();
     // This denotes the deadline after which we stop accepting heartbeats from a
     // disconnected task. This grace period accounts for the lag time between
@@ -247,6 +262,19 @@ class CoordinationServiceStandaloneImpl : public CoordinationServiceInterface {
   mutex state_mu_;
   absl::flat_hash_map<std::string, std::unique_ptr<TaskState>> cluster_state_
       TF_GUARDED_BY(state_mu_);
+  // Compact view of `cluster_state_` for the hot paths (heartbeats and the
+  // staleness check), which would otherwise build and hash a task name per
+  // task. Tasks are laid out in the order of `coordinated_job_list`; task
+  // `task_id` of a job is at `job_ranges_[job_name].offset + task_id`.
+  // `job_ranges_` and `task_names_` are immutable after construction.
+  struct JobRange {
+    int offset;
+    int num_tasks;
+  };
+  absl::flat_hash_map<std::string, JobRange> job_ranges_;
+  std::vector<std::string> task_names_;
+  // Owned by `cluster_state_`. Cleared with it when the service stops.
+  std::vector<TaskState*> task_states_ TF_GUARDED_BY(state_mu_);
   DeviceInfo cluster_devices_ TF_GUARDED_BY(state_mu_);
 
   mutex kv_mu_;
@@ -297,7 +325,7 @@ void CoordinationServiceStandaloneImpl::TaskState::SetError(
 }
 
 Status CoordinationServiceStandaloneImpl::TaskState::RecordHeartbeat(
-    uint64_t task_incarnation) {
+    uint64_t task_incarnation, uint64_t now_us) {
   if (!status_.ok()) return status_;
   if (task_incarnation != task_incarnation_) {
     return MakeCoordinationError(errors::Aborted(
@@ -305,7 +333,7 @@ Status CoordinationServiceStandaloneImpl::TaskState::RecordHeartbeat(
         task_incarnation, ". This means the remote task has restarted."));
   }
   mutex_lock l(last_heartbeat_mu_);
-  last_heartbeat_us_ = Env::Default()->NowMicros();
+  last_heartbeat_us_ = now_us;
   return OkStatus();
 }
 
@@ -358,9 +386,18 @@ CoordinationServiceStandaloneImpl::CoordinationServiceStandaloneImpl(
   recoverable_jobs_ = absl::flat_hash_set<std::string>(
       config.recoverable_jobs().cbegin(), config.recoverable_jobs().cend());
   for (const auto& job : config.coordinated_job_list()) {
+    const bool inserted =
+        job_ranges_
+            .emplace(job.name(), JobRange{static_cast<int>(task_names_.size()),
+                                          job.num_tasks()})
+            .second;
+    if (!inserted) continue;
     for (int i = 0; i < job.num_tasks(); ++i) {
       const std::string task_name = GetTaskName(job.name(), i);
-      cluster_state_.emplace(task_name, std::make_unique<TaskState>());
+      auto task_state = std::make_unique<TaskState>();
+      task_names_.push_back(task_name);
+      task_states_.push_back(task_state.get());
+      cluster_state_.emplace(task_name, std::move(task_state));
     }
   }
   StartCheckStaleness();
@@ -387,12 +424,14 @@ void CoordinationServiceStandaloneImpl::StartCheckStaleness() {
           Status status = OkStatus();
           {
             mutex_lock l(state_mu_);
-            for (const auto& [task_name, task_state] : cluster_state_) {
+            for (size_t i = 0; i < task_states_.size(); ++i) {
+              TaskState* task_state = task_states_[i];
               // Skip tasks that are not registered or in error state
               if (task_state->GetState() !=
                   CoordinatedTaskState::TASKSTATE_CONNECTED) {
                 continue;
               }
+              const std::string& task_name = task_names_[i];
               const bool is_stale = task_state->TimeSinceLastHeartbeatMs() >
                                     heartbeat_timeout_ms_;
               VLOG(10) << "Checking staleness for " << task_name
@@ -505,6 +544,7 @@ void CoordinationServiceStandaloneImpl::Stop(bool shut_staleness_thread) {
     barriers_.clear();
     // Cluster state is used in `PassBarrier` and it needs to be cleared after
     // it.
+    task_states_.clear();
     cluster_state_.clear();
   }
   {
@@ -709,48 +749,105 @@ CoordinationServiceStandaloneImpl::GetTaskState(
   return states_info;
 }
 
+int CoordinationServiceStandaloneImpl::GetTaskIndex(
+    const CoordinatedTask& task) {
+  auto it = job_ranges_.find(task.job_name());
+  if (it == job_ranges_.end() || task.task_id() < 0 ||
+      task.task_id() >= it->second.num_tasks) {
+    return -1;
+  }
+  const int index = it->second.offset + task.task_id();
+  return index < static_cast<int>(task_states_.size()) ? index : -1;
+}
+
+Status CoordinationServiceStandaloneImpl::RecordHeartbeatLocked(
+    const CoordinatedTask& task, uint64_t incarnation, uint64_t now_us,
+    bool* task_failed) {
+  *task_failed = false;
+  const int index = GetTaskIndex(task);
+  if (index < 0) {
+    return MakeCoordinationError(errors::InvalidArgument(
+        "Unexpected heartbeat request from task: ", GetTaskName(task),
+        ". This usually implies an earlier error that caused coordination "
+        "service to shut down before the workers disconnect. Check the task "
+        "leader's logs for an earlier error to debug the root cause."));
+  }
+  TaskState* task_state = task_states_[index];
+  if (!task_state->GetStatus().ok()) {
+    return task_state->GetStatus();
+  } else if (task_state->GetState() ==
+                 CoordinatedTaskState::TASKSTATE_DISCONNECTED &&
+             // We accept heartbeats for a short grace period to account for
+             // the lag time between the service recording the state change
+             // and the agent stopping heartbeats.
+             now_us > task_state->GetDisconnectedGracePeriodMicros()) {
+    return MakeCoordinationError(errors::InvalidArgument(
+        "Task with task_name=", task_names_[index],
+        " must be registered before sending heartbeat messages"));
+  }
+  Status s = task_state->RecordHeartbeat(incarnation, now_us);
+  if (!s.ok()) {
+    SetTaskError(task_names_[index], s);
+    *task_failed = true;
+  }
+  return s;
+}
+
 Status CoordinationServiceStandaloneImpl::RecordHeartbeat(
     const CoordinatedTask& task, uint64_t incarnation) {
-  const std::string& task_name = GetTaskName(task);
-  Status s = OkStatus();
+  Status s;
+  bool task_failed = false;
   {
     mutex_lock l(state_mu_);
-    if (!cluster_state_.contains(task_name)) {
-      return MakeCoordinationError(errors::InvalidArgument(
-          "Unexpected heartbeat request from task: ", task_name,
-          ". This usually implies an earlier error that caused coordination "
-          "service to shut down before the workers disconnect. Check the task "
-          "leader's logs for an earlier error to debug the root cause."));
-    }
-    if (!cluster_state_[task_name]->GetStatus().ok()) {
-      return cluster_state_[task_name]->GetStatus();
-    } else if (cluster_state_[task_name]->GetState() ==
-                   CoordinatedTaskState::TASKSTATE_DISCONNECTED &&
-               // We accept heartbeats for a short grace period to account for
-               // the lag time between the service recording the state change
-               // and the agent stopping heartbeats.
-               Env::Default()->NowMicros() >
-                   cluster_state_[task_name]
-                       ->GetDisconnectedGracePeriodMicros()) {
-      return MakeCoordinationError(errors::InvalidArgument(
-          "Task with task_name=", task_name,
-          " must be registered before sending heartbeat messages"));
-    }
-    s = cluster_state_[task_name]->RecordHeartbeat(incarnation);
+    s = RecordHeartbeatLocked(task, incarnation, Env::Default()->NowMicros(),
+                              &task_failed);
   }
 
-  // Set and propagate any heartbeat errors.
-  if (!s.ok()) {
-    {
-      mutex_lock l(state_mu_);
-      SetTaskError(task_name, s);
-    }
+  // Propagate any heartbeat errors.
+  if (task_failed) {
     PropagateError(task);
   }
 
   return s;
 }
 
+void CoordinationServiceStandaloneImpl::RecordForwardedHeartbeats(
+    const protobuf::RepeatedPtrField<HeartbeatRequest>& heartbeats) {
+  std::vector<const CoordinatedTask*> failed_tasks;
+  std::vector<std::pair<const CoordinatedTask*, Status>> rejected_heartbeats;
+  {
+    mutex_lock l(state_mu_);
+    const uint64_t now_us = Env::Default()->NowMicros();
+    for (const HeartbeatRequest& heartbeat : heartbeats) {
+      bool task_failed = false;
+      Status s = RecordHeartbeatLocked(heartbeat.source_task(),
+                                       heartbeat.incarnation(), now_us,
+                                       &task_failed);
+      if (task_failed) {
+        failed_tasks.push_back(&heartbeat.source_task());
+        continue;
+      }
+      if (s.ok()) continue;
+      // A directly connected task would learn from the heartbeat response
+      // that it is not registered anymore; tell forwarded tasks explicitly.
+      // Tasks in error state have already been notified.
+      const int index = GetTaskIndex(heartbeat.source_task());
+      if (index >= 0 && task_states_[index]->GetState() ==
+                            CoordinatedTaskState::TASKSTATE_DISCONNECTED) {
+        rejected_heartbeats.emplace_back(&heartbeat.source_task(), s);
+      } else {
+        VLOG(1) << "Dropping forwarded heartbeat: " << s;
+      }
+    }
+  }
+  for (const CoordinatedTask* task : failed_tasks) {
+    PropagateError(*task);
+  }
+  for (const auto& [task, error] : rejected_heartbeats) {
+    ReportServiceErrorToTaskAsync(*task, error);
+  }
+}
+
 void CoordinationServiceStandaloneImpl::ReportServiceErrorToTaskAsync(
     const CoordinatedTask& destination_task, Status error) {
   assert(!error.ok());
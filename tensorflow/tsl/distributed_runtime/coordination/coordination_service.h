@@ -26,6 +26,7 @@ limitations under the License.
 #include "absl/strings/string_view.h"
 #include "absl/time/time.h"
 #include "tensorflow/tsl/distributed_runtime/coordination/coordination_client.h"
+#include "tensorflow/tsl/platform/protobuf.h"
 #include "tensorflow/tsl/platform/status.h"
 #include "tensorflow/tsl/platform/statusor.h"
 #include "tensorflow/tsl/protobuf/coordination_config.pb.h"
@@ -148,6 +149,15 @@ class CoordinationServiceInterface {
   virtual Status RecordHeartbeat(const tensorflow::CoordinatedTask& task,
                                  uint64_t incarnation) = 0;
 
+  // Update the heartbeat timestamps of the tasks whose heartbeats were batched
+  // by a task of the heartbeat aggregation tree. The heartbeats are recorded
+  // under a single lock. An error in one heartbeat puts its task in error
+  // state and propagates the error as in RecordHeartbeat(), without affecting
+  // the other heartbeats.
+  virtual void RecordForwardedHeartbeats(
+      const protobuf::RepeatedPtrField<tensorflow::HeartbeatRequest>&
+          heartbeats) = 0;
+
   // Set a task in error state permanently.
   virtual Status ReportTaskError(const tensorflow::CoordinatedTask& task,
                                  Status error) = 0;
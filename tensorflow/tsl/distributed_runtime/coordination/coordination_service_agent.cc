@@ -25,6 +25,7 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/strings/str_cat.h"
@@ -51,6 +52,7 @@ using tensorflow::CoordinatedTaskState;
 using tensorflow::CoordinatedTaskStateInfo;
 using tensorflow::CoordinationServiceConfig;
 using tensorflow::DeviceInfo;
+using tensorflow::HeartbeatRequest;
 using tensorflow::KeyValueEntry;
 
 namespace {
@@ -63,6 +65,34 @@ constexpr absl::Duration kDefaultHeartbeatTimeout = absl::Seconds(10);
 constexpr absl::Duration kDefaultShutdownTimeout = absl::Seconds(10);
 constexpr char kHeartbeatThread[] = "CoordinationServiceHeartbeatLoop";
 
+// Returns the position of `task` in the heartbeat aggregation tree, i.e. among
+// the tasks of `coordinated_job_list`, or -1 if it is not listed. Sets
+// `num_tasks` to the number of tasks in the tree.
+int GetHeartbeatTreePosition(const CoordinationServiceConfig& config,
+                             const CoordinatedTask& task, int* num_tasks) {
+  int position = -1;
+  *num_tasks = 0;
+  for (const auto& job : config.coordinated_job_list()) {
+    if (job.name() == task.job_name() && task.task_id() >= 0 &&
+        task.task_id() < job.num_tasks()) {
+      position = *num_tasks + task.task_id();
+    }
+    *num_tasks += job.num_tasks();
+  }
+  return position;
+}
+
+// Returns true if other tasks send their heartbeats through `task`.
+bool HasHeartbeatChildren(const CoordinationServiceConfig& config,
+                          const CoordinatedTask& task) {
+  const int fanout = config.heartbeat_aggregation_fanout();
+  if (fanout <= 0) return false;
+  int num_tasks;
+  const int position = GetHeartbeatTreePosition(config, task, &num_tasks);
+  return position >= 0 &&
+         static_cast<int64_t>(position + 1) * fanout < num_tasks;
+}
+
 class CoordinationServiceAgentImpl : public CoordinationServiceAgent {
  public:
   CoordinationServiceAgentImpl() = default;
@@ -78,6 +108,8 @@ class CoordinationServiceAgentImpl : public CoordinationServiceAgent {
                     const CoordinationServiceConfig& configs,
                     std::unique_ptr<CoordinationClient> leader_client,
                     StatusCallback error_fn) override;
+  Status SetHeartbeatParentClient(
+      std::unique_ptr<CoordinationClient> parent_client) override;
   bool IsInitialized() override;
   bool IsConnected() override;
   bool IsError() override;
@@ -126,6 +158,8 @@ class CoordinationServiceAgentImpl : public CoordinationServiceAgent {
   void SetError(const Status& error) override;
   Status ActivateWatch(const std::string& key,
                        const std::map<std::string, std::string>&) override;
+  StatusOr<uint64_t> AggregateHeartbeat(
+      const HeartbeatRequest& request) override;
   // Returns an error if agent is not running. If `allow_disconnected` is true,
   // returns OK even if the agent is in DISCONNECTED state.
   Status ValidateRunningAgent(bool allow_disconnected = false);
@@ -158,6 +192,13 @@ class CoordinationServiceAgentImpl : public CoordinationServiceAgent {
   // GetKeyValueAsync() callbacks.
   CancellationManager cancellation_manager_;
   std::unique_ptr<CoordinationClient> leader_client_;
+  // Parent in the heartbeat aggregation tree, if any.
+  std::unique_ptr<CoordinationClient> heartbeat_parent_client_;
+  // Latest incarnation of each task of the subtree whose heartbeat has been
+  // received since the last heartbeat of this task, keyed by (job, task id).
+  mutex forwarded_heartbeats_mu_;
+  absl::flat_hash_map<std::pair<std::string, int>, uint64_t>
+      forwarded_heartbeats_ TF_GUARDED_BY(forwarded_heartbeats_mu_);
 
   TF_DISALLOW_COPY_AND_ASSIGN(CoordinationServiceAgentImpl);
 };
@@ -202,6 +243,18 @@ Status CoordinationServiceAgentImpl::Initialize(
   return OkStatus();
 }
 
+Status CoordinationServiceAgentImpl::SetHeartbeatParentClient(
+    std::unique_ptr<CoordinationClient> parent_client) {
+  mutex_lock l(state_mu_);
+  if (state_ != CoordinatedTaskState::TASKSTATE_DISCONNECTED) {
+    return MakeCoordinationError(errors::FailedPrecondition(
+        "The heartbeat parent must be set after initializing the coordination "
+        "service agent and before connecting it."));
+  }
+  heartbeat_parent_client_ = std::move(parent_client);
+  return OkStatus();
+}
+
 bool CoordinationServiceAgentImpl::IsInitialized() {
   mutex_lock l(state_mu_);
   return state_ != CoordinatedTaskState::TASKSTATE_UNINITIALIZED;
@@ -307,22 +360,55 @@ Status CoordinationServiceAgentImpl::Connect() {
             configs_.heartbeat_timeout_in_ms() > 0
                 ? configs_.heartbeat_timeout_in_ms() / 2
                 : absl::ToInt64Milliseconds(kDefaultHeartbeatTimeout) / 2;
+        // Forwarding delays the heartbeats of the subtree, which the leader
+        // could then see late enough to consider the tasks stale. Tasks that
+        // aggregate heartbeats send them more often to keep the delay small.
+        const int64_t send_interval_ms =
+            HasHeartbeatChildren(configs_, task_)
+                ? std::max<int64_t>(heartbeat_interval_ms / 4, 1)
+                : heartbeat_interval_ms;
         CallOptions call_opts;
         call_opts.SetTimeout(heartbeat_interval_ms);
-
-        while (true) {
+        auto send_heartbeat = [&](CoordinationClient* client) {
           Status status;
           absl::Notification n;
           // Heartbeat RPC implementation automatically retries to tolerate
           // transient network failures.
           VLOG(10) << "HeartbeatRequest: " << request.DebugString();
-          leader_client_->HeartbeatAsync(&call_opts, &request, &response,
-                                         [&](Status s) {
-                                           status = s;
-                                           n.Notify();
-                                         });
+          client->HeartbeatAsync(&call_opts, &request, &response,
+                                 [&](Status s) {
+                                   status = s;
+                                   n.Notify();
+                                 });
           n.WaitForNotification();
           VLOG(10) << "HeartbeatResponse: " << status;
+          return status;
+        };
+
+        while (true) {
+          {
+            mutex_lock l(forwarded_heartbeats_mu_);
+            request.clear_forwarded_heartbeats();
+            for (const auto& [task, incarnation] : forwarded_heartbeats_) {
+              HeartbeatRequest* forwarded = request.add_forwarded_heartbeats();
+              forwarded->mutable_source_task()->set_job_name(task.first);
+              forwarded->mutable_source_task()->set_task_id(task.second);
+              forwarded->set_incarnation(incarnation);
+            }
+            forwarded_heartbeats_.clear();
+          }
+          Status status;
+          if (heartbeat_parent_client_ != nullptr) {
+            status = send_heartbeat(heartbeat_parent_client_.get());
+            if (!status.ok()) {
+              VLOG(1) << "Heartbeat parent did not take the heartbeat, "
+                         "sending it to the leader instead: "
+                      << status;
+            }
+          }
+          if (heartbeat_parent_client_ == nullptr || !status.ok()) {
+            status = send_heartbeat(leader_client_.get());
+          }
           {
             mutex_lock l(heartbeat_thread_shutdown_mu_);
             // Ignore heartbeat errors and exit thread if shutting down. For
@@ -344,7 +430,7 @@ Status CoordinationServiceAgentImpl::Connect() {
           {
             mutex_lock l(heartbeat_thread_shutdown_mu_);
             heartbeat_thread_cv_.wait_for(
-                l, std::chrono::milliseconds(heartbeat_interval_ms));
+                l, std::chrono::milliseconds(send_interval_ms));
             if (shutting_down_) {
               return;
             }
@@ -864,6 +950,28 @@ Status CoordinationServiceAgentImpl::ValidateRunningAgent(
   }
 }
 
+StatusOr<uint64_t> CoordinationServiceAgentImpl::AggregateHeartbeat(
+    const HeartbeatRequest& request) {
+  {
+    mutex_lock l(state_mu_);
+    if (state_ != CoordinatedTaskState::TASKSTATE_CONNECTED) {
+      return MakeCoordinationError(errors::FailedPrecondition(absl::StrCat(
+          "Heartbeat parent is not in CONNECTED state. Current state: ",
+          state_)));
+    }
+  }
+  mutex_lock l(forwarded_heartbeats_mu_);
+  const CoordinatedTask& source_task = request.source_task();
+  forwarded_heartbeats_[{source_task.job_name(), source_task.task_id()}] =
+      request.incarnation();
+  for (const HeartbeatRequest& forwarded : request.forwarded_heartbeats()) {
+    forwarded_heartbeats_[{forwarded.source_task().job_name(),
+                           forwarded.source_task().task_id()}] =
+        forwarded.incarnation();
+  }
+  return leader_incarnation_;
+}
+
 StatusOr<Env*> CoordinationServiceAgentImpl::GetEnv() {
   if (!IsInitialized()) {
     return MakeCoordinationError(errors::FailedPrecondition(
@@ -883,4 +991,25 @@ std::unique_ptr<CoordinationServiceAgent> CreateCoordinationServiceAgent() {
   return std::make_unique<CoordinationServiceAgentImpl>();
 }
 
+std::optional<CoordinatedTask> GetHeartbeatParent(
+    const CoordinationServiceConfig& config, const CoordinatedTask& task) {
+  const int fanout = config.heartbeat_aggregation_fanout();
+  if (fanout <= 0) return std::nullopt;
+  int num_tasks;
+  const int position = GetHeartbeatTreePosition(config, task, &num_tasks);
+  // Unlisted tasks and the first `fanout` tasks report to the leader.
+  if (position < fanout) return std::nullopt;
+  int parent_position = position / fanout - 1;
+  for (const auto& job : config.coordinated_job_list()) {
+    if (parent_position < job.num_tasks()) {
+      CoordinatedTask parent;
+      parent.set_job_name(job.name());
+      parent.set_task_id(parent_position);
+      return parent;
+    }
+    parent_position -= job.num_tasks();
+  }
+  return std::nullopt;
+}
+
 }  // namespace tsl
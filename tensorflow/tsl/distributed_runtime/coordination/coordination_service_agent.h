@@ -19,6 +19,7 @@ limitations under the License.
 #include <functional>
 #include <map>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
@@ -85,6 +86,16 @@ class CoordinationServiceAgent {
       std::unique_ptr<CoordinationClient> leader_client,
       StatusCallback error_fn) = 0;
 
+  // Sends heartbeats to `parent_client` instead of the service leader, to be
+  // batched into the heartbeats of the parent of this task in the heartbeat
+  // aggregation tree (see GetHeartbeatParent()). Heartbeats that the parent
+  // cannot take are sent to the leader directly. Must be called before
+  // Connect().
+  // Possible errors:
+  //   - FailedPrecondition: Agent is not in DISCONNECTED state.
+  virtual Status SetHeartbeatParentClient(
+      std::unique_ptr<CoordinationClient> parent_client) = 0;
+
   // Return true if the coordination service agent has been initialized.
   virtual bool IsInitialized() = 0;
 
@@ -271,12 +282,27 @@ class CoordinationServiceAgent {
   virtual Status ActivateWatch(const std::string& key,
                                const std::map<std::string, std::string>&) = 0;
 
+  // Buffers the heartbeat of a child task in the heartbeat aggregation tree,
+  // along with the heartbeats that it forwards, to be sent with the next
+  // heartbeat of this task. Returns the incarnation of the service leader.
+  // Possible errors:
+  //   - FailedPrecondition: Agent is not in CONNECTED state.
+  virtual StatusOr<uint64_t> AggregateHeartbeat(
+      const tensorflow::HeartbeatRequest& request) = 0;
+
  private:
   friend class CoordinationServiceRpcHandler;
 };
 
 std::unique_ptr<CoordinationServiceAgent> CreateCoordinationServiceAgent();
 
+// Returns the task that batches the heartbeats of `task` when
+// `heartbeat_aggregation_fanout` is set in `config`, or std::nullopt if `task`
+// sends its heartbeats to the service leader directly.
+std::optional<tensorflow::CoordinatedTask> GetHeartbeatParent(
+    const tensorflow::CoordinationServiceConfig& config,
+    const tensorflow::CoordinatedTask& task);
+
 }  // namespace tsl
 
 #endif  // TENSORFLOW_TSL_DISTRIBUTED_RUNTIME_COORDINATION_COORDINATION_SERVICE_AGENT_H_
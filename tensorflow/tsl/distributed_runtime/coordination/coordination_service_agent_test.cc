@@ -497,5 +497,41 @@ TEST_F(CoordinationServiceAgentTest, Connect_InternalErrorShouldBeRetried) {
   TF_EXPECT_OK(agent_->Connect());
 }
 
+TEST(CoordinationServiceAgentHeartbeatTreeTest, GetHeartbeatParent) {
+  CoordinationServiceConfig config;
+  tensorflow::CoordinatedJob* chief = config.add_coordinated_job_list();
+  chief->set_name("chief");
+  chief->set_num_tasks(1);
+  tensorflow::CoordinatedJob* worker = config.add_coordinated_job_list();
+  worker->set_name("worker");
+  worker->set_num_tasks(8);
+  auto task = [](const std::string& job, int id) {
+    CoordinatedTask task;
+    task.set_job_name(job);
+    task.set_task_id(id);
+    return task;
+  };
+
+  // Without fanout, every task reports to the leader.
+  EXPECT_FALSE(GetHeartbeatParent(config, task("worker", 7)).has_value());
+
+  // Positions: chief:0 -> 0, worker:i -> i + 1. With fanout 2, positions 0
+  // and 1 report to the leader, and position p >= 2 to p / 2 - 1.
+  config.set_heartbeat_aggregation_fanout(2);
+  EXPECT_FALSE(GetHeartbeatParent(config, task("chief", 0)).has_value());
+  EXPECT_FALSE(GetHeartbeatParent(config, task("worker", 0)).has_value());
+  auto parent = GetHeartbeatParent(config, task("worker", 1));
+  ASSERT_TRUE(parent.has_value());
+  EXPECT_EQ(parent->job_name(), "chief");
+  EXPECT_EQ(parent->task_id(), 0);
+  parent = GetHeartbeatParent(config, task("worker", 7));
+  ASSERT_TRUE(parent.has_value());
+  EXPECT_EQ(parent->job_name(), "worker");
+  EXPECT_EQ(parent->task_id(), 2);
+  // Tasks outside of the coordinated jobs report to the leader.
+  EXPECT_FALSE(GetHeartbeatParent(config, task("ps", 3)).has_value());
+  EXPECT_FALSE(GetHeartbeatParent(config, task("worker", 8)).has_value());
+}
+
 }  // namespace
 }  // namespace tsl
@@ -71,13 +71,29 @@ void CoordinationServiceRpcHandler::HeartbeatAsync(
     StatusCallback done) {
   tf_shared_lock l(mu_);
   if (service_ == nullptr) {
-    done(MakeCoordinationError(
-        errors::Internal("Coordination service is not enabled.")));
+    // Tasks other than the leader receive heartbeats only as intermediate
+    // nodes of the heartbeat aggregation tree.
+    if (agent_ == nullptr) {
+      done(MakeCoordinationError(
+          errors::Internal("Coordination service is not enabled.")));
+      return;
+    }
+    StatusOr<uint64_t> leader_incarnation =
+        agent_->AggregateHeartbeat(*request);
+    if (!leader_incarnation.ok()) {
+      done(leader_incarnation.status());
+      return;
+    }
+    response->set_leader_incarnation(*leader_incarnation);
+    done(OkStatus());
     return;
   }
   const CoordinatedTask& task = request->source_task();
   const uint64_t incarnation = request->incarnation();
   const uint64_t leader_incarnation = service_->GetServiceIncarnation();
+  if (!request->forwarded_heartbeats().empty()) {
+    service_->RecordForwardedHeartbeats(request->forwarded_heartbeats());
+  }
   Status s = service_->RecordHeartbeat(task, incarnation);
   if (!s.ok()) {
     done(s);
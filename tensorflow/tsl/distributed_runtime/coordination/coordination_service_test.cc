@@ -34,6 +34,7 @@ limitations under the License.
 #include "tensorflow/tsl/platform/env.h"
 #include "tensorflow/tsl/platform/errors.h"
 #include "tensorflow/tsl/platform/mutex.h"
+#include "tensorflow/tsl/platform/protobuf.h"
 #include "tensorflow/tsl/platform/random.h"
 #include "tensorflow/tsl/platform/status.h"
 #include "tensorflow/tsl/platform/test.h"
@@ -52,6 +53,7 @@ using tensorflow::CoordinatedJob;
 using tensorflow::CoordinatedTask;
 using tensorflow::CoordinationServiceConfig;
 using tensorflow::DeviceInfo;
+using tensorflow::HeartbeatRequest;
 using tensorflow::KeyValueEntry;
 using tensorflow::TestDevice;
 using tensorflow::TestDeviceList;
@@ -468,6 +470,46 @@ TEST_F(CoordinateTwoTasksTest,
       coord_service_->RecordHeartbeat(task_1_, incarnation_1_)));
 }
 
+TEST_F(CoordinateTwoTasksTest, ForwardedHeartbeatsKeepTasksAlive) {
+  EnableCoordinationService();
+  TF_ASSERT_OK(coord_service_->RegisterTask(task_0_, incarnation_0_));
+  TF_ASSERT_OK(coord_service_->RegisterTask(task_1_, incarnation_1_));
+  protobuf::RepeatedPtrField<HeartbeatRequest> forwarded;
+  HeartbeatRequest* heartbeat = forwarded.Add();
+  *heartbeat->mutable_source_task() = task_1_;
+  heartbeat->set_incarnation(incarnation_1_);
+
+  // Task 1 only heartbeats through task 0 for longer than the timeout.
+  for (int i = 0; i < 4; ++i) {
+    Env::Default()->SleepForMicroseconds(
+        absl::ToInt64Microseconds(kHeartbeatTimeout / 2));
+    TF_ASSERT_OK(coord_service_->RecordHeartbeat(task_0_, incarnation_0_));
+    coord_service_->RecordForwardedHeartbeats(forwarded);
+  }
+
+  TF_EXPECT_OK(coord_service_->RecordHeartbeat(task_1_, incarnation_1_));
+  TF_EXPECT_OK(client_0_.GetStatus());
+}
+
+TEST_F(CoordinateTwoTasksTest, ForwardedHeartbeatWithStaleIncarnation) {
+  EnableCoordinationService();
+  TF_ASSERT_OK(coord_service_->RegisterTask(task_0_, incarnation_0_));
+  TF_ASSERT_OK(coord_service_->RegisterTask(task_1_, incarnation_1_));
+  protobuf::RepeatedPtrField<HeartbeatRequest> forwarded;
+  HeartbeatRequest* heartbeat = forwarded.Add();
+  *heartbeat->mutable_source_task() = task_1_;
+  heartbeat->set_incarnation(0);
+
+  coord_service_->RecordForwardedHeartbeats(forwarded);
+
+  // The forwarding task is not affected, but the error of task 1 is recorded
+  // and propagated.
+  TF_EXPECT_OK(coord_service_->RecordHeartbeat(task_0_, incarnation_0_));
+  EXPECT_TRUE(absl::IsAborted(
+      coord_service_->RecordHeartbeat(task_1_, incarnation_1_)));
+  EXPECT_TRUE(absl::IsAborted(client_0_.GetStatus()));
+}
+
 TEST_F(CoordinateTwoTasksTest, TestTaskRestart) {
   EnableCoordinationService();
   TF_ASSERT_OK(coord_service_->RegisterTask(task_0_, incarnation_0_));
@@ -135,6 +135,12 @@ const ::grpc::ChannelArguments* GetDefaultChannelArguments() {
     if (rpc_options->disable_session_connection_sharing()) {
       VLOG(5) << "Disabling TCP connection sharing";
       args.SetInt(GRPC_ARG_USE_LOCAL_SUBCHANNEL_POOL, true);
+    } else if (rpc_options->num_channels_per_target() > 1) {
+      // Channels with the same arguments share their connection through the
+      // global subchannel pool, which would defeat the purpose of having
+      // several channels per target.
+      VLOG(5) << "Using one TCP connection per channel";
+      args.SetInt(GRPC_ARG_USE_LOCAL_SUBCHANNEL_POOL, true);
     }
   }
   return args;
@@ -20,6 +20,7 @@ limitations under the License.
 #include <memory>
 #include <set>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "grpcpp/grpcpp.h"
@@ -73,6 +74,17 @@ class GrpcChannelCache {
   // E.g., /job:mnist/task:2
   virtual SharedGrpcChannelPtr FindWorkerChannel(const string& target) = 0;
 
+  // Populates *channels with all of the channels that are connected to the
+  // remote worker named by 'target', or leaves it unchanged if 'target' is
+  // unknown. Callers that hold on to a target for a long time use this to
+  // spread their RPCs over every channel of the target instead of pinning the
+  // one returned by FindWorkerChannel().
+  virtual void FindWorkerChannels(const string& target,
+                                  std::vector<SharedGrpcChannelPtr>* channels) {
+    SharedGrpcChannelPtr channel = FindWorkerChannel(target);
+    if (channel) channels->push_back(std::move(channel));
+  }
+
   // Translates a string in the form `/job:X/task:Z` into a host_port.
   virtual string TranslateTask(const string& task) = 0;
 };
@@ -69,6 +69,18 @@ class GenericCachingChannelCache : public ChannelCacheT {
     }
   }
 
+  void FindWorkerChannels(
+      const string& target,
+      std::vector<SharedGrpcChannelPtr>* channels) override {
+    // Populates the cache for `target` if needed.
+    if (!FindWorkerChannel(target)) return;
+    mutex_lock l(mu_);
+    auto iter = channels_.find(target);
+    if (iter == channels_.end()) return;
+    channels->insert(channels->end(), iter->second.channels.begin(),
+                     iter->second.channels.end());
+  }
+
  protected:
   // Find the ClientChannel for "target".  Only called when no channel was
   // found in the channels_ cache for "target".  A non nullptr result will be
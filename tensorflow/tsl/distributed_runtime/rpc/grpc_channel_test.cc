@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/tsl/distributed_runtime/rpc/grpc_channel.h"
 
+#include <algorithm>
 #include <string>
 #include <vector>
 
@@ -203,6 +204,45 @@ TEST(GrpcChannelTest, HostPortsMultiChannelPerTarget) {
   }
 }
 
+TEST(GrpcChannelTest, FindWorkerChannels) {
+  GrpcChannelSpec spec;
+  TF_EXPECT_OK(spec.AddHostPortsJob("mnist", {{0, "a:1"}, {1, "b:2"}}));
+  ChannelCreationFunction channel_func =
+      ConvertToChannelCreationFunction(NewHostPortGrpcChannel);
+  tensorflow::RPCOptions rpc_options;
+  rpc_options.set_num_channels_per_target(3);
+  std::unique_ptr<GrpcChannelCache> cc(
+      NewGrpcChannelCache(spec, channel_func, rpc_options));
+
+  std::vector<SharedGrpcChannelPtr> channels;
+  cc->FindWorkerChannels("/job:other/replica:0/task:0", &channels);
+  EXPECT_TRUE(channels.empty());
+
+  cc->FindWorkerChannels("/job:mnist/replica:0/task:0", &channels);
+  ASSERT_EQ(3, channels.size());
+  EXPECT_NE(channels[0].get(), channels[1].get());
+  EXPECT_NE(channels[0].get(), channels[2].get());
+  EXPECT_NE(channels[1].get(), channels[2].get());
+
+  // The pool is the one that FindWorkerChannel() cycles through.
+  for (int i = 0; i < 3; i++) {
+    SharedGrpcChannelPtr channel =
+        cc->FindWorkerChannel("/job:mnist/replica:0/task:0");
+    EXPECT_NE(channels.end(),
+              std::find(channels.begin(), channels.end(), channel));
+  }
+
+  // Caches with a single channel per target return that channel.
+  std::unique_ptr<GrpcChannelCache> single_cc(
+      NewGrpcChannelCache(spec, channel_func));
+  std::vector<SharedGrpcChannelPtr> single_channels;
+  single_cc->FindWorkerChannels("/job:mnist/replica:0/task:1",
+                                &single_channels);
+  ASSERT_EQ(1, single_channels.size());
+  EXPECT_EQ(single_channels[0].get(),
+            single_cc->FindWorkerChannel("/job:mnist/replica:0/task:1").get());
+}
+
 TEST(GrpcChannelTest, HostPortsMultiGrpcMultiChannelPerTarget) {
   GrpcChannelSpec spec;
   TF_EXPECT_OK(
@@ -36,7 +36,10 @@ string AllocatorStats::DebugString() const {
       "MaxAllocSize:     %20lld\n"
       "Reserved:         %20lld\n"
       "PeakReserved:     %20lld\n"
-      "LargestFreeBlock: %20lld\n",
+      "LargestFreeBlock: %20lld\n"
+      "Fragmentation:    %20.4f\n"
+      "NumDefrags:       %20lld\n"
+      "DefragBytes:      %20lld\n",
       static_cast<long long>(this->bytes_limit ? *this->bytes_limit : 0),
       static_cast<long long>(this->bytes_in_use),
       static_cast<long long>(this->peak_bytes_in_use),
@@ -44,7 +47,10 @@ string AllocatorStats::DebugString() const {
       static_cast<long long>(this->largest_alloc_size),
       static_cast<long long>(this->bytes_reserved),
       static_cast<long long>(this->peak_bytes_reserved),
-      static_cast<long long>(this->largest_free_block_bytes));
+      static_cast<long long>(this->largest_free_block_bytes),
+      this->fragmentation.value_or(0),
+      static_cast<long long>(this->num_defragmentations),
+      static_cast<long long>(this->bytes_defragmented));
 }
 
 constexpr size_t Allocator::kAllocatorAlignment;
@@ -21,9 +21,11 @@ limitations under the License.
 #include <functional>
 #include <limits>
 #include <optional>
+#include <utility>
 
 #include "absl/strings/string_view.h"
 #include "absl/types/optional.h"
+#include "absl/types/span.h"
 #include "tensorflow/tsl/framework/numeric_types.h"
 #include "tensorflow/tsl/framework/type_traits.h"
 #include "tensorflow/tsl/platform/logging.h"
@@ -92,6 +94,15 @@ struct AllocatorStats {
   std::optional<int64_t> pool_bytes;
   std::optional<int64_t> peak_pool_bytes;
 
+  // Fragmentation of the free memory held by the allocator, i.e. one minus the
+  // ratio of the largest free block over all free bytes, in [0, 1].
+  std::optional<double> fragmentation;
+
+  // Number of times the allocator defragmented its free memory by remapping
+  // it to contiguous addresses, and the total number of bytes remapped.
+  int64_t num_defragmentations;
+  int64_t bytes_defragmented;
+
   AllocatorStats()
       : num_allocs(0),
         bytes_in_use(0),
@@ -99,7 +110,9 @@ struct AllocatorStats {
         largest_alloc_size(0),
         bytes_reserved(0),
         peak_bytes_reserved(0),
-        largest_free_block_bytes(0) {}
+        largest_free_block_bytes(0),
+        num_defragmentations(0),
+        bytes_defragmented(0) {}
 
   std::string DebugString() const;
 };
@@ -406,6 +419,24 @@ class SubAllocator {
   // returned by this allocator.
   virtual bool SupportsCoalescing() const = 0;
 
+  // Returns the granularity of Remap(), or 0 if this allocator can't remap
+  // memory.
+  virtual size_t RemapGranularity() const { return 0; }
+
+  // Moves the physical memory backing `ranges` to a new contiguous range of
+  // addresses, in order and without copying it, and returns the start of the
+  // new range. Each range must lie in memory returned by Alloc() or Remap(),
+  // and its address and size must be multiples of RemapGranularity().
+  //
+  // On success, the addresses in `ranges` are no longer valid, and Free() may
+  // be called on any part of the remaining memory whose address and size are
+  // multiples of RemapGranularity(). On failure, returns nullptr and leaves
+  // `ranges` unchanged.
+  virtual void* Remap(absl::Span<const std::pair<void*, size_t>> ranges,
+                      size_t* bytes_received) {
+    return nullptr;
+  }
+
   // Returns the type of the memory allocated by this SubAllocator.
   virtual AllocatorMemoryType GetMemoryType() const {
     return AllocatorMemoryType::kUnknown;
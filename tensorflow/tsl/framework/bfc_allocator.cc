@@ -46,8 +46,22 @@ BFCAllocator::BFCAllocator(std::unique_ptr<SubAllocator> sub_allocator,
       coalesce_regions_(sub_allocator->SupportsCoalescing()),
       sub_allocator_(std::move(sub_allocator)),
       name_(name),
+      num_thread_cache_classes_(
+          static_cast<int>(RoundedBytes(opts.thread_cache_max_bytes) /
+                           kMinAllocationSize)),
       free_chunks_list_(kInvalidChunkHandle),
       next_allocation_id_(1) {
+  if (num_thread_cache_classes_ > 0) {
+    CHECK_GT(opts.thread_cache_capacity, 0);
+    CHECK_GT(opts.num_thread_caches, 0);
+    thread_caches_ = std::make_unique<ThreadCache[]>(opts.num_thread_caches);
+    for (int i = 0; i < opts.num_thread_caches; ++i) {
+      mutex_lock l(thread_caches_[i].mu);
+      thread_caches_[i].magazines.resize(num_thread_cache_classes_);
+    }
+    cached_chunk_shards_ =
+        std::make_unique<CachedChunkShard[]>(opts.num_thread_caches);
+  }
   if (opts.allow_growth) {
     // 2MiB smallest initial allocation, unless total memory available
     // is less.
@@ -171,20 +185,25 @@ bool BFCAllocator::Extend(size_t alignment, size_t rounded_bytes) {
   VLOG(1) << "Allocated memory at " << mem_addr << " to "
           << static_cast<void*>(static_cast<char*>(mem_addr) + bytes_received);
 
+  AddRegion(mem_addr, bytes_received);
+  return true;
+}
+
+void BFCAllocator::AddRegion(void* ptr, size_t size) {
   AllocationRegion* maybe_extended_region = nullptr;
   if (coalesce_regions_) {
     maybe_extended_region =
-        region_manager_.AddOrExtendAllocationRegion(mem_addr, bytes_received);
+        region_manager_.AddOrExtendAllocationRegion(ptr, size);
   } else {
-    region_manager_.AddAllocationRegion(mem_addr, bytes_received);
+    region_manager_.AddAllocationRegion(ptr, size);
   }
 
   // Create one large chunk for the whole memory space that will
   // be chunked later.
   ChunkHandle h = AllocateChunk();
   BFCAllocator::Chunk* c = ChunkFromHandle(h);
-  c->ptr = mem_addr;
-  c->size = bytes_received;
+  c->ptr = ptr;
+  c->size = size;
   c->allocation_id = -1;
   c->prev = kInvalidChunkHandle;
   c->next = kInvalidChunkHandle;
@@ -209,8 +228,6 @@ bool BFCAllocator::Extend(size_t alignment, size_t rounded_bytes) {
 
   // Maybe merge adjacent chunks and insert the chunk into the right bin.
   InsertFreeChunkIntoBin(TryToCoalesce(h, /*ignore_freed_at=*/false));
-
-  return true;
 }
 
 BFCAllocator::ChunkHandle BFCAllocator::AllocateChunk() {
@@ -254,7 +271,14 @@ void* BFCAllocator::AllocateRawInternalWithRetry(
           if (allocation_attr.freed_by_func != nullptr) {
             freed_by_count = (*allocation_attr.freed_by_func)();
           }
-          return AllocateRawInternal(a, nb, v, freed_by_count);
+          void* ptr = AllocateRawInternal(a, nb, v, freed_by_count);
+          if (ptr == nullptr && thread_caches_ != nullptr) {
+            // Chunks held by the thread caches may be enough to satisfy the
+            // request once they are merged back into the bins.
+            FlushThreadCaches();
+            ptr = AllocateRawInternal(a, nb, v, freed_by_count);
+          }
+          return ptr;
         },
         kMaxMillisToWait, unused_alignment, num_bytes);
     return r;
@@ -264,6 +288,14 @@ void* BFCAllocator::AllocateRawInternalWithRetry(
 void* BFCAllocator::AllocateRaw(size_t unused_alignment, size_t num_bytes,
                                 const AllocationAttributes& allocation_attr) {
   VLOG(3) << "AllocateRaw " << Name() << "  " << num_bytes;
+  if (thread_caches_ != nullptr && allocation_attr.freed_by_func == nullptr) {
+    void* ptr = AllocateFromThreadCache(num_bytes);
+    if (ptr != nullptr) {
+      VLOG(3) << "AllocateRaw " << Name() << "  " << num_bytes << " " << ptr
+              << " (thread cache)";
+      return ptr;
+    }
+  }
   void* result = [&] {
     if (!opts_.allow_retry_on_failure || !allocation_attr.retry_on_failure) {
       // If we have globally disabled retry-on-failure and fail to allocate an
@@ -289,6 +321,13 @@ void* BFCAllocator::AllocateRaw(size_t unused_alignment, size_t num_bytes,
       }
       void* res = AllocateRawInternal(unused_alignment, num_bytes,
                                       dump_log_on_failure, freed_by_count);
+      if (res == nullptr && thread_caches_ != nullptr) {
+        // Chunks held by the thread caches may be enough to satisfy the
+        // request once they are merged back into the bins.
+        FlushThreadCaches();
+        res = AllocateRawInternal(unused_alignment, num_bytes,
+                                  dump_log_on_failure, freed_by_count);
+      }
       if (res == nullptr) {
         int32 counter_value = log_counter.load(std::memory_order_relaxed);
         if (counter_value < kMaxFailureLogs) {
@@ -314,6 +353,154 @@ void* BFCAllocator::AllocateRaw(size_t unused_alignment, size_t num_bytes,
   return result;
 }
 
+BFCAllocator::ThreadCache& BFCAllocator::CurrentThreadCache() {
+  static std::atomic<int> next_thread_index{0};
+  thread_local const int thread_index =
+      next_thread_index.fetch_add(1, std::memory_order_relaxed);
+  return thread_caches_[thread_index % opts_.num_thread_caches];
+}
+
+BFCAllocator::CachedChunkShard& BFCAllocator::CachedChunkShardFor(
+    const void* ptr) const {
+  // All chunk addresses are multiples of kMinAllocationSize.
+  const uint64 index = reinterpret_cast<uintptr_t>(ptr) >> kMinAllocationBits;
+  return cached_chunk_shards_[index % opts_.num_thread_caches];
+}
+
+void* BFCAllocator::AllocateFromThreadCache(size_t num_bytes) {
+  if (num_bytes == 0 || timing_counter_ != nullptr) return nullptr;
+  const size_t rounded_bytes = RoundedBytes(num_bytes);
+  const int size_class =
+      static_cast<int>(rounded_bytes / kMinAllocationSize) - 1;
+  if (size_class >= num_thread_cache_classes_) return nullptr;
+
+  ThreadCache& cache = CurrentThreadCache();
+  void* ptr = nullptr;
+  {
+    mutex_lock l(cache.mu);
+    std::vector<void*>& magazine = cache.magazines[size_class];
+    if (!magazine.empty()) {
+      ptr = magazine.back();
+      magazine.pop_back();
+    }
+  }
+
+  if (ptr == nullptr) {
+    // Refill the magazine with a batch of chunks, amortizing one acquisition
+    // of `lock_` over several allocations. The pool is not grown here; if the
+    // bins are exhausted, the caller falls back to the regular path.
+    const int batch_size = std::max(1, opts_.thread_cache_capacity / 2);
+    std::vector<void*> batch;
+    batch.reserve(batch_size);
+    {
+      mutex_lock l(lock_);
+      if (!timestamped_chunks_.empty()) {
+        MergeTimestampedChunks(0);
+      }
+      const BinNum bin_num = BinNumForSize(rounded_bytes);
+      for (int i = 0; i < batch_size; ++i) {
+        void* chunk_ptr = FindChunkPtr(bin_num, rounded_bytes, rounded_bytes,
+                                       /*freed_before=*/0);
+        if (chunk_ptr == nullptr) break;
+        batch.push_back(chunk_ptr);
+      }
+    }
+    if (batch.empty()) return nullptr;
+    for (void* chunk_ptr : batch) {
+      CachedChunkShard& shard = CachedChunkShardFor(chunk_ptr);
+      mutex_lock l(shard.mu);
+      shard.chunks[chunk_ptr] = {size_class, rounded_bytes};
+    }
+    ptr = batch.back();
+    batch.pop_back();
+    if (!batch.empty()) {
+      mutex_lock l(cache.mu);
+      std::vector<void*>& magazine = cache.magazines[size_class];
+      magazine.insert(magazine.end(), batch.begin(), batch.end());
+    }
+  }
+
+  {
+    CachedChunkShard& shard = CachedChunkShardFor(ptr);
+    mutex_lock l(shard.mu);
+    shard.chunks[ptr].requested_size = num_bytes;
+  }
+  AddThreadCacheTraceMe("MemoryAllocation", ptr, num_bytes);
+  return ptr;
+}
+
+bool BFCAllocator::DeallocateToThreadCache(void* ptr) {
+  int size_class;
+  size_t requested_size;
+  {
+    CachedChunkShard& shard = CachedChunkShardFor(ptr);
+    mutex_lock l(shard.mu);
+    auto it = shard.chunks.find(ptr);
+    if (it == shard.chunks.end()) return false;
+    size_class = it->second.size_class;
+    requested_size = it->second.requested_size;
+  }
+  AddThreadCacheTraceMe("MemoryDeallocation", ptr, requested_size);
+
+  std::vector<void*> overflow;
+  {
+    ThreadCache& cache = CurrentThreadCache();
+    mutex_lock l(cache.mu);
+    std::vector<void*>& magazine = cache.magazines[size_class];
+    magazine.push_back(ptr);
+    if (magazine.size() > static_cast<size_t>(opts_.thread_cache_capacity)) {
+      // Keep the most recently freed (and most likely cache-hot) chunks.
+      const size_t num_to_return = magazine.size() / 2;
+      overflow.assign(magazine.begin(), magazine.begin() + num_to_return);
+      magazine.erase(magazine.begin(), magazine.begin() + num_to_return);
+    }
+  }
+  if (!overflow.empty()) {
+    ReturnCachedChunks(overflow);
+    retry_helper_.NotifyDealloc();
+  }
+  return true;
+}
+
+void BFCAllocator::AddThreadCacheTraceMe(absl::string_view traceme_name,
+                                         const void* ptr, int64_t req_bytes) {
+  if (!tsl::profiler::TraceMe::Active(tsl::profiler::TraceMeLevel::kInfo)) {
+    return;
+  }
+  mutex_lock l(lock_);
+  const Chunk* chunk = ChunkFromHandle(region_manager_.get_handle(ptr));
+  AddTraceMe(traceme_name, ptr, req_bytes, chunk->size);
+}
+
+void BFCAllocator::ReturnCachedChunks(const std::vector<void*>& ptrs) {
+  for (void* ptr : ptrs) {
+    CachedChunkShard& shard = CachedChunkShardFor(ptr);
+    mutex_lock l(shard.mu);
+    shard.chunks.erase(ptr);
+  }
+  mutex_lock l(lock_);
+  for (void* ptr : ptrs) {
+    DeallocateRawLocked(ptr);
+  }
+}
+
+void BFCAllocator::FlushThreadCaches() {
+  if (thread_caches_ == nullptr) return;
+  std::vector<void*> ptrs;
+  for (int i = 0; i < opts_.num_thread_caches; ++i) {
+    ThreadCache& cache = thread_caches_[i];
+    mutex_lock l(cache.mu);
+    for (std::vector<void*>& magazine : cache.magazines) {
+      ptrs.insert(ptrs.end(), magazine.begin(), magazine.end());
+      magazine.clear();
+    }
+  }
+  if (!ptrs.empty()) {
+    ReturnCachedChunks(ptrs);
+    retry_helper_.NotifyDealloc();
+  }
+}
+
 // static
 size_t BFCAllocator::RoundedBytes(size_t bytes) {
   size_t rounded_bytes =
@@ -414,6 +601,118 @@ void BFCAllocator::DeallocateRegions(
   }
 }
 
+bool BFCAllocator::DefragmentByRemapping(size_t rounded_bytes) {
+  if (!opts_.defragment_by_remapping) {
+    return false;
+  }
+  const uintptr_t granularity = sub_allocator_->RemapGranularity();
+  if (granularity == 0) {
+    return false;
+  }
+
+  // Finds the pages entirely covered by free chunks. Chunks freed with a
+  // timestamp may still be used by pending work, so they are left alone.
+  struct FreePages {
+    ChunkHandle h;
+    void* ptr;
+    size_t size;
+  };
+  std::vector<FreePages> free_pages;
+  for (const AllocationRegion& region : region_manager_.regions()) {
+    ChunkHandle h = region_manager_.get_handle(region.ptr());
+    while (h != kInvalidChunkHandle) {
+      const Chunk* c = ChunkFromHandle(h);
+      if (!c->in_use() && c->bin_num != kInvalidBinNum &&
+          c->freed_at_count == 0) {
+        const uintptr_t begin = reinterpret_cast<uintptr_t>(c->ptr);
+        const uintptr_t pages_begin =
+            (begin + granularity - 1) / granularity * granularity;
+        const uintptr_t pages_end =
+            (begin + c->size) / granularity * granularity;
+        if (pages_end > pages_begin) {
+          free_pages.push_back({h, reinterpret_cast<void*>(pages_begin),
+                                pages_end - pages_begin});
+        }
+      }
+      h = c->next;
+    }
+  }
+
+  // Moves as few pages as possible, taking the largest ranges first.
+  std::stable_sort(free_pages.begin(), free_pages.end(),
+                   [](const FreePages& a, const FreePages& b) {
+                     return a.size > b.size;
+                   });
+  size_t total_bytes = 0;
+  size_t num_ranges = 0;
+  while (num_ranges < free_pages.size() && total_bytes < rounded_bytes) {
+    total_bytes += free_pages[num_ranges++].size;
+  }
+  if (total_bytes < rounded_bytes) {
+    return false;
+  }
+  free_pages.resize(num_ranges);
+  std::sort(free_pages.begin(), free_pages.end(),
+            [](const FreePages& a, const FreePages& b) {
+              return a.ptr < b.ptr;
+            });
+
+  std::vector<std::pair<void*, size_t>> ranges;
+  ranges.reserve(free_pages.size());
+  for (const FreePages& pages : free_pages) {
+    ranges.emplace_back(pages.ptr, pages.size);
+  }
+  size_t bytes_received;
+  void* ptr = sub_allocator_->Remap(ranges, &bytes_received);
+  if (ptr == nullptr) {
+    return false;
+  }
+  VLOG(1) << "Defragmented " << strings::HumanReadableNumBytes(bytes_received)
+          << " from " << ranges.size() << " free chunks of " << Name()
+          << " to " << ptr;
+
+  for (const FreePages& pages : free_pages) {
+    RemoveRemappedRange(pages.h, pages.ptr, pages.size);
+  }
+  AddRegion(ptr, bytes_received);
+  ++stats_.num_defragmentations;
+  stats_.bytes_defragmented += bytes_received;
+  return true;
+}
+
+void BFCAllocator::RemoveRemappedRange(ChunkHandle h, void* ptr,
+                                       size_t size) {
+  RemoveFreeChunkFromBin(h);
+  char* begin = static_cast<char*>(ptr);
+  char* end = begin + size;
+
+  // Splits off the free memory after the range, which goes back to a bin.
+  Chunk* c = ChunkFromHandle(h);
+  if (end < static_cast<char*>(c->ptr) + c->size) {
+    SplitChunk(h, end - static_cast<char*>(c->ptr));
+  }
+  // Splits off the free memory before the range.
+  ChunkHandle h_removed = h;
+  c = ChunkFromHandle(h);
+  if (begin > c->ptr) {
+    SplitChunk(h, begin - static_cast<char*>(c->ptr));
+    h_removed = ChunkFromHandle(h)->next;
+    RemoveFreeChunkFromBin(h_removed);
+    InsertFreeChunkIntoBin(h);
+  }
+
+  // The chunks around the range are no longer contiguous with it.
+  Chunk* removed = ChunkFromHandle(h_removed);
+  if (removed->prev != kInvalidChunkHandle) {
+    ChunkFromHandle(removed->prev)->next = kInvalidChunkHandle;
+  }
+  if (removed->next != kInvalidChunkHandle) {
+    ChunkFromHandle(removed->next)->prev = kInvalidChunkHandle;
+  }
+  DeleteChunk(h_removed);
+  region_manager_.RemoveRange(ptr, size);
+}
+
 void* BFCAllocator::AllocateRawInternal(size_t unused_alignment,
                                         size_t num_bytes,
                                         bool dump_log_on_failure,
@@ -477,6 +776,16 @@ void* BFCAllocator::AllocateRawInternal(size_t unused_alignment,
     }
   }
 
+  // Free memory may still be enough but scattered between chunks in use. If
+  // the sub-allocator can remap memory, gather enough of it at new addresses.
+  if (DefragmentByRemapping(rounded_bytes)) {
+    ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes, freed_before);
+    if (ptr != nullptr) {
+      AddTraceMe("MemoryAllocation", ptr);
+      return ptr;
+    }
+  }
+
   // We searched all bins for an existing free chunk to use and
   // couldn't find one.  This means we must have run out of memory,
   // Dump the memory log for analysis.
@@ -684,6 +993,10 @@ void BFCAllocator::SplitChunk(BFCAllocator::ChunkHandle h, size_t num_bytes) {
 void BFCAllocator::DeallocateRaw(void* ptr) {
   VLOG(3) << "DeallocateRaw " << Name() << " "
           << (ptr ? RequestedSize(ptr) : 0);
+  if (thread_caches_ != nullptr && ptr != nullptr &&
+      DeallocateToThreadCache(ptr)) {
+    return;
+  }
   DeallocateRawInternal(ptr);
   retry_helper_.NotifyDealloc();
 }
@@ -694,7 +1007,10 @@ void BFCAllocator::DeallocateRawInternal(void* ptr) {
     return;
   }
   mutex_lock l(lock_);
+  DeallocateRawLocked(ptr);
+}
 
+void BFCAllocator::DeallocateRawLocked(void* ptr) {
   // Find the chunk from the ptr.
   BFCAllocator::ChunkHandle h = region_manager_.get_handle(ptr);
   CHECK(h != kInvalidChunkHandle);
@@ -937,6 +1253,14 @@ bool BFCAllocator::TracksAllocationSizes() const { return true; }
 
 size_t BFCAllocator::RequestedSize(const void* ptr) const {
   CHECK(ptr);
+  if (cached_chunk_shards_ != nullptr) {
+    // The chunk of a pointer handed out from a thread cache records the size of
+    // the request that moved it into the cache, not of the latest request.
+    CachedChunkShard& shard = CachedChunkShardFor(ptr);
+    mutex_lock l(shard.mu);
+    auto it = shard.chunks.find(ptr);
+    if (it != shard.chunks.end()) return it->second.requested_size;
+  }
   mutex_lock l(lock_);
   BFCAllocator::ChunkHandle h = region_manager_.get_handle(ptr);
   CHECK(h != kInvalidChunkHandle)
@@ -1207,7 +1531,11 @@ MemoryDump BFCAllocator::RecordMemoryMapInternal() {
 
 absl::optional<AllocatorStats> BFCAllocator::GetStats() {
   mutex_lock l(lock_);
-  return stats_;
+  AllocatorStats stats = stats_;
+  stats.largest_free_block_bytes = LargestFreeChunk();
+  stats.fragmentation =
+      *stats_.pool_bytes > stats_.bytes_in_use ? GetFragmentation() : 0.0;
+  return stats;
 }
 
 bool BFCAllocator::ClearStats() {
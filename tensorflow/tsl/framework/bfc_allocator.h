@@ -23,6 +23,7 @@ limitations under the License.
 #include <unordered_map>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "tensorflow/tsl/framework/allocator.h"
 #include "tensorflow/tsl/framework/allocator_retry.h"
@@ -68,6 +69,31 @@ class BFCAllocator : public Allocator {
     // Controls when a chunk should be split, if its size exceeds the requested
     // allocation size.
     double fragmentation_fraction = 0;
+
+    // If true and the sub-allocator can remap memory (see
+    // SubAllocator::RemapGranularity()), an allocation that fails because the
+    // free memory is fragmented moves the physical memory backing free chunks
+    // to a new contiguous range of addresses, without copying it.
+    bool defragment_by_remapping = false;
+
+    // If positive, allocations of at most this many bytes (after rounding) are
+    // served from small per-thread caches of free chunks, without acquiring
+    // the allocator-wide lock. Cached chunks are kept out of the bins, count
+    // as in use in `GetStats()`, and are only returned to the bins in batches
+    // (or when an allocation would otherwise fail). Caches are bypassed for
+    // allocations with a `freed_by_func` and when a timing counter is set.
+    size_t thread_cache_max_bytes = 0;
+
+    // The maximum number of free chunks a cache holds for each size class.
+    // When a cache overflows, half of its chunks for that size class are
+    // returned to the bins under one acquisition of the allocator lock. An
+    // empty cache is refilled with up to half this many chunks at once.
+    int thread_cache_capacity = 64;
+
+    // The number of caches. Each thread uses one cache, assigned round-robin on
+    // the thread's first allocation, so this bounds the number of threads that
+    // allocate small chunks without contending with each other.
+    int num_thread_caches = 16;
   };
   BFCAllocator(std::unique_ptr<SubAllocator> sub_allocator, size_t total_memory,
                const string& name, const Options& opts);
@@ -107,9 +133,60 @@ class BFCAllocator : public Allocator {
 
   MemoryDump RecordMemoryMap();
 
+  // Returns all chunks held by the per-thread caches (see
+  // `Options::thread_cache_max_bytes`) to the bins.
+  void FlushThreadCaches() TF_LOCKS_EXCLUDED(lock_);
+
  private:
   struct Bin;
 
+  // Bookkeeping for a chunk that is owned by the per-thread caches, either
+  // because it is sitting in a cache or because it was handed out from one.
+  struct CachedChunkInfo {
+    int size_class;
+    size_t requested_size;
+  };
+
+  // A per-thread cache: one "magazine" of free chunks per size class. Size
+  // class `c` holds chunks for requests that round to
+  // `(c + 1) * kMinAllocationSize` bytes.
+  struct alignas(64) ThreadCache {
+    mutex mu;
+    std::vector<std::vector<void*>> magazines TF_GUARDED_BY(mu);
+  };
+
+  // Maps pointers owned by the per-thread caches to their bookkeeping. Sharded
+  // by pointer, since a chunk may be freed on a different thread than the one
+  // that allocated it.
+  struct alignas(64) CachedChunkShard {
+    mutex mu;
+    absl::flat_hash_map<const void*, CachedChunkInfo> chunks TF_GUARDED_BY(mu);
+  };
+
+  // Returns a chunk for `num_bytes` from the calling thread's cache, refilling
+  // the cache from the bins if necessary. Returns nullptr if the request is
+  // not eligible for caching, or if no chunk could be found without growing
+  // the pool.
+  void* AllocateFromThreadCache(size_t num_bytes) TF_LOCKS_EXCLUDED(lock_);
+
+  // Puts `ptr` into the calling thread's cache if it is owned by the caches,
+  // and returns true. Returns false if `ptr` must be freed to the bins.
+  bool DeallocateToThreadCache(void* ptr) TF_LOCKS_EXCLUDED(lock_);
+
+  // Drops the bookkeeping for `ptrs` and returns them to the bins under one
+  // acquisition of `lock_`.
+  void ReturnCachedChunks(const std::vector<void*>& ptrs)
+      TF_LOCKS_EXCLUDED(lock_);
+
+  // Adds a TraceMe for `ptr`, which is owned by the per-thread caches, so
+  // that cached allocations are visible to the memory profiler. Only takes
+  // `lock_` while memory profiling is active.
+  void AddThreadCacheTraceMe(absl::string_view traceme_name, const void* ptr,
+                             int64_t req_bytes) TF_LOCKS_EXCLUDED(lock_);
+
+  ThreadCache& CurrentThreadCache();
+  CachedChunkShard& CachedChunkShardFor(const void* ptr) const;
+
   void* AllocateRawInternal(size_t alignment, size_t num_bytes,
                             bool dump_log_on_failure,
                             uint64 freed_before_count);
@@ -119,6 +196,7 @@ class BFCAllocator : public Allocator {
       const AllocationAttributes& allocation_attr);
 
   void DeallocateRawInternal(void* ptr);
+  void DeallocateRawLocked(void* ptr) TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
 
   // Chunks whose freed_at_count is later than the safe frontier value are kept
   // on a special list and not subject to merging immediately upon being freed.
@@ -326,6 +404,20 @@ class BFCAllocator : public Allocator {
     void set_handle(const void* p, ChunkHandle h) { handles_[IndexFor(p)] = h; }
     void erase(const void* p) { set_handle(p, kInvalidChunkHandle); }
 
+    // Moves the memory at and after `p` to a new region, which is returned.
+    AllocationRegion SplitAt(void* p) {
+      const size_t index = IndexFor(p);
+      AllocationRegion tail;
+      tail.ptr_ = p;
+      tail.end_ptr_ = end_ptr_;
+      tail.memory_size_ = memory_size_ - index * kMinAllocationSize;
+      tail.handles_.assign(handles_.begin() + index, handles_.end());
+      memory_size_ -= tail.memory_size_;
+      end_ptr_ = p;
+      handles_.resize(index);
+      return tail;
+    }
+
    private:
     void Swap(AllocationRegion* other) {
       std::swap(ptr_, other->ptr_);
@@ -408,6 +500,26 @@ class BFCAllocator : public Allocator {
       return regions_.erase(it);
     }
 
+    // Removes the memory [ptr, ptr + size) from the region that contains it,
+    // splitting the region in two if the memory is in its middle.
+    void RemoveRange(void* ptr, size_t size) {
+      auto it =
+          std::upper_bound(regions_.begin(), regions_.end(), ptr, &Comparator);
+      CHECK(it != regions_.end()) << "Could not find Region for " << ptr;
+      char* begin = static_cast<char*>(ptr);
+      char* end = begin + size;
+      DCHECK_LE(end, static_cast<char*>(it->end_ptr()));
+      if (end < it->end_ptr()) {
+        AllocationRegion tail = it->SplitAt(end);
+        it = regions_.insert(it + 1, std::move(tail)) - 1;
+      }
+      if (begin > it->ptr()) {
+        it->SplitAt(begin);
+      } else {
+        regions_.erase(it);
+      }
+    }
+
     ChunkHandle get_handle(const void* p) const {
       return RegionFor(p)->get_handle(p);
     }
@@ -465,6 +577,23 @@ class BFCAllocator : public Allocator {
   void DeallocateRegions(const absl::flat_hash_set<void*>& region_ptrs)
       TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
 
+  // Adds the memory [ptr, ptr + size) received from the sub-allocator as one
+  // free chunk, in a new region or at the end of an adjacent one.
+  void AddRegion(void* ptr, size_t size) TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Moves the physical memory backing the largest free chunks to a new
+  // contiguous region that can satisfy an allocation of 'rounded_bytes' bytes
+  // (see `Options::defragment_by_remapping`). Returns true on success and
+  // false if there isn't enough free memory or remapping isn't supported.
+  bool DefragmentByRemapping(size_t rounded_bytes)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Removes the memory [ptr, ptr + size) from the free chunk 'h' and from its
+  // region, after the sub-allocator has remapped it elsewhere. The remaining
+  // parts of the chunk, if any, stay free.
+  void RemoveRemappedRange(ChunkHandle h, void* ptr, size_t size)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
   // Returns a pointer to an underlying allocated chunk of size
   // 'rounded_bytes'.
   void* FindChunkPtr(BinNum bin_num, size_t rounded_bytes, size_t num_bytes,
@@ -596,6 +725,12 @@ class BFCAllocator : public Allocator {
 
   std::atomic<uint64> safe_frontier_ = {0};
 
+  // Per-thread caches of small free chunks. Both arrays are null iff
+  // `opts_.thread_cache_max_bytes` is 0.
+  const int num_thread_cache_classes_;
+  std::unique_ptr<ThreadCache[]> thread_caches_;
+  std::unique_ptr<CachedChunkShard[]> cached_chunk_shards_;
+
   // Structures mutable after construction
   mutable mutex lock_;
   RegionManager region_manager_ TF_GUARDED_BY(lock_);
@@ -0,0 +1,291 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/tsl/framework/bfc_allocator.h"
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/tsl/platform/blocking_counter.h"
+#include "tensorflow/tsl/platform/env.h"
+#include "tensorflow/tsl/platform/mem.h"
+#include "tensorflow/tsl/platform/test.h"
+#include "tensorflow/tsl/platform/test_benchmark.h"
+#include "tensorflow/tsl/platform/threadpool.h"
+
+namespace tsl {
+namespace {
+
+class HostSubAllocator : public SubAllocator {
+ public:
+  HostSubAllocator() : SubAllocator({}, {}) {}
+
+  void* Alloc(size_t alignment, size_t num_bytes,
+              size_t* bytes_received) override {
+    *bytes_received = num_bytes;
+    return port::AlignedMalloc(num_bytes, std::max<size_t>(alignment, 64));
+  }
+
+  void Free(void* ptr, size_t num_bytes) override { port::AlignedFree(ptr); }
+
+  bool SupportsCoalescing() const override { return false; }
+
+  AllocatorMemoryType GetMemoryType() const override {
+    return AllocatorMemoryType::kHostPageable;
+  }
+};
+
+std::unique_ptr<BFCAllocator> NewAllocator(size_t thread_cache_max_bytes,
+                                           size_t total_memory = 1 << 26) {
+  BFCAllocator::Options opts;
+  opts.thread_cache_max_bytes = thread_cache_max_bytes;
+  opts.thread_cache_capacity = 8;
+  opts.num_thread_caches = 4;
+  return std::make_unique<BFCAllocator>(std::make_unique<HostSubAllocator>(),
+                                        total_memory, "test_bfc", opts);
+}
+
+TEST(BFCAllocatorTest, ThreadCacheReusesFreedChunk) {
+  auto a = NewAllocator(/*thread_cache_max_bytes=*/1024);
+  // The first allocation grows the pool through the regular path; the second
+  // one refills this thread's cache from the bins.
+  a->DeallocateRaw(a->AllocateRaw(64, 100));
+  void* p1 = a->AllocateRaw(64, 100);
+  ASSERT_NE(p1, nullptr);
+  EXPECT_EQ(a->RequestedSize(p1), 100);
+  a->DeallocateRaw(p1);
+  // The freed chunk stays in this thread's cache and is handed out again.
+  void* p2 = a->AllocateRaw(64, 200);
+  EXPECT_EQ(p1, p2);
+  EXPECT_EQ(a->RequestedSize(p2), 200);
+  a->DeallocateRaw(p2);
+}
+
+TEST(BFCAllocatorTest, ThreadCacheSkipsLargeAllocations) {
+  auto a = NewAllocator(/*thread_cache_max_bytes=*/1024);
+  void* p = a->AllocateRaw(64, 4096);
+  ASSERT_NE(p, nullptr);
+  a->DeallocateRaw(p);
+  // Large chunks are returned to the bins immediately.
+  EXPECT_EQ(a->GetStats()->bytes_in_use, 0);
+}
+
+TEST(BFCAllocatorTest, ThreadCacheNoDups) {
+  auto a = NewAllocator(/*thread_cache_max_bytes=*/1024);
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 100; ++i) {
+    for (int s = 1; s <= 1024; s += 97) {
+      ptrs.push_back(a->AllocateRaw(64, s));
+    }
+  }
+  std::vector<void*> sorted = ptrs;
+  std::sort(sorted.begin(), sorted.end());
+  for (size_t i = 1; i < sorted.size(); ++i) {
+    ASSERT_NE(sorted[i], sorted[i - 1]);
+    const size_t gap =
+        static_cast<char*>(sorted[i]) - static_cast<char*>(sorted[i - 1]);
+    ASSERT_GE(gap, a->RequestedSize(sorted[i - 1]));
+  }
+  for (void* p : ptrs) a->DeallocateRaw(p);
+  a->FlushThreadCaches();
+  EXPECT_EQ(a->GetStats()->bytes_in_use, 0);
+}
+
+TEST(BFCAllocatorTest, FlushThreadCachesOnExhaustion) {
+  // With 64 KiB in total, the pool runs out unless cached chunks are returned
+  // to the bins and merged.
+  auto a = NewAllocator(/*thread_cache_max_bytes=*/1024,
+                        /*total_memory=*/1 << 16);
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 32; ++i) {
+    ptrs.push_back(a->AllocateRaw(64, 1024));
+    ASSERT_NE(ptrs.back(), nullptr);
+  }
+  for (void* p : ptrs) a->DeallocateRaw(p);
+  void* big = a->AllocateRaw(64, 3 << 14);
+  EXPECT_NE(big, nullptr);
+  a->DeallocateRaw(big);
+}
+
+TEST(BFCAllocatorTest, ThreadCacheConcurrentAllocations) {
+  auto a = NewAllocator(/*thread_cache_max_bytes=*/2048);
+  {
+    thread::ThreadPool pool(Env::Default(), "test", 8);
+    for (int t = 0; t < 8; ++t) {
+      pool.Schedule([&a, t]() {
+        std::vector<void*> ptrs;
+        for (int i = 0; i < 2000; ++i) {
+          ptrs.push_back(a->AllocateRaw(64, 1 + (i * 37 + t) % 2048));
+          if (ptrs.size() > 16) {
+            // Freeing on a different position keeps chunks moving between
+            // caches and bins.
+            a->DeallocateRaw(ptrs[i % ptrs.size()]);
+            ptrs.erase(ptrs.begin() + i % ptrs.size());
+          }
+        }
+        for (void* p : ptrs) a->DeallocateRaw(p);
+      });
+    }
+  }
+  a->FlushThreadCaches();
+  EXPECT_EQ(a->GetStats()->bytes_in_use, 0);
+}
+
+// Hands out consecutive addresses of a host arena. Remap() hands out the next
+// addresses without moving anything, which is enough for free memory.
+class RemappingSubAllocator : public SubAllocator {
+ public:
+  static constexpr size_t kGranularity = 1 << 16;
+
+  explicit RemappingSubAllocator(size_t arena_size)
+      : SubAllocator({}, {}),
+        arena_(static_cast<char*>(
+            port::AlignedMalloc(arena_size, kGranularity))),
+        arena_size_(arena_size) {}
+  ~RemappingSubAllocator() override { port::AlignedFree(arena_); }
+
+  void* Alloc(size_t alignment, size_t num_bytes,
+              size_t* bytes_received) override {
+    num_bytes = (num_bytes + kGranularity - 1) / kGranularity * kGranularity;
+    return Take(num_bytes, bytes_received);
+  }
+
+  void Free(void* ptr, size_t num_bytes) override {
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(ptr) % kGranularity, 0);
+    EXPECT_EQ(num_bytes % kGranularity, 0);
+  }
+
+  bool SupportsCoalescing() const override { return true; }
+
+  size_t RemapGranularity() const override { return kGranularity; }
+
+  void* Remap(absl::Span<const std::pair<void*, size_t>> ranges,
+              size_t* bytes_received) override {
+    size_t num_bytes = 0;
+    for (const auto& range : ranges) {
+      EXPECT_EQ(reinterpret_cast<uintptr_t>(range.first) % kGranularity, 0);
+      EXPECT_EQ(range.second % kGranularity, 0);
+      num_bytes += range.second;
+    }
+    return Take(num_bytes, bytes_received);
+  }
+
+ private:
+  void* Take(size_t num_bytes, size_t* bytes_received) {
+    if (next_ + num_bytes > arena_size_) return nullptr;
+    void* ptr = arena_ + next_;
+    next_ += num_bytes;
+    *bytes_received = num_bytes;
+    return ptr;
+  }
+
+  char* arena_;
+  size_t arena_size_;
+  size_t next_ = 0;
+};
+
+TEST(BFCAllocatorTest, DefragmentByRemapping) {
+  constexpr size_t kPage = RemappingSubAllocator::kGranularity;
+  for (bool defragment : {false, true}) {
+    BFCAllocator::Options opts;
+    opts.allow_growth = false;
+    opts.allow_retry_on_failure = false;
+    opts.defragment_by_remapping = defragment;
+    BFCAllocator a(std::make_unique<RemappingSubAllocator>(64 * kPage),
+                   8 * kPage, "test_bfc", opts);
+    AllocationAttributes no_retry;
+    no_retry.retry_on_failure = false;
+
+    std::vector<void*> ptrs;
+    for (int i = 0; i < 8; ++i) {
+      ptrs.push_back(a.AllocateRaw(64, kPage, no_retry));
+      ASSERT_NE(ptrs.back(), nullptr);
+    }
+    // Frees every other page: half of the memory is free, in 4 pieces.
+    for (int i = 0; i < 8; i += 2) a.DeallocateRaw(ptrs[i]);
+    auto stats = a.GetStats();
+    EXPECT_EQ(stats->largest_free_block_bytes, kPage);
+    EXPECT_DOUBLE_EQ(*stats->fragmentation, 0.75);
+
+    void* big = a.AllocateRaw(64, 2 * kPage, no_retry);
+    if (!defragment) {
+      EXPECT_EQ(big, nullptr);
+      for (int i = 1; i < 8; i += 2) a.DeallocateRaw(ptrs[i]);
+      continue;
+    }
+    ASSERT_NE(big, nullptr);
+    stats = a.GetStats();
+    EXPECT_EQ(stats->num_defragmentations, 1);
+    EXPECT_EQ(stats->bytes_defragmented, 2 * kPage);
+    EXPECT_EQ(*stats->pool_bytes, 8 * kPage);
+    EXPECT_DOUBLE_EQ(*stats->fragmentation, 0.5);
+
+    // Chunks next to remapped memory are freed without merging across it,
+    // and the remaining free memory can be defragmented again.
+    for (int i = 1; i < 8; i += 2) a.DeallocateRaw(ptrs[i]);
+    a.DeallocateRaw(big);
+    void* all = a.AllocateRaw(64, 8 * kPage, no_retry);
+    ASSERT_NE(all, nullptr);
+    EXPECT_EQ(a.GetStats()->num_defragmentations, 2);
+    a.DeallocateRaw(all);
+    EXPECT_EQ(a.GetStats()->bytes_in_use, 0);
+  }
+}
+
+// Each of `state.range(0)` threads repeatedly allocates and frees a few small
+// host buffers, as concurrently running kernels do. `state.range(1)` selects
+// whether the per-thread caches are enabled.
+static void BM_AllocationThreaded(::testing::benchmark::State& state) {
+  const int num_threads = state.range(0);
+  const bool use_thread_cache = state.range(1);
+  constexpr int kAllocationsPerThread = 10000;
+  auto a = NewAllocator(use_thread_cache ? 4096 : 0, 1 << 28);
+  thread::ThreadPool pool(Env::Default(), "test", num_threads);
+  for (auto s : state) {
+    BlockingCounter done(num_threads);
+    for (int t = 0; t < num_threads; ++t) {
+      pool.Schedule([&a, &done]() {
+        void* ptrs[4];
+        for (int i = 0; i < kAllocationsPerThread; ++i) {
+          for (int j = 0; j < 4; ++j) {
+            ptrs[j] = a->AllocateRaw(64, 64 << j);
+          }
+          for (int j = 0; j < 4; ++j) {
+            a->DeallocateRaw(ptrs[j]);
+          }
+        }
+        done.DecrementCount();
+      });
+    }
+    done.Wait();
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                          num_threads * kAllocationsPerThread * 4);
+}
+BENCHMARK(BM_AllocationThreaded)
+    ->UseRealTime()
+    ->ArgPair(1, 0)
+    ->ArgPair(1, 1)
+    ->ArgPair(4, 0)
+    ->ArgPair(4, 1)
+    ->ArgPair(16, 0)
+    ->ArgPair(16, 1)
+    ->ArgPair(64, 0)
+    ->ArgPair(64, 1);
+
+}  // namespace
+}  // namespace tsl
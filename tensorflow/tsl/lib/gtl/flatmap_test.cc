@@ -22,8 +22,11 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/str_cat.h"
 #include "tensorflow/tsl/platform/hash.h"
 #include "tensorflow/tsl/platform/test.h"
+#include "tensorflow/tsl/platform/test_benchmark.h"
 #include "tensorflow/tsl/platform/types.h"
 
 namespace tsl {
@@ -705,6 +708,125 @@ TEST(FlatMap, UniqueMapIter) {
   EXPECT_EQ(val_sum, key_sum + (kCount * kValueDelta));
 }
 
+TEST(FlatMap, EraseAndReinsertMany) {
+  NumMap map;
+  std::unordered_map<int64_t, int32> expected;
+  // Interleaves inserts and erases so that buckets see both deleted and
+  // reused entries.
+  for (int64_t i = 0; i < 10000; i++) {
+    map[i] = i;
+    expected[i] = i;
+    if (i % 3 == 0) {
+      map.erase(i / 2);
+      expected.erase(i / 2);
+    }
+  }
+  EXPECT_EQ(map.size(), expected.size());
+  for (int64_t i = 0; i < 10000; i++) {
+    auto iter = expected.find(i);
+    EXPECT_EQ(Get(map, i), iter == expected.end() ? -1 : iter->second);
+  }
+}
+
+//===----------------------------------------------------------------------===//
+// Performance benchmarks below, comparing with absl::flat_hash_map.
+//===----------------------------------------------------------------------===//
+
+// Keys shaped like rendezvous keys.
+std::vector<std::string> RendezvousKeys(int n) {
+  std::vector<std::string> keys;
+  keys.reserve(n);
+  for (int i = 0; i < n; i++) {
+    keys.push_back(absl::StrCat(
+        "/job:worker/replica:0/task:0/device:CPU:0;0000000000000001;",
+        "/job:worker/replica:0/task:0/device:GPU:0;edge_", i, "_op;0:0"));
+  }
+  return keys;
+}
+
+template <typename Map>
+void LookupInt64(::testing::benchmark::State& state) {
+  const int n = state.range(0);
+  Map map;
+  for (int64_t i = 0; i < n; i++) map[i * 7919] = i;
+  int64_t i = 0;
+  for (auto _ : state) {
+    testing::DoNotOptimize(map.find((i++ % n) * 7919));
+  }
+}
+
+template <typename Map>
+void LookupMissInt64(::testing::benchmark::State& state) {
+  const int n = state.range(0);
+  Map map;
+  for (int64_t i = 0; i < n; i++) map[i * 7919] = i;
+  int64_t i = 0;
+  for (auto _ : state) {
+    testing::DoNotOptimize(map.find((i++ % n) * 7919 + 1));
+  }
+}
+
+template <typename Map>
+void LookupString(::testing::benchmark::State& state) {
+  const std::vector<std::string> keys = RendezvousKeys(state.range(0));
+  Map map;
+  for (int i = 0; i < keys.size(); i++) map[keys[i]] = i;
+  size_t i = 0;
+  for (auto _ : state) {
+    testing::DoNotOptimize(map.find(keys[i++ % keys.size()]));
+  }
+}
+
+// Inserts a key and erases an older one, keeping a steady number of keys, as
+// a rendezvous table does.
+template <typename Map>
+void InsertEraseString(::testing::benchmark::State& state) {
+  const int n = state.range(0);
+  const std::vector<std::string> keys = RendezvousKeys(2 * n);
+  Map map;
+  for (int i = 0; i < n; i++) map[keys[i]] = i;
+  size_t i = 0;
+  for (auto _ : state) {
+    map[keys[(i + n) % keys.size()]] = i;
+    map.erase(keys[i % keys.size()]);
+    i++;
+  }
+}
+
+void BM_FlatMapLookupInt64(::testing::benchmark::State& state) {
+  LookupInt64<FlatMap<int64_t, int64_t>>(state);
+}
+void BM_AbslLookupInt64(::testing::benchmark::State& state) {
+  LookupInt64<absl::flat_hash_map<int64_t, int64_t>>(state);
+}
+void BM_FlatMapLookupMissInt64(::testing::benchmark::State& state) {
+  LookupMissInt64<FlatMap<int64_t, int64_t>>(state);
+}
+void BM_AbslLookupMissInt64(::testing::benchmark::State& state) {
+  LookupMissInt64<absl::flat_hash_map<int64_t, int64_t>>(state);
+}
+void BM_FlatMapLookupString(::testing::benchmark::State& state) {
+  LookupString<FlatMap<std::string, int64_t>>(state);
+}
+void BM_AbslLookupString(::testing::benchmark::State& state) {
+  LookupString<absl::flat_hash_map<std::string, int64_t>>(state);
+}
+void BM_FlatMapInsertEraseString(::testing::benchmark::State& state) {
+  InsertEraseString<FlatMap<std::string, int64_t>>(state);
+}
+void BM_AbslInsertEraseString(::testing::benchmark::State& state) {
+  InsertEraseString<absl::flat_hash_map<std::string, int64_t>>(state);
+}
+
+BENCHMARK(BM_FlatMapLookupInt64)->Arg(16)->Arg(1024)->Arg(1 << 16);
+BENCHMARK(BM_AbslLookupInt64)->Arg(16)->Arg(1024)->Arg(1 << 16);
+BENCHMARK(BM_FlatMapLookupMissInt64)->Arg(16)->Arg(1024)->Arg(1 << 16);
+BENCHMARK(BM_AbslLookupMissInt64)->Arg(16)->Arg(1024)->Arg(1 << 16);
+BENCHMARK(BM_FlatMapLookupString)->Arg(16)->Arg(1024)->Arg(1 << 16);
+BENCHMARK(BM_AbslLookupString)->Arg(16)->Arg(1024)->Arg(1 << 16);
+BENCHMARK(BM_FlatMapInsertEraseString)->Arg(16)->Arg(1024);
+BENCHMARK(BM_AbslInsertEraseString)->Arg(16)->Arg(1024);
+
 }  // namespace
 }  // namespace gtl
 }  // namespace tsl
@@ -20,13 +20,111 @@ limitations under the License.
 
 #include <utility>
 
+#include "absl/numeric/bits.h"
 #include "tensorflow/tsl/platform/prefetch.h"
 #include "tensorflow/tsl/platform/types.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 namespace tsl {
 namespace gtl {
 namespace internal {
 
+// A set of entries of a bucket, as returned by MarkerGroup::Match(). Entry i
+// is in the set if a bit of `bits` whose index is i after shifting right by
+// kShift is set; see MarkerGroup for the encodings.
+template <uint32 kShift>
+class MarkerMask {
+ public:
+  explicit MarkerMask(uint64 bits) : bits_(bits) {}
+
+  explicit operator bool() const { return bits_ != 0; }
+
+  // Returns the index of the first entry in the set. The set must not be
+  // empty.
+  uint32 Lowest() const { return absl::countr_zero(bits_) >> kShift; }
+
+  // Removes the first entry from the set.
+  void ClearLowest() { bits_ &= bits_ - 1; }
+
+ private:
+  uint64 bits_;
+};
+
+// The markers of all the entries of a bucket, matched in parallel.
+#if defined(__SSE2__)
+
+// SSE2: a bucket holds 16 entries, and entry i of a mask is bit i.
+class MarkerGroup {
+ public:
+  static constexpr uint32 kBase = 4;
+  using Mask = MarkerMask<0>;
+
+  explicit MarkerGroup(const uint8* markers)
+      : markers_(_mm_loadu_si128(reinterpret_cast<const __m128i*>(markers))) {}
+
+  // Returns the entries whose marker is `marker`.
+  Mask Match(uint8 marker) const {
+    const __m128i match = _mm_set1_epi8(static_cast<char>(marker));
+    return Mask(static_cast<uint32>(
+        _mm_movemask_epi8(_mm_cmpeq_epi8(match, markers_))));
+  }
+
+ private:
+  __m128i markers_;
+};
+
+#else
+
+// NEON and portable: a bucket holds 8 entries, and entry i of a mask is the
+// high bit of byte i, i.e. bit 8 * i + 7.
+class MarkerGroup {
+ public:
+  static constexpr uint32 kBase = 3;
+  using Mask = MarkerMask<3>;
+
+  explicit MarkerGroup(const uint8* markers) {
+#if defined(__ARM_NEON)
+    markers_ = vld1_u8(markers);
+#else
+    // Little-endian load; compiles to a single load on little-endian targets.
+    markers_ = 0;
+    for (uint32 i = 0; i < 8; ++i) {
+      markers_ |= static_cast<uint64>(markers[i]) << (8 * i);
+    }
+#endif
+  }
+
+  // Returns the entries whose marker is `marker`.
+  Mask Match(uint8 marker) const {
+#if defined(__ARM_NEON)
+    const uint64 match = vget_lane_u64(
+        vreinterpret_u64_u8(vceq_u8(markers_, vdup_n_u8(marker))), 0);
+    return Mask(match & kMsbs);
+#else
+    // The bytes of x are zero exactly for the matching entries. Unlike the
+    // usual (x - lsbs) & ~x trick, this test has no false positives.
+    const uint64 x = markers_ ^ (kLsbs * marker);
+    return Mask(~(((x & ~kMsbs) + ~kMsbs) | x) & kMsbs);
+#endif
+  }
+
+ private:
+  static constexpr uint64 kMsbs = 0x8080808080808080ULL;
+#if defined(__ARM_NEON)
+  uint8x8_t markers_;
+#else
+  static constexpr uint64 kLsbs = 0x0101010101010101ULL;
+  uint64 markers_;
+#endif
+};
+
+#endif
+
 // Internal representation for FlatMap and FlatSet.
 //
 // The representation is an open-addressed hash table.  Conceptually,
@@ -41,13 +139,18 @@ namespace internal {
 //      These hash bits can be used to avoid potentially expensive
 //      key comparisons.
 //
+// The markers of a bucket are matched in parallel (with SSE2 or NEON when
+// available), so a probe examines a whole bucket at once: a key hashes to a
+// bucket, buckets are probed quadratically, and a probe stops at the first
+// bucket holding an empty entry.
+//
 // FlatMap passes in a bucket that contains keys and values, FlatSet
 // passes in a bucket that does not contain values.
 template <typename Key, typename Bucket, class Hash, class Eq>
 class FlatRep {
  public:
   // kWidth is the number of entries stored in a bucket.
-  static constexpr uint32 kBase = 3;
+  static constexpr uint32 kBase = MarkerGroup::kBase;
   static constexpr uint32 kWidth = (1 << kBase);
 
   FlatRep(size_t N, const Hash& hf, const Eq& eq) : hash_(hf), equal_(eq) {
@@ -138,22 +241,24 @@ class FlatRep {
 
   // Hash value is partitioned as follows:
   // 1. Bottom 8 bits are stored in bucket to help speed up comparisons.
-  // 2. Next 3 bits give index inside bucket.
-  // 3. Remaining bits give bucket number.
+  // 2. Remaining bits give bucket number.
 
   // Find bucket/index for key k.
   SearchResult Find(const Key& k) const {
     size_t h = hash_(k);
     const uint32 marker = Marker(h & 0xff);
-    size_t index = (h >> 8) & mask_;  // Holds bucket num and index-in-bucket
-    uint32 num_probes = 1;            // Needed for quadratic probing
+    size_t index = BucketIndex(h);
+    uint32 num_probes = 1;  // Needed for quadratic probing
     while (true) {
-      uint32 bi = index & (kWidth - 1);
-      Bucket* b = &array_[index >> kBase];
-      const uint32 x = b->marker[bi];
-      if (x == marker && equal_(b->key(bi), k)) {
-        return {true, b, bi};
-      } else if (x == kEmpty) {
+      Bucket* b = &array_[index];
+      const MarkerGroup group(b->marker);
+      for (auto m = group.Match(marker); m; m.ClearLowest()) {
+        const uint32 bi = m.Lowest();
+        if (equal_(b->key(bi), k)) {
+          return {true, b, bi};
+        }
+      }
+      if (group.Match(kEmpty)) {
         return {false, nullptr, 0};
       }
       index = NextIndex(index, num_probes);
@@ -170,27 +275,35 @@ class FlatRep {
   SearchResult FindOrInsert(KeyType&& k) {
     size_t h = hash_(k);
     const uint32 marker = Marker(h & 0xff);
-    size_t index = (h >> 8) & mask_;  // Holds bucket num and index-in-bucket
-    uint32 num_probes = 1;            // Needed for quadratic probing
-    Bucket* del = nullptr;            // First encountered deletion for kInsert
+    size_t index = BucketIndex(h);
+    uint32 num_probes = 1;  // Needed for quadratic probing
+    Bucket* del = nullptr;  // First encountered deletion for kInsert
     uint32 di = 0;
     while (true) {
-      uint32 bi = index & (kWidth - 1);
-      Bucket* b = &array_[index >> kBase];
-      const uint32 x = b->marker[bi];
-      if (x == marker && equal_(b->key(bi), k)) {
-        return {true, b, bi};
-      } else if (!del && x == kDeleted) {
+      Bucket* b = &array_[index];
+      const MarkerGroup group(b->marker);
+      for (auto m = group.Match(marker); m; m.ClearLowest()) {
+        const uint32 bi = m.Lowest();
+        if (equal_(b->key(bi), k)) {
+          return {true, b, bi};
+        }
+      }
+      if (!del) {
         // Remember deleted index to use for insertion.
-        del = b;
-        di = bi;
-      } else if (x == kEmpty) {
+        if (auto deleted = group.Match(kDeleted)) {
+          del = b;
+          di = deleted.Lowest();
+        }
+      }
+      if (auto empty = group.Match(kEmpty)) {
+        uint32 bi;
         if (del) {
           // Store in the first deleted slot we encountered
           b = del;
           bi = di;
           deleted_--;  // not_empty_ does not change
         } else {
+          bi = empty.Lowest();
           not_empty_++;
         }
         b->marker[bi] = marker;
@@ -204,18 +317,24 @@ class FlatRep {
 
   void Erase(Bucket* b, uint32 i) {
     b->Destroy(i);
-    b->marker[i] = kDeleted;
-    deleted_++;
+    // A bucket with an empty entry has never been probed past, since probes
+    // stop at it and buckets only get empty entries this way. So the erased
+    // entry can be made empty rather than deleted, which keeps probes short.
+    if (MarkerGroup(b->marker).Match(kEmpty)) {
+      b->marker[i] = kEmpty;
+      not_empty_--;
+    } else {
+      b->marker[i] = kDeleted;
+      deleted_++;
+    }
     grow_ = 0;  // Consider shrinking on next insert
   }
 
   void Prefetch(const Key& k) const {
     size_t h = hash_(k);
-    size_t index = (h >> 8) & mask_;  // Holds bucket num and index-in-bucket
-    uint32 bi = index & (kWidth - 1);
-    Bucket* b = &array_[index >> kBase];
-    port::prefetch<port::PREFETCH_HINT_T0>(&b->marker[bi]);
-    port::prefetch<port::PREFETCH_HINT_T0>(&b->storage.key[bi]);
+    Bucket* b = &array_[BucketIndex(h)];
+    port::prefetch<port::PREFETCH_HINT_T0>(&b->marker[0]);
+    port::prefetch<port::PREFETCH_HINT_T0>(&b->storage.key[0]);
   }
 
   inline void MaybeResize() {
@@ -322,13 +441,12 @@ class FlatRep {
   void FreshInsert(Bucket* src, uint32 src_index, Copier copier) {
     size_t h = hash_(src->key(src_index));
     const uint32 marker = Marker(h & 0xff);
-    size_t index = (h >> 8) & mask_;  // Holds bucket num and index-in-bucket
-    uint32 num_probes = 1;            // Needed for quadratic probing
+    size_t index = BucketIndex(h);
+    uint32 num_probes = 1;  // Needed for quadratic probing
     while (true) {
-      uint32 bi = index & (kWidth - 1);
-      Bucket* b = &array_[index >> kBase];
-      const uint32 x = b->marker[bi];
-      if (x == 0) {
+      Bucket* b = &array_[index];
+      if (auto empty = MarkerGroup(b->marker).Match(kEmpty)) {
+        const uint32 bi = empty.Lowest();
         b->marker[bi] = marker;
         not_empty_++;
         copier(b, bi, src, src_index);
@@ -339,9 +457,14 @@ class FlatRep {
     }
   }
 
+  // Returns the number of the first bucket probed for hash value h.
+  inline size_t BucketIndex(size_t h) const {
+    return (h >> 8) & (mask_ >> kBase);
+  }
+
   inline size_t NextIndex(size_t i, uint32 num_probes) const {
-    // Quadratic probing.
-    return (i + num_probes) & mask_;
+    // Quadratic probing over buckets.
+    return (i + num_probes) & (mask_ >> kBase);
   }
 };
 
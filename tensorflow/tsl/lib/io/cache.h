@@ -26,10 +26,11 @@ limitations under the License.
 // length strings, may use the length of the string as the charge for
 // the string.
 //
-// A builtin cache implementation with a least-recently-used eviction
-// policy is provided.  Clients may use their own implementations if
-// they want something more sophisticated (like scan-resistance, a
-// custom eviction policy, variable cache sizing, etc.)
+// Two builtin cache implementations are provided: one with a
+// least-recently-used eviction policy, and one with a scan-resistant
+// CLOCK eviction policy whose lookups take no lock.  Clients may use
+// their own implementations if they want something more sophisticated
+// (like a custom eviction policy, variable cache sizing, etc.)
 
 namespace tsl {
 
@@ -43,6 +44,19 @@ class Cache;
 // of Cache uses a least-recently-used eviction policy.
 Cache* NewLRUCache(size_t capacity);
 
+// Create a new cache with a fixed size capacity.  This implementation
+// of Cache uses a CLOCK eviction policy: a lookup marks its entry as
+// used without taking a lock, and eviction skips the entries used since
+// it last looked at them.  New entries start out unused, so that a scan
+// over many entries evicts the other scanned entries before the ones in
+// regular use.
+//
+// The hash table of the cache has a fixed number of slots, sized for
+// entries of "estimated_entry_charge", e.g. the table block size.  If the
+// entries are much smaller, the cache holds fewer of them than its
+// capacity allows.
+Cache* NewClockCache(size_t capacity, size_t estimated_entry_charge);
+
 class Cache {
  public:
   Cache() = default;
@@ -15,12 +15,17 @@ limitations under the License.
 
 #include "tensorflow/tsl/lib/io/cache.h"
 
+#include <memory>
 #include <string>
 #include <vector>
 
+#include "tensorflow/tsl/lib/random/philox_random.h"
+#include "tensorflow/tsl/lib/random/simple_philox.h"
 #include "tensorflow/tsl/platform/coding.h"
+#include "tensorflow/tsl/platform/env.h"
 #include "tensorflow/tsl/platform/raw_coding.h"
 #include "tensorflow/tsl/platform/test.h"
+#include "tensorflow/tsl/platform/test_benchmark.h"
 
 namespace tsl {
 
@@ -38,7 +43,19 @@ static int DecodeKey(const Slice& k) {
 static void* EncodeValue(uintptr_t v) { return reinterpret_cast<void*>(v); }
 static int DecodeValue(void* v) { return reinterpret_cast<uintptr_t>(v); }
 
-class CacheTest : public ::testing::Test {
+enum class CacheType { kLRU, kClock };
+
+Cache* NewCache(CacheType type, size_t capacity) {
+  switch (type) {
+    case CacheType::kLRU:
+      return NewLRUCache(capacity);
+    case CacheType::kClock:
+      return NewClockCache(capacity, /*estimated_entry_charge=*/1);
+  }
+  return nullptr;
+}
+
+class CacheTest : public ::testing::TestWithParam<CacheType> {
  public:
   static void Deleter(const Slice& key, void* v) {
     current_->deleted_keys_.push_back(DecodeKey(key));
@@ -50,7 +67,7 @@ class CacheTest : public ::testing::Test {
   std::vector<int> deleted_values_;
   Cache* cache_;
 
-  CacheTest() : cache_(NewLRUCache(kCacheSize)) { current_ = this; }
+  CacheTest() : cache_(NewCache(GetParam(), kCacheSize)) { current_ = this; }
 
   ~CacheTest() { delete cache_; }
 
@@ -74,11 +91,12 @@ class CacheTest : public ::testing::Test {
   }
 
   void Erase(int key) { cache_->Erase(EncodeKey(key)); }
+  static void NoopDeleter(const Slice& key, void* v) {}
   static CacheTest* current_;
 };
 CacheTest* CacheTest::current_;
 
-TEST_F(CacheTest, HitAndMiss) {
+TEST_P(CacheTest, HitAndMiss) {
   ASSERT_EQ(-1, Lookup(100));
 
   Insert(100, 101);
@@ -101,7 +119,7 @@ TEST_F(CacheTest, HitAndMiss) {
   ASSERT_EQ(101, deleted_values_[0]);
 }
 
-TEST_F(CacheTest, Erase) {
+TEST_P(CacheTest, Erase) {
   Erase(200);
   ASSERT_EQ(0, deleted_keys_.size());
 
@@ -120,7 +138,7 @@ TEST_F(CacheTest, Erase) {
   ASSERT_EQ(1, deleted_keys_.size());
 }
 
-TEST_F(CacheTest, EntriesArePinned) {
+TEST_P(CacheTest, EntriesArePinned) {
   Insert(100, 101);
   Cache::Handle* h1 = cache_->Lookup(EncodeKey(100));
   ASSERT_EQ(101, DecodeValue(cache_->Value(h1)));
@@ -145,7 +163,7 @@ TEST_F(CacheTest, EntriesArePinned) {
   ASSERT_EQ(102, deleted_values_[1]);
 }
 
-TEST_F(CacheTest, EvictionPolicy) {
+TEST_P(CacheTest, EvictionPolicy) {
   Insert(100, 101);
   Insert(200, 201);
   Insert(300, 301);
@@ -164,7 +182,7 @@ TEST_F(CacheTest, EvictionPolicy) {
   cache_->Release(h);
 }
 
-TEST_F(CacheTest, UseExceedsCacheSize) {
+TEST_P(CacheTest, UseExceedsCacheSize) {
   // Overfill the cache, keeping handles on all inserted entries.
   std::vector<Cache::Handle*> h;
   for (int i = 0; i < kCacheSize + 100; i++) {
@@ -181,7 +199,7 @@ TEST_F(CacheTest, UseExceedsCacheSize) {
   }
 }
 
-TEST_F(CacheTest, HeavyEntries) {
+TEST_P(CacheTest, HeavyEntries) {
   // Add a bunch of light and heavy entries and then count the combined
   // size of items still in the cache, which must be approximately the
   // same as the total capacity.
@@ -208,13 +226,13 @@ TEST_F(CacheTest, HeavyEntries) {
   ASSERT_LE(cached_weight, kCacheSize + kCacheSize / 10);
 }
 
-TEST_F(CacheTest, NewId) {
+TEST_P(CacheTest, NewId) {
   uint64_t a = cache_->NewId();
   uint64_t b = cache_->NewId();
   ASSERT_NE(a, b);
 }
 
-TEST_F(CacheTest, Prune) {
+TEST_P(CacheTest, Prune) {
   Insert(1, 100);
   Insert(2, 200);
 
@@ -227,13 +245,114 @@ TEST_F(CacheTest, Prune) {
   ASSERT_EQ(-1, Lookup(2));
 }
 
-TEST_F(CacheTest, ZeroSizeCache) {
+TEST_P(CacheTest, ZeroSizeCache) {
   delete cache_;
-  cache_ = NewLRUCache(0);
+  cache_ = NewCache(GetParam(), 0);
 
   Insert(1, 100);
   ASSERT_EQ(-1, Lookup(1));
 }
 
+TEST_P(CacheTest, ConcurrentAccess) {
+  constexpr int kNumThreads = 8;
+  constexpr int kNumKeys = 2 * kCacheSize;
+  std::vector<std::unique_ptr<Thread>> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back(Env::Default()->StartThread(
+        ThreadOptions(), "cache_test", [this, t]() {
+          random::PhiloxRandom philox(t);
+          random::SimplePhilox rnd(&philox);
+          for (int i = 0; i < 10000; i++) {
+            const int key = rnd.Uniform(kNumKeys);
+            Cache::Handle* handle = cache_->Lookup(EncodeKey(key));
+            if (handle == nullptr) {
+              handle = cache_->Insert(EncodeKey(key), EncodeValue(key + 1000),
+                                      1, &CacheTest::NoopDeleter);
+            }
+            ASSERT_EQ(key + 1000, DecodeValue(cache_->Value(handle)));
+            if (rnd.OneIn(10)) cache_->Erase(EncodeKey(key));
+            cache_->Release(handle);
+          }
+        }));
+  }
+  threads.clear();
+  ASSERT_LE(cache_->TotalCharge(), kCacheSize + kCacheSize / 10);
+}
+
+INSTANTIATE_TEST_SUITE_P(CacheTests, CacheTest,
+                         ::testing::Values(CacheType::kLRU,
+                                           CacheType::kClock));
+
+TEST(ClockCacheTest, ScanResistance) {
+  constexpr int kCacheSize = 1000;
+  std::unique_ptr<Cache> cache(
+      NewClockCache(kCacheSize, /*estimated_entry_charge=*/1));
+  auto insert = [&cache](int key) {
+    cache->Release(cache->Insert(EncodeKey(key), EncodeValue(key), 1,
+                                 &CacheTest::NoopDeleter));
+  };
+  auto lookup = [&cache](int key) {
+    Cache::Handle* handle = cache->Lookup(EncodeKey(key));
+    if (handle == nullptr) return false;
+    cache->Release(handle);
+    return true;
+  };
+
+  // A working set that is used repeatedly...
+  constexpr int kNumHotKeys = kCacheSize / 4;
+  for (int key = 0; key < kNumHotKeys; key++) insert(key);
+  for (int i = 0; i < 3; i++) {
+    for (int key = 0; key < kNumHotKeys; key++) ASSERT_TRUE(lookup(key));
+  }
+  // ...survives a scan over as many keys as the cache holds.
+  for (int key = kNumHotKeys; key < kNumHotKeys + kCacheSize; key++) {
+    if (!lookup(key)) insert(key);
+  }
+  int num_hot_hits = 0;
+  for (int key = 0; key < kNumHotKeys; key++) num_hot_hits += lookup(key);
+  EXPECT_GE(num_hot_hits, kNumHotKeys * 9 / 10);
+}
+
+// Looks up keys with a skewed distribution from several threads, inserting
+// the missing ones.  Reports the hit rate along with the throughput.
+void BM_CacheLookup(::testing::benchmark::State& state) {
+  constexpr int kCapacity = 10000;
+  constexpr int kNumKeys = 4 * kCapacity;
+  static Cache* cache = nullptr;
+  if (state.thread_index() == 0) {
+    cache = NewCache(static_cast<CacheType>(state.range(0)), kCapacity);
+  }
+  random::PhiloxRandom philox(state.thread_index());
+  random::SimplePhilox rnd(&philox);
+  int64_t hits = 0;
+  int64_t lookups = 0;
+  for (auto s : state) {
+    // Skewed towards the small keys: 90% of the lookups hit 10% of the keys.
+    const int key = rnd.OneIn(10) ? rnd.Uniform(kNumKeys)
+                                  : rnd.Uniform(kNumKeys / 10);
+    const std::string encoded_key = EncodeKey(key);
+    Cache::Handle* handle = cache->Lookup(encoded_key);
+    if (handle != nullptr) {
+      hits++;
+    } else {
+      handle = cache->Insert(encoded_key, EncodeValue(key), 1,
+                             &CacheTest::NoopDeleter);
+    }
+    cache->Release(handle);
+    lookups++;
+  }
+  state.counters["hit_rate"] = ::benchmark::Counter(
+      static_cast<double>(hits) / lookups, ::benchmark::Counter::kAvgThreads);
+  if (state.thread_index() == 0) {
+    delete cache;
+    cache = nullptr;
+  }
+}
+BENCHMARK(BM_CacheLookup)
+    ->Arg(static_cast<int>(CacheType::kLRU))
+    ->Arg(static_cast<int>(CacheType::kClock))
+    ->ThreadRange(1, 16)
+    ->UseRealTime();
+
 }  // namespace table
 }  // namespace tsl
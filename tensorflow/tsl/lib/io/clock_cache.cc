@@ -0,0 +1,425 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <assert.h>
+
+#include <atomic>
+#include <memory>
+#include <string>
+
+#include "tensorflow/tsl/lib/io/cache.h"
+#include "tensorflow/tsl/platform/hash.h"
+#include "tensorflow/tsl/platform/mutex.h"
+
+namespace tsl {
+
+namespace table {
+
+namespace {
+
+// CLOCK cache implementation
+//
+// Each shard keeps its entries in a fixed-size open addressing hash table with
+// linear probing.  All the state of an entry that lookups depend on is packed
+// in one atomic word, "meta", so that a lookup is a probe of the table and one
+// atomic increment of the reference count, with no lock and no list to
+// reorder:
+// - refs:  references held by clients.  Lookups may also briefly hold a
+//   reference on an entry they end up not returning.
+// - clock:  a saturating usage counter.  Lookups increment it, and the clock
+//   hand decrements it on every pass.  An unreferenced entry is evicted when
+//   the clock hand finds it at zero.  New entries start at zero, so that
+//   entries touched only once or twice, e.g. by a scan, go before the ones in
+//   regular use.
+// - state:  one of
+//   - empty:  the slot holds no entry.
+//   - construction:  a thread has exclusive access to the slot, to fill or to
+//     free it.
+//   - visible:  the entry is in the cache.
+//   - invisible:  the entry was erased or replaced while still referenced.  It
+//     is freed by the last Release().
+//
+// Insert(), Erase(), Prune() and eviction are serialized by a mutex per shard.
+// Since a slot is only reused once it is unreferenced, a lookup that holds a
+// reference may read the key of the slot without further synchronization.
+//
+// A lookup stops probing at a slot that no entry was displaced past, which is
+// tracked by the "displacements" count of every slot.
+
+constexpr int kClockShift = 30;
+constexpr int kStateShift = 32;
+constexpr uint64_t kRefsMask = (uint64_t{1} << kClockShift) - 1;
+constexpr uint64_t kClockMask = uint64_t{3} << kClockShift;
+constexpr uint64_t kMaxClock = 3;
+
+enum State : uint64_t {
+  kEmpty = 0,
+  kConstruction = 1,
+  kVisible = 2,
+  kInvisible = 3,
+};
+
+// Aim for a table at most 70% full, to keep the probes short.
+constexpr size_t kLoadFactorPercent = 70;
+constexpr size_t kMinSlotsPerShard = 16;
+
+inline uint64_t Refs(uint64_t meta) { return meta & kRefsMask; }
+inline uint64_t Clock(uint64_t meta) {
+  return (meta & kClockMask) >> kClockShift;
+}
+inline State GetState(uint64_t meta) {
+  return static_cast<State>(meta >> kStateShift);
+}
+inline uint64_t StateBits(State state) {
+  return static_cast<uint64_t>(state) << kStateShift;
+}
+
+struct ClockHandle {
+  std::atomic<uint64_t> meta{0};
+  // Number of entries whose probe sequence went past this slot.
+  std::atomic<uint32_t> displacements{0};
+  // Atomic so that lookups can skip slots of other keys without taking a
+  // reference first.
+  std::atomic<uint32_t> hash{0};
+  // Whether the entry is outside of the table, e.g. in a zero-size cache.
+  bool standalone = false;
+  void* value = nullptr;
+  void (*deleter)(const Slice&, void* value) = nullptr;
+  size_t charge = 0;
+  std::string key;
+};
+
+// A single shard of sharded cache.
+class ClockCacheShard {
+ public:
+  ClockCacheShard() = default;
+  ~ClockCacheShard();
+
+  // Separate from constructor so caller can easily make an array of shards.
+  void Init(size_t capacity, size_t estimated_entry_charge);
+
+  // Like Cache methods, but with an extra "hash" parameter.
+  Cache::Handle* Insert(const Slice& key, uint32_t hash, void* value,
+                        size_t charge,
+                        void (*deleter)(const Slice& key, void* value));
+  Cache::Handle* Lookup(const Slice& key, uint32_t hash);
+  void Release(Cache::Handle* handle);
+  void Erase(const Slice& key, uint32_t hash);
+  void Prune();
+  size_t TotalCharge() const { return usage_.load(std::memory_order_relaxed); }
+
+ private:
+  size_t Index(uint32_t hash, size_t probe) const {
+    return (hash + probe) & mask_;
+  }
+
+  // Drops a reference on "h", freeing it if it was the last reference of an
+  // invisible entry.
+  void Unref(ClockHandle* h);
+
+  // Claims an empty slot for an entry with "hash", or returns nullptr if the
+  // table is full.
+  ClockHandle* Claim(uint32_t hash) TF_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  // Frees the entry of "h", which the caller put in the construction state.
+  void Free(ClockHandle* h);
+
+  // Advances the clock hand by one slot.  Returns whether it evicted an entry.
+  bool EvictNext() TF_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  // Initialized before use.
+  size_t capacity_ = 0;
+  size_t max_occupancy_ = 0;
+  size_t mask_ = 0;
+  std::unique_ptr<ClockHandle[]> slots_;
+
+  std::atomic<size_t> usage_{0};
+  std::atomic<size_t> occupancy_{0};
+
+  // mutex_ serializes the changes to the table, but not the lookups.
+  mutex mutex_;
+  size_t clock_hand_ TF_GUARDED_BY(mutex_) = 0;
+};
+
+ClockCacheShard::~ClockCacheShard() {
+  for (size_t i = 0; i <= mask_ && slots_ != nullptr; i++) {
+    ClockHandle* h = &slots_[i];
+    const uint64_t meta = h->meta.load(std::memory_order_relaxed);
+    if (GetState(meta) == kEmpty) continue;
+    // Error if caller has an unreleased handle
+    assert(GetState(meta) == kVisible && Refs(meta) == 0);
+    h->meta.store(StateBits(kConstruction), std::memory_order_relaxed);
+    Free(h);
+  }
+}
+
+void ClockCacheShard::Init(size_t capacity, size_t estimated_entry_charge) {
+  capacity_ = capacity;
+  const size_t estimated_entries =
+      capacity / (estimated_entry_charge > 0 ? estimated_entry_charge : 1);
+  size_t num_slots = kMinSlotsPerShard;
+  while (num_slots * kLoadFactorPercent / 100 < estimated_entries) {
+    num_slots *= 2;
+  }
+  mask_ = num_slots - 1;
+  max_occupancy_ = num_slots * kLoadFactorPercent / 100;
+  slots_.reset(new ClockHandle[num_slots]);
+}
+
+Cache::Handle* ClockCacheShard::Lookup(const Slice& key, uint32_t hash) {
+  for (size_t probe = 0; probe <= mask_; probe++) {
+    ClockHandle* h = &slots_[Index(hash, probe)];
+    if (GetState(h->meta.load(std::memory_order_acquire)) == kVisible &&
+        h->hash.load(std::memory_order_relaxed) == hash) {
+      const uint64_t old = h->meta.fetch_add(1, std::memory_order_acquire);
+      if (GetState(old) == kVisible && key == Slice(h->key)) {
+        // Hits on an entry in regular use find its count at the maximum and
+        // write nothing more.
+        constexpr uint64_t kClockOne = uint64_t{1} << kClockShift;
+        uint64_t meta = old + 1;
+        while (Clock(meta) < kMaxClock &&
+               !h->meta.compare_exchange_weak(meta, meta + kClockOne,
+                                              std::memory_order_relaxed)) {
+        }
+        return reinterpret_cast<Cache::Handle*>(h);
+      }
+      Unref(h);
+    }
+    if (h->displacements.load(std::memory_order_acquire) == 0) break;
+  }
+  return nullptr;
+}
+
+void ClockCacheShard::Release(Cache::Handle* handle) {
+  Unref(reinterpret_cast<ClockHandle*>(handle));
+}
+
+void ClockCacheShard::Unref(ClockHandle* h) {
+  uint64_t meta = h->meta.fetch_sub(1, std::memory_order_acq_rel) - 1;
+  // Only one thread may free the entry, so ownership is taken with a CAS.
+  while (GetState(meta) == kInvisible && Refs(meta) == 0) {
+    if (h->meta.compare_exchange_weak(meta, StateBits(kConstruction),
+                                      std::memory_order_acq_rel)) {
+      Free(h);
+      return;
+    }
+  }
+}
+
+Cache::Handle* ClockCacheShard::Insert(const Slice& key, uint32_t hash,
+                                       void* value, size_t charge,
+                                       void (*deleter)(const Slice& key,
+                                                       void* value)) {
+  mutex_lock l(mutex_);
+
+  ClockHandle* h = nullptr;
+  if (capacity_ > 0) {  // capacity_==0 is supported and turns off caching.
+    // The new entry replaces any entry with the same key.
+    Cache::Handle* old = Lookup(key, hash);
+    if (old != nullptr) {
+      ClockHandle* e = reinterpret_cast<ClockHandle*>(old);
+      e->meta.fetch_add(StateBits(kInvisible) - StateBits(kVisible),
+                        std::memory_order_acq_rel);
+      Unref(e);
+    }
+    // Every step lowers the clock count of an entry or evicts it, so the
+    // clock hand goes around at most kMaxClock + 1 times when nothing is in
+    // use.
+    const size_t max_steps = 2 * (kMaxClock + 1) * (mask_ + 1);
+    for (size_t step = 0;
+         step < max_steps &&
+         (usage_.load(std::memory_order_relaxed) + charge > capacity_ ||
+          occupancy_.load(std::memory_order_relaxed) >= max_occupancy_);
+         step++) {
+      EvictNext();
+    }
+    h = Claim(hash);
+  }
+  if (h == nullptr) {
+    // Don't cache, but still hand out a handle.
+    h = new ClockHandle;
+    h->standalone = true;
+  }
+
+  h->hash.store(hash, std::memory_order_relaxed);
+  h->value = value;
+  h->deleter = deleter;
+  h->charge = charge;
+  h->key.assign(key.data(), key.size());
+  if (h->standalone) {
+    h->meta.store(StateBits(kInvisible) + 1, std::memory_order_relaxed);
+  } else {
+    usage_.fetch_add(charge, std::memory_order_relaxed);
+    // Publishes the entry, with a reference for the returned handle.
+    h->meta.fetch_add(StateBits(kVisible) - StateBits(kConstruction) + 1,
+                      std::memory_order_release);
+  }
+  return reinterpret_cast<Cache::Handle*>(h);
+}
+
+ClockHandle* ClockCacheShard::Claim(uint32_t hash) {
+  // Past max_occupancy_, which eviction aims for, the probes get longer but
+  // entries in use still fit.
+  for (size_t probe = 0; probe <= mask_; probe++) {
+    ClockHandle* h = &slots_[Index(hash, probe)];
+    uint64_t meta = h->meta.load(std::memory_order_relaxed);
+    // Lookups may hold references on an empty slot for a short while; they
+    // are kept through the state changes.
+    if (GetState(meta) == kEmpty &&
+        h->meta.compare_exchange_strong(meta, meta + StateBits(kConstruction),
+                                        std::memory_order_acquire)) {
+      for (size_t i = 0; i < probe; i++) {
+        slots_[Index(hash, i)].displacements.fetch_add(
+            1, std::memory_order_relaxed);
+      }
+      occupancy_.fetch_add(1, std::memory_order_relaxed);
+      return h;
+    }
+  }
+  return nullptr;
+}
+
+void ClockCacheShard::Free(ClockHandle* h) {
+  if (h->standalone) {
+    (*h->deleter)(h->key, h->value);
+    delete h;
+    return;
+  }
+  (*h->deleter)(h->key, h->value);
+  usage_.fetch_sub(h->charge, std::memory_order_relaxed);
+  const size_t index = h - slots_.get();
+  const uint32_t hash = h->hash.load(std::memory_order_relaxed);
+  for (size_t i = hash & mask_; i != index; i = (i + 1) & mask_) {
+    slots_[i].displacements.fetch_sub(1, std::memory_order_release);
+  }
+  h->value = nullptr;
+  h->deleter = nullptr;
+  h->key.clear();
+  occupancy_.fetch_sub(1, std::memory_order_relaxed);
+  h->meta.fetch_sub(StateBits(kConstruction), std::memory_order_release);
+}
+
+bool ClockCacheShard::EvictNext() {
+  ClockHandle* h = &slots_[clock_hand_++ & mask_];
+  uint64_t meta = h->meta.load(std::memory_order_acquire);
+  if (GetState(meta) != kVisible || Refs(meta) != 0) return false;
+  if (Clock(meta) > 0) {
+    // Only the clock hand lowers the count, so it can't drop below zero.
+    h->meta.fetch_sub(uint64_t{1} << kClockShift, std::memory_order_relaxed);
+    return false;
+  }
+  if (!h->meta.compare_exchange_strong(meta, StateBits(kConstruction),
+                                       std::memory_order_acq_rel)) {
+    return false;
+  }
+  Free(h);
+  return true;
+}
+
+void ClockCacheShard::Erase(const Slice& key, uint32_t hash) {
+  mutex_lock l(mutex_);
+  Cache::Handle* handle = Lookup(key, hash);
+  if (handle != nullptr) {
+    ClockHandle* h = reinterpret_cast<ClockHandle*>(handle);
+    h->meta.fetch_add(StateBits(kInvisible) - StateBits(kVisible),
+                      std::memory_order_acq_rel);
+    Unref(h);
+  }
+}
+
+void ClockCacheShard::Prune() {
+  mutex_lock l(mutex_);
+  for (size_t i = 0; i <= mask_; i++) {
+    ClockHandle* h = &slots_[i];
+    uint64_t meta = h->meta.load(std::memory_order_acquire);
+    if (GetState(meta) == kVisible && Refs(meta) == 0 &&
+        h->meta.compare_exchange_strong(meta, StateBits(kConstruction),
+                                        std::memory_order_acq_rel)) {
+      Free(h);
+    }
+  }
+}
+
+static const int kNumShardBits = 4;
+static const int kNumShards = 1 << kNumShardBits;
+
+class ShardedClockCache : public Cache {
+ private:
+  ClockCacheShard shard_[kNumShards];
+  mutex id_mutex_;
+  uint64_t last_id_;
+
+  static inline uint32_t HashSlice(const Slice& s) {
+    return Hash32(s.data(), s.size(), 0);
+  }
+
+  static uint32_t Shard(uint32_t hash) { return hash >> (32 - kNumShardBits); }
+
+ public:
+  ShardedClockCache(size_t capacity, size_t estimated_entry_charge)
+      : last_id_(0) {
+    const size_t per_shard = (capacity + (kNumShards - 1)) / kNumShards;
+    for (int s = 0; s < kNumShards; s++) {
+      shard_[s].Init(per_shard, estimated_entry_charge);
+    }
+  }
+  ~ShardedClockCache() override {}
+  Handle* Insert(const Slice& key, void* value, size_t charge,
+                 void (*deleter)(const Slice& key, void* value)) override {
+    const uint32_t hash = HashSlice(key);
+    return shard_[Shard(hash)].Insert(key, hash, value, charge, deleter);
+  }
+  Handle* Lookup(const Slice& key) override {
+    const uint32_t hash = HashSlice(key);
+    return shard_[Shard(hash)].Lookup(key, hash);
+  }
+  void Release(Handle* handle) override {
+    ClockHandle* h = reinterpret_cast<ClockHandle*>(handle);
+    shard_[Shard(h->hash.load(std::memory_order_relaxed))].Release(handle);
+  }
+  void Erase(const Slice& key) override {
+    const uint32_t hash = HashSlice(key);
+    shard_[Shard(hash)].Erase(key, hash);
+  }
+  void* Value(Handle* handle) override {
+    return reinterpret_cast<ClockHandle*>(handle)->value;
+  }
+  uint64_t NewId() override {
+    mutex_lock l(id_mutex_);
+    return ++(last_id_);
+  }
+  void Prune() override {
+    for (int s = 0; s < kNumShards; s++) {
+      shard_[s].Prune();
+    }
+  }
+  size_t TotalCharge() const override {
+    size_t total = 0;
+    for (int s = 0; s < kNumShards; s++) {
+      total += shard_[s].TotalCharge();
+    }
+    return total;
+  }
+};
+
+}  // end anonymous namespace
+
+Cache* NewClockCache(size_t capacity, size_t estimated_entry_charge) {
+  return new ShardedClockCache(capacity, estimated_entry_charge);
+}
+
+}  // namespace table
+
+}  // namespace tsl
@@ -23,6 +23,8 @@ const char kNone[] = "";
 const char kGzip[] = "GZIP";
 const char kSnappy[] = "SNAPPY";
 const char kZlib[] = "ZLIB";
+const char kZstd[] = "ZSTD";
+const char kLz4[] = "LZ4";
 
 }  // namespace compression
 }  // namespace io
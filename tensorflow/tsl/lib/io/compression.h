@@ -24,6 +24,8 @@ extern const char kNone[];
 extern const char kGzip[];
 extern const char kSnappy[];
 extern const char kZlib[];
+extern const char kZstd[];
+extern const char kLz4[];
 
 }  // namespace compression
 }  // namespace io
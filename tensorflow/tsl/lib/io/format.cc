@@ -22,6 +22,7 @@ limitations under the License.
 #include "tensorflow/tsl/platform/coding.h"
 #include "tensorflow/tsl/platform/env.h"
 #include "tensorflow/tsl/platform/errors.h"
+#include "tensorflow/tsl/platform/hash.h"
 #include "tensorflow/tsl/platform/raw_coding.h"
 #include "tensorflow/tsl/platform/snappy.h"
 
@@ -162,5 +163,63 @@ Status ReadBlock(RandomAccessFile* file, const BlockHandle& handle,
   return OkStatus();
 }
 
+// The bloom filters follow the layout of the LevelDB ones: the bit array,
+// then one byte with the number of probes.  The probes are derived from one
+// hash by double hashing.
+uint32 BloomHash(const StringPiece& key) {
+  return Hash32(key.data(), key.size(), 0xbc9f1d34);
+}
+
+void AppendBloomFilter(const std::vector<uint32>& hashes, int bits_per_key,
+                       string* dst) {
+  // Round down to reduce probing cost a little bit; 0.69 =~ ln(2).
+  size_t num_probes = static_cast<size_t>(bits_per_key * 0.69);
+  if (num_probes < 1) num_probes = 1;
+  if (num_probes > 30) num_probes = 30;
+
+  // For small n, we can see a very high false positive rate.  Fix it
+  // by enforcing a minimum bloom filter length.
+  size_t bits = hashes.size() * bits_per_key;
+  if (bits < 64) bits = 64;
+  const size_t bytes = (bits + 7) / 8;
+  bits = bytes * 8;
+
+  const size_t init_size = dst->size();
+  dst->resize(init_size + bytes, 0);
+  dst->push_back(static_cast<char>(num_probes));
+  char* array = &(*dst)[init_size];
+  for (uint32 h : hashes) {
+    const uint32 delta = (h >> 17) | (h << 15);  // Rotate right 17 bits
+    for (size_t j = 0; j < num_probes; j++) {
+      const uint32 bitpos = h % bits;
+      array[bitpos / 8] |= (1 << (bitpos % 8));
+      h += delta;
+    }
+  }
+}
+
+bool BloomFilterMayContain(uint32 hash, const StringPiece& filter) {
+  const size_t len = filter.size();
+  if (len < 2) return false;
+
+  const char* array = filter.data();
+  const size_t bits = (len - 1) * 8;
+  const size_t num_probes = static_cast<uint8>(array[len - 1]);
+  if (num_probes > 30) {
+    // Reserved for potentially new encodings for short bloom filters.
+    // Consider it a match.
+    return true;
+  }
+
+  uint32 h = hash;
+  const uint32 delta = (h >> 17) | (h << 15);  // Rotate right 17 bits
+  for (size_t j = 0; j < num_probes; j++) {
+    const uint32 bitpos = h % bits;
+    if ((array[bitpos / 8] & (1 << (bitpos % 8))) == 0) return false;
+    h += delta;
+  }
+  return true;
+}
+
 }  // namespace table
 }  // namespace tsl
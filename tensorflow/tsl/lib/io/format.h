@@ -19,6 +19,7 @@ limitations under the License.
 #include <stdint.h>
 
 #include <string>
+#include <vector>
 
 #include "tensorflow/tsl/lib/io/table_builder.h"
 #include "tensorflow/tsl/platform/status.h"
@@ -102,6 +103,26 @@ struct BlockContents {
 extern Status ReadBlock(RandomAccessFile* file, const BlockHandle& handle,
                         BlockContents* result);
 
+// Key of the metaindex entry that marks a table with a partitioned index.
+// The index block of such a table maps keys to index partitions, which map
+// keys to data blocks like the index block of other tables does.
+static const char kPartitionedIndexKey[] = "tsl.index.partitioned";
+
+// The bloom filter of a data block, if any, follows its block handle in the
+// index entry.  Readers that predate filters ignore it.
+
+// Returns the hash of "key" that bloom filters are built from.
+extern uint32 BloomHash(const StringPiece& key);
+
+// Appends to "*dst" a bloom filter of the keys whose hashes are "hashes",
+// using "bits_per_key" bits per key.
+extern void AppendBloomFilter(const std::vector<uint32>& hashes,
+                              int bits_per_key, string* dst);
+
+// Returns false if the key whose hash is "hash" is certainly not in "filter",
+// and true if it may be.
+extern bool BloomFilterMayContain(uint32 hash, const StringPiece& filter);
+
 // Implementation details follow.  Clients should ignore,
 
 inline BlockHandle::BlockHandle()
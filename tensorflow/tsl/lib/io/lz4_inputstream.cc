@@ -0,0 +1,159 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/tsl/lib/io/lz4_inputstream.h"
+
+#include <lz4frame.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include "tensorflow/tsl/platform/errors.h"
+#include "tensorflow/tsl/platform/logging.h"
+
+namespace tsl {
+namespace io {
+
+Lz4InputStream::Lz4InputStream(InputStreamInterface* input_stream,
+                               size_t input_buffer_bytes,
+                               size_t output_buffer_bytes,
+                               bool owns_input_stream)
+    : owns_input_stream_(owns_input_stream),
+      input_stream_(input_stream),
+      input_buffer_capacity_(input_buffer_bytes),
+      input_buffer_(new char[input_buffer_bytes]),
+      output_buffer_capacity_(output_buffer_bytes),
+      output_buffer_(new char[output_buffer_bytes]),
+      context_(nullptr) {
+  const LZ4F_errorCode_t error =
+      LZ4F_createDecompressionContext(&context_, LZ4F_VERSION);
+  CHECK(!LZ4F_isError(error)) << "LZ4F_createDecompressionContext failed: "
+                              << LZ4F_getErrorName(error);
+}
+
+Lz4InputStream::Lz4InputStream(InputStreamInterface* input_stream,
+                               size_t input_buffer_bytes,
+                               size_t output_buffer_bytes)
+    : Lz4InputStream(input_stream, input_buffer_bytes, output_buffer_bytes,
+                     false) {}
+
+Lz4InputStream::~Lz4InputStream() {
+  LZ4F_freeDecompressionContext(context_);
+  if (owns_input_stream_) {
+    delete input_stream_;
+  }
+}
+
+Status Lz4InputStream::Reset() {
+  TF_RETURN_IF_ERROR(input_stream_->Reset());
+  LZ4F_resetDecompressionContext(context_);
+  input_pos_ = input_size_ = 0;
+  output_pos_ = output_size_ = 0;
+  output_buffer_filled_ = false;
+  at_frame_boundary_ = true;
+  bytes_read_ = 0;
+  return OkStatus();
+}
+
+Status Lz4InputStream::ReadFromStream() {
+  tstring data;
+  Status s = input_stream_->ReadNBytes(input_buffer_capacity_, &data);
+  if (!s.ok() && !errors::IsOutOfRange(s)) {
+    return s;
+  }
+  // Reading less than requested is fine at the end of the stream.
+  if (data.empty()) {
+    return errors::OutOfRange("EOF reached");
+  }
+  memcpy(input_buffer_.get(), data.data(), data.size());
+  input_pos_ = 0;
+  input_size_ = data.size();
+  return OkStatus();
+}
+
+Status Lz4InputStream::Decompress() {
+  output_pos_ = output_size_ = 0;
+  while (output_size_ == 0) {
+    if (input_pos_ == input_size_ && !output_buffer_filled_) {
+      Status s = ReadFromStream();
+      if (errors::IsOutOfRange(s) && !at_frame_boundary_) {
+        return errors::DataLoss("truncated lz4 stream");
+      }
+      TF_RETURN_IF_ERROR(s);
+    }
+    size_t input_bytes = input_size_ - input_pos_;
+    size_t output_bytes = output_buffer_capacity_;
+    const size_t result =
+        LZ4F_decompress(context_, output_buffer_.get(), &output_bytes,
+                        input_buffer_.get() + input_pos_, &input_bytes,
+                        /*dOptPtr=*/nullptr);
+    if (LZ4F_isError(result)) {
+      return errors::DataLoss("LZ4F_decompress() failed: ",
+                              LZ4F_getErrorName(result));
+    }
+    input_pos_ += input_bytes;
+    output_size_ = output_bytes;
+    output_buffer_filled_ = output_bytes == output_buffer_capacity_;
+    // A result of 0 means that a frame was completely decoded and flushed.
+    // Calls that make no progress, like retrying after an exactly filled
+    // output buffer, report the size of the next frame header instead.
+    if (input_bytes > 0 || output_bytes > 0) {
+      at_frame_boundary_ = result == 0;
+    }
+  }
+  return OkStatus();
+}
+
+size_t Lz4InputStream::ReadBytesFromCache(size_t bytes_to_read,
+                                          tstring* result) {
+  const size_t can_read_bytes =
+      std::min(bytes_to_read, output_size_ - output_pos_);
+  if (can_read_bytes > 0) {
+    result->append(output_buffer_.get() + output_pos_, can_read_bytes);
+    output_pos_ += can_read_bytes;
+  }
+  bytes_read_ += can_read_bytes;
+  return can_read_bytes;
+}
+
+Status Lz4InputStream::ReadNBytes(int64_t bytes_to_read, tstring* result) {
+  result->clear();
+  // Read as many bytes as possible from cache.
+  bytes_to_read -= ReadBytesFromCache(bytes_to_read, result);
+
+  while (bytes_to_read > 0) {
+    // At this point we can be sure that cache has been emptied.
+    DCHECK_EQ(output_pos_, output_size_);
+    TF_RETURN_IF_ERROR(Decompress());
+    bytes_to_read -= ReadBytesFromCache(bytes_to_read, result);
+  }
+
+  return OkStatus();
+}
+
+#if defined(TF_CORD_SUPPORT)
+Status Lz4InputStream::ReadNBytes(int64_t bytes_to_read, absl::Cord* result) {
+  tstring buf;
+  TF_RETURN_IF_ERROR(ReadNBytes(bytes_to_read, &buf));
+  result->Clear();
+  result->Append(buf.data());
+  return OkStatus();
+}
+#endif
+
+int64_t Lz4InputStream::Tell() const { return bytes_read_; }
+
+}  // namespace io
+}  // namespace tsl
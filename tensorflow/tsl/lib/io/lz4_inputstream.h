@@ -0,0 +1,121 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_TSL_LIB_IO_LZ4_INPUTSTREAM_H_
+#define TENSORFLOW_TSL_LIB_IO_LZ4_INPUTSTREAM_H_
+
+#include <memory>
+
+#include "tensorflow/tsl/lib/io/inputstream_interface.h"
+#include "tensorflow/tsl/platform/macros.h"
+#include "tensorflow/tsl/platform/status.h"
+#include "tensorflow/tsl/platform/types.h"
+
+// Forward declare the decompression context of lz4, which is only included
+// in the .cc file.
+struct LZ4F_dctx_s;
+
+namespace tsl {
+namespace io {
+
+// An Lz4InputStream provides support for reading from a stream compressed
+// with the lz4 frame format (https://lz4.org/). Concatenated frames are read
+// as one stream.
+//
+// A given instance of an Lz4InputStream is NOT safe for concurrent use
+// by multiple threads
+class Lz4InputStream : public InputStreamInterface {
+ public:
+  // Create an Lz4InputStream for `input_stream` with a buffer of size
+  // `input_buffer_bytes` bytes for reading contents from `input_stream` and
+  // another buffer with size `output_buffer_bytes` for caching decompressed
+  // contents.
+  //
+  // Takes ownership of `input_stream` iff `owns_input_stream` is true.
+  Lz4InputStream(InputStreamInterface* input_stream, size_t input_buffer_bytes,
+                 size_t output_buffer_bytes, bool owns_input_stream);
+
+  // Equivalent to the previous constructor with owns_input_stream=false.
+  Lz4InputStream(InputStreamInterface* input_stream, size_t input_buffer_bytes,
+                 size_t output_buffer_bytes);
+
+  ~Lz4InputStream() override;
+
+  // Reads bytes_to_read bytes into *result, overwriting *result.
+  //
+  // Return Status codes:
+  // OK:           If successful.
+  // OUT_OF_RANGE: If there are not enough bytes to read before
+  //               the end of the stream.
+  // DATA_LOSS:    If LZ4F_decompress() fails, or if the stream ends within
+  //               a frame.
+  // others:       If reading from stream failed.
+  Status ReadNBytes(int64_t bytes_to_read, tstring* result) override;
+
+#if defined(TF_CORD_SUPPORT)
+  Status ReadNBytes(int64_t bytes_to_read, absl::Cord* result) override;
+#endif
+
+  int64_t Tell() const override;
+
+  Status Reset() override;
+
+ private:
+  // Reads up to `input_buffer_capacity_` bytes from `input_stream_` into the
+  // emptied input buffer. Returns OutOfRange if no data could be read.
+  Status ReadFromStream();
+
+  // Decompresses data into the emptied output buffer, reading more compressed
+  // data when needed, until some output was produced. Returns OutOfRange at
+  // the end of the stream.
+  Status Decompress();
+
+  // Appends up to `bytes_to_read` bytes of the decompressed data cache to
+  // `*result`, and returns the number of bytes appended.
+  size_t ReadBytesFromCache(size_t bytes_to_read, tstring* result);
+
+  const bool owns_input_stream_;
+  InputStreamInterface* input_stream_;
+
+  // Compressed data read from `input_stream_`, of which
+  // [input_pos_, input_size_) is not decompressed yet.
+  const size_t input_buffer_capacity_;
+  std::unique_ptr<char[]> input_buffer_;
+  size_t input_pos_ = 0;
+  size_t input_size_ = 0;
+
+  // Decompressed data, of which [output_pos_, output_size_) is not read yet.
+  const size_t output_buffer_capacity_;
+  std::unique_ptr<char[]> output_buffer_;
+  size_t output_pos_ = 0;
+  size_t output_size_ = 0;
+
+  LZ4F_dctx_s* context_;
+  // Whether the last decompression filled up the output buffer, in which case
+  // lz4 may hold more output without needing more input.
+  bool output_buffer_filled_ = false;
+  // Whether the data decompressed so far ends on a frame boundary.
+  bool at_frame_boundary_ = true;
+
+  // Number of *uncompressed* bytes that have been read from this stream.
+  int64_t bytes_read_ = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(Lz4InputStream);
+};
+
+}  // namespace io
+}  // namespace tsl
+
+#endif  // TENSORFLOW_TSL_LIB_IO_LZ4_INPUTSTREAM_H_
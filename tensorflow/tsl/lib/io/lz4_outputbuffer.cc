@@ -0,0 +1,176 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/tsl/lib/io/lz4_outputbuffer.h"
+
+#include <lz4frame.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include "tensorflow/tsl/platform/errors.h"
+#include "tensorflow/tsl/platform/logging.h"
+
+namespace tsl {
+namespace io {
+namespace {
+
+LZ4F_preferences_t Preferences(int compression_level) {
+  LZ4F_preferences_t preferences;
+  memset(&preferences, 0, sizeof(preferences));
+  preferences.compressionLevel = compression_level;
+  preferences.frameInfo.contentChecksumFlag = LZ4F_contentChecksumEnabled;
+  return preferences;
+}
+
+// Returns the size of output that compressing `bytes` may produce at most,
+// including the end of the frame.
+size_t CompressBound(size_t bytes, int compression_level) {
+  const LZ4F_preferences_t preferences = Preferences(compression_level);
+  return LZ4F_compressBound(bytes, &preferences);
+}
+
+Status Lz4Error(const char* function, size_t result) {
+  return errors::DataLoss(function, "() failed: ", LZ4F_getErrorName(result));
+}
+
+}  // namespace
+
+Lz4OutputBuffer::Lz4OutputBuffer(WritableFile* file,
+                                 const Lz4CompressionOptions& options)
+    : file_(file),
+      compression_level_(options.compression_level),
+      input_chunk_size_(options.input_buffer_size),
+      // The output of compressing a chunk of input must fit in the buffer.
+      output_buffer_capacity_(std::max<size_t>(
+          options.output_buffer_size,
+          CompressBound(options.input_buffer_size,
+                        options.compression_level) +
+              LZ4F_HEADER_SIZE_MAX)),
+      output_buffer_(new char[output_buffer_capacity_]),
+      context_(nullptr) {
+  const size_t result = LZ4F_createCompressionContext(&context_, LZ4F_VERSION);
+  CHECK(!LZ4F_isError(result)) << "LZ4F_createCompressionContext failed: "
+                               << LZ4F_getErrorName(result);
+}
+
+Lz4OutputBuffer::~Lz4OutputBuffer() {
+  if (context_ != nullptr) {
+    LOG(WARNING) << "Lz4OutputBuffer::Close() not called. Possible data loss";
+    LZ4F_freeCompressionContext(context_);
+  }
+}
+
+Status Lz4OutputBuffer::Begin() {
+  if (context_ == nullptr) {
+    return errors::FailedPrecondition(
+        "Lz4OutputBuffer used after it was closed.");
+  }
+  if (begun_) return OkStatus();
+  TF_RETURN_IF_ERROR(ReserveOutput(LZ4F_HEADER_SIZE_MAX));
+  const LZ4F_preferences_t preferences = Preferences(compression_level_);
+  const size_t result = LZ4F_compressBegin(
+      context_, output_buffer_.get() + output_size_,
+      output_buffer_capacity_ - output_size_, &preferences);
+  if (LZ4F_isError(result)) return Lz4Error("LZ4F_compressBegin", result);
+  output_size_ += result;
+  begun_ = true;
+  return OkStatus();
+}
+
+Status Lz4OutputBuffer::ReserveOutput(size_t bytes) {
+  if (output_buffer_capacity_ - output_size_ < bytes) {
+    TF_RETURN_IF_ERROR(FlushOutputBufferToFile());
+  }
+  return OkStatus();
+}
+
+Status Lz4OutputBuffer::FlushOutputBufferToFile() {
+  if (output_size_ > 0) {
+    TF_RETURN_IF_ERROR(
+        file_->Append(StringPiece(output_buffer_.get(), output_size_)));
+    output_size_ = 0;
+  }
+  return OkStatus();
+}
+
+Status Lz4OutputBuffer::Append(StringPiece data) {
+  TF_RETURN_IF_ERROR(Begin());
+  while (!data.empty()) {
+    const size_t chunk_size = std::min(data.size(), input_chunk_size_);
+    TF_RETURN_IF_ERROR(
+        ReserveOutput(CompressBound(chunk_size, compression_level_)));
+    const size_t result = LZ4F_compressUpdate(
+        context_, output_buffer_.get() + output_size_,
+        output_buffer_capacity_ - output_size_, data.data(), chunk_size,
+        /*cOptPtr=*/nullptr);
+    if (LZ4F_isError(result)) return Lz4Error("LZ4F_compressUpdate", result);
+    output_size_ += result;
+    data.remove_prefix(chunk_size);
+  }
+  return OkStatus();
+}
+
+#if defined(TF_CORD_SUPPORT)
+Status Lz4OutputBuffer::Append(const absl::Cord& cord) {
+  for (absl::string_view fragment : cord.Chunks()) {
+    TF_RETURN_IF_ERROR(Append(fragment));
+  }
+  return OkStatus();
+}
+#endif
+
+Status Lz4OutputBuffer::Flush() {
+  TF_RETURN_IF_ERROR(Begin());
+  TF_RETURN_IF_ERROR(ReserveOutput(CompressBound(0, compression_level_)));
+  const size_t result =
+      LZ4F_flush(context_, output_buffer_.get() + output_size_,
+                 output_buffer_capacity_ - output_size_, /*cOptPtr=*/nullptr);
+  if (LZ4F_isError(result)) return Lz4Error("LZ4F_flush", result);
+  output_size_ += result;
+  TF_RETURN_IF_ERROR(FlushOutputBufferToFile());
+  return file_->Flush();
+}
+
+Status Lz4OutputBuffer::Name(StringPiece* result) const {
+  return file_->Name(result);
+}
+
+Status Lz4OutputBuffer::Sync() {
+  TF_RETURN_IF_ERROR(Flush());
+  return file_->Sync();
+}
+
+Status Lz4OutputBuffer::Close() {
+  if (context_ == nullptr) return OkStatus();
+  TF_RETURN_IF_ERROR(Begin());
+  TF_RETURN_IF_ERROR(ReserveOutput(CompressBound(0, compression_level_)));
+  const size_t result = LZ4F_compressEnd(
+      context_, output_buffer_.get() + output_size_,
+      output_buffer_capacity_ - output_size_, /*cOptPtr=*/nullptr);
+  if (LZ4F_isError(result)) return Lz4Error("LZ4F_compressEnd", result);
+  output_size_ += result;
+  TF_RETURN_IF_ERROR(FlushOutputBufferToFile());
+  LZ4F_freeCompressionContext(context_);
+  context_ = nullptr;
+  return OkStatus();
+}
+
+Status Lz4OutputBuffer::Tell(int64_t* position) {
+  return file_->Tell(position);
+}
+
+}  // namespace io
+}  // namespace tsl
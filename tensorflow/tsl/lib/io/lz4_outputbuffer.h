@@ -0,0 +1,115 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_TSL_LIB_IO_LZ4_OUTPUTBUFFER_H_
+#define TENSORFLOW_TSL_LIB_IO_LZ4_OUTPUTBUFFER_H_
+
+#include <memory>
+
+#include "tensorflow/tsl/lib/io/lz4_compression_options.h"
+#include "tensorflow/tsl/platform/file_system.h"
+#include "tensorflow/tsl/platform/macros.h"
+#include "tensorflow/tsl/platform/status.h"
+#include "tensorflow/tsl/platform/stringpiece.h"
+#include "tensorflow/tsl/platform/types.h"
+
+// Forward declare the compression context of lz4, which is only included in
+// the .cc file.
+struct LZ4F_cctx_s;
+
+namespace tsl {
+namespace io {
+
+// Provides support for writing compressed output to file using the lz4 frame
+// format (https://lz4.org/). The output is a single lz4 frame, with a checksum
+// of the content.
+//
+// A given instance of an Lz4OutputBuffer is NOT safe for concurrent use
+// by multiple threads
+class Lz4OutputBuffer : public WritableFile {
+ public:
+  // Create an Lz4OutputBuffer for `file` with a buffer of size
+  // `options.output_buffer_size` that caches the compressed output. lz4
+  // buffers the input itself, and is fed at most `options.input_buffer_size`
+  // bytes at a time. Does not take ownership of `file`.
+  Lz4OutputBuffer(WritableFile* file, const Lz4CompressionOptions& options);
+
+  // Per convention, the dtor does not call Flush() or Close(). We expect the
+  // caller to call those manually when done.
+  ~Lz4OutputBuffer() override;
+
+  // Adds `data` to the compression pipeline. The compressed output is written
+  // to file when the output buffer is full.
+  //
+  // To immediately write contents to file call `Flush()`.
+  Status Append(StringPiece data) override;
+
+#if defined(TF_CORD_SUPPORT)
+  Status Append(const absl::Cord& cord) override;
+#endif
+
+  // Compresses any cached input and writes all output to file.
+  Status Flush() override;
+
+  // Ends the lz4 frame and writes all output to file. This must be called
+  // before the destructor to avoid any data loss. Does not close `file`.
+  //
+  // After calling this, any further calls to `Append()` or `Flush()` will
+  // fail.
+  Status Close() override;
+
+  // Returns the name of the underlying file.
+  Status Name(StringPiece* result) const override;
+
+  // Compresses any cached input, writes all output to file and syncs it.
+  Status Sync() override;
+
+  // Returns the write position in the underlying file. The position does not
+  // reflect buffered, un-flushed data.
+  Status Tell(int64_t* position) override;
+
+ private:
+  // Writes the frame header, unless it was written already.
+  Status Begin();
+
+  // Makes room for `bytes` bytes in the output buffer, writing it to file if
+  // needed.
+  Status ReserveOutput(size_t bytes);
+
+  // Appends contents of `output_buffer_` to `file_`.
+  // Returns non-OK status if writing to file fails.
+  Status FlushOutputBufferToFile();
+
+  WritableFile* file_;  // Not owned
+  const int compression_level_;
+  const size_t input_chunk_size_;
+
+  // Buffer for storing compressed contents, of which the first
+  // `output_size_` bytes are not written to file yet.
+  const size_t output_buffer_capacity_;
+  std::unique_ptr<char[]> output_buffer_;
+  size_t output_size_ = 0;
+
+  // Null once closed.
+  LZ4F_cctx_s* context_;
+  bool begun_ = false;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(Lz4OutputBuffer);
+};
+
+}  // namespace io
+}  // namespace tsl
+
+#endif  // TENSORFLOW_TSL_LIB_IO_LZ4_OUTPUTBUFFER_H_
@@ -16,14 +16,22 @@ limitations under the License.
 #include "tensorflow/tsl/lib/io/record_reader.h"
 
 #include <limits.h>
+#if !defined(IS_SLIM_BUILD)
+#include <zlib.h>
+#endif  // IS_SLIM_BUILD
+
+#include <algorithm>
 
 #include "tensorflow/tsl/lib/hash/crc32c.h"
 #include "tensorflow/tsl/lib/io/buffered_inputstream.h"
 #include "tensorflow/tsl/lib/io/compression.h"
 #include "tensorflow/tsl/lib/io/random_inputstream.h"
+#include "tensorflow/tsl/lib/io/record_writer.h"
+#include "tensorflow/tsl/platform/coding.h"
 #include "tensorflow/tsl/platform/env.h"
 #include "tensorflow/tsl/platform/errors.h"
 #include "tensorflow/tsl/platform/raw_coding.h"
+#include "tensorflow/tsl/platform/threadpool.h"
 
 namespace tsl {
 namespace io {
@@ -46,6 +54,10 @@ RecordReaderOptions RecordReaderOptions::CreateRecordReaderOptions(
     options.zlib_options = io::ZlibCompressionOptions::GZIP();
   } else if (compression_type == compression::kSnappy) {
     options.compression_type = io::RecordReaderOptions::SNAPPY_COMPRESSION;
+  } else if (compression_type == compression::kZstd) {
+    options.compression_type = io::RecordReaderOptions::ZSTD_COMPRESSION;
+  } else if (compression_type == compression::kLz4) {
+    options.compression_type = io::RecordReaderOptions::LZ4_COMPRESSION;
   } else if (compression_type != compression::kNone) {
     LOG(ERROR) << "Unsupported compression_type:" << compression_type
                << ". No compression will be used.";
@@ -77,6 +89,15 @@ RecordReader::RecordReader(RandomAccessFile* file,
     input_stream_.reset(
         new SnappyInputStream(input_stream_.release(),
                               options.snappy_options.output_buffer_size, true));
+  } else if (options.compression_type ==
+             RecordReaderOptions::ZSTD_COMPRESSION) {
+    input_stream_.reset(new ZstdInputStream(
+        input_stream_.release(), options.zstd_options.input_buffer_size,
+        options.zstd_options.output_buffer_size, true));
+  } else if (options.compression_type == RecordReaderOptions::LZ4_COMPRESSION) {
+    input_stream_.reset(new Lz4InputStream(
+        input_stream_.release(), options.lz4_options.input_buffer_size,
+        options.lz4_options.output_buffer_size, true));
   } else if (options.compression_type == RecordReaderOptions::NONE) {
     // Nothing to do.
   } else {
@@ -259,5 +280,188 @@ SequentialRecordReader::SequentialRecordReader(
     RandomAccessFile* file, const RecordReaderOptions& options)
     : underlying_(file, options), offset_(0) {}
 
+#if !defined(IS_SLIM_BUILD)
+namespace {
+
+// Reads exactly "n" bytes at "offset" of "*file" into "*result".
+Status ReadExactly(RandomAccessFile* file, uint64 offset, size_t n,
+                   string* result) {
+  string scratch(n, '\0');
+  StringPiece data;
+  Status s = file->Read(offset, n, &data, &scratch[0]);
+  if (data.size() != n) {
+    return errors::DataLoss("truncated block record file at ", offset);
+  }
+  if (!s.ok() && !errors::IsOutOfRange(s)) return s;
+  result->assign(data.data(), data.size());
+  return OkStatus();
+}
+
+// Reads the data of the record at "offset" of "*file" into "*data", checking
+// its checksums.
+Status ReadBlockRecord(RandomAccessFile* file, uint64 offset, string* data) {
+  string header;
+  TF_RETURN_IF_ERROR(
+      ReadExactly(file, offset, RecordReader::kHeaderSize, &header));
+  if (crc32c::Unmask(core::DecodeFixed32(header.data() + sizeof(uint64))) !=
+      crc32c::Value(header.data(), sizeof(uint64))) {
+    return errors::DataLoss("corrupted record at ", offset);
+  }
+  const uint64 length = core::DecodeFixed64(header.data());
+  if (length >= SIZE_MAX - RecordReader::kFooterSize) {
+    return errors::DataLoss("record size too large at ", offset);
+  }
+  TF_RETURN_IF_ERROR(ReadExactly(file, offset + RecordReader::kHeaderSize,
+                                 length + RecordReader::kFooterSize, data));
+  if (crc32c::Unmask(core::DecodeFixed32(data->data() + length)) !=
+      crc32c::Value(data->data(), length)) {
+    return errors::DataLoss("corrupted record at ", offset);
+  }
+  data->resize(length);
+  return OkStatus();
+}
+
+// Decompresses "input" into "*output", which must have the uncompressed size.
+Status ZlibUncompress(const ZlibCompressionOptions& options,
+                      const string& input, string* output) {
+  z_stream stream = {};
+  int status = inflateInit2(&stream, options.window_bits);
+  if (status != Z_OK) {
+    return errors::InvalidArgument("inflateInit failed with status ", status);
+  }
+  stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+  stream.avail_in = input.size();
+  stream.next_out = reinterpret_cast<Bytef*>(&(*output)[0]);
+  stream.avail_out = output->size();
+  status = inflate(&stream, Z_FINISH);
+  const uint64 total_out = stream.total_out;
+  inflateEnd(&stream);
+  if (status != Z_STREAM_END || total_out != output->size()) {
+    return errors::DataLoss("corrupted compressed block, inflate returned ",
+                            status);
+  }
+  return OkStatus();
+}
+
+}  // namespace
+
+Status BlockRecordReader::Open(RandomAccessFile* file, uint64 file_size,
+                               const ZlibCompressionOptions& options,
+                               std::unique_ptr<BlockRecordReader>* reader) {
+  if (file_size < RecordWriter::kBlockTrailerSize) {
+    return errors::DataLoss("file is too short to be a block record file");
+  }
+  string trailer;
+  TF_RETURN_IF_ERROR(
+      ReadExactly(file, file_size - RecordWriter::kBlockTrailerSize,
+                  RecordWriter::kBlockTrailerSize, &trailer));
+  if (core::DecodeFixed64(trailer.data() + sizeof(uint64)) !=
+      RecordWriter::kBlockTrailerMagic) {
+    return errors::DataLoss("not a block record file (bad magic number)");
+  }
+  const uint64 index_offset = core::DecodeFixed64(trailer.data());
+  string index;
+  TF_RETURN_IF_ERROR(ReadBlockRecord(file, index_offset, &index));
+  if (index.size() % RecordWriter::kBlockIndexEntrySize != 0) {
+    return errors::DataLoss("corrupted block index");
+  }
+
+  std::unique_ptr<BlockRecordReader> result(
+      new BlockRecordReader(file, options));
+  result->blocks_.resize(index.size() / RecordWriter::kBlockIndexEntrySize);
+  const char* entry = index.data();
+  for (Block& block : result->blocks_) {
+    block.offset = core::DecodeFixed64(entry);
+    block.num_records = core::DecodeFixed64(entry + sizeof(uint64));
+    block.uncompressed_size = core::DecodeFixed64(entry + 2 * sizeof(uint64));
+    block.first_record = result->num_records_;
+    if (block.offset >= index_offset || block.num_records <= 0) {
+      return errors::DataLoss("corrupted block index");
+    }
+    result->num_records_ += block.num_records;
+    entry += RecordWriter::kBlockIndexEntrySize;
+  }
+  *reader = std::move(result);
+  return OkStatus();
+}
+
+Status BlockRecordReader::ReadBlock(int block,
+                                    std::vector<tstring>* records) const {
+  if (block < 0 || block >= num_blocks()) {
+    return errors::OutOfRange("block ", block, " is out of range");
+  }
+  const Block& info = blocks_[block];
+  string compressed;
+  TF_RETURN_IF_ERROR(ReadBlockRecord(file_, info.offset, &compressed));
+  string uncompressed(info.uncompressed_size, '\0');
+  TF_RETURN_IF_ERROR(ZlibUncompress(options_, compressed, &uncompressed));
+
+  records->clear();
+  records->reserve(info.num_records);
+  StringPiece input(uncompressed);
+  uint64 length;
+  while (!input.empty()) {
+    if (!core::GetVarint64(&input, &length) || length > input.size()) {
+      return errors::DataLoss("corrupted block at ", info.offset);
+    }
+    records->emplace_back(input.data(), length);
+    input.remove_prefix(length);
+  }
+  if (static_cast<int64_t>(records->size()) != info.num_records) {
+    return errors::DataLoss("corrupted block at ", info.offset);
+  }
+  return OkStatus();
+}
+
+Status BlockRecordReader::ReadBlocks(int first_block, int last_block,
+                                     thread::ThreadPool* pool,
+                                     std::vector<tstring>* records) const {
+  if (first_block < 0 || last_block > num_blocks() ||
+      first_block > last_block) {
+    return errors::OutOfRange("blocks [", first_block, ", ", last_block,
+                              ") are out of range");
+  }
+  const int count = last_block - first_block;
+  std::vector<std::vector<tstring>> block_records(count);
+  std::vector<Status> statuses(count);
+  auto read_blocks = [&](int64_t start, int64_t limit) {
+    for (int64_t i = start; i < limit; ++i) {
+      statuses[i] = ReadBlock(first_block + i, &block_records[i]);
+    }
+  };
+  if (pool != nullptr) {
+    // Decompressing a block takes about a millisecond per megabyte, so every
+    // block is worth a task of its own.
+    pool->ParallelFor(count, /*cost_per_unit=*/1000000, read_blocks);
+  } else {
+    read_blocks(0, count);
+  }
+
+  records->clear();
+  for (int i = 0; i < count; ++i) {
+    TF_RETURN_IF_ERROR(statuses[i]);
+    for (tstring& record : block_records[i]) {
+      records->push_back(std::move(record));
+    }
+  }
+  return OkStatus();
+}
+
+Status BlockRecordReader::ReadRecord(int64_t index, tstring* record) const {
+  if (index < 0 || index >= num_records_) {
+    return errors::OutOfRange("record ", index, " is out of range");
+  }
+  // The last block whose first record is at most "index".
+  const auto it = std::upper_bound(
+      blocks_.begin(), blocks_.end(), index,
+      [](int64_t i, const Block& block) { return i < block.first_record; });
+  const Block& block = *(it - 1);
+  std::vector<tstring> records;
+  TF_RETURN_IF_ERROR(ReadBlock(it - 1 - blocks_.begin(), &records));
+  *record = std::move(records[index - block.first_record]);
+  return OkStatus();
+}
+#endif  // IS_SLIM_BUILD
+
 }  // namespace io
 }  // namespace tsl
@@ -16,20 +16,30 @@ limitations under the License.
 #ifndef TENSORFLOW_TSL_LIB_IO_RECORD_READER_H_
 #define TENSORFLOW_TSL_LIB_IO_RECORD_READER_H_
 
+#include <memory>
+#include <vector>
+
 #include "tensorflow/tsl/lib/io/inputstream_interface.h"
 #include "tensorflow/tsl/platform/errors.h"
 #include "tensorflow/tsl/platform/stringpiece.h"
 #if !defined(IS_SLIM_BUILD)
+#include "tensorflow/tsl/lib/io/lz4_compression_options.h"
+#include "tensorflow/tsl/lib/io/lz4_inputstream.h"
 #include "tensorflow/tsl/lib/io/snappy/snappy_compression_options.h"
 #include "tensorflow/tsl/lib/io/snappy/snappy_inputstream.h"
 #include "tensorflow/tsl/lib/io/zlib_compression_options.h"
 #include "tensorflow/tsl/lib/io/zlib_inputstream.h"
+#include "tensorflow/tsl/lib/io/zstd_compression_options.h"
+#include "tensorflow/tsl/lib/io/zstd_inputstream.h"
 #endif  // IS_SLIM_BUILD
 #include "tensorflow/tsl/platform/macros.h"
 #include "tensorflow/tsl/platform/types.h"
 
 namespace tsl {
 class RandomAccessFile;
+namespace thread {
+class ThreadPool;
+}  // namespace thread
 
 namespace io {
 
@@ -37,7 +47,9 @@ struct RecordReaderOptions {
   enum CompressionType {
     NONE = 0,
     ZLIB_COMPRESSION = 1,
-    SNAPPY_COMPRESSION = 2
+    SNAPPY_COMPRESSION = 2,
+    ZSTD_COMPRESSION = 4,
+    LZ4_COMPRESSION = 5
   };
   CompressionType compression_type = NONE;
 
@@ -53,6 +65,8 @@ struct RecordReaderOptions {
   // Options specific to compression.
   ZlibCompressionOptions zlib_options;
   SnappyCompressionOptions snappy_options;
+  ZstdCompressionOptions zstd_options;
+  Lz4CompressionOptions lz4_options;
 #endif  // IS_SLIM_BUILD
 };
 
@@ -173,6 +187,68 @@ class SequentialRecordReader {
   uint64 offset_ = 0;
 };
 
+#if !defined(IS_SLIM_BUILD)
+// Interface to read TFRecord files written with
+// RecordWriterOptions::ZLIB_BLOCK_COMPRESSION.
+//
+// The records are compressed in independent blocks, so that blocks can be
+// decompressed in parallel, a record can be read without decompressing the
+// records before it, and shards of a file can be read by giving every shard
+// its own range of blocks.
+//
+// This class is thread safe.
+class BlockRecordReader {
+ public:
+  // Reads the block index of "*file", which is "file_size" bytes long.
+  // "options" must match the zlib options of the writer.
+  // "*file" must remain live while the reader is in use.
+  static Status Open(RandomAccessFile* file, uint64 file_size,
+                     const ZlibCompressionOptions& options,
+                     std::unique_ptr<BlockRecordReader>* reader);
+
+  int num_blocks() const { return blocks_.size(); }
+  int64_t num_records() const { return num_records_; }
+
+  // Returns the index of the first record of "block".
+  int64_t FirstRecordOfBlock(int block) const {
+    return blocks_[block].first_record;
+  }
+
+  // Reads the records of "block" into "*records".
+  Status ReadBlock(int block, std::vector<tstring>* records) const;
+
+  // Reads the records of the blocks in [first_block, last_block) into
+  // "*records". If "pool" isn't null, the blocks are decompressed in parallel
+  // on its threads.
+  Status ReadBlocks(int first_block, int last_block, thread::ThreadPool* pool,
+                    std::vector<tstring>* records) const;
+
+  // Reads the record with index "index" into "*record". This decompresses its
+  // whole block, so scans should use ReadBlocks() instead. Returns
+  // OUT_OF_RANGE if there is no such record.
+  Status ReadRecord(int64_t index, tstring* record) const;
+
+ private:
+  struct Block {
+    uint64 offset;
+    int64_t first_record;
+    int64_t num_records;
+    uint64 uncompressed_size;
+  };
+
+  BlockRecordReader(RandomAccessFile* file,
+                    const ZlibCompressionOptions& options)
+      : file_(file), options_(options) {}
+
+  RandomAccessFile* const file_;
+  const ZlibCompressionOptions options_;
+  std::vector<Block> blocks_;
+  int64_t num_records_ = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(BlockRecordReader);
+};
+#endif  // IS_SLIM_BUILD
+
 }  // namespace io
 }  // namespace tsl
 
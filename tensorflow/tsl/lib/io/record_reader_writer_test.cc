@@ -30,6 +30,7 @@ limitations under the License.
 #include "tensorflow/tsl/platform/status.h"
 #include "tensorflow/tsl/platform/strcat.h"
 #include "tensorflow/tsl/platform/test.h"
+#include "tensorflow/tsl/platform/threadpool.h"
 
 namespace tsl {
 
@@ -366,4 +367,104 @@ TEST(RecordReaderWriterTest, TestUseAfterClose) {
   }
 }
 
+TEST(RecordReaderWriterTest, TestZlibBlocks) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/record_reader_writer_zlib_block_test";
+  std::vector<string> records;
+  for (int i = 0; i < 1000; ++i) {
+    records.push_back(strings::StrCat("record ", i, string(i % 50, 'x')));
+  }
+
+  io::RecordWriterOptions write_options;
+  write_options.compression_type =
+      io::RecordWriterOptions::ZLIB_BLOCK_COMPRESSION;
+  write_options.zlib_options = io::ZlibCompressionOptions::GZIP();
+  write_options.block_size = 1024;
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_CHECK_OK(env->NewWritableFile(fname, &file));
+    io::RecordWriter writer(file.get(), write_options);
+    for (const string& record : records) {
+      TF_EXPECT_OK(writer.WriteRecord(record));
+    }
+    TF_EXPECT_OK(writer.Close());
+    CHECK_EQ(writer.WriteRecord("abc").code(), error::FAILED_PRECONDITION);
+    TF_CHECK_OK(file->Close());
+  }
+
+  std::unique_ptr<RandomAccessFile> read_file;
+  TF_CHECK_OK(env->NewRandomAccessFile(fname, &read_file));
+  std::unique_ptr<io::BlockRecordReader> reader;
+  TF_CHECK_OK(io::BlockRecordReader::Open(read_file.get(), GetFileSize(fname),
+                                          write_options.zlib_options,
+                                          &reader));
+  EXPECT_EQ(reader->num_records(), 1000);
+  EXPECT_GT(reader->num_blocks(), 10);
+
+  // Decompresses all blocks in parallel.
+  thread::ThreadPool pool(env, "test", 4);
+  std::vector<tstring> read_records;
+  TF_CHECK_OK(
+      reader->ReadBlocks(0, reader->num_blocks(), &pool, &read_records));
+  ASSERT_EQ(read_records.size(), records.size());
+  for (size_t i = 0; i < records.size(); ++i) {
+    EXPECT_EQ(read_records[i], records[i]);
+  }
+
+  // Reads the second half of the blocks, as the second of two shards.
+  const int middle = reader->num_blocks() / 2;
+  TF_CHECK_OK(reader->ReadBlocks(middle, reader->num_blocks(),
+                                 /*pool=*/nullptr, &read_records));
+  const int64_t first = reader->FirstRecordOfBlock(middle);
+  ASSERT_EQ(read_records.size(), records.size() - first);
+  EXPECT_EQ(read_records[0], records[first]);
+
+  // Reads single records.
+  tstring record;
+  for (int64_t i : {0, 1, 499, 998, 999}) {
+    TF_CHECK_OK(reader->ReadRecord(i, &record));
+    EXPECT_EQ(record, records[i]);
+  }
+  EXPECT_EQ(reader->ReadRecord(1000, &record).code(), error::OUT_OF_RANGE);
+}
+
+TEST(RecordReaderWriterTest, TestZlibBlocksEmptyAndCorrupted) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/record_reader_writer_zlib_block_empty";
+  io::RecordWriterOptions write_options =
+      io::RecordWriterOptions::CreateRecordWriterOptions("");
+  write_options.compression_type =
+      io::RecordWriterOptions::ZLIB_BLOCK_COMPRESSION;
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_CHECK_OK(env->NewWritableFile(fname, &file));
+    io::RecordWriter writer(file.get(), write_options);
+    TF_CHECK_OK(writer.Close());
+    TF_CHECK_OK(file->Close());
+  }
+  std::unique_ptr<RandomAccessFile> read_file;
+  TF_CHECK_OK(env->NewRandomAccessFile(fname, &read_file));
+  std::unique_ptr<io::BlockRecordReader> reader;
+  TF_CHECK_OK(io::BlockRecordReader::Open(read_file.get(), GetFileSize(fname),
+                                          write_options.zlib_options,
+                                          &reader));
+  EXPECT_EQ(reader->num_records(), 0);
+  EXPECT_EQ(reader->num_blocks(), 0);
+
+  // A file that isn't a block record file.
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_CHECK_OK(env->NewWritableFile(fname, &file));
+    io::RecordWriter writer(file.get());
+    TF_CHECK_OK(writer.WriteRecord("abcdefghijklmnopqrstuvwxyz"));
+    TF_CHECK_OK(writer.Close());
+    TF_CHECK_OK(file->Close());
+  }
+  TF_CHECK_OK(env->NewRandomAccessFile(fname, &read_file));
+  EXPECT_EQ(io::BlockRecordReader::Open(read_file.get(), GetFileSize(fname),
+                                        write_options.zlib_options, &reader)
+                .code(),
+            error::DATA_LOSS);
+}
+
 }  // namespace tsl
@@ -15,10 +15,15 @@ limitations under the License.
 
 #include "tensorflow/tsl/lib/io/record_writer.h"
 
+#if !defined(IS_SLIM_BUILD)
+#include <zlib.h>
+#endif  // IS_SLIM_BUILD
+
 #include "tensorflow/tsl/lib/hash/crc32c.h"
 #include "tensorflow/tsl/lib/io/compression.h"
 #include "tensorflow/tsl/platform/coding.h"
 #include "tensorflow/tsl/platform/env.h"
+#include "tensorflow/tsl/platform/errors.h"
 
 namespace tsl {
 namespace io {
@@ -30,6 +35,45 @@ bool IsZlibCompressed(const RecordWriterOptions& options) {
 bool IsSnappyCompressed(const RecordWriterOptions& options) {
   return options.compression_type == RecordWriterOptions::SNAPPY_COMPRESSION;
 }
+
+bool IsZstdCompressed(const RecordWriterOptions& options) {
+  return options.compression_type == RecordWriterOptions::ZSTD_COMPRESSION;
+}
+
+bool IsLz4Compressed(const RecordWriterOptions& options) {
+  return options.compression_type == RecordWriterOptions::LZ4_COMPRESSION;
+}
+
+bool IsBlockCompressed(const RecordWriterOptions& options) {
+  return options.compression_type ==
+         RecordWriterOptions::ZLIB_BLOCK_COMPRESSION;
+}
+
+#if !defined(IS_SLIM_BUILD)
+// Compresses "input" in one go into "*output".
+Status ZlibCompress(const ZlibCompressionOptions& options, StringPiece input,
+                    string* output) {
+  z_stream stream = {};
+  int status = deflateInit2(&stream, options.compression_level,
+                            options.compression_method, options.window_bits,
+                            options.mem_level, options.compression_strategy);
+  if (status != Z_OK) {
+    return errors::InvalidArgument("deflateInit failed with status ", status);
+  }
+  output->resize(deflateBound(&stream, input.size()));
+  stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+  stream.avail_in = input.size();
+  stream.next_out = reinterpret_cast<Bytef*>(&(*output)[0]);
+  stream.avail_out = output->size();
+  status = deflate(&stream, Z_FINISH);
+  output->resize(stream.total_out);
+  deflateEnd(&stream);
+  if (status != Z_STREAM_END) {
+    return errors::DataLoss("deflate failed with status ", status);
+  }
+  return OkStatus();
+}
+#endif  // IS_SLIM_BUILD
 }  // namespace
 
 RecordWriterOptions RecordWriterOptions::CreateRecordWriterOptions(
@@ -49,6 +93,10 @@ RecordWriterOptions RecordWriterOptions::CreateRecordWriterOptions(
     options.zlib_options = io::ZlibCompressionOptions::GZIP();
   } else if (compression_type == compression::kSnappy) {
     options.compression_type = io::RecordWriterOptions::SNAPPY_COMPRESSION;
+  } else if (compression_type == compression::kZstd) {
+    options.compression_type = io::RecordWriterOptions::ZSTD_COMPRESSION;
+  } else if (compression_type == compression::kLz4) {
+    options.compression_type = io::RecordWriterOptions::LZ4_COMPRESSION;
   } else if (compression_type != compression::kNone) {
     LOG(ERROR) << "Unsupported compression_type:" << compression_type
                << ". No compression will be used.";
@@ -79,6 +127,12 @@ RecordWriter::RecordWriter(WritableFile* dest,
     dest_ =
         new SnappyOutputBuffer(dest, options.snappy_options.input_buffer_size,
                                options.snappy_options.output_buffer_size);
+  } else if (IsZstdCompressed(options)) {
+    dest_ = new ZstdOutputBuffer(dest, options.zstd_options);
+  } else if (IsLz4Compressed(options)) {
+    dest_ = new Lz4OutputBuffer(dest, options.lz4_options);
+  } else if (IsBlockCompressed(options)) {
+    // The blocks are compressed as they fill up.
   } else if (options.compression_type == RecordWriterOptions::NONE) {
     // Nothing to do
   } else {
@@ -101,6 +155,15 @@ Status RecordWriter::WriteRecord(StringPiece data) {
     return Status(absl::StatusCode::kFailedPrecondition,
                   "Writer not initialized or previously closed");
   }
+  if (IsBlockCompressed(options_)) {
+    core::PutVarint64(&block_, data.size());
+    block_.append(data.data(), data.size());
+    ++block_num_records_;
+    if (static_cast<int64_t>(block_.size()) >= options_.block_size) {
+      return FlushBlock();
+    }
+    return OkStatus();
+  }
   // Format of a single record:
   //  uint64    length
   //  uint32    masked crc of length
@@ -121,6 +184,9 @@ Status RecordWriter::WriteRecord(const absl::Cord& data) {
     return Status(absl::StatusCode::kFailedPrecondition,
                   "Writer not initialized or previously closed");
   }
+  if (IsBlockCompressed(options_)) {
+    return WriteRecord(StringPiece(string(data)));
+  }
   // Format of a single record:
   //  uint64    length
   //  uint32    masked crc of length
@@ -136,9 +202,53 @@ Status RecordWriter::WriteRecord(const absl::Cord& data) {
 }
 #endif
 
+Status RecordWriter::FlushBlock() {
+  if (block_num_records_ == 0) return OkStatus();
+#if defined(IS_SLIM_BUILD)
+  return errors::Unimplemented(
+      "Compression is unsupported on mobile platforms.");
+#else
+  string compressed;
+  TF_RETURN_IF_ERROR(ZlibCompress(options_.zlib_options, block_, &compressed));
+  core::PutFixed64(&block_index_, block_offset_);
+  core::PutFixed64(&block_index_, block_num_records_);
+  core::PutFixed64(&block_index_, block_.size());
+  block_.clear();
+  block_num_records_ = 0;
+  return AppendBlockRecord(compressed);
+#endif
+}
+
+Status RecordWriter::AppendBlockRecord(StringPiece data) {
+  char header[kHeaderSize];
+  char footer[kFooterSize];
+  PopulateHeader(header, data.data(), data.size());
+  PopulateFooter(footer, data.data(), data.size());
+  TF_RETURN_IF_ERROR(dest_->Append(StringPiece(header, sizeof(header))));
+  TF_RETURN_IF_ERROR(dest_->Append(data));
+  TF_RETURN_IF_ERROR(dest_->Append(StringPiece(footer, sizeof(footer))));
+  block_offset_ += kHeaderSize + data.size() + kFooterSize;
+  return OkStatus();
+}
+
 Status RecordWriter::Close() {
   if (dest_ == nullptr) return OkStatus();
-  if (IsZlibCompressed(options_) || IsSnappyCompressed(options_)) {
+  if (IsBlockCompressed(options_)) {
+    Status s = FlushBlock();
+    const uint64 index_offset = block_offset_;
+    if (s.ok()) s = AppendBlockRecord(block_index_);
+    if (s.ok()) {
+      char trailer[kBlockTrailerSize];
+      core::EncodeFixed64(trailer, index_offset);
+      core::EncodeFixed64(trailer + sizeof(uint64), kBlockTrailerMagic);
+      s = dest_->Append(StringPiece(trailer, sizeof(trailer)));
+    }
+    // The file isn't owned, but can't take more records after the index.
+    dest_ = nullptr;
+    return s;
+  }
+  if (IsZlibCompressed(options_) || IsSnappyCompressed(options_) ||
+      IsZstdCompressed(options_) || IsLz4Compressed(options_)) {
     Status s = dest_->Close();
     delete dest_;
     dest_ = nullptr;
@@ -152,6 +262,7 @@ Status RecordWriter::Flush() {
     return Status(absl::StatusCode::kFailedPrecondition,
                   "Writer not initialized or previously closed");
   }
+  if (IsBlockCompressed(options_)) TF_RETURN_IF_ERROR(FlushBlock());
   return dest_->Flush();
 }
 
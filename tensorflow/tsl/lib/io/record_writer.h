@@ -21,10 +21,14 @@ limitations under the License.
 #include "tensorflow/tsl/platform/status.h"
 #include "tensorflow/tsl/platform/stringpiece.h"
 #if !defined(IS_SLIM_BUILD)
+#include "tensorflow/tsl/lib/io/lz4_compression_options.h"
+#include "tensorflow/tsl/lib/io/lz4_outputbuffer.h"
 #include "tensorflow/tsl/lib/io/snappy/snappy_compression_options.h"
 #include "tensorflow/tsl/lib/io/snappy/snappy_outputbuffer.h"
 #include "tensorflow/tsl/lib/io/zlib_compression_options.h"
 #include "tensorflow/tsl/lib/io/zlib_outputbuffer.h"
+#include "tensorflow/tsl/lib/io/zstd_compression_options.h"
+#include "tensorflow/tsl/lib/io/zstd_outputbuffer.h"
 #endif  // IS_SLIM_BUILD
 #include "tensorflow/tsl/platform/cord.h"
 #include "tensorflow/tsl/platform/macros.h"
@@ -41,10 +45,20 @@ struct RecordWriterOptions {
   enum CompressionType {
     NONE = 0,
     ZLIB_COMPRESSION = 1,
-    SNAPPY_COMPRESSION = 2
+    SNAPPY_COMPRESSION = 2,
+    // Compresses the records in independent blocks, followed by a block
+    // index, which BlockRecordReader uses to decompress blocks in parallel
+    // and to seek to a record. RecordReader can't read such files.
+    ZLIB_BLOCK_COMPRESSION = 3,
+    ZSTD_COMPRESSION = 4,
+    LZ4_COMPRESSION = 5
   };
   CompressionType compression_type = NONE;
 
+  // Number of uncompressed bytes of records after which a block is
+  // compressed, for ZLIB_BLOCK_COMPRESSION.
+  int64_t block_size = 1 << 20;
+
   static RecordWriterOptions CreateRecordWriterOptions(
       const string& compression_type);
 
@@ -52,6 +66,8 @@ struct RecordWriterOptions {
   // Options specific to compression.
   io::ZlibCompressionOptions zlib_options;
   io::SnappyCompressionOptions snappy_options;
+  io::ZstdCompressionOptions zstd_options;
+  io::Lz4CompressionOptions lz4_options;
 #endif  // IS_SLIM_BUILD
 };
 
@@ -65,6 +81,23 @@ class RecordWriter {
   static constexpr size_t kHeaderSize = sizeof(uint64) + sizeof(uint32);
   static constexpr size_t kFooterSize = sizeof(uint32);
 
+  // With ZLIB_BLOCK_COMPRESSION, the file is a sequence of records in the
+  // format above, followed by a trailer:
+  //  record    compressed block, for every block
+  //  record    block index
+  //  uint64    offset of the block index record
+  //  uint64    kBlockTrailerMagic
+  //
+  // A block holds the data of consecutive records, each one prefixed with
+  // its varint64 length, compressed with the zlib options. The block index
+  // has, for every block:
+  //  uint64    offset of the block record
+  //  uint64    number of records in the block
+  //  uint64    uncompressed size of the block
+  static constexpr size_t kBlockTrailerSize = 2 * sizeof(uint64);
+  static constexpr size_t kBlockIndexEntrySize = 3 * sizeof(uint64);
+  static constexpr uint64 kBlockTrailerMagic = 0x6b6c426365524654ull;
+
   // Create a writer that will append data to "*dest".
   // "*dest" must be initially empty.
   // "*dest" must remain live while this Writer is in use.
@@ -86,9 +119,11 @@ class RecordWriter {
   // Flushes any buffered data held by underlying containers of the
   // RecordWriter to the WritableFile. Does *not* flush the
   // WritableFile.
+  // With ZLIB_BLOCK_COMPRESSION, this ends the current block.
   Status Flush();
 
   // Writes all output to the file. Does *not* close the WritableFile.
+  // With ZLIB_BLOCK_COMPRESSION, this also writes the block index.
   //
   // After calling Close(), any further calls to `WriteRecord()` or `Flush()`
   // are invalid.
@@ -111,9 +146,21 @@ class RecordWriter {
 #endif
 
  private:
+  // Compresses and writes the pending records, for ZLIB_BLOCK_COMPRESSION.
+  Status FlushBlock();
+  // Writes "data" as a record to the file, for ZLIB_BLOCK_COMPRESSION.
+  Status AppendBlockRecord(StringPiece data);
+
   WritableFile* dest_;
   RecordWriterOptions options_;
 
+  // State of ZLIB_BLOCK_COMPRESSION: the records of the current block, the
+  // offset of the next record in the file and the entries of the index.
+  string block_;
+  uint64 block_num_records_ = 0;
+  uint64 block_offset_ = 0;
+  string block_index_;
+
   inline static uint32 MaskedCrc(const char* data, size_t n) {
     return crc32c::Mask(crc32c::Value(data, n));
   }
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/tsl/lib/io/table.h"
 
+#include <memory>
+
 #include "tensorflow/tsl/lib/io/block.h"
 #include "tensorflow/tsl/lib/io/cache.h"
 #include "tensorflow/tsl/lib/io/format.h"
@@ -37,6 +39,8 @@ struct Table::Rep {
 
   BlockHandle metaindex_handle;  // Handle to metaindex_block: saved from footer
   Block* index_block;
+  // Whether index_block indexes index partitions rather than data blocks.
+  bool partitioned_index;
 };
 
 Status Table::Open(const Options& options, RandomAccessFile* file, uint64 size,
@@ -63,6 +67,25 @@ Status Table::Open(const Options& options, RandomAccessFile* file, uint64 size,
     s = ReadBlock(file, footer.index_handle(), &contents);
   }
 
+  // Tables without meta blocks have an empty metaindex block, which holds
+  // only its restart array: skip reading it.
+  bool partitioned_index = false;
+  if (s.ok() && footer.metaindex_handle().size() > 2 * sizeof(uint32)) {
+    BlockContents metaindex_contents;
+    s = ReadBlock(file, footer.metaindex_handle(), &metaindex_contents);
+    if (s.ok()) {
+      Block metaindex_block(metaindex_contents);
+      std::unique_ptr<Iterator> iter(metaindex_block.NewIterator());
+      iter->Seek(kPartitionedIndexKey);
+      partitioned_index =
+          iter->Valid() && iter->key() == StringPiece(kPartitionedIndexKey);
+      s = iter->status();
+    }
+    if (!s.ok() && contents.heap_allocated) {
+      delete[] contents.data.data();
+    }
+  }
+
   if (s.ok()) {
     // We've successfully read the footer and the index block: we're
     // ready to serve requests.
@@ -72,6 +95,7 @@ Status Table::Open(const Options& options, RandomAccessFile* file, uint64 size,
     rep->file = file;
     rep->metaindex_handle = footer.metaindex_handle();
     rep->index_block = index_block;
+    rep->partitioned_index = partitioned_index;
     rep->cache_id = (options.block_cache ? options.block_cache->NewId() : 0);
     *table = new Table(rep);
   } else {
@@ -152,18 +176,61 @@ Iterator* Table::BlockReader(void* arg, const StringPiece& index_value) {
   return iter;
 }
 
+Iterator* Table::NewIndexIterator() const {
+  Iterator* iter = rep_->index_block->NewIterator();
+  if (!rep_->partitioned_index) return iter;
+  // The entries of a partitioned index are in the blocks it points to.
+  return NewTwoLevelIterator(iter, &Table::BlockReader,
+                             const_cast<Table*>(this));
+}
+
 Iterator* Table::NewIterator() const {
-  return NewTwoLevelIterator(rep_->index_block->NewIterator(),
-                             &Table::BlockReader, const_cast<Table*>(this));
+  return NewTwoLevelIterator(NewIndexIterator(), &Table::BlockReader,
+                             const_cast<Table*>(this));
+}
+
+// Returns false if the bloom filter in "index_value", if any, rules out that
+// the block it points to holds "key".
+static bool BlockMayContain(const StringPiece& index_value,
+                            const StringPiece& key) {
+  BlockHandle handle;
+  StringPiece input = index_value;
+  if (!handle.DecodeFrom(&input).ok() || input.empty()) return true;
+  return BloomFilterMayContain(BloomHash(key), input);
+}
+
+namespace {
+struct GetState {
+  StringPiece key;
+  string* value;
+  bool found;
+};
+}  // namespace
+
+static void SaveValue(void* arg, const StringPiece& k, const StringPiece& v) {
+  GetState* state = reinterpret_cast<GetState*>(arg);
+  if (k == state->key) {
+    state->value->assign(v.data(), v.size());
+    state->found = true;
+  }
+}
+
+Status Table::Get(const StringPiece& key, string* value) {
+  GetState state = {key, value, false};
+  TF_RETURN_IF_ERROR(InternalGet(key, &state, &SaveValue));
+  if (!state.found) {
+    return errors::NotFound("key not found in table");
+  }
+  return OkStatus();
 }
 
 Status Table::InternalGet(const StringPiece& k, void* arg,
                           void (*saver)(void*, const StringPiece&,
                                         const StringPiece&)) {
   Status s;
-  Iterator* iiter = rep_->index_block->NewIterator();
+  Iterator* iiter = NewIndexIterator();
   iiter->Seek(k);
-  if (iiter->Valid()) {
+  if (iiter->Valid() && BlockMayContain(iiter->value(), k)) {
     Iterator* block_iter = BlockReader(this, iiter->value());
     block_iter->Seek(k);
     if (block_iter->Valid()) {
@@ -180,7 +247,7 @@ Status Table::InternalGet(const StringPiece& k, void* arg,
 }
 
 uint64 Table::ApproximateOffsetOf(const StringPiece& key) const {
-  Iterator* index_iter = rep_->index_block->NewIterator();
+  Iterator* index_iter = NewIndexIterator();
   index_iter->Seek(key);
   uint64 result;
   if (index_iter->Valid()) {
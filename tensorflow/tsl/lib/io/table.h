@@ -61,6 +61,12 @@ class Table {
   // be close to the file length.
   uint64 ApproximateOffsetOf(const StringPiece& key) const;
 
+  // Looks up "key".  If the table holds it, stores its value in "*value"
+  // and returns OK, else returns NotFound.  Unlike a Seek() of an iterator,
+  // this doesn't read the data block that a bloom filter rules out, if the
+  // table was built with filters.
+  Status Get(const StringPiece& key, string* value);
+
  private:
   struct Rep;
   Rep* rep_;
@@ -68,6 +74,9 @@ class Table {
   explicit Table(Rep* rep) { rep_ = rep; }
   static Iterator* BlockReader(void*, const StringPiece&);
 
+  // Returns an iterator over the index entries, which point to data blocks.
+  Iterator* NewIndexIterator() const;
+
   // Calls (*handle_result)(arg, ...) with the entry found after a call
   // to Seek(key).  May not make such a call if filter policy says
   // that key is not present.
@@ -17,6 +17,8 @@ limitations under the License.
 
 #include <assert.h>
 
+#include <vector>
+
 #include "tensorflow/tsl/lib/hash/crc32c.h"
 #include "tensorflow/tsl/lib/io/block_builder.h"
 #include "tensorflow/tsl/lib/io/format.h"
@@ -76,6 +78,10 @@ struct TableBuilder::Rep {
   Status status;
   BlockBuilder data_block;
   BlockBuilder index_block;
+  // The index over the index partitions, if the index is partitioned.
+  BlockBuilder top_index_block;
+  int64_t num_index_partitions;
+  string last_index_key;
   string last_key;
   int64_t num_entries;
   bool closed;  // Either Finish() or Abandon() has been called.
@@ -91,6 +97,10 @@ struct TableBuilder::Rep {
   // Invariant: r->pending_index_entry is true only if data_block is empty.
   bool pending_index_entry;
   BlockHandle pending_handle;  // Handle to add to index block
+  string pending_filter;       // Filter to add along with pending_handle
+
+  // Hashes of the keys of data_block, if filters are enabled.
+  std::vector<uint32> filter_hashes;
 
   string compressed_output;
 
@@ -101,10 +111,13 @@ struct TableBuilder::Rep {
         offset(0),
         data_block(&options),
         index_block(&index_block_options),
+        top_index_block(&index_block_options),
+        num_index_partitions(0),
         num_entries(0),
         closed(false),
         pending_index_entry(false) {
-    index_block_options.block_restart_interval = 1;
+    index_block_options.block_restart_interval =
+        opt.index_block_restart_interval;
   }
 };
 
@@ -134,15 +147,15 @@ void TableBuilder::Add(const StringPiece& key, const StringPiece& value) {
   if (r->pending_index_entry) {
     assert(r->data_block.empty());
     FindShortestSeparator(&r->last_key, key);
-    string handle_encoding;
-    r->pending_handle.EncodeTo(&handle_encoding);
-    r->index_block.Add(r->last_key, StringPiece(handle_encoding));
-    r->pending_index_entry = false;
+    AddIndexEntry(r->last_key);
   }
 
   r->last_key.assign(key.data(), key.size());
   r->num_entries++;
   r->data_block.Add(key, value);
+  if (r->options.filter_bits_per_key > 0) {
+    r->filter_hashes.push_back(BloomHash(key));
+  }
 
   const size_t estimated_block_size = r->data_block.CurrentSizeEstimate();
   if (estimated_block_size >= r->options.block_size) {
@@ -161,6 +174,42 @@ void TableBuilder::Flush() {
     r->pending_index_entry = true;
     // We don't flush the underlying file as that can be slow.
   }
+  if (!r->filter_hashes.empty()) {
+    AppendBloomFilter(r->filter_hashes, r->options.filter_bits_per_key,
+                      &r->pending_filter);
+    r->filter_hashes.clear();
+  }
+}
+
+void TableBuilder::AddIndexEntry(const StringPiece& key) {
+  Rep* r = rep_;
+  string handle_encoding;
+  r->pending_handle.EncodeTo(&handle_encoding);
+  handle_encoding.append(r->pending_filter);
+  r->index_block.Add(key, StringPiece(handle_encoding));
+  r->last_index_key.assign(key.data(), key.size());
+  r->pending_index_entry = false;
+  r->pending_filter.clear();
+
+  if (r->options.index_partition_size > 0 &&
+      r->index_block.CurrentSizeEstimate() >= r->options.index_partition_size) {
+    FlushIndexPartition();
+  }
+}
+
+void TableBuilder::FlushIndexPartition() {
+  Rep* r = rep_;
+  if (!ok()) return;
+  BlockHandle handle;
+  WriteBlock(&r->index_block, &handle);
+  if (ok()) {
+    // The last key of the partition is >= all keys of its data blocks, and <
+    // all keys of the following ones.
+    string handle_encoding;
+    handle.EncodeTo(&handle_encoding);
+    r->top_index_block.Add(r->last_index_key, StringPiece(handle_encoding));
+    r->num_index_partitions++;
+  }
 }
 
 void TableBuilder::WriteBlock(BlockBuilder* block, BlockHandle* handle) {
@@ -228,23 +277,30 @@ Status TableBuilder::Finish() {
 
   BlockHandle metaindex_block_handle, index_block_handle;
 
+  if (ok() && r->pending_index_entry) {
+    FindShortSuccessor(&r->last_key);
+    AddIndexEntry(r->last_key);
+  }
+  // Once the index is partitioned, its last entries go to a last partition.
+  const bool partitioned_index = r->num_index_partitions > 0;
+  if (partitioned_index && !r->index_block.empty()) {
+    FlushIndexPartition();
+  }
+
   // Write metaindex block
   if (ok()) {
     BlockBuilder meta_index_block(&r->options);
+    if (partitioned_index) {
+      meta_index_block.Add(kPartitionedIndexKey, StringPiece());
+    }
     // TODO(postrelease): Add stats and other meta blocks
     WriteBlock(&meta_index_block, &metaindex_block_handle);
   }
 
   // Write index block
   if (ok()) {
-    if (r->pending_index_entry) {
-      FindShortSuccessor(&r->last_key);
-      string handle_encoding;
-      r->pending_handle.EncodeTo(&handle_encoding);
-      r->index_block.Add(r->last_key, StringPiece(handle_encoding));
-      r->pending_index_entry = false;
-    }
-    WriteBlock(&r->index_block, &index_block_handle);
+    WriteBlock(partitioned_index ? &r->top_index_block : &r->index_block,
+               &index_block_handle);
   }
 
   // Write footer
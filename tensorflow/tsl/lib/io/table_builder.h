@@ -84,6 +84,8 @@ class TableBuilder {
  private:
   bool ok() const { return status().ok(); }
   void WriteBlock(BlockBuilder* block, BlockHandle* handle);
+  void AddIndexEntry(const StringPiece& key);
+  void FlushIndexPartition();
   void WriteRawBlock(const StringPiece& data, CompressionType,
                      BlockHandle* handle);
 
@@ -68,6 +68,24 @@ struct Options {
 
   // If non-null, use the specified cache for blocks.
   Cache* block_cache = nullptr;
+
+  // If greater than zero, store a bloom filter with this many bits per key
+  // for every data block, so that Table::Get() skips reading the blocks that
+  // certainly don't hold the key.  10 bits per key give about 1% of false
+  // positives.  Readers that don't support filters ignore them.
+  int filter_bits_per_key = 0;
+
+  // Number of keys between restart points for delta encoding of keys in
+  // the index blocks.  Larger values make the index smaller, at the cost
+  // of slower seeks within it.
+  int index_block_restart_interval = 1;
+
+  // If greater than zero, split the index of a table whose index outgrows
+  // this many bytes into partitions of about that size, under a top-level
+  // index.  Opening the table then only reads the top-level index, and
+  // lookups read the partitions they need, through the block cache.
+  // NOTE: readers that predate partitioned indexes can't read such tables.
+  size_t index_partition_size = 0;
 };
 
 }  // namespace table
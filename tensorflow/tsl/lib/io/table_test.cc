@@ -21,6 +21,7 @@ limitations under the License.
 #include <vector>
 
 #include "absl/strings/escaping.h"
+#include "tensorflow/tsl/lib/core/status_test_util.h"
 #include "tensorflow/tsl/lib/io/block.h"
 #include "tensorflow/tsl/lib/io/block_builder.h"
 #include "tensorflow/tsl/lib/io/format.h"
@@ -30,6 +31,7 @@ limitations under the License.
 #include "tensorflow/tsl/platform/env.h"
 #include "tensorflow/tsl/platform/errors.h"
 #include "tensorflow/tsl/platform/snappy.h"
+#include "tensorflow/tsl/platform/stringprintf.h"
 #include "tensorflow/tsl/platform/test.h"
 
 namespace tsl {
@@ -247,6 +249,10 @@ class TableConstructor : public Constructor {
 
   uint64 BytesRead() const { return source_->BytesRead(); }
 
+  Status Get(const StringPiece& key, string* value) {
+    return table_->Get(key, value);
+  }
+
  private:
   void Reset() {
     delete table_;
@@ -264,11 +270,16 @@ enum TestType { TABLE_TEST, BLOCK_TEST };
 struct TestArgs {
   TestType type;
   int restart_interval;
+  int filter_bits_per_key;
+  size_t index_partition_size;
 };
 
 static const TestArgs kTestArgList[] = {
-    {TABLE_TEST, 16}, {TABLE_TEST, 1}, {TABLE_TEST, 1024},
-    {BLOCK_TEST, 16}, {BLOCK_TEST, 1}, {BLOCK_TEST, 1024},
+    {TABLE_TEST, 16},         {TABLE_TEST, 1},
+    {TABLE_TEST, 1024},       {TABLE_TEST, 16, 10},
+    {TABLE_TEST, 16, 10, 64}, {TABLE_TEST, 1, 0, 64},
+    {BLOCK_TEST, 16},         {BLOCK_TEST, 1},
+    {BLOCK_TEST, 1024},
 };
 static const int kNumTestArgs = sizeof(kTestArgList) / sizeof(kTestArgList[0]);
 
@@ -282,6 +293,10 @@ class Harness : public ::testing::Test {
     options_ = Options();
 
     options_.block_restart_interval = args.restart_interval;
+    options_.index_block_restart_interval = args.restart_interval;
+    options_.filter_bits_per_key = args.filter_bits_per_key;
+    options_.index_partition_size = args.index_partition_size;
+    type_ = args.type;
     // Use shorter block size for tests to exercise block boundary
     // conditions more.
     options_.block_size = 256;
@@ -308,6 +323,26 @@ class Harness : public ::testing::Test {
 
     TestForwardScan(keys, data);
     TestRandomAccess(rnd, keys, data, num_random_access_iters);
+    if (type_ == TABLE_TEST) {
+      TestGet(rnd, keys, data, num_random_access_iters);
+    }
+  }
+
+  void TestGet(random::SimplePhilox* rnd, const std::vector<string>& keys,
+               const KVMap& data, int num_iters) {
+    TableConstructor* table = static_cast<TableConstructor*>(constructor_);
+    for (int i = 0; i < num_iters; i++) {
+      const string key = PickRandomKey(rnd, keys);
+      string value;
+      Status s = table->Get(key, &value);
+      KVMap::const_iterator model_iter = data.find(key);
+      if (model_iter == data.end()) {
+        ASSERT_TRUE(errors::IsNotFound(s)) << s.ToString();
+      } else {
+        TF_ASSERT_OK(s);
+        ASSERT_EQ(model_iter->second, value);
+      }
+    }
   }
 
   void TestForwardScan(const std::vector<string>& keys, const KVMap& data) {
@@ -425,6 +460,7 @@ class Harness : public ::testing::Test {
 
  private:
   Options options_;
+  TestType type_;
   Constructor* constructor_;
 };
 
@@ -633,5 +669,67 @@ TEST(TableTest, SeekToFirstKeyDoesNotReadTooMuch) {
   EXPECT_LT(c.BytesRead(), 200);
 }
 
+// Returns the bytes read by looking up 100 keys absent from the table of "c",
+// which holds the keys "k0000" to "k0999".
+static uint64 BytesReadByMissingKeys(TableConstructor* c) {
+  const uint64 bytes_read_before = c->BytesRead();
+  for (int i = 0; i < 100; i++) {
+    string value;
+    EXPECT_TRUE(
+        errors::IsNotFound(c->Get(strings::Printf("k%04da", i * 10), &value)));
+  }
+  return c->BytesRead() - bytes_read_before;
+}
+
+TEST(TableTest, FiltersSkipDataBlocks) {
+  for (int filter_bits_per_key : {0, 10}) {
+    TableConstructor c;
+    for (int i = 0; i < 1000; i++) {
+      c.Add(strings::Printf("k%04d", i), string(100, 'x'));
+    }
+    std::vector<string> keys;
+    KVMap kvmap;
+    Options options;
+    options.block_size = 1024;
+    options.compression = kNoCompression;
+    options.filter_bits_per_key = filter_bits_per_key;
+    c.Finish(options, &keys, &kvmap);
+
+    string value;
+    TF_ASSERT_OK(c.Get("k0123", &value));
+    EXPECT_EQ(string(100, 'x'), value);
+    if (filter_bits_per_key == 0) {
+      // Every lookup reads a data block.
+      EXPECT_GE(BytesReadByMissingKeys(&c), 100 * 1024);
+    } else {
+      // Only the false positives of the filters read one.
+      EXPECT_LT(BytesReadByMissingKeys(&c), 5 * 1024);
+    }
+  }
+}
+
+TEST(TableTest, PartitionedIndex) {
+  TableConstructor c;
+  for (int i = 0; i < 1000; i++) {
+    c.Add(strings::Printf("k%04d", i), string(100, 'x'));
+  }
+  std::vector<string> keys;
+  KVMap kvmap;
+  Options options;
+  options.block_size = 1024;
+  options.compression = kNoCompression;
+  options.index_partition_size = 256;
+  c.Finish(options, &keys, &kvmap);
+  // Opening the table reads the top-level index only.
+  EXPECT_LT(c.BytesRead(), 512);
+
+  for (int i = 0; i < 1000; i += 7) {
+    string value;
+    TF_ASSERT_OK(c.Get(strings::Printf("k%04d", i), &value));
+    EXPECT_EQ(string(100, 'x'), value);
+  }
+  EXPECT_TRUE(Between(c.ApproximateOffsetOf("k0500"), 50000, 60000));
+}
+
 }  // namespace table
 }  // namespace tsl
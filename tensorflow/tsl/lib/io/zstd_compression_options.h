@@ -0,0 +1,41 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_TSL_LIB_IO_ZSTD_COMPRESSION_OPTIONS_H_
+#define TENSORFLOW_TSL_LIB_IO_ZSTD_COMPRESSION_OPTIONS_H_
+
+#include "tensorflow/tsl/platform/types.h"
+
+namespace tsl {
+namespace io {
+
+struct ZstdCompressionOptions {
+  // Size of the buffer used for caching the data read from the compressed
+  // stream.
+  int64_t input_buffer_size = 256 << 10;
+
+  // Size of the buffer where the compressed/decompressed data produced by
+  // zstd is cached.
+  int64_t output_buffer_size = 256 << 10;
+
+  // From 1 (fastest) to 19 (best compression). Levels 20 to 22 need a lot of
+  // memory to decompress. 0 uses the default level of zstd, which is 3.
+  int8 compression_level = 0;
+};
+
+}  // namespace io
+}  // namespace tsl
+
+#endif  // TENSORFLOW_TSL_LIB_IO_ZSTD_COMPRESSION_OPTIONS_H_
@@ -0,0 +1,154 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/tsl/lib/io/zstd_inputstream.h"
+
+#include <zstd.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include "tensorflow/tsl/platform/errors.h"
+#include "tensorflow/tsl/platform/logging.h"
+
+namespace tsl {
+namespace io {
+
+ZstdInputStream::ZstdInputStream(InputStreamInterface* input_stream,
+                                 size_t input_buffer_bytes,
+                                 size_t output_buffer_bytes,
+                                 bool owns_input_stream)
+    : owns_input_stream_(owns_input_stream),
+      input_stream_(input_stream),
+      input_buffer_capacity_(input_buffer_bytes),
+      input_buffer_(new char[input_buffer_bytes]),
+      output_buffer_capacity_(output_buffer_bytes),
+      output_buffer_(new char[output_buffer_bytes]),
+      context_(ZSTD_createDCtx()) {
+  CHECK(context_ != nullptr) << "ZSTD_createDCtx failed";
+}
+
+ZstdInputStream::ZstdInputStream(InputStreamInterface* input_stream,
+                                 size_t input_buffer_bytes,
+                                 size_t output_buffer_bytes)
+    : ZstdInputStream(input_stream, input_buffer_bytes, output_buffer_bytes,
+                      false) {}
+
+ZstdInputStream::~ZstdInputStream() {
+  ZSTD_freeDCtx(context_);
+  if (owns_input_stream_) {
+    delete input_stream_;
+  }
+}
+
+Status ZstdInputStream::Reset() {
+  TF_RETURN_IF_ERROR(input_stream_->Reset());
+  ZSTD_DCtx_reset(context_, ZSTD_reset_session_only);
+  input_pos_ = input_size_ = 0;
+  output_pos_ = output_size_ = 0;
+  output_buffer_filled_ = false;
+  at_frame_boundary_ = true;
+  bytes_read_ = 0;
+  return OkStatus();
+}
+
+Status ZstdInputStream::ReadFromStream() {
+  tstring data;
+  Status s = input_stream_->ReadNBytes(input_buffer_capacity_, &data);
+  if (!s.ok() && !errors::IsOutOfRange(s)) {
+    return s;
+  }
+  // Reading less than requested is fine at the end of the stream.
+  if (data.empty()) {
+    return errors::OutOfRange("EOF reached");
+  }
+  memcpy(input_buffer_.get(), data.data(), data.size());
+  input_pos_ = 0;
+  input_size_ = data.size();
+  return OkStatus();
+}
+
+Status ZstdInputStream::Decompress() {
+  output_pos_ = output_size_ = 0;
+  while (output_size_ == 0) {
+    if (input_pos_ == input_size_ && !output_buffer_filled_) {
+      Status s = ReadFromStream();
+      if (errors::IsOutOfRange(s) && !at_frame_boundary_) {
+        return errors::DataLoss("truncated zstd stream");
+      }
+      TF_RETURN_IF_ERROR(s);
+    }
+    ZSTD_inBuffer input = {input_buffer_.get() + input_pos_,
+                           input_size_ - input_pos_, 0};
+    ZSTD_outBuffer output = {output_buffer_.get(), output_buffer_capacity_, 0};
+    const size_t result = ZSTD_decompressStream(context_, &output, &input);
+    if (ZSTD_isError(result)) {
+      return errors::DataLoss("ZSTD_decompressStream() failed: ",
+                              ZSTD_getErrorName(result));
+    }
+    input_pos_ += input.pos;
+    output_size_ = output.pos;
+    output_buffer_filled_ = output.pos == output.size;
+    // A result of 0 means that a frame was completely decoded and flushed.
+    // Calls that make no progress, like retrying after an exactly filled
+    // output buffer, report the size of the next frame header instead.
+    if (input.pos > 0 || output.pos > 0) {
+      at_frame_boundary_ = result == 0;
+    }
+  }
+  return OkStatus();
+}
+
+size_t ZstdInputStream::ReadBytesFromCache(size_t bytes_to_read,
+                                           tstring* result) {
+  const size_t can_read_bytes =
+      std::min(bytes_to_read, output_size_ - output_pos_);
+  if (can_read_bytes > 0) {
+    result->append(output_buffer_.get() + output_pos_, can_read_bytes);
+    output_pos_ += can_read_bytes;
+  }
+  bytes_read_ += can_read_bytes;
+  return can_read_bytes;
+}
+
+Status ZstdInputStream::ReadNBytes(int64_t bytes_to_read, tstring* result) {
+  result->clear();
+  // Read as many bytes as possible from cache.
+  bytes_to_read -= ReadBytesFromCache(bytes_to_read, result);
+
+  while (bytes_to_read > 0) {
+    // At this point we can be sure that cache has been emptied.
+    DCHECK_EQ(output_pos_, output_size_);
+    TF_RETURN_IF_ERROR(Decompress());
+    bytes_to_read -= ReadBytesFromCache(bytes_to_read, result);
+  }
+
+  return OkStatus();
+}
+
+#if defined(TF_CORD_SUPPORT)
+Status ZstdInputStream::ReadNBytes(int64_t bytes_to_read, absl::Cord* result) {
+  tstring buf;
+  TF_RETURN_IF_ERROR(ReadNBytes(bytes_to_read, &buf));
+  result->Clear();
+  result->Append(buf.data());
+  return OkStatus();
+}
+#endif
+
+int64_t ZstdInputStream::Tell() const { return bytes_read_; }
+
+}  // namespace io
+}  // namespace tsl
@@ -0,0 +1,256 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/tsl/lib/core/status_test_util.h"
+#include "tensorflow/tsl/lib/io/lz4_compression_options.h"
+#include "tensorflow/tsl/lib/io/lz4_inputstream.h"
+#include "tensorflow/tsl/lib/io/lz4_outputbuffer.h"
+#include "tensorflow/tsl/lib/io/random_inputstream.h"
+#include "tensorflow/tsl/lib/io/zlib_compression_options.h"
+#include "tensorflow/tsl/lib/io/zlib_inputstream.h"
+#include "tensorflow/tsl/lib/io/zlib_outputbuffer.h"
+#include "tensorflow/tsl/lib/io/zstd_compression_options.h"
+#include "tensorflow/tsl/lib/io/zstd_inputstream.h"
+#include "tensorflow/tsl/lib/io/zstd_outputbuffer.h"
+#include "tensorflow/tsl/platform/env.h"
+#include "tensorflow/tsl/platform/errors.h"
+#include "tensorflow/tsl/platform/strcat.h"
+#include "tensorflow/tsl/platform/test.h"
+#include "tensorflow/tsl/platform/test_benchmark.h"
+
+namespace tsl {
+namespace io {
+namespace {
+
+std::vector<int> BufferSizes() { return {10, 100, 1000, 100000}; }
+
+std::vector<int> NumCopies() { return {0, 1, 50, 500}; }
+
+string GenTestString(int copies) {
+  string result;
+  for (int i = 0; i < copies; i++) {
+    strings::StrAppend(&result, "Record ", i, ": Lorem ipsum dolor sit amet,",
+                       " consectetur adipiscing elit. Fusce vehicula ",
+                       "tincidunt libero sit amet ultrices.\n");
+  }
+  return result;
+}
+
+struct ZstdTraits {
+  using Options = ZstdCompressionOptions;
+  using OutputBuffer = ZstdOutputBuffer;
+  using InputStream = ZstdInputStream;
+};
+
+struct Lz4Traits {
+  using Options = Lz4CompressionOptions;
+  using OutputBuffer = Lz4OutputBuffer;
+  using InputStream = Lz4InputStream;
+};
+
+template <typename Traits>
+class CompressedBuffersTest : public ::testing::Test {
+ protected:
+  // Writes every string of `frames` to `fname` as a compressed frame of its
+  // own, flushing the output after `flush_every` bytes if it is positive.
+  void WriteFile(const string& fname, const std::vector<string>& frames,
+                 int buffer_size, int flush_every = 0) {
+    Env* env = Env::Default();
+    std::unique_ptr<WritableFile> file_writer;
+    TF_ASSERT_OK(env->NewWritableFile(fname, &file_writer));
+    typename Traits::Options options;
+    options.input_buffer_size = buffer_size;
+    options.output_buffer_size = buffer_size;
+    for (const string& data : frames) {
+      typename Traits::OutputBuffer out(file_writer.get(), options);
+      StringPiece remaining(data);
+      while (!remaining.empty()) {
+        const size_t n = flush_every > 0
+                             ? std::min<size_t>(remaining.size(), flush_every)
+                             : remaining.size();
+        TF_ASSERT_OK(out.Append(remaining.substr(0, n)));
+        if (flush_every > 0) TF_ASSERT_OK(out.Flush());
+        remaining.remove_prefix(n);
+      }
+      TF_ASSERT_OK(out.Close());
+    }
+    TF_ASSERT_OK(file_writer->Close());
+  }
+};
+
+using CompressionTypes = ::testing::Types<ZstdTraits, Lz4Traits>;
+TYPED_TEST_SUITE(CompressedBuffersTest, CompressionTypes);
+
+TYPED_TEST(CompressedBuffersTest, AllCombinations) {
+  Env* env = Env::Default();
+  string fname;
+  ASSERT_TRUE(env->LocalTempFilename(&fname));
+  for (int copies : NumCopies()) {
+    const string data = GenTestString(copies);
+    for (int buffer_size : BufferSizes()) {
+      this->WriteFile(fname, {data}, buffer_size);
+      std::unique_ptr<RandomAccessFile> file_reader;
+      TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file_reader));
+      RandomAccessInputStream input_stream(file_reader.get());
+      typename TypeParam::InputStream in(&input_stream, buffer_size,
+                                         buffer_size);
+      tstring result;
+      TF_ASSERT_OK(in.ReadNBytes(data.size(), &result));
+      EXPECT_EQ(result, data);
+      EXPECT_EQ(in.Tell(), data.size());
+      EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(1, &result)));
+    }
+  }
+}
+
+TYPED_TEST(CompressedBuffersTest, FlushesAndConcatenatedFrames) {
+  Env* env = Env::Default();
+  string fname;
+  ASSERT_TRUE(env->LocalTempFilename(&fname));
+  const string first = GenTestString(20);
+  const string second = GenTestString(30);
+  this->WriteFile(fname, {first, second}, 100, /*flush_every=*/333);
+
+  std::unique_ptr<RandomAccessFile> file_reader;
+  TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file_reader));
+  RandomAccessInputStream input_stream(file_reader.get());
+  typename TypeParam::InputStream in(&input_stream, 64, 64);
+  tstring result;
+  TF_ASSERT_OK(in.ReadNBytes(first.size() + second.size(), &result));
+  EXPECT_EQ(result, first + second);
+
+  TF_ASSERT_OK(in.Reset());
+  EXPECT_EQ(in.Tell(), 0);
+  TF_ASSERT_OK(in.SkipNBytes(first.size()));
+  TF_ASSERT_OK(in.ReadNBytes(second.size(), &result));
+  EXPECT_EQ(result, second);
+}
+
+TYPED_TEST(CompressedBuffersTest, TruncatedStream) {
+  Env* env = Env::Default();
+  string fname;
+  ASSERT_TRUE(env->LocalTempFilename(&fname));
+  const string data = GenTestString(100);
+  this->WriteFile(fname, {data}, 1000);
+
+  string compressed;
+  TF_ASSERT_OK(ReadFileToString(env, fname, &compressed));
+  compressed.resize(compressed.size() / 2);
+  TF_ASSERT_OK(WriteStringToFile(env, fname, compressed));
+
+  std::unique_ptr<RandomAccessFile> file_reader;
+  TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file_reader));
+  RandomAccessInputStream input_stream(file_reader.get());
+  typename TypeParam::InputStream in(&input_stream, 1000, 1000);
+  tstring result;
+  EXPECT_TRUE(errors::IsDataLoss(in.ReadNBytes(data.size(), &result)));
+}
+
+TYPED_TEST(CompressedBuffersTest, CorruptedStream) {
+  Env* env = Env::Default();
+  string fname;
+  ASSERT_TRUE(env->LocalTempFilename(&fname));
+  TF_ASSERT_OK(WriteStringToFile(env, fname, GenTestString(10)));
+
+  std::unique_ptr<RandomAccessFile> file_reader;
+  TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file_reader));
+  RandomAccessInputStream input_stream(file_reader.get());
+  typename TypeParam::InputStream in(&input_stream, 1000, 1000);
+  tstring result;
+  EXPECT_TRUE(errors::IsDataLoss(in.ReadNBytes(1, &result)));
+}
+
+TYPED_TEST(CompressedBuffersTest, AppendAfterClose) {
+  Env* env = Env::Default();
+  string fname;
+  ASSERT_TRUE(env->LocalTempFilename(&fname));
+  std::unique_ptr<WritableFile> file_writer;
+  TF_ASSERT_OK(env->NewWritableFile(fname, &file_writer));
+  typename TypeParam::OutputBuffer out(file_writer.get(),
+                                       typename TypeParam::Options());
+  TF_ASSERT_OK(out.Append("data"));
+  TF_ASSERT_OK(out.Close());
+  EXPECT_TRUE(errors::IsFailedPrecondition(out.Append("more data")));
+}
+
+// Compares the decompression throughput of zlib (0), zstd (1) and lz4 (2) on
+// 64MB of log-like text.
+void BM_Decompress(::testing::benchmark::State& state) {
+  const int compression = state.range(0);
+  const int64_t buffer_size = 256 << 10;
+  Env* env = Env::Default();
+  string fname;
+  ASSERT_TRUE(env->LocalTempFilename(&fname));
+
+  string data;
+  for (int64_t step = 0; data.size() < (64 << 20); ++step) {
+    strings::StrAppend(&data, "I1015 12:", step / 60000 % 60, ":",
+                       step / 1000 % 60, ".", step * 7919 % 1000000, " step ",
+                       step, " loss=0.", step * 104729 % 100000, "\n");
+  }
+
+  std::unique_ptr<WritableFile> file_writer;
+  TF_ASSERT_OK(env->NewWritableFile(fname, &file_writer));
+  if (compression == 0) {
+    ZlibCompressionOptions options = ZlibCompressionOptions::DEFAULT();
+    ZlibOutputBuffer out(file_writer.get(), buffer_size, buffer_size, options);
+    TF_ASSERT_OK(out.Init());
+    TF_ASSERT_OK(out.Append(data));
+    TF_ASSERT_OK(out.Close());
+  } else if (compression == 1) {
+    ZstdOutputBuffer out(file_writer.get(), ZstdCompressionOptions());
+    TF_ASSERT_OK(out.Append(data));
+    TF_ASSERT_OK(out.Close());
+  } else {
+    Lz4OutputBuffer out(file_writer.get(), Lz4CompressionOptions());
+    TF_ASSERT_OK(out.Append(data));
+    TF_ASSERT_OK(out.Close());
+  }
+  TF_ASSERT_OK(file_writer->Close());
+
+  std::unique_ptr<RandomAccessFile> file_reader;
+  TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file_reader));
+  uint64 compressed_size;
+  TF_ASSERT_OK(env->GetFileSize(fname, &compressed_size));
+  state.counters["ratio"] = static_cast<double>(data.size()) / compressed_size;
+
+  tstring result;
+  for (auto s : state) {
+    RandomAccessInputStream input_stream(file_reader.get());
+    std::unique_ptr<InputStreamInterface> in;
+    if (compression == 0) {
+      in = std::make_unique<ZlibInputStream>(&input_stream, buffer_size,
+                                             buffer_size,
+                                             ZlibCompressionOptions::DEFAULT());
+    } else if (compression == 1) {
+      in = std::make_unique<ZstdInputStream>(&input_stream, buffer_size,
+                                             buffer_size);
+    } else {
+      in = std::make_unique<Lz4InputStream>(&input_stream, buffer_size,
+                                            buffer_size);
+    }
+    TF_ASSERT_OK(in->ReadNBytes(data.size(), &result));
+  }
+  state.SetBytesProcessed(state.iterations() * data.size());
+}
+BENCHMARK(BM_Decompress)->Arg(0)->Arg(1)->Arg(2);
+
+}  // namespace
+}  // namespace io
+}  // namespace tsl
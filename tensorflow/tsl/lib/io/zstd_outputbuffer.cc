@@ -0,0 +1,122 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/tsl/lib/io/zstd_outputbuffer.h"
+
+#include <zstd.h>
+
+#include "tensorflow/tsl/platform/errors.h"
+#include "tensorflow/tsl/platform/logging.h"
+
+namespace tsl {
+namespace io {
+
+ZstdOutputBuffer::ZstdOutputBuffer(WritableFile* file,
+                                   const ZstdCompressionOptions& options)
+    : file_(file),
+      output_buffer_capacity_(options.output_buffer_size),
+      output_buffer_(new char[options.output_buffer_size]),
+      context_(ZSTD_createCCtx()) {
+  CHECK(context_ != nullptr) << "ZSTD_createCCtx failed";
+  ZSTD_CCtx_setParameter(context_, ZSTD_c_compressionLevel,
+                         options.compression_level);
+  ZSTD_CCtx_setParameter(context_, ZSTD_c_checksumFlag, 1);
+}
+
+ZstdOutputBuffer::~ZstdOutputBuffer() {
+  if (context_ != nullptr) {
+    LOG(WARNING) << "ZstdOutputBuffer::Close() not called. Possible data loss";
+    ZSTD_freeCCtx(context_);
+  }
+}
+
+Status ZstdOutputBuffer::Compress(StringPiece data, int end_op) {
+  if (context_ == nullptr) {
+    return errors::FailedPrecondition(
+        "Compress() called after ZstdOutputBuffer was closed.");
+  }
+  ZSTD_inBuffer input = {data.data(), data.size(), 0};
+  while (true) {
+    ZSTD_outBuffer output = {output_buffer_.get(), output_buffer_capacity_,
+                             output_size_};
+    const size_t remaining = ZSTD_compressStream2(
+        context_, &output, &input, static_cast<ZSTD_EndDirective>(end_op));
+    if (ZSTD_isError(remaining)) {
+      return errors::DataLoss("ZSTD_compressStream2() failed: ",
+                              ZSTD_getErrorName(remaining));
+    }
+    output_size_ = output.pos;
+    // zstd takes all input unless the output buffer is full, and flushes until
+    // nothing remains.
+    const bool done = end_op == ZSTD_e_continue ? input.pos == input.size
+                                                : remaining == 0;
+    if (done) return OkStatus();
+    TF_RETURN_IF_ERROR(FlushOutputBufferToFile());
+  }
+}
+
+Status ZstdOutputBuffer::FlushOutputBufferToFile() {
+  if (output_size_ > 0) {
+    TF_RETURN_IF_ERROR(
+        file_->Append(StringPiece(output_buffer_.get(), output_size_)));
+    output_size_ = 0;
+  }
+  return OkStatus();
+}
+
+Status ZstdOutputBuffer::Append(StringPiece data) {
+  return Compress(data, ZSTD_e_continue);
+}
+
+#if defined(TF_CORD_SUPPORT)
+Status ZstdOutputBuffer::Append(const absl::Cord& cord) {
+  for (absl::string_view fragment : cord.Chunks()) {
+    TF_RETURN_IF_ERROR(Append(fragment));
+  }
+  return OkStatus();
+}
+#endif
+
+Status ZstdOutputBuffer::Flush() {
+  TF_RETURN_IF_ERROR(Compress(StringPiece(), ZSTD_e_flush));
+  TF_RETURN_IF_ERROR(FlushOutputBufferToFile());
+  return file_->Flush();
+}
+
+Status ZstdOutputBuffer::Name(StringPiece* result) const {
+  return file_->Name(result);
+}
+
+Status ZstdOutputBuffer::Sync() {
+  TF_RETURN_IF_ERROR(Flush());
+  return file_->Sync();
+}
+
+Status ZstdOutputBuffer::Close() {
+  if (context_ != nullptr) {
+    TF_RETURN_IF_ERROR(Compress(StringPiece(), ZSTD_e_end));
+    TF_RETURN_IF_ERROR(FlushOutputBufferToFile());
+    ZSTD_freeCCtx(context_);
+    context_ = nullptr;
+  }
+  return OkStatus();
+}
+
+Status ZstdOutputBuffer::Tell(int64_t* position) {
+  return file_->Tell(position);
+}
+
+}  // namespace io
+}  // namespace tsl
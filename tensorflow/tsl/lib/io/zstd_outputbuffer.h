@@ -0,0 +1,108 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_TSL_LIB_IO_ZSTD_OUTPUTBUFFER_H_
+#define TENSORFLOW_TSL_LIB_IO_ZSTD_OUTPUTBUFFER_H_
+
+#include <memory>
+
+#include "tensorflow/tsl/lib/io/zstd_compression_options.h"
+#include "tensorflow/tsl/platform/file_system.h"
+#include "tensorflow/tsl/platform/macros.h"
+#include "tensorflow/tsl/platform/status.h"
+#include "tensorflow/tsl/platform/stringpiece.h"
+#include "tensorflow/tsl/platform/types.h"
+
+// Forward declare the compression context of zstd, which is only included in
+// the .cc file.
+struct ZSTD_CCtx_s;
+
+namespace tsl {
+namespace io {
+
+// Provides support for writing compressed output to file using zstd
+// (https://facebook.github.io/zstd/). The output is a single zstd frame, with
+// a checksum of the content.
+//
+// A given instance of a ZstdOutputBuffer is NOT safe for concurrent use
+// by multiple threads
+class ZstdOutputBuffer : public WritableFile {
+ public:
+  // Create a ZstdOutputBuffer for `file` with a buffer of size
+  // `options.output_buffer_size` that caches the compressed output. zstd
+  // buffers the input itself. Does not take ownership of `file`.
+  ZstdOutputBuffer(WritableFile* file, const ZstdCompressionOptions& options);
+
+  // Per convention, the dtor does not call Flush() or Close(). We expect the
+  // caller to call those manually when done.
+  ~ZstdOutputBuffer() override;
+
+  // Adds `data` to the compression pipeline. The compressed output is written
+  // to file when the output buffer is full.
+  //
+  // To immediately write contents to file call `Flush()`.
+  Status Append(StringPiece data) override;
+
+#if defined(TF_CORD_SUPPORT)
+  Status Append(const absl::Cord& cord) override;
+#endif
+
+  // Compresses any cached input and writes all output to file.
+  Status Flush() override;
+
+  // Ends the zstd frame and writes all output to file. This must be called
+  // before the destructor to avoid any data loss. Does not close `file`.
+  //
+  // After calling this, any further calls to `Append()` or `Flush()` will
+  // fail.
+  Status Close() override;
+
+  // Returns the name of the underlying file.
+  Status Name(StringPiece* result) const override;
+
+  // Compresses any cached input, writes all output to file and syncs it.
+  Status Sync() override;
+
+  // Returns the write position in the underlying file. The position does not
+  // reflect buffered, un-flushed data.
+  Status Tell(int64_t* position) override;
+
+ private:
+  // Feeds `data` to zstd with the ZSTD_EndDirective `end_op`, writing the
+  // output buffer to file whenever it is full.
+  Status Compress(StringPiece data, int end_op);
+
+  // Appends contents of `output_buffer_` to `file_`.
+  // Returns non-OK status if writing to file fails.
+  Status FlushOutputBufferToFile();
+
+  WritableFile* file_;  // Not owned
+
+  // Buffer for storing compressed contents, of which the first
+  // `output_size_` bytes are not written to file yet.
+  const size_t output_buffer_capacity_;
+  std::unique_ptr<char[]> output_buffer_;
+  size_t output_size_ = 0;
+
+  // Null once closed.
+  ZSTD_CCtx_s* context_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ZstdOutputBuffer);
+};
+
+}  // namespace io
+}  // namespace tsl
+
+#endif  // TENSORFLOW_TSL_LIB_IO_ZSTD_OUTPUTBUFFER_H_
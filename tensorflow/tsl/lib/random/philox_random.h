@@ -157,6 +157,56 @@ class PhiloxRandom {
     }
   }
 
+  // Number of results computed together by GenerateBatch().
+  static constexpr int kBatchSize = 16;
+
+  // Writes the next kBatchSize groups of four random numbers to `output` and
+  // skips them in the stream, so that the results are bit-identical to
+  // kBatchSize calls of operator(). The rounds are computed for all the groups
+  // in lockstep over arrays of 32-bit words, which lets the compiler use vector
+  // multiplies (AVX2, AVX-512 or NEON, depending on the target) instead of one
+  // scalar multiply per word.
+  void GenerateBatch(ResultType* output) {
+    uint32_t c0[kBatchSize];
+    uint32_t c1[kBatchSize];
+    uint32_t c2[kBatchSize];
+    uint32_t c3[kBatchSize];
+    PhiloxRandom lane = *this;
+    for (int i = 0; i < kBatchSize; ++i) {
+      c0[i] = lane.counter_[0];
+      c1[i] = lane.counter_[1];
+      c2[i] = lane.counter_[2];
+      c3[i] = lane.counter_[3];
+      lane.SkipOne();
+    }
+
+    Key key = key_;
+    for (int round = 0; round < 10; ++round) {
+      if (round > 0) RaiseKey(&key);
+      // Same as ComputeSingleRound() for every group.
+      for (int i = 0; i < kBatchSize; ++i) {
+        const uint64_t product0 = static_cast<uint64_t>(kPhiloxM4x32A) * c0[i];
+        const uint64_t product1 = static_cast<uint64_t>(kPhiloxM4x32B) * c2[i];
+        const uint32_t next0 =
+            static_cast<uint32_t>(product1 >> 32) ^ c1[i] ^ key[0];
+        const uint32_t next2 =
+            static_cast<uint32_t>(product0 >> 32) ^ c3[i] ^ key[1];
+        c1[i] = static_cast<uint32_t>(product1);
+        c3[i] = static_cast<uint32_t>(product0);
+        c0[i] = next0;
+        c2[i] = next2;
+      }
+    }
+
+    for (int i = 0; i < kBatchSize; ++i) {
+      output[i][0] = c0[i];
+      output[i][1] = c1[i];
+      output[i][2] = c2[i];
+      output[i][3] = c3[i];
+    }
+    counter_ = lane.counter_;
+  }
+
   // Returns a group of four random numbers using the underlying Philox
   // algorithm.
   PHILOX_DEVICE_INLINE ResultType operator()() {
@@ -252,6 +302,33 @@ class PhiloxRandom {
   Key key_;
 };
 
+// A generator returning the same stream as a PhiloxRandom, computed
+// PhiloxRandom::kBatchSize groups at a time with GenerateBatch(). The stream
+// is consumed in whole batches, so the wrapped generator may be advanced past
+// the last group returned. Only for use on the host.
+class BatchedPhiloxRandom {
+ public:
+  using ResultType = PhiloxRandom::ResultType;
+  using ResultElementType = PhiloxRandom::ResultElementType;
+  static constexpr int kResultElementCount = PhiloxRandom::kResultElementCount;
+
+  explicit BatchedPhiloxRandom(PhiloxRandom gen)
+      : gen_(gen), next_(PhiloxRandom::kBatchSize) {}
+
+  ResultType operator()() {
+    if (next_ == PhiloxRandom::kBatchSize) {
+      gen_.GenerateBatch(results_);
+      next_ = 0;
+    }
+    return results_[next_++];
+  }
+
+ private:
+  PhiloxRandom gen_;
+  ResultType results_[PhiloxRandom::kBatchSize];
+  int next_;
+};
+
 }  // namespace random
 }  // namespace tsl
 
@@ -69,6 +69,42 @@ TEST(PhiloxRandomTest, SkipMatchTest) {
   }
 }
 
+// This test checks that generating batches of samples, including across a
+// carry into the higher words of the counter, is equivalent to generating
+// them one at a time.
+TEST(PhiloxRandomTest, BatchMatchTest) {
+  constexpr int count = 3 * PhiloxRandom::kBatchSize + 1;
+
+  uint64 test_seed = GetTestSeed();
+  PhiloxRandom::ResultType counter;
+  counter[0] = 0xFFFFFFF0u;
+  counter[1] = 0xFFFFFFFFu;
+  counter[2] = 0xFFFFFFFFu;
+  counter[3] = 7;
+  PhiloxRandom::Key key;
+  key[0] = static_cast<uint32>(test_seed);
+  key[1] = static_cast<uint32>(test_seed >> 32);
+
+  PhiloxRandom gen(counter, key);
+  BatchedPhiloxRandom batched_gen(PhiloxRandom(counter, key));
+  for (int i = 0; i < count; ++i) {
+    const PhiloxRandom::ResultType expected = gen();
+    const PhiloxRandom::ResultType actual = batched_gen();
+    for (int j = 0; j < PhiloxRandom::kResultElementCount; ++j) {
+      ASSERT_EQ(actual[j], expected[j]) << "sample " << i << " element " << j;
+    }
+  }
+
+  PhiloxRandom batch_gen(counter, key);
+  PhiloxRandom::ResultType batch[PhiloxRandom::kBatchSize];
+  batch_gen.GenerateBatch(batch);
+  PhiloxRandom skip_gen(counter, key);
+  skip_gen.Skip(PhiloxRandom::kBatchSize);
+  for (int j = 0; j < PhiloxRandom::kResultElementCount; ++j) {
+    EXPECT_EQ(batch_gen.counter()[j], skip_gen.counter()[j]);
+  }
+}
+
 }  // namespace
 }  // namespace random
 }  // namespace tsl
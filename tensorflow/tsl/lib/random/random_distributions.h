@@ -58,6 +58,8 @@ PHILOX_DEVICE_INLINE Int SignedAdd(Int a,
 //             distribution. This could be either float or double for now.
 // This class is meant to be implemented through specialization. The default
 // is not defined by design.
+// Samples can also be drawn from any other generator with the same ResultType
+// as Generator, such as a BatchedPhiloxRandom wrapping a PhiloxRandom.
 template <class Generator, typename RealType>
 class UniformDistribution;
 
@@ -74,8 +76,8 @@ class UniformDistribution<Generator, Eigen::half> {
   typedef Array<Eigen::half, kResultElementCount> ResultType;
   typedef Eigen::half ResultElementType;
 
-  PHILOX_DEVICE_INLINE
-  ResultType operator()(Generator* gen) {
+  template <class SampleGenerator>
+  PHILOX_DEVICE_INLINE ResultType operator()(SampleGenerator* gen) {
     typename Generator::ResultType sample = (*gen)();
     ResultType result;
     for (int i = 0; i < kResultElementCount; ++i) {
@@ -98,8 +100,8 @@ class UniformDistribution<Generator, bfloat16> {
   typedef Array<bfloat16, kResultElementCount> ResultType;
   typedef bfloat16 ResultElementType;
 
-  PHILOX_DEVICE_INLINE
-  ResultType operator()(Generator* gen) {
+  template <class SampleGenerator>
+  PHILOX_DEVICE_INLINE ResultType operator()(SampleGenerator* gen) {
     typename Generator::ResultType sample = (*gen)();
     ResultType result;
     for (int i = 0; i < kResultElementCount; ++i) {
@@ -122,8 +124,8 @@ class UniformDistribution<Generator, float> {
   typedef Array<float, kResultElementCount> ResultType;
   typedef float ResultElementType;
 
-  PHILOX_DEVICE_INLINE
-  ResultType operator()(Generator* gen) {
+  template <class SampleGenerator>
+  PHILOX_DEVICE_INLINE ResultType operator()(SampleGenerator* gen) {
     typename Generator::ResultType sample = (*gen)();
     ResultType result;
     for (int i = 0; i < kResultElementCount; ++i) {
@@ -146,8 +148,8 @@ class UniformDistribution<Generator, double> {
   typedef Array<double, kResultElementCount> ResultType;
   typedef double ResultElementType;
 
-  PHILOX_DEVICE_INLINE
-  ResultType operator()(Generator* gen) {
+  template <class SampleGenerator>
+  PHILOX_DEVICE_INLINE ResultType operator()(SampleGenerator* gen) {
     typename Generator::ResultType sample = (*gen)();
     ResultType result;
     for (int i = 0; i < kResultElementCount; ++i) {
@@ -174,8 +176,8 @@ class UniformDistribution<Generator, int32> {
   UniformDistribution(int32_t lo, int32_t hi)
       : lo_(lo), range_(static_cast<uint32>(hi) - static_cast<uint32>(lo)) {}
 
-  PHILOX_DEVICE_INLINE
-  ResultType operator()(Generator* gen) {
+  template <class SampleGenerator>
+  PHILOX_DEVICE_INLINE ResultType operator()(SampleGenerator* gen) {
     typename Generator::ResultType sample = (*gen)();
     ResultType result;
     for (int i = 0; i < kResultElementCount; ++i) {
@@ -209,8 +211,8 @@ class UniformDistribution<Generator, int64_t> {
   UniformDistribution(int64_t lo, int64_t hi)
       : lo_(lo), range_(static_cast<uint64>(hi) - static_cast<uint64>(lo)) {}
 
-  PHILOX_DEVICE_INLINE
-  ResultType operator()(Generator* gen) {
+  template <class SampleGenerator>
+  PHILOX_DEVICE_INLINE ResultType operator()(SampleGenerator* gen) {
     typename Generator::ResultType sample = (*gen)();
     ResultType result;
     for (int i = 0; i < kResultElementCount; ++i) {
@@ -247,8 +249,8 @@ class UniformFullIntDistribution32 {
   typedef Array<IntType, kResultElementCount> ResultType;
   typedef IntType ResultElementType;
 
-  PHILOX_DEVICE_INLINE
-  ResultType operator()(Generator* gen) {
+  template <class SampleGenerator>
+  PHILOX_DEVICE_INLINE ResultType operator()(SampleGenerator* gen) {
     typename Generator::ResultType sample = (*gen)();
     ResultType result;
     for (int i = 0; i < kResultElementCount; ++i) {
@@ -271,8 +273,8 @@ class UniformFullIntDistribution64 {
   typedef Array<IntType, kResultElementCount> ResultType;
   typedef IntType ResultElementType;
 
-  PHILOX_DEVICE_INLINE
-  ResultType operator()(Generator* gen) {
+  template <class SampleGenerator>
+  PHILOX_DEVICE_INLINE ResultType operator()(SampleGenerator* gen) {
     typename Generator::ResultType sample = (*gen)();
     ResultType result;
     for (int i = 0; i < kResultElementCount; ++i) {
@@ -368,6 +370,8 @@ class SingleSampleAdapter {
 //             distribution. This could be either float or double for now.
 // This class is meant to be implemented through specialization. The default
 // is not defined by design.
+// Like UniformDistribution, samples can be drawn from any generator with the
+// same ResultType as Generator.
 template <class Generator, typename RealType>
 class NormalDistribution;
 
@@ -391,8 +395,8 @@ class NormalDistribution<Generator, Eigen::half> {
   typedef Array<Eigen::half, kResultElementCount> ResultType;
   typedef Eigen::half ResultElementType;
 
-  PHILOX_DEVICE_INLINE
-  ResultType operator()(Generator* gen) {
+  template <class SampleGenerator>
+  PHILOX_DEVICE_INLINE ResultType operator()(SampleGenerator* gen) {
     typename Generator::ResultType sample = (*gen)();
     ResultType result;
     for (int i = 0; i < kResultElementCount; i += 2) {
@@ -418,8 +422,8 @@ class NormalDistribution<Generator, bfloat16> {
   typedef Array<bfloat16, kResultElementCount> ResultType;
   typedef bfloat16 ResultElementType;
 
-  PHILOX_DEVICE_INLINE
-  ResultType operator()(Generator* gen) {
+  template <class SampleGenerator>
+  PHILOX_DEVICE_INLINE ResultType operator()(SampleGenerator* gen) {
     typename Generator::ResultType sample = (*gen)();
     ResultType result;
     static_assert(kResultElementCount % 2 == 0,
@@ -448,8 +452,8 @@ class NormalDistribution<Generator, float> {
   typedef Array<float, kResultElementCount> ResultType;
   typedef float ResultElementType;
 
-  PHILOX_DEVICE_INLINE
-  ResultType operator()(Generator* gen) {
+  template <class SampleGenerator>
+  PHILOX_DEVICE_INLINE ResultType operator()(SampleGenerator* gen) {
     typename Generator::ResultType sample = (*gen)();
     ResultType result;
     for (int i = 0; i < kResultElementCount; i += 2) {
@@ -472,8 +476,8 @@ class NormalDistribution<Generator, double> {
   typedef Array<double, kResultElementCount> ResultType;
   typedef double ResultElementType;
 
-  PHILOX_DEVICE_INLINE
-  ResultType operator()(Generator* gen) {
+  template <class SampleGenerator>
+  PHILOX_DEVICE_INLINE ResultType operator()(SampleGenerator* gen) {
     typename Generator::ResultType sample = (*gen)();
     ResultType result;
     for (int i = 0; i < kResultElementCount; i += 2) {
@@ -24,6 +24,7 @@ limitations under the License.
 #endif
 
 #include <algorithm>
+#include <atomic>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
@@ -162,11 +163,66 @@ constexpr char kAppendMode[] = "GCS_APPEND_MODE";
 // objects.
 constexpr char kComposeAppend[] = "compose";
 
+// The environment variable that overrides the maximum read-ahead of sequential
+// readers of uncached files, in blocks (format: <uint64>).
+constexpr char kReadaheadMaxBlocks[] = "GCS_READAHEAD_MAX_BLOCKS";
+constexpr size_t kDefaultReadaheadMaxBlocks = 2;
+// The environment variable that overrides the maximum number of concurrent
+// ranged requests used to refill the read-ahead buffer (format: <uint64>).
+constexpr char kReadParallelism[] = "GCS_READ_PARALLELISM";
+constexpr size_t kDefaultReadParallelism = 8;
+// The environment variable that enables parallel composite uploads of files of
+// at least this size, in MB. Composite objects have no MD5 hash, so this is
+// disabled by default (format: <uint64>).
+constexpr char kCompositeUploadThreshold[] =
+    "GCS_COMPOSITE_UPLOAD_THRESHOLD_MB";
+// The environment variable that overrides the minimum size of the parts of a
+// composite upload, in MB (format: <uint64>).
+constexpr char kCompositeUploadPartSize[] = "GCS_COMPOSITE_UPLOAD_PART_SIZE_MB";
+// The environment variable that overrides the number of parts of a composite
+// upload that are uploaded concurrently (format: <uint64>).
+constexpr char kCompositeUploadParallelism[] =
+    "GCS_COMPOSITE_UPLOAD_PARALLELISM";
+constexpr size_t kDefaultCompositeUploadParallelism = 8;
+// The maximum number of source objects of a single compose request.
+constexpr size_t kMaxComposeSources = 32;
+
 Status GetTmpFilename(string* filename) {
   *filename = io::GetTempFilename("");
   return OkStatus();
 }
 
+/// \brief Calls `fn` for every index in [0, num_tasks) on up to `parallelism`
+/// threads, including the calling one, and returns the first error.
+///
+/// With a parallelism of 1 the tasks run in order on the calling thread.
+Status ParallelFor(size_t num_tasks, size_t parallelism,
+                   const std::function<Status(size_t)>& fn) {
+  std::atomic<size_t> next_task(0);
+  mutex mu;
+  Status status;
+  auto worker = [&]() {
+    for (size_t i = next_task++; i < num_tasks; i = next_task++) {
+      Status task_status = fn(i);
+      if (!task_status.ok()) {
+        mutex_lock l(mu);
+        status.Update(task_status);
+      }
+    }
+  };
+  {
+    std::vector<std::unique_ptr<Thread>> threads;
+    const size_t num_threads = std::min(num_tasks, parallelism);
+    for (size_t t = 1; t < num_threads; ++t) {
+      threads.emplace_back(
+          Env::Default()->StartThread(ThreadOptions(), "gcs_transfer", worker));
+    }
+    worker();
+    // The Thread destructors join the workers.
+  }
+  return status;
+}
+
 /// Appends a trailing slash if the name doesn't already have one.
 string MaybeAppendSlash(const string& name) {
   if (name.empty()) {
@@ -344,15 +400,23 @@ class BufferedGcsRandomAccessFile : public RandomAccessFile {
   using ReadFn =
       std::function<Status(const string& filename, uint64 offset, size_t n,
                            StringPiece* result, char* scratch)>;
-
-  // Initialize the reader. Provided read_fn should be thread safe.
-  BufferedGcsRandomAccessFile(const string& filename, uint64 buffer_size,
-                              ReadFn read_fn)
+  using ThroughputFn = std::function<void(
+      const string& filename, size_t bytes_transferred, uint64 elapsed_micros)>;
+
+  // Initialize the reader. Provided read_fn should be thread safe, as a
+  // refill may call it concurrently for disjoint ranges.
+  BufferedGcsRandomAccessFile(
+      const string& filename, uint64 buffer_size,
+      const GcsFileSystem::ReadaheadConfig& readahead, ReadFn read_fn,
+      ThroughputFn throughput_fn)
       : filename_(filename),
         read_fn_(std::move(read_fn)),
+        throughput_fn_(std::move(throughput_fn)),
         buffer_size_(buffer_size),
+        readahead_(readahead),
         buffer_start_(0),
-        buffer_end_is_past_eof_(false) {}
+        buffer_end_is_past_eof_(false),
+        readahead_blocks_(1) {}
 
   Status Name(StringPiece* result) const override {
     *result = filename_;
@@ -404,13 +468,54 @@ class BufferedGcsRandomAccessFile : public RandomAccessFile {
  private:
   Status FillBuffer(uint64 start) const
       TF_EXCLUSIVE_LOCKS_REQUIRED(buffer_mutex_) {
+    // Grow the read-ahead while the reader keeps consuming the buffer to its
+    // end, and fall back to a single block as soon as it seeks elsewhere.
+    if (!buffer_.empty() && start == buffer_start_ + buffer_.size()) {
+      readahead_blocks_ =
+          std::min(readahead_blocks_ * 2, readahead_.max_blocks);
+    } else {
+      readahead_blocks_ = 1;
+    }
+    const size_t fill_size =
+        buffer_size_ * std::max<size_t>(readahead_blocks_, 1);
     buffer_start_ = start;
-    buffer_.resize(buffer_size_);
-    StringPiece str_piece;
-    Status status = read_fn_(filename_, buffer_start_, buffer_size_, &str_piece,
-                             &(buffer_[0]));
+    buffer_.resize(fill_size);
+
+    // Split the refill into equally sized concurrent ranged reads.
+    size_t num_reads = std::max<size_t>(
+        1, std::min(readahead_.max_parallel_reads,
+                    fill_size / std::max<size_t>(
+                                    readahead_.min_parallel_read_size, 1)));
+    const size_t read_size = (fill_size + num_reads - 1) / num_reads;
+    num_reads = (fill_size + read_size - 1) / read_size;
+    std::vector<StringPiece> pieces(num_reads);
+    std::vector<Status> statuses(num_reads);
+    char* buffer = &buffer_[0];
+    const uint64 start_micros = Env::Default()->NowMicros();
+    ParallelFor(num_reads, num_reads, [&](size_t i) {
+      const size_t read_offset = i * read_size;
+      statuses[i] = read_fn_(filename_, start + read_offset,
+                             std::min(read_size, fill_size - read_offset),
+                             &pieces[i], buffer + read_offset);
+      return OkStatus();
+    }).IgnoreError();
+
+    // The buffer holds the data up to the first short or failed read.
+    size_t bytes_read = 0;
+    Status status;
+    for (size_t i = 0; i < num_reads; ++i) {
+      bytes_read += pieces[i].size();
+      if (!statuses[i].ok()) {
+        status = statuses[i];
+        break;
+      }
+    }
+    if (throughput_fn_) {
+      throughput_fn_(filename_, bytes_read,
+                     Env::Default()->NowMicros() - start_micros);
+    }
     buffer_end_is_past_eof_ = absl::IsOutOfRange(status);
-    buffer_.resize(str_piece.size());
+    buffer_.resize(bytes_read);
     return status;
   }
 
@@ -420,9 +525,14 @@ class BufferedGcsRandomAccessFile : public RandomAccessFile {
   // The implementation of the read operation (provided by the GCSFileSystem).
   const ReadFn read_fn_;
 
+  // Called with the transfer size and duration of every refill.
+  const ThroughputFn throughput_fn_;
+
   // Size of buffer that we read from GCS each time we send a request.
   const uint64 buffer_size_;
 
+  const GcsFileSystem::ReadaheadConfig readahead_;
+
   // Mutex for buffering operations that can be accessed from multiple threads.
   // The following members are mutable in order to provide a const Read.
   mutable mutex buffer_mutex_;
@@ -433,6 +543,9 @@ class BufferedGcsRandomAccessFile : public RandomAccessFile {
   mutable bool buffer_end_is_past_eof_ TF_GUARDED_BY(buffer_mutex_);
 
   mutable string buffer_ TF_GUARDED_BY(buffer_mutex_);
+
+  // The number of blocks fetched by the next refill if it is sequential.
+  mutable size_t readahead_blocks_ TF_GUARDED_BY(buffer_mutex_);
 };
 
 // Function object declaration with params needed to create upload sessions.
@@ -601,6 +714,16 @@ class GcsWritableFile : public WritableFile {
       return errors::Internal(
           "Could not write to the internal temporary file.");
     }
+    const GcsFileSystem::CompositeUploadConfig composite_upload =
+        filesystem_->composite_upload_config();
+    if (composite_upload.threshold > 0 &&
+        (!compose_append_ || start_offset_ == 0)) {
+      uint64 file_size;
+      TF_RETURN_IF_ERROR(GetCurrentFileSize(&file_size));
+      if (file_size >= composite_upload.threshold) {
+        return ComposeFromParts(composite_upload, file_size);
+      }
+    }
     UploadSessionHandle session_handle;
     uint64 start_offset = 0;
     string object_to_upload = object_;
@@ -728,6 +851,98 @@ class GcsWritableFile : public WritableFile {
         retry_config_);
   }
 
+  /// \brief Uploads the whole file as a parallel composite upload.
+  ///
+  /// The file is split into at most kMaxComposeSources parts which are
+  /// uploaded concurrently as temporary objects, composed into the object and
+  /// deleted.
+  Status ComposeFromParts(const GcsFileSystem::CompositeUploadConfig& config,
+                          uint64 file_size) {
+    const uint64 part_size = std::max<uint64>(
+        {config.part_size, (file_size + kMaxComposeSources - 1) /
+                               kMaxComposeSources,
+         1});
+    const size_t num_parts = (file_size + part_size - 1) / part_size;
+    VLOG(3) << "ComposeFromParts: " << GetGcsPath() << " from " << num_parts
+            << " parts";
+    std::vector<string> parts(num_parts);
+    for (size_t i = 0; i < num_parts; ++i) {
+      parts[i] = strings::StrCat(io::Dirname(object_), "/.tmpcompose/",
+                                 io::Basename(object_), ".part", i);
+    }
+    TF_RETURN_IF_ERROR(ParallelFor(
+        num_parts, std::max<size_t>(config.parallelism, 1),
+        [&parts, file_size, part_size, this](size_t i) {
+          const uint64 offset = i * part_size;
+          return UploadPart(parts[i], offset,
+                            std::min(part_size, file_size - offset));
+        }));
+
+    TF_RETURN_IF_ERROR(RetryingUtils::CallWithRetries(
+        [&parts, this]() {
+          std::unique_ptr<HttpRequest> request;
+          TF_RETURN_IF_ERROR(filesystem_->CreateHttpRequest(&request));
+
+          request->SetUri(strings::StrCat(kGcsUriBase, "b/", bucket_, "/o/",
+                                          request->EscapeString(object_),
+                                          "/compose"));
+
+          string request_body = "{'sourceObjects': [";
+          for (size_t i = 0; i < parts.size(); ++i) {
+            strings::StrAppend(&request_body, i > 0 ? "," : "", "{'name': '",
+                               parts[i], "'}");
+          }
+          strings::StrAppend(&request_body, "]}");
+          request->SetTimeouts(timeouts_->connect, timeouts_->idle,
+                               timeouts_->metadata);
+          request->AddHeader("content-type", "application/json");
+          request->SetPostFromBuffer(request_body.c_str(), request_body.size());
+          TF_RETURN_WITH_CONTEXT_IF_ERROR(request->Send(),
+                                          " when composing to ", GetGcsPath());
+          return OkStatus();
+        },
+        retry_config_));
+    // Erase the file from the file cache on every successful write.
+    file_cache_erase_();
+
+    for (const string& part : parts) {
+      const string part_path = GetGcsPathWithObject(part);
+      TF_RETURN_IF_ERROR(RetryingUtils::DeleteWithRetries(
+          [&part_path, this]() {
+            return filesystem_->DeleteFile(part_path, nullptr);
+          },
+          retry_config_));
+    }
+    return GetCurrentFileSize(&start_offset_);
+  }
+
+  /// Uploads `size` bytes of the temporary file at `offset` to `part`.
+  Status UploadPart(const string& part, uint64 offset, uint64 size) {
+    string data(size, '\0');
+    std::ifstream part_file(tmp_content_filename_, std::ifstream::binary);
+    part_file.seekg(offset);
+    part_file.read(&data[0], size);
+    if (!part_file.good()) {
+      return errors::Internal(
+          "Could not read from the internal temporary file.");
+    }
+    return RetryingUtils::CallWithRetries(
+        [&part, &data, this]() {
+          std::unique_ptr<HttpRequest> request;
+          TF_RETURN_IF_ERROR(filesystem_->CreateHttpRequest(&request));
+          request->SetUri(strings::StrCat(kGcsUploadUriBase, "b/", bucket_,
+                                          "/o?uploadType=media&name=",
+                                          request->EscapeString(part)));
+          request->SetTimeouts(timeouts_->connect, timeouts_->idle,
+                               timeouts_->write);
+          request->SetPostFromBuffer(data.data(), data.size());
+          TF_RETURN_WITH_CONTEXT_IF_ERROR(request->Send(), " when uploading ",
+                                          GetGcsPathWithObject(part));
+          return OkStatus();
+        },
+        retry_config_);
+  }
+
   /// \brief Requests status of a previously initiated upload session.
   ///
   /// If the upload has already succeeded, sets 'completed' to true.
@@ -975,6 +1190,27 @@ GcsFileSystem::GcsFileSystem(bool make_default_cache) {
     compose_append_ = false;
   }
 
+  // Apply the overrides for the read-ahead of uncached files and for parallel
+  // composite uploads.
+  readahead_config_.max_blocks = kDefaultReadaheadMaxBlocks;
+  readahead_config_.max_parallel_reads = kDefaultReadParallelism;
+  if (GetEnvVar(kReadaheadMaxBlocks, strings::safe_strtou64, &value)) {
+    readahead_config_.max_blocks = value;
+  }
+  if (GetEnvVar(kReadParallelism, strings::safe_strtou64, &value)) {
+    readahead_config_.max_parallel_reads = value;
+  }
+  composite_upload_config_.parallelism = kDefaultCompositeUploadParallelism;
+  if (GetEnvVar(kCompositeUploadThreshold, strings::safe_strtou64, &value)) {
+    composite_upload_config_.threshold = value * 1024 * 1024;
+  }
+  if (GetEnvVar(kCompositeUploadPartSize, strings::safe_strtou64, &value)) {
+    composite_upload_config_.part_size = value * 1024 * 1024;
+  }
+  if (GetEnvVar(kCompositeUploadParallelism, strings::safe_strtou64, &value)) {
+    composite_upload_config_.parallelism = value;
+  }
+
   retry_config_ = GetGcsRetryConfig();
 }
 
@@ -1044,7 +1280,7 @@ Status GcsFileSystem::NewRandomAccessFile(
     }));
   } else {
     result->reset(new BufferedGcsRandomAccessFile(
-        fname, block_size_,
+        fname, block_size_, readahead_config_,
         [this, bucket, object](const string& fname, uint64 offset, size_t n,
                                StringPiece* result, char* scratch) {
           *result = StringPiece();
@@ -1058,11 +1294,27 @@ Status GcsFileSystem::NewRandomAccessFile(
                                       " bytes requested.");
           }
           return OkStatus();
+        },
+        [this](const string& fname, size_t bytes_transferred,
+               uint64 elapsed_micros) {
+          if (stats_ != nullptr) {
+            stats_->RecordReadThroughput(fname, bytes_transferred,
+                                         elapsed_micros);
+          }
         }));
   }
   return OkStatus();
 }
 
+void GcsFileSystem::SetReadaheadConfig(const ReadaheadConfig& config) {
+  readahead_config_ = config;
+}
+
+void GcsFileSystem::SetCompositeUploadConfig(
+    const CompositeUploadConfig& config) {
+  composite_upload_config_ = config;
+}
+
 void GcsFileSystem::ResetFileBlockCache(size_t block_size_bytes,
                                         size_t max_bytes,
                                         uint64 max_staleness_secs) {
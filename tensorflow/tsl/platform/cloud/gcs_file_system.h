@@ -104,6 +104,13 @@ class GcsStatsInterface {
   // is about to be made.
   virtual void RecordStatObjectRequest() = 0;
 
+  /// RecordReadThroughput is called once a read-ahead refill of `file` has
+  /// transferred `bytes_transferred` bytes in `elapsed_micros` of wall time,
+  /// possibly over several concurrent ranged requests.
+  virtual void RecordReadThroughput(const string& file,
+                                    size_t bytes_transferred,
+                                    uint64 elapsed_micros) {}
+
   /// HttpStats is called to optionally provide a RequestStats listener
   /// to be annotated on every HTTP request made to the GCS API.
   ///
@@ -125,6 +132,8 @@ struct UploadSessionHandle {
 class GcsFileSystem : public FileSystem {
  public:
   struct TimeoutConfig;
+  struct ReadaheadConfig;
+  struct CompositeUploadConfig;
 
   // Main constructor used (via RetryingFileSystem) throughout Tensorflow
   explicit GcsFileSystem(bool make_default_cache = true);
@@ -267,6 +276,54 @@ class GcsFileSystem : public FileSystem {
           write(write) {}
   };
 
+  /// Structure containing the read-ahead configuration of files opened while
+  /// the block cache is disabled.
+  ///
+  /// The defaults fetch exactly one block per request.
+  struct ReadaheadConfig {
+    // The maximum read-ahead of a sequential reader, in blocks. The read-ahead
+    // starts at one block, doubles on every sequential refill up to
+    // `max_blocks`, and drops back to one block on a random access.
+    size_t max_blocks = 1;
+
+    // The maximum number of concurrent ranged requests a refill is split
+    // into.
+    size_t max_parallel_reads = 1;
+
+    // The minimum number of bytes fetched by each of those requests.
+    size_t min_parallel_read_size = 8 * 1024 * 1024;
+  };
+
+  /// Structure containing the configuration of parallel composite uploads.
+  ///
+  /// Files of at least `threshold` bytes are uploaded as separate part
+  /// objects which are then composed into the destination object.
+  struct CompositeUploadConfig {
+    // The minimum file size for a composite upload, in bytes. 0 disables
+    // composite uploads.
+    uint64 threshold = 0;
+
+    // The minimum size of a part. Parts grow beyond it for files that would
+    // otherwise need more parts than a single compose request accepts.
+    uint64 part_size = 32 * 1024 * 1024;
+
+    // The number of parts uploaded concurrently. Each of them is buffered in
+    // memory while it is being uploaded.
+    size_t parallelism = 1;
+  };
+
+  ReadaheadConfig readahead_config() const { return readahead_config_; }
+  CompositeUploadConfig composite_upload_config() const {
+    return composite_upload_config_;
+  }
+
+  /// \brief Sets the read-ahead of subsequently opened uncached files.
+  void SetReadaheadConfig(const ReadaheadConfig& config);
+
+  /// \brief Sets the parallel composite upload configuration of subsequent
+  /// writes.
+  void SetCompositeUploadConfig(const CompositeUploadConfig& config);
+
   Status CreateHttpRequest(std::unique_ptr<HttpRequest>* request);
 
   /// \brief Sets a new AuthProvider on the GCS FileSystem.
@@ -436,6 +493,9 @@ class GcsFileSystem : public FileSystem {
   std::unordered_set<string> allowed_locations_;
   bool compose_append_;
 
+  ReadaheadConfig readahead_config_;
+  CompositeUploadConfig composite_upload_config_;
+
   GcsStatsInterface* stats_ = nullptr;  // Not owned.
 
   // Additional header material to be transmitted with all GCS requests
@@ -15,11 +15,13 @@ limitations under the License.
 
 #include "tensorflow/tsl/platform/cloud/gcs_file_system.h"
 
+#include <algorithm>
 #include <fstream>
 
 #include "tensorflow/tsl/lib/core/status_test_util.h"
 #include "tensorflow/tsl/platform/cloud/http_request_fake.h"
 #include "tensorflow/tsl/platform/errors.h"
+#include "tensorflow/tsl/platform/mutex.h"
 #include "tensorflow/tsl/platform/str_util.h"
 #include "tensorflow/tsl/platform/strcat.h"
 #include "tensorflow/tsl/platform/test.h"
@@ -59,6 +61,66 @@ class FakeZoneProvider : public ZoneProvider {
   }
 };
 
+// Serves ranged reads of a single object regardless of the order in which the
+// requests are created, for readers that issue them concurrently.
+class FakeObjectRangeRequest : public FakeHttpRequest {
+ public:
+  FakeObjectRangeRequest(const string& object, mutex* mu,
+                         std::vector<string>* ranges)
+      : FakeHttpRequest("", ""), object_(object), mu_(mu), ranges_(ranges) {}
+
+  void SetRange(uint64 start, uint64 end) override {
+    start_ = start;
+    end_ = end;
+  }
+  void SetResultBufferDirect(char* buffer, size_t size) override {
+    buffer_ = buffer;
+  }
+  size_t GetResultBufferDirectBytesTransferred() override {
+    return bytes_transferred_;
+  }
+  Status Send() override {
+    if (start_ < object_.size()) {
+      bytes_transferred_ =
+          std::min<size_t>(end_ + 1, object_.size()) - start_;
+      memcpy(buffer_, object_.data() + start_, bytes_transferred_);
+    }
+    mutex_lock l(*mu_);
+    ranges_->push_back(strings::StrCat(start_, "-", end_));
+    return OkStatus();
+  }
+
+ private:
+  const string object_;
+  mutex* const mu_;
+  std::vector<string>* const ranges_;
+  uint64 start_ = 0;
+  uint64 end_ = 0;
+  char* buffer_ = nullptr;
+  size_t bytes_transferred_ = 0;
+};
+
+class FakeObjectRangeRequestFactory : public HttpRequest::Factory {
+ public:
+  explicit FakeObjectRangeRequestFactory(const string& object)
+      : object_(object) {}
+
+  HttpRequest* Create() override {
+    return new FakeObjectRangeRequest(object_, &mu_, &ranges_);
+  }
+
+  // Returns the requested ranges in the order in which they were sent.
+  std::vector<string> ranges() {
+    mutex_lock l(mu_);
+    return ranges_;
+  }
+
+ private:
+  const string object_;
+  mutex mu_;
+  std::vector<string> ranges_ TF_GUARDED_BY(mu_);
+};
+
 TEST(GcsFileSystemTest, NewRandomAccessFile_NoBlockCache) {
   std::vector<HttpRequest*> requests(
       {new FakeHttpRequest(
@@ -430,6 +492,113 @@ TEST(GcsFileSystemTest, NewRandomAccessFile_Buffered_ReadBackwards) {
   EXPECT_EQ("0123456789", result);
 }
 
+TEST(GcsFileSystemTest, NewRandomAccessFile_Buffered_AdaptiveReadahead) {
+  const string contents = "0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLM";
+  std::vector<HttpRequest*> requests(
+      {new FakeHttpRequest(
+           "Uri: https://storage.googleapis.com/bucket/random_access.txt\n"
+           "Auth Token: fake_token\n"
+           "Range: 0-9\n"
+           "Timeouts: 5 1 20\n",
+           contents.substr(0, 10)),
+       new FakeHttpRequest(
+           "Uri: https://storage.googleapis.com/bucket/random_access.txt\n"
+           "Auth Token: fake_token\n"
+           "Range: 10-29\n"
+           "Timeouts: 5 1 20\n",
+           contents.substr(10, 20)),
+       new FakeHttpRequest(
+           "Uri: https://storage.googleapis.com/bucket/random_access.txt\n"
+           "Auth Token: fake_token\n"
+           "Range: 30-69\n"
+           "Timeouts: 5 1 20\n",
+           contents.substr(30)),
+       new FakeHttpRequest(
+           "Uri: https://storage.googleapis.com/bucket/random_access.txt\n"
+           "Auth Token: fake_token\n"
+           "Range: 5-14\n"
+           "Timeouts: 5 1 20\n",
+           contents.substr(5, 10))});
+  GcsFileSystem fs(
+      std::unique_ptr<AuthProvider>(new FakeAuthProvider),
+      std::unique_ptr<HttpRequest::Factory>(
+          new FakeHttpRequestFactory(&requests)),
+      std::unique_ptr<ZoneProvider>(new FakeZoneProvider), 10 /* block size */,
+      0 /* max bytes */, 0 /* max staleness */, 0 /* stat cache max age */,
+      0 /* stat cache max entries */, 0 /* matching paths cache max age */,
+      0 /* matching paths cache max entries */, kTestRetryConfig,
+      kTestTimeoutConfig, *kAllowedLocationsDefault,
+      nullptr /* gcs additional header */, false /* compose append */);
+  GcsFileSystem::ReadaheadConfig readahead;
+  readahead.max_blocks = 4;
+  fs.SetReadaheadConfig(readahead);
+
+  std::unique_ptr<RandomAccessFile> file;
+  TF_EXPECT_OK(
+      fs.NewRandomAccessFile("gs://bucket/random_access.txt", nullptr, &file));
+
+  char scratch[10];
+  StringPiece result;
+
+  // Every sequential refill doubles the read-ahead until it reaches the end of
+  // the file.
+  for (int offset = 0; offset < 40; offset += sizeof(scratch)) {
+    TF_EXPECT_OK(file->Read(offset, sizeof(scratch), &result, scratch));
+    EXPECT_EQ(contents.substr(offset, sizeof(scratch)), result);
+  }
+  EXPECT_TRUE(
+      errors::IsOutOfRange(file->Read(40, sizeof(scratch), &result, scratch)));
+  EXPECT_EQ(contents.substr(40), result);
+
+  // A random access drops the read-ahead back to a single block.
+  TF_EXPECT_OK(file->Read(5, sizeof(scratch), &result, scratch));
+  EXPECT_EQ(contents.substr(5, sizeof(scratch)), result);
+}
+
+TEST(GcsFileSystemTest, NewRandomAccessFile_Buffered_ParallelReads) {
+  const string contents = "0123456789abcdefghijklmnopq";
+  auto* factory = new FakeObjectRangeRequestFactory(contents);
+  GcsFileSystem fs(
+      std::unique_ptr<AuthProvider>(new FakeAuthProvider),
+      std::unique_ptr<HttpRequest::Factory>(factory),
+      std::unique_ptr<ZoneProvider>(new FakeZoneProvider), 10 /* block size */,
+      0 /* max bytes */, 0 /* max staleness */, 0 /* stat cache max age */,
+      0 /* stat cache max entries */, 0 /* matching paths cache max age */,
+      0 /* matching paths cache max entries */, kTestRetryConfig,
+      kTestTimeoutConfig, *kAllowedLocationsDefault,
+      nullptr /* gcs additional header */, false /* compose append */);
+  GcsFileSystem::ReadaheadConfig readahead;
+  readahead.max_blocks = 2;
+  readahead.max_parallel_reads = 4;
+  readahead.min_parallel_read_size = 3;
+  fs.SetReadaheadConfig(readahead);
+
+  std::unique_ptr<RandomAccessFile> file;
+  TF_EXPECT_OK(
+      fs.NewRandomAccessFile("gs://bucket/random_access.txt", nullptr, &file));
+
+  char scratch[10];
+  StringPiece result;
+
+  // The first refill of one block is split into three reads of at least three
+  // bytes, the second one of two blocks into four reads, the last of which
+  // reaches past the end of the file.
+  TF_EXPECT_OK(file->Read(0, sizeof(scratch), &result, scratch));
+  EXPECT_EQ(contents.substr(0, 10), result);
+  TF_EXPECT_OK(file->Read(10, sizeof(scratch), &result, scratch));
+  EXPECT_EQ(contents.substr(10, 10), result);
+  EXPECT_TRUE(
+      errors::IsOutOfRange(file->Read(20, sizeof(scratch), &result, scratch)));
+  EXPECT_EQ(contents.substr(20), result);
+
+  std::vector<string> ranges = factory->ranges();
+  std::sort(ranges.begin(), ranges.begin() + 3);
+  std::sort(ranges.begin() + 3, ranges.end());
+  EXPECT_EQ(std::vector<string>({"0-3", "4-7", "8-9", "10-14", "15-19",
+                                 "20-24", "25-29"}),
+            ranges);
+}
+
 TEST(GcsFileSystemTest,
      NewRandomAccessFile_WithLocationConstraintInSameLocation) {
   std::vector<HttpRequest*> requests({new FakeHttpRequest(
@@ -995,6 +1164,87 @@ TEST(GcsFileSystemTest, NewWritableFile) {
   TF_EXPECT_OK(wfile->Close());
 }
 
+TEST(GcsFileSystemTest, NewWritableFile_CompositeUpload) {
+  std::vector<HttpRequest*> requests(
+      {// Upload the parts to temporary objects.
+       new FakeHttpRequest(
+           "Uri: https://www.googleapis.com/upload/storage/v1/b/bucket/o?"
+           "uploadType=media&name=path%2F.tmpcompose%2Fwriteable.part0\n"
+           "Auth Token: fake_token\n"
+           "Timeouts: 5 1 30\n"
+           "Post body: content1\n",
+           ""),
+       new FakeHttpRequest(
+           "Uri: https://www.googleapis.com/upload/storage/v1/b/bucket/o?"
+           "uploadType=media&name=path%2F.tmpcompose%2Fwriteable.part1\n"
+           "Auth Token: fake_token\n"
+           "Timeouts: 5 1 30\n"
+           "Post body: ,content\n",
+           ""),
+       new FakeHttpRequest(
+           "Uri: https://www.googleapis.com/upload/storage/v1/b/bucket/o?"
+           "uploadType=media&name=path%2F.tmpcompose%2Fwriteable.part2\n"
+           "Auth Token: fake_token\n"
+           "Timeouts: 5 1 30\n"
+           "Post body: 2\n",
+           ""),
+       // Compose the parts into the object.
+       new FakeHttpRequest("Uri: "
+                           "https://www.googleapis.com/storage/v1/b/bucket/o/"
+                           "path%2Fwriteable/compose\n"
+                           "Auth Token: fake_token\n"
+                           "Timeouts: 5 1 10\n"
+                           "Header content-type: application/json\n"
+                           "Post body: {'sourceObjects': [{'name': "
+                           "'path/.tmpcompose/writeable.part0'},{'name': "
+                           "'path/.tmpcompose/writeable.part1'},{'name': "
+                           "'path/.tmpcompose/writeable.part2'}]}\n",
+                           ""),
+       // Delete the temporary objects.
+       new FakeHttpRequest("Uri: "
+                           "https://www.googleapis.com/storage/v1/b/bucket/o/"
+                           "path%2F.tmpcompose%2Fwriteable.part0\n"
+                           "Auth Token: fake_token\n"
+                           "Timeouts: 5 1 10\n"
+                           "Delete: yes\n",
+                           ""),
+       new FakeHttpRequest("Uri: "
+                           "https://www.googleapis.com/storage/v1/b/bucket/o/"
+                           "path%2F.tmpcompose%2Fwriteable.part1\n"
+                           "Auth Token: fake_token\n"
+                           "Timeouts: 5 1 10\n"
+                           "Delete: yes\n",
+                           ""),
+       new FakeHttpRequest("Uri: "
+                           "https://www.googleapis.com/storage/v1/b/bucket/o/"
+                           "path%2F.tmpcompose%2Fwriteable.part2\n"
+                           "Auth Token: fake_token\n"
+                           "Timeouts: 5 1 10\n"
+                           "Delete: yes\n",
+                           "")});
+  GcsFileSystem fs(
+      std::unique_ptr<AuthProvider>(new FakeAuthProvider),
+      std::unique_ptr<HttpRequest::Factory>(
+          new FakeHttpRequestFactory(&requests)),
+      std::unique_ptr<ZoneProvider>(new FakeZoneProvider), 8 /* block size */,
+      0 /* max bytes */, 0 /* max staleness */, 0 /* stat cache max age */,
+      0 /* stat cache max entries */, 0 /* matching paths cache max age */,
+      0 /* matching paths cache max entries */, kTestRetryConfig,
+      kTestTimeoutConfig, *kAllowedLocationsDefault,
+      nullptr /* gcs additional header */, false /* compose append */);
+  GcsFileSystem::CompositeUploadConfig composite_upload;
+  composite_upload.threshold = 10;
+  composite_upload.part_size = 8;
+  fs.SetCompositeUploadConfig(composite_upload);
+
+  std::unique_ptr<WritableFile> wfile;
+  TF_EXPECT_OK(
+      fs.NewWritableFile("gs://bucket/path/writeable", nullptr, &wfile));
+  TF_EXPECT_OK(wfile->Append("content1,"));
+  TF_EXPECT_OK(wfile->Append("content2"));
+  TF_EXPECT_OK(wfile->Close());
+}
+
 TEST(GcsFileSystemTest, NewWritableFile_ResumeUploadSucceeds) {
   std::vector<HttpRequest*> requests(
       {new FakeHttpRequest(
@@ -3681,6 +3931,19 @@ TEST(GcsFileSystemTest, OverrideCacheParameters) {
   EXPECT_EQ(20, fs5.timeouts().metadata);
   EXPECT_EQ(30, fs5.timeouts().read);
   EXPECT_EQ(40, fs5.timeouts().write);
+
+  // Verify read-ahead and composite upload overrides.
+  setenv("GCS_READAHEAD_MAX_BLOCKS", "8", 1);
+  setenv("GCS_READ_PARALLELISM", "16", 1);
+  setenv("GCS_COMPOSITE_UPLOAD_THRESHOLD_MB", "256", 1);
+  setenv("GCS_COMPOSITE_UPLOAD_PART_SIZE_MB", "64", 1);
+  setenv("GCS_COMPOSITE_UPLOAD_PARALLELISM", "4", 1);
+  GcsFileSystem fs6;
+  EXPECT_EQ(8, fs6.readahead_config().max_blocks);
+  EXPECT_EQ(16, fs6.readahead_config().max_parallel_reads);
+  EXPECT_EQ(256 * 1024 * 1024, fs6.composite_upload_config().threshold);
+  EXPECT_EQ(64 * 1024 * 1024, fs6.composite_upload_config().part_size);
+  EXPECT_EQ(4, fs6.composite_upload_config().parallelism);
 }
 
 TEST(GcsFileSystemTest, CreateHttpRequest) {
@@ -3733,6 +3996,12 @@ class TestGcsStats : public GcsStatsInterface {
 
   void RecordStatObjectRequest() override { stat_object_request_count_++; }
 
+  void RecordReadThroughput(const string& file, size_t bytes_transferred,
+                            uint64 elapsed_micros) override {
+    read_throughput_file_ = file;
+    read_throughput_bytes_transferred_ += bytes_transferred;
+  }
+
   HttpRequest::RequestStats* HttpStats() override { return nullptr; }
 
   GcsFileSystem* fs_ = nullptr;
@@ -3743,6 +4012,8 @@ class TestGcsStats : public GcsStatsInterface {
   string block_retrieved_file_;
   size_t block_retrieved_bytes_transferred_ = 0;
   int stat_object_request_count_ = 0;
+  string read_throughput_file_;
+  size_t read_throughput_bytes_transferred_ = 0;
 };
 
 TEST(GcsFileSystemTest, Stat_StatsRecording) {
@@ -3810,6 +4081,49 @@ TEST(GcsFileSystemTest, NewRandomAccessFile_StatsRecording) {
   EXPECT_EQ(6, stats.block_retrieved_bytes_transferred_);
 }
 
+TEST(GcsFileSystemTest, NewRandomAccessFile_Buffered_ThroughputStatsRecording) {
+  std::vector<HttpRequest*> requests(
+      {new FakeHttpRequest(
+           "Uri: https://storage.googleapis.com/bucket/random_access.txt\n"
+           "Auth Token: fake_token\n"
+           "Range: 0-9\n"
+           "Timeouts: 5 1 20\n",
+           "0123456789"),
+       new FakeHttpRequest(
+           "Uri: https://storage.googleapis.com/bucket/random_access.txt\n"
+           "Auth Token: fake_token\n"
+           "Range: 10-19\n"
+           "Timeouts: 5 1 20\n",
+           "abc")});
+  GcsFileSystem fs(
+      std::unique_ptr<AuthProvider>(new FakeAuthProvider),
+      std::unique_ptr<HttpRequest::Factory>(
+          new FakeHttpRequestFactory(&requests)),
+      std::unique_ptr<ZoneProvider>(new FakeZoneProvider), 10 /* block size */,
+      0 /* max bytes */, 0 /* max staleness */, 0 /* stat cache max age */,
+      0 /* stat cache max entries */, 0 /* matching paths cache max age */,
+      0 /* matching paths cache max entries */, kTestRetryConfig,
+      kTestTimeoutConfig, *kAllowedLocationsDefault,
+      nullptr /* gcs additional header */, false /* compose append */);
+
+  TestGcsStats stats;
+  fs.SetStats(&stats);
+
+  std::unique_ptr<RandomAccessFile> file;
+  TF_EXPECT_OK(
+      fs.NewRandomAccessFile("gs://bucket/random_access.txt", nullptr, &file));
+
+  char scratch[10];
+  StringPiece result;
+  TF_EXPECT_OK(file->Read(0, sizeof(scratch), &result, scratch));
+  EXPECT_TRUE(
+      errors::IsOutOfRange(file->Read(10, sizeof(scratch), &result, scratch)));
+  EXPECT_EQ("abc", result);
+
+  EXPECT_EQ("gs://bucket/random_access.txt", stats.read_throughput_file_);
+  EXPECT_EQ(13, stats.read_throughput_bytes_transferred_);
+}
+
 TEST(GcsFileSystemTest, NewAppendableFile_MultipleFlushesWithCompose) {
   std::vector<string> contents(
       {"content0,", "content1,", "content2,", "content3,"});
@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_TSL_PLATFORM_CPU_INFO_H_
 
 #include <string>
+#include <vector>
 
 // TODO(ahentz): This is not strictly required here but, for historical
 // reasons, many people depend on cpu_info.h in order to use kLittleEndian.
@@ -68,6 +69,12 @@ int GetCurrentCPU();
 // on the CPU
 int NumHyperthreadsPerCore();
 
+// Restricts the current thread to run on the CPUs with the given ids, which
+// are in [0, NumTotalCPUs()). Returns false if thread affinity is not
+// supported on this platform or could not be set, e.g. because none of the
+// CPUs is available to this process.
+bool SetCurrentThreadCpuAffinity(const std::vector<int>& cpus);
+
 // Mostly ISA related features that we care about
 enum CPUFeature {
   // Do not change numeric assignments.
@@ -37,6 +37,8 @@ limitations under the License.
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+
+#include <algorithm>
 #ifdef TF_USE_SNAPPY
 #include "snappy.h"
 #endif
@@ -167,6 +169,25 @@ int NumHyperthreadsPerCore() {
   return (ht_per_core > 0) ? ht_per_core : 1;
 }
 
+bool SetCurrentThreadCpuAffinity(const std::vector<int>& cpus) {
+#if defined(__linux__)
+  if (cpus.empty()) return false;
+  const int ncpus = *std::max_element(cpus.begin(), cpus.end()) + 1;
+  size_t setsize = CPU_ALLOC_SIZE(ncpus);
+  cpu_set_t* mask = CPU_ALLOC(ncpus);
+  if (!mask) return false;
+  CPU_ZERO_S(setsize, mask);
+  for (int cpu : cpus) {
+    if (cpu >= 0) CPU_SET_S(cpu, setsize, mask);
+  }
+  const bool ok = sched_setaffinity(0, setsize, mask) == 0;
+  CPU_FREE(mask);
+  return ok;
+#else
+  return false;
+#endif
+}
+
 #ifdef TENSORFLOW_USE_NUMA
 namespace {
 static hwloc_topology_t hwloc_topology_handle;
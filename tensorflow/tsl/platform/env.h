@@ -598,6 +598,12 @@ struct ThreadOptions {
   /// Guard area size to use near thread stacks to use (in bytes)
   size_t guard_size = 0;  // 0: use system default value
   int numa_node = port::kNUMANoAffinity;
+  /// CPUs the threads of a thread::ThreadPool may run on. Pools that are given
+  /// disjoint sets never compete for a core. Empty: no restriction.
+  std::vector<int> cpu_set;
+  /// If true, the i-th thread of a thread::ThreadPool is pinned to
+  /// cpu_set[i % cpu_set.size()] instead of floating over the whole set.
+  bool pin_threads_to_cpus = false;
 };
 
 /// A utility routine: copy contents of `src` in file system `src_fs`
@@ -17,10 +17,16 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <vector>
+
 #include "absl/types/optional.h"
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/tsl/platform/blocking_counter.h"
 #include "tensorflow/tsl/platform/context.h"
+#include "tensorflow/tsl/platform/cpu_info.h"
 #include "tensorflow/tsl/platform/denormal.h"
 #include "tensorflow/tsl/platform/logging.h"
 #include "tensorflow/tsl/platform/mutex.h"
@@ -40,6 +46,13 @@ namespace tsl {
 
 namespace thread {
 
+// Counters behind ThreadPool::GetStats().
+struct ThreadPoolCounters {
+  std::atomic<int64_t> queued{0};
+  std::atomic<int64_t> started{0};
+  std::atomic<int64_t> steals{0};
+};
+
 struct EigenEnvironment {
   typedef Thread EnvThread;
   struct TaskImpl {
@@ -54,12 +67,20 @@ struct EigenEnvironment {
   Env* const env_;
   const ThreadOptions thread_options_;
   const string name_;
+  const std::shared_ptr<ThreadPoolCounters> counters_;
+  // Index of the next thread created, used to pin threads to CPUs.
+  int next_thread_index_ = 0;
 
   EigenEnvironment(Env* env, const ThreadOptions& thread_options,
-                   const string& name)
-      : env_(env), thread_options_(thread_options), name_(name) {}
+                   const string& name,
+                   std::shared_ptr<ThreadPoolCounters> counters = nullptr)
+      : env_(env),
+        thread_options_(thread_options),
+        name_(name),
+        counters_(std::move(counters)) {}
 
   EnvThread* CreateThread(std::function<void()> f) {
+    const int thread_index = next_thread_index_++;
     return env_->StartThread(thread_options_, name_, [=]() {
       // Set the processor flag to flush denormals to zero.
       port::ScopedFlushDenormal flush;
@@ -68,11 +89,26 @@ struct EigenEnvironment {
       if (thread_options_.numa_node != port::kNUMANoAffinity) {
         port::NUMASetThreadNodeAffinity(thread_options_.numa_node);
       }
+      const std::vector<int>& cpu_set = thread_options_.cpu_set;
+      if (!cpu_set.empty()) {
+        const bool ok =
+            thread_options_.pin_threads_to_cpus
+                ? port::SetCurrentThreadCpuAffinity(
+                      {cpu_set[thread_index % cpu_set.size()]})
+                : port::SetCurrentThreadCpuAffinity(cpu_set);
+        if (!ok) {
+          LOG_FIRST_N(WARNING, 1)
+              << "Could not set the CPU affinity of thread pool " << name_;
+        }
+      }
       f();
     });
   }
 
   Task CreateTask(std::function<void()> f) {
+    if (counters_ != nullptr) {
+      counters_->queued.fetch_add(1, std::memory_order_relaxed);
+    }
     uint64 id = 0;
     if (tracing::EventCollector::IsEnabled()) {
       id = tracing::GetUniqueArg();
@@ -88,6 +124,10 @@ struct EigenEnvironment {
   }
 
   void ExecuteTask(const Task& t) {
+    if (counters_ != nullptr) {
+      counters_->queued.fetch_sub(1, std::memory_order_relaxed);
+      counters_->started.fetch_add(1, std::memory_order_relaxed);
+    }
     WithContext wc(t.f->context);
     tracing::ScopedRegion region(tracing::EventCategory::kRunClosure,
                                  t.f->trace_id);
@@ -113,15 +153,17 @@ ThreadPool::ThreadPool(Env* env, const ThreadOptions& thread_options,
   if (num_threads < 1) num_threads = 1;
 #endif  // TENSORFLOW_THREADSCALING_EXPERIMENTAL
 
+  counters_ = std::make_shared<ThreadPoolCounters>();
   eigen_threadpool_.reset(new Eigen::ThreadPoolTempl<EigenEnvironment>(
       num_threads, low_latency_hint,
-      EigenEnvironment(env, thread_options, "tf_" + name)));
+      EigenEnvironment(env, thread_options, "tf_" + name, counters_)));
   underlying_threadpool_ = eigen_threadpool_.get();
   threadpool_device_.reset(new Eigen::ThreadPoolDevice(underlying_threadpool_,
                                                        num_threads, allocator));
 }
 
 ThreadPool::ThreadPool(thread::ThreadPoolInterface* user_threadpool) {
+  counters_ = std::make_shared<ThreadPoolCounters>();
   underlying_threadpool_ = user_threadpool;
   threadpool_device_.reset(new Eigen::ThreadPoolDevice(
       underlying_threadpool_, underlying_threadpool_->NumThreads(), nullptr));
@@ -165,6 +207,11 @@ void ThreadPool::ParallelFor(int64_t total,
       }
       break;
     }
+    case SchedulingStrategy::kWorkStealing: {
+      ParallelForWorkStealing(total, scheduling_params.block_size().value_or(1),
+                              fn);
+      break;
+    }
   }
 }
 
@@ -216,6 +263,124 @@ void ThreadPool::ParallelForFixedBlockSizeScheduling(
   counter.Wait();
 }
 
+namespace {
+
+// A range of units of a work stealing ParallelFor. Its owner takes chunks from
+// the front, while thieves split off the back.
+struct StealableRange {
+  mutex mu;
+  int64_t begin TF_GUARDED_BY(mu) = 0;
+  int64_t end TF_GUARDED_BY(mu) = 0;
+};
+
+// The state of a work stealing ParallelFor. It is shared with the scheduled
+// workers, which may only start after the call has returned if the pool is
+// busy. Those find no work left and never touch the caller's function.
+struct WorkStealingState {
+  explicit WorkStealingState(int num_workers)
+      : num_workers(num_workers), ranges(new StealableRange[num_workers]) {}
+
+  const int num_workers;
+  std::unique_ptr<StealableRange[]> ranges;
+  mutex mu;
+  condition_variable done;
+  int64_t remaining TF_GUARDED_BY(mu) = 0;
+};
+
+}  // namespace
+
+void ThreadPool::ParallelForWorkStealing(
+    const int64_t total, const int64_t min_block_size,
+    const std::function<void(int64_t, int64_t)>& fn) {
+  CHECK_GE(total, 0);
+  const int64_t min_block = std::max<int64_t>(min_block_size, 1);
+  const int num_workers = static_cast<int>(std::min<int64_t>(
+      NumThreads() + 1, (total + min_block - 1) / min_block));
+  if (num_workers <= 1) {
+    if (total > 0) fn(0, total);
+    return;
+  }
+
+  auto state = std::make_shared<WorkStealingState>(num_workers);
+  {
+    mutex_lock l(state->mu);
+    state->remaining = total;
+  }
+  for (int i = 0; i < num_workers; ++i) {
+    StealableRange& range = state->ranges[i];
+    mutex_lock l(range.mu);
+    range.begin = total * i / num_workers;
+    range.end = total * (i + 1) / num_workers;
+  }
+
+  auto worker = [state, min_block, &fn, counters = counters_](int self) {
+    StealableRange& own = state->ranges[self];
+    while (true) {
+      int64_t first = 0;
+      int64_t last = 0;
+      {
+        mutex_lock l(own.mu);
+        if (own.begin < own.end) {
+          // Take a quarter of what is left, so that chunks get smaller as the
+          // range drains and the tail remains available to thieves.
+          first = own.begin;
+          last = std::min(own.end,
+                          first + std::max(min_block, (own.end - first) / 4));
+          own.begin = last;
+        }
+      }
+      if (first < last) {
+        fn(first, last);
+        mutex_lock l(state->mu);
+        state->remaining -= last - first;
+        if (state->remaining == 0) state->done.notify_all();
+        continue;
+      }
+
+      // Steal the back half of the largest range left, or all of it if it is
+      // too small to split. Ranges whose owner has not started yet are taken
+      // over completely, so the caller alone can always finish the loop.
+      int victim = -1;
+      int64_t victim_size = 0;
+      for (int i = 0; i < state->num_workers; ++i) {
+        if (i == self) continue;
+        StealableRange& range = state->ranges[i];
+        mutex_lock l(range.mu);
+        if (range.end - range.begin > victim_size) {
+          victim = i;
+          victim_size = range.end - range.begin;
+        }
+      }
+      if (victim < 0) return;
+      int64_t stolen_begin;
+      int64_t stolen_end;
+      {
+        StealableRange& range = state->ranges[victim];
+        mutex_lock l(range.mu);
+        const int64_t size = range.end - range.begin;
+        if (size <= 0) continue;
+        stolen_end = range.end;
+        stolen_begin =
+            size >= 2 * min_block ? range.begin + size / 2 : range.begin;
+        range.end = stolen_begin;
+      }
+      counters->steals.fetch_add(1, std::memory_order_relaxed);
+      mutex_lock l(own.mu);
+      own.begin = stolen_begin;
+      own.end = stolen_end;
+    }
+  };
+
+  for (int i = 1; i < num_workers; ++i) {
+    Schedule([worker, i]() { worker(i); });
+  }
+  worker(0);
+  mutex_lock l(state->mu);
+  while (state->remaining > 0) {
+    state->done.wait(l);
+  }
+}
+
 void ThreadPool::ParallelFor(int64_t total, int64_t cost_per_unit,
                              const std::function<void(int64_t, int64_t)>& fn) {
   CHECK_GE(total, 0);
@@ -265,6 +430,14 @@ int ThreadPool::CurrentThreadId() const {
   return underlying_threadpool_->CurrentThreadId();
 }
 
+ThreadPool::Stats ThreadPool::GetStats() const {
+  Stats stats;
+  stats.queue_depth = counters_->queued.load(std::memory_order_relaxed);
+  stats.tasks_started = counters_->started.load(std::memory_order_relaxed);
+  stats.steals = counters_->steals.load(std::memory_order_relaxed);
+  return stats;
+}
+
 void ThreadPool::ScheduleWithHint(std::function<void()> fn, int start,
                                   int limit) {
   underlying_threadpool_->ScheduleWithHint(std::move(fn), start, limit);
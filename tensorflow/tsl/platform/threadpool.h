@@ -38,6 +38,7 @@ namespace tsl {
 namespace thread {
 
 struct EigenEnvironment;
+struct ThreadPoolCounters;
 
 class ThreadPool {
  public:
@@ -66,7 +67,17 @@ class ThreadPool {
     // on the number of threads available in the pool. Note that when there
     // aren't enough threads in the pool to achieve full parallelism, function
     // calls will be automatically queued.
-    kFixedBlockSize
+    kFixedBlockSize,
+    // The Work Stealing scheduling strategy ignores cost estimates and
+    // balances the work by the actual idle capacity of the pool. The units of
+    // work are split evenly among the caller and the pool threads, each of
+    // which processes its range in chunks that shrink as the range drains.
+    // Threads that run out of work steal half of the largest remaining range
+    // of another thread.
+    //
+    // The optional 'block_size' is the minimum number of units passed to a
+    // single call of the function, 1 by default.
+    kWorkStealing
   };
 
   // Contains additional parameters for either the Adaptive or the Fixed Block
@@ -95,17 +106,29 @@ class ThreadPool {
     absl::optional<int64_t> cost_per_unit_;
 
     // The block size of each shard. Only applicable for Fixed Block Size
-    // scheduling strategy.
+    // scheduling strategy, and the minimum shard size for Work Stealing.
     absl::optional<int64_t> block_size_;
   };
 
+  // Load metrics of a pool, see GetStats().
+  struct Stats {
+    // Number of closures scheduled on the pool that have not started yet.
+    int64_t queue_depth = 0;
+    // Number of closures that have started running.
+    int64_t tasks_started = 0;
+    // Number of ranges that threads took over from other threads in work
+    // stealing ParallelFor calls.
+    int64_t steals = 0;
+  };
+
   // Constructs a pool that contains "num_threads" threads with specified
   // "name". env->StartThread() is used to create individual threads with the
-  // given ThreadOptions. If "low_latency_hint" is true the thread pool
-  // implementation may use it as a hint that lower latency is preferred at the
-  // cost of higher CPU usage, e.g. by letting one or more idle threads spin
-  // wait. Conversely, if the threadpool is used to schedule high-latency
-  // operations like I/O the hint should be set to false.
+  // given ThreadOptions, whose numa_node, cpu_set and pin_threads_to_cpus
+  // fields also set the CPU affinity of the threads. If "low_latency_hint" is
+  // true the thread pool implementation may use it as a hint that lower
+  // latency is preferred at the cost of higher CPU usage, e.g. by letting one
+  // or more idle threads spin wait. Conversely, if the threadpool is used to
+  // schedule high-latency operations like I/O the hint should be set to false.
   //
   // REQUIRES: num_threads > 0
   ThreadPool(Env* env, const ThreadOptions& thread_options,
@@ -211,6 +234,11 @@ class ThreadPool {
   // thread in the pool. Returns -1 otherwise.
   int CurrentThreadId() const;
 
+  // Returns the current load metrics of the pool. The queue depth and the
+  // number of started closures are only tracked by pools that own their
+  // threads, and are 0 for pools wrapping a user provided threadpool.
+  Stats GetStats() const;
+
   // If ThreadPool implementation is compatible with Eigen::ThreadPoolInterface,
   // returns a non-null pointer. The caller does not own the object the returned
   // pointer points to, and should not attempt to delete.
@@ -228,6 +256,12 @@ class ThreadPool {
       const int64_t total, const int64_t block_size,
       const std::function<void(int64_t, int64_t)>& fn);
 
+  // Runs fn over [0, total) as described for the Work Stealing scheduling
+  // strategy, in shards of at least min_block_size units.
+  void ParallelForWorkStealing(
+      const int64_t total, const int64_t min_block_size,
+      const std::function<void(int64_t, int64_t)>& fn);
+
   // underlying_threadpool_ is the user_threadpool if user_threadpool is
   // provided in the constructor. Otherwise it is the eigen_threadpool_.
   Eigen::ThreadPoolInterface* underlying_threadpool_;
@@ -235,6 +269,9 @@ class ThreadPool {
   // user_threadpool is not in the constructor.
   std::unique_ptr<Eigen::ThreadPoolTempl<EigenEnvironment>> eigen_threadpool_;
   std::unique_ptr<Eigen::ThreadPoolDevice> threadpool_device_;
+  // Shared with the EigenEnvironment of eigen_threadpool_, which updates the
+  // queue metrics.
+  std::shared_ptr<ThreadPoolCounters> counters_;
   TF_DISALLOW_COPY_AND_ASSIGN(ThreadPool);
 };
 
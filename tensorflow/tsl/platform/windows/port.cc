@@ -198,6 +198,18 @@ int NumHyperthreadsPerCore() {
   return (ht_per_core > 0) ? ht_per_core : 1;
 }
 
+bool SetCurrentThreadCpuAffinity(const std::vector<int>& cpus) {
+  // Only CPUs of the current processor group can be addressed.
+  DWORD_PTR mask = 0;
+  for (int cpu : cpus) {
+    if (cpu < 0 || cpu >= static_cast<int>(sizeof(DWORD_PTR) * 8)) {
+      return false;
+    }
+    mask |= DWORD_PTR{1} << cpu;
+  }
+  return mask != 0 && SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
+}
+
 }  // namespace port
 }  // namespace tsl
 
@@ -35,6 +35,7 @@ namespace profiler {
 namespace internal {
 
 std::atomic<int> g_trace_level(TraceMeRecorder::kTracingDisabled);
+std::atomic<int> g_sampling_period(1);
 
 // g_trace_level implementation must be lock-free for faster execution of the
 // TraceMe API. This can be commented (if compilation is failing) but execution
@@ -92,6 +93,29 @@ class SplitEventTracker {
   std::vector<TraceMeRecorder::Event*> end_events_;
 };
 
+// Appends a consumed event to `result`, or to `split_event_tracker` if it is
+// the start of a split event.
+void AddConsumedEvent(TraceMeRecorder::Event&& event,
+                      SplitEventTracker* split_event_tracker,
+                      std::deque<TraceMeRecorder::Event>* result) {
+  // Copy data from start events to end events. TraceMe records events in its
+  // destructor, so this results in complete events sorted by their end_time in
+  // the thread they ended. Within the same thread, the start event must appear
+  // before the corresponding end event.
+  if (event.IsStart()) {
+    split_event_tracker->AddStart(std::move(event));
+    return;
+  }
+  result->emplace_back(std::move(event));
+  if (result->back().IsEnd()) {
+    split_event_tracker->AddEnd(&result->back());
+  }
+}
+
+// True while continuous recording writes to the per-thread EventRings rather
+// than to the EventQueues.
+std::atomic<bool> record_to_ring(false);
+
 // A single-producer single-consumer queue of Events.
 //
 // Implemented as a linked-list of blocks containing numbered slots, with start
@@ -167,19 +191,7 @@ class EventQueue {
     size_t end = end_.load(std::memory_order_acquire);
     std::deque<TraceMeRecorder::Event> result;
     while (start_ != end) {
-      TraceMeRecorder::Event event = Pop();
-      // Copy data from start events to end events. TraceMe records events in
-      // its destructor, so this results in complete events sorted by their
-      // end_time in the thread they ended. Within the same thread, the start
-      // event must appear before the corresponding end event.
-      if (event.IsStart()) {
-        split_event_tracker->AddStart(std::move(event));
-        continue;
-      }
-      result.emplace_back(std::move(event));
-      if (result.back().IsEnd()) {
-        split_event_tracker->AddEnd(&result.back());
-      }
+      AddConsumedEvent(Pop(), split_event_tracker, &result);
     }
     return result;
   }
@@ -237,6 +249,67 @@ class EventQueue {
   std::atomic<size_t> end_;  // Atomic: also read by consumer thread.
 };
 
+// A fixed-size ring of the most recent Events of a thread, used by continuous
+// recording. Push overwrites the oldest event once the ring is full.
+//
+// Push is only called by the owner thread, and Reset and Snapshot by the
+// tracing control thread. Continuous recording samples events, so a mutex that
+// is almost never contended is cheap enough here, and it lets Snapshot copy
+// the ring while the owner thread keeps recording.
+class EventRing {
+ public:
+  // Drops all events and changes the capacity of the ring. A ring with zero
+  // capacity drops all pushed events.
+  void Reset(size_t capacity) {
+    std::vector<TraceMeRecorder::Event> events(capacity);
+    mutex_lock lock(mutex_);
+    events_.swap(events);
+    next_ = 0;
+    size_ = 0;
+  }
+
+  void Push(TraceMeRecorder::Event&& event) {
+    mutex_lock lock(mutex_);
+    if (TF_PREDICT_FALSE(events_.empty())) return;
+    events_[next_] = std::move(event);
+    if (++next_ == events_.size()) next_ = 0;
+    if (size_ < events_.size()) ++size_;
+  }
+
+  // Returns the events recorded at or after `start_time_ns`, oldest first,
+  // leaving the ring unchanged.
+  TF_MUST_USE_RESULT std::deque<TraceMeRecorder::Event> Snapshot(
+      int64_t start_time_ns, SplitEventTracker* split_event_tracker) const {
+    std::vector<TraceMeRecorder::Event> events;
+    {
+      mutex_lock lock(mutex_);
+      events.reserve(size_);
+      // Start from the oldest event.
+      size_t index = 0;
+      if (size_ > 0) index = (next_ + events_.size() - size_) % events_.size();
+      for (size_t i = 0; i < size_; ++i) {
+        const TraceMeRecorder::Event& event = events_[index];
+        int64_t time = event.IsStart() ? event.start_time : event.end_time;
+        if (time >= start_time_ns) events.push_back(event);
+        if (++index == events_.size()) index = 0;
+      }
+    }
+    std::deque<TraceMeRecorder::Event> result;
+    for (auto& event : events) {
+      AddConsumedEvent(std::move(event), split_event_tracker, &result);
+    }
+    return result;
+  }
+
+ private:
+  mutable mutex mutex_;
+  std::vector<TraceMeRecorder::Event> events_ TF_GUARDED_BY(mutex_);
+  // Slot written by the next Push.
+  size_t next_ TF_GUARDED_BY(mutex_) = 0;
+  // Number of events in the ring.
+  size_t size_ TF_GUARDED_BY(mutex_) = 0;
+};
+
 }  // namespace
 
 // To avoid unnecessary synchronization between threads, each thread has a
@@ -259,7 +332,13 @@ class TraceMeRecorder::ThreadLocalRecorder {
   void SetInactive() { active_.store(0, std::memory_order_release); }
 
   // Record is only called from the owner thread.
-  void Record(TraceMeRecorder::Event&& event) { queue_.Push(std::move(event)); }
+  void Record(TraceMeRecorder::Event&& event) {
+    if (TF_PREDICT_FALSE(record_to_ring.load(std::memory_order_acquire))) {
+      ring_.Push(std::move(event));
+    } else {
+      queue_.Push(std::move(event));
+    }
+  }
 
   // Clear is called from the control thread when tracing starts to remove any
   // elements added due to Record racing with Consume.
@@ -271,9 +350,19 @@ class TraceMeRecorder::ThreadLocalRecorder {
     return {info_, queue_.Consume(split_event_tracker)};
   }
 
+  // ResetRing and SnapshotRing are called from the control thread while
+  // continuous recording is configured.
+  void ResetRing(size_t capacity) { ring_.Reset(capacity); }
+
+  TF_MUST_USE_RESULT TraceMeRecorder::ThreadEvents SnapshotRing(
+      int64_t start_time_ns, SplitEventTracker* split_event_tracker) const {
+    return {info_, ring_.Snapshot(start_time_ns, split_event_tracker)};
+  }
+
  private:
   TraceMeRecorder::ThreadInfo info_;
   EventQueue queue_;
+  EventRing ring_;
   std::atomic<int> active_{1};  // std::atomic<bool> is not always lock-free.
 };
 
@@ -312,14 +401,19 @@ class TraceMeRecorder::ThreadLocalRecorderWrapper {
 void TraceMeRecorder::RegisterThread(
     uint32 tid, std::shared_ptr<ThreadLocalRecorder> thread) {
   mutex_lock lock(mutex_);
+  if (continuous_) thread->ResetRing(continuous_events_per_thread_);
   threads_.insert_or_assign(tid, std::move(thread));
 }
 
 void TraceMeRecorder::UnregisterThread(uint32 tid) {
   // If tracing is active, keep the ThreadLocalRecorder alive.
-  if (Active()) return;
-  // If tracing is inactive, destroy the ThreadLocalRecorder.
+  if (Active() && !record_to_ring.load(std::memory_order_acquire)) return;
   mutex_lock lock(mutex_);
+  // Check again while holding the mutex, as recording might have started.
+  if (recording_) return;
+  // If tracing is inactive, destroy the ThreadLocalRecorder. Continuous
+  // recording drops the events of threads that exit, so that the recorders of
+  // short-lived threads don't accumulate.
   threads_.erase(tid);
 }
 
@@ -368,15 +462,17 @@ TraceMeRecorder::Events TraceMeRecorder::Consume() {
 bool TraceMeRecorder::StartRecording(int level) {
   level = std::max(0, level);
   mutex_lock lock(mutex_);
+  if (recording_) return false;
+  recording_ = true;
+  // Suspend continuous recording, if active, so that every activity is
+  // recorded into the EventQueues.
+  record_to_ring.store(false, std::memory_order_release);
+  internal::g_sampling_period.store(1, std::memory_order_relaxed);
+  // We may have old events in buffers because Record() raced with Stop().
+  Clear();
   // Change trace_level_ while holding mutex_.
-  int expected = kTracingDisabled;
-  bool started = internal::g_trace_level.compare_exchange_strong(
-      expected, level, std::memory_order_acq_rel);
-  if (started) {
-    // We may have old events in buffers because Record() raced with Stop().
-    Clear();
-  }
-  return started;
+  internal::g_trace_level.store(level, std::memory_order_release);
+  return true;
 }
 
 void TraceMeRecorder::Record(Event&& event) {
@@ -387,14 +483,80 @@ void TraceMeRecorder::Record(Event&& event) {
 TraceMeRecorder::Events TraceMeRecorder::StopRecording() {
   TraceMeRecorder::Events events;
   mutex_lock lock(mutex_);
+  if (!recording_) return events;
+  recording_ = false;
   // Change trace_level_ while holding mutex_.
-  if (internal::g_trace_level.exchange(
-          kTracingDisabled, std::memory_order_acq_rel) != kTracingDisabled) {
-    events = Consume();
+  if (continuous_) {
+    ResumeContinuousRecording();
+  } else {
+    internal::g_trace_level.store(kTracingDisabled, std::memory_order_release);
   }
+  events = Consume();
   return events;
 }
 
+void TraceMeRecorder::ResumeContinuousRecording() {
+  internal::g_sampling_period.store(continuous_sampling_period_,
+                                    std::memory_order_relaxed);
+  record_to_ring.store(true, std::memory_order_release);
+  internal::g_trace_level.store(continuous_level_, std::memory_order_release);
+}
+
+bool TraceMeRecorder::StartContinuousRecording(int level, int sampling_period,
+                                               size_t events_per_thread) {
+  mutex_lock lock(mutex_);
+  if (continuous_) return false;
+  continuous_ = true;
+  continuous_level_ = std::max(0, level);
+  continuous_sampling_period_ = std::max(1, sampling_period);
+  continuous_events_per_thread_ = events_per_thread;
+  for (auto& id_and_recorder : threads_) {
+    id_and_recorder.second->ResetRing(events_per_thread);
+  }
+  if (!recording_) ResumeContinuousRecording();
+  return true;
+}
+
+void TraceMeRecorder::StopContinuousRecording() {
+  mutex_lock lock(mutex_);
+  if (!continuous_) return;
+  continuous_ = false;
+  if (!recording_) {
+    internal::g_trace_level.store(kTracingDisabled, std::memory_order_release);
+    record_to_ring.store(false, std::memory_order_release);
+    internal::g_sampling_period.store(1, std::memory_order_relaxed);
+  }
+  for (auto& id_and_recorder : threads_) {
+    id_and_recorder.second->ResetRing(0);
+  }
+}
+
+TraceMeRecorder::Events TraceMeRecorder::SnapshotContinuous(
+    int64_t start_time_ns) {
+  TraceMeRecorder::Events result;
+  mutex_lock lock(mutex_);
+  if (!continuous_) return result;
+  result.reserve(threads_.size());
+  SplitEventTracker split_event_tracker;
+  for (auto& id_and_recorder : threads_) {
+    TraceMeRecorder::ThreadEvents events =
+        id_and_recorder.second->SnapshotRing(start_time_ns,
+                                             &split_event_tracker);
+    if (!events.events.empty()) {
+      result.push_back(std::move(events));
+    }
+  }
+  split_event_tracker.HandleCrossThreadEvents();
+  return result;
+}
+
+/*static*/ bool TraceMeRecorder::SampleOnCurrentThread() {
+  static thread_local uint32 counter = 0;
+  const uint32 period =
+      internal::g_sampling_period.load(std::memory_order_relaxed);
+  return ++counter % period == 0;
+}
+
 /*static*/ int64_t TraceMeRecorder::NewActivityId() {
   // Activity IDs: To avoid contention over a counter, the top 32 bits identify
   // the originating thread, the bottom 32 bits name the event within a thread.
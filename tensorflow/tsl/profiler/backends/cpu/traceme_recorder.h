@@ -36,6 +36,11 @@ namespace internal {
 // Modified by TraceMeRecorder singleton when tracing starts/stops.
 TF_EXPORT extern std::atomic<int> g_trace_level;
 
+// One of every g_sampling_period TraceMe activities is recorded on each
+// thread. It is 1 (record all activities) unless continuous recording is
+// active.
+TF_EXPORT extern std::atomic<int> g_sampling_period;
+
 }  // namespace internal
 
 // TraceMeRecorder is a singleton repository of TraceMe events.
@@ -49,6 +54,13 @@ TF_EXPORT extern std::atomic<int> g_trace_level;
 // events. TraceMe::ActivityStart records start events, and TraceMe::ActivityEnd
 // records end events. The profiler then stops the recorder and finds start/end
 // pairs. (Unpaired start/end events are discarded at that point).
+//
+// The recorder also has a continuous mode, meant to be left on in production:
+// StartContinuous() records a sampled fraction of TraceMe activities into a
+// fixed-size ring per thread, and Snapshot() returns the most recent events
+// without stopping the recording. While continuous recording is active,
+// Start() and Stop() still work: the recorder records every activity into the
+// regular buffers until Stop(), and then resumes continuous recording.
 class TraceMeRecorder {
  public:
   // An Event is either the start of a TraceMe, the end of a TraceMe, or both.
@@ -89,11 +101,38 @@ class TraceMeRecorder {
   // Events passed to Record after Stop has started will be dropped.
   static Events Stop() { return Get()->StopRecording(); }
 
+  // Starts continuous recording of TraceMe() at levels <= level. One of every
+  // `sampling_period` activities is recorded on each thread, and only the last
+  // `events_per_thread` events of each thread are kept.
+  // Returns false if continuous recording is already active.
+  static bool StartContinuous(int level, int sampling_period,
+                              size_t events_per_thread) {
+    return Get()->StartContinuousRecording(level, sampling_period,
+                                           events_per_thread);
+  }
+
+  // Stops continuous recording and releases the per-thread rings.
+  static void StopContinuous() { Get()->StopContinuousRecording(); }
+
+  // Returns the continuously recorded events of all threads that were
+  // recorded at or after `start_time_ns`. The recording continues; each
+  // thread's ring is only frozen while it is copied.
+  static Events Snapshot(int64_t start_time_ns) {
+    return Get()->SnapshotContinuous(start_time_ns);
+  }
+
   // Returns whether we're currently recording. Racy, but cheap!
   static inline bool Active(int level = 1) {
     return internal::g_trace_level.load(std::memory_order_acquire) >= level;
   }
 
+  // Returns whether the activity about to start should be recorded. This is
+  // always true unless continuous recording samples activities.
+  static inline bool Sampled() {
+    return internal::g_sampling_period.load(std::memory_order_relaxed) <= 1 ||
+           SampleOnCurrentThread();
+  }
+
   // Default value for trace_level_ when tracing is disabled
   static constexpr int kTracingDisabled = -1;
 
@@ -114,12 +153,25 @@ class TraceMeRecorder {
 
   TF_DISALLOW_COPY_AND_ASSIGN(TraceMeRecorder);
 
+  // Advances the calling thread's sampling counter and returns true once every
+  // g_sampling_period calls.
+  static bool SampleOnCurrentThread();
+
   void RegisterThread(uint32 tid, std::shared_ptr<ThreadLocalRecorder> thread);
   void UnregisterThread(uint32 tid);
 
   bool StartRecording(int level);
   Events StopRecording();
 
+  bool StartContinuousRecording(int level, int sampling_period,
+                                size_t events_per_thread);
+  void StopContinuousRecording();
+  Events SnapshotContinuous(int64_t start_time_ns);
+
+  // Makes Record() write to the per-thread rings of continuous recording, with
+  // the configured level and sampling period.
+  void ResumeContinuousRecording() TF_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
   // Clears events from all active threads that were added due to Record
   // racing with StopRecording.
   void Clear() TF_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
@@ -137,6 +189,15 @@ class TraceMeRecorder {
   // stops so the events can be retrieved.
   absl::flat_hash_map<uint32, std::shared_ptr<ThreadLocalRecorder>> threads_
       TF_GUARDED_BY(mutex_);
+
+  // True between Start() and Stop().
+  bool recording_ TF_GUARDED_BY(mutex_) = false;
+
+  // Configuration of continuous recording, if active.
+  bool continuous_ TF_GUARDED_BY(mutex_) = false;
+  int continuous_level_ TF_GUARDED_BY(mutex_) = 0;
+  int continuous_sampling_period_ TF_GUARDED_BY(mutex_) = 1;
+  size_t continuous_events_per_thread_ TF_GUARDED_BY(mutex_) = 0;
 };
 
 }  // namespace profiler
@@ -15,6 +15,7 @@ limitations under the License.
 #include "tensorflow/tsl/profiler/backends/cpu/traceme_recorder.h"
 
 #include <atomic>
+#include <deque>
 #include <set>
 #include <string>
 #include <utility>
@@ -186,6 +187,91 @@ TEST(RecorderTest, Multithreaded) {
   }
 }
 
+// Returns the events of the calling thread in `events`.
+std::deque<TraceMeRecorder::Event> CurrentThreadEvents(
+    const TraceMeRecorder::Events& events) {
+  const uint32 tid = Env::Default()->GetCurrentThreadId();
+  for (const auto& thread : events) {
+    if (thread.thread.tid == tid) return thread.events;
+  }
+  return {};
+}
+
+TEST(RecorderTest, ContinuousKeepsMostRecentEvents) {
+  int64_t start_time = GetCurrentTimeNanos();
+  int64_t end_time = start_time + UniToNano(1);
+
+  ASSERT_TRUE(TraceMeRecorder::StartContinuous(
+      /*level=*/1, /*sampling_period=*/1, /*events_per_thread=*/3));
+  EXPECT_FALSE(TraceMeRecorder::StartContinuous(1, 1, 3));
+  EXPECT_TRUE(TraceMeRecorder::Active(1));
+  EXPECT_FALSE(TraceMeRecorder::Active(2));
+  for (int i = 0; i < 5; ++i) {
+    TraceMeRecorder::Record({absl::StrCat(i), start_time, end_time});
+  }
+
+  // Snapshots don't consume the events.
+  for (int i = 0; i < 2; ++i) {
+    EXPECT_THAT(CurrentThreadEvents(TraceMeRecorder::Snapshot(start_time)),
+                ElementsAre(Named("2"), Named("3"), Named("4")));
+  }
+  EXPECT_TRUE(
+      CurrentThreadEvents(TraceMeRecorder::Snapshot(end_time + 1)).empty());
+
+  TraceMeRecorder::StopContinuous();
+  EXPECT_FALSE(TraceMeRecorder::Active());
+  EXPECT_TRUE(TraceMeRecorder::Snapshot(start_time).empty());
+}
+
+TEST(RecorderTest, ContinuousPairsSplitEvents) {
+  ASSERT_TRUE(TraceMeRecorder::StartContinuous(1, 1, 8));
+  int64_t start_time = GetCurrentTimeNanos();
+  int64_t activity_id = TraceMeRecorder::NewActivityId();
+  TraceMeRecorder::Record({"split", start_time, -activity_id});
+  TraceMeRecorder::Record({"", -activity_id, start_time + UniToNano(1)});
+
+  auto events = CurrentThreadEvents(TraceMeRecorder::Snapshot(start_time));
+  ASSERT_EQ(events.size(), 1);
+  EXPECT_EQ(events[0].name, "split");
+  EXPECT_TRUE(events[0].IsComplete());
+  TraceMeRecorder::StopContinuous();
+}
+
+TEST(RecorderTest, OnDemandRecordingSuspendsContinuous) {
+  int64_t start_time = GetCurrentTimeNanos();
+  int64_t end_time = start_time + UniToNano(1);
+
+  ASSERT_TRUE(TraceMeRecorder::StartContinuous(1, 1, 8));
+  TraceMeRecorder::Record({"continuous1", start_time, end_time});
+
+  ASSERT_TRUE(TraceMeRecorder::Start(/*level=*/2));
+  EXPECT_FALSE(TraceMeRecorder::Start(/*level=*/2));
+  EXPECT_TRUE(TraceMeRecorder::Active(2));
+  TraceMeRecorder::Record({"on_demand", start_time, end_time});
+  EXPECT_THAT(CurrentThreadEvents(TraceMeRecorder::Stop()),
+              ElementsAre(Named("on_demand")));
+
+  // Continuous recording resumes at its own level.
+  EXPECT_TRUE(TraceMeRecorder::Active(1));
+  EXPECT_FALSE(TraceMeRecorder::Active(2));
+  TraceMeRecorder::Record({"continuous2", start_time, end_time});
+  EXPECT_THAT(CurrentThreadEvents(TraceMeRecorder::Snapshot(start_time)),
+              ElementsAre(Named("continuous1"), Named("continuous2")));
+  TraceMeRecorder::StopContinuous();
+}
+
+TEST(RecorderTest, ContinuousSampling) {
+  EXPECT_TRUE(TraceMeRecorder::Sampled());
+  ASSERT_TRUE(TraceMeRecorder::StartContinuous(1, /*sampling_period=*/4, 8));
+  int num_sampled = 0;
+  for (int i = 0; i < 40; ++i) {
+    if (TraceMeRecorder::Sampled()) ++num_sampled;
+  }
+  EXPECT_EQ(num_sampled, 10);
+  TraceMeRecorder::StopContinuous();
+  EXPECT_TRUE(TraceMeRecorder::Sampled());
+}
+
 }  // namespace
 }  // namespace profiler
 }  // namespace tsl
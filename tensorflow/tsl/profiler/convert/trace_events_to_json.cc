@@ -22,6 +22,7 @@ limitations under the License.
 #include "absl/algorithm/container.h"
 #include "absl/strings/str_cat.h"
 #include "json/json.h"
+#include "tensorflow/tsl/platform/errors.h"
 #include "tensorflow/tsl/platform/protobuf.h"
 #include "tensorflow/tsl/platform/types.h"
 #include "tensorflow/tsl/profiler/protobuf/trace_events.pb.h"
@@ -58,6 +59,13 @@ std::vector<const typename Map::value_type*> SortByKey(const Map& m) {
   return pairs;
 }
 
+constexpr char kJsonHeader[] =
+    R"({"displayTimeUnit":"ns","metadata":{"highres-ticks":true},)"
+    R"("traceEvents":[)";
+
+// Add one fake event to avoid dealing with no-trailing-comma rule.
+constexpr char kJsonTrailer[] = "{}]}";
+
 inline void AddDeviceMetadata(uint32 device_id, const Device& device,
                               std::string* json) {
   if (!device.name().empty()) {
@@ -103,29 +111,64 @@ inline void AddTraceEvent(const TraceEvent& event, string* json) {
   absl::StrAppend(json, "},");
 }
 
+inline void AddDeviceAndResourcesMetadata(uint32 device_id,
+                                          const Device& device,
+                                          std::string* json) {
+  AddDeviceMetadata(device_id, device, json);
+  for (const auto* id_and_resource : SortByKey(device.resources())) {
+    uint32 resource_id = id_and_resource->first;
+    const Resource& resource = id_and_resource->second;
+    AddResourceMetadata(device_id, resource_id, resource, json);
+  }
+}
+
 }  // namespace
 
 std::string TraceContainerToJson(const TraceContainer& container) {
-  std::string json =
-      R"({"displayTimeUnit":"ns","metadata":{"highres-ticks":true},)"
-      R"("traceEvents":[)";
+  std::string json = kJsonHeader;
   for (const auto* id_and_device : SortByKey(container.trace().devices())) {
-    uint32 device_id = id_and_device->first;
-    const Device& device = id_and_device->second;
-    AddDeviceMetadata(device_id, device, &json);
-    for (const auto* id_and_resource : SortByKey(device.resources())) {
-      uint32 resource_id = id_and_resource->first;
-      const Resource& resource = id_and_resource->second;
-      AddResourceMetadata(device_id, resource_id, resource, &json);
-    }
+    AddDeviceAndResourcesMetadata(id_and_device->first, id_and_device->second,
+                                  &json);
   }
   for (const TraceEvent* const event : container.UnsortedEvents()) {
     AddTraceEvent(*event, &json);
   }
-  // Add one fake event to avoid dealing with no-trailing-comma rule.
-  absl::StrAppend(&json, "{}]}");
+  absl::StrAppend(&json, kJsonTrailer);
   return json;
 }
 
+TraceEventsJsonWriter::TraceEventsJsonWriter(WritableFile* output,
+                                             size_t chunk_size)
+    : output_(output), chunk_size_(chunk_size), buffer_(kJsonHeader) {}
+
+Status TraceEventsJsonWriter::WriteDevice(uint32 device_id,
+                                          const Device& device) {
+  if (finished_) return errors::FailedPrecondition("Writer is finished.");
+  AddDeviceAndResourcesMetadata(device_id, device, &buffer_);
+  return MaybeFlush();
+}
+
+Status TraceEventsJsonWriter::WriteEvent(const TraceEvent& event) {
+  if (finished_) return errors::FailedPrecondition("Writer is finished.");
+  AddTraceEvent(event, &buffer_);
+  return MaybeFlush();
+}
+
+Status TraceEventsJsonWriter::Finish() {
+  if (finished_) return errors::FailedPrecondition("Writer is finished.");
+  finished_ = true;
+  absl::StrAppend(&buffer_, kJsonTrailer);
+  TF_RETURN_IF_ERROR(output_->Append(buffer_));
+  std::string().swap(buffer_);
+  return output_->Flush();
+}
+
+Status TraceEventsJsonWriter::MaybeFlush() {
+  if (buffer_.size() < chunk_size_) return OkStatus();
+  TF_RETURN_IF_ERROR(output_->Append(buffer_));
+  buffer_.clear();
+  return OkStatus();
+}
+
 }  // namespace profiler
 }  // namespace tsl
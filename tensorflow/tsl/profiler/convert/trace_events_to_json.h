@@ -16,10 +16,14 @@ limitations under the License.
 #ifndef TENSORFLOW_TSL_PROFILER_CONVERT_TRACE_EVENTS_TO_JSON_H_
 #define TENSORFLOW_TSL_PROFILER_CONVERT_TRACE_EVENTS_TO_JSON_H_
 
+#include <cstddef>
 #include <string>
 
+#include "tensorflow/tsl/platform/file_system.h"
+#include "tensorflow/tsl/platform/status.h"
 #include "tensorflow/tsl/platform/types.h"
 #include "tensorflow/tsl/profiler/convert/trace_container.h"
+#include "tensorflow/tsl/profiler/protobuf/trace_events.pb.h"
 
 namespace tsl {
 namespace profiler {
@@ -28,6 +32,44 @@ namespace profiler {
 // consumed by catapult trace viewer.
 std::string TraceContainerToJson(const TraceContainer& container);
 
+// Writes trace events as JSON that can be consumed by catapult trace viewer,
+// in the same format as TraceContainerToJson, without holding the trace or
+// the JSON string in memory. The JSON is buffered and appended to `output`
+// whenever the buffer exceeds `chunk_size` bytes, so memory usage is bounded
+// by the chunk size rather than by the size of the trace.
+//
+// Devices and events may be written in any order and interleaved.
+class TraceEventsJsonWriter {
+ public:
+  static constexpr size_t kDefaultChunkSize = 1 << 20;
+
+  // Does not take ownership of `output`, which must outlive the writer.
+  explicit TraceEventsJsonWriter(WritableFile* output,
+                                 size_t chunk_size = kDefaultChunkSize);
+
+  TraceEventsJsonWriter(const TraceEventsJsonWriter&) = delete;
+  TraceEventsJsonWriter& operator=(const TraceEventsJsonWriter&) = delete;
+
+  // Writes the metadata of `device` and of its resources.
+  Status WriteDevice(uint32 device_id, const Device& device);
+
+  // Writes a complete event.
+  Status WriteEvent(const TraceEvent& event);
+
+  // Terminates the JSON and appends the remaining buffer to the output. No
+  // other method may be called afterwards.
+  Status Finish();
+
+ private:
+  // Appends the buffer to the output if it exceeds the chunk size.
+  Status MaybeFlush();
+
+  WritableFile* const output_;
+  const size_t chunk_size_;
+  std::string buffer_;
+  bool finished_ = false;
+};
+
 }  // namespace profiler
 }  // namespace tsl
 
@@ -18,6 +18,8 @@ limitations under the License.
 #include <string>
 
 #include "json/json.h"
+#include "tensorflow/tsl/lib/core/status_test_util.h"
+#include "tensorflow/tsl/platform/file_system.h"
 #include "tensorflow/tsl/platform/protobuf.h"
 #include "tensorflow/tsl/platform/test.h"
 #include "tensorflow/tsl/profiler/convert/trace_container.h"
@@ -27,6 +29,27 @@ namespace tsl {
 namespace profiler {
 namespace {
 
+// A WritableFile that appends to a string and counts the appends.
+class StringDest : public WritableFile {
+ public:
+  explicit StringDest(std::string* contents) : contents_(contents) {}
+
+  Status Close() override { return OkStatus(); }
+  Status Flush() override { return OkStatus(); }
+  Status Sync() override { return OkStatus(); }
+  Status Append(StringPiece slice) override {
+    contents_->append(slice.data(), slice.size());
+    ++num_appends_;
+    return OkStatus();
+  }
+
+  int num_appends() const { return num_appends_; }
+
+ private:
+  std::string* contents_;
+  int num_appends_ = 0;
+};
+
 Json::Value ToJsonValue(const std::string& json_str) {
   Json::Value json;
   Json::Reader reader;
@@ -122,6 +145,39 @@ TEST(TraceEventsToJson, JsonConversion) {
   EXPECT_EQ(json, expected_json);
 }
 
+TEST(TraceEventsToJson, StreamingMatchesTraceContainerToJson) {
+  TraceContainer container;
+  Device* device = container.MutableDevice(1);
+  device->set_name("D1");
+  device->set_device_id(1);
+  Resource& resource = (*device->mutable_resources())[2];
+  resource.set_resource_id(2);
+  resource.set_name("R1.2");
+  for (int i = 0; i < 100; ++i) {
+    TraceEvent* event = container.CreateEvent();
+    event->set_device_id(1);
+    event->set_resource_id(2);
+    event->set_name("E1.2");
+    event->set_timestamp_ps(1000 * i);
+    event->set_duration_ps(500);
+    event->mutable_args()->insert({"step", std::to_string(i)});
+  }
+
+  std::string json;
+  StringDest dest(&json);
+  // A small chunk size flushes the JSON several times.
+  TraceEventsJsonWriter writer(&dest, /*chunk_size=*/256);
+  TF_ASSERT_OK(writer.WriteDevice(1, *device));
+  for (const TraceEvent* event : container.UnsortedEvents()) {
+    TF_ASSERT_OK(writer.WriteEvent(*event));
+  }
+  TF_ASSERT_OK(writer.Finish());
+
+  EXPECT_GT(dest.num_appends(), 10);
+  EXPECT_EQ(json, TraceContainerToJson(container));
+  EXPECT_FALSE(writer.WriteEvent(TraceEvent()).ok());
+}
+
 }  // namespace
 }  // namespace profiler
 }  // namespace tsl
@@ -14,7 +14,9 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/tsl/profiler/convert/xplane_to_profile_instructions.h"
 
+#include <algorithm>
 #include <numeric>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -25,6 +27,7 @@ limitations under the License.
 #include "tensorflow/tsl/platform/env.h"
 #include "tensorflow/tsl/platform/status.h"
 #include "tensorflow/tsl/platform/types.h"
+#include "tensorflow/tsl/profiler/convert/xla_op_utils.h"
 #include "tensorflow/tsl/profiler/protobuf/xplane.pb.h"
 #include "tensorflow/tsl/profiler/utils/file_system_utils.h"
 #include "tensorflow/tsl/profiler/utils/tf_xplane_visitor.h"
@@ -39,34 +42,98 @@ constexpr char kXPlanePb[] = "xplane.pb";
 
 void GetXPlaneLatencyInfo(
     const XPlaneVisitor& xplane,
-    absl::flat_hash_map<std::string, HloLatencyInfo>* hlo_latency_info) {
+    absl::flat_hash_map<std::string, ModuleLatencyInfo>* latency_info) {
   // Iterate events.
-  xplane.ForEachLine([hlo_latency_info](const XLineVisitor& xline) {
+  xplane.ForEachLine([latency_info](const XLineVisitor& xline) {
     if (xline.DisplayName() == tsl::profiler::kXlaAsyncOpLineName) {
       return;
     }
-    xline.ForEachEvent([hlo_latency_info](const XEventVisitor& xevent) {
+    xline.ForEachEvent([latency_info](const XEventVisitor& xevent) {
       int64_t event_type =
           xevent.Type().value_or(HostEventType::kUnknownHostEventType);
       if (IsInternalEvent(event_type)) return;
+      std::optional<std::string> hlo_name;
+      std::string module_name;
+      std::optional<uint64_t> program_id;
       auto for_each_stat = [&](const XStatVisitor& stat) {
         if (stat.ValueCase() == XStat::VALUE_NOT_SET) return;
         if (IsInternalStat(stat.Type())) return;
         // Store latency information for HLOs.
         if (stat.Name() == GetStatTypeStr(StatType::kHloOp)) {
-          std::string hlo_name = stat.ToString();
-          double latency = static_cast<double>(xevent.DurationNs()) / 1e3;
-          (*hlo_latency_info)[hlo_name].durations.emplace_back(latency);
+          hlo_name = stat.ToString();
+        } else if (stat.Name() == GetStatTypeStr(StatType::kHloModule)) {
+          module_name = stat.ToString();
+        } else if (stat.Name() == GetStatTypeStr(StatType::kProgramId)) {
+          program_id = stat.IntOrUintValue();
         }
       };
       xevent.Metadata().ForEachStat(for_each_stat);
       xevent.ForEachStat(for_each_stat);
+      if (hlo_name.has_value()) {
+        if (program_id.has_value() && !module_name.empty()) {
+          module_name = HloModuleNameWithProgramId(module_name, *program_id);
+        }
+        double latency = static_cast<double>(xevent.DurationNs()) / 1e3;
+        (*latency_info)[module_name][*hlo_name].durations.emplace_back(
+            latency);
+      }
     });
   });
 }
 
 }  // namespace
 
+void AddXSpaceLatencyInfo(
+    const XSpace& xspace,
+    absl::flat_hash_map<std::string, ModuleLatencyInfo>* latency_info) {
+  std::vector<const XPlane*> device_planes =
+      FindPlanesWithPrefix(xspace, kGpuPlanePrefix);
+  // We don't expect GPU and TPU planes and custom devices to be present in the
+  // same XSpace.
+  if (device_planes.empty()) {
+    device_planes = FindPlanesWithPrefix(xspace, kTpuPlanePrefix);
+  }
+  if (device_planes.empty()) {
+    device_planes = FindPlanesWithPrefix(xspace, kCustomPlanePrefix);
+  }
+  // Go over each device plane.
+  for (const XPlane* device_plane : device_planes) {
+    XPlaneVisitor xplane = CreateTfXPlaneVisitor(device_plane);
+    GetXPlaneLatencyInfo(xplane, latency_info);
+  }
+}
+
+void MergeIntoProfiledInstructionsProto(
+    const ModuleLatencyInfo& latency_info,
+    tensorflow::profiler::ProfiledInstructionsProto*
+        profiled_instructions_proto) {
+  absl::flat_hash_map<std::string,
+                      tensorflow::profiler::ProfiledInstructionsProto::
+                          InstructionCost*>
+      costs_by_name;
+  for (auto& cost : *profiled_instructions_proto->mutable_costs()) {
+    costs_by_name[cost.name()] = &cost;
+  }
+  for (const auto& iter : latency_info) {
+    const std::vector<double>& durations = iter.second.durations;
+    if (durations.empty()) continue;
+    double sum = std::accumulate(durations.begin(), durations.end(), 0.0);
+    int64_t num_samples = durations.size();
+    auto*& cost = costs_by_name[iter.first];
+    if (cost == nullptr) {
+      cost = profiled_instructions_proto->add_costs();
+      cost->set_name(iter.first);
+    } else {
+      int64_t old_num_samples = std::max<int64_t>(cost->num_samples(), 1);
+      sum += cost->cost_us() * old_num_samples;
+      num_samples += old_num_samples;
+    }
+    cost->set_cost_us(sum / num_samples);
+    cost->set_num_samples(num_samples);
+  }
+  profiled_instructions_proto->set_version(kProfiledInstructionsVersion);
+}
+
 Status ConvertXplaneToProfiledInstructionsProto(
     const std::string& logdir, tensorflow::profiler::ProfiledInstructionsProto*
                                    profiled_instructions_proto) {
@@ -77,46 +144,28 @@ Status ConvertXplaneToProfiledInstructionsProto(
     return absl::NotFoundError(
         absl::StrCat("Could not find file under: ", logdir));
   }
-  std::vector<tensorflow::profiler::XSpace> xspaces;
+  // Gets the duration information for each hlo, across the modules and hosts.
+  absl::flat_hash_map<std::string, ModuleLatencyInfo> latency_info;
   for (const string& child_path : children_path) {
     if (absl::StrContains(child_path, kXPlanePb)) {
       std::string xspace_path = ProfilerJoinPath(logdir, child_path);
       tensorflow::profiler::XSpace xspace;
       TF_RETURN_IF_ERROR(ReadBinaryProto(Env::Default(), xspace_path, &xspace));
-      xspaces.emplace_back(xspace);
+      AddXSpaceLatencyInfo(xspace, &latency_info);
     }
   }
-
-  // Gets the duration information for each hlo.
-  absl::flat_hash_map<std::string, HloLatencyInfo> hlo_latency_info;
-  // Iterate through each host.
-  for (const XSpace& xspace : xspaces) {
-    std::vector<const XPlane*> device_planes =
-        FindPlanesWithPrefix(xspace, kGpuPlanePrefix);
-    // We don't expect GPU and TPU planes and custom devices to be present in
-    // the same XSpace.
-    if (device_planes.empty()) {
-      device_planes = FindPlanesWithPrefix(xspace, kTpuPlanePrefix);
-    }
-    if (device_planes.empty()) {
-      device_planes = FindPlanesWithPrefix(xspace, kCustomPlanePrefix);
-    }
-    // Go over each device plane.
-    for (const XPlane* device_plane : device_planes) {
-      XPlaneVisitor xplane = CreateTfXPlaneVisitor(device_plane);
-      GetXPlaneLatencyInfo(xplane, &hlo_latency_info);
+  ModuleLatencyInfo hlo_latency_info;
+  for (auto& module : latency_info) {
+    for (auto& hlo : module.second) {
+      std::vector<double>& durations = hlo_latency_info[hlo.first].durations;
+      durations.insert(durations.end(), hlo.second.durations.begin(),
+                       hlo.second.durations.end());
     }
   }
 
   // Get the mean duration for each hlo and store into the proto.
-  for (const auto& iter : hlo_latency_info) {
-    auto* cost = profiled_instructions_proto->add_costs();
-    std::vector<double> durations = iter.second.durations;
-    double sum = std::accumulate(durations.begin(), durations.end(), 0.0);
-    cost->set_cost_us(sum / durations.size());
-    cost->set_name(iter.first);
-  }
-
+  MergeIntoProfiledInstructionsProto(hlo_latency_info,
+                                     profiled_instructions_proto);
   return OkStatus();
 }
 
@@ -19,17 +19,42 @@ limitations under the License.
 #include <string>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "tensorflow/tsl/platform/status.h"
 #include "tensorflow/tsl/profiler/protobuf/profiled_instructions.pb.h"
+#include "tensorflow/tsl/profiler/protobuf/xplane.pb.h"
 
 namespace tsl {
 namespace profiler {
 
+// Version of the ProfiledInstructionsProto written by the functions below.
+inline constexpr int kProfiledInstructionsVersion = 1;
+
 // Latency info for a single HLO instruction.
 struct HloLatencyInfo {
   std::vector<double> durations;
 };
 
+// Latency info of the HLO instructions of one module, keyed by their name.
+using ModuleLatencyInfo = absl::flat_hash_map<std::string, HloLatencyInfo>;
+
+// Adds the latencies of the HLO instructions executed on the device planes of
+// `xspace` to `latency_info`, keyed by the name of their module as given by
+// the kHloModule stat of the events (empty if they have none), followed by
+// the program id in parentheses if the events have a kProgramId stat.
+void AddXSpaceLatencyInfo(
+    const tensorflow::profiler::XSpace& xspace,
+    absl::flat_hash_map<std::string, ModuleLatencyInfo>* latency_info);
+
+// Merges the mean latencies of `latency_info` into the costs of
+// `profiled_instructions_proto`. Existing costs are weighted by their
+// num_samples, or as one sample if they have none, so that the profile can be
+// refined with the traces of later runs.
+void MergeIntoProfiledInstructionsProto(
+    const ModuleLatencyInfo& latency_info,
+    tensorflow::profiler::ProfiledInstructionsProto*
+        profiled_instructions_proto);
+
 // Convert XSpace to ProfiledInstructionsProto. This function will aggregate
 // all the xplane.pb info into ProfiledInstructionsProto.
 Status ConvertXplaneToProfiledInstructionsProto(
@@ -102,6 +102,59 @@ TEST(XplaneToProfiledInstructionsProtoTest,
   EXPECT_EQ(profile_proto.costs_size(), 1);
   EXPECT_EQ(profile_proto.costs(0).cost_us(), 10);
   EXPECT_EQ(profile_proto.costs(0).name(), "fusion");
+  EXPECT_EQ(profile_proto.costs(0).num_samples(), 4);
+  EXPECT_EQ(profile_proto.version(), kProfiledInstructionsVersion);
+}
+
+TEST(XplaneToProfiledInstructionsProtoTest, GroupsLatenciesByModule) {
+  XSpace xspace;
+  XPlaneBuilder device_plane(xspace.add_planes());
+  device_plane.SetName(GpuPlaneName(0));
+  XLineBuilder stream = device_plane.GetOrCreateLine(30);
+  for (const char* module : {"module_a", "module_b"}) {
+    XEventBuilder event =
+        stream.AddEvent(*device_plane.GetOrCreateEventMetadata("kernel"));
+    event.SetDurationNs(1000);
+    event.AddStatValue(*device_plane.GetOrCreateStatMetadata(
+                           GetStatTypeStr(StatType::kHloOp)),
+                       *device_plane.GetOrCreateStatMetadata("fusion"));
+    event.AddStatValue(*device_plane.GetOrCreateStatMetadata(
+                           GetStatTypeStr(StatType::kHloModule)),
+                       *device_plane.GetOrCreateStatMetadata(module));
+  }
+
+  absl::flat_hash_map<std::string, ModuleLatencyInfo> latency_info;
+  AddXSpaceLatencyInfo(xspace, &latency_info);
+  ASSERT_EQ(latency_info.size(), 2);
+  EXPECT_EQ(latency_info["module_a"]["fusion"].durations.size(), 1);
+  EXPECT_EQ(latency_info["module_b"]["fusion"].durations.size(), 1);
+}
+
+TEST(XplaneToProfiledInstructionsProtoTest, MergesIntoExistingProfile) {
+  tensorflow::profiler::ProfiledInstructionsProto profile_proto;
+  auto* cost = profile_proto.add_costs();
+  cost->set_name("fusion");
+  cost->set_cost_us(10);
+  cost->set_num_samples(2);
+  // Hand written costs count as one sample.
+  cost = profile_proto.add_costs();
+  cost->set_name("convolution");
+  cost->set_cost_us(20);
+
+  ModuleLatencyInfo latency_info;
+  latency_info["fusion"].durations = {40};
+  latency_info["convolution"].durations = {10, 30};
+  latency_info["all-reduce"].durations = {5};
+  MergeIntoProfiledInstructionsProto(latency_info, &profile_proto);
+
+  ASSERT_EQ(profile_proto.costs_size(), 3);
+  EXPECT_EQ(profile_proto.costs(0).cost_us(), 20);
+  EXPECT_EQ(profile_proto.costs(0).num_samples(), 3);
+  EXPECT_EQ(profile_proto.costs(1).cost_us(), 20);
+  EXPECT_EQ(profile_proto.costs(1).num_samples(), 3);
+  EXPECT_EQ(profile_proto.costs(2).name(), "all-reduce");
+  EXPECT_EQ(profile_proto.costs(2).cost_us(), 5);
+  EXPECT_EQ(profile_proto.version(), kProfiledInstructionsVersion);
 }
 
 }  // namespace
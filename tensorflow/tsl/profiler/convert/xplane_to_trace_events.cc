@@ -24,7 +24,9 @@ limitations under the License.
 
 #include "absl/strings/string_view.h"
 #include "absl/types/optional.h"
+#include "tensorflow/tsl/platform/errors.h"
 #include "tensorflow/tsl/platform/types.h"
+#include "tensorflow/tsl/profiler/convert/trace_events_to_json.h"
 #include "tensorflow/tsl/profiler/protobuf/trace_events.pb.h"
 #include "tensorflow/tsl/profiler/protobuf/xplane.pb.h"
 #include "tensorflow/tsl/profiler/utils/tf_xplane_visitor.h"
@@ -60,6 +62,54 @@ void BuildDeviceAndResources(uint32 device_id, const XPlaneVisitor& plane,
   });
 }
 
+// Converts `xevent` on the line `resource_id` of the device `device_id` to
+// `event`.
+void ConvertXEventToTraceEvent(uint32 device_id, uint32 resource_id,
+                               const XEventVisitor& xevent, TraceEvent* event) {
+  auto& args = *event->mutable_args();
+  event->set_device_id(device_id);
+  event->set_resource_id(resource_id);
+  if (xevent.HasDisplayName()) {
+    event->set_name(std::string(xevent.DisplayName()));
+    args["long_name"] = std::string(xevent.Name());
+  } else {
+    event->set_name(std::string(xevent.Name()));
+  }
+  event->set_timestamp_ps(xevent.TimestampPs());
+  event->set_duration_ps(xevent.DurationPs());
+
+  auto for_each_stat = [&](const XStatVisitor& stat) {
+    if (stat.ValueCase() == XStat::VALUE_NOT_SET) return;
+    if (IsInternalStat(stat.Type())) return;
+    if (stat.Type() == StatType::kStepName) {
+      event->set_name(stat.ToString());
+    }
+    args[std::string(stat.Name())] = stat.ToString();
+  };
+  // The metadata stats should appear before the per-occurrence stats.
+  xevent.Metadata().ForEachStat(for_each_stat);
+  xevent.ForEachStat(for_each_stat);
+}
+
+// Calls `fn(xline)` for each line of `xplane` whose events are converted to
+// trace events.
+template <typename ForEachLineFn>
+void ForEachTraceLine(const XPlaneVisitor& xplane, ForEachLineFn&& fn) {
+  xplane.ForEachLine([&fn](const XLineVisitor& xline) {
+    if (xline.DisplayName() == tsl::profiler::kXlaAsyncOpLineName) {
+      return;
+    }
+    fn(xline);
+  });
+}
+
+// Returns true if `xevent` is converted to a trace event.
+bool IsTraceEvent(const XEventVisitor& xevent) {
+  int64_t event_type =
+      xevent.Type().value_or(HostEventType::kUnknownHostEventType);
+  return !IsInternalEvent(event_type);
+}
+
 void ConvertXPlaneToTraceEvents(uint32 device_id, const XPlaneVisitor& xplane,
                                 TraceContainer& container) {
   // Convert devices and resources.
@@ -67,63 +117,25 @@ void ConvertXPlaneToTraceEvents(uint32 device_id, const XPlaneVisitor& xplane,
                           container.MutableDevice(device_id));
 
   // Convert events.
-  xplane.ForEachLine([device_id, &container](const XLineVisitor& xline) {
+  ForEachTraceLine(xplane, [device_id, &container](const XLineVisitor& xline) {
     uint32 resource_id = xline.DisplayId();
-    if (xline.DisplayName() == tsl::profiler::kXlaAsyncOpLineName) {
-      return;
-    }
     xline.ForEachEvent(
         [device_id, resource_id, &container](const XEventVisitor& xevent) {
-          int64_t event_type =
-              xevent.Type().value_or(HostEventType::kUnknownHostEventType);
-          if (IsInternalEvent(event_type)) return;
-          TraceEvent* event = container.CreateEvent();
-          auto& args = *event->mutable_args();
-          event->set_device_id(device_id);
-          event->set_resource_id(resource_id);
-          if (xevent.HasDisplayName()) {
-            event->set_name(std::string(xevent.DisplayName()));
-            args["long_name"] = std::string(xevent.Name());
-          } else {
-            event->set_name(std::string(xevent.Name()));
-          }
-          event->set_timestamp_ps(xevent.TimestampPs());
-          event->set_duration_ps(xevent.DurationPs());
-
-          auto for_each_stat = [&](const XStatVisitor& stat) {
-            if (stat.ValueCase() == XStat::VALUE_NOT_SET) return;
-            if (IsInternalStat(stat.Type())) return;
-            if (stat.Type() == StatType::kStepName) {
-              event->set_name(stat.ToString());
-            }
-            args[std::string(stat.Name())] = stat.ToString();
-          };
-          // The metadata stats should appear before the per-occurrence stats.
-          xevent.Metadata().ForEachStat(for_each_stat);
-          xevent.ForEachStat(for_each_stat);
+          if (!IsTraceEvent(xevent)) return;
+          ConvertXEventToTraceEvent(device_id, resource_id, xevent,
+                                    container.CreateEvent());
         });
   });
 }
 
-}  // namespace
-
-uint64 GetTraceViewerMaxEvents() {
-  constexpr uint64 kMaxEvents = 1000000;
-  // Testing only env variable, not recommended for use
-  char* max_events = getenv("TF_PROFILER_TRACE_VIEWER_MAX_EVENTS");
-  if (max_events != nullptr) {
-    return std::stoull(max_events, nullptr, 10);
-  } else {
-    return kMaxEvents;
-  }
-}
-
-TraceContainer ConvertXSpaceToTraceContainer(const XSpace& xspace) {
-  TraceContainer container;
+// Calls `fn(device_id, xplane)` for each plane of `xspace` that is converted
+// to trace events: the host plane first, then the device planes.
+template <typename ForEachPlaneFn>
+void ForEachTracePlane(const XSpace& xspace, ForEachPlaneFn&& fn) {
   const XPlane* host_plane = FindPlaneWithName(xspace, kHostThreadsPlaneName);
   if (host_plane != nullptr) {
     XPlaneVisitor xplane = CreateTfXPlaneVisitor(host_plane);
-    ConvertXPlaneToTraceEvents(kHostThreadsDeviceId, xplane, container);
+    fn(kHostThreadsDeviceId, xplane);
   }
   std::vector<const XPlane*> device_planes =
       FindPlanesWithPrefix(xspace, kGpuPlanePrefix);
@@ -138,8 +150,29 @@ TraceContainer ConvertXSpaceToTraceContainer(const XSpace& xspace) {
   for (const XPlane* device_plane : device_planes) {
     XPlaneVisitor xplane = CreateTfXPlaneVisitor(device_plane);
     uint32 device_id = kFirstDeviceId + xplane.Id();
-    ConvertXPlaneToTraceEvents(device_id, xplane, container);
+    fn(device_id, xplane);
   }
+}
+
+}  // namespace
+
+uint64 GetTraceViewerMaxEvents() {
+  constexpr uint64 kMaxEvents = 1000000;
+  // Testing only env variable, not recommended for use
+  char* max_events = getenv("TF_PROFILER_TRACE_VIEWER_MAX_EVENTS");
+  if (max_events != nullptr) {
+    return std::stoull(max_events, nullptr, 10);
+  } else {
+    return kMaxEvents;
+  }
+}
+
+TraceContainer ConvertXSpaceToTraceContainer(const XSpace& xspace) {
+  TraceContainer container;
+  ForEachTracePlane(xspace,
+                    [&container](uint32 device_id, const XPlaneVisitor& xplane) {
+                      ConvertXPlaneToTraceEvents(device_id, xplane, container);
+                    });
   // Trace viewer (non-streaming) has scalability issues, we need to drop
   // events to avoid loading failure for trace viewer.
   uint64 viewer_max_events = GetTraceViewerMaxEvents();
@@ -152,5 +185,41 @@ void ConvertXSpaceToTraceEventsString(const XSpace& xspace,
   ConvertXSpaceToTraceContainer(xspace).FlushAndSerializeEvents(content);
 }
 
+Status ConvertXSpaceToTraceEventsJson(const XSpace& xspace,
+                                      const TraceEventsStreamOptions& options,
+                                      WritableFile* output) {
+  TraceEventsJsonWriter writer(output, options.chunk_size);
+  Status status;
+  // Only one device and one event are materialized at a time.
+  Device device;
+  TraceEvent event;
+  ForEachTracePlane(xspace, [&](uint32 device_id,
+                                const XPlaneVisitor& xplane) {
+    if (!status.ok()) return;
+    device.Clear();
+    BuildDeviceAndResources(device_id, xplane, &device);
+    status = writer.WriteDevice(device_id, device);
+    ForEachTraceLine(xplane, [&](const XLineVisitor& xline) {
+      uint32 resource_id = xline.DisplayId();
+      uint64 num_events = 0;
+      xline.ForEachEvent([&](const XEventVisitor& xevent) {
+        if (!status.ok()) return;
+        if (options.max_events_per_line > 0 &&
+            num_events >= options.max_events_per_line) {
+          return;
+        }
+        if (!IsTraceEvent(xevent)) return;
+        if (xevent.DurationPs() < options.min_duration_ps) return;
+        event.Clear();
+        ConvertXEventToTraceEvent(device_id, resource_id, xevent, &event);
+        status = writer.WriteEvent(event);
+        ++num_events;
+      });
+    });
+  });
+  TF_RETURN_IF_ERROR(status);
+  return writer.Finish();
+}
+
 }  // namespace profiler
 }  // namespace tsl
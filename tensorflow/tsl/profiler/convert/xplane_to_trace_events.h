@@ -16,10 +16,14 @@ limitations under the License.
 #ifndef TENSORFLOW_TSL_PROFILER_CONVERT_XPLANE_TO_TRACE_EVENTS_H_
 #define TENSORFLOW_TSL_PROFILER_CONVERT_XPLANE_TO_TRACE_EVENTS_H_
 
+#include <cstddef>
 #include <string>
 
+#include "tensorflow/tsl/platform/file_system.h"
+#include "tensorflow/tsl/platform/status.h"
 #include "tensorflow/tsl/platform/types.h"
 #include "tensorflow/tsl/profiler/convert/trace_container.h"
+#include "tensorflow/tsl/profiler/convert/trace_events_to_json.h"
 #include "tensorflow/tsl/profiler/protobuf/xplane.pb.h"
 
 namespace tsl {
@@ -30,6 +34,27 @@ TraceContainer ConvertXSpaceToTraceContainer(
 
 void ConvertXSpaceToTraceEventsString(
     const tensorflow::profiler::XSpace& xspace, std::string* content);
+
+struct TraceEventsStreamOptions {
+  // Size of the chunks appended to the output.
+  size_t chunk_size = TraceEventsJsonWriter::kDefaultChunkSize;
+
+  // Downsampling for visualization of very large traces. Events shorter than
+  // `min_duration_ps` are dropped, and only the first `max_events_per_line`
+  // events of each line are kept. Zero keeps all events.
+  uint64 min_duration_ps = 0;
+  uint64 max_events_per_line = 0;
+};
+
+// Converts `xspace` to trace viewer JSON written to `output`. Unlike
+// ConvertXSpaceToTraceEventsString, the trace and the JSON are never held in
+// memory as a whole: events are converted one at a time and the JSON is
+// appended to `output` in chunks. Events are not capped by
+// GetTraceViewerMaxEvents(); use `options` to downsample instead.
+Status ConvertXSpaceToTraceEventsJson(
+    const tensorflow::profiler::XSpace& xspace,
+    const TraceEventsStreamOptions& options, WritableFile* output);
+
 }  // namespace profiler
 }  // namespace tsl
 
@@ -15,10 +15,19 @@ limitations under the License.
 
 #include "tensorflow/tsl/profiler/convert/xplane_to_trace_events.h"
 
+#include <algorithm>
 #include <limits>
+#include <string>
 #include <utility>
+#include <vector>
 
+#include "absl/strings/str_cat.h"
+#include "json/json.h"
+#include "tensorflow/tsl/lib/core/status_test_util.h"
+#include "tensorflow/tsl/platform/file_system.h"
+#include "tensorflow/tsl/platform/status.h"
 #include "tensorflow/tsl/platform/test.h"
+#include "tensorflow/tsl/profiler/convert/trace_events_to_json.h"
 #include "tensorflow/tsl/profiler/protobuf/trace_events.pb.h"
 #include "tensorflow/tsl/profiler/protobuf/xplane.pb.h"
 #include "tensorflow/tsl/profiler/utils/trace_utils.h"
@@ -31,6 +40,51 @@ namespace {
 
 using tensorflow::profiler::XSpace;
 
+class StringDest : public WritableFile {
+ public:
+  explicit StringDest(std::string* contents) : contents_(contents) {}
+
+  Status Close() override { return OkStatus(); }
+  Status Flush() override { return OkStatus(); }
+  Status Sync() override { return OkStatus(); }
+  Status Append(StringPiece slice) override {
+    contents_->append(slice.data(), slice.size());
+    return OkStatus();
+  }
+
+ private:
+  std::string* contents_;
+};
+
+Json::Value ToJsonValue(const std::string& json_str) {
+  Json::Value json;
+  Json::Reader reader;
+  EXPECT_TRUE(reader.parse(json_str, json));
+  return json;
+}
+
+// Returns the trace events of the trace viewer JSON in a canonical order, as
+// the order of the events doesn't matter to trace viewer.
+std::vector<std::string> SortedTraceEvents(const Json::Value& json) {
+  std::vector<std::string> events;
+  for (const Json::Value& event : json["traceEvents"]) {
+    events.push_back(Json::FastWriter().write(event));
+  }
+  std::sort(events.begin(), events.end());
+  return events;
+}
+
+// Returns the names of the complete events in the trace viewer JSON.
+std::vector<std::string> EventNames(const Json::Value& json) {
+  std::vector<std::string> names;
+  for (const Json::Value& event : json["traceEvents"]) {
+    if (event["ph"].asString() == "X") {
+      names.push_back(event["name"].asString());
+    }
+  }
+  return names;
+}
+
 void CreateXSpace(XSpace* space) {
   XPlaneBuilder host_plane(space->add_planes());
   host_plane.SetName(kHostThreadsPlaneName);
@@ -95,6 +149,46 @@ TEST(ConvertXPlaneToTraceEvents, SkipAsyncOps) {
   ASSERT_THAT(container.UnsortedEvents(), ::testing::IsEmpty());
 }
 
+TEST(ConvertXPlaneToTraceEvents, StreamingJson) {
+  XSpace xspace;
+  CreateXSpace(&xspace);
+
+  std::string json;
+  StringDest dest(&json);
+  TraceEventsStreamOptions options;
+  options.chunk_size = 64;
+  TF_ASSERT_OK(ConvertXSpaceToTraceEventsJson(xspace, options, &dest));
+
+  // Metadata is written per device rather than before all events.
+  EXPECT_EQ(SortedTraceEvents(ToJsonValue(json)),
+            SortedTraceEvents(ToJsonValue(
+                TraceContainerToJson(ConvertXSpaceToTraceContainer(xspace)))));
+}
+
+TEST(ConvertXPlaneToTraceEvents, StreamingJsonDownsampling) {
+  XSpace xspace;
+  XPlaneBuilder host_plane(xspace.add_planes());
+  host_plane.SetName(kHostThreadsPlaneName);
+  XLineBuilder thread = host_plane.GetOrCreateLine(10);
+  thread.SetName("thread");
+  for (int i = 0; i < 10; ++i) {
+    XEventBuilder event = thread.AddEvent(
+        *host_plane.GetOrCreateEventMetadata(absl::StrCat("event", i)));
+    event.SetTimestampNs(100 * i);
+    event.SetDurationNs(i % 2 == 0 ? 10 : 50);
+  }
+
+  std::string json;
+  StringDest dest(&json);
+  TraceEventsStreamOptions options;
+  options.min_duration_ps = 20000;
+  options.max_events_per_line = 3;
+  TF_ASSERT_OK(ConvertXSpaceToTraceEventsJson(xspace, options, &dest));
+
+  EXPECT_THAT(EventNames(ToJsonValue(json)),
+              ::testing::ElementsAre("event1", "event3", "event5"));
+}
+
 }  // namespace
 }  // namespace profiler
 }  // namespace tsl
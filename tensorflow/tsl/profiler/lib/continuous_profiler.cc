@@ -0,0 +1,101 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/tsl/profiler/lib/continuous_profiler.h"
+
+#include <memory>
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/tsl/platform/errors.h"
+#include "tensorflow/tsl/platform/logging.h"
+#include "tensorflow/tsl/profiler/backends/cpu/host_tracer_utils.h"
+#include "tensorflow/tsl/profiler/backends/cpu/traceme_recorder.h"
+#include "tensorflow/tsl/profiler/utils/time_utils.h"
+#include "tensorflow/tsl/profiler/utils/xplane_schema.h"
+#include "tensorflow/tsl/profiler/utils/xplane_utils.h"
+
+namespace tsl {
+namespace profiler {
+
+/*static*/ StatusOr<std::unique_ptr<ContinuousProfiler>>
+ContinuousProfiler::Create(Options options) {
+  if (options.window_ns <= 0) {
+    return errors::InvalidArgument("window_ns must be positive, got ",
+                                   options.window_ns);
+  }
+  if (!TraceMeRecorder::StartContinuous(options.trace_level,
+                                        options.sampling_period,
+                                        options.events_per_thread)) {
+    return errors::AlreadyExists("Continuous profiling is already active.");
+  }
+  return std::unique_ptr<ContinuousProfiler>(
+      new ContinuousProfiler(std::move(options)));
+}
+
+ContinuousProfiler::ContinuousProfiler(Options options)
+    : options_(std::move(options)) {}
+
+ContinuousProfiler::~ContinuousProfiler() {
+  TraceMeRecorder::StopContinuous();
+}
+
+bool ContinuousProfiler::ReportLatency(int64_t latency_ns) {
+  if (options_.latency_threshold_ns <= 0 ||
+      latency_ns <= options_.latency_threshold_ns) {
+    return false;
+  }
+  return Trigger(absl::StrCat("latency of ", latency_ns,
+                              "ns above threshold of ",
+                              options_.latency_threshold_ns, "ns"));
+}
+
+bool ContinuousProfiler::ReportError(const Status& status) {
+  if (status.ok() || !options_.trigger_on_error) return false;
+  return Trigger(absl::StrCat("error: ", status.ToString()));
+}
+
+Status ContinuousProfiler::Export(tensorflow::profiler::XSpace* space) const {
+  const int64_t start_time_ns = GetCurrentTimeNanos() - options_.window_ns;
+  TraceMeRecorder::Events events = TraceMeRecorder::Snapshot(start_time_ns);
+  if (events.empty()) return OkStatus();
+  tensorflow::profiler::XPlane* plane =
+      FindOrAddMutablePlaneWithName(space, kHostThreadsPlaneName);
+  ConvertCompleteEventsToXPlane(start_time_ns, std::move(events), plane);
+  return OkStatus();
+}
+
+bool ContinuousProfiler::Trigger(absl::string_view reason) {
+  const int64_t now_ns = GetCurrentTimeNanos();
+  {
+    mutex_lock lock(mutex_);
+    if (last_trigger_ns_ != 0 &&
+        now_ns - last_trigger_ns_ < options_.min_trigger_interval_ns) {
+      return false;
+    }
+    last_trigger_ns_ = now_ns;
+  }
+  VLOG(1) << "Continuous profiler triggered by " << reason;
+  tensorflow::profiler::XSpace space;
+  Status status = Export(&space);
+  if (!status.ok()) {
+    LOG(WARNING) << "Continuous profiler failed to export: " << status;
+    return false;
+  }
+  if (options_.on_trigger) options_.on_trigger(reason, std::move(space));
+  return true;
+}
+
+}  // namespace profiler
+}  // namespace tsl
@@ -0,0 +1,121 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_TSL_PROFILER_LIB_CONTINUOUS_PROFILER_H_
+#define TENSORFLOW_TSL_PROFILER_LIB_CONTINUOUS_PROFILER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+#include "absl/strings/string_view.h"
+#include "tensorflow/tsl/platform/mutex.h"
+#include "tensorflow/tsl/platform/status.h"
+#include "tensorflow/tsl/platform/statusor.h"
+#include "tensorflow/tsl/platform/thread_annotations.h"
+#include "tensorflow/tsl/profiler/protobuf/xplane.pb.h"
+
+namespace tsl {
+namespace profiler {
+
+// A low-overhead profiler meant to be left on in production to catch rare
+// latency spikes.
+//
+// While a ContinuousProfiler is alive, TraceMeRecorder continuously records a
+// sampled fraction of TraceMe activities into a fixed-size ring per thread.
+// When a trigger fires (a reported latency above the threshold, or a reported
+// error), the events of the last `window_ns` are exported as an XSpace and
+// passed to `on_trigger`.
+//
+// On-demand profiling (ProfilerSession) keeps working while a
+// ContinuousProfiler is alive: continuous recording is suspended for the
+// duration of the session.
+//
+// Thread-safety: ContinuousProfiler is thread-safe.
+class ContinuousProfiler {
+ public:
+  struct Options {
+    // TraceMe activities with level <= trace_level are recorded.
+    int trace_level = 1;
+
+    // One of every `sampling_period` TraceMe activities is recorded on each
+    // thread.
+    int sampling_period = 100;
+
+    // Number of most recent events kept per thread.
+    size_t events_per_thread = 4096;
+
+    // Length of the exported window, ending at the time of the export.
+    int64_t window_ns = 10'000'000'000;
+
+    // ReportLatency() fires a trigger for latencies above this threshold.
+    // Zero disables latency triggers.
+    int64_t latency_threshold_ns = 0;
+
+    // Whether ReportError() fires a trigger.
+    bool trigger_on_error = true;
+
+    // Minimum time between two exports caused by triggers, so that a burst of
+    // slow requests or errors doesn't export the same window over and over.
+    int64_t min_trigger_interval_ns = 60'000'000'000;
+
+    // Receives the XSpace exported when a trigger fires, and the reason of the
+    // trigger. Runs on the thread that reported the trigger.
+    std::function<void(absl::string_view reason,
+                       tensorflow::profiler::XSpace space)>
+        on_trigger;
+  };
+
+  // Starts continuous recording. Returns an error if another
+  // ContinuousProfiler is alive.
+  static StatusOr<std::unique_ptr<ContinuousProfiler>> Create(
+      Options options);
+
+  // Stops continuous recording.
+  ~ContinuousProfiler();
+
+  ContinuousProfiler(const ContinuousProfiler&) = delete;
+  ContinuousProfiler& operator=(const ContinuousProfiler&) = delete;
+
+  // Reports the latency of an operation. Fires a trigger if the latency is
+  // above the threshold. Returns true if an XSpace was exported.
+  bool ReportLatency(int64_t latency_ns) TF_LOCKS_EXCLUDED(mutex_);
+
+  // Reports an error. Fires a trigger if `status` is not OK and error triggers
+  // are enabled. Returns true if an XSpace was exported.
+  bool ReportError(const Status& status) TF_LOCKS_EXCLUDED(mutex_);
+
+  // Exports the events of the last window into `space`, independently of any
+  // trigger.
+  Status Export(tensorflow::profiler::XSpace* space) const;
+
+ private:
+  explicit ContinuousProfiler(Options options);
+
+  // Exports the last window and passes it to `on_trigger`, unless the last
+  // triggered export is too recent.
+  bool Trigger(absl::string_view reason) TF_LOCKS_EXCLUDED(mutex_);
+
+  const Options options_;
+
+  mutex mutex_;
+  // Time of the last triggered export.
+  int64_t last_trigger_ns_ TF_GUARDED_BY(mutex_) = 0;
+};
+
+}  // namespace profiler
+}  // namespace tsl
+
+#endif  // TENSORFLOW_TSL_PROFILER_LIB_CONTINUOUS_PROFILER_H_
@@ -0,0 +1,117 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/tsl/profiler/lib/continuous_profiler.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "tensorflow/tsl/lib/core/status_test_util.h"
+#include "tensorflow/tsl/platform/errors.h"
+#include "tensorflow/tsl/platform/status.h"
+#include "tensorflow/tsl/platform/test.h"
+#include "tensorflow/tsl/profiler/lib/traceme.h"
+#include "tensorflow/tsl/profiler/protobuf/xplane.pb.h"
+#include "tensorflow/tsl/profiler/utils/xplane_schema.h"
+#include "tensorflow/tsl/profiler/utils/xplane_utils.h"
+
+namespace tsl {
+namespace profiler {
+namespace {
+
+using tensorflow::profiler::XSpace;
+
+// Returns the names of the host events in `space`.
+std::vector<std::string> HostEventNames(const XSpace& space) {
+  std::vector<std::string> names;
+  const auto* plane = FindPlaneWithName(space, kHostThreadsPlaneName);
+  if (plane == nullptr) return names;
+  for (const auto& line : plane->lines()) {
+    for (const auto& event : line.events()) {
+      names.push_back(plane->event_metadata().at(event.metadata_id()).name());
+    }
+  }
+  return names;
+}
+
+TEST(ContinuousProfilerTest, TriggersOnLatency) {
+  std::vector<std::string> reasons;
+  std::vector<XSpace> spaces;
+  ContinuousProfiler::Options options;
+  options.sampling_period = 1;
+  options.latency_threshold_ns = 1000;
+  options.on_trigger = [&](absl::string_view reason, XSpace space) {
+    reasons.emplace_back(reason);
+    spaces.push_back(std::move(space));
+  };
+  auto profiler = ContinuousProfiler::Create(std::move(options));
+  TF_ASSERT_OK(profiler.status());
+
+  { TraceMe trace_me("slow_op"); }
+
+  EXPECT_FALSE((*profiler)->ReportLatency(1000));
+  EXPECT_TRUE((*profiler)->ReportLatency(1001));
+  ASSERT_EQ(spaces.size(), 1);
+  EXPECT_THAT(reasons[0], ::testing::HasSubstr("latency"));
+  EXPECT_THAT(HostEventNames(spaces[0]), ::testing::Contains("slow_op"));
+
+  // Triggers are rate limited.
+  EXPECT_FALSE((*profiler)->ReportLatency(1001));
+  EXPECT_EQ(spaces.size(), 1);
+}
+
+TEST(ContinuousProfilerTest, TriggersOnError) {
+  int num_triggers = 0;
+  ContinuousProfiler::Options options;
+  options.on_trigger = [&](absl::string_view, XSpace) { ++num_triggers; };
+  auto profiler = ContinuousProfiler::Create(std::move(options));
+  TF_ASSERT_OK(profiler.status());
+
+  EXPECT_FALSE((*profiler)->ReportError(OkStatus()));
+  EXPECT_TRUE((*profiler)->ReportError(errors::Internal("failure")));
+  EXPECT_EQ(num_triggers, 1);
+  // Latency triggers are disabled by default.
+  EXPECT_FALSE((*profiler)->ReportLatency(1000000000));
+}
+
+TEST(ContinuousProfilerTest, SamplesTraceMes) {
+  ContinuousProfiler::Options options;
+  options.sampling_period = 10;
+  auto profiler = ContinuousProfiler::Create(std::move(options));
+  TF_ASSERT_OK(profiler.status());
+
+  for (int i = 0; i < 100; ++i) {
+    TraceMe trace_me("op");
+  }
+  XSpace space;
+  TF_ASSERT_OK((*profiler)->Export(&space));
+  EXPECT_EQ(HostEventNames(space).size(), 10);
+}
+
+TEST(ContinuousProfilerTest, SingleInstance) {
+  auto profiler = ContinuousProfiler::Create({});
+  TF_ASSERT_OK(profiler.status());
+  EXPECT_TRUE(
+      errors::IsAlreadyExists(ContinuousProfiler::Create({}).status()));
+  profiler->reset();
+  TF_EXPECT_OK(ContinuousProfiler::Create({}).status());
+  EXPECT_FALSE(TraceMe::Active());
+}
+
+}  // namespace
+}  // namespace profiler
+}  // namespace tsl
@@ -96,10 +96,13 @@ class TraceMe {
   // - Can be a value in enum TraceMeLevel.
   // Users are welcome to use level > 3 in their code, if they wish to filter
   // out their host traces based on verbosity.
+  // While continuous recording is active only a sampled fraction of
+  // activities is recorded, so a recorded activity may lack its parent.
   explicit TraceMe(absl::string_view name, int level = 1) {
     DCHECK_GE(level, 1);
 #if !defined(IS_MOBILE_PLATFORM)
-    if (TF_PREDICT_FALSE(TraceMeRecorder::Active(level))) {
+    if (TF_PREDICT_FALSE(TraceMeRecorder::Active(level) &&
+                         TraceMeRecorder::Sampled())) {
       new (&no_init_.name) std::string(name);
       start_time_ = GetCurrentTimeNanos();
     }
@@ -146,7 +149,8 @@ class TraceMe {
   explicit TraceMe(NameGeneratorT&& name_generator, int level = 1) {
     DCHECK_GE(level, 1);
 #if !defined(IS_MOBILE_PLATFORM)
-    if (TF_PREDICT_FALSE(TraceMeRecorder::Active(level))) {
+    if (TF_PREDICT_FALSE(TraceMeRecorder::Active(level) &&
+                         TraceMeRecorder::Sampled())) {
       new (&no_init_.name)
           std::string(std::forward<NameGeneratorT>(name_generator)());
       start_time_ = GetCurrentTimeNanos();
@@ -227,7 +231,8 @@ class TraceMe {
             std::enable_if_t<is_invocable<NameGeneratorT>::value, bool> = true>
   static int64_t ActivityStart(NameGeneratorT&& name_generator, int level = 1) {
 #if !defined(IS_MOBILE_PLATFORM)
-    if (TF_PREDICT_FALSE(TraceMeRecorder::Active(level))) {
+    if (TF_PREDICT_FALSE(TraceMeRecorder::Active(level) &&
+                         TraceMeRecorder::Sampled())) {
       int64_t activity_id = TraceMeRecorder::NewActivityId();
       TraceMeRecorder::Record({std::forward<NameGeneratorT>(name_generator)(),
                                GetCurrentTimeNanos(), -activity_id});
@@ -241,7 +246,8 @@ class TraceMe {
   // Returns the activity ID, which is used to stop the activity.
   static int64_t ActivityStart(absl::string_view name, int level = 1) {
 #if !defined(IS_MOBILE_PLATFORM)
-    if (TF_PREDICT_FALSE(TraceMeRecorder::Active(level))) {
+    if (TF_PREDICT_FALSE(TraceMeRecorder::Active(level) &&
+                         TraceMeRecorder::Sampled())) {
       int64_t activity_id = TraceMeRecorder::NewActivityId();
       TraceMeRecorder::Record(
           {std::string(name), GetCurrentTimeNanos(), -activity_id});
@@ -279,7 +285,8 @@ class TraceMe {
             std::enable_if_t<is_invocable<NameGeneratorT>::value, bool> = true>
   static void InstantActivity(NameGeneratorT&& name_generator, int level = 1) {
 #if !defined(IS_MOBILE_PLATFORM)
-    if (TF_PREDICT_FALSE(TraceMeRecorder::Active(level))) {
+    if (TF_PREDICT_FALSE(TraceMeRecorder::Active(level) &&
+                         TraceMeRecorder::Sampled())) {
       int64_t now = GetCurrentTimeNanos();
       TraceMeRecorder::Record({std::forward<NameGeneratorT>(name_generator)(),
                                /*start_time=*/now, /*end_time=*/now});
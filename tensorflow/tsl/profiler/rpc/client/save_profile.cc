@@ -34,6 +34,7 @@ limitations under the License.
 #include "tensorflow/tsl/platform/errors.h"
 #include "tensorflow/tsl/platform/file_system.h"
 #include "tensorflow/tsl/platform/logging.h"
+#include "tensorflow/tsl/platform/protobuf.h"
 #include "tensorflow/tsl/platform/status.h"
 #include "tensorflow/tsl/profiler/protobuf/profiler_service.pb.h"
 #include "tensorflow/tsl/profiler/protobuf/xplane.pb.h"
@@ -84,6 +85,52 @@ Status GetOrCreateRunDir(const std::string& repository_root,
   TF_RETURN_IF_ERROR(Env::Default()->RecursivelyCreateDir(*run_dir));
   return OkStatus();
 }
+
+// Writes `xspace` in the binary proto format to `filepath`, one field at a
+// time: only one plane is serialized in memory at once, instead of the whole
+// XSpace, which may be several GBs for large traces.
+Status WriteXSpaceToFile(const std::string& filepath,
+                         const tensorflow::profiler::XSpace& xspace) {
+  std::unique_ptr<WritableFile> file;
+  TF_RETURN_IF_ERROR(Env::Default()->NewWritableFile(filepath, &file));
+  std::string field;
+  // Appends a length-delimited field, as serialized by the XSpace message.
+  auto append_field = [&](uint32_t field_number,
+                          absl::string_view value) -> Status {
+    constexpr uint32_t kLengthDelimitedWireType = 2;
+    field.clear();
+    {
+      protobuf::io::StringOutputStream string_stream(&field);
+      protobuf::io::CodedOutputStream coded_stream(&string_stream);
+      coded_stream.WriteTag((field_number << 3) | kLengthDelimitedWireType);
+      coded_stream.WriteVarint32(value.size());
+    }
+    TF_RETURN_IF_ERROR(file->Append(field));
+    return file->Append(value);
+  };
+  std::string serialized_plane;
+  for (const auto& plane : xspace.planes()) {
+    if (!plane.SerializeToString(&serialized_plane)) {
+      return errors::Internal("Failed to serialize XPlane ", plane.name());
+    }
+    TF_RETURN_IF_ERROR(append_field(
+        tensorflow::profiler::XSpace::kPlanesFieldNumber, serialized_plane));
+  }
+  std::string().swap(serialized_plane);
+  for (const auto& error : xspace.errors()) {
+    TF_RETURN_IF_ERROR(append_field(
+        tensorflow::profiler::XSpace::kErrorsFieldNumber, error));
+  }
+  for (const auto& warning : xspace.warnings()) {
+    TF_RETURN_IF_ERROR(append_field(
+        tensorflow::profiler::XSpace::kWarningsFieldNumber, warning));
+  }
+  for (const auto& hostname : xspace.hostnames()) {
+    TF_RETURN_IF_ERROR(append_field(
+        tensorflow::profiler::XSpace::kHostnamesFieldNumber, hostname));
+  }
+  return file->Close();
+}
 }  // namespace
 
 std::string GetTensorBoardProfilePluginDir(const std::string& logdir) {
@@ -143,7 +190,7 @@ Status SaveXSpace(const std::string& repository_root, const std::string& run,
   std::string out_path = ProfilerJoinPath(log_dir, file_name);
   LOG(INFO) << "Collecting XSpace to repository: " << out_path;
 
-  return WriteBinaryProto(Env::Default(), out_path, xspace);
+  return WriteXSpaceToFile(out_path, xspace);
 }
 
 }  // namespace profiler
@@ -47,7 +47,8 @@ Status SaveGzippedToolData(const std::string& repository_root,
                            const std::string& tool_name,
                            const std::string& data);
 
-// Save XSpace to <repository_root>/<run>/<host>_<port>.<kXPlanePb>.
+// Save XSpace to <repository_root>/<run>/<host>_<port>.<kXPlanePb>. The planes
+// are serialized and written one at a time.
 Status SaveXSpace(const std::string& repository_root, const std::string& run,
                   const std::string& host,
                   const tensorflow::profiler::XSpace& xspace);
@@ -603,6 +603,22 @@ def _tf_repositories():
         urls = tf_mirror_urls("https://github.com/google/snappy/archive/984b191f0fefdeb17050b42a90b7625999c13b8d.tar.gz"),
     )
 
+    tf_http_archive(
+        name = "zstd",
+        build_file = "//third_party:zstd.BUILD",
+        sha256 = "30f35f71c1203369dc979ecde0400ffea93c27391bfd2ac5a9715d2173d92ff7",
+        strip_prefix = "zstd-1.5.6",
+        urls = tf_mirror_urls("https://github.com/facebook/zstd/archive/v1.5.6.tar.gz"),
+    )
+
+    tf_http_archive(
+        name = "lz4",
+        build_file = "//third_party:lz4.BUILD",
+        sha256 = "0b0e3aa07c8c063ddf40b082bdf7e37a1562bda40a0ff5272957f3e987e0e54b",
+        strip_prefix = "lz4-1.9.4",
+        urls = tf_mirror_urls("https://github.com/lz4/lz4/archive/v1.9.4.tar.gz"),
+    )
+
     tf_http_archive(
         name = "nccl_archive",
         build_file = "//third_party:nccl/archive.BUILD",